@@ -0,0 +1,564 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Concepts.h>
+#include <AK/Error.h>
+#include <AK/Noncopyable.h>
+#include <AK/Optional.h>
+#include <AK/kmalloc.h>
+
+namespace AK {
+
+template<typename LeafNodeType, typename ElementType>
+class BTreeMapIterator {
+public:
+    BTreeMapIterator() = default;
+    bool operator==(BTreeMapIterator const& other) const { return m_leaf == other.m_leaf && m_index == other.m_index; }
+    bool operator!=(BTreeMapIterator const& other) const { return !(*this == other); }
+    BTreeMapIterator& operator++()
+    {
+        if (!m_leaf)
+            return *this;
+        if (++m_index == m_leaf->count) {
+            m_leaf = m_leaf->next;
+            m_index = 0;
+        }
+        return *this;
+    }
+    BTreeMapIterator& operator--()
+    {
+        if (!m_leaf)
+            return *this;
+        if (m_index > 0) {
+            --m_index;
+        } else if (m_leaf->previous) {
+            m_leaf = m_leaf->previous;
+            m_index = m_leaf->count - 1;
+        }
+        return *this;
+    }
+    ElementType& operator*() { return m_leaf->value(m_index); }
+    ElementType* operator->() { return &m_leaf->value(m_index); }
+    [[nodiscard]] bool is_end() const { return !m_leaf; }
+    [[nodiscard]] bool is_begin() const { return m_leaf && m_index == 0 && !m_leaf->previous; }
+
+    [[nodiscard]] auto key() const { return m_leaf->keys[m_index]; }
+
+    BTreeMapIterator(LeafNodeType* leaf, size_t index)
+        : m_leaf(leaf)
+        , m_index(index)
+    {
+    }
+
+private:
+    LeafNodeType* m_leaf { nullptr };
+    size_t m_index { 0 };
+};
+
+// A B+ tree that keeps many keys per node, so lookups touch few cache lines and
+// allocations are amortized over many elements. All values live in the leaves,
+// which are linked together for cheap in-order iteration.
+//
+// Its interface mirrors RedBlackTree, with one difference: values move around
+// inside the tree, so pointers to them (and iterators) are invalidated by any
+// insertion or removal.
+template<Integral K, typename V>
+class BTreeMap {
+    AK_MAKE_NONCOPYABLE(BTreeMap);
+    AK_MAKE_NONMOVABLE(BTreeMap);
+
+    static constexpr size_t leaf_capacity = 16;
+    static constexpr size_t internal_capacity = 16;
+    static constexpr size_t minimum_leaf_count = leaf_capacity / 2;
+    static constexpr size_t minimum_internal_count = (internal_capacity - 1) / 2;
+
+    // With every node at least half full, this is plenty for any number of elements that fits in memory.
+    static constexpr size_t maximum_height = 32;
+
+    struct LeafNode {
+        size_t count { 0 };
+        LeafNode* previous { nullptr };
+        LeafNode* next { nullptr };
+        K keys[leaf_capacity];
+        alignas(V) u8 value_storage[sizeof(V) * leaf_capacity];
+
+        V& value(size_t index) { return reinterpret_cast<V*>(value_storage)[index]; }
+        V const& value(size_t index) const { return reinterpret_cast<V const*>(value_storage)[index]; }
+    };
+
+    // Everything in children[i] is smaller than keys[i], and everything in children[i + 1] is at least keys[i].
+    struct InternalNode {
+        size_t count { 0 };
+        K keys[internal_capacity];
+        void* children[internal_capacity + 1];
+    };
+
+public:
+    BTreeMap() = default;
+    ~BTreeMap() { clear(); }
+
+    [[nodiscard]] size_t size() const { return m_size; }
+    [[nodiscard]] bool is_empty() const { return m_size == 0; }
+
+    [[nodiscard]] V* find(K key)
+    {
+        auto* leaf = leaf_for(key);
+        if (!leaf)
+            return nullptr;
+        auto index = lower_bound(*leaf, key);
+        if (index == leaf->count || leaf->keys[index] != key)
+            return nullptr;
+        return &leaf->value(index);
+    }
+
+    [[nodiscard]] V* find_largest_not_above(K key)
+    {
+        auto iterator = find_largest_not_above_iterator(key);
+        if (iterator.is_end())
+            return nullptr;
+        return &*iterator;
+    }
+
+    void insert(K key, V const& value)
+    {
+        insert(key, V(value));
+    }
+
+    void insert(K key, V&& value)
+    {
+        MUST(try_insert(key, move(value)));
+    }
+
+    // Inserting a key that is already in the map replaces its value.
+    ErrorOr<void> try_insert(K key, V&& value)
+    {
+        if (!m_root) {
+            auto* leaf = new (nothrow) LeafNode;
+            if (!leaf)
+                return Error::from_errno(ENOMEM);
+            m_root = leaf;
+            m_height = 0;
+        }
+
+        // Full nodes are split on the way down, so there is always room in the parent for the separator key.
+        // If an allocation fails halfway, the tree is still valid, just with a few more nodes than necessary.
+        if (is_full(m_root, m_height == 0)) {
+            auto* new_root = new (nothrow) InternalNode;
+            if (!new_root)
+                return Error::from_errno(ENOMEM);
+            new_root->children[0] = m_root;
+            if (auto result = split_child(*new_root, 0, m_height == 0); result.is_error()) {
+                delete new_root;
+                return result.release_error();
+            }
+            m_root = new_root;
+            ++m_height;
+        }
+
+        void* node = m_root;
+        for (size_t level = m_height; level > 0; --level) {
+            auto& internal = *static_cast<InternalNode*>(node);
+            auto index = child_index(internal, key);
+            bool child_is_leaf = level == 1;
+            if (is_full(internal.children[index], child_is_leaf)) {
+                TRY(split_child(internal, index, child_is_leaf));
+                if (key >= internal.keys[index])
+                    ++index;
+            }
+            node = internal.children[index];
+        }
+
+        auto& leaf = *static_cast<LeafNode*>(node);
+        auto index = lower_bound(leaf, key);
+        if (index < leaf.count && leaf.keys[index] == key) {
+            leaf.value(index) = move(value);
+            return {};
+        }
+
+        for (size_t i = leaf.count; i > index; --i)
+            move_entry(leaf, i - 1, leaf, i);
+        leaf.keys[index] = key;
+        new (&leaf.value(index)) V(move(value));
+        ++leaf.count;
+        ++m_size;
+        return {};
+    }
+
+    using Iterator = BTreeMapIterator<LeafNode, V>;
+    Iterator begin() { return Iterator(first_leaf(), 0); }
+    Iterator end() { return {}; }
+    Iterator begin_from(K key) { return iterator_for_exact_key<Iterator>(key); }
+
+    using ConstIterator = BTreeMapIterator<LeafNode const, V const>;
+    ConstIterator begin() const { return ConstIterator(first_leaf(), 0); }
+    ConstIterator end() const { return {}; }
+    ConstIterator begin_from(K key) const { return iterator_for_exact_key<ConstIterator>(key); }
+
+    Iterator find_largest_not_above_iterator(K key) { return largest_not_above_iterator<Iterator>(key); }
+    ConstIterator find_largest_not_above_iterator(K key) const { return largest_not_above_iterator<ConstIterator>(key); }
+
+    Iterator find_smallest_not_below_iterator(K key) { return smallest_not_below_iterator<Iterator>(key); }
+    ConstIterator find_smallest_not_below_iterator(K key) const { return smallest_not_below_iterator<ConstIterator>(key); }
+
+    Optional<V> take(K key)
+    {
+        if (!m_root)
+            return {};
+
+        // Remember the way down, so underfull nodes can be fixed up on the way back.
+        InternalNode* parents[maximum_height];
+        size_t child_indices[maximum_height];
+        void* node = m_root;
+        for (size_t level = 0; level < m_height; ++level) {
+            auto* internal = static_cast<InternalNode*>(node);
+            parents[level] = internal;
+            child_indices[level] = child_index(*internal, key);
+            node = internal->children[child_indices[level]];
+        }
+
+        auto& leaf = *static_cast<LeafNode*>(node);
+        auto index = lower_bound(leaf, key);
+        if (index == leaf.count || leaf.keys[index] != key)
+            return {};
+
+        Optional<V> value = move(leaf.value(index));
+        leaf.value(index).~V();
+        for (size_t i = index + 1; i < leaf.count; ++i)
+            move_entry(leaf, i, leaf, i - 1);
+        --leaf.count;
+        --m_size;
+
+        rebalance_after_removal(parents, child_indices);
+        return value;
+    }
+
+    V unsafe_remove(K key)
+    {
+        auto value = take(key);
+        VERIFY(value.has_value());
+        return value.release_value();
+    }
+
+    bool remove(K key)
+    {
+        return take(key).has_value();
+    }
+
+    void clear()
+    {
+        if (m_root)
+            destroy(m_root, m_height);
+        m_root = nullptr;
+        m_height = 0;
+        m_size = 0;
+    }
+
+private:
+    static bool is_full(void* node, bool is_leaf)
+    {
+        if (is_leaf)
+            return static_cast<LeafNode*>(node)->count == leaf_capacity;
+        return static_cast<InternalNode*>(node)->count == internal_capacity;
+    }
+
+    static size_t child_index(InternalNode const& node, K key)
+    {
+        size_t index = 0;
+        while (index < node.count && key >= node.keys[index])
+            ++index;
+        return index;
+    }
+
+    static size_t lower_bound(LeafNode const& leaf, K key)
+    {
+        size_t index = 0;
+        while (index < leaf.count && leaf.keys[index] < key)
+            ++index;
+        return index;
+    }
+
+    static void move_entry(LeafNode& from, size_t from_index, LeafNode& to, size_t to_index)
+    {
+        to.keys[to_index] = from.keys[from_index];
+        new (&to.value(to_index)) V(move(from.value(from_index)));
+        from.value(from_index).~V();
+    }
+
+    LeafNode* leaf_for(K key) const
+    {
+        void* node = m_root;
+        for (size_t level = 0; node && level < m_height; ++level) {
+            auto* internal = static_cast<InternalNode*>(node);
+            node = internal->children[child_index(*internal, key)];
+        }
+        return static_cast<LeafNode*>(node);
+    }
+
+    LeafNode* first_leaf() const
+    {
+        void* node = m_root;
+        for (size_t level = 0; node && level < m_height; ++level)
+            node = static_cast<InternalNode*>(node)->children[0];
+        auto* leaf = static_cast<LeafNode*>(node);
+        return leaf && leaf->count ? leaf : nullptr;
+    }
+
+    template<typename IteratorType>
+    IteratorType iterator_for_exact_key(K key) const
+    {
+        auto* leaf = leaf_for(key);
+        if (!leaf)
+            return {};
+        auto index = lower_bound(*leaf, key);
+        if (index == leaf->count || leaf->keys[index] != key)
+            return {};
+        return IteratorType(leaf, index);
+    }
+
+    template<typename IteratorType>
+    IteratorType largest_not_above_iterator(K key) const
+    {
+        auto* leaf = leaf_for(key);
+        if (!leaf)
+            return {};
+        size_t index = 0;
+        while (index < leaf->count && leaf->keys[index] <= key)
+            ++index;
+        if (index > 0)
+            return IteratorType(leaf, index - 1);
+        // Everything in this leaf is above the key, but everything in the one before it is below it.
+        if (!leaf->previous)
+            return {};
+        return IteratorType(leaf->previous, leaf->previous->count - 1);
+    }
+
+    template<typename IteratorType>
+    IteratorType smallest_not_below_iterator(K key) const
+    {
+        auto* leaf = leaf_for(key);
+        if (!leaf)
+            return {};
+        auto index = lower_bound(*leaf, key);
+        if (index < leaf->count)
+            return IteratorType(leaf, index);
+        if (!leaf->next)
+            return {};
+        return IteratorType(leaf->next, 0);
+    }
+
+    ErrorOr<void> split_child(InternalNode& parent, size_t index, bool child_is_leaf)
+    {
+        void* new_child;
+        K separator;
+        if (child_is_leaf) {
+            auto& left = *static_cast<LeafNode*>(parent.children[index]);
+            auto* right = new (nothrow) LeafNode;
+            if (!right)
+                return Error::from_errno(ENOMEM);
+            size_t middle = leaf_capacity / 2;
+            for (size_t i = middle; i < left.count; ++i)
+                move_entry(left, i, *right, i - middle);
+            right->count = left.count - middle;
+            left.count = middle;
+
+            right->previous = &left;
+            right->next = left.next;
+            if (right->next)
+                right->next->previous = right;
+            left.next = right;
+
+            new_child = right;
+            separator = right->keys[0];
+        } else {
+            auto& left = *static_cast<InternalNode*>(parent.children[index]);
+            auto* right = new (nothrow) InternalNode;
+            if (!right)
+                return Error::from_errno(ENOMEM);
+            size_t middle = internal_capacity / 2;
+            separator = left.keys[middle];
+            for (size_t i = middle + 1; i < left.count; ++i)
+                right->keys[i - middle - 1] = left.keys[i];
+            for (size_t i = middle + 1; i <= left.count; ++i)
+                right->children[i - middle - 1] = left.children[i];
+            right->count = left.count - middle - 1;
+            left.count = middle;
+
+            new_child = right;
+        }
+
+        for (size_t i = parent.count; i > index; --i) {
+            parent.keys[i] = parent.keys[i - 1];
+            parent.children[i + 1] = parent.children[i];
+        }
+        parent.keys[index] = separator;
+        parent.children[index + 1] = new_child;
+        ++parent.count;
+        return {};
+    }
+
+    static void remove_from_parent(InternalNode& parent, size_t key_index)
+    {
+        for (size_t i = key_index + 1; i < parent.count; ++i) {
+            parent.keys[i - 1] = parent.keys[i];
+            parent.children[i] = parent.children[i + 1];
+        }
+        --parent.count;
+    }
+
+    static void fix_underfull_leaf(InternalNode& parent, size_t index)
+    {
+        auto& leaf = *static_cast<LeafNode*>(parent.children[index]);
+
+        if (index > 0) {
+            auto& left = *static_cast<LeafNode*>(parent.children[index - 1]);
+            if (left.count > minimum_leaf_count) {
+                for (size_t i = leaf.count; i > 0; --i)
+                    move_entry(leaf, i - 1, leaf, i);
+                move_entry(left, left.count - 1, leaf, 0);
+                --left.count;
+                ++leaf.count;
+                parent.keys[index - 1] = leaf.keys[0];
+                return;
+            }
+        }
+
+        if (index < parent.count) {
+            auto& right = *static_cast<LeafNode*>(parent.children[index + 1]);
+            if (right.count > minimum_leaf_count) {
+                move_entry(right, 0, leaf, leaf.count);
+                for (size_t i = 1; i < right.count; ++i)
+                    move_entry(right, i, right, i - 1);
+                --right.count;
+                ++leaf.count;
+                parent.keys[index] = right.keys[0];
+                return;
+            }
+        }
+
+        // Neither neighbor has anything to spare, so merge with one of them.
+        size_t left_index = index > 0 ? index - 1 : index;
+        auto& left = *static_cast<LeafNode*>(parent.children[left_index]);
+        auto* right = static_cast<LeafNode*>(parent.children[left_index + 1]);
+        for (size_t i = 0; i < right->count; ++i)
+            move_entry(*right, i, left, left.count + i);
+        left.count += right->count;
+        left.next = right->next;
+        if (left.next)
+            left.next->previous = &left;
+        delete right;
+        remove_from_parent(parent, left_index);
+    }
+
+    static void fix_underfull_internal_node(InternalNode& parent, size_t index)
+    {
+        auto& node = *static_cast<InternalNode*>(parent.children[index]);
+
+        if (index > 0) {
+            auto& left = *static_cast<InternalNode*>(parent.children[index - 1]);
+            if (left.count > minimum_internal_count) {
+                node.children[node.count + 1] = node.children[node.count];
+                for (size_t i = node.count; i > 0; --i) {
+                    node.keys[i] = node.keys[i - 1];
+                    node.children[i] = node.children[i - 1];
+                }
+                node.keys[0] = parent.keys[index - 1];
+                node.children[0] = left.children[left.count];
+                parent.keys[index - 1] = left.keys[left.count - 1];
+                --left.count;
+                ++node.count;
+                return;
+            }
+        }
+
+        if (index < parent.count) {
+            auto& right = *static_cast<InternalNode*>(parent.children[index + 1]);
+            if (right.count > minimum_internal_count) {
+                node.keys[node.count] = parent.keys[index];
+                node.children[node.count + 1] = right.children[0];
+                ++node.count;
+                parent.keys[index] = right.keys[0];
+                for (size_t i = 1; i < right.count; ++i)
+                    right.keys[i - 1] = right.keys[i];
+                for (size_t i = 1; i <= right.count; ++i)
+                    right.children[i - 1] = right.children[i];
+                --right.count;
+                return;
+            }
+        }
+
+        size_t left_index = index > 0 ? index - 1 : index;
+        auto& left = *static_cast<InternalNode*>(parent.children[left_index]);
+        auto* right = static_cast<InternalNode*>(parent.children[left_index + 1]);
+        left.keys[left.count] = parent.keys[left_index];
+        for (size_t i = 0; i < right->count; ++i)
+            left.keys[left.count + 1 + i] = right->keys[i];
+        for (size_t i = 0; i <= right->count; ++i)
+            left.children[left.count + 1 + i] = right->children[i];
+        left.count += right->count + 1;
+        delete right;
+        remove_from_parent(parent, left_index);
+    }
+
+    void rebalance_after_removal(InternalNode** parents, size_t* child_indices)
+    {
+        for (size_t level = m_height; level > 0; --level) {
+            auto& parent = *parents[level - 1];
+            auto index = child_indices[level - 1];
+            bool child_is_leaf = level == m_height;
+            if (child_is_leaf) {
+                if (static_cast<LeafNode*>(parent.children[index])->count >= minimum_leaf_count)
+                    return;
+                fix_underfull_leaf(parent, index);
+            } else {
+                if (static_cast<InternalNode*>(parent.children[index])->count >= minimum_internal_count)
+                    return;
+                fix_underfull_internal_node(parent, index);
+            }
+        }
+
+        if (m_height == 0) {
+            auto* leaf = static_cast<LeafNode*>(m_root);
+            if (leaf->count == 0) {
+                delete leaf;
+                m_root = nullptr;
+            }
+            return;
+        }
+
+        auto* root = static_cast<InternalNode*>(m_root);
+        if (root->count == 0) {
+            m_root = root->children[0];
+            delete root;
+            --m_height;
+        }
+    }
+
+    static void destroy(void* node, size_t height)
+    {
+        if (height == 0) {
+            auto* leaf = static_cast<LeafNode*>(node);
+            for (size_t i = 0; i < leaf->count; ++i)
+                leaf->value(i).~V();
+            delete leaf;
+            return;
+        }
+
+        auto* internal = static_cast<InternalNode*>(node);
+        for (size_t i = 0; i <= internal->count; ++i)
+            destroy(internal->children[i], height - 1);
+        delete internal;
+    }
+
+    void* m_root { nullptr };
+    size_t m_height { 0 };
+    size_t m_size { 0 };
+};
+
+}
+
+using AK::BTreeMap;
@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include <AK/BuiltinWrappers.h>
+#include <AK/Endian.h>
 #include <AK/Optional.h>
 #include <AK/Stream.h>
 
@@ -25,13 +27,9 @@ public:
             return 0;
 
         size_t nread = 0;
-        if (bytes.size() >= 1) {
-            if (m_next_byte.has_value()) {
-                bytes[0] = m_next_byte.value();
-                m_next_byte.clear();
-
-                ++nread;
-            }
+        while (nread < bytes.size() && m_buffered_bytes > 0) {
+            bytes[nread++] = static_cast<u8>(m_bit_buffer);
+            drop_current_byte();
         }
 
         return nread + m_stream.read(bytes.slice(nread));
@@ -47,15 +45,13 @@ public:
         return true;
     }
 
-    bool unreliable_eof() const override { return !m_next_byte.has_value() && m_stream.unreliable_eof(); }
+    bool unreliable_eof() const override { return m_buffered_bytes == 0 && m_stream.unreliable_eof(); }
 
     bool discard_or_error(size_t count) override
     {
-        if (count >= 1) {
-            if (m_next_byte.has_value()) {
-                m_next_byte.clear();
-                --count;
-            }
+        while (count > 0 && m_buffered_bytes > 0) {
+            drop_current_byte();
+            --count;
         }
 
         return m_stream.discard_or_error(count);
@@ -67,61 +63,86 @@ public:
 
         size_t nread = 0;
         while (nread < count) {
-            if (m_stream.has_any_error()) {
-                set_fatal_error();
+            auto const chunk_size = min(count - nread, max_bits_per_peek);
+            if (!fill_bit_buffer(chunk_size))
                 return 0;
-            }
-
-            if (m_next_byte.has_value()) {
-                const auto bit = (m_next_byte.value() >> m_bit_offset) & 1;
-                result |= bit << nread;
-                ++nread;
 
-                if (m_bit_offset++ == 7)
-                    m_next_byte.clear();
-            } else {
-                m_stream >> m_next_byte;
-                m_bit_offset = 0;
-            }
+            result |= buffered_bits(chunk_size) << nread;
+            consume_bits(chunk_size);
+            nread += chunk_size;
         }
 
         return result;
     }
 
+    // Returns the next count bits without consuming them. Unlike read_bits(), this doesn't fail at the end of
+    // the stream, bits past the end are returned as zeroes instead.
+    // NOTE: This reads ahead of the bits that are actually consumed, so any bytes that should be read after
+    //       the bit stream is done have to be read through it as well, not through the underlying stream.
+    u64 peek_bits(size_t count)
+    {
+        VERIFY(count <= max_bits_per_peek);
+
+        while (buffered_bit_count() < count) {
+            u8 byte = 0;
+            if (m_stream.read({ &byte, sizeof(byte) }) == 0)
+                break;
+            append_to_bit_buffer(byte);
+        }
+
+        return buffered_bits(count);
+    }
+
+    // Consumes bits that were previously returned by peek_bits().
+    void discard_previously_peeked_bits(size_t count)
+    {
+        if (count > buffered_bit_count()) {
+            set_fatal_error();
+            return;
+        }
+
+        consume_bits(count);
+    }
+
     u64 read_bits_big_endian(size_t count)
     {
-        u64 result = 0;
+        if (count == 0)
+            return 0;
 
-        size_t nread = 0;
-        while (nread < count) {
-            if (m_stream.has_any_error()) {
-                set_fatal_error();
+        // Reads that are too big to fit into the bit buffer at once are split up.
+        if (count > max_bits_per_big_endian_read) {
+            u64 high_bits = read_bits_big_endian(count - 32);
+            return (high_bits << 32) | read_bits_big_endian(32);
+        }
+
+        if (!fill_bit_buffer(count))
+            return 0;
+
+        auto result = buffered_bits_big_endian() >> (64 - count);
+        consume_bits(count);
+        return result;
+    }
+
+    // Reads a unary coded number (as in the Rice codes of FLAC): the count of zero bits before the next one bit,
+    // which is consumed as well.
+    u32 read_unary_big_endian()
+    {
+        u32 zero_bits = 0;
+        for (;;) {
+            if (!fill_bit_buffer(1))
                 return 0;
-            }
 
-            if (m_next_byte.has_value()) {
-                // read an entire byte
-                if (((count - nread) >= 8) && m_bit_offset == 0) {
-                    // shift existing bytes over
-                    result <<= 8;
-                    result |= m_next_byte.value();
-                    nread += 8;
-                    m_next_byte.clear();
-                } else {
-                    const auto bit = (m_next_byte.value() >> (7 - m_bit_offset)) & 1;
-                    result <<= 1;
-                    result |= bit;
-                    ++nread;
-                    if (m_bit_offset++ == 7)
-                        m_next_byte.clear();
-                }
-            } else {
-                m_stream >> m_next_byte;
-                m_bit_offset = 0;
+            if (auto bits = buffered_bits_big_endian(); bits != 0) {
+                auto leading_zero_bits = count_leading_zeroes(bits);
+                consume_bits(leading_zero_bits + 1);
+                return zero_bits + leading_zero_bits;
             }
-        }
 
-        return result;
+            zero_bits += buffered_bit_count();
+            m_bit_buffer = 0;
+            m_buffered_bytes = 0;
+            m_bit_offset = 0;
+        }
     }
 
     bool read_bit() { return static_cast<bool>(read_bits(1)); }
@@ -130,10 +151,14 @@ public:
 
     void align_to_byte_boundary()
     {
-        if (m_next_byte.has_value())
-            m_next_byte.clear();
+        if (m_bit_offset > 0)
+            drop_current_byte();
     }
 
+    // Lets the bit stream read as many bytes ahead as it can buffer, instead of reading them one at a time when they're needed.
+    // NOTE: Just like with peek_bits(), any bytes that should be read after the bit stream is done have to be read through it.
+    void set_read_ahead(bool read_ahead) { m_read_ahead = read_ahead; }
+
     bool handle_any_error() override
     {
         bool handled_errors = m_stream.handle_any_error();
@@ -141,8 +166,65 @@ public:
     }
 
 private:
-    Optional<u8> m_next_byte;
+    static constexpr size_t max_bits_per_peek = 32;
+    // The bit buffer holds up to 8 bytes, the first of which may already be partially consumed.
+    static constexpr size_t max_bits_per_big_endian_read = 64 - 7;
+
+    size_t buffered_bit_count() const { return m_buffered_bytes * 8 - m_bit_offset; }
+    u64 buffered_bits(size_t count) const { return (m_bit_buffer >> m_bit_offset) & ((1ull << count) - 1); }
+    // The buffered bits in the order a big endian reader sees them, starting at the most significant bit.
+    u64 buffered_bits_big_endian() const { return convert_between_host_and_big_endian(m_bit_buffer) << m_bit_offset; }
+
+    void append_to_bit_buffer(u8 byte)
+    {
+        m_bit_buffer |= static_cast<u64>(byte) << (m_buffered_bytes * 8);
+        ++m_buffered_bytes;
+    }
+
+    bool fill_bit_buffer(size_t count)
+    {
+        if (m_read_ahead && buffered_bit_count() < count) {
+            u8 bytes[sizeof(m_bit_buffer)];
+            auto nread = m_stream.read({ bytes, sizeof(m_bit_buffer) - m_buffered_bytes });
+            for (size_t i = 0; i < nread; ++i)
+                append_to_bit_buffer(bytes[i]);
+        }
+
+        while (buffered_bit_count() < count) {
+            u8 byte = 0;
+            m_stream >> byte;
+            if (m_stream.has_any_error()) {
+                set_fatal_error();
+                return false;
+            }
+            append_to_bit_buffer(byte);
+        }
+
+        return true;
+    }
+
+    void consume_bits(size_t count)
+    {
+        m_bit_offset += count;
+        auto const consumed_bytes = m_bit_offset / 8;
+        // NOTE: Shifting a u64 by 64 bits is undefined.
+        m_bit_buffer = consumed_bytes < sizeof(m_bit_buffer) ? m_bit_buffer >> (consumed_bytes * 8) : 0;
+        m_buffered_bytes -= consumed_bytes;
+        m_bit_offset %= 8;
+    }
+
+    void drop_current_byte()
+    {
+        m_bit_buffer >>= 8;
+        --m_buffered_bytes;
+        m_bit_offset = 0;
+    }
+
+    // Bytes that were read from the underlying stream but not fully consumed yet, the current one is in the lowest 8 bits.
+    u64 m_bit_buffer { 0 };
+    size_t m_buffered_bytes { 0 };
     size_t m_bit_offset { 0 };
+    bool m_read_ahead { false };
     InputStream& m_stream;
 };
 
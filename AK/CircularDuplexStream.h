@@ -69,6 +69,36 @@ public:
         return nread;
     }
 
+    // Appends count bytes, starting seekback bytes behind the end of the stream. If seekback is less than count,
+    // the bytes that are being appended are repeated, just as if they were copied one at a time.
+    bool copy_from_seekback(size_t seekback, size_t count)
+    {
+        if (seekback == 0 || seekback > Capacity || seekback > m_total_written || count > Capacity - m_queue.size()) {
+            set_recoverable_error();
+            return false;
+        }
+
+        // Once the first seekback bytes have been copied, the source repeats with a longer period that
+        // is still a multiple of seekback, which allows copying larger chunks at once.
+        auto distance = seekback;
+        size_t ncopied = 0;
+        while (ncopied < count) {
+            const auto source_index = (m_total_written - distance) % Capacity;
+            const auto destination_index = (m_queue.head_index() + m_queue.size()) % Capacity;
+            const auto chunk_size = min(min(count - ncopied, distance), min(Capacity - source_index, Capacity - destination_index));
+
+            // NOTE: The ranges can only overlap with the source after the destination, or when distance is equal to Capacity.
+            __builtin_memmove(m_queue.m_storage + destination_index, m_queue.m_storage + source_index, chunk_size);
+
+            m_queue.m_size += chunk_size;
+            m_total_written += chunk_size;
+            ncopied += chunk_size;
+            distance = min(ncopied + seekback, Capacity) / seekback * seekback;
+        }
+
+        return true;
+    }
+
     bool read_or_error(Bytes bytes) override
     {
         if (m_queue.size() < bytes.size()) {
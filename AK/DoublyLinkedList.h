@@ -173,6 +173,29 @@ public:
         delete node;
     }
 
+    template<typename U>
+    void insert_before(Iterator it, U&& value)
+    {
+        static_assert(
+            requires { T(value); }, "Conversion operator is missing.");
+        if (it.is_end()) {
+            append(forward<U>(value));
+            return;
+        }
+        auto* node = new Node(forward<U>(value));
+        auto* next = it.m_node;
+        node->next = next;
+        node->prev = next->prev;
+        if (next->prev) {
+            VERIFY(next != m_head);
+            next->prev->next = node;
+        } else {
+            VERIFY(next == m_head);
+            m_head = node;
+        }
+        next->prev = node;
+    }
+
 private:
     Node* m_head { nullptr };
     Node* m_tail { nullptr };
@@ -55,15 +55,16 @@ FlyString::FlyString(const String& string)
     }
 }
 
-FlyString::FlyString(StringView string)
+FlyString::FlyString(StringView string, u32 hash)
 {
     if (string.is_null())
         return;
-    auto it = fly_impls().find(string.hash(), [&](auto& candidate) {
+    auto it = fly_impls().find(hash, [&](auto& candidate) {
         return string == candidate;
     });
     if (it == fly_impls().end()) {
         auto new_string = string.to_string();
+        new_string.impl()->set_hash({}, hash);
         fly_impls().set(new_string.impl());
         new_string.impl()->set_fly({}, true);
         m_impl = new_string.impl();
@@ -134,7 +135,9 @@ bool FlyString::operator==(const String& other) const
 
 bool FlyString::operator==(StringView string) const
 {
-    return *this == String(string);
+    if (is_null())
+        return string.is_null();
+    return view() == string;
 }
 
 bool FlyString::operator==(const char* string) const
@@ -23,12 +23,31 @@ public:
     {
     }
     FlyString(const String&);
-    FlyString(StringView);
+    FlyString(StringView string)
+        : FlyString(string, string.is_null() ? 0 : string.hash())
+    {
+    }
     FlyString(const char* string)
-        : FlyString(static_cast<String>(string))
+        : FlyString(StringView { string })
     {
     }
 
+    // A string literal along with its hash, which is worked out at compile time.
+    struct Literal {
+        template<size_t N>
+        consteval Literal(char const (&literal)[N])
+            : view(literal, N - 1)
+            , hash(string_hash(literal, N - 1))
+        {
+        }
+
+        StringView view;
+        u32 hash;
+    };
+
+    // Interns a string literal without hashing it at runtime, e.g. FlyString::from_literal("div").
+    static FlyString from_literal(Literal literal) { return FlyString(literal.view, literal.hash); }
+
     static FlyString from_fly_impl(NonnullRefPtr<StringImpl> impl)
     {
         VERIFY(impl->is_fly());
@@ -91,6 +110,8 @@ public:
     }
 
 private:
+    FlyString(StringView, u32 hash);
+
     RefPtr<StringImpl> m_impl;
 };
 
@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/BuiltinWrappers.h>
 #include <AK/CharacterTypes.h>
 #include <AK/Format.h>
 #include <AK/GenericLexer.h>
@@ -47,54 +48,78 @@ static constexpr size_t use_next_index = NumericLimits<size_t>::max();
 
 // The worst case is that we have the largest 64-bit value formatted as binary number, this would take
 // 65 bytes. Choosing a larger power of two won't hurt and is a bit of mitigation against out-of-bounds accesses.
-static constexpr size_t convert_unsigned_to_string(u64 value, Array<u8, 128>& buffer, u8 base, bool upper_case)
+// The digits are written to the end of the buffer; the returned view points at them.
+static StringView convert_unsigned_to_string(u64 value, Array<u8, 128>& buffer, u8 base, bool upper_case)
 {
     VERIFY(base >= 2 && base <= 16);
 
     constexpr const char* lowercase_lookup = "0123456789abcdef";
     constexpr const char* uppercase_lookup = "0123456789ABCDEF";
-
-    if (value == 0) {
-        buffer[0] = '0';
-        return 1;
-    }
-
-    size_t used = 0;
-    while (value > 0) {
-        if (upper_case)
-            buffer[used++] = uppercase_lookup[value % base];
-        else
-            buffer[used++] = lowercase_lookup[value % base];
-
-        value /= base;
+    constexpr const char* two_digit_lookup = "00010203040506070809"
+                                             "10111213141516171819"
+                                             "20212223242526272829"
+                                             "30313233343536373839"
+                                             "40414243444546474849"
+                                             "50515253545556575859"
+                                             "60616263646566676869"
+                                             "70717273747576777879"
+                                             "80818283848586878889"
+                                             "90919293949596979899";
+
+    size_t position = buffer.size();
+
+    if (base == 10) {
+        // Dividing by a constant is much cheaper than by a variable base, and doing two digits per step halves the divisions.
+        while (value >= 100) {
+            auto two_digits = value % 100;
+            value /= 100;
+            buffer[--position] = two_digit_lookup[two_digits * 2 + 1];
+            buffer[--position] = two_digit_lookup[two_digits * 2];
+        }
+        if (value >= 10) {
+            buffer[--position] = two_digit_lookup[value * 2 + 1];
+            buffer[--position] = two_digit_lookup[value * 2];
+        } else {
+            buffer[--position] = '0' + value;
+        }
+    } else if ((base & (base - 1)) == 0) {
+        auto const* lookup = upper_case ? uppercase_lookup : lowercase_lookup;
+        auto bits_per_digit = count_trailing_zeroes(base);
+        do {
+            buffer[--position] = lookup[value & (base - 1)];
+            value >>= bits_per_digit;
+        } while (value > 0);
+    } else {
+        auto const* lookup = upper_case ? uppercase_lookup : lowercase_lookup;
+        do {
+            buffer[--position] = lookup[value % base];
+            value /= base;
+        } while (value > 0);
     }
 
-    for (size_t i = 0; i < used / 2; ++i)
-        swap(buffer[i], buffer[used - i - 1]);
-
-    return used;
+    return { buffer.data() + position, buffer.size() - position };
 }
 
 ErrorOr<void> vformat_impl(TypeErasedFormatParams& params, FormatBuilder& builder, FormatParser& parser)
 {
-    const auto literal = parser.consume_literal();
-    TRY(builder.put_literal(literal));
-
-    FormatParser::FormatSpecifier specifier;
-    if (!parser.consume_specifier(specifier)) {
-        VERIFY(parser.is_eof());
-        return {};
-    }
+    for (;;) {
+        const auto literal = parser.consume_literal();
+        TRY(builder.put_literal(literal));
+
+        FormatParser::FormatSpecifier specifier;
+        if (!parser.consume_specifier(specifier)) {
+            VERIFY(parser.is_eof());
+            return {};
+        }
 
-    if (specifier.index == use_next_index)
-        specifier.index = params.take_next_index();
+        if (specifier.index == use_next_index)
+            specifier.index = params.take_next_index();
 
-    auto& parameter = params.parameters().at(specifier.index);
+        auto& parameter = params.parameters().at(specifier.index);
 
-    FormatParser argparser { specifier.flags };
-    TRY(parameter.formatter(params, builder, argparser, parameter.value));
-    TRY(vformat_impl(params, builder, parser));
-    return {};
+        FormatParser argparser { specifier.flags };
+        TRY(parameter.formatter(params, builder, argparser, parameter.value));
+    }
 }
 
 } // namespace AK::{anonymous}
@@ -108,16 +133,16 @@ StringView FormatParser::consume_literal()
     const auto begin = tell();
 
     while (!is_eof()) {
-        if (consume_specific("{{"))
-            continue;
-
-        if (consume_specific("}}"))
+        auto ch = peek();
+        if (ch != '{' && ch != '}') {
+            ignore();
             continue;
+        }
 
-        if (next_is(is_any_of("{}")))
+        // Escaped braces are part of the literal, and put_literal() takes care of collapsing them.
+        if (peek(1) != ch)
             return m_input.substring_view(begin, tell() - begin);
-
-        consume();
+        ignore(2);
     }
 
     return m_input.substring_view(begin);
@@ -191,17 +216,27 @@ bool FormatParser::consume_replacement_field(size_t& index)
 
 ErrorOr<void> FormatBuilder::put_padding(char fill, size_t amount)
 {
-    for (size_t i = 0; i < amount; ++i)
-        TRY(m_builder.try_append(fill));
+    char padding[64];
+    __builtin_memset(padding, fill, min(amount, sizeof(padding)));
+    while (amount > 0) {
+        auto chunk = min(amount, sizeof(padding));
+        TRY(m_builder.try_append(padding, chunk));
+        amount -= chunk;
+    }
     return {};
 }
 ErrorOr<void> FormatBuilder::put_literal(StringView value)
 {
+    // Braces in a literal are always doubled, so append everything up to and including a brace in one go, then skip its twin.
+    size_t run_start = 0;
     for (size_t i = 0; i < value.length(); ++i) {
-        TRY(m_builder.try_append(value[i]));
-        if (value[i] == '{' || value[i] == '}')
-            ++i;
+        if (value[i] != '{' && value[i] != '}')
+            continue;
+        TRY(m_builder.try_append(value.substring_view(run_start, i + 1 - run_start)));
+        run_start = ++i + 1;
     }
+    if (run_start < value.length())
+        TRY(m_builder.try_append(value.substring_view(run_start)));
     return {};
 }
 
@@ -252,7 +287,8 @@ ErrorOr<void> FormatBuilder::put_u64(
 
     Array<u8, 128> buffer;
 
-    const auto used_by_digits = convert_unsigned_to_string(value, buffer, base, upper_case);
+    const auto digits = convert_unsigned_to_string(value, buffer, base, upper_case);
+    const auto used_by_digits = digits.length();
 
     size_t used_by_prefix = 0;
     if (align == Align::Right && zero_pad) {
@@ -303,9 +339,7 @@ ErrorOr<void> FormatBuilder::put_u64(
     };
 
     const auto put_digits = [&]() -> ErrorOr<void> {
-        for (size_t i = 0; i < used_by_digits; ++i)
-            TRY(m_builder.try_append(buffer[i]));
-        return {};
+        return m_builder.try_append(digits);
     };
 
     if (align == Align::Left) {
@@ -528,6 +562,10 @@ ErrorOr<void> vformat(StringBuilder& builder, StringView fmtstr, TypeErasedForma
 
 void StandardFormatter::parse(TypeErasedFormatParams& params, FormatParser& parser)
 {
+    // Most replacement fields are a plain "{}", so don't bother checking for every possible flag.
+    if (parser.is_eof())
+        return;
+
     if (StringView { "<^>" }.contains(parser.peek(1))) {
         VERIFY(!parser.next_is(is_any_of("{}")));
         m_fill = parser.consume();
@@ -6,10 +6,13 @@
 
 #pragma once
 
+#include <AK/BitCast.h>
+#include <AK/BuiltinWrappers.h>
 #include <AK/Concepts.h>
 #include <AK/Error.h>
 #include <AK/Forward.h>
 #include <AK/HashFunctions.h>
+#include <AK/SIMD.h>
 #include <AK/StdLibExtras.h>
 #include <AK/Traits.h>
 #include <AK/Types.h>
@@ -28,6 +31,65 @@ enum class HashSetExistingEntryBehavior {
     Replace
 };
 
+namespace Detail {
+
+// Every slot in a HashTable has a control byte, stored apart from the slots themselves.
+// Full slots keep the low 7 bits of their hash in it, so a lookup can rule out most
+// non-matching slots without ever touching them.
+static constexpr u8 hash_table_control_empty = 0x80;
+static constexpr u8 hash_table_control_deleted = 0xfe;
+static constexpr u8 hash_table_control_sentinel = 0xff;
+
+static constexpr bool hash_table_control_is_full(u8 control) { return control < 0x80; }
+
+// Control bytes are probed a group at a time. The match functions return a bitmask with
+// one bit per slot in the group, lowest slot first.
+#ifdef __SSE2__
+class HashTableControlGroup {
+public:
+    static constexpr size_t size = 16;
+
+    explicit HashTableControlGroup(u8 const* control) { __builtin_memcpy(&m_control, control, size); }
+
+    u32 match(u8 control) const { return mask_of(m_control == control); }
+    u32 match_empty() const { return match(hash_table_control_empty); }
+    u32 match_empty_or_deleted() const { return mask_of(m_control); }
+
+private:
+    template<typename VectorType>
+    static u32 mask_of(VectorType vector) { return __builtin_ia32_pmovmskb128(bit_cast<SIMD::c8x16>(vector)); }
+
+    SIMD::u8x16 m_control;
+};
+#else
+// Without SSE2 (notably in the kernel, which is built without it), we do the same thing
+// on 8 control bytes packed into a 64-bit word.
+class HashTableControlGroup {
+public:
+    static constexpr size_t size = 8;
+
+    explicit HashTableControlGroup(u8 const* control) { __builtin_memcpy(&m_control, control, size); }
+
+    u32 match(u8 control) const
+    {
+        u64 difference = m_control ^ (0x0101010101010101ull * control);
+        // Sets the high bit of exactly those bytes in `difference` that are zero.
+        u64 zero_bytes = ~(((difference & 0x7f7f7f7f7f7f7f7full) + 0x7f7f7f7f7f7f7f7full) | difference) & 0x8080808080808080ull;
+        return mask_of(zero_bytes);
+    }
+    u32 match_empty() const { return match(hash_table_control_empty); }
+    u32 match_empty_or_deleted() const { return mask_of(m_control & 0x8080808080808080ull); }
+
+private:
+    // Gathers the high bit of every byte into the low 8 bits.
+    static u32 mask_of(u64 high_bits) { return ((high_bits >> 7) * 0x0102040810204080ull) >> 56; }
+
+    u64 m_control;
+};
+#endif
+
+}
+
 template<typename HashTableType, typename T, typename BucketType>
 class HashTableIterator {
     friend HashTableType;
@@ -46,19 +108,21 @@ private:
             return;
         do {
             ++m_bucket;
-            if (m_bucket->used)
+            ++m_control;
+            if (Detail::hash_table_control_is_full(*m_control))
                 return;
-        } while (!m_bucket->end);
-        if (m_bucket->end)
-            m_bucket = nullptr;
+        } while (*m_control != Detail::hash_table_control_sentinel);
+        m_bucket = nullptr;
     }
 
-    explicit HashTableIterator(BucketType* bucket)
+    HashTableIterator(BucketType* bucket, u8 const* control)
         : m_bucket(bucket)
+        , m_control(control)
     {
     }
 
     BucketType* m_bucket { nullptr };
+    u8 const* m_control { nullptr };
 };
 
 template<typename OrderedHashTableType, typename T, typename BucketType>
@@ -84,12 +148,11 @@ private:
 
 template<typename T, typename TraitsForT, bool IsOrdered>
 class HashTable {
-    static constexpr size_t load_factor_in_percent = 60;
+    static constexpr size_t load_factor_in_percent = 87;
+
+    using ControlGroup = Detail::HashTableControlGroup;
 
     struct Bucket {
-        bool used;
-        bool deleted;
-        bool end;
         alignas(T) u8 storage[sizeof(T)];
 
         T* slot() { return reinterpret_cast<T*>(storage); }
@@ -99,8 +162,6 @@ class HashTable {
     struct OrderedBucket {
         OrderedBucket* previous;
         OrderedBucket* next;
-        bool used;
-        bool deleted;
         alignas(T) u8 storage[sizeof(T)];
         T* slot() { return reinterpret_cast<T*>(storage); }
         const T* slot() const { return reinterpret_cast<const T*>(storage); }
@@ -127,9 +188,11 @@ public:
         if (!m_buckets)
             return;
 
-        for (size_t i = 0; i < m_capacity; ++i) {
-            if (m_buckets[i].used)
-                m_buckets[i].slot()->~T();
+        if constexpr (!Detail::IsTriviallyDestructible<T>) {
+            for (size_t i = 0; i < m_capacity; ++i) {
+                if (Detail::hash_table_control_is_full(control()[i]))
+                    m_buckets[i].slot()->~T();
+            }
         }
 
         kfree_sized(m_buckets, size_in_bytes(m_capacity));
@@ -199,10 +262,14 @@ public:
         MUST(try_set_from(from_array));
     }
 
-    void ensure_capacity(size_t capacity)
+    ErrorOr<void> try_ensure_capacity(size_t capacity)
     {
         VERIFY(capacity >= size());
-        rehash(capacity * 2);
+        return try_rehash(capacity_for_size(capacity));
+    }
+    void ensure_capacity(size_t capacity)
+    {
+        MUST(try_ensure_capacity(capacity));
     }
 
     [[nodiscard]] bool contains(T const& value) const
@@ -222,19 +289,12 @@ public:
 
     [[nodiscard]] Iterator begin()
     {
-        if constexpr (IsOrdered)
-            return Iterator(m_collection_data.head);
-
-        for (size_t i = 0; i < m_capacity; ++i) {
-            if (m_buckets[i].used)
-                return Iterator(&m_buckets[i]);
-        }
-        return end();
+        return make_iterator<Iterator>(first_bucket());
     }
 
     [[nodiscard]] Iterator end()
     {
-        return Iterator(nullptr);
+        return make_iterator<Iterator>(nullptr);
     }
 
     using ConstIterator = Conditional<IsOrdered,
@@ -243,19 +303,12 @@ public:
 
     [[nodiscard]] ConstIterator begin() const
     {
-        if constexpr (IsOrdered)
-            return ConstIterator(m_collection_data.head);
-
-        for (size_t i = 0; i < m_capacity; ++i) {
-            if (m_buckets[i].used)
-                return ConstIterator(&m_buckets[i]);
-        }
-        return end();
+        return make_iterator<ConstIterator>(first_bucket());
     }
 
     [[nodiscard]] ConstIterator end() const
     {
-        return ConstIterator(nullptr);
+        return make_iterator<ConstIterator>(nullptr);
     }
 
     void clear()
@@ -265,46 +318,39 @@ public:
     void clear_with_capacity()
     {
         if constexpr (!Detail::IsTriviallyDestructible<T>) {
-            for (auto* bucket : *this)
-                bucket->~T();
+            for (auto& value : *this)
+                value.~T();
         }
-        __builtin_memset(m_buckets, 0, size_in_bytes(capacity()));
+        if (m_buckets)
+            __builtin_memset(control(), Detail::hash_table_control_empty, m_capacity);
         m_size = 0;
         m_deleted_count = 0;
 
         if constexpr (IsOrdered)
             m_collection_data = { nullptr, nullptr };
-        else
-            m_buckets[m_capacity].end = true;
     }
 
     template<typename U = T>
     ErrorOr<HashSetResult> try_set(U&& value, HashSetExistingEntryBehavior existing_entry_behavior = HashSetExistingEntryBehavior::Replace)
     {
-        auto* bucket = TRY(try_lookup_for_writing(value));
-        if (bucket->used) {
+        auto hash = TraitsForT::hash(value);
+        auto* bucket = TRY(try_lookup_for_writing(hash, value));
+        auto& bucket_control = control_for(*bucket);
+        if (Detail::hash_table_control_is_full(bucket_control)) {
             if (existing_entry_behavior == HashSetExistingEntryBehavior::Keep)
                 return HashSetResult::KeptExistingEntry;
             (*bucket->slot()) = forward<U>(value);
             return HashSetResult::ReplacedExistingEntry;
         }
 
-        new (bucket->slot()) T(forward<U>(value));
-        bucket->used = true;
-        if (bucket->deleted) {
-            bucket->deleted = false;
+        if (bucket_control == Detail::hash_table_control_deleted)
             --m_deleted_count;
-        }
 
-        if constexpr (IsOrdered) {
-            if (!m_collection_data.head) [[unlikely]] {
-                m_collection_data.head = bucket;
-            } else {
-                bucket->previous = m_collection_data.tail;
-                m_collection_data.tail->next = bucket;
-            }
-            m_collection_data.tail = bucket;
-        }
+        new (bucket->slot()) T(forward<U>(value));
+        bucket_control = control_byte_for_hash(hash);
+
+        if constexpr (IsOrdered)
+            append_to_order(*bucket);
 
         ++m_size;
         return HashSetResult::InsertedNewEntry;
@@ -318,7 +364,7 @@ public:
     template<typename TUnaryPredicate>
     [[nodiscard]] Iterator find(unsigned hash, TUnaryPredicate predicate)
     {
-        return Iterator(lookup_with_hash(hash, move(predicate)));
+        return make_iterator<Iterator>(lookup_with_hash(hash, move(predicate)));
     }
 
     [[nodiscard]] Iterator find(T const& value)
@@ -329,9 +375,8 @@ public:
     template<typename TUnaryPredicate>
     [[nodiscard]] ConstIterator find(unsigned hash, TUnaryPredicate predicate) const
     {
-        return ConstIterator(lookup_with_hash(hash, move(predicate)));
+        return make_iterator<ConstIterator>(lookup_with_hash(hash, move(predicate)));
     }
-
     [[nodiscard]] ConstIterator find(T const& value) const
     {
         return find(TraitsForT::hash(value), [&](auto& other) { return TraitsForT::equals(value, other); });
@@ -388,20 +433,25 @@ public:
     {
         VERIFY(iterator.m_bucket);
         auto& bucket = *iterator.m_bucket;
-        VERIFY(bucket.used);
-        VERIFY(!bucket.deleted);
-
-        if constexpr (!IsOrdered)
-            VERIFY(!bucket.end);
+        auto& bucket_control = control_for(bucket);
+        VERIFY(Detail::hash_table_control_is_full(bucket_control));
 
         auto next_iterator = iterator;
         ++next_iterator;
 
         bucket.slot()->~T();
-        bucket.used = false;
-        bucket.deleted = true;
         --m_size;
-        ++m_deleted_count;
+
+        // A lookup only moves on to the next group if the current one is completely full,
+        // so if this group still has an empty slot, nobody can be relying on this one being occupied.
+        size_t index = &bucket - m_buckets;
+        ControlGroup group { &control()[index - index % ControlGroup::size] };
+        if (group.match_empty()) {
+            bucket_control = Detail::hash_table_control_empty;
+        } else {
+            bucket_control = Detail::hash_table_control_deleted;
+            ++m_deleted_count;
+        }
 
         if constexpr (IsOrdered) {
             if (bucket.previous)
@@ -434,36 +484,94 @@ public:
     }
 
 private:
-    void insert_during_rehash(T&& value)
+    // The slots are followed by one control byte per slot, and a sentinel control byte that stops iteration.
+    [[nodiscard]] u8* control() const { return reinterpret_cast<u8*>(m_buckets + m_capacity); }
+    [[nodiscard]] u8& control_for(BucketType const& bucket) const { return control()[&bucket - m_buckets]; }
+
+    [[nodiscard]] static constexpr u8 control_byte_for_hash(unsigned hash) { return hash & 0x7f; }
+
+    [[nodiscard]] size_t first_group_start_for_hash(unsigned hash) const
     {
-        auto& bucket = lookup_for_writing(value);
-        new (bucket.slot()) T(move(value));
-        bucket.used = true;
+        // Mix all bits of the hash into the top ones, then scale those onto the number of groups.
+        u32 mixed = hash * 2654435769u;
+        size_t group_count = m_capacity / ControlGroup::size;
+        return ((static_cast<u64>(mixed) * group_count) >> 32) * ControlGroup::size;
+    }
+    [[nodiscard]] size_t next_group_start(size_t group_start) const
+    {
+        group_start += ControlGroup::size;
+        return group_start == m_capacity ? 0 : group_start;
+    }
 
+    [[nodiscard]] BucketType* first_bucket() const
+    {
         if constexpr (IsOrdered) {
-            if (!m_collection_data.head) [[unlikely]] {
-                m_collection_data.head = &bucket;
-            } else {
-                bucket.previous = m_collection_data.tail;
-                m_collection_data.tail->next = &bucket;
+            return m_collection_data.head;
+        } else {
+            for (size_t i = 0; i < m_capacity; ++i) {
+                if (Detail::hash_table_control_is_full(control()[i]))
+                    return &m_buckets[i];
             }
-            m_collection_data.tail = &bucket;
+            return nullptr;
         }
     }
 
-    [[nodiscard]] static constexpr size_t size_in_bytes(size_t capacity)
+    template<typename IteratorType>
+    [[nodiscard]] IteratorType make_iterator(BucketType* bucket) const
     {
-        if constexpr (IsOrdered) {
-            return sizeof(BucketType) * capacity;
-        } else {
-            return sizeof(BucketType) * (capacity + 1);
+        if constexpr (IsOrdered)
+            return IteratorType(bucket);
+        else
+            return IteratorType(bucket, bucket ? &control_for(*bucket) : nullptr);
+    }
+
+    void append_to_order(BucketType& bucket)
+    {
+        bucket.previous = m_collection_data.tail;
+        bucket.next = nullptr;
+        if (!m_collection_data.head) [[unlikely]]
+            m_collection_data.head = &bucket;
+        else
+            m_collection_data.tail->next = &bucket;
+        m_collection_data.tail = &bucket;
+    }
+
+    void insert_during_rehash(T&& value)
+    {
+        // There are no deleted slots or equal values yet, so we can take the first free slot without comparing anything.
+        auto hash = TraitsForT::hash(value);
+        for (auto group_start = first_group_start_for_hash(hash);; group_start = next_group_start(group_start)) {
+            auto free_slots = ControlGroup { &control()[group_start] }.match_empty_or_deleted();
+            if (!free_slots)
+                continue;
+
+            size_t index = group_start + count_trailing_zeroes(free_slots);
+            auto& bucket = m_buckets[index];
+            new (bucket.slot()) T(move(value));
+            control()[index] = control_byte_for_hash(hash);
+
+            if constexpr (IsOrdered)
+                append_to_order(bucket);
+            return;
         }
     }
 
+    [[nodiscard]] static constexpr size_t size_in_bytes(size_t capacity)
+    {
+        return (sizeof(BucketType) + 1) * capacity + 1;
+    }
+
+    [[nodiscard]] static constexpr size_t capacity_for_size(size_t size)
+    {
+        return size * 100 / load_factor_in_percent + 1;
+    }
+
     ErrorOr<void> try_rehash(size_t new_capacity)
     {
-        new_capacity = max(new_capacity, static_cast<size_t>(4));
-        new_capacity = kmalloc_good_size(new_capacity * sizeof(BucketType)) / sizeof(BucketType);
+        new_capacity = max(new_capacity, ControlGroup::size);
+        new_capacity = (new_capacity + ControlGroup::size - 1) / ControlGroup::size * ControlGroup::size;
+        new_capacity = (kmalloc_good_size(size_in_bytes(new_capacity)) - 1) / (sizeof(BucketType) + 1);
+        new_capacity -= new_capacity % ControlGroup::size;
 
         auto* old_buckets = m_buckets;
         auto old_capacity = m_capacity;
@@ -474,15 +582,14 @@ private:
             return Error::from_errno(ENOMEM);
 
         m_buckets = (BucketType*)new_buckets;
-        __builtin_memset(m_buckets, 0, size_in_bytes(new_capacity));
-
         m_capacity = new_capacity;
         m_deleted_count = 0;
 
+        __builtin_memset(control(), Detail::hash_table_control_empty, m_capacity);
+        control()[m_capacity] = Detail::hash_table_control_sentinel;
+
         if constexpr (IsOrdered)
             m_collection_data = { nullptr, nullptr };
-        else
-            m_buckets[m_capacity].end = true;
 
         if (!old_buckets)
             return {};
@@ -506,49 +613,49 @@ private:
         if (is_empty())
             return nullptr;
 
-        for (;;) {
-            auto& bucket = m_buckets[hash % m_capacity];
-
-            if (bucket.used && predicate(*bucket.slot()))
-                return &bucket;
+        auto control_byte = control_byte_for_hash(hash);
+        for (auto group_start = first_group_start_for_hash(hash);; group_start = next_group_start(group_start)) {
+            ControlGroup group { &control()[group_start] };
+            for (auto matches = group.match(control_byte); matches; matches &= matches - 1) {
+                auto& bucket = m_buckets[group_start + count_trailing_zeroes(matches)];
+                if (predicate(*bucket.slot()))
+                    return &bucket;
+            }
 
-            if (!bucket.used && !bucket.deleted)
+            if (group.match_empty())
                 return nullptr;
-
-            hash = double_hash(hash);
         }
     }
 
-    ErrorOr<BucketType*> try_lookup_for_writing(T const& value)
+    ErrorOr<BucketType*> try_lookup_for_writing(unsigned hash, T const& value)
     {
         // FIXME: Maybe overrun the "allowed" load factor to avoid OOM
         //        If we are allowed to do that, separate that logic from
         //        the normal lookup_for_writing
-        if (should_grow())
-            TRY(try_rehash(capacity() * 2));
-        auto hash = TraitsForT::hash(value);
-        BucketType* first_empty_bucket = nullptr;
-        for (;;) {
-            auto& bucket = m_buckets[hash % m_capacity];
-
-            if (bucket.used && TraitsForT::equals(*bucket.slot(), value))
-                return &bucket;
+        if (should_grow()) {
+            // If most of the used slots are tombstones, clearing them out is enough.
+            TRY(try_rehash(m_deleted_count >= m_size ? capacity() : capacity() * 2));
+        }
 
-            if (!bucket.used) {
-                if (!first_empty_bucket)
-                    first_empty_bucket = &bucket;
+        auto control_byte = control_byte_for_hash(hash);
+        BucketType* first_free_bucket = nullptr;
+        for (auto group_start = first_group_start_for_hash(hash);; group_start = next_group_start(group_start)) {
+            ControlGroup group { &control()[group_start] };
+            for (auto matches = group.match(control_byte); matches; matches &= matches - 1) {
+                auto& bucket = m_buckets[group_start + count_trailing_zeroes(matches)];
+                if (TraitsForT::equals(*bucket.slot(), value))
+                    return &bucket;
+            }
 
-                if (!bucket.deleted)
-                    return const_cast<BucketType*>(first_empty_bucket);
+            if (!first_free_bucket) {
+                if (auto free_slots = group.match_empty_or_deleted())
+                    first_free_bucket = &m_buckets[group_start + count_trailing_zeroes(free_slots)];
             }
 
-            hash = double_hash(hash);
+            if (group.match_empty())
+                return first_free_bucket;
         }
     }
-    [[nodiscard]] BucketType& lookup_for_writing(T const& value)
-    {
-        return *MUST(try_lookup_for_writing(value));
-    }
 
     [[nodiscard]] size_t used_bucket_count() const { return m_size + m_deleted_count; }
     [[nodiscard]] bool should_grow() const { return ((used_bucket_count() + 1) * 100) >= (m_capacity * load_factor_in_percent); }
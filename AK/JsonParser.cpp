@@ -185,20 +185,26 @@ ErrorOr<JsonValue> JsonParser::parse_string()
 }
 
 ErrorOr<JsonValue> JsonParser::parse_number()
+{
+    size_t start = m_index;
+    while (next_is('-') || next_is('.') || is_ascii_digit(peek()))
+        ++m_index;
+    return parse_number(m_input.substring_view(start, m_index - start));
+}
+
+ErrorOr<JsonValue> JsonParser::parse_number(StringView input)
 {
     JsonValue value;
     Vector<char, 128> number_buffer;
     Vector<char, 128> fraction_buffer;
 
     bool is_double = false;
-    for (;;) {
-        char ch = peek();
+    for (char ch : input) {
         if (ch == '.') {
             if (is_double)
                 return Error::from_string_literal("JsonParser: Multiple '.' in number"sv);
 
             is_double = true;
-            ++m_index;
             continue;
         }
         if (ch == '-' || (ch >= '0' && ch <= '9')) {
@@ -220,10 +226,9 @@ ErrorOr<JsonValue> JsonParser::parse_number()
 
                 number_buffer.append(ch);
             }
-            ++m_index;
             continue;
         }
-        break;
+        return Error::from_string_literal("JsonParser: Error while parsing number"sv);
     }
 
     StringView number_string(number_buffer.data(), number_buffer.size());
@@ -20,6 +20,9 @@ public:
 
     ErrorOr<JsonValue> parse();
 
+    // Turns the text of a number (as found in JSON) into a JsonValue, using the same rules as parse().
+    static ErrorOr<JsonValue> parse_number(StringView);
+
 private:
     ErrorOr<JsonValue> parse_helper();
 
@@ -0,0 +1,300 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/CharacterTypes.h>
+#include <AK/JsonParser.h>
+#include <AK/JsonStreamParser.h>
+#include <AK/StringUtils.h>
+
+namespace AK {
+
+static constexpr size_t read_chunk_size = 4096;
+
+static constexpr bool is_space(char ch)
+{
+    return ch == '\t' || ch == '\n' || ch == '\r' || ch == ' ';
+}
+
+ErrorOr<bool> JsonStreamParser::read_more()
+{
+    if (!m_stream)
+        return false;
+
+    // Everything before the current position has already been handed to the visitor, so we can drop it.
+    if (m_position > 0) {
+        auto remaining = m_buffer.size() - m_position;
+        __builtin_memmove(m_buffer.data(), m_buffer.data() + m_position, remaining);
+        m_buffer.resize(remaining);
+        m_position = 0;
+    }
+
+    auto old_size = m_buffer.size();
+    TRY(m_buffer.try_resize(old_size + read_chunk_size));
+    auto nread = m_stream->read(m_buffer.bytes().slice(old_size));
+    m_buffer.resize(old_size + nread);
+
+    if (m_stream->handle_any_error())
+        return Error::from_string_literal("JsonStreamParser: Error while reading input"sv);
+    return nread > 0;
+}
+
+ErrorOr<bool> JsonStreamParser::ensure_available(size_t count)
+{
+    while (data().size() - m_position < count) {
+        if (!TRY(read_more()))
+            return false;
+    }
+    return true;
+}
+
+ErrorOr<char> JsonStreamParser::peek()
+{
+    if (!TRY(ensure_available(1)))
+        return Error::from_string_literal("JsonStreamParser: Unexpected end of input"sv);
+    return static_cast<char>(data()[m_position]);
+}
+
+ErrorOr<bool> JsonStreamParser::is_eof()
+{
+    return !TRY(ensure_available(1));
+}
+
+ErrorOr<void> JsonStreamParser::skip_whitespace()
+{
+    while (TRY(ensure_available(1)) && is_space(data()[m_position]))
+        ++m_position;
+    return {};
+}
+
+ErrorOr<void> JsonStreamParser::consume_specific(char expected, StringView error_message)
+{
+    if (TRY(peek()) != expected)
+        return Error::from_string_literal(error_message);
+    ++m_position;
+    return {};
+}
+
+ErrorOr<void> JsonStreamParser::consume_specific(StringView expected, StringView error_message)
+{
+    if (!TRY(ensure_available(expected.length())))
+        return Error::from_string_literal(error_message);
+    if (StringView { data().slice(m_position, expected.length()) } != expected)
+        return Error::from_string_literal(error_message);
+    m_position += expected.length();
+    return {};
+}
+
+ErrorOr<StringView> JsonStreamParser::parse_string()
+{
+    TRY(consume_specific('"', "JsonStreamParser: Expected '\"'"sv));
+
+    // Strings without escape sequences are returned as they are in the input.
+    size_t length = 0;
+    for (;;) {
+        auto available = data().size() - m_position;
+        for (; length < available; ++length) {
+            char ch = data()[m_position + length];
+            if (ch == '"') {
+                StringView string { data().slice(m_position, length) };
+                m_position += length + 1;
+                return string;
+            }
+            if (ch == '\\')
+                return unescape_string(length);
+            if (is_ascii_c0_control(ch))
+                return Error::from_string_literal("JsonStreamParser: Error while parsing string"sv);
+        }
+        if (!TRY(read_more()))
+            return Error::from_string_literal("JsonStreamParser: EOF while parsing string"sv);
+    }
+}
+
+ErrorOr<StringView> JsonStreamParser::unescape_string(size_t length_before_escape)
+{
+    m_unescaped_string.clear();
+    TRY(m_unescaped_string.try_append(StringView { data().slice(m_position, length_before_escape) }));
+    m_position += length_before_escape;
+
+    for (;;) {
+        if (TRY(is_eof()))
+            return Error::from_string_literal("JsonStreamParser: EOF while parsing string"sv);
+        char ch = data()[m_position++];
+        if (ch == '"')
+            return m_unescaped_string.string_view();
+        if (is_ascii_c0_control(ch))
+            return Error::from_string_literal("JsonStreamParser: Error while parsing string"sv);
+        if (ch != '\\') {
+            TRY(m_unescaped_string.try_append(ch));
+            continue;
+        }
+
+        if (TRY(is_eof()))
+            return Error::from_string_literal("JsonStreamParser: EOF while parsing string"sv);
+        switch (char escape = data()[m_position++]; escape) {
+        case '"':
+        case '\\':
+        case '/':
+            TRY(m_unescaped_string.try_append(escape));
+            break;
+        case 'n':
+            TRY(m_unescaped_string.try_append('\n'));
+            break;
+        case 'r':
+            TRY(m_unescaped_string.try_append('\r'));
+            break;
+        case 't':
+            TRY(m_unescaped_string.try_append('\t'));
+            break;
+        case 'b':
+            TRY(m_unescaped_string.try_append('\b'));
+            break;
+        case 'f':
+            TRY(m_unescaped_string.try_append('\f'));
+            break;
+        case 'u': {
+            if (!TRY(ensure_available(4)))
+                return Error::from_string_literal("JsonStreamParser: EOF while parsing Unicode escape"sv);
+            auto code_point = AK::StringUtils::convert_to_uint_from_hex(StringView { data().slice(m_position, 4) });
+            if (!code_point.has_value())
+                return Error::from_string_literal("JsonStreamParser: Error while parsing Unicode escape"sv);
+            m_position += 4;
+            TRY(m_unescaped_string.try_append_code_point(code_point.value()));
+            break;
+        }
+        default:
+            return Error::from_string_literal("JsonStreamParser: Error while parsing string"sv);
+        }
+    }
+}
+
+ErrorOr<void> JsonStreamParser::parse_property_name(Visitor& visitor)
+{
+    TRY(visitor.visit_property_name(TRY(parse_string())));
+    TRY(skip_whitespace());
+    return consume_specific(':', "JsonStreamParser: Expected ':'"sv);
+}
+
+ErrorOr<void> JsonStreamParser::parse_number(Visitor& visitor)
+{
+    size_t length = 0;
+    for (;;) {
+        if (!TRY(ensure_available(length + 1)))
+            break;
+        char ch = data()[m_position + length];
+        if (ch != '-' && ch != '.' && !is_ascii_digit(ch))
+            break;
+        ++length;
+    }
+
+    auto value = TRY(JsonParser::parse_number(StringView { data().slice(m_position, length) }));
+    m_position += length;
+    return visitor.visit_number(value);
+}
+
+ErrorOr<bool> JsonStreamParser::parse_after_value(Visitor& visitor)
+{
+    for (;;) {
+        TRY(skip_whitespace());
+        if (m_containers.is_empty()) {
+            if (!TRY(is_eof()))
+                return Error::from_string_literal("JsonStreamParser: Didn't consume all input"sv);
+            return true;
+        }
+
+        bool is_object = m_containers.last() == Container::Object;
+        char ch = TRY(peek());
+        if (ch == (is_object ? '}' : ']')) {
+            ++m_position;
+            m_containers.take_last();
+            TRY(is_object ? visitor.visit_object_end() : visitor.visit_array_end());
+            continue;
+        }
+
+        if (ch != ',')
+            return Error::from_string_literal("JsonStreamParser: Expected ','"sv);
+        ++m_position;
+        TRY(skip_whitespace());
+
+        if (is_object) {
+            if (TRY(peek()) == '}')
+                return Error::from_string_literal("JsonStreamParser: Unexpected '}'"sv);
+            TRY(parse_property_name(visitor));
+        } else if (TRY(peek()) == ']') {
+            return Error::from_string_literal("JsonStreamParser: Unexpected ']'"sv);
+        }
+        return false;
+    }
+}
+
+ErrorOr<void> JsonStreamParser::parse(Visitor& visitor)
+{
+    m_containers.clear();
+
+    // Nested containers are kept track of in m_containers rather than by recursing, so deeply nested input can't exhaust the stack.
+    for (;;) {
+        TRY(skip_whitespace());
+        switch (TRY(peek())) {
+        case '{':
+            ++m_position;
+            TRY(visitor.visit_object_start());
+            TRY(skip_whitespace());
+            if (TRY(peek()) == '}') {
+                ++m_position;
+                TRY(visitor.visit_object_end());
+                break;
+            }
+            TRY(m_containers.try_append(Container::Object));
+            TRY(parse_property_name(visitor));
+            continue;
+        case '[':
+            ++m_position;
+            TRY(visitor.visit_array_start());
+            TRY(skip_whitespace());
+            if (TRY(peek()) == ']') {
+                ++m_position;
+                TRY(visitor.visit_array_end());
+                break;
+            }
+            TRY(m_containers.try_append(Container::Array));
+            continue;
+        case '"':
+            TRY(visitor.visit_string(TRY(parse_string())));
+            break;
+        case '-':
+        case '0':
+        case '1':
+        case '2':
+        case '3':
+        case '4':
+        case '5':
+        case '6':
+        case '7':
+        case '8':
+        case '9':
+            TRY(parse_number(visitor));
+            break;
+        case 'f':
+            TRY(consume_specific("false"sv, "JsonStreamParser: Expected 'false'"sv));
+            TRY(visitor.visit_boolean(false));
+            break;
+        case 't':
+            TRY(consume_specific("true"sv, "JsonStreamParser: Expected 'true'"sv));
+            TRY(visitor.visit_boolean(true));
+            break;
+        case 'n':
+            TRY(consume_specific("null"sv, "JsonStreamParser: Expected 'null'"sv));
+            TRY(visitor.visit_null());
+            break;
+        default:
+            return Error::from_string_literal("JsonStreamParser: Unexpected character"sv);
+        }
+
+        if (TRY(parse_after_value(visitor)))
+            return {};
+    }
+}
+
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/Error.h>
+#include <AK/JsonValue.h>
+#include <AK/Stream.h>
+#include <AK/StringBuilder.h>
+#include <AK/StringView.h>
+#include <AK/Vector.h>
+
+namespace AK {
+
+// An event-based JSON parser. Instead of building a JsonValue tree, it tells a Visitor about
+// every value it encounters, in document order, so its memory use only depends on the nesting
+// depth and the size of the largest string or number, not on the size of the whole document.
+//
+// The StringViews handed to the visitor point into the input (or, for strings that contain
+// escape sequences, into an internal buffer), and are only valid until the callback returns.
+class JsonStreamParser {
+public:
+    class Visitor {
+    public:
+        virtual ~Visitor() = default;
+
+        virtual ErrorOr<void> visit_object_start() { return {}; }
+        virtual ErrorOr<void> visit_property_name(StringView) { return {}; }
+        virtual ErrorOr<void> visit_object_end() { return {}; }
+        virtual ErrorOr<void> visit_array_start() { return {}; }
+        virtual ErrorOr<void> visit_array_end() { return {}; }
+        virtual ErrorOr<void> visit_string(StringView) { return {}; }
+        // Numbers are parsed the same way JsonParser does, into an integer or a double JsonValue.
+        virtual ErrorOr<void> visit_number(JsonValue const&) { return {}; }
+        virtual ErrorOr<void> visit_boolean(bool) { return {}; }
+        virtual ErrorOr<void> visit_null() { return {}; }
+    };
+
+    explicit JsonStreamParser(StringView input)
+        : m_input(input.bytes())
+    {
+    }
+
+    explicit JsonStreamParser(InputStream& stream)
+        : m_stream(&stream)
+    {
+    }
+
+    ErrorOr<void> parse(Visitor&);
+
+private:
+    enum class Container : u8 {
+        Object,
+        Array,
+    };
+
+    ReadonlyBytes data() const { return m_stream ? m_buffer.bytes() : m_input; }
+
+    ErrorOr<bool> ensure_available(size_t count);
+    ErrorOr<bool> read_more();
+
+    ErrorOr<char> peek();
+    ErrorOr<bool> is_eof();
+    ErrorOr<void> skip_whitespace();
+    ErrorOr<void> consume_specific(char, StringView error_message);
+    ErrorOr<void> consume_specific(StringView, StringView error_message);
+
+    ErrorOr<StringView> parse_string();
+    ErrorOr<StringView> unescape_string(size_t length_before_escape);
+    ErrorOr<void> parse_property_name(Visitor&);
+    ErrorOr<void> parse_number(Visitor&);
+    ErrorOr<bool> parse_after_value(Visitor&);
+
+    InputStream* m_stream { nullptr };
+    ReadonlyBytes m_input;
+    ByteBuffer m_buffer;
+    size_t m_position { 0 };
+
+    Vector<Container, 32> m_containers;
+    StringBuilder m_unescaped_string;
+};
+
+}
+
+using AK::JsonStreamParser;
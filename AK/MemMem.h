@@ -9,39 +9,12 @@
 #include <AK/Array.h>
 #include <AK/Assertions.h>
 #include <AK/Span.h>
+#include <AK/StringSearcher.h>
 #include <AK/Types.h>
 #include <AK/Vector.h>
 
 namespace AK {
 
-namespace Detail {
-inline constexpr const void* bitap_bitwise(const void* haystack, size_t haystack_length, const void* needle, size_t needle_length)
-{
-    VERIFY(needle_length < 32);
-
-    u64 lookup = 0xfffffffe;
-
-    constexpr size_t mask_length = (size_t)((u8)-1) + 1;
-    u64 needle_mask[mask_length];
-
-    for (size_t i = 0; i < mask_length; ++i)
-        needle_mask[i] = 0xffffffff;
-
-    for (size_t i = 0; i < needle_length; ++i)
-        needle_mask[((const u8*)needle)[i]] &= ~(0x00000001 << i);
-
-    for (size_t i = 0; i < haystack_length; ++i) {
-        lookup |= needle_mask[((const u8*)haystack)[i]];
-        lookup <<= 1;
-
-        if (0 == (lookup & (0x00000001 << needle_length)))
-            return ((const u8*)haystack) + i - needle_length + 1;
-    }
-
-    return nullptr;
-}
-}
-
 template<typename HaystackIterT>
 inline Optional<size_t> memmem(const HaystackIterT& haystack_begin, const HaystackIterT& haystack_end, Span<const u8> needle) requires(requires { (*haystack_begin).data(); (*haystack_begin).size(); })
 {
@@ -114,16 +87,8 @@ inline Optional<size_t> memmem_optional(const void* haystack, size_t haystack_le
         return {};
     }
 
-    if (needle_length < 32) {
-        auto const* ptr = Detail::bitap_bitwise(haystack, haystack_length, needle, needle_length);
-        if (ptr)
-            return static_cast<size_t>((FlatPtr)ptr - (FlatPtr)haystack);
-        return {};
-    }
-
-    // Fallback to KMP.
-    Array<Span<const u8>, 1> spans { Span<const u8> { (const u8*)haystack, haystack_length } };
-    return memmem(spans.begin(), spans.end(), { (const u8*)needle, needle_length });
+    StringSearcher searcher { ReadonlyBytes { (const u8*)needle, needle_length } };
+    return searcher.find(ReadonlyBytes { (const u8*)haystack, haystack_length });
 }
 
 inline const void* memmem(const void* haystack, size_t haystack_length, const void* needle, size_t needle_length)
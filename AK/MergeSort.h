@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/QuickSort.h>
+#include <AK/StdLibExtras.h>
+#include <AK/Vector.h>
+
+namespace AK {
+
+namespace Detail {
+
+// Merges the sorted runs [start, middle) and [middle, end). The left run is moved out into
+// the buffer first, which therefore needs room for middle - start elements.
+template<typename Collection, typename Buffer, typename LessThan>
+void merge_adjacent_runs(Collection& col, size_t start, size_t middle, size_t end, Buffer& buffer, LessThan& less_than)
+{
+    // Nothing to do if the runs are already in order, which is common for partially sorted input.
+    if (middle == end || !less_than(col[middle], col[middle - 1]))
+        return;
+
+    buffer.clear_with_capacity();
+    for (size_t i = start; i < middle; ++i)
+        buffer.unchecked_append(move(col[i]));
+
+    size_t left = 0;
+    size_t right = middle;
+    size_t out = start;
+    while (left < buffer.size() && right < end) {
+        // Ties are taken from the left run, which is what keeps the sort stable.
+        if (less_than(col[right], buffer[left]))
+            col[out++] = move(col[right++]);
+        else
+            col[out++] = move(buffer[left++]);
+    }
+    while (left < buffer.size())
+        col[out++] = move(buffer[left++]);
+}
+
+}
+
+// A stable sort: elements that compare equal keep their relative order. It needs a buffer
+// for up to the whole collection, so prefer quick_sort() when stability doesn't matter.
+template<typename Collection, typename LessThan>
+void merge_sort(Collection& col, LessThan less_than)
+{
+    size_t size = col.size();
+    if (size < 2)
+        return;
+
+    // Insertion sort only ever swaps neighbors that are out of order, so it is stable too.
+    constexpr size_t initial_run_size = Detail::quick_sort_insertion_sort_threshold;
+    for (size_t start = 0; start < size; start += initial_run_size)
+        Detail::insertion_sort(col, start, min(start + initial_run_size, size) - 1, less_than);
+
+    if (size <= initial_run_size)
+        return;
+
+    Vector<RemoveCVReference<decltype(col[0])>> buffer;
+    buffer.ensure_capacity(size);
+    for (size_t width = initial_run_size; width < size; width *= 2) {
+        for (size_t start = 0; start + width < size; start += 2 * width)
+            Detail::merge_adjacent_runs(col, start, start + width, min(start + 2 * width, size), buffer, less_than);
+    }
+}
+
+template<typename Collection>
+void merge_sort(Collection& col)
+{
+    merge_sort(col, [](auto& a, auto& b) { return a < b; });
+}
+
+}
+
+using AK::merge_sort;
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Assertions.h>
+#include <AK/Noncopyable.h>
+#include <AK/StdLibExtras.h>
+#include <AK/Types.h>
+#include <AK/kmalloc.h>
+
+namespace AK {
+
+// A free-list allocator for objects of a single type. Memory is taken from the
+// heap in chunks of chunk_size bytes, and slots of deallocated objects are handed
+// out again before any new memory is touched, so creating and destroying many
+// short-lived objects doesn't hit malloc every time.
+//
+// Chunks are only returned to the heap when the pool itself is destroyed, at which
+// point any objects that are still allocated are not destroyed. The pool is not
+// thread-safe; give each thread its own pool if they need one.
+template<typename T, size_t chunk_size = 4 * KiB>
+class ObjectPool {
+    AK_MAKE_NONCOPYABLE(ObjectPool);
+    AK_MAKE_NONMOVABLE(ObjectPool);
+
+    union Slot {
+        alignas(T) u8 storage[sizeof(T)];
+        Slot* next_free;
+    };
+
+    struct ChunkHeader {
+        ChunkHeader* next_chunk;
+    };
+
+    static constexpr size_t slots_offset = align_up_to(sizeof(ChunkHeader), alignof(Slot));
+
+public:
+    ObjectPool()
+        : m_chunk_size(kmalloc_good_size(chunk_size))
+        , m_slots_per_chunk((m_chunk_size - slots_offset) / sizeof(Slot))
+    {
+        static_assert(chunk_size >= slots_offset + sizeof(Slot), "ObjectPool chunks must fit at least one object");
+    }
+
+    ~ObjectPool()
+    {
+        auto* chunk = m_first_chunk;
+        while (chunk) {
+            auto* next_chunk = chunk->next_chunk;
+            kfree_sized(chunk, m_chunk_size);
+            chunk = next_chunk;
+        }
+    }
+
+    // Returns nullptr if a new chunk was needed but could not be allocated.
+    template<typename... Args>
+    [[nodiscard]] T* allocate(Args&&... args)
+    {
+        auto* slot = take_slot();
+        if (!slot)
+            return nullptr;
+        ++m_live_count;
+        return new (slot->storage) T { forward<Args>(args)... };
+    }
+
+    void deallocate(T* object)
+    {
+        if (!object)
+            return;
+        VERIFY(m_live_count > 0);
+        object->~T();
+        auto* slot = reinterpret_cast<Slot*>(object);
+        slot->next_free = m_free_list;
+        m_free_list = slot;
+        --m_live_count;
+    }
+
+    [[nodiscard]] size_t live_count() const { return m_live_count; }
+
+private:
+    Slot* take_slot()
+    {
+        if (m_free_list) {
+            auto* slot = m_free_list;
+            m_free_list = slot->next_free;
+            return slot;
+        }
+
+        if (!m_first_chunk || m_used_slots_in_first_chunk == m_slots_per_chunk) {
+            auto* chunk = static_cast<ChunkHeader*>(kmalloc(m_chunk_size));
+            if (!chunk)
+                return nullptr;
+            chunk->next_chunk = m_first_chunk;
+            m_first_chunk = chunk;
+            m_used_slots_in_first_chunk = 0;
+        }
+
+        auto* slots = reinterpret_cast<Slot*>(reinterpret_cast<u8*>(m_first_chunk) + slots_offset);
+        return &slots[m_used_slots_in_first_chunk++];
+    }
+
+    ChunkHeader* m_first_chunk { nullptr };
+    size_t m_used_slots_in_first_chunk { 0 };
+    Slot* m_free_list { nullptr };
+    size_t m_live_count { 0 };
+    size_t m_chunk_size { 0 };
+    size_t m_slots_per_chunk { 0 };
+};
+
+}
+
+using AK::ObjectPool;
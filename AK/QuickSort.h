@@ -10,29 +10,72 @@
 
 namespace AK {
 
-/* This is a dual pivot quick sort. It is quite a bit faster than the single
- * pivot quick_sort below. The other quick_sort below should only be used when
- * you are stuck with simple iterators to a container and you don't have access
- * to the container itself.
- */
+namespace Detail {
+
+// Partitioning doesn't pay off for ranges this small, insertion sort is faster there.
+static constexpr int quick_sort_insertion_sort_threshold = 16;
+
 template<typename Collection, typename LessThan>
-void dual_pivot_quick_sort(Collection& col, int start, int end, LessThan less_than)
+void insertion_sort(Collection& col, int start, int end, LessThan& less_than)
+{
+    for (int i = start + 1; i <= end; ++i) {
+        for (int j = i; j > start && less_than(col[j], col[j - 1]); --j)
+            swap(col[j], col[j - 1]);
+    }
+}
+
+template<typename Collection, typename LessThan>
+void sift_down(Collection& col, int start, int root, int size, LessThan& less_than)
+{
+    for (;;) {
+        int child = 2 * root + 1;
+        if (child >= size)
+            return;
+        if (child + 1 < size && less_than(col[start + child], col[start + child + 1]))
+            ++child;
+        if (!less_than(col[start + root], col[start + child]))
+            return;
+        swap(col[start + root], col[start + child]);
+        root = child;
+    }
+}
+
+template<typename Collection, typename LessThan>
+void heap_sort(Collection& col, int start, int end, LessThan& less_than)
+{
+    int size = end - start + 1;
+    for (int root = size / 2 - 1; root >= 0; --root)
+        sift_down(col, start, root, size, less_than);
+    for (int last = size - 1; last > 0; --last) {
+        swap(col[start], col[start + last]);
+        sift_down(col, start, 0, last, less_than);
+    }
+}
+
+template<typename Collection, typename LessThan>
+void dual_pivot_quick_sort(Collection& col, int start, int end, LessThan& less_than, int depth_limit)
 {
     while (start < end) {
         int size = end - start + 1;
-        if (size > 3) {
-            int third = size / 3;
-            if (less_than(col[start + third], col[end - third])) {
-                swap(col[start + third], col[start]);
-                swap(col[end - third], col[end]);
-            } else {
-                swap(col[start + third], col[end]);
-                swap(col[end - third], col[start]);
-            }
+        if (size <= quick_sort_insertion_sort_threshold) {
+            insertion_sort(col, start, end, less_than);
+            return;
+        }
+
+        // Too many bad pivots in a row means the input is defeating our pivot choice,
+        // so finish this range with heap sort to stay within O(n log n).
+        if (depth_limit-- == 0) {
+            heap_sort(col, start, end, less_than);
+            return;
+        }
+
+        int third = size / 3;
+        if (less_than(col[start + third], col[end - third])) {
+            swap(col[start + third], col[start]);
+            swap(col[end - third], col[end]);
         } else {
-            if (!less_than(col[start], col[end])) {
-                swap(col[start], col[end]);
-            }
+            swap(col[start + third], col[end]);
+            swap(col[end - third], col[start]);
         }
 
         int j = start + 1;
@@ -73,22 +116,43 @@ void dual_pivot_quick_sort(Collection& col, int start, int end, LessThan less_th
         int right_size = (end + 1) - (right_pointer + 1);
 
         if (left_size >= middle_size && left_size >= right_size) {
-            dual_pivot_quick_sort(col, left_pointer + 1, right_pointer - 1, less_than);
-            dual_pivot_quick_sort(col, right_pointer + 1, end, less_than);
+            dual_pivot_quick_sort(col, left_pointer + 1, right_pointer - 1, less_than, depth_limit);
+            dual_pivot_quick_sort(col, right_pointer + 1, end, less_than, depth_limit);
             end = left_pointer - 1;
         } else if (middle_size >= right_size) {
-            dual_pivot_quick_sort(col, start, left_pointer - 1, less_than);
-            dual_pivot_quick_sort(col, right_pointer + 1, end, less_than);
+            dual_pivot_quick_sort(col, start, left_pointer - 1, less_than, depth_limit);
+            dual_pivot_quick_sort(col, right_pointer + 1, end, less_than, depth_limit);
             start = left_pointer + 1;
             end = right_pointer - 1;
         } else {
-            dual_pivot_quick_sort(col, start, left_pointer - 1, less_than);
-            dual_pivot_quick_sort(col, left_pointer + 1, right_pointer - 1, less_than);
+            dual_pivot_quick_sort(col, start, left_pointer - 1, less_than, depth_limit);
+            dual_pivot_quick_sort(col, left_pointer + 1, right_pointer - 1, less_than, depth_limit);
             start = right_pointer + 1;
         }
     }
 }
 
+}
+
+/* This is a dual pivot quick sort. It is quite a bit faster than the single
+ * pivot quick_sort below. The other quick_sort below should only be used when
+ * you are stuck with simple iterators to a container and you don't have access
+ * to the container itself.
+ *
+ * Like introsort, it switches to insertion sort for small ranges and to heap sort
+ * when partitioning keeps going badly, so it is O(n log n) even for adversarial input.
+ */
+template<typename Collection, typename LessThan>
+void dual_pivot_quick_sort(Collection& col, int start, int end, LessThan less_than)
+{
+    if (start >= end)
+        return;
+    int depth_limit = 0;
+    for (int size = end - start + 1; size > 1; size >>= 1)
+        depth_limit += 2;
+    Detail::dual_pivot_quick_sort(col, start, end, less_than, depth_limit);
+}
+
 template<typename Iterator, typename LessThan>
 void single_pivot_quick_sort(Iterator start, Iterator end, LessThan less_than)
 {
@@ -26,6 +26,24 @@ StringImpl& StringImpl::the_empty_stringimpl()
     return *s_the_empty_stringimpl;
 }
 
+#ifndef KERNEL
+// The kernel runs on multiple processors at once, and StringImpl's reference count isn't atomic.
+static StringImpl* s_single_character_stringimpls[256];
+
+// Single-character strings are common enough (delimiters, operators, short identifiers)
+// that we keep one shared StringImpl for each of them instead of allocating a new one every time.
+static StringImpl& single_character_stringimpl(char ch)
+{
+    auto*& impl = s_single_character_stringimpls[static_cast<u8>(ch)];
+    if (!impl) {
+        char* buffer;
+        impl = &StringImpl::create_uninitialized(1, buffer).leak_ref();
+        buffer[0] = ch;
+    }
+    return *impl;
+}
+#endif
+
 StringImpl::StringImpl(ConstructWithInlineBufferTag, size_t length)
     : m_length(length)
 {
@@ -66,6 +84,11 @@ RefPtr<StringImpl> StringImpl::create(const char* cstring, size_t length, Should
     if (!length)
         return the_empty_stringimpl();
 
+#ifndef KERNEL
+    if (length == 1)
+        return single_character_stringimpl(cstring[0]);
+#endif
+
     char* buffer;
     auto new_stringimpl = create_uninitialized(length, buffer);
     memcpy(buffer, cstring, length * sizeof(char));
@@ -95,6 +118,10 @@ RefPtr<StringImpl> StringImpl::create_lowercased(char const* cstring, size_t len
         return nullptr;
     if (!length)
         return the_empty_stringimpl();
+#ifndef KERNEL
+    if (length == 1)
+        return single_character_stringimpl((char)to_ascii_lowercase(cstring[0]));
+#endif
     char* buffer;
     auto impl = create_uninitialized(length, buffer);
     for (size_t i = 0; i < length; ++i)
@@ -108,6 +135,10 @@ RefPtr<StringImpl> StringImpl::create_uppercased(char const* cstring, size_t len
         return nullptr;
     if (!length)
         return the_empty_stringimpl();
+#ifndef KERNEL
+    if (length == 1)
+        return single_character_stringimpl((char)to_ascii_uppercase(cstring[0]));
+#endif
     char* buffer;
     auto impl = create_uninitialized(length, buffer);
     for (size_t i = 0; i < length; ++i)
@@ -78,6 +78,13 @@ public:
     bool is_fly() const { return m_fly; }
     void set_fly(Badge<FlyString>, bool fly) const { m_fly = fly; }
 
+    // FlyString usually knows the hash already, and there's no point in computing it twice.
+    void set_hash(Badge<FlyString>, unsigned hash) const
+    {
+        m_hash = hash;
+        m_has_hash = true;
+    }
+
 private:
     enum ConstructTheEmptyStringImplTag {
         ConstructTheEmptyStringImpl
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/BuiltinWrappers.h>
+#include <AK/Optional.h>
+#include <AK/Span.h>
+#include <AK/StringView.h>
+#include <AK/Types.h>
+
+#ifdef __SSE2__
+#    include <AK/BitCast.h>
+#    include <AK/SIMD.h>
+#endif
+
+namespace AK {
+
+// Finds occurrences of a needle in any number of haystacks. Everything that only depends
+// on the needle is worked out once, up front, so searching for the same needle many times
+// (say, in every line of a file) only pays for the search itself.
+//
+// The needle is not copied, and has to outlive the searcher.
+class StringSearcher {
+public:
+    explicit StringSearcher(ReadonlyBytes needle)
+        : m_needle(needle)
+    {
+        if (m_needle.size() < horspool_threshold)
+            return;
+
+        for (auto& skip : m_skip_table)
+            skip = m_needle.size();
+        for (size_t i = 0; i < m_needle.size() - 1; ++i)
+            m_skip_table[m_needle[i]] = m_needle.size() - 1 - i;
+    }
+
+    explicit StringSearcher(StringView needle)
+        : StringSearcher(needle.bytes())
+    {
+    }
+
+    ReadonlyBytes needle() const { return m_needle; }
+
+    Optional<size_t> find(ReadonlyBytes haystack) const
+    {
+        if (m_needle.is_empty())
+            return 0;
+        if (haystack.size() < m_needle.size())
+            return {};
+        if (m_needle.size() >= horspool_threshold)
+            return find_with_horspool(haystack);
+        return find_with_first_and_last_byte(haystack);
+    }
+
+    Optional<size_t> find(StringView haystack) const { return find(haystack.bytes()); }
+
+    bool is_in(ReadonlyBytes haystack) const { return find(haystack).has_value(); }
+    bool is_in(StringView haystack) const { return find(haystack).has_value(); }
+
+private:
+    // Long needles are searched with Boyer-Moore-Horspool, which gets to skip ahead by up to the
+    // length of the needle. For short needles that isn't worth the cost of the table.
+    static constexpr size_t horspool_threshold = 32;
+
+    static size_t find_byte(ReadonlyBytes haystack, size_t start, size_t end, u8 byte)
+    {
+#ifdef KERNEL
+        while (start < end && haystack[start] != byte)
+            ++start;
+        return start;
+#else
+        auto const* found = static_cast<u8 const*>(__builtin_memchr(haystack.data() + start, byte, end - start));
+        return found ? found - haystack.data() : end;
+#endif
+    }
+
+    // Only candidates where both the first and the last byte of the needle match are compared in full.
+    // Looking at two bytes that are far apart rejects far more candidates than looking at the first byte
+    // alone, especially in text where the first byte is common.
+    Optional<size_t> find_with_first_and_last_byte(ReadonlyBytes haystack) const
+    {
+        auto first = m_needle[0];
+        auto last_offset = m_needle.size() - 1;
+        auto last = m_needle[last_offset];
+        auto const* needle_middle = m_needle.data() + 1;
+        auto middle_length = m_needle.size() < 2 ? 0 : m_needle.size() - 2;
+
+        // One past the last position the needle could start at.
+        size_t end = haystack.size() - m_needle.size() + 1;
+        size_t position = 0;
+
+#ifdef __SSE2__
+        for (; position + 16 <= end; position += 16) {
+            SIMD::u8x16 first_bytes;
+            SIMD::u8x16 last_bytes;
+            __builtin_memcpy(&first_bytes, haystack.data() + position, sizeof(first_bytes));
+            __builtin_memcpy(&last_bytes, haystack.data() + position + last_offset, sizeof(last_bytes));
+
+            u32 candidates = __builtin_ia32_pmovmskb128(bit_cast<SIMD::c8x16>((first_bytes == first) & (last_bytes == last)));
+            while (candidates) {
+                auto candidate = position + count_trailing_zeroes(candidates);
+                if (__builtin_memcmp(haystack.data() + candidate + 1, needle_middle, middle_length) == 0)
+                    return candidate;
+                candidates &= candidates - 1;
+            }
+        }
+#endif
+
+        for (; position < end; ++position) {
+            position = find_byte(haystack, position, end, first);
+            if (position == end)
+                break;
+            if (haystack[position + last_offset] == last && __builtin_memcmp(haystack.data() + position + 1, needle_middle, middle_length) == 0)
+                return position;
+        }
+        return {};
+    }
+
+    Optional<size_t> find_with_horspool(ReadonlyBytes haystack) const
+    {
+        auto last_offset = m_needle.size() - 1;
+        auto last = m_needle[last_offset];
+        for (size_t position = 0; position + m_needle.size() <= haystack.size();) {
+            auto byte = haystack[position + last_offset];
+            if (byte == last && __builtin_memcmp(haystack.data() + position, m_needle.data(), last_offset) == 0)
+                return position;
+            position += m_skip_table[byte];
+        }
+        return {};
+    }
+
+    ReadonlyBytes m_needle;
+    size_t m_skip_table[256];
+};
+
+}
+
+using AK::StringSearcher;
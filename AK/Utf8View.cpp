@@ -6,7 +6,10 @@
  */
 
 #include <AK/Assertions.h>
+#include <AK/BitCast.h>
+#include <AK/BuiltinWrappers.h>
 #include <AK/Format.h>
+#include <AK/SIMD.h>
 #include <AK/Utf8View.h>
 
 namespace AK {
@@ -96,36 +99,137 @@ static inline bool decode_first_byte(
     return false;
 }
 
+// Returns the length of the well-formed code point at the start of `ptr`, or 0 if there isn't one.
+static inline size_t length_of_valid_code_point(u8 const* ptr, size_t remaining_length)
+{
+    size_t code_point_length_in_bytes;
+    u32 value;
+    if (!decode_first_byte(*ptr, code_point_length_in_bytes, value))
+        return 0;
+    if (code_point_length_in_bytes > remaining_length)
+        return 0;
+    for (size_t i = 1; i < code_point_length_in_bytes; i++) {
+        if (ptr[i] >> 6 != 2)
+            return 0;
+    }
+    return code_point_length_in_bytes;
+}
+
+static inline bool is_continuation_byte(u8 byte)
+{
+    return byte >> 6 == 2;
+}
+
+#ifdef __SSE2__
+static constexpr size_t utf8_chunk_size = 16;
+
+// Checks that each of the 16 bytes at `ptr` is a continuation byte exactly when one of the
+// three bytes before it is a leading byte that asks for one. Those three bytes have to be
+// part of the view, and must already have been checked themselves.
+ALWAYS_INLINE static bool is_valid_utf8_chunk(u8 const* ptr, SIMD::u64x2& continuation_byte_mask)
+{
+    SIMD::u8x16 bytes;
+    SIMD::u8x16 previous1;
+    SIMD::u8x16 previous2;
+    SIMD::u8x16 previous3;
+    __builtin_memcpy(&bytes, ptr, utf8_chunk_size);
+    __builtin_memcpy(&previous1, ptr - 1, utf8_chunk_size);
+    __builtin_memcpy(&previous2, ptr - 2, utf8_chunk_size);
+    __builtin_memcpy(&previous3, ptr - 3, utf8_chunk_size);
+
+    auto expects_continuation = (previous1 >= 0xc0) | (previous2 >= 0xe0) | (previous3 >= 0xf0);
+    auto is_continuation = (bytes & 0xc0) == 0x80;
+    auto errors = bit_cast<SIMD::u64x2>((expects_continuation ^ is_continuation) | (bytes >= 0xf8));
+
+    continuation_byte_mask = bit_cast<SIMD::u64x2>(is_continuation);
+    return !(errors[0] | errors[1]);
+}
+
+// Called after a run of valid chunks that ended at `ptr`. The last code point that starts before `ptr`
+// may continue past it, so that's where checking has to pick up again.
+static u8 const* start_of_last_code_point_before(u8 const* ptr)
+{
+    do {
+        --ptr;
+    } while (is_continuation_byte(*ptr));
+    return ptr;
+}
+#endif
+
 bool Utf8View::validate(size_t& valid_bytes) const
 {
-    valid_bytes = 0;
-    for (auto ptr = begin_ptr(); ptr < end_ptr(); ptr++) {
-        size_t code_point_length_in_bytes;
-        u32 value;
-        bool first_byte_makes_sense = decode_first_byte(*ptr, code_point_length_in_bytes, value);
-        if (!first_byte_makes_sense)
+    auto const* ptr = begin_ptr();
+
+#ifdef __SSE2__
+    // Check code points one by one until we can look three bytes back, then go through the bulk of the view a chunk at a time.
+    while (ptr < end_ptr() && ptr < begin_ptr() + 3) {
+        auto code_point_length_in_bytes = length_of_valid_code_point(ptr, end_ptr() - ptr);
+        if (!code_point_length_in_bytes) {
+            valid_bytes = ptr - begin_ptr();
             return false;
-
-        for (size_t i = 1; i < code_point_length_in_bytes; i++) {
-            ptr++;
-            if (ptr >= end_ptr())
-                return false;
-            if (*ptr >> 6 != 2)
-                return false;
         }
+        ptr += code_point_length_in_bytes;
+    }
 
-        valid_bytes += code_point_length_in_bytes;
+    auto const* chunks_start = ptr;
+    SIMD::u64x2 continuation_byte_mask;
+    while (static_cast<size_t>(end_ptr() - ptr) >= utf8_chunk_size && is_valid_utf8_chunk(ptr, continuation_byte_mask))
+        ptr += utf8_chunk_size;
+
+    // Whatever is left, or the chunk that was invalid, is checked one code point at a time so we know where exactly the valid bytes end.
+    if (ptr != chunks_start)
+        ptr = start_of_last_code_point_before(ptr);
+#endif
+
+    for (; ptr < end_ptr();) {
+        auto code_point_length_in_bytes = length_of_valid_code_point(ptr, end_ptr() - ptr);
+        if (!code_point_length_in_bytes)
+            break;
+        ptr += code_point_length_in_bytes;
     }
 
-    return true;
+    valid_bytes = ptr - begin_ptr();
+    return ptr == end_ptr();
 }
 
 size_t Utf8View::calculate_length() const
 {
     size_t length = 0;
-    for ([[maybe_unused]] auto code_point : *this) {
+    auto const* ptr = begin_ptr();
+
+#ifdef __SSE2__
+    // As long as the view is valid, the number of code points is simply the number of bytes that aren't continuation bytes.
+    // Once we find something invalid, we fall back to the iterator, which knows how to step over invalid sequences.
+    bool is_valid_so_far = true;
+    while (ptr < end_ptr() && ptr < begin_ptr() + 3) {
+        auto code_point_length_in_bytes = length_of_valid_code_point(ptr, end_ptr() - ptr);
+        if (!code_point_length_in_bytes) {
+            is_valid_so_far = false;
+            break;
+        }
+        ptr += code_point_length_in_bytes;
         ++length;
     }
+
+    if (is_valid_so_far) {
+        auto const* chunks_start = ptr;
+        SIMD::u64x2 continuation_byte_mask;
+        while (static_cast<size_t>(end_ptr() - ptr) >= utf8_chunk_size && is_valid_utf8_chunk(ptr, continuation_byte_mask)) {
+            auto continuation_bytes = (popcount(continuation_byte_mask[0]) + popcount(continuation_byte_mask[1])) / 8;
+            length += utf8_chunk_size - continuation_bytes;
+            ptr += utf8_chunk_size;
+        }
+
+        if (ptr != chunks_start) {
+            // The leading byte of this code point has already been counted above.
+            ptr = start_of_last_code_point_before(ptr);
+            --length;
+        }
+    }
+#endif
+
+    for (Utf8CodePointIterator iterator { ptr, static_cast<size_t>(end_ptr() - ptr) }; !iterator.done(); ++iterator)
+        ++length;
     return length;
 }
 
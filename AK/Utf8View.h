@@ -80,6 +80,13 @@ public:
     Utf8CodePointIterator end() const { return { end_ptr(), 0 }; }
     Utf8CodePointIterator iterator_at_byte_offset(size_t) const;
 
+    // NOTE: Unlike iterator_at_byte_offset(), this doesn't walk the string, so the offset has to be at the start of a code point.
+    Utf8CodePointIterator iterator_at_byte_offset_without_validation(size_t byte_offset) const
+    {
+        VERIFY(byte_offset <= m_string.length());
+        return { begin_ptr() + byte_offset, m_string.length() - byte_offset };
+    }
+
     const unsigned char* bytes() const { return begin_ptr(); }
     size_t byte_length() const { return m_string.length(); }
     size_t byte_offset_of(const Utf8CodePointIterator&) const;
@@ -32,6 +32,7 @@ enum {
     PERF_EVENT_PAGE_FAULT = 8192,
     PERF_EVENT_SYSCALL = 16384,
     PERF_EVENT_SIGNPOST = 32768,
+    PERF_EVENT_THREAD_WAKEUP = 65536,
 };
 
 #define PERF_EVENT_MASK_ALL (~0ull)
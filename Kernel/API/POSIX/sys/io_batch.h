@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <Kernel/API/POSIX/sys/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IO_READ 1
+#define IO_WRITE 2
+#define IO_READV 3
+#define IO_WRITEV 4
+
+// Use io_request.offset instead of (and without moving) the file offset.
+#define IO_POSITIONAL (1 << 0)
+
+// The most requests a single io_submit_batch() call accepts.
+#define IO_BATCH_MAX 1024
+
+struct io_request {
+    int opcode;
+    int fd;
+    int flags;
+    off_t offset;
+    // For IO_READV and IO_WRITEV, buffer points to an array of length struct iovecs.
+    void* buffer;
+    size_t length;
+    // Filled in by the kernel: the number of bytes transferred, or a negated errno value.
+    ssize_t result;
+};
+
+#ifdef __cplusplus
+}
+#endif
@@ -58,6 +58,7 @@ extern "C" {
 #define MSG_DONTROUTE 0x10
 #define MSG_WAITALL 0x20
 #define MSG_DONTWAIT 0x40
+#define MSG_WAITFORONE 0x80
 
 typedef uint16_t sa_family_t;
 
@@ -77,6 +78,12 @@ struct msghdr {
     int msg_flags;
 };
 
+// For recvmmsg() and sendmmsg(), which fill in msg_len with the length of each message.
+struct mmsghdr {
+    struct msghdr msg_hdr;
+    unsigned int msg_len;
+};
+
 struct sockaddr {
     sa_family_t sa_family;
     char sa_data[14];
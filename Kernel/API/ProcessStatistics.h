@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Types.h>
+
+// The layout of /proc/all_binary, which has the same information as /proc/all without
+// any JSON to generate or parse. It starts with a ProcessStatisticsHeader, followed by
+// process_count processes. Each process is a ProcessStatisticsRecord, its strings, and
+// then thread_count threads, each of which is a ThreadStatisticsRecord and its strings.
+// Strings are not null-terminated, and follow the record in the order their lengths
+// are declared in.
+
+static constexpr u32 PROCESS_STATISTICS_VERSION = 1;
+
+struct [[gnu::packed]] ProcessStatisticsHeader {
+    u32 version;
+    u32 process_count;
+    u64 total_time;
+    u64 total_time_kernel;
+};
+
+struct [[gnu::packed]] ProcessStatisticsRecord {
+    i32 pid;
+    i32 pgid;
+    i32 pgp;
+    i32 sid;
+    u32 uid;
+    u32 gid;
+    i32 ppid;
+    u32 nfds;
+    u8 kernel;
+    u8 dumpable;
+    u64 amount_virtual;
+    u64 amount_resident;
+    u64 amount_shared;
+    u64 amount_dirty_private;
+    u64 amount_clean_inode;
+    u64 amount_purgeable_volatile;
+    u64 amount_purgeable_nonvolatile;
+    u32 thread_count;
+    u16 name_length;
+    u16 executable_length;
+    u16 tty_length;
+    u16 pledge_length;
+    u16 veil_length;
+};
+
+struct [[gnu::packed]] ThreadStatisticsRecord {
+    i32 tid;
+    u32 times_scheduled;
+    u64 time_user;
+    u64 time_kernel;
+    u32 cpu;
+    u32 priority;
+    u32 syscall_count;
+    u32 inode_faults;
+    u32 zero_faults;
+    u32 cow_faults;
+    u64 file_read_bytes;
+    u64 file_write_bytes;
+    u64 unix_socket_read_bytes;
+    u64 unix_socket_write_bytes;
+    u64 ipv4_socket_read_bytes;
+    u64 ipv4_socket_write_bytes;
+    u16 name_length;
+    u16 state_length;
+};
@@ -17,6 +17,8 @@
 constexpr int syscall_vector = 0x82;
 
 extern "C" {
+struct epoll_event;
+struct io_request;
 struct pollfd;
 struct timeval;
 struct timespec;
@@ -67,6 +69,9 @@ enum class NeedsBigProcessLock {
     S(disown, NeedsBigProcessLock::Yes)                     \
     S(dump_backtrace, NeedsBigProcessLock::No)              \
     S(dup2, NeedsBigProcessLock::Yes)                       \
+    S(epoll_create1, NeedsBigProcessLock::Yes)              \
+    S(epoll_ctl, NeedsBigProcessLock::Yes)                  \
+    S(epoll_wait, NeedsBigProcessLock::Yes)                 \
     S(emuctl, NeedsBigProcessLock::Yes)                     \
     S(execve, NeedsBigProcessLock::Yes)                     \
     S(exit, NeedsBigProcessLock::Yes)                       \
@@ -107,6 +112,7 @@ enum class NeedsBigProcessLock {
     S(getuid, NeedsBigProcessLock::Yes)                     \
     S(inode_watcher_add_watch, NeedsBigProcessLock::Yes)    \
     S(inode_watcher_remove_watch, NeedsBigProcessLock::Yes) \
+    S(io_submit_batch, NeedsBigProcessLock::Yes)            \
     S(ioctl, NeedsBigProcessLock::Yes)                      \
     S(join_thread, NeedsBigProcessLock::Yes)                \
     S(kill, NeedsBigProcessLock::Yes)                       \
@@ -145,12 +151,15 @@ enum class NeedsBigProcessLock {
     S(readv, NeedsBigProcessLock::Yes)                      \
     S(realpath, NeedsBigProcessLock::Yes)                   \
     S(recvfd, NeedsBigProcessLock::Yes)                     \
+    S(recvmmsg, NeedsBigProcessLock::Yes)                   \
     S(recvmsg, NeedsBigProcessLock::Yes)                    \
     S(rename, NeedsBigProcessLock::Yes)                     \
     S(rmdir, NeedsBigProcessLock::Yes)                      \
     S(sched_getparam, NeedsBigProcessLock::Yes)             \
     S(sched_setparam, NeedsBigProcessLock::Yes)             \
     S(sendfd, NeedsBigProcessLock::Yes)                     \
+    S(sendfile, NeedsBigProcessLock::Yes)                   \
+    S(sendmmsg, NeedsBigProcessLock::Yes)                   \
     S(sendmsg, NeedsBigProcessLock::Yes)                    \
     S(set_coredump_metadata, NeedsBigProcessLock::Yes)      \
     S(set_mmap_name, NeedsBigProcessLock::Yes)              \
@@ -270,6 +279,14 @@ struct SC_poll_params {
     const u32* sigmask;
 };
 
+struct SC_epoll_wait_params {
+    int epfd;
+    struct epoll_event* events;
+    int max_events;
+    const struct timespec* timeout;
+    const u32* sigmask;
+};
+
 struct SC_clock_nanosleep_params {
     int clock_id;
     int flags;
@@ -21,9 +21,23 @@ inline bool time_page_supports(clockid_t clock_id)
     return clock_id == CLOCK_REALTIME_COARSE || clock_id == CLOCK_MONOTONIC_COARSE;
 }
 
+// The precise clocks are only published at every tick, so they can only be read from the time page
+// if the time since the last tick can be measured with the TSC (see TimePage::tsc_to_ns_multiplier).
+inline bool time_page_supports_with_tsc(clockid_t clock_id)
+{
+    return clock_id == CLOCK_REALTIME || clock_id == CLOCK_MONOTONIC || clock_id == CLOCK_MONOTONIC_RAW;
+}
+
 struct TimePage {
     volatile u32 update1;
     struct timespec clocks[CLOCK_ID_COUNT];
+    // The TSC at the time the clocks were updated.
+    u64 tsc_at_update;
+    // Nanoseconds per TSC cycle, as a fixed point number with 32 fractional bits.
+    // This is 0 if the TSC can't be used to measure the time since the clocks were updated.
+    u64 tsc_to_ns_multiplier;
+    // No more than this is ever added to the clocks, so they never go past the next update.
+    u32 max_ns_since_update;
     volatile u32 update2;
 };
 
@@ -56,6 +56,12 @@ public:
         return 0;
     }
 
+    [[nodiscard]] ALWAYS_INLINE bool try_lock(u32& prev_flags)
+    {
+        prev_flags = 0;
+        return true;
+    }
+
     ALWAYS_INLINE void unlock(u32 /*prev_flags*/)
     {
     }
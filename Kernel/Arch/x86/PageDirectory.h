@@ -25,6 +25,13 @@ public:
         m_raw |= PhysicalAddress::physical_page_base(value);
     }
 
+    // With the Huge bit set, the entry maps a 2 MiB page directly instead of pointing to a page table.
+    void set_huge_page_base(PhysicalPtr value)
+    {
+        m_raw &= 0x8000000000000fffULL;
+        m_raw |= PhysicalAddress::physical_page_base(value);
+    }
+
     bool is_null() const { return m_raw == 0; }
     void clear() { m_raw = 0; }
 
@@ -95,6 +102,7 @@ public:
         UserSupervisor = 1 << 2,
         WriteThrough = 1 << 3,
         CacheDisabled = 1 << 4,
+        Accessed = 1 << 5,
         Global = 1 << 8,
         NoExecute = 0x8000000000000000ULL,
     };
@@ -114,6 +122,10 @@ public:
     bool is_cache_disabled() const { return (raw() & CacheDisabled) == CacheDisabled; }
     void set_cache_disabled(bool b) { set_bit(CacheDisabled, b); }
 
+    // The CPU sets this whenever it uses the entry, which lets us tell pages that are in use from those that aren't.
+    bool is_accessed() const { return (raw() & Accessed) == Accessed; }
+    void set_accessed(bool b) { set_bit(Accessed, b); }
+
     bool is_global() const { return (raw() & Global) == Global; }
     void set_global(bool b) { set_bit(Global, b); }
 
@@ -8,6 +8,7 @@
 
 #include <Kernel/Arch/Processor.h>
 #include <Kernel/Locking/LockRank.h>
+#include <Kernel/Locking/LockStatistics.h>
 
 #include <AK/Platform.h>
 VALIDATE_IS_X86()
@@ -29,8 +30,16 @@ public:
         u32 prev_flags = cpu_flags();
         Processor::enter_critical();
         cli();
-        while (m_lock.exchange(1, AK::memory_order_acquire) != 0) {
-            Processor::wait_check();
+        if (m_lock.exchange(1, AK::memory_order_acquire) != 0) [[unlikely]] {
+            bool record_statistics = LockStatistics::is_enabled();
+            u64 wait_start = record_statistics ? read_tsc() : 0;
+            while (m_lock.exchange(1, AK::memory_order_acquire) != 0) {
+                Processor::wait_check();
+            }
+            if (record_statistics)
+                LockStatistics::record_contended_acquisition(LockStatisticsKind::Spinlock, FlatPtr(this), {}, read_tsc() - wait_start);
+        } else if (LockStatistics::is_enabled()) [[unlikely]] {
+            LockStatistics::record_acquisition(LockStatisticsKind::Spinlock, FlatPtr(this), {});
         }
         track_lock_acquire(m_rank);
         return prev_flags;
@@ -82,18 +91,53 @@ public:
         auto& proc = Processor::current();
         FlatPtr cpu = FlatPtr(&proc);
         FlatPtr expected = 0;
+        bool record_statistics = LockStatistics::is_enabled();
+        u64 wait_start = 0;
         while (!m_lock.compare_exchange_strong(expected, cpu, AK::memory_order_acq_rel)) {
             if (expected == cpu)
                 break;
+            if (record_statistics && wait_start == 0)
+                wait_start = read_tsc();
             Processor::wait_check();
             expected = 0;
         }
-        if (m_recursions == 0)
+        if (m_recursions == 0) {
+            if (record_statistics) [[unlikely]] {
+                if (wait_start != 0)
+                    LockStatistics::record_contended_acquisition(LockStatisticsKind::RecursiveSpinlock, FlatPtr(this), {}, read_tsc() - wait_start);
+                else
+                    LockStatistics::record_acquisition(LockStatisticsKind::RecursiveSpinlock, FlatPtr(this), {});
+            }
             track_lock_acquire(m_rank);
+        }
         m_recursions++;
         return prev_flags;
     }
 
+    // Like lock(), but gives up right away if another processor holds the lock.
+    // This is for code that has to take locks in the "wrong" order, where waiting could deadlock.
+    [[nodiscard]] ALWAYS_INLINE bool try_lock(u32& prev_flags)
+    {
+        prev_flags = cpu_flags();
+        cli();
+        Processor::enter_critical();
+        FlatPtr cpu = FlatPtr(&Processor::current());
+        FlatPtr expected = 0;
+        if (!m_lock.compare_exchange_strong(expected, cpu, AK::memory_order_acq_rel) && expected != cpu) {
+            if ((prev_flags & 0x200) != 0)
+                sti();
+            Processor::leave_critical();
+            return false;
+        }
+        if (m_recursions == 0) {
+            if (LockStatistics::is_enabled()) [[unlikely]]
+                LockStatistics::record_acquisition(LockStatisticsKind::RecursiveSpinlock, FlatPtr(this), {});
+            track_lock_acquire(m_rank);
+        }
+        m_recursions++;
+        return true;
+    }
+
     ALWAYS_INLINE void unlock(u32 prev_flags)
     {
         VERIFY(m_recursions > 0);
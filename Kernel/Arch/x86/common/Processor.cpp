@@ -81,6 +81,8 @@ UNMAP_AFTER_INIT void Processor::cpu_detect()
         set_feature(CPUFeature::PAE);
     if (processor_info.edx() & (1 << 13))
         set_feature(CPUFeature::PGE);
+    if (processor_info.edx() & (1 << 16))
+        set_feature(CPUFeature::PAT);
     if (processor_info.edx() & (1 << 23))
         set_feature(CPUFeature::MMX);
     if (processor_info.edx() & (1 << 24))
@@ -184,6 +186,14 @@ UNMAP_AFTER_INIT void Processor::cpu_setup()
         write_cr4(read_cr4() | 0x80);
     }
 
+    if (has_feature(CPUFeature::PAT)) {
+        // Make PAT entries 1 and 5 (selected by PWT without PCD) write-combining instead of write-through,
+        // which nothing uses. The other entries keep their power-on values: WB, UC- and UC.
+        // Regions that are Cacheable::WriteCombine are mapped with PWT, see Region::map_individual_page_impl().
+        MSR ia32_pat(MSR_IA32_PAT);
+        ia32_pat.set(0x0007010600070106);
+    }
+
     if (has_feature(CPUFeature::NX)) {
         // Turn on IA32_EFER.NXE
         MSR ia32_efer(MSR_IA32_EFER);
@@ -307,6 +317,8 @@ NonnullOwnPtr<KString> Processor::features_string() const
             return "lm"sv;
         case CPUFeature::HYPERVISOR:
             return "hypervisor"sv;
+        case CPUFeature::PAT:
+            return "pat"sv;
             // no default statement here intentionally so that we get
             // a warning if a new feature is forgotten to be added here
         }
@@ -344,6 +356,9 @@ UNMAP_AFTER_INIT void Processor::early_initialize(u32 cpu)
     m_current_thread = nullptr;
     m_info = nullptr;
 
+    for (auto& specific_data : m_processor_specific_data)
+        specific_data = nullptr;
+
     m_halt_requested = false;
     if (cpu == 0) {
         s_smp_enabled = false;
@@ -716,8 +731,17 @@ void Processor::check_invoke_scheduler()
     }
 }
 
+// Past this many pages it is cheaper to drop the whole TLB than to invalidate page by page.
+// Reloading CR3 leaves global (kernel) translations alone, so we only do this for user ranges.
+static constexpr size_t full_tlb_flush_threshold = 32;
+
 void Processor::flush_tlb_local(VirtualAddress vaddr, size_t page_count)
 {
+    if (page_count > full_tlb_flush_threshold && Memory::is_user_address(vaddr)) {
+        flush_entire_tlb_local();
+        return;
+    }
+
     auto ptr = vaddr.as_ptr();
     while (page_count > 0) {
         // clang-format off
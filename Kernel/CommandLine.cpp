@@ -224,6 +224,23 @@ UNMAP_AFTER_INIT AHCIResetMode CommandLine::ahci_reset_mode() const
     PANIC("Unknown AHCIResetMode: {}", ahci_reset_mode);
 }
 
+TCPCongestionAlgorithm CommandLine::tcp_congestion_algorithm() const
+{
+    const auto algorithm = lookup("tcp_congestion"sv).value_or("cubic"sv);
+    if (algorithm == "newreno"sv)
+        return TCPCongestionAlgorithm::NewReno;
+    return TCPCongestionAlgorithm::Cubic;
+}
+
+size_t CommandLine::profiling_sample_rate() const
+{
+    const auto sample_rate = lookup("profiling_sample_rate"sv).value_or("1000"sv);
+    auto sample_rate_number = sample_rate.to_uint();
+    if (sample_rate_number.has_value() && sample_rate_number.value() >= 1)
+        return sample_rate_number.value();
+    PANIC("Invalid profiling sample rate: {}", sample_rate);
+}
+
 StringView CommandLine::system_mode() const
 {
     return lookup("system_mode"sv).value_or("graphical"sv);
@@ -40,6 +40,11 @@ enum class AHCIResetMode {
     Aggressive,
 };
 
+enum class TCPCongestionAlgorithm {
+    NewReno,
+    Cubic,
+};
+
 class CommandLine {
 
 public:
@@ -82,6 +87,8 @@ public:
     [[nodiscard]] bool disable_usb() const;
     [[nodiscard]] bool disable_virtio() const;
     [[nodiscard]] AHCIResetMode ahci_reset_mode() const;
+    [[nodiscard]] TCPCongestionAlgorithm tcp_congestion_algorithm() const;
+    [[nodiscard]] size_t profiling_sample_rate() const;
     [[nodiscard]] StringView userspace_init() const;
     [[nodiscard]] NonnullOwnPtrVector<KString> userspace_init_args() const;
     [[nodiscard]] StringView root_device() const;
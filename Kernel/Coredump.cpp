@@ -173,8 +173,6 @@ ErrorOr<void> Coredump::write_program_headers(size_t notes_size)
 
 ErrorOr<void> Coredump::write_regions()
 {
-    u8 zero_buffer[PAGE_SIZE] = {};
-
     for (auto& region : m_process->address_space().regions()) {
         VERIFY(!region->is_kernel());
 
@@ -191,13 +189,17 @@ ErrorOr<void> Coredump::write_regions()
 
         for (size_t i = 0; i < region->page_count(); i++) {
             auto const* page = region->physical_page(i);
-            auto src_buffer = [&]() -> ErrorOr<UserOrKernelBuffer> {
-                if (page)
-                    return UserOrKernelBuffer::for_user_buffer(reinterpret_cast<uint8_t*>((region->vaddr().as_ptr() + (i * PAGE_SIZE))), PAGE_SIZE);
-                // If the current page is not backed by a physical page, we zero it in the coredump file.
-                return UserOrKernelBuffer::for_kernel_buffer(zero_buffer);
-            }();
-            TRY(m_description->write(src_buffer.value(), PAGE_SIZE));
+
+            // Pages that were never touched read as zeros, so they're left as a hole in the file instead of being written.
+            // Anonymous pages without a physical page are compressed though, and reading them brings them back.
+            bool is_untouched = page ? (page->is_shared_zero_page() || page->is_lazy_committed_page()) : !region->vmobject().is_anonymous();
+            if (is_untouched) {
+                TRY(m_description->seek(PAGE_SIZE, SEEK_CUR));
+                continue;
+            }
+
+            auto src_buffer = TRY(UserOrKernelBuffer::for_user_buffer(reinterpret_cast<uint8_t*>((region->vaddr().as_ptr() + (i * PAGE_SIZE))), PAGE_SIZE));
+            TRY(m_description->write(src_buffer, PAGE_SIZE));
         }
     }
     return {};
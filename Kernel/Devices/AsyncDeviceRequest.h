@@ -23,6 +23,7 @@ extern WorkQueue* g_io_work;
 class AsyncDeviceRequest : public RefCounted<AsyncDeviceRequest> {
     AK_MAKE_NONCOPYABLE(AsyncDeviceRequest);
     AK_MAKE_NONMOVABLE(AsyncDeviceRequest);
+    friend class Device;
 
 public:
     enum [[nodiscard]] RequestResult {
@@ -57,6 +58,10 @@ public:
     virtual StringView name() const = 0;
     virtual void start() = 0;
 
+    // Requests that know where on the device they operate may be reordered
+    // by their device to cut down on seeking, see Device::queue_request().
+    virtual Optional<u64> device_position() const { return {}; }
+
     void add_sub_request(NonnullRefPtr<AsyncDeviceRequest>);
 
     [[nodiscard]] RequestWaitResult wait(Time* = nullptr);
@@ -141,6 +146,7 @@ private:
 
     AsyncDeviceRequest* m_parent_request { nullptr };
     RequestResult m_result { Pending };
+    u32 m_times_overtaken { 0 };
     IntrusiveListNode<AsyncDeviceRequest, RefPtr<AsyncDeviceRequest>> m_list_node;
 
     using AsyncDeviceSubRequestList = IntrusiveList<&AsyncDeviceRequest::m_list_node>;
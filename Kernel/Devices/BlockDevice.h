@@ -30,6 +30,7 @@ public:
     size_t buffer_size() const { return m_buffer_size; }
 
     virtual void start() override;
+    virtual Optional<u64> device_position() const override { return m_block_index; }
     virtual StringView name() const override
     {
         switch (m_request_type) {
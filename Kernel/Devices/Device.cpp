@@ -151,6 +151,53 @@ ErrorOr<NonnullOwnPtr<KString>> Device::pseudo_path(const OpenFileDescription&)
     return KString::formatted("device:{},{}", major(), minor());
 }
 
+void Device::queue_request(NonnullRefPtr<AsyncDeviceRequest> request)
+{
+    VERIFY(m_requests_lock.is_locked());
+
+    auto position = request->device_position();
+    if (!position.has_value() || !should_reorder_requests() || m_requests.is_empty()) {
+        m_requests.append(move(request));
+        return;
+    }
+
+    // The first request is the one currently being serviced. From there we sweep
+    // upwards through the pending requests in ascending order, and then wrap around
+    // to the lowest one (C-LOOK). Requests that have been overtaken too often can't
+    // be overtaken anymore, so a steady stream of nearby requests can't starve them.
+    static constexpr u32 max_times_overtaken = 16;
+    auto head_position = m_requests.first()->device_position().value_or(0);
+    // Returns whether a request at position a is reached before one at position b in the current sweep.
+    auto comes_before_in_sweep = [&](u64 a, u64 b) {
+        bool a_wraps_around = a < head_position;
+        bool b_wraps_around = b < head_position;
+        if (a_wraps_around != b_wraps_around)
+            return !a_wraps_around;
+        return a < b;
+    };
+
+    auto first_candidate = m_requests.begin();
+    ++first_candidate;
+    for (auto it = first_candidate; it != m_requests.end(); ++it) {
+        if ((*it)->m_times_overtaken >= max_times_overtaken) {
+            first_candidate = it;
+            ++first_candidate;
+        }
+    }
+
+    auto insert_position = first_candidate;
+    for (; insert_position != m_requests.end(); ++insert_position) {
+        auto pending_position = (*insert_position)->device_position().value_or(0);
+        if (comes_before_in_sweep(position.value(), pending_position))
+            break;
+    }
+
+    for (auto it = insert_position; it != m_requests.end(); ++it)
+        ++(*it)->m_times_overtaken;
+
+    m_requests.insert_before(insert_position, move(request));
+}
+
 void Device::process_next_queued_request(Badge<AsyncDeviceRequest>, const AsyncDeviceRequest& completed_request)
 {
     SpinlockLocker lock(m_requests_lock);
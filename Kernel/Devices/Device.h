@@ -57,7 +57,7 @@ public:
         auto request = TRY(adopt_nonnull_ref_or_enomem(new (nothrow) AsyncRequestType(*this, forward<Args>(args)...)));
         SpinlockLocker lock(m_requests_lock);
         bool was_empty = m_requests.is_empty();
-        m_requests.append(request);
+        queue_request(request);
         if (was_empty)
             request->do_start(move(lock));
         return request;
@@ -68,7 +68,13 @@ protected:
     void set_uid(UserID uid) { m_uid = uid; }
     void set_gid(GroupID gid) { m_gid = gid; }
 
+    // Devices that pay a penalty for seeking (e.g. spinning disks) can return true
+    // here to have their pending requests serviced in elevator order.
+    virtual bool should_reorder_requests() const { return false; }
+
 private:
+    void queue_request(NonnullRefPtr<AsyncDeviceRequest>);
+
     MajorNumber m_major { 0 };
     MinorNumber m_minor { 0 };
     UserID m_uid { 0 };
@@ -8,6 +8,7 @@
 #include <Kernel/Debug.h>
 #include <Kernel/FileSystem/BlockBasedFileSystem.h>
 #include <Kernel/Process.h>
+#include <Kernel/WorkQueue.h>
 
 namespace Kernel {
 
@@ -18,21 +19,39 @@ struct CacheEntry {
     bool has_data { false };
 };
 
+// The cache is made up of one or more chunks of entries. It starts out with a single
+// chunk and grows by another chunk whenever it would otherwise have to evict something
+// while there's plenty of physical memory left. Under memory pressure, chunks are
+// released again until we're back down to the initial one.
+struct DiskCacheChunk {
+    NonnullOwnPtr<KBuffer> cached_block_data;
+    NonnullOwnPtr<KBuffer> entries_buffer;
+
+    CacheEntry* entries() { return (CacheEntry*)entries_buffer->data(); }
+};
+
 class DiskCache {
 public:
-    static constexpr size_t EntryCount = 10000;
-    explicit DiskCache(BlockBasedFileSystem& fs, NonnullOwnPtr<KBuffer> cached_block_data, NonnullOwnPtr<KBuffer> entries_buffer)
-        : m_fs(fs)
-        , m_cached_block_data(move(cached_block_data))
-        , m_entries(move(entries_buffer))
+    static constexpr size_t EntriesPerChunk = 10000;
+    static constexpr size_t MaximumChunkCount = 16;
+
+    // Reads of missing blocks are batched into a single device read of at most this many blocks.
+    static constexpr size_t MaximumBatchBlockCount = 32;
+
+    static ErrorOr<NonnullOwnPtr<DiskCache>> try_create(BlockBasedFileSystem& fs)
     {
-        for (size_t i = 0; i < EntryCount; ++i) {
-            entries()[i].data = m_cached_block_data->data() + i * m_fs.block_size();
-            m_clean_list.append(entries()[i]);
-        }
+        auto batch_buffer = TRY(KBuffer::try_create_with_size(MaximumBatchBlockCount * fs.block_size(), Memory::Region::Access::ReadWrite, "DiskCache batch buffer"));
+        auto cache = TRY(adopt_nonnull_own_or_enomem(new (nothrow) DiskCache(fs, move(batch_buffer))));
+        TRY(cache->try_add_chunk());
+        return cache;
     }
 
-    ~DiskCache() = default;
+    ~DiskCache()
+    {
+        // The entries live in m_chunks, so unlink them before those go away.
+        m_clean_list.clear();
+        m_dirty_list.clear();
+    }
 
     bool is_dirty() const { return !m_dirty_list.is_empty(); }
     bool entry_is_dirty(CacheEntry const& entry) const { return m_dirty_list.contains(entry); }
@@ -65,8 +84,21 @@ public:
 
     CacheEntry& ensure(BlockBasedFileSystem::BlockIndex block_index) const
     {
-        if (auto* entry = get(block_index))
+        if (auto* entry = get(block_index)) {
+            // Keep the clean list in least-recently-used order, so we always evict the coldest block.
+            if (!entry_is_dirty(*entry))
+                m_clean_list.prepend(*entry);
             return *entry;
+        }
+
+        if (is_under_memory_pressure())
+            shrink();
+
+        if (m_clean_list.is_empty() || m_clean_list.last()->has_data) {
+            // We'd have to evict something, so try to grow the cache instead.
+            if (should_grow())
+                (void)try_add_chunk();
+        }
 
         if (m_clean_list.is_empty()) {
             // Not a single clean entry! Flush writes and try again.
@@ -80,7 +112,7 @@ public:
         auto& new_entry = *m_clean_list.last();
         m_clean_list.prepend(new_entry);
 
-        m_hash.remove(new_entry.block_index);
+        forget(new_entry);
         m_hash.set(block_index, &new_entry);
 
         new_entry.block_index = block_index;
@@ -89,9 +121,6 @@ public:
         return new_entry;
     }
 
-    const CacheEntry* entries() const { return (const CacheEntry*)m_entries->data(); }
-    CacheEntry* entries() { return (CacheEntry*)m_entries->data(); }
-
     template<typename Callback>
     void for_each_dirty_entry(Callback callback)
     {
@@ -99,13 +128,123 @@ public:
             callback(entry);
     }
 
+    u8* batch_buffer() { return m_batch_buffer->data(); }
+
+    size_t entry_count() const { return m_chunks.size() * EntriesPerChunk; }
+
+    // Sequential access detection, used to decide whether to read ahead.
+    static constexpr size_t ReadaheadBlockCount = 32;
+
+    Optional<BlockBasedFileSystem::BlockIndex> note_read_and_check_for_readahead(BlockBasedFileSystem::BlockIndex index, size_t count)
+    {
+        if (index == m_next_sequential_block)
+            ++m_sequential_read_count;
+        else
+            m_sequential_read_count = 0;
+        m_next_sequential_block = BlockBasedFileSystem::BlockIndex { index.value() + count };
+
+        // Only start reading ahead once we've seen a couple of back-to-back reads,
+        // and keep at least half a readahead window in front of the reader.
+        if (m_sequential_read_count < 2)
+            return {};
+        if (m_readahead_block.value() >= m_next_sequential_block.value() + ReadaheadBlockCount / 2)
+            return {};
+        auto readahead_start = max(m_readahead_block, m_next_sequential_block);
+        m_readahead_block = BlockBasedFileSystem::BlockIndex { readahead_start.value() + ReadaheadBlockCount };
+        return readahead_start;
+    }
+
 private:
+    DiskCache(BlockBasedFileSystem& fs, NonnullOwnPtr<KBuffer> batch_buffer)
+        : m_fs(fs)
+        , m_batch_buffer(move(batch_buffer))
+    {
+    }
+
+    ErrorOr<void> try_add_chunk() const
+    {
+        auto cached_block_data = TRY(KBuffer::try_create_with_size(EntriesPerChunk * m_fs.block_size(), Memory::Region::Access::ReadWrite, "DiskCache"));
+        auto entries_buffer = TRY(KBuffer::try_create_with_size(EntriesPerChunk * sizeof(CacheEntry), Memory::Region::Access::ReadWrite, "DiskCache entries"));
+        TRY(m_chunks.try_append(DiskCacheChunk { move(cached_block_data), move(entries_buffer) }));
+
+        auto& chunk = m_chunks.last();
+        for (size_t i = 0; i < EntriesPerChunk; ++i) {
+            auto* entry = new (&chunk.entries()[i]) CacheEntry;
+            entry->data = chunk.cached_block_data->data() + i * m_fs.block_size();
+            // Unused entries go to the back of the clean list, so they are picked before we evict anything.
+            m_clean_list.append(*entry);
+        }
+        dbgln_if(BBFS_DEBUG, "DiskCache: Grew to {} entries", entry_count());
+        return {};
+    }
+
+    void forget(CacheEntry& entry) const
+    {
+        auto it = m_hash.find(entry.block_index);
+        if (it != m_hash.end() && it->value == &entry)
+            m_hash.remove(it);
+    }
+
+    size_t chunk_page_count() const
+    {
+        return (EntriesPerChunk * m_fs.block_size()) / PAGE_SIZE;
+    }
+
+    bool should_grow() const
+    {
+        if (m_chunks.size() >= MaximumChunkCount)
+            return false;
+        // Only grow while at least a quarter of physical memory would remain uncommitted afterwards.
+        auto info = MM.get_system_memory_info();
+        if (info.user_physical_pages_uncommitted < chunk_page_count())
+            return false;
+        return info.user_physical_pages_uncommitted - chunk_page_count() > info.user_physical_pages / 4;
+    }
+
+    bool is_under_memory_pressure() const
+    {
+        if (m_chunks.size() <= 1)
+            return false;
+        auto info = MM.get_system_memory_info();
+        return info.user_physical_pages_uncommitted < info.user_physical_pages / 8;
+    }
+
+    void shrink() const
+    {
+        VERIFY(m_chunks.size() > 1);
+        auto& chunk = m_chunks.last();
+        auto* first_entry = &chunk.entries()[0];
+        auto* last_entry = &chunk.entries()[EntriesPerChunk - 1];
+
+        // Make sure none of the entries we're about to drop are still holding on to unwritten data.
+        for (auto& entry : m_dirty_list) {
+            if (&entry >= first_entry && &entry <= last_entry) {
+                m_fs.flush_writes_impl();
+                break;
+            }
+        }
+
+        for (size_t i = 0; i < EntriesPerChunk; ++i) {
+            auto& entry = chunk.entries()[i];
+            VERIFY(!entry_is_dirty(entry));
+            m_clean_list.remove(entry);
+            forget(entry);
+            entry.~CacheEntry();
+        }
+        m_chunks.take_last();
+        dbgln_if(BBFS_DEBUG, "DiskCache: Shrunk to {} entries", entry_count());
+    }
+
     BlockBasedFileSystem& m_fs;
     mutable HashMap<BlockBasedFileSystem::BlockIndex, CacheEntry*> m_hash;
     mutable IntrusiveList<&CacheEntry::list_node> m_clean_list;
     mutable IntrusiveList<&CacheEntry::list_node> m_dirty_list;
-    NonnullOwnPtr<KBuffer> m_cached_block_data;
-    NonnullOwnPtr<KBuffer> m_entries;
+    mutable Vector<DiskCacheChunk> m_chunks;
+    NonnullOwnPtr<KBuffer> m_batch_buffer;
+
+    BlockBasedFileSystem::BlockIndex m_next_sequential_block { 0 };
+    BlockBasedFileSystem::BlockIndex m_readahead_block { 0 };
+    size_t m_sequential_read_count { 0 };
 };
 
 BlockBasedFileSystem::BlockBasedFileSystem(OpenFileDescription& file_description)
@@ -121,9 +260,7 @@ BlockBasedFileSystem::~BlockBasedFileSystem()
 ErrorOr<void> BlockBasedFileSystem::initialize()
 {
     VERIFY(block_size() != 0);
-    auto cached_block_data = TRY(KBuffer::try_create_with_size(DiskCache::EntryCount * block_size()));
-    auto entries_data = TRY(KBuffer::try_create_with_size(DiskCache::EntryCount * sizeof(CacheEntry)));
-    auto disk_cache = TRY(adopt_nonnull_own_or_enomem(new (nothrow) DiskCache(*this, move(cached_block_data), move(entries_data))));
+    auto disk_cache = TRY(DiskCache::try_create(*this));
 
     m_cache.with_exclusive([&](auto& cache) {
         cache = move(disk_cache);
@@ -225,7 +362,7 @@ ErrorOr<void> BlockBasedFileSystem::read_block(BlockIndex index, UserOrKernelBuf
     VERIFY(offset + count <= block_size());
     dbgln_if(BBFS_DEBUG, "BlockBasedFileSystem::read_block {}", index);
 
-    return m_cache.with_exclusive([&](auto& cache) -> ErrorOr<void> {
+    TRY(m_cache.with_exclusive([&](auto& cache) -> ErrorOr<void> {
         if (!allow_cache) {
             const_cast<BlockBasedFileSystem*>(this)->flush_specific_block_if_needed(index);
             auto base_offset = index.value() * block_size() + offset;
@@ -245,7 +382,11 @@ ErrorOr<void> BlockBasedFileSystem::read_block(BlockIndex index, UserOrKernelBuf
         if (buffer)
             TRY(buffer->write(entry.data + offset, count));
         return {};
-    });
+    }));
+
+    if (allow_cache && buffer)
+        schedule_readahead_if_sequential(index, 1);
+    return {};
 }
 
 ErrorOr<void> BlockBasedFileSystem::read_blocks(BlockIndex index, unsigned count, UserOrKernelBuffer& buffer, bool allow_cache) const
@@ -255,15 +396,86 @@ ErrorOr<void> BlockBasedFileSystem::read_blocks(BlockIndex index, unsigned count
         return EINVAL;
     if (count == 1)
         return read_block(index, &buffer, block_size(), 0, allow_cache);
-    auto out = buffer;
-    for (unsigned i = 0; i < count; ++i) {
-        TRY(read_block(BlockIndex { index.value() + i }, &out, block_size(), 0, allow_cache));
-        out = out.offset(block_size());
+    if (!allow_cache) {
+        auto out = buffer;
+        for (unsigned i = 0; i < count; ++i) {
+            TRY(read_block(BlockIndex { index.value() + i }, &out, block_size(), 0, allow_cache));
+            out = out.offset(block_size());
+        }
+        return {};
     }
 
+    TRY(m_cache.with_exclusive([&](auto& cache) { return read_blocks_into_cache(*cache, index, count, &buffer); }));
+    schedule_readahead_if_sequential(index, count);
     return {};
 }
 
+ErrorOr<void> BlockBasedFileSystem::read_blocks_into_cache(DiskCache& cache, BlockIndex index, unsigned count, UserOrKernelBuffer* buffer, bool is_readahead) const
+{
+    auto out = buffer ? *buffer : UserOrKernelBuffer::for_kernel_buffer(nullptr);
+    unsigned i = 0;
+    while (i < count) {
+        auto block = BlockIndex { index.value() + i };
+        if (auto* entry = cache.get(block); entry && entry->has_data) {
+            auto& cached_entry = cache.ensure(block);
+            if (buffer)
+                TRY(out.write(cached_entry.data, block_size()));
+            out = out.offset(block_size());
+            ++i;
+            continue;
+        }
+
+        // Gather a run of consecutive blocks that we don't have yet, and read all of them at once.
+        unsigned run_length = 1;
+        while (i + run_length < count && run_length < DiskCache::MaximumBatchBlockCount) {
+            auto* entry = cache.get(BlockIndex { block.value() + run_length });
+            if (entry && entry->has_data)
+                break;
+            ++run_length;
+        }
+
+        auto base_offset = block.value() * block_size();
+        auto batch_buffer = UserOrKernelBuffer::for_kernel_buffer(cache.batch_buffer());
+        auto nread_or_error = file_description().read(batch_buffer, base_offset, run_length * block_size());
+        if (is_readahead) {
+            // Reading ahead is only a hint, so it's fine if we ran past the end of the device.
+            if (nread_or_error.is_error())
+                return {};
+            run_length = min<unsigned>(run_length, nread_or_error.value() / block_size());
+            if (run_length == 0)
+                return {};
+        } else {
+            auto nread = TRY(nread_or_error);
+            VERIFY(nread == run_length * block_size());
+        }
+
+        for (unsigned j = 0; j < run_length; ++j) {
+            auto& entry = cache.ensure(BlockIndex { block.value() + j });
+            memcpy(entry.data, cache.batch_buffer() + j * block_size(), block_size());
+            entry.has_data = true;
+            if (buffer)
+                TRY(out.write(entry.data, block_size()));
+            out = out.offset(block_size());
+        }
+        i += run_length;
+    }
+    return {};
+}
+
+void BlockBasedFileSystem::schedule_readahead_if_sequential(BlockIndex index, unsigned count) const
+{
+    auto readahead_block = m_cache.with_exclusive([&](auto& cache) { return cache->note_read_and_check_for_readahead(index, count); });
+    if (!readahead_block.has_value())
+        return;
+
+    dbgln_if(BBFS_DEBUG, "BlockBasedFileSystem: Sequential reads detected, reading ahead {} blocks from {}", DiskCache::ReadaheadBlockCount, readahead_block.value());
+    g_io_work->queue([fs = NonnullRefPtr<BlockBasedFileSystem>(const_cast<BlockBasedFileSystem&>(*this)), readahead_block = readahead_block.value()]() {
+        fs->m_cache.with_exclusive([&](auto& cache) {
+            (void)fs->read_blocks_into_cache(*cache, readahead_block, DiskCache::ReadaheadBlockCount, nullptr, true);
+        });
+    });
+}
+
 void BlockBasedFileSystem::flush_specific_block_if_needed(BlockIndex index)
 {
     m_cache.with_exclusive([&](auto& cache) {
@@ -44,6 +44,9 @@ private:
     DiskCache& cache() const;
     void flush_specific_block_if_needed(BlockIndex index);
 
+    ErrorOr<void> read_blocks_into_cache(DiskCache&, BlockIndex, unsigned count, UserOrKernelBuffer*, bool is_readahead = false) const;
+    void schedule_readahead_if_sequential(BlockIndex, unsigned count) const;
+
     mutable MutexProtected<OwnPtr<DiskCache>> m_cache;
 };
 
@@ -110,15 +110,15 @@ ErrorOr<void> DevPtsFSInode::traverse_as_directory(Function<ErrorOr<void>(FileSy
     if (identifier().index() > 1)
         return ENOTDIR;
 
-    TRY(callback({ ".", identifier(), 0 }));
-    TRY(callback({ "..", identifier(), 0 }));
+    TRY(callback({ ".", identifier(), DT_DIR }));
+    TRY(callback({ "..", identifier(), DT_DIR }));
 
     return SlavePTY::all_instances().with([&](auto& list) -> ErrorOr<void> {
         StringBuilder builder;
         for (SlavePTY& slave_pty : list) {
             builder.clear();
             TRY(builder.try_appendff("{}", slave_pty.index()));
-            TRY(callback({ builder.string_view(), { fsid(), pty_index_to_inode_index(slave_pty.index()) }, 0 }));
+            TRY(callback({ builder.string_view(), { fsid(), pty_index_to_inode_index(slave_pty.index()) }, DT_CHR }));
         }
         return {};
     });
@@ -212,12 +212,27 @@ DevTmpFSDirectoryInode::~DevTmpFSDirectoryInode()
 
 ErrorOr<void> DevTmpFSDirectoryInode::traverse_as_directory(Function<ErrorOr<void>(FileSystem::DirectoryEntryView const&)> callback) const
 {
+    auto directory_entry_type = [](DevTmpFSInode const& node) -> u8 {
+        switch (node.node_type()) {
+        case Type::BlockDevice:
+            return DT_BLK;
+        case Type::CharacterDevice:
+            return DT_CHR;
+        case Type::Directory:
+        case Type::RootDirectory:
+            return DT_DIR;
+        case Type::Link:
+            return DT_LNK;
+        }
+        VERIFY_NOT_REACHED();
+    };
+
     MutexLocker locker(m_inode_lock);
-    TRY(callback({ ".", identifier(), 0 }));
-    TRY(callback({ "..", identifier(), 0 }));
+    TRY(callback({ ".", identifier(), DT_DIR }));
+    TRY(callback({ "..", identifier(), DT_DIR }));
     for (auto& node : m_nodes) {
         InodeIdentifier identifier = { fsid(), node.index() };
-        TRY(callback({ node.name(), identifier, 0 }));
+        TRY(callback({ node.name(), identifier, directory_entry_type(node) }));
     }
     return {};
 }
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/HashFunctions.h>
+#include <Kernel/FileSystem/Custody.h>
+#include <Kernel/FileSystem/DirectoryEntryCache.h>
+#include <Kernel/FileSystem/Inode.h>
+
+namespace Kernel {
+
+unsigned DirectoryEntryCache::hash_for(InodeIdentifier directory, StringView name)
+{
+    auto directory_hash = pair_int_hash(directory.fsid().value(), u64_hash(directory.index().value()));
+    return pair_int_hash(directory_hash, name.hash());
+}
+
+auto DirectoryEntryCache::take_entry_with_lock_held(InodeIdentifier directory, StringView name) -> OwnPtr<Entry>
+{
+    VERIFY(m_lock.is_locked_by_current_thread());
+    auto it = m_entries.find(hash_for(directory, name), [&](auto& entry) {
+        return entry->directory == directory && entry->name->view() == name;
+    });
+    if (it == m_entries.end())
+        return {};
+    OwnPtr<Entry> entry = move(*it);
+    m_entries.remove(it);
+    m_lru_list.remove(*entry);
+    return entry;
+}
+
+Optional<RefPtr<Custody>> DirectoryEntryCache::lookup(Custody& parent, StringView name)
+{
+    MutexLocker locker(m_lock);
+    auto directory = parent.inode().identifier();
+    auto it = m_entries.find(hash_for(directory, name), [&](auto& entry) {
+        return entry->directory == directory && entry->name->view() == name;
+    });
+    if (it == m_entries.end())
+        return {};
+    auto& entry = **it;
+    if (entry.parent.ptr() != &parent)
+        return {};
+    m_lru_list.remove(entry);
+    m_lru_list.prepend(entry);
+    return entry.child;
+}
+
+void DirectoryEntryCache::add(Custody& parent, StringView name, RefPtr<Custody> child, u64 generation)
+{
+    // Failing to cache something is not an error, so we just drop the entry if we're out of memory.
+    auto name_or_error = KString::try_create(name);
+    if (name_or_error.is_error())
+        return;
+    auto new_entry = adopt_own_if_nonnull(new (nothrow) Entry { parent.inode().identifier(), name_or_error.release_value(), parent, move(child), {} });
+    if (!new_entry)
+        return;
+    auto entry = new_entry.release_nonnull();
+
+    // Entries we replace or evict hold references to custodies (and thus inodes),
+    // so we make sure to only let go of them after dropping the lock.
+    OwnPtr<Entry> replaced_entry;
+    OwnPtr<Entry> evicted_entry;
+    MutexLocker locker(m_lock);
+
+    if (generation != this->generation())
+        return;
+
+    replaced_entry = take_entry_with_lock_held(entry->directory, entry->name->view());
+    if (m_entries.size() >= max_entry_count) {
+        auto& victim = *m_lru_list.last();
+        evicted_entry = take_entry_with_lock_held(victim.directory, victim.name->view());
+    }
+
+    auto& entry_ref = *entry;
+    if (m_entries.try_set(move(entry)).is_error())
+        return;
+    m_lru_list.prepend(entry_ref);
+}
+
+void DirectoryEntryCache::invalidate(InodeIdentifier directory, StringView name)
+{
+    OwnPtr<Entry> stale_entry;
+    MutexLocker locker(m_lock);
+    m_generation.fetch_add(1, AK::MemoryOrder::memory_order_acq_rel);
+    stale_entry = take_entry_with_lock_held(directory, name);
+}
+
+void DirectoryEntryCache::invalidate_all()
+{
+    HashTable<NonnullOwnPtr<Entry>, EntryTraits> stale_entries;
+    MutexLocker locker(m_lock);
+    m_generation.fetch_add(1, AK::MemoryOrder::memory_order_acq_rel);
+    m_lru_list.clear();
+    swap(stale_entries, m_entries);
+}
+
+}
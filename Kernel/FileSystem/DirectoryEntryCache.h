@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/HashTable.h>
+#include <AK/IntrusiveList.h>
+#include <AK/Noncopyable.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Optional.h>
+#include <AK/RefPtr.h>
+#include <Kernel/FileSystem/InodeIdentifier.h>
+#include <Kernel/Forward.h>
+#include <Kernel/KString.h>
+#include <Kernel/Locking/Mutex.h>
+
+namespace Kernel {
+
+// Remembers what looking up a name in a directory resolved to during path resolution,
+// including lookups that failed with ENOENT.
+//
+// We only find out about entries going stale through Inode::did_add_child() and
+// Inode::did_remove_child(), so only file systems that report every change to their
+// directories that way opt into this (see FileSystem::supports_directory_entry_caching()).
+// Mount table changes throw away the whole cache.
+class DirectoryEntryCache {
+    AK_MAKE_NONCOPYABLE(DirectoryEntryCache);
+    AK_MAKE_NONMOVABLE(DirectoryEntryCache);
+
+public:
+    static constexpr size_t max_entry_count = 4096;
+
+    DirectoryEntryCache() = default;
+
+    // Bumped on every invalidation. Pass the value from before a lookup to add(),
+    // so we don't cache a result that may have gone stale while we were looking.
+    u64 generation() const { return m_generation.load(AK::MemoryOrder::memory_order_acquire); }
+
+    // Returns an empty Optional on a cache miss. Otherwise, returns the custody for `name`
+    // inside `parent`, which is null if `name` is known not to exist.
+    Optional<RefPtr<Custody>> lookup(Custody& parent, StringView name);
+    void add(Custody& parent, StringView name, RefPtr<Custody> child, u64 generation);
+
+    void invalidate(InodeIdentifier directory, StringView name);
+    void invalidate_all();
+
+private:
+    struct Entry {
+        InodeIdentifier directory;
+        NonnullOwnPtr<KString> name;
+        // An entry only applies to lookups through the custody it was created for,
+        // since the same directory inode may be reachable through different paths.
+        NonnullRefPtr<Custody> parent;
+        RefPtr<Custody> child;
+        IntrusiveListNode<Entry> lru_list_node;
+    };
+
+    struct EntryTraits : public GenericTraits<NonnullOwnPtr<Entry>> {
+        static unsigned hash(NonnullOwnPtr<Entry> const& entry) { return hash_for(entry->directory, entry->name->view()); }
+        static bool equals(NonnullOwnPtr<Entry> const& a, NonnullOwnPtr<Entry> const& b) { return a->directory == b->directory && a->name->view() == b->name->view(); }
+    };
+
+    static unsigned hash_for(InodeIdentifier, StringView name);
+    OwnPtr<Entry> take_entry_with_lock_held(InodeIdentifier directory, StringView name);
+
+    Mutex m_lock { "DirectoryEntryCache" };
+    HashTable<NonnullOwnPtr<Entry>, EntryTraits> m_entries;
+    IntrusiveList<&Entry::lru_list_node> m_lru_list;
+    Atomic<u64> m_generation { 0 };
+};
+
+}
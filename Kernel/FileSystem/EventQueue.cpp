@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/FileSystem/EventQueue.h>
+#include <Kernel/FileSystem/OpenFileDescription.h>
+#include <Kernel/KString.h>
+
+namespace Kernel {
+
+using BlockFlags = Thread::FileBlocker::BlockFlags;
+
+static BlockFlags block_flags_for_events(u32 events)
+{
+    auto block_flags = BlockFlags::None;
+    if (events & EPOLLIN)
+        block_flags |= BlockFlags::Read;
+    if (events & EPOLLOUT)
+        block_flags |= BlockFlags::Write;
+    return block_flags;
+}
+
+static u32 events_for_unblock_flags(BlockFlags unblock_flags)
+{
+    u32 events = 0;
+    if (has_flag(unblock_flags, BlockFlags::Read))
+        events |= EPOLLIN;
+    if (has_flag(unblock_flags, BlockFlags::Write))
+        events |= EPOLLOUT;
+    return events;
+}
+
+ErrorOr<NonnullRefPtr<EventQueue>> EventQueue::try_create()
+{
+    return adopt_nonnull_ref_or_enomem(new (nothrow) EventQueue);
+}
+
+EventQueue::~EventQueue()
+{
+    (void)close();
+}
+
+bool EventQueue::can_read(const OpenFileDescription&, size_t) const
+{
+    SpinlockLocker lock(m_lock);
+    return !m_ready_watches.is_empty();
+}
+
+ErrorOr<void> EventQueue::close()
+{
+    MutexLocker locker(m_watches_lock);
+    for (auto& it : m_watches)
+        detach_watch(*it.value);
+    m_watches.clear();
+    return {};
+}
+
+ErrorOr<NonnullOwnPtr<KString>> EventQueue::pseudo_path(const OpenFileDescription&) const
+{
+    return KString::formatted("EventQueue:({})", m_watches.size());
+}
+
+void EventQueue::evaluate_watch(Watch& watch)
+{
+    BlockFlags block_flags;
+    {
+        SpinlockLocker lock(m_lock);
+        if (watch.ready_list_node.is_in_list())
+            return;
+        block_flags = block_flags_for_events(watch.events);
+    }
+
+    if (watch.description->should_unblock(block_flags) == BlockFlags::None)
+        return;
+
+    {
+        SpinlockLocker lock(m_lock);
+        if (watch.ready_list_node.is_in_list())
+            return;
+        m_ready_watches.append(watch);
+    }
+    evaluate_block_conditions();
+}
+
+void EventQueue::detach_watch(Watch& watch)
+{
+    VERIFY(m_watches_lock.is_locked());
+    // Once we're no longer observing the file, nobody can put the watch back on the ready list.
+    watch.description->blocker_set().remove_observer(watch);
+    SpinlockLocker lock(m_lock);
+    if (watch.ready_list_node.is_in_list())
+        m_ready_watches.remove(watch);
+}
+
+ErrorOr<void> EventQueue::add_watch(int fd, NonnullRefPtr<OpenFileDescription> description, epoll_event const& event)
+{
+    MutexLocker locker(m_watches_lock);
+
+    if (auto it = m_watches.find(fd); it != m_watches.end()) {
+        if (it->value->description.ptr() == description.ptr())
+            return EEXIST;
+        // The descriptor was closed and reused since it was added, so this watch is stale.
+        detach_watch(*it->value);
+        m_watches.remove(it);
+    }
+
+    auto new_watch = TRY(adopt_nonnull_own_or_enomem(new (nothrow) Watch(*this, fd, move(description), event)));
+    auto& watch = *new_watch;
+    TRY(m_watches.try_set(fd, move(new_watch)));
+
+    watch.description->blocker_set().add_observer(watch);
+    // The description may already be ready, in which case nothing would tell us about it.
+    evaluate_watch(watch);
+    return {};
+}
+
+ErrorOr<void> EventQueue::modify_watch(int fd, epoll_event const& event)
+{
+    MutexLocker locker(m_watches_lock);
+
+    auto it = m_watches.find(fd);
+    if (it == m_watches.end())
+        return ENOENT;
+
+    auto& watch = *it->value;
+    {
+        SpinlockLocker lock(m_lock);
+        watch.events = event.events;
+        watch.data = event.data.u64;
+    }
+    evaluate_watch(watch);
+    return {};
+}
+
+ErrorOr<void> EventQueue::remove_watch(int fd)
+{
+    MutexLocker locker(m_watches_lock);
+
+    auto it = m_watches.find(fd);
+    if (it == m_watches.end())
+        return ENOENT;
+
+    detach_watch(*it->value);
+    m_watches.remove(it);
+    return {};
+}
+
+ErrorOr<size_t> EventQueue::collect_ready_events(Span<epoll_event> events)
+{
+    MutexLocker locker(m_watches_lock);
+
+    Vector<Watch*, 32> candidates;
+    TRY(candidates.try_ensure_capacity(min(events.size(), m_watches.size())));
+    {
+        SpinlockLocker lock(m_lock);
+        while (candidates.size() < events.size() && !m_ready_watches.is_empty())
+            candidates.unchecked_append(m_ready_watches.take_first());
+    }
+
+    size_t event_count = 0;
+    for (auto* watch : candidates) {
+        u32 watch_events;
+        u64 watch_data;
+        {
+            SpinlockLocker lock(m_lock);
+            watch_events = watch->events;
+            watch_data = watch->data;
+        }
+
+        // The description may have stopped being ready since it was put on the ready list.
+        auto unblock_flags = watch->description->should_unblock(block_flags_for_events(watch_events));
+        if (unblock_flags == BlockFlags::None)
+            continue;
+
+        auto& event = events[event_count++];
+        event.events = events_for_unblock_flags(unblock_flags);
+        event.data.u64 = watch_data;
+
+        // Level-triggered watches stay ready until we see that they aren't anymore.
+        // Edge-triggered ones are only reported again once the file's conditions change.
+        if (!(watch_events & EPOLLET)) {
+            SpinlockLocker lock(m_lock);
+            if (!watch->ready_list_node.is_in_list())
+                m_ready_watches.append(*watch);
+        }
+    }
+    return event_count;
+}
+
+}
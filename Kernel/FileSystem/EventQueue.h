@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/IntrusiveList.h>
+#include <AK/NonnullOwnPtr.h>
+#include <Kernel/API/POSIX/sys/epoll.h>
+#include <Kernel/FileSystem/File.h>
+#include <Kernel/Forward.h>
+#include <Kernel/Locking/Mutex.h>
+
+namespace Kernel {
+
+// A persistent set of file descriptions a process is interested in. Instead of
+// scanning every description on each wait like poll() does, watched files tell
+// us when their blocking conditions change, and waiting only looks at the
+// descriptions that became ready in the meantime.
+class EventQueue final : public File {
+public:
+    static ErrorOr<NonnullRefPtr<EventQueue>> try_create();
+    virtual ~EventQueue() override;
+
+    virtual bool can_read(const OpenFileDescription&, size_t) const override;
+    virtual ErrorOr<size_t> read(OpenFileDescription&, u64, UserOrKernelBuffer&, size_t) override { return EINVAL; }
+    virtual bool can_write(const OpenFileDescription&, size_t) const override { return false; }
+    virtual ErrorOr<size_t> write(OpenFileDescription&, u64, const UserOrKernelBuffer&, size_t) override { return EINVAL; }
+    virtual ErrorOr<void> close() override;
+
+    virtual ErrorOr<NonnullOwnPtr<KString>> pseudo_path(const OpenFileDescription&) const override;
+    virtual StringView class_name() const override { return "EventQueue"sv; };
+    virtual bool is_event_queue() const override { return true; }
+
+    ErrorOr<void> add_watch(int fd, NonnullRefPtr<OpenFileDescription>, epoll_event const&);
+    ErrorOr<void> modify_watch(int fd, epoll_event const&);
+    ErrorOr<void> remove_watch(int fd);
+
+    // Fills in events for watched descriptions that are ready, and returns how many there were.
+    ErrorOr<size_t> collect_ready_events(Span<epoll_event>);
+
+private:
+    EventQueue() = default;
+
+    class Watch final : public FileBlockerSet::Observer {
+    public:
+        Watch(EventQueue& queue, int fd, NonnullRefPtr<OpenFileDescription> description, epoll_event const& event)
+            : queue(queue)
+            , fd(fd)
+            , description(move(description))
+            , events(event.events)
+            , data(event.data.u64)
+        {
+        }
+
+        virtual void blocking_conditions_changed() override { queue.evaluate_watch(*this); }
+
+        EventQueue& queue;
+        int fd { -1 };
+        NonnullRefPtr<OpenFileDescription> description;
+        u32 events { 0 };
+        u64 data { 0 };
+        IntrusiveListNode<Watch> ready_list_node;
+    };
+
+    void evaluate_watch(Watch&);
+    void detach_watch(Watch&);
+
+    // Serializes changes to the set of watches, and keeps watches alive while we're collecting events.
+    Mutex m_watches_lock;
+    HashMap<int, NonnullOwnPtr<Watch>> m_watches;
+
+    // Protects the ready list, and the event mask and data of every watch.
+    mutable Spinlock m_lock;
+    IntrusiveList<&Watch::ready_list_node> m_ready_watches;
+};
+
+}
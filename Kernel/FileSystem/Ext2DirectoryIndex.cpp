@@ -0,0 +1,434 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/StdLibExtras.h>
+#include <Kernel/API/POSIX/errno.h>
+#include <Kernel/FileSystem/Ext2DirectoryIndex.h>
+#include <Kernel/FileSystem/ext2_fs.h>
+
+namespace Kernel {
+
+static constexpr u32 rotate_left(u32 value, unsigned bits)
+{
+    return (value << bits) | (value >> (32 - bits));
+}
+
+// Packs the name into words the way the hashes expect it, padding it with its length.
+// Whether the characters are sign extended depends on the hash version.
+static void pack_name_for_hash(ReadonlyBytes name, u32* words, size_t word_count, bool is_signed)
+{
+    u32 padding = static_cast<u32>(name.size()) | (static_cast<u32>(name.size()) << 8);
+    padding |= padding << 16;
+
+    u32 value = padding;
+    size_t length = min(name.size(), word_count * 4);
+    size_t words_written = 0;
+    for (size_t i = 0; i < length; ++i) {
+        u32 character = is_signed ? static_cast<u32>(static_cast<i32>(static_cast<i8>(name[i]))) : name[i];
+        value = character + (value << 8);
+        if (i % 4 == 3) {
+            words[words_written++] = value;
+            value = padding;
+        }
+    }
+    if (words_written < word_count)
+        words[words_written++] = value;
+    while (words_written < word_count)
+        words[words_written++] = padding;
+}
+
+static u32 legacy_hash(ReadonlyBytes name, bool is_signed)
+{
+    u32 hash0 = 0x12a3fe2d;
+    u32 hash1 = 0x37abe8f9;
+    for (auto byte : name) {
+        u32 character = is_signed ? static_cast<u32>(static_cast<i32>(static_cast<i8>(byte))) : byte;
+        u32 hash = hash1 + (hash0 ^ (character * 7152373));
+        if (hash & 0x80000000)
+            hash -= 0x7fffffff;
+        hash1 = hash0;
+        hash0 = hash;
+    }
+    return hash0 << 1;
+}
+
+// The first three rounds of MD4, on eight words at a time.
+static void half_md4_transform(u32 state[4], u32 const input[8])
+{
+    u32 a = state[0];
+    u32 b = state[1];
+    u32 c = state[2];
+    u32 d = state[3];
+
+    auto f = [](u32 x, u32 y, u32 z) { return z ^ (x & (y ^ z)); };
+    auto g = [](u32 x, u32 y, u32 z) { return (x & y) + ((x ^ y) & z); };
+    auto h = [](u32 x, u32 y, u32 z) { return x ^ y ^ z; };
+    auto round = [](auto function, u32& w, u32 x, u32 y, u32 z, u32 value, unsigned shift) {
+        w = rotate_left(w + function(x, y, z) + value, shift);
+    };
+
+    round(f, a, b, c, d, input[0], 3);
+    round(f, d, a, b, c, input[1], 7);
+    round(f, c, d, a, b, input[2], 11);
+    round(f, b, c, d, a, input[3], 19);
+    round(f, a, b, c, d, input[4], 3);
+    round(f, d, a, b, c, input[5], 7);
+    round(f, c, d, a, b, input[6], 11);
+    round(f, b, c, d, a, input[7], 19);
+
+    constexpr u32 k2 = 0x5a827999;
+    round(g, a, b, c, d, input[1] + k2, 3);
+    round(g, d, a, b, c, input[3] + k2, 5);
+    round(g, c, d, a, b, input[5] + k2, 9);
+    round(g, b, c, d, a, input[7] + k2, 13);
+    round(g, a, b, c, d, input[0] + k2, 3);
+    round(g, d, a, b, c, input[2] + k2, 5);
+    round(g, c, d, a, b, input[4] + k2, 9);
+    round(g, b, c, d, a, input[6] + k2, 13);
+
+    constexpr u32 k3 = 0x6ed9eba1;
+    round(h, a, b, c, d, input[3] + k3, 3);
+    round(h, d, a, b, c, input[7] + k3, 9);
+    round(h, c, d, a, b, input[2] + k3, 11);
+    round(h, b, c, d, a, input[6] + k3, 15);
+    round(h, a, b, c, d, input[1] + k3, 3);
+    round(h, d, a, b, c, input[5] + k3, 9);
+    round(h, c, d, a, b, input[0] + k3, 11);
+    round(h, b, c, d, a, input[4] + k3, 15);
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+}
+
+static void tea_transform(u32 state[4], u32 const input[4])
+{
+    constexpr u32 delta = 0x9e3779b9;
+    u32 sum = 0;
+    u32 b0 = state[0];
+    u32 b1 = state[1];
+    for (size_t i = 0; i < 16; ++i) {
+        sum += delta;
+        b0 += ((b1 << 4) + input[0]) ^ (b1 + sum) ^ ((b1 >> 5) + input[1]);
+        b1 += ((b0 << 4) + input[2]) ^ (b0 + sum) ^ ((b0 >> 5) + input[3]);
+    }
+    state[0] += b0;
+    state[1] += b1;
+}
+
+u32 ext2_directory_name_hash(StringView name, u8 hash_version, u32 const seed[4])
+{
+    u32 state[4] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476 };
+    if (seed[0] || seed[1] || seed[2] || seed[3])
+        __builtin_memcpy(state, seed, sizeof(state));
+
+    auto bytes = name.bytes();
+    u32 hash = 0;
+    switch (hash_version) {
+    case EXT2_HASH_LEGACY:
+    case EXT2_HASH_LEGACY_UNSIGNED:
+        hash = legacy_hash(bytes, hash_version == EXT2_HASH_LEGACY);
+        break;
+    case EXT2_HASH_HALF_MD4:
+    case EXT2_HASH_HALF_MD4_UNSIGNED:
+        for (size_t offset = 0; offset < bytes.size(); offset += 32) {
+            u32 input[8];
+            pack_name_for_hash(bytes.slice(offset), input, 8, hash_version == EXT2_HASH_HALF_MD4);
+            half_md4_transform(state, input);
+        }
+        hash = state[1];
+        break;
+    case EXT2_HASH_TEA:
+    case EXT2_HASH_TEA_UNSIGNED:
+        for (size_t offset = 0; offset < bytes.size(); offset += 16) {
+            u32 input[4];
+            pack_name_for_hash(bytes.slice(offset), input, 4, hash_version == EXT2_HASH_TEA);
+            tea_transform(state, input);
+        }
+        hash = state[0];
+        break;
+    default:
+        VERIFY_NOT_REACHED();
+    }
+
+    hash &= ~1u;
+    // The largest hash is reserved to mark the end of a directory in readdir() cookies.
+    if (hash == 0xfffffffe)
+        hash = 0xfffffffc;
+    return hash;
+}
+
+ErrorOr<void> Ext2DirectoryBlock::for_each_entry(Function<ErrorOr<void>(Entry const&)> callback) const
+{
+    for (size_t offset = 0; offset < m_block.size();) {
+        auto const* entry = reinterpret_cast<ext2_dir_entry_2 const*>(m_block.offset_pointer(offset));
+        if (offset + 8 > m_block.size() || entry->rec_len < 8 || entry->rec_len % 4 || offset + entry->rec_len > m_block.size() || entry->name_len + 8u > entry->rec_len)
+            return EIO;
+        if (entry->inode != 0)
+            TRY(callback({ { entry->name, entry->name_len }, entry->inode, entry->file_type }));
+        offset += entry->rec_len;
+    }
+    return {};
+}
+
+ErrorOr<Optional<u32>> Ext2DirectoryBlock::find(StringView name) const
+{
+    Optional<u32> inode;
+    TRY(for_each_entry([&](auto& entry) -> ErrorOr<void> {
+        if (!inode.has_value() && entry.name == name)
+            inode = entry.inode;
+        return {};
+    }));
+    return inode;
+}
+
+ErrorOr<bool> Ext2DirectoryBlock::try_add(StringView name, u32 inode, u8 file_type)
+{
+    // Make sure the block is intact before we start carving it up.
+    TRY(for_each_entry([](auto&) -> ErrorOr<void> { return {}; }));
+
+    auto needed_length = record_length(name.length());
+    for (size_t offset = 0; offset < m_block.size();) {
+        auto* entry = reinterpret_cast<ext2_dir_entry_2*>(m_block.offset_pointer(offset));
+        size_t used_length = entry->inode ? record_length(entry->name_len) : 0;
+        if (entry->rec_len - used_length < needed_length) {
+            offset += entry->rec_len;
+            continue;
+        }
+
+        if (used_length) {
+            auto* new_entry = reinterpret_cast<ext2_dir_entry_2*>(m_block.offset_pointer(offset + used_length));
+            new_entry->rec_len = entry->rec_len - used_length;
+            entry->rec_len = used_length;
+            entry = new_entry;
+        }
+        entry->inode = inode;
+        entry->name_len = name.length();
+        entry->file_type = file_type;
+        __builtin_memcpy(entry->name, name.characters_without_null_termination(), name.length());
+        return true;
+    }
+    return false;
+}
+
+ErrorOr<Optional<u32>> Ext2DirectoryBlock::remove(StringView name)
+{
+    TRY(for_each_entry([](auto&) -> ErrorOr<void> { return {}; }));
+
+    ext2_dir_entry_2* previous_entry = nullptr;
+    for (size_t offset = 0; offset < m_block.size();) {
+        auto* entry = reinterpret_cast<ext2_dir_entry_2*>(m_block.offset_pointer(offset));
+        if (entry->inode != 0 && StringView(entry->name, entry->name_len) == name) {
+            u32 inode = entry->inode;
+            // The space of the entry goes to the one before it. The first one in a block has to stay, so it's just marked unused.
+            if (previous_entry)
+                previous_entry->rec_len += entry->rec_len;
+            else
+                entry->inode = 0;
+            return Optional<u32> { inode };
+        }
+        previous_entry = entry;
+        offset += entry->rec_len;
+    }
+    return Optional<u32> {};
+}
+
+void Ext2DirectoryBlock::fill(Span<Entry const> entries)
+{
+    __builtin_memset(m_block.data(), 0, m_block.size());
+    if (entries.is_empty()) {
+        auto* entry = reinterpret_cast<ext2_dir_entry_2*>(m_block.data());
+        entry->rec_len = m_block.size();
+        return;
+    }
+
+    size_t offset = 0;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        auto& entry = entries[i];
+        auto length = i + 1 == entries.size() ? m_block.size() - offset : record_length(entry.name.length());
+        VERIFY(offset + record_length(entry.name.length()) <= m_block.size());
+        auto* raw_entry = reinterpret_cast<ext2_dir_entry_2*>(m_block.offset_pointer(offset));
+        raw_entry->inode = entry.inode;
+        raw_entry->rec_len = length;
+        raw_entry->name_len = entry.name.length();
+        raw_entry->file_type = entry.file_type;
+        __builtin_memcpy(raw_entry->name, entry.name.characters_without_null_termination(), entry.name.length());
+        offset += length;
+    }
+}
+
+ErrorOr<Ext2DirectoryIndexNode> Ext2DirectoryIndexNode::try_create(Bytes block, size_t entries_offset)
+{
+    Ext2DirectoryIndexNode node { block, entries_offset };
+    if (entries_offset == root_entries_offset) {
+        auto const* info = reinterpret_cast<ext2_dx_root_info const*>(block.offset_pointer(24));
+        if (info->reserved_zero != 0 || info->info_length != 8 || (info->unused_flags & EXT2_HASH_FLAG_INCOMPAT))
+            return EINVAL;
+    } else {
+        auto const* fake_entry = reinterpret_cast<ext2_dir_entry_2 const*>(block.data());
+        if (fake_entry->inode != 0 || fake_entry->rec_len != block.size())
+            return EINVAL;
+    }
+    if (node.limit() != limit_for(block.size(), entries_offset) || node.count() == 0 || node.count() > node.limit())
+        return EINVAL;
+    return node;
+}
+
+void Ext2DirectoryIndexNode::initialize_root(Bytes block, u32 directory_inode, u32 parent_inode, u8 hash_version)
+{
+    __builtin_memset(block.data(), 0, block.size());
+
+    auto* dot = reinterpret_cast<ext2_dir_entry_2*>(block.data());
+    dot->inode = directory_inode;
+    dot->rec_len = 12;
+    dot->name_len = 1;
+    dot->file_type = EXT2_FT_DIR;
+    dot->name[0] = '.';
+
+    // ".." takes up the rest of the block, so the index looks like unused space in it.
+    auto* dot_dot = reinterpret_cast<ext2_dir_entry_2*>(block.offset_pointer(12));
+    dot_dot->inode = parent_inode;
+    dot_dot->rec_len = block.size() - 12;
+    dot_dot->name_len = 2;
+    dot_dot->file_type = EXT2_FT_DIR;
+    dot_dot->name[0] = '.';
+    dot_dot->name[1] = '.';
+
+    auto* info = reinterpret_cast<ext2_dx_root_info*>(block.offset_pointer(24));
+    info->hash_version = hash_version;
+    info->info_length = 8;
+
+    Ext2DirectoryIndexNode root { block, root_entries_offset };
+    *reinterpret_cast<u16*>(block.offset_pointer(root_entries_offset)) = limit_for(block.size(), root_entries_offset);
+    root.set_count(1);
+}
+
+void Ext2DirectoryIndexNode::initialize_interior(Bytes block)
+{
+    __builtin_memset(block.data(), 0, block.size());
+    auto* fake_entry = reinterpret_cast<ext2_dir_entry_2*>(block.data());
+    fake_entry->rec_len = block.size();
+
+    Ext2DirectoryIndexNode node { block, interior_entries_offset };
+    *reinterpret_cast<u16*>(block.offset_pointer(interior_entries_offset)) = limit_for(block.size(), interior_entries_offset);
+    node.set_count(1);
+}
+
+u8 Ext2DirectoryIndexNode::root_hash_version() const
+{
+    VERIFY(m_entries_offset == root_entries_offset);
+    return reinterpret_cast<ext2_dx_root_info const*>(m_block.offset_pointer(24))->hash_version;
+}
+
+u8 Ext2DirectoryIndexNode::root_indirect_levels() const
+{
+    VERIFY(m_entries_offset == root_entries_offset);
+    return reinterpret_cast<ext2_dx_root_info const*>(m_block.offset_pointer(24))->indirect_levels;
+}
+
+void Ext2DirectoryIndexNode::set_root_indirect_levels(u8 levels)
+{
+    VERIFY(m_entries_offset == root_entries_offset);
+    reinterpret_cast<ext2_dx_root_info*>(m_block.offset_pointer(24))->indirect_levels = levels;
+}
+
+size_t Ext2DirectoryIndexNode::count() const
+{
+    return *reinterpret_cast<u16 const*>(m_block.offset_pointer(m_entries_offset + 2));
+}
+
+size_t Ext2DirectoryIndexNode::limit() const
+{
+    return *reinterpret_cast<u16 const*>(m_block.offset_pointer(m_entries_offset));
+}
+
+void Ext2DirectoryIndexNode::set_count(size_t count)
+{
+    *reinterpret_cast<u16*>(m_block.offset_pointer(m_entries_offset + 2)) = count;
+}
+
+u32 Ext2DirectoryIndexNode::read_u32(size_t offset) const
+{
+    u32 value;
+    __builtin_memcpy(&value, m_block.offset_pointer(offset), sizeof(value));
+    return value;
+}
+
+void Ext2DirectoryIndexNode::write_u32(size_t offset, u32 value)
+{
+    __builtin_memcpy(m_block.offset_pointer(offset), &value, sizeof(value));
+}
+
+u32 Ext2DirectoryIndexNode::hash(size_t index) const
+{
+    // The first entry has the count and limit where its hash would be.
+    if (index == 0)
+        return 0;
+    return read_u32(m_entries_offset + index * 8);
+}
+
+void Ext2DirectoryIndexNode::set_hash(size_t index, u32 hash)
+{
+    VERIFY(index > 0);
+    write_u32(m_entries_offset + index * 8, hash);
+}
+
+u32 Ext2DirectoryIndexNode::block(size_t index) const
+{
+    return read_u32(m_entries_offset + index * 8 + 4);
+}
+
+void Ext2DirectoryIndexNode::set_block(size_t index, u32 block)
+{
+    write_u32(m_entries_offset + index * 8 + 4, block);
+}
+
+size_t Ext2DirectoryIndexNode::find(u32 hash) const
+{
+    // Find the last entry with a hash that isn't above the one we're looking for.
+    size_t low = 1;
+    size_t high = count();
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (this->hash(middle) > hash)
+            high = middle;
+        else
+            low = middle + 1;
+    }
+    return low - 1;
+}
+
+void Ext2DirectoryIndexNode::insert(size_t index, u32 hash, u32 block)
+{
+    VERIFY(index > 0 && index <= count() && !is_full());
+    auto* entry = m_block.offset_pointer(m_entries_offset + index * 8);
+    __builtin_memmove(entry + 8, entry, (count() - index) * 8);
+    set_count(count() + 1);
+    set_hash(index, hash);
+    set_block(index, block);
+}
+
+void Ext2DirectoryIndexNode::move_entries_to(size_t first_index, Ext2DirectoryIndexNode& other)
+{
+    VERIFY(first_index < count());
+    VERIFY(other.count() == 1 && count() - first_index <= other.limit());
+    other.set_block(0, block(first_index));
+    for (size_t i = first_index + 1; i < count(); ++i) {
+        other.set_count(other.count() + 1);
+        other.set_hash(other.count() - 1, hash(i));
+        other.set_block(other.count() - 1, block(i));
+    }
+    set_count(first_index);
+}
+
+void Ext2DirectoryIndexNode::reset(u32 block)
+{
+    set_count(1);
+    set_block(0, block);
+}
+
+}
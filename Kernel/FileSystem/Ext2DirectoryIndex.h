@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Error.h>
+#include <AK/Function.h>
+#include <AK/Optional.h>
+#include <AK/Span.h>
+#include <AK/StringView.h>
+#include <AK/Types.h>
+
+namespace Kernel {
+
+// Hash-indexed ("dir_index") directories, as ext3 and later create them.
+//
+// The first block of an indexed directory holds the "." and ".." entries, followed by the root of a tree
+// of name hashes. The tree points at the blocks that hold the actual entries (the leaves), each of which
+// holds the entries for one range of hashes. Interior nodes of the tree look like a block without entries
+// to anyone who doesn't know about the index, so every directory can still be read one block after the other.
+
+// The hash of a name in an indexed directory. The lowest bit is always 0, as it marks continued hashes in the tree.
+u32 ext2_directory_name_hash(StringView name, u8 hash_version, u32 const seed[4]);
+
+// A block of directory entries.
+class Ext2DirectoryBlock {
+public:
+    explicit Ext2DirectoryBlock(Bytes block)
+        : m_block(block)
+    {
+    }
+
+    struct Entry {
+        StringView name;
+        u32 inode { 0 };
+        u8 file_type { 0 };
+    };
+
+    ErrorOr<void> for_each_entry(Function<ErrorOr<void>(Entry const&)>) const;
+    ErrorOr<Optional<u32>> find(StringView name) const;
+
+    // Returns false if there's no room in this block.
+    ErrorOr<bool> try_add(StringView name, u32 inode, u8 file_type);
+
+    // Returns the inode of the removed entry, if there was one with that name.
+    ErrorOr<Optional<u32>> remove(StringView name);
+
+    // Replaces the contents of the block with the given entries, which have to fit.
+    void fill(Span<Entry const>);
+
+    static size_t record_length(size_t name_length) { return (name_length + 8 + 3) & ~3u; }
+
+private:
+    Bytes m_block;
+};
+
+// The index entries in the root or an interior node of the tree of an indexed directory.
+// Every entry points at the block for the hashes from its own up to the one of the next entry.
+// The first entry has no hash of its own, it covers everything below the second one.
+class Ext2DirectoryIndexNode {
+public:
+    static constexpr size_t root_entries_offset = 32;
+    static constexpr size_t interior_entries_offset = 8;
+
+    // Fails if the node doesn't look like the ones we create, e.g. because it has room for checksums.
+    static ErrorOr<Ext2DirectoryIndexNode> try_create(Bytes block, size_t entries_offset);
+
+    static void initialize_root(Bytes block, u32 directory_inode, u32 parent_inode, u8 hash_version);
+    static void initialize_interior(Bytes block);
+
+    u8 root_hash_version() const;
+    u8 root_indirect_levels() const;
+    void set_root_indirect_levels(u8);
+
+    size_t count() const;
+    size_t limit() const;
+    bool is_full() const { return count() >= limit(); }
+
+    u32 hash(size_t index) const;
+    u32 block(size_t index) const;
+    void set_block(size_t index, u32 block);
+
+    // The index of the entry whose range covers the given hash.
+    size_t find(u32 hash) const;
+
+    void insert(size_t index, u32 hash, u32 block);
+
+    // Moves the entries from the given index on to the (empty) other node.
+    void move_entries_to(size_t first_index, Ext2DirectoryIndexNode& other);
+
+    // Leaves only a single entry, pointing at the given block.
+    void reset(u32 block);
+
+private:
+    Ext2DirectoryIndexNode(Bytes block, size_t entries_offset)
+        : m_block(block)
+        , m_entries_offset(entries_offset)
+    {
+    }
+
+    static size_t limit_for(size_t block_size, size_t entries_offset) { return (block_size - entries_offset) / 8; }
+
+    void set_count(size_t);
+    void set_hash(size_t index, u32 hash);
+    u32 read_u32(size_t offset) const;
+    void write_u32(size_t offset, u32);
+
+    Bytes m_block;
+    size_t m_entries_offset { 0 };
+};
+
+}
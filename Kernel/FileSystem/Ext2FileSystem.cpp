@@ -7,6 +7,7 @@
 
 #include <AK/HashMap.h>
 #include <AK/MemoryStream.h>
+#include <AK/QuickSort.h>
 #include <AK/StdLibExtras.h>
 #include <AK/StringView.h>
 #include <Kernel/API/POSIX/errno.h>
@@ -23,6 +24,9 @@ namespace Kernel {
 static constexpr size_t max_block_size = 4096;
 static constexpr size_t max_inline_symlink_length = 60;
 
+// How many blocks past the end of a file we reserve when it is being appended to.
+static constexpr size_t preallocation_window_block_count = 16;
+
 struct Ext2FSDirectoryEntry {
     NonnullOwnPtr<KString> name;
     InodeIndex inode_index { 0 };
@@ -725,6 +729,9 @@ Ext2FSInode::Ext2FSInode(Ext2FS& fs, InodeIndex index)
 
 Ext2FSInode::~Ext2FSInode()
 {
+    // Alas, we have nowhere to propagate any errors that occur here.
+    (void)release_preallocated_blocks();
+
     if (m_raw_inode.i_links_count == 0) {
         // Alas, we have nowhere to propagate any errors that occur here.
         (void)fs().free_inode(*this);
@@ -867,6 +874,19 @@ ErrorOr<size_t> Ext2FSInode::read_bytes(off_t offset, size_t count, UserOrKernel
         if (block_index.value() == 0) {
             // This is a hole, act as if it's filled with zeroes.
             TRY(buffer_offset.memset(0, num_bytes_to_copy));
+        } else if (offset_into_block == 0 && num_bytes_to_copy == (size_t)block_size) {
+            // Read whole blocks that are contiguous on disk with a single request.
+            unsigned run_length = 1;
+            while (bi.value() + run_length <= last_block_logical_index.value()
+                && (run_length + 1) * (size_t)block_size <= (size_t)remaining_count
+                && m_block_list[bi.value() + run_length].value() == block_index.value() + run_length)
+                ++run_length;
+            if (auto result = fs().read_blocks(block_index, run_length, buffer_offset, allow_cache); result.is_error()) {
+                dmesgln("Ext2FSInode[{}]::read_bytes(): Failed to read {} blocks at {} (index {})", identifier(), run_length, block_index.value(), bi);
+                return result.release_error();
+            }
+            num_bytes_to_copy = run_length * block_size;
+            bi = bi.value() + run_length - 1;
         } else {
             if (auto result = fs().read_block(block_index, &buffer_offset, num_bytes_to_copy, offset_into_block, allow_cache); result.is_error()) {
                 dmesgln("Ext2FSInode[{}]::read_bytes(): Failed to read block {} (index {})", identifier(), block_index.value(), bi);
@@ -900,7 +920,7 @@ ErrorOr<void> Ext2FSInode::resize(u64 new_size)
 
     if (blocks_needed_after > blocks_needed_before) {
         auto additional_blocks_needed = blocks_needed_after - blocks_needed_before;
-        if (additional_blocks_needed > fs().super_block().s_free_blocks_count)
+        if (additional_blocks_needed > fs().super_block().s_free_blocks_count + m_preallocated_blocks.size())
             return ENOSPC;
     }
 
@@ -908,9 +928,9 @@ ErrorOr<void> Ext2FSInode::resize(u64 new_size)
         m_block_list = TRY(compute_block_list());
 
     if (blocks_needed_after > blocks_needed_before) {
-        auto blocks = TRY(fs().allocate_blocks(fs().group_index_from_inode(index()), blocks_needed_after - blocks_needed_before));
-        TRY(m_block_list.try_extend(move(blocks)));
+        TRY(allocate_blocks_for_append(blocks_needed_after - blocks_needed_before));
     } else if (blocks_needed_after < blocks_needed_before) {
+        TRY(release_preallocated_blocks());
         if constexpr (EXT2_VERY_DEBUG) {
             dbgln("Ext2FSInode[{}]::resize(): Shrinking inode, old block list is {} entries:", identifier(), m_block_list.size());
             for (auto block_index : m_block_list) {
@@ -953,6 +973,70 @@ ErrorOr<void> Ext2FSInode::resize(u64 new_size)
     return {};
 }
 
+ErrorOr<void> Ext2FSInode::allocate_blocks_for_append(size_t count)
+{
+    VERIFY(m_inode_lock.is_locked_by_current_thread());
+    TRY(m_block_list.try_ensure_capacity(m_block_list.size() + count));
+
+    auto preallocated_blocks_to_use = min(count, m_preallocated_blocks.size());
+    for (size_t i = 0; i < preallocated_blocks_to_use; ++i)
+        m_block_list.unchecked_append(m_preallocated_blocks[i]);
+    m_preallocated_blocks.remove(0, preallocated_blocks_to_use);
+    count -= preallocated_blocks_to_use;
+    if (count == 0)
+        return {};
+
+    // Only regular files that someone is writing to get a preallocation window; directories
+    // and files that are resized without being open would just keep the blocks from others.
+    size_t blocks_to_preallocate = 0;
+    if (Kernel::is_regular_file(m_raw_inode.i_mode) && m_attached_description_count && count + preallocation_window_block_count <= fs().super_block().s_free_blocks_count)
+        blocks_to_preallocate = preallocation_window_block_count;
+
+    BlockBasedFileSystem::BlockIndex goal = 0;
+    if (!m_block_list.is_empty() && m_block_list.last().value())
+        goal = m_block_list.last().value() + 1;
+
+    auto blocks = TRY(fs().allocate_blocks(fs().group_index_from_inode(index()), count + blocks_to_preallocate, goal));
+    for (size_t i = 0; i < count; ++i)
+        m_block_list.unchecked_append(blocks[i]);
+
+    // The preallocation is only useful if it continues the run we just handed out.
+    for (size_t i = count; i < blocks.size(); ++i) {
+        bool continues_run = blocks[i].value() == blocks[i - 1].value() + 1 && m_preallocated_blocks.size() == i - count;
+        if (!continues_run || m_preallocated_blocks.try_append(blocks[i]).is_error())
+            TRY(fs().set_block_allocation_state(blocks[i], false));
+    }
+    dbgln_if(EXT2_BLOCKLIST_DEBUG, "Ext2FSInode[{}]::allocate_blocks_for_append(): Allocated {} blocks, {} preallocated", identifier(), count, m_preallocated_blocks.size());
+    return {};
+}
+
+ErrorOr<void> Ext2FSInode::release_preallocated_blocks()
+{
+    MutexLocker locker(m_inode_lock);
+    while (!m_preallocated_blocks.is_empty()) {
+        TRY(fs().set_block_allocation_state(m_preallocated_blocks.last(), false));
+        m_preallocated_blocks.take_last();
+    }
+    return {};
+}
+
+ErrorOr<void> Ext2FSInode::attach(OpenFileDescription&)
+{
+    MutexLocker locker(m_inode_lock);
+    ++m_attached_description_count;
+    return {};
+}
+
+void Ext2FSInode::detach(OpenFileDescription&)
+{
+    MutexLocker locker(m_inode_lock);
+    VERIFY(m_attached_description_count);
+    if (--m_attached_description_count == 0) {
+        if (auto result = release_preallocated_blocks(); result.is_error())
+            dbgln("Ext2FSInode[{}]::detach(): Failed to release preallocated blocks: {}", identifier(), result.error());
+    }
+}
+
 ErrorOr<size_t> Ext2FSInode::write_bytes(off_t offset, size_t count, const UserOrKernelBuffer& data, OpenFileDescription* description)
 {
     VERIFY(offset >= 0);
@@ -1050,6 +1134,28 @@ Ext2FS::FeaturesReadOnly Ext2FS::get_features_readonly() const
     return Ext2FS::FeaturesReadOnly::None;
 }
 
+bool Ext2FS::has_directory_index_feature() const
+{
+    return m_super_block.s_rev_level > 0 && (m_super_block.s_feature_compat & EXT2_FEATURE_COMPAT_DIR_INDEX);
+}
+
+// The root of a directory index doesn't say whether the hash treats characters as signed, the super block does.
+Optional<u8> Ext2FS::directory_hash_version(u8 stored_hash_version) const
+{
+    if (stored_hash_version > EXT2_HASH_TEA)
+        return {};
+    if (m_super_block.s_flags & EXT2_FLAGS_UNSIGNED_HASH)
+        return stored_hash_version + EXT2_HASH_LEGACY_UNSIGNED;
+    return stored_hash_version;
+}
+
+u8 Ext2FS::default_directory_hash_version() const
+{
+    if (m_super_block.s_def_hash_version > EXT2_HASH_TEA)
+        return EXT2_HASH_HALF_MD4;
+    return m_super_block.s_def_hash_version;
+}
+
 ErrorOr<void> Ext2FSInode::traverse_as_directory(Function<ErrorOr<void>(FileSystem::DirectoryEntryView const&)> callback) const
 {
     VERIFY(is_directory());
@@ -1131,6 +1237,8 @@ ErrorOr<void> Ext2FSInode::write_directory(Vector<Ext2FSDirectoryEntry>& entries
     VERIFY(stream.is_end());
 
     TRY(resize(stream.size()));
+    // The directory is written as a plain list of entries, so any index it had no longer applies.
+    m_raw_inode.i_flags &= ~EXT2_INDEX_FL;
 
     auto buffer = UserOrKernelBuffer::for_kernel_buffer(stream.data());
     auto nwritten = TRY(write_bytes(0, stream.size(), buffer, nullptr));
@@ -1157,24 +1265,30 @@ ErrorOr<void> Ext2FSInode::add_child(Inode& child, StringView name, mode_t mode)
 
     dbgln_if(EXT2_DEBUG, "Ext2FSInode[{}]::add_child(): Adding inode {} with name '{}' and mode {:o} to directory {}", identifier(), child.index(), name, mode, index());
 
-    Vector<Ext2FSDirectoryEntry> entries;
-    TRY(traverse_as_directory([&](auto& entry) -> ErrorOr<void> {
-        if (name == entry.name)
+    if (has_directory_index()) {
+        auto existing_entry_or_error = lookup_in_directory_index(name);
+        if (existing_entry_or_error.is_error()) {
+            dbgln("Ext2FSInode[{}]::add_child(): Dropping unusable directory index: {}", identifier(), existing_entry_or_error.error());
+            drop_directory_index();
+        } else if (existing_entry_or_error.value().has_value()) {
             return EEXIST;
-        auto entry_name = TRY(KString::try_create(entry.name));
-        TRY(entries.try_append({ move(entry_name), entry.inode.index(), entry.file_type }));
-        return {};
-    }));
-
-    TRY(child.increment_link_count());
+        }
+    } else if (m_raw_inode.i_flags & EXT2_INDEX_FL) {
+        // We can't keep the index up to date without the feature, so nobody should use it after this.
+        drop_directory_index();
+    }
 
-    auto entry_name = TRY(KString::try_create(name));
-    TRY(entries.try_empend(move(entry_name), child.index(), to_ext2_file_type(mode)));
+    if (!has_directory_index()) {
+        TRY(populate_lookup_cache());
+        if (m_lookup_cache.find(name.hash(), [&](auto& entry) { return entry.key == name; }) != m_lookup_cache.end())
+            return EEXIST;
+    }
 
-    TRY(write_directory(entries));
-    TRY(populate_lookup_cache());
+    TRY(child.increment_link_count());
+    TRY(add_directory_entry(name, child.index(), to_ext2_file_type(mode)));
 
-    TRY(m_lookup_cache.try_set(name, child.index()));
+    if (!m_lookup_cache.is_empty())
+        TRY(m_lookup_cache.try_set(name, child.index()));
     did_add_child(child.identifier(), name);
     return {};
 }
@@ -1185,33 +1299,408 @@ ErrorOr<void> Ext2FSInode::remove_child(StringView name)
     dbgln_if(EXT2_DEBUG, "Ext2FSInode[{}]::remove_child(): Removing '{}'", identifier(), name);
     VERIFY(is_directory());
 
-    TRY(populate_lookup_cache());
+    auto child_inode_index = TRY(remove_directory_entry(name));
+    InodeIdentifier child_id { fsid(), child_inode_index };
 
-    auto it = m_lookup_cache.find(name);
-    if (it == m_lookup_cache.end())
-        return ENOENT;
-    auto child_inode_index = (*it).value;
+    m_lookup_cache.remove(name);
 
-    InodeIdentifier child_id { fsid(), child_inode_index };
+    auto child_inode = TRY(fs().get_inode(child_id));
+    TRY(child_inode->decrement_link_count());
 
-    Vector<Ext2FSDirectoryEntry> entries;
-    TRY(traverse_as_directory([&](auto& entry) -> ErrorOr<void> {
-        if (name != entry.name) {
-            auto entry_name = TRY(KString::try_create(entry.name));
-            TRY(entries.try_append({ move(entry_name), entry.inode.index(), entry.file_type }));
+    did_remove_child(child_id, name);
+    return {};
+}
+
+static ErrorOr<ByteBuffer> allocate_directory_block_buffer(size_t size)
+{
+    auto buffer = ByteBuffer::create_uninitialized(size);
+    if (!buffer.has_value())
+        return ENOMEM;
+    return buffer.release_value();
+}
+
+ErrorOr<void> Ext2FSInode::read_directory_block(u32 logical_block, Bytes block) const
+{
+    auto block_size = fs().block_size();
+    VERIFY(block.size() == block_size);
+    if ((static_cast<u64>(logical_block) + 1) * block_size > size())
+        return EIO;
+    auto buffer = UserOrKernelBuffer::for_kernel_buffer(block.data());
+    auto nread = TRY(read_bytes(static_cast<u64>(logical_block) * block_size, block_size, buffer, nullptr));
+    if (nread != block_size)
+        return EIO;
+    return {};
+}
+
+ErrorOr<void> Ext2FSInode::write_directory_block(u32 logical_block, ReadonlyBytes block)
+{
+    VERIFY(block.size() == fs().block_size());
+    auto buffer = UserOrKernelBuffer::for_kernel_buffer(const_cast<u8*>(block.data()));
+    auto nwritten = TRY(write_bytes(static_cast<u64>(logical_block) * block.size(), block.size(), buffer, nullptr));
+    if (nwritten != block.size())
+        return EIO;
+    return {};
+}
+
+// Returns the logical index of the first of the new blocks. They're added with a single write,
+// so either all of them are added or none of them are.
+ErrorOr<u32> Ext2FSInode::append_directory_blocks(ReadonlyBytes blocks)
+{
+    VERIFY(blocks.size() % fs().block_size() == 0);
+    u32 first_block = size() / fs().block_size();
+    auto buffer = UserOrKernelBuffer::for_kernel_buffer(const_cast<u8*>(blocks.data()));
+    auto nwritten = TRY(write_bytes(size(), blocks.size(), buffer, nullptr));
+    if (nwritten != blocks.size())
+        return EIO;
+    return first_block;
+}
+
+ErrorOr<void> Ext2FSInode::add_directory_entry(StringView name, InodeIndex inode, u8 file_type)
+{
+    if (has_directory_index()) {
+        if (TRY(try_add_directory_entry_to_index(name, inode, file_type)))
+            return {};
+        dbgln_if(EXT2_DEBUG, "Ext2FSInode[{}]::add_directory_entry(): Directory index is full, dropping it", identifier());
+        drop_directory_index();
+    }
+
+    auto block_size = fs().block_size();
+    auto block = TRY(allocate_directory_block_buffer(block_size));
+    u32 block_count = size() / block_size;
+
+    // New entries usually end up in the last block, so that's where we look for room first.
+    for (u32 i = 0; i < block_count; ++i) {
+        u32 logical_block = (block_count - 1 + i) % block_count;
+        TRY(read_directory_block(logical_block, block.bytes()));
+        if (TRY(Ext2DirectoryBlock(block.bytes()).try_add(name, inode.value(), file_type))) {
+            TRY(write_directory_block(logical_block, block.bytes()));
+            return {};
         }
+    }
+
+    // Like ext3, we index a directory once it outgrows its first block.
+    if (block_count == 1 && fs().has_directory_index_feature() && TRY(try_make_directory_indexed())) {
+        if (TRY(try_add_directory_entry_to_index(name, inode, file_type)))
+            return {};
+        drop_directory_index();
+        return add_directory_entry(name, inode, file_type);
+    }
+
+    Ext2DirectoryBlock new_block { block.bytes() };
+    new_block.fill({});
+    auto added = TRY(new_block.try_add(name, inode.value(), file_type));
+    VERIFY(added);
+    TRY(append_directory_blocks(block.bytes()));
+    return {};
+}
+
+ErrorOr<InodeIndex> Ext2FSInode::remove_directory_entry(StringView name)
+{
+    auto block = TRY(allocate_directory_block_buffer(fs().block_size()));
+
+    if (has_directory_index()) {
+        auto path_or_error = walk_directory_index(name);
+        if (!path_or_error.is_error()) {
+            auto path = path_or_error.release_value();
+            do {
+                TRY(read_directory_block(path.leaf_block(), block.bytes()));
+                if (auto inode = TRY(Ext2DirectoryBlock(block.bytes()).remove(name)); inode.has_value()) {
+                    TRY(write_directory_block(path.leaf_block(), block.bytes()));
+                    return InodeIndex { *inode };
+                }
+            } while (TRY(advance_to_next_directory_index_leaf(path)));
+            return ENOENT;
+        }
+        dbgln("Ext2FSInode[{}]::remove_directory_entry(): Dropping unusable directory index: {}", identifier(), path_or_error.error());
+        drop_directory_index();
+    }
+
+    u32 block_count = size() / fs().block_size();
+    for (u32 logical_block = 0; logical_block < block_count; ++logical_block) {
+        TRY(read_directory_block(logical_block, block.bytes()));
+        if (auto inode = TRY(Ext2DirectoryBlock(block.bytes()).remove(name)); inode.has_value()) {
+            TRY(write_directory_block(logical_block, block.bytes()));
+            return InodeIndex { *inode };
+        }
+    }
+    return ENOENT;
+}
+
+Ext2DirectoryIndexNode Ext2FSInode::DirectoryIndexFrame::node()
+{
+    // The node was checked when it was read.
+    return MUST(Ext2DirectoryIndexNode::try_create(data.bytes(), entries_offset));
+}
+
+bool Ext2FSInode::has_directory_index() const
+{
+    return (m_raw_inode.i_flags & EXT2_INDEX_FL) && fs().has_directory_index_feature();
+}
+
+// The index only speeds up lookups, every entry can still be found without it.
+void Ext2FSInode::drop_directory_index()
+{
+    m_raw_inode.i_flags &= ~EXT2_INDEX_FL;
+    set_metadata_dirty(true);
+}
+
+ErrorOr<Ext2FSInode::DirectoryIndexPath> Ext2FSInode::walk_directory_index(StringView name) const
+{
+    VERIFY(has_directory_index());
+    DirectoryIndexPath path;
+    size_t indirect_levels = 0;
+    u32 block = 0;
+    for (size_t level = 0; level <= indirect_levels; ++level) {
+        DirectoryIndexFrame frame;
+        frame.block = block;
+        frame.entries_offset = level == 0 ? Ext2DirectoryIndexNode::root_entries_offset : Ext2DirectoryIndexNode::interior_entries_offset;
+        frame.data = TRY(allocate_directory_block_buffer(fs().block_size()));
+        TRY(read_directory_block(block, frame.data.bytes()));
+        auto node = TRY(Ext2DirectoryIndexNode::try_create(frame.data.bytes(), frame.entries_offset));
+
+        if (level == 0) {
+            auto hash_version = fs().directory_hash_version(node.root_hash_version());
+            // More than one level of interior nodes needs the "large_dir" feature, which we don't support.
+            if (!hash_version.has_value() || node.root_indirect_levels() > 1)
+                return EINVAL;
+            indirect_levels = node.root_indirect_levels();
+            path.hash_version = hash_version.value();
+            path.hash = ext2_directory_name_hash(name, path.hash_version, fs().super_block().s_hash_seed);
+        }
+
+        frame.position = node.find(path.hash);
+        block = node.block(frame.position);
+        TRY(path.frames.try_append(move(frame)));
+    }
+    return path;
+}
+
+// Names with the same hash may have been split across two leaves, in which case the index marks the
+// hash of the second one as continued. Returns false if the hash we're looking for doesn't continue.
+ErrorOr<bool> Ext2FSInode::advance_to_next_directory_index_leaf(DirectoryIndexPath& path) const
+{
+    size_t level = path.frames.size();
+    while (level > 0 && path.frames[level - 1].position + 1 >= path.frames[level - 1].node().count())
+        --level;
+    if (level == 0)
+        return false;
+
+    auto& frame = path.frames[level - 1];
+    if ((frame.node().hash(frame.position + 1) & ~1u) != path.hash)
+        return false;
+    ++frame.position;
+
+    for (; level < path.frames.size(); ++level) {
+        auto& child = path.frames[level];
+        child.block = path.frames[level - 1].node().block(path.frames[level - 1].position);
+        TRY(read_directory_block(child.block, child.data.bytes()));
+        TRY(Ext2DirectoryIndexNode::try_create(child.data.bytes(), child.entries_offset));
+        child.position = 0;
+    }
+    return true;
+}
+
+ErrorOr<Optional<InodeIndex>> Ext2FSInode::lookup_in_directory_index(StringView name) const
+{
+    auto path = TRY(walk_directory_index(name));
+    auto block = TRY(allocate_directory_block_buffer(fs().block_size()));
+    do {
+        TRY(read_directory_block(path.leaf_block(), block.bytes()));
+        if (auto inode = TRY(Ext2DirectoryBlock(block.bytes()).find(name)); inode.has_value())
+            return Optional<InodeIndex> { InodeIndex { *inode } };
+    } while (TRY(advance_to_next_directory_index_leaf(path)));
+    return Optional<InodeIndex> {};
+}
+
+struct HashedDirectoryEntry {
+    Ext2DirectoryBlock::Entry entry;
+    u32 hash { 0 };
+};
+
+// Sorts the entries by their hash and splits them into two halves of about the same size.
+// Returns where the upper half starts, and the hash for it in the index.
+static size_t sort_and_split_directory_entries(Vector<HashedDirectoryEntry>& entries, u32& split_hash)
+{
+    VERIFY(entries.size() >= 2);
+    quick_sort(entries, [](auto& a, auto& b) { return a.hash < b.hash; });
+
+    size_t total_length = 0;
+    for (auto& entry : entries)
+        total_length += Ext2DirectoryBlock::record_length(entry.entry.name.length());
+
+    size_t split_index = entries.size() - 1;
+    size_t moved_length = Ext2DirectoryBlock::record_length(entries[split_index].entry.name.length());
+    while (split_index > 1) {
+        auto length = Ext2DirectoryBlock::record_length(entries[split_index - 1].entry.name.length());
+        if ((moved_length + length) * 2 > total_length)
+            break;
+        moved_length += length;
+        --split_index;
+    }
+
+    split_hash = entries[split_index].hash;
+    if (entries[split_index - 1].hash == split_hash)
+        split_hash |= 1;
+    return split_index;
+}
+
+static void fill_directory_block(Bytes block, Span<HashedDirectoryEntry const> entries)
+{
+    Vector<Ext2DirectoryBlock::Entry> plain_entries;
+    plain_entries.ensure_capacity(entries.size());
+    for (auto& entry : entries)
+        plain_entries.unchecked_append(entry.entry);
+    Ext2DirectoryBlock(block).fill(plain_entries);
+}
+
+ErrorOr<bool> Ext2FSInode::try_add_directory_entry_to_index(StringView name, InodeIndex inode, u8 file_type)
+{
+    auto path = TRY(walk_directory_index(name));
+    auto block_size = fs().block_size();
+    auto leaf = TRY(allocate_directory_block_buffer(block_size));
+    TRY(read_directory_block(path.leaf_block(), leaf.bytes()));
+    if (TRY(Ext2DirectoryBlock(leaf.bytes()).try_add(name, inode.value(), file_type))) {
+        TRY(write_directory_block(path.leaf_block(), leaf.bytes()));
+        return true;
+    }
+
+    // The leaf is full, so half of its entries move to a new leaf, which needs an entry in the index.
+    if (!TRY(make_room_in_directory_index(path)))
+        return false;
+
+    Vector<HashedDirectoryEntry> entries;
+    TRY(Ext2DirectoryBlock(leaf.bytes()).for_each_entry([&](auto& entry) -> ErrorOr<void> {
+        TRY(entries.try_append({ entry, ext2_directory_name_hash(entry.name, path.hash_version, fs().super_block().s_hash_seed) }));
         return {};
     }));
+    if (entries.size() < 2)
+        return false;
 
-    TRY(write_directory(entries));
+    u32 split_hash = 0;
+    auto split_index = sort_and_split_directory_entries(entries, split_hash);
+    auto lower_leaf = TRY(allocate_directory_block_buffer(block_size));
+    auto upper_leaf = TRY(allocate_directory_block_buffer(block_size));
+    fill_directory_block(lower_leaf.bytes(), entries.span().trim(split_index));
+    fill_directory_block(upper_leaf.bytes(), entries.span().slice(split_index));
+
+    auto lower_leaf_block = path.leaf_block();
+    auto upper_leaf_block = TRY(append_directory_blocks(upper_leaf.bytes()));
+    TRY(write_directory_block(lower_leaf_block, lower_leaf.bytes()));
+    auto& frame = path.frames.last();
+    frame.node().insert(frame.position + 1, split_hash, upper_leaf_block);
+    TRY(write_directory_block(frame.block, frame.data.bytes()));
+
+    bool goes_to_upper_leaf = path.hash >= (split_hash & ~1u);
+    auto& target_leaf = goes_to_upper_leaf ? upper_leaf : lower_leaf;
+    if (!TRY(Ext2DirectoryBlock(target_leaf.bytes()).try_add(name, inode.value(), file_type)))
+        return false;
+    TRY(write_directory_block(goes_to_upper_leaf ? upper_leaf_block : lower_leaf_block, target_leaf.bytes()));
+    return true;
+}
 
-    m_lookup_cache.remove(name);
+// Makes sure the lowest node on the path has room for one more entry, by splitting it or by adding a level
+// to the tree. Returns false if the tree can't grow any further.
+ErrorOr<bool> Ext2FSInode::make_room_in_directory_index(DirectoryIndexPath& path)
+{
+    auto block_size = fs().block_size();
+    auto& bottom_frame = path.frames.last();
+    if (!bottom_frame.node().is_full())
+        return true;
+
+    if (path.frames.size() == 1) {
+        // The entries of the root move to a new interior node, which becomes the only child of the root.
+        DirectoryIndexFrame interior_frame;
+        interior_frame.entries_offset = Ext2DirectoryIndexNode::interior_entries_offset;
+        interior_frame.data = TRY(allocate_directory_block_buffer(block_size));
+        interior_frame.position = bottom_frame.position;
+        Ext2DirectoryIndexNode::initialize_interior(interior_frame.data.bytes());
+        auto root = bottom_frame.node();
+        auto interior = interior_frame.node();
+        root.move_entries_to(0, interior);
+
+        interior_frame.block = TRY(append_directory_blocks(interior_frame.data.bytes()));
+        root.reset(interior_frame.block);
+        root.set_root_indirect_levels(1);
+        TRY(write_directory_block(bottom_frame.block, bottom_frame.data.bytes()));
+
+        bottom_frame.position = 0;
+        TRY(path.frames.try_append(move(interior_frame)));
+        return true;
+    }
 
-    auto child_inode = TRY(fs().get_inode(child_id));
-    TRY(child_inode->decrement_link_count());
+    VERIFY(path.frames.size() == 2);
+    auto& root_frame = path.frames.first();
+    if (root_frame.node().is_full())
+        return false;
 
-    did_remove_child(child_id, name);
-    return {};
+    // The upper half of the interior node moves to a new one next to it.
+    DirectoryIndexFrame new_frame;
+    new_frame.entries_offset = Ext2DirectoryIndexNode::interior_entries_offset;
+    new_frame.data = TRY(allocate_directory_block_buffer(block_size));
+    Ext2DirectoryIndexNode::initialize_interior(new_frame.data.bytes());
+    auto interior = bottom_frame.node();
+    auto new_interior = new_frame.node();
+    size_t split_index = interior.count() / 2;
+    u32 split_hash = interior.hash(split_index);
+    interior.move_entries_to(split_index, new_interior);
+
+    new_frame.block = TRY(append_directory_blocks(new_frame.data.bytes()));
+    TRY(write_directory_block(bottom_frame.block, bottom_frame.data.bytes()));
+    root_frame.node().insert(root_frame.position + 1, split_hash, new_frame.block);
+    TRY(write_directory_block(root_frame.block, root_frame.data.bytes()));
+
+    if (bottom_frame.position >= split_index) {
+        new_frame.position = bottom_frame.position - split_index;
+        bottom_frame = move(new_frame);
+        ++root_frame.position;
+    }
+    return true;
+}
+
+// Turns a directory that has outgrown its first block into an indexed one: The first block becomes
+// the root of the index, and the entries are split between two new leaves.
+ErrorOr<bool> Ext2FSInode::try_make_directory_indexed()
+{
+    auto block_size = fs().block_size();
+    VERIFY(size() == block_size);
+
+    auto old_block = TRY(allocate_directory_block_buffer(block_size));
+    TRY(read_directory_block(0, old_block.bytes()));
+
+    auto stored_hash_version = fs().default_directory_hash_version();
+    auto hash_version = fs().directory_hash_version(stored_hash_version).value();
+    u32 parent_inode = 0;
+    Vector<HashedDirectoryEntry> entries;
+    TRY(Ext2DirectoryBlock(old_block.bytes()).for_each_entry([&](auto& entry) -> ErrorOr<void> {
+        if (entry.name == "."sv)
+            return {};
+        if (entry.name == ".."sv) {
+            parent_inode = entry.inode;
+            return {};
+        }
+        TRY(entries.try_append({ entry, ext2_directory_name_hash(entry.name, hash_version, fs().super_block().s_hash_seed) }));
+        return {};
+    }));
+    if (parent_inode == 0 || entries.size() < 2)
+        return false;
+
+    u32 split_hash = 0;
+    auto split_index = sort_and_split_directory_entries(entries, split_hash);
+    auto leaves = TRY(allocate_directory_block_buffer(2 * block_size));
+    fill_directory_block(leaves.bytes().trim(block_size), entries.span().trim(split_index));
+    fill_directory_block(leaves.bytes().slice(block_size), entries.span().slice(split_index));
+    auto first_leaf_block = TRY(append_directory_blocks(leaves.bytes()));
+
+    auto root_block = TRY(allocate_directory_block_buffer(block_size));
+    Ext2DirectoryIndexNode::initialize_root(root_block.bytes(), index().value(), parent_inode, stored_hash_version);
+    auto root = MUST(Ext2DirectoryIndexNode::try_create(root_block.bytes(), Ext2DirectoryIndexNode::root_entries_offset));
+    root.set_block(0, first_leaf_block);
+    root.insert(1, split_hash, first_leaf_block + 1);
+    TRY(write_directory_block(0, root_block.bytes()));
+
+    m_raw_inode.i_flags |= EXT2_INDEX_FL;
+    set_metadata_dirty(true);
+    return true;
 }
 
 u64 Ext2FS::inodes_per_block() const
@@ -1243,9 +1732,9 @@ ErrorOr<void> Ext2FS::write_ext2_inode(InodeIndex inode, ext2_inode const& e2ino
     return write_block(block_index, buffer, inode_size(), offset);
 }
 
-auto Ext2FS::allocate_blocks(GroupIndex preferred_group_index, size_t count) -> ErrorOr<Vector<BlockIndex>>
+auto Ext2FS::allocate_blocks(GroupIndex preferred_group_index, size_t count, BlockIndex goal) -> ErrorOr<Vector<BlockIndex>>
 {
-    dbgln_if(EXT2_DEBUG, "Ext2FS: allocate_blocks(preferred group: {}, count {})", preferred_group_index, count);
+    dbgln_if(EXT2_DEBUG, "Ext2FS: allocate_blocks(preferred group: {}, count {}, goal {})", preferred_group_index, count, goal);
     if (count == 0)
         return Vector<BlockIndex> {};
 
@@ -1253,9 +1742,32 @@ auto Ext2FS::allocate_blocks(GroupIndex preferred_group_index, size_t count) ->
     TRY(blocks.try_ensure_capacity(count));
 
     MutexLocker locker(m_lock);
+
+    // Try to continue right where the caller's last block ended, so that files that are
+    // appended to end up in one contiguous run on disk.
+    if (goal.value() && goal.value() < super_block().s_blocks_count) {
+        auto goal_group_index = group_index_from_block_index(goal);
+        auto const& bgd = group_descriptor(goal_group_index);
+        if (bgd.bg_free_blocks_count) {
+            auto* cached_bitmap = TRY(get_bitmap_block(bgd.bg_block_bitmap));
+            int blocks_in_group = min(blocks_per_group(), super_block().s_blocks_count);
+            auto block_bitmap = cached_bitmap->bitmap(blocks_in_group);
+            BlockIndex first_block_in_group = (goal_group_index.value() - 1) * blocks_per_group() + first_block_index().value();
+            for (auto bit_index = goal.value() - first_block_in_group.value(); blocks.size() < count && bit_index < (size_t)blocks_in_group; ++bit_index) {
+                if (block_bitmap.get(bit_index))
+                    break;
+                BlockIndex block_index = bit_index + first_block_in_group.value();
+                TRY(set_block_allocation_state(block_index, true));
+                blocks.unchecked_append(block_index);
+                dbgln_if(EXT2_DEBUG, "  allocated at goal > {}", block_index);
+            }
+            preferred_group_index = goal_group_index;
+        }
+    }
+
     auto group_index = preferred_group_index;
 
-    if (!group_descriptor(preferred_group_index).bg_free_blocks_count) {
+    if (blocks.size() < count && !group_descriptor(preferred_group_index).bg_free_blocks_count) {
         group_index = 1;
     }
 
@@ -1543,6 +2055,24 @@ ErrorOr<NonnullRefPtr<Inode>> Ext2FSInode::lookup(StringView name)
 {
     VERIFY(is_directory());
     dbgln_if(EXT2_DEBUG, "Ext2FSInode[{}]:lookup(): Looking up '{}'", identifier(), name);
+
+    if (has_directory_index()) {
+        // With an index, we only have to read the blocks on the way to the name.
+        auto inode_index_or_error = [&] {
+            MutexLocker locker(m_inode_lock);
+            return lookup_in_directory_index(name);
+        }();
+        if (!inode_index_or_error.is_error()) {
+            auto inode_index = inode_index_or_error.release_value();
+            if (!inode_index.has_value()) {
+                dbgln_if(EXT2_DEBUG, "Ext2FSInode[{}]:lookup(): '{}' not found", identifier(), name);
+                return ENOENT;
+            }
+            return fs().get_inode({ fsid(), *inode_index });
+        }
+        dbgln("Ext2FSInode[{}]:lookup(): Ignoring unusable directory index: {}", identifier(), inode_index_or_error.error());
+    }
+
     TRY(populate_lookup_cache());
 
     InodeIndex inode_index;
@@ -7,8 +7,10 @@
 #pragma once
 
 #include <AK/Bitmap.h>
+#include <AK/ByteBuffer.h>
 #include <AK/HashMap.h>
 #include <Kernel/FileSystem/BlockBasedFileSystem.h>
+#include <Kernel/FileSystem/Ext2DirectoryIndex.h>
 #include <Kernel/FileSystem/Inode.h>
 #include <Kernel/FileSystem/ext2_fs.h>
 #include <Kernel/KBuffer.h>
@@ -53,10 +55,46 @@ private:
     virtual ErrorOr<void> chown(UserID, GroupID) override;
     virtual ErrorOr<void> truncate(u64) override;
     virtual ErrorOr<int> get_block_address(int) override;
+    virtual ErrorOr<void> attach(OpenFileDescription&) override;
+    virtual void detach(OpenFileDescription&) override;
 
     ErrorOr<void> write_directory(Vector<Ext2FSDirectoryEntry>&);
     ErrorOr<void> populate_lookup_cache() const;
+
+    ErrorOr<void> read_directory_block(u32 logical_block, Bytes) const;
+    ErrorOr<void> write_directory_block(u32 logical_block, ReadonlyBytes);
+    ErrorOr<u32> append_directory_blocks(ReadonlyBytes);
+    ErrorOr<void> add_directory_entry(StringView name, InodeIndex, u8 file_type);
+    ErrorOr<InodeIndex> remove_directory_entry(StringView name);
+
+    // The path from the root of a hash-indexed directory down to the leaf that holds a name.
+    struct DirectoryIndexFrame {
+        u32 block { 0 };
+        size_t entries_offset { 0 };
+        ByteBuffer data;
+        size_t position { 0 };
+
+        Ext2DirectoryIndexNode node();
+    };
+    struct DirectoryIndexPath {
+        Vector<DirectoryIndexFrame, 2> frames;
+        u8 hash_version { 0 };
+        u32 hash { 0 };
+
+        u32 leaf_block() { return frames.last().node().block(frames.last().position); }
+    };
+
+    bool has_directory_index() const;
+    void drop_directory_index();
+    ErrorOr<DirectoryIndexPath> walk_directory_index(StringView name) const;
+    ErrorOr<bool> advance_to_next_directory_index_leaf(DirectoryIndexPath&) const;
+    ErrorOr<Optional<InodeIndex>> lookup_in_directory_index(StringView name) const;
+    ErrorOr<bool> try_add_directory_entry_to_index(StringView name, InodeIndex, u8 file_type);
+    ErrorOr<bool> make_room_in_directory_index(DirectoryIndexPath&);
+    ErrorOr<bool> try_make_directory_indexed();
     ErrorOr<void> resize(u64);
+    ErrorOr<void> allocate_blocks_for_append(size_t count);
+    ErrorOr<void> release_preallocated_blocks();
     ErrorOr<void> write_indirect_block(BlockBasedFileSystem::BlockIndex, Span<BlockBasedFileSystem::BlockIndex>);
     ErrorOr<void> grow_doubly_indirect_block(BlockBasedFileSystem::BlockIndex, size_t, Span<BlockBasedFileSystem::BlockIndex>, Vector<BlockBasedFileSystem::BlockIndex>&, unsigned&);
     ErrorOr<void> shrink_doubly_indirect_block(BlockBasedFileSystem::BlockIndex, size_t, size_t, unsigned&);
@@ -73,6 +111,13 @@ private:
     Ext2FSInode(Ext2FS&, InodeIndex);
 
     mutable Vector<BlockBasedFileSystem::BlockIndex> m_block_list;
+
+    // Blocks directly following the end of m_block_list that have been marked as allocated
+    // but don't belong to the file yet. Appends take blocks from here first, so a file that
+    // grows a little at a time still ends up contiguous on disk. These are not counted in
+    // i_blocks, and are given back once the last description for this inode is closed.
+    Vector<BlockBasedFileSystem::BlockIndex> m_preallocated_blocks;
+    size_t m_attached_description_count { 0 };
     mutable HashMap<String, InodeIndex> m_lookup_cache;
     ext2_inode m_raw_inode {};
 };
@@ -99,11 +144,16 @@ public:
     virtual ErrorOr<void> prepare_to_unmount() override;
 
     virtual bool supports_watchers() const override { return true; }
+    virtual bool supports_directory_entry_caching() const override { return true; }
 
     virtual u8 internal_file_type_to_directory_entry_type(const DirectoryEntryView& entry) const override;
 
     FeaturesReadOnly get_features_readonly() const;
 
+    bool has_directory_index_feature() const;
+    Optional<u8> directory_hash_version(u8 stored_hash_version) const;
+    u8 default_directory_hash_version() const;
+
 private:
     TYPEDEF_DISTINCT_ORDERED_ID(unsigned, GroupIndex);
 
@@ -133,7 +183,7 @@ private:
 
     BlockIndex first_block_index() const;
     ErrorOr<InodeIndex> allocate_inode(GroupIndex preferred_group = 0);
-    ErrorOr<Vector<BlockIndex>> allocate_blocks(GroupIndex preferred_group_index, size_t count);
+    ErrorOr<Vector<BlockIndex>> allocate_blocks(GroupIndex preferred_group_index, size_t count, BlockIndex goal = 0);
     GroupIndex group_index_from_inode(InodeIndex) const;
     GroupIndex group_index_from_block_index(BlockIndex) const;
 
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <AK/Error.h>
+#include <AK/IntrusiveList.h>
 #include <AK/NonnullRefPtr.h>
 #include <AK/RefCounted.h>
 #include <AK/StringView.h>
@@ -23,8 +24,37 @@ class File;
 
 class FileBlockerSet final : public Thread::BlockerSet {
 public:
+    // An observer hears about every evaluation of the file's blocking conditions,
+    // without having to keep a thread blocked on the file.
+    class Observer {
+    public:
+        virtual ~Observer() = default;
+        virtual void blocking_conditions_changed() = 0;
+
+    private:
+        friend class FileBlockerSet;
+        IntrusiveListNode<Observer> m_observer_list_node;
+    };
+
     FileBlockerSet() { }
 
+    virtual ~FileBlockerSet() override
+    {
+        VERIFY(m_observers.is_empty());
+    }
+
+    void add_observer(Observer& observer)
+    {
+        SpinlockLocker lock(m_lock);
+        m_observers.append(observer);
+    }
+
+    void remove_observer(Observer& observer)
+    {
+        SpinlockLocker lock(m_lock);
+        m_observers.remove(observer);
+    }
+
     virtual bool should_add_blocker(Thread::Blocker& b, void* data) override
     {
         VERIFY(b.blocker_type() == Thread::Blocker::Type::File);
@@ -40,7 +70,12 @@ public:
             auto& blocker = static_cast<Thread::FileBlocker&>(b);
             return blocker.unblock_if_conditions_are_met(false, data);
         });
+        for (auto& observer : m_observers)
+            observer.blocking_conditions_changed();
     }
+
+private:
+    IntrusiveList<&Observer::m_observer_list_node> m_observers;
 };
 
 // File is the base class for anything that can be referenced by a OpenFileDescription.
@@ -114,6 +149,7 @@ public:
     virtual bool is_character_device() const { return false; }
     virtual bool is_socket() const { return false; }
     virtual bool is_inode_watcher() const { return false; }
+    virtual bool is_event_queue() const { return false; }
 
     virtual FileBlockerSet& blocker_set() { return m_blocker_set; }
 
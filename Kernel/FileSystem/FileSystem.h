@@ -35,6 +35,9 @@ public:
     virtual StringView class_name() const = 0;
     virtual Inode& root_inode() = 0;
     virtual bool supports_watchers() const { return false; }
+    // Whether every change to a directory is reported through Inode::did_add_child() and Inode::did_remove_child(),
+    // so path resolution may cache the results of looking up names in it.
+    virtual bool supports_directory_entry_caching() const { return false; }
 
     bool is_readonly() const { return m_readonly; }
 
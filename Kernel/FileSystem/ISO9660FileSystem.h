@@ -311,6 +311,8 @@ public:
     virtual ErrorOr<void> initialize() override;
     virtual StringView class_name() const override { return "ISO9660FS"sv; }
     virtual Inode& root_inode() override;
+    // We're read-only, so our directories never change.
+    virtual bool supports_directory_entry_caching() const override { return true; }
 
     virtual unsigned total_block_count() const override;
     virtual unsigned total_inode_count() const override;
@@ -204,6 +204,8 @@ void Inode::set_metadata_dirty(bool metadata_dirty)
 
 void Inode::did_add_child(InodeIdentifier, StringView name)
 {
+    VirtualFileSystem::the().directory_entry_cache().invalidate(identifier(), name);
+
     MutexLocker locker(m_inode_lock);
 
     for (auto& watcher : m_watchers) {
@@ -213,6 +215,8 @@ void Inode::did_add_child(InodeIdentifier, StringView name)
 
 void Inode::did_remove_child(InodeIdentifier, StringView name)
 {
+    VirtualFileSystem::the().directory_entry_cache().invalidate(identifier(), name);
+
     MutexLocker locker(m_inode_lock);
 
     if (name == "." || name == "..") {
@@ -86,6 +86,10 @@ public:
     void set_shared_vmobject(Memory::SharedInodeVMObject&);
     RefPtr<Memory::SharedInodeVMObject> shared_vmobject() const;
 
+    // File systems that keep file contents in physical pages can hand those pages out here,
+    // so that shared mappings of the file use them directly instead of reading in a copy.
+    virtual void share_physical_pages(Span<RefPtr<Memory::PhysicalPage>>) const { }
+
     static void sync_all();
     void sync();
 
@@ -31,7 +31,11 @@ ErrorOr<size_t> InodeFile::read(OpenFileDescription& description, u64 offset, Us
     if (Checked<off_t>::addition_would_overflow(offset, count))
         return EOVERFLOW;
 
-    auto nread = TRY(m_inode->read_bytes(offset, count, buffer, &description));
+    size_t nread = 0;
+    if (auto shared_vmobject = m_inode->shared_vmobject())
+        nread = TRY(shared_vmobject->read_bytes(offset, count, buffer, &description));
+    else
+        nread = TRY(m_inode->read_bytes(offset, count, buffer, &description));
     if (nread > 0) {
         Thread::current()->did_file_read(nread);
         evaluate_block_conditions();
@@ -47,6 +51,8 @@ ErrorOr<size_t> InodeFile::write(OpenFileDescription& description, u64 offset, c
     auto nwritten = TRY(m_inode->write_bytes(offset, count, data, &description));
     if (nwritten > 0) {
         auto mtime_result = m_inode->set_mtime(kgettimeofday().to_truncated_seconds());
+        if (auto shared_vmobject = m_inode->shared_vmobject())
+            TRY(shared_vmobject->did_write_bytes(offset, nwritten, data));
         Thread::current()->did_file_write(nwritten);
         evaluate_block_conditions();
         if (mtime_result.is_error())
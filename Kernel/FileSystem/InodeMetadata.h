@@ -35,6 +35,28 @@ inline bool is_sticky(mode_t mode) { return (mode & S_ISVTX) == S_ISVTX; }
 inline bool is_setuid(mode_t mode) { return (mode & S_ISUID) == S_ISUID; }
 inline bool is_setgid(mode_t mode) { return (mode & S_ISGID) == S_ISGID; }
 
+inline u8 directory_entry_type_from_mode(mode_t mode)
+{
+    switch (mode & S_IFMT) {
+    case S_IFREG:
+        return DT_REG;
+    case S_IFDIR:
+        return DT_DIR;
+    case S_IFCHR:
+        return DT_CHR;
+    case S_IFBLK:
+        return DT_BLK;
+    case S_IFIFO:
+        return DT_FIFO;
+    case S_IFSOCK:
+        return DT_SOCK;
+    case S_IFLNK:
+        return DT_LNK;
+    default:
+        return DT_UNKNOWN;
+    }
+}
+
 struct InodeMetadata {
     bool is_valid() const { return inode.is_valid(); }
 
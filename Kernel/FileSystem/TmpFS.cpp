@@ -5,6 +5,7 @@
  */
 
 #include <Kernel/FileSystem/TmpFS.h>
+#include <Kernel/Memory/MemoryManager.h>
 #include <Kernel/Process.h>
 #include <LibC/limits.h>
 
@@ -116,11 +117,11 @@ ErrorOr<void> TmpFSInode::traverse_as_directory(Function<ErrorOr<void>(FileSyste
     if (!is_directory())
         return ENOTDIR;
 
-    TRY(callback({ ".", identifier(), 0 }));
-    TRY(callback({ "..", m_parent, 0 }));
+    TRY(callback({ ".", identifier(), DT_DIR }));
+    TRY(callback({ "..", m_parent, DT_DIR }));
 
     for (auto& child : m_children) {
-        TRY(callback({ child.name->view(), child.inode->identifier(), 0 }));
+        TRY(callback({ child.name->view(), child.inode->identifier(), directory_entry_type_from_mode(child.inode->m_metadata.mode) }));
     }
     return {};
 }
@@ -131,17 +132,30 @@ ErrorOr<size_t> TmpFSInode::read_bytes(off_t offset, size_t size, UserOrKernelBu
     VERIFY(!is_directory());
     VERIFY(offset >= 0);
 
-    if (!m_content)
-        return 0;
-
     if (offset >= m_metadata.size)
         return 0;
 
     if (static_cast<off_t>(size) > m_metadata.size - offset)
         size = m_metadata.size - offset;
 
-    TRY(buffer.write(m_content->data() + offset, size));
-    return size;
+    size_t nread = 0;
+    while (nread < size) {
+        auto position = offset + nread;
+        auto page_index = position / PAGE_SIZE;
+        auto offset_in_page = position % PAGE_SIZE;
+        auto chunk_size = min(size - nread, PAGE_SIZE - offset_in_page);
+
+        auto const& page = m_pages[page_index];
+        if (page) {
+            u8 page_buffer[PAGE_SIZE];
+            MM.copy_physical_page(const_cast<Memory::PhysicalPage&>(*page), page_buffer);
+            TRY(buffer.write(page_buffer + offset_in_page, nread, chunk_size));
+        } else {
+            TRY(buffer.memset(0, nread, chunk_size));
+        }
+        nread += chunk_size;
+    }
+    return nread;
 }
 
 ErrorOr<size_t> TmpFSInode::write_bytes(off_t offset, size_t size, const UserOrKernelBuffer& buffer, OpenFileDescription*)
@@ -158,31 +172,45 @@ ErrorOr<size_t> TmpFSInode::write_bytes(off_t offset, size_t size, const UserOrK
         new_size = offset + size;
 
     if (static_cast<u64>(new_size) > (NumericLimits<size_t>::max() / 2)) // on 32-bit, size_t might be 32 bits while off_t is 64 bits
-        return ENOMEM;                                                   // we won't be able to resize to this capacity
+        return ENOMEM;                                                   // we won't be able to grow the page list to this size
+
+    if (new_size > old_size)
+        TRY(m_pages.try_resize(ceil_div(static_cast<size_t>(new_size), static_cast<size_t>(PAGE_SIZE))));
+
+    // Only the pages that are actually written to get touched, so appending to a file
+    // costs the same no matter how large the file already is.
+    size_t nwritten = 0;
+    while (nwritten < size) {
+        auto position = offset + nwritten;
+        auto page_index = position / PAGE_SIZE;
+        auto offset_in_page = position % PAGE_SIZE;
+        auto chunk_size = min(size - nwritten, PAGE_SIZE - offset_in_page);
+
+        auto& page = m_pages[page_index];
+        bool is_new_page = !page;
+        if (is_new_page) {
+            page = MM.allocate_user_physical_page(Memory::MemoryManager::ShouldZeroFill::Yes);
+            if (!page)
+                return ENOMEM;
+        }
 
-    if (new_size > old_size) {
-        if (m_content && static_cast<off_t>(m_content->capacity()) >= new_size) {
-            m_content->set_size(new_size);
-        } else {
-            // Grow the content buffer 2x the new size to accommodate repeating write() calls.
-            // Note that we're not actually committing physical memory to the buffer
-            // until it's needed. We only grow VM here.
-
-            // FIXME: Fix this so that no memcpy() is necessary, and we can just grow the
-            //        KBuffer and it will add physical pages as needed while keeping the
-            //        existing ones.
-            auto tmp = TRY(KBuffer::try_create_with_size(new_size * 2));
-            tmp->set_size(new_size);
-            if (m_content)
-                memcpy(tmp->data(), m_content->data(), old_size);
-            m_content = move(tmp);
+        u8 page_buffer[PAGE_SIZE];
+        if (chunk_size != PAGE_SIZE) {
+            if (is_new_page)
+                memset(page_buffer, 0, PAGE_SIZE);
+            else
+                MM.copy_physical_page(*page, page_buffer);
         }
+        TRY(buffer.read(page_buffer + offset_in_page, nwritten, chunk_size)); // TODO: partial reads?
+        MM.fill_physical_page(*page, page_buffer);
+        nwritten += chunk_size;
+    }
+
+    if (new_size > old_size) {
         m_metadata.size = new_size;
         set_metadata_dirty(true);
     }
 
-    TRY(buffer.read(m_content->data() + offset, size)); // TODO: partial reads?
-
     did_modify_contents();
     return size;
 }
@@ -317,20 +345,21 @@ ErrorOr<void> TmpFSInode::truncate(u64 size)
     MutexLocker locker(m_inode_lock);
     VERIFY(!is_directory());
 
-    if (size == 0)
-        m_content.clear();
-    else if (!m_content) {
-        m_content = TRY(KBuffer::try_create_with_size(size));
-    } else if (static_cast<size_t>(size) < m_content->capacity()) {
-        size_t prev_size = m_metadata.size;
-        m_content->set_size(size);
-        if (prev_size < static_cast<size_t>(size))
-            memset(m_content->data() + prev_size, 0, size - prev_size);
-    } else {
-        size_t prev_size = m_metadata.size;
-        auto tmp = TRY(KBuffer::try_create_with_size(size));
-        memcpy(tmp->data(), m_content->data(), prev_size);
-        m_content = move(tmp);
+    if (size > (NumericLimits<size_t>::max() / 2))
+        return ENOMEM;
+
+    size_t old_size = m_metadata.size;
+    TRY(m_pages.try_resize(ceil_div(static_cast<size_t>(size), static_cast<size_t>(PAGE_SIZE))));
+
+    // Clear the tail of the last page, so growing the file again reads back zeroes.
+    auto offset_in_last_page = size % PAGE_SIZE;
+    if (size < old_size && offset_in_last_page != 0) {
+        if (auto& page = m_pages.last()) {
+            u8 page_buffer[PAGE_SIZE];
+            MM.copy_physical_page(*page, page_buffer);
+            memset(page_buffer + offset_in_last_page, 0, PAGE_SIZE - offset_in_last_page);
+            MM.fill_physical_page(*page, page_buffer);
+        }
     }
 
     m_metadata.size = size;
@@ -370,4 +399,11 @@ void TmpFSInode::remove_from_secondary_lists()
     fs().unregister_inode(identifier());
 }
 
+void TmpFSInode::share_physical_pages(Span<RefPtr<Memory::PhysicalPage>> pages) const
+{
+    MutexLocker locker(m_inode_lock, Mutex::Mode::Shared);
+    for (size_t i = 0; i < min(pages.size(), m_pages.size()); ++i)
+        pages[i] = m_pages[i];
+}
+
 }
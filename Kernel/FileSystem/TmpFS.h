@@ -8,7 +8,7 @@
 
 #include <Kernel/FileSystem/FileSystem.h>
 #include <Kernel/FileSystem/Inode.h>
-#include <Kernel/KBuffer.h>
+#include <Kernel/Memory/PhysicalPage.h>
 
 namespace Kernel {
 
@@ -25,6 +25,7 @@ public:
     virtual StringView class_name() const override { return "TmpFS"sv; }
 
     virtual bool supports_watchers() const override { return true; }
+    virtual bool supports_directory_entry_caching() const override { return true; }
 
     virtual Inode& root_inode() override;
 
@@ -68,6 +69,7 @@ public:
     virtual ErrorOr<void> set_ctime(time_t) override;
     virtual ErrorOr<void> set_mtime(time_t) override;
     virtual void remove_from_secondary_lists() override;
+    virtual void share_physical_pages(Span<RefPtr<Memory::PhysicalPage>>) const override;
 
 private:
     TmpFSInode(TmpFS& fs, const InodeMetadata& metadata, InodeIdentifier parent);
@@ -86,7 +88,9 @@ private:
     InodeMetadata m_metadata;
     InodeIdentifier m_parent;
 
-    OwnPtr<KBuffer> m_content;
+    // File contents, one physical page at a time. Pages that have never been written
+    // to are null and read back as zeroes.
+    Vector<RefPtr<Memory::PhysicalPage>> m_pages;
 
     Child::List m_children;
 };
@@ -52,6 +52,7 @@ InodeIdentifier VirtualFileSystem::root_inode_id() const
 
 ErrorOr<void> VirtualFileSystem::mount(FileSystem& fs, Custody& mount_point, int flags)
 {
+    m_directory_entry_cache.invalidate_all();
     return m_mounts.with_exclusive([&](auto& mounts) -> ErrorOr<void> {
         auto& inode = mount_point.inode();
         dbgln("VirtualFileSystem: Mounting {} at inode {} with flags {}",
@@ -67,6 +68,7 @@ ErrorOr<void> VirtualFileSystem::mount(FileSystem& fs, Custody& mount_point, int
 
 ErrorOr<void> VirtualFileSystem::bind_mount(Custody& source, Custody& mount_point, int flags)
 {
+    m_directory_entry_cache.invalidate_all();
     return m_mounts.with_exclusive([&](auto& mounts) -> ErrorOr<void> {
         dbgln("VirtualFileSystem: Bind-mounting inode {} at inode {}", source.inode().identifier(), mount_point.inode().identifier());
         // FIXME: check that this is not already a mount point
@@ -85,6 +87,8 @@ ErrorOr<void> VirtualFileSystem::remount(Custody& mount_point, int new_flags)
         return ENODEV;
 
     mount->set_flags(new_flags);
+    // Cached custodies carry the mount flags they were resolved with.
+    m_directory_entry_cache.invalidate_all();
     return {};
 }
 
@@ -92,6 +96,9 @@ ErrorOr<void> VirtualFileSystem::unmount(Inode& guest_inode)
 {
     dbgln("VirtualFileSystem: unmount called with inode {}", guest_inode.identifier());
 
+    // Cached custodies keep inodes of the file system alive, which would make it look busy.
+    m_directory_entry_cache.invalidate_all();
+
     return m_mounts.with_exclusive([&](auto& mounts) -> ErrorOr<void> {
         for (size_t i = 0; i < mounts.size(); ++i) {
             auto& mount = mounts[i];
@@ -847,6 +854,41 @@ static bool safe_to_follow_symlink(const Inode& inode, const InodeMetadata& pare
     return false;
 }
 
+ErrorOr<NonnullRefPtr<Custody>> VirtualFileSystem::resolve_path_component(Custody& parent, StringView name)
+{
+    bool is_cacheable = parent.inode().fs().supports_directory_entry_caching();
+    auto cache_generation = m_directory_entry_cache.generation();
+    if (is_cacheable) {
+        if (auto cached_child = m_directory_entry_cache.lookup(parent, name); cached_child.has_value()) {
+            if (cached_child->is_null())
+                return ENOENT;
+            return cached_child->release_nonnull();
+        }
+    }
+
+    auto child_or_error = parent.inode().lookup(name);
+    if (child_or_error.is_error()) {
+        if (is_cacheable && child_or_error.error().code() == ENOENT)
+            m_directory_entry_cache.add(parent, name, nullptr, cache_generation);
+        return child_or_error.release_error();
+    }
+    auto child_inode = child_or_error.release_value();
+
+    int mount_flags_for_child = parent.mount_flags();
+
+    // See if there's something mounted on the child; in that case
+    // we would need to return the guest inode, not the host inode.
+    if (auto mount = find_mount_for_host(child_inode->identifier())) {
+        child_inode = mount->guest();
+        mount_flags_for_child = mount->flags();
+    }
+
+    auto child = TRY(Custody::try_create(&parent, name, *child_inode, mount_flags_for_child));
+    if (is_cacheable)
+        m_directory_entry_cache.add(parent, name, child, cache_generation);
+    return child;
+}
+
 ErrorOr<NonnullRefPtr<Custody>> VirtualFileSystem::resolve_path_without_veil(StringView path, Custody& base, RefPtr<Custody>* out_parent, int options, int symlink_recursion_level)
 {
     if (symlink_recursion_level >= symlink_recursion_limit)
@@ -887,7 +929,7 @@ ErrorOr<NonnullRefPtr<Custody>> VirtualFileSystem::resolve_path_without_veil(Str
         }
 
         // Okay, let's look up this part.
-        auto child_or_error = parent.inode().lookup(part);
+        auto child_or_error = resolve_path_component(parent, part);
         if (child_or_error.is_error()) {
             if (out_parent) {
                 // ENOENT with a non-null parent custody signals to caller that
@@ -897,20 +939,10 @@ ErrorOr<NonnullRefPtr<Custody>> VirtualFileSystem::resolve_path_without_veil(Str
             }
             return child_or_error.release_error();
         }
-        auto child_inode = child_or_error.release_value();
-
-        int mount_flags_for_child = parent.mount_flags();
-
-        // See if there's something mounted on the child; in that case
-        // we would need to return the guest inode, not the host inode.
-        if (auto mount = find_mount_for_host(child_inode->identifier())) {
-            child_inode = mount->guest();
-            mount_flags_for_child = mount->flags();
-        }
-
-        custody = TRY(Custody::try_create(&parent, part, *child_inode, mount_flags_for_child));
+        custody = child_or_error.release_value();
+        auto& child_inode = custody->inode();
 
-        if (child_inode->metadata().is_symlink()) {
+        if (child_inode.metadata().is_symlink()) {
             if (!have_more_parts) {
                 if (options & O_NOFOLLOW)
                     return ELOOP;
@@ -918,12 +950,12 @@ ErrorOr<NonnullRefPtr<Custody>> VirtualFileSystem::resolve_path_without_veil(Str
                     break;
             }
 
-            if (!safe_to_follow_symlink(*child_inode, parent_metadata))
+            if (!safe_to_follow_symlink(child_inode, parent_metadata))
                 return EACCES;
 
             TRY(validate_path_against_process_veil(*custody, options));
 
-            auto symlink_target = TRY(child_inode->resolve_as_link(parent, out_parent, options, symlink_recursion_level + 1));
+            auto symlink_target = TRY(child_inode.resolve_as_link(parent, out_parent, options, symlink_recursion_level + 1));
             if (!have_more_parts)
                 return symlink_target;
 
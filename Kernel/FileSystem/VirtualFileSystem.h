@@ -13,6 +13,7 @@
 #include <AK/NonnullOwnPtrVector.h>
 #include <AK/OwnPtr.h>
 #include <AK/RefPtr.h>
+#include <Kernel/FileSystem/DirectoryEntryCache.h>
 #include <Kernel/FileSystem/FileSystem.h>
 #include <Kernel/FileSystem/InodeIdentifier.h>
 #include <Kernel/FileSystem/InodeMetadata.h>
@@ -78,6 +79,8 @@ public:
     ErrorOr<NonnullRefPtr<Custody>> resolve_path(StringView path, Custody& base, RefPtr<Custody>* out_parent = nullptr, int options = 0, int symlink_recursion_level = 0);
     ErrorOr<NonnullRefPtr<Custody>> resolve_path_without_veil(StringView path, Custody& base, RefPtr<Custody>* out_parent = nullptr, int options = 0, int symlink_recursion_level = 0);
 
+    DirectoryEntryCache& directory_entry_cache() { return m_directory_entry_cache; }
+
 private:
     friend class OpenFileDescription;
 
@@ -92,10 +95,14 @@ private:
     Mount* find_mount_for_host(InodeIdentifier);
     Mount* find_mount_for_guest(InodeIdentifier);
 
+    ErrorOr<NonnullRefPtr<Custody>> resolve_path_component(Custody& parent, StringView name);
+
     RefPtr<Inode> m_root_inode;
     RefPtr<Custody> m_root_custody;
 
     MutexProtected<Vector<Mount, 16>> m_mounts;
+
+    DirectoryEntryCache m_directory_entry_cache;
 };
 
 }
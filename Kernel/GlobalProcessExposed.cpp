@@ -4,8 +4,10 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/ByteBuffer.h>
 #include <AK/JsonObjectSerializer.h>
 #include <AK/UBSanitizer.h>
+#include <Kernel/API/ProcessStatistics.h>
 #include <Kernel/Arch/x86/CPU.h>
 #include <Kernel/Arch/x86/InterruptDisabler.h>
 #include <Kernel/Arch/x86/ProcessorInfo.h>
@@ -109,6 +111,12 @@ private:
             obj.add("bytes_in", socket.bytes_in());
             obj.add("packets_out", socket.packets_out());
             obj.add("bytes_out", socket.bytes_out());
+            obj.add("send_window_size", socket.send_window_size());
+            obj.add("congestion_control", socket.congestion_control_name());
+            obj.add("congestion_window", socket.congestion_window());
+            obj.add("slow_start_threshold", socket.slow_start_threshold());
+            obj.add("smoothed_rtt_us", socket.smoothed_rtt().to_microseconds());
+            obj.add("retransmission_timeout_us", socket.retransmission_timeout().to_microseconds());
             if (Process::current().is_superuser() || Process::current().uid() == socket.origin_uid()) {
                 obj.add("origin_pid", socket.origin_pid().value());
                 obj.add("origin_uid", socket.origin_uid().value());
@@ -410,6 +418,8 @@ private:
         json.add("user_physical_available", system_memory.user_physical_pages - system_memory.user_physical_pages_used);
         json.add("user_physical_committed", system_memory.user_physical_pages_committed);
         json.add("user_physical_uncommitted", system_memory.user_physical_pages_uncommitted);
+        json.add("user_physical_compressed", system_memory.user_physical_pages_compressed);
+        json.add("user_physical_compressed_pool", system_memory.user_physical_pages_compressed_pool);
         json.add("super_physical_allocated", system_memory.super_physical_pages_used);
         json.add("super_physical_available", system_memory.super_physical_pages - system_memory.super_physical_pages_used);
         json.add("kmalloc_call_count", stats.kmalloc_call_count);
@@ -437,6 +447,10 @@ private:
             idle_time += processor.time_spent_idle();
         });
         json.add("idle_time", idle_time);
+        auto const& mutex_statistics = Mutex::statistics();
+        json.add("mutex_contended", mutex_statistics.contended.load());
+        json.add("mutex_acquired_after_spinning", mutex_statistics.acquired_after_spinning.load());
+        json.add("mutex_blocked", mutex_statistics.blocked.load());
         json.finish();
         return {};
     }
@@ -553,6 +567,148 @@ private:
         return {};
     }
 };
+class ProcFSOverallProcessesBinary final : public ProcFSGlobalInformation {
+public:
+    static NonnullRefPtr<ProcFSOverallProcessesBinary> must_create();
+
+private:
+    ProcFSOverallProcessesBinary();
+
+    template<typename T>
+    static ReadonlyBytes bytes_of(T const& record)
+    {
+        return { reinterpret_cast<u8 const*>(&record), sizeof(record) };
+    }
+
+    static StringView truncated_for_record(StringView string)
+    {
+        return string.substring_view(0, min(string.length(), static_cast<size_t>(NumericLimits<u16>::max())));
+    }
+
+    virtual ErrorOr<void> try_generate(KBufferBuilder& builder) override
+    {
+        // Keep this in sync with Core::ProcessStatisticsReader.
+        auto build_process = [&](const Process& process) -> ErrorOr<void> {
+            StringBuilder pledge_builder;
+            StringView veil;
+            if (process.is_user_process()) {
+#define __ENUMERATE_PLEDGE_PROMISE(promise)      \
+    if (process.has_promised(Pledge::promise)) { \
+        pledge_builder.append(#promise " ");     \
+    }
+                ENUMERATE_PLEDGE_PROMISES
+#undef __ENUMERATE_PLEDGE_PROMISE
+
+                switch (process.veil_state()) {
+                case VeilState::None:
+                    veil = "None"sv;
+                    break;
+                case VeilState::Dropped:
+                    veil = "Dropped"sv;
+                    break;
+                case VeilState::Locked:
+                    veil = "Locked"sv;
+                    break;
+                }
+            }
+
+            OwnPtr<KString> executable;
+            if (process.executable())
+                executable = TRY(process.executable()->try_serialize_absolute_path());
+
+            auto name = truncated_for_record(process.name());
+            auto executable_path = truncated_for_record(executable ? executable->view() : ""sv);
+            auto tty = truncated_for_record(process.tty() ? process.tty()->tty_name().view() : "notty"sv);
+            auto pledge = truncated_for_record(pledge_builder.string_view());
+
+            ProcessStatisticsRecord record {};
+            record.pid = process.pid().value();
+            record.pgid = process.tty() ? process.tty()->pgid().value() : 0;
+            record.pgp = process.pgid().value();
+            record.sid = process.sid().value();
+            record.uid = process.uid().value();
+            record.gid = process.gid().value();
+            record.ppid = process.ppid().value();
+            record.nfds = process.fds().open_count();
+            record.kernel = process.is_kernel_process();
+            record.dumpable = process.is_dumpable();
+            record.amount_virtual = process.address_space().amount_virtual();
+            record.amount_resident = process.address_space().amount_resident();
+            record.amount_shared = process.address_space().amount_shared();
+            record.amount_dirty_private = process.address_space().amount_dirty_private();
+            record.amount_clean_inode = process.address_space().amount_clean_inode();
+            record.amount_purgeable_volatile = process.address_space().amount_purgeable_volatile();
+            record.amount_purgeable_nonvolatile = process.address_space().amount_purgeable_nonvolatile();
+            record.name_length = name.length();
+            record.executable_length = executable_path.length();
+            record.tty_length = tty.length();
+            record.pledge_length = pledge.length();
+            record.veil_length = veil.length();
+
+            // Gather the threads first, so we know how many of them there are.
+            ByteBuffer threads;
+            ErrorOr<void> result;
+            process.for_each_thread([&](const Thread& thread) {
+                SpinlockLocker locker(thread.get_lock());
+                auto thread_name = truncated_for_record(thread.name());
+                auto state = truncated_for_record(thread.state_string());
+
+                ThreadStatisticsRecord thread_record {};
+                thread_record.tid = thread.tid().value();
+                thread_record.times_scheduled = thread.times_scheduled();
+                thread_record.time_user = thread.time_in_user();
+                thread_record.time_kernel = thread.time_in_kernel();
+                thread_record.cpu = thread.cpu();
+                thread_record.priority = thread.priority();
+                thread_record.syscall_count = thread.syscall_count();
+                thread_record.inode_faults = thread.inode_faults();
+                thread_record.zero_faults = thread.zero_faults();
+                thread_record.cow_faults = thread.cow_faults();
+                thread_record.file_read_bytes = thread.file_read_bytes();
+                thread_record.file_write_bytes = thread.file_write_bytes();
+                thread_record.unix_socket_read_bytes = thread.unix_socket_read_bytes();
+                thread_record.unix_socket_write_bytes = thread.unix_socket_write_bytes();
+                thread_record.ipv4_socket_read_bytes = thread.ipv4_socket_read_bytes();
+                thread_record.ipv4_socket_write_bytes = thread.ipv4_socket_write_bytes();
+                thread_record.name_length = thread_name.length();
+                thread_record.state_length = state.length();
+                result = threads.try_append(bytes_of(thread_record));
+                if (!result.is_error())
+                    result = threads.try_append(thread_name.bytes());
+                if (!result.is_error())
+                    result = threads.try_append(state.bytes());
+                ++record.thread_count;
+                return result.is_error() ? IterationDecision::Break : IterationDecision::Continue;
+            });
+            TRY(result);
+
+            TRY(builder.append_bytes(bytes_of(record)));
+            TRY(builder.append(name));
+            TRY(builder.append(executable_path));
+            TRY(builder.append(tty));
+            TRY(builder.append(pledge));
+            TRY(builder.append(veil));
+            TRY(builder.append_bytes(threads.bytes()));
+            return {};
+        };
+
+        SpinlockLocker lock(g_scheduler_lock);
+        auto total_time_scheduled = Scheduler::get_total_time_scheduled();
+        return Process::all_instances().with([&](auto& processes) -> ErrorOr<void> {
+            ProcessStatisticsHeader header {};
+            header.version = PROCESS_STATISTICS_VERSION;
+            header.process_count = processes.size_slow() + 1;
+            header.total_time = total_time_scheduled.total;
+            header.total_time_kernel = total_time_scheduled.total_kernel;
+            TRY(builder.append_bytes(bytes_of(header)));
+
+            TRY(build_process(*Scheduler::colonel()));
+            for (auto& process : processes)
+                TRY(build_process(process));
+            return {};
+        });
+    }
+};
 class ProcFSCPUInformation final : public ProcFSGlobalInformation {
 public:
     static NonnullRefPtr<ProcFSCPUInformation> must_create();
@@ -788,6 +944,10 @@ UNMAP_AFTER_INIT NonnullRefPtr<ProcFSOverallProcesses> ProcFSOverallProcesses::m
 {
     return adopt_ref_if_nonnull(new (nothrow) ProcFSOverallProcesses).release_nonnull();
 }
+UNMAP_AFTER_INIT NonnullRefPtr<ProcFSOverallProcessesBinary> ProcFSOverallProcessesBinary::must_create()
+{
+    return adopt_ref_if_nonnull(new (nothrow) ProcFSOverallProcessesBinary).release_nonnull();
+}
 UNMAP_AFTER_INIT NonnullRefPtr<ProcFSCPUInformation> ProcFSCPUInformation::must_create()
 {
     return adopt_ref_if_nonnull(new (nothrow) ProcFSCPUInformation).release_nonnull();
@@ -854,6 +1014,10 @@ UNMAP_AFTER_INIT ProcFSOverallProcesses::ProcFSOverallProcesses()
     : ProcFSGlobalInformation("all"sv)
 {
 }
+UNMAP_AFTER_INIT ProcFSOverallProcessesBinary::ProcFSOverallProcessesBinary()
+    : ProcFSGlobalInformation("all_binary"sv)
+{
+}
 UNMAP_AFTER_INIT ProcFSCPUInformation::ProcFSCPUInformation()
     : ProcFSGlobalInformation("cpuinfo"sv)
 {
@@ -922,6 +1086,7 @@ UNMAP_AFTER_INIT NonnullRefPtr<ProcFSRootDirectory> ProcFSRootDirectory::must_cr
     directory->m_components.append(ProcFSMemoryStatus::must_create());
     directory->m_components.append(ProcFSSystemStatistics::must_create());
     directory->m_components.append(ProcFSOverallProcesses::must_create());
+    directory->m_components.append(ProcFSOverallProcessesBinary::must_create());
     directory->m_components.append(ProcFSCPUInformation::must_create());
     directory->m_components.append(ProcFSDmesg::must_create());
     directory->m_components.append(ProcFSInterrupts::must_create());
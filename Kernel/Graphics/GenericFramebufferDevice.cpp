@@ -101,12 +101,14 @@ ErrorOr<void> GenericFramebufferDevice::ioctl(OpenFileDescription&, unsigned req
         if (Checked<unsigned>::multiplication_would_overflow(flush_rects.count, sizeof(FBRect)))
             return Error::from_errno(EFAULT);
         MutexLocker locker(m_flushing_lock);
-        if (flush_rects.count > 0) {
-            for (unsigned i = 0; i < flush_rects.count; i++) {
-                FBRect user_dirty_rect;
-                TRY(copy_from_user(&user_dirty_rect, &flush_rects.rects[i]));
-                TRY(flush_rectangle(flush_rects.buffer_index, user_dirty_rect));
-            }
+        // Copy the rectangles in batches, so the device gets to flush as many of them at once as we can hold.
+        constexpr size_t max_rects_per_batch = 32;
+        FBRect user_dirty_rects[max_rects_per_batch];
+        for (unsigned i = 0; i < flush_rects.count;) {
+            size_t batch_size = min<size_t>(flush_rects.count - i, max_rects_per_batch);
+            TRY(copy_n_from_user(user_dirty_rects, &flush_rects.rects[i], batch_size));
+            TRY(flush_rectangles(flush_rects.buffer_index, { user_dirty_rects, batch_size }));
+            i += batch_size;
         }
         return {};
     };
@@ -125,6 +127,13 @@ ErrorOr<void> GenericFramebufferDevice::ioctl(OpenFileDescription&, unsigned req
     };
 }
 
+ErrorOr<void> GenericFramebufferDevice::flush_rectangles(size_t buffer_index, Span<FBRect const> rects)
+{
+    for (auto& rect : rects)
+        TRY(flush_rectangle(buffer_index, rect));
+    return {};
+}
+
 GenericFramebufferDevice::GenericFramebufferDevice(const GenericGraphicsAdapter& adapter)
     : BlockDevice(29, GraphicsManagement::the().allocate_minor_device_number())
     , m_graphics_adapter(adapter)
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <AK/Error.h>
+#include <AK/Span.h>
 #include <AK/Types.h>
 #include <Kernel/Devices/BlockDevice.h>
 #include <Kernel/Graphics/GenericGraphicsAdapter.h>
@@ -56,6 +57,8 @@ protected:
     virtual ErrorOr<void> flush_head_buffer(size_t head) = 0;
     // FIXME: This method is too much specific to the VirtIO implementation (especially the buffer_index parameter)
     virtual ErrorOr<void> flush_rectangle(size_t buffer_index, FBRect const&) = 0;
+    // Devices that can combine the rectangles of one flush request (e.g. into a single transfer to the host) override this.
+    virtual ErrorOr<void> flush_rectangles(size_t buffer_index, Span<FBRect const>);
 
     ErrorOr<void> verify_head_index(int head_index) const;
 
@@ -107,35 +107,54 @@ ErrorOr<void> FramebufferDevice::flush_head_buffer(size_t)
     // so if we happen to accidentally reach this code, assert.
     VERIFY_NOT_REACHED();
 }
+static void unite_rects(Protocol::Rect& rect, Protocol::Rect const& other)
+{
+    if (rect.width == 0 || rect.height == 0) {
+        rect = other;
+        return;
+    }
+    auto right = rect.x + rect.width;
+    auto bottom = rect.y + rect.height;
+    rect.x = min(rect.x, other.x);
+    rect.y = min(rect.y, other.y);
+    rect.width = max(right, other.x + other.width) - rect.x;
+    rect.height = max(bottom, other.y + other.height) - rect.y;
+}
+
 ErrorOr<void> FramebufferDevice::flush_rectangle(size_t buffer_index, FBRect const& rect)
+{
+    return flush_rectangles(buffer_index, { &rect, 1 });
+}
+
+ErrorOr<void> FramebufferDevice::flush_rectangles(size_t buffer_index, Span<FBRect const> rects)
 {
     MutexLocker locker(adapter()->operation_lock());
-    Protocol::Rect dirty_rect {
-        .x = rect.x,
-        .y = rect.y,
-        .width = rect.width,
-        .height = rect.height
-    };
     // FIXME: Find a better ErrorOr<void> here.
     if (!m_are_writes_active)
         return Error::from_errno(EIO);
     auto& buffer = buffer_from_index(buffer_index);
-    transfer_framebuffer_data_to_host(dirty_rect, buffer);
+    Protocol::Rect united_rect {};
+    for (auto& rect : rects) {
+        Protocol::Rect dirty_rect {
+            .x = rect.x,
+            .y = rect.y,
+            .width = rect.width,
+            .height = rect.height
+        };
+        if (dirty_rect.width == 0 || dirty_rect.height == 0)
+            continue;
+        // Only the damaged parts have to be copied to the host, but they can be shown with a single flush.
+        transfer_framebuffer_data_to_host(dirty_rect, buffer);
+        unite_rects(united_rect, dirty_rect);
+    }
+    if (united_rect.width == 0 || united_rect.height == 0)
+        return {};
     if (&buffer == m_current_buffer) {
         // Flushing directly to screen
-        flush_displayed_image(dirty_rect, buffer);
+        flush_displayed_image(united_rect, buffer);
         buffer.dirty_rect = {};
     } else {
-        if (buffer.dirty_rect.width == 0 || buffer.dirty_rect.height == 0) {
-            buffer.dirty_rect = dirty_rect;
-        } else {
-            auto current_dirty_right = buffer.dirty_rect.x + buffer.dirty_rect.width;
-            auto current_dirty_bottom = buffer.dirty_rect.y + buffer.dirty_rect.height;
-            buffer.dirty_rect.x = min(buffer.dirty_rect.x, dirty_rect.x);
-            buffer.dirty_rect.y = min(buffer.dirty_rect.y, dirty_rect.y);
-            buffer.dirty_rect.width = max(current_dirty_right, dirty_rect.x + dirty_rect.width) - buffer.dirty_rect.x;
-            buffer.dirty_rect.height = max(current_dirty_bottom, dirty_rect.y + dirty_rect.height) - buffer.dirty_rect.y;
-        }
+        unite_rects(buffer.dirty_rect, united_rect);
     }
     return {};
 }
@@ -61,6 +61,7 @@ private:
     virtual ErrorOr<void> set_head_buffer(size_t head, bool second_buffer) override;
     virtual ErrorOr<void> flush_head_buffer(size_t head) override;
     virtual ErrorOr<void> flush_rectangle(size_t head, FBRect const&) override;
+    virtual ErrorOr<void> flush_rectangles(size_t head, Span<FBRect const>) override;
 
     void flush_dirty_window(Protocol::Rect const&, Buffer&);
     void transfer_framebuffer_data_to_host(Protocol::Rect const&, Buffer&);
@@ -6,6 +6,7 @@
 
 #include <AK/Assertions.h>
 #include <AK/Types.h>
+#include <Kernel/Arch/x86/InterruptDisabler.h>
 #include <Kernel/Debug.h>
 #include <Kernel/Heap/Heap.h>
 #include <Kernel/Heap/kmalloc.h>
@@ -141,6 +142,47 @@ private:
     KmallocSlabBlock::List m_full_blocks;
 };
 
+// A magazine is a small stack of free slabs of one size class that is owned
+// by a single processor. It is only ever touched with interrupts disabled on
+// its owning processor, so no locking is required to use it.
+class KmallocMagazine {
+public:
+    static constexpr size_t capacity = 32;
+    static constexpr size_t batch_size = capacity / 2;
+
+    bool is_empty() const { return m_count == 0; }
+    bool is_full() const { return m_count == capacity; }
+    size_t count() const { return m_count; }
+
+    void push(void* ptr)
+    {
+        VERIFY(!is_full());
+        m_slots[m_count++] = ptr;
+    }
+
+    void* pop()
+    {
+        VERIFY(!is_empty());
+        return m_slots[--m_count];
+    }
+
+private:
+    size_t m_count { 0 };
+    void* m_slots[capacity];
+};
+
+static constexpr size_t slabheap_count = 6;
+
+struct KmallocPerProcessorData {
+    static ProcessorSpecificDataID processor_specific_data_id() { return ProcessorSpecificDataID::Kmalloc; }
+
+    KmallocMagazine magazines[slabheap_count];
+
+    size_t kmalloc_call_count { 0 };
+    size_t kfree_call_count { 0 };
+    size_t nested_kfree_calls { 0 };
+};
+
 struct KmallocGlobalData {
     static constexpr size_t minimum_subheap_size = 1 * MiB;
 
@@ -198,6 +240,39 @@ struct KmallocGlobalData {
         PANIC("Bogus pointer passed to kfree_sized({:p}, {})", ptr, size);
     }
 
+    Optional<size_t> slabheap_index_for(size_t size) const
+    {
+        for (size_t i = 0; i < slabheap_count; ++i) {
+            if (size <= slabheaps[i].slab_size())
+                return i;
+        }
+        return {};
+    }
+
+    // The magazine helpers move slabs in batches, so that the global lock
+    // is only taken once every KmallocMagazine::batch_size operations.
+    void refill_magazine(size_t slabheap_index, KmallocMagazine& magazine)
+    {
+        VERIFY(!expansion_in_progress);
+        while (magazine.count() < KmallocMagazine::batch_size)
+            magazine.push(slabheaps[slabheap_index].allocate());
+    }
+
+    void drain_magazine(size_t slabheap_index, KmallocMagazine& magazine)
+    {
+        VERIFY(!expansion_in_progress);
+        while (magazine.count() > KmallocMagazine::capacity - KmallocMagazine::batch_size)
+            slabheaps[slabheap_index].deallocate(magazine.pop());
+    }
+
+    KmallocPerProcessorData* create_per_processor_data()
+    {
+        auto* slot = allocate(sizeof(KmallocPerProcessorData));
+        auto* data = new (slot) KmallocPerProcessorData;
+        Processor::current().set_specific(ProcessorSpecificDataID::Kmalloc, data);
+        return data;
+    }
+
     size_t allocated_bytes() const
     {
         size_t total = 0;
@@ -311,7 +386,7 @@ struct KmallocGlobalData {
 
     KmallocSubheap::List subheaps;
 
-    KmallocSlabheap slabheaps[6] = { 16, 32, 64, 128, 256, 512 };
+    KmallocSlabheap slabheaps[slabheap_count] = { 16, 32, 64, 128, 256, 512 };
 
     bool expansion_in_progress { false };
 };
@@ -346,19 +421,42 @@ UNMAP_AFTER_INIT void kmalloc_init()
     s_lock.initialize();
 }
 
-void* kmalloc(size_t size)
+static KmallocPerProcessorData* per_processor_data()
 {
-    kmalloc_verify_nospinlock_held();
+    VERIFY_INTERRUPTS_DISABLED();
+    if (!Processor::is_initialized())
+        return nullptr;
+    if (auto* data = Processor::current().get_specific<KmallocPerProcessorData>())
+        return data;
     SpinlockLocker lock(s_lock);
-    ++g_kmalloc_call_count;
+    return g_kmalloc_global->create_per_processor_data();
+}
 
-    if (g_dump_kmalloc_stacks && Kernel::g_kernel_symbols_available) {
-        dbgln("kmalloc({})", size);
-        Kernel::dump_backtrace();
+static void* try_allocate_from_magazine(size_t size)
+{
+    auto slabheap_index = g_kmalloc_global->slabheap_index_for(size);
+    if (!slabheap_index.has_value())
+        return nullptr;
+
+    InterruptDisabler disabler;
+    auto* data = per_processor_data();
+    if (!data)
+        return nullptr;
+
+    auto& magazine = data->magazines[*slabheap_index];
+    if (magazine.is_empty()) {
+        SpinlockLocker lock(s_lock);
+        g_kmalloc_global->refill_magazine(*slabheap_index, magazine);
     }
+    ++data->kmalloc_call_count;
 
-    void* ptr = g_kmalloc_global->allocate(size);
+    auto* ptr = magazine.pop();
+    memset(ptr, KMALLOC_SCRUB_BYTE, g_kmalloc_global->slabheaps[*slabheap_index].slab_size());
+    return ptr;
+}
 
+static inline void add_kmalloc_perf_event(size_t size, void* ptr)
+{
     Thread* current_thread = Thread::current();
     if (!current_thread)
         current_thread = Processor::idle_thread();
@@ -368,10 +466,75 @@ void* kmalloc(size_t size)
         VERIFY(current_thread->is_allocation_enabled());
         PerformanceManager::add_kmalloc_perf_event(*current_thread, size, (FlatPtr)ptr);
     }
+}
+
+static inline void add_kfree_perf_event(void* ptr)
+{
+    Thread* current_thread = Thread::current();
+    if (!current_thread)
+        current_thread = Processor::idle_thread();
+    if (current_thread) {
+        VERIFY(current_thread->is_allocation_enabled());
+        PerformanceManager::add_kfree_perf_event(*current_thread, 0, (FlatPtr)ptr);
+    }
+}
 
+void* kmalloc(size_t size)
+{
+    kmalloc_verify_nospinlock_held();
+
+    // Small allocations are served from this processor's magazines without taking s_lock.
+    // When dumping kmalloc stacks we always go through the slow path below.
+    if (!g_dump_kmalloc_stacks) {
+        if (auto* ptr = try_allocate_from_magazine(size)) {
+            add_kmalloc_perf_event(size, ptr);
+            return ptr;
+        }
+    }
+
+    SpinlockLocker lock(s_lock);
+    ++g_kmalloc_call_count;
+
+    if (g_dump_kmalloc_stacks && Kernel::g_kernel_symbols_available) {
+        dbgln("kmalloc({})", size);
+        Kernel::dump_backtrace();
+    }
+
+    void* ptr = g_kmalloc_global->allocate(size);
+    add_kmalloc_perf_event(size, ptr);
     return ptr;
 }
 
+static bool try_deallocate_to_magazine(void* ptr, size_t size)
+{
+    auto slabheap_index = g_kmalloc_global->slabheap_index_for(size);
+    if (!slabheap_index.has_value())
+        return false;
+
+    InterruptDisabler disabler;
+    auto* data = per_processor_data();
+    if (!data)
+        return false;
+
+    VERIFY(g_kmalloc_global->is_valid_kmalloc_address(VirtualAddress { ptr }));
+    ++data->kfree_call_count;
+    ++data->nested_kfree_calls;
+
+    if (data->nested_kfree_calls == 1)
+        add_kfree_perf_event(ptr);
+
+    auto& magazine = data->magazines[*slabheap_index];
+    if (magazine.is_full()) {
+        SpinlockLocker lock(s_lock);
+        g_kmalloc_global->drain_magazine(*slabheap_index, magazine);
+    }
+    memset(ptr, KFREE_SCRUB_BYTE, g_kmalloc_global->slabheaps[*slabheap_index].slab_size());
+    magazine.push(ptr);
+
+    --data->nested_kfree_calls;
+    return true;
+}
+
 void kfree_sized(void* ptr, size_t size)
 {
     if (!ptr)
@@ -380,19 +543,16 @@ void kfree_sized(void* ptr, size_t size)
     VERIFY(size > 0);
 
     kmalloc_verify_nospinlock_held();
+
+    if (try_deallocate_to_magazine(ptr, size))
+        return;
+
     SpinlockLocker lock(s_lock);
     ++g_kfree_call_count;
     ++g_nested_kfree_calls;
 
-    if (g_nested_kfree_calls == 1) {
-        Thread* current_thread = Thread::current();
-        if (!current_thread)
-            current_thread = Processor::idle_thread();
-        if (current_thread) {
-            VERIFY(current_thread->is_allocation_enabled());
-            PerformanceManager::add_kfree_perf_event(*current_thread, 0, (FlatPtr)ptr);
-        }
-    }
+    if (g_nested_kfree_calls == 1)
+        add_kfree_perf_event(ptr);
 
     g_kmalloc_global->deallocate(ptr, size);
     --g_nested_kfree_calls;
@@ -488,4 +648,10 @@ void get_kmalloc_stats(kmalloc_stats& stats)
     stats.bytes_free = g_kmalloc_global->free_bytes();
     stats.kmalloc_call_count = g_kmalloc_call_count;
     stats.kfree_call_count = g_kfree_call_count;
+    Processor::for_each([&](Processor& processor) {
+        if (auto* data = processor.get_specific<KmallocPerProcessorData>()) {
+            stats.kmalloc_call_count += data->kmalloc_call_count;
+            stats.kfree_call_count += data->kfree_call_count;
+        }
+    });
 }
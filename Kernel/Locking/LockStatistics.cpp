@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Array.h>
+#include <AK/BuiltinWrappers.h>
+#include <AK/JsonObjectSerializer.h>
+#include <Kernel/KBufferBuilder.h>
+#include <Kernel/KSyms.h>
+#include <Kernel/Locking/LockStatistics.h>
+
+namespace Kernel {
+
+using RelaxedCounter = Atomic<size_t, AK::MemoryOrder::memory_order_relaxed>;
+
+struct LockStatisticsEntry {
+    // Zero while the slot is unused. Slots are claimed once and never given back,
+    // so that the recording side never needs to take a lock itself.
+    Atomic<FlatPtr> key { 0 };
+    LockStatisticsKind kind { LockStatisticsKind::Spinlock };
+    StringView name;
+
+    RelaxedCounter acquisitions { 0 };
+    RelaxedCounter contentions { 0 };
+    RelaxedCounter total_wait_cycles { 0 };
+    Array<RelaxedCounter, LockStatistics::wait_histogram_bucket_count> wait_histogram {};
+};
+
+static constexpr size_t max_entry_count = 512;
+static Array<LockStatisticsEntry, max_entry_count> s_entries;
+static RelaxedCounter s_dropped_acquisitions { 0 };
+
+Atomic<bool> LockStatistics::s_enabled { false };
+
+enum class CreateEntry {
+    No,
+    Yes,
+};
+
+static LockStatisticsEntry* entry_for(LockStatisticsKind kind, FlatPtr key, StringView name, CreateEntry create)
+{
+    VERIFY(key != 0);
+    // Open addressing with linear probing. Locks are never removed from the table,
+    // so a lookup can stop at the first empty slot.
+    size_t start = ptr_hash(key) % max_entry_count;
+    for (size_t i = 0; i < max_entry_count; ++i) {
+        auto& entry = s_entries[(start + i) % max_entry_count];
+        auto entry_key = entry.key.load(AK::MemoryOrder::memory_order_acquire);
+        if (entry_key == key)
+            return &entry;
+        if (entry_key != 0)
+            continue;
+        if (create == CreateEntry::No)
+            return nullptr;
+        FlatPtr expected = 0;
+        if (entry.key.compare_exchange_strong(expected, key, AK::MemoryOrder::memory_order_acq_rel)) {
+            entry.kind = kind;
+            entry.name = name;
+            return &entry;
+        }
+        if (expected == key)
+            return &entry;
+    }
+    return nullptr;
+}
+
+void LockStatistics::set_enabled(bool enabled)
+{
+    if (enabled && !is_enabled()) {
+        for (auto& entry : s_entries) {
+            entry.acquisitions = 0;
+            entry.contentions = 0;
+            entry.total_wait_cycles = 0;
+            for (auto& bucket : entry.wait_histogram)
+                bucket = 0;
+        }
+        s_dropped_acquisitions = 0;
+    }
+    s_enabled.store(enabled, AK::MemoryOrder::memory_order_relaxed);
+}
+
+void LockStatistics::record_acquisition(LockStatisticsKind kind, FlatPtr key, StringView name)
+{
+    // There are far too many spinlocks embedded in all kinds of objects to track every one
+    // of them, so spinlocks only get an entry once they have been contended at least once.
+    auto create = kind == LockStatisticsKind::Mutex ? CreateEntry::Yes : CreateEntry::No;
+    auto* entry = entry_for(kind, key, name, create);
+    if (!entry) {
+        if (create == CreateEntry::Yes)
+            s_dropped_acquisitions++;
+        return;
+    }
+    entry->acquisitions++;
+}
+
+void LockStatistics::record_contended_acquisition(LockStatisticsKind kind, FlatPtr key, StringView name, u64 wait_cycles)
+{
+    auto* entry = entry_for(kind, key, name, CreateEntry::Yes);
+    if (!entry) {
+        s_dropped_acquisitions++;
+        return;
+    }
+    entry->acquisitions++;
+    entry->contentions++;
+    entry->total_wait_cycles += static_cast<size_t>(min<u64>(wait_cycles, NumericLimits<size_t>::max()));
+    // Bucket n counts waits of [2^n, 2^(n+1)) cycles, the last one everything longer than that.
+    size_t bucket = wait_cycles == 0 ? 0 : min<size_t>(sizeof(u64) * 8 - 1 - count_leading_zeroes(wait_cycles), wait_histogram_bucket_count - 1);
+    entry->wait_histogram[bucket]++;
+}
+
+static StringView kind_to_string(LockStatisticsKind kind)
+{
+    switch (kind) {
+    case LockStatisticsKind::Spinlock:
+        return "spinlock"sv;
+    case LockStatisticsKind::RecursiveSpinlock:
+        return "recursive_spinlock"sv;
+    case LockStatisticsKind::Mutex:
+        return "mutex"sv;
+    }
+    VERIFY_NOT_REACHED();
+}
+
+ErrorOr<void> LockStatistics::try_serialize(KBufferBuilder& builder)
+{
+    JsonObjectSerializer<KBufferBuilder> json { builder };
+    json.add("enabled", is_enabled());
+    json.add("dropped_acquisitions", s_dropped_acquisitions.load());
+    auto array = json.add_array("locks");
+    for (auto const& entry : s_entries) {
+        auto key = entry.key.load(AK::MemoryOrder::memory_order_acquire);
+        if (key == 0)
+            continue;
+        auto acquisitions = entry.acquisitions.load();
+        if (acquisitions == 0)
+            continue;
+
+        auto object = array.add_object();
+        object.add("kind", kind_to_string(entry.kind));
+        if (entry.kind == LockStatisticsKind::Mutex) {
+            object.add("name", entry.name);
+        } else {
+            object.add("address", key);
+            // Only statically allocated spinlocks have a symbol of their own.
+            auto const* symbol = g_kernel_symbols_available ? symbolicate_kernel_address(key) : nullptr;
+            if (symbol && symbol->address == key)
+                object.add("name", symbol->name);
+            else
+                object.add("name", ""sv);
+        }
+        object.add("acquisitions", acquisitions);
+        object.add("contentions", entry.contentions.load());
+        object.add("total_wait_cycles", entry.total_wait_cycles.load());
+        auto histogram = object.add_array("wait_histogram");
+        for (auto const& bucket : entry.wait_histogram)
+            histogram.add(bucket.load());
+        histogram.finish();
+        object.finish();
+    }
+    array.finish();
+    json.finish();
+    return {};
+}
+
+}
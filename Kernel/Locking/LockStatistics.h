@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/Error.h>
+#include <AK/StringView.h>
+#include <AK/Types.h>
+
+namespace Kernel {
+
+class KBufferBuilder;
+
+enum class LockStatisticsKind : u8 {
+    Spinlock,
+    RecursiveSpinlock,
+    Mutex,
+};
+
+// Counts how often each lock is taken, how often that meant waiting for another
+// holder, and how long those waits took. Recording is off by default and is switched
+// on and off at runtime through /sys/locking/statistics, so that it costs a single
+// relaxed load per acquisition when nobody is looking.
+//
+// Spinlocks are identified by their address, and are only tracked from the first time
+// they are contended. Mutexes are identified by their name, which makes e.g. the
+// mutexes of all inodes show up as one "Inode" entry.
+class LockStatistics {
+public:
+    // Wait times are bucketed by powers of two of TSC cycles.
+    static constexpr size_t wait_histogram_bucket_count = 32;
+
+    static bool is_enabled() { return s_enabled.load(AK::MemoryOrder::memory_order_relaxed); }
+
+    // Enabling the statistics starts counting from scratch.
+    static void set_enabled(bool);
+
+    static void record_acquisition(LockStatisticsKind, FlatPtr key, StringView name);
+    static void record_contended_acquisition(LockStatisticsKind, FlatPtr key, StringView name, u64 wait_cycles);
+
+    static ErrorOr<void> try_serialize(KBufferBuilder&);
+
+private:
+    static Atomic<bool> s_enabled;
+};
+
+}
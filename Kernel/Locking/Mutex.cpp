@@ -4,15 +4,42 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/ScopeGuard.h>
 #include <Kernel/Debug.h>
 #include <Kernel/KSyms.h>
 #include <Kernel/Locking/LockLocation.h>
+#include <Kernel/Locking/LockStatistics.h>
 #include <Kernel/Locking/Mutex.h>
 #include <Kernel/Locking/Spinlock.h>
 #include <Kernel/Thread.h>
 
 namespace Kernel {
 
+MutexStatistics Mutex::s_statistics;
+
+// How many times we check on a mutex held by a thread running on another processor before blocking.
+static constexpr size_t max_spin_iterations = 1000;
+
+void Mutex::spin_while_holder_is_running(Thread& current_thread, SpinlockLocker<Spinlock>& lock)
+{
+    // Most critical sections are short, so if the holder is running right now it will likely
+    // release the mutex before we would even be done blocking. If somebody is already blocked
+    // on it though, it will be handed to them and there's no point in waiting around.
+    if (Processor::count() == 1)
+        return;
+    for (size_t i = 0; i < max_spin_iterations; ++i) {
+        if (m_mode != Mode::Exclusive || !m_blocked_threads_list_exclusive.is_empty() || !m_blocked_threads_list_shared.is_empty())
+            return;
+        auto* holder = m_holder.ptr();
+        VERIFY(holder && holder != &current_thread);
+        if (holder->state() != Thread::Running || holder->cpu() == Processor::current_id())
+            return;
+        lock.unlock();
+        Processor::wait_check();
+        lock.lock();
+    }
+}
+
 void Mutex::lock(Mode mode, [[maybe_unused]] LockLocation const& location)
 {
     // NOTE: This may be called from an interrupt handler (not an IRQ handler)
@@ -24,6 +51,27 @@ void Mutex::lock(Mode mode, [[maybe_unused]] LockLocation const& location)
     auto* current_thread = Thread::current();
 
     SpinlockLocker lock(m_lock);
+
+    // Note: All the ways out of here below return while still holding m_lock, so this runs before it is released.
+    u64 contention_start = 0;
+    ScopeGuard record_statistics = [&] {
+        if (!LockStatistics::is_enabled())
+            return;
+        auto key = m_name.is_empty() ? FlatPtr(this) : FlatPtr(m_name.characters_without_null_termination());
+        if (contention_start != 0)
+            LockStatistics::record_contended_acquisition(LockStatisticsKind::Mutex, key, m_name, read_tsc() - contention_start);
+        else
+            LockStatistics::record_acquisition(LockStatisticsKind::Mutex, key, m_name);
+    };
+
+    if (current_thread && m_mode == Mode::Exclusive && m_holder != current_thread) {
+        s_statistics.contended++;
+        if (LockStatistics::is_enabled())
+            contention_start = read_tsc();
+        spin_while_holder_is_running(*current_thread, lock);
+        if (m_mode == Mode::Unlocked)
+            s_statistics.acquired_after_spinning++;
+    }
     bool did_block = false;
     Mode current_mode = m_mode;
     switch (current_mode) {
@@ -51,6 +99,7 @@ void Mutex::lock(Mode mode, [[maybe_unused]] LockLocation const& location)
     case Mode::Exclusive: {
         VERIFY(m_holder);
         if (m_holder != current_thread) {
+            s_statistics.blocked++;
             block(*current_thread, mode, lock, 1);
             did_block = true;
             // If we blocked then m_mode should have been updated to what we requested
@@ -102,6 +151,10 @@ void Mutex::lock(Mode mode, [[maybe_unused]] LockLocation const& location)
                 }
             }
 
+            s_statistics.contended++;
+            s_statistics.blocked++;
+            if (LockStatistics::is_enabled())
+                contention_start = read_tsc();
             block(*current_thread, mode, lock, 1);
             did_block = true;
             VERIFY(m_mode == mode);
@@ -17,6 +17,15 @@
 
 namespace Kernel {
 
+struct MutexStatistics {
+    // Calls to Mutex::lock() that found the mutex held by another thread.
+    Atomic<size_t, AK::MemoryOrder::memory_order_relaxed> contended { 0 };
+    // Contended locks that became available while we were spinning.
+    Atomic<size_t, AK::MemoryOrder::memory_order_relaxed> acquired_after_spinning { 0 };
+    // Contended locks that we had to block on.
+    Atomic<size_t, AK::MemoryOrder::memory_order_relaxed> blocked { 0 };
+};
+
 class Mutex {
     friend class Thread;
 
@@ -54,6 +63,8 @@ public:
 
     [[nodiscard]] StringView name() const { return m_name; }
 
+    static MutexStatistics const& statistics() { return s_statistics; }
+
     static StringView mode_to_string(Mode mode)
     {
         switch (mode) {
@@ -77,9 +88,12 @@ private:
         return mode == Mode::Exclusive ? m_blocked_threads_list_exclusive : m_blocked_threads_list_shared;
     }
 
+    void spin_while_holder_is_running(Thread&, SpinlockLocker<Spinlock>&);
     void block(Thread&, Mode, SpinlockLocker<Spinlock>&, u32);
     void unblock_waiters(Mode);
 
+    static MutexStatistics s_statistics;
+
     StringView m_name;
     Mode m_mode { Mode::Unlocked };
 
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/KBufferBuilder.h>
+#include <Kernel/Locking/LockStatistics.h>
+#include <Kernel/Locking/SysFSLocking.h>
+#include <Kernel/Sections.h>
+
+namespace Kernel {
+
+UNMAP_AFTER_INIT void LockingSysFSDirectory::initialize()
+{
+    auto locking_directory = adopt_ref_if_nonnull(new (nothrow) LockingSysFSDirectory()).release_nonnull();
+    SysFSComponentRegistry::the().register_new_component(locking_directory);
+    locking_directory->create_components();
+}
+
+UNMAP_AFTER_INIT void LockingSysFSDirectory::create_components()
+{
+    m_components.append(LockStatisticsSysFSComponent::must_create(*this));
+}
+
+UNMAP_AFTER_INIT LockingSysFSDirectory::LockingSysFSDirectory()
+    : SysFSDirectory(SysFSComponentRegistry::the().root_directory())
+{
+}
+
+UNMAP_AFTER_INIT NonnullRefPtr<LockStatisticsSysFSComponent> LockStatisticsSysFSComponent::must_create(LockingSysFSDirectory& locking_directory)
+{
+    return adopt_ref_if_nonnull(new (nothrow) LockStatisticsSysFSComponent(locking_directory)).release_nonnull();
+}
+
+UNMAP_AFTER_INIT LockStatisticsSysFSComponent::LockStatisticsSysFSComponent(LockingSysFSDirectory&)
+    : SysFSComponent()
+{
+}
+
+mode_t LockStatisticsSysFSComponent::permissions() const
+{
+    return S_IRUSR | S_IRGRP | S_IROTH | S_IWUSR;
+}
+
+ErrorOr<void> LockStatisticsSysFSComponent::refresh_data(OpenFileDescription& description) const
+{
+    MutexLocker locker(m_lock);
+    auto& cached_data = description.data();
+    if (!cached_data)
+        cached_data = TRY(adopt_nonnull_own_or_enomem(new (nothrow) SysFSInodeData));
+    auto builder = TRY(KBufferBuilder::try_create());
+    TRY(LockStatistics::try_serialize(builder));
+    auto& typed_cached_data = static_cast<SysFSInodeData&>(*cached_data);
+    typed_cached_data.buffer = builder.build();
+    if (!typed_cached_data.buffer)
+        return ENOMEM;
+    return {};
+}
+
+ErrorOr<size_t> LockStatisticsSysFSComponent::read_bytes(off_t offset, size_t count, UserOrKernelBuffer& buffer, OpenFileDescription* description) const
+{
+    VERIFY(offset >= 0);
+    if (!description)
+        return EIO;
+
+    MutexLocker locker(m_lock);
+    if (!description->data())
+        return EIO;
+
+    auto& data_buffer = static_cast<SysFSInodeData&>(*description->data()).buffer;
+    if (!data_buffer || static_cast<size_t>(offset) >= data_buffer->size())
+        return 0;
+
+    ssize_t nread = min(static_cast<off_t>(data_buffer->size() - offset), static_cast<off_t>(count));
+    TRY(buffer.write(data_buffer->data() + offset, nread));
+    return nread;
+}
+
+ErrorOr<void> LockStatisticsSysFSComponent::truncate(u64 size)
+{
+    // Opening this for writing with O_TRUNC is fine, there's nothing to truncate.
+    if (size != 0)
+        return EPERM;
+    return {};
+}
+
+ErrorOr<size_t> LockStatisticsSysFSComponent::write_bytes(off_t offset, size_t count, UserOrKernelBuffer const& data, OpenFileDescription*)
+{
+    if (offset > 0)
+        return EINVAL;
+    // Allow for a trailing newline, as in `echo 1 > /sys/locking/statistics`.
+    if (count == 0 || count > 2)
+        return EINVAL;
+
+    char buf[2];
+    TRY(data.read(buf, count));
+    if (count == 2 && buf[1] != '\n')
+        return EINVAL;
+    switch (buf[0]) {
+    case '0':
+        LockStatistics::set_enabled(false);
+        return count;
+    case '1':
+        LockStatistics::set_enabled(true);
+        return count;
+    default:
+        return EINVAL;
+    }
+}
+
+}
@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <Kernel/FileSystem/SysFS.h>
+#include <Kernel/KBufferBuilder.h>
+#include <Kernel/Locking/Mutex.h>
+
+namespace Kernel {
+
+class LockingSysFSDirectory final : public SysFSDirectory {
+public:
+    virtual StringView name() const override { return "locking"sv; }
+    static void initialize();
+
+private:
+    LockingSysFSDirectory();
+    void create_components();
+};
+
+// Reading gives the lock statistics as JSON. Writing "1" starts recording them
+// from scratch, writing "0" stops recording.
+class LockStatisticsSysFSComponent final : public SysFSComponent {
+public:
+    virtual StringView name() const override { return "statistics"sv; }
+    static NonnullRefPtr<LockStatisticsSysFSComponent> must_create(LockingSysFSDirectory&);
+
+    virtual mode_t permissions() const override;
+    virtual ErrorOr<size_t> read_bytes(off_t, size_t, UserOrKernelBuffer&, OpenFileDescription*) const override;
+    virtual ErrorOr<size_t> write_bytes(off_t, size_t, UserOrKernelBuffer const&, OpenFileDescription*) override;
+    virtual ErrorOr<void> truncate(u64) override;
+    virtual ErrorOr<void> set_mtime(time_t) override { return {}; }
+
+private:
+    explicit LockStatisticsSysFSComponent(LockingSysFSDirectory&);
+
+    virtual ErrorOr<void> refresh_data(OpenFileDescription&) const override;
+
+    mutable Mutex m_lock { "LockStatisticsSysFSComponent" };
+};
+
+}
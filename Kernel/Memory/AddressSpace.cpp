@@ -10,6 +10,7 @@
 #include <Kernel/Memory/AnonymousVMObject.h>
 #include <Kernel/Memory/InodeVMObject.h>
 #include <Kernel/Memory/MemoryManager.h>
+#include <Kernel/Memory/TLBShootdownBatch.h>
 #include <Kernel/PerformanceManager.h>
 #include <Kernel/Process.h>
 
@@ -60,8 +61,12 @@ ErrorOr<void> AddressSpace::unmap_mmap_range(VirtualAddress addr, size_t size)
         // with the exact same start address, but don't deallocate it yet.
         auto region = take_region(*old_region);
 
+        // The new region(s) cover part of the old one, so a single flush of the old range suffices.
+        TLBShootdownBatch tlb_shootdown_batch(page_directory());
+        tlb_shootdown_batch.add(region->range());
+
         // We manually unmap the old region here, specifying that we *don't* want the VM deallocated.
-        region->unmap(Region::ShouldDeallocateVirtualRange::No);
+        region->unmap(Region::ShouldDeallocateVirtualRange::No, ShouldFlushTLB::No);
 
         auto new_regions = TRY(try_split_region_around_range(*region, range_to_unmap));
 
@@ -72,7 +77,7 @@ ErrorOr<void> AddressSpace::unmap_mmap_range(VirtualAddress addr, size_t size)
         for (auto* new_region : new_regions) {
             // TODO: Ideally we should do this in a way that can be rolled back on failure, as failing here
             // leaves the caller in an undefined state.
-            TRY(new_region->map(page_directory()));
+            TRY(new_region->map(page_directory(), ShouldFlushTLB::No));
         }
 
         PerformanceManager::add_unmap_perf_event(Process::current(), range_to_unmap);
@@ -94,10 +99,21 @@ ErrorOr<void> AddressSpace::unmap_mmap_range(VirtualAddress addr, size_t size)
 
     Vector<Region*, 2> new_regions;
 
+    // Regions we remove entirely are only destroyed after the batched TLB flush, since their
+    // physical pages may still be reachable through stale TLB entries until then.
+    Vector<NonnullOwnPtr<Region>> removed_regions;
+    TRY(removed_regions.try_ensure_capacity(regions.size()));
+
+    TLBShootdownBatch tlb_shootdown_batch(page_directory());
+
     for (auto* old_region : regions) {
+        tlb_shootdown_batch.add(old_region->range());
+
         // If it's a full match we can remove the entire old region.
         if (old_region->range().intersect(range_to_unmap).size() == old_region->size()) {
-            deallocate_region(*old_region);
+            auto region = take_region(*old_region);
+            region->unmap(Region::ShouldDeallocateVirtualRange::Yes, ShouldFlushTLB::No);
+            removed_regions.unchecked_append(move(region));
             continue;
         }
 
@@ -106,7 +122,7 @@ ErrorOr<void> AddressSpace::unmap_mmap_range(VirtualAddress addr, size_t size)
         auto region = take_region(*old_region);
 
         // We manually unmap the old region here, specifying that we *don't* want the VM deallocated.
-        region->unmap(Region::ShouldDeallocateVirtualRange::No);
+        region->unmap(Region::ShouldDeallocateVirtualRange::No, ShouldFlushTLB::No);
 
         // Otherwise, split the regions and collect them for future mapping.
         auto split_regions = TRY(try_split_region_around_range(*region, range_to_unmap));
@@ -120,9 +136,11 @@ ErrorOr<void> AddressSpace::unmap_mmap_range(VirtualAddress addr, size_t size)
     for (auto* new_region : new_regions) {
         // TODO: Ideally we should do this in a way that can be rolled back on failure, as failing here
         // leaves the caller in an undefined state.
-        TRY(new_region->map(page_directory()));
+        TRY(new_region->map(page_directory(), ShouldFlushTLB::No));
     }
 
+    tlb_shootdown_batch.flush();
+
     PerformanceManager::add_unmap_perf_event(Process::current(), range_to_unmap);
 
     return {};
@@ -144,7 +162,7 @@ ErrorOr<Region*> AddressSpace::try_allocate_split_region(Region const& source_re
         region_name = TRY(KString::try_create(source_region.name()));
 
     auto new_region = TRY(Region::try_create_user_accessible(
-        range, source_region.vmobject(), offset_in_vmobject, move(region_name), source_region.access(), source_region.is_cacheable() ? Region::Cacheable::Yes : Region::Cacheable::No, source_region.is_shared()));
+        range, source_region.vmobject(), offset_in_vmobject, move(region_name), source_region.access(), source_region.cacheable(), source_region.is_shared()));
     auto* region = TRY(add_region(move(new_region)));
     region->set_syscall_region(source_region.is_syscall_region());
     region->set_mmap(source_region.is_mmap());
@@ -169,7 +187,7 @@ ErrorOr<Region*> AddressSpace::allocate_region(VirtualRange const& range, String
     return add_region(move(region));
 }
 
-ErrorOr<Region*> AddressSpace::allocate_region_with_vmobject(VirtualRange const& range, NonnullRefPtr<VMObject> vmobject, size_t offset_in_vmobject, StringView name, int prot, bool shared)
+ErrorOr<Region*> AddressSpace::allocate_region_with_vmobject(VirtualRange const& range, NonnullRefPtr<VMObject> vmobject, size_t offset_in_vmobject, StringView name, int prot, bool shared, Region::Cacheable cacheable)
 {
     VERIFY(range.is_valid());
     size_t end_in_vmobject = offset_in_vmobject + range.size();
@@ -189,7 +207,7 @@ ErrorOr<Region*> AddressSpace::allocate_region_with_vmobject(VirtualRange const&
     OwnPtr<KString> region_name;
     if (!name.is_null())
         region_name = TRY(KString::try_create(name));
-    auto region = TRY(Region::try_create_user_accessible(range, move(vmobject), offset_in_vmobject, move(region_name), prot_to_region_access_flags(prot), Region::Cacheable::Yes, shared));
+    auto region = TRY(Region::try_create_user_accessible(range, move(vmobject), offset_in_vmobject, move(region_name), prot_to_region_access_flags(prot), cacheable, shared));
     auto* added_region = TRY(add_region(move(region)));
     TRY(added_region->map(page_directory()));
     return added_region;
@@ -246,10 +264,10 @@ Vector<Region*> AddressSpace::find_regions_intersecting(VirtualRange const& rang
 
     SpinlockLocker lock(m_lock);
 
-    auto* found_region = m_regions.find_largest_not_above(range.base().get());
-    if (!found_region)
+    auto iter = m_regions.find_largest_not_above_iterator(range.base().get());
+    if (iter.is_end())
         return regions;
-    for (auto iter = m_regions.begin_from((*found_region)->vaddr().get()); !iter.is_end(); ++iter) {
+    for (; !iter.is_end(); ++iter) {
         const auto& iter_range = (*iter)->range();
         if (iter_range.base() < range.end() && iter_range.end() > range.base()) {
             regions.append(*iter);
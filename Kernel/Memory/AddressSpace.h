@@ -7,11 +7,12 @@
 
 #pragma once
 
-#include <AK/RedBlackTree.h>
+#include <AK/BTreeMap.h>
 #include <AK/Vector.h>
 #include <AK/WeakPtr.h>
 #include <Kernel/Memory/AllocationStrategy.h>
 #include <Kernel/Memory/PageDirectory.h>
+#include <Kernel/Memory/Region.h>
 #include <Kernel/UnixTypes.h>
 
 namespace Kernel::Memory {
@@ -28,8 +29,8 @@ public:
 
     size_t region_count() const { return m_regions.size(); }
 
-    RedBlackTree<FlatPtr, NonnullOwnPtr<Region>>& regions() { return m_regions; }
-    const RedBlackTree<FlatPtr, NonnullOwnPtr<Region>>& regions() const { return m_regions; }
+    BTreeMap<FlatPtr, NonnullOwnPtr<Region>>& regions() { return m_regions; }
+    const BTreeMap<FlatPtr, NonnullOwnPtr<Region>>& regions() const { return m_regions; }
 
     void dump_regions();
 
@@ -37,7 +38,7 @@ public:
 
     ErrorOr<VirtualRange> try_allocate_range(VirtualAddress, size_t, size_t alignment = PAGE_SIZE);
 
-    ErrorOr<Region*> allocate_region_with_vmobject(VirtualRange const&, NonnullRefPtr<VMObject>, size_t offset_in_vmobject, StringView name, int prot, bool shared);
+    ErrorOr<Region*> allocate_region_with_vmobject(VirtualRange const&, NonnullRefPtr<VMObject>, size_t offset_in_vmobject, StringView name, int prot, bool shared, Region::Cacheable = Region::Cacheable::Yes);
     ErrorOr<Region*> allocate_region(VirtualRange const&, StringView name, int prot = PROT_READ | PROT_WRITE, AllocationStrategy strategy = AllocationStrategy::Reserve);
     void deallocate_region(Region& region);
     NonnullOwnPtr<Region> take_region(Region& region);
@@ -72,7 +73,7 @@ private:
 
     RefPtr<PageDirectory> m_page_directory;
 
-    RedBlackTree<FlatPtr, NonnullOwnPtr<Region>> m_regions;
+    BTreeMap<FlatPtr, NonnullOwnPtr<Region>> m_regions;
 
     struct RegionLookupCache {
         Optional<VirtualRange> range;
@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/ScopeGuard.h>
 #include <Kernel/Arch/SmapDisabler.h>
 #include <Kernel/Debug.h>
 #include <Kernel/Memory/AnonymousVMObject.h>
@@ -26,6 +27,9 @@ ErrorOr<NonnullRefPtr<VMObject>> AnonymousVMObject::try_clone()
         return clone;
     }
 
+    // The clone shares our physical pages, so they all have to be there.
+    TRY(restore_compressed_pages());
+
     // We're the parent. Since we're about to become COW we need to
     // commit the number of pages that we need to potentially allocate
     // so that the parent is still guaranteed to be able to have all
@@ -116,6 +120,7 @@ ErrorOr<NonnullRefPtr<AnonymousVMObject>> AnonymousVMObject::try_create_for_phys
 AnonymousVMObject::AnonymousVMObject(size_t size, AllocationStrategy strategy, Optional<CommittedPhysicalPageSet> committed_pages)
     : VMObject(size)
     , m_unused_committed_pages(move(committed_pages))
+    , m_compressible(true)
 {
     if (strategy == AllocationStrategy::AllocateNow) {
         // Allocate all pages right now. We know we can get all because we committed the amount needed
@@ -148,12 +153,19 @@ AnonymousVMObject::AnonymousVMObject(AnonymousVMObject const& other, NonnullRefP
     : VMObject(other)
     , m_shared_committed_cow_pages(move(shared_committed_cow_pages))
     , m_purgeable(other.m_purgeable)
+    , m_compressible(other.m_compressible)
 {
     ensure_cow_map();
 }
 
 AnonymousVMObject::~AnonymousVMObject()
 {
+    if (m_compressed_page_handles.size() == 0)
+        return;
+    for (size_t i = 0; i < page_count(); ++i) {
+        if (!m_physical_pages[i])
+            discard_compressed_page(i);
+    }
 }
 
 size_t AnonymousVMObject::purge()
@@ -244,6 +256,13 @@ NonnullRefPtr<PhysicalPage> AnonymousVMObject::allocate_committed_page(Badge<Reg
     return m_unused_committed_pages->take_one();
 }
 
+NonnullRefPtrVector<PhysicalPage> AnonymousVMObject::try_allocate_committed_huge_page(Badge<Region>)
+{
+    if (!m_unused_committed_pages.has_value())
+        return {};
+    return m_unused_committed_pages->try_take_huge_page();
+}
+
 Bitmap& AnonymousVMObject::ensure_cow_map()
 {
     if (m_cow_map.is_null())
@@ -274,6 +293,146 @@ void AnonymousVMObject::set_should_cow(size_t page_index, bool cow)
     ensure_cow_map().set(page_index, cow);
 }
 
+void AnonymousVMObject::adopt_page(size_t page_index, NonnullRefPtr<PhysicalPage> page)
+{
+    SpinlockLocker lock(m_lock);
+    VERIFY(!is_purgeable());
+
+    auto& page_slot = physical_pages()[page_index];
+    if (!page_slot)
+        discard_compressed_page(page_index);
+
+    if (page_slot && page_slot->is_lazy_committed_page()) {
+        // The page that was committed for this slot will never be needed now.
+        if (m_unused_committed_pages.has_value() && !m_unused_committed_pages->is_empty())
+            m_unused_committed_pages->uncommit_one();
+    } else if (m_shared_committed_cow_pages && !m_cow_map.is_null() && m_cow_map.get(page_index)) {
+        // Same for the page that was committed to break this COW share.
+        if (!m_shared_committed_cow_pages->is_empty())
+            m_shared_committed_cow_pages->uncommit_one();
+        if (m_shared_committed_cow_pages->is_empty())
+            m_shared_committed_cow_pages = nullptr;
+    }
+
+    page_slot = move(page);
+    if (!m_cow_map.is_null())
+        m_cow_map.set(page_index, false);
+}
+
+size_t AnonymousVMObject::compress_cold_pages(size_t max_page_count)
+{
+    VERIFY(s_mm_lock.is_locked_by_current_processor());
+    if (!m_compressible || is_purgeable() || page_count() == 0)
+        return 0;
+
+    // Page faults take our lock before s_mm_lock, which we're already holding. So instead of waiting for the lock,
+    // we leave this object alone while someone is using it. That includes this processor, which could be in the middle
+    // of handling a fault in here when it ran out of pages.
+    if (m_lock.is_locked_by_current_processor())
+        return 0;
+    u32 prev_flags = 0;
+    if (!m_lock.try_lock(prev_flags))
+        return 0;
+    ScopeGuard unlock_guard = [&] { m_lock.unlock(prev_flags); };
+
+    // The kernel doesn't expect its own memory to go missing.
+    bool is_mapped_by_kernel = false;
+    for_each_region([&](Region& region) {
+        if (!region.is_user())
+            is_mapped_by_kernel = true;
+    });
+    if (is_mapped_by_kernel)
+        return 0;
+
+    size_t compressed_page_count = 0;
+    for (size_t scanned_page_count = 0; scanned_page_count < page_count() && compressed_page_count < max_page_count; ++scanned_page_count) {
+        auto page_index = m_clock_hand;
+        m_clock_hand = (m_clock_hand + 1) % page_count();
+
+        // Pages that are shared with another object (after a fork) would only be duplicated by compressing them.
+        auto& page_slot = m_physical_pages[page_index];
+        if (!page_slot || page_slot->is_shared_zero_page() || page_slot->is_lazy_committed_page() || page_slot->ref_count() != 1)
+            continue;
+
+        // Pages that were used since we last came by get a second chance.
+        bool was_accessed = false;
+        bool is_busy = false;
+        for_each_region([&](Region& region) {
+            auto region_was_accessed = region.try_test_and_clear_accessed({}, page_index);
+            if (!region_was_accessed.has_value())
+                is_busy = true;
+            else if (region_was_accessed.value())
+                was_accessed = true;
+        });
+        if (is_busy)
+            break;
+        if (was_accessed)
+            continue;
+
+        if (m_compressed_page_handles.size() == 0) {
+            auto handles_or_error = FixedArray<CompressedPageStore::Handle>::try_create(page_count());
+            if (handles_or_error.is_error())
+                break;
+            m_compressed_page_handles.swap(handles_or_error.value());
+        }
+
+        // Nobody may change the page while we compress it. If a fault maps it back in before we get to it, we'll just have to try again later.
+        bool is_unmapped = true;
+        for_each_region([&](Region& region) {
+            if (!region.try_unmap_vmobject_page({}, page_index))
+                is_unmapped = false;
+        });
+        if (!is_unmapped)
+            break;
+
+        auto handle = MM.compressed_page_store().try_compress(page_slot);
+        if (!handle.has_value())
+            continue;
+        m_compressed_page_handles[page_index] = handle.value();
+        ++compressed_page_count;
+    }
+    return compressed_page_count;
+}
+
+bool AnonymousVMObject::restore_compressed_page(size_t page_index)
+{
+    VERIFY(m_lock.is_locked_by_current_processor());
+    auto& page_slot = m_physical_pages[page_index];
+    VERIFY(!page_slot);
+
+    // NOTE: The page that was compressed went back to the uncommitted pool, so this may fail like any other allocation.
+    auto page = MM.allocate_user_physical_page(MemoryManager::ShouldZeroFill::No);
+    if (!page) {
+        dmesgln("MM: Unable to allocate a physical page to restore a compressed page");
+        return false;
+    }
+    {
+        SpinlockLocker mm_locker(s_mm_lock);
+        MM.compressed_page_store().decompress(m_compressed_page_handles[page_index], *page);
+    }
+    page_slot = move(page);
+    return true;
+}
+
+ErrorOr<void> AnonymousVMObject::restore_compressed_pages()
+{
+    VERIFY(m_lock.is_locked_by_current_processor());
+    if (m_compressed_page_handles.size() == 0)
+        return {};
+    for (size_t i = 0; i < page_count(); ++i) {
+        if (!m_physical_pages[i] && !restore_compressed_page(i))
+            return ENOMEM;
+    }
+    return {};
+}
+
+void AnonymousVMObject::discard_compressed_page(size_t page_index)
+{
+    VERIFY(!m_physical_pages[page_index]);
+    SpinlockLocker mm_locker(s_mm_lock);
+    MM.compressed_page_store().discard(m_compressed_page_handles[page_index]);
+}
+
 size_t AnonymousVMObject::cow_pages() const
 {
     if (m_cow_map.is_null())
@@ -6,7 +6,9 @@
 
 #pragma once
 
+#include <AK/FixedArray.h>
 #include <Kernel/Memory/AllocationStrategy.h>
+#include <Kernel/Memory/CompressedPageStore.h>
 #include <Kernel/Memory/MemoryManager.h>
 #include <Kernel/Memory/PageFaultResponse.h>
 #include <Kernel/Memory/VMObject.h>
@@ -26,11 +28,15 @@ public:
     virtual ErrorOr<NonnullRefPtr<VMObject>> try_clone() override;
 
     [[nodiscard]] NonnullRefPtr<PhysicalPage> allocate_committed_page(Badge<Region>);
+    [[nodiscard]] NonnullRefPtrVector<PhysicalPage> try_allocate_committed_huge_page(Badge<Region>);
     PageFaultResponse handle_cow_fault(size_t, VirtualAddress);
     size_t cow_pages() const;
     bool should_cow(size_t page_index, bool) const;
     void set_should_cow(size_t page_index, bool);
 
+    // Puts a page that was filled elsewhere into the given slot, dropping whatever was there.
+    void adopt_page(size_t page_index, NonnullRefPtr<PhysicalPage>);
+
     bool is_purgeable() const { return m_purgeable; }
     bool is_volatile() const { return m_volatile; }
 
@@ -38,6 +44,14 @@ public:
 
     size_t purge();
 
+    // Compresses pages that weren't accessed since the last time we came by, until we've got the given number of them.
+    // This is called by the MemoryManager with s_mm_lock held, when it runs out of physical pages.
+    size_t compress_cold_pages(size_t max_page_count);
+
+    // Compressed pages have no physical page in their slot. This gives them one back, or drops their contents.
+    [[nodiscard]] bool restore_compressed_page(size_t page_index);
+    void discard_compressed_page(size_t page_index);
+
 private:
     class SharedCommittedCowPages;
 
@@ -57,6 +71,8 @@ private:
     Bitmap& ensure_cow_map();
     void ensure_or_reset_cow_map();
 
+    ErrorOr<void> restore_compressed_pages();
+
     Optional<CommittedPhysicalPageSet> m_unused_committed_pages;
     Bitmap m_cow_map;
 
@@ -85,6 +101,11 @@ private:
     bool m_purgeable { false };
     bool m_volatile { false };
     bool m_was_purged { false };
+
+    // Only objects that hold ordinary memory are compressed, not those that map specific physical pages.
+    bool m_compressible { false };
+    size_t m_clock_hand { 0 };
+    FixedArray<CompressedPageStore::Handle> m_compressed_page_handles;
 };
 
 }
@@ -0,0 +1,304 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Span.h>
+#include <Kernel/Memory/CompressedPageStore.h>
+#include <Kernel/Memory/MemoryManager.h>
+#include <Kernel/Memory/PhysicalPage.h>
+
+namespace Kernel::Memory {
+
+// The codec is an LZ77 variant along the lines of LZ4, which is about as fast as it gets and good enough for the
+// repetitive data that most pages hold. The compressed data is a series of sequences, each starting with a token byte:
+// the high nibble is the number of literal bytes that follow, and the low nibble is the length of the match (minus 4)
+// that follows them, as a 16-bit little endian offset back into the output. Nibbles of 15 are followed by extra bytes
+// that add to the length, up to and including the first byte that isn't 255. The last sequence has no match.
+
+static constexpr size_t min_match_length = 4;
+static constexpr size_t match_table_bits = 12;
+static constexpr u16 no_match = 0xffff;
+
+static u32 read_u32(u8 const* data)
+{
+    u32 value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+static size_t match_table_index(u32 value)
+{
+    return (value * 2654435761u) >> (32 - match_table_bits);
+}
+
+static Optional<size_t> compress_page(ReadonlyBytes input, Bytes output, u16* match_table)
+{
+    static_assert(PAGE_SIZE < no_match);
+    for (size_t i = 0; i < (1u << match_table_bits); ++i)
+        match_table[i] = no_match;
+
+    size_t output_offset = 0;
+    size_t literals_offset = 0;
+
+    auto write_byte = [&](u8 byte) {
+        if (output_offset >= output.size())
+            return false;
+        output[output_offset++] = byte;
+        return true;
+    };
+    auto write_extra_length = [&](size_t length) {
+        for (; length >= 255; length -= 255) {
+            if (!write_byte(255))
+                return false;
+        }
+        return write_byte(length);
+    };
+    auto write_sequence = [&](size_t literal_length, size_t match_length, size_t match_offset) {
+        u8 token = min(literal_length, 15u) << 4;
+        if (match_length != 0)
+            token |= min(match_length - min_match_length, 15u);
+        if (!write_byte(token))
+            return false;
+        if (literal_length >= 15 && !write_extra_length(literal_length - 15))
+            return false;
+        if (literal_length > output.size() - output_offset)
+            return false;
+        memcpy(output.offset_pointer(output_offset), input.offset_pointer(literals_offset), literal_length);
+        output_offset += literal_length;
+        if (match_length == 0)
+            return true;
+        if (!write_byte(match_offset & 0xff) || !write_byte(match_offset >> 8))
+            return false;
+        if (match_length - min_match_length >= 15 && !write_extra_length(match_length - min_match_length - 15))
+            return false;
+        return true;
+    };
+
+    size_t offset = 0;
+    while (offset + min_match_length <= input.size()) {
+        auto value = read_u32(input.offset_pointer(offset));
+        auto& entry = match_table[match_table_index(value)];
+        size_t candidate = entry;
+        entry = offset;
+        if (candidate == no_match || read_u32(input.offset_pointer(candidate)) != value) {
+            ++offset;
+            continue;
+        }
+
+        size_t match_length = min_match_length;
+        while (offset + match_length < input.size() && input[candidate + match_length] == input[offset + match_length])
+            ++match_length;
+        if (!write_sequence(offset - literals_offset, match_length, offset - candidate))
+            return {};
+        offset += match_length;
+        literals_offset = offset;
+    }
+
+    if (!write_sequence(input.size() - literals_offset, 0, 0))
+        return {};
+    return output_offset;
+}
+
+static bool decompress_page(ReadonlyBytes input, Bytes output)
+{
+    size_t input_offset = 0;
+    size_t output_offset = 0;
+
+    auto read_extra_length = [&](size_t& length) {
+        for (;;) {
+            if (input_offset >= input.size())
+                return false;
+            u8 byte = input[input_offset++];
+            length += byte;
+            if (byte != 255)
+                return true;
+        }
+    };
+
+    while (input_offset < input.size()) {
+        u8 token = input[input_offset++];
+
+        size_t literal_length = token >> 4;
+        if (literal_length == 15 && !read_extra_length(literal_length))
+            return false;
+        if (literal_length > input.size() - input_offset || literal_length > output.size() - output_offset)
+            return false;
+        memcpy(output.offset_pointer(output_offset), input.offset_pointer(input_offset), literal_length);
+        input_offset += literal_length;
+        output_offset += literal_length;
+
+        if (input_offset == input.size())
+            break;
+
+        if (input.size() - input_offset < 2)
+            return false;
+        size_t match_offset = input[input_offset] | (input[input_offset + 1] << 8);
+        input_offset += 2;
+        size_t match_length = (token & 0xf) + min_match_length;
+        if ((token & 0xf) == 15 && !read_extra_length(match_length))
+            return false;
+        if (match_offset == 0 || match_offset > output_offset || match_length > output.size() - output_offset)
+            return false;
+        // NOTE: The match may overlap the bytes it produces, so this has to go byte by byte.
+        for (size_t i = 0; i < match_length; ++i, ++output_offset)
+            output[output_offset] = output[output_offset - match_offset];
+    }
+
+    return output_offset == output.size();
+}
+
+static bool is_zero_page(u8 const* data)
+{
+    auto const* words = reinterpret_cast<u64 const*>(data);
+    for (size_t i = 0; i < PAGE_SIZE / sizeof(u64); ++i) {
+        if (words[i] != 0)
+            return false;
+    }
+    return true;
+}
+
+Optional<CompressedPageStore::Handle> CompressedPageStore::try_compress(RefPtr<PhysicalPage>& page)
+{
+    VERIFY(s_mm_lock.is_locked_by_current_processor());
+    VERIFY(page);
+
+    // Every slot starts with the size of the compressed data in it.
+    u16 compressed_size = 0;
+    Bytes compressed_data { m_compressed_buffer + sizeof(compressed_size), max_compressed_size - sizeof(compressed_size) };
+
+    auto* data = MM.quickmap_page(*page);
+    bool is_zero = is_zero_page(data);
+    auto compressed_size_or_empty = is_zero ? Optional<size_t> {} : compress_page({ data, PAGE_SIZE }, compressed_data, m_match_table);
+    MM.unquickmap_page();
+
+    if (is_zero) {
+        page = nullptr;
+        ++m_compressed_page_count;
+        return zero_page_handle;
+    }
+    if (!compressed_size_or_empty.has_value())
+        return {};
+
+    compressed_size = compressed_size_or_empty.value();
+    memcpy(m_compressed_buffer, &compressed_size, sizeof(compressed_size));
+    size_t stored_size = sizeof(compressed_size) + compressed_size;
+    size_t size_class = (stored_size - 1) / slot_size_granularity;
+
+    size_t pool_page_index = 0;
+    size_t slot = 0;
+    if (auto index = find_pool_page_with_free_slot(size_class); index.has_value()) {
+        pool_page_index = index.value();
+        auto& pool_page = m_pool_pages[pool_page_index];
+        slot = count_trailing_zeroes(static_cast<u16>(~pool_page.used_slots));
+        auto* pool_data = MM.quickmap_page(*pool_page.page);
+        memcpy(pool_data + slot * pool_page.slot_size(), m_compressed_buffer, stored_size);
+        MM.unquickmap_page();
+        page = nullptr;
+    } else {
+        // There's no room for it in the pool, so the page itself joins the pool and holds its own compressed data.
+        if (auto index = find_free_pool_page_entry(); index.has_value()) {
+            pool_page_index = index.value();
+        } else {
+            if (m_pool_pages.try_append({}).is_error())
+                return {};
+            pool_page_index = m_pool_pages.size() - 1;
+        }
+        auto* pool_data = MM.quickmap_page(*page);
+        memcpy(pool_data, m_compressed_buffer, stored_size);
+        MM.unquickmap_page();
+        auto& pool_page = m_pool_pages[pool_page_index];
+        pool_page.page = move(page);
+        pool_page.size_class = size_class;
+        ++m_pool_page_count;
+    }
+
+    m_pool_pages[pool_page_index].used_slots |= 1u << slot;
+    m_pool_page_hints[size_class] = pool_page_index;
+    ++m_compressed_page_count;
+    return make_handle(pool_page_index, slot);
+}
+
+void CompressedPageStore::decompress(Handle handle, PhysicalPage& page)
+{
+    VERIFY(s_mm_lock.is_locked_by_current_processor());
+
+    if (handle == zero_page_handle) {
+        auto* data = MM.quickmap_page(page);
+        memset(data, 0, PAGE_SIZE);
+        MM.unquickmap_page();
+        --m_compressed_page_count;
+        return;
+    }
+
+    auto& pool_page = m_pool_pages[pool_page_index_from_handle(handle)];
+    u16 compressed_size = 0;
+    auto* pool_data = MM.quickmap_page(*pool_page.page) + slot_from_handle(handle) * pool_page.slot_size();
+    memcpy(&compressed_size, pool_data, sizeof(compressed_size));
+    VERIFY(sizeof(compressed_size) + compressed_size <= pool_page.slot_size());
+    memcpy(m_compressed_buffer, pool_data + sizeof(compressed_size), compressed_size);
+    MM.unquickmap_page();
+
+    auto* data = MM.quickmap_page(page);
+    bool success = decompress_page({ m_compressed_buffer, compressed_size }, { data, PAGE_SIZE });
+    MM.unquickmap_page();
+    VERIFY(success);
+
+    release_slot(handle);
+}
+
+void CompressedPageStore::discard(Handle handle)
+{
+    VERIFY(s_mm_lock.is_locked_by_current_processor());
+    if (handle == zero_page_handle) {
+        --m_compressed_page_count;
+        return;
+    }
+    release_slot(handle);
+}
+
+void CompressedPageStore::release_slot(Handle handle)
+{
+    auto pool_page_index = pool_page_index_from_handle(handle);
+    auto& pool_page = m_pool_pages[pool_page_index];
+    u16 slot_bit = 1u << slot_from_handle(handle);
+    VERIFY(pool_page.used_slots & slot_bit);
+    pool_page.used_slots &= ~slot_bit;
+    --m_compressed_page_count;
+
+    if (pool_page.used_slots == 0) {
+        pool_page.page = nullptr;
+        --m_pool_page_count;
+        return;
+    }
+    m_pool_page_hints[pool_page.size_class] = pool_page_index;
+}
+
+Optional<size_t> CompressedPageStore::find_pool_page_with_free_slot(size_t size_class) const
+{
+    auto has_free_slot = [&](size_t index) {
+        auto const& pool_page = m_pool_pages[index];
+        return !pool_page.is_free() && pool_page.size_class == size_class && !pool_page.is_full();
+    };
+
+    auto hint = m_pool_page_hints[size_class];
+    if (hint < m_pool_pages.size() && has_free_slot(hint))
+        return hint;
+    for (size_t i = 0; i < m_pool_pages.size(); ++i) {
+        if (has_free_slot(i))
+            return i;
+    }
+    return {};
+}
+
+Optional<size_t> CompressedPageStore::find_free_pool_page_entry() const
+{
+    for (size_t i = 0; i < m_pool_pages.size(); ++i) {
+        if (m_pool_pages[i].is_free())
+            return i;
+    }
+    return {};
+}
+
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Array.h>
+#include <AK/BuiltinWrappers.h>
+#include <AK/Optional.h>
+#include <AK/RefPtr.h>
+#include <AK/Types.h>
+#include <AK/Vector.h>
+#include <Kernel/Memory/PhysicalPage.h>
+
+namespace Kernel::Memory {
+
+// Keeps the contents of anonymous pages that were compressed to free up memory (see AnonymousVMObject::compress_cold_pages()).
+//
+// The compressed data lives in physical pages of its own (the "pool"), each of which is cut into equally sized slots.
+// A compressed page takes up one slot of the smallest size that fits it, and is referred to by a handle that encodes
+// the pool page and the slot in it. Pages that are all zeros don't take up any room at all.
+//
+// Everything here has to be called with s_mm_lock held, as it runs when we're out of memory.
+class CompressedPageStore {
+    AK_MAKE_NONCOPYABLE(CompressedPageStore);
+    AK_MAKE_NONMOVABLE(CompressedPageStore);
+
+public:
+    using Handle = u32;
+    static constexpr Handle zero_page_handle = 0;
+
+    CompressedPageStore() = default;
+
+    // Compresses the (no longer mapped) page. On success, the page reference is taken away: the page is either freed or
+    // becomes part of the pool. Fails if the page doesn't compress well enough to be worth it, or we're out of memory.
+    Optional<Handle> try_compress(RefPtr<PhysicalPage>&);
+
+    // Fills the page with the contents that were compressed, and forgets about them.
+    void decompress(Handle, PhysicalPage&);
+
+    void discard(Handle);
+
+    size_t compressed_page_count() const { return m_compressed_page_count; }
+    size_t pool_page_count() const { return m_pool_page_count; }
+
+private:
+    static constexpr size_t slot_size_granularity = 256;
+
+    // Slots that are larger than half a page wouldn't save anything, as there's only room for one of them.
+    static constexpr size_t size_class_count = PAGE_SIZE / 2 / slot_size_granularity;
+    static constexpr size_t max_compressed_size = size_class_count * slot_size_granularity;
+
+    struct PoolPage {
+        RefPtr<PhysicalPage> page;
+        u8 size_class { 0 };
+        u16 used_slots { 0 };
+
+        bool is_free() const { return page.is_null(); }
+        size_t slot_size() const { return (size_class + 1) * slot_size_granularity; }
+        size_t slot_count() const { return PAGE_SIZE / slot_size(); }
+        bool is_full() const { return static_cast<size_t>(popcount(used_slots)) == slot_count(); }
+    };
+
+    static_assert(PAGE_SIZE / slot_size_granularity <= 16, "Slot bitmaps and handles have room for 16 slots per page");
+    static Handle make_handle(size_t pool_page_index, size_t slot) { return ((pool_page_index + 1) << 4) | slot; }
+    static size_t pool_page_index_from_handle(Handle handle) { return (handle >> 4) - 1; }
+    static size_t slot_from_handle(Handle handle) { return handle & 0xf; }
+
+    Optional<size_t> find_pool_page_with_free_slot(size_t size_class) const;
+    Optional<size_t> find_free_pool_page_entry() const;
+    void release_slot(Handle);
+
+    Vector<PoolPage> m_pool_pages;
+    Array<size_t, size_class_count> m_pool_page_hints {};
+    size_t m_compressed_page_count { 0 };
+    size_t m_pool_page_count { 0 };
+
+    // Scratch space for (de)compression, as only one page can be quickmapped at a time.
+    u8 m_compressed_buffer[max_compressed_size];
+    u16 m_match_table[4096];
+};
+
+}
@@ -10,6 +10,7 @@
 #include <Kernel/Arch/x86/PageFault.h>
 #include <Kernel/BootInfo.h>
 #include <Kernel/CMOS.h>
+#include <Kernel/Debug.h>
 #include <Kernel/FileSystem/Inode.h>
 #include <Kernel/Heap/kmalloc.h>
 #include <Kernel/Memory/AnonymousVMObject.h>
@@ -550,9 +551,11 @@ PageTableEntry* MemoryManager::pte(PageDirectory& page_directory, VirtualAddress
     u32 page_table_index = (vaddr.get() >> 12) & 0x1ff;
 
     auto* pd = quickmap_pd(const_cast<PageDirectory&>(page_directory), page_directory_table_index);
-    PageDirectoryEntry const& pde = pd[page_directory_index];
+    PageDirectoryEntry& pde = pd[page_directory_index];
     if (!pde.is_present())
         return nullptr;
+    if (pde.is_huge())
+        split_huge_page(page_directory, pde, vaddr);
 
     return &quickmap_pt(PhysicalAddress((FlatPtr)pde.page_table_base()))[page_table_index];
 }
@@ -568,8 +571,11 @@ PageTableEntry* MemoryManager::ensure_pte(PageDirectory& page_directory, Virtual
 
     auto* pd = quickmap_pd(page_directory, page_directory_table_index);
     auto& pde = pd[page_directory_index];
-    if (pde.is_present())
+    if (pde.is_present()) {
+        if (pde.is_huge())
+            split_huge_page(page_directory, pde, vaddr);
         return &quickmap_pt(PhysicalAddress(pde.page_table_base()))[page_table_index];
+    }
 
     bool did_purge = false;
     auto page_table = allocate_user_physical_page(ShouldZeroFill::Yes, &did_purge);
@@ -610,6 +616,8 @@ void MemoryManager::release_pte(PageDirectory& page_directory, VirtualAddress va
     auto* pd = quickmap_pd(page_directory, page_directory_table_index);
     PageDirectoryEntry& pde = pd[page_directory_index];
     if (pde.is_present()) {
+        if (pde.is_huge())
+            split_huge_page(page_directory, pde, vaddr);
         auto* page_table = quickmap_pt(PhysicalAddress((FlatPtr)pde.page_table_base()));
         auto& pte = page_table[page_table_index];
         pte.clear();
@@ -632,6 +640,133 @@ void MemoryManager::release_pte(PageDirectory& page_directory, VirtualAddress va
     }
 }
 
+bool MemoryManager::try_map_huge_page(PageDirectory& page_directory, VirtualAddress vaddr)
+{
+    VERIFY_INTERRUPTS_DISABLED();
+    VERIFY(s_mm_lock.is_locked_by_current_processor());
+    VERIFY(page_directory.get_lock().is_locked_by_current_processor());
+    VERIFY(vaddr.get() % huge_page_size == 0);
+    // Huge pages are only ever used for userspace; the kernel's page directory entries are shared.
+    VERIFY(&page_directory != m_kernel_page_directory.ptr());
+    u32 page_directory_table_index = (vaddr.get() >> 30) & 0x1ff;
+    u32 page_directory_index = (vaddr.get() >> 21) & 0x1ff;
+
+    auto* pd = quickmap_pd(page_directory, page_directory_table_index);
+    auto& pde = pd[page_directory_index];
+    if (!pde.is_present() || pde.is_huge())
+        return false;
+
+    auto page_table_paddr = PhysicalAddress(pde.page_table_base());
+    auto* page_table = quickmap_pt(page_table_paddr);
+
+    // Everything but the physical address and the accessed and dirty bits has to match.
+    constexpr u64 attribute_mask = 0x8000000000000f9fULL;
+    // Read-only ranges are usually waiting for copy-on-write faults, which would split them right away.
+    auto const& first_pte = page_table[0];
+    if (!first_pte.is_present() || !first_pte.is_writable() || first_pte.physical_page_base() % huge_page_size)
+        return false;
+    for (size_t i = 1; i < pages_per_huge_page; ++i) {
+        auto const& pte = page_table[i];
+        if (pte.physical_page_base() != first_pte.physical_page_base() + i * PAGE_SIZE)
+            return false;
+        if ((pte.raw() & attribute_mask) != (first_pte.raw() & attribute_mask))
+            return false;
+    }
+
+    if (page_directory.m_page_tables_behind_huge_pages.try_set(vaddr.get(), page_table_paddr).is_error())
+        return false;
+
+    PageDirectoryEntry huge_pde = pde;
+    huge_pde.set_huge_page_base(first_pte.physical_page_base());
+    huge_pde.set_huge(true);
+    huge_pde.set_writable(first_pte.is_writable());
+    huge_pde.set_user_allowed(first_pte.is_user_allowed());
+    huge_pde.set_write_through(first_pte.is_write_through());
+    huge_pde.set_cache_disabled(first_pte.is_cache_disabled());
+    huge_pde.set_execute_disabled(first_pte.is_execute_disabled());
+    huge_pde.set_global(false);
+    pde = huge_pde;
+
+    flush_tlb(&page_directory, vaddr, pages_per_huge_page);
+    return true;
+}
+
+void MemoryManager::split_huge_page(PageDirectory& page_directory, PageDirectoryEntry& pde, VirtualAddress vaddr)
+{
+    VERIFY(s_mm_lock.is_locked_by_current_processor());
+    VERIFY(pde.is_huge());
+    FlatPtr base = vaddr.get() & ~(huge_page_size - 1);
+    auto page_table_paddr = page_directory.m_page_tables_behind_huge_pages.get(base);
+    VERIFY(page_table_paddr.has_value());
+    page_directory.m_page_tables_behind_huge_pages.remove(base);
+
+    // The page table still maps the range exactly like the huge page did.
+    PageDirectoryEntry page_table_pde = pde;
+    page_table_pde.set_huge(false);
+    page_table_pde.set_page_table_base(page_table_paddr->get());
+    page_table_pde.set_user_allowed(true);
+    page_table_pde.set_writable(true);
+    page_table_pde.set_write_through(false);
+    page_table_pde.set_cache_disabled(false);
+    page_table_pde.set_execute_disabled(false);
+    pde = page_table_pde;
+
+    flush_tlb(&page_directory, VirtualAddress(base), pages_per_huge_page);
+}
+
+bool MemoryManager::test_and_clear_accessed(PageDirectory& page_directory, VirtualAddress vaddr)
+{
+    VERIFY_INTERRUPTS_DISABLED();
+    VERIFY(s_mm_lock.is_locked_by_current_processor());
+    VERIFY(page_directory.get_lock().is_locked_by_current_processor());
+    u32 page_directory_table_index = (vaddr.get() >> 30) & 0x1ff;
+    u32 page_directory_index = (vaddr.get() >> 21) & 0x1ff;
+    u32 page_table_index = (vaddr.get() >> 12) & 0x1ff;
+
+    auto* pd = quickmap_pd(page_directory, page_directory_table_index);
+    auto& pde = pd[page_directory_index];
+    if (!pde.is_present())
+        return false;
+    // We don't keep track of the pages inside a huge page, and splitting it up just to find out would defeat its purpose.
+    if (pde.is_huge())
+        return true;
+
+    // NOTE: We don't flush the TLB here. A page that stays in the TLB won't be marked as accessed again, so it may look
+    //       cold while it's in use. That only costs us a fault to bring it back, which isn't worth an IPI per page.
+    auto& pte = quickmap_pt(PhysicalAddress(pde.page_table_base()))[page_table_index];
+    bool was_accessed = pte.is_accessed();
+    pte.set_accessed(false);
+    return was_accessed;
+}
+
+size_t MemoryManager::compress_cold_pages(size_t max_page_count)
+{
+    VERIFY(s_mm_lock.is_locked_by_current_processor());
+    size_t compressed_page_count = 0;
+
+    // Every VMObject sweeps its pages like a clock hand, and compresses those that weren't accessed since it last came by.
+    // So the first round may only clear accessed bits, and the second one finds the pages that stayed cold.
+    // We pick up with the VMObject after the one we stopped at last time, to spread the cost around.
+    for (size_t round = 0; round < 2 && compressed_page_count < max_page_count; ++round) {
+        size_t first_vmobject = m_next_vmobject_to_compress;
+        for (size_t pass = 0; pass < 2 && compressed_page_count < max_page_count; ++pass) {
+            size_t index = 0;
+            for_each_vmobject([&](VMObject& vmobject) {
+                bool is_in_this_pass = pass == 0 ? index >= first_vmobject : index < first_vmobject;
+                ++index;
+                if (!is_in_this_pass || !vmobject.is_anonymous())
+                    return IterationDecision::Continue;
+                compressed_page_count += static_cast<AnonymousVMObject&>(vmobject).compress_cold_pages(max_page_count - compressed_page_count);
+                if (compressed_page_count < max_page_count)
+                    return IterationDecision::Continue;
+                m_next_vmobject_to_compress = index;
+                return IterationDecision::Break;
+            });
+        }
+    }
+    return compressed_page_count;
+}
+
 UNMAP_AFTER_INIT void MemoryManager::initialize(u32 cpu)
 {
     ProcessorSpecific<MemoryManagerData>::initialize();
@@ -898,6 +1033,31 @@ NonnullRefPtr<PhysicalPage> MemoryManager::allocate_committed_user_physical_page
     return page.release_nonnull();
 }
 
+NonnullRefPtrVector<PhysicalPage> MemoryManager::allocate_committed_user_physical_huge_page(Badge<CommittedPhysicalPageSet>)
+{
+    SpinlockLocker lock(s_mm_lock);
+    VERIFY(m_system_memory_info.user_physical_pages_committed >= pages_per_huge_page);
+
+    NonnullRefPtrVector<PhysicalPage> pages;
+    for (auto& region : m_user_physical_regions) {
+        pages = region.take_contiguous_free_pages(pages_per_huge_page, huge_page_size);
+        if (!pages.is_empty())
+            break;
+    }
+    if (pages.is_empty())
+        return {};
+
+    m_system_memory_info.user_physical_pages_committed -= pages_per_huge_page;
+    m_system_memory_info.user_physical_pages_used += pages_per_huge_page;
+
+    for (auto& page : pages) {
+        auto* ptr = quickmap_page(page);
+        memset(ptr, 0, PAGE_SIZE);
+        unquickmap_page();
+    }
+    return pages;
+}
+
 RefPtr<PhysicalPage> MemoryManager::allocate_user_physical_page(ShouldZeroFill should_zero_fill, bool* did_purge)
 {
     SpinlockLocker lock(s_mm_lock);
@@ -922,12 +1082,45 @@ RefPtr<PhysicalPage> MemoryManager::allocate_user_physical_page(ShouldZeroFill s
             }
             return IterationDecision::Continue;
         });
-        if (!page) {
-            dmesgln("MM: no user physical pages available");
-            return {};
+    }
+
+    if (!page) {
+        // Next, we drop clean file pages that are only mapped read-only, they can be read back from the inode.
+        // Pages under a writable mapping are never marked dirty, so we can't tell whether they're still clean.
+        for_each_vmobject([&](auto& vmobject) {
+            if (!vmobject.is_shared_inode())
+                return IterationDecision::Continue;
+            auto& inode_vmobject = static_cast<SharedInodeVMObject&>(vmobject);
+            if (inode_vmobject.writable_mappings())
+                return IterationDecision::Continue;
+            if (auto released_page_count = inode_vmobject.release_all_clean_pages()) {
+                dbgln("MM: Released {} clean pages from SharedInodeVMObject", released_page_count);
+                // Someone else may still hold a reference to the pages we released.
+                page = find_free_user_physical_page(false);
+                if (page)
+                    return IterationDecision::Break;
+            }
+            return IterationDecision::Continue;
+        });
+    }
+
+    if (!page) {
+        // Finally, we compress anonymous pages that haven't been used in a while. They come back when they're touched.
+        // We do a batch at a time, so the next few allocations don't have to go through all of this again.
+        static constexpr size_t pages_to_compress_at_once = 32;
+        if (auto compressed_page_count = compress_cold_pages(pages_to_compress_at_once)) {
+            dbgln_if(COMPRESSED_PAGE_DEBUG, "MM: Compressed {} cold anonymous pages", compressed_page_count);
+            page = find_free_user_physical_page(false);
+            // Compressing pages touches page tables, just like purging does.
+            purged_pages = true;
         }
     }
 
+    if (!page) {
+        dmesgln("MM: no user physical pages available");
+        return {};
+    }
+
     if (should_zero_fill == ShouldZeroFill::Yes) {
         auto* ptr = quickmap_page(*page);
         memset(ptr, 0, PAGE_SIZE);
@@ -1173,6 +1366,16 @@ NonnullRefPtr<PhysicalPage> CommittedPhysicalPageSet::take_one()
     return MM.allocate_committed_user_physical_page({}, MemoryManager::ShouldZeroFill::Yes);
 }
 
+NonnullRefPtrVector<PhysicalPage> CommittedPhysicalPageSet::try_take_huge_page()
+{
+    if (m_page_count < pages_per_huge_page)
+        return {};
+    auto pages = MM.allocate_committed_user_physical_huge_page({});
+    if (!pages.is_empty())
+        m_page_count -= pages_per_huge_page;
+    return pages;
+}
+
 void CommittedPhysicalPageSet::uncommit_one()
 {
     VERIFY(m_page_count > 0);
@@ -1188,4 +1391,12 @@ void MemoryManager::copy_physical_page(PhysicalPage& physical_page, u8 page_buff
     unquickmap_page();
 }
 
+void MemoryManager::fill_physical_page(PhysicalPage& physical_page, u8 const page_buffer[PAGE_SIZE])
+{
+    SpinlockLocker locker(s_mm_lock);
+    auto* quickmapped_page = quickmap_page(physical_page);
+    memcpy(quickmapped_page, page_buffer, PAGE_SIZE);
+    unquickmap_page();
+}
+
 }
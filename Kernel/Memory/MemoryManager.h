@@ -13,6 +13,7 @@
 #include <Kernel/Forward.h>
 #include <Kernel/Locking/Spinlock.h>
 #include <Kernel/Memory/AllocationStrategy.h>
+#include <Kernel/Memory/CompressedPageStore.h>
 #include <Kernel/Memory/PhysicalPage.h>
 #include <Kernel/Memory/PhysicalRegion.h>
 #include <Kernel/Memory/Region.h>
@@ -33,6 +34,11 @@ constexpr FlatPtr page_round_down(FlatPtr x)
     return ((FlatPtr)(x)) & ~(PAGE_SIZE - 1);
 }
 
+// Large anonymous regions are mapped with 2 MiB pages where possible. The VMObject still tracks
+// them as individual pages, the huge mapping is merely a shortcut in the page directory.
+constexpr size_t huge_page_size = 2 * MiB;
+constexpr size_t pages_per_huge_page = huge_page_size / PAGE_SIZE;
+
 inline FlatPtr virtual_to_low_physical(FlatPtr virtual_)
 {
     return virtual_ - physical_to_virtual_offset;
@@ -119,6 +125,8 @@ public:
     size_t page_count() const { return m_page_count; }
 
     [[nodiscard]] NonnullRefPtr<PhysicalPage> take_one();
+    // Returns an empty vector if there are not enough committed pages left, or no free huge page.
+    [[nodiscard]] NonnullRefPtrVector<PhysicalPage> try_take_huge_page();
     void uncommit_one();
 
     void operator=(CommittedPhysicalPageSet&&) = delete;
@@ -131,6 +139,7 @@ class MemoryManager {
     friend class PageDirectory;
     friend class AnonymousVMObject;
     friend class Region;
+    friend class TLBShootdownBatch;
     friend class VMObject;
     friend struct ::KmallocGlobalData;
 
@@ -169,6 +178,7 @@ public:
     void uncommit_user_physical_pages(Badge<CommittedPhysicalPageSet>, size_t page_count);
 
     NonnullRefPtr<PhysicalPage> allocate_committed_user_physical_page(Badge<CommittedPhysicalPageSet>, ShouldZeroFill = ShouldZeroFill::Yes);
+    NonnullRefPtrVector<PhysicalPage> allocate_committed_user_physical_huge_page(Badge<CommittedPhysicalPageSet>);
     RefPtr<PhysicalPage> allocate_user_physical_page(ShouldZeroFill = ShouldZeroFill::Yes, bool* did_purge = nullptr);
     RefPtr<PhysicalPage> allocate_supervisor_physical_page();
     NonnullRefPtrVector<PhysicalPage> allocate_contiguous_supervisor_physical_pages(size_t size);
@@ -191,12 +201,17 @@ public:
         PhysicalSize user_physical_pages_uncommitted { 0 };
         PhysicalSize super_physical_pages { 0 };
         PhysicalSize super_physical_pages_used { 0 };
+        PhysicalSize user_physical_pages_compressed { 0 };
+        PhysicalSize user_physical_pages_compressed_pool { 0 };
     };
 
     SystemMemoryInfo get_system_memory_info()
     {
         SpinlockLocker lock(s_mm_lock);
-        return m_system_memory_info;
+        auto info = m_system_memory_info;
+        info.user_physical_pages_compressed = m_compressed_page_store.compressed_page_count();
+        info.user_physical_pages_compressed_pool = m_compressed_page_store.pool_page_count();
+        return info;
     }
 
     template<IteratorFunction<VMObject&> Callback>
@@ -238,6 +253,7 @@ public:
     PhysicalAddress get_physical_address(PhysicalPage const&);
 
     void copy_physical_page(PhysicalPage&, u8 page_buffer[PAGE_SIZE]);
+    void fill_physical_page(PhysicalPage&, u8 const page_buffer[PAGE_SIZE]);
 
     IterationDecision for_each_physical_memory_range(Function<IterationDecision(PhysicalMemoryRange const&)>);
 
@@ -280,6 +296,18 @@ private:
     };
     void release_pte(PageDirectory&, VirtualAddress, IsLastPTERelease);
 
+    // Maps the 2 MiB range at the given (aligned) address with a single huge page, if its page table
+    // maps it to one naturally aligned run of physical memory with the same attributes throughout.
+    bool try_map_huge_page(PageDirectory&, VirtualAddress);
+    void split_huge_page(PageDirectory&, PageDirectoryEntry&, VirtualAddress);
+
+    // Clears the accessed bit of the page at the given address, and returns whether it was set.
+    bool test_and_clear_accessed(PageDirectory&, VirtualAddress);
+
+    // Compresses up to the given number of anonymous pages that haven't been used in a while, and returns how many it got.
+    size_t compress_cold_pages(size_t max_page_count);
+    CompressedPageStore& compressed_page_store() { return m_compressed_page_store; }
+
     RefPtr<PageDirectory> m_kernel_page_directory;
 
     RefPtr<PhysicalPage> m_shared_zero_page;
@@ -287,6 +315,9 @@ private:
 
     SystemMemoryInfo m_system_memory_info;
 
+    CompressedPageStore m_compressed_page_store;
+    size_t m_next_vmobject_to_compress { 0 };
+
     NonnullOwnPtrVector<PhysicalRegion> m_user_physical_regions;
     OwnPtr<PhysicalRegion> m_super_physical_region;
     OwnPtr<PhysicalRegion> m_physical_pages_region;
@@ -64,6 +64,10 @@ private:
 #else
     RefPtr<PhysicalPage> m_directory_pages[4];
 #endif
+    // While a 2 MiB range is mapped by a single huge page directory entry, the page table that
+    // used to map it is kept here (keyed by the range's base address), so that the range can
+    // go back to 4 KiB pages at any time without having to allocate anything.
+    HashMap<FlatPtr, PhysicalAddress> m_page_tables_behind_huge_pages;
     RecursiveSpinlock m_lock;
 };
 
@@ -59,8 +59,25 @@ void PhysicalRegion::initialize_zones()
         return zone_count;
     };
 
+    // The large zones can hand out naturally aligned blocks of up to their own size, but only relative
+    // to their base address. Start them on a huge page boundary so that those blocks are also aligned
+    // in physical memory, and cover the pages in front of that boundary with smaller power-of-two zones.
+    size_t pages_before_huge_page_boundary = ((huge_page_size - base_address.get() % huge_page_size) % huge_page_size) / PAGE_SIZE;
+    if (remaining_pages >= pages_before_huge_page_boundary + large_zone_size / PAGE_SIZE) {
+        while (pages_before_huge_page_boundary) {
+            size_t zone_page_count = 1u << count_trailing_zeroes(base_address.get() / PAGE_SIZE);
+            while (zone_page_count > pages_before_huge_page_boundary)
+                zone_page_count /= 2;
+            m_zones.append(make<PhysicalZone>(base_address, zone_page_count));
+            m_usable_zones.append(m_zones.last());
+            base_address = base_address.offset(zone_page_count * PAGE_SIZE);
+            remaining_pages -= zone_page_count;
+            pages_before_huge_page_boundary -= zone_page_count;
+        }
+    }
+
     // First make 16 MiB zones (with 4096 pages each)
-    m_large_zones = make_zones(large_zone_size);
+    make_zones(large_zone_size);
 
     // Then divide any remaining space into 1 MiB zones (with 256 pages each)
     make_zones(small_zone_size);
@@ -78,13 +95,17 @@ OwnPtr<PhysicalRegion> PhysicalRegion::try_take_pages_from_beginning(unsigned pa
     return try_create(taken_lower, taken_upper);
 }
 
-NonnullRefPtrVector<PhysicalPage> PhysicalRegion::take_contiguous_free_pages(size_t count)
+NonnullRefPtrVector<PhysicalPage> PhysicalRegion::take_contiguous_free_pages(size_t count, size_t physical_alignment)
 {
     auto rounded_page_count = next_power_of_two(count);
     auto order = count_trailing_zeroes(rounded_page_count);
+    // Blocks are aligned to their size relative to the base of their zone.
+    VERIFY(physical_alignment <= rounded_page_count * PAGE_SIZE);
 
     Optional<PhysicalAddress> page_base;
     for (auto& zone : m_usable_zones) {
+        if (zone.base().get() % physical_alignment)
+            continue;
         page_base = zone.allocate_block(order);
         if (page_base.has_value()) {
             if (zone.is_empty()) {
@@ -123,22 +144,30 @@ RefPtr<PhysicalPage> PhysicalRegion::take_free_page()
     return PhysicalPage::create(page.value());
 }
 
+PhysicalZone* PhysicalRegion::zone_containing(PhysicalAddress paddr)
+{
+    size_t low = 0;
+    size_t high = m_zones.size();
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        auto& zone = m_zones[middle];
+        if (paddr < zone.base())
+            high = middle;
+        else if (zone.contains(paddr))
+            return &zone;
+        else
+            low = middle + 1;
+    }
+    return nullptr;
+}
+
 void PhysicalRegion::return_page(PhysicalAddress paddr)
 {
-    auto large_zone_base = lower().get();
-    auto small_zone_base = lower().get() + (m_large_zones * large_zone_size);
-
-    size_t zone_index;
-    if (paddr.get() < small_zone_base)
-        zone_index = (paddr.get() - large_zone_base) / large_zone_size;
-    else
-        zone_index = m_large_zones + (paddr.get() - small_zone_base) / small_zone_size;
-
-    auto& zone = m_zones[zone_index];
-    VERIFY(zone.contains(paddr));
-    zone.deallocate_block(paddr, 0);
-    if (m_full_zones.contains(zone))
-        m_usable_zones.append(zone);
+    auto* zone = zone_containing(paddr);
+    VERIFY(zone);
+    zone->deallocate_block(paddr, 0);
+    if (m_full_zones.contains(*zone))
+        m_usable_zones.append(*zone);
 }
 
 }
@@ -34,7 +34,7 @@ public:
     OwnPtr<PhysicalRegion> try_take_pages_from_beginning(unsigned);
 
     RefPtr<PhysicalPage> take_free_page();
-    NonnullRefPtrVector<PhysicalPage> take_contiguous_free_pages(size_t count);
+    NonnullRefPtrVector<PhysicalPage> take_contiguous_free_pages(size_t count, size_t physical_alignment = PAGE_SIZE);
     void return_page(PhysicalAddress);
 
 private:
@@ -43,9 +43,10 @@ private:
     static constexpr size_t large_zone_size = 16 * MiB;
     static constexpr size_t small_zone_size = 1 * MiB;
 
-    NonnullOwnPtrVector<PhysicalZone> m_zones;
+    PhysicalZone* zone_containing(PhysicalAddress);
 
-    size_t m_large_zones { 0 };
+    // Sorted by base address.
+    NonnullOwnPtrVector<PhysicalZone> m_zones;
 
     PhysicalZone::List m_usable_zones;
     PhysicalZone::List m_full_zones;
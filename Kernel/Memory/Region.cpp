@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/ByteBuffer.h>
 #include <AK/Memory.h>
 #include <AK/StringView.h>
 #include <Kernel/Arch/x86/PageFault.h>
@@ -28,6 +29,7 @@ Region::Region(VirtualRange const& range, NonnullRefPtr<VMObject> vmobject, size
     , m_access(access | ((access & 0x7) << 4))
     , m_shared(shared)
     , m_cacheable(cacheable == Cacheable::Yes)
+    , m_write_combine(cacheable == Cacheable::WriteCombine)
 {
     VERIFY(m_range.base().is_page_aligned());
     VERIFY(m_range.size());
@@ -56,7 +58,7 @@ Region::~Region()
     }
 }
 
-ErrorOr<NonnullOwnPtr<Region>> Region::try_clone()
+ErrorOr<NonnullOwnPtr<Region>> Region::try_clone(ShouldFlushTLB should_flush_tlb)
 {
     VERIFY(Process::has_current());
 
@@ -72,7 +74,7 @@ ErrorOr<NonnullOwnPtr<Region>> Region::try_clone()
             region_name = TRY(m_name->try_clone());
 
         auto region = TRY(Region::try_create_user_accessible(
-            m_range, m_vmobject, m_offset_in_vmobject, move(region_name), access(), m_cacheable ? Cacheable::Yes : Cacheable::No, m_shared));
+            m_range, m_vmobject, m_offset_in_vmobject, move(region_name), access(), cacheable(), m_shared));
         region->set_mmap(m_mmap);
         region->set_shared(m_shared);
         region->set_syscall_region(is_syscall_region());
@@ -85,14 +87,16 @@ ErrorOr<NonnullOwnPtr<Region>> Region::try_clone()
     auto vmobject_clone = TRY(vmobject().try_clone());
 
     // Set up a COW region. The parent (this) region becomes COW as well!
-    remap();
+    // Pages of a region that isn't writable are already mapped read-only, so there is nothing to write-protect.
+    if (is_writable())
+        remap(should_flush_tlb);
 
     OwnPtr<KString> clone_region_name;
     if (m_name)
         clone_region_name = TRY(m_name->try_clone());
 
     auto clone_region = TRY(Region::try_create_user_accessible(
-        m_range, vmobject_clone, m_offset_in_vmobject, move(clone_region_name), access(), m_cacheable ? Cacheable::Yes : Cacheable::No, m_shared));
+        m_range, vmobject_clone, m_offset_in_vmobject, move(clone_region_name), access(), cacheable(), m_shared));
 
     if (m_stack) {
         VERIFY(is_readable());
@@ -121,6 +125,30 @@ size_t Region::cow_pages() const
     return static_cast<AnonymousVMObject const&>(vmobject()).cow_pages();
 }
 
+bool Region::can_adopt_pages() const
+{
+    if (!is_user() || !is_writable() || is_shared() || !vmobject().is_anonymous())
+        return false;
+    return !static_cast<AnonymousVMObject const&>(vmobject()).is_purgeable();
+}
+
+ErrorOr<void> Region::adopt_page(size_t page_index, NonnullRefPtr<PhysicalPage> page)
+{
+    VERIFY(can_adopt_pages());
+    auto page_index_in_vmobject = translate_to_vmobject_page(page_index);
+    static_cast<AnonymousVMObject&>(vmobject()).adopt_page(page_index_in_vmobject, move(page));
+    if (!remap_vmobject_page(page_index_in_vmobject))
+        return ENOMEM;
+    return {};
+}
+
+bool Region::can_use_huge_pages() const
+{
+    if (!can_adopt_pages() || !is_cacheable() || size() < huge_page_size)
+        return false;
+    return true;
+}
+
 size_t Region::amount_dirty() const
 {
     if (!vmobject().is_inode())
@@ -193,7 +221,9 @@ bool Region::map_individual_page_impl(size_t page_index)
     if (!page || (!is_readable() && !is_writable())) {
         pte->clear();
     } else {
-        pte->set_cache_disabled(!m_cacheable);
+        bool write_combine = m_write_combine && Processor::current().has_feature(CPUFeature::PAT);
+        pte->set_write_through(write_combine);
+        pte->set_cache_disabled(!m_cacheable && !write_combine);
         pte->set_physical_page_base(page->paddr().get());
         pte->set_present(true);
         if (page->is_shared_zero_page() || page->is_lazy_committed_page() || should_cow(page_index))
@@ -287,16 +317,37 @@ ErrorOr<void> Region::map(PageDirectory& page_directory, ShouldFlushTLB should_f
     if (page_index > 0) {
         if (should_flush_tlb == ShouldFlushTLB::Yes)
             MemoryManager::flush_tlb(m_page_directory, vaddr(), page_index);
-        if (page_index == page_count())
+        if (page_index == page_count()) {
+            if (can_use_huge_pages())
+                map_huge_pages_where_possible();
             return {};
+        }
     }
     return ENOMEM;
 }
 
-void Region::remap()
+void Region::map_lazily(PageDirectory& page_directory)
+{
+    SpinlockLocker page_lock(page_directory.get_lock());
+    SpinlockLocker lock(s_mm_lock);
+    if (is_user() && !is_shared()) {
+        VERIFY(!vmobject().is_shared_inode());
+    }
+    set_page_directory(page_directory);
+}
+
+void Region::map_huge_pages_where_possible()
+{
+    VERIFY(m_page_directory->get_lock().is_locked_by_current_processor());
+    VERIFY(s_mm_lock.is_locked_by_current_processor());
+    for (FlatPtr base = align_up_to(vaddr().get(), huge_page_size); base + huge_page_size <= range().end().get(); base += huge_page_size)
+        (void)MM.try_map_huge_page(*m_page_directory, VirtualAddress(base));
+}
+
+void Region::remap(ShouldFlushTLB should_flush_tlb)
 {
     VERIFY(m_page_directory);
-    auto result = map(*m_page_directory);
+    auto result = map(*m_page_directory, should_flush_tlb);
     if (result.is_error())
         TODO();
 }
@@ -307,16 +358,64 @@ void Region::clear_to_zero()
     SpinlockLocker locker(vmobject().m_lock);
     for (auto i = 0u; i < page_count(); ++i) {
         auto& page = physical_page_slot(i);
-        VERIFY(page);
-        if (page->is_shared_zero_page())
+        if (!page)
+            static_cast<AnonymousVMObject&>(vmobject()).discard_compressed_page(translate_to_vmobject_page(i));
+        else if (page->is_shared_zero_page())
             continue;
         page = MM.shared_zero_page();
     }
 }
 
+bool Region::try_lock_page_directory(u32& prev_flags)
+{
+    // Whoever holds the lock will want s_mm_lock next, so we can't wait for them. If it's this processor,
+    // it's in the middle of changing the page tables and we'd better stay out of its way.
+    auto& lock = m_page_directory->get_lock();
+    if (lock.is_locked_by_current_processor())
+        return false;
+    return lock.try_lock(prev_flags);
+}
+
+Optional<bool> Region::try_test_and_clear_accessed(Badge<AnonymousVMObject>, size_t page_index)
+{
+    VERIFY(s_mm_lock.is_locked_by_current_processor());
+    if (!m_page_directory || !translate_vmobject_page(page_index))
+        return false;
+    u32 prev_flags = 0;
+    if (!try_lock_page_directory(prev_flags))
+        return {};
+    bool was_accessed = MM.test_and_clear_accessed(*m_page_directory, vaddr_from_page_index(page_index));
+    m_page_directory->get_lock().unlock(prev_flags);
+    return was_accessed;
+}
+
+bool Region::try_unmap_vmobject_page(Badge<AnonymousVMObject>, size_t page_index)
+{
+    VERIFY(s_mm_lock.is_locked_by_current_processor());
+    if (!m_page_directory || !translate_vmobject_page(page_index))
+        return true;
+    u32 prev_flags = 0;
+    if (!try_lock_page_directory(prev_flags))
+        return false;
+    auto page_vaddr = vaddr_from_page_index(page_index);
+    if (auto* pte = MM.pte(*m_page_directory, page_vaddr))
+        pte->clear();
+    MemoryManager::flush_tlb(m_page_directory, page_vaddr);
+    m_page_directory->get_lock().unlock(prev_flags);
+    return true;
+}
+
 PageFaultResponse Region::handle_fault(PageFault const& fault)
 {
     auto page_index_in_region = page_index_from_address(fault.vaddr());
+
+    // Hold on to the lock of anonymous VMObjects, so none of their pages get compressed while we're looking at them.
+    Optional<SpinlockLocker<RecursiveSpinlock>> vmobject_locker;
+    if (vmobject().is_anonymous()) {
+        vmobject_locker.emplace(vmobject().m_lock);
+        if (!physical_page_slot(page_index_in_region))
+            return handle_compressed_page_fault(page_index_in_region);
+    }
     if (fault.type() == PageFault::Type::PageNotPresent) {
         if (fault.is_read() && !is_readable()) {
             dbgln("NP(non-readable) fault in Region({})[{}]", this, page_index_in_region);
@@ -340,8 +439,9 @@ PageFaultResponse Region::handle_fault(PageFault const& fault)
                 return PageFaultResponse::OutOfMemory;
             return PageFaultResponse::Continue;
         }
-        dbgln("BUG! Unexpected NP fault at {}", fault.vaddr());
-        return PageFaultResponse::ShouldCrash;
+
+        // The page is there, we just haven't mapped it yet (see map_lazily()).
+        return handle_lazily_mapped_page_fault(fault, page_index_in_region);
     }
     VERIFY(fault.type() == PageFault::Type::ProtectionViolation);
     if (fault.access() == PageFault::Access::Write && is_writable() && should_cow(page_index_in_region)) {
@@ -357,6 +457,21 @@ PageFaultResponse Region::handle_fault(PageFault const& fault)
     return PageFaultResponse::ShouldCrash;
 }
 
+PageFaultResponse Region::handle_compressed_page_fault(size_t page_index_in_region)
+{
+    VERIFY_INTERRUPTS_DISABLED();
+    VERIFY(vmobject().m_lock.is_locked_by_current_processor());
+    dbgln_if(COMPRESSED_PAGE_DEBUG, "NP(compressed) fault in Region({})[{}]", this, page_index_in_region);
+
+    // Whatever kind of access faulted, it gets to try again (and maybe fault for another reason) once the page is back.
+    auto page_index_in_vmobject = translate_to_vmobject_page(page_index_in_region);
+    if (!static_cast<AnonymousVMObject&>(vmobject()).restore_compressed_page(page_index_in_vmobject))
+        return PageFaultResponse::OutOfMemory;
+    if (!remap_vmobject_page(page_index_in_vmobject))
+        return PageFaultResponse::OutOfMemory;
+    return PageFaultResponse::Continue;
+}
+
 PageFaultResponse Region::handle_zero_fault(size_t page_index_in_region)
 {
     VERIFY_INTERRUPTS_DISABLED();
@@ -378,6 +493,11 @@ PageFaultResponse Region::handle_zero_fault(size_t page_index_in_region)
     if (current_thread != nullptr)
         current_thread->did_zero_fault();
 
+    if (page_slot->is_lazy_committed_page() && can_use_huge_pages()) {
+        if (auto response = try_handle_zero_fault_with_huge_page(page_index_in_region); response.has_value())
+            return response.release_value();
+    }
+
     if (page_slot->is_lazy_committed_page()) {
         VERIFY(m_vmobject->is_anonymous());
         page_slot = static_cast<AnonymousVMObject&>(*m_vmobject).allocate_committed_page({});
@@ -398,6 +518,61 @@ PageFaultResponse Region::handle_zero_fault(size_t page_index_in_region)
     return PageFaultResponse::Continue;
 }
 
+Optional<PageFaultResponse> Region::try_handle_zero_fault_with_huge_page(size_t page_index_in_region)
+{
+    VERIFY(vmobject().m_lock.is_locked_by_current_processor());
+
+    // Only do this if the whole surrounding 2 MiB range belongs to us and is untouched.
+    FlatPtr base = vaddr_from_page_index(page_index_in_region).get() & ~(huge_page_size - 1);
+    if (base < vaddr().get() || base + huge_page_size > range().end().get())
+        return {};
+    auto first_page_index = page_index_from_address(VirtualAddress(base));
+    for (size_t i = 0; i < pages_per_huge_page; ++i) {
+        auto& page_slot = physical_page_slot(first_page_index + i);
+        if (!page_slot || !page_slot->is_lazy_committed_page())
+            return {};
+    }
+
+    auto pages = static_cast<AnonymousVMObject&>(vmobject()).try_allocate_committed_huge_page({});
+    if (pages.is_empty())
+        return {};
+    dbgln_if(PAGE_FAULT_DEBUG, "      >> ALLOCATED HUGE PAGE {} for {:p}", pages.first().paddr(), base);
+
+    for (size_t i = 0; i < pages_per_huge_page; ++i)
+        physical_page_slot(first_page_index + i) = pages[i];
+
+    SpinlockLocker page_lock(m_page_directory->get_lock());
+    SpinlockLocker lock(s_mm_lock);
+    for (size_t i = 0; i < pages_per_huge_page; ++i) {
+        if (!map_individual_page_impl(first_page_index + i)) {
+            dmesgln("MM: handle_zero_fault was unable to allocate a page table to map {:p}", base);
+            return PageFaultResponse::OutOfMemory;
+        }
+    }
+    if (!MM.try_map_huge_page(*m_page_directory, VirtualAddress(base)))
+        MemoryManager::flush_tlb(m_page_directory, VirtualAddress(base), pages_per_huge_page);
+    return PageFaultResponse::Continue;
+}
+
+PageFaultResponse Region::handle_lazily_mapped_page_fault(PageFault const& fault, size_t page_index_in_region)
+{
+    VERIFY_INTERRUPTS_DISABLED();
+    dbgln_if(PAGE_FAULT_DEBUG, "NP(lazy) fault in Region({})[{}] at {}", this, page_index_in_region, fault.vaddr());
+
+    // Don't take a second fault just to break COW on a write.
+    if (fault.is_write() && should_cow(page_index_in_region)) {
+        if (physical_page(page_index_in_region)->is_shared_zero_page())
+            return handle_zero_fault(page_index_in_region);
+        return handle_cow_fault(page_index_in_region);
+    }
+
+    // Only map the page into this region. If we share the VMObject with others, they map it themselves when they need it.
+    SpinlockLocker locker(vmobject().m_lock);
+    if (!do_remap_vmobject_page(translate_to_vmobject_page(page_index_in_region)))
+        return PageFaultResponse::OutOfMemory;
+    return PageFaultResponse::Continue;
+}
+
 PageFaultResponse Region::handle_cow_fault(size_t page_index_in_region)
 {
     VERIFY_INTERRUPTS_DISABLED();
@@ -415,6 +590,50 @@ PageFaultResponse Region::handle_cow_fault(size_t page_index_in_region)
     return response;
 }
 
+// When handling an inode fault, we also map whichever pages in this window around the faulting page are already resident.
+static constexpr size_t inode_fault_around_pages = 16;
+
+// Read-ahead starts at this many pages once faults look sequential, and doubles from there on.
+static constexpr size_t initial_inode_fault_read_ahead_pages = 4;
+static constexpr size_t maximum_inode_fault_read_ahead_pages = 32;
+
+size_t Region::inode_fault_read_ahead_pages(size_t page_index_in_region)
+{
+    // A fault counts as sequential if it lands just past what the previous fault read and mapped.
+    auto sequential_limit = m_last_inode_fault_page_index + m_inode_fault_read_ahead_pages + inode_fault_around_pages + 1;
+    bool is_sequential = page_index_in_region >= m_last_inode_fault_page_index && page_index_in_region <= sequential_limit;
+
+    if (!is_sequential)
+        m_inode_fault_read_ahead_pages = 0;
+    else if (m_inode_fault_read_ahead_pages == 0)
+        m_inode_fault_read_ahead_pages = initial_inode_fault_read_ahead_pages;
+    else
+        m_inode_fault_read_ahead_pages = min(m_inode_fault_read_ahead_pages * 2, maximum_inode_fault_read_ahead_pages);
+
+    m_last_inode_fault_page_index = page_index_in_region;
+    return m_inode_fault_read_ahead_pages;
+}
+
+void Region::map_resident_inode_pages_around(size_t page_index_in_region, size_t pages_read)
+{
+    VERIFY(vmobject().m_lock.is_locked_by_current_processor());
+    if (!m_page_directory)
+        return;
+
+    auto first_page_index = page_index_in_region - (page_index_in_region % inode_fault_around_pages);
+    auto end_page_index = min(max(first_page_index + inode_fault_around_pages, page_index_in_region + pages_read), page_count());
+
+    SpinlockLocker page_lock(m_page_directory->get_lock());
+    SpinlockLocker lock(s_mm_lock);
+    for (auto page_index = first_page_index; page_index < end_page_index; ++page_index) {
+        if (page_index == page_index_in_region || !physical_page(page_index))
+            continue;
+        // These pages were not present before, so there can't be any stale TLB entries to flush.
+        if (!map_individual_page_impl(page_index))
+            break;
+    }
+}
+
 PageFaultResponse Region::handle_inode_fault(size_t page_index_in_region)
 {
     VERIFY_INTERRUPTS_DISABLED();
@@ -427,27 +646,46 @@ PageFaultResponse Region::handle_inode_fault(size_t page_index_in_region)
     auto page_index_in_vmobject = translate_to_vmobject_page(page_index_in_region);
     auto& vmobject_physical_page_entry = inode_vmobject.physical_pages()[page_index_in_vmobject];
 
+    auto read_ahead_pages = inode_fault_read_ahead_pages(page_index_in_region);
+    size_t pages_to_read = 1;
+
     {
         SpinlockLocker locker(inode_vmobject.m_lock);
         if (!vmobject_physical_page_entry.is_null()) {
             dbgln_if(PAGE_FAULT_DEBUG, "handle_inode_fault: Page faulted in by someone else before reading, remapping.");
             if (!remap_vmobject_page(page_index_in_vmobject))
                 return PageFaultResponse::OutOfMemory;
+            map_resident_inode_pages_around(page_index_in_region, 1);
             return PageFaultResponse::Continue;
         }
+
+        // Read ahead for as long as the following pages aren't resident yet.
+        auto max_pages_to_read = min(1 + read_ahead_pages, min(page_count() - page_index_in_region, inode_vmobject.page_count() - page_index_in_vmobject));
+        while (pages_to_read < max_pages_to_read && inode_vmobject.physical_pages()[page_index_in_vmobject + pages_to_read].is_null())
+            ++pages_to_read;
     }
 
-    dbgln_if(PAGE_FAULT_DEBUG, "Inode fault in {} page index: {}", name(), page_index_in_region);
+    dbgln_if(PAGE_FAULT_DEBUG, "Inode fault in {} page index: {}, reading {} pages", name(), page_index_in_region, pages_to_read);
 
     auto current_thread = Thread::current();
     if (current_thread)
         current_thread->did_inode_fault();
 
     u8 page_buffer[PAGE_SIZE];
+    u8* data = page_buffer;
+    Optional<ByteBuffer> read_ahead_buffer;
+    if (pages_to_read > 1) {
+        read_ahead_buffer = ByteBuffer::create_uninitialized(pages_to_read * PAGE_SIZE);
+        if (read_ahead_buffer.has_value())
+            data = read_ahead_buffer->data();
+        else
+            pages_to_read = 1;
+    }
+
     auto& inode = inode_vmobject.inode();
 
-    auto buffer = UserOrKernelBuffer::for_kernel_buffer(page_buffer);
-    auto result = inode.read_bytes(page_index_in_vmobject * PAGE_SIZE, PAGE_SIZE, buffer, nullptr);
+    auto buffer = UserOrKernelBuffer::for_kernel_buffer(data);
+    auto result = inode.read_bytes(page_index_in_vmobject * PAGE_SIZE, pages_to_read * PAGE_SIZE, buffer, nullptr);
 
     if (result.is_error()) {
         dmesgln("handle_inode_fault: Error ({}) while reading from inode", result.error());
@@ -455,9 +693,9 @@ PageFaultResponse Region::handle_inode_fault(size_t page_index_in_region)
     }
 
     auto nread = result.value();
-    if (nread < PAGE_SIZE) {
-        // If we read less than a page, zero out the rest to avoid leaking uninitialized data.
-        memset(page_buffer + nread, 0, PAGE_SIZE - nread);
+    if (nread < pages_to_read * PAGE_SIZE) {
+        // If we read less than we asked for, zero out the rest to avoid leaking uninitialized data.
+        memset(data + nread, 0, pages_to_read * PAGE_SIZE - nread);
     }
 
     SpinlockLocker locker(inode_vmobject.m_lock);
@@ -468,26 +706,35 @@ PageFaultResponse Region::handle_inode_fault(size_t page_index_in_region)
         dbgln_if(PAGE_FAULT_DEBUG, "handle_inode_fault: Page faulted in by someone else, remapping.");
         if (!remap_vmobject_page(page_index_in_vmobject))
             return PageFaultResponse::OutOfMemory;
+        map_resident_inode_pages_around(page_index_in_region, 1);
         return PageFaultResponse::Continue;
     }
 
-    vmobject_physical_page_entry = MM.allocate_user_physical_page(MemoryManager::ShouldZeroFill::No);
+    for (size_t i = 0; i < pages_to_read; ++i) {
+        auto& physical_page_entry = inode_vmobject.physical_pages()[page_index_in_vmobject + i];
+        if (!physical_page_entry.is_null())
+            continue;
 
-    if (vmobject_physical_page_entry.is_null()) {
-        dmesgln("MM: handle_inode_fault was unable to allocate a physical page");
-        return PageFaultResponse::OutOfMemory;
-    }
+        auto physical_page = MM.allocate_user_physical_page(MemoryManager::ShouldZeroFill::No);
+        if (physical_page.is_null()) {
+            if (i == 0) {
+                dmesgln("MM: handle_inode_fault was unable to allocate a physical page");
+                return PageFaultResponse::OutOfMemory;
+            }
+            // We're low on memory, so just don't cache the pages we read ahead.
+            pages_to_read = i;
+            break;
+        }
 
-    {
-        SpinlockLocker mm_locker(s_mm_lock);
-        u8* dest_ptr = MM.quickmap_page(*vmobject_physical_page_entry);
-        memcpy(dest_ptr, page_buffer, PAGE_SIZE);
-        MM.unquickmap_page();
+        MM.fill_physical_page(*physical_page, data + i * PAGE_SIZE);
+        physical_page_entry = move(physical_page);
     }
 
     if (!remap_vmobject_page(page_index_in_vmobject))
         return PageFaultResponse::OutOfMemory;
 
+    map_resident_inode_pages_around(page_index_in_region, pages_to_read);
+
     return PageFaultResponse::Continue;
 }
 
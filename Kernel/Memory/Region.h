@@ -48,6 +48,9 @@ public:
     enum class Cacheable {
         No = 0,
         Yes,
+        // Not cached, but writes are combined before they go out, which is much faster for e.g. framebuffers.
+        // Without PAT support, this is the same as No.
+        WriteCombine,
     };
 
     static ErrorOr<NonnullOwnPtr<Region>> try_create_user_accessible(VirtualRange const&, NonnullRefPtr<VMObject>, size_t offset_in_vmobject, OwnPtr<KString> name, Region::Access access, Cacheable, bool shared);
@@ -67,6 +70,12 @@ public:
     [[nodiscard]] bool has_been_executable() const { return (m_access & Access::HasBeenExecutable) == Access::HasBeenExecutable; }
 
     [[nodiscard]] bool is_cacheable() const { return m_cacheable; }
+    [[nodiscard]] Cacheable cacheable() const
+    {
+        if (m_write_combine)
+            return Cacheable::WriteCombine;
+        return m_cacheable ? Cacheable::Yes : Cacheable::No;
+    }
     [[nodiscard]] StringView name() const { return m_name ? m_name->view() : StringView {}; }
     [[nodiscard]] OwnPtr<KString> take_name() { return move(m_name); }
     [[nodiscard]] Region::Access access() const { return static_cast<Region::Access>(m_access); }
@@ -91,7 +100,7 @@ public:
 
     PageFaultResponse handle_fault(PageFault const&);
 
-    ErrorOr<NonnullOwnPtr<Region>> try_clone();
+    ErrorOr<NonnullOwnPtr<Region>> try_clone(ShouldFlushTLB = ShouldFlushTLB::Yes);
 
     [[nodiscard]] bool contains(VirtualAddress vaddr) const
     {
@@ -166,6 +175,15 @@ public:
 
     [[nodiscard]] size_t cow_pages() const;
 
+    // Whether pages of this region can be replaced with pages handed to us by someone else,
+    // which is how large LocalSocket messages end up in userspace without being copied.
+    [[nodiscard]] bool can_adopt_pages() const;
+    ErrorOr<void> adopt_page(size_t page_index, NonnullRefPtr<PhysicalPage>);
+
+    // Whether zero faults should try to populate a whole 2 MiB range at once, so that it
+    // can be mapped with a single huge page.
+    [[nodiscard]] bool can_use_huge_pages() const;
+
     void set_readable(bool b) { set_access_bit(Access::Read, b); }
     void set_writable(bool b) { set_access_bit(Access::Write, b); }
     void set_executable(bool b) { set_access_bit(Access::Execute, b); }
@@ -174,6 +192,9 @@ public:
 
     void set_page_directory(PageDirectory&);
     ErrorOr<void> map(PageDirectory&, ShouldFlushTLB = ShouldFlushTLB::Yes);
+    // Like map(), but doesn't populate any page table entries up front.
+    // Pages get mapped one at a time as they are faulted in.
+    void map_lazily(PageDirectory&);
     enum class ShouldDeallocateVirtualRange {
         No,
         Yes,
@@ -181,10 +202,15 @@ public:
     void unmap(ShouldDeallocateVirtualRange, ShouldFlushTLB = ShouldFlushTLB::Yes);
     void unmap_with_locks_held(ShouldDeallocateVirtualRange, ShouldFlushTLB, SpinlockLocker<RecursiveSpinlock>& pd_locker, SpinlockLocker<RecursiveSpinlock>& mm_locker);
 
-    void remap();
+    void remap(ShouldFlushTLB = ShouldFlushTLB::Yes);
 
     void clear_to_zero();
 
+    // For AnonymousVMObject::compress_cold_pages(), which runs with s_mm_lock held. Both of these take a page index
+    // in the VMObject, and give up if someone else is holding our page directory's lock.
+    Optional<bool> try_test_and_clear_accessed(Badge<AnonymousVMObject>, size_t page_index);
+    [[nodiscard]] bool try_unmap_vmobject_page(Badge<AnonymousVMObject>, size_t page_index);
+
     [[nodiscard]] bool is_syscall_region() const { return m_syscall_region; }
     void set_syscall_region(bool b) { m_syscall_region = b; }
 
@@ -202,20 +228,34 @@ private:
             m_access &= ~access;
     }
 
+    [[nodiscard]] PageFaultResponse handle_compressed_page_fault(size_t page_index);
     [[nodiscard]] PageFaultResponse handle_cow_fault(size_t page_index);
     [[nodiscard]] PageFaultResponse handle_inode_fault(size_t page_index);
+    [[nodiscard]] PageFaultResponse handle_lazily_mapped_page_fault(PageFault const&, size_t page_index);
     [[nodiscard]] PageFaultResponse handle_zero_fault(size_t page_index);
+    [[nodiscard]] Optional<PageFaultResponse> try_handle_zero_fault_with_huge_page(size_t page_index);
+
+    void map_huge_pages_where_possible();
+
+    [[nodiscard]] size_t inode_fault_read_ahead_pages(size_t page_index);
+    void map_resident_inode_pages_around(size_t page_index, size_t page_count);
 
     [[nodiscard]] bool map_individual_page_impl(size_t page_index);
 
+    [[nodiscard]] bool try_lock_page_directory(u32& prev_flags);
+
     RefPtr<PageDirectory> m_page_directory;
     VirtualRange m_range;
     size_t m_offset_in_vmobject { 0 };
     NonnullRefPtr<VMObject> m_vmobject;
     OwnPtr<KString> m_name;
     u8 m_access { Region::None };
+    // Used to detect sequential inode faults. This is only a heuristic, so we don't bother locking it.
+    size_t m_last_inode_fault_page_index { 0 };
+    size_t m_inode_fault_read_ahead_pages { 0 };
     bool m_shared : 1 { false };
     bool m_cacheable : 1 { false };
+    bool m_write_combine : 1 { false };
     bool m_stack : 1 { false };
     bool m_mmap : 1 { false };
     bool m_syscall_region : 1 { false };
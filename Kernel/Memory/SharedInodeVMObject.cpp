@@ -16,6 +16,7 @@ ErrorOr<NonnullRefPtr<SharedInodeVMObject>> SharedInodeVMObject::try_create_with
     if (auto shared_vmobject = inode.shared_vmobject())
         return shared_vmobject.release_nonnull();
     auto vmobject = TRY(adopt_nonnull_ref_or_enomem(new (nothrow) SharedInodeVMObject(inode, size)));
+    inode.share_physical_pages(vmobject->physical_pages());
     vmobject->inode().set_shared_vmobject(*vmobject);
     return vmobject;
 }
@@ -55,4 +56,97 @@ ErrorOr<void> SharedInodeVMObject::sync(off_t offset_in_pages, size_t pages)
     return {};
 }
 
+ErrorOr<void> SharedInodeVMObject::ensure_page_is_resident(size_t page_index, u8 page_buffer[PAGE_SIZE])
+{
+    {
+        SpinlockLocker locker(m_lock);
+        if (auto physical_page = m_physical_pages[page_index]) {
+            MM.copy_physical_page(*physical_page, page_buffer);
+            return {};
+        }
+    }
+
+    auto buffer = UserOrKernelBuffer::for_kernel_buffer(page_buffer);
+    auto nread = TRY(m_inode->read_bytes(page_index * PAGE_SIZE, PAGE_SIZE, buffer, nullptr));
+    if (nread < PAGE_SIZE) {
+        // If we read less than a page, zero out the rest to avoid leaking uninitialized data.
+        memset(page_buffer + nread, 0, PAGE_SIZE - nread);
+    }
+
+    // If we're out of memory we can still satisfy this read, we just won't cache the page.
+    auto new_page = MM.allocate_user_physical_page(MemoryManager::ShouldZeroFill::No);
+    if (!new_page)
+        return {};
+    MM.fill_physical_page(*new_page, page_buffer);
+
+    SpinlockLocker locker(m_lock);
+    auto& physical_page = m_physical_pages[page_index];
+    if (physical_page) {
+        // Someone else faulted in this page while we were reading from the inode.
+        MM.copy_physical_page(*physical_page, page_buffer);
+        return {};
+    }
+    physical_page = move(new_page);
+    return {};
+}
+
+ErrorOr<size_t> SharedInodeVMObject::read_bytes(off_t offset, size_t count, UserOrKernelBuffer& buffer, OpenFileDescription* description)
+{
+    VERIFY(offset >= 0);
+    auto inode_size = static_cast<u64>(m_inode->size());
+    if (static_cast<u64>(offset) >= inode_size)
+        return 0;
+    count = min<u64>(count, inode_size - offset);
+
+    // Anything beyond the end of the file as it was when we were created isn't covered by our pages.
+    auto cached_end = min<u64>(inode_size, static_cast<u64>(page_count()) * PAGE_SIZE);
+
+    size_t nread = 0;
+    while (nread < count && offset + nread < cached_end) {
+        auto position = offset + nread;
+        auto page_index = position / PAGE_SIZE;
+        auto offset_in_page = position % PAGE_SIZE;
+        auto chunk_size = min<u64>(min<u64>(count - nread, PAGE_SIZE - offset_in_page), cached_end - position);
+
+        u8 page_buffer[PAGE_SIZE];
+        TRY(ensure_page_is_resident(page_index, page_buffer));
+        TRY(buffer.write(page_buffer + offset_in_page, nread, chunk_size));
+        nread += chunk_size;
+    }
+
+    if (nread < count) {
+        auto remaining_buffer = buffer.offset(nread);
+        nread += TRY(m_inode->read_bytes(offset + nread, count - nread, remaining_buffer, description));
+    }
+    return nread;
+}
+
+ErrorOr<void> SharedInodeVMObject::did_write_bytes(off_t offset, size_t count, UserOrKernelBuffer const& data)
+{
+    VERIFY(offset >= 0);
+    auto cached_end = min<u64>(static_cast<u64>(offset) + count, static_cast<u64>(page_count()) * PAGE_SIZE);
+
+    size_t nupdated = 0;
+    while (offset + nupdated < cached_end) {
+        auto position = offset + nupdated;
+        auto page_index = position / PAGE_SIZE;
+        auto offset_in_page = position % PAGE_SIZE;
+        auto chunk_size = min<u64>(PAGE_SIZE - offset_in_page, cached_end - position);
+
+        RefPtr<PhysicalPage> physical_page;
+        {
+            SpinlockLocker locker(m_lock);
+            physical_page = m_physical_pages[page_index];
+        }
+        if (physical_page) {
+            u8 page_buffer[PAGE_SIZE];
+            MM.copy_physical_page(*physical_page, page_buffer);
+            TRY(data.read(page_buffer + offset_in_page, nupdated, chunk_size));
+            MM.fill_physical_page(*physical_page, page_buffer);
+        }
+        nupdated += chunk_size;
+    }
+    return {};
+}
+
 }
@@ -20,9 +20,17 @@ public:
 
     ErrorOr<void> sync(off_t offset_in_pages = 0, size_t pages = -1);
 
+    // Reads file contents through the pages of this VMObject, so read() and mmap() share one copy of the data.
+    ErrorOr<size_t> read_bytes(off_t offset, size_t count, UserOrKernelBuffer& buffer, OpenFileDescription*);
+
+    // Brings resident pages up to date after data has been written to the inode behind our back.
+    ErrorOr<void> did_write_bytes(off_t offset, size_t count, UserOrKernelBuffer const& data);
+
 private:
     virtual bool is_shared_inode() const override { return true; }
 
+    ErrorOr<void> ensure_page_is_resident(size_t page_index, u8 page_buffer[PAGE_SIZE]);
+
     explicit SharedInodeVMObject(Inode&, size_t);
     explicit SharedInodeVMObject(SharedInodeVMObject const&);
 
@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/Memory/MemoryManager.h>
+#include <Kernel/Memory/TLBShootdownBatch.h>
+
+namespace Kernel::Memory {
+
+TLBShootdownBatch::TLBShootdownBatch(PageDirectory& page_directory)
+    : m_page_directory(page_directory)
+{
+}
+
+TLBShootdownBatch::~TLBShootdownBatch()
+{
+    flush();
+}
+
+void TLBShootdownBatch::add(VirtualRange const& range)
+{
+    if (!range.size())
+        return;
+    if (m_start == m_end) {
+        m_start = range.base().get();
+        m_end = range.end().get();
+        return;
+    }
+    m_start = min(m_start, range.base().get());
+    m_end = max(m_end, range.end().get());
+}
+
+void TLBShootdownBatch::flush()
+{
+    if (m_start == m_end)
+        return;
+    // We flush the bounding range of everything that was added. Ranges are usually close
+    // together, and large flushes fall back to a full TLB flush in Processor::flush_tlb().
+    MemoryManager::flush_tlb(m_page_directory.ptr(), VirtualAddress(m_start), (m_end - m_start) / PAGE_SIZE);
+    m_start = 0;
+    m_end = 0;
+}
+
+}
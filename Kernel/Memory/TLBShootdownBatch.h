@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Noncopyable.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/Types.h>
+#include <Kernel/Forward.h>
+#include <Kernel/Memory/PageDirectory.h>
+#include <Kernel/Memory/VirtualRange.h>
+
+namespace Kernel::Memory {
+
+// Collects the ranges touched by a series of map/unmap operations on one page directory
+// and invalidates them with a single TLB flush (and thus at most one IPI) when flushed
+// or destroyed. Callers map and unmap with ShouldFlushTLB::No and add() the ranges here.
+//
+// Anything the stale translations may still point at (e.g. the physical pages of an
+// unmapped region) must be kept alive until the batch has been flushed.
+class TLBShootdownBatch {
+    AK_MAKE_NONCOPYABLE(TLBShootdownBatch);
+    AK_MAKE_NONMOVABLE(TLBShootdownBatch);
+
+public:
+    explicit TLBShootdownBatch(PageDirectory&);
+    ~TLBShootdownBatch();
+
+    void add(VirtualRange const&);
+    void flush();
+
+private:
+    NonnullRefPtr<PageDirectory> m_page_directory;
+    FlatPtr m_start { 0 };
+    FlatPtr m_end { 0 };
+};
+
+}
@@ -278,8 +278,10 @@ ErrorOr<size_t> IPv4Socket::receive_byte_buffered(OpenFileDescription& descripti
     else
         nreceived_or_error = m_receive_buffer->read(buffer, buffer_length);
 
-    if (!nreceived_or_error.is_error() && nreceived_or_error.value() > 0 && !(flags & MSG_PEEK))
+    if (!nreceived_or_error.is_error() && nreceived_or_error.value() > 0 && !(flags & MSG_PEEK)) {
         Thread::current()->did_ipv4_socket_read(nreceived_or_error.value());
+        protocol_did_read_from_receive_buffer();
+    }
 
     set_can_read(!m_receive_buffer->is_empty());
     return nreceived_or_error;
@@ -818,4 +820,11 @@ void IPv4Socket::drop_receive_buffer()
     m_receive_buffer = nullptr;
 }
 
+size_t IPv4Socket::receive_buffer_space() const
+{
+    if (!m_receive_buffer)
+        return 0;
+    return m_receive_buffer->space_for_writing();
+}
+
 }
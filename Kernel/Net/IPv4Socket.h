@@ -86,6 +86,7 @@ protected:
     virtual ErrorOr<u16> protocol_allocate_local_port() { return ENOPROTOOPT; }
     virtual ErrorOr<size_t> protocol_size(ReadonlyBytes /* raw_ipv4_packet */) { return ENOTIMPL; }
     virtual bool protocol_is_disconnected() const { return false; }
+    virtual void protocol_did_read_from_receive_buffer() { }
 
     virtual void shut_down_for_reading() override;
 
@@ -94,6 +95,7 @@ protected:
 
     static ErrorOr<NonnullOwnPtr<DoubleBuffer>> try_create_receive_buffer();
     void drop_receive_buffer();
+    size_t receive_buffer_space() const;
 
 private:
     virtual bool is_ipv4() const override { return true; }
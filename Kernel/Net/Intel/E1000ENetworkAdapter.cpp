@@ -230,6 +230,8 @@ UNMAP_AFTER_INIT bool E1000ENetworkAdapter::initialize()
 
     setup_link();
     setup_interrupts();
+
+    set_offloads(Offload::TransmitTCPChecksum | Offload::TCPSegmentation, maximum_segmentation_data_descriptors * tx_buffer_size - sizeof(EthernetFrameHeader));
     return true;
 }
 
@@ -81,6 +81,27 @@ namespace Kernel {
 #define CMD_VLE (1 << 6)  // VLAN Packet Enable
 #define CMD_IDE (1 << 7)  // Interrupt Delay Enable
 
+// TCP/IP Context and Data Descriptors
+
+#define DTYP_CONTEXT (0x0 << 20)
+#define DTYP_DATA (0x1 << 20)
+#define TUCMD_TCP (1 << 24)  // Packet type is TCP
+#define TUCMD_IP (1 << 25)   // Packet type is IPv4
+#define TUCMD_TSE (1 << 26)  // TCP Segmentation Enable
+#define TUCMD_RS (1 << 27)   // Report Status
+#define TUCMD_DEXT (1 << 29) // Descriptor Extension
+#define DCMD_EOP (1 << 24)   // End of Packet
+#define DCMD_IFCS (1 << 25)  // Insert FCS
+#define DCMD_TSE (1 << 26)   // TCP Segmentation Enable
+#define DCMD_RS (1 << 27)    // Report Status
+#define DCMD_DEXT (1 << 29)  // Descriptor Extension
+#define POPTS_IXSM (1 << 0)  // Insert IP Checksum
+#define POPTS_TXSM (1 << 1)  // Insert TCP/UDP Checksum
+
+// Offsets of the checksum fields within the IPv4 and TCP headers.
+static constexpr size_t ipv4_checksum_offset = 10;
+static constexpr size_t tcp_checksum_offset = 16;
+
 // TCTL Register
 
 #define TCTL_EN (1 << 1)      // Transmit Enable
@@ -184,10 +205,17 @@ UNMAP_AFTER_INIT void E1000NetworkAdapter::setup_link()
     out32(REG_CTRL, flags | ECTRL_SLU);
 }
 
+// Receive interrupts are masked while NetworkTask is polling the receive ring.
+static constexpr u32 receive_interrupts = INTERRUPT_RXT0 | INTERRUPT_RXO;
+
+// The interrupt throttling register counts in units of 256 nanoseconds. 488 makes the
+// device wait at least ~125 microseconds between interrupts, i.e. at most ~8000 per second.
+static constexpr u32 interrupt_throttling_interval = 488;
+
 UNMAP_AFTER_INIT void E1000NetworkAdapter::setup_interrupts()
 {
-    out32(REG_INTERRUPT_RATE, 6000); // Interrupt rate of 1.536 milliseconds
-    out32(REG_INTERRUPT_MASK_SET, INTERRUPT_LSC | INTERRUPT_RXT0 | INTERRUPT_RXO);
+    out32(REG_INTERRUPT_RATE, interrupt_throttling_interval);
+    out32(REG_INTERRUPT_MASK_SET, INTERRUPT_LSC | INTERRUPT_TXDW | receive_interrupts);
     in32(REG_INTERRUPT_CAUSE_READ);
     enable_irq();
 }
@@ -224,6 +252,8 @@ UNMAP_AFTER_INIT bool E1000NetworkAdapter::initialize()
 
     m_link_up = ((in32(REG_STATUS) & STATUS_LU) != 0);
 
+    set_offloads(Offload::TransmitTCPChecksum | Offload::TCPSegmentation, maximum_segmentation_data_descriptors * tx_buffer_size - sizeof(EthernetFrameHeader));
+
     return true;
 }
 
@@ -261,8 +291,10 @@ bool E1000NetworkAdapter::handle_irq(const RegisterState&)
     if (status & INTERRUPT_RXO) {
         dbgln_if(E1000_DEBUG, "E1000: RX buffer overrun");
     }
-    if (status & INTERRUPT_RXT0) {
-        receive();
+    if (status & receive_interrupts) {
+        // Leave the receive ring to NetworkTask until it has drained it.
+        out32(REG_INTERRUPT_MASK_CLEAR, receive_interrupts);
+        schedule_receive_poll();
     }
 
     m_wait_queue.wake_all();
@@ -347,14 +379,14 @@ UNMAP_AFTER_INIT void E1000NetworkAdapter::initialize_tx_descriptors()
 {
     auto* tx_descriptors = (e1000_tx_desc*)m_tx_descriptors_region->vaddr().as_ptr();
 
-    constexpr auto tx_buffer_size = 8192;
     constexpr auto tx_buffer_page_count = tx_buffer_size / PAGE_SIZE;
     m_tx_buffer_region = MM.allocate_contiguous_kernel_region(tx_buffer_size * number_of_tx_descriptors, "E1000 TX buffers", Memory::Region::Access::ReadWrite).release_value();
 
     for (size_t i = 0; i < number_of_tx_descriptors; ++i) {
         auto& descriptor = tx_descriptors[i];
         m_tx_buffers[i] = m_tx_buffer_region->vaddr().as_ptr() + tx_buffer_size * i;
-        descriptor.addr = m_tx_buffer_region->physical_page(tx_buffer_page_count * i)->paddr().get();
+        m_tx_buffer_addresses[i] = m_tx_buffer_region->physical_page(tx_buffer_page_count * i)->paddr().get();
+        descriptor.addr = m_tx_buffer_addresses[i];
         descriptor.cmd = 0;
     }
 
@@ -427,48 +459,171 @@ u32 E1000NetworkAdapter::in32(u16 address)
 
 void E1000NetworkAdapter::send_raw(ReadonlyBytes payload)
 {
-    disable_irq();
-    size_t tx_current = in32(REG_TXDESCTAIL) % number_of_tx_descriptors;
-    dbgln_if(E1000_DEBUG, "E1000: Sending packet ({} bytes)", payload.size());
+    transmit(payload, {});
+}
+
+void E1000NetworkAdapter::send_raw_with_offload(ReadonlyBytes payload, TransmitOffload const& offload)
+{
+    transmit(payload, offload);
+}
+
+bool E1000NetworkAdapter::has_free_tx_descriptors(size_t count) const
+{
+    VERIFY(m_tx_lock.is_locked());
     auto* tx_descriptors = (e1000_tx_desc*)m_tx_descriptors_region->vaddr().as_ptr();
-    auto& descriptor = tx_descriptors[tx_current];
-    VERIFY(payload.size() <= 8192);
-    auto* vptr = (void*)m_tx_buffers[tx_current];
-    memcpy(vptr, payload.data(), payload.size());
+    for (size_t i = 0; i < count; ++i) {
+        auto& descriptor = tx_descriptors[(m_tx_tail + i) % number_of_tx_descriptors];
+        // A descriptor can be reused once the device reported that it's done with it.
+        if (descriptor.cmd != 0 && !(descriptor.status & TSTA_DD))
+            return false;
+    }
+    return true;
+}
+
+void E1000NetworkAdapter::transmit(ReadonlyBytes payload, TransmitOffload const& offload)
+{
+    dbgln_if(E1000_DEBUG, "E1000: Sending packet ({} bytes)", payload.size());
+
+    size_t descriptors_needed = 1;
+    if (offload.tcp_segment_size) {
+        descriptors_needed += ceil_div(payload.size(), tx_buffer_size);
+        VERIFY(descriptors_needed <= maximum_segmentation_data_descriptors + 1);
+    } else {
+        VERIFY(payload.size() <= tx_buffer_size);
+    }
+
+    for (;;) {
+        SpinlockLocker locker(m_tx_lock);
+        if (has_free_tx_descriptors(descriptors_needed)) {
+            if (offload.tcp_segment_size)
+                queue_tcp_segmentation(payload, offload);
+            else
+                queue_packet(payload, offload);
+
+            if (is_in_transmit_batch()) {
+                m_tx_tail_needs_flush = true;
+                return;
+            }
+            out32(REG_TXDESCTAIL, m_tx_tail);
+            m_tx_tail_needs_flush = false;
+            return;
+        }
+
+        // The ring is full; make sure the device knows about everything we've queued and wait for it.
+        if (m_tx_tail_needs_flush) {
+            out32(REG_TXDESCTAIL, m_tx_tail);
+            m_tx_tail_needs_flush = false;
+        }
+        locker.unlock();
+        m_wait_queue.wait_forever("E1000NetworkAdapter");
+    }
+}
+
+void E1000NetworkAdapter::queue_packet(ReadonlyBytes payload, TransmitOffload const& offload)
+{
+    auto& descriptor = ((e1000_tx_desc*)m_tx_descriptors_region->vaddr().as_ptr())[m_tx_tail];
+    memcpy(m_tx_buffers[m_tx_tail], payload.data(), payload.size());
+    descriptor.addr = m_tx_buffer_addresses[m_tx_tail];
     descriptor.length = payload.size();
     descriptor.status = 0;
     descriptor.cmd = CMD_EOP | CMD_IFCS | CMD_RS;
-    dbgln_if(E1000_DEBUG, "E1000: Using tx descriptor {} (head is at {})", tx_current, in32(REG_TXDESCHEAD));
-    tx_current = (tx_current + 1) % number_of_tx_descriptors;
-    cli();
-    enable_irq();
-    out32(REG_TXDESCTAIL, tx_current);
-    for (;;) {
-        if (descriptor.status) {
-            sti();
-            break;
+    descriptor.css = 0;
+    descriptor.cso = 0;
+    if (offload.tcp_checksum) {
+        // The legacy descriptor can insert a single checksum, computed from CSS to the end of the packet.
+        descriptor.css = ipv4_payload_offset();
+        descriptor.cso = ipv4_payload_offset() + tcp_checksum_offset;
+        descriptor.cmd = descriptor.cmd | CMD_IC;
+    }
+    dbgln_if(E1000_DEBUG, "E1000: Using tx descriptor {}", m_tx_tail);
+    m_tx_tail = (m_tx_tail + 1) % number_of_tx_descriptors;
+}
+
+void E1000NetworkAdapter::queue_tcp_segmentation(ReadonlyBytes payload, TransmitOffload const& offload)
+{
+    size_t ip_header_start = layer3_payload_offset();
+    size_t tcp_header_start = ipv4_payload_offset();
+    size_t tcp_header_size = (payload[tcp_header_start + 12] >> 4) * sizeof(u32);
+    size_t header_size = tcp_header_start + tcp_header_size;
+    VERIFY(payload.size() > header_size);
+
+    auto& context = ((e1000_tx_context_desc*)m_tx_descriptors_region->vaddr().as_ptr())[m_tx_tail];
+    context.ipcss = ip_header_start;
+    context.ipcso = ip_header_start + ipv4_checksum_offset;
+    context.ipcse = tcp_header_start - 1;
+    context.tucss = tcp_header_start;
+    context.tucso = tcp_header_start + tcp_checksum_offset;
+    context.tucse = 0;
+    context.paylen_dtyp_tucmd = (payload.size() - header_size) | DTYP_CONTEXT | TUCMD_TCP | TUCMD_IP | TUCMD_TSE | TUCMD_RS | TUCMD_DEXT;
+    context.status = 0;
+    context.hdrlen = header_size;
+    context.mss = offload.tcp_segment_size;
+    m_tx_tail = (m_tx_tail + 1) % number_of_tx_descriptors;
+
+    for (size_t offset = 0; offset < payload.size(); offset += tx_buffer_size) {
+        size_t length = min(tx_buffer_size, payload.size() - offset);
+        bool is_last = offset + length == payload.size();
+        auto& descriptor = ((e1000_tx_data_desc*)m_tx_descriptors_region->vaddr().as_ptr())[m_tx_tail];
+        memcpy(m_tx_buffers[m_tx_tail], payload.offset(offset), length);
+        if (offset == 0) {
+            // The device sums up the IPv4 header including its checksum field for every segment.
+            auto* ip_checksum = (u8*)m_tx_buffers[m_tx_tail] + ip_header_start + ipv4_checksum_offset;
+            ip_checksum[0] = 0;
+            ip_checksum[1] = 0;
         }
-        m_wait_queue.wait_forever("E1000NetworkAdapter");
+        descriptor.addr = m_tx_buffer_addresses[m_tx_tail];
+        descriptor.status = 0;
+        descriptor.popts = POPTS_IXSM | POPTS_TXSM;
+        descriptor.dtalen_dtyp_dcmd = length | DTYP_DATA | DCMD_IFCS | DCMD_TSE | DCMD_RS | DCMD_DEXT | (is_last ? DCMD_EOP : 0);
+        m_tx_tail = (m_tx_tail + 1) % number_of_tx_descriptors;
     }
-    dbgln_if(E1000_DEBUG, "E1000: Sent packet, status is now {:#02x}!", (u8)descriptor.status);
 }
 
-void E1000NetworkAdapter::receive()
+void E1000NetworkAdapter::flush_transmit_batch()
+{
+    SpinlockLocker locker(m_tx_lock);
+    if (!m_tx_tail_needs_flush)
+        return;
+    out32(REG_TXDESCTAIL, m_tx_tail);
+    m_tx_tail_needs_flush = false;
+}
+
+void E1000NetworkAdapter::poll_receive(size_t budget)
 {
     auto* rx_descriptors = (e1000_tx_desc*)m_rx_descriptors_region->vaddr().as_ptr();
-    u32 rx_current;
-    for (;;) {
-        rx_current = in32(REG_RXDESCTAIL) % number_of_rx_descriptors;
-        rx_current = (rx_current + 1) % number_of_rx_descriptors;
-        if (!(rx_descriptors[rx_current].status & 1))
-            break;
+    auto next_descriptor_is_ready = [&] {
+        return rx_descriptors[(m_rx_tail + 1) % number_of_rx_descriptors].status & 1;
+    };
+
+    size_t received = 0;
+    while (received < budget && next_descriptor_is_ready()) {
+        auto rx_current = (m_rx_tail + 1) % number_of_rx_descriptors;
         auto* buffer = m_rx_buffers[rx_current];
         u16 length = rx_descriptors[rx_current].length;
         VERIFY(length <= 8192);
         dbgln_if(E1000_DEBUG, "E1000: Received 1 packet @ {:p} ({} bytes)", buffer, length);
-        did_receive({ buffer, length });
+        queue_received_packet({ buffer, length });
         rx_descriptors[rx_current].status = 0;
-        out32(REG_RXDESCTAIL, rx_current);
+        m_rx_tail = rx_current;
+        ++received;
+    }
+
+    if (received > 0) {
+        // Hand all the descriptors we've consumed back to the device at once.
+        out32(REG_RXDESCTAIL, m_rx_tail);
+        did_receive_batch();
+    }
+
+    if (received == budget)
+        return;
+
+    complete_receive_poll();
+    out32(REG_INTERRUPT_MASK_SET, receive_interrupts);
+
+    // A packet may have arrived after we last looked, but before we unmasked the interrupts.
+    if (next_descriptor_is_ready()) {
+        out32(REG_INTERRUPT_MASK_CLEAR, receive_interrupts);
+        schedule_receive_poll();
     }
 }
 
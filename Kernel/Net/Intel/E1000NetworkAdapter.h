@@ -11,6 +11,7 @@
 #include <Kernel/Bus/PCI/Access.h>
 #include <Kernel/Bus/PCI/Device.h>
 #include <Kernel/Interrupts/IRQHandler.h>
+#include <Kernel/Locking/Spinlock.h>
 #include <Kernel/Net/NetworkAdapter.h>
 #include <Kernel/Random.h>
 
@@ -27,12 +28,15 @@ public:
     virtual ~E1000NetworkAdapter() override;
 
     virtual void send_raw(ReadonlyBytes) override;
+    virtual void send_raw_with_offload(ReadonlyBytes, TransmitOffload const&) override;
     virtual bool link_up() override { return m_link_up; };
     virtual i32 link_speed() override;
     virtual bool link_full_duplex() override;
 
     virtual StringView purpose() const override { return class_name(); }
 
+    virtual void poll_receive(size_t budget) override;
+
 protected:
     void setup_interrupts();
     void setup_link();
@@ -60,6 +64,29 @@ protected:
         volatile uint16_t special { 0 };
     };
 
+    // Section 3.5 of the 8254x manual. The status byte of all transmit descriptor
+    // types sits at the same offset as in the legacy descriptor.
+    struct [[gnu::packed]] e1000_tx_context_desc {
+        volatile uint8_t ipcss { 0 };
+        volatile uint8_t ipcso { 0 };
+        volatile uint16_t ipcse { 0 };
+        volatile uint8_t tucss { 0 };
+        volatile uint8_t tucso { 0 };
+        volatile uint16_t tucse { 0 };
+        volatile uint32_t paylen_dtyp_tucmd { 0 };
+        volatile uint8_t status { 0 };
+        volatile uint8_t hdrlen { 0 };
+        volatile uint16_t mss { 0 };
+    };
+
+    struct [[gnu::packed]] e1000_tx_data_desc {
+        volatile uint64_t addr { 0 };
+        volatile uint32_t dtalen_dtyp_dcmd { 0 };
+        volatile uint8_t status { 0 };
+        volatile uint8_t popts { 0 };
+        volatile uint16_t special { 0 };
+    };
+
     virtual void detect_eeprom();
     virtual u32 read_eeprom(u8 address);
     void read_mac_address();
@@ -77,10 +104,17 @@ protected:
     u16 in16(u16 address);
     u32 in32(u16 address);
 
-    void receive();
+    virtual void flush_transmit_batch() override;
+    void transmit(ReadonlyBytes, TransmitOffload const&);
+    void queue_packet(ReadonlyBytes, TransmitOffload const&);
+    void queue_tcp_segmentation(ReadonlyBytes, TransmitOffload const&);
+    bool has_free_tx_descriptors(size_t count) const;
 
     static constexpr size_t number_of_rx_descriptors = 32;
-    static constexpr size_t number_of_tx_descriptors = 8;
+    static constexpr size_t number_of_tx_descriptors = 32;
+    static constexpr size_t tx_buffer_size = 8192;
+    // A segmentation offload needs one context descriptor and up to this many data descriptors.
+    static constexpr size_t maximum_segmentation_data_descriptors = 5;
 
     IOAddress m_io_base;
     VirtualAddress m_mmio_base;
@@ -90,12 +124,19 @@ protected:
     OwnPtr<Memory::Region> m_tx_buffer_region;
     Array<void*, number_of_rx_descriptors> m_rx_buffers;
     Array<void*, number_of_tx_descriptors> m_tx_buffers;
+    Array<u64, number_of_tx_descriptors> m_tx_buffer_addresses;
     OwnPtr<Memory::Region> m_mmio_region;
     bool m_has_eeprom { false };
     bool m_use_mmio { false };
     bool m_link_up { false };
     EntropySource m_entropy_source;
 
+    // Our copies of the ring tails, so we don't have to read them back from the device.
+    size_t m_rx_tail { number_of_rx_descriptors - 1 };
+    Spinlock m_tx_lock;
+    size_t m_tx_tail { 0 };
+    bool m_tx_tail_needs_flush { false };
+
     WaitQueue m_wait_queue;
 };
 }
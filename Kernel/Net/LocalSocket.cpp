@@ -38,7 +38,9 @@ ErrorOr<NonnullRefPtr<LocalSocket>> LocalSocket::try_create(int type)
 {
     auto client_buffer = TRY(DoubleBuffer::try_create());
     auto server_buffer = TRY(DoubleBuffer::try_create());
-    return adopt_nonnull_ref_or_enomem(new (nothrow) LocalSocket(type, move(client_buffer), move(server_buffer)));
+    auto client_page_buffer = TRY(PageTransferBuffer::try_create());
+    auto server_page_buffer = TRY(PageTransferBuffer::try_create());
+    return adopt_nonnull_ref_or_enomem(new (nothrow) LocalSocket(type, move(client_buffer), move(server_buffer), move(client_page_buffer), move(server_page_buffer)));
 }
 
 ErrorOr<SocketPair> LocalSocket::try_create_connected_pair(int type)
@@ -58,10 +60,12 @@ ErrorOr<SocketPair> LocalSocket::try_create_connected_pair(int type)
     return SocketPair { move(description1), move(description2) };
 }
 
-LocalSocket::LocalSocket(int type, NonnullOwnPtr<DoubleBuffer> client_buffer, NonnullOwnPtr<DoubleBuffer> server_buffer)
+LocalSocket::LocalSocket(int type, NonnullOwnPtr<DoubleBuffer> client_buffer, NonnullOwnPtr<DoubleBuffer> server_buffer, NonnullOwnPtr<PageTransferBuffer> client_page_buffer, NonnullOwnPtr<PageTransferBuffer> server_page_buffer)
     : Socket(AF_LOCAL, type, 0)
     , m_for_client(move(client_buffer))
     , m_for_server(move(server_buffer))
+    , m_pages_for_client(move(client_page_buffer))
+    , m_pages_for_server(move(server_page_buffer))
 {
     auto& current_process = Process::current();
     m_prebind_uid = current_process.euid();
@@ -74,6 +78,12 @@ LocalSocket::LocalSocket(int type, NonnullOwnPtr<DoubleBuffer> client_buffer, No
     m_for_server->set_unblock_callback([this]() {
         evaluate_block_conditions();
     });
+    m_pages_for_client->set_unblock_callback([this]() {
+        evaluate_block_conditions();
+    });
+    m_pages_for_server->set_unblock_callback([this]() {
+        evaluate_block_conditions();
+    });
 
     all_sockets().with_exclusive([&](auto& list) {
         list.append(*this);
@@ -264,9 +274,9 @@ bool LocalSocket::can_read(const OpenFileDescription& description, size_t) const
     if (role == Role::Listener)
         return can_accept();
     if (role == Role::Accepted)
-        return !has_attached_peer(description) || !m_for_server->is_empty();
+        return !has_attached_peer(description) || !m_for_server->is_empty() || !m_pages_for_server->is_empty();
     if (role == Role::Connected)
-        return !has_attached_peer(description) || !m_for_client->is_empty();
+        return !has_attached_peer(description) || !m_for_client->is_empty() || !m_pages_for_client->is_empty();
     return false;
 }
 
@@ -283,10 +293,11 @@ bool LocalSocket::has_attached_peer(const OpenFileDescription& description) cons
 bool LocalSocket::can_write(const OpenFileDescription& description, size_t) const
 {
     auto role = this->role(description);
+    // Once something has been queued as pages, everything after it has to be queued there too.
     if (role == Role::Accepted)
-        return !has_attached_peer(description) || m_for_client->space_for_writing();
+        return !has_attached_peer(description) || (m_pages_for_client->is_empty() ? m_for_client->space_for_writing() : m_pages_for_client->space_for_writing());
     if (role == Role::Connected)
-        return !has_attached_peer(description) || m_for_server->space_for_writing();
+        return !has_attached_peer(description) || (m_pages_for_server->is_empty() ? m_for_server->space_for_writing() : m_pages_for_server->space_for_writing());
     return false;
 }
 
@@ -295,9 +306,13 @@ ErrorOr<size_t> LocalSocket::sendto(OpenFileDescription& description, const User
     if (!has_attached_peer(description))
         return set_so_error(EPIPE);
     auto* socket_buffer = send_buffer_for(description);
-    if (!socket_buffer)
+    auto* page_buffer = send_page_buffer_for(description);
+    if (!socket_buffer || !page_buffer)
         return set_so_error(EINVAL);
-    auto nwritten_or_error = socket_buffer->write(data, data_size);
+    // Keep the stream in order: once something has been queued as pages, everything after it has to be queued there too.
+    auto nwritten_or_error = (data_size >= page_transfer_threshold || !page_buffer->is_empty())
+        ? page_buffer->write(data, data_size)
+        : socket_buffer->write(data, data_size);
     if (!nwritten_or_error.is_error() && nwritten_or_error.value() > 0)
         Thread::current()->did_unix_socket_write(nwritten_or_error.value());
     return nwritten_or_error;
@@ -323,13 +338,35 @@ DoubleBuffer* LocalSocket::send_buffer_for(OpenFileDescription& description)
     return nullptr;
 }
 
+PageTransferBuffer* LocalSocket::receive_page_buffer_for(OpenFileDescription& description)
+{
+    auto role = this->role(description);
+    if (role == Role::Accepted)
+        return m_pages_for_server.ptr();
+    if (role == Role::Connected)
+        return m_pages_for_client.ptr();
+    return nullptr;
+}
+
+PageTransferBuffer* LocalSocket::send_page_buffer_for(OpenFileDescription& description)
+{
+    auto role = this->role(description);
+    if (role == Role::Connected)
+        return m_pages_for_server.ptr();
+    if (role == Role::Accepted)
+        return m_pages_for_client.ptr();
+    return nullptr;
+}
+
 ErrorOr<size_t> LocalSocket::recvfrom(OpenFileDescription& description, UserOrKernelBuffer& buffer, size_t buffer_size, int, Userspace<sockaddr*>, Userspace<socklen_t*>, Time&)
 {
     auto* socket_buffer = receive_buffer_for(description);
-    if (!socket_buffer)
+    auto* page_buffer = receive_page_buffer_for(description);
+    if (!socket_buffer || !page_buffer)
         return set_so_error(EINVAL);
+    auto is_empty = [&] { return socket_buffer->is_empty() && page_buffer->is_empty(); };
     if (!description.is_blocking()) {
-        if (socket_buffer->is_empty()) {
+        if (is_empty()) {
             if (!has_attached_peer(description))
                 return 0;
             return set_so_error(EAGAIN);
@@ -339,13 +376,24 @@ ErrorOr<size_t> LocalSocket::recvfrom(OpenFileDescription& description, UserOrKe
         if (Thread::current()->block<Thread::ReadBlocker>({}, description, unblock_flags).was_interrupted())
             return set_so_error(EINTR);
     }
-    if (!has_attached_peer(description) && socket_buffer->is_empty())
+    if (!has_attached_peer(description) && is_empty())
         return 0;
-    VERIFY(!socket_buffer->is_empty());
-    auto nread_or_error = socket_buffer->read(buffer, buffer_size);
-    if (!nread_or_error.is_error() && nread_or_error.value() > 0)
-        Thread::current()->did_unix_socket_read(nread_or_error.value());
-    return nread_or_error;
+    VERIFY(!is_empty());
+
+    size_t nread = 0;
+    if (!socket_buffer->is_empty())
+        nread = TRY(socket_buffer->read(buffer, buffer_size));
+    if (nread < buffer_size && socket_buffer->is_empty() && !page_buffer->is_empty()) {
+        auto remaining_buffer = buffer.offset(nread);
+        auto nread_from_pages_or_error = page_buffer->read(remaining_buffer, buffer_size - nread);
+        if (nread_from_pages_or_error.is_error() && nread == 0)
+            return nread_from_pages_or_error.release_error();
+        if (!nread_from_pages_or_error.is_error())
+            nread += nread_from_pages_or_error.value();
+    }
+    if (nread > 0)
+        Thread::current()->did_unix_socket_read(nread);
+    return nread;
 }
 
 StringView LocalSocket::socket_path() const
@@ -426,7 +474,7 @@ ErrorOr<void> LocalSocket::ioctl(OpenFileDescription& description, unsigned requ
 {
     switch (request) {
     case FIONREAD: {
-        int readable = receive_buffer_for(description)->immediately_readable();
+        int readable = receive_buffer_for(description)->immediately_readable() + receive_page_buffer_for(description)->immediately_readable();
         return copy_to_user(static_ptr_cast<int*>(arg), &readable);
     }
     }
@@ -9,6 +9,7 @@
 #include <AK/IntrusiveList.h>
 #include <Kernel/DoubleBuffer.h>
 #include <Kernel/Net/Socket.h>
+#include <Kernel/PageTransferBuffer.h>
 
 namespace Kernel {
 
@@ -52,12 +53,18 @@ public:
     virtual ErrorOr<void> chmod(OpenFileDescription&, mode_t) override;
 
 private:
-    explicit LocalSocket(int type, NonnullOwnPtr<DoubleBuffer> client_buffer, NonnullOwnPtr<DoubleBuffer> server_buffer);
+    // Writes of at least this size are queued as whole pages, so that a reader receiving
+    // into page-aligned memory gets the pages mapped in instead of copied.
+    static constexpr size_t page_transfer_threshold = 4 * PAGE_SIZE;
+
+    explicit LocalSocket(int type, NonnullOwnPtr<DoubleBuffer> client_buffer, NonnullOwnPtr<DoubleBuffer> server_buffer, NonnullOwnPtr<PageTransferBuffer> client_page_buffer, NonnullOwnPtr<PageTransferBuffer> server_page_buffer);
     virtual StringView class_name() const override { return "LocalSocket"sv; }
     virtual bool is_local() const override { return true; }
     bool has_attached_peer(const OpenFileDescription&) const;
     DoubleBuffer* receive_buffer_for(OpenFileDescription&);
     DoubleBuffer* send_buffer_for(OpenFileDescription&);
+    PageTransferBuffer* receive_page_buffer_for(OpenFileDescription&);
+    PageTransferBuffer* send_page_buffer_for(OpenFileDescription&);
     NonnullRefPtrVector<OpenFileDescription>& sendfd_queue_for(const OpenFileDescription&);
     NonnullRefPtrVector<OpenFileDescription>& recvfd_queue_for(const OpenFileDescription&);
 
@@ -99,6 +106,10 @@ private:
     NonnullOwnPtr<DoubleBuffer> m_for_client;
     NonnullOwnPtr<DoubleBuffer> m_for_server;
 
+    // Bytes in these always come after all bytes in the DoubleBuffer for the same direction.
+    NonnullOwnPtr<PageTransferBuffer> m_pages_for_client;
+    NonnullOwnPtr<PageTransferBuffer> m_pages_for_server;
+
     NonnullRefPtrVector<OpenFileDescription> m_fds_for_client;
     NonnullRefPtrVector<OpenFileDescription> m_fds_for_server;
 
@@ -9,6 +9,8 @@
 #include <Kernel/Net/EtherType.h>
 #include <Kernel/Net/NetworkAdapter.h>
 #include <Kernel/Net/NetworkingManagement.h>
+#include <Kernel/Net/TCP.h>
+#include <Kernel/Net/TCPSocket.h>
 #include <Kernel/Process.h>
 #include <Kernel/StdLib.h>
 
@@ -23,11 +25,75 @@ NetworkAdapter::~NetworkAdapter()
 {
 }
 
-void NetworkAdapter::send_packet(ReadonlyBytes packet)
+bool NetworkAdapter::supports(Offload offload) const
 {
+    return has_flag(m_offloads, offload);
+}
+
+void NetworkAdapter::send_packet(ReadonlyBytes packet, TransmitOffload const& offload)
+{
+    if (offload.is_empty()) {
+        m_packets_out++;
+        m_bytes_out += packet.size();
+        send_raw(packet);
+        return;
+    }
+
+    bool can_offload = (!offload.tcp_checksum || supports(Offload::TransmitTCPChecksum))
+        && (offload.tcp_segment_size == 0 || supports(Offload::TCPSegmentation));
+    if (!can_offload) {
+        // This can happen if a packet that was built for another adapter is retransmitted through us.
+        send_packet_with_software_offload(packet, offload);
+        return;
+    }
+
     m_packets_out++;
     m_bytes_out += packet.size();
-    send_raw(packet);
+    send_raw_with_offload(packet, offload);
+}
+
+void NetworkAdapter::send_packet_with_software_offload(ReadonlyBytes packet, TransmitOffload const& offload)
+{
+    auto const& tcp_packet = *(TCPPacket const*)(packet.data() + ipv4_payload_offset());
+    size_t header_size = ipv4_payload_offset() + tcp_packet.header_size();
+    VERIFY(packet.size() >= header_size);
+    size_t payload_size = packet.size() - header_size;
+    size_t segment_size = offload.tcp_segment_size ? offload.tcp_segment_size : payload_size;
+    u16 ident = ((IPv4Packet const*)(packet.data() + layer3_payload_offset()))->ident();
+
+    size_t offset = 0;
+    do {
+        size_t segment_payload_size = min(segment_size, payload_size - offset);
+        auto segment = acquire_packet_buffer(header_size + segment_payload_size);
+        if (!segment) {
+            // TCP will retransmit whatever we couldn't send.
+            dbgln("NetworkAdapter: Dropping TCP segment because we're out of memory");
+            return;
+        }
+        u8* segment_data = segment->buffer->data();
+        memcpy(segment_data, packet.data(), header_size);
+        memcpy(segment_data + header_size, packet.data() + header_size + offset, segment_payload_size);
+
+        auto& segment_ipv4 = *(IPv4Packet*)(segment_data + layer3_payload_offset());
+        segment_ipv4.set_length(header_size - layer3_payload_offset() + segment_payload_size);
+        segment_ipv4.set_ident(ident++);
+        segment_ipv4.set_checksum(0);
+        segment_ipv4.set_checksum(segment_ipv4.compute_checksum());
+
+        auto& segment_tcp = *(TCPPacket*)(segment_data + ipv4_payload_offset());
+        segment_tcp.set_sequence_number(tcp_packet.sequence_number() + offset);
+        if (offset + segment_payload_size < payload_size)
+            segment_tcp.set_flags(tcp_packet.flags() & ~(TCPFlags::FIN | TCPFlags::PUSH));
+        segment_tcp.set_checksum(0);
+        segment_tcp.set_checksum(TCPSocket::compute_tcp_checksum(segment_ipv4.source(), segment_ipv4.destination(), segment_tcp, segment_payload_size));
+
+        m_packets_out++;
+        m_bytes_out += segment->buffer->size();
+        send_raw(segment->bytes());
+        release_packet_buffer(*segment);
+
+        offset += segment_payload_size;
+    } while (offset < payload_size);
 }
 
 void NetworkAdapter::send(const MACAddress& destination, const ARPPacket& packet)
@@ -49,7 +115,8 @@ void NetworkAdapter::send(const MACAddress& destination, const ARPPacket& packet
 void NetworkAdapter::fill_in_ipv4_header(PacketWithTimestamp& packet, IPv4Address const& source_ipv4, MACAddress const& destination_mac, IPv4Address const& destination_ipv4, IPv4Protocol protocol, size_t payload_size, u8 type_of_service, u8 ttl)
 {
     size_t ipv4_packet_size = sizeof(IPv4Packet) + payload_size;
-    VERIFY(ipv4_packet_size <= mtu());
+    // Packets larger than the MTU get split into segments by the adapter.
+    VERIFY(ipv4_packet_size <= mtu() || ipv4_packet_size <= maximum_segmentation_size());
 
     size_t ethernet_frame_size = ipv4_payload_offset() + payload_size;
     VERIFY(packet.buffer->size() == ethernet_frame_size);
@@ -72,6 +139,25 @@ void NetworkAdapter::fill_in_ipv4_header(PacketWithTimestamp& packet, IPv4Addres
 }
 
 void NetworkAdapter::did_receive(ReadonlyBytes payload)
+{
+    queue_received_packet(payload);
+    did_receive_batch();
+}
+
+void NetworkAdapter::did_receive_batch()
+{
+    if (on_receive)
+        on_receive();
+}
+
+void NetworkAdapter::schedule_receive_poll()
+{
+    m_receive_poll_scheduled.store(true, AK::MemoryOrder::memory_order_release);
+    if (on_receive)
+        on_receive();
+}
+
+void NetworkAdapter::queue_received_packet(ReadonlyBytes payload)
 {
     InterruptDisabler disabler;
     m_packets_in++;
@@ -92,9 +178,6 @@ void NetworkAdapter::did_receive(ReadonlyBytes payload)
 
     m_packet_queue.append(*packet);
     m_packet_queue_size++;
-
-    if (on_receive)
-        on_receive();
 }
 
 size_t NetworkAdapter::dequeue_packet(u8* buffer, size_t buffer_size, Time& packet_timestamp)
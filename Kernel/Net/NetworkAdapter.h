@@ -6,7 +6,9 @@
 
 #pragma once
 
+#include <AK/Atomic.h>
 #include <AK/ByteBuffer.h>
+#include <AK/EnumBits.h>
 #include <AK/Function.h>
 #include <AK/IntrusiveList.h>
 #include <AK/MACAddress.h>
@@ -41,11 +43,32 @@ struct PacketWithTimestamp : public RefCounted<PacketWithTimestamp> {
     IntrusiveListNode<PacketWithTimestamp, RefPtr<PacketWithTimestamp>> packet_node;
 };
 
+// Work that the network stack left for the adapter to do on an outgoing packet.
+// The stack only asks for offloads that the adapter advertised in offloads().
+struct TransmitOffload {
+    // The TCP checksum field only holds the sum of the pseudo-header, and the adapter
+    // has to add the TCP header and payload to it. If the packet is to be segmented,
+    // the pseudo-header sum does not include the TCP length.
+    bool tcp_checksum { false };
+
+    // If non-zero, the TCP payload is larger than the MTU and the adapter has to split it
+    // into segments of this size, each with their own copy of the headers.
+    u16 tcp_segment_size { 0 };
+
+    bool is_empty() const { return !tcp_checksum && tcp_segment_size == 0; }
+};
+
 class NetworkAdapter : public RefCounted<NetworkAdapter>
     , public Weakable<NetworkAdapter> {
 public:
     static constexpr i32 LINKSPEED_INVALID = -1;
 
+    enum class Offload : u8 {
+        None = 0,
+        TransmitTCPChecksum = 1 << 0,
+        TCPSegmentation = 1 << 1,
+    };
+
     virtual ~NetworkAdapter();
 
     virtual StringView class_name() const = 0;
@@ -78,6 +101,11 @@ public:
     u32 mtu() const { return m_mtu; }
     void set_mtu(u32 mtu) { m_mtu = mtu; }
 
+    Offload offloads() const { return m_offloads; }
+    bool supports(Offload) const;
+    // The largest IPv4 packet we may hand to the adapter for TCP segmentation.
+    size_t maximum_segmentation_size() const { return m_maximum_segmentation_size; }
+
     u32 packets_in() const { return m_packets_in; }
     u32 bytes_in() const { return m_bytes_in; }
     u32 packets_out() const { return m_packets_out; }
@@ -91,15 +119,60 @@ public:
 
     Function<void()> on_receive;
 
-    void send_packet(ReadonlyBytes);
+    void send_packet(ReadonlyBytes, TransmitOffload const& = {});
+
+    // Instead of receiving every packet from their IRQ handler, drivers may mask their
+    // receive interrupts and ask NetworkTask to poll them until their receive ring runs
+    // dry. This keeps a busy adapter from interrupting the CPU for every single packet.
+    bool is_receive_poll_scheduled() const { return m_receive_poll_scheduled.load(AK::MemoryOrder::memory_order_acquire); }
+    virtual void poll_receive([[maybe_unused]] size_t budget) { }
+
+    // Keeps the driver from notifying the hardware about every packet we send, until the
+    // outermost batch on this adapter goes out of scope.
+    class TransmitBatch {
+    public:
+        explicit TransmitBatch(NetworkAdapter& adapter)
+            : m_adapter(adapter)
+        {
+            m_adapter.m_transmit_batch_depth.fetch_add(1, AK::MemoryOrder::memory_order_acq_rel);
+        }
+
+        ~TransmitBatch()
+        {
+            if (m_adapter.m_transmit_batch_depth.fetch_sub(1, AK::MemoryOrder::memory_order_acq_rel) == 1)
+                m_adapter.flush_transmit_batch();
+        }
+
+    private:
+        NetworkAdapter& m_adapter;
+    };
 
 protected:
     NetworkAdapter(NonnullOwnPtr<KString>);
     void set_mac_address(const MACAddress& mac_address) { m_mac_address = mac_address; }
     void did_receive(ReadonlyBytes);
     virtual void send_raw(ReadonlyBytes) = 0;
+    virtual void send_raw_with_offload(ReadonlyBytes, TransmitOffload const&) { VERIFY_NOT_REACHED(); }
+
+    void set_offloads(Offload offloads, size_t maximum_segmentation_size = 0)
+    {
+        m_offloads = offloads;
+        m_maximum_segmentation_size = maximum_segmentation_size;
+    }
+
+    // Queues a packet for NetworkTask without waking it up; call did_receive_batch() once done.
+    void queue_received_packet(ReadonlyBytes);
+    void did_receive_batch();
+
+    void schedule_receive_poll();
+    void complete_receive_poll() { m_receive_poll_scheduled.store(false, AK::MemoryOrder::memory_order_release); }
+
+    bool is_in_transmit_batch() const { return m_transmit_batch_depth.load(AK::MemoryOrder::memory_order_acquire) > 0; }
+    virtual void flush_transmit_batch() { }
 
 private:
+    void send_packet_with_software_offload(ReadonlyBytes, TransmitOffload const&);
+
     MACAddress m_mac_address;
     IPv4Address m_ipv4_address;
     IPv4Address m_ipv4_netmask;
@@ -119,6 +192,12 @@ private:
     u32 m_packets_out { 0 };
     u32 m_bytes_out { 0 };
     u32 m_mtu { 1500 };
+    Offload m_offloads { Offload::None };
+    size_t m_maximum_segmentation_size { 0 };
+    Atomic<bool> m_receive_poll_scheduled { false };
+    Atomic<u32> m_transmit_batch_depth { 0 };
 };
 
+AK_ENUM_BITWISE_OPERATORS(NetworkAdapter::Offload);
+
 }
@@ -60,7 +60,6 @@ void NetworkTask_main(void*)
     delayed_ack_sockets = new HashTable<RefPtr<TCPSocket>>;
 
     WaitQueue packet_wait_queue;
-    int pending_packets = 0;
     NetworkingManagement::the().for_each([&](auto& adapter) {
         dmesgln("NetworkTask: {} network adapter found: hw={}", adapter.class_name(), adapter.mac_address().to_string());
 
@@ -71,20 +70,26 @@ void NetworkTask_main(void*)
         }
 
         adapter.on_receive = [&]() {
-            pending_packets++;
             packet_wait_queue.wake_all();
         };
     });
 
-    auto dequeue_packet = [&pending_packets](u8* buffer, size_t buffer_size, Time& packet_timestamp) -> size_t {
-        if (pending_packets == 0)
-            return 0;
+    // How many packets an adapter may hand us per poll before we look at the other adapters.
+    constexpr size_t receive_poll_budget = 64;
+
+    auto poll_adapters = [] {
+        NetworkingManagement::the().for_each([&](auto& adapter) {
+            if (adapter.is_receive_poll_scheduled() && !adapter.has_queued_packets())
+                adapter.poll_receive(receive_poll_budget);
+        });
+    };
+
+    auto dequeue_packet = [](u8* buffer, size_t buffer_size, Time& packet_timestamp) -> size_t {
         size_t packet_size = 0;
         NetworkingManagement::the().for_each([&](auto& adapter) {
             if (packet_size || !adapter.has_queued_packets())
                 return;
             packet_size = adapter.dequeue_packet(buffer, buffer_size, packet_timestamp);
-            pending_packets--;
             dbgln_if(NETWORK_TASK_DEBUG, "NetworkTask: Dequeued packet from {} ({} bytes)", adapter.name(), packet_size);
         });
         return packet_size;
@@ -101,6 +106,7 @@ void NetworkTask_main(void*)
     for (;;) {
         flush_delayed_tcp_acks();
         retransmit_tcp_packets();
+        poll_adapters();
         size_t packet_size = dequeue_packet(buffer, buffer_size, packet_timestamp);
         if (!packet_size) {
             auto timeout_time = Time::from_milliseconds(500);
@@ -459,6 +465,7 @@ void handle_tcp(IPv4Packet const& ipv4_packet, Time const& packet_timestamp)
             dbgln_if(TCP_DEBUG, "handle_tcp: created new client socket with tuple {}", client->tuple().to_string());
             client->set_sequence_number(1000);
             client->set_ack_number(tcp_packet.sequence_number() + payload_size + 1);
+            client->receive_syn_options(tcp_packet);
             [[maybe_unused]] auto rc2 = client->send_tcp_packet(TCPFlags::SYN | TCPFlags::ACK);
             client->set_state(TCPSocket::State::SynReceived);
             return;
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Array.h>
+#include <AK/HashMap.h>
+#include <AK/Traits.h>
+#include <Kernel/Locking/MutexProtected.h>
+
+namespace Kernel {
+
+// A socket lookup table that is split into independently locked buckets, so that packets
+// for unrelated connections don't all serialize on a single lock. BucketTraits decides
+// which bucket a key lives in; keys that have to be looked up or updated together must
+// hash to the same bucket.
+template<typename Key, typename Value, typename BucketTraits = Traits<Key>, size_t bucket_count = 64>
+class SocketTable {
+    AK_MAKE_NONCOPYABLE(SocketTable);
+    AK_MAKE_NONMOVABLE(SocketTable);
+
+public:
+    using Bucket = HashMap<Key, Value>;
+
+    SocketTable() = default;
+
+    template<typename Callback>
+    decltype(auto) with_shared(Key const& key, Callback callback, LockLocation const& location = LockLocation::current()) const
+    {
+        return bucket_for(key).with_shared(move(callback), location);
+    }
+
+    template<typename Callback>
+    decltype(auto) with_exclusive(Key const& key, Callback callback, LockLocation const& location = LockLocation::current())
+    {
+        return bucket_for(key).with_exclusive(move(callback), location);
+    }
+
+    // Visits every entry, locking one bucket at a time.
+    template<typename Callback>
+    void for_each_shared(Callback callback, LockLocation const& location = LockLocation::current()) const
+    {
+        for (auto& bucket : m_buckets)
+            bucket.for_each_shared(callback, location);
+    }
+
+private:
+    static size_t bucket_index(Key const& key) { return BucketTraits::hash(key) % bucket_count; }
+
+    MutexProtected<Bucket>& bucket_for(Key const& key) { return m_buckets[bucket_index(key)]; }
+    MutexProtected<Bucket> const& bucket_for(Key const& key) const { return m_buckets[bucket_index(key)]; }
+
+    Array<MutexProtected<Bucket>, bucket_count> m_buckets;
+};
+
+}
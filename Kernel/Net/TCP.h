@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/Span.h>
 #include <AK/StdLibExtras.h>
 #include <Kernel/Net/IPv4.h>
 
@@ -22,6 +23,15 @@ struct TCPFlags {
     };
 };
 
+enum class TCPOptionKind : u8 {
+    End = 0x00,
+    NoOperation = 0x01,
+    MSS = 0x02,
+    WindowScale = 0x03,
+    SACKPermitted = 0x04,
+    SACK = 0x05,
+};
+
 class [[gnu::packed]] TCPOptionMSS {
 public:
     TCPOptionMSS(u16 value)
@@ -39,6 +49,42 @@ private:
 
 static_assert(AssertSize<TCPOptionMSS, 4>());
 
+// RFC 7323, section 2.2. Prefixed with a NOP to keep the options 32-bit aligned.
+class [[gnu::packed]] TCPOptionWindowScale {
+public:
+    TCPOptionWindowScale(u8 shift_count)
+        : m_shift_count(shift_count)
+    {
+    }
+
+    u8 shift_count() const { return m_shift_count; }
+
+private:
+    u8 m_padding { 0x01 };
+    u8 m_option_kind { 0x03 };
+    u8 m_option_length { 3 };
+    u8 m_shift_count { 0 };
+};
+
+static_assert(AssertSize<TCPOptionWindowScale, 4>());
+
+// RFC 2018, section 2. Prefixed with two NOPs to keep the options 32-bit aligned.
+class [[gnu::packed]] TCPOptionSACKPermitted {
+private:
+    u8 m_padding[2] { 0x01, 0x01 };
+    u8 m_option_kind { 0x04 };
+    u8 m_option_length { 2 };
+};
+
+static_assert(AssertSize<TCPOptionSACKPermitted, 4>());
+
+struct [[gnu::packed]] TCPSACKBlock {
+    NetworkOrdered<u32> left_edge;
+    NetworkOrdered<u32> right_edge;
+};
+
+static_assert(AssertSize<TCPSACKBlock, 8>());
+
 class [[gnu::packed]] TCPPacket {
 public:
     TCPPacket() = default;
@@ -81,6 +127,33 @@ public:
     const void* payload() const { return ((const u8*)this) + header_size(); }
     void* payload() { return ((u8*)this) + header_size(); }
 
+    // Calls the callback with the kind and the data (without kind and length bytes) of each option.
+    template<typename Callback>
+    void for_each_option(Callback callback) const
+    {
+        if (header_size() <= sizeof(TCPPacket))
+            return;
+        auto const* options = reinterpret_cast<u8 const*>(this) + sizeof(TCPPacket);
+        size_t options_size = header_size() - sizeof(TCPPacket);
+        size_t offset = 0;
+        while (offset < options_size) {
+            auto kind = static_cast<TCPOptionKind>(options[offset]);
+            if (kind == TCPOptionKind::End)
+                return;
+            if (kind == TCPOptionKind::NoOperation) {
+                ++offset;
+                continue;
+            }
+            if (offset + 1 >= options_size)
+                return;
+            size_t length = options[offset + 1];
+            if (length < 2 || offset + length > options_size)
+                return;
+            callback(kind, ReadonlyBytes { options + offset + 2, length - 2 });
+            offset += length;
+        }
+    }
+
 private:
     NetworkOrdered<u16> m_source_port;
     NetworkOrdered<u16> m_destination_port;
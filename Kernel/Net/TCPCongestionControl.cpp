@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/Net/TCPCongestionControl.h>
+
+namespace Kernel {
+
+ErrorOr<NonnullOwnPtr<TCPCongestionControl>> TCPCongestionControl::try_create(TCPCongestionAlgorithm algorithm, size_t mss)
+{
+    switch (algorithm) {
+    case TCPCongestionAlgorithm::NewReno:
+        return TRY(adopt_nonnull_own_or_enomem(new (nothrow) TCPNewRenoCongestionControl(mss)));
+    case TCPCongestionAlgorithm::Cubic:
+        return TRY(adopt_nonnull_own_or_enomem(new (nothrow) TCPCubicCongestionControl(mss)));
+    }
+    VERIFY_NOT_REACHED();
+}
+
+// RFC 6928: The initial window is min(10 * MSS, max(2 * MSS, 14600)).
+static size_t initial_window_for_mss(size_t mss)
+{
+    return min(10 * mss, max(2 * mss, 14600u));
+}
+
+TCPCongestionControl::TCPCongestionControl(size_t mss)
+    : m_mss(mss)
+    , m_congestion_window(initial_window_for_mss(mss))
+{
+}
+
+void TCPCongestionControl::set_mss(size_t mss)
+{
+    VERIFY(mss > 0);
+    // The MSS is only known for sure once the handshake has completed, so recompute
+    // the initial window if nothing has been acknowledged yet.
+    if (m_congestion_window == initial_window_for_mss(m_mss))
+        m_congestion_window = initial_window_for_mss(mss);
+    m_mss = mss;
+}
+
+void TCPCongestionControl::grow_in_slow_start(size_t bytes_acknowledged)
+{
+    m_congestion_window += min(bytes_acknowledged, m_mss);
+}
+
+void TCPCongestionControl::did_time_out(size_t bytes_in_flight, Time const&)
+{
+    m_slow_start_threshold = max(bytes_in_flight / 2, 2 * m_mss);
+    m_congestion_window = m_mss;
+}
+
+void TCPNewRenoCongestionControl::did_acknowledge(size_t bytes_acknowledged, Time const&, Time const&)
+{
+    if (is_in_slow_start()) {
+        grow_in_slow_start(bytes_acknowledged);
+        return;
+    }
+
+    // Congestion avoidance: grow by one MSS per window's worth of acknowledged data.
+    m_bytes_acknowledged_in_congestion_avoidance += bytes_acknowledged;
+    if (m_bytes_acknowledged_in_congestion_avoidance >= m_congestion_window) {
+        m_bytes_acknowledged_in_congestion_avoidance -= m_congestion_window;
+        m_congestion_window += m_mss;
+    }
+}
+
+void TCPNewRenoCongestionControl::did_enter_fast_recovery(size_t bytes_in_flight, Time const&)
+{
+    m_slow_start_threshold = max(bytes_in_flight / 2, 2 * m_mss);
+    m_congestion_window = m_slow_start_threshold + 3 * m_mss;
+    m_bytes_acknowledged_in_congestion_avoidance = 0;
+}
+
+// CUBIC uses C = 0.4 and beta = 0.7; we keep them as fractions because the kernel does not use floating point.
+static constexpr u64 cubic_c_numerator = 4;
+static constexpr u64 cubic_c_denominator = 10;
+static constexpr u64 cubic_beta_numerator = 7;
+static constexpr u64 cubic_beta_denominator = 10;
+
+// Keeps d^3 * C * MSS comfortably within 64 bits.
+static constexpr i64 cubic_maximum_time_offset_ms = 60'000;
+
+static u64 integer_cube_root(u64 value)
+{
+    u64 low = 0;
+    u64 high = 1u << 21;
+    while (low < high) {
+        u64 middle = (low + high + 1) / 2;
+        if (middle * middle * middle <= value)
+            low = middle;
+        else
+            high = middle - 1;
+    }
+    return low;
+}
+
+void TCPCubicCongestionControl::reduce_window(size_t bytes_in_flight, Time const&)
+{
+    // Fast convergence (RFC 8312, section 4.6): if we didn't even get back to the last maximum,
+    // release some bandwidth for newer flows.
+    if (m_congestion_window < m_maximum_window)
+        m_maximum_window = m_congestion_window * (cubic_beta_denominator + cubic_beta_numerator) / (2 * cubic_beta_denominator);
+    else
+        m_maximum_window = m_congestion_window;
+
+    auto reduced_window = max(m_congestion_window, bytes_in_flight) * cubic_beta_numerator / cubic_beta_denominator;
+    m_slow_start_threshold = max(reduced_window, 2 * m_mss);
+    m_has_epoch = false;
+}
+
+void TCPCubicCongestionControl::did_enter_fast_recovery(size_t bytes_in_flight, Time const& now)
+{
+    reduce_window(bytes_in_flight, now);
+    m_congestion_window = m_slow_start_threshold + 3 * m_mss;
+}
+
+void TCPCubicCongestionControl::did_time_out(size_t bytes_in_flight, Time const& now)
+{
+    reduce_window(bytes_in_flight, now);
+    m_congestion_window = m_mss;
+}
+
+size_t TCPCubicCongestionControl::cubic_window_at(Time const& now) const
+{
+    // W_cubic(t) = C * (t - K)^3 + W_max, with t and K in seconds and the window in segments.
+    i64 offset_ms = (now - m_epoch_start).to_milliseconds() - static_cast<i64>(m_time_to_maximum_window_ms);
+    offset_ms = clamp(offset_ms, -cubic_maximum_time_offset_ms, cubic_maximum_time_offset_ms);
+    i64 scaled_mss = static_cast<i64>(m_mss * cubic_c_numerator / cubic_c_denominator);
+    i64 delta = scaled_mss * offset_ms * offset_ms * offset_ms / 1'000'000'000;
+    i64 window = static_cast<i64>(m_maximum_window) + delta;
+    return static_cast<size_t>(max(window, static_cast<i64>(2 * m_mss)));
+}
+
+size_t TCPCubicCongestionControl::tcp_friendly_window_at(Time const& now, Time const& smoothed_rtt) const
+{
+    // W_est(t) = W_max * beta + 3 * (1 - beta) / (1 + beta) * t / RTT, which is 9/17 for beta = 0.7.
+    u64 elapsed_ms = static_cast<u64>(max<i64>((now - m_epoch_start).to_milliseconds(), 0));
+    u64 rtt_ms = static_cast<u64>(max<i64>(smoothed_rtt.to_milliseconds(), 1));
+    return m_maximum_window * cubic_beta_numerator / cubic_beta_denominator + m_mss * 9 * elapsed_ms / (17 * rtt_ms);
+}
+
+void TCPCubicCongestionControl::did_acknowledge(size_t bytes_acknowledged, Time const& smoothed_rtt, Time const& now)
+{
+    if (is_in_slow_start()) {
+        grow_in_slow_start(bytes_acknowledged);
+        return;
+    }
+
+    if (!m_has_epoch) {
+        m_has_epoch = true;
+        m_epoch_start = now;
+        if (m_congestion_window < m_maximum_window) {
+            // K = cbrt((W_max - cwnd) / C), in milliseconds.
+            u64 missing_millisegments = static_cast<u64>(m_maximum_window - m_congestion_window) * 1000 / m_mss;
+            m_time_to_maximum_window_ms = integer_cube_root(missing_millisegments * cubic_c_denominator / cubic_c_numerator * 1'000'000);
+        } else {
+            m_time_to_maximum_window_ms = 0;
+            m_maximum_window = m_congestion_window;
+        }
+    }
+
+    size_t target = max(cubic_window_at(now), tcp_friendly_window_at(now, smoothed_rtt));
+    // Never more than 1.5x the current window per RTT (RFC 8312, section 4.1).
+    target = min(target, m_congestion_window + m_congestion_window / 2);
+
+    if (target > m_congestion_window)
+        m_congestion_window += max<size_t>((target - m_congestion_window) * bytes_acknowledged / m_congestion_window, 1);
+    else
+        m_congestion_window += m_mss * bytes_acknowledged / (100 * m_congestion_window);
+}
+
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Error.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/StringView.h>
+#include <AK/Time.h>
+#include <AK/Types.h>
+#include <Kernel/CommandLine.h>
+
+namespace Kernel {
+
+// Decides how many bytes a TCPSocket may have in flight. The socket itself takes
+// care of detecting loss (duplicate ACKs, SACK holes and retransmit timeouts) and
+// tells the congestion controller about it; the controller only maintains the
+// congestion window and the slow start threshold.
+class TCPCongestionControl {
+public:
+    static ErrorOr<NonnullOwnPtr<TCPCongestionControl>> try_create(TCPCongestionAlgorithm, size_t mss);
+    virtual ~TCPCongestionControl() = default;
+
+    virtual StringView name() const = 0;
+
+    size_t congestion_window() const { return m_congestion_window; }
+    size_t slow_start_threshold() const { return m_slow_start_threshold; }
+    bool is_in_slow_start() const { return m_congestion_window < m_slow_start_threshold; }
+
+    void set_mss(size_t mss);
+
+    // New data was cumulatively acknowledged while not recovering from a loss.
+    virtual void did_acknowledge(size_t bytes_acknowledged, Time const& smoothed_rtt, Time const& now) = 0;
+
+    // Loss was detected through duplicate ACKs and we are entering fast recovery.
+    virtual void did_enter_fast_recovery(size_t bytes_in_flight, Time const& now) = 0;
+
+    // Each further duplicate ACK during fast recovery means another segment has left the network.
+    void did_receive_duplicate_ack_during_recovery() { m_congestion_window += m_mss; }
+
+    // Everything that was outstanding when the loss was detected has been acknowledged.
+    void did_exit_fast_recovery() { m_congestion_window = m_slow_start_threshold; }
+
+    // The retransmission timer expired (RFC 5681, section 3.1).
+    virtual void did_time_out(size_t bytes_in_flight, Time const& now);
+
+protected:
+    explicit TCPCongestionControl(size_t mss);
+
+    // RFC 5681, section 3.1: slow start increases the window by at most one MSS per ACK.
+    void grow_in_slow_start(size_t bytes_acknowledged);
+
+    size_t m_mss { 0 };
+    size_t m_congestion_window { 0 };
+    size_t m_slow_start_threshold { NumericLimits<size_t>::max() };
+};
+
+// RFC 5681 and RFC 6582.
+class TCPNewRenoCongestionControl final : public TCPCongestionControl {
+public:
+    explicit TCPNewRenoCongestionControl(size_t mss)
+        : TCPCongestionControl(mss)
+    {
+    }
+
+    virtual StringView name() const override { return "newreno"sv; }
+    virtual void did_acknowledge(size_t bytes_acknowledged, Time const& smoothed_rtt, Time const& now) override;
+    virtual void did_enter_fast_recovery(size_t bytes_in_flight, Time const& now) override;
+
+private:
+    size_t m_bytes_acknowledged_in_congestion_avoidance { 0 };
+};
+
+// RFC 8312.
+class TCPCubicCongestionControl final : public TCPCongestionControl {
+public:
+    explicit TCPCubicCongestionControl(size_t mss)
+        : TCPCongestionControl(mss)
+    {
+    }
+
+    virtual StringView name() const override { return "cubic"sv; }
+    virtual void did_acknowledge(size_t bytes_acknowledged, Time const& smoothed_rtt, Time const& now) override;
+    virtual void did_enter_fast_recovery(size_t bytes_in_flight, Time const& now) override;
+    virtual void did_time_out(size_t bytes_in_flight, Time const& now) override;
+
+private:
+    void reduce_window(size_t bytes_in_flight, Time const& now);
+    size_t cubic_window_at(Time const& now) const;
+    size_t tcp_friendly_window_at(Time const& now, Time const& smoothed_rtt) const;
+
+    // Window size just before the last reduction.
+    size_t m_maximum_window { 0 };
+    // Time it takes to grow the window back to m_maximum_window, in milliseconds.
+    u64 m_time_to_maximum_window_ms { 0 };
+    Time m_epoch_start;
+    bool m_has_epoch { false };
+};
+
+}
@@ -6,6 +6,7 @@
 
 #include <AK/Singleton.h>
 #include <AK/Time.h>
+#include <Kernel/CommandLine.h>
 #include <Kernel/Debug.h>
 #include <Kernel/Devices/RandomDevice.h>
 #include <Kernel/FileSystem/OpenFileDescription.h>
@@ -22,6 +23,12 @@
 
 namespace Kernel {
 
+// Sequence numbers wrap around, so they have to be compared in modular arithmetic (RFC 793, section 3.3).
+static bool sequence_number_is_before_or_equal(u32 a, u32 b)
+{
+    return static_cast<i32>(a - b) <= 0;
+}
+
 void TCPSocket::for_each(Function<void(const TCPSocket&)> callback)
 {
     sockets_by_tuple().for_each_shared([&](const auto& it) {
@@ -31,7 +38,7 @@ void TCPSocket::for_each(Function<void(const TCPSocket&)> callback)
 
 bool TCPSocket::unref() const
 {
-    bool did_hit_zero = sockets_by_tuple().with_exclusive([&](auto& table) {
+    bool did_hit_zero = sockets_by_tuple().with_exclusive(tuple(), [&](auto& table) {
         if (deref_base())
             return false;
         table.remove(tuple());
@@ -67,7 +74,7 @@ void TCPSocket::set_state(State new_state)
     }
 
     if (new_state == State::Closed) {
-        closing_sockets().with_exclusive([&](auto& table) {
+        closing_sockets().with_exclusive(tuple(), [&](auto& table) {
             table.remove(tuple());
         });
 
@@ -79,34 +86,40 @@ void TCPSocket::set_state(State new_state)
         evaluate_block_conditions();
 }
 
-static Singleton<MutexProtected<HashMap<IPv4SocketTuple, RefPtr<TCPSocket>>>> s_socket_closing;
+static Singleton<TCPSocket::ClosingSockets> s_socket_closing;
 
-MutexProtected<HashMap<IPv4SocketTuple, RefPtr<TCPSocket>>>& TCPSocket::closing_sockets()
+TCPSocket::ClosingSockets& TCPSocket::closing_sockets()
 {
     return *s_socket_closing;
 }
 
-static Singleton<MutexProtected<HashMap<IPv4SocketTuple, TCPSocket*>>> s_socket_tuples;
+static Singleton<TCPSocket::SocketsByTuple> s_socket_tuples;
 
-MutexProtected<HashMap<IPv4SocketTuple, TCPSocket*>>& TCPSocket::sockets_by_tuple()
+TCPSocket::SocketsByTuple& TCPSocket::sockets_by_tuple()
 {
     return *s_socket_tuples;
 }
 
 RefPtr<TCPSocket> TCPSocket::from_tuple(const IPv4SocketTuple& tuple)
 {
-    return sockets_by_tuple().with_shared([&](const auto& table) -> RefPtr<TCPSocket> {
-        auto exact_match = table.get(tuple);
-        if (exact_match.has_value())
-            return { *exact_match.value() };
+    auto exact_match = sockets_by_tuple().with_shared(tuple, [&](const auto& table) -> RefPtr<TCPSocket> {
+        auto match = table.get(tuple);
+        if (match.has_value())
+            return { *match.value() };
+        return {};
+    });
+    if (exact_match)
+        return exact_match;
 
+    // Listening sockets for a port all share a bucket, see TupleBucketTraits.
+    auto listener_tuple = IPv4SocketTuple(IPv4Address(), tuple.local_port(), IPv4Address(), 0);
+    return sockets_by_tuple().with_shared(listener_tuple, [&](const auto& table) -> RefPtr<TCPSocket> {
         auto address_tuple = IPv4SocketTuple(tuple.local_address(), tuple.local_port(), IPv4Address(), 0);
         auto address_match = table.get(address_tuple);
         if (address_match.has_value())
             return { *address_match.value() };
 
-        auto wildcard_tuple = IPv4SocketTuple(IPv4Address(), tuple.local_port(), IPv4Address(), 0);
-        auto wildcard_match = table.get(wildcard_tuple);
+        auto wildcard_match = table.get(listener_tuple);
         if (wildcard_match.has_value())
             return { *wildcard_match.value() };
 
@@ -116,7 +129,7 @@ RefPtr<TCPSocket> TCPSocket::from_tuple(const IPv4SocketTuple& tuple)
 ErrorOr<NonnullRefPtr<TCPSocket>> TCPSocket::try_create_client(const IPv4Address& new_local_address, u16 new_local_port, const IPv4Address& new_peer_address, u16 new_peer_port)
 {
     auto tuple = IPv4SocketTuple(new_local_address, new_local_port, new_peer_address, new_peer_port);
-    return sockets_by_tuple().with_exclusive([&](auto& table) -> ErrorOr<NonnullRefPtr<TCPSocket>> {
+    return sockets_by_tuple().with_exclusive(tuple, [&](auto& table) -> ErrorOr<NonnullRefPtr<TCPSocket>> {
         if (table.contains(tuple))
             return EEXIST;
 
@@ -153,8 +166,9 @@ void TCPSocket::release_for_accept(RefPtr<TCPSocket> socket)
     [[maybe_unused]] auto rc = queue_connection_from(*socket);
 }
 
-TCPSocket::TCPSocket(int protocol, NonnullOwnPtr<DoubleBuffer> receive_buffer, NonnullOwnPtr<KBuffer> scratch_buffer)
+TCPSocket::TCPSocket(int protocol, NonnullOwnPtr<DoubleBuffer> receive_buffer, NonnullOwnPtr<KBuffer> scratch_buffer, NonnullOwnPtr<TCPCongestionControl> congestion_control)
     : IPv4Socket(SOCK_STREAM, protocol, move(receive_buffer), move(scratch_buffer))
+    , m_congestion_control(move(congestion_control))
 {
     m_last_retransmit_time = kgettimeofday();
 }
@@ -170,7 +184,8 @@ ErrorOr<NonnullRefPtr<TCPSocket>> TCPSocket::try_create(int protocol, NonnullOwn
 {
     // Note: Scratch buffer is only used for SOCK_STREAM sockets.
     auto scratch_buffer = TRY(KBuffer::try_create_with_size(65536));
-    return adopt_nonnull_ref_or_enomem(new (nothrow) TCPSocket(protocol, move(receive_buffer), move(scratch_buffer)));
+    auto congestion_control = TRY(TCPCongestionControl::try_create(kernel_command_line().tcp_congestion_algorithm(), default_mss));
+    return adopt_nonnull_ref_or_enomem(new (nothrow) TCPSocket(protocol, move(receive_buffer), move(scratch_buffer), move(congestion_control)));
 }
 
 ErrorOr<size_t> TCPSocket::protocol_size(ReadonlyBytes raw_ipv4_packet)
@@ -196,8 +211,18 @@ ErrorOr<size_t> TCPSocket::protocol_send(const UserOrKernelBuffer& data, size_t
     RoutingDecision routing_decision = route_to(peer_address(), local_address(), bound_interface());
     if (routing_decision.is_zero())
         return set_so_error(EHOSTUNREACH);
-    size_t mss = routing_decision.adapter->mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket);
-    data_length = min(data_length, mss);
+    size_t mss = min<size_t>(routing_decision.adapter->mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket), m_peer_mss);
+    size_t maximum_payload_size = mss;
+    auto& adapter = *routing_decision.adapter;
+    if (adapter.supports(NetworkAdapter::Offload::TCPSegmentation)) {
+        // Hand the adapter as many whole segments as our windows allow, and let it do the cutting.
+        size_t bytes_in_flight = m_unacked_packets.with_shared([](auto& unacked_packets) { return unacked_packets.size; });
+        size_t window = effective_send_window();
+        size_t available_window = window > bytes_in_flight ? window - bytes_in_flight : 0;
+        size_t segmentation_payload_size = min(adapter.maximum_segmentation_size() - sizeof(IPv4Packet) - sizeof(TCPPacket), available_window);
+        maximum_payload_size = max(mss, segmentation_payload_size / mss * mss);
+    }
+    data_length = min(data_length, maximum_payload_size);
     TRY(send_tcp_packet(TCPFlags::PUSH | TCPFlags::ACK, &data, data_length, &routing_decision));
     return data_length;
 }
@@ -217,8 +242,19 @@ ErrorOr<void> TCPSocket::send_tcp_packet(u16 flags, const UserOrKernelBuffer* pa
 
     auto ipv4_payload_offset = routing_decision.adapter->ipv4_payload_offset();
 
-    const bool has_mss_option = flags == TCPFlags::SYN;
-    const size_t options_size = has_mss_option ? sizeof(TCPOptionMSS) : 0;
+    const bool is_syn = flags & TCPFlags::SYN;
+    // A SYN-ACK may only carry the window scale and SACK-permitted options if the peer's SYN did.
+    const bool is_syn_ack = is_syn && (flags & TCPFlags::ACK);
+    const bool has_mss_option = is_syn;
+    const bool has_window_scale_option = is_syn && (!is_syn_ack || m_window_scaling_enabled);
+    const bool has_sack_permitted_option = is_syn && (!is_syn_ack || m_sack_permitted);
+    size_t options_size = 0;
+    if (has_mss_option)
+        options_size += sizeof(TCPOptionMSS);
+    if (has_window_scale_option)
+        options_size += sizeof(TCPOptionWindowScale);
+    if (has_sack_permitted_option)
+        options_size += sizeof(TCPOptionSACKPermitted);
     const size_t tcp_header_size = sizeof(TCPPacket) + options_size;
     const size_t buffer_size = ipv4_payload_offset + tcp_header_size + payload_size;
     auto packet = routing_decision.adapter->acquire_packet_buffer(buffer_size);
@@ -232,7 +268,8 @@ ErrorOr<void> TCPSocket::send_tcp_packet(u16 flags, const UserOrKernelBuffer* pa
     VERIFY(local_port());
     tcp_packet.set_source_port(local_port());
     tcp_packet.set_destination_port(peer_port());
-    tcp_packet.set_window_size(NumericLimits<u16>::max());
+    m_last_advertised_window_size = advertised_window_size(is_syn);
+    tcp_packet.set_window_size(m_last_advertised_window_size);
     tcp_packet.set_sequence_number(m_sequence_number);
     tcp_packet.set_data_offset(tcp_header_size / sizeof(u32));
     tcp_packet.set_flags(flags);
@@ -250,28 +287,60 @@ ErrorOr<void> TCPSocket::send_tcp_packet(u16 flags, const UserOrKernelBuffer* pa
         }
     }
 
+    auto first_sequence_number = m_sequence_number;
     if (flags & TCPFlags::SYN) {
         ++m_sequence_number;
     } else {
         m_sequence_number += payload_size;
     }
 
+    auto* options = packet->buffer->data() + ipv4_payload_offset + sizeof(TCPPacket);
+    VERIFY(packet->buffer->size() >= ipv4_payload_offset + sizeof(TCPPacket) + options_size);
     if (has_mss_option) {
         u16 mss = routing_decision.adapter->mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket);
         TCPOptionMSS mss_option { mss };
-        VERIFY(packet->buffer->size() >= ipv4_payload_offset + sizeof(TCPPacket) + sizeof(mss_option));
-        memcpy(packet->buffer->data() + ipv4_payload_offset + sizeof(TCPPacket), &mss_option, sizeof(mss_option));
+        memcpy(options, &mss_option, sizeof(mss_option));
+        options += sizeof(mss_option);
+    }
+    if (has_window_scale_option) {
+        TCPOptionWindowScale window_scale_option { receive_window_scale_shift };
+        memcpy(options, &window_scale_option, sizeof(window_scale_option));
+        options += sizeof(window_scale_option);
+    }
+    if (has_sack_permitted_option) {
+        TCPOptionSACKPermitted sack_permitted_option;
+        memcpy(options, &sack_permitted_option, sizeof(sack_permitted_option));
+        options += sizeof(sack_permitted_option);
     }
 
-    tcp_packet.set_checksum(compute_tcp_checksum(local_address(), peer_address(), tcp_packet, payload_size));
+    TransmitOffload offload;
+    size_t segment_size = min<size_t>(routing_decision.adapter->mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket), m_peer_mss);
+    if (payload_size > segment_size) {
+        VERIFY(routing_decision.adapter->supports(NetworkAdapter::Offload::TCPSegmentation));
+        offload.tcp_segment_size = segment_size;
+        offload.tcp_checksum = true;
+    } else if (routing_decision.adapter->supports(NetworkAdapter::Offload::TransmitTCPChecksum)) {
+        offload.tcp_checksum = true;
+    }
+
+    if (offload.tcp_checksum) {
+        u16 tcp_length = offload.tcp_segment_size ? 0 : tcp_packet.header_size() + payload_size;
+        tcp_packet.set_checksum(compute_tcp_pseudo_header_sum(local_address(), peer_address(), tcp_length));
+    } else {
+        tcp_packet.set_checksum(compute_tcp_checksum(local_address(), peer_address(), tcp_packet, payload_size));
+    }
 
-    routing_decision.adapter->send_packet(packet->bytes());
+    routing_decision.adapter->send_packet(packet->bytes(), offload);
 
     m_packets_out++;
     m_bytes_out += buffer_size;
     if (tcp_packet.has_syn() || payload_size > 0) {
         m_unacked_packets.with_exclusive([&](auto& unacked_packets) {
-            unacked_packets.packets.append({ m_sequence_number, move(packet), ipv4_payload_offset, *routing_decision.adapter });
+            auto now = kgettimeofday();
+            // RFC 6298, section 5.1: Start the retransmission timer if it isn't already running.
+            if (unacked_packets.packets.is_empty())
+                m_last_retransmit_time = now;
+            unacked_packets.packets.append({ m_sequence_number, move(packet), ipv4_payload_offset, *routing_decision.adapter, 0, first_sequence_number, payload_size, now, false, offload });
             unacked_packets.size += payload_size;
             enqueue_for_retransmit();
         });
@@ -284,25 +353,43 @@ ErrorOr<void> TCPSocket::send_tcp_packet(u16 flags, const UserOrKernelBuffer* pa
 
 void TCPSocket::receive_tcp_packet(const TCPPacket& packet, u16 size)
 {
+    if (packet.has_syn() && m_state != State::Listen)
+        receive_syn_options(packet);
+
     if (packet.has_ack()) {
         u32 ack_number = packet.ack_number();
+        auto now = kgettimeofday();
+
+        // The window field of a SYN segment is never scaled (RFC 7323, section 2.2).
+        auto previous_send_window_size = m_send_window_size;
+        if (packet.has_syn())
+            m_send_window_size = packet.window_size();
+        else
+            m_send_window_size = static_cast<u32>(packet.window_size()) << m_send_window_scale_shift;
 
         dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: receive_tcp_packet: {}", ack_number);
 
         int removed = 0;
         m_unacked_packets.with_exclusive([&](auto& unacked_packets) {
+            if (m_sack_permitted)
+                mark_sacked_packets(unacked_packets, packet);
+
+            size_t bytes_acknowledged = 0;
+            Optional<Time> rtt_sample;
             while (!unacked_packets.packets.is_empty()) {
                 auto& packet = unacked_packets.packets.first();
 
                 dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: iterate: {}", packet.ack_number);
 
-                if (packet.ack_number <= ack_number) {
+                if (sequence_number_is_before_or_equal(packet.ack_number, ack_number)) {
                     auto old_adapter = packet.adapter.strong_ref();
                     if (old_adapter)
                         old_adapter->release_packet_buffer(*packet.buffer);
-                    TCPPacket& tcp_packet = *(TCPPacket*)(packet.buffer->buffer->data() + packet.ipv4_payload_offset);
-                    auto payload_size = packet.buffer->buffer->data() + packet.buffer->buffer->size() - (u8*)tcp_packet.payload();
-                    unacked_packets.size -= payload_size;
+                    unacked_packets.size -= packet.payload_size;
+                    bytes_acknowledged += packet.payload_size;
+                    // Karn's algorithm: segments that were retransmitted don't give us a usable RTT sample.
+                    if (packet.tx_counter == 0)
+                        rtt_sample = now - packet.first_sent_time;
                     evaluate_block_conditions();
                     unacked_packets.packets.take_first();
                     removed++;
@@ -311,6 +398,49 @@ void TCPSocket::receive_tcp_packet(const TCPPacket& packet, u16 size)
                 }
             }
 
+            if (rtt_sample.has_value())
+                update_rtt_estimate(rtt_sample.value());
+
+            size_t payload_size = size - packet.header_size();
+            bool is_duplicate_ack = removed == 0
+                && !unacked_packets.packets.is_empty()
+                && ack_number == m_last_received_ack_number
+                && payload_size == 0
+                && !packet.has_syn() && !packet.has_fin()
+                && m_send_window_size == previous_send_window_size;
+            m_last_received_ack_number = ack_number;
+
+            if (removed > 0) {
+                // RFC 6298, section 5.3: Restart the retransmission timer when new data is acknowledged.
+                m_received_duplicate_acks = 0;
+                m_retransmit_attempts = 0;
+                m_last_retransmit_time = now;
+
+                if (m_is_in_fast_recovery) {
+                    if (sequence_number_is_before_or_equal(m_recovery_point, ack_number)) {
+                        m_is_in_fast_recovery = false;
+                        m_congestion_control->did_exit_fast_recovery();
+                    } else {
+                        // RFC 6582, section 3.2: A partial ACK means the next segment was lost as well.
+                        retransmit_first_unacknowledged_packet(unacked_packets);
+                    }
+                } else if (bytes_acknowledged > 0) {
+                    m_congestion_control->did_acknowledge(bytes_acknowledged, m_smoothed_rtt, now);
+                }
+            } else if (is_duplicate_ack) {
+                ++m_received_duplicate_acks;
+                if (m_is_in_fast_recovery) {
+                    m_congestion_control->did_receive_duplicate_ack_during_recovery();
+                    evaluate_block_conditions();
+                } else if (m_received_duplicate_acks == fast_retransmit_threshold) {
+                    dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}) entering fast recovery at ack {}", this, ack_number);
+                    m_is_in_fast_recovery = true;
+                    m_recovery_point = m_sequence_number;
+                    m_congestion_control->did_enter_fast_recovery(unacked_packets.size, now);
+                    retransmit_first_unacknowledged_packet(unacked_packets);
+                }
+            }
+
             if (unacked_packets.packets.is_empty()) {
                 m_retransmit_attempts = 0;
                 dequeue_for_retransmit();
@@ -318,12 +448,125 @@ void TCPSocket::receive_tcp_packet(const TCPPacket& packet, u16 size)
 
             dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: receive_tcp_packet acknowledged {} packets", removed);
         });
+
+        if (m_send_window_size > previous_send_window_size)
+            evaluate_block_conditions();
     }
 
     m_packets_in++;
     m_bytes_in += packet.header_size() + size;
 }
 
+void TCPSocket::receive_syn_options(TCPPacket const& packet)
+{
+    bool peer_offered_window_scale = false;
+    u8 peer_window_scale_shift = 0;
+    bool peer_offered_sack = false;
+    u16 peer_mss = default_mss;
+
+    packet.for_each_option([&](TCPOptionKind kind, ReadonlyBytes data) {
+        switch (kind) {
+        case TCPOptionKind::MSS:
+            if (data.size() == sizeof(u16))
+                peer_mss = (data[0] << 8) | data[1];
+            break;
+        case TCPOptionKind::WindowScale:
+            if (data.size() == sizeof(u8)) {
+                peer_offered_window_scale = true;
+                // RFC 7323, section 2.3: Shift counts above 14 must be treated as 14.
+                peer_window_scale_shift = min(data[0], (u8)14);
+            }
+            break;
+        case TCPOptionKind::SACKPermitted:
+            peer_offered_sack = true;
+            break;
+        default:
+            break;
+        }
+    });
+
+    m_peer_mss = peer_mss ? peer_mss : default_mss;
+    m_window_scaling_enabled = peer_offered_window_scale;
+    m_send_window_scale_shift = peer_offered_window_scale ? peer_window_scale_shift : 0;
+    m_receive_window_scale_shift = peer_offered_window_scale ? receive_window_scale_shift : 0;
+    m_sack_permitted = peer_offered_sack;
+
+    size_t mss = m_peer_mss;
+    auto routing_decision = route_to(peer_address(), local_address(), bound_interface());
+    if (!routing_decision.is_zero())
+        mss = min(mss, routing_decision.adapter->mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket));
+    m_congestion_control->set_mss(mss);
+
+    dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}) peer options: mss={}, window scale={} ({}), sack permitted={}", this, m_peer_mss, m_window_scaling_enabled, m_send_window_scale_shift, m_sack_permitted);
+}
+
+void TCPSocket::mark_sacked_packets(UnackedPackets& unacked_packets, TCPPacket const& packet)
+{
+    packet.for_each_option([&](TCPOptionKind kind, ReadonlyBytes data) {
+        if (kind != TCPOptionKind::SACK)
+            return;
+        for (size_t offset = 0; offset + sizeof(TCPSACKBlock) <= data.size(); offset += sizeof(TCPSACKBlock)) {
+            TCPSACKBlock block;
+            memcpy(&block, data.offset(offset), sizeof(block));
+            u32 left_edge = block.left_edge;
+            u32 right_edge = block.right_edge;
+            for (auto& outgoing_packet : unacked_packets.packets) {
+                if (sequence_number_is_before_or_equal(left_edge, outgoing_packet.sequence_number) && sequence_number_is_before_or_equal(outgoing_packet.ack_number, right_edge))
+                    outgoing_packet.is_sacked = true;
+            }
+        }
+    });
+}
+
+void TCPSocket::update_rtt_estimate(Time const& rtt)
+{
+    // RFC 6298, section 2.
+    i64 rtt_us = max<i64>(rtt.to_microseconds(), 0);
+    if (!m_has_rtt_sample) {
+        m_has_rtt_sample = true;
+        m_smoothed_rtt = Time::from_microseconds(rtt_us);
+        m_rtt_variance = Time::from_microseconds(rtt_us / 2);
+    } else {
+        i64 smoothed_rtt_us = m_smoothed_rtt.to_microseconds();
+        i64 deviation_us = smoothed_rtt_us > rtt_us ? smoothed_rtt_us - rtt_us : rtt_us - smoothed_rtt_us;
+        m_rtt_variance = Time::from_microseconds((3 * m_rtt_variance.to_microseconds() + deviation_us) / 4);
+        m_smoothed_rtt = Time::from_microseconds((7 * smoothed_rtt_us + rtt_us) / 8);
+    }
+
+    constexpr i64 clock_granularity_us = 1000;
+    constexpr i64 minimum_retransmission_timeout_us = 1'000'000;
+    constexpr i64 maximum_retransmission_timeout_us = 60'000'000;
+    i64 timeout_us = m_smoothed_rtt.to_microseconds() + max(clock_granularity_us, 4 * m_rtt_variance.to_microseconds());
+    m_retransmission_timeout = Time::from_microseconds(clamp(timeout_us, minimum_retransmission_timeout_us, maximum_retransmission_timeout_us));
+}
+
+u16 TCPSocket::advertised_window_size(bool is_syn) const
+{
+    size_t space = receive_buffer_space();
+    // The window field of a SYN segment is never scaled (RFC 7323, section 2.2).
+    if (!is_syn)
+        space >>= m_receive_window_scale_shift;
+    return min(space, (size_t)NumericLimits<u16>::max());
+}
+
+size_t TCPSocket::effective_send_window() const
+{
+    return min<size_t>(m_send_window_size, m_congestion_control->congestion_window());
+}
+
+void TCPSocket::protocol_did_read_from_receive_buffer()
+{
+    if (m_state != State::Established)
+        return;
+
+    // RFC 1122, section 4.2.3.3: Only announce a larger window once it has grown by at
+    // least a full segment, to avoid the silly window syndrome.
+    size_t window = static_cast<size_t>(advertised_window_size(false)) << m_receive_window_scale_shift;
+    size_t last_window = static_cast<size_t>(m_last_advertised_window_size) << m_receive_window_scale_shift;
+    if (window >= last_window + m_peer_mss)
+        (void)send_ack(true);
+}
+
 bool TCPSocket::should_delay_next_ack() const
 {
     // FIXME: We don't know the MSS here so make a reasonable guess.
@@ -340,7 +583,7 @@ bool TCPSocket::should_delay_next_ack() const
     return true;
 }
 
-NetworkOrdered<u16> TCPSocket::compute_tcp_checksum(const IPv4Address& source, const IPv4Address& destination, const TCPPacket& packet, u16 payload_size)
+u16 TCPSocket::compute_tcp_pseudo_header_sum(IPv4Address const& source, IPv4Address const& destination, u16 tcp_length)
 {
     struct [[gnu::packed]] PseudoHeader {
         IPv4Address source;
@@ -350,7 +593,7 @@ NetworkOrdered<u16> TCPSocket::compute_tcp_checksum(const IPv4Address& source, c
         NetworkOrdered<u16> payload_size;
     };
 
-    PseudoHeader pseudo_header { source, destination, 0, (u8)IPv4Protocol::TCP, packet.header_size() + payload_size };
+    PseudoHeader pseudo_header { source, destination, 0, (u8)IPv4Protocol::TCP, tcp_length };
 
     u32 checksum = 0;
     auto raw_pseudo_header = bit_cast<u16*>(&pseudo_header);
@@ -359,6 +602,12 @@ NetworkOrdered<u16> TCPSocket::compute_tcp_checksum(const IPv4Address& source, c
         if (checksum > 0xffff)
             checksum = (checksum >> 16) + (checksum & 0xffff);
     }
+    return checksum;
+}
+
+NetworkOrdered<u16> TCPSocket::compute_tcp_checksum(const IPv4Address& source, const IPv4Address& destination, const TCPPacket& packet, u16 payload_size)
+{
+    u32 checksum = compute_tcp_pseudo_header_sum(source, destination, packet.header_size() + payload_size);
     auto raw_packet = bit_cast<u16*>(&packet);
     for (size_t i = 0; i < packet.header_size() / sizeof(u16); ++i) {
         checksum += AK::convert_between_host_and_network_endian(raw_packet[i]);
@@ -395,7 +644,7 @@ ErrorOr<void> TCPSocket::protocol_bind()
 ErrorOr<void> TCPSocket::protocol_listen(bool did_allocate_port)
 {
     if (!did_allocate_port) {
-        bool ok = sockets_by_tuple().with_exclusive([&](auto& table) -> bool {
+        bool ok = sockets_by_tuple().with_exclusive(tuple(), [&](auto& table) -> bool {
             if (table.contains(tuple()))
                 return false;
             table.set(tuple(), this);
@@ -462,24 +711,27 @@ ErrorOr<u16> TCPSocket::protocol_allocate_local_port()
     constexpr u16 ephemeral_port_range_size = last_ephemeral_port - first_ephemeral_port;
     u16 first_scan_port = first_ephemeral_port + get_good_random<u16>() % ephemeral_port_range_size;
 
-    return sockets_by_tuple().with_exclusive([&](auto& table) -> ErrorOr<u16> {
-        for (u16 port = first_scan_port;;) {
-            IPv4SocketTuple proposed_tuple(local_address(), port, peer_address(), peer_port());
+    for (u16 port = first_scan_port;;) {
+        IPv4SocketTuple proposed_tuple(local_address(), port, peer_address(), peer_port());
 
-            auto it = table.find(proposed_tuple);
-            if (it == table.end()) {
-                set_local_port(port);
-                table.set(proposed_tuple, this);
-                return port;
-            }
-            ++port;
-            if (port > last_ephemeral_port)
-                port = first_ephemeral_port;
-            if (port == first_scan_port)
-                break;
-        }
-        return set_so_error(EADDRINUSE);
-    });
+        // Each candidate tuple is checked and claimed under its own bucket's lock.
+        bool did_claim = sockets_by_tuple().with_exclusive(proposed_tuple, [&](auto& table) {
+            if (table.contains(proposed_tuple))
+                return false;
+            set_local_port(port);
+            table.set(proposed_tuple, this);
+            return true;
+        });
+        if (did_claim)
+            return port;
+
+        ++port;
+        if (port > last_ephemeral_port)
+            port = first_ephemeral_port;
+        if (port == first_scan_port)
+            break;
+    }
+    return set_so_error(EADDRINUSE);
 }
 
 bool TCPSocket::protocol_is_disconnected() const
@@ -520,7 +772,7 @@ ErrorOr<void> TCPSocket::close()
     }
 
     if (state() != State::Closed && state() != State::Listen)
-        closing_sockets().with_exclusive([&](auto& table) {
+        closing_sockets().with_exclusive(tuple(), [&](auto& table) {
             table.set(tuple(), *this);
         });
     return result;
@@ -551,13 +803,15 @@ void TCPSocket::retransmit_packets()
 {
     auto now = kgettimeofday();
 
-    // RFC6298 says we should have at least one second between retransmits. According to
-    // RFC1122 we must do exponential backoff - even for SYN packets.
-    i64 retransmit_interval = 1;
-    for (decltype(m_retransmit_attempts) i = 0; i < m_retransmit_attempts; i++)
-        retransmit_interval *= 2;
+    // RFC6298 says we should back off exponentially on every retransmit, and that the
+    // timeout may be capped at 60 seconds. According to RFC1122 we must do exponential
+    // backoff - even for SYN packets.
+    auto retransmit_interval = m_retransmission_timeout;
+    auto const maximum_retransmit_interval = Time::from_seconds(60);
+    for (decltype(m_retransmit_attempts) i = 0; i < m_retransmit_attempts && retransmit_interval < maximum_retransmit_interval; i++)
+        retransmit_interval = retransmit_interval + retransmit_interval;
 
-    if (m_last_retransmit_time > now - Time::from_seconds(retransmit_interval))
+    if (m_last_retransmit_time > now - retransmit_interval)
         return;
 
     dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}) handling retransmit", this);
@@ -576,42 +830,71 @@ void TCPSocket::retransmit_packets()
     if (routing_decision.is_zero())
         return;
 
+    NetworkAdapter::TransmitBatch transmit_batch { *routing_decision.adapter };
     m_unacked_packets.with_exclusive([&](auto& unacked_packets) {
+        // A timeout means the whole flight may have been lost; shrink the window
+        // so that new data goes through slow start again.
+        m_is_in_fast_recovery = false;
+        m_received_duplicate_acks = 0;
+        m_congestion_control->did_time_out(unacked_packets.size, now);
+
         for (auto& packet : unacked_packets.packets) {
-            packet.tx_counter++;
-
-            if constexpr (TCP_SOCKET_DEBUG) {
-                auto& tcp_packet = *(const TCPPacket*)(packet.buffer->buffer->data() + packet.ipv4_payload_offset);
-                dbgln("Sending TCP packet from {}:{} to {}:{} with ({}{}{}{}) seq_no={}, ack_no={}, tx_counter={}",
-                    local_address(), local_port(),
-                    peer_address(), peer_port(),
-                    (tcp_packet.has_syn() ? "SYN " : ""),
-                    (tcp_packet.has_ack() ? "ACK " : ""),
-                    (tcp_packet.has_fin() ? "FIN " : ""),
-                    (tcp_packet.has_rst() ? "RST " : ""),
-                    tcp_packet.sequence_number(),
-                    tcp_packet.ack_number(),
-                    packet.tx_counter);
-            }
+            // The peer already has these, there's no point in sending them again.
+            if (packet.is_sacked)
+                continue;
+            retransmit_packet(packet, routing_decision);
+        }
+    });
+}
 
-            size_t ipv4_payload_offset = routing_decision.adapter->ipv4_payload_offset();
-            if (ipv4_payload_offset != packet.ipv4_payload_offset) {
-                // FIXME: Add support for this. This can happen if after a route change
-                // we ended up on another adapter which doesn't have the same layer 2 type
-                // like the previous adapter.
-                VERIFY_NOT_REACHED();
-            }
+void TCPSocket::retransmit_first_unacknowledged_packet(UnackedPackets& unacked_packets)
+{
+    auto routing_decision = route_to(peer_address(), local_address(), bound_interface());
+    if (routing_decision.is_zero())
+        return;
 
-            auto packet_buffer = packet.buffer->bytes();
+    for (auto& packet : unacked_packets.packets) {
+        if (packet.is_sacked)
+            continue;
+        retransmit_packet(packet, routing_decision);
+        return;
+    }
+}
 
-            routing_decision.adapter->fill_in_ipv4_header(*packet.buffer,
-                local_address(), routing_decision.next_hop, peer_address(),
-                IPv4Protocol::TCP, packet_buffer.size() - ipv4_payload_offset, type_of_service(), ttl());
-            routing_decision.adapter->send_packet(packet_buffer);
-            m_packets_out++;
-            m_bytes_out += packet_buffer.size();
-        }
-    });
+void TCPSocket::retransmit_packet(OutgoingPacket& packet, RoutingDecision& routing_decision)
+{
+    packet.tx_counter++;
+
+    if constexpr (TCP_SOCKET_DEBUG) {
+        auto& tcp_packet = *(const TCPPacket*)(packet.buffer->buffer->data() + packet.ipv4_payload_offset);
+        dbgln("Sending TCP packet from {}:{} to {}:{} with ({}{}{}{}) seq_no={}, ack_no={}, tx_counter={}",
+            local_address(), local_port(),
+            peer_address(), peer_port(),
+            (tcp_packet.has_syn() ? "SYN " : ""),
+            (tcp_packet.has_ack() ? "ACK " : ""),
+            (tcp_packet.has_fin() ? "FIN " : ""),
+            (tcp_packet.has_rst() ? "RST " : ""),
+            tcp_packet.sequence_number(),
+            tcp_packet.ack_number(),
+            packet.tx_counter);
+    }
+
+    size_t ipv4_payload_offset = routing_decision.adapter->ipv4_payload_offset();
+    if (ipv4_payload_offset != packet.ipv4_payload_offset) {
+        // FIXME: Add support for this. This can happen if after a route change
+        // we ended up on another adapter which doesn't have the same layer 2 type
+        // like the previous adapter.
+        VERIFY_NOT_REACHED();
+    }
+
+    auto packet_buffer = packet.buffer->bytes();
+
+    routing_decision.adapter->fill_in_ipv4_header(*packet.buffer,
+        local_address(), routing_decision.next_hop, peer_address(),
+        IPv4Protocol::TCP, packet_buffer.size() - ipv4_payload_offset, type_of_service(), ttl());
+    routing_decision.adapter->send_packet(packet_buffer, packet.offload);
+    m_packets_out++;
+    m_bytes_out += packet_buffer.size();
 }
 
 bool TCPSocket::can_write(const OpenFileDescription& file_description, size_t size) const
@@ -626,7 +909,7 @@ bool TCPSocket::can_write(const OpenFileDescription& file_description, size_t si
         return true;
 
     return m_unacked_packets.with_shared([&](auto& unacked_packets) {
-        return unacked_packets.size + size <= m_send_window_size;
+        return unacked_packets.size + size <= effective_send_window();
     });
 }
 }
@@ -13,6 +13,10 @@
 #include <AK/WeakPtr.h>
 #include <Kernel/Locking/MutexProtected.h>
 #include <Kernel/Net/IPv4Socket.h>
+#include <Kernel/Net/NetworkAdapter.h>
+#include <Kernel/Net/Routing.h>
+#include <Kernel/Net/SocketTable.h>
+#include <Kernel/Net/TCPCongestionControl.h>
 
 namespace Kernel {
 
@@ -138,16 +142,46 @@ public:
     void set_duplicate_acks(u32 acks) { m_duplicate_acks = acks; }
     u32 duplicate_acks() const { return m_duplicate_acks; }
 
+    // RFC 5681 says three duplicate ACKs are a strong enough indication that a segment was lost.
+    static constexpr u32 fast_retransmit_threshold = 3;
+
+    // Our receive buffer is 256 KiB, which needs a shift of 3 to be advertised in full.
+    static constexpr u8 receive_window_scale_shift = 3;
+
+    // RFC 1122 says to assume an MSS of 536 unless the peer told us otherwise.
+    static constexpr u16 default_mss = 536;
+
+    u32 send_window_size() const { return m_send_window_size; }
+    StringView congestion_control_name() const { return m_congestion_control->name(); }
+    size_t congestion_window() const { return m_congestion_control->congestion_window(); }
+    size_t slow_start_threshold() const { return m_congestion_control->slow_start_threshold(); }
+    Time smoothed_rtt() const { return m_smoothed_rtt; }
+    Time retransmission_timeout() const { return m_retransmission_timeout; }
+
     ErrorOr<void> send_ack(bool allow_duplicate = false);
     ErrorOr<void> send_tcp_packet(u16 flags, const UserOrKernelBuffer* = nullptr, size_t = 0, RoutingDecision* = nullptr);
     void receive_tcp_packet(const TCPPacket&, u16 size);
+    void receive_syn_options(TCPPacket const&);
 
     bool should_delay_next_ack() const;
 
-    static MutexProtected<HashMap<IPv4SocketTuple, TCPSocket*>>& sockets_by_tuple();
+    // Sockets are sharded by local port and peer endpoint only, so that a listening socket
+    // bound to a specific address lives in the same bucket as the wildcard listener for
+    // the same port and both can be checked under a single lock.
+    struct TupleBucketTraits {
+        static unsigned hash(IPv4SocketTuple const& tuple)
+        {
+            return pair_int_hash(tuple.local_port(), pair_int_hash(tuple.peer_address().to_u32(), tuple.peer_port()));
+        }
+    };
+
+    using SocketsByTuple = SocketTable<IPv4SocketTuple, TCPSocket*, TupleBucketTraits>;
+    using ClosingSockets = SocketTable<IPv4SocketTuple, RefPtr<TCPSocket>, TupleBucketTraits>;
+
+    static SocketsByTuple& sockets_by_tuple();
     static RefPtr<TCPSocket> from_tuple(const IPv4SocketTuple& tuple);
 
-    static MutexProtected<HashMap<IPv4SocketTuple, RefPtr<TCPSocket>>>& closing_sockets();
+    static ClosingSockets& closing_sockets();
 
     ErrorOr<NonnullRefPtr<TCPSocket>> try_create_client(IPv4Address const& local_address, u16 local_port, IPv4Address const& peer_address, u16 peer_port);
     void set_originator(TCPSocket& originator) { m_originator = originator; }
@@ -162,12 +196,14 @@ public:
     virtual bool can_write(const OpenFileDescription&, size_t) const override;
 
     static NetworkOrdered<u16> compute_tcp_checksum(IPv4Address const& source, IPv4Address const& destination, TCPPacket const&, u16 payload_size);
+    // The (folded, but not complemented) sum of the TCP pseudo-header, for adapters that compute the rest of the checksum.
+    static u16 compute_tcp_pseudo_header_sum(IPv4Address const& source, IPv4Address const& destination, u16 tcp_length);
 
 protected:
     void set_direction(Direction direction) { m_direction = direction; }
 
 private:
-    explicit TCPSocket(int protocol, NonnullOwnPtr<DoubleBuffer> receive_buffer, NonnullOwnPtr<KBuffer> scratch_buffer);
+    explicit TCPSocket(int protocol, NonnullOwnPtr<DoubleBuffer> receive_buffer, NonnullOwnPtr<KBuffer> scratch_buffer, NonnullOwnPtr<TCPCongestionControl>);
     virtual StringView class_name() const override { return "TCPSocket"sv; }
 
     virtual void shut_down_for_writing() override;
@@ -180,10 +216,15 @@ private:
     virtual bool protocol_is_disconnected() const override;
     virtual ErrorOr<void> protocol_bind() override;
     virtual ErrorOr<void> protocol_listen(bool did_allocate_port) override;
+    virtual void protocol_did_read_from_receive_buffer() override;
 
     void enqueue_for_retransmit();
     void dequeue_for_retransmit();
 
+    u16 advertised_window_size(bool is_syn) const;
+    size_t effective_send_window() const;
+    void update_rtt_estimate(Time const& rtt);
+
     WeakPtr<TCPSocket> m_originator;
     HashMap<IPv4SocketTuple, NonnullRefPtr<TCPSocket>> m_pending_release_for_accept;
     Direction m_direction { Direction::Unspecified };
@@ -203,6 +244,11 @@ private:
         size_t ipv4_payload_offset;
         WeakPtr<NetworkAdapter> adapter;
         int tx_counter { 0 };
+        u32 sequence_number { 0 };
+        size_t payload_size { 0 };
+        Time first_sent_time;
+        bool is_sacked { false };
+        TransmitOffload offload;
     };
 
     struct UnackedPackets {
@@ -210,6 +256,10 @@ private:
         size_t size { 0 };
     };
 
+    void retransmit_packet(OutgoingPacket&, RoutingDecision&);
+    void retransmit_first_unacknowledged_packet(UnackedPackets&);
+    void mark_sacked_packets(UnackedPackets&, TCPPacket const&);
+
     MutexProtected<UnackedPackets> m_unacked_packets;
 
     u32 m_duplicate_acks { 0 };
@@ -222,8 +272,25 @@ private:
     Time m_last_retransmit_time;
     u32 m_retransmit_attempts { 0 };
 
-    // FIXME: Parse window size TCP option from the peer
-    u32 m_send_window_size { 64 * KiB };
+    u32 m_send_window_size { NumericLimits<u16>::max() };
+    u8 m_send_window_scale_shift { 0 };
+    u8 m_receive_window_scale_shift { 0 };
+    bool m_window_scaling_enabled { false };
+    u16 m_last_advertised_window_size { 0 };
+    bool m_sack_permitted { false };
+    u16 m_peer_mss { default_mss };
+
+    NonnullOwnPtr<TCPCongestionControl> m_congestion_control;
+    u32 m_last_received_ack_number { 0 };
+    u32 m_received_duplicate_acks { 0 };
+    bool m_is_in_fast_recovery { false };
+    u32 m_recovery_point { 0 };
+
+    // RFC 6298 retransmission timer state.
+    bool m_has_rtt_sample { false };
+    Time m_smoothed_rtt;
+    Time m_rtt_variance;
+    Time m_retransmission_timeout { Time::from_seconds(1) };
 
     IntrusiveListNode<TCPSocket> m_retransmit_list_node;
 
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/Memory/MemoryManager.h>
+#include <Kernel/PageTransferBuffer.h>
+#include <Kernel/Process.h>
+
+namespace Kernel {
+
+ErrorOr<NonnullOwnPtr<PageTransferBuffer>> PageTransferBuffer::try_create(size_t capacity)
+{
+    return adopt_nonnull_own_or_enomem(new (nothrow) PageTransferBuffer(capacity));
+}
+
+PageTransferBuffer::PageTransferBuffer(size_t capacity)
+    : m_capacity(capacity)
+{
+}
+
+ErrorOr<size_t> PageTransferBuffer::write(UserOrKernelBuffer const& data, size_t size)
+{
+    if (!size)
+        return 0;
+    MutexLocker locker(m_lock);
+    size_t bytes_to_write = min(size, space_for_writing());
+    if (!bytes_to_write)
+        return 0;
+
+    auto region_size = TRY(Memory::page_round_up(bytes_to_write));
+    auto region = TRY(MM.allocate_kernel_region(region_size, "PageTransferBuffer"sv, Memory::Region::Access::ReadWrite, AllocationStrategy::AllocateNow));
+    TRY(data.read(region->vaddr().as_ptr(), bytes_to_write));
+    TRY(m_chunks.try_append({ move(region), bytes_to_write, 0 }));
+    m_size += bytes_to_write;
+
+    if (m_unblock_callback)
+        m_unblock_callback();
+    return bytes_to_write;
+}
+
+size_t PageTransferBuffer::move_pages_to_user(Chunk& chunk, UserOrKernelBuffer const& destination, size_t length)
+{
+    auto destination_vaddr = VirtualAddress(destination.user_or_kernel_ptr());
+    if (chunk.read_offset % PAGE_SIZE != 0 || destination_vaddr.get() % PAGE_SIZE != 0)
+        return 0;
+
+    auto& address_space = Process::current().address_space();
+    size_t nmoved = 0;
+    while (length - nmoved >= PAGE_SIZE) {
+        auto page_vaddr = destination_vaddr.offset(nmoved);
+        SpinlockLocker locker(address_space.get_lock());
+        auto* region = address_space.find_region_containing({ page_vaddr, PAGE_SIZE });
+        if (!region || !region->can_adopt_pages())
+            break;
+
+        // Our kernel mapping of the page stays around until the whole chunk has been read,
+        // but nothing looks at this part of it anymore.
+        auto& page = chunk.region->physical_page_slot((chunk.read_offset + nmoved) / PAGE_SIZE);
+        VERIFY(page);
+        if (region->adopt_page(region->page_index_from_address(page_vaddr), *page).is_error())
+            break;
+        nmoved += PAGE_SIZE;
+    }
+    return nmoved;
+}
+
+ErrorOr<size_t> PageTransferBuffer::read(UserOrKernelBuffer& data, size_t size)
+{
+    MutexLocker locker(m_lock);
+    size_t nread = 0;
+    while (nread < size && !m_chunks.is_empty()) {
+        auto& chunk = m_chunks.first();
+        auto destination = data.offset(nread);
+        size_t length = min(size - nread, chunk.size - chunk.read_offset);
+
+        size_t nmoved = 0;
+        if (!destination.is_kernel_buffer())
+            nmoved = move_pages_to_user(chunk, destination, length);
+
+        if (nmoved == 0) {
+            // If source and destination are equally misaligned, copy up to the next page
+            // boundary so that the following pages can be moved.
+            auto misalignment = (FlatPtr)destination.user_or_kernel_ptr() % PAGE_SIZE;
+            if (!destination.is_kernel_buffer() && misalignment == chunk.read_offset % PAGE_SIZE && misalignment != 0)
+                length = min(length, PAGE_SIZE - misalignment);
+            if (auto result = destination.write(chunk.region->vaddr().offset(chunk.read_offset).as_ptr(), length); result.is_error()) {
+                if (nread > 0)
+                    break;
+                return result.release_error();
+            }
+            nmoved = length;
+        }
+
+        chunk.read_offset += nmoved;
+        m_size -= nmoved;
+        nread += nmoved;
+        if (chunk.read_offset == chunk.size)
+            m_chunks.take_first();
+    }
+
+    if (nread > 0 && m_unblock_callback)
+        m_unblock_callback();
+    return nread;
+}
+
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Function.h>
+#include <AK/Types.h>
+#include <AK/Vector.h>
+#include <Kernel/Locking/Mutex.h>
+#include <Kernel/Memory/Region.h>
+#include <Kernel/UserOrKernelBuffer.h>
+
+namespace Kernel {
+
+// A byte stream that is stored as a queue of whole pages instead of a fixed ring.
+// Each write lands in freshly allocated pages. When a reader asks for page-aligned
+// data into page-aligned private memory, those pages are mapped into its address
+// space in place of its own instead of being copied.
+class PageTransferBuffer {
+public:
+    static ErrorOr<NonnullOwnPtr<PageTransferBuffer>> try_create(size_t capacity = 1 * MiB);
+
+    ErrorOr<size_t> write(UserOrKernelBuffer const&, size_t);
+    ErrorOr<size_t> read(UserOrKernelBuffer&, size_t);
+
+    bool is_empty() const { return m_size == 0; }
+    size_t immediately_readable() const { return m_size; }
+    size_t space_for_writing() const { return m_chunks.size() < maximum_chunk_count ? m_capacity - m_size : 0; }
+
+    void set_unblock_callback(Function<void()> callback)
+    {
+        VERIFY(!m_unblock_callback);
+        m_unblock_callback = move(callback);
+    }
+
+private:
+    static constexpr size_t maximum_chunk_count = 64;
+
+    explicit PageTransferBuffer(size_t capacity);
+
+    struct Chunk {
+        NonnullOwnPtr<Memory::Region> region;
+        size_t size { 0 };
+        size_t read_offset { 0 };
+    };
+
+    size_t move_pages_to_user(Chunk&, UserOrKernelBuffer const& destination, size_t length);
+
+    Vector<Chunk> m_chunks;
+    Function<void()> m_unblock_callback;
+    size_t m_capacity { 0 };
+    size_t m_size { 0 };
+    mutable Mutex m_lock { "PageTransferBuffer" };
+};
+
+}
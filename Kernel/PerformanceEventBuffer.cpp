@@ -9,6 +9,7 @@
 #include <AK/ScopeGuard.h>
 #include <Kernel/Arch/RegisterState.h>
 #include <Kernel/Arch/SmapDisabler.h>
+#include <Kernel/Arch/x86/InterruptDisabler.h>
 #include <Kernel/FileSystem/Custody.h>
 #include <Kernel/KBufferBuilder.h>
 #include <Kernel/PerformanceEventBuffer.h>
@@ -16,11 +17,34 @@
 
 namespace Kernel {
 
-PerformanceEventBuffer::PerformanceEventBuffer(NonnullOwnPtr<KBuffer> buffer)
-    : m_buffer(move(buffer))
+PerformanceEventBuffer::PerformanceEventBuffer(NonnullOwnPtrVector<ProcessorEvents> processor_events)
+    : m_processor_events(move(processor_events))
 {
 }
 
+void PerformanceEventBuffer::clear()
+{
+    for (auto& processor_events : m_processor_events)
+        processor_events.count.store(0, AK::MemoryOrder::memory_order_release);
+    m_next_sequence_number = 0;
+}
+
+size_t PerformanceEventBuffer::capacity() const
+{
+    size_t capacity = 0;
+    for (auto const& processor_events : m_processor_events)
+        capacity += processor_events.capacity();
+    return capacity;
+}
+
+size_t PerformanceEventBuffer::count() const
+{
+    size_t count = 0;
+    for (auto const& processor_events : m_processor_events)
+        count += processor_events.count.load(AK::MemoryOrder::memory_order_acquire);
+    return count;
+}
+
 NEVER_INLINE ErrorOr<void> PerformanceEventBuffer::append(int type, FlatPtr arg1, FlatPtr arg2, StringView arg3, Thread* current_thread)
 {
     FlatPtr base_pointer;
@@ -80,9 +104,6 @@ ErrorOr<void> PerformanceEventBuffer::append_with_ip_and_bp(ProcessID pid, Threa
 ErrorOr<void> PerformanceEventBuffer::append_with_ip_and_bp(ProcessID pid, ThreadID tid,
     FlatPtr ip, FlatPtr bp, int type, u32 lost_samples, FlatPtr arg1, FlatPtr arg2, StringView arg3)
 {
-    if (count() >= capacity())
-        return ENOBUFS;
-
     if ((g_profiling_event_mask & type) == 0)
         return EINVAL;
 
@@ -147,6 +168,9 @@ ErrorOr<void> PerformanceEventBuffer::append_with_ip_and_bp(ProcessID pid, Threa
     case PERF_EVENT_CONTEXT_SWITCH:
         event.data.context_switch.next_pid = arg1;
         event.data.context_switch.next_tid = arg2;
+        memset(event.data.context_switch.reason, 0, sizeof(event.data.context_switch.reason));
+        if (!arg3.is_empty())
+            memcpy(event.data.context_switch.reason, arg3.characters_without_null_termination(), min(arg3.length(), sizeof(event.data.context_switch.reason) - 1));
         break;
     case PERF_EVENT_KMALLOC:
         event.data.kmalloc.size = arg1;
@@ -164,6 +188,8 @@ ErrorOr<void> PerformanceEventBuffer::append_with_ip_and_bp(ProcessID pid, Threa
         event.data.signpost.arg1 = arg1;
         event.data.signpost.arg2 = arg2;
         break;
+    case PERF_EVENT_THREAD_WAKEUP:
+        break;
     default:
         return EINVAL;
     }
@@ -175,15 +201,17 @@ ErrorOr<void> PerformanceEventBuffer::append_with_ip_and_bp(ProcessID pid, Threa
     event.pid = pid.value();
     event.tid = tid.value();
     event.timestamp = TimeManagement::the().uptime_ms();
-    at(m_count++) = event;
-    return {};
-}
 
-PerformanceEvent& PerformanceEventBuffer::at(size_t index)
-{
-    VERIFY(index < capacity());
-    auto* events = reinterpret_cast<PerformanceEvent*>(m_buffer->data());
-    return events[index];
+    // Nothing else can touch this processor's buffer while interrupts are disabled.
+    InterruptDisabler disabler;
+    auto& processor_events = m_processor_events[Processor::current_id()];
+    auto index = processor_events.count.load(AK::MemoryOrder::memory_order_relaxed);
+    if (index >= processor_events.capacity())
+        return ENOBUFS;
+    event.sequence_number = m_next_sequence_number++;
+    processor_events.events()[index] = event;
+    processor_events.count.store(index + 1, AK::MemoryOrder::memory_order_release);
+    return {};
 }
 
 template<typename Serializer>
@@ -196,11 +224,30 @@ ErrorOr<void> PerformanceEventBuffer::to_json_impl(Serializer& object) const
         }
     }
 
+    // Only look at the events that had been recorded when we started.
+    Vector<Span<PerformanceEvent const>, 8> processor_events;
+    for (auto const& it : m_processor_events)
+        TRY(processor_events.try_append({ it.events(), it.count.load(AK::MemoryOrder::memory_order_acquire) }));
+
+    // Merge the per-processor buffers by sequence number. Each of them is already in order.
+    auto take_next_event = [&]() -> PerformanceEvent const* {
+        Span<PerformanceEvent const>* earliest = nullptr;
+        for (auto& events : processor_events) {
+            if (!events.is_empty() && (!earliest || events[0].sequence_number < (*earliest)[0].sequence_number))
+                earliest = &events;
+        }
+        if (!earliest)
+            return nullptr;
+        auto const* event = &(*earliest)[0];
+        *earliest = earliest->slice(1);
+        return event;
+    };
+
     bool show_kernel_addresses = Process::current().is_superuser();
     auto array = object.add_array("events");
     bool seen_first_sample = false;
-    for (size_t i = 0; i < m_count; ++i) {
-        auto const& event = at(i);
+    while (auto const* next_event = take_next_event()) {
+        auto const& event = *next_event;
 
         if (!show_kernel_addresses) {
             if (event.type == PERF_EVENT_KMALLOC || event.type == PERF_EVENT_KFREE)
@@ -255,6 +302,7 @@ ErrorOr<void> PerformanceEventBuffer::to_json_impl(Serializer& object) const
             event_object.add("type", "context_switch");
             event_object.add("next_pid", static_cast<u64>(event.data.context_switch.next_pid));
             event_object.add("next_tid", static_cast<u64>(event.data.context_switch.next_tid));
+            event_object.add("reason", event.data.context_switch.reason);
             break;
         case PERF_EVENT_KMALLOC:
             event_object.add("type", "kmalloc");
@@ -277,6 +325,9 @@ ErrorOr<void> PerformanceEventBuffer::to_json_impl(Serializer& object) const
             event_object.add("arg1"sv, event.data.signpost.arg1);
             event_object.add("arg2"sv, event.data.signpost.arg2);
             break;
+        case PERF_EVENT_THREAD_WAKEUP:
+            event_object.add("type", "thread_wakeup");
+            break;
         }
         event_object.add("pid", event.pid);
         event_object.add("tid", event.tid);
@@ -307,10 +358,22 @@ ErrorOr<void> PerformanceEventBuffer::to_json(KBufferBuilder& builder) const
 
 OwnPtr<PerformanceEventBuffer> PerformanceEventBuffer::try_create_with_size(size_t buffer_size)
 {
-    auto buffer_or_error = KBuffer::try_create_with_size(buffer_size, Memory::Region::Access::ReadWrite, "Performance events", AllocationStrategy::AllocateNow);
-    if (buffer_or_error.is_error())
+    auto processor_count = Processor::count();
+    auto buffer_size_per_processor = max(buffer_size / processor_count, sizeof(PerformanceEvent));
+
+    NonnullOwnPtrVector<ProcessorEvents> processor_events;
+    if (processor_events.try_ensure_capacity(processor_count).is_error())
         return {};
-    return adopt_own_if_nonnull(new (nothrow) PerformanceEventBuffer(buffer_or_error.release_value()));
+    for (u32 i = 0; i < processor_count; ++i) {
+        auto buffer_or_error = KBuffer::try_create_with_size(buffer_size_per_processor, Memory::Region::Access::ReadWrite, "Performance events", AllocationStrategy::AllocateNow);
+        if (buffer_or_error.is_error())
+            return {};
+        auto events = adopt_own_if_nonnull(new (nothrow) ProcessorEvents(buffer_or_error.release_value()));
+        if (!events)
+            return {};
+        processor_events.unchecked_append(events.release_nonnull());
+    }
+    return adopt_own_if_nonnull(new (nothrow) PerformanceEventBuffer(move(processor_events)));
 }
 
 ErrorOr<void> PerformanceEventBuffer::add_process(const Process& process, ProcessEventType event_type)
@@ -6,7 +6,9 @@
 
 #pragma once
 
+#include <AK/Atomic.h>
 #include <AK/Error.h>
+#include <AK/NonnullOwnPtrVector.h>
 #include <Kernel/KBuffer.h>
 
 namespace Kernel {
@@ -51,6 +53,8 @@ struct [[gnu::packed]] ThreadCreatePerformanceEvent {
 struct [[gnu::packed]] ContextSwitchPerformanceEvent {
     pid_t next_pid;
     u32 next_tid;
+    // Why the previous thread stopped running: its state, or what it blocked on.
+    char reason[16];
 };
 
 struct [[gnu::packed]] KMallocPerformanceEvent {
@@ -69,11 +73,12 @@ struct [[gnu::packed]] SignpostPerformanceEvent {
 };
 
 struct [[gnu::packed]] PerformanceEvent {
-    u16 type { 0 };
+    u32 type { 0 };
     u8 stack_size { 0 };
     u32 pid { 0 };
     u32 tid { 0 };
     u64 timestamp;
+    size_t sequence_number;
     u32 lost_samples;
     union {
         MallocPerformanceEvent malloc;
@@ -97,6 +102,12 @@ enum class ProcessEventType {
     Exec
 };
 
+// Events are recorded into a separate buffer for each processor, so recording an event
+// only has to disable interrupts on the current processor rather than take a lock that
+// every processor contends on. Every event gets a sequence number from a shared counter,
+// which the per-processor buffers are merged by when they are read. That keeps the events
+// of a thread in order even when it migrates between processors, which timestamps with
+// millisecond resolution can't guarantee.
 class PerformanceEventBuffer {
 public:
     static OwnPtr<PerformanceEventBuffer> try_create_with_size(size_t buffer_size);
@@ -107,17 +118,10 @@ public:
     ErrorOr<void> append_with_ip_and_bp(ProcessID pid, ThreadID tid, const RegisterState& regs,
         int type, u32 lost_samples, FlatPtr arg1, FlatPtr arg2, StringView arg3);
 
-    void clear()
-    {
-        m_count = 0;
-    }
+    void clear();
 
-    size_t capacity() const { return m_buffer->size() / sizeof(PerformanceEvent); }
-    size_t count() const { return m_count; }
-    const PerformanceEvent& at(size_t index) const
-    {
-        return const_cast<PerformanceEventBuffer&>(*this).at(index);
-    }
+    size_t capacity() const;
+    size_t count() const;
 
     ErrorOr<void> to_json(KBufferBuilder&) const;
 
@@ -126,15 +130,29 @@ public:
     ErrorOr<FlatPtr> register_string(NonnullOwnPtr<KString>);
 
 private:
-    explicit PerformanceEventBuffer(NonnullOwnPtr<KBuffer>);
+    struct ProcessorEvents {
+        explicit ProcessorEvents(NonnullOwnPtr<KBuffer> buffer)
+            : buffer(move(buffer))
+        {
+        }
+
+        size_t capacity() const { return buffer->size() / sizeof(PerformanceEvent); }
+        PerformanceEvent const* events() const { return reinterpret_cast<PerformanceEvent const*>(buffer->data()); }
+        PerformanceEvent* events() { return reinterpret_cast<PerformanceEvent*>(buffer->data()); }
+
+        NonnullOwnPtr<KBuffer> buffer;
+        // Only ever incremented by the owning processor, with interrupts disabled, once the
+        // event is in place. Readers on other processors can use any event below it.
+        Atomic<size_t> count { 0 };
+    };
+
+    explicit PerformanceEventBuffer(NonnullOwnPtrVector<ProcessorEvents>);
 
     template<typename Serializer>
     ErrorOr<void> to_json_impl(Serializer&) const;
 
-    PerformanceEvent& at(size_t index);
-
-    size_t m_count { 0 };
-    NonnullOwnPtr<KBuffer> m_buffer;
+    NonnullOwnPtrVector<ProcessorEvents> m_processor_events;
+    Atomic<size_t, AK::MemoryOrder::memory_order_relaxed> m_next_sequence_number { 0 };
 
     HashTable<NonnullOwnPtr<KString>> m_strings;
 };
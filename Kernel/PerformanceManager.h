@@ -82,10 +82,33 @@ public:
 
     inline static void add_context_switch_perf_event(Thread& current_thread, Thread& next_thread)
     {
-        if (current_thread.is_profiling_suppressed())
+        PerformanceEventBuffer* current_event_buffer = nullptr;
+        if (!current_thread.is_profiling_suppressed())
+            current_event_buffer = current_thread.process().current_perf_events_buffer();
+        if (current_event_buffer) {
+            // NOTE: state_string() would need the thread's block lock for a blocked thread, which we can't take here.
+            auto reason = current_thread.state() == Thread::Blocked ? current_thread.blocked_on() : current_thread.state_string();
+            [[maybe_unused]] auto res = current_event_buffer->append(PERF_EVENT_CONTEXT_SWITCH, next_thread.pid().value(), next_thread.tid().value(), reason);
+        }
+
+        // The next thread's profile has to see it getting back on the CPU as well, even though it's not running yet
+        // and its stack can't be captured.
+        if (next_thread.is_profiling_suppressed())
             return;
-        if (auto* event_buffer = current_thread.process().current_perf_events_buffer()) {
-            [[maybe_unused]] auto res = event_buffer->append(PERF_EVENT_CONTEXT_SWITCH, next_thread.pid().value(), next_thread.tid().value(), nullptr);
+        auto* next_event_buffer = next_thread.process().current_perf_events_buffer();
+        if (next_event_buffer && next_event_buffer != current_event_buffer) {
+            [[maybe_unused]] auto res = next_event_buffer->append_with_ip_and_bp(next_thread.pid(), next_thread.tid(), 0, 0,
+                PERF_EVENT_CONTEXT_SWITCH, 0, next_thread.pid().value(), next_thread.tid().value(), {});
+        }
+    }
+
+    inline static void add_thread_wakeup_perf_event(Thread& thread)
+    {
+        if (thread.is_profiling_suppressed())
+            return;
+        if (auto* event_buffer = thread.process().current_perf_events_buffer()) {
+            [[maybe_unused]] auto res = event_buffer->append_with_ip_and_bp(thread.pid(), thread.tid(), 0, 0,
+                PERF_EVENT_THREAD_WAKEUP, 0, 0, 0, {});
         }
     }
 
@@ -131,7 +154,7 @@ public:
     {
         static Time last_wakeup;
         auto now = kgettimeofday();
-        constexpr auto ideal_interval = Time::from_microseconds(1000'000 / OPTIMAL_PROFILE_TICKS_PER_SECOND_RATE);
+        auto ideal_interval = Time::from_microseconds(1000'000 / TimeManagement::the().profile_sample_rate());
         auto expected_wakeup = last_wakeup + ideal_interval;
         auto delay = (now > expected_wakeup) ? now - expected_wakeup : Time::from_microseconds(0);
         last_wakeup = now;
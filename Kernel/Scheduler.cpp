@@ -6,7 +6,6 @@
 
 #include <AK/BuiltinWrappers.h>
 #include <AK/ScopeGuard.h>
-#include <AK/Singleton.h>
 #include <AK/Time.h>
 #include <Kernel/Arch/x86/InterruptDisabler.h>
 #include <Kernel/Arch/x86/TrapFrame.h>
@@ -47,9 +46,61 @@ struct ThreadReadyQueues {
     u32 mask {};
     static constexpr size_t count = sizeof(mask) * 8;
     Array<ThreadReadyQueue, count> queues;
+
+    Thread* find_runnable_thread(u32 affinity_mask)
+    {
+        auto priority_mask = mask;
+        while (priority_mask != 0) {
+            auto priority = bit_scan_forward(priority_mask);
+            VERIFY(priority > 0);
+            auto& ready_queue = queues[--priority];
+            for (auto& thread : ready_queue.thread_list) {
+                VERIFY(thread.m_runnable_priority == (int)priority);
+                if (thread.is_active())
+                    continue;
+                if (!(thread.affinity() & affinity_mask))
+                    continue;
+                return &thread;
+            }
+            priority_mask &= ~(1u << priority);
+        }
+        return nullptr;
+    }
+
+    Thread* take_runnable_thread(u32 affinity_mask)
+    {
+        auto* thread = find_runnable_thread(affinity_mask);
+        if (!thread)
+            return nullptr;
+
+        auto priority = thread->m_runnable_priority;
+        auto& ready_queue = queues[priority];
+        thread->m_runnable_priority = -1;
+        ready_queue.thread_list.remove(*thread);
+        if (ready_queue.thread_list.is_empty())
+            mask &= ~(1u << priority);
+        // Mark it as active because we are using this thread. This is similar
+        // to comparing it with Processor::current_thread, but when there are
+        // multiple processors there's no easy way to check whether the thread
+        // is actually still needed. This prevents accidental finalization when
+        // a thread is no longer in Running state, but running on another core.
+
+        // We need to mark it active here so that this thread won't be
+        // scheduled on another core if it were to be queued before actually
+        // switching to it.
+        // FIXME: Figure out a better way maybe?
+        thread->set_active(true);
+        return thread;
+    }
 };
 
-static Singleton<SpinlockProtected<ThreadReadyQueues>> g_ready_queues;
+// Every processor owns its own set of ready queues, so that picking the next
+// thread only contends with processors that are trying to steal from us.
+struct SchedulerPerProcessorData {
+    static ProcessorSpecificDataID processor_specific_data_id() { return ProcessorSpecificDataID::Scheduler; }
+
+    SpinlockProtected<ThreadReadyQueues> ready_queues;
+};
 
 static SpinlockProtected<TotalTimeScheduled> g_total_time_scheduled;
 
@@ -62,7 +113,7 @@ static void dump_thread_list(bool = false);
 static inline u32 thread_priority_to_priority_index(u32 thread_priority)
 {
     // Converts the priority in the range of THREAD_PRIORITY_MIN...THREAD_PRIORITY_MAX
-    // to a index into g_ready_queues where 0 is the highest priority bucket
+    // to a index into ThreadReadyQueues::queues where 0 is the highest priority bucket
     VERIFY(thread_priority >= THREAD_PRIORITY_MIN && thread_priority <= THREAD_PRIORITY_MAX);
     constexpr u32 thread_priority_count = THREAD_PRIORITY_MAX - THREAD_PRIORITY_MIN + 1;
     static_assert(thread_priority_count > 0);
@@ -71,71 +122,65 @@ static inline u32 thread_priority_to_priority_index(u32 thread_priority)
     return priority_bucket;
 }
 
-Thread& Scheduler::pull_next_runnable_thread()
+static SpinlockProtected<ThreadReadyQueues>* ready_queues_for(Processor& processor)
 {
-    auto affinity_mask = 1u << Processor::current_id();
+    // NOTE: Application processors only get their scheduler data once they
+    //       start scheduling, so this may be null while they are booting.
+    auto* data = processor.get_specific<SchedulerPerProcessorData>();
+    if (!data)
+        return nullptr;
+    return &data->ready_queues;
+}
 
-    return g_ready_queues->with([&](auto& ready_queues) -> Thread& {
-        auto priority_mask = ready_queues.mask;
-        while (priority_mask != 0) {
-            auto priority = bit_scan_forward(priority_mask);
-            VERIFY(priority > 0);
-            auto& ready_queue = ready_queues.queues[--priority];
-            for (auto& thread : ready_queue.thread_list) {
-                VERIFY(thread.m_runnable_priority == (int)priority);
-                if (thread.is_active())
-                    continue;
-                if (!(thread.affinity() & affinity_mask))
-                    continue;
-                thread.m_runnable_priority = -1;
-                ready_queue.thread_list.remove(thread);
-                if (ready_queue.thread_list.is_empty())
-                    ready_queues.mask &= ~(1u << priority);
-                // Mark it as active because we are using this thread. This is similar
-                // to comparing it with Processor::current_thread, but when there are
-                // multiple processors there's no easy way to check whether the thread
-                // is actually still needed. This prevents accidental finalization when
-                // a thread is no longer in Running state, but running on another core.
-
-                // We need to mark it active here so that this thread won't be
-                // scheduled on another core if it were to be queued before actually
-                // switching to it.
-                // FIXME: Figure out a better way maybe?
-                thread.set_active(true);
-                return thread;
-            }
-            priority_mask &= ~(1u << priority);
-        }
-        return *Processor::idle_thread();
+Thread& Scheduler::pull_next_runnable_thread()
+{
+    auto& processor = Processor::current();
+    auto affinity_mask = 1u << processor.id();
+
+    if (auto* thread = ready_queues_for(processor)->with([&](auto& ready_queues) { return ready_queues.take_runnable_thread(affinity_mask); }))
+        return *thread;
+
+    // Our own queues are empty, try to steal a thread from another processor.
+    // We only ever hold one ready queue lock at a time, so this can't deadlock
+    // with another processor doing the same.
+    Thread* stolen_thread = nullptr;
+    Processor::for_each([&](Processor& other_processor) {
+        if (stolen_thread || &other_processor == &processor)
+            return;
+        auto* other_ready_queues = ready_queues_for(other_processor);
+        if (!other_ready_queues)
+            return;
+        stolen_thread = other_ready_queues->with([&](auto& ready_queues) { return ready_queues.take_runnable_thread(affinity_mask); });
     });
+    if (stolen_thread) {
+        dbgln_if(SCHEDULER_DEBUG, "Scheduler[{}]: Stole {} from processor {}", processor.id(), *stolen_thread, stolen_thread->m_ready_queue_cpu);
+        return *stolen_thread;
+    }
+
+    return *Processor::idle_thread();
 }
 
 Thread* Scheduler::peek_next_runnable_thread()
 {
-    auto affinity_mask = 1u << Processor::current_id();
-
-    return g_ready_queues->with([&](auto& ready_queues) -> Thread* {
-        auto priority_mask = ready_queues.mask;
-        while (priority_mask != 0) {
-            auto priority = bit_scan_forward(priority_mask);
-            VERIFY(priority > 0);
-            auto& ready_queue = ready_queues.queues[--priority];
-            for (auto& thread : ready_queue.thread_list) {
-                VERIFY(thread.m_runnable_priority == (int)priority);
-                if (thread.is_active())
-                    continue;
-                if (!(thread.affinity() & affinity_mask))
-                    continue;
-                return &thread;
-            }
-            priority_mask &= ~(1u << priority);
-        }
-
-        // Unlike in pull_next_runnable_thread() we don't want to fall back to
-        // the idle thread. We just want to see if we have any other thread ready
-        // to be scheduled.
-        return nullptr;
+    auto& processor = Processor::current();
+    auto affinity_mask = 1u << processor.id();
+
+    if (auto* thread = ready_queues_for(processor)->with([&](auto& ready_queues) { return ready_queues.find_runnable_thread(affinity_mask); }))
+        return thread;
+
+    // Unlike in pull_next_runnable_thread() we don't want to fall back to
+    // the idle thread. We just want to see if we have any other thread ready
+    // to be scheduled, which includes threads we could steal.
+    Thread* thread = nullptr;
+    Processor::for_each([&](Processor& other_processor) {
+        if (thread || &other_processor == &processor)
+            return;
+        auto* other_ready_queues = ready_queues_for(other_processor);
+        if (!other_ready_queues)
+            return;
+        thread = other_ready_queues->with([&](auto& ready_queues) { return ready_queues.find_runnable_thread(affinity_mask); });
     });
+    return thread;
 }
 
 bool Scheduler::dequeue_runnable_thread(Thread& thread, bool check_affinity)
@@ -143,16 +188,22 @@ bool Scheduler::dequeue_runnable_thread(Thread& thread, bool check_affinity)
     if (thread.is_idle_thread())
         return true;
 
-    return g_ready_queues->with([&](auto& ready_queues) {
+    if (thread.m_runnable_priority < 0) {
+        VERIFY(!thread.m_ready_queue_node.is_in_list());
+        return false;
+    }
+
+    if (check_affinity && !(thread.affinity() & (1 << Processor::current_id())))
+        return false;
+
+    return ready_queues_for(Processor::by_id(thread.m_ready_queue_cpu))->with([&](auto& ready_queues) {
         auto priority = thread.m_runnable_priority;
         if (priority < 0) {
+            // Someone else took it off the queue before we got the lock.
             VERIFY(!thread.m_ready_queue_node.is_in_list());
             return false;
         }
 
-        if (check_affinity && !(thread.affinity() & (1 << Processor::current_id())))
-            return false;
-
         VERIFY(ready_queues.mask & (1u << priority));
         auto& ready_queue = ready_queues.queues[priority];
         thread.m_runnable_priority = -1;
@@ -163,16 +214,43 @@ bool Scheduler::dequeue_runnable_thread(Thread& thread, bool check_affinity)
     });
 }
 
+static u32 pick_processor_for(Thread const& thread)
+{
+    auto affinity = thread.affinity();
+    auto is_usable = [&](u32 cpu) {
+        if (cpu >= Processor::count() || !(affinity & (1u << cpu)))
+            return false;
+        return ready_queues_for(Processor::by_id(cpu)) != nullptr;
+    };
+
+    // Prefer the processor the thread last ran on, as its caches are most
+    // likely still warm. Otherwise keep it local if the affinity allows.
+    if (is_usable(thread.cpu()))
+        return thread.cpu();
+    auto current_cpu = Processor::current_id();
+    if (is_usable(current_cpu))
+        return current_cpu;
+    for (u32 cpu = 0; cpu < Processor::count(); ++cpu) {
+        if (is_usable(cpu))
+            return cpu;
+    }
+    // None of the processors this thread may run on are scheduling yet,
+    // queue it locally so it's picked up (or stolen) once one of them is.
+    return current_cpu;
+}
+
 void Scheduler::enqueue_runnable_thread(Thread& thread)
 {
     VERIFY(g_scheduler_lock.is_locked_by_current_processor());
     if (thread.is_idle_thread())
         return;
     auto priority = thread_priority_to_priority_index(thread.priority());
+    auto cpu = pick_processor_for(thread);
 
-    g_ready_queues->with([&](auto& ready_queues) {
+    ready_queues_for(Processor::by_id(cpu))->with([&](auto& ready_queues) {
         VERIFY(thread.m_runnable_priority < 0);
         thread.m_runnable_priority = (int)priority;
+        thread.m_ready_queue_cpu = cpu;
         VERIFY(!thread.m_ready_queue_node.is_in_list());
         auto& ready_queue = ready_queues.queues[priority];
         bool was_empty = ready_queue.thread_list.is_empty();
@@ -426,6 +504,7 @@ UNMAP_AFTER_INIT void Scheduler::initialize()
 
 UNMAP_AFTER_INIT void Scheduler::set_idle_thread(Thread* idle_thread)
 {
+    ProcessorSpecific<SchedulerPerProcessorData>::initialize();
     idle_thread->set_idle_thread();
     Processor::current().set_idle_thread(*idle_thread);
     Processor::set_current_thread(*idle_thread);
@@ -318,6 +318,8 @@ bool AHCIPort::initialize()
         // FIXME: We don't support ATAPI devices yet, so for now we don't "create" them
         if (!is_atapi_attached()) {
             m_connected_device = ATADiskDevice::create(m_parent_handler->hba_controller(), { m_port_index, 0 }, 0, logical_sector_size, max_addressable_sector);
+            // A nominal media rotation rate of 1 means this is a non-rotating (solid state) device.
+            m_connected_device->set_rotational(identify_block->nominal_media_rotation_rate != 1);
         } else {
             dbgln("AHCI Port {}: Ignoring ATAPI devices for now as we don't currently support them.", representative_port_index());
         }
@@ -413,10 +413,13 @@ UNMAP_AFTER_INIT void IDEChannel::detect_disks()
         dbgln("IDEChannel: {} {} {} device found: Name={}, Capacity={}, Capabilities={:#04x}", channel_type_string(), channel_string(i), !command_set_is_atapi ? "ATA" : "ATAPI", ((char*)bbuf.data() + 54), max_addressable_block * 512, capabilities);
         // FIXME: Don't assume all drives will have logical sector size of 512 bytes.
         ATADevice::Address address = { m_channel_type == ChannelType::Primary ? static_cast<u8>(0) : static_cast<u8>(1), static_cast<u8>(i) };
+        auto device = ATADiskDevice::create(m_parent_controller, address, capabilities, 512, max_addressable_block);
+        // A nominal media rotation rate of 1 means this is a non-rotating (solid state) device.
+        device->set_rotational(identify_block.nominal_media_rotation_rate != 1);
         if (i == 0) {
-            m_master = ATADiskDevice::create(m_parent_controller, address, capabilities, 512, max_addressable_block);
+            m_master = move(device);
         } else {
-            m_slave = ATADiskDevice::create(m_parent_controller, address, capabilities, 512, max_addressable_block);
+            m_slave = move(device);
         }
     }
 }
@@ -34,8 +34,6 @@ NVMeController::NVMeController(const PCI::DeviceIdentifier& device_identifier)
 
 ErrorOr<void> NVMeController::initialize()
 {
-    // Nr of queues = one queue per core
-    auto nr_of_queues = Processor::count();
     auto irq = m_pci_device_id.interrupt_line().value();
 
     PCI::enable_memory_space(m_pci_device_id.address());
@@ -54,10 +52,15 @@ ErrorOr<void> NVMeController::initialize()
     VERIFY(IO_QUEUE_SIZE < MQES(m_controller_regs->cap));
     dbgln_if(NVME_DEBUG, "NVMe: IO queue depth is: {}", IO_QUEUE_SIZE);
 
-    // Create an IO queue per core
-    for (u32 cpuid = 0; cpuid < nr_of_queues; ++cpuid) {
+    // Ideally we want one IO queue per core, so that every processor can submit
+    // requests without contending with the others, but the controller decides how
+    // many we actually get. Processors share queues round-robin if we get fewer.
+    auto nr_of_queues = negotiate_io_queue_count(Processor::count());
+    dbgln_if(NVME_DEBUG, "NVMe: Using {} IO queues for {} processors", nr_of_queues, Processor::count());
+
+    for (u32 queue_index = 0; queue_index < nr_of_queues; ++queue_index) {
         // qid is zero is used for admin queue
-        TRY(create_io_queue(irq, cpuid + 1));
+        TRY(create_io_queue(irq, queue_index + 1));
     }
     TRY(identify_and_init_namespaces());
     return {};
@@ -267,6 +270,26 @@ ErrorOr<void> NVMeController::create_admin_queue(u8 irq)
     return {};
 }
 
+u32 NVMeController::negotiate_io_queue_count(u32 wanted_queue_count)
+{
+    VERIFY(wanted_queue_count > 0);
+    NVMeSubmission sub {};
+    u32 result = 0;
+
+    sub.op = OP_ADMIN_SET_FEATURES;
+    sub.cdw10 = AK::convert_between_host_and_little_endian(FEATURE_NUMBER_OF_QUEUES);
+    // Both the number of completion and submission queues are 0 based
+    sub.cdw11 = AK::convert_between_host_and_little_endian((wanted_queue_count - 1) << 16 | (wanted_queue_count - 1));
+    if (auto status = submit_admin_command(sub, true, &result); status != 0) {
+        dmesgln("NVMe: Failed to set the number of IO queues (status {:#x}), falling back to a single queue", status);
+        return 1;
+    }
+
+    u32 allocated_submission_queues = (result & 0xFFFF) + 1;
+    u32 allocated_completion_queues = (result >> 16) + 1;
+    return min(wanted_queue_count, min(allocated_submission_queues, allocated_completion_queues));
+}
+
 ErrorOr<void> NVMeController::create_io_queue(u8 irq, u8 qid)
 {
     NVMeSubmission sub {};
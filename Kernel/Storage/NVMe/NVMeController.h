@@ -41,11 +41,11 @@ public:
     bool start_controller();
     u32 get_admin_q_dept();
 
-    u16 submit_admin_command(struct NVMeSubmission& sub, bool sync = false)
+    u16 submit_admin_command(struct NVMeSubmission& sub, bool sync = false, u32* command_specific = nullptr)
     {
         // First queue is always the admin queue
         if (sync) {
-            return m_admin_queue->submit_sync_sqe(sub);
+            return m_admin_queue->submit_sync_sqe(sub, command_specific);
         }
         m_admin_queue->submit_sqe(sub);
         return 0;
@@ -59,6 +59,7 @@ private:
     Tuple<u64, u8> get_ns_features(IdentifyNamespace& identify_data_struct);
     ErrorOr<void> create_admin_queue(u8 irq);
     ErrorOr<void> create_io_queue(u8 irq, u8 qid);
+    u32 negotiate_io_queue_count(u32 wanted_queue_count);
     void calculate_doorbell_stride()
     {
         m_dbl_stride = (m_controller_regs->cap >> CAP_DBL_SHIFT) & CAP_DBL_MASK;
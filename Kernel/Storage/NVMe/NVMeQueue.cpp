@@ -114,15 +114,15 @@ void NVMeQueue::submit_sqe(struct NVMeSubmission& sub)
     update_sq_doorbell();
 }
 
-u16 NVMeQueue::submit_sync_sqe(NVMeSubmission& sub)
+u16 NVMeQueue::submit_sync_sqe(NVMeSubmission& sub, u32* command_specific)
 {
     // For now let's use sq tail as a unique command id.
     u16 cqe_cid;
     u16 cid = m_sq_tail;
+    int index;
 
     submit_sqe(sub);
     do {
-        int index;
         {
             SpinlockLocker lock(m_cq_lock);
             index = m_cq_head - 1;
@@ -133,6 +133,8 @@ u16 NVMeQueue::submit_sync_sqe(NVMeSubmission& sub)
         Scheduler::yield();
     } while (cid != cqe_cid);
 
+    if (command_specific)
+        *command_specific = m_cqe_array[index].cmd_spec;
     auto status = CQ_STATUS_FIELD(m_cqe_array[m_cq_head].status);
     return status;
 }
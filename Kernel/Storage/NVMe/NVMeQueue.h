@@ -35,7 +35,7 @@ public:
     bool is_admin_queue() { return m_admin_queue; };
     bool handle_irq(const RegisterState&) override;
     void submit_sqe(struct NVMeSubmission&);
-    u16 submit_sync_sqe(struct NVMeSubmission&);
+    u16 submit_sync_sqe(struct NVMeSubmission&, u32* command_specific = nullptr);
     void read(AsyncBlockDeviceRequest& request, u16 nsid, u64 index, u32 count);
     void write(AsyncBlockDeviceRequest& request, u16 nsid, u64 index, u32 count);
     void enable_interrupts() { enable_irq(); };
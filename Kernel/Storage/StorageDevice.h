@@ -36,6 +36,9 @@ public:
 public:
     virtual u64 max_addressable_block() const { return m_max_addressable_block; }
 
+    bool is_rotational() const { return m_is_rotational; }
+    void set_rotational(bool rotational) { m_is_rotational = rotational; }
+
     // ^BlockDevice
     virtual ErrorOr<size_t> read(OpenFileDescription&, u64, UserOrKernelBuffer&, size_t) override;
     virtual bool can_read(const OpenFileDescription&, size_t) const override;
@@ -60,6 +63,9 @@ protected:
     // ^DiskDevice
     virtual StringView class_name() const override;
 
+    // ^Device
+    virtual bool should_reorder_requests() const override { return m_is_rotational; }
+
 private:
     mutable IntrusiveListNode<StorageDevice, RefPtr<StorageDevice>> m_list_node;
     NonnullRefPtrVector<DiskPartition> m_partitions;
@@ -67,6 +73,7 @@ private:
     // FIXME: Remove this method after figuring out another scheme for naming.
     NonnullOwnPtr<KString> m_early_storage_device_name;
     u64 m_max_addressable_block;
+    bool m_is_rotational { false };
 };
 
 }
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ScopeGuard.h>
+#include <Kernel/Debug.h>
+#include <Kernel/FileSystem/EventQueue.h>
+#include <Kernel/FileSystem/OpenFileDescription.h>
+#include <Kernel/Process.h>
+
+namespace Kernel {
+
+using BlockFlags = Thread::FileBlocker::BlockFlags;
+
+// Arbitrary pain threshold.
+static constexpr int max_events_per_wait = 1024;
+
+static ErrorOr<NonnullRefPtr<OpenFileDescription>> open_event_queue_description(Process::OpenFileDescriptions const& fds, int epfd)
+{
+    auto description = TRY(fds.open_file_description(epfd));
+    if (!description->file().is_event_queue())
+        return EINVAL;
+    return description;
+}
+
+ErrorOr<FlatPtr> Process::sys$epoll_create1(int flags)
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this)
+    TRY(require_promise(Pledge::stdio));
+    if (flags & ~EPOLL_CLOEXEC)
+        return EINVAL;
+
+    auto fd_allocation = TRY(m_fds.allocate());
+    auto event_queue = TRY(EventQueue::try_create());
+    auto description = TRY(OpenFileDescription::try_create(move(event_queue)));
+    description->set_readable(true);
+
+    m_fds[fd_allocation.fd].set(move(description));
+    if (flags & EPOLL_CLOEXEC)
+        m_fds[fd_allocation.fd].set_flags(m_fds[fd_allocation.fd].flags() | FD_CLOEXEC);
+
+    return fd_allocation.fd;
+}
+
+ErrorOr<FlatPtr> Process::sys$epoll_ctl(int epfd, int op, int fd, Userspace<epoll_event const*> user_event)
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this)
+    TRY(require_promise(Pledge::stdio));
+    auto event_queue_description = TRY(open_event_queue_description(fds(), epfd));
+    auto& event_queue = static_cast<EventQueue&>(event_queue_description->file());
+
+    if (op == EPOLL_CTL_DEL) {
+        TRY(event_queue.remove_watch(fd));
+        return 0;
+    }
+
+    auto event = TRY(copy_typed_from_user(user_event));
+    switch (op) {
+    case EPOLL_CTL_ADD: {
+        auto description = TRY(fds().open_file_description(fd));
+        // Watching event queues could form cycles of notifications.
+        if (description->file().is_event_queue())
+            return EINVAL;
+        TRY(event_queue.add_watch(fd, move(description), event));
+        return 0;
+    }
+    case EPOLL_CTL_MOD:
+        TRY(event_queue.modify_watch(fd, event));
+        return 0;
+    default:
+        return EINVAL;
+    }
+}
+
+ErrorOr<FlatPtr> Process::sys$epoll_wait(Userspace<Syscall::SC_epoll_wait_params const*> user_params)
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this)
+    TRY(require_promise(Pledge::stdio));
+    auto params = TRY(copy_typed_from_user(user_params));
+
+    if (params.max_events <= 0)
+        return EINVAL;
+
+    auto description = TRY(open_event_queue_description(fds(), params.epfd));
+    auto& event_queue = static_cast<EventQueue&>(description->file());
+
+    Thread::BlockTimeout timeout;
+    bool should_wait = true;
+    if (params.timeout) {
+        auto timeout_time = TRY(copy_time_from_user(params.timeout));
+        timeout = Thread::BlockTimeout(false, &timeout_time);
+        should_wait = timeout_time > Time::zero();
+    }
+
+    sigset_t sigmask = {};
+    if (params.sigmask)
+        TRY(copy_from_user(&sigmask, params.sigmask));
+
+    Vector<epoll_event, 32> events;
+    TRY(events.try_resize(min(params.max_events, max_events_per_wait)));
+
+    auto* current_thread = Thread::current();
+
+    u32 previous_signal_mask = 0;
+    if (params.sigmask)
+        previous_signal_mask = current_thread->update_signal_mask(sigmask);
+    ScopeGuard rollback_signal_mask([&]() {
+        if (params.sigmask)
+            current_thread->update_signal_mask(previous_signal_mask);
+    });
+
+    dbgln_if(POLL_SELECT_DEBUG, "epoll_wait on {} with room for {} events, timeout={}", params.epfd, events.size(), params.timeout);
+
+    for (;;) {
+        auto event_count = TRY(event_queue.collect_ready_events(events.span()));
+        if (event_count > 0) {
+            TRY(copy_n_to_user(params.events, events.data(), event_count));
+            return event_count;
+        }
+        if (!should_wait)
+            return 0;
+
+        auto unblock_flags = BlockFlags::None;
+        auto block_result = current_thread->block<Thread::ReadBlocker>(timeout, *description, unblock_flags);
+        if (block_result.was_interrupted())
+            return EINTR;
+        if (block_result == Thread::BlockResult::InterruptedByTimeout)
+            return 0;
+    }
+}
+
+}
@@ -8,6 +8,7 @@
 #include <Kernel/FileSystem/Custody.h>
 #include <Kernel/FileSystem/OpenFileDescription.h>
 #include <Kernel/Memory/Region.h>
+#include <Kernel/Memory/TLBShootdownBatch.h>
 #include <Kernel/PerformanceManager.h>
 #include <Kernel/Process.h>
 
@@ -99,11 +100,17 @@ ErrorOr<FlatPtr> Process::sys$fork(RegisterState& regs)
 
     {
         SpinlockLocker lock(address_space().get_lock());
+        // Turning our private regions into COW regions write-protects them, so we have to flush
+        // our TLB entries for them. Do it all at once instead of shooting down each region separately.
+        Memory::TLBShootdownBatch tlb_shootdown_batch(address_space().page_directory());
         for (auto& region : address_space().regions()) {
             dbgln_if(FORK_DEBUG, "fork: cloning Region({}) '{}' @ {}", region, region->name(), region->vaddr());
-            auto region_clone = TRY(region->try_clone());
+            tlb_shootdown_batch.add(region->range());
+            auto region_clone = TRY(region->try_clone(Memory::ShouldFlushTLB::No));
             auto* child_region = TRY(child->address_space().add_region(move(region_clone)));
-            TRY(child_region->map(child->address_space().page_directory(), Memory::ShouldFlushTLB::No));
+            // The child populates its page tables as it touches its memory. Most children exec() right away,
+            // so mapping everything here would mostly be wasted work.
+            child_region->map_lazily(child->address_space().page_directory());
 
             if (region == m_master_tls_region.unsafe_ptr())
                 child->m_master_tls_region = child_region;
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/NumericLimits.h>
+#include <Kernel/API/POSIX/sys/io_batch.h>
+#include <Kernel/API/POSIX/sys/uio.h>
+#include <Kernel/Debug.h>
+#include <Kernel/FileSystem/OpenFileDescription.h>
+#include <Kernel/Process.h>
+
+namespace Kernel {
+
+// How many requests we copy in from (and results we copy back out to) userspace at a time.
+static constexpr size_t io_request_chunk_size = 32;
+
+// Arbitrary pain threshold, same as readv() and writev().
+static constexpr size_t max_iovec_count = MiB;
+
+ErrorOr<FlatPtr> Process::do_io_request(io_request const& request)
+{
+    if (request.flags & ~IO_POSITIONAL)
+        return EINVAL;
+    Optional<off_t> offset;
+    if (request.flags & IO_POSITIONAL) {
+        if (request.offset < 0)
+            return EINVAL;
+        offset = request.offset;
+    }
+
+    auto description = TRY(fds().open_file_description(request.fd));
+    bool is_read = request.opcode == IO_READ || request.opcode == IO_READV;
+    if (is_read && !description->is_readable())
+        return EBADF;
+    if (!is_read && !description->is_writable())
+        return EBADF;
+    if (description->is_directory())
+        return EISDIR;
+
+    // Vectored requests are handled one iovec at a time, just like plain requests.
+    Vector<iovec, 16> vecs;
+    switch (request.opcode) {
+    case IO_READ:
+    case IO_WRITE:
+        TRY(vecs.try_append({ request.buffer, request.length }));
+        break;
+    case IO_READV:
+    case IO_WRITEV: {
+        if (request.length > max_iovec_count)
+            return EFAULT;
+        TRY(vecs.try_resize(request.length));
+        TRY(copy_n_from_user(vecs.data(), static_cast<iovec const*>(request.buffer), request.length));
+        break;
+    }
+    default:
+        return EINVAL;
+    }
+
+    u64 total_length = 0;
+    for (auto& vec : vecs) {
+        total_length += vec.iov_len;
+        if (total_length > NumericLimits<ssize_t>::max())
+            return EINVAL;
+    }
+    if (offset.has_value() && Checked<off_t>::addition_would_overflow(offset.value(), total_length))
+        return EOVERFLOW;
+
+    size_t ntransferred = 0;
+    for (auto& vec : vecs) {
+        if (vec.iov_len == 0)
+            continue;
+        auto buffer = TRY(UserOrKernelBuffer::for_user_buffer(static_cast<u8*>(vec.iov_base), vec.iov_len));
+        Optional<off_t> vec_offset;
+        if (offset.has_value())
+            vec_offset = offset.value() + ntransferred;
+
+        ErrorOr<FlatPtr> result = 0;
+        if (is_read) {
+            result = do_read(*description, buffer, vec.iov_len, vec_offset);
+        } else if (vec_offset.has_value()) {
+            if (!description->file().is_seekable())
+                return EINVAL;
+            result = description->write(vec_offset.value(), buffer, vec.iov_len);
+        } else {
+            result = do_write(*description, buffer, vec.iov_len);
+        }
+
+        // Like readv() and writev(), report a partial transfer rather than the error that cut it short.
+        if (result.is_error()) {
+            if (ntransferred == 0)
+                return result.release_error();
+            break;
+        }
+        ntransferred += result.value();
+        if (result.value() < vec.iov_len)
+            break;
+    }
+    return ntransferred;
+}
+
+ErrorOr<FlatPtr> Process::sys$io_submit_batch(Userspace<io_request*> user_requests, size_t count)
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this)
+    TRY(require_promise(Pledge::stdio));
+    if (count > IO_BATCH_MAX)
+        return EINVAL;
+    dbgln_if(IO_DEBUG, "sys$io_submit_batch({}, {})", user_requests.ptr(), count);
+
+    // The requests are carried out in order. Every request gets its own result, so a failing
+    // request doesn't stop the rest of the batch, but being interrupted by a signal does.
+    size_t nprocessed = 0;
+    while (nprocessed < count) {
+        Array<io_request, io_request_chunk_size> requests;
+        auto chunk_size = min(count - nprocessed, io_request_chunk_size);
+        auto* user_chunk = user_requests.unsafe_userspace_ptr() + nprocessed;
+        TRY(copy_n_from_user(requests.data(), user_chunk, chunk_size));
+
+        bool was_interrupted = false;
+        size_t nprocessed_in_chunk = 0;
+        for (; nprocessed_in_chunk < chunk_size && !was_interrupted; ++nprocessed_in_chunk) {
+            auto& request = requests[nprocessed_in_chunk];
+            auto result = do_io_request(request);
+            if (result.is_error()) {
+                request.result = -result.error().code();
+                was_interrupted = result.error().code() == EINTR;
+            } else {
+                request.result = static_cast<ssize_t>(result.value());
+            }
+        }
+
+        TRY(copy_n_to_user(user_chunk, requests.data(), nprocessed_in_chunk));
+        nprocessed += nprocessed_in_chunk;
+        if (was_interrupted)
+            break;
+    }
+    return nprocessed;
+}
+
+}
@@ -182,6 +182,10 @@ ErrorOr<FlatPtr> Process::sys$mmap(Userspace<const Syscall::SC_mmap_params*> use
     if (map_stack && (!map_private || !map_anonymous))
         return EINVAL;
 
+    // Give large private anonymous mappings a chance to be backed by huge pages.
+    if (map_anonymous && map_private && !map_stack && !(flags & MAP_PURGEABLE) && !addr && rounded_size >= Memory::huge_page_size)
+        alignment = max(alignment, Memory::huge_page_size);
+
     Memory::Region* region = nullptr;
 
     auto range = TRY([&]() -> ErrorOr<Memory::VirtualRange> {
@@ -37,6 +37,16 @@ static ErrorOr<void> check_blocked_read(OpenFileDescription* description)
     return {};
 }
 
+ErrorOr<FlatPtr> Process::do_read(OpenFileDescription& description, UserOrKernelBuffer& buffer, size_t size, Optional<off_t> offset)
+{
+    if (offset.has_value() && !description.file().is_seekable())
+        return EINVAL;
+    TRY(check_blocked_read(&description));
+    if (offset.has_value())
+        return TRY(description.read(buffer, offset.value(), size));
+    return TRY(description.read(buffer, size));
+}
+
 ErrorOr<FlatPtr> Process::sys$readv(int fd, Userspace<const struct iovec*> iov, int iov_count)
 {
     VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this)
@@ -81,9 +91,8 @@ ErrorOr<FlatPtr> Process::sys$read(int fd, Userspace<u8*> buffer, size_t size)
         return EINVAL;
     dbgln_if(IO_DEBUG, "sys$read({}, {}, {})", fd, buffer.ptr(), size);
     auto description = TRY(open_readable_file_description(fds(), fd));
-    TRY(check_blocked_read(description));
     auto user_buffer = TRY(UserOrKernelBuffer::for_user_buffer(buffer, size));
-    return TRY(description->read(user_buffer, size));
+    return do_read(*description, user_buffer, size);
 }
 
 // NOTE: The offset is passed by pointer because off_t is 64bit,
@@ -101,11 +110,8 @@ ErrorOr<FlatPtr> Process::sys$pread(int fd, Userspace<u8*> buffer, size_t size,
         return EINVAL;
     dbgln_if(IO_DEBUG, "sys$pread({}, {}, {}, {})", fd, buffer.ptr(), size, offset);
     auto description = TRY(open_readable_file_description(fds(), fd));
-    if (!description->file().is_seekable())
-        return EINVAL;
-    TRY(check_blocked_read(description));
     auto user_buffer = TRY(UserOrKernelBuffer::for_user_buffer(buffer, size));
-    return TRY(description->read(user_buffer, offset, size));
+    return do_read(*description, user_buffer, size, offset);
 }
 
 }
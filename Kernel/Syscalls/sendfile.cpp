@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/NumericLimits.h>
+#include <Kernel/Debug.h>
+#include <Kernel/FileSystem/OpenFileDescription.h>
+#include <Kernel/KBuffer.h>
+#include <Kernel/Process.h>
+
+namespace Kernel {
+
+// How much file data we stage in the kernel at a time on its way to the output file.
+static constexpr size_t sendfile_chunk_size = 64 * KiB;
+
+ErrorOr<FlatPtr> Process::sys$sendfile(int out_fd, int in_fd, Userspace<off_t*> userspace_offset, size_t count)
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this)
+    TRY(require_promise(Pledge::stdio));
+    if (count == 0)
+        return 0;
+    if (count > NumericLimits<ssize_t>::max())
+        return EINVAL;
+    dbgln_if(IO_DEBUG, "sys$sendfile({}, {}, {}, {})", out_fd, in_fd, userspace_offset.ptr(), count);
+
+    auto in_description = TRY(fds().open_file_description(in_fd));
+    if (!in_description->is_readable())
+        return EBADF;
+    // Only inode-backed files can be read at arbitrary offsets without disturbing anyone else.
+    if (!in_description->file().is_inode() || in_description->is_directory())
+        return EINVAL;
+
+    auto out_description = TRY(fds().open_file_description(out_fd));
+    if (!out_description->is_writable())
+        return EBADF;
+
+    off_t offset = in_description->offset();
+    if (userspace_offset)
+        TRY(copy_from_user(&offset, userspace_offset));
+    if (offset < 0)
+        return EINVAL;
+
+    auto chunk = TRY(KBuffer::try_create_with_size(min(count, sendfile_chunk_size), Memory::Region::Access::ReadWrite, "sendfile"sv));
+    auto chunk_buffer = UserOrKernelBuffer::for_kernel_buffer(chunk->data());
+
+    size_t total_nsent = 0;
+    ErrorOr<void> result;
+    while (total_nsent < count) {
+        auto nread_or_error = in_description->read(chunk_buffer, offset + total_nsent, min(count - total_nsent, chunk->size()));
+        if (nread_or_error.is_error()) {
+            result = nread_or_error.release_error();
+            break;
+        }
+        auto nread = nread_or_error.release_value();
+        if (nread == 0)
+            break;
+
+        auto nwritten_or_error = do_write(*out_description, chunk_buffer, nread);
+        if (nwritten_or_error.is_error()) {
+            result = nwritten_or_error.release_error();
+            break;
+        }
+        auto nwritten = nwritten_or_error.release_value();
+        total_nsent += nwritten;
+        // The output file would block, report what we got through so far.
+        if (nwritten < nread)
+            break;
+    }
+
+    if (total_nsent == 0 && result.is_error())
+        return result.release_error();
+
+    if (userspace_offset) {
+        off_t new_offset = offset + total_nsent;
+        TRY(copy_to_user(userspace_offset, &new_offset));
+    } else {
+        TRY(in_description->seek(offset + total_nsent, SEEK_SET));
+    }
+    return total_nsent;
+}
+
+}
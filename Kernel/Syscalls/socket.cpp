@@ -19,6 +19,9 @@ namespace Kernel {
             TRY(require_promise(Pledge::unix));   \
     } while (0)
 
+// Same as Linux's UIO_MAXIOV, so that a single recvmmsg() or sendmmsg() can't hold on to the big lock for too long.
+static constexpr unsigned max_messages_per_batch = 1024;
+
 void Process::setup_socket_fd(int fd, NonnullRefPtr<OpenFileDescription> description, int type)
 {
     description->set_readable(true);
@@ -158,12 +161,8 @@ ErrorOr<FlatPtr> Process::sys$shutdown(int sockfd, int how)
     return 0;
 }
 
-ErrorOr<FlatPtr> Process::sys$sendmsg(int sockfd, Userspace<const struct msghdr*> user_msg, int flags)
+static ErrorOr<size_t> send_message(OpenFileDescription& description, Socket& socket, struct msghdr const& msg, int flags)
 {
-    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this)
-    TRY(require_promise(Pledge::stdio));
-    auto msg = TRY(copy_typed_from_user(user_msg));
-
     if (msg.msg_iovlen != 1)
         return ENOTSUP; // FIXME: Support this :)
     Vector<iovec, 1> iovs;
@@ -175,22 +174,14 @@ ErrorOr<FlatPtr> Process::sys$sendmsg(int sockfd, Userspace<const struct msghdr*
     Userspace<const sockaddr*> user_addr((FlatPtr)msg.msg_name);
     socklen_t addr_length = msg.msg_namelen;
 
-    auto description = TRY(fds().open_file_description(sockfd));
-    if (!description->is_socket())
-        return ENOTSOCK;
-    auto& socket = *description->socket();
     if (socket.is_shut_down_for_writing())
         return EPIPE;
     auto data_buffer = TRY(UserOrKernelBuffer::for_user_buffer((u8*)iovs[0].iov_base, iovs[0].iov_len));
-    auto bytes_sent = TRY(socket.sendto(*description, data_buffer, iovs[0].iov_len, flags, user_addr, addr_length));
-    return bytes_sent;
+    return socket.sendto(description, data_buffer, iovs[0].iov_len, flags, user_addr, addr_length);
 }
 
-ErrorOr<FlatPtr> Process::sys$recvmsg(int sockfd, Userspace<struct msghdr*> user_msg, int flags)
+static ErrorOr<size_t> receive_message(OpenFileDescription& description, Socket& socket, Userspace<struct msghdr*> user_msg, int flags)
 {
-    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this)
-    TRY(require_promise(Pledge::stdio));
-
     struct msghdr msg;
     TRY(copy_from_user(&msg, user_msg));
 
@@ -203,23 +194,18 @@ ErrorOr<FlatPtr> Process::sys$recvmsg(int sockfd, Userspace<struct msghdr*> user
     Userspace<sockaddr*> user_addr((FlatPtr)msg.msg_name);
     Userspace<socklen_t*> user_addr_length(msg.msg_name ? (FlatPtr)&user_msg.unsafe_userspace_ptr()->msg_namelen : 0);
 
-    auto description = TRY(fds().open_file_description(sockfd));
-    if (!description->is_socket())
-        return ENOTSOCK;
-    auto& socket = *description->socket();
-
     if (socket.is_shut_down_for_reading())
         return 0;
 
-    bool original_blocking = description->is_blocking();
+    bool original_blocking = description.is_blocking();
     if (flags & MSG_DONTWAIT)
-        description->set_blocking(false);
+        description.set_blocking(false);
 
     auto data_buffer = TRY(UserOrKernelBuffer::for_user_buffer((u8*)iovs[0].iov_base, iovs[0].iov_len));
     Time timestamp {};
-    auto result = socket.recvfrom(*description, data_buffer, iovs[0].iov_len, flags, user_addr, user_addr_length, timestamp);
+    auto result = socket.recvfrom(description, data_buffer, iovs[0].iov_len, flags, user_addr, user_addr_length, timestamp);
     if (flags & MSG_DONTWAIT)
-        description->set_blocking(original_blocking);
+        description.set_blocking(original_blocking);
 
     if (result.is_error())
         return result.release_error();
@@ -250,6 +236,91 @@ ErrorOr<FlatPtr> Process::sys$recvmsg(int sockfd, Userspace<struct msghdr*> user
     return result.value();
 }
 
+ErrorOr<FlatPtr> Process::sys$sendmsg(int sockfd, Userspace<const struct msghdr*> user_msg, int flags)
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this)
+    TRY(require_promise(Pledge::stdio));
+    auto msg = TRY(copy_typed_from_user(user_msg));
+
+    auto description = TRY(fds().open_file_description(sockfd));
+    if (!description->is_socket())
+        return ENOTSOCK;
+    auto& socket = *description->socket();
+    return TRY(send_message(*description, socket, msg, flags));
+}
+
+ErrorOr<FlatPtr> Process::sys$sendmmsg(int sockfd, Userspace<struct mmsghdr*> user_msgvec, unsigned vlen, int flags)
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this)
+    TRY(require_promise(Pledge::stdio));
+    vlen = min(vlen, max_messages_per_batch);
+
+    auto description = TRY(fds().open_file_description(sockfd));
+    if (!description->is_socket())
+        return ENOTSOCK;
+    auto& socket = *description->socket();
+
+    auto* user_msgs = user_msgvec.unsafe_userspace_ptr();
+    unsigned sent_count = 0;
+    for (; sent_count < vlen; ++sent_count) {
+        struct msghdr msg;
+        TRY(copy_from_user(&msg, &user_msgs[sent_count].msg_hdr));
+        auto result = send_message(*description, socket, msg, flags);
+        // Like Linux, only report an error if nothing was sent at all. The caller will run into it again with the rest.
+        if (result.is_error()) {
+            if (sent_count == 0)
+                return result.release_error();
+            break;
+        }
+        unsigned message_length = result.value();
+        TRY(copy_to_user(&user_msgs[sent_count].msg_len, &message_length));
+    }
+    return sent_count;
+}
+
+ErrorOr<FlatPtr> Process::sys$recvmsg(int sockfd, Userspace<struct msghdr*> user_msg, int flags)
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this)
+    TRY(require_promise(Pledge::stdio));
+
+    auto description = TRY(fds().open_file_description(sockfd));
+    if (!description->is_socket())
+        return ENOTSOCK;
+    auto& socket = *description->socket();
+    return TRY(receive_message(*description, socket, user_msg, flags));
+}
+
+ErrorOr<FlatPtr> Process::sys$recvmmsg(int sockfd, Userspace<struct mmsghdr*> user_msgvec, unsigned vlen, int flags)
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this)
+    TRY(require_promise(Pledge::stdio));
+    vlen = min(vlen, max_messages_per_batch);
+    flags &= ~MSG_WAITFORONE;
+
+    auto description = TRY(fds().open_file_description(sockfd));
+    if (!description->is_socket())
+        return ENOTSOCK;
+    auto& socket = *description->socket();
+
+    auto* user_msgs = user_msgvec.unsafe_userspace_ptr();
+    unsigned received_count = 0;
+    for (; received_count < vlen; ++received_count) {
+        // Only wait for the first message (if at all), then take whatever else is already queued up.
+        int message_flags = received_count == 0 ? flags : flags | MSG_DONTWAIT;
+        auto result = receive_message(*description, socket, (FlatPtr)&user_msgs[received_count].msg_hdr, message_flags);
+        if (result.is_error()) {
+            if (received_count == 0)
+                return result.release_error();
+            break;
+        }
+        unsigned message_length = result.value();
+        TRY(copy_to_user(&user_msgs[received_count].msg_len, &message_length));
+        if (message_length == 0 && socket.is_shut_down_for_reading())
+            break;
+    }
+    return received_count;
+}
+
 template<bool sockname, typename Params>
 ErrorOr<void> Process::get_sock_or_peer_name(const Params& params)
 {
@@ -154,6 +154,7 @@ class Thread
     friend class Process;
     friend class Scheduler;
     friend struct ThreadReadyQueue;
+    friend struct ThreadReadyQueues;
 
 public:
     inline static Thread* current()
@@ -846,6 +847,10 @@ public:
     State state() const { return m_state; }
     StringView state_string() const;
 
+    // What the thread blocked on most recently. Unlike state_string(), this doesn't need m_block_lock,
+    // but it's only meaningful while the thread is blocked.
+    StringView blocked_on() const { return m_blocked_on; }
+
     VirtualAddress thread_specific_data() const { return m_thread_specific_data; }
     size_t thread_specific_region_size() const;
     size_t thread_specific_region_alignment() const;
@@ -932,6 +937,7 @@ public:
 
         blocker.begin_blocking({});
 
+        m_blocked_on = blocker.state_string();
         set_state(Thread::Blocked);
 
         scheduler_lock.unlock();
@@ -1253,6 +1259,7 @@ private:
 
     IntrusiveListNode<Thread> m_process_thread_list_node;
     int m_runnable_priority { -1 };
+    u32 m_ready_queue_cpu { 0 };
 
     friend class WaitQueue;
 
@@ -1347,6 +1354,7 @@ private:
     Array<SignalActionData, NSIG> m_signal_action_data;
     Blocker* m_blocker { nullptr };
     Kernel::Mutex* m_blocking_lock { nullptr };
+    StringView m_blocked_on;
     u32 m_lock_requested_count { 0 };
     IntrusiveListNode<Thread> m_blocked_threads_list_node;
     LockRank m_lock_rank_mask { LockRank::None };
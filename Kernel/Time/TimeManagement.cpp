@@ -154,6 +154,8 @@ UNMAP_AFTER_INIT void TimeManagement::initialize(u32 cpu)
         }
 
         s_the->m_time_page_region = MM.allocate_kernel_region(PAGE_SIZE, "Time page"sv, Memory::Region::Access::ReadWrite, AllocationStrategy::AllocateNow).release_value();
+        // Userspace can only measure the time since the last update of the time page with the TSC if it always runs at the same rate.
+        s_the->m_time_page_can_use_tsc = Processor::current().has_feature(CPUFeature::NONSTOP_TSC);
     } else {
         VERIFY(s_the.is_initialized());
         if (auto* apic_timer = APIC::the().get_timer()) {
@@ -420,8 +422,12 @@ bool TimeManagement::enable_profile_timer()
 {
     if (!m_profile_timer)
         return false;
-    if (m_profile_enable_count.fetch_add(1) == 0)
-        return m_profile_timer->try_to_set_frequency(m_profile_timer->calculate_nearest_possible_frequency(OPTIMAL_PROFILE_TICKS_PER_SECOND_RATE));
+    if (m_profile_enable_count.fetch_add(1) == 0) {
+        auto frequency = m_profile_timer->calculate_nearest_possible_frequency(kernel_command_line().profiling_sample_rate());
+        if (!m_profile_timer->try_to_set_frequency(frequency))
+            return false;
+        m_profile_sample_rate = frequency;
+    }
     return true;
 }
 
@@ -434,12 +440,47 @@ bool TimeManagement::disable_profile_timer()
     return true;
 }
 
+void TimeManagement::calibrate_tsc(u64 tsc, Time now)
+{
+    // The TSC is measured against our own clock about once a second, so the time page follows any drift between the two.
+    if (m_tsc_calibration_start_tsc == 0) {
+        m_tsc_calibration_start_tsc = tsc;
+        m_tsc_calibration_start_time = now;
+        return;
+    }
+
+    i64 elapsed_ns = (now - m_tsc_calibration_start_time).to_nanoseconds();
+    if (elapsed_ns < 1'000'000'000)
+        return;
+
+    u64 elapsed_tsc = tsc - m_tsc_calibration_start_tsc;
+    // Past 4 seconds the nanoseconds don't fit into 32 bits anymore, so we'd overflow below. Just start over then.
+    if (elapsed_tsc > 0 && elapsed_ns < 4'000'000'000)
+        m_tsc_to_ns_multiplier = ((u64)elapsed_ns << 32) / elapsed_tsc;
+    m_tsc_calibration_start_tsc = tsc;
+    m_tsc_calibration_start_time = now;
+}
+
 void TimeManagement::update_time_page()
 {
     auto* page = time_page();
+    auto monotonic_timespec = monotonic_time(TimePrecision::Coarse).to_timespec();
+    u64 tsc = 0;
+    if (m_time_page_can_use_tsc) {
+        tsc = read_tsc();
+        calibrate_tsc(tsc, Time::from_timespec(monotonic_timespec));
+    }
+
     u32 update_iteration = AK::atomic_fetch_add(&page->update2, 1u, AK::MemoryOrder::memory_order_acquire);
     page->clocks[CLOCK_REALTIME_COARSE] = m_epoch_time;
-    page->clocks[CLOCK_MONOTONIC_COARSE] = monotonic_time(TimePrecision::Coarse).to_timespec();
+    page->clocks[CLOCK_MONOTONIC_COARSE] = monotonic_timespec;
+    // The precise clocks are the same as the coarse ones here, userspace adds the time since this update to them.
+    page->clocks[CLOCK_REALTIME] = m_epoch_time;
+    page->clocks[CLOCK_MONOTONIC] = monotonic_timespec;
+    page->clocks[CLOCK_MONOTONIC_RAW] = monotonic_timespec;
+    page->tsc_at_update = tsc;
+    page->tsc_to_ns_multiplier = m_tsc_to_ns_multiplier;
+    page->max_ns_since_update = 1'000'000'000 / m_time_keeper_timer->frequency() - 1;
     AK::atomic_store(&page->update1, update_iteration + 1u, AK::MemoryOrder::memory_order_release);
 }
 
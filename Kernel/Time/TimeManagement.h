@@ -60,6 +60,7 @@ public:
 
     bool enable_profile_timer();
     bool disable_profile_timer();
+    size_t profile_sample_rate() const { return m_profile_sample_rate; }
 
     u64 uptime_ms() const;
     static Time now();
@@ -78,6 +79,7 @@ public:
 private:
     TimePage* time_page();
     void update_time_page();
+    void calibrate_tsc(u64 tsc, Time now);
 
     bool probe_and_set_legacy_hardware_timers();
     bool probe_and_set_non_legacy_hardware_timers();
@@ -106,9 +108,15 @@ private:
     RefPtr<HardwareTimerBase> m_time_keeper_timer;
 
     Atomic<u32> m_profile_enable_count { 0 };
+    size_t m_profile_sample_rate { OPTIMAL_PROFILE_TICKS_PER_SECOND_RATE };
     RefPtr<HardwareTimerBase> m_profile_timer;
 
     OwnPtr<Memory::Region> m_time_page_region;
+    bool m_time_page_can_use_tsc { false };
+    // Only accessed from update_time_page(), which always runs on the same processor.
+    u64 m_tsc_calibration_start_tsc { 0 };
+    Time m_tsc_calibration_start_time;
+    u64 m_tsc_to_ns_multiplier { 0 };
 };
 
 }
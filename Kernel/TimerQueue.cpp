@@ -53,6 +53,32 @@ TimerQueue& TimerQueue::the()
 UNMAP_AFTER_INIT TimerQueue::TimerQueue()
 {
     m_ticks_per_second = TimeManagement::the().ticks_per_second();
+    VERIFY(m_ticks_per_second > 0);
+    m_nanoseconds_per_wheel_tick = 1'000'000'000 / static_cast<i64>(m_ticks_per_second);
+    m_timer_wheel.next_tick = wheel_tick_for(TimeManagement::the().current_time(CLOCK_MONOTONIC_COARSE));
+}
+
+bool TimerQueue::is_wheel_clock(clockid_t clock_id)
+{
+    switch (clock_id) {
+    case CLOCK_MONOTONIC:
+    case CLOCK_MONOTONIC_COARSE:
+    case CLOCK_MONOTONIC_RAW:
+        return true;
+    case CLOCK_REALTIME:
+    case CLOCK_REALTIME_COARSE:
+        return false;
+    default:
+        VERIFY_NOT_REACHED();
+    }
+}
+
+u64 TimerQueue::wheel_tick_for(Time const& time) const
+{
+    auto nanoseconds = time.to_nanoseconds();
+    if (nanoseconds <= 0)
+        return 0;
+    return static_cast<u64>(nanoseconds / m_nanoseconds_per_wheel_tick);
 }
 
 bool TimerQueue::add_timer_without_id(NonnullRefPtr<Timer> timer, clockid_t clock_id, const Time& deadline, Function<void()>&& callback)
@@ -92,7 +118,13 @@ void TimerQueue::add_timer_locked(NonnullRefPtr<Timer> timer)
     timer->clear_callback_finished();
     timer->set_in_use();
 
-    auto& queue = queue_for_timer(*timer);
+    if (is_wheel_clock(timer->m_clock_id)) {
+        add_timer_to_wheel_locked(timer.leak_ref());
+        ++m_timer_wheel.timer_count;
+        return;
+    }
+
+    auto& queue = m_timer_queue_realtime;
     if (queue.list.is_empty()) {
         queue.list.append(timer.leak_ref());
         queue.next_timer_due = timer_expiration;
@@ -115,6 +147,47 @@ void TimerQueue::add_timer_locked(NonnullRefPtr<Timer> timer)
     }
 }
 
+void TimerQueue::add_timer_to_wheel_locked(Timer& timer)
+{
+    VERIFY(g_timerqueue_lock.is_locked());
+    auto& wheel = m_timer_wheel;
+
+    // Timers that are already due go into the slot we look at next.
+    auto expiration_tick = max(wheel_tick_for(timer.m_expires), wheel.next_tick);
+    auto ticks_until_expiration = expiration_tick - wheel.next_tick;
+
+    for (size_t level = 0; level < TimerWheel::level_count; ++level) {
+        auto ticks_covered_by_level = 1ull << ((level + 1) * TimerWheel::slot_bits);
+        if (ticks_until_expiration >= ticks_covered_by_level) {
+            if (level != TimerWheel::level_count - 1)
+                continue;
+            expiration_tick = wheel.next_tick + ticks_covered_by_level - 1;
+        }
+        auto slot_index = (expiration_tick >> (level * TimerWheel::slot_bits)) & TimerWheel::slot_mask;
+        wheel.levels[level][slot_index].append(timer);
+        return;
+    }
+    VERIFY_NOT_REACHED();
+}
+
+void TimerQueue::cascade_wheel_locked()
+{
+    VERIFY(g_timerqueue_lock.is_locked());
+    auto& wheel = m_timer_wheel;
+
+    for (size_t level = 1; level < TimerWheel::level_count; ++level) {
+        auto level_shift = level * TimerWheel::slot_bits;
+        // Only cascade once everything below this level has gone all the way around.
+        if ((wheel.next_tick & ((1ull << level_shift) - 1)) != 0)
+            break;
+        auto& slot = wheel.levels[level][(wheel.next_tick >> level_shift) & TimerWheel::slot_mask];
+        while (auto* timer = slot.first()) {
+            slot.remove(*timer);
+            add_timer_to_wheel_locked(*timer);
+        }
+    }
+}
+
 bool TimerQueue::cancel_timer(Timer& timer, bool* was_in_use)
 {
     bool in_use = timer.is_in_use();
@@ -128,15 +201,15 @@ bool TimerQueue::cancel_timer(Timer& timer, bool* was_in_use)
     }
 
     bool did_already_run = timer.set_cancelled();
-    auto& timer_queue = queue_for_timer(timer);
     if (!did_already_run) {
         timer.clear_in_use();
 
         SpinlockLocker lock(g_timerqueue_lock);
-        if (timer_queue.list.contains(timer)) {
+        if (!m_timers_executing.contains(timer)) {
             // The timer has not fired, remove it
+            VERIFY(timer.is_queued());
             VERIFY(timer.ref_count() > 1);
-            remove_timer_locked(timer_queue, timer);
+            remove_timer_locked(timer);
             return true;
         }
 
@@ -145,7 +218,6 @@ bool TimerQueue::cancel_timer(Timer& timer, bool* was_in_use)
         // and we don't need to spin. It still holds a reference
         // that will be dropped when it does get a chance to run,
         // but since we called set_cancelled it will only drop its reference
-        VERIFY(m_timers_executing.contains(timer));
         m_timers_executing.remove(timer);
         return true;
     }
@@ -158,65 +230,111 @@ bool TimerQueue::cancel_timer(Timer& timer, bool* was_in_use)
     return false;
 }
 
-void TimerQueue::remove_timer_locked(Queue& queue, Timer& timer)
+void TimerQueue::remove_timer_locked(Timer& timer)
 {
-    bool was_next_timer = (queue.list.first() == &timer);
-    queue.list.remove(timer);
+    if (is_wheel_clock(timer.m_clock_id)) {
+        // We don't need to know which slot the timer is in to unlink it.
+        timer.m_list_node.remove();
+        --m_timer_wheel.timer_count;
+    } else {
+        auto& queue = m_timer_queue_realtime;
+        bool was_next_timer = (queue.list.first() == &timer);
+        queue.list.remove(timer);
+        if (was_next_timer)
+            update_next_timer_due(queue);
+    }
+
     auto now = timer.now(false);
     if (timer.m_expires > now)
         timer.m_remaining = timer.m_expires - now;
 
-    if (was_next_timer)
-        update_next_timer_due(queue);
     // Whenever we remove a timer that was still queued (but hasn't been
     // fired) we added a reference to it. So, when removing it from the
     // queue we need to drop that reference.
     timer.unref();
 }
 
-void TimerQueue::fire()
+void TimerQueue::execute_timer_locked(SpinlockLocker<Spinlock>& lock, Timer& timer)
 {
-    SpinlockLocker lock(g_timerqueue_lock);
-
-    auto fire_timers = [&](Queue& queue) {
-        auto* timer = queue.list.first();
-        VERIFY(timer);
-        VERIFY(queue.next_timer_due == timer->m_expires);
+    VERIFY(!timer.is_queued());
+    m_timers_executing.append(timer);
+
+    lock.unlock();
+
+    // Defer executing the timer outside of the irq handler
+    Processor::deferred_call_queue([this, timer = &timer]() {
+        // Check if we were cancelled in between being triggered
+        // by the timer irq handler and now. If so, just drop
+        // our reference and don't execute the callback.
+        if (!timer->set_cancelled()) {
+            timer->m_callback();
+            SpinlockLocker lock(g_timerqueue_lock);
+            m_timers_executing.remove(*timer);
+        }
+        timer->clear_in_use();
+        timer->set_callback_finished();
+        // Drop the reference we added when queueing the timer
+        timer->unref();
+    });
 
-        while (timer && timer->now(true) > timer->m_expires) {
-            queue.list.remove(*timer);
+    lock.lock();
+}
 
-            m_timers_executing.append(*timer);
+void TimerQueue::fire_wheel_slot_locked(SpinlockLocker<Spinlock>& lock, Timer::List& slot, Timer::List& not_yet_due)
+{
+    while (auto* timer = slot.first()) {
+        slot.remove(*timer);
+        if (timer->now(true) <= timer->m_expires) {
+            not_yet_due.append(*timer);
+            continue;
+        }
+        --m_timer_wheel.timer_count;
+        execute_timer_locked(lock, *timer);
+    }
+}
 
-            update_next_timer_due(queue);
+void TimerQueue::fire()
+{
+    SpinlockLocker lock(g_timerqueue_lock);
 
-            lock.unlock();
-
-            // Defer executing the timer outside of the irq handler
-            Processor::deferred_call_queue([this, timer]() {
-                // Check if we were cancelled in between being triggered
-                // by the timer irq handler and now. If so, just drop
-                // our reference and don't execute the callback.
-                if (!timer->set_cancelled()) {
-                    timer->m_callback();
-                    SpinlockLocker lock(g_timerqueue_lock);
-                    m_timers_executing.remove(*timer);
-                }
-                timer->clear_in_use();
-                timer->set_callback_finished();
-                // Drop the reference we added when queueing the timer
-                timer->unref();
-            });
-
-            lock.lock();
-            timer = queue.list.first();
+    auto& wheel = m_timer_wheel;
+    auto current_tick = wheel_tick_for(TimeManagement::the().current_time(CLOCK_MONOTONIC_COARSE));
+
+    // The slot for the current tick may also hold timers that expire later during this tick, and timers
+    // on a clock other than the one we use to advance the wheel may run slightly behind it. We set those
+    // aside while we fire the others (every fired timer drops the lock), and put them back at the end.
+    Timer::List not_yet_due;
+    for (;;) {
+        if (wheel.timer_count == 0) {
+            // With nothing in the wheel, there is nothing to cascade either.
+            wheel.next_tick = max(wheel.next_tick, current_tick);
+            break;
         }
-    };
+        fire_wheel_slot_locked(lock, wheel.levels[0][wheel.next_tick & TimerWheel::slot_mask], not_yet_due);
+        if (wheel.next_tick >= current_tick)
+            break;
+        ++wheel.next_tick;
+        cascade_wheel_locked();
+    }
+    while (auto* timer = not_yet_due.first()) {
+        not_yet_due.remove(*timer);
+        add_timer_to_wheel_locked(*timer);
+    }
+
+    auto& queue = m_timer_queue_realtime;
+    if (queue.list.is_empty())
+        return;
 
-    if (!m_timer_queue_monotonic.list.is_empty())
-        fire_timers(m_timer_queue_monotonic);
-    if (!m_timer_queue_realtime.list.is_empty())
-        fire_timers(m_timer_queue_realtime);
+    auto* timer = queue.list.first();
+    VERIFY(timer);
+    VERIFY(queue.next_timer_due == timer->m_expires);
+
+    while (timer && timer->now(true) > timer->m_expires) {
+        queue.list.remove(*timer);
+        update_next_timer_due(queue);
+        execute_timer_locked(lock, *timer);
+        timer = queue.list.first();
+    }
 }
 
 void TimerQueue::update_next_timer_due(Queue& queue)
@@ -6,12 +6,14 @@
 
 #pragma once
 
+#include <AK/Array.h>
 #include <AK/Function.h>
 #include <AK/IntrusiveList.h>
 #include <AK/NonnullRefPtr.h>
 #include <AK/OwnPtr.h>
 #include <AK/RefCounted.h>
 #include <AK/Time.h>
+#include <Kernel/Locking/Spinlock.h>
 #include <Kernel/Time/TimeManagement.h>
 
 namespace Kernel {
@@ -93,32 +95,45 @@ public:
     void fire();
 
 private:
+    // Realtime timers are kept in a list sorted by expiration time, since the realtime
+    // clock can be set to an arbitrary time and we'd have to rebuild a wheel when it is.
     struct Queue {
         Timer::List list;
         Time next_timer_due {};
     };
-    void remove_timer_locked(Queue&, Timer&);
+
+    // Monotonic timers live in a hierarchical timer wheel, which makes adding and cancelling
+    // them O(1) no matter how many are pending. Each slot on level N covers 64^N ticks of the
+    // system timer. Whenever the lower levels have gone all the way around, the next slot of
+    // the level above is cascaded down. Timers too far out for the top level are parked in its
+    // furthest slot and find their place again when that slot cascades.
+    struct TimerWheel {
+        static constexpr size_t level_count = 4;
+        static constexpr size_t slot_bits = 6;
+        static constexpr size_t slots_per_level = 1 << slot_bits;
+        static constexpr u64 slot_mask = slots_per_level - 1;
+
+        Array<Array<Timer::List, slots_per_level>, level_count> levels;
+        // The first tick whose level 0 slot may still hold timers.
+        u64 next_tick { 0 };
+        size_t timer_count { 0 };
+    };
+
+    static bool is_wheel_clock(clockid_t);
+
+    void remove_timer_locked(Timer&);
     void update_next_timer_due(Queue&);
     void add_timer_locked(NonnullRefPtr<Timer>);
-
-    Queue& queue_for_timer(Timer& timer)
-    {
-        switch (timer.m_clock_id) {
-        case CLOCK_MONOTONIC:
-        case CLOCK_MONOTONIC_COARSE:
-        case CLOCK_MONOTONIC_RAW:
-            return m_timer_queue_monotonic;
-        case CLOCK_REALTIME:
-        case CLOCK_REALTIME_COARSE:
-            return m_timer_queue_realtime;
-        default:
-            VERIFY_NOT_REACHED();
-        }
-    }
+    void add_timer_to_wheel_locked(Timer&);
+    void cascade_wheel_locked();
+    void fire_wheel_slot_locked(SpinlockLocker<Spinlock>&, Timer::List& slot, Timer::List& not_yet_due);
+    void execute_timer_locked(SpinlockLocker<Spinlock>&, Timer&);
+    u64 wheel_tick_for(Time const&) const;
 
     u64 m_timer_id_count { 0 };
     u64 m_ticks_per_second { 0 };
-    Queue m_timer_queue_monotonic;
+    i64 m_nanoseconds_per_wheel_tick { 0 };
+    TimerWheel m_timer_wheel;
     Queue m_timer_queue_realtime;
     Timer::List m_timers_executing;
 };
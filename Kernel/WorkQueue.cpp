@@ -5,6 +5,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <Kernel/Arch/Processor.h>
 #include <Kernel/Process.h>
 #include <Kernel/Sections.h>
 #include <Kernel/WaitQueue.h>
@@ -16,43 +17,58 @@ WorkQueue* g_io_work;
 
 UNMAP_AFTER_INIT void WorkQueue::initialize()
 {
+    // This has to happen after the APs have been brought up, as we need to know how many
+    // processors there are to create a worker thread for each of them.
     g_io_work = new WorkQueue("IO WorkQueue");
 }
 
 UNMAP_AFTER_INIT WorkQueue::WorkQueue(StringView name)
 {
-    RefPtr<Thread> thread;
-    auto name_kstring = KString::try_create(name);
-    if (name_kstring.is_error())
-        TODO();
-    (void)Process::create_kernel_process(thread, name_kstring.release_value(), [this] {
-        for (;;) {
-            WorkItem* item;
-            bool have_more;
-            m_items.with([&](auto& items) {
-                item = items.take_first();
-                have_more = !items.is_empty();
-            });
-            if (item) {
-                item->function();
-                delete item;
-
-                if (have_more)
-                    continue;
-            }
-            [[maybe_unused]] auto result = m_wait_queue.wait_on({});
+    auto processor_count = Processor::count();
+    m_workers.ensure_capacity(processor_count);
+    for (u32 cpu = 0; cpu < processor_count; ++cpu) {
+        m_workers.unchecked_append(make<Worker>());
+        auto& worker = m_workers.last();
+        RefPtr<Thread> thread;
+        auto name_kstring = KString::formatted("{} #{}", name, cpu);
+        if (name_kstring.is_error())
+            TODO();
+        (void)Process::create_kernel_process(
+            thread, name_kstring.release_value(), [this, &worker] { run_worker(worker); }, 1u << cpu);
+        // If we can't create the thread we're in trouble...
+        worker.thread = thread.release_nonnull();
+    }
+}
+
+void WorkQueue::run_worker(Worker& worker)
+{
+    for (;;) {
+        // Take everything that has been queued so far in one go, so that a burst of
+        // completions only costs us a single trip through the lock and the wait queue.
+        WorkItemList batch;
+        worker.items.with([&](auto& items) {
+            while (auto* item = items.take_first())
+                batch.append(*item);
+        });
+        if (batch.is_empty()) {
+            [[maybe_unused]] auto result = worker.wait_queue.wait_on({});
+            continue;
         }
-    });
-    // If we can't create the thread we're in trouble...
-    m_thread = thread.release_nonnull();
+        while (auto* item = batch.take_first()) {
+            item->function();
+            delete item;
+        }
+    }
 }
 
 void WorkQueue::do_queue(WorkItem* item)
 {
-    m_items.with([&](auto& items) {
+    auto cpu = Processor::current_id();
+    auto& worker = cpu < m_workers.size() ? m_workers[cpu] : m_workers.first();
+    worker.items.with([&](auto& items) {
         items.append(*item);
     });
-    m_wait_queue.wake_one();
+    worker.wait_queue.wake_one();
 }
 
 }
@@ -8,6 +8,7 @@
 #pragma once
 
 #include <AK/IntrusiveList.h>
+#include <AK/NonnullOwnPtrVector.h>
 #include <Kernel/Forward.h>
 #include <Kernel/Locking/SpinlockProtected.h>
 #include <Kernel/WaitQueue.h>
@@ -51,11 +52,20 @@ private:
         Function<void()> function;
     };
 
+    using WorkItemList = IntrusiveList<&WorkItem::m_node>;
+
+    // Every processor has its own worker thread, pinned to that processor, so that work
+    // queued from an interrupt handler runs where the interrupt was taken.
+    struct Worker {
+        RefPtr<Thread> thread;
+        WaitQueue wait_queue;
+        SpinlockProtected<WorkItemList> items;
+    };
+
     void do_queue(WorkItem*);
+    void run_worker(Worker&);
 
-    RefPtr<Thread> m_thread;
-    WaitQueue m_wait_queue;
-    SpinlockProtected<IntrusiveList<&WorkItem::m_node>> m_items;
+    NonnullOwnPtrVector<Worker> m_workers;
 };
 
 }
@@ -38,6 +38,7 @@
 #include <Kernel/Interrupts/InterruptManagement.h>
 #include <Kernel/Interrupts/PIC.h>
 #include <Kernel/KSyms.h>
+#include <Kernel/Locking/SysFSLocking.h>
 #include <Kernel/Memory/MemoryManager.h>
 #include <Kernel/Multiboot.h>
 #include <Kernel/Net/NetworkTask.h>
@@ -274,8 +275,6 @@ void init_stage2(void*)
     // The colonel process gets away without having to do this because it never exits.
     Process::register_new(Process::current());
 
-    WorkQueue::initialize();
-
     if (kernel_command_line().is_smp_enabled() && APIC::initialized() && APIC::the().enabled_processor_count() > 1) {
         // We can't start the APs until we have a scheduler up and running.
         // We need to be able to process ICI messages, otherwise another
@@ -284,6 +283,8 @@ void init_stage2(void*)
         APIC::the().boot_aps();
     }
 
+    WorkQueue::initialize();
+
     // Initialize the PCI Bus as early as possible, for early boot (PCI based) serial logging
     PCI::initialize();
     PCISerialDevice::detect();
@@ -309,6 +310,7 @@ void init_stage2(void*)
 
     USB::USBManagement::initialize();
     FirmwareSysFSDirectory::initialize();
+    LockingSysFSDirectory::initialize();
 
     VirtIO::detect();
 
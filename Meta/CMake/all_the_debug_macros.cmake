@@ -15,6 +15,7 @@ set(CHTTPJOB_DEBUG ON)
 set(CNETWORKJOB_DEBUG ON)
 set(COMMIT_DEBUG ON)
 set(COMPOSE_DEBUG ON)
+set(COMPRESSED_PAGE_DEBUG ON)
 set(CONTEXT_SWITCH_DEBUG ON)
 set(CONTIGUOUS_VMOBJECT_DEBUG ON)
 set(COPY_DEBUG ON)
@@ -55,7 +56,6 @@ set(EXT2_VERY_DEBUG ON)
 set(FILE_CONTENT_DEBUG ON)
 set(FILEDESCRIPTION_DEBUG ON)
 set(FILE_WATCHER_DEBUG ON)
-set(FILL_PATH_DEBUG ON)
 set(FORK_DEBUG ON)
 set(FRAMEBUFFER_DEVICE_DEBUG ON)
 set(FUTEX_DEBUG ON)
@@ -76,6 +76,7 @@ set(HIGHLIGHT_FOCUSED_FRAME_DEBUG ON)
 set(HPET_COMPARATOR_DEBUG ON)
 set(HPET_DEBUG ON)
 set(HTML_SCRIPT_DEBUG ON)
+set(HTTP2_DEBUG ON)
 set(HTTPSJOB_DEBUG ON)
 set(HUNKS_DEBUG ON)
 set(ICMP_DEBUG ON)
@@ -418,11 +418,10 @@ public:
             message_generator.append(R"~~~(
     virtual bool valid() const override { return m_ipc_message_valid; }
 
-    virtual IPC::MessageBuffer encode() const override
+    virtual void encode_into(IPC::MessageBuffer& buffer) const override
     {
         VERIFY(valid());
 
-        IPC::MessageBuffer buffer;
         IPC::Encoder stream(buffer);
         stream << endpoint_magic();
         stream << (int)MessageID::@message.pascal_name@;
@@ -438,7 +437,6 @@ public:
             }
 
             message_generator.append(R"~~~(
-        return buffer;
     }
 )~~~");
 
@@ -762,7 +760,9 @@ public:
             [[maybe_unused]] auto& request = static_cast<const Messages::@endpoint.name@::@message.pascal_name@&>(message);
             @handler_name@(@arguments@);
             auto response = Messages::@endpoint.name@::@message.response_type@ { };
-            return make<IPC::MessageBuffer>(response.encode());
+            auto buffer = make<IPC::MessageBuffer>();
+            response.encode_into(*buffer);
+            return buffer;
 )~~~");
                     } else {
                         message_generator.append(R"~~~(
@@ -770,7 +770,9 @@ public:
             auto response = @handler_name@(@arguments@);
             if (!response.valid())
                 return {};
-            return make<IPC::MessageBuffer>(response.encode());
+            auto buffer = make<IPC::MessageBuffer>();
+            response.encode_into(*buffer);
+            return buffer;
 )~~~");
                     }
                 } else {
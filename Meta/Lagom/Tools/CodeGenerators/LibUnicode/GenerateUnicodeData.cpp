@@ -10,6 +10,7 @@
 #include <AK/CharacterTypes.h>
 #include <AK/Find.h>
 #include <AK/HashMap.h>
+#include <AK/NumericLimits.h>
 #include <AK/Optional.h>
 #include <AK/QuickSort.h>
 #include <AK/SourceGenerator.h>
@@ -609,6 +610,19 @@ struct SpecialCasing {
     VERIFY(file.write(generator.as_string_view()));
 }
 
+// Code points are looked up in two stages: The upper bits of a code point pick one of the blocks of the second stage, in which
+// the lower bits pick the value. Blocks that repeat (e.g. the many unassigned ones) are only stored once.
+static constexpr u32 max_code_point = 0x10ffff;
+static constexpr u32 code_point_block_bits = 8;
+static constexpr u32 code_point_block_size = 1u << code_point_block_bits;
+static constexpr u32 code_point_block_count = (max_code_point + 1) / code_point_block_size;
+
+template<typename T>
+static String span_as_key(Span<T const> values)
+{
+    return String { ReadonlyBytes { reinterpret_cast<u8 const*>(values.data()), values.size() * sizeof(T) } };
+}
+
 static void generate_unicode_data_implementation(Core::File& file, UnicodeData const& unicode_data)
 {
     StringBuilder builder;
@@ -749,81 +763,125 @@ static constexpr Array<@mapping_type@, @size@> s_@name@_mappings { {
     append_code_point_mappings("lowercase"sv, "CodePointMapping"sv, unicode_data.simple_lowercase_mapping_size, [](auto const& data) { return data.simple_lowercase_mapping; });
     append_code_point_mappings("special_case"sv, "SpecialCaseMapping"sv, unicode_data.code_points_with_special_casing, [](auto const& data) { return data.special_casing_indices; });
 
-    generator.append(R"~~~(
-struct CodePointRange {
-    u32 first { 0 };
-    u32 last { 0 };
-};
+    auto append_values = [&](auto const& values) {
+        constexpr size_t max_values_per_row = 32;
+        size_t values_in_current_row = 0;
 
-struct CodePointRangeComparator {
-    constexpr int operator()(u32 code_point, CodePointRange const& range)
-    {
-        return (code_point > range.last) - (code_point < range.first);
-    }
-};
-
-)~~~");
+        for (auto value : values) {
+            if (values_in_current_row++ > 0)
+                generator.append(" ");
 
-    auto append_code_point_range_list = [&](String name, Vector<CodePointRange> const& ranges) {
-        generator.set("name", name);
-        generator.set("size", String::number(ranges.size()));
-        generator.append(R"~~~(
-static constexpr Array<CodePointRange, @size@> @name@ { {
-    )~~~");
+            generator.set("value", String::number(value));
+            generator.append("@value@,");
 
-        constexpr size_t max_ranges_per_row = 20;
-        size_t ranges_in_current_row = 0;
+            if (values_in_current_row == max_values_per_row) {
+                values_in_current_row = 0;
+                generator.append("\n    ");
+            }
+        }
+    };
 
-        for (auto const& range : ranges) {
-            if (ranges_in_current_row++ > 0)
-                generator.append(" ");
+    // Every code point is mapped to the set of values (e.g. general categories) it has, which is stored as a bitmap
+    // indexed by the values' enum. There are far fewer distinct sets than code points, so the tables hold set indices.
+    auto append_code_point_tables = [&](StringView collection_name, PropList const& property_list) {
+        auto property_names = property_list.keys();
+        quick_sort(property_names);
 
-            generator.set("first", String::formatted("{:#x}", range.first));
-            generator.set("last", String::formatted("{:#x}", range.last));
-            generator.append("{ @first@, @last@ },");
+        auto words_per_set = ceil_div(property_names.size(), static_cast<size_t>(64));
+        Vector<u64> code_point_sets;
+        code_point_sets.resize((max_code_point + 1) * words_per_set);
 
-            if (ranges_in_current_row == max_ranges_per_row) {
-                ranges_in_current_row = 0;
-                generator.append("\n    ");
+        for (size_t index = 0; index < property_names.size(); ++index) {
+            for (auto const& range : property_list.find(property_names[index])->value) {
+                for (u32 code_point = range.first; code_point <= range.last; ++code_point)
+                    code_point_sets[code_point * words_per_set + index / 64] |= static_cast<u64>(1) << (index % 64);
             }
         }
 
-        generator.append(R"~~~(
-} };
-)~~~");
-    };
+        HashMap<String, size_t> unique_set_indices;
+        Vector<Span<u64 const>> unique_sets;
+        HashMap<String, size_t> unique_block_indices;
+        Vector<u32> unique_blocks;
+        Vector<size_t> stage1;
+
+        for (u32 block = 0; block < code_point_block_count; ++block) {
+            Vector<u32> block_set_indices;
+            block_set_indices.ensure_capacity(code_point_block_size);
+
+            for (u32 code_point = block << code_point_block_bits; code_point < (block + 1) << code_point_block_bits; ++code_point) {
+                auto set = code_point_sets.span().slice(code_point * words_per_set, words_per_set);
+                auto set_index = unique_set_indices.ensure(span_as_key<u64>(set), [&]() -> size_t {
+                    unique_sets.append(set);
+                    return unique_sets.size() - 1;
+                });
+                block_set_indices.unchecked_append(set_index);
+            }
 
-    auto append_prop_list = [&](StringView collection_name, StringView property_format, PropList const& property_list) {
-        for (auto const& property : property_list) {
-            auto name = String::formatted(property_format, property.key);
-            append_code_point_range_list(move(name), property.value);
+            auto block_index = unique_block_indices.ensure(span_as_key<u32>(block_set_indices), [&]() -> size_t {
+                unique_blocks.extend(block_set_indices);
+                return unique_blocks.size() / code_point_block_size - 1;
+            });
+            stage1.append(block_index);
         }
 
-        auto property_names = property_list.keys();
-        quick_sort(property_names);
+        VERIFY(unique_blocks.size() / code_point_block_size <= NumericLimits<u16>::max() + 1);
+        VERIFY(unique_sets.size() <= NumericLimits<u16>::max() + 1);
 
         generator.set("name", collection_name);
-        generator.set("size", String::number(property_names.size()));
+        generator.set("words_per_set", String::number(words_per_set));
+        generator.set("set_count", String::number(unique_sets.size()));
         generator.append(R"~~~(
-static constexpr Array<Span<CodePointRange const>, @size@> @name@ { {)~~~");
+static constexpr Array<Array<u64, @words_per_set@>, @set_count@> @name@_sets { {)~~~");
 
-        for (auto const& property_name : property_names) {
-            generator.set("name", String::formatted(property_format, property_name));
-            generator.append(R"~~~(
-    @name@.span(),)~~~");
+        for (auto const& set : unique_sets) {
+            generator.append("\n    { {");
+            for (auto word : set) {
+                generator.set("word", String::formatted("{:#x}", word));
+                generator.append(" @word@,");
+            }
+            generator.append(" } },");
         }
 
+        generator.set("stage1_size", String::number(stage1.size()));
+        generator.append(R"~~~(
+} };
+
+static constexpr Array<u16, @stage1_size@> @name@_stage1 { {
+    )~~~");
+        append_values(stage1);
+
+        generator.set("stage2_type", unique_sets.size() <= NumericLimits<u8>::max() + 1 ? "u8"sv : "u16"sv);
+        generator.set("stage2_size", String::number(unique_blocks.size()));
+        generator.append(R"~~~(
+} };
+
+static constexpr Array<@stage2_type@, @stage2_size@> @name@_stage2 { {
+    )~~~");
+        append_values(unique_blocks);
+
         generator.append(R"~~~(
 } };
 )~~~");
     };
 
-    append_prop_list("s_general_categories"sv, "s_general_category_{}"sv, unicode_data.general_categories);
-    append_prop_list("s_properties"sv, "s_property_{}"sv, unicode_data.prop_list);
-    append_prop_list("s_scripts"sv, "s_script_{}"sv, unicode_data.script_list);
-    append_prop_list("s_script_extensions"sv, "s_script_extension_{}"sv, unicode_data.script_extensions);
+    append_code_point_tables("s_general_categories"sv, unicode_data.general_categories);
+    append_code_point_tables("s_properties"sv, unicode_data.prop_list);
+    append_code_point_tables("s_scripts"sv, unicode_data.script_list);
+    append_code_point_tables("s_script_extensions"sv, unicode_data.script_extensions);
 
     generator.append(R"~~~(
+struct CodePointRange {
+    u32 first { 0 };
+    u32 last { 0 };
+};
+
+struct CodePointRangeComparator {
+    constexpr int operator()(u32 code_point, CodePointRange const& range)
+    {
+        return (code_point > range.last) - (code_point < range.first);
+    }
+};
+
 struct CodePointName {
     CodePointRange code_point_range {};
     StringView display_name;
@@ -865,22 +923,37 @@ Optional<String> code_point_display_name(u32 code_point)
 }
 )~~~");
 
-    auto append_code_point_mapping_search = [&](StringView method, StringView mappings, StringView fallback) {
+    // Most text is ASCII, so the lookups skip the binary search for ASCII code points where they can.
+    auto append_code_point_mapping_search = [&](StringView method, StringView mappings, StringView fallback, StringView ascii_mapping) {
         generator.set("method", method);
         generator.set("mappings", mappings);
         generator.set("fallback", fallback);
+        generator.set("ascii_mapping", ascii_mapping);
         generator.append(R"~~~(
 u32 @method@(u32 code_point)
 {
+    if (is_ascii(code_point))
+        return @ascii_mapping@;
+
     auto const* mapping = binary_search(@mappings@, code_point, nullptr, CodePointComparator<CodePointMapping> {});
     return mapping ? mapping->mapping : @fallback@;
 }
 )~~~");
     };
 
-    append_code_point_mapping_search("canonical_combining_class"sv, "s_combining_class_mappings"sv, "0"sv);
-    append_code_point_mapping_search("to_unicode_uppercase"sv, "s_uppercase_mappings"sv, "code_point"sv);
-    append_code_point_mapping_search("to_unicode_lowercase"sv, "s_lowercase_mappings"sv, "code_point"sv);
+    // The ASCII fast paths here and in the full string case mappings rely on ASCII code points not being special.
+    VERIFY(all_of(unicode_data.code_point_data, [](auto const& data) {
+        if (!is_ascii(data.code_point))
+            return true;
+        return data.canonical_combining_class == 0
+            && data.simple_uppercase_mapping.value_or(data.code_point) == to_ascii_uppercase(data.code_point)
+            && data.simple_lowercase_mapping.value_or(data.code_point) == to_ascii_lowercase(data.code_point);
+    }));
+    VERIFY(all_of(unicode_data.special_casing, [](auto const& casing) { return !is_ascii(casing.code_point) || !casing.locale.is_empty(); }));
+
+    append_code_point_mapping_search("canonical_combining_class"sv, "s_combining_class_mappings"sv, "0"sv, "0"sv);
+    append_code_point_mapping_search("to_unicode_uppercase"sv, "s_uppercase_mappings"sv, "code_point"sv, "to_ascii_uppercase(code_point)"sv);
+    append_code_point_mapping_search("to_unicode_lowercase"sv, "s_lowercase_mappings"sv, "code_point"sv, "to_ascii_lowercase(code_point)"sv);
 
     generator.append(R"~~~(
 Span<SpecialCasing const* const> special_case_mapping(u32 code_point)
@@ -893,6 +966,10 @@ Span<SpecialCasing const* const> special_case_mapping(u32 code_point)
 }
 )~~~");
 
+    generator.set("max_code_point", String::formatted("{:#x}", max_code_point));
+    generator.set("block_bits", String::number(code_point_block_bits));
+    generator.set("block_mask", String::formatted("{:#x}", code_point_block_size - 1));
+
     auto append_prop_search = [&](StringView enum_title, StringView enum_snake, StringView collection_name) {
         generator.set("enum_title", enum_title);
         generator.set("enum_snake", enum_snake);
@@ -900,11 +977,13 @@ Span<SpecialCasing const* const> special_case_mapping(u32 code_point)
         generator.append(R"~~~(
 bool code_point_has_@enum_snake@(u32 code_point, @enum_title@ @enum_snake@)
 {
-    auto index = static_cast<@enum_title@UnderlyingType>(@enum_snake@);
-    auto const& ranges = @collection_name@.at(index);
+    if (code_point > @max_code_point@)
+        return false;
 
-    auto const* range = binary_search(ranges, code_point, nullptr, CodePointRangeComparator {});
-    return range != nullptr;
+    auto index = static_cast<@enum_title@UnderlyingType>(@enum_snake@);
+    u32 block = @collection_name@_stage1[code_point >> @block_bits@];
+    auto set = @collection_name@_stage2[(block << @block_bits@) | (code_point & @block_mask@)];
+    return ((@collection_name@_sets[set][index / 64] >> (index % 64)) & 1) != 0;
 }
 )~~~");
     };
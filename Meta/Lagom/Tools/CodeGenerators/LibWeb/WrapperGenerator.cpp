@@ -1544,6 +1544,12 @@ public:
 )~~~");
     }
 
+    if (interface.extended_attributes.contains("CustomGet") || interface.extended_attributes.contains("CustomSet") || interface.is_legacy_platform_object()) {
+        generator.append(R"~~~(
+    virtual bool may_cache_property_lookups() const override { return false; }
+)~~~");
+    }
+
     if (interface.wrapper_base_class == "Wrapper") {
         generator.append(R"~~~(
     @fully_qualified_name@& impl() { return *m_impl; }
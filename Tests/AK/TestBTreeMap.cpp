@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/Array.h>
+#include <AK/BTreeMap.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Random.h>
+#include <AK/RedBlackTree.h>
+
+TEST_CASE(construct)
+{
+    BTreeMap<int, int> empty;
+    EXPECT(empty.is_empty());
+    EXPECT(empty.size() == 0);
+    EXPECT(empty.begin() == empty.end());
+}
+
+TEST_CASE(ints)
+{
+    BTreeMap<int, int> ints;
+    ints.insert(1, 10);
+    ints.insert(3, 20);
+    ints.insert(2, 30);
+    EXPECT_EQ(ints.size(), 3u);
+    EXPECT_EQ(*ints.find(3), 20);
+    EXPECT_EQ(*ints.find(2), 30);
+    EXPECT_EQ(*ints.find(1), 10);
+    EXPECT(!ints.remove(4));
+    EXPECT(ints.remove(2));
+    EXPECT(ints.remove(1));
+    EXPECT(ints.remove(3));
+    EXPECT_EQ(ints.size(), 0u);
+}
+
+TEST_CASE(insert_replaces_existing_value)
+{
+    BTreeMap<int, int> ints;
+    ints.insert(1, 10);
+    ints.insert(1, 20);
+    EXPECT_EQ(ints.size(), 1u);
+    EXPECT_EQ(*ints.find(1), 20);
+}
+
+TEST_CASE(largest_not_above_and_smallest_not_below)
+{
+    BTreeMap<int, int> ints;
+    for (int i = 0; i < 1000; ++i)
+        ints.insert(i * 10 + 1, i);
+    EXPECT_EQ(*ints.find_largest_not_above(3), 0);
+    EXPECT_EQ(*ints.find_largest_not_above(11), 1);
+    EXPECT_EQ(*ints.find_largest_not_above(5000), 499);
+    EXPECT_EQ(*ints.find_largest_not_above(100000), 999);
+    EXPECT_EQ(ints.find_largest_not_above(-5), nullptr);
+
+    EXPECT_EQ(ints.find_smallest_not_below_iterator(-5).key(), 1);
+    EXPECT_EQ(ints.find_smallest_not_below_iterator(11).key(), 11);
+    EXPECT_EQ(ints.find_smallest_not_below_iterator(4992).key(), 5001);
+    EXPECT(ints.find_smallest_not_below_iterator(9992).is_end());
+}
+
+TEST_CASE(range_iteration)
+{
+    BTreeMap<int, int> ints;
+    for (int i = 0; i < 1000; ++i)
+        ints.insert(i, i);
+
+    int expected = 250;
+    for (auto it = ints.find_smallest_not_below_iterator(250); !it.is_end() && it.key() < 750; ++it)
+        EXPECT_EQ(*it, expected++);
+    EXPECT_EQ(expected, 750);
+
+    auto it = ints.begin_from(500);
+    for (int i = 500; i > 0; --i)
+        --it;
+    EXPECT(it.is_begin());
+    EXPECT_EQ(*it, 0);
+}
+
+TEST_CASE(key_ordered_iteration)
+{
+    constexpr auto amount = 10000;
+    BTreeMap<int, size_t> test;
+    Array<int, amount> keys {};
+
+    for (int i = 0; i < amount; i++)
+        keys[i] = i;
+    for (size_t i = 0; i < amount; i++)
+        swap(keys[i], keys[get_random<size_t>() % amount]);
+
+    for (size_t i = 0; i < amount; i++)
+        test.insert(keys[i], keys[i]);
+
+    size_t index = 0;
+    for (auto& value : test)
+        EXPECT(value == index++);
+    EXPECT_EQ(index, static_cast<size_t>(amount));
+
+    for (size_t i = 0; i < amount; i++)
+        EXPECT(test.remove(keys[i]));
+    EXPECT(test.is_empty());
+}
+
+TEST_CASE(random_operations_match_red_black_tree)
+{
+    BTreeMap<u32, u32> btree;
+    RedBlackTree<u32, u32> reference;
+
+    for (size_t i = 0; i < 50000; ++i) {
+        u32 key = get_random<u32>() % 4096;
+        if (get_random<u32>() % 3 == 0) {
+            EXPECT_EQ(btree.remove(key), reference.remove(key));
+        } else if (!reference.find(key)) {
+            btree.insert(key, i);
+            reference.insert(key, i);
+        }
+    }
+
+    EXPECT_EQ(btree.size(), reference.size());
+    auto it = btree.begin();
+    for (auto reference_it = reference.begin(); reference_it != reference.end(); ++reference_it, ++it) {
+        EXPECT(!it.is_end());
+        EXPECT_EQ(it.key(), reference_it.key());
+        EXPECT_EQ(*it, *reference_it);
+    }
+    EXPECT(it.is_end());
+
+    for (u32 key = 0; key < 4096; ++key) {
+        auto* value = btree.find_largest_not_above(key);
+        auto* reference_value = reference.find_largest_not_above(key);
+        EXPECT_EQ(value == nullptr, reference_value == nullptr);
+        if (value && reference_value)
+            EXPECT_EQ(*value, *reference_value);
+    }
+}
+
+TEST_CASE(owned_values)
+{
+    BTreeMap<size_t, NonnullOwnPtr<size_t>> test;
+    for (size_t i = 0; i < 1000; i++)
+        test.insert(i, make<size_t>(i));
+
+    auto value = test.unsafe_remove(500);
+    EXPECT_EQ(*value, 500u);
+    EXPECT_EQ(test.size(), 999u);
+    EXPECT_EQ(**test.find(501), 501u);
+}
+
+TEST_CASE(clear)
+{
+    BTreeMap<size_t, size_t> test;
+    for (size_t i = 0; i < 1000; i++)
+        test.insert(i, i);
+    test.clear();
+    EXPECT_EQ(test.size(), 0u);
+    EXPECT(test.begin().is_end());
+}
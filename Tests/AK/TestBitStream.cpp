@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/BitStream.h>
+#include <AK/MemoryStream.h>
+
+TEST_CASE(read_bits_big_endian)
+{
+    u8 const data[] = { 0b10110011, 0b00001111, 0xde, 0xad, 0xbe, 0xef, 0x01, 0x23, 0x45, 0x67, 0x89 };
+    InputMemoryStream memory_stream { { data, sizeof(data) } };
+    InputBitStream bit_stream { memory_stream };
+
+    EXPECT_EQ(bit_stream.read_bit_big_endian(), true);
+    EXPECT_EQ(bit_stream.read_bits_big_endian(3), 0b011u);
+    EXPECT_EQ(bit_stream.read_bits_big_endian(8), 0b00110000u);
+    EXPECT_EQ(bit_stream.read_bits_big_endian(0), 0u);
+    EXPECT_EQ(bit_stream.read_bits_big_endian(4), 0b1111u);
+    // Reads that span more bytes than the bit buffer can hold.
+    EXPECT_EQ(bit_stream.read_bits_big_endian(60), 0xdeadbeef0123456u);
+    EXPECT_EQ(bit_stream.read_bits_big_endian(12), 0x789u);
+
+    EXPECT(!bit_stream.has_any_error());
+    EXPECT_EQ(bit_stream.read_bits_big_endian(1), 0u);
+    EXPECT(bit_stream.handle_any_error());
+}
+
+TEST_CASE(read_unary_big_endian)
+{
+    u8 const data[] = { 0b10010000, 0b00000000, 0b00000000, 0b01000000 };
+    InputMemoryStream memory_stream { { data, sizeof(data) } };
+    InputBitStream bit_stream { memory_stream };
+
+    EXPECT_EQ(bit_stream.read_unary_big_endian(), 0u);
+    EXPECT_EQ(bit_stream.read_unary_big_endian(), 2u);
+    EXPECT_EQ(bit_stream.read_unary_big_endian(), 21u);
+    EXPECT_EQ(bit_stream.read_bits_big_endian(6), 0u);
+    EXPECT(!bit_stream.has_any_error());
+}
+
+TEST_CASE(read_ahead)
+{
+    u8 const data[] = { 0xab, 0xcd, 0xef };
+    InputMemoryStream memory_stream { { data, sizeof(data) } };
+    InputBitStream bit_stream { memory_stream };
+    bit_stream.set_read_ahead(true);
+
+    EXPECT_EQ(bit_stream.read_bits_big_endian(4), 0xau);
+    EXPECT(memory_stream.eof());
+    EXPECT_EQ(bit_stream.read_bits_big_endian(12), 0xbcdu);
+
+    // The bytes that were read ahead can still be read through the bit stream.
+    u8 byte = 0;
+    EXPECT_EQ(bit_stream.read({ &byte, 1 }), 1u);
+    EXPECT_EQ(byte, 0xef);
+    EXPECT(!bit_stream.has_any_error());
+}
@@ -41,3 +41,27 @@ TEST_CASE(should_find_const)
 
     EXPECT_EQ(sut.end(), sut.find(42));
 }
+
+TEST_CASE(insert_before)
+{
+    auto sut = make_list();
+
+    sut.insert_before(sut.begin(), -1);
+    EXPECT_EQ(-1, sut.first());
+
+    sut.insert_before(sut.find(5), 42);
+    auto it = sut.find(4);
+    ++it;
+    EXPECT_EQ(42, *it);
+    ++it;
+    EXPECT_EQ(5, *it);
+
+    sut.insert_before(sut.end(), 10);
+    EXPECT_EQ(10, sut.last());
+
+    int expected[] = { -1, 0, 1, 2, 3, 4, 42, 5, 6, 7, 8, 9, 10 };
+    size_t index = 0;
+    for (auto value : sut)
+        EXPECT_EQ(expected[index++], value);
+    EXPECT_EQ(index, sizeof(expected) / sizeof(expected[0]));
+}
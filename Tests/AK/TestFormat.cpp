@@ -342,3 +342,24 @@ TEST_CASE(format_wchar)
     EXPECT_EQ(String::formatted("{:6d}", L'a'), "    97");
     EXPECT_EQ(String::formatted("{:#x}", L'\U0001F41E'), "0x1f41e");
 }
+
+TEST_CASE(format_large_integers_and_padding)
+{
+    EXPECT_EQ(String::formatted("{}", NumericLimits<u64>::max()), "18446744073709551615");
+    EXPECT_EQ(String::formatted("{}", NumericLimits<i64>::min()), "-9223372036854775808");
+    EXPECT_EQ(String::formatted("{:x}", NumericLimits<u64>::max()), "ffffffffffffffff");
+    EXPECT_EQ(String::formatted("{:o}", 0777u), "777");
+    EXPECT_EQ(String::formatted("{:b}", NumericLimits<u64>::max()), String::repeated('1', 64));
+    EXPECT_EQ(String::formatted("{:*>100}", 1), String::formatted("{}1", String::repeated('*', 99)));
+    EXPECT_EQ(String::formatted("{{{}}} {{ }} {}", 1, 2), "{1} { } 2");
+}
+
+BENCHMARK_CASE(format_many_integers)
+{
+    StringBuilder builder;
+    for (size_t i = 0; i < 1'000'000; ++i) {
+        builder.appendff("value {} is {:x} in hex and {:08} padded\n", i, i * 37, i);
+        if (builder.length() > 64 * KiB)
+            builder.clear();
+    }
+}
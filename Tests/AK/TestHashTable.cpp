@@ -224,3 +224,76 @@ TEST_CASE(basic_contains)
     EXPECT_EQ(table.remove(1), true);
     EXPECT_EQ(table.contains(1), false);
 }
+
+TEST_CASE(interleaved_set_and_remove)
+{
+    HashTable<int> table;
+    bool present[4096] {};
+    size_t expected_size = 0;
+
+    u32 state = 1;
+    for (int i = 0; i < 100'000; ++i) {
+        state = state * 1103515245 + 12345;
+        int value = (state >> 8) % 4096;
+        if (state & 1) {
+            EXPECT_EQ(table.set(value) == AK::HashSetResult::InsertedNewEntry, !present[value]);
+            if (!present[value])
+                ++expected_size;
+            present[value] = true;
+        } else {
+            EXPECT_EQ(table.remove(value), present[value]);
+            if (present[value])
+                --expected_size;
+            present[value] = false;
+        }
+    }
+
+    EXPECT_EQ(table.size(), expected_size);
+    for (int value = 0; value < 4096; ++value)
+        EXPECT_EQ(table.contains(value), present[value]);
+
+    size_t iterated = 0;
+    for (auto value : table) {
+        EXPECT(present[value]);
+        ++iterated;
+    }
+    EXPECT_EQ(iterated, expected_size);
+}
+
+TEST_CASE(ordered_insertion_after_remove)
+{
+    OrderedHashTable<int> table;
+    for (int i = 0; i < 100; ++i)
+        table.set(i);
+    for (int i = 0; i < 100; i += 2)
+        EXPECT(table.remove(i));
+    for (int i = 0; i < 100; i += 2)
+        table.set(i);
+
+    int expected = 1;
+    for (auto value : table) {
+        EXPECT_EQ(value, expected);
+        expected += 2;
+        if (expected == 101)
+            expected = 0;
+    }
+    EXPECT_EQ(expected, 100);
+}
+
+TEST_CASE(clear_with_capacity)
+{
+    HashTable<String> strings;
+    for (int i = 0; i < 100; ++i)
+        strings.set(String::number(i));
+
+    auto capacity = strings.capacity();
+    strings.clear_with_capacity();
+    EXPECT(strings.is_empty());
+    EXPECT_EQ(strings.capacity(), capacity);
+    EXPECT(strings.begin() == strings.end());
+
+    strings.set("foo");
+    EXPECT_EQ(strings.size(), 1u);
+    EXPECT(strings.contains("foo"));
+    EXPECT(!strings.contains("1"));
+}
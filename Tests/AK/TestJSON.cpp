@@ -8,7 +8,9 @@
 
 #include <AK/HashMap.h>
 #include <AK/JsonObject.h>
+#include <AK/JsonStreamParser.h>
 #include <AK/JsonValue.h>
+#include <AK/MemoryStream.h>
 #include <AK/String.h>
 #include <AK/StringBuilder.h>
 
@@ -128,3 +130,122 @@ TEST_CASE(json_parse_empty_string)
     auto value = JsonValue::from_string("");
     EXPECT_EQ(value.value().is_null(), true);
 }
+
+class JsonEventRecorder final : public JsonStreamParser::Visitor {
+public:
+    virtual ErrorOr<void> visit_object_start() override { return m_builder.try_append("{ "sv); }
+    virtual ErrorOr<void> visit_property_name(StringView name) override { return m_builder.try_appendff("{}: ", name); }
+    virtual ErrorOr<void> visit_object_end() override { return m_builder.try_append("} "sv); }
+    virtual ErrorOr<void> visit_array_start() override { return m_builder.try_append("[ "sv); }
+    virtual ErrorOr<void> visit_array_end() override { return m_builder.try_append("] "sv); }
+    virtual ErrorOr<void> visit_string(StringView string) override { return m_builder.try_appendff("'{}' ", string); }
+    virtual ErrorOr<void> visit_number(JsonValue const& number) override { return m_builder.try_appendff("{} ", number.to_string()); }
+    virtual ErrorOr<void> visit_boolean(bool value) override { return m_builder.try_appendff("{} ", value); }
+    virtual ErrorOr<void> visit_null() override { return m_builder.try_append("null "sv); }
+
+    String events() const { return m_builder.to_string(); }
+
+private:
+    StringBuilder m_builder;
+};
+
+// Hands out its data one byte at a time, so that every token ends up split across reads.
+class TrickleInputStream final : public InputStream {
+public:
+    explicit TrickleInputStream(StringView data)
+        : m_data(data)
+    {
+    }
+
+    virtual size_t read(Bytes bytes) override
+    {
+        if (bytes.is_empty() || m_offset == m_data.length())
+            return 0;
+        bytes[0] = m_data[m_offset++];
+        return 1;
+    }
+    virtual bool unreliable_eof() const override { return m_offset == m_data.length(); }
+    virtual bool read_or_error(Bytes) override { VERIFY_NOT_REACHED(); }
+    virtual bool discard_or_error(size_t) override { VERIFY_NOT_REACHED(); }
+
+private:
+    StringView m_data;
+    size_t m_offset { 0 };
+};
+
+static ErrorOr<String> stream_parse_events(StringView input)
+{
+    JsonEventRecorder recorder;
+    TRY(JsonStreamParser { input }.parse(recorder));
+    auto events = recorder.events();
+
+    JsonEventRecorder trickle_recorder;
+    TrickleInputStream stream { input };
+    TRY(JsonStreamParser { stream }.parse(trickle_recorder));
+    EXPECT_EQ(trickle_recorder.events(), events);
+
+    return events;
+}
+
+TEST_CASE(json_stream_parser)
+{
+    auto events = stream_parse_events(R"( {"name": "Form1", "widgets": [ {"enabled": true, "tooltip": null, "x": -155, "ratio": 1.5}, [], {} ], "escaped": "a\"b\u00e9c\n"} )"sv);
+    EXPECT(!events.is_error());
+    EXPECT_EQ(events.value(), "{ name: 'Form1' widgets: [ { enabled: true tooltip: null x: -155 ratio: 1.5 } [ ] { } ] escaped: 'a\"b\u00e9c\n' } ");
+
+    EXPECT_EQ(stream_parse_events("42"sv).value(), "42 ");
+    EXPECT_EQ(stream_parse_events("  \"lonely string\"\n"sv).value(), "'lonely string' ");
+}
+
+TEST_CASE(json_stream_parser_errors)
+{
+    EXPECT(stream_parse_events(""sv).is_error());
+    EXPECT(stream_parse_events("[1, 2"sv).is_error());
+    EXPECT(stream_parse_events("[1, 2,]"sv).is_error());
+    EXPECT(stream_parse_events("{\"a\": 1,}"sv).is_error());
+    EXPECT(stream_parse_events("{\"a\" 1}"sv).is_error());
+    EXPECT(stream_parse_events("\"unterminated"sv).is_error());
+    EXPECT(stream_parse_events("\"bad escape \\q\""sv).is_error());
+    EXPECT(stream_parse_events("01"sv).is_error());
+    EXPECT(stream_parse_events("tru"sv).is_error());
+    EXPECT(stream_parse_events("[] []"sv).is_error());
+}
+
+TEST_CASE(json_stream_parser_strings_point_into_input)
+{
+    class StringChecker final : public JsonStreamParser::Visitor {
+    public:
+        explicit StringChecker(StringView input)
+            : m_input(input)
+        {
+        }
+
+        virtual ErrorOr<void> visit_string(StringView string) override
+        {
+            EXPECT(string.characters_without_null_termination() >= m_input.characters_without_null_termination());
+            EXPECT(string.characters_without_null_termination() + string.length() <= m_input.characters_without_null_termination() + m_input.length());
+            ++strings_seen;
+            return {};
+        }
+
+        StringView m_input;
+        size_t strings_seen { 0 };
+    };
+
+    auto input = R"(["first", "second", "third"])"sv;
+    StringChecker checker { input };
+    EXPECT(!JsonStreamParser { input }.parse(checker).is_error());
+    EXPECT_EQ(checker.strings_seen, 3u);
+}
+
+TEST_CASE(json_stream_parser_deep_nesting)
+{
+    StringBuilder builder;
+    for (size_t i = 0; i < 100'000; ++i)
+        builder.append('[');
+    for (size_t i = 0; i < 100'000; ++i)
+        builder.append(']');
+
+    JsonStreamParser::Visitor visitor;
+    EXPECT(!JsonStreamParser { builder.string_view() }.parse(visitor).is_error());
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/MergeSort.h>
+#include <AK/Noncopyable.h>
+#include <AK/Vector.h>
+
+TEST_CASE(sorts_small_and_empty_collections)
+{
+    Vector<int> empty;
+    merge_sort(empty);
+    EXPECT(empty.is_empty());
+
+    Vector<int> values { 3, 1, 2 };
+    merge_sort(values);
+    EXPECT_EQ(values, (Vector<int> { 1, 2, 3 }));
+}
+
+TEST_CASE(is_stable)
+{
+    struct Entry {
+        int key;
+        int original_position;
+    };
+
+    Vector<Entry> entries;
+    for (int i = 0; i < 5000; ++i)
+        entries.append({ (i * 7919) % 37, i });
+
+    merge_sort(entries, [](auto& a, auto& b) { return a.key < b.key; });
+
+    for (size_t i = 1; i < entries.size(); ++i) {
+        EXPECT(entries[i - 1].key <= entries[i].key);
+        if (entries[i - 1].key == entries[i].key)
+            EXPECT(entries[i - 1].original_position < entries[i].original_position);
+    }
+}
+
+TEST_CASE(sorts_without_copy)
+{
+    struct NoCopy {
+        AK_MAKE_NONCOPYABLE(NoCopy);
+
+    public:
+        NoCopy(int value)
+            : value(value)
+        {
+        }
+        NoCopy(NoCopy&&) = default;
+        NoCopy& operator=(NoCopy&&) = default;
+
+        int value { 0 };
+    };
+
+    Vector<NoCopy> values;
+    for (int i = 0; i < 100; ++i)
+        values.append({ (100 - i) % 32 });
+
+    merge_sort(values, [](auto& a, auto& b) { return a.value < b.value; });
+
+    for (size_t i = 1; i < values.size(); ++i)
+        EXPECT(values[i - 1].value <= values[i].value);
+}
+
+BENCHMARK_CASE(merge_sort_random_integers)
+{
+    Vector<u32> values;
+    u32 state = 1;
+    for (size_t i = 0; i < 1'000'000; ++i) {
+        state = state * 1103515245 + 12345;
+        values.append(state);
+    }
+    merge_sort(values);
+    for (size_t i = 1; i < values.size(); ++i)
+        EXPECT(values[i - 1] <= values[i]);
+}
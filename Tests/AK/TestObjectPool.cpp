@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/ObjectPool.h>
+#include <AK/String.h>
+#include <AK/Vector.h>
+
+TEST_CASE(allocate_and_deallocate)
+{
+    ObjectPool<String> pool;
+    auto* first = pool.allocate("first");
+    auto* second = pool.allocate("second");
+    EXPECT_EQ(*first, "first");
+    EXPECT_EQ(*second, "second");
+    EXPECT_EQ(pool.live_count(), 2u);
+
+    pool.deallocate(first);
+    pool.deallocate(second);
+    EXPECT_EQ(pool.live_count(), 0u);
+}
+
+TEST_CASE(deallocated_slots_are_reused)
+{
+    ObjectPool<u64> pool;
+    auto* first = pool.allocate(1u);
+    pool.deallocate(first);
+    auto* second = pool.allocate(2u);
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(*second, 2u);
+    pool.deallocate(second);
+}
+
+TEST_CASE(many_chunks)
+{
+    struct Object {
+        size_t value;
+        u8 padding[100] {};
+    };
+
+    ObjectPool<Object, 1 * KiB> pool;
+    Vector<Object*> objects;
+    for (size_t i = 0; i < 1000; ++i)
+        objects.append(pool.allocate(i));
+
+    for (size_t i = 0; i < objects.size(); ++i)
+        EXPECT_EQ(objects[i]->value, i);
+
+    for (size_t i = 0; i < objects.size(); i += 2)
+        pool.deallocate(objects[i]);
+    EXPECT_EQ(pool.live_count(), 500u);
+
+    for (size_t i = 1; i < objects.size(); i += 2)
+        EXPECT_EQ(objects[i]->value, i);
+
+    for (size_t i = 1; i < objects.size(); i += 2)
+        pool.deallocate(objects[i]);
+    EXPECT_EQ(pool.live_count(), 0u);
+}
+
+TEST_CASE(destructors_are_run)
+{
+    static size_t destroyed_count = 0;
+    struct Object {
+        ~Object() { ++destroyed_count; }
+    };
+
+    ObjectPool<Object> pool;
+    auto* first = pool.allocate();
+    auto* second = pool.allocate();
+    pool.deallocate(first);
+    EXPECT_EQ(destroyed_count, 1u);
+    pool.deallocate(second);
+    EXPECT_EQ(destroyed_count, 2u);
+}
@@ -9,6 +9,7 @@
 #include <AK/Noncopyable.h>
 #include <AK/QuickSort.h>
 #include <AK/StdLibExtras.h>
+#include <AK/Vector.h>
 
 TEST_CASE(sorts_without_copy)
 {
@@ -97,3 +98,40 @@ TEST_CASE(maximum_stack_depth)
 
     delete[] data;
 }
+
+TEST_CASE(sorts_adversarial_and_duplicate_heavy_input)
+{
+    auto expect_sorted = [](Vector<int> const& values) {
+        for (size_t i = 1; i < values.size(); ++i)
+            EXPECT(values[i - 1] <= values[i]);
+    };
+
+    Vector<int> ascending;
+    Vector<int> descending;
+    Vector<int> few_distinct;
+    Vector<int> organ_pipe;
+    for (int i = 0; i < 10000; ++i) {
+        ascending.append(i);
+        descending.append(10000 - i);
+        few_distinct.append(i % 3);
+        organ_pipe.append(i < 5000 ? i : 10000 - i);
+    }
+
+    for (auto* values : Array { &ascending, &descending, &few_distinct, &organ_pipe }) {
+        quick_sort(*values);
+        expect_sorted(*values);
+    }
+}
+
+BENCHMARK_CASE(sort_random_integers)
+{
+    Vector<u32> values;
+    u32 state = 1;
+    for (size_t i = 0; i < 1'000'000; ++i) {
+        state = state * 1103515245 + 12345;
+        values.append(state);
+    }
+    quick_sort(values);
+    for (size_t i = 1; i < values.size(); ++i)
+        EXPECT(values[i - 1] <= values[i]);
+}
@@ -92,6 +92,20 @@ TEST_CASE(copy_string)
     EXPECT_EQ(test_string.characters(), test_string_copy.characters());
 }
 
+TEST_CASE(single_character_strings_are_shared)
+{
+    String a = "a";
+    String also_a = StringView { "abc" }.substring_view(0, 1);
+    EXPECT_EQ(a.impl(), also_a.impl());
+    EXPECT_EQ(String("A").to_lowercase().impl(), a.impl());
+    EXPECT_EQ(a.length(), 1u);
+    EXPECT_EQ(a.characters()[1], '\0');
+
+    String zero { "\0", 1 };
+    EXPECT_EQ(zero.length(), 1u);
+    EXPECT_EQ(zero[0], '\0');
+}
+
 TEST_CASE(move_string)
 {
     String test_string = "ABCDEF";
@@ -142,6 +156,18 @@ TEST_CASE(flystring)
         EXPECT_EQ(a.impl(), b.impl());
         EXPECT_EQ(a.impl(), c.impl());
     }
+
+    {
+        FlyString a("literal");
+        auto b = FlyString::from_literal("literal");
+        auto c = FlyString::from_literal("another literal");
+        EXPECT_EQ(a.impl(), b.impl());
+        EXPECT_EQ(b.hash(), "literal"sv.hash());
+        EXPECT_NE(b.impl(), c.impl());
+        EXPECT_EQ(c, "another literal"sv);
+        EXPECT_NE(c, "another"sv);
+        EXPECT_EQ(FlyString::from_literal(""), ""sv);
+    }
 }
 
 TEST_CASE(replace)
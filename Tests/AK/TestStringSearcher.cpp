@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/Random.h>
+#include <AK/String.h>
+#include <AK/StringBuilder.h>
+#include <AK/StringSearcher.h>
+
+static Optional<size_t> naive_find(ReadonlyBytes haystack, ReadonlyBytes needle)
+{
+    for (size_t i = 0; i + needle.size() <= haystack.size(); ++i) {
+        if (haystack.slice(i, needle.size()) == needle)
+            return i;
+    }
+    return {};
+}
+
+TEST_CASE(short_needles)
+{
+    StringSearcher searcher { "needle"sv };
+    EXPECT_EQ(searcher.find("needle"sv), 0u);
+    EXPECT_EQ(searcher.find("a needle in a haystack"sv), 2u);
+    EXPECT_EQ(searcher.find("neede needl needle"sv), 12u);
+    EXPECT(!searcher.find("needl"sv).has_value());
+    EXPECT(!searcher.find("a haystack without it, no matter how long the haystack gets"sv).has_value());
+
+    EXPECT_EQ(StringSearcher { "x"sv }.find("0123456789abcdefghijklmnopqrstuvwxyz"sv), 33u);
+    EXPECT_EQ(StringSearcher { "xy"sv }.find("0123456789abcdefghijklmnopqrstuvwxyz"sv), 33u);
+    EXPECT_EQ(StringSearcher { ""sv }.find("abc"sv), 0u);
+    EXPECT_EQ(StringSearcher { ""sv }.find(""sv), 0u);
+}
+
+TEST_CASE(long_needles)
+{
+    auto needle = "this needle is long enough to be searched for with horspool"sv;
+    StringSearcher searcher { needle };
+    auto haystack = String::formatted("{}{}{}", String::repeated('a', 1000), needle, String::repeated('b', 1000));
+    EXPECT_EQ(searcher.find(haystack), 1000u);
+    EXPECT(!searcher.find(haystack.substring_view(0, 1000 + needle.length() - 1)).has_value());
+    EXPECT(!searcher.find(haystack.substring_view(1001)).has_value());
+}
+
+TEST_CASE(random_haystacks_match_naive_search)
+{
+    for (size_t round = 0; round < 2000; ++round) {
+        // A small alphabet makes partial matches common.
+        StringBuilder haystack_builder;
+        auto haystack_length = get_random<u32>() % 300;
+        for (size_t i = 0; i < haystack_length; ++i)
+            haystack_builder.append('a' + get_random<u8>() % 3);
+        auto haystack = haystack_builder.build();
+
+        StringBuilder needle_builder;
+        auto needle_length = 1 + get_random<u32>() % 40;
+        for (size_t i = 0; i < needle_length; ++i)
+            needle_builder.append('a' + get_random<u8>() % 3);
+        auto needle = needle_builder.build();
+
+        // Sometimes take the needle from the haystack, so we are sure to find something.
+        if (haystack_length > needle_length && round % 2)
+            needle = haystack.substring(get_random<u32>() % (haystack_length - needle_length), needle_length);
+
+        StringSearcher searcher { needle };
+        EXPECT_EQ(searcher.find(haystack), naive_find(haystack.bytes(), needle.bytes()));
+    }
+}
+
+BENCHMARK_CASE(search_large_text)
+{
+    StringBuilder builder;
+    for (size_t i = 0; i < 100'000; ++i)
+        builder.appendff("[{}] kernel: some fairly average log line without anything interesting in it\n", i);
+    auto haystack = builder.build();
+
+    StringSearcher short_searcher { "interesting thing"sv };
+    StringSearcher long_searcher { "a log line that is long enough for the skip table to kick in"sv };
+    for (size_t i = 0; i < 10; ++i) {
+        EXPECT(!short_searcher.find(haystack).has_value());
+        EXPECT(!long_searcher.find(haystack).has_value());
+    }
+}
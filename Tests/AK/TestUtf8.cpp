@@ -217,3 +217,62 @@ TEST_CASE(trim)
         EXPECT_EQ(view.trim(whitespace, TrimMode::Right).as_string(), "\u180E");
     }
 }
+
+static size_t count_code_points_by_iterating(Utf8View const& view)
+{
+    size_t count = 0;
+    for (auto it = view.begin(); it != view.end(); ++it)
+        ++count;
+    return count;
+}
+
+TEST_CASE(validate_and_count_long_strings)
+{
+    auto text = "ASCII text that is longer than a chunk, Привет, мир! 😀 γειά σου κόσμος こんにちは世界, and some more ASCII at the end."sv;
+    Utf8View view { text };
+    size_t valid_bytes;
+    EXPECT(view.validate(valid_bytes));
+    EXPECT_EQ(valid_bytes, text.length());
+    EXPECT_EQ(view.length(), count_code_points_by_iterating(view));
+
+    // Breaking the string at any position has to be caught, and the valid bytes have to end right before the broken code point.
+    for (size_t i = 0; i < text.length(); ++i) {
+        auto buffer = ByteBuffer::copy(text.bytes()).release_value();
+        size_t expected_valid_bytes = i;
+        while (expected_valid_bytes > 0 && (buffer[expected_valid_bytes] & 0xc0) == 0x80)
+            --expected_valid_bytes;
+        buffer[i] = (buffer[i] & 0xc0) == 0x80 ? 'x' : 0x80;
+
+        Utf8View broken_view { StringView { buffer.bytes() } };
+        EXPECT(!broken_view.validate(valid_bytes));
+        if ((text[i] & 0xc0) == 0x80) {
+            // Replacing a continuation byte makes the code point before it invalid.
+            EXPECT_EQ(valid_bytes, expected_valid_bytes);
+        } else {
+            // Replacing a leading byte with a continuation byte makes that byte itself invalid.
+            EXPECT_EQ(valid_bytes, i);
+        }
+        EXPECT_EQ(broken_view.length(), count_code_points_by_iterating(broken_view));
+    }
+
+    // A truncated code point at the very end.
+    auto truncated = text.substring_view(0, text.find("😀"sv).value() + 2);
+    Utf8View truncated_view { truncated };
+    EXPECT(!truncated_view.validate(valid_bytes));
+    EXPECT_EQ(valid_bytes, truncated.length() - 2);
+    EXPECT_EQ(truncated_view.length(), count_code_points_by_iterating(truncated_view));
+}
+
+BENCHMARK_CASE(validate_and_count_large_text)
+{
+    StringBuilder builder;
+    for (size_t i = 0; i < 100'000; ++i)
+        builder.append("Some ASCII, some Ελληνικά, some 日本語. "sv);
+    auto text = builder.to_string();
+
+    for (size_t i = 0; i < 10; ++i) {
+        Utf8View view { text };
+        EXPECT(view.validate());
+        EXPECT_EQ(view.length(), 3'700'000u);
+    }
+}
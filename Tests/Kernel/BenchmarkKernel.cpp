@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Atomic.h>
+#include <LibTest/TestCase.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <serenity.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <syscall.h>
+#include <unistd.h>
+
+// Most benchmarks repeat their operation this many times per run, so the cost of one operation is the time of a run
+// divided by this. It keeps the cost of timing the run out of the results.
+static constexpr size_t operations_per_run = 1000;
+
+static constexpr size_t pages_per_run = 256;
+
+BENCHMARK_CASE(getpid_round_trip)
+{
+    // NOTE: getpid() is cached by LibC, so this makes the syscall itself.
+    for (size_t i = 0; i < operations_per_run; ++i)
+        EXPECT(syscall(SC_getpid) > 0);
+}
+
+BENCHMARK_CASE(zero_byte_read)
+{
+    static int fd = open("/dev/zero", O_RDONLY | O_CLOEXEC);
+    VERIFY(fd >= 0);
+    char buffer;
+    for (size_t i = 0; i < operations_per_run; ++i)
+        EXPECT_EQ(read(fd, &buffer, 0), 0);
+}
+
+// A thread that sends every byte it reads straight back, so every round trip with it is two context switches.
+struct EchoChannel {
+    int read_fd { -1 };
+    int write_fd { -1 };
+};
+
+static void* echo_forever(void* argument)
+{
+    auto* channel_ptr = static_cast<EchoChannel*>(argument);
+    auto channel = *channel_ptr;
+    delete channel_ptr;
+    char byte;
+    while (read(channel.read_fd, &byte, 1) == 1) {
+        if (write(channel.write_fd, &byte, 1) != 1)
+            break;
+    }
+    return nullptr;
+}
+
+static EchoChannel start_echo_thread(EchoChannel our_end, EchoChannel their_end)
+{
+    // NOTE: The thread is never joined, it just goes away with the process.
+    pthread_t thread;
+    VERIFY(pthread_create(&thread, nullptr, echo_forever, new EchoChannel(their_end)) == 0);
+    VERIFY(pthread_detach(thread) == 0);
+    return our_end;
+}
+
+static void ping_pong(EchoChannel const& channel)
+{
+    char byte = 'x';
+    for (size_t i = 0; i < operations_per_run; ++i) {
+        EXPECT_EQ(write(channel.write_fd, &byte, 1), 1);
+        EXPECT_EQ(read(channel.read_fd, &byte, 1), 1);
+    }
+}
+
+BENCHMARK_CASE(pipe_ping_pong)
+{
+    static EchoChannel s_channel = [] {
+        int requests[2];
+        int responses[2];
+        VERIFY(pipe(requests) == 0);
+        VERIFY(pipe(responses) == 0);
+        return start_echo_thread({ responses[0], requests[1] }, { requests[0], responses[1] });
+    }();
+    ping_pong(s_channel);
+}
+
+BENCHMARK_CASE(local_socket_ping_pong)
+{
+    static EchoChannel s_channel = [] {
+        int fds[2];
+        VERIFY(socketpair(AF_LOCAL, SOCK_STREAM, 0, fds) == 0);
+        return start_echo_thread({ fds[0], fds[0] }, { fds[1], fds[1] });
+    }();
+    ping_pong(s_channel);
+}
+
+// The main thread sets the word to 1 and wakes the other thread, which sets it back to 0 and wakes the main thread.
+static Atomic<u32> s_futex_word;
+
+static u32* futex_word()
+{
+    return const_cast<u32*>(s_futex_word.ptr());
+}
+
+static void* reset_futex_word_forever(void*)
+{
+    for (;;) {
+        while (s_futex_word.load() == 0)
+            futex_wait(futex_word(), 0, nullptr, 0);
+        s_futex_word.store(0);
+        futex_wake(futex_word(), 1);
+    }
+    return nullptr;
+}
+
+BENCHMARK_CASE(futex_wake_round_trip)
+{
+    static bool s_started = [] {
+        pthread_t thread;
+        VERIFY(pthread_create(&thread, nullptr, reset_futex_word_forever, nullptr) == 0);
+        VERIFY(pthread_detach(thread) == 0);
+        return true;
+    }();
+    VERIFY(s_started);
+
+    for (size_t i = 0; i < operations_per_run; ++i) {
+        s_futex_word.store(1);
+        futex_wake(futex_word(), 1);
+        while (s_futex_word.load() == 1)
+            futex_wait(futex_word(), 1, nullptr, 0);
+    }
+}
+
+BENCHMARK_CASE(anonymous_page_faults)
+{
+    auto* ptr = mmap(nullptr, pages_per_run * PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, 0, 0);
+    VERIFY(ptr != MAP_FAILED);
+    auto* data = static_cast<u8 volatile*>(ptr);
+    for (size_t page = 0; page < pages_per_run; ++page)
+        data[page * PAGE_SIZE] = 1;
+    EXPECT_EQ(munmap(ptr, pages_per_run * PAGE_SIZE), 0);
+}
+
+BENCHMARK_CASE(file_backed_page_faults)
+{
+    static int fd = [] {
+        char path[] = "/tmp/BenchmarkKernel.XXXXXX";
+        int fd = mkstemp(path);
+        VERIFY(fd >= 0);
+        VERIFY(unlink(path) == 0);
+        VERIFY(ftruncate(fd, pages_per_run * PAGE_SIZE) == 0);
+        return fd;
+    }();
+
+    auto* ptr = mmap(nullptr, pages_per_run * PAGE_SIZE, PROT_READ, MAP_PRIVATE, fd, 0);
+    VERIFY(ptr != MAP_FAILED);
+    auto* data = static_cast<u8 volatile const*>(ptr);
+    for (size_t page = 0; page < pages_per_run; ++page)
+        EXPECT_EQ(data[page * PAGE_SIZE], 0);
+    EXPECT_EQ(munmap(ptr, pages_per_run * PAGE_SIZE), 0);
+}
+
+BENCHMARK_CASE(fork_exec_wait)
+{
+    // This is slow enough to be measured on its own.
+    pid_t pid = fork();
+    VERIFY(pid >= 0);
+    if (pid == 0) {
+        execl("/bin/true", "true", nullptr);
+        _exit(127);
+    }
+    int status = 0;
+    EXPECT_EQ(waitpid(pid, &status, 0), pid);
+    EXPECT(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+BENCHMARK_CASE(mmap_munmap_churn)
+{
+    for (size_t i = 0; i < operations_per_run; ++i) {
+        auto* ptr = mmap(nullptr, PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, 0, 0);
+        VERIFY(ptr != MAP_FAILED);
+        EXPECT_EQ(munmap(ptr, PAGE_SIZE), 0);
+    }
+}
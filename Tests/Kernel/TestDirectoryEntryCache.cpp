@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/String.h>
+#include <LibTest/TestCase.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static bool exists(char const* path)
+{
+    struct stat st;
+    return stat(path, &st) == 0;
+}
+
+static void create_file(char const* path)
+{
+    int fd = open(path, O_CREAT | O_WRONLY | O_EXCL, 0644);
+    VERIFY(fd >= 0);
+    close(fd);
+}
+
+TEST_CASE(negative_entry_is_invalidated_by_create)
+{
+    char directory[] = "/tmp/dentry-cache.XXXXXX";
+    EXPECT_NE(mkdtemp(directory), nullptr);
+    auto path = String::formatted("{}/file", directory);
+
+    EXPECT(!exists(path.characters()));
+    EXPECT(!exists(path.characters()));
+    create_file(path.characters());
+    EXPECT(exists(path.characters()));
+
+    EXPECT_EQ(unlink(path.characters()), 0);
+    EXPECT(!exists(path.characters()));
+    EXPECT_EQ(rmdir(directory), 0);
+}
+
+TEST_CASE(rename_is_visible_through_both_names)
+{
+    char directory[] = "/tmp/dentry-cache.XXXXXX";
+    EXPECT_NE(mkdtemp(directory), nullptr);
+    auto old_path = String::formatted("{}/old", directory);
+    auto new_path = String::formatted("{}/new", directory);
+
+    create_file(old_path.characters());
+    EXPECT(exists(old_path.characters()));
+    EXPECT(!exists(new_path.characters()));
+
+    EXPECT_EQ(rename(old_path.characters(), new_path.characters()), 0);
+    EXPECT(!exists(old_path.characters()));
+    EXPECT(exists(new_path.characters()));
+
+    EXPECT_EQ(unlink(new_path.characters()), 0);
+    EXPECT_EQ(rmdir(directory), 0);
+}
+
+TEST_CASE(recreated_directory_does_not_see_old_entries)
+{
+    char directory[] = "/tmp/dentry-cache.XXXXXX";
+    EXPECT_NE(mkdtemp(directory), nullptr);
+    auto subdirectory = String::formatted("{}/sub", directory);
+    auto path = String::formatted("{}/sub/file", directory);
+
+    EXPECT_EQ(mkdir(subdirectory.characters(), 0755), 0);
+    create_file(path.characters());
+    EXPECT(exists(path.characters()));
+    EXPECT_EQ(unlink(path.characters()), 0);
+    EXPECT_EQ(rmdir(subdirectory.characters()), 0);
+    EXPECT(!exists(path.characters()));
+
+    EXPECT_EQ(mkdir(subdirectory.characters(), 0755), 0);
+    EXPECT(!exists(path.characters()));
+    create_file(path.characters());
+    EXPECT(exists(path.characters()));
+
+    EXPECT_EQ(unlink(path.characters()), 0);
+    EXPECT_EQ(rmdir(subdirectory.characters()), 0);
+    EXPECT_EQ(rmdir(directory), 0);
+}
+
+TEST_CASE(permission_changes_apply_to_cached_paths)
+{
+    if (getuid() == 0) {
+        // The superuser bypasses the permission checks we'd like to test.
+        return;
+    }
+
+    char directory[] = "/tmp/dentry-cache.XXXXXX";
+    EXPECT_NE(mkdtemp(directory), nullptr);
+    auto path = String::formatted("{}/file", directory);
+    create_file(path.characters());
+    EXPECT(exists(path.characters()));
+
+    EXPECT_EQ(chmod(directory, 0600), 0);
+    struct stat st;
+    EXPECT_EQ(stat(path.characters(), &st), -1);
+    EXPECT_EQ(errno, EACCES);
+
+    EXPECT_EQ(chmod(directory, 0700), 0);
+    EXPECT(exists(path.characters()));
+    EXPECT_EQ(unlink(path.characters()), 0);
+    EXPECT_EQ(rmdir(directory), 0);
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/String.h>
+#include <LibTest/TestCase.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/statvfs.h>
+#include <unistd.h>
+
+// /tmp is a TmpFS, so put the test files on the root file system to exercise Ext2FS.
+static constexpr char const* test_file_template = "/home/anon/ext2-append.XXXXXX";
+
+static constexpr size_t chunk_size = 1000;
+static constexpr size_t chunk_count = 700;
+
+static u8 expected_byte_at(size_t offset)
+{
+    return static_cast<u8>((offset / chunk_size) * 7 + offset % 251);
+}
+
+static int create_test_file()
+{
+    char path[64];
+    strcpy(path, test_file_template);
+    int fd = mkstemp(path);
+    VERIFY(fd >= 0);
+    unlink(path);
+    return fd;
+}
+
+static u64 free_blocks()
+{
+    struct statvfs buf;
+    VERIFY(statvfs("/home/anon", &buf) == 0);
+    return buf.f_bfree;
+}
+
+static void append_chunks(int fd)
+{
+    u8 chunk[chunk_size];
+    for (size_t i = 0; i < chunk_count; ++i) {
+        for (size_t j = 0; j < chunk_size; ++j)
+            chunk[j] = expected_byte_at(i * chunk_size + j);
+        VERIFY(write(fd, chunk, chunk_size) == static_cast<ssize_t>(chunk_size));
+    }
+}
+
+static void expect_contents(int fd, off_t offset, size_t size)
+{
+    auto buffer = ByteBuffer::create_uninitialized(size).release_value();
+    EXPECT_EQ(pread(fd, buffer.data(), size, offset), static_cast<ssize_t>(size));
+    for (size_t i = 0; i < size; ++i) {
+        if (buffer[i] != expected_byte_at(offset + i)) {
+            FAIL(String::formatted("Byte at offset {} is {:#x}, expected {:#x}", offset + i, buffer[i], expected_byte_at(offset + i)));
+            return;
+        }
+    }
+}
+
+TEST_CASE(small_appends_read_back_correctly)
+{
+    int fd = create_test_file();
+    append_chunks(fd);
+
+    constexpr size_t file_size = chunk_size * chunk_count;
+    expect_contents(fd, 0, file_size);
+    expect_contents(fd, 4096, 64 * 1024);
+    expect_contents(fd, 12345, 99999);
+    expect_contents(fd, file_size - 5000, 5000);
+    close(fd);
+}
+
+TEST_CASE(interleaved_appends_to_two_files)
+{
+    int first_fd = create_test_file();
+    int second_fd = create_test_file();
+
+    u8 chunk[chunk_size];
+    for (size_t i = 0; i < chunk_count; ++i) {
+        for (size_t j = 0; j < chunk_size; ++j)
+            chunk[j] = expected_byte_at(i * chunk_size + j);
+        VERIFY(write(first_fd, chunk, chunk_size) == static_cast<ssize_t>(chunk_size));
+        VERIFY(write(second_fd, chunk, chunk_size) == static_cast<ssize_t>(chunk_size));
+    }
+
+    expect_contents(first_fd, 0, chunk_size * chunk_count);
+    expect_contents(second_fd, 0, chunk_size * chunk_count);
+    close(first_fd);
+    close(second_fd);
+}
+
+TEST_CASE(preallocated_blocks_are_released)
+{
+    auto free_blocks_before = free_blocks();
+
+    int fd = create_test_file();
+    append_chunks(fd);
+    EXPECT_EQ(ftruncate(fd, chunk_size), 0);
+    expect_contents(fd, 0, chunk_size);
+    close(fd);
+
+    // The file was unlinked, so closing it gives back every block it used.
+    EXPECT_EQ(free_blocks(), free_blocks_before);
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/String.h>
+#include <LibTest/TestCase.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// /tmp is a TmpFS, so put the test directory on the root file system to exercise Ext2FS.
+static constexpr char const* test_directory_template = "/home/anon/ext2-directory-index.XXXXXX";
+
+// Enough entries to fill many blocks, so the directory gets (and outgrows) an index.
+static constexpr size_t entry_count = 3000;
+
+static String create_test_directory()
+{
+    char path[64];
+    strcpy(path, test_directory_template);
+    VERIFY(mkdtemp(path));
+    return path;
+}
+
+static String entry_path(String const& directory, size_t index)
+{
+    return String::formatted("{}/entry-with-a-longish-name-{}", directory, index);
+}
+
+static void create_entry(String const& path)
+{
+    int fd = open(path.characters(), O_CREAT | O_EXCL | O_WRONLY, 0644);
+    VERIFY(fd >= 0);
+    close(fd);
+}
+
+static size_t count_entries(String const& directory)
+{
+    DIR* dir = opendir(directory.characters());
+    VERIFY(dir);
+    size_t count = 0;
+    while (auto* entry = readdir(dir)) {
+        if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0)
+            ++count;
+    }
+    closedir(dir);
+    return count;
+}
+
+static void expect_entries(String const& directory, bool (*should_exist)(size_t))
+{
+    for (size_t i = 0; i < entry_count; ++i) {
+        struct stat st;
+        bool exists = stat(entry_path(directory, i).characters(), &st) == 0;
+        if (exists != should_exist(i)) {
+            FAIL(String::formatted("Entry {} {}", i, exists ? "still exists" : "is missing"));
+            return;
+        }
+    }
+}
+
+TEST_CASE(many_entries_can_be_found_and_removed)
+{
+    auto directory = create_test_directory();
+    for (size_t i = 0; i < entry_count; ++i)
+        create_entry(entry_path(directory, i));
+
+    expect_entries(directory, [](size_t) { return true; });
+    EXPECT_EQ(count_entries(directory), entry_count);
+
+    // Creating an existing entry again must fail, even when it's in a leaf far from the first block.
+    EXPECT_EQ(open(entry_path(directory, entry_count / 2).characters(), O_CREAT | O_EXCL | O_WRONLY, 0644), -1);
+    EXPECT_EQ(errno, EEXIST);
+
+    for (size_t i = 0; i < entry_count; i += 2)
+        EXPECT_EQ(unlink(entry_path(directory, i).characters()), 0);
+
+    expect_entries(directory, [](size_t index) { return index % 2 == 1; });
+    EXPECT_EQ(count_entries(directory), entry_count / 2);
+
+    // Re-adding entries reuses the room that the removed ones left behind.
+    for (size_t i = 0; i < entry_count; i += 2)
+        create_entry(entry_path(directory, i));
+    expect_entries(directory, [](size_t) { return true; });
+
+    for (size_t i = 0; i < entry_count; ++i)
+        EXPECT_EQ(unlink(entry_path(directory, i).characters()), 0);
+    EXPECT_EQ(count_entries(directory), 0u);
+    EXPECT_EQ(rmdir(directory.characters()), 0);
+}
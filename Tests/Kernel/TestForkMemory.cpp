@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static constexpr size_t mapping_size = 64 * PAGE_SIZE;
+
+static u8* map_and_fill(u8 seed)
+{
+    auto* ptr = mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, 0, 0);
+    VERIFY(ptr != MAP_FAILED);
+    auto* data = static_cast<u8*>(ptr);
+    for (size_t i = 0; i < mapping_size; i += 256)
+        data[i] = static_cast<u8>(seed + i / 256);
+    return data;
+}
+
+static bool contents_are_intact(u8 const* data, u8 seed)
+{
+    for (size_t i = 0; i < mapping_size; i += 256) {
+        if (data[i] != static_cast<u8>(seed + i / 256))
+            return false;
+    }
+    return true;
+}
+
+// Runs the callback in a forked child and returns whether it exited with status 0.
+template<typename Callback>
+static bool run_in_child(Callback callback)
+{
+    pid_t pid = fork();
+    VERIFY(pid >= 0);
+    if (pid == 0)
+        _exit(callback() ? 0 : 1);
+    int status = 0;
+    VERIFY(waitpid(pid, &status, 0) == pid);
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+TEST_CASE(child_sees_parent_memory)
+{
+    auto* data = map_and_fill(1);
+    EXPECT(run_in_child([&] { return contents_are_intact(data, 1); }));
+    EXPECT_EQ(munmap(data, mapping_size), 0);
+}
+
+TEST_CASE(child_writes_are_private)
+{
+    auto* data = map_and_fill(2);
+    EXPECT(run_in_child([&] {
+        // Write before reading, so the first touch of each page is a write fault.
+        for (size_t i = 0; i < mapping_size; i += PAGE_SIZE)
+            data[i + 1] = 0xff;
+        for (size_t i = 0; i < mapping_size; i += PAGE_SIZE)
+            data[i + 1] = 0;
+        return contents_are_intact(data, 2);
+    }));
+    EXPECT(contents_are_intact(data, 2));
+    EXPECT_EQ(data[1], 0);
+    EXPECT_EQ(munmap(data, mapping_size), 0);
+}
+
+TEST_CASE(parent_writes_after_fork_are_private)
+{
+    auto* data = map_and_fill(3);
+    int pipe_fds[2];
+    EXPECT_EQ(pipe(pipe_fds), 0);
+
+    pid_t pid = fork();
+    VERIFY(pid >= 0);
+    if (pid == 0) {
+        char c;
+        VERIFY(read(pipe_fds[0], &c, 1) == 1);
+        _exit(contents_are_intact(data, 3) ? 0 : 1);
+    }
+
+    memset(data, 0, mapping_size);
+    EXPECT_EQ(write(pipe_fds[1], "x", 1), 1);
+
+    int status = 0;
+    EXPECT_EQ(waitpid(pid, &status, 0), pid);
+    EXPECT(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+    EXPECT_EQ(munmap(data, mapping_size), 0);
+}
+
+TEST_CASE(read_only_region_becomes_writable_after_fork)
+{
+    auto* data = map_and_fill(4);
+    EXPECT_EQ(mprotect(data, mapping_size, PROT_READ), 0);
+    EXPECT(run_in_child([&] {
+        if (mprotect(data, mapping_size, PROT_READ | PROT_WRITE) < 0)
+            return false;
+        memset(data, 0, mapping_size);
+        return true;
+    }));
+
+    EXPECT_EQ(mprotect(data, mapping_size, PROT_READ | PROT_WRITE), 0);
+    EXPECT(contents_are_intact(data, 4));
+    EXPECT_EQ(munmap(data, mapping_size), 0);
+}
+
+TEST_CASE(shared_mapping_is_shared_with_child)
+{
+    auto* ptr = mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_SHARED, 0, 0);
+    EXPECT_NE(ptr, MAP_FAILED);
+    auto* data = static_cast<u8*>(ptr);
+    data[0] = 1;
+    EXPECT(run_in_child([&] {
+        if (data[0] != 1)
+            return false;
+        data[mapping_size - 1] = 2;
+        return true;
+    }));
+    EXPECT_EQ(data[mapping_size - 1], 2);
+    EXPECT_EQ(munmap(data, mapping_size), 0);
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static constexpr size_t huge_page_size = 2 * MiB;
+static constexpr size_t mapping_size = 3 * huge_page_size;
+
+static u8* map_and_fill()
+{
+    auto* ptr = mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, 0, 0);
+    VERIFY(ptr != MAP_FAILED);
+    auto* data = static_cast<u8*>(ptr);
+    for (size_t i = 0; i < mapping_size; i += 512)
+        data[i] = static_cast<u8>(i / 512);
+    return data;
+}
+
+static bool contents_are_intact(u8 const* data, size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end; i += 512) {
+        if (data[i] != static_cast<u8>(i / 512))
+            return false;
+    }
+    return true;
+}
+
+TEST_CASE(large_anonymous_mappings_are_huge_page_aligned)
+{
+    auto* data = map_and_fill();
+    EXPECT_EQ(reinterpret_cast<FlatPtr>(data) % huge_page_size, 0u);
+    EXPECT(contents_are_intact(data, 0, mapping_size));
+    EXPECT_EQ(munmap(data, mapping_size), 0);
+}
+
+TEST_CASE(partial_munmap_splits_huge_page)
+{
+    auto* data = map_and_fill();
+    EXPECT_EQ(munmap(data + huge_page_size + PAGE_SIZE, PAGE_SIZE), 0);
+    EXPECT(contents_are_intact(data, 0, huge_page_size + PAGE_SIZE));
+    EXPECT(contents_are_intact(data, huge_page_size + 2 * PAGE_SIZE, mapping_size));
+    EXPECT_EQ(munmap(data, huge_page_size + PAGE_SIZE), 0);
+    EXPECT_EQ(munmap(data + huge_page_size + 2 * PAGE_SIZE, mapping_size - huge_page_size - 2 * PAGE_SIZE), 0);
+}
+
+TEST_CASE(partial_mprotect_splits_huge_page)
+{
+    auto* data = map_and_fill();
+    EXPECT_EQ(mprotect(data + huge_page_size, PAGE_SIZE, PROT_READ), 0);
+    EXPECT(contents_are_intact(data, 0, mapping_size));
+
+    // The rest of the huge page must still be writable.
+    data[huge_page_size + PAGE_SIZE] = 0x42;
+    EXPECT_EQ(data[huge_page_size + PAGE_SIZE], 0x42);
+    EXPECT_EQ(munmap(data, mapping_size), 0);
+}
+
+TEST_CASE(fork_copies_huge_pages_on_write)
+{
+    auto* data = map_and_fill();
+    int pipe_fds[2];
+    EXPECT_EQ(pipe(pipe_fds), 0);
+
+    pid_t pid = fork();
+    VERIFY(pid >= 0);
+    if (pid == 0) {
+        data[huge_page_size] = 0xff;
+        u8 intact = contents_are_intact(data, huge_page_size + 512, mapping_size);
+        write(pipe_fds[1], &intact, 1);
+        _exit(0);
+    }
+
+    u8 child_saw_intact_contents = 0;
+    EXPECT_EQ(read(pipe_fds[0], &child_saw_intact_contents, 1), 1);
+    EXPECT_EQ(child_saw_intact_contents, 1);
+    EXPECT_EQ(waitpid(pid, nullptr, 0), pid);
+    EXPECT(contents_are_intact(data, 0, mapping_size));
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+    EXPECT_EQ(munmap(data, mapping_size), 0);
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/io_batch.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+static int create_test_file()
+{
+    char path[] = "/tmp/io-batch-test.XXXXXX";
+    int fd = mkstemp(path);
+    VERIFY(fd >= 0);
+    unlink(path);
+    return fd;
+}
+
+TEST_CASE(positional_writes_and_reads)
+{
+    int fd = create_test_file();
+
+    char const* words[] = { "alpha", "bravo", "charlie" };
+    io_request writes[3];
+    for (size_t i = 0; i < 3; ++i)
+        writes[i] = { IO_WRITE, fd, IO_POSITIONAL, static_cast<off_t>(i * 16), const_cast<char*>(words[i]), strlen(words[i]), 0 };
+    EXPECT_EQ(io_submit_batch(writes, 3), 3);
+    for (size_t i = 0; i < 3; ++i)
+        EXPECT_EQ(writes[i].result, static_cast<ssize_t>(strlen(words[i])));
+
+    // Positional requests don't move the file offset.
+    EXPECT_EQ(lseek(fd, 0, SEEK_CUR), 0);
+
+    char buffers[3][16] {};
+    io_request reads[3];
+    for (size_t i = 0; i < 3; ++i)
+        reads[i] = { IO_READ, fd, IO_POSITIONAL, static_cast<off_t>(i * 16), buffers[i], strlen(words[i]), 0 };
+    EXPECT_EQ(io_submit_batch(reads, 3), 3);
+    for (size_t i = 0; i < 3; ++i) {
+        EXPECT_EQ(reads[i].result, static_cast<ssize_t>(strlen(words[i])));
+        EXPECT_EQ(StringView(buffers[i]), StringView(words[i]));
+    }
+
+    close(fd);
+}
+
+TEST_CASE(vectored_requests)
+{
+    int fd = create_test_file();
+
+    char hello[] = "hello ";
+    char world[] = "world";
+    iovec write_vecs[] = { { hello, 6 }, { world, 5 } };
+    io_request write { IO_WRITEV, fd, 0, 0, write_vecs, 2, 0 };
+    EXPECT_EQ(io_submit_batch(&write, 1), 1);
+    EXPECT_EQ(write.result, 11);
+    EXPECT_EQ(lseek(fd, 0, SEEK_CUR), 11);
+
+    char first[5] {};
+    char second[7] {};
+    iovec read_vecs[] = { { first, 4 }, { second, 6 } };
+    io_request read { IO_READV, fd, IO_POSITIONAL, 1, read_vecs, 2, 0 };
+    EXPECT_EQ(io_submit_batch(&read, 1), 1);
+    EXPECT_EQ(read.result, 10);
+    EXPECT_EQ(StringView(first), "ello"sv);
+    EXPECT_EQ(StringView(second), " world"sv);
+
+    close(fd);
+}
+
+TEST_CASE(failing_request_does_not_stop_the_batch)
+{
+    int fd = create_test_file();
+
+    char buffer[4];
+    io_request requests[] = {
+        { IO_WRITE, -1, 0, 0, buffer, sizeof(buffer), 0 },
+        { IO_WRITE, fd, 0, 0, const_cast<char*>("data"), 4, 0 },
+        { 1234, fd, 0, 0, buffer, sizeof(buffer), 0 },
+    };
+    EXPECT_EQ(io_submit_batch(requests, 3), 3);
+    EXPECT_EQ(requests[0].result, -EBADF);
+    EXPECT_EQ(requests[1].result, 4);
+    EXPECT_EQ(requests[2].result, -EINVAL);
+
+    close(fd);
+}
+
+TEST_CASE(pwrite_leaves_file_offset_alone)
+{
+    int fd = create_test_file();
+
+    EXPECT_EQ(write(fd, "0123456789", 10), 10);
+    EXPECT_EQ(pwrite(fd, "ab", 2, 4), 2);
+    EXPECT_EQ(lseek(fd, 0, SEEK_CUR), 10);
+
+    char buffer[11] {};
+    EXPECT_EQ(pread(fd, buffer, 10, 0), 10);
+    EXPECT_EQ(StringView(buffer), "0123ab6789"sv);
+
+    close(fd);
+}
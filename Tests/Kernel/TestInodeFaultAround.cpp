@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+static constexpr size_t page_count = 150;
+static constexpr size_t tail_size = 123;
+static constexpr size_t file_size = page_count * PAGE_SIZE + tail_size;
+
+static int create_test_file()
+{
+    char path[] = "/tmp/fault-around.XXXXXX";
+    int fd = mkstemp(path);
+    VERIFY(fd >= 0);
+    unlink(path);
+
+    u8 page[PAGE_SIZE];
+    for (size_t i = 0; i <= page_count; ++i) {
+        memset(page, static_cast<u8>(i + 1), sizeof(page));
+        auto size = i == page_count ? tail_size : PAGE_SIZE;
+        VERIFY(write(fd, page, size) == static_cast<ssize_t>(size));
+    }
+    return fd;
+}
+
+static void expect_page_contents(u8 const* data, size_t page_index)
+{
+    auto size = page_index == page_count ? tail_size : PAGE_SIZE;
+    u8 expected = static_cast<u8>(page_index + 1);
+    for (size_t i = 0; i < size; ++i) {
+        if (data[i] != expected) {
+            FAIL(String::formatted("Page {} has byte {:#x} at offset {}, expected {:#x}", page_index, data[i], i, expected));
+            return;
+        }
+    }
+    // The part of the last page beyond the end of the file must read as zeroes.
+    for (size_t i = size; i < PAGE_SIZE; ++i) {
+        if (data[i] != 0) {
+            FAIL(String::formatted("Page {} has non-zero byte beyond the end of the file at offset {}", page_index, i));
+            return;
+        }
+    }
+}
+
+TEST_CASE(sequential_faults)
+{
+    int fd = create_test_file();
+    auto* data = static_cast<u8*>(mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0));
+    EXPECT_NE(data, MAP_FAILED);
+
+    for (size_t i = 0; i <= page_count; ++i)
+        expect_page_contents(data + i * PAGE_SIZE, i);
+
+    EXPECT_EQ(munmap(data, file_size), 0);
+    close(fd);
+}
+
+TEST_CASE(backwards_and_strided_faults)
+{
+    int fd = create_test_file();
+    auto* data = static_cast<u8*>(mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0));
+    EXPECT_NE(data, MAP_FAILED);
+
+    for (ssize_t i = page_count; i >= 0; i -= 7)
+        expect_page_contents(data + i * PAGE_SIZE, i);
+    for (size_t i = 0; i <= page_count; ++i)
+        expect_page_contents(data + i * PAGE_SIZE, i);
+
+    EXPECT_EQ(munmap(data, file_size), 0);
+    close(fd);
+}
+
+TEST_CASE(faults_at_an_offset)
+{
+    int fd = create_test_file();
+    size_t offset_pages = 37;
+    size_t size = file_size - offset_pages * PAGE_SIZE;
+    auto* data = static_cast<u8*>(mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, offset_pages * PAGE_SIZE));
+    EXPECT_NE(data, MAP_FAILED);
+
+    for (size_t i = offset_pages; i <= page_count; ++i)
+        expect_page_contents(data + (i - offset_pages) * PAGE_SIZE, i);
+
+    EXPECT_EQ(munmap(data, size), 0);
+    close(fd);
+}
+
+TEST_CASE(shared_mapping_sees_pages_faulted_in_by_another_mapping)
+{
+    int fd = create_test_file();
+    auto* first = static_cast<u8*>(mmap(nullptr, file_size, PROT_READ, MAP_SHARED, fd, 0));
+    EXPECT_NE(first, MAP_FAILED);
+    for (size_t i = 0; i <= page_count; i += 3)
+        expect_page_contents(first + i * PAGE_SIZE, i);
+
+    auto* second = static_cast<u8*>(mmap(nullptr, file_size, PROT_READ, MAP_SHARED, fd, 0));
+    EXPECT_NE(second, MAP_FAILED);
+    for (size_t i = 0; i <= page_count; ++i)
+        expect_page_contents(second + i * PAGE_SIZE, i);
+
+    EXPECT_EQ(munmap(first, file_size), 0);
+    EXPECT_EQ(munmap(second, file_size), 0);
+    close(fd);
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+#include <errno.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+TEST_CASE(level_triggered_read_readiness)
+{
+    int pipe_fds[2];
+    EXPECT_EQ(pipe(pipe_fds), 0);
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    EXPECT(epfd >= 0);
+
+    epoll_event event {};
+    event.events = EPOLLIN;
+    event.data.u64 = 0x1234;
+    EXPECT_EQ(epoll_ctl(epfd, EPOLL_CTL_ADD, pipe_fds[0], &event), 0);
+
+    epoll_event ready[4];
+    EXPECT_EQ(epoll_wait(epfd, ready, 4, 0), 0);
+
+    EXPECT_EQ(write(pipe_fds[1], "x", 1), 1);
+    EXPECT_EQ(epoll_wait(epfd, ready, 4, 0), 1);
+    EXPECT_EQ(ready[0].events, EPOLLIN);
+    EXPECT_EQ(ready[0].data.u64, 0x1234u);
+
+    // Nothing was read, so the pipe is still ready.
+    EXPECT_EQ(epoll_wait(epfd, ready, 4, 0), 1);
+
+    char buffer;
+    EXPECT_EQ(read(pipe_fds[0], &buffer, 1), 1);
+    EXPECT_EQ(epoll_wait(epfd, ready, 4, 0), 0);
+
+    close(epfd);
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+}
+
+TEST_CASE(edge_triggered_read_readiness)
+{
+    int pipe_fds[2];
+    EXPECT_EQ(pipe(pipe_fds), 0);
+    int epfd = epoll_create1(0);
+    EXPECT(epfd >= 0);
+
+    epoll_event event {};
+    event.events = EPOLLIN | EPOLLET;
+    event.data.fd = pipe_fds[0];
+    EXPECT_EQ(epoll_ctl(epfd, EPOLL_CTL_ADD, pipe_fds[0], &event), 0);
+
+    EXPECT_EQ(write(pipe_fds[1], "x", 1), 1);
+    epoll_event ready[4];
+    EXPECT_EQ(epoll_wait(epfd, ready, 4, 0), 1);
+    EXPECT_EQ(ready[0].data.fd, pipe_fds[0]);
+
+    // We're only told again once something happens to the pipe.
+    EXPECT_EQ(epoll_wait(epfd, ready, 4, 0), 0);
+    EXPECT_EQ(write(pipe_fds[1], "y", 1), 1);
+    EXPECT_EQ(epoll_wait(epfd, ready, 4, 0), 1);
+
+    close(epfd);
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+}
+
+TEST_CASE(modify_and_remove_watches)
+{
+    int pipe_fds[2];
+    EXPECT_EQ(pipe(pipe_fds), 0);
+    int epfd = epoll_create1(0);
+    EXPECT(epfd >= 0);
+
+    epoll_event event {};
+    event.events = EPOLLIN;
+    EXPECT_EQ(epoll_ctl(epfd, EPOLL_CTL_ADD, pipe_fds[1], &event), 0);
+    EXPECT_EQ(epoll_ctl(epfd, EPOLL_CTL_ADD, pipe_fds[1], &event), -1);
+    EXPECT_EQ(errno, EEXIST);
+
+    epoll_event ready[4];
+    EXPECT_EQ(epoll_wait(epfd, ready, 4, 0), 0);
+
+    event.events = EPOLLOUT;
+    EXPECT_EQ(epoll_ctl(epfd, EPOLL_CTL_MOD, pipe_fds[1], &event), 0);
+    EXPECT_EQ(epoll_wait(epfd, ready, 4, 0), 1);
+    EXPECT_EQ(ready[0].events, EPOLLOUT);
+
+    EXPECT_EQ(epoll_ctl(epfd, EPOLL_CTL_DEL, pipe_fds[1], nullptr), 0);
+    EXPECT_EQ(epoll_wait(epfd, ready, 4, 0), 0);
+    EXPECT_EQ(epoll_ctl(epfd, EPOLL_CTL_DEL, pipe_fds[1], nullptr), -1);
+    EXPECT_EQ(errno, ENOENT);
+
+    // Event queues can't watch each other.
+    int other_epfd = epoll_create1(0);
+    EXPECT(other_epfd >= 0);
+    EXPECT_EQ(epoll_ctl(epfd, EPOLL_CTL_ADD, other_epfd, &event), -1);
+    EXPECT_EQ(errno, EINVAL);
+
+    close(other_epfd);
+    close(epfd);
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Array.h>
+#include <AK/Time.h>
+#include <LibTest/TestCase.h>
+#include <sys/select.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+static Time monotonic_now()
+{
+    timespec now;
+    VERIFY(clock_gettime(CLOCK_MONOTONIC, &now) == 0);
+    return Time::from_timespec(now);
+}
+
+static void sleep_for(Time duration)
+{
+    auto ts = duration.to_timespec();
+    while (nanosleep(&ts, &ts) < 0)
+        ;
+}
+
+TEST_CASE(sleeps_never_end_early)
+{
+    // These cover several levels of the kernel's timer wheel.
+    constexpr Array durations_ms { 1, 3, 10, 40, 150, 300, 1100 };
+    for (auto duration_ms : durations_ms) {
+        auto duration = Time::from_milliseconds(duration_ms);
+        auto start = monotonic_now();
+        sleep_for(duration);
+        auto elapsed = monotonic_now() - start;
+        EXPECT(elapsed >= duration);
+        // Add a generous buffer to allow for latency on the system.
+        EXPECT(elapsed < duration + Time::from_milliseconds(100));
+    }
+}
+
+TEST_CASE(concurrent_sleeps_wake_up_in_order)
+{
+    constexpr Array durations_ms { 700, 100, 400, 20, 250 };
+    Array<pid_t, durations_ms.size()> pids {};
+    for (size_t i = 0; i < durations_ms.size(); ++i) {
+        pids[i] = fork();
+        VERIFY(pids[i] >= 0);
+        if (pids[i] == 0) {
+            sleep_for(Time::from_milliseconds(durations_ms[i]));
+            _exit(0);
+        }
+    }
+
+    int previous_duration_ms = 0;
+    for (size_t i = 0; i < durations_ms.size(); ++i) {
+        auto pid = waitpid(-1, nullptr, 0);
+        EXPECT(pid > 0);
+        for (size_t j = 0; j < pids.size(); ++j) {
+            if (pids[j] != pid)
+                continue;
+            EXPECT(durations_ms[j] >= previous_duration_ms);
+            previous_duration_ms = durations_ms[j];
+        }
+    }
+}
+
+TEST_CASE(cancelled_timeouts_do_not_fire)
+{
+    // A blocking read with a timeout that is satisfied early cancels its timer.
+    int fds[2];
+    EXPECT_EQ(pipe(fds), 0);
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(write(fds[1], "x", 1), 1);
+        timespec timeout { .tv_sec = 5, .tv_nsec = 0 };
+        fd_set read_fds;
+        FD_ZERO(&read_fds);
+        FD_SET(fds[0], &read_fds);
+        EXPECT_EQ(pselect(fds[0] + 1, &read_fds, nullptr, nullptr, &timeout, nullptr), 1);
+        char c;
+        EXPECT_EQ(read(fds[0], &c, 1), 1);
+    }
+    close(fds[0]);
+    close(fds[1]);
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static constexpr size_t large_message_size = 64 * KiB + 123;
+
+static void fill_pattern(u8* data, size_t size, u8 seed)
+{
+    for (size_t i = 0; i < size; ++i)
+        data[i] = static_cast<u8>(i * 7 + seed);
+}
+
+static bool matches_pattern(u8 const* data, size_t size, u8 seed, size_t pattern_offset = 0)
+{
+    for (size_t i = 0; i < size; ++i) {
+        if (data[i] != static_cast<u8>((i + pattern_offset) * 7 + seed))
+            return false;
+    }
+    return true;
+}
+
+static size_t read_fully(int fd, u8* data, size_t size)
+{
+    size_t nread = 0;
+    while (nread < size) {
+        auto rc = read(fd, data + nread, size - nread);
+        if (rc <= 0)
+            break;
+        nread += rc;
+    }
+    return nread;
+}
+
+TEST_CASE(large_write_into_page_aligned_buffer)
+{
+    int fds[2];
+    EXPECT_EQ(socketpair(AF_LOCAL, SOCK_STREAM, 0, fds), 0);
+
+    auto* source = static_cast<u8*>(mmap(nullptr, large_message_size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0));
+    EXPECT_NE(source, MAP_FAILED);
+    fill_pattern(source, large_message_size, 3);
+    EXPECT_EQ(write(fds[0], source, large_message_size), static_cast<ssize_t>(large_message_size));
+
+    // The writer can keep using its buffer, the receiver must not see that.
+    memset(source, 0, large_message_size);
+
+    auto* destination = static_cast<u8*>(mmap(nullptr, large_message_size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0));
+    EXPECT_NE(destination, MAP_FAILED);
+    EXPECT_EQ(read_fully(fds[1], destination, large_message_size), large_message_size);
+    EXPECT(matches_pattern(destination, large_message_size, 3));
+
+    munmap(source, large_message_size);
+    munmap(destination, large_message_size);
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST_CASE(small_and_large_writes_stay_in_order)
+{
+    int fds[2];
+    EXPECT_EQ(socketpair(AF_LOCAL, SOCK_STREAM, 0, fds), 0);
+
+    static u8 large[large_message_size];
+    fill_pattern(large, large_message_size, 11);
+
+    EXPECT_EQ(write(fds[0], "abc", 3), 3);
+    EXPECT_EQ(write(fds[0], large, large_message_size), static_cast<ssize_t>(large_message_size));
+    EXPECT_EQ(write(fds[0], "xyz", 3), 3);
+
+    // Read into an unaligned heap buffer so that the data has to be copied.
+    auto* received = static_cast<u8*>(malloc(large_message_size + 7));
+    EXPECT_EQ(read_fully(fds[1], received + 1, large_message_size + 6), large_message_size + 6);
+    EXPECT_EQ(memcmp(received + 1, "abc", 3), 0);
+    EXPECT(matches_pattern(received + 4, large_message_size, 11));
+    EXPECT_EQ(memcmp(received + 4 + large_message_size, "xyz", 3), 0);
+
+    free(received);
+    close(fds[0]);
+    close(fds[1]);
+}
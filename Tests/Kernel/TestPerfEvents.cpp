@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Array.h>
+#include <AK/JsonArray.h>
+#include <AK/JsonObject.h>
+#include <AK/JsonValue.h>
+#include <AK/StringBuilder.h>
+#include <LibTest/TestCase.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <serenity.h>
+#include <unistd.h>
+
+static constexpr size_t thread_count = 4;
+static constexpr size_t signposts_per_thread = 500;
+
+static void* emit_signposts(void* argument)
+{
+    auto thread_index = reinterpret_cast<uintptr_t>(argument);
+    for (size_t i = 0; i < signposts_per_thread; ++i)
+        VERIFY(perf_event(PERF_EVENT_SIGNPOST, thread_index, i) == 0);
+    return nullptr;
+}
+
+static JsonValue read_perf_events()
+{
+    int fd = open("/proc/self/perf_events", O_RDONLY);
+    VERIFY(fd >= 0);
+    StringBuilder builder;
+    char buffer[4096];
+    ssize_t nread;
+    while ((nread = read(fd, buffer, sizeof(buffer))) > 0)
+        builder.append(buffer, nread);
+    close(fd);
+    return JsonValue::from_string(builder.string_view()).release_value();
+}
+
+TEST_CASE(signposts_from_many_threads_are_merged_in_order)
+{
+    EXPECT_EQ(profiling_enable(getpid(), PERF_EVENT_SIGNPOST), 0);
+
+    Array<pthread_t, thread_count> threads;
+    for (size_t i = 0; i < thread_count; ++i)
+        EXPECT_EQ(pthread_create(&threads[i], nullptr, emit_signposts, reinterpret_cast<void*>(i)), 0);
+    for (auto thread : threads)
+        EXPECT_EQ(pthread_join(thread, nullptr), 0);
+
+    EXPECT_EQ(profiling_disable(getpid()), 0);
+
+    auto json = read_perf_events();
+    auto const& events = json.as_object().get("events"sv).as_array();
+
+    Array<size_t, thread_count> next_signpost {};
+    Array<u64, thread_count> previous_timestamp {};
+    events.for_each([&](JsonValue const& value) {
+        auto const& event = value.as_object();
+        if (event.get("type"sv).as_string() != "signpost"sv)
+            return;
+        auto thread_index = event.get("arg1"sv).to_u64();
+        VERIFY(thread_index < thread_count);
+        // Events from one thread must come out in the order they were recorded,
+        // even if the thread moved to another processor in between.
+        EXPECT_EQ(event.get("arg2"sv).to_u64(), next_signpost[thread_index]);
+        ++next_signpost[thread_index];
+        auto timestamp = event.get("timestamp"sv).to_u64();
+        EXPECT(timestamp >= previous_timestamp[thread_index]);
+        previous_timestamp[thread_index] = timestamp;
+    });
+
+    for (auto count : next_signpost)
+        EXPECT_EQ(count, signposts_per_thread);
+
+    EXPECT_EQ(profiling_free_buffer(getpid()), 0);
+}
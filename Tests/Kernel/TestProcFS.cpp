@@ -4,8 +4,11 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/ByteBuffer.h>
+#include <Kernel/API/ProcessStatistics.h>
 #include <LibTest/TestCase.h>
 #include <cstring>
+#include <fcntl.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
@@ -74,3 +77,48 @@ TEST_CASE(test_process_fd_readlink)
     buf[link_length] = '\0';
     EXPECT_EQ(0, strcmp(buf, expected_link));
 }
+
+TEST_CASE(test_all_processes_binary)
+{
+    int fd = open("/proc/all_binary", O_RDONLY);
+    EXPECT(fd >= 0);
+    ByteBuffer contents;
+    u8 buffer[4096];
+    ssize_t nread;
+    while ((nread = read(fd, buffer, sizeof(buffer))) > 0)
+        contents.append(buffer, nread);
+    close(fd);
+
+    ReadonlyBytes bytes = contents.bytes();
+    auto take = [&](size_t size) {
+        VERIFY(bytes.size() >= size);
+        auto taken = bytes.slice(0, size);
+        bytes = bytes.slice(size);
+        return taken;
+    };
+
+    ProcessStatisticsHeader header;
+    memcpy(&header, take(sizeof(header)).data(), sizeof(header));
+    EXPECT_EQ(header.version, PROCESS_STATISTICS_VERSION);
+    EXPECT(header.process_count > 1);
+
+    bool found_self = false;
+    for (u32 i = 0; i < header.process_count; ++i) {
+        ProcessStatisticsRecord process;
+        memcpy(&process, take(sizeof(process)).data(), sizeof(process));
+        auto name = StringView { take(process.name_length) };
+        take(process.executable_length + process.tty_length + process.pledge_length + process.veil_length);
+        if (process.pid == getpid()) {
+            found_self = true;
+            EXPECT_EQ(name, "TestProcFS"sv);
+            EXPECT_EQ(process.thread_count, 1u);
+        }
+        for (u32 j = 0; j < process.thread_count; ++j) {
+            ThreadStatisticsRecord thread;
+            memcpy(&thread, take(sizeof(thread)).data(), sizeof(thread));
+            take(thread.name_length + thread.state_length);
+        }
+    }
+    EXPECT(found_self);
+    EXPECT(bytes.is_empty());
+}
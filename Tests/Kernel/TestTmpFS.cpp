@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+static int create_test_file()
+{
+    char path[] = "/tmp/tmpfs-test.XXXXXX";
+    int fd = mkstemp(path);
+    VERIFY(fd >= 0);
+    unlink(path);
+    return fd;
+}
+
+TEST_CASE(append_across_page_boundaries)
+{
+    int fd = create_test_file();
+
+    // Odd-sized writes so that most of them straddle a page boundary.
+    u8 chunk[1000];
+    for (size_t i = 0; i < 100; ++i) {
+        memset(chunk, static_cast<int>(i), sizeof(chunk));
+        EXPECT_EQ(write(fd, chunk, sizeof(chunk)), static_cast<ssize_t>(sizeof(chunk)));
+    }
+
+    for (size_t i = 0; i < 100; ++i) {
+        EXPECT_EQ(pread(fd, chunk, sizeof(chunk), i * sizeof(chunk)), static_cast<ssize_t>(sizeof(chunk)));
+        for (auto byte : chunk) {
+            if (byte != i) {
+                FAIL("Unexpected byte in file contents");
+                break;
+            }
+        }
+    }
+
+    EXPECT_EQ(pread(fd, chunk, sizeof(chunk), 100 * sizeof(chunk)), 0);
+    close(fd);
+}
+
+TEST_CASE(holes_read_back_as_zeroes)
+{
+    int fd = create_test_file();
+
+    EXPECT_EQ(pwrite(fd, "x", 1, 3 * PAGE_SIZE + 10), 1);
+
+    u8 buffer[PAGE_SIZE];
+    EXPECT_EQ(pread(fd, buffer, sizeof(buffer), PAGE_SIZE), static_cast<ssize_t>(sizeof(buffer)));
+    for (auto byte : buffer)
+        EXPECT_EQ(byte, 0);
+
+    close(fd);
+}
+
+TEST_CASE(truncate_then_grow_reads_back_zeroes)
+{
+    int fd = create_test_file();
+
+    u8 buffer[PAGE_SIZE];
+    memset(buffer, 'A', sizeof(buffer));
+    EXPECT_EQ(write(fd, buffer, sizeof(buffer)), static_cast<ssize_t>(sizeof(buffer)));
+
+    EXPECT_EQ(ftruncate(fd, 100), 0);
+    EXPECT_EQ(ftruncate(fd, PAGE_SIZE), 0);
+
+    EXPECT_EQ(pread(fd, buffer, sizeof(buffer), 0), static_cast<ssize_t>(sizeof(buffer)));
+    EXPECT_EQ(buffer[99], 'A');
+    EXPECT_EQ(buffer[100], 0);
+    EXPECT_EQ(buffer[PAGE_SIZE - 1], 0);
+
+    close(fd);
+}
+
+TEST_CASE(shared_mapping_sees_writes_and_vice_versa)
+{
+    int fd = create_test_file();
+    EXPECT_EQ(ftruncate(fd, 2 * PAGE_SIZE), 0);
+    EXPECT_EQ(pwrite(fd, "hello", 5, 0), 5);
+
+    auto* mapping = static_cast<char*>(mmap(nullptr, 2 * PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0));
+    EXPECT_NE(mapping, MAP_FAILED);
+    if (mapping == MAP_FAILED)
+        return;
+
+    EXPECT_EQ(memcmp(mapping, "hello", 5), 0);
+
+    EXPECT_EQ(pwrite(fd, "world", 5, 0), 5);
+    EXPECT_EQ(memcmp(mapping, "world", 5), 0);
+
+    memcpy(mapping + PAGE_SIZE, "mapped", 6);
+    memcpy(mapping, "again", 5);
+    char buffer[6];
+    EXPECT_EQ(pread(fd, buffer, 5, 0), 5);
+    EXPECT_EQ(memcmp(buffer, "again", 5), 0);
+    EXPECT_EQ(pread(fd, buffer, 6, PAGE_SIZE), 6);
+    EXPECT_EQ(memcmp(buffer, "mapped", 6), 0);
+
+    munmap(mapping, 2 * PAGE_SIZE);
+    close(fd);
+}
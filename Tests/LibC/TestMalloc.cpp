@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/Array.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+TEST_CASE(good_size_fits_request)
+{
+    for (size_t size = 1; size <= 65536; size += 7) {
+        auto good_size = malloc_good_size(size);
+        EXPECT(good_size >= size);
+        EXPECT_EQ(good_size % 16, 0u);
+    }
+    EXPECT_EQ(malloc_good_size(40), 48u);
+    EXPECT_EQ(malloc_good_size(129), 160u);
+}
+
+TEST_CASE(malloc_size_matches_good_size)
+{
+    for (size_t size : Array<size_t, 7> { 1, 17, 100, 500, 1000, 3000, 20000 }) {
+        void* ptr = malloc(size);
+        EXPECT_EQ(malloc_size(ptr), malloc_good_size(size));
+        memset(ptr, 0x55, size);
+        free(ptr);
+    }
+}
+
+TEST_CASE(chunks_are_reused_by_the_same_thread)
+{
+    void* first = malloc(64);
+    free(first);
+    void* second = malloc(64);
+    EXPECT_EQ(first, second);
+    free(second);
+}
+
+static constexpr size_t number_of_allocations_per_thread = 4096;
+
+static void* allocate(void*)
+{
+    auto* pointers = new Array<u8*, number_of_allocations_per_thread>;
+    for (size_t i = 0; i < number_of_allocations_per_thread; ++i) {
+        size_t size = 1 + (i * 37) % 1500;
+        (*pointers)[i] = static_cast<u8*>(malloc(size));
+        memset((*pointers)[i], static_cast<u8>(i), size);
+    }
+    return pointers;
+}
+
+TEST_CASE(free_chunks_allocated_by_other_threads)
+{
+    Array<pthread_t, 4> threads;
+    for (auto& thread : threads)
+        EXPECT_EQ(pthread_create(&thread, nullptr, allocate, nullptr), 0);
+
+    for (auto& thread : threads) {
+        void* result = nullptr;
+        EXPECT_EQ(pthread_join(thread, &result), 0);
+        auto* pointers = static_cast<Array<u8*, number_of_allocations_per_thread>*>(result);
+        for (size_t i = 0; i < number_of_allocations_per_thread; ++i) {
+            size_t size = 1 + (i * 37) % 1500;
+            EXPECT_EQ((*pointers)[i][0], static_cast<u8>(i));
+            EXPECT_EQ((*pointers)[i][size - 1], static_cast<u8>(i));
+            free((*pointers)[i]);
+        }
+        delete pointers;
+    }
+}
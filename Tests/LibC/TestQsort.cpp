@@ -76,3 +76,39 @@ TEST_CASE(quick_sort)
         }
     }
 }
+
+struct [[gnu::packed]] OddSizedObject {
+    int key;
+    char payload[9];
+};
+static_assert(sizeof(OddSizedObject) == 13);
+
+TEST_CASE(quick_sort_odd_sized_objects_with_context)
+{
+    Vector<OddSizedObject> test_objects;
+    for (auto i = 0; i < 1000; ++i) {
+        OddSizedObject object { static_cast<int>(get_random_uniform(100)), {} };
+        for (auto j = 0; j < 9; ++j)
+            object.payload[j] = static_cast<char>(object.key + j);
+        test_objects.append(object);
+    }
+
+    size_t comparisons = 0;
+    qsort_r(
+        test_objects.data(), test_objects.size(), sizeof(OddSizedObject), [](void const* a, void const* b, void* context) {
+            ++*static_cast<size_t*>(context);
+            auto key1 = static_cast<OddSizedObject const*>(a)->key;
+            auto key2 = static_cast<OddSizedObject const*>(b)->key;
+            return key1 < key2 ? -1 : (key1 == key2 ? 0 : 1);
+        },
+        &comparisons);
+
+    EXPECT(comparisons > 0);
+    for (auto i = 0u; i < test_objects.size(); ++i) {
+        auto const& object = test_objects[i];
+        if (i + 1 < test_objects.size())
+            EXPECT(object.key <= test_objects[i + 1].key);
+        for (auto j = 0; j < 9; ++j)
+            EXPECT_EQ(object.payload[j], static_cast<char>(object.key + j));
+    }
+}
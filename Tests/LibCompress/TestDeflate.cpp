@@ -68,6 +68,30 @@ TEST_CASE(deflate_decompress_compressed_block)
     EXPECT(decompressed.value().bytes() == ReadonlyBytes({ uncompressed, sizeof(uncompressed) - 1 }));
 }
 
+TEST_CASE(deflate_decompress_into_span)
+{
+    const Array<u8, 28> compressed {
+        0x0B, 0xC9, 0xC8, 0x2C, 0x56, 0x00, 0xA2, 0x44, 0x85, 0xE2, 0xCC, 0xDC,
+        0x82, 0x9C, 0x54, 0x85, 0x92, 0xD4, 0x8A, 0x12, 0x85, 0xB4, 0x4C, 0x20,
+        0xCB, 0x4A, 0x13, 0x00
+    };
+
+    const u8 uncompressed[] = "This is a simple text file :)";
+    constexpr size_t uncompressed_size = sizeof(uncompressed) - 1;
+
+    Array<u8, uncompressed_size + 3> output {};
+
+    const auto exact_size = Compress::DeflateDecompressor::decompress_into(compressed, output.span().trim(uncompressed_size));
+    EXPECT_EQ(exact_size.value(), uncompressed_size);
+    EXPECT(output.span().trim(uncompressed_size) == ReadonlyBytes({ uncompressed, uncompressed_size }));
+
+    const auto larger_size = Compress::DeflateDecompressor::decompress_into(compressed, output);
+    EXPECT_EQ(larger_size.value(), uncompressed_size);
+
+    const auto too_small = Compress::DeflateDecompressor::decompress_into(compressed, output.span().trim(uncompressed_size - 1));
+    EXPECT(!too_small.has_value());
+}
+
 TEST_CASE(deflate_decompress_uncompressed_block)
 {
     const Array<u8, 18> compressed {
@@ -95,3 +95,19 @@ TEST_CASE(gzip_round_trip)
     EXPECT(uncompressed.has_value());
     EXPECT(uncompressed.value() == original);
 }
+
+TEST_CASE(gzip_round_trip_parallel)
+{
+    // Repeat a random pattern across several chunks, so that back references cross the chunk boundaries
+    auto const size = Compress::GzipCompressor::parallel_chunk_size * 5 + 1234;
+    auto original = ByteBuffer::create_uninitialized(size).release_value();
+    fill_with_random(original.data(), 3000);
+    for (size_t i = 3000; i < size; ++i)
+        original[i] = original[i % 3000] ^ (i / 100000);
+
+    auto compressed = Compress::GzipCompressor::compress_all_in_parallel(original, 4);
+    EXPECT(compressed.has_value());
+    auto uncompressed = Compress::GzipDecompressor::decompress_all(compressed.value());
+    EXPECT(uncompressed.has_value());
+    EXPECT(uncompressed.value() == original);
+}
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/Array.h>
+#include <AK/MemoryStream.h>
+#include <AK/Random.h>
+#include <AK/String.h>
+#include <LibCompress/Lz4.h>
+
+// Compressed by the reference implementation, with block and content checksums as well as the content size.
+static constexpr Array<u8, 53> compressed_hello {
+    0x04, 0x22, 0x4d, 0x18, 0x7c, 0x40, 0x2f, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x6e, 0x16, 0x00, 0x00, 0x00, 0xcf, 0x48, 0x65, 0x6c, 0x6c,
+    0x6f, 0x2c, 0x20, 0x4c, 0x5a, 0x34, 0x21, 0x20, 0x0c, 0x00, 0x0b, 0x50,
+    0x20, 0x4c, 0x5a, 0x34, 0x21, 0xeb, 0x3b, 0x5a, 0x12, 0x00, 0x00, 0x00,
+    0x00, 0xe0, 0xc9, 0x4a, 0xa8
+};
+
+static constexpr StringView uncompressed_hello = "Hello, LZ4! Hello, LZ4! Hello, LZ4! Hello, LZ4!"sv;
+
+static ByteBuffer compressible_data(size_t size)
+{
+    auto buffer = ByteBuffer::create_uninitialized(size).release_value();
+    for (size_t i = 0; i < size; ++i)
+        buffer[i] = (i * 7 / 13) % 251;
+    return buffer;
+}
+
+TEST_CASE(lz4_decompress_reference_frame)
+{
+    EXPECT(Compress::Lz4Decompressor::is_likely_compressed(compressed_hello));
+
+    auto const decompressed = Compress::Lz4Decompressor::decompress_all(compressed_hello);
+    EXPECT(decompressed.value().bytes() == uncompressed_hello.bytes());
+}
+
+TEST_CASE(lz4_decompress_concatenated_and_skippable_frames)
+{
+    Array<u8, 12> const skippable_frame { 0x5a, 0x2a, 0x4d, 0x18, 0x04, 0x00, 0x00, 0x00, 0xde, 0xad, 0xbe, 0xef };
+
+    ByteBuffer compressed;
+    compressed.append(compressed_hello);
+    compressed.append(skippable_frame);
+    compressed.append(compressed_hello);
+
+    auto const decompressed = Compress::Lz4Decompressor::decompress_all(compressed);
+    EXPECT(decompressed.value().bytes() == String::formatted("{}{}", uncompressed_hello, uncompressed_hello).bytes());
+}
+
+TEST_CASE(lz4_decompress_corrupted_frame)
+{
+    auto compressed = ByteBuffer::copy(compressed_hello).release_value();
+    compressed[25] ^= 1;
+    EXPECT(!Compress::Lz4Decompressor::decompress_all(compressed).has_value());
+
+    EXPECT(!Compress::Lz4Decompressor::decompress_all(compressed_hello.span().trim(compressed_hello.size() - 1)).has_value());
+}
+
+TEST_CASE(lz4_round_trip_compressible)
+{
+    auto const original = compressible_data(300 * KiB + 17);
+    auto const compressed = Compress::Lz4Compressor::compress_all(original);
+    EXPECT(compressed.value().size() < original.size() / 2);
+
+    auto const decompressed = Compress::Lz4Decompressor::decompress_all(compressed.value());
+    EXPECT(decompressed.value() == original);
+}
+
+TEST_CASE(lz4_round_trip_random)
+{
+    auto original = ByteBuffer::create_uninitialized(200 * KiB).release_value();
+    fill_with_random(original.data(), original.size());
+
+    auto const compressed = Compress::Lz4Compressor::compress_all(original);
+    auto const decompressed = Compress::Lz4Decompressor::decompress_all(compressed.value());
+    EXPECT(decompressed.value() == original);
+}
+
+TEST_CASE(lz4_round_trip_short_inputs)
+{
+    for (size_t size = 0; size < 40; ++size) {
+        auto const original = compressible_data(size);
+        auto const compressed = Compress::Lz4Compressor::compress_all(original);
+        auto const decompressed = Compress::Lz4Decompressor::decompress_all(compressed.value());
+        EXPECT(decompressed.value() == original);
+    }
+}
+
+TEST_CASE(lz4_streaming_in_small_pieces)
+{
+    auto const original = compressible_data(150 * KiB);
+
+    DuplexMemoryStream compressed_stream;
+    Compress::Lz4Compressor compressor { compressed_stream };
+    for (size_t offset = 0; offset < original.size(); offset += 1000)
+        EXPECT(compressor.write_or_error(original.bytes().slice(offset, min<size_t>(1000, original.size() - offset))));
+    compressor.final_flush();
+    auto const compressed = compressed_stream.copy_into_contiguous_buffer();
+
+    InputMemoryStream input_stream { compressed };
+    Compress::Lz4Decompressor decompressor { input_stream };
+    ByteBuffer decompressed;
+    u8 buffer[777];
+    while (!decompressor.unreliable_eof()) {
+        auto nread = decompressor.read({ buffer, sizeof(buffer) });
+        decompressed.append(buffer, nread);
+        EXPECT(!decompressor.handle_any_error());
+    }
+    EXPECT(decompressed == original);
+}
+
+TEST_CASE(lz4_block_round_trip)
+{
+    auto const original = compressible_data(4096);
+    Array<u8, 4096> compressed;
+    auto const compressed_size = Compress::Lz4Compressor::compress_block(original, compressed);
+    EXPECT(compressed_size.value() < 4096u);
+
+    Array<u8, 4096> decompressed;
+    EXPECT(Compress::Lz4Decompressor::decompress_block(compressed.span().trim(compressed_size.value()), decompressed));
+    EXPECT(decompressed.span() == original.bytes());
+
+    // The decompressed size has to match exactly.
+    EXPECT(!Compress::Lz4Decompressor::decompress_block(compressed.span().trim(compressed_size.value()), decompressed.span().trim(4095)));
+}
@@ -430,6 +430,31 @@ TEST_CASE(buffered_small_file_read)
     EXPECT(!file.can_read_line().value());
 }
 
+TEST_CASE(buffered_small_file_read_line_view)
+{
+    auto maybe_file = Core::Stream::File::open("/usr/Tests/LibCore/small.txt", Core::Stream::OpenMode::Read);
+    EXPECT(!maybe_file.is_error());
+    auto maybe_buffered_file = Core::Stream::BufferedFile::create(maybe_file.release_value());
+    EXPECT(!maybe_buffered_file.is_error());
+    auto file = maybe_buffered_file.release_value();
+
+    static constexpr StringView expected_lines[] {
+        "Well"sv,
+        "hello"sv,
+        "friends!"sv,
+        ":^)"sv
+    };
+
+    for (auto const& line : expected_lines) {
+        auto maybe_line = file.read_line_view();
+        EXPECT(!maybe_line.is_error());
+        EXPECT_EQ(StringView(maybe_line.value()), line);
+    }
+    auto maybe_line = file.read_line_view();
+    EXPECT(!maybe_line.is_error());
+    EXPECT(maybe_line.value().is_empty());
+}
+
 constexpr auto buffered_sent_data = "Well hello friends!\n:^)\nThis shouldn't be present. :^("sv;
 constexpr auto first_line = "Well hello friends!"sv;
 constexpr auto second_line = ":^)"sv;
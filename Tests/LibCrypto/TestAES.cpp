@@ -454,3 +454,25 @@ TEST_CASE(test_AES_GCM_128bit_decrypt_multiple_blocks_with_aad)
     EXPECT(memcmp(result_pt, out.data(), out.size()) == 0);
     EXPECT_EQ(consistency, Crypto::VerificationConsistency::Consistent);
 }
+
+TEST_CASE(test_AES_GCM_128bit_encrypt_decrypt_long_input)
+{
+    // Long enough to go through several chunks of the multi-block implementations, and not a multiple of the block size.
+    Crypto::Cipher::AESCipher::GCMMode cipher("\xfe\xff\xe9\x92\x86\x65\x73\x1c\x6d\x6a\x8f\x94\x67\x30\x83\x08"_b, 128, Crypto::Cipher::Intent::Encryption);
+    u8 result_tag[] { 0xb6, 0x15, 0x2d, 0xba, 0x19, 0xc5, 0x99, 0x4e, 0x79, 0x2a, 0x5d, 0x8a, 0x0e, 0x6f, 0x01, 0x75 };
+    auto in = ByteBuffer::create_uninitialized(10001).release_value();
+    for (size_t i = 0; i < in.size(); ++i)
+        in[i] = static_cast<u8>(i * 7 + i / 13);
+
+    auto tag = ByteBuffer::create_uninitialized(16).release_value();
+    auto out = ByteBuffer::create_uninitialized(in.size()).release_value();
+    auto out_bytes = out.bytes();
+    cipher.encrypt(in, out_bytes, "\xca\xfe\xba\xbe\xfa\xce\xdb\xad\xde\xca\xf8\x88\x00\x00\x00\x00"_b, "\xde\xad\xbe\xef\xfa\xaf\x11\xcc"_b, tag);
+    EXPECT(memcmp(result_tag, tag.data(), tag.size()) == 0);
+
+    auto decrypted = ByteBuffer::create_uninitialized(in.size()).release_value();
+    auto decrypted_bytes = decrypted.bytes();
+    auto consistency = cipher.decrypt(out, decrypted_bytes, "\xca\xfe\xba\xbe\xfa\xce\xdb\xad\xde\xca\xf8\x88\x00\x00\x00\x00"_b, "\xde\xad\xbe\xef\xfa\xaf\x11\xcc"_b, tag);
+    EXPECT_EQ(consistency, Crypto::VerificationConsistency::Consistent);
+    EXPECT(in == decrypted);
+}
@@ -201,6 +201,23 @@ TEST_CASE(test_unsigned_bigint_multiplication_with_big_numbers2)
     EXPECT_EQ(result.words(), expected_result);
 }
 
+TEST_CASE(test_unsigned_bigint_karatsuba_multiplication)
+{
+    // F(n)^2 + F(n+1)^2 = F(2n+1), with operands long enough to go through Karatsuba.
+    Crypto::UnsignedBigInteger num1 = bigint_fibonacci(3000);
+    Crypto::UnsignedBigInteger num2 = bigint_fibonacci(3001);
+    Crypto::UnsignedBigInteger result = num1.multiplied_by(num1).plus(num2.multiplied_by(num2));
+    EXPECT_EQ(result, bigint_fibonacci(6001));
+}
+
+TEST_CASE(test_unsigned_bigint_karatsuba_multiplication_with_different_lengths)
+{
+    // F(m+n) = F(m) * F(n+1) + F(m-1) * F(n), with one operand several times longer than the other.
+    Crypto::UnsignedBigInteger result = bigint_fibonacci(1600).multiplied_by(bigint_fibonacci(5001)).plus(bigint_fibonacci(1599).multiplied_by(bigint_fibonacci(5000)));
+    EXPECT_EQ(result, bigint_fibonacci(6600));
+    EXPECT_EQ(bigint_fibonacci(5001).multiplied_by(bigint_fibonacci(1600)), bigint_fibonacci(1600).multiplied_by(bigint_fibonacci(5001)));
+}
+
 TEST_CASE(test_unsigned_bigint_simple_division)
 {
     Crypto::UnsignedBigInteger num1(27194);
@@ -330,6 +347,16 @@ TEST_CASE(test_bigint_modular_power_extra_tests)
     }
 }
 
+TEST_CASE(test_bigint_large_prime_modular_power)
+{
+    // 2^2203 - 1 is a Mersenne prime, so Fermat's little theorem gives a^(p-1) = 1 (mod p).
+    Crypto::UnsignedBigInteger modulo = Crypto::UnsignedBigInteger(1).shift_left(2203).minus(1);
+    Crypto::UnsignedBigInteger exponent = modulo.minus(1);
+    EXPECT_EQ(Crypto::NumberTheory::ModularPower(bigint_fibonacci(3000), exponent, modulo), 1);
+    EXPECT_EQ(Crypto::NumberTheory::ModularPower(3, exponent, modulo), 1);
+    EXPECT_EQ(Crypto::NumberTheory::ModularPower(3, modulo, modulo), 3);
+}
+
 TEST_CASE(test_bigint_primality_test)
 {
     struct {
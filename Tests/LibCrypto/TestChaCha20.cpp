@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Hex.h>
+#include <LibCrypto/Cipher/ChaCha20.h>
+#include <LibCrypto/Cipher/ChaCha20Poly1305.h>
+#include <LibTest/TestCase.h>
+#include <cstring>
+
+static ByteBuffer operator""_hex(const char* string, size_t length)
+{
+    return decode_hex({ string, length }).release_value();
+}
+
+// RFC 8439 section 2.4.2
+static constexpr StringView sunscreen = "Ladies and Gentlemen of the class of '99: If I could offer you only one tip for the future, sunscreen would be it."sv;
+
+TEST_CASE(test_chacha20_encrypt)
+{
+    u8 key[32];
+    for (size_t i = 0; i < sizeof(key); ++i)
+        key[i] = i;
+
+    auto expected = "6e2e359a2568f98041ba0728dd0d6981e97e7aec1d4360c20a27afccfd9fae0bf91b65c5524733ab8f593dabcd62b3571639d624e65152ab8f530c359f0861d807ca0dbf500d6a6156a38e088a22b65e52bc514d16ccf806818ce91ab77937365af90bbf74a35be6b40b8eedf2785e42874d"_hex;
+
+    Crypto::Cipher::ChaCha20 cipher({ key, sizeof(key) }, "000000000000004a00000000"_hex, 1);
+    auto output = ByteBuffer::create_uninitialized(sunscreen.length()).release_value();
+    cipher.encrypt(sunscreen.bytes(), output);
+    EXPECT_EQ(output, expected);
+}
+
+TEST_CASE(test_chacha20_encrypt_in_pieces)
+{
+    u8 key[32];
+    for (size_t i = 0; i < sizeof(key); ++i)
+        key[i] = i;
+
+    auto expected = "6e2e359a2568f98041ba0728dd0d6981e97e7aec1d4360c20a27afccfd9fae0bf91b65c5524733ab8f593dabcd62b3571639d624e65152ab8f530c359f0861d807ca0dbf500d6a6156a38e088a22b65e52bc514d16ccf806818ce91ab77937365af90bbf74a35be6b40b8eedf2785e42874d"_hex;
+
+    // Crossing block boundaries between calls must not lose keystream bytes.
+    Crypto::Cipher::ChaCha20 cipher({ key, sizeof(key) }, "000000000000004a00000000"_hex, 1);
+    auto output = ByteBuffer::create_uninitialized(sunscreen.length()).release_value();
+    cipher.encrypt(sunscreen.bytes().trim(10), output.bytes().trim(10));
+    cipher.encrypt(sunscreen.bytes().slice(10, 60), output.bytes().slice(10, 60));
+    cipher.encrypt(sunscreen.bytes().slice(70), output.bytes().slice(70));
+    EXPECT_EQ(output, expected);
+}
+
+TEST_CASE(test_chacha20_poly1305_encrypt)
+{
+    u8 key[32];
+    for (size_t i = 0; i < sizeof(key); ++i)
+        key[i] = 0x80 + i;
+
+    auto expected_ciphertext = "d31a8d34648e60db7b86afbc53ef7ec2a4aded51296e08fea9e2b5a736ee62d63dbea45e8ca9671282fafb69da92728b1a71de0a9e060b2905d6a5b67ecd3b3692ddbd7f2d778b8c9803aee328091b58fab324e4fad675945585808b4831d7bc3ff4def08e4b7a9de576d26586cec64b6116"_hex;
+    auto expected_tag = "1ae10b594f09e26a7e902ecbd0600691"_hex;
+
+    Crypto::Cipher::ChaCha20Poly1305 cipher({ key, sizeof(key) });
+    auto ciphertext = ByteBuffer::create_uninitialized(sunscreen.length()).release_value();
+    u8 tag[16];
+    cipher.encrypt(sunscreen.bytes(), ciphertext, "070000004041424344454647"_hex, "50515253c0c1c2c3c4c5c6c7"_hex, { tag, sizeof(tag) });
+    EXPECT_EQ(ciphertext, expected_ciphertext);
+    EXPECT_EQ(ReadonlyBytes(tag, sizeof(tag)), expected_tag.bytes());
+}
+
+TEST_CASE(test_chacha20_poly1305_decrypt)
+{
+    u8 key[32];
+    for (size_t i = 0; i < sizeof(key); ++i)
+        key[i] = 0x80 + i;
+
+    auto ciphertext = "d31a8d34648e60db7b86afbc53ef7ec2a4aded51296e08fea9e2b5a736ee62d63dbea45e8ca9671282fafb69da92728b1a71de0a9e060b2905d6a5b67ecd3b3692ddbd7f2d778b8c9803aee328091b58fab324e4fad675945585808b4831d7bc3ff4def08e4b7a9de576d26586cec64b6116"_hex;
+    auto tag = "1ae10b594f09e26a7e902ecbd0600691"_hex;
+
+    Crypto::Cipher::ChaCha20Poly1305 cipher({ key, sizeof(key) });
+    auto plaintext = ByteBuffer::create_uninitialized(ciphertext.size()).release_value();
+    auto consistency = cipher.decrypt(ciphertext, plaintext, "070000004041424344454647"_hex, "50515253c0c1c2c3c4c5c6c7"_hex, tag);
+    EXPECT_EQ(consistency, Crypto::VerificationConsistency::Consistent);
+    EXPECT_EQ(plaintext.bytes(), sunscreen.bytes());
+}
+
+TEST_CASE(test_chacha20_poly1305_decrypt_tampered)
+{
+    u8 key[32];
+    for (size_t i = 0; i < sizeof(key); ++i)
+        key[i] = 0x80 + i;
+
+    auto ciphertext = "d31a8d34648e60db7b86afbc53ef7ec2a4aded51296e08fea9e2b5a736ee62d63dbea45e8ca9671282fafb69da92728b1a71de0a9e060b2905d6a5b67ecd3b3692ddbd7f2d778b8c9803aee328091b58fab324e4fad675945585808b4831d7bc3ff4def08e4b7a9de576d26586cec64b6116"_hex;
+    auto tag = "1ae10b594f09e26a7e902ecbd0600691"_hex;
+    ciphertext[7] ^= 1;
+
+    Crypto::Cipher::ChaCha20Poly1305 cipher({ key, sizeof(key) });
+    auto plaintext = ByteBuffer::create_uninitialized(ciphertext.size()).release_value();
+    auto consistency = cipher.decrypt(ciphertext, plaintext, "070000004041424344454647"_hex, "50515253c0c1c2c3c4c5c6c7"_hex, tag);
+    EXPECT_EQ(consistency, Crypto::VerificationConsistency::Inconsistent);
+}
@@ -6,6 +6,7 @@
 
 #include <LibCrypto/Checksum/Adler32.h>
 #include <LibCrypto/Checksum/CRC32.h>
+#include <LibCrypto/Checksum/XXHash32.h>
 #include <LibTest/TestCase.h>
 
 TEST_CASE(test_adler32)
@@ -33,3 +34,52 @@ TEST_CASE(test_crc32)
     do_test(String("The quick brown fox jumps over the lazy dog").bytes(), 0x414FA339);
     do_test(String("various CRC algorithms input data").bytes(), 0x9BD366AE);
 }
+
+TEST_CASE(test_xxhash32)
+{
+    auto do_test = [](ReadonlyBytes input, u32 expected_result) {
+        auto digest = Crypto::Checksum::XXHash32(input).digest();
+        EXPECT_EQ(digest, expected_result);
+    };
+
+    do_test(String("").bytes(), 0x02CC5D05);
+    do_test(String("a").bytes(), 0x550D7456);
+    do_test(String("abc").bytes(), 0x32D153FF);
+    do_test(String("Nobody inspects the spammish repetition").bytes(), 0xE2293B2F);
+}
+
+// Long enough inputs to go through the vectorized implementations, with lengths that leave a remainder for the scalar ones.
+static ByteBuffer long_checksum_input(bool all_ones)
+{
+    auto buffer = ByteBuffer::create_uninitialized(10000).release_value();
+    for (size_t i = 0; i < buffer.size(); ++i)
+        buffer[i] = all_ones ? 0xff : static_cast<u8>(i * 7 + i / 13);
+    return buffer;
+}
+
+TEST_CASE(test_adler32_long_input)
+{
+    EXPECT_EQ(Crypto::Checksum::Adler32(long_checksum_input(false)).digest(), 0x97036c69u);
+    EXPECT_EQ(Crypto::Checksum::Adler32(long_checksum_input(true)).digest(), 0xb623eb2bu);
+}
+
+TEST_CASE(test_crc32_long_input)
+{
+    EXPECT_EQ(Crypto::Checksum::CRC32(long_checksum_input(false)).digest(), 0x615a7563u);
+    EXPECT_EQ(Crypto::Checksum::CRC32(long_checksum_input(true)).digest(), 0x133c790du);
+
+    auto input = long_checksum_input(false);
+    Crypto::Checksum::CRC32 crc32;
+    crc32.update(input.bytes().slice(0, 123));
+    crc32.update(input.bytes().slice(123));
+    EXPECT_EQ(crc32.digest(), 0x615a7563u);
+}
+
+TEST_CASE(test_xxhash32_in_pieces)
+{
+    auto input = long_checksum_input(false);
+    Crypto::Checksum::XXHash32 checksum;
+    for (size_t offset = 0; offset < input.size(); offset += 7)
+        checksum.update(input.bytes().slice(offset, min<size_t>(7, input.size() - offset)));
+    EXPECT_EQ(checksum.digest(), Crypto::Checksum::XXHash32(input).digest());
+}
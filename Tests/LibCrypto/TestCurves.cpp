@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Hex.h>
+#include <LibCrypto/Curves/X25519.h>
+#include <LibTest/TestCase.h>
+#include <cstring>
+
+static ByteBuffer operator""_hex(const char* string, size_t length)
+{
+    return decode_hex({ string, length }).release_value();
+}
+
+// RFC 7748 section 5.2
+TEST_CASE(test_x25519)
+{
+    u8 output[32];
+
+    Crypto::Curves::X25519::compute_coordinate(
+        "a546e36bf0527c9d3b16154b82465edd62144c0ac1fc5a18506a2244ba449ac4"_hex,
+        "e6db6867583030db3594c1a424b15f7c726624ec26b3353b10a903a6d0ab1c4c"_hex,
+        { output, sizeof(output) });
+    EXPECT_EQ(ReadonlyBytes(output, sizeof(output)), "c3da55379de9c6908e94ea4df28d084f32eccf03491c71f754b4075577a28552"_hex.bytes());
+
+    Crypto::Curves::X25519::compute_coordinate(
+        "4b66e9d4d1b4673c5ad22691957d6af5c11b6421e0ea01d42ca4169e7918ba0d"_hex,
+        "e5210f12786811d3f4b7959d0538ae2c31dbe7106fc03c3efc4cd549c715a493"_hex,
+        { output, sizeof(output) });
+    EXPECT_EQ(ReadonlyBytes(output, sizeof(output)), "95cbde9476e8907d7aade45cb4b873f88b595a68799fa152e6f8f7647aac7957"_hex.bytes());
+}
+
+TEST_CASE(test_x25519_iterated)
+{
+    u8 k[32] = { 9 };
+    u8 u[32] = { 9 };
+    u8 result[32];
+
+    for (size_t i = 0; i < 1000; ++i) {
+        Crypto::Curves::X25519::compute_coordinate({ k, sizeof(k) }, { u, sizeof(u) }, { result, sizeof(result) });
+        memcpy(u, k, sizeof(k));
+        memcpy(k, result, sizeof(result));
+        if (i == 0)
+            EXPECT_EQ(ReadonlyBytes(k, sizeof(k)), "422c8e7a6227d7bca1350b3e2bb7279f7897b87bb6854b783c60e80311ae3079"_hex.bytes());
+    }
+    EXPECT_EQ(ReadonlyBytes(k, sizeof(k)), "684cf59ba83309552800ef566f2f4d3c1c3887c49360e3875f2eb94d99532c51"_hex.bytes());
+}
+
+// RFC 7748 section 6.1
+TEST_CASE(test_x25519_diffie_hellman)
+{
+    auto alice_private_key = "77076d0a7318a57d3c16c17251b26645df4c2f87ebc0992ab177fba51db92c2a"_hex;
+    auto bob_private_key = "5dab087e624a8a4b79e17f8b83800ee66f3bb1292618b6fd1c2f8b27ff88e0eb"_hex;
+
+    u8 alice_public_key[32];
+    u8 bob_public_key[32];
+    Crypto::Curves::X25519::generate_public_key(alice_private_key, { alice_public_key, sizeof(alice_public_key) });
+    Crypto::Curves::X25519::generate_public_key(bob_private_key, { bob_public_key, sizeof(bob_public_key) });
+    EXPECT_EQ(ReadonlyBytes(alice_public_key, 32), "8520f0098930a754748b7ddcb43ef75a0dbf3a0d26381af4eba4a98eaa9b4e6a"_hex.bytes());
+    EXPECT_EQ(ReadonlyBytes(bob_public_key, 32), "de9edb7d7b7dc1b4d35b61c2ece435373f8343c85b78674dadfc7e146f882b4f"_hex.bytes());
+
+    u8 alice_shared_secret[32];
+    u8 bob_shared_secret[32];
+    Crypto::Curves::X25519::compute_coordinate(alice_private_key, { bob_public_key, sizeof(bob_public_key) }, { alice_shared_secret, sizeof(alice_shared_secret) });
+    Crypto::Curves::X25519::compute_coordinate(bob_private_key, { alice_public_key, sizeof(alice_public_key) }, { bob_shared_secret, sizeof(bob_shared_secret) });
+    EXPECT_EQ(ReadonlyBytes(alice_shared_secret, 32), "4a5d9d5ba4ce2de1728e3bf480350f25e07e21c947d19e3376f09b3c1e161742"_hex.bytes());
+    EXPECT_EQ(ReadonlyBytes(bob_shared_secret, 32), "4a5d9d5ba4ce2de1728e3bf480350f25e07e21c947d19e3376f09b3c1e161742"_hex.bytes());
+}
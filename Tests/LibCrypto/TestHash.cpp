@@ -4,8 +4,10 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Hex.h>
 #include <LibCrypto/Authentication/GHash.h>
 #include <LibCrypto/Authentication/HMAC.h>
+#include <LibCrypto/Hash/HashManager.h>
 #include <LibCrypto/Hash/MD5.h>
 #include <LibCrypto/Hash/SHA1.h>
 #include <LibCrypto/Hash/SHA2.h>
@@ -230,3 +232,62 @@ TEST_CASE(test_ghash_galois_field_multiply2)
     Crypto::Authentication::galois_multiply(z, x, y);
     EXPECT(memcmp(result, z, 4 * sizeof(u32)) == 0);
 }
+
+static ByteBuffer long_hash_input(size_t size)
+{
+    auto buffer = ByteBuffer::create_uninitialized(size).release_value();
+    for (size_t i = 0; i < buffer.size(); ++i)
+        buffer[i] = static_cast<u8>(i * 7 + i / 13);
+    return buffer;
+}
+
+// Long enough to go through the whole-block paths, split so that the second update starts in the middle of a block.
+TEST_CASE(test_hash_manager_long_input)
+{
+    auto input = long_hash_input(10000);
+    auto hash = [&](Crypto::Hash::HashKind kind) {
+        Crypto::Hash::Manager manager(kind);
+        manager.update(input.bytes().slice(0, 123));
+        manager.update(input.bytes().slice(123));
+        return encode_hex(manager.digest().bytes());
+    };
+
+    EXPECT_EQ(hash(Crypto::Hash::HashKind::SHA1), "f052918134d85a25f4250672c9e08d05f649879c");
+    EXPECT_EQ(hash(Crypto::Hash::HashKind::SHA256), "1883f95754b149830b05d00bc066ec3c555c4c9d8dcb414dec9fc2943cdd56f8");
+    EXPECT_EQ(hash(Crypto::Hash::HashKind::SHA384), "868d92e0de904349b2281dacceba0e8397a54c3305203c0c41cbcfc39bf3663087bc6017ca9df990c23441be1a3dea4b");
+    EXPECT_EQ(hash(Crypto::Hash::HashKind::SHA512), "2bb472c07bc1ffee8a496cb3855b16e817be37b471a713a9c9895b041991031d405b2d7e1f62293cd9dcdd9bccf64b34b0c1058dce4cba191ea54aa04bbbbae5");
+}
+
+static void hash_many_megabytes(Crypto::Hash::HashKind kind)
+{
+    auto input = long_hash_input(1 * MiB);
+    Crypto::Hash::Manager manager(kind);
+    for (size_t i = 0; i < 64; ++i)
+        manager.update(input);
+    EXPECT_EQ(manager.digest().bytes().size(), manager.digest_size());
+}
+
+BENCHMARK_CASE(benchmark_md5)
+{
+    hash_many_megabytes(Crypto::Hash::HashKind::MD5);
+}
+
+BENCHMARK_CASE(benchmark_sha1)
+{
+    hash_many_megabytes(Crypto::Hash::HashKind::SHA1);
+}
+
+BENCHMARK_CASE(benchmark_sha256)
+{
+    hash_many_megabytes(Crypto::Hash::HashKind::SHA256);
+}
+
+BENCHMARK_CASE(benchmark_sha384)
+{
+    hash_many_megabytes(Crypto::Hash::HashKind::SHA384);
+}
+
+BENCHMARK_CASE(benchmark_sha512)
+{
+    hash_many_megabytes(Crypto::Hash::HashKind::SHA512);
+}
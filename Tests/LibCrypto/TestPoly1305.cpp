@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Hex.h>
+#include <LibCrypto/Authentication/Poly1305.h>
+#include <LibTest/TestCase.h>
+
+static ByteBuffer operator""_hex(const char* string, size_t length)
+{
+    return decode_hex({ string, length }).release_value();
+}
+
+// RFC 8439 section 2.5.2
+TEST_CASE(test_poly1305)
+{
+    Crypto::Authentication::Poly1305 poly1305("85d6be7857556d337f4452fe42d506a80103808afb0db2fd4abff6af4149f51b"_hex);
+    poly1305.update("Cryptographic Forum Research Group"sv.bytes());
+    auto tag = poly1305.digest();
+    EXPECT_EQ(ReadonlyBytes(tag.data(), tag.size()), "a8061dc1305136c6c22b8baf0c0127a9"_hex.bytes());
+}
+
+TEST_CASE(test_poly1305_in_pieces)
+{
+    auto message = "Cryptographic Forum Research Group"sv.bytes();
+    Crypto::Authentication::Poly1305 poly1305("85d6be7857556d337f4452fe42d506a80103808afb0db2fd4abff6af4149f51b"_hex);
+    poly1305.update(message.trim(5));
+    poly1305.update(message.slice(5, 20));
+    poly1305.update(message.slice(25));
+    auto tag = poly1305.digest();
+    EXPECT_EQ(ReadonlyBytes(tag.data(), tag.size()), "a8061dc1305136c6c22b8baf0c0127a9"_hex.bytes());
+}
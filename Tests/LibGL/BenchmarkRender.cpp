@@ -0,0 +1,277 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/Array.h>
+#include <AK/Format.h>
+#include <AK/Function.h>
+#include <AK/Math.h>
+#include <AK/StringView.h>
+#include <AK/Vector.h>
+#include <LibCore/ElapsedTimer.h>
+#include <LibGL/GL/gl.h>
+#include <LibGL/GLContext.h>
+#include <LibGL/SoftwareGLContext.h>
+#include <LibGfx/Bitmap.h>
+
+static constexpr int frame_count = 30;
+
+static Array<Gfx::IntSize, 2> const render_sizes {
+    Gfx::IntSize { 320, 240 },
+    Gfx::IntSize { 640, 480 },
+};
+
+static u32 s_random_state = 1;
+
+static float random_float()
+{
+    s_random_state = s_random_state * 1103515245 + 12345;
+    return static_cast<float>((s_random_state >> 8) & 0xffff) / 0xffff;
+}
+
+static double milliseconds_per_frame(Time const& time)
+{
+    return time.to_nanoseconds() / 1'000'000.0 / frame_count;
+}
+
+// Renders frame_count frames of a scene at every size in render_sizes, and reports the frame rate together
+// with the time spent in each stage of the device.
+static void run_scene(StringView name, Function<void()> set_up, Function<void(int frame)> draw_frame)
+{
+    for (auto size : render_sizes) {
+        auto bitmap = MUST(Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRx8888, size));
+        auto context = GL::create_context(*bitmap);
+        GL::make_context_current(context);
+
+        glViewport(0, 0, size.width(), size.height());
+        set_up();
+
+        // Render one frame up front, so that one-time allocations don't end up in the measurement
+        draw_frame(0);
+        context->present();
+        EXPECT_EQ(glGetError(), 0u);
+
+        auto& software_context = static_cast<GL::SoftwareGLContext&>(*context);
+        software_context.reset_device_statistics();
+
+        Core::ElapsedTimer timer { true };
+        timer.start();
+        for (int frame = 1; frame <= frame_count; ++frame) {
+            draw_frame(frame);
+            context->present();
+        }
+        auto total_time = timer.elapsed_time();
+        EXPECT_EQ(glGetError(), 0u);
+
+        auto const& statistics = software_context.device_statistics();
+        auto const ms_per_frame = milliseconds_per_frame(total_time);
+        outln("{} {}x{}: {:.2}ms/frame ({:.1} fps), vertices {:.2}ms, rasterization {:.2}ms, present {:.2}ms, {} triangles/frame",
+            name, size.width(), size.height(), ms_per_frame, 1000.0 / ms_per_frame,
+            milliseconds_per_frame(statistics.vertex_processing_time),
+            milliseconds_per_frame(statistics.rasterization_time),
+            milliseconds_per_frame(statistics.present_time),
+            statistics.num_triangles / frame_count);
+
+        GL::make_context_current(nullptr);
+    }
+}
+
+static void set_up_perspective(float aspect_ratio)
+{
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    glFrustum(-0.5 * aspect_ratio, 0.5 * aspect_ratio, -0.5, 0.5, 1, 100);
+    glMatrixMode(GL_MODELVIEW);
+}
+
+static void draw_cube()
+{
+    static constexpr Array<Array<float, 3>, 8> corners { {
+        { -1, -1, -1 },
+        { 1, -1, -1 },
+        { 1, 1, -1 },
+        { -1, 1, -1 },
+        { -1, -1, 1 },
+        { 1, -1, 1 },
+        { 1, 1, 1 },
+        { -1, 1, 1 },
+    } };
+    static constexpr Array<Array<int, 4>, 6> faces { {
+        { 0, 3, 2, 1 },
+        { 4, 5, 6, 7 },
+        { 0, 1, 5, 4 },
+        { 2, 3, 7, 6 },
+        { 0, 4, 7, 3 },
+        { 1, 2, 6, 5 },
+    } };
+    static constexpr Array<Array<float, 2>, 4> tex_coords { {
+        { 0, 0 },
+        { 1, 0 },
+        { 1, 1 },
+        { 0, 1 },
+    } };
+
+    glBegin(GL_QUADS);
+    for (auto const& face : faces) {
+        for (size_t i = 0; i < face.size(); ++i) {
+            auto const& corner = corners[face[i]];
+            glTexCoord2f(tex_coords[i][0], tex_coords[i][1]);
+            glVertex3f(corner[0], corner[1], corner[2]);
+        }
+    }
+    glEnd();
+}
+
+BENCHMARK_CASE(textured_cube_field)
+{
+    GLuint texture = 0;
+
+    auto set_up = [&] {
+        static constexpr int texture_size = 128;
+        Vector<u32> texels;
+        texels.resize(texture_size * texture_size);
+        for (int y = 0; y < texture_size; ++y) {
+            for (int x = 0; x < texture_size; ++x)
+                texels[y * texture_size + x] = ((x / 16 + y / 16) % 2) ? 0xff20c0e0 : 0xff303030;
+        }
+
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, texture_size, texture_size, 0, GL_RGBA, GL_UNSIGNED_BYTE, texels.data());
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glEnable(GL_TEXTURE_2D);
+
+        glEnable(GL_DEPTH_TEST);
+        glEnable(GL_CULL_FACE);
+        glClearColor(0, 0, 0, 1);
+        set_up_perspective(4.0f / 3);
+    };
+
+    auto draw_frame = [](int frame) {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        for (int z = 0; z < 10; ++z) {
+            for (int x = 0; x < 10; ++x) {
+                glLoadIdentity();
+                glTranslatef((x - 4.5f) * 3, -2, -5 - z * 3);
+                glRotatef(frame * 3 + x * 10 + z * 20, 0, 1, 0);
+                draw_cube();
+            }
+        }
+    };
+
+    run_scene("textured cube field"sv, move(set_up), move(draw_frame));
+}
+
+BENCHMARK_CASE(alpha_blended_particles)
+{
+    static constexpr int particle_count = 2000;
+
+    struct Particle {
+        float x;
+        float y;
+        float z;
+        float size;
+        Array<float, 4> color;
+    };
+    Vector<Particle> particles;
+
+    auto set_up = [&] {
+        particles.clear();
+        for (int i = 0; i < particle_count; ++i) {
+            particles.append({
+                random_float() * 8 - 4,
+                random_float() * 6 - 3,
+                -3 - random_float() * 10,
+                0.1f + random_float() * 0.4f,
+                { random_float(), random_float(), random_float(), 0.25f + random_float() * 0.5f },
+            });
+        }
+
+        glEnable(GL_DEPTH_TEST);
+        glDepthMask(GL_FALSE);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glClearColor(0, 0, 0, 1);
+        set_up_perspective(4.0f / 3);
+    };
+
+    auto draw_frame = [&](int frame) {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        glLoadIdentity();
+        glBegin(GL_QUADS);
+        for (auto const& particle : particles) {
+            auto const y = particle.y + AK::sin(frame * 0.1f + particle.x) * 0.2f;
+            auto const half_size = particle.size / 2;
+            glColor4f(particle.color[0], particle.color[1], particle.color[2], particle.color[3]);
+            glVertex3f(particle.x - half_size, y - half_size, particle.z);
+            glVertex3f(particle.x + half_size, y - half_size, particle.z);
+            glVertex3f(particle.x + half_size, y + half_size, particle.z);
+            glVertex3f(particle.x - half_size, y + half_size, particle.z);
+        }
+        glEnd();
+    };
+
+    run_scene("alpha blended particles"sv, move(set_up), move(draw_frame));
+}
+
+BENCHMARK_CASE(lit_high_polygon_mesh)
+{
+    static constexpr int rings = 96;
+    static constexpr int segments = 128;
+
+    GLuint list = 0;
+
+    auto set_up = [&] {
+        // A unit sphere made of one triangle strip per ring, where every position doubles as its normal
+        auto sphere_vertex = [](int ring, int segment) {
+            auto const theta = ring * AK::Pi<float> / rings;
+            auto const phi = segment * 2 * AK::Pi<float> / segments;
+            auto const x = AK::sin(theta) * AK::cos(phi);
+            auto const y = AK::cos(theta);
+            auto const z = AK::sin(theta) * AK::sin(phi);
+            glNormal3f(x, y, z);
+            glVertex3f(x, y, z);
+        };
+
+        list = glGenLists(1);
+        glNewList(list, GL_COMPILE);
+        for (int ring = 0; ring < rings; ++ring) {
+            glBegin(GL_TRIANGLE_STRIP);
+            for (int segment = 0; segment <= segments; ++segment) {
+                sphere_vertex(ring, segment);
+                sphere_vertex(ring + 1, segment);
+            }
+            glEnd();
+        }
+        glEndList();
+
+        glEnable(GL_DEPTH_TEST);
+        glEnable(GL_LIGHTING);
+        glEnable(GL_LIGHT0);
+        glEnable(GL_LIGHT1);
+        GLfloat const light0_position[] = { 1, 1, 1, 0 };
+        GLfloat const light1_position[] = { -2, 0, 0, 1 };
+        GLfloat const light1_diffuse[] = { 0.8f, 0.2f, 0.2f, 1 };
+        glLightfv(GL_LIGHT0, GL_POSITION, light0_position);
+        glLightfv(GL_LIGHT1, GL_POSITION, light1_position);
+        glLightfv(GL_LIGHT1, GL_DIFFUSE, light1_diffuse);
+
+        glClearColor(0, 0, 0, 1);
+        set_up_perspective(4.0f / 3);
+    };
+
+    auto draw_frame = [&](int frame) {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        glLoadIdentity();
+        glTranslatef(0, 0, -3);
+        glRotatef(frame * 2, 0, 1, 0);
+        glCallList(list);
+    };
+
+    run_scene("lit high polygon mesh"sv, move(set_up), move(draw_frame));
+}
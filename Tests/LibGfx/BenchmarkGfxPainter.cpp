@@ -61,3 +61,33 @@ BENCHMARK_CASE(fill_with_gradient)
         painter.fill_rect_with_gradient(bitmap->rect(), Color::Blue, Color::Red);
     }
 }
+
+BENCHMARK_CASE(draw_scaled_bitmap_bilinear)
+{
+    const int run_count = 20;
+    const int bitmap_size = 2000;
+
+    auto bitmap = Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRx8888, { bitmap_size, bitmap_size }).release_value_but_fixme_should_propagate_errors();
+    auto source = Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRA8888, { bitmap_size / 3, bitmap_size / 3 }).release_value_but_fixme_should_propagate_errors();
+    source->fill(Color::from_rgba(0x80ff8000));
+    Gfx::Painter painter(bitmap);
+
+    for (int run = 0; run < run_count; run++) {
+        painter.draw_scaled_bitmap(bitmap->rect(), *source, source->rect(), 1.0f, Gfx::Painter::ScalingMode::BilinearBlend);
+    }
+}
+
+BENCHMARK_CASE(draw_scaled_bitmap_box_sampling)
+{
+    const int run_count = 20;
+    const int bitmap_size = 2000;
+
+    auto bitmap = Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRx8888, { bitmap_size / 8, bitmap_size / 8 }).release_value_but_fixme_should_propagate_errors();
+    auto source = Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRA8888, { bitmap_size, bitmap_size }).release_value_but_fixme_should_propagate_errors();
+    source->fill(Color::from_rgba(0x80ff8000));
+    Gfx::Painter painter(bitmap);
+
+    for (int run = 0; run < run_count; run++) {
+        painter.draw_scaled_bitmap(bitmap->rect(), *source, source->rect(), 1.0f, Gfx::Painter::ScalingMode::BoxSampling);
+    }
+}
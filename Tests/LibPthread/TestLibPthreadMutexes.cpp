@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Array.h>
+#include <LibPthread/pthread.h>
+#include <LibTest/TestCase.h>
+#include <unistd.h>
+
+static constexpr size_t thread_count = 8;
+static constexpr size_t increments_per_thread = 20000;
+
+struct SharedCounter {
+    pthread_mutex_t mutex;
+    size_t value { 0 };
+    size_t in_critical_section { 0 };
+    bool saw_overlap { false };
+};
+
+static void* increment_counter(void* argument)
+{
+    auto& counter = *static_cast<SharedCounter*>(argument);
+    for (size_t i = 0; i < increments_per_thread; ++i) {
+        EXPECT_EQ(pthread_mutex_lock(&counter.mutex), 0);
+        if (counter.in_critical_section++ != 0)
+            counter.saw_overlap = true;
+        ++counter.value;
+        // Hold the mutex a little longer now and then, so that others give up spinning and sleep.
+        if (i % 1000 == 0)
+            usleep(100);
+        --counter.in_critical_section;
+        EXPECT_EQ(pthread_mutex_unlock(&counter.mutex), 0);
+    }
+    return nullptr;
+}
+
+static void run_contended_counter(int type)
+{
+    SharedCounter counter;
+    pthread_mutexattr_t attributes;
+    pthread_mutexattr_init(&attributes);
+    pthread_mutexattr_settype(&attributes, type);
+    EXPECT_EQ(pthread_mutex_init(&counter.mutex, &attributes), 0);
+
+    Array<pthread_t, thread_count> threads;
+    for (auto& thread : threads)
+        EXPECT_EQ(pthread_create(&thread, nullptr, increment_counter, &counter), 0);
+    for (auto thread : threads)
+        EXPECT_EQ(pthread_join(thread, nullptr), 0);
+
+    EXPECT(!counter.saw_overlap);
+    EXPECT_EQ(counter.value, thread_count * increments_per_thread);
+    EXPECT_EQ(pthread_mutex_destroy(&counter.mutex), 0);
+}
+
+TEST_CASE(contended_normal_mutex)
+{
+    run_contended_counter(PTHREAD_MUTEX_NORMAL);
+}
+
+TEST_CASE(contended_recursive_mutex)
+{
+    run_contended_counter(PTHREAD_MUTEX_RECURSIVE);
+}
@@ -6,6 +6,8 @@
 
 #include <LibPthread/pthread.h>
 #include <LibTest/TestCase.h>
+#include <errno.h>
+#include <time.h>
 
 TEST_CASE(rwlock_init)
 {
@@ -88,3 +90,43 @@ TEST_CASE(rwlock_wrlock_init_in_once)
     result = pthread_rwlock_unlock(&lock);
     EXPECT_EQ(0, result);
 }
+
+TEST_CASE(rwlock_try_locks)
+{
+    pthread_rwlock_t lock = PTHREAD_RWLOCK_INITIALIZER;
+
+    EXPECT_EQ(0, pthread_rwlock_rdlock(&lock));
+    EXPECT_EQ(0, pthread_rwlock_tryrdlock(&lock));
+    EXPECT_EQ(EBUSY, pthread_rwlock_trywrlock(&lock));
+    EXPECT_EQ(0, pthread_rwlock_unlock(&lock));
+    EXPECT_EQ(0, pthread_rwlock_unlock(&lock));
+
+    EXPECT_EQ(0, pthread_rwlock_trywrlock(&lock));
+    EXPECT_EQ(EBUSY, pthread_rwlock_tryrdlock(&lock));
+    EXPECT_EQ(EBUSY, pthread_rwlock_trywrlock(&lock));
+    EXPECT_EQ(0, pthread_rwlock_unlock(&lock));
+
+    EXPECT_EQ(EINVAL, pthread_rwlock_unlock(&lock));
+}
+
+TEST_CASE(rwlock_timed_wrlock_times_out)
+{
+    pthread_rwlock_t lock = PTHREAD_RWLOCK_INITIALIZER;
+    EXPECT_EQ(0, pthread_rwlock_rdlock(&lock));
+
+    timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_nsec += 10'000'000;
+    if (deadline.tv_nsec >= 1'000'000'000) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1'000'000'000;
+    }
+    EXPECT_EQ(ETIMEDOUT, pthread_rwlock_timedwrlock(&lock, &deadline));
+
+    // The writer gave up, so it must not hold back new readers.
+    EXPECT_EQ(0, pthread_rwlock_unlock(&lock));
+    EXPECT_EQ(0, pthread_rwlock_tryrdlock(&lock));
+    EXPECT_EQ(0, pthread_rwlock_unlock(&lock));
+    EXPECT_EQ(0, pthread_rwlock_trywrlock(&lock));
+    EXPECT_EQ(0, pthread_rwlock_unlock(&lock));
+}
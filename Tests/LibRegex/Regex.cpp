@@ -941,6 +941,36 @@ TEST_CASE(optimizer_char_class_lut)
         EXPECT_EQ(re.match("1635488940000"sv).success, false);
 }
 
+TEST_CASE(optimizer_literals)
+{
+    Array tests {
+        // Pattern, literal prefix, required literal
+        Tuple { "ERROR.*timeout"sv, "ERROR"sv, "timeout"sv },
+        Tuple { "^GET /index\\.html"sv, "GET /index.html"sv, "GET /index.html"sv },
+        Tuple { "x(foo|bar)yz"sv, "x"sv, "yz"sv },
+        Tuple { "a?bcd"sv, StringView {}, "bcd"sv },
+        Tuple { "[0-9]+ms"sv, StringView {}, "ms"sv },
+        Tuple { "hello|world"sv, StringView {}, StringView {} },
+        Tuple { "foo(?=bar)"sv, StringView {}, StringView {} },
+    };
+
+    for (auto& test : tests) {
+        Regex<ECMA262> re(test.get<0>());
+        EXPECT_EQ(re.parser_result.optimization_data.literal_prefix, test.get<1>());
+        EXPECT_EQ(re.parser_result.optimization_data.required_literal, test.get<2>());
+    }
+
+    Regex<PosixExtended> re("ERROR.*timeout", PosixFlags::Global | PosixFlags::Multiline);
+    auto result = re.match("INFO ok\nERROR: ERROR in timeout\nERROR: connection reset\nWARN timeout\n");
+    EXPECT_EQ(result.count, 1u);
+    EXPECT_EQ(result.matches.first().view, "ERROR: ERROR in timeout"sv);
+    EXPECT_EQ(result.matches.first().line, 1u);
+
+    // Case-insensitive matches can't search for the literals as they are.
+    result = re.match("error: Timeout\n", PosixFlags::Global | PosixFlags::Multiline | PosixFlags::Insensitive);
+    EXPECT_EQ(result.count, 1u);
+}
+
 TEST_CASE(posix_basic_dollar_is_end_anchor)
 {
     // Ensure that a dollar sign at the end only matches the end of the line.
@@ -984,3 +1014,110 @@ TEST_CASE(negative_lookahead)
         EXPECT_EQ(re.match(":foobar").success, true);
     }
 }
+
+TEST_CASE(lazy_dfa_rejects_without_backtracking)
+{
+    {
+        Regex<PosixExtended> re("foo(bar|baz)+qux", PosixFlags::Global);
+        auto result = re.match("foobarbaz foobazqu fooqux");
+        EXPECT_EQ(result.success, false);
+        EXPECT_EQ(result.n_operations, 0u);
+        EXPECT_EQ(re.match("foobarbaz foobazbarqux").success, true);
+    }
+    {
+        Regex<PosixExtended> re("[[:digit:]]{3}-[[:digit:]]{4}", PosixFlags::Global | PosixFlags::Multiline);
+        auto result = re.match("555-123\n12-3456\n");
+        EXPECT_EQ(result.success, false);
+        EXPECT_EQ(result.n_operations, 0u);
+        result = re.match("555-123\n555-1234\n");
+        EXPECT_EQ(result.success, true);
+        EXPECT_EQ(result.matches.first().line, 1u);
+    }
+    {
+        // Without Global, the whole subject has to match.
+        Regex<PosixExtended> re("ab*");
+        auto result = re.match("abbbc");
+        EXPECT_EQ(result.success, false);
+        EXPECT_EQ(result.n_operations, 0u);
+        EXPECT_EQ(re.match("abbb").success, true);
+    }
+    {
+        Regex<ECMA262> re("^HELLO\\b", ECMAScriptFlags::Insensitive);
+        EXPECT_EQ(re.match("hello").success, true);
+        auto result = re.match("help");
+        EXPECT_EQ(result.success, false);
+        EXPECT_EQ(result.n_operations, 0u);
+    }
+    {
+        // Stateful matches only look for a match at the start offset.
+        Regex<ECMA262> re("b+", ECMAScriptFlags::Global);
+        re.start_offset = 1;
+        auto result = re.match("abba");
+        EXPECT_EQ(result.success, true);
+        EXPECT_EQ(result.matches.first().view, "bb"sv);
+        re.start_offset = 3;
+        result = re.match("abba");
+        EXPECT_EQ(result.success, false);
+        EXPECT_EQ(result.n_operations, 0u);
+    }
+    {
+        Regex<ECMA262> re("\\u{1f600}+!", ECMAScriptFlags::Unicode);
+        auto subject = AK::utf8_to_utf16("😀😀!");
+        EXPECT_EQ(re.match(Utf16View { subject }).success, true);
+        subject = AK::utf8_to_utf16("😀😃!");
+        auto result = re.match(Utf16View { subject });
+        EXPECT_EQ(result.success, false);
+        EXPECT_EQ(result.n_operations, 0u);
+    }
+}
+
+TEST_CASE(lazy_dfa_leaves_lookaround_and_backreferences_to_backtracking)
+{
+    {
+        Regex<ECMA262> re("(a+)b\\1");
+        EXPECT_EQ(re.match("aabaa").success, true);
+        auto result = re.match("aaba");
+        EXPECT_EQ(result.success, false);
+        EXPECT_NE(result.n_operations, 0u);
+    }
+    {
+        Regex<ECMA262> re("a(?=b)b");
+        EXPECT_EQ(re.match("ab").success, true);
+        auto result = re.match("ac");
+        EXPECT_EQ(result.success, false);
+        EXPECT_NE(result.n_operations, 0u);
+    }
+}
+
+TEST_CASE(compile_cached)
+{
+    {
+        auto first = Regex<ECMA262>::compile_cached("(?<word>[a-z]+)-\\d+", ECMAScriptFlags::Global);
+        auto second = Regex<ECMA262>::compile_cached(String("(?<word>[a-z]+)-\\d+"), ECMAScriptFlags::Global);
+        EXPECT_EQ(first.parser_result.error, regex::Error::NoError);
+        EXPECT_EQ(second.parser_result.error, regex::Error::NoError);
+        EXPECT_EQ(first.parser_result.bytecode.size(), second.parser_result.bytecode.size());
+
+        // Both share the bytecode, but not the state of stateful matches.
+        EXPECT_EQ(first.match("ab-1 cd-2").success, true);
+        EXPECT_EQ(first.start_offset, 4u);
+        EXPECT_EQ(second.start_offset, 0u);
+        auto result = second.match("ab-1 cd-2");
+        EXPECT_EQ(result.success, true);
+        EXPECT_EQ(result.capture_group_matches[0][0].view, "ab"sv);
+        EXPECT_EQ(result.capture_group_matches[0][0].capture_group_name, "word"sv);
+    }
+    {
+        auto case_sensitive = Regex<ECMA262>::compile_cached("abc");
+        auto case_insensitive = Regex<ECMA262>::compile_cached("abc", ECMAScriptFlags::Insensitive);
+        EXPECT_EQ(case_sensitive.match("ABC").success, false);
+        EXPECT_EQ(case_insensitive.match("ABC").success, true);
+    }
+    {
+        for (size_t i = 0; i < 2; ++i) {
+            auto re = Regex<PosixExtended>::compile_cached("a(b", PosixFlags::SkipTrimEmptyMatches);
+            EXPECT_EQ(re.parser_result.error, regex::Error::MismatchingParen);
+            EXPECT_EQ(re.match("ab").success, false);
+        }
+    }
+}
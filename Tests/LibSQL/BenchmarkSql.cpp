@@ -0,0 +1,235 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <unistd.h>
+
+#include <AK/Function.h>
+#include <AK/ScopeGuard.h>
+#include <AK/StringView.h>
+#include <AK/Vector.h>
+#include <LibCore/ElapsedTimer.h>
+#include <LibSQL/AST/Parser.h>
+#include <LibSQL/BTree.h>
+#include <LibSQL/Database.h>
+#include <LibSQL/HashIndex.h>
+#include <LibSQL/Heap.h>
+#include <LibSQL/Meta.h>
+#include <LibSQL/SQLResult.h>
+#include <LibSQL/Value.h>
+#include <LibTest/TestCase.h>
+
+namespace {
+
+constexpr const char* db_name = "/tmp/benchmark.db";
+
+// Number of rows in the tables the statement benchmarks run against.
+constexpr int row_count = 100'000;
+
+// Number of keys in the indexes the lookup benchmarks run against.
+constexpr int key_count = 1'000'000;
+constexpr int lookup_count = 100'000;
+constexpr int range_scan_count = 1'000;
+constexpr int range_scan_length = 100;
+
+u32 s_random_state = 1;
+
+u32 random_u32()
+{
+    s_random_state = s_random_state * 1103515245 + 12345;
+    return s_random_state >> 1;
+}
+
+// Runs the operation once and reports how many of the given number of operations it got through per second.
+void measure(StringView name, size_t operations, Function<void()> operation)
+{
+    Core::ElapsedTimer timer { true };
+    timer.start();
+    operation();
+    auto milliseconds = max(timer.elapsed_time().to_milliseconds(), 1);
+    outln("{}: {} operations in {}ms ({:.0} operations/s)", name, operations, milliseconds, operations * 1000.0 / milliseconds);
+}
+
+RefPtr<SQL::SQLResult> execute(NonnullRefPtr<SQL::Database> database, String const& sql)
+{
+    auto parser = SQL::AST::Parser(SQL::AST::Lexer(sql));
+    auto statement = parser.next_statement();
+    EXPECT(!parser.has_errors());
+    auto result = statement->execute(move(database));
+    EXPECT(result->error().code == SQL::SQLErrorCode::NoError);
+    return result;
+}
+
+size_t count_rows(SQL::SQLResult& result)
+{
+    size_t count = 0;
+    for (auto row = result.next_row(); row.has_value(); row = result.next_row())
+        count++;
+    EXPECT(!result.has_error());
+    return count;
+}
+
+// Fills Bench.Table<table_number> with row_count rows. IntColumn is a permutation of 0 .. row_count - 1.
+void insert_rows(NonnullRefPtr<SQL::Database> database, int table_number)
+{
+    execute(database, String::formatted("CREATE TABLE Bench.Table{} ( TextColumn text, IntColumn integer );", table_number));
+    auto parser = SQL::AST::Parser(SQL::AST::Lexer(String::formatted("INSERT INTO Bench.Table{} VALUES (?, ?);", table_number)));
+    auto insert = parser.next_statement();
+    EXPECT(!parser.has_errors());
+
+    for (auto ix = 0; ix < row_count; ix++) {
+        auto value = static_cast<int>((ix * 7919ll) % row_count);
+        auto result = insert->execute(database, { SQL::Value(String::formatted("Row_{}", value)), SQL::Value(value) });
+        EXPECT_EQ(result->inserted(), 1);
+    }
+    EXPECT(!database->commit().is_error());
+}
+
+NonnullRefPtr<SQL::TupleDescriptor> integer_key_descriptor()
+{
+    NonnullRefPtr<SQL::TupleDescriptor> tuple_descriptor = adopt_ref(*new SQL::TupleDescriptor);
+    tuple_descriptor->append({ "schema", "table", "id", SQL::SQLType::Integer, SQL::Order::Ascending });
+    return tuple_descriptor;
+}
+
+// A unique BTree over an integer column is what a primary key is stored as.
+NonnullRefPtr<SQL::BTree> build_primary_key_index(SQL::Serializer& serializer)
+{
+    auto btree = SQL::BTree::construct(serializer, integer_key_descriptor(), true, serializer.heap().new_record_pointer());
+    Vector<SQL::Key> keys;
+    keys.ensure_capacity(key_count);
+    for (auto ix = 0; ix < key_count; ix++) {
+        SQL::Key key(btree->descriptor());
+        key[0] = ix;
+        key.set_pointer(ix + 1);
+        keys.append(move(key));
+    }
+    measure("Primary key bulk load"sv, key_count, [&] {
+        EXPECT(btree->bulk_load(move(keys)));
+    });
+    return btree;
+}
+
+}
+
+BENCHMARK_CASE(insert_rows)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    EXPECT(!database->open().is_error());
+    execute(database, "CREATE SCHEMA Bench;");
+    measure("INSERT"sv, row_count, [&] {
+        insert_rows(database, 1);
+    });
+}
+
+BENCHMARK_CASE(primary_key_lookups)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto heap = SQL::Heap::construct(db_name);
+    EXPECT(!heap->open().is_error());
+    SQL::Serializer serializer(heap);
+    auto btree = build_primary_key_index(serializer);
+
+    measure("Primary key lookup"sv, lookup_count, [&] {
+        for (auto ix = 0; ix < lookup_count; ix++) {
+            SQL::Key key(btree->descriptor());
+            auto id = static_cast<int>(random_u32() % key_count);
+            key[0] = id;
+            EXPECT_EQ(btree->get(key).value(), static_cast<u32>(id + 1));
+        }
+    });
+}
+
+BENCHMARK_CASE(primary_key_range_scans)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto heap = SQL::Heap::construct(db_name);
+    EXPECT(!heap->open().is_error());
+    SQL::Serializer serializer(heap);
+    auto btree = build_primary_key_index(serializer);
+
+    measure("Primary key range scan"sv, range_scan_count * range_scan_length, [&] {
+        for (auto ix = 0; ix < range_scan_count; ix++) {
+            SQL::Key key(btree->descriptor());
+            key[0] = static_cast<int>(random_u32() % (key_count - range_scan_length));
+            auto iterator = btree->find(key);
+            for (auto scanned = 0; scanned < range_scan_length; scanned++, iterator++)
+                EXPECT(!iterator.is_end());
+        }
+    });
+}
+
+BENCHMARK_CASE(hash_index_lookups)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto heap = SQL::Heap::construct(db_name);
+    EXPECT(!heap->open().is_error());
+    SQL::Serializer serializer(heap);
+    auto hash_index = SQL::HashIndex::construct(serializer, integer_key_descriptor(), heap->new_record_pointer());
+
+    measure("Hash index insert"sv, key_count, [&] {
+        for (auto ix = 0; ix < key_count; ix++) {
+            SQL::Key key(hash_index->descriptor());
+            key[0] = ix;
+            key.set_pointer(ix + 1);
+            EXPECT(hash_index->insert(key));
+        }
+    });
+
+    measure("Hash index lookup"sv, lookup_count, [&] {
+        for (auto ix = 0; ix < lookup_count; ix++) {
+            SQL::Key key(hash_index->descriptor());
+            auto id = static_cast<int>(random_u32() % key_count);
+            key[0] = id;
+            EXPECT_EQ(hash_index->get(key).value(), static_cast<u32>(id + 1));
+        }
+    });
+}
+
+BENCHMARK_CASE(select_range)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    EXPECT(!database->open().is_error());
+    execute(database, "CREATE SCHEMA Bench;");
+    insert_rows(database, 1);
+
+    measure("SELECT with range WHERE"sv, row_count, [&] {
+        auto result = execute(database, String::formatted("SELECT TextColumn FROM Bench.Table1 WHERE IntColumn < {};", row_count / 4));
+        EXPECT_EQ(count_rows(*result), static_cast<size_t>(row_count / 4));
+    });
+}
+
+BENCHMARK_CASE(select_join)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    EXPECT(!database->open().is_error());
+    execute(database, "CREATE SCHEMA Bench;");
+    insert_rows(database, 1);
+    insert_rows(database, 2);
+
+    measure("SELECT with equi-join"sv, 2 * row_count, [&] {
+        auto result = execute(database,
+            "SELECT Table1.TextColumn, Table2.TextColumn FROM Bench.Table1, Bench.Table2 "
+            "WHERE Table1.IntColumn = Table2.IntColumn;");
+        EXPECT_EQ(count_rows(*result), static_cast<size_t>(row_count));
+    });
+}
+
+BENCHMARK_CASE(select_order_by)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    EXPECT(!database->open().is_error());
+    execute(database, "CREATE SCHEMA Bench;");
+    insert_rows(database, 1);
+
+    measure("SELECT with ORDER BY"sv, row_count, [&] {
+        auto result = execute(database, "SELECT TextColumn, IntColumn FROM Bench.Table1 ORDER BY TextColumn;");
+        EXPECT_EQ(count_rows(*result), static_cast<size_t>(row_count));
+    });
+}
@@ -318,3 +318,168 @@ TEST_CASE(btree_scan_50_keys)
 {
     insert_into_and_scan_btree(50);
 }
+
+NonnullRefPtr<SQL::BTree> setup_text_btree(SQL::Serializer&);
+void verify_btree_scan(SQL::BTree&, int);
+
+NonnullRefPtr<SQL::BTree> setup_text_btree(SQL::Serializer& serializer)
+{
+    NonnullRefPtr<SQL::TupleDescriptor> tuple_descriptor = adopt_ref(*new SQL::TupleDescriptor);
+    tuple_descriptor->append({ "schema", "table", "name", SQL::SQLType::Text, SQL::Order::Ascending });
+    tuple_descriptor->append({ "schema", "table", "number", SQL::SQLType::Integer, SQL::Order::Ascending });
+
+    auto root_pointer = serializer.heap().user_value(0);
+    if (!root_pointer) {
+        root_pointer = serializer.heap().new_record_pointer();
+        serializer.heap().set_user_value(0, root_pointer);
+    }
+    auto btree = SQL::BTree::construct(serializer, tuple_descriptor, true, root_pointer);
+    btree->on_new_root = [&]() {
+        serializer.heap().set_user_value(0, btree->root());
+    };
+    return btree;
+}
+
+void verify_btree_scan(SQL::BTree& btree, int num_keys)
+{
+    int count = 0;
+    SQL::Tuple prev;
+    for (auto iter = btree.begin(); !iter.is_end(); iter++, count++) {
+        auto key = (*iter);
+        if (prev.size()) {
+            EXPECT(prev < key);
+        }
+        prev = key;
+    }
+    EXPECT_EQ(count, num_keys);
+}
+
+TEST_CASE(btree_bulk_load)
+{
+    constexpr int num_keys = 20000;
+    ScopeGuard guard([]() { unlink("/tmp/test.db"); });
+    {
+        auto heap = SQL::Heap::construct("/tmp/test.db");
+        EXPECT(!heap->open().is_error());
+        SQL::Serializer serializer(heap);
+        auto btree = setup_btree(serializer);
+
+        Vector<SQL::Key> bulk_keys;
+        for (auto ix = num_keys - 1; ix >= 0; ix--) {
+            SQL::Key k(btree->descriptor());
+            k[0] = ix * 2;
+            k.set_pointer(ix + 1);
+            bulk_keys.append(k);
+        }
+        EXPECT(btree->bulk_load(move(bulk_keys)));
+
+        // The tree is a regular tree after loading, and can be added to as usual:
+        SQL::Key k(btree->descriptor());
+        k[0] = 501;
+        k.set_pointer(num_keys + 1);
+        EXPECT(btree->insert(k));
+    }
+
+    {
+        auto heap = SQL::Heap::construct("/tmp/test.db");
+        EXPECT(!heap->open().is_error());
+        SQL::Serializer serializer(heap);
+        auto btree = setup_btree(serializer);
+
+        for (auto ix = 0; ix < num_keys; ix++) {
+            SQL::Key k(btree->descriptor());
+            k[0] = ix * 2;
+            auto pointer_opt = btree->get(k);
+            EXPECT(pointer_opt.has_value());
+            EXPECT_EQ(pointer_opt.value(), static_cast<u32>(ix + 1));
+        }
+        SQL::Key k(btree->descriptor());
+        k[0] = 501;
+        EXPECT_EQ(btree->get(k).value(), static_cast<u32>(num_keys + 1));
+        verify_btree_scan(btree, num_keys + 1);
+    }
+}
+
+TEST_CASE(btree_bulk_load_rejects_duplicates_and_non_empty_trees)
+{
+    ScopeGuard guard([]() { unlink("/tmp/test.db"); });
+    auto heap = SQL::Heap::construct("/tmp/test.db");
+    EXPECT(!heap->open().is_error());
+    SQL::Serializer serializer(heap);
+    auto btree = setup_btree(serializer);
+
+    SQL::Key k(btree->descriptor());
+    k[0] = 42;
+    k.set_pointer(1);
+    EXPECT(!btree->bulk_load({ k, k }));
+    EXPECT(btree->bulk_load({ k }));
+    EXPECT(!btree->bulk_load({ k }));
+}
+
+TEST_CASE(btree_text_keys_with_shared_prefixes)
+{
+    constexpr int num_keys = 500;
+    auto make_key = [](SQL::BTree& btree, int ix) {
+        SQL::Key k(btree.descriptor());
+        k[0] = String::formatted("Customer/{:04}/{}", ix / 10, ix % 3 == 0 ? "Invoices" : "Orders");
+        k[1] = ix % 10;
+        k.set_pointer(ix + 1);
+        return k;
+    };
+
+    ScopeGuard guard([]() { unlink("/tmp/test.db"); });
+    {
+        auto heap = SQL::Heap::construct("/tmp/test.db");
+        EXPECT(!heap->open().is_error());
+        SQL::Serializer serializer(heap);
+        auto btree = setup_text_btree(serializer);
+        for (auto ix = 0; ix < num_keys; ix++)
+            EXPECT(btree->insert(make_key(btree, (ix * 7) % num_keys)));
+    }
+
+    {
+        auto heap = SQL::Heap::construct("/tmp/test.db");
+        EXPECT(!heap->open().is_error());
+        SQL::Serializer serializer(heap);
+        auto btree = setup_text_btree(serializer);
+        for (auto ix = 0; ix < num_keys; ix++) {
+            auto k = make_key(btree, ix);
+            auto pointer_opt = btree->get(k);
+            EXPECT(pointer_opt.has_value());
+            EXPECT_EQ(pointer_opt.value(), static_cast<u32>(ix + 1));
+        }
+        verify_btree_scan(btree, num_keys);
+    }
+}
+
+TEST_CASE(btree_find_and_reject_keys_in_non_leaf_nodes)
+{
+    // Enough keys for the tree to have several levels, so that some keys end up in non-leaf nodes.
+    constexpr int num_keys = 5000;
+    ScopeGuard guard([]() { unlink("/tmp/test.db"); });
+    auto heap = SQL::Heap::construct("/tmp/test.db");
+    EXPECT(!heap->open().is_error());
+    SQL::Serializer serializer(heap);
+    auto btree = setup_btree(serializer);
+
+    for (auto ix = 0; ix < num_keys; ix++) {
+        SQL::Key k(btree->descriptor());
+        k[0] = ix;
+        k.set_pointer(ix + 1);
+        EXPECT(btree->insert(k));
+    }
+
+    for (auto ix = 0; ix < num_keys; ix++) {
+        SQL::Key k(btree->descriptor());
+        k[0] = ix;
+        auto iterator = btree->find(k);
+        EXPECT(!iterator.is_end());
+        EXPECT(iterator == k);
+        EXPECT(!btree->insert(k));
+
+        k.set_pointer(num_keys + ix + 1);
+        EXPECT(btree->update_key_pointer(k));
+        EXPECT_EQ(btree->get(k).value_or(0), static_cast<u32>(num_keys + ix + 1));
+    }
+    verify_btree_scan(btree, num_keys);
+}
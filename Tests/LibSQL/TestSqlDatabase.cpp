@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <fcntl.h>
 #include <unistd.h>
 
 #include <AK/ScopeGuard.h>
@@ -116,7 +117,26 @@ TEST_CASE(create_heap)
     ScopeGuard guard([]() { unlink("/tmp/test.db"); });
     auto heap = SQL::Heap::construct("/tmp/test.db");
     EXPECT(!heap->open().is_error());
-    EXPECT_EQ(heap->version(), 0x00000001u);
+    EXPECT_EQ(heap->version(), SQL::HEAP_VERSION);
+}
+
+TEST_CASE(open_heap_with_old_version)
+{
+    ScopeGuard guard([]() { unlink("/tmp/test.db"); });
+    {
+        auto heap = SQL::Heap::construct("/tmp/test.db");
+        EXPECT(!heap->open().is_error());
+        EXPECT(!heap->flush().is_error());
+    }
+    {
+        int fd = open("/tmp/test.db", O_WRONLY);
+        EXPECT(fd >= 0);
+        u32 old_version = 0x00000001;
+        EXPECT_EQ(pwrite(fd, &old_version, sizeof(old_version), 12), static_cast<ssize_t>(sizeof(old_version)));
+        close(fd);
+    }
+    auto heap = SQL::Heap::construct("/tmp/test.db");
+    EXPECT(heap->open().is_error());
 }
 
 TEST_CASE(create_from_dev_random)
@@ -225,3 +245,47 @@ TEST_CASE(insert_100_into_table)
 {
     insert_and_verify(100);
 }
+
+TEST_CASE(insert_null_values_into_table)
+{
+    ScopeGuard guard([]() { unlink("/tmp/test.db"); });
+    {
+        auto db = SQL::Database::construct("/tmp/test.db");
+        EXPECT(!db->open().is_error());
+        auto schema = setup_schema(db);
+        auto table = SQL::TableDef::construct(schema, "TestTable");
+        table->append_column("TextColumn", SQL::SQLType::Text);
+        table->append_column("IntColumn", SQL::SQLType::Integer);
+        table->append_column("FloatColumn", SQL::SQLType::Float);
+        EXPECT(!db->add_table(table).is_error());
+        commit(db);
+    }
+    {
+        auto db = SQL::Database::construct("/tmp/test.db");
+        EXPECT(!db->open().is_error());
+        auto table = db->get_table("TestSchema", "TestTable").release_value();
+        SQL::Row row(table);
+        row["TextColumn"] = "Some text";
+        row["FloatColumn"] = 3.5;
+        EXPECT(!db->insert(row).is_error());
+        SQL::Row empty_row(table);
+        EXPECT(!db->insert(empty_row).is_error());
+        commit(db);
+    }
+    {
+        auto db = SQL::Database::construct("/tmp/test.db");
+        EXPECT(!db->open().is_error());
+        auto table = db->get_table("TestSchema", "TestTable").release_value();
+        auto rows = db->select_all(*table).release_value();
+        EXPECT_EQ(rows.size(), 2u);
+        for (auto& row : rows) {
+            EXPECT(row["IntColumn"].is_null());
+            if (row["TextColumn"].is_null()) {
+                EXPECT(row["FloatColumn"].is_null());
+            } else {
+                EXPECT_EQ(row["TextColumn"].to_string(), "Some text");
+                EXPECT_EQ(row["FloatColumn"].to_double().value(), 3.5);
+            }
+        }
+    }
+}
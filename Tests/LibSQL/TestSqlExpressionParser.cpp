@@ -131,6 +131,19 @@ TEST_CASE(null_literal)
     validate("NULL");
 }
 
+TEST_CASE(placeholder)
+{
+    auto result = parse("? + ?");
+    EXPECT(!result.is_error());
+    auto expression = result.release_value();
+    EXPECT(is<SQL::AST::BinaryOperatorExpression>(*expression));
+    auto const& binary = static_cast<SQL::AST::BinaryOperatorExpression const&>(*expression);
+    EXPECT(is<SQL::AST::Placeholder>(*binary.lhs()));
+    EXPECT(is<SQL::AST::Placeholder>(*binary.rhs()));
+    EXPECT_EQ(static_cast<SQL::AST::Placeholder const&>(*binary.lhs()).parameter_index(), 0u);
+    EXPECT_EQ(static_cast<SQL::AST::Placeholder const&>(*binary.rhs()).parameter_index(), 1u);
+}
+
 TEST_CASE(column_name)
 {
     EXPECT(parse(".column_name").is_error());
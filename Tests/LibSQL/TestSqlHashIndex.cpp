@@ -335,3 +335,41 @@ TEST_CASE(hash_index_scan_50_keys)
 {
     insert_into_and_scan_hash_index(50);
 }
+
+TEST_CASE(hash_index_many_keys)
+{
+    // Enough keys for the directory to span several directory nodes.
+    constexpr int num_keys = 20000;
+    ScopeGuard guard([]() { unlink("/tmp/test.db"); });
+    {
+        auto heap = SQL::Heap::construct("/tmp/test.db");
+        EXPECT(!heap->open().is_error());
+        SQL::Serializer serializer(heap);
+        auto hash_index = setup_hash_index(serializer);
+
+        for (auto ix = 0; ix < num_keys; ix++) {
+            SQL::Key k(hash_index->descriptor());
+            k[0] = ix;
+            k[1] = String::formatted("Key {}", ix);
+            k.set_pointer(ix + 1);
+            EXPECT(hash_index->insert(k));
+        }
+        EXPECT(hash_index->nodes() > 1);
+    }
+
+    {
+        auto heap = SQL::Heap::construct("/tmp/test.db");
+        EXPECT(!heap->open().is_error());
+        SQL::Serializer serializer(heap);
+        auto hash_index = setup_hash_index(serializer);
+
+        for (auto ix = 0; ix < num_keys; ix++) {
+            SQL::Key k(hash_index->descriptor());
+            k[0] = ix;
+            k[1] = String::formatted("Key {}", ix);
+            auto pointer_opt = hash_index->get(k);
+            EXPECT(pointer_opt.has_value());
+            EXPECT_EQ(pointer_opt.value_or(0), static_cast<u32>(ix + 1));
+        }
+    }
+}
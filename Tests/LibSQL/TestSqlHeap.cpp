@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ScopeGuard.h>
+#include <LibCore/File.h>
+#include <LibSQL/Heap.h>
+#include <LibTest/TestCase.h>
+#include <unistd.h>
+
+static ByteBuffer make_block(u32 block)
+{
+    auto buffer = ByteBuffer::create_zeroed(SQL::BLOCKSIZE).release_value();
+    for (size_t i = 0; i < buffer.size(); ++i)
+        buffer[i] = static_cast<u8>(block + i);
+    return buffer;
+}
+
+static void fill_heap(SQL::Heap& heap, u32 count)
+{
+    for (u32 ix = 0; ix < count; ++ix) {
+        auto block = heap.new_record_pointer();
+        EXPECT(!heap.add_to_wal(block, make_block(block)).is_error());
+    }
+}
+
+static void verify_heap(SQL::Heap& heap, u32 count)
+{
+    for (u32 block = 1; block <= count; ++block) {
+        auto buffer_or_error = heap.read_block(block);
+        EXPECT(!buffer_or_error.is_error());
+        EXPECT_EQ(buffer_or_error.value(), make_block(block));
+    }
+}
+
+static void copy_file(String const& from, String const& to)
+{
+    auto contents = MUST(Core::File::open(from, Core::OpenMode::ReadOnly))->read_all();
+    auto file = MUST(Core::File::open(to, Core::OpenMode::WriteOnly));
+    EXPECT(file->write(contents.data(), contents.size()));
+}
+
+TEST_CASE(heap_evicts_least_recently_used_pages)
+{
+    ScopeGuard guard([]() {
+        unlink("/tmp/test-heap.db");
+        unlink("/tmp/test-heap.db-wal");
+    });
+    {
+        auto heap = SQL::Heap::construct("/tmp/test-heap.db");
+        heap->set_page_pool_size(8);
+        EXPECT(!heap->open().is_error());
+
+        // More blocks than fit in the pool, so dirty pages have to be written back.
+        fill_heap(*heap, 50);
+        EXPECT(heap->dirty_page_count() <= 8u);
+        EXPECT(heap->size() > 1u);
+        verify_heap(*heap, 50);
+        EXPECT(!heap->flush().is_error());
+        EXPECT_EQ(heap->dirty_page_count(), 0u);
+        EXPECT_EQ(heap->size(), 51u);
+    }
+    {
+        auto heap = SQL::Heap::construct("/tmp/test-heap.db");
+        heap->set_page_pool_size(4);
+        EXPECT(!heap->open().is_error());
+        EXPECT_EQ(heap->size(), 51u);
+        verify_heap(*heap, 50);
+    }
+}
+
+TEST_CASE(heap_keeps_pinned_pages_resident)
+{
+    ScopeGuard guard([]() {
+        unlink("/tmp/test-heap.db");
+        unlink("/tmp/test-heap.db-wal");
+    });
+    auto heap = SQL::Heap::construct("/tmp/test-heap.db");
+    heap->set_page_pool_size(2);
+    EXPECT(!heap->open().is_error());
+    fill_heap(*heap, 2);
+
+    auto bytes_or_error = heap->pin_block(1);
+    EXPECT(!bytes_or_error.is_error());
+    auto bytes = bytes_or_error.release_value();
+    bytes[0] = 0xff;
+    heap->unpin_block(1, true);
+
+    bytes_or_error = heap->pin_block(1);
+    EXPECT(!bytes_or_error.is_error());
+    EXPECT_EQ(bytes_or_error.value().data(), bytes.data());
+
+    // Block 1 is pinned, so every other block has to share the remaining page.
+    EXPECT(!heap->read_block(2).is_error());
+    EXPECT(!heap->read_block(0).is_error());
+    EXPECT(!heap->read_block(2).is_error());
+    EXPECT_EQ(bytes[0], 0xff);
+    heap->unpin_block(1);
+
+    EXPECT(!heap->flush().is_error());
+    auto buffer_or_error = heap->read_block(1);
+    EXPECT(!buffer_or_error.is_error());
+    EXPECT_EQ(buffer_or_error.value()[0], 0xff);
+}
+
+TEST_CASE(heap_fails_when_all_pages_are_pinned)
+{
+    ScopeGuard guard([]() {
+        unlink("/tmp/test-heap.db");
+        unlink("/tmp/test-heap.db-wal");
+    });
+    auto heap = SQL::Heap::construct("/tmp/test-heap.db");
+    heap->set_page_pool_size(1);
+    EXPECT(!heap->open().is_error());
+    fill_heap(*heap, 1);
+
+    EXPECT(!heap->pin_block(1).is_error());
+    EXPECT(heap->read_block(0).is_error());
+    heap->unpin_block(1);
+    EXPECT(!heap->read_block(0).is_error());
+}
+
+TEST_CASE(heap_recovers_committed_blocks_from_log)
+{
+    ScopeGuard guard([]() {
+        unlink("/tmp/test-heap.db");
+        unlink("/tmp/test-heap.db-wal");
+        unlink("/tmp/test-crash.db");
+        unlink("/tmp/test-crash.db-wal");
+    });
+    {
+        auto heap = SQL::Heap::construct("/tmp/test-heap.db");
+        heap->set_page_pool_size(2);
+        EXPECT(!heap->open().is_error());
+        fill_heap(*heap, 10);
+        EXPECT(!heap->flush().is_error());
+        EXPECT(heap->wal_size() > 0u);
+
+        // Changed, and pushed out to the log by eviction, but never committed.
+        auto changed = make_block(42);
+        EXPECT(!heap->add_to_wal(1, changed).is_error());
+        EXPECT(!heap->read_block(2).is_error());
+        EXPECT(!heap->read_block(3).is_error());
+        EXPECT_EQ(heap->read_block(1).value(), changed);
+
+        // Take a snapshot of the files as they would be after a crash at this point, with a
+        // torn record at the end of the log.
+        copy_file("/tmp/test-heap.db", "/tmp/test-crash.db");
+        copy_file("/tmp/test-heap.db-wal", "/tmp/test-crash.db-wal");
+        auto wal = MUST(Core::File::open("/tmp/test-crash.db-wal", Core::OpenMode::WriteOnly | Core::OpenMode::Append));
+        EXPECT(wal->write("SQLW garbage"));
+    }
+    {
+        auto heap = SQL::Heap::construct("/tmp/test-crash.db");
+        EXPECT(!heap->open().is_error());
+        EXPECT_EQ(heap->size(), 11u);
+        EXPECT_EQ(heap->wal_size(), 0u);
+        verify_heap(*heap, 10);
+    }
+}
+
+TEST_CASE(heap_checkpoints_when_log_grows)
+{
+    ScopeGuard guard([]() {
+        unlink("/tmp/test-heap.db");
+        unlink("/tmp/test-heap.db-wal");
+    });
+    {
+        auto heap = SQL::Heap::construct("/tmp/test-heap.db");
+        heap->set_checkpoint_threshold(16);
+        EXPECT(!heap->open().is_error());
+        fill_heap(*heap, 8);
+        EXPECT(!heap->flush().is_error());
+        EXPECT(heap->wal_size() > 0u);
+        fill_heap(*heap, 42);
+        EXPECT(!heap->flush().is_error());
+        EXPECT_EQ(heap->wal_size(), 0u);
+        verify_heap(*heap, 50);
+    }
+    EXPECT(access("/tmp/test-heap.db-wal", F_OK) != 0);
+    {
+        auto heap = SQL::Heap::construct("/tmp/test-heap.db");
+        EXPECT(!heap->open().is_error());
+        EXPECT_EQ(heap->size(), 51u);
+        verify_heap(*heap, 50);
+    }
+}
@@ -18,14 +18,14 @@ namespace {
 
 constexpr const char* db_name = "/tmp/test.db";
 
-RefPtr<SQL::SQLResult> execute(NonnullRefPtr<SQL::Database> database, String const& sql)
+RefPtr<SQL::SQLResult> execute(NonnullRefPtr<SQL::Database> database, String const& sql, Vector<SQL::Value> placeholder_values = {})
 {
     auto parser = SQL::AST::Parser(SQL::AST::Lexer(sql));
     auto statement = parser.next_statement();
     EXPECT(!parser.has_errors());
     if (parser.has_errors())
         outln("{}", parser.errors()[0].to_string());
-    auto result = statement->execute(move(database));
+    auto result = statement->execute(move(database), move(placeholder_values));
     if (result->error().code != SQL::SQLErrorCode::NoError)
         outln("{}", result->error().to_string());
     return result;
@@ -337,6 +337,151 @@ TEST_CASE(select_inner_join)
     EXPECT_EQ(row[2].to_string(), "Test_12");
 }
 
+TEST_CASE(select_inner_join_with_duplicate_keys)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    EXPECT(!database->open().is_error());
+    create_two_tables(database);
+    auto result = execute(database,
+        "INSERT INTO TestSchema.TestTable1 ( TextColumn1, IntColumn ) VALUES "
+        "( 'Test_1', 42 ), "
+        "( 'Test_2', 43 ), "
+        "( 'Test_3', 44 ), "
+        "( 'Test_4', 44 ), "
+        "( 'Test_5', 46 );");
+    EXPECT(result->error().code == SQL::SQLErrorCode::NoError);
+    EXPECT(result->inserted() == 5);
+    result = execute(database,
+        "INSERT INTO TestSchema.TestTable2 ( TextColumn2, IntColumn ) VALUES "
+        "( 'Test_10', 42 ), "
+        "( 'Test_11', 44 ), "
+        "( 'Test_12', 44 ), "
+        "( 'Test_13', 46 ), "
+        "( 'Test_14', 48 );");
+    EXPECT(result->error().code == SQL::SQLErrorCode::NoError);
+    EXPECT(result->inserted() == 5);
+    result = execute(database,
+        "SELECT TestTable1.IntColumn, TextColumn1, TextColumn2 "
+        "FROM TestSchema.TestTable1, TestSchema.TestTable2 "
+        "WHERE TestTable1.IntColumn = TestTable2.IntColumn;");
+    EXPECT(result->error().code == SQL::SQLErrorCode::NoError);
+    EXPECT(result->has_results());
+    EXPECT_EQ(result->results().size(), 6u);
+    for (auto& row : result->results()) {
+        EXPECT_EQ(row.size(), 3u);
+        auto suffix = row[2].to_string().substring_view(5).to_int().value();
+        switch (row[0].to_int().value()) {
+        case 42:
+            EXPECT_EQ(row[1].to_string(), "Test_1");
+            EXPECT_EQ(suffix, 10);
+            break;
+        case 44:
+            EXPECT(row[1].to_string() == "Test_3" || row[1].to_string() == "Test_4");
+            EXPECT(suffix == 11 || suffix == 12);
+            break;
+        case 46:
+            EXPECT_EQ(row[1].to_string(), "Test_5");
+            EXPECT_EQ(suffix, 13);
+            break;
+        default:
+            FAIL("Unexpected join result");
+        }
+    }
+
+    result = execute(database,
+        "SELECT TextColumn1, TextColumn2 FROM TestSchema.TestTable1, TestSchema.TestTable2 "
+        "WHERE TextColumn2 > 'Test_12';");
+    EXPECT(result->error().code == SQL::SQLErrorCode::NoError);
+    EXPECT_EQ(result->results().size(), 10u);
+
+    result = execute(database,
+        "SELECT TextColumn1 FROM TestSchema.TestTable1, TestSchema.TestTable2 "
+        "WHERE IntColumn = 42;");
+    EXPECT(result->error().code == SQL::SQLErrorCode::AmbiguousColumnName);
+}
+
+TEST_CASE(select_with_order_by)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    EXPECT(!database->open().is_error());
+    create_table(database);
+    auto result = execute(database,
+        "INSERT INTO TestSchema.TestTable ( TextColumn, IntColumn ) VALUES "
+        "( 'Test_1', 44 ), "
+        "( 'Test_2', 42 ), "
+        "( 'Test_3', 46 ), "
+        "( 'Test_4', 43 ), "
+        "( 'Test_5', 45 );");
+    EXPECT(result->error().code == SQL::SQLErrorCode::NoError);
+    EXPECT(result->inserted() == 5);
+
+    result = execute(database, "SELECT TextColumn, IntColumn FROM TestSchema.TestTable ORDER BY IntColumn;");
+    EXPECT(result->error().code == SQL::SQLErrorCode::NoError);
+    EXPECT_EQ(result->results().size(), 5u);
+    for (auto ix = 0u; ix < result->results().size(); ix++)
+        EXPECT_EQ(result->results()[ix][1].to_int().value(), 42 + (int)ix);
+
+    result = execute(database, "SELECT TextColumn FROM TestSchema.TestTable ORDER BY TextColumn DESC;");
+    EXPECT(result->error().code == SQL::SQLErrorCode::NoError);
+    EXPECT_EQ(result->results().size(), 5u);
+    EXPECT_EQ(result->results()[0][0].to_string(), "Test_5");
+    EXPECT_EQ(result->results()[4][0].to_string(), "Test_1");
+}
+
+TEST_CASE(select_with_limit)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    EXPECT(!database->open().is_error());
+    create_table(database);
+    for (auto count = 0; count < 100; count++) {
+        auto result = execute(database,
+            String::formatted("INSERT INTO TestSchema.TestTable ( TextColumn, IntColumn ) VALUES ( 'Test_{}', {} );", count, count));
+        EXPECT(result->inserted() == 1);
+    }
+
+    auto result = execute(database, "SELECT TextColumn, IntColumn FROM TestSchema.TestTable ORDER BY IntColumn LIMIT 10 OFFSET 5;");
+    EXPECT(result->error().code == SQL::SQLErrorCode::NoError);
+    EXPECT_EQ(result->results().size(), 10u);
+    for (auto ix = 0u; ix < result->results().size(); ix++)
+        EXPECT_EQ(result->results()[ix][1].to_int().value(), 5 + (int)ix);
+
+    result = execute(database, "SELECT TextColumn FROM TestSchema.TestTable LIMIT 0;");
+    EXPECT(result->error().code == SQL::SQLErrorCode::NoError);
+    EXPECT(!result->has_results());
+
+    result = execute(database, "SELECT TextColumn FROM TestSchema.TestTable LIMIT 150;");
+    EXPECT(result->error().code == SQL::SQLErrorCode::NoError);
+    EXPECT_EQ(result->results().size(), 100u);
+}
+
+TEST_CASE(select_streams_rows)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    EXPECT(!database->open().is_error());
+    create_table(database);
+    for (auto count = 0; count < 20; count++) {
+        auto result = execute(database,
+            String::formatted("INSERT INTO TestSchema.TestTable ( TextColumn, IntColumn ) VALUES ( 'Test_{}', {} );", count, count));
+        EXPECT(result->inserted() == 1);
+    }
+
+    auto result = execute(database, "SELECT TextColumn FROM TestSchema.TestTable WHERE IntColumn > 9;");
+    EXPECT(result->error().code == SQL::SQLErrorCode::NoError);
+    EXPECT(result->has_results());
+    size_t count = 0;
+    for (auto row = result->next_row(); row.has_value(); row = result->next_row()) {
+        EXPECT_EQ(row->size(), 1u);
+        count++;
+    }
+    EXPECT_EQ(count, 10u);
+    EXPECT(!result->has_error());
+    EXPECT(!result->next_row().has_value());
+}
+
 TEST_CASE(select_with_like)
 {
     ScopeGuard guard([]() { unlink(db_name); });
@@ -410,4 +555,34 @@ TEST_CASE(select_with_like)
     EXPECT(!result->has_results());
 }
 
+TEST_CASE(execute_with_placeholders)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    EXPECT(!database->open().is_error());
+    create_table(database);
+
+    auto parser = SQL::AST::Parser(SQL::AST::Lexer("INSERT INTO TestSchema.TestTable VALUES (?, ?);"));
+    auto insert = parser.next_statement();
+    EXPECT(!parser.has_errors());
+    for (auto count = 0; count < 5; ++count) {
+        auto result = insert->execute(database, { SQL::Value(String::formatted("Test_{}", count)), SQL::Value(count) });
+        EXPECT(result->error().code == SQL::SQLErrorCode::NoError);
+        EXPECT(result->inserted() == 1);
+    }
+
+    auto result = execute(database, "SELECT TextColumn FROM TestSchema.TestTable WHERE IntColumn > ?;", { SQL::Value(2) });
+    EXPECT(result->error().code == SQL::SQLErrorCode::NoError);
+    EXPECT_EQ(result->results().size(), 2u);
+
+    result = execute(database, "SELECT IntColumn FROM TestSchema.TestTable WHERE TextColumn = ?;", { SQL::Value("Test_3") });
+    EXPECT(result->error().code == SQL::SQLErrorCode::NoError);
+    EXPECT_EQ(result->results().size(), 1u);
+    EXPECT_EQ(result->results()[0][0].to_int().value(), 3);
+
+    result = insert->execute(database, { SQL::Value("Test_5") });
+    EXPECT(result->error().code == SQL::SQLErrorCode::InvalidNumberOfPlaceholderValues);
+    EXPECT(result->inserted() == 0);
+}
+
 }
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTLS/TLSv12.h>
+#include <LibTest/TestCase.h>
+
+static Certificate make_certificate(String subject, String issuer)
+{
+    Certificate certificate;
+    certificate.subject.subject = move(subject);
+    certificate.issuer.subject = move(issuer);
+    return certificate;
+}
+
+static NonnullRefPtr<TrustStore> make_trust_store()
+{
+    Vector<Certificate> roots;
+    roots.append(make_certificate("Root A", "Root A"));
+    roots.append(make_certificate("Root B", "Root B"));
+    return TrustStore::create(move(roots));
+}
+
+TEST_CASE(test_trust_store_lookup)
+{
+    auto trust_store = make_trust_store();
+    auto* root = trust_store->find_by_subject("Root B");
+    EXPECT_NE(root, nullptr);
+    EXPECT_EQ(root->subject.subject, "Root B");
+    EXPECT_EQ(trust_store->find_by_subject("Root C"), nullptr);
+    EXPECT(trust_store->is_trusted_issuer("Root A"));
+    EXPECT(!trust_store->is_trusted_issuer("Intermediate"));
+}
+
+TEST_CASE(test_verify_chain_through_intermediate)
+{
+    TLS::Context context;
+    context.root_certificates = make_trust_store();
+    context.certificates.append(make_certificate("example.com", "Intermediate"));
+    context.certificates.append(make_certificate("Intermediate", "Root A"));
+    EXPECT(context.verify_chain());
+    EXPECT(context.root_certificates->is_trusted_issuer("Intermediate"));
+    EXPECT(!context.root_certificates->is_trusted_issuer("example.com"));
+}
+
+TEST_CASE(test_verify_chain_with_cached_intermediate)
+{
+    auto trust_store = make_trust_store();
+
+    TLS::Context first_context;
+    first_context.root_certificates = trust_store;
+    first_context.certificates.append(make_certificate("example.com", "Intermediate"));
+    first_context.certificates.append(make_certificate("Intermediate", "Root A"));
+    EXPECT(first_context.verify_chain());
+
+    // The intermediate is missing this time, but it has already been seen chaining up to a root.
+    TLS::Context second_context;
+    second_context.root_certificates = trust_store;
+    second_context.certificates.append(make_certificate("other.example.com", "Intermediate"));
+    EXPECT(second_context.verify_chain());
+}
+
+TEST_CASE(test_verify_chain_with_unknown_issuer)
+{
+    TLS::Context context;
+    context.root_certificates = make_trust_store();
+    context.certificates.append(make_certificate("example.com", "Intermediate"));
+    context.certificates.append(make_certificate("Intermediate", "Root C"));
+    EXPECT(!context.verify_chain());
+    EXPECT(!context.root_certificates->is_trusted_issuer("Intermediate"));
+}
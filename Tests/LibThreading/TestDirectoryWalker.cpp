@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+#include <AK/QuickSort.h>
+#include <AK/String.h>
+#include <LibCore/DirIterator.h>
+#include <LibCore/File.h>
+#include <LibThreading/DirectoryWalker.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static String create_tree()
+{
+    char path_template[] = "/tmp/directory_walker.XXXXXX";
+    auto* root = mkdtemp(path_template);
+    VERIFY(root);
+    for (int i = 0; i < 6; ++i) {
+        auto directory = String::formatted("{}/dir{}", root, i);
+        VERIFY(mkdir(directory.characters(), 0700) == 0);
+        for (int j = 0; j < 4; ++j) {
+            auto subdirectory = String::formatted("{}/sub{}", directory, j);
+            VERIFY(mkdir(subdirectory.characters(), 0700) == 0);
+            for (int k = 0; k < 3; ++k) {
+                auto file = String::formatted("{}/file{}", subdirectory, k);
+                int fd = open(file.characters(), O_CREAT | O_WRONLY, 0600);
+                VERIFY(fd >= 0);
+                VERIFY(write(fd, "hello", k) == k);
+                close(fd);
+            }
+        }
+        VERIFY(symlink("sub0", String::formatted("{}/link", directory).characters()) == 0);
+    }
+    return root;
+}
+
+static void walk_with_dir_iterator(String const& path, Vector<String>& paths)
+{
+    Core::DirIterator iterator(path, Core::DirIterator::SkipParentAndBaseDir);
+    while (iterator.has_next()) {
+        auto child = iterator.next_full_path();
+        paths.append(child);
+        struct stat st;
+        VERIFY(lstat(child.characters(), &st) == 0);
+        if (S_ISDIR(st.st_mode))
+            walk_with_dir_iterator(child, paths);
+    }
+}
+
+static void walk_with_walker(Threading::DirectoryWalker& walker, String const& path, Vector<String>& paths)
+{
+    auto entries = walker.read_directory(path).release_value();
+    for (auto& entry : entries) {
+        paths.append(entry.path);
+        if (entry.type == DT_DIR)
+            walk_with_walker(walker, entry.path, paths);
+    }
+}
+
+TEST_CASE(walks_the_same_tree_as_a_plain_recursive_walk)
+{
+    auto root = create_tree();
+
+    Vector<String> expected;
+    walk_with_dir_iterator(root, expected);
+
+    Vector<String> paths;
+    {
+        Threading::DirectoryWalker walker;
+        walk_with_walker(walker, root, paths);
+    }
+
+    EXPECT_EQ(paths.size(), 6u * (1 + 1 + 4 * (1 + 3)));
+    EXPECT_EQ(paths, expected);
+
+    MUST(Core::File::remove(root, Core::File::RecursionMode::Allowed, false));
+}
+
+TEST_CASE(stats_entries_when_asked_to)
+{
+    auto root = create_tree();
+
+    Threading::DirectoryWalker walker(Threading::DirectoryWalker::StatEntries::Always);
+    auto entries = walker.read_directory(String::formatted("{}/dir0/sub2", root)).release_value();
+    quick_sort(entries, [](auto& a, auto& b) { return a.name < b.name; });
+    EXPECT_EQ(entries.size(), 3u);
+    for (size_t i = 0; i < entries.size(); ++i) {
+        EXPECT_EQ(entries[i].type, DT_REG);
+        EXPECT(entries[i].stat.has_value());
+        EXPECT_EQ(entries[i].stat->st_size, static_cast<off_t>(i));
+    }
+
+    auto link_entries = walker.read_directory(String::formatted("{}/dir0", root)).release_value();
+    auto link = link_entries.first_matching([](auto& entry) { return entry.name == "link"; });
+    EXPECT(link.has_value());
+    EXPECT_EQ(link->type, DT_LNK);
+
+    MUST(Core::File::remove(root, Core::File::RecursionMode::Allowed, false));
+}
+
+TEST_CASE(reports_errors)
+{
+    Threading::DirectoryWalker walker;
+    auto result = walker.read_directory("/this/does/not/exist");
+    EXPECT(result.is_error());
+    EXPECT_EQ(result.error().code(), ENOENT);
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+#include <AK/Array.h>
+#include <AK/Atomic.h>
+#include <LibThreading/Parallel.h>
+
+static Vector<u32> random_values(size_t count)
+{
+    Vector<u32> values;
+    u32 state = 1;
+    for (size_t i = 0; i < count; ++i) {
+        state = state * 1103515245 + 12345;
+        values.append(state);
+    }
+    return values;
+}
+
+TEST_CASE(sorts_small_input_without_threads)
+{
+    auto values = random_values(1000);
+    Threading::parallel_sort(values);
+    for (size_t i = 1; i < values.size(); ++i)
+        EXPECT(values[i - 1] <= values[i]);
+}
+
+TEST_CASE(sorts_large_input)
+{
+    auto values = random_values(Threading::parallel_sort_threshold * 3 + 17);
+    Threading::parallel_sort(values, [](auto& a, auto& b) { return a > b; }, 3);
+    for (size_t i = 1; i < values.size(); ++i)
+        EXPECT(values[i - 1] >= values[i]);
+}
+
+TEST_CASE(sorts_large_span)
+{
+    auto values = random_values(Threading::parallel_sort_threshold * 2 + 5);
+    Threading::parallel_sort(values.span().slice(3), [](auto& a, auto& b) { return a < b; }, 5);
+    for (size_t i = 4; i < values.size(); ++i)
+        EXPECT(values[i - 1] <= values[i]);
+}
+
+TEST_CASE(parallel_for_visits_every_index_once)
+{
+    static Array<Atomic<u32>, 10'000> visits;
+    Threading::parallel_for(visits.size(), [&](size_t i) { ++visits[i]; });
+    Threading::parallel_for(visits.size(), [&](size_t i) { ++visits[i]; }, 7);
+    for (auto& count : visits)
+        EXPECT_EQ(count.load(), 2u);
+}
+
+TEST_CASE(parallel_for_over_span)
+{
+    auto values = random_values(5000);
+    auto expected = values;
+    for (auto& value : expected)
+        value /= 3;
+    Threading::parallel_for(values.span(), [](u32& value) { value /= 3; });
+    EXPECT(values == expected);
+}
+
+TEST_CASE(parallel_for_nested)
+{
+    Atomic<size_t> total = 0;
+    Threading::parallel_for(8, [&](size_t) {
+        Threading::parallel_for(1000, [&](size_t) { ++total; }, 10);
+    });
+    EXPECT_EQ(total.load(), 8000u);
+}
+
+TEST_CASE(parallel_reduce_combines_chunks_in_order)
+{
+    Vector<u32> values;
+    for (u32 i = 0; i < 3000; ++i)
+        values.append(i);
+
+    auto sum = Threading::parallel_reduce(
+        values.span(), u64 { 0 }, [](u64 sum, u32 value) { return sum + value; }, [](u64 a, u64 b) { return a + b; });
+    EXPECT_EQ(sum, 3000u * 2999u / 2u);
+
+    // Concatenation is associative but not commutative, so this only works if the chunks are combined in order.
+    auto concatenated = Threading::parallel_reduce(
+        values.span().slice(0, 100), Vector<u32> {},
+        [](Vector<u32> result, u32 value) { result.append(value); return result; },
+        [](Vector<u32> a, Vector<u32> b) { a.extend(move(b)); return a; },
+        3);
+    EXPECT(concatenated.span() == values.span().slice(0, 100));
+
+    EXPECT_EQ(Threading::parallel_reduce(Span<u32> {}, 42, [](int a, u32) { return a; }, [](int a, int) { return a; }), 42);
+}
+
+BENCHMARK_CASE(parallel_sort_random_integers)
+{
+    auto values = random_values(4'000'000);
+    Threading::parallel_sort(values);
+}
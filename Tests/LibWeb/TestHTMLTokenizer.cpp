@@ -177,6 +177,28 @@ TEST_CASE(character_reference_in_attribute)
     END_ENUMERATION();
 }
 
+TEST_CASE(long_text_and_attribute_values)
+{
+    // Long enough to be consumed in several chunks, with characters that end a chunk in between.
+    auto text = String::formatted("{}\n{}\u00e9{}", String::repeated('a', 300), String::repeated('b', 20), String::repeated('c', 40));
+    auto value = String::formatted("{}\u00fc{}", String::repeated('x', 40), String::repeated('y', 17));
+    auto tokens = run_tokenizer(String::formatted("<p foo=\"{0}&amp;{0}\" bar='{0}' baz={0}>{1}&lt;{1}</p>", value, text));
+
+    BEGIN_ENUMERATION(tokens);
+    EXPECT_START_TAG_TOKEN(p);
+    EXPECT_TAG_TOKEN_ATTRIBUTE_COUNT(3);
+    EXPECT_TAG_TOKEN_ATTRIBUTE(foo, String::formatted("{0}&{0}", value));
+    EXPECT_TAG_TOKEN_ATTRIBUTE(bar, value);
+    EXPECT_TAG_TOKEN_ATTRIBUTE(baz, value);
+    auto expected_text = String::formatted("{0}<{0}", text);
+    for (auto code_point : Utf8View(expected_text)) {
+        EXPECT_CHARACTER_TOKEN(code_point);
+    }
+    EXPECT_END_TAG_TOKEN(p);
+    EXPECT_END_OF_FILE_TOKEN();
+    END_ENUMERATION();
+}
+
 TEST_CASE(comment)
 {
     auto tokens = run_tokenizer("<p><!-- This is a comment --></p>");
@@ -129,6 +129,14 @@ void FileProvider::query(const String& query, Function<void(NonnullRefPtrVector<
 {
     build_filesystem_cache();
 
+    // Background actions may run concurrently, so wait for the cache to be complete before searching it.
+    if (m_building_cache) {
+        m_pending_query = [this, query, on_complete = move(on_complete)]() mutable {
+            this->query(query, move(on_complete));
+        };
+        return;
+    }
+
     if (m_fuzzy_match_work)
         m_fuzzy_match_work->cancel();
 
@@ -161,14 +169,17 @@ void FileProvider::build_filesystem_cache()
         return;
 
     m_building_cache = true;
-    m_work_queue.enqueue("/");
 
-    (void)Threading::BackgroundAction<int>::construct(
-        [this](auto&) {
+    (void)Threading::BackgroundAction<Vector<String>>::construct(
+        [](auto&) {
+            Vector<String> full_path_cache;
+            Queue<String> work_queue;
+            work_queue.enqueue("/");
+
             String slash = "/";
             auto timer = Core::ElapsedTimer::start_new();
-            while (!m_work_queue.is_empty()) {
-                auto base_directory = m_work_queue.dequeue();
+            while (!work_queue.is_empty()) {
+                auto base_directory = work_queue.dequeue();
 
                 if (base_directory.template is_one_of("/dev"sv, "/proc"sv, "/sys"sv))
                     continue;
@@ -188,18 +199,21 @@ void FileProvider::build_filesystem_cache()
 
                     auto full_path = LexicalPath::join(slash, base_directory, path).string();
 
-                    m_full_path_cache.append(full_path);
+                    full_path_cache.append(full_path);
 
                     if (S_ISDIR(st.st_mode)) {
-                        m_work_queue.enqueue(full_path);
+                        work_queue.enqueue(full_path);
                     }
                 }
             }
             dbgln("Built cache in {} ms", timer.elapsed());
-            return 0;
+            return full_path_cache;
         },
-        [this](auto) {
+        [this](auto full_path_cache) {
+            m_full_path_cache = move(full_path_cache);
             m_building_cache = false;
+            if (auto pending_query = move(m_pending_query))
+                pending_query();
         });
 }
 
@@ -156,7 +156,7 @@ private:
     RefPtr<Threading::BackgroundAction<NonnullRefPtrVector<Result>>> m_fuzzy_match_work;
     bool m_building_cache { false };
     Vector<String> m_full_path_cache;
-    Queue<String> m_work_queue;
+    Function<void()> m_pending_query;
 };
 
 class TerminalProvider final : public Provider {
@@ -17,7 +17,8 @@ PDFViewer::PDFViewer()
     set_focus_policy(GUI::FocusPolicy::StrongFocus);
     set_scrollbars_enabled(true);
 
-    start_timer(30'000);
+    m_prerender_timer = Core::Timer::create_single_shot(
+        prerender_delay_ms, [this] { prerender_adjacent_page(); }, this);
 }
 
 void PDFViewer::set_document(RefPtr<PDF::Document> document)
@@ -25,25 +26,72 @@ void PDFViewer::set_document(RefPtr<PDF::Document> document)
     m_document = document;
     m_current_page_index = document->get_first_page_index();
     m_zoom_level = initial_zoom_level;
-    m_rendered_page_list.clear();
-
-    m_rendered_page_list.ensure_capacity(document->get_page_count());
-    for (u32 i = 0; i < document->get_page_count(); i++)
-        m_rendered_page_list.unchecked_append(HashMap<u32, RenderedPage>());
+    forget_rendered_pages();
+    m_page_commands.clear();
 
     update();
 }
 
-RefPtr<Gfx::Bitmap> PDFViewer::get_rendered_page(u32 index)
+NonnullRefPtr<Gfx::Bitmap> PDFViewer::get_rendered_page(u32 index)
 {
-    auto& rendered_page_map = m_rendered_page_list[index];
-    auto existing_rendered_page = rendered_page_map.get(m_zoom_level);
-    if (existing_rendered_page.has_value() && existing_rendered_page.value().rotation == m_rotations)
-        return existing_rendered_page.value().bitmap;
+    for (size_t i = 0; i < m_rendered_pages.size(); i++) {
+        if (m_rendered_pages[i].index == index) {
+            auto rendered_page = m_rendered_pages.take(i);
+            auto bitmap = rendered_page.bitmap;
+            m_rendered_pages.append(move(rendered_page));
+            return bitmap;
+        }
+    }
+
+    auto bitmap = render_page(index);
+    m_rendered_pages.append({ index, bitmap });
+    m_rendered_pages_size_in_bytes += bitmap->size_in_bytes();
+
+    // The current page stays, even if it doesn't fit into the budget on its own.
+    for (size_t i = 0; i < m_rendered_pages.size() && m_rendered_pages_size_in_bytes > rendered_pages_budget_in_bytes;) {
+        if (m_rendered_pages[i].index == m_current_page_index || m_rendered_pages[i].index == index) {
+            i++;
+            continue;
+        }
+        m_rendered_pages_size_in_bytes -= m_rendered_pages[i].bitmap->size_in_bytes();
+        m_rendered_pages.remove(i);
+    }
+
+    return bitmap;
+}
 
-    auto rendered_page = render_page(m_document->get_page(index));
-    rendered_page_map.set(m_zoom_level, { rendered_page, m_rotations });
-    return rendered_page;
+void PDFViewer::forget_rendered_pages()
+{
+    m_rendered_pages.clear();
+    m_rendered_pages_size_in_bytes = 0;
+}
+
+void PDFViewer::prerender_adjacent_page()
+{
+    if (!m_document)
+        return;
+
+    auto find_rendered_page = [&](u32 index) {
+        return m_rendered_pages.find_if([&](auto& rendered_page) { return rendered_page.index == index; });
+    };
+
+    auto current_page = find_rendered_page(m_current_page_index);
+    if (current_page == m_rendered_pages.end())
+        return;
+
+    // Don't bother if the pages are so big (i.e. zoomed in so far) that they'd push each other out of the cache.
+    if (3 * current_page->bitmap->size_in_bytes() > rendered_pages_budget_in_bytes)
+        return;
+
+    // The next page is the one that's most likely to be shown next. We only render one page
+    // at a time, so we get back to the event loop in between.
+    for (auto index : { m_current_page_index + 1, m_current_page_index - 1 }) {
+        if (index >= m_document->get_page_count() || find_rendered_page(index) != m_rendered_pages.end())
+            continue;
+        (void)get_rendered_page(index);
+        m_prerender_timer->restart();
+        return;
+    }
 }
 
 void PDFViewer::paint_event(GUI::PaintEvent& event)
@@ -68,6 +116,9 @@ void PDFViewer::paint_event(GUI::PaintEvent& event)
     int y = max(0, (height() - page->height()) / 2);
 
     painter.blit({ x, y }, *page, page->rect());
+
+    // Now that this page is on screen, get the ones next to it ready in case the user flips to them.
+    m_prerender_timer->restart();
 }
 
 void PDFViewer::mousewheel_event(GUI::MouseEvent& event)
@@ -136,19 +187,18 @@ void PDFViewer::mousemove_event(GUI::MouseEvent& event)
     }
 }
 
-void PDFViewer::timer_event(Core::TimerEvent&)
+void PDFViewer::resize_event(GUI::ResizeEvent& event)
 {
-    // Clear the bitmap vector of all pages except the current page
-    for (size_t i = 0; i < m_rendered_page_list.size(); i++) {
-        if (i != m_current_page_index)
-            m_rendered_page_list[i].clear();
-    }
+    // Pages are rendered to fit the height of the widget.
+    forget_rendered_pages();
+    GUI::AbstractScrollableWidget::resize_event(event);
 }
 
 void PDFViewer::zoom_in()
 {
     if (m_zoom_level < number_of_zoom_levels - 1) {
         m_zoom_level++;
+        forget_rendered_pages();
         update();
     }
 }
@@ -157,6 +207,7 @@ void PDFViewer::zoom_out()
 {
     if (m_zoom_level > 0) {
         m_zoom_level--;
+        forget_rendered_pages();
         update();
     }
 }
@@ -164,17 +215,31 @@ void PDFViewer::zoom_out()
 void PDFViewer::reset_zoom()
 {
     m_zoom_level = initial_zoom_level;
+    forget_rendered_pages();
     update();
 }
 
 void PDFViewer::rotate(int degrees)
 {
     m_rotations = (m_rotations + degrees + 360) % 360;
+    forget_rendered_pages();
     update();
 }
 
-RefPtr<Gfx::Bitmap> PDFViewer::render_page(const PDF::Page& page)
+Vector<PDF::Command> const& PDFViewer::get_page_commands(u32 index, PDF::Page const& page)
 {
+    // Only the pages around the current one are likely to be rendered again soon.
+    m_page_commands.remove_all_matching([&](u32 page_index, auto&) {
+        return page_index + 1 < m_current_page_index || page_index > m_current_page_index + 1;
+    });
+
+    return m_page_commands.ensure(index, [&] { return PDF::Renderer::parse_page_commands(*m_document, page); });
+}
+
+NonnullRefPtr<Gfx::Bitmap> PDFViewer::render_page(u32 index)
+{
+    auto page = m_document->get_page(index);
+
     auto zoom_scale_factor = static_cast<float>(zoom_levels[m_zoom_level]) / 100.0f;
 
     auto page_width = page.media_box.upper_right_x - page.media_box.lower_left_x;
@@ -185,7 +250,7 @@ RefPtr<Gfx::Bitmap> PDFViewer::render_page(const PDF::Page& page)
     auto width = height / page_scale_factor;
     auto bitmap = Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRA8888, { width, height }).release_value_but_fixme_should_propagate_errors();
 
-    PDF::Renderer::render(*m_document, page, bitmap);
+    PDF::Renderer::render(*m_document, page, get_page_commands(index, page), bitmap);
 
     if (page.rotate + m_rotations != 0) {
         int rotation_count = ((page.rotate + m_rotations) / 90) % 4;
@@ -7,8 +7,10 @@
 #pragma once
 
 #include <AK/HashMap.h>
+#include <LibCore/Timer.h>
 #include <LibGUI/AbstractScrollableWidget.h>
 #include <LibGfx/Bitmap.h>
+#include <LibPDF/Command.h>
 #include <LibPDF/Document.h>
 
 static constexpr u16 zoom_levels[] = {
@@ -62,20 +64,37 @@ protected:
     virtual void mousedown_event(GUI::MouseEvent&) override;
     virtual void mouseup_event(GUI::MouseEvent&) override;
     virtual void mousemove_event(GUI::MouseEvent&) override;
-    virtual void timer_event(Core::TimerEvent&) override;
+    virtual void resize_event(GUI::ResizeEvent&) override;
 
 private:
     struct RenderedPage {
-        RefPtr<Gfx::Bitmap> bitmap;
-        int rotation;
+        u32 index { 0 };
+        NonnullRefPtr<Gfx::Bitmap> bitmap;
     };
 
-    RefPtr<Gfx::Bitmap> get_rendered_page(u32 index);
-    RefPtr<Gfx::Bitmap> render_page(const PDF::Page&);
+    // Rendered pages are kept as long as they fit into this budget, so flipping back and forth between pages is quick.
+    static constexpr size_t rendered_pages_budget_in_bytes = 64 * MiB;
+
+    // How long we wait after showing a page before rendering the pages next to it, so we don't delay repainting.
+    static constexpr int prerender_delay_ms = 50;
+
+    NonnullRefPtr<Gfx::Bitmap> get_rendered_page(u32 index);
+    NonnullRefPtr<Gfx::Bitmap> render_page(u32 index);
+    Vector<PDF::Command> const& get_page_commands(u32 index, PDF::Page const&);
+    void forget_rendered_pages();
+    void prerender_adjacent_page();
 
     RefPtr<PDF::Document> m_document;
     u32 m_current_page_index { 0 };
-    Vector<HashMap<u32, RenderedPage>> m_rendered_page_list;
+
+    // All of these are rendered at the current zoom level, rotation and widget height. The most recently used one is last.
+    Vector<RenderedPage> m_rendered_pages;
+    size_t m_rendered_pages_size_in_bytes { 0 };
+
+    // The parsed contents of the current page and the ones next to it, so a new zoom level only has to paint them again.
+    HashMap<u32, Vector<PDF::Command>> m_page_commands;
+
+    RefPtr<Core::Timer> m_prerender_timer;
 
     u8 m_zoom_level { initial_zoom_level };
 
@@ -6,7 +6,7 @@
  */
 
 #include "PDFViewerWidget.h"
-#include <LibCore/File.h>
+#include <LibCore/MappedFile.h>
 #include <LibFileSystemAccessClient/Client.h>
 #include <LibGUI/Application.h>
 #include <LibGUI/BoxLayout.h>
@@ -153,21 +153,24 @@ void PDFViewerWidget::create_toolbar()
 
 void PDFViewerWidget::open_file(int fd, String const& path)
 {
-    auto file = Core::File::construct();
-    if (!file->open(fd, Core::OpenMode::ReadOnly, Core::File::ShouldCloseFileDescriptor::Yes) && file->error() != ENOENT) {
-        GUI::MessageBox::show(window(), String::formatted("Opening \"{}\" failed: {}", path, strerror(errno)), "Error", GUI::MessageBox::Type::Error);
+    // The document only reads the parts of the file that it needs, so there's no point in reading all of it up front.
+    auto mapped_file_or_error = Core::MappedFile::map_from_fd_and_close(fd, path);
+    if (mapped_file_or_error.is_error()) {
+        GUI::MessageBox::show(window(), String::formatted("Opening \"{}\" failed: {}", path, mapped_file_or_error.error()), "Error", GUI::MessageBox::Type::Error);
         return;
     }
     window()->set_title(String::formatted("{} - PDF Viewer", path));
 
-    m_buffer = file->read_all();
-    auto document = PDF::Document::create(m_buffer);
+    auto mapped_file = mapped_file_or_error.release_value();
+    auto document = PDF::Document::create(mapped_file->bytes());
     if (!document) {
         GUI::MessageBox::show_error(nullptr, String::formatted("Couldn't load PDF: {}", path));
         return;
     }
 
+    // NOTE: The previous document still refers to the previous file until it's replaced.
     m_viewer->set_document(document);
+    m_mapped_file = move(mapped_file);
     m_total_page_label->set_text(String::formatted("of {}", document->get_page_count()));
 
     m_page_text_box->set_enabled(true);
@@ -9,6 +9,7 @@
 #include "NumericInput.h"
 #include "PDFViewer.h"
 #include "SidebarWidget.h"
+#include <LibCore/MappedFile.h>
 #include <LibGUI/Action.h>
 #include <LibGUI/TextBox.h>
 #include <LibGUI/Widget.h>
@@ -42,5 +43,5 @@ private:
     RefPtr<GUI::Action> m_rotate_clockwise_action;
 
     bool m_sidebar_open { false };
-    ByteBuffer m_buffer;
+    RefPtr<Core::MappedFile> m_mapped_file;
 };
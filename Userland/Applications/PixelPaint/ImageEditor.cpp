@@ -107,8 +107,7 @@ void ImageEditor::paint_event(GUI::PaintEvent& event)
         Gfx::DisjointRectSet background_rects;
         background_rects.add(frame_inner_rect());
         background_rects.shatter(m_editor_image_rect);
-        for (auto& rect : background_rects.rects())
-            painter.fill_rect(rect, palette().color(Gfx::ColorRole::Tray));
+        painter.fill_rects(background_rects, palette().color(Gfx::ColorRole::Tray));
     }
 
     Gfx::StylePainter::paint_transparency_grid(painter, m_editor_image_rect, palette());
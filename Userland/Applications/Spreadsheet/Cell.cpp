@@ -11,6 +11,13 @@
 
 namespace Spreadsheet {
 
+Cell::~Cell()
+{
+    forget_references();
+    for (auto* cell : m_referencing_cells)
+        cell->m_referenced_cells.remove(this);
+}
+
 void Cell::set_data(String new_data)
 {
     // If we are a formula, we do not save the beginning '=', if the new_data is "" we can simply change our kind
@@ -30,6 +37,7 @@ void Cell::set_data(String new_data)
     }
 
     m_data = move(new_data);
+    m_parsed_formula = nullptr;
     m_dirty = true;
     m_evaluated_externally = false;
 }
@@ -43,6 +51,7 @@ void Cell::set_data(JS::Value new_data)
 
     builder.append(new_data.to_string_without_side_effects());
     m_data = builder.build();
+    m_parsed_formula = nullptr;
 
     m_evaluated_data = move(new_data);
 }
@@ -100,20 +109,25 @@ void Cell::update_data(Badge<Sheet>)
 
     if (m_dirty) {
         m_dirty = false;
+        if (!m_evaluated_externally) {
+            // Whatever the formula refers to is recorded again as it runs, and it may not be what it used to be.
+            forget_references();
+        }
         if (m_kind == Formula) {
             if (!m_evaluated_externally) {
-                auto [value, exception] = m_sheet->evaluate(m_data, this);
-                m_evaluated_data = value;
-                m_js_exception = move(exception);
+                if (!m_parsed_formula)
+                    m_parsed_formula = m_sheet->parse(m_data);
+                if (m_parsed_formula) {
+                    auto [value, exception] = m_sheet->evaluate(*m_parsed_formula, this);
+                    m_evaluated_data = value;
+                    m_js_exception = move(exception);
+                } else {
+                    m_evaluated_data = JS::js_undefined();
+                }
             }
         }
 
-        for (auto& ref : m_referencing_cells) {
-            if (ref) {
-                ref->m_dirty = true;
-                ref->update();
-            }
-        }
+        // NOTE: The sheet takes care of recalculating the cells that refer to this one, in the right order.
     }
 
     m_evaluated_formats.background_color.clear();
@@ -168,10 +182,15 @@ void Cell::reference_from(Cell* other)
     if (!other || other == this)
         return;
 
-    if (!m_referencing_cells.find_if([other](const auto& ptr) { return ptr.ptr() == other; }).is_end())
-        return;
+    m_referencing_cells.set(other);
+    other->m_referenced_cells.set(this);
+}
 
-    m_referencing_cells.append(other->make_weak_ptr());
+void Cell::forget_references()
+{
+    for (auto* cell : m_referenced_cells)
+        cell->m_referencing_cells.remove(this);
+    m_referenced_cells.clear();
 }
 
 void Cell::copy_from(const Cell& other)
@@ -179,6 +198,7 @@ void Cell::copy_from(const Cell& other)
     m_dirty = true;
     m_evaluated_externally = other.m_evaluated_externally;
     m_data = other.m_data;
+    m_parsed_formula = nullptr;
     m_evaluated_data = other.m_evaluated_data;
     m_kind = other.m_kind;
     m_type = other.m_type;
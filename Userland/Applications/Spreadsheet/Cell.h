@@ -11,9 +11,11 @@
 #include "Forward.h"
 #include "JSIntegration.h"
 #include "Position.h"
+#include <AK/HashTable.h>
 #include <AK/String.h>
 #include <AK/Types.h>
 #include <AK/WeakPtr.h>
+#include <LibJS/AST.h>
 
 namespace Spreadsheet {
 
@@ -42,11 +44,14 @@ struct Cell : public Weakable<Cell> {
     {
     }
 
+    ~Cell();
+
     void reference_from(Cell*);
 
     void set_data(String new_data);
     void set_data(JS::Value new_data);
     bool dirty() const { return m_dirty; }
+    void set_dirty() { m_dirty = true; }
     void clear_dirty() { m_dirty = false; }
 
     void set_exception(JS::Exception* exc) { m_js_exception = exc; }
@@ -55,7 +60,7 @@ struct Cell : public Weakable<Cell> {
     const String& data() const { return m_data; }
     const JS::Value& evaluated_data() const { return m_evaluated_data; }
     Kind kind() const { return m_kind; }
-    const Vector<WeakPtr<Cell>>& referencing_cells() const { return m_referencing_cells; }
+    const HashTable<Cell*>& referencing_cells() const { return m_referencing_cells; }
 
     void set_type(StringView name);
     void set_type(const CellType*);
@@ -99,6 +104,8 @@ struct Cell : public Weakable<Cell> {
     void copy_from(const Cell&);
 
 private:
+    void forget_references();
+
     bool m_dirty { false };
     bool m_evaluated_externally { false };
     String m_data;
@@ -106,7 +113,15 @@ private:
     JS::Exception* m_js_exception { nullptr };
     Kind m_kind { LiteralString };
     WeakPtr<Sheet> m_sheet;
-    Vector<WeakPtr<Cell>> m_referencing_cells;
+
+    // The formula is parsed the first time it's evaluated, and kept until it changes.
+    RefPtr<JS::Program> m_parsed_formula;
+
+    // The edges of the dependency graph of the sheet: the cells that have to be recalculated when this one changes,
+    // and the cells that this one was calculated from. Both are recorded while the formulas run.
+    // NOTE: Cells always unlink themselves from the graph when they go away, so these never dangle.
+    HashTable<Cell*> m_referencing_cells;
+    HashTable<Cell*> m_referenced_cells;
     const CellType* m_type { nullptr };
     CellTypeMetadata m_type_metadata;
     Position m_position;
@@ -120,22 +120,80 @@ void Sheet::update()
         return;
     }
     m_visited_cells_in_update.clear();
-    Vector<Cell&> cells_copy;
+    Vector<Cell&> changed_cells;
 
     // Grab a copy as updates might insert cells into the table.
     for (auto& it : m_cells) {
         if (it.value->dirty()) {
-            cells_copy.append(*it.value);
+            changed_cells.append(*it.value);
             m_workbook.set_dirty(true);
         }
     }
 
-    for (auto& cell : cells_copy)
+    // Only the cells that changed and the ones that depend on them are recalculated, and each of them only once.
+    // Cells that a formula starts referring to during the recalculation are still brought up to date as it reads them.
+    auto cells_to_recalculate = cells_in_recalculation_order(changed_cells);
+    for (auto& cell : cells_to_recalculate)
+        cell.set_dirty();
+
+    for (auto& cell : cells_to_recalculate)
         update(cell);
 
     m_visited_cells_in_update.clear();
 }
 
+Vector<Cell&> Sheet::cells_in_recalculation_order(Vector<Cell&> const& changed_cells)
+{
+    HashTable<Cell*> affected_cells;
+    Vector<Cell*> cells_to_visit;
+    for (auto& cell : changed_cells) {
+        if (affected_cells.set(&cell) == AK::HashSetResult::InsertedNewEntry)
+            cells_to_visit.append(&cell);
+    }
+    while (!cells_to_visit.is_empty()) {
+        auto* cell = cells_to_visit.take_last();
+        for (auto* referencing_cell : cell->referencing_cells()) {
+            if (affected_cells.set(referencing_cell) == AK::HashSetResult::InsertedNewEntry)
+                cells_to_visit.append(referencing_cell);
+        }
+    }
+
+    // Every affected cell waits for the affected cells it refers to, and is ready once all of them are done.
+    HashMap<Cell*, size_t> pending_reference_counts;
+    for (auto* cell : affected_cells) {
+        pending_reference_counts.ensure(cell);
+        for (auto* referencing_cell : cell->referencing_cells())
+            ++pending_reference_counts.ensure(referencing_cell);
+    }
+
+    Vector<Cell*> ready_cells;
+    for (auto& it : pending_reference_counts) {
+        if (it.value == 0)
+            ready_cells.append(it.key);
+    }
+
+    Vector<Cell&> ordered_cells;
+    ordered_cells.ensure_capacity(affected_cells.size());
+    while (!ready_cells.is_empty()) {
+        auto* cell = ready_cells.take_last();
+        ordered_cells.unchecked_append(*cell);
+        for (auto* referencing_cell : cell->referencing_cells()) {
+            if (--pending_reference_counts.find(referencing_cell)->value == 0)
+                ready_cells.append(referencing_cell);
+        }
+    }
+
+    // Cells in a reference cycle never become ready, so they go last, in no particular order.
+    if (ordered_cells.size() != affected_cells.size()) {
+        for (auto& it : pending_reference_counts) {
+            if (it.value != 0)
+                ordered_cells.unchecked_append(*it.key);
+        }
+    }
+
+    return ordered_cells;
+}
+
 void Sheet::update(Cell& cell)
 {
     if (m_should_ignore_updates) {
@@ -154,15 +212,30 @@ void Sheet::update(Cell& cell)
     }
 }
 
-Sheet::ValueAndException Sheet::evaluate(StringView source, Cell* on_behalf_of)
+RefPtr<JS::Program> Sheet::parse(StringView source) const
 {
-    TemporaryChange cell_change { m_current_cell_being_evaluated, on_behalf_of };
-    ScopeGuard clear_exception { [&] { interpreter().vm().clear_exception(); } };
-
     auto parser = JS::Parser(JS::Lexer(source));
     auto program = parser.parse_program();
-    if (parser.has_errors() || interpreter().exception())
+    if (parser.has_errors())
+        return {};
+    return program;
+}
+
+Sheet::ValueAndException Sheet::evaluate(StringView source, Cell* on_behalf_of)
+{
+    auto program = parse(source);
+    if (!program || interpreter().exception()) {
+        ScopeGuard clear_exception { [&] { interpreter().vm().clear_exception(); } };
         return { JS::js_undefined(), interpreter().exception() };
+    }
+
+    return evaluate(*program, on_behalf_of);
+}
+
+Sheet::ValueAndException Sheet::evaluate(JS::Program const& program, Cell* on_behalf_of)
+{
+    TemporaryChange cell_change { m_current_cell_being_evaluated, on_behalf_of };
+    ScopeGuard clear_exception { [&] { interpreter().vm().clear_exception(); } };
 
     auto result = interpreter().run(global_object(), program);
     if (result.is_error()) {
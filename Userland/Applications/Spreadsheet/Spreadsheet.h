@@ -112,6 +112,10 @@ public:
         JS::Exception* exception { nullptr };
     };
     ValueAndException evaluate(StringView, Cell* = nullptr);
+    ValueAndException evaluate(JS::Program const&, Cell* = nullptr);
+
+    // Returns null if the source has syntax errors.
+    RefPtr<JS::Program> parse(StringView) const;
     JS::Interpreter& interpreter() const;
     SheetGlobalObject& global_object() const { return *m_global_object; }
 
@@ -138,6 +142,9 @@ private:
     explicit Sheet(Workbook&);
     explicit Sheet(StringView name, Workbook&);
 
+    // The given cells and everything that refers to them, directly or not, ordered so that every cell comes after the cells it refers to.
+    Vector<Cell&> cells_in_recalculation_order(Vector<Cell&> const& changed_cells);
+
     String m_name;
     Vector<String> m_columns;
     size_t m_rows { 0 };
@@ -113,15 +113,21 @@ private:
 
 void ThreadStackWidget::refresh()
 {
+    // Symbolication shares its cache between all threads, so don't start another one while the last is still running.
+    if (m_refresh_in_progress)
+        return;
+    m_refresh_in_progress = true;
+
     (void)Threading::BackgroundAction<Vector<Symbolication::Symbol>>::construct(
         [pid = m_pid, tid = m_tid](auto&) {
             return Symbolication::symbolicate_thread(pid, tid, Symbolication::IncludeSourcePosition::No);
         },
 
-        [weak_this = make_weak_ptr()](auto result) {
+        [weak_this = make_weak_ptr<ThreadStackWidget>()](auto result) {
             if (!weak_this)
                 return;
-            Core::EventLoop::main().post_event(const_cast<Core::Object&>(*weak_this), make<CompletionEvent>(move(result)));
+            weak_this.ptr()->m_refresh_in_progress = false;
+            Core::EventLoop::main().post_event(*weak_this.ptr(), make<CompletionEvent>(move(result)));
         });
 }
 
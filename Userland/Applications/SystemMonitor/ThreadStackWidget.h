@@ -28,4 +28,5 @@ private:
     pid_t m_tid { -1 };
     RefPtr<GUI::TableView> m_stack_table;
     RefPtr<Core::Timer> m_timer;
+    bool m_refresh_in_progress { false };
 };
@@ -26,6 +26,7 @@ public:
     virtual const char* class_name() const override { return m_variable_info.type_name.characters(); }
 
     JS::ThrowCompletionOr<bool> internal_set(JS::PropertyKey const&, JS::Value value, JS::Value receiver) override;
+    virtual bool may_cache_property_lookups() const override { return false; }
 
 private:
     DebuggerGlobalJSObject& debugger_object() const;
@@ -67,6 +67,7 @@ Vector<GUI::AutocompleteProvider::Entry> CppComprehensionEngine::get_suggestions
 
     dbgln_if(CPP_LANGUAGE_SERVER_DEBUG, "CppComprehensionEngine position {}:{}", position.line, position.column);
 
+    reparse_edited_documents();
     const auto* document_ptr = get_or_create_document_data(file);
     if (!document_ptr)
         return {};
@@ -386,7 +387,45 @@ String CppComprehensionEngine::document_path_from_include_path(StringView includ
 
 void CppComprehensionEngine::on_edit(const String& file)
 {
-    set_document_data(file, create_document_data_for(file));
+    m_edited_documents.set(filedb().to_absolute_path(file));
+
+    // NOTE: The timer is created here rather than in the constructor, as the tests use the engine without an event loop.
+    if (!m_reparse_timer)
+        m_reparse_timer = Core::Timer::create_single_shot(reparse_delay_ms, [this] { reparse_edited_documents(); });
+    m_reparse_timer->restart();
+}
+
+void CppComprehensionEngine::reparse_edited_documents()
+{
+    if (m_edited_documents.is_empty())
+        return;
+    if (m_reparse_timer)
+        m_reparse_timer->stop();
+
+    auto includes_edited_document = [&](DocumentData const& document) {
+        for (auto& header : document.m_available_headers) {
+            if (m_edited_documents.contains(filedb().to_absolute_path(header)))
+                return true;
+        }
+        return false;
+    };
+
+    Vector<String> documents_to_reparse;
+    for (auto& path : m_edited_documents)
+        documents_to_reparse.append(path);
+    for (auto& it : m_documents) {
+        if (!m_edited_documents.contains(it.key) && it.value && includes_edited_document(*it.value))
+            documents_to_reparse.append(it.key);
+    }
+    m_edited_documents.clear();
+
+    // Drop all of the outdated documents first, so a document that includes another one doesn't pick up its old definitions.
+    for (auto& path : documents_to_reparse)
+        m_documents.remove(path);
+    for (auto& path : documents_to_reparse) {
+        if (!m_documents.contains(path))
+            set_document_data(path, create_document_data_for(path));
+    }
 }
 
 void CppComprehensionEngine::file_opened([[maybe_unused]] const String& file)
@@ -396,6 +435,7 @@ void CppComprehensionEngine::file_opened([[maybe_unused]] const String& file)
 
 Optional<GUI::AutocompleteProvider::ProjectLocation> CppComprehensionEngine::find_declaration_of(const String& filename, const GUI::TextPosition& identifier_position)
 {
+    reparse_edited_documents();
     const auto* document_ptr = get_or_create_document_data(filename);
     if (!document_ptr)
         return {};
@@ -772,6 +812,7 @@ bool CppComprehensionEngine::is_symbol_available(const Symbol& symbol, const Vec
 
 Optional<CodeComprehensionEngine::FunctionParamsHint> CppComprehensionEngine::get_function_params_hint(const String& filename, const GUI::TextPosition& identifier_position)
 {
+    reparse_edited_documents();
     const auto* document_ptr = get_or_create_document_data(filename);
     if (!document_ptr)
         return {};
@@ -15,6 +15,7 @@
 #include <LibCpp/AST.h>
 #include <LibCpp/Parser.h>
 #include <LibCpp/Preprocessor.h>
+#include <LibCore/Timer.h>
 #include <LibGUI/TextPosition.h>
 
 namespace LanguageServers::Cpp {
@@ -117,6 +118,7 @@ private:
     void set_document_data(const String& file, OwnPtr<DocumentData>&& data);
 
     OwnPtr<DocumentData> create_document_data_for(const String& file);
+    void reparse_edited_documents();
     String document_path_from_include_path(StringView include_path) const;
     void update_declared_symbols(DocumentData&);
     void update_todo_entries(DocumentData&);
@@ -145,6 +147,12 @@ private:
     // A document is added to this set when we start processing it (e.g because it was #included) and removed when we're done.
     // We use this to prevent circular #includes from looping indefinitely.
     HashTable<String> m_unfinished_documents;
+
+    // Edits come in one keystroke at a time, so edited documents are only reparsed once the edits stop for a moment,
+    // or as soon as we're asked something about them. Documents that include an edited one are reparsed along with it.
+    static constexpr int reparse_delay_ms = 300;
+    HashTable<String> m_edited_documents;
+    RefPtr<Core::Timer> m_reparse_timer;
 };
 
 template<typename Func>
@@ -113,7 +113,7 @@ DisassemblyModel::DisassemblyModel(Profile& profile, ProfileNode& node)
         auto disassembly = insn.value().to_string(address_in_profiled_program, &symbol_provider);
 
         StringView instruction_bytes = view.substring_view(offset_into_symbol, insn.value().length());
-        u32 samples_at_this_instruction = m_node.events_per_address().get(address_in_profiled_program).value_or(0);
+        u64 samples_at_this_instruction = m_node.events_per_address().get(address_in_profiled_program).value_or(0);
         float percent = ((float)samples_at_this_instruction / (float)m_node.event_count()) * 100.0f;
 
         m_instructions.append({ insn.value(), disassembly, instruction_bytes, address_in_profiled_program, samples_at_this_instruction, percent, debug_info->get_source_position_with_inlines(address_in_profiled_program - base_address) });
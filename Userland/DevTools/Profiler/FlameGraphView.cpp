@@ -182,7 +182,7 @@ void FlameGraphView::layout_children(GUI::ModelIndex& index, int depth, int left
     if (y < 0)
         return;
 
-    u32 node_event_count = 0;
+    u64 node_event_count = 0;
     if (!index.is_valid()) {
         // We're at the root, so calculate the event count across all roots
         for (auto i = 0; i < m_model.row_count(index); ++i) {
@@ -8,6 +8,7 @@
 #include "DisassemblyModel.h"
 #include "ProfileModel.h"
 #include "SamplesModel.h"
+#include "SchedulerLatencyModel.h"
 #include "SourceModel.h"
 #include <AK/HashTable.h>
 #include <AK/LexicalPath.h>
@@ -48,6 +49,7 @@ Profile::Profile(Vector<Process> processes, Vector<Event> events)
     m_model = ProfileModel::create(*this);
     m_samples_model = SamplesModel::create(*this);
     m_signposts_model = SignpostsModel::create(*this);
+    m_scheduler_latency_model = SchedulerLatencyModel::create(*this);
 
     rebuild_tree();
 }
@@ -67,6 +69,11 @@ GUI::Model& Profile::signposts_model()
     return *m_signposts_model;
 }
 
+GUI::Model& Profile::scheduler_latency_model()
+{
+    return *m_scheduler_latency_model;
+}
+
 void Profile::rebuild_tree()
 {
     Vector<NonnullRefPtr<ProfileNode>> roots;
@@ -100,6 +107,7 @@ void Profile::rebuild_tree()
     });
 
     m_filtered_event_indices.clear();
+    m_filtered_event_weight = 0;
     m_filtered_signpost_indices.clear();
 
     for (size_t event_index = 0; event_index < m_events.size(); ++event_index) {
@@ -119,13 +127,41 @@ void Profile::rebuild_tree()
             continue;
         }
 
+        // Wakeups and threads being switched in only mark the end of some off-CPU time, and have no stack.
+        auto* context_switch_data = event.data.get_pointer<Event::ContextSwitchData>();
+        if (event.data.has<Event::ThreadWakeupData>() || (context_switch_data && !context_switch_data->is_switch_out(event)))
+            continue;
+
         m_filtered_event_indices.append(event_index);
 
-        if (auto* malloc_data = event.data.get_pointer<Event::MallocData>(); malloc_data && !live_allocations.contains(malloc_data->ptr))
-            continue;
+        u64 weight = 1;
+        if (m_metric == Metric::AllocatedBytes) {
+            // Each event is weighted by the number of bytes it allocated, so that allocations (including those that were
+            // freed again) add up to where the memory was allocated. With sampling, an event stands for many allocations.
+            auto* malloc_data = event.data.get_pointer<Event::MallocData>();
+            if (!malloc_data)
+                continue;
+            weight = malloc_data->size;
+            m_filtered_event_weight += weight;
+        } else if (m_metric == Metric::OffCpuTime) {
+            // Each time a thread was switched out is weighted by how long it took to get back on the CPU. The stack
+            // ends in why it was switched out, which the inverted tree groups by.
+            if (!context_switch_data || !context_switch_data->off_cpu_time)
+                continue;
+            weight = context_switch_data->off_cpu_time;
+            m_filtered_event_weight += weight;
+        } else {
+            if (context_switch_data)
+                continue;
 
-        if (event.data.has<Event::FreeData>())
-            continue;
+            m_filtered_event_weight += weight;
+
+            if (auto* malloc_data = event.data.get_pointer<Event::MallocData>(); malloc_data && !live_allocations.contains(malloc_data->ptr))
+                continue;
+
+            if (event.data.has<Event::FreeData>())
+                continue;
+        }
 
         auto for_each_frame = [&]<typename Callback>(Callback callback) {
             if (!m_inverted) {
@@ -144,7 +180,7 @@ void Profile::rebuild_tree()
         if (!m_show_top_functions) {
             ProfileNode* node = nullptr;
             auto& process_node = find_or_create_process_node(event.pid, event.serial);
-            process_node.increment_event_count();
+            process_node.increment_event_count(weight);
             for_each_frame([&](Frame const& frame, bool is_innermost_frame) {
                 auto const& object_name = frame.object_name;
                 auto const& symbol = frame.symbol;
@@ -159,16 +195,16 @@ void Profile::rebuild_tree()
                     node = &process_node;
                 node = &node->find_or_create_child(object_name, symbol, address, offset, event.timestamp, event.pid);
 
-                node->increment_event_count();
+                node->increment_event_count(weight);
                 if (is_innermost_frame) {
-                    node->add_event_address(address);
-                    node->increment_self_count();
+                    node->add_event_address(address, weight);
+                    node->increment_self_count(weight);
                 }
                 return IterationDecision::Continue;
             });
         } else {
             auto& process_node = find_or_create_process_node(event.pid, event.serial);
-            process_node.increment_event_count();
+            process_node.increment_event_count(weight);
             for (size_t i = 0; i < event.frames.size(); ++i) {
                 ProfileNode* node = nullptr;
                 ProfileNode* root = nullptr;
@@ -193,14 +229,14 @@ void Profile::rebuild_tree()
 
                     if (!root->has_seen_event(event_index)) {
                         root->did_see_event(event_index);
-                        root->increment_event_count();
+                        root->increment_event_count(weight);
                     } else if (node != root) {
-                        node->increment_event_count();
+                        node->increment_event_count(weight);
                     }
 
                     if (j == event.frames.size() - 1) {
-                        node->add_event_address(address);
-                        node->increment_self_count();
+                        node->add_event_address(address, weight);
+                        node->increment_self_count(weight);
                     }
                 }
             }
@@ -211,6 +247,49 @@ void Profile::rebuild_tree()
 
     m_roots = move(roots);
     m_model->invalidate();
+    m_scheduler_latency_model->invalidate();
+}
+
+// A thread is off-CPU from the moment it's switched out until it runs again. If it was preempted, or it blocked and
+// was woken up, it then spent the time since then waiting for a CPU: that is the scheduler latency.
+static void compute_off_cpu_times(Vector<Profile::Event>& events)
+{
+    struct OffCpuThread {
+        size_t switch_out_index { 0 };
+        Optional<u64> woken_at;
+    };
+    HashMap<pid_t, OffCpuThread> off_cpu_threads;
+
+    auto thread_is_running = [&](pid_t tid, u64 timestamp) {
+        auto it = off_cpu_threads.find(tid);
+        if (it == off_cpu_threads.end())
+            return;
+        auto& switch_out_event = events[it->value.switch_out_index];
+        auto& switch_out = switch_out_event.data.get<Profile::Event::ContextSwitchData>();
+        switch_out.off_cpu_time = timestamp - switch_out_event.timestamp;
+        if (it->value.woken_at.has_value())
+            switch_out.scheduler_latency = timestamp - it->value.woken_at.value();
+        else if (switch_out.reason == "Runnable"sv)
+            switch_out.scheduler_latency = switch_out.off_cpu_time;
+        off_cpu_threads.remove(it);
+    };
+
+    for (size_t i = 0; i < events.size(); ++i) {
+        auto& event = events[i];
+        if (event.data.has<Profile::Event::ThreadWakeupData>()) {
+            if (auto it = off_cpu_threads.find(event.tid); it != off_cpu_threads.end() && !it->value.woken_at.has_value())
+                it->value.woken_at = event.timestamp;
+            continue;
+        }
+
+        // Any event of a thread means it's running, but only being switched in says exactly when it started to.
+        thread_is_running(event.tid, event.timestamp);
+        if (auto* context_switch = event.data.get_pointer<Profile::Event::ContextSwitchData>()) {
+            thread_is_running(context_switch->next_tid, event.timestamp);
+            if (context_switch->is_switch_out(event))
+                off_cpu_threads.set(event.tid, { i, {} });
+        }
+    }
 }
 
 Optional<MappedObject> g_kernel_debuginfo_object;
@@ -369,6 +448,28 @@ ErrorOr<NonnullOwnPtr<Profile>> Profile::load_from_perfcore_file(StringView path
             if (it != current_processes.end())
                 it->value->handle_thread_exit(event.tid, event.serial);
             continue;
+        } else if (type_string == "context_switch"sv) {
+            event.data = Event::ContextSwitchData {
+                .next_pid = perf_event.get("next_pid"sv).to_number<pid_t>(),
+                .next_tid = perf_event.get("next_tid"sv).to_number<pid_t>(),
+                .reason = perf_event.get("reason"sv).to_string(),
+            };
+        } else if (type_string == "thread_wakeup"sv) {
+            event.data = Event::ThreadWakeupData {};
+        } else if (type_string == "kmalloc"sv) {
+            event.data = Event::KmallocData {
+                .ptr = perf_event.get("ptr"sv).to_number<FlatPtr>(),
+                .size = perf_event.get("size"sv).to_number<size_t>(),
+            };
+        } else if (type_string == "kfree"sv) {
+            event.data = Event::KfreeData {
+                .ptr = perf_event.get("ptr"sv).to_number<FlatPtr>(),
+                .size = perf_event.get("size"sv).to_number<size_t>(),
+            };
+        } else if (type_string == "page_fault"sv) {
+            event.data = Event::PageFaultData {};
+        } else if (type_string == "syscall"sv) {
+            event.data = Event::SyscallData {};
         } else {
             dbgln("Unknown event type '{}'", type_string);
             VERIFY_NOT_REACHED();
@@ -409,15 +510,34 @@ ErrorOr<NonnullOwnPtr<Profile>> Profile::load_from_perfcore_file(StringView path
             event.frames.append({ object_name, symbol, (FlatPtr)ptr, offset });
         }
 
+        // These don't have a stack, but are needed to tell how long threads were off-CPU.
+        auto* context_switch_data = event.data.get_pointer<Event::ContextSwitchData>();
+        if (event.data.has<Event::ThreadWakeupData>() || (context_switch_data && !context_switch_data->is_switch_out(event))) {
+            events.append(move(event));
+            continue;
+        }
+
         if (event.frames.size() < 2)
             continue;
 
         FlatPtr innermost_frame_address = event.frames.at(1).address;
         event.in_kernel = maybe_kernel_base.has_value() && innermost_frame_address >= maybe_kernel_base.value();
 
+        // Why the thread was switched out goes below its innermost frame, so the off-CPU time can be told apart by it.
+        if (context_switch_data) {
+            auto reason = context_switch_data->reason;
+            if (reason == "Runnable"sv)
+                reason = "Preempted";
+            else if (reason.is_empty())
+                reason = "Blocked";
+            event.frames.append({ {}, String::formatted("[{}]", reason), 0, 0 });
+        }
+
         events.append(move(event));
     }
 
+    compute_off_cpu_times(events);
+
     if (events.is_empty())
         return Error::from_string_literal("No events captured (targeted process was never on CPU)"sv);
 
@@ -538,6 +658,14 @@ void Profile::set_show_percentages(bool show_percentages)
     m_show_percentages = show_percentages;
 }
 
+void Profile::set_metric(Metric metric)
+{
+    if (m_metric == metric)
+        return;
+    m_metric = metric;
+    rebuild_tree();
+}
+
 void Profile::set_disassembly_index(GUI::ModelIndex const& index)
 {
     if (m_disassembly_index == index)
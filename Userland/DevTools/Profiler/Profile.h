@@ -11,6 +11,7 @@
 #include "Profile.h"
 #include "ProfileModel.h"
 #include "SamplesModel.h"
+#include "SchedulerLatencyModel.h"
 #include "SignpostsModel.h"
 #include "SourceModel.h"
 #include <AK/Bitmap.h>
@@ -58,8 +59,8 @@ public:
     u32 offset() const { return m_offset; }
     u64 timestamp() const { return m_timestamp; }
 
-    u32 event_count() const { return m_event_count; }
-    u32 self_count() const { return m_self_count; }
+    u64 event_count() const { return m_event_count; }
+    u64 self_count() const { return m_self_count; }
 
     int child_count() const { return m_children.size(); }
     Vector<NonnullRefPtr<ProfileNode>> const& children() const { return m_children; }
@@ -89,19 +90,19 @@ public:
     ProfileNode* parent() { return m_parent; }
     ProfileNode const* parent() const { return m_parent; }
 
-    void increment_event_count() { ++m_event_count; }
-    void increment_self_count() { ++m_self_count; }
+    void increment_event_count(u64 weight = 1) { m_event_count += weight; }
+    void increment_self_count(u64 weight = 1) { m_self_count += weight; }
 
     void sort_children();
 
-    HashMap<FlatPtr, size_t> const& events_per_address() const { return m_events_per_address; }
-    void add_event_address(FlatPtr address)
+    HashMap<FlatPtr, u64> const& events_per_address() const { return m_events_per_address; }
+    void add_event_address(FlatPtr address, u64 weight = 1)
     {
         auto it = m_events_per_address.find(address);
         if (it == m_events_per_address.end())
-            m_events_per_address.set(address, 1);
+            m_events_per_address.set(address, weight);
         else
-            m_events_per_address.set(address, it->value + 1);
+            m_events_per_address.set(address, it->value + weight);
     }
 
     pid_t pid() const { return m_pid; }
@@ -121,11 +122,11 @@ private:
     pid_t m_pid { 0 };
     FlatPtr m_address { 0 };
     u32 m_offset { 0 };
-    u32 m_event_count { 0 };
-    u32 m_self_count { 0 };
+    u64 m_event_count { 0 };
+    u64 m_self_count { 0 };
     u64 m_timestamp { 0 };
     Vector<NonnullRefPtr<ProfileNode>> m_children;
-    HashMap<FlatPtr, size_t> m_events_per_address;
+    HashMap<FlatPtr, u64> m_events_per_address;
     Bitmap m_seen_events;
 };
 
@@ -147,6 +148,7 @@ public:
     GUI::Model& model();
     GUI::Model& samples_model();
     GUI::Model& signposts_model();
+    GUI::Model& scheduler_latency_model();
     GUI::Model* disassembly_model();
     GUI::Model* source_model();
 
@@ -221,7 +223,42 @@ public:
             pid_t parent_tid {};
         };
 
-        Variant<std::nullptr_t, SampleData, MallocData, FreeData, SignpostData, MmapData, MunmapData, ProcessCreateData, ProcessExecData, ThreadCreateData> data { nullptr };
+        // The thread with the event's TID was switched out for the next thread. If that's the same thread, it was
+        // switched in instead, and the event has no stack.
+        struct ContextSwitchData {
+            pid_t next_pid { 0 };
+            pid_t next_tid { 0 };
+            String reason;
+            // How long the thread was off-CPU after being switched out, and how much of that it spent waiting for a
+            // CPU after it was able to run again. Both are only known once it has been seen running again.
+            u64 off_cpu_time { 0 };
+            Optional<u64> scheduler_latency;
+
+            bool is_switch_out(Event const& event) const { return event.tid != next_tid; }
+        };
+
+        struct ThreadWakeupData {
+        };
+
+        struct KmallocData {
+            FlatPtr ptr {};
+            size_t size {};
+        };
+
+        struct KfreeData {
+            FlatPtr ptr {};
+            size_t size {};
+        };
+
+        struct PageFaultData {
+        };
+
+        struct SyscallData {
+        };
+
+        Variant<std::nullptr_t, SampleData, MallocData, FreeData, SignpostData, MmapData, MunmapData, ProcessCreateData, ProcessExecData, ThreadCreateData,
+            ContextSwitchData, ThreadWakeupData, KmallocData, KfreeData, PageFaultData, SyscallData>
+            data { nullptr };
     };
 
     Vector<Event> const& events() const { return m_events; }
@@ -250,6 +287,18 @@ public:
     bool show_percentages() const { return m_show_percentages; }
     void set_show_percentages(bool);
 
+    // What the call tree and flame graph count for each stack frame.
+    enum class Metric {
+        Samples,
+        AllocatedBytes,
+        OffCpuTime,
+    };
+    Metric metric() const { return m_metric; }
+    void set_metric(Metric);
+
+    // What the percentages are relative to: the sum of the metric over the filtered events.
+    u64 filtered_event_weight() const { return m_filtered_event_weight; }
+
     Vector<Process> const& processes() const { return m_processes; }
 
     template<typename Callback>
@@ -283,6 +332,7 @@ private:
     RefPtr<ProfileModel> m_model;
     RefPtr<SamplesModel> m_samples_model;
     RefPtr<SignpostsModel> m_signposts_model;
+    RefPtr<SchedulerLatencyModel> m_scheduler_latency_model;
     RefPtr<DisassemblyModel> m_disassembly_model;
     RefPtr<SourceModel> m_source_model;
 
@@ -291,6 +341,7 @@ private:
 
     Vector<NonnullRefPtr<ProfileNode>> m_roots;
     Vector<size_t> m_filtered_event_indices;
+    u64 m_filtered_event_weight { 0 };
     u64 m_first_timestamp { 0 };
     u64 m_last_timestamp { 0 };
 
@@ -308,6 +359,7 @@ private:
     bool m_inverted { false };
     bool m_show_top_functions { false };
     bool m_show_percentages { false };
+    Metric m_metric { Metric::Samples };
 };
 
 }
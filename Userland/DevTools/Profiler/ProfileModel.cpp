@@ -79,9 +79,25 @@ String ProfileModel::column_name(int column) const
 {
     switch (column) {
     case Column::SampleCount:
-        return m_profile.show_percentages() ? "% Samples" : "# Samples";
+        switch (m_profile.metric()) {
+        case Profile::Metric::AllocatedBytes:
+            return m_profile.show_percentages() ? "% Bytes" : "# Bytes";
+        case Profile::Metric::OffCpuTime:
+            return m_profile.show_percentages() ? "% Off-CPU" : "Off-CPU ms";
+        case Profile::Metric::Samples:
+            return m_profile.show_percentages() ? "% Samples" : "# Samples";
+        }
+        VERIFY_NOT_REACHED();
     case Column::SelfCount:
-        return m_profile.show_percentages() ? "% Self" : "# Self";
+        switch (m_profile.metric()) {
+        case Profile::Metric::AllocatedBytes:
+            return m_profile.show_percentages() ? "% Self Bytes" : "# Self Bytes";
+        case Profile::Metric::OffCpuTime:
+            return m_profile.show_percentages() ? "% Self Off-CPU" : "Self Off-CPU ms";
+        case Profile::Metric::Samples:
+            return m_profile.show_percentages() ? "% Self" : "# Self";
+        }
+        VERIFY_NOT_REACHED();
     case Column::ObjectName:
         return "Object";
     case Column::StackFrame:
@@ -116,12 +132,12 @@ GUI::Variant ProfileModel::data(GUI::ModelIndex const& index, GUI::ModelRole rol
     if (role == GUI::ModelRole::Display) {
         if (index.column() == Column::SampleCount) {
             if (m_profile.show_percentages())
-                return ((float)node->event_count() / (float)m_profile.filtered_event_indices().size()) * 100.0f;
+                return ((float)node->event_count() / (float)m_profile.filtered_event_weight()) * 100.0f;
             return node->event_count();
         }
         if (index.column() == Column::SelfCount) {
             if (m_profile.show_percentages())
-                return ((float)node->self_count() / (float)m_profile.filtered_event_indices().size()) * 100.0f;
+                return ((float)node->self_count() / (float)m_profile.filtered_event_weight()) * 100.0f;
             return node->self_count();
         }
         if (index.column() == Column::ObjectName)
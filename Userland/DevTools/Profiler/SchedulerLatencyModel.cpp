@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "SchedulerLatencyModel.h"
+#include "Profile.h"
+#include <AK/BuiltinWrappers.h>
+
+namespace Profiler {
+
+SchedulerLatencyModel::SchedulerLatencyModel(Profile& profile)
+    : m_profile(profile)
+{
+}
+
+SchedulerLatencyModel::~SchedulerLatencyModel()
+{
+}
+
+void SchedulerLatencyModel::invalidate()
+{
+    m_buckets.fill(0);
+    m_total_count = 0;
+    for (auto event_index : m_profile.filtered_event_indices()) {
+        auto const& event = m_profile.events().at(event_index);
+        auto const* context_switch = event.data.get_pointer<Profile::Event::ContextSwitchData>();
+        if (!context_switch || !context_switch->scheduler_latency.has_value())
+            continue;
+        auto latency = context_switch->scheduler_latency.value();
+        size_t bucket = latency == 0 ? 0 : min(bucket_count - 1, 64 - count_leading_zeroes(latency));
+        ++m_buckets[bucket];
+        ++m_total_count;
+    }
+    GUI::Model::invalidate();
+}
+
+int SchedulerLatencyModel::row_count(GUI::ModelIndex const&) const
+{
+    return bucket_count;
+}
+
+int SchedulerLatencyModel::column_count(GUI::ModelIndex const&) const
+{
+    return Column::__Count;
+}
+
+String SchedulerLatencyModel::column_name(int column) const
+{
+    switch (column) {
+    case Column::Latency:
+        return "Latency";
+    case Column::SwitchCount:
+        return "# Switches";
+    case Column::Percentage:
+        return "% Switches";
+    default:
+        VERIFY_NOT_REACHED();
+    }
+}
+
+GUI::Variant SchedulerLatencyModel::data(GUI::ModelIndex const& index, GUI::ModelRole role) const
+{
+    size_t bucket = index.row();
+
+    if (role == GUI::ModelRole::TextAlignment) {
+        if (index.column() != Column::Latency)
+            return Gfx::TextAlignment::CenterRight;
+        return {};
+    }
+
+    if (role == GUI::ModelRole::Display) {
+        if (index.column() == Column::Latency) {
+            if (bucket == 0)
+                return "< 1 ms";
+            u64 low = 1ull << (bucket - 1);
+            if (bucket == bucket_count - 1)
+                return String::formatted(">= {} ms", low);
+            if (low == 1)
+                return "1 ms";
+            return String::formatted("{} - {} ms", low, low * 2 - 1);
+        }
+
+        if (index.column() == Column::SwitchCount)
+            return m_buckets[bucket];
+
+        if (index.column() == Column::Percentage) {
+            if (!m_total_count)
+                return 0.0f;
+            return ((float)m_buckets[bucket] / (float)m_total_count) * 100.0f;
+        }
+    }
+    return {};
+}
+
+}
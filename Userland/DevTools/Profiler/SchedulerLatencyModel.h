@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Array.h>
+#include <LibGUI/Model.h>
+
+namespace Profiler {
+
+class Profile;
+
+// How long threads had to wait for a CPU once they could run, over the filtered events.
+class SchedulerLatencyModel final : public GUI::Model {
+public:
+    static NonnullRefPtr<SchedulerLatencyModel> create(Profile& profile)
+    {
+        return adopt_ref(*new SchedulerLatencyModel(profile));
+    }
+
+    enum Column {
+        Latency,
+        SwitchCount,
+        Percentage,
+        __Count
+    };
+
+    virtual ~SchedulerLatencyModel() override;
+
+    virtual int row_count(GUI::ModelIndex const& = GUI::ModelIndex()) const override;
+    virtual int column_count(GUI::ModelIndex const& = GUI::ModelIndex()) const override;
+    virtual String column_name(int) const override;
+    virtual GUI::Variant data(GUI::ModelIndex const&, GUI::ModelRole) const override;
+    virtual bool is_column_sortable(int) const override { return false; }
+    virtual void invalidate() override;
+
+private:
+    explicit SchedulerLatencyModel(Profile&);
+
+    // Bucket 0 holds latencies under 1 ms, bucket n those from 2^(n-1) up to 2^n ms, and the last one all longer ones.
+    static constexpr size_t bucket_count = 10;
+
+    Profile& m_profile;
+    Array<u64, bucket_count> m_buckets {};
+    u64 m_total_count { 0 };
+};
+
+}
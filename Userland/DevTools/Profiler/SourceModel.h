@@ -14,7 +14,7 @@ class Profile;
 class ProfileNode;
 
 struct SourceLineData {
-    u32 event_count { 0 };
+    u64 event_count { 0 };
     float percent { 0 };
     String location;
     u32 line_number { 0 };
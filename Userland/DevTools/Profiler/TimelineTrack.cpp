@@ -7,12 +7,16 @@
 #include "TimelineTrack.h"
 #include "Profile.h"
 #include "TimelineView.h"
+#include <AK/StringBuilder.h>
 #include <LibGUI/Application.h>
 #include <LibGUI/Painter.h>
 #include <LibGfx/Palette.h>
 
 namespace Profiler {
 
+static constexpr Array counter_names { "Page faults"sv, "Syscalls"sv, "Context switches"sv, "kmalloc"sv };
+static constexpr Array counter_colors { Color::from_rgb(0xe08a1e), Color::from_rgb(0x2e9e4f), Color::from_rgb(0x9b59b6), Color::from_rgb(0x1e9ee0) };
+
 TimelineTrack::TimelineTrack(TimelineView const& view, Profile const& profile, Process const& process)
     : m_view(view)
     , m_profile(profile)
@@ -87,6 +91,22 @@ void TimelineTrack::paint_event(GUI::PaintEvent& event)
         painter.fill_rect({ x, frame_thickness() + kernel_column_height, cw, height() - frame_thickness() * 2 }, kernel_color);
     }
 
+    for (size_t counter = 0; counter < m_counter_histograms.size(); ++counter) {
+        auto const& counter_histogram = m_counter_histograms[counter];
+        if (!counter_histogram.max_value)
+            continue;
+        float counter_height = (float)(frame_inner_rect().height() - 1) / (float)counter_histogram.max_value;
+        Gfx::IntPoint previous_point;
+        for (size_t bucket = 0; bucket < counter_histogram.histogram->size(); bucket++) {
+            int x = (int)((float)bucket * column_width);
+            int y = frame_inner_rect().bottom() - (int)((float)counter_histogram.histogram->at(bucket) * counter_height);
+            Gfx::IntPoint point { x, y };
+            if (bucket > 0)
+                painter.draw_line(previous_point, point, counter_colors[counter]);
+            previous_point = point;
+        }
+    }
+
     u64 normalized_start_time = clamp_timestamp(min(m_view.select_start_time(), m_view.select_end_time()));
     u64 normalized_end_time = clamp_timestamp(max(m_view.select_start_time(), m_view.select_end_time()));
     u64 normalized_hover_time = clamp_timestamp(m_view.hover_time());
@@ -140,10 +160,30 @@ void TimelineTrack::mousemove_event(GUI::MouseEvent& event)
         return IterationDecision::Continue;
     });
 
-    if (!hovering_a_signpost)
+    if (hovering_a_signpost)
+        return;
+
+    size_t bucket = max(0, event.x()) / column_width;
+    if (auto description = counters_description(bucket); !description.is_empty())
+        GUI::Application::the()->show_tooltip_immediately(description, this);
+    else
         GUI::Application::the()->hide_tooltip();
 }
 
+String TimelineTrack::counters_description(size_t bucket) const
+{
+    StringBuilder builder;
+    for (size_t counter = 0; counter < m_counter_histograms.size(); ++counter) {
+        auto const& counter_histogram = m_counter_histograms[counter];
+        if (!counter_histogram.max_value || bucket >= counter_histogram.histogram->size())
+            continue;
+        if (!builder.is_empty())
+            builder.append(", ");
+        builder.appendff("{}: {}", counter_names[counter], counter_histogram.histogram->at(bucket));
+    }
+    return builder.to_string();
+}
+
 void TimelineTrack::recompute_histograms_if_needed(HistogramInputs const& inputs)
 {
     if (m_cached_histogram_inputs == inputs && m_kernel_histogram.has_value())
@@ -155,6 +195,8 @@ void TimelineTrack::recompute_histograms_if_needed(HistogramInputs const& inputs
 
     m_kernel_histogram = Histogram { inputs.start, inputs.end, inputs.columns };
     m_user_histogram = Histogram { inputs.start, inputs.end, inputs.columns };
+    for (auto& counter_histogram : m_counter_histograms)
+        counter_histogram = { Histogram { inputs.start, inputs.end, inputs.columns }, 0 };
 
     for (auto const& event : m_profile.events()) {
         if (event.pid != m_process.pid)
@@ -163,10 +205,35 @@ void TimelineTrack::recompute_histograms_if_needed(HistogramInputs const& inputs
         if (!m_process.valid_at(event.serial))
             continue;
 
+        auto counter = event.data.visit(
+            [](Profile::Event::PageFaultData const&) -> Optional<Counter> { return PageFaults; },
+            [](Profile::Event::SyscallData const&) -> Optional<Counter> { return Syscalls; },
+            [&](Profile::Event::ContextSwitchData const& data) -> Optional<Counter> {
+                if (!data.is_switch_out(event))
+                    return {};
+                return ContextSwitches;
+            },
+            [](Profile::Event::KmallocData const&) -> Optional<Counter> { return Kmalloc; },
+            [](auto const&) -> Optional<Counter> { return {}; });
+        if (counter.has_value()) {
+            auto& counter_histogram = m_counter_histograms[counter.value()];
+            counter_histogram.histogram->insert(clamp_timestamp(event.timestamp));
+            continue;
+        }
+
+        // Threads waking up or getting back on the CPU, and memory being freed, don't say anything about where the time went.
+        if (event.data.has<Profile::Event::ThreadWakeupData>() || event.data.has<Profile::Event::ContextSwitchData>() || event.data.has<Profile::Event::KfreeData>())
+            continue;
+
         auto& histogram = event.in_kernel ? *m_kernel_histogram : *m_user_histogram;
         histogram.insert(clamp_timestamp(event.timestamp), 1 + event.lost_samples);
     }
 
+    for (auto& counter_histogram : m_counter_histograms) {
+        for (size_t bucket = 0; bucket < counter_histogram.histogram->size(); ++bucket)
+            counter_histogram.max_value = max(counter_histogram.max_value, counter_histogram.histogram->at(bucket));
+    }
+
     auto shorter_histogram_size = min(m_kernel_histogram->size(), m_user_histogram->size());
     for (size_t bucket = 0; bucket < shorter_histogram_size; ++bucket) {
         auto value = m_kernel_histogram->at(bucket) + m_user_histogram->at(bucket);
@@ -180,6 +247,8 @@ void TimelineTrack::recompute_histograms_if_needed(HistogramInputs const& inputs
         if (value > m_max_value)
             m_max_value = value;
     }
+
+    m_cached_histogram_inputs = inputs;
 }
 
 float TimelineTrack::column_width() const
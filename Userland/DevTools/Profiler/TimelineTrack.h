@@ -7,6 +7,7 @@
 #pragma once
 
 #include "Histogram.h"
+#include <AK/Array.h>
 #include <LibGUI/Frame.h>
 
 namespace Profiler {
@@ -42,6 +43,21 @@ private:
 
     void recompute_histograms_if_needed(HistogramInputs const&);
 
+    // Events that count how often something happened, rather than where the time went. Each of them is drawn as a line
+    // over the samples, scaled to its own maximum.
+    enum Counter {
+        PageFaults,
+        Syscalls,
+        ContextSwitches,
+        Kmalloc,
+        __CounterCount
+    };
+    struct CounterHistogram {
+        Optional<Histogram<u64>> histogram;
+        u16 max_value { 0 };
+    };
+    String counters_description(size_t bucket) const;
+
     explicit TimelineTrack(TimelineView const&, Profile const&, Process const&);
 
     TimelineView const& m_view;
@@ -53,6 +69,7 @@ private:
     Optional<Histogram<u64>> m_kernel_histogram;
     Optional<Histogram<u64>> m_user_histogram;
     decltype(m_kernel_histogram->at(0)) m_max_value { 0 };
+    Array<CounterHistogram, __CounterCount> m_counter_histograms;
 };
 
 }
@@ -20,6 +20,7 @@
 #include <LibCore/Timer.h>
 #include <LibDesktop/Launcher.h>
 #include <LibGUI/Action.h>
+#include <LibGUI/ActionGroup.h>
 #include <LibGUI/Application.h>
 #include <LibGUI/BoxLayout.h>
 #include <LibGUI/Button.h>
@@ -210,6 +211,13 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
         individual_signpost_view->set_model(move(model));
     };
 
+    auto scheduler_latency_tab = TRY(tab_widget->try_add_tab<GUI::Widget>("Scheduler Latency"));
+    scheduler_latency_tab->set_layout<GUI::VerticalBoxLayout>();
+    scheduler_latency_tab->layout()->set_margins(4);
+
+    auto scheduler_latency_table_view = TRY(scheduler_latency_tab->try_add<GUI::TableView>());
+    scheduler_latency_table_view->set_model(profile->scheduler_latency_model());
+
     auto flamegraph_tab = TRY(tab_widget->try_add_tab<GUI::Widget>("Flame Graph"));
     flamegraph_tab->set_layout<GUI::VerticalBoxLayout>();
     flamegraph_tab->layout()->set_margins({ 4, 4, 4, 4 });
@@ -230,11 +238,11 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
         auto flamegraph_hovered_index = flamegraph_view->hovered_index();
         if (flamegraph_hovered_index.is_valid()) {
             auto stack = profile->model().data(flamegraph_hovered_index.sibling_at_column(ProfileModel::Column::StackFrame)).to_string();
-            auto sample_count = profile->model().data(flamegraph_hovered_index.sibling_at_column(ProfileModel::Column::SampleCount)).to_i32();
-            auto self_count = profile->model().data(flamegraph_hovered_index.sibling_at_column(ProfileModel::Column::SelfCount)).to_i32();
+            auto sample_count = profile->model().data(flamegraph_hovered_index.sibling_at_column(ProfileModel::Column::SampleCount)).to_i64();
+            auto self_count = profile->model().data(flamegraph_hovered_index.sibling_at_column(ProfileModel::Column::SelfCount)).to_i64();
             builder.appendff("{}, ", stack);
-            builder.appendff("Samples: {}{}, ", sample_count, profile->show_percentages() ? "%" : " Samples");
-            builder.appendff("Self: {}{}", self_count, profile->show_percentages() ? "%" : " Samples");
+            builder.appendff("{}: {}, ", profile->model().column_name(ProfileModel::Column::SampleCount), sample_count);
+            builder.appendff("{}: {}", profile->model().column_name(ProfileModel::Column::SelfCount), self_count);
         } else {
             u64 normalized_start_time = clamp_timestamp(min(view.select_start_time(), view.select_end_time()));
             u64 normalized_end_time = clamp_timestamp(max(view.select_start_time(), view.select_end_time()));
@@ -278,6 +286,30 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     percent_action->set_checked(false);
     TRY(view_menu->try_add_action(percent_action));
 
+    TRY(view_menu->try_add_separator());
+
+    GUI::ActionGroup metric_actions;
+    metric_actions.set_exclusive(true);
+
+    auto samples_action = GUI::Action::create_checkable("&Samples", [&](auto&) {
+        profile->set_metric(Profile::Metric::Samples);
+    });
+    auto allocated_bytes_action = GUI::Action::create_checkable("Allocated &Bytes", { Mod_Ctrl, Key_B }, [&](auto&) {
+        profile->set_metric(Profile::Metric::AllocatedBytes);
+    });
+    auto off_cpu_time_action = GUI::Action::create_checkable("&Off-CPU Time", { Mod_Ctrl, Key_O }, [&](auto&) {
+        profile->set_metric(Profile::Metric::OffCpuTime);
+    });
+
+    metric_actions.add_action(*samples_action);
+    metric_actions.add_action(*allocated_bytes_action);
+    metric_actions.add_action(*off_cpu_time_action);
+
+    TRY(view_menu->try_add_action(samples_action));
+    TRY(view_menu->try_add_action(allocated_bytes_action));
+    TRY(view_menu->try_add_action(off_cpu_time_action));
+    samples_action->set_checked(true);
+
     TRY(view_menu->try_add_action(disassembly_action));
     TRY(view_menu->try_add_action(source_action));
 
@@ -344,7 +376,8 @@ bool generate_profile(pid_t& pid)
     }
 
     static constexpr u64 event_mask = PERF_EVENT_SAMPLE | PERF_EVENT_MMAP | PERF_EVENT_MUNMAP | PERF_EVENT_PROCESS_CREATE
-        | PERF_EVENT_PROCESS_EXEC | PERF_EVENT_PROCESS_EXIT | PERF_EVENT_THREAD_CREATE | PERF_EVENT_THREAD_EXIT;
+        | PERF_EVENT_PROCESS_EXEC | PERF_EVENT_PROCESS_EXIT | PERF_EVENT_THREAD_CREATE | PERF_EVENT_THREAD_EXIT
+        | PERF_EVENT_CONTEXT_SWITCH | PERF_EVENT_THREAD_WAKEUP | PERF_EVENT_PAGE_FAULT;
 
     if (profiling_enable(pid, event_mask) < 0) {
         int saved_errno = errno;
@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include "InstructionCache.h"
 #include "MallocTracer.h"
 #include "RangeAllocator.h"
 #include "Report.h"
@@ -66,6 +67,7 @@ public:
     u32 virt_syscall(u32 function, u32 arg1, u32 arg2, u32 arg3);
 
     SoftMMU& mmu() { return m_mmu; }
+    InstructionCache& instruction_cache() { return m_instruction_cache; }
 
     MallocTracer* malloc_tracer() { return m_malloc_tracer; }
 
@@ -118,6 +120,7 @@ private:
 
     SoftMMU m_mmu;
     SoftCPU m_cpu;
+    InstructionCache m_instruction_cache;
 
     OwnPtr<MallocTracer> m_malloc_tracer;
 
@@ -1001,6 +1001,8 @@ u32 Emulator::virt$mprotect(FlatPtr base, size_t size, int prot)
     if (has_non_mmapped_region)
         return -EINVAL;
 
+    // The code that was decoded before mustn't run anymore if it's no longer executable.
+    m_instruction_cache.did_change_memory(base, size);
     return 0;
 }
 
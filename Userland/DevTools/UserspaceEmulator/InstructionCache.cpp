@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "InstructionCache.h"
+#include "SoftCPU.h"
+
+namespace UserspaceEmulator {
+
+InstructionCache::InstructionCache()
+    : m_pages_with_instructions(static_cast<size_t>(NumericLimits<u32>::max()) / PAGE_SIZE + 1, false)
+{
+}
+
+X86::Instruction InstructionCache::fetch(SoftCPU& cpu)
+{
+    u32 eip = cpu.eip();
+
+    if (m_current_block && eip == m_current_block->instructions[m_next_index_in_block - 1].next_eip) {
+        auto& block = *m_current_block;
+        if (m_next_index_in_block < block.instructions.size()) {
+            auto& decoded = block.instructions[m_next_index_in_block++];
+            cpu.set_eip(decoded.next_eip);
+            return decoded.instruction;
+        }
+        // The code ran past the end of the block without branching, so the block continues here.
+        if (block.instructions.size() < max_instructions_per_block)
+            return decode(cpu, block);
+    }
+
+    m_current_block = nullptr;
+    if (auto it = m_blocks.find(eip); it != m_blocks.end()) {
+        m_current_block = it->value.ptr();
+        m_next_index_in_block = 1;
+        auto& decoded = m_current_block->instructions.first();
+        cpu.set_eip(decoded.next_eip);
+        return decoded.instruction;
+    }
+
+    auto block = make<Block>();
+    block->base = eip;
+    auto instruction = decode(cpu, *block);
+    if (!block->instructions.is_empty()) {
+        m_current_block = block.ptr();
+        m_blocks.set(eip, move(block));
+    }
+    return instruction;
+}
+
+X86::Instruction InstructionCache::decode(SoftCPU& cpu, Block& block)
+{
+    u32 eip = cpu.eip();
+    auto instruction = X86::Instruction::from_stream(cpu, true, true);
+
+    // Invalid instructions aren't kept, so they're reported every time they're run.
+    if (!instruction.is_valid()) {
+        m_current_block = nullptr;
+        return instruction;
+    }
+
+    u32 next_eip = cpu.eip();
+    block.instructions.append({ instruction, next_eip });
+    m_next_index_in_block = block.instructions.size();
+
+    size_t first_page = eip / PAGE_SIZE;
+    size_t last_page = (next_eip - 1) / PAGE_SIZE;
+    m_pages_with_instructions.set_range(first_page, last_page - first_page + 1, true);
+    return instruction;
+}
+
+void InstructionCache::invalidate_pages(size_t first_page, size_t last_page)
+{
+    u64 start = static_cast<u64>(first_page) * PAGE_SIZE;
+    u64 end = static_cast<u64>(last_page + 1) * PAGE_SIZE;
+    m_blocks.remove_all_matching([&](auto, auto& block) {
+        return block->base < end && block->end() > start;
+    });
+
+    // Every block with instructions on these pages is gone now, even the ones that only started or ended there.
+    m_pages_with_instructions.set_range(first_page, last_page - first_page + 1, false);
+    m_current_block = nullptr;
+}
+
+}
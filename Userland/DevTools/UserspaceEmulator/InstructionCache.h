@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Bitmap.h>
+#include <AK/HashMap.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Types.h>
+#include <AK/Vector.h>
+#include <LibX86/Instruction.h>
+
+namespace UserspaceEmulator {
+
+class SoftCPU;
+
+// Keeps the instructions that were already decoded, so they don't have to be decoded again every time they run.
+// They're grouped into blocks of instructions that ran one after the other, keyed by the address of the first one.
+class InstructionCache {
+public:
+    InstructionCache();
+
+    // Returns the instruction at the CPU's EIP, and moves EIP past it, like X86::Instruction::from_stream() does.
+    X86::Instruction fetch(SoftCPU&);
+
+    // Anything that changes the code (or whether it may run) has to call this, so the old instructions aren't used.
+    ALWAYS_INLINE void did_change_memory(u32 address, size_t size)
+    {
+        if (size == 0)
+            return;
+        size_t first_page = address / PAGE_SIZE;
+        size_t last_page = (address + size - 1) / PAGE_SIZE;
+        for (size_t page = first_page; page <= last_page; ++page) {
+            if (m_pages_with_instructions.get(page)) [[unlikely]] {
+                invalidate_pages(first_page, last_page);
+                return;
+            }
+        }
+    }
+
+private:
+    static constexpr size_t max_instructions_per_block = 64;
+
+    struct DecodedInstruction {
+        X86::Instruction instruction;
+        u32 next_eip { 0 };
+    };
+
+    struct Block {
+        u32 base { 0 };
+        Vector<DecodedInstruction> instructions;
+
+        u32 end() const { return instructions.last().next_eip; }
+    };
+
+    X86::Instruction decode(SoftCPU&, Block&);
+    void invalidate_pages(size_t first_page, size_t last_page);
+
+    HashMap<u32, NonnullOwnPtr<Block>> m_blocks;
+    Bitmap m_pages_with_instructions;
+
+    // The block we're running, and where in it the next instruction is, if the code doesn't branch.
+    Block* m_current_block { nullptr };
+    size_t m_next_index_in_block { 0 };
+};
+
+}
@@ -11,11 +11,10 @@
 
 namespace UserspaceEmulator {
 
-static void* mmap_initialized(size_t bytes, char initial_value, const char* name)
+static void* mmap_anonymous(size_t bytes, int flags, const char* name)
 {
-    auto* ptr = mmap_with_name(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, 0, 0, name);
+    auto* ptr = mmap_with_name(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE | flags, 0, 0, name);
     VERIFY(ptr != MAP_FAILED);
-    memset(ptr, initial_value, bytes);
     return ptr;
 }
 
@@ -27,8 +26,8 @@ static void free_pages(void* ptr, size_t bytes)
 
 NonnullOwnPtr<MmapRegion> MmapRegion::create_anonymous(u32 base, u32 size, u32 prot, String name)
 {
-    auto* data = (u8*)mmap_initialized(size, 0, String::formatted("(UE) {}", name).characters());
-    auto* shadow_data = (u8*)mmap_initialized(size, 1, "MmapRegion ShadowData");
+    auto* data = (u8*)mmap_anonymous(size, 0, String::formatted("(UE) {}", name).characters());
+    auto* shadow_data = (u8*)mmap_anonymous(size, MAP_NORESERVE, "MmapRegion ShadowData");
     auto region = adopt_own(*new MmapRegion(base, size, prot, data, shadow_data));
     region->m_name = move(name);
     return region;
@@ -40,7 +39,7 @@ NonnullOwnPtr<MmapRegion> MmapRegion::create_file_backed(u32 base, u32 size, u32
     auto real_flags = flags & ~(MAP_FIXED | MAP_FIXED_NOREPLACE);
     auto* data = (u8*)mmap_with_name(nullptr, size, prot, real_flags, fd, offset, name.is_empty() ? nullptr : String::formatted("(UE) {}", name).characters());
     VERIFY(data != MAP_FAILED);
-    auto* shadow_data = (u8*)mmap_initialized(size, 1, "MmapRegion ShadowData");
+    auto* shadow_data = (u8*)mmap_anonymous(size, MAP_NORESERVE, "MmapRegion ShadowData");
     auto region = adopt_own(*new MmapRegion(base, size, prot, data, shadow_data));
     region->m_file_backed = true;
     region->m_name = move(name);
@@ -51,6 +50,7 @@ MmapRegion::MmapRegion(u32 base, u32 size, int prot, u8* data, u8* shadow_data)
     : Region(base, size, true)
     , m_data(data)
     , m_shadow_data(shadow_data)
+    , m_pages_with_shadow(ceil_div(size, PAGE_SIZE), false)
 {
     set_prot(prot);
 }
@@ -75,7 +75,7 @@ ValueWithShadow<u8> MmapRegion::read8(FlatPtr offset)
     }
 
     VERIFY(offset < size());
-    return { m_data[offset], m_shadow_data[offset] };
+    return { m_data[offset], read_shadow<u8>(offset) };
 }
 
 ValueWithShadow<u16> MmapRegion::read16(u32 offset)
@@ -92,9 +92,9 @@ ValueWithShadow<u16> MmapRegion::read16(u32 offset)
     }
 
     VERIFY(offset + 1 < size());
-    u16 value, shadow;
+    u16 value;
     ByteReader::load(m_data + offset, value);
-    ByteReader::load(m_shadow_data + offset, shadow);
+    auto shadow = read_shadow<u16>(offset);
 
     return { value, shadow };
 }
@@ -113,9 +113,9 @@ ValueWithShadow<u32> MmapRegion::read32(u32 offset)
     }
 
     VERIFY(offset + 3 < size());
-    u32 value, shadow;
+    u32 value;
     ByteReader::load(m_data + offset, value);
-    ByteReader::load(m_shadow_data + offset, shadow);
+    auto shadow = read_shadow<u32>(offset);
 
     return { value, shadow };
 }
@@ -134,9 +134,9 @@ ValueWithShadow<u64> MmapRegion::read64(u32 offset)
     }
 
     VERIFY(offset + 7 < size());
-    u64 value, shadow;
+    u64 value;
     ByteReader::load(m_data + offset, value);
-    ByteReader::load(m_shadow_data + offset, shadow);
+    auto shadow = read_shadow<u64>(offset);
 
     return { value, shadow };
 }
@@ -155,9 +155,9 @@ ValueWithShadow<u128> MmapRegion::read128(u32 offset)
     }
 
     VERIFY(offset + 15 < size());
-    u128 value, shadow;
+    u128 value;
     ByteReader::load(m_data + offset, value);
-    ByteReader::load(m_shadow_data + offset, shadow);
+    auto shadow = read_shadow<u128>(offset);
     return { value, shadow };
 }
 
@@ -175,9 +175,9 @@ ValueWithShadow<u256> MmapRegion::read256(u32 offset)
     }
 
     VERIFY(offset + 31 < size());
-    u256 value, shadow;
+    u256 value;
     ByteReader::load(m_data + offset, value);
-    ByteReader::load(m_shadow_data + offset, shadow);
+    auto shadow = read_shadow<u256>(offset);
     return { value, shadow };
 }
 
@@ -196,7 +196,7 @@ void MmapRegion::write8(u32 offset, ValueWithShadow<u8> value)
 
     VERIFY(offset < size());
     m_data[offset] = value.value();
-    m_shadow_data[offset] = value.shadow();
+    write_shadow(offset, value.shadow());
 }
 
 void MmapRegion::write16(u32 offset, ValueWithShadow<u16> value)
@@ -214,7 +214,7 @@ void MmapRegion::write16(u32 offset, ValueWithShadow<u16> value)
 
     VERIFY(offset + 1 < size());
     ByteReader::store(m_data + offset, value.value());
-    ByteReader::store(m_shadow_data + offset, value.shadow());
+    write_shadow(offset, value.shadow());
 }
 
 void MmapRegion::write32(u32 offset, ValueWithShadow<u32> value)
@@ -233,7 +233,7 @@ void MmapRegion::write32(u32 offset, ValueWithShadow<u32> value)
     VERIFY(offset + 3 < size());
     VERIFY(m_data != m_shadow_data);
     ByteReader::store(m_data + offset, value.value());
-    ByteReader::store(m_shadow_data + offset, value.shadow());
+    write_shadow(offset, value.shadow());
 }
 
 void MmapRegion::write64(u32 offset, ValueWithShadow<u64> value)
@@ -252,7 +252,7 @@ void MmapRegion::write64(u32 offset, ValueWithShadow<u64> value)
     VERIFY(offset + 7 < size());
     VERIFY(m_data != m_shadow_data);
     ByteReader::store(m_data + offset, value.value());
-    ByteReader::store(m_shadow_data + offset, value.shadow());
+    write_shadow(offset, value.shadow());
 }
 
 void MmapRegion::write128(u32 offset, ValueWithShadow<u128> value)
@@ -270,7 +270,7 @@ void MmapRegion::write128(u32 offset, ValueWithShadow<u128> value)
     VERIFY(offset + 15 < size());
     VERIFY(m_data != m_shadow_data);
     ByteReader::store(m_data + offset, value.value());
-    ByteReader::store(m_shadow_data + offset, value.shadow());
+    write_shadow(offset, value.shadow());
 }
 
 void MmapRegion::write256(u32 offset, ValueWithShadow<u256> value)
@@ -288,7 +288,49 @@ void MmapRegion::write256(u32 offset, ValueWithShadow<u256> value)
     VERIFY(offset + 31 < size());
     VERIFY(m_data != m_shadow_data);
     ByteReader::store(m_data + offset, value.value());
-    ByteReader::store(m_shadow_data + offset, value.shadow());
+    write_shadow(offset, value.shadow());
+}
+
+u8* MmapRegion::shadow_data()
+{
+    materialize_shadow(0, size());
+    return m_shadow_data;
+}
+
+void MmapRegion::fill_shadow(u32 offset, size_t size, u8 value)
+{
+    if (size == 0)
+        return;
+    VERIFY(offset + size <= this->size());
+
+    if (value != 0x01) {
+        materialize_shadow(offset, size);
+        memset(m_shadow_data + offset, value, size);
+        return;
+    }
+
+    // Pages that are entirely initialized now don't need their shadow anymore.
+    for (size_t page = offset / PAGE_SIZE; page <= (offset + size - 1) / PAGE_SIZE; ++page) {
+        size_t page_start = page * PAGE_SIZE;
+        size_t page_end = min<size_t>(page_start + PAGE_SIZE, this->size());
+        size_t fill_start = max<size_t>(page_start, offset);
+        size_t fill_end = min<size_t>(page_end, offset + size);
+        if (fill_start == page_start && fill_end == page_end)
+            m_pages_with_shadow.set(page, false);
+        else if (m_pages_with_shadow.get(page))
+            memset(m_shadow_data + fill_start, 0x01, fill_end - fill_start);
+    }
+}
+
+void MmapRegion::materialize_shadow(u32 offset, size_t size)
+{
+    for (size_t page = offset / PAGE_SIZE; page <= (offset + size - 1) / PAGE_SIZE; ++page) {
+        if (m_pages_with_shadow.get(page))
+            continue;
+        size_t page_start = page * PAGE_SIZE;
+        memset(m_shadow_data + page_start, 0x01, min<size_t>(PAGE_SIZE, this->size() - page_start));
+        m_pages_with_shadow.set(page, true);
+    }
 }
 
 NonnullOwnPtr<MmapRegion> MmapRegion::split_at(VirtualAddress offset)
@@ -300,6 +342,9 @@ NonnullOwnPtr<MmapRegion> MmapRegion::split_at(VirtualAddress offset)
     auto other_region = adopt_own(*new MmapRegion(other_range.base().get(), other_range.size(), prot(), data() + new_range.size(), shadow_data() + new_range.size()));
     other_region->m_file_backed = m_file_backed;
     other_region->m_name = m_name;
+    size_t first_page_of_other_region = new_range.size() / PAGE_SIZE;
+    for (size_t page = 0; page < other_region->m_pages_with_shadow.size(); ++page)
+        other_region->m_pages_with_shadow.set(page, m_pages_with_shadow.get(first_page_of_other_region + page));
     set_range(new_range);
     return other_region;
 }
@@ -7,6 +7,8 @@
 #pragma once
 
 #include "SoftMMU.h"
+#include <AK/Bitmap.h>
+#include <AK/ByteReader.h>
 #include <sys/mman.h>
 
 namespace UserspaceEmulator {
@@ -35,7 +37,9 @@ public:
     virtual void write256(u32 offset, ValueWithShadow<u256>) override;
 
     virtual u8* data() override { return m_data; }
-    virtual u8* shadow_data() override { return m_shadow_data; }
+    // NOTE: This has to keep the shadow of every page, so fill_shadow() should be used instead where possible.
+    virtual u8* shadow_data() override;
+    virtual void fill_shadow(u32 offset, size_t size, u8 value) override;
 
     bool is_malloc_block() const { return m_malloc; }
     void set_malloc(bool b) { m_malloc = b; }
@@ -66,8 +70,41 @@ public:
 private:
     MmapRegion(u32 base, u32 size, int prot, u8* data, u8* shadow_data);
 
+    ALWAYS_INLINE bool has_shadow(u32 offset, size_t size) const
+    {
+        return m_pages_with_shadow.get(offset / PAGE_SIZE) || m_pages_with_shadow.get((offset + size - 1) / PAGE_SIZE);
+    }
+
+    template<typename T>
+    ALWAYS_INLINE T read_shadow(u32 offset)
+    {
+        if (!has_shadow(offset, sizeof(T)))
+            return shadow_wrap_as_initialized(T {}).shadow();
+        // An access can span a page that has a shadow and one that doesn't.
+        materialize_shadow(offset, sizeof(T));
+        T shadow;
+        ByteReader::load(m_shadow_data + offset, shadow);
+        return shadow;
+    }
+
+    template<typename T>
+    ALWAYS_INLINE void write_shadow(u32 offset, T shadow)
+    {
+        if (!has_shadow(offset, sizeof(T)) && shadow == shadow_wrap_as_initialized(T {}).shadow())
+            return;
+        materialize_shadow(offset, sizeof(T));
+        ByteReader::store(m_shadow_data + offset, shadow);
+    }
+
+    void materialize_shadow(u32 offset, size_t size);
+
     u8* m_data { nullptr };
     u8* m_shadow_data { nullptr };
+
+    // Most memory never holds uninitialized bytes, so the shadow is only kept for the pages that do. The shadow of
+    // every other page would be all 0x01, and its part of m_shadow_data is never touched, so it takes up no memory.
+    Bitmap m_pages_with_shadow;
+
     bool m_file_backed { false };
     bool m_malloc { false };
 
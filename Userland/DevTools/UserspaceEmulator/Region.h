@@ -60,6 +60,7 @@ public:
 
     virtual u8* data() = 0;
     virtual u8* shadow_data() = 0;
+    virtual void fill_shadow(u32 offset, size_t size, u8 value) { memset(shadow_data() + offset, value, size); }
 
     Emulator& emulator() { return m_emulator; }
     const Emulator& emulator() const { return m_emulator; }
@@ -35,6 +35,10 @@ void SoftMMU::add_region(NonnullOwnPtr<Region> region)
 
 void SoftMMU::remove_region(Region& region)
 {
+    m_emulator.instruction_cache().did_change_memory(region.base(), region.size());
+    if (m_last_region == &region)
+        m_last_region = nullptr;
+
     size_t first_page_in_region = region.base() / PAGE_SIZE;
     for (size_t i = 0; i < ceil_div(region.size(), PAGE_SIZE); ++i) {
         m_page_to_region_map[first_page_in_region + i] = nullptr;
@@ -213,6 +217,7 @@ void SoftMMU::write8(X86::LogicalAddress address, ValueWithShadow<u8> value)
         TODO();
     }
     region->write8(address.offset() - region->base(), value);
+    m_emulator.instruction_cache().did_change_memory(address.offset(), sizeof(u8));
 }
 
 void SoftMMU::write16(X86::LogicalAddress address, ValueWithShadow<u16> value)
@@ -231,6 +236,7 @@ void SoftMMU::write16(X86::LogicalAddress address, ValueWithShadow<u16> value)
     }
 
     region->write16(address.offset() - region->base(), value);
+    m_emulator.instruction_cache().did_change_memory(address.offset(), sizeof(u16));
 }
 
 void SoftMMU::write32(X86::LogicalAddress address, ValueWithShadow<u32> value)
@@ -249,6 +255,7 @@ void SoftMMU::write32(X86::LogicalAddress address, ValueWithShadow<u32> value)
     }
 
     region->write32(address.offset() - region->base(), value);
+    m_emulator.instruction_cache().did_change_memory(address.offset(), sizeof(u32));
 }
 
 void SoftMMU::write64(X86::LogicalAddress address, ValueWithShadow<u64> value)
@@ -267,6 +274,7 @@ void SoftMMU::write64(X86::LogicalAddress address, ValueWithShadow<u64> value)
     }
 
     region->write64(address.offset() - region->base(), value);
+    m_emulator.instruction_cache().did_change_memory(address.offset(), sizeof(u64));
 }
 
 void SoftMMU::write128(X86::LogicalAddress address, ValueWithShadow<u128> value)
@@ -285,6 +293,7 @@ void SoftMMU::write128(X86::LogicalAddress address, ValueWithShadow<u128> value)
     }
 
     region->write128(address.offset() - region->base(), value);
+    m_emulator.instruction_cache().did_change_memory(address.offset(), sizeof(u128));
 }
 
 void SoftMMU::write256(X86::LogicalAddress address, ValueWithShadow<u256> value)
@@ -303,6 +312,7 @@ void SoftMMU::write256(X86::LogicalAddress address, ValueWithShadow<u256> value)
     }
 
     region->write256(address.offset() - region->base(), value);
+    m_emulator.instruction_cache().did_change_memory(address.offset(), sizeof(u256));
 }
 
 void SoftMMU::copy_to_vm(FlatPtr destination, const void* source, size_t size)
@@ -347,7 +357,8 @@ bool SoftMMU::fast_fill_memory8(X86::LogicalAddress address, size_t size, ValueW
 
     size_t offset_in_region = address.offset() - region->base();
     memset(region->data() + offset_in_region, value.value(), size);
-    memset(region->shadow_data() + offset_in_region, value.shadow(), size);
+    region->fill_shadow(offset_in_region, size, value.shadow());
+    m_emulator.instruction_cache().did_change_memory(address.offset(), size);
     return true;
 }
 
@@ -360,6 +371,10 @@ bool SoftMMU::fast_fill_memory32(X86::LogicalAddress address, size_t count, Valu
         return false;
     if (!region->contains(address.offset() + (count * sizeof(u32)) - 1))
         return false;
+    // The shadow can only be filled in one go if it's the same for every byte.
+    u8 shadow_byte = value.shadow() & 0xff;
+    if (value.shadow() != shadow_byte * 0x01010101u)
+        return false;
 
     if (is<MmapRegion>(*region) && static_cast<const MmapRegion&>(*region).is_malloc_block()) {
         if (auto* tracer = m_emulator.malloc_tracer()) {
@@ -372,7 +387,8 @@ bool SoftMMU::fast_fill_memory32(X86::LogicalAddress address, size_t count, Valu
 
     size_t offset_in_region = address.offset() - region->base();
     fast_u32_fill((u32*)(region->data() + offset_in_region), value.value(), count);
-    fast_u32_fill((u32*)(region->shadow_data() + offset_in_region), value.shadow(), count);
+    region->fill_shadow(offset_in_region, count * sizeof(u32), shadow_byte);
+    m_emulator.instruction_cache().did_change_memory(address.offset(), count * sizeof(u32));
     return true;
 }
 
@@ -14,6 +14,9 @@ namespace Audio {
 // Real-time audio may be improved with a lower value.
 static timespec g_enqueue_wait_time { 0, 10'000'000 };
 
+// About a third of a second at 48 kHz. When the ring is full, we wait until half of it has been played.
+static constexpr size_t sample_ring_capacity = 16 * KiB;
+
 ClientConnection::ClientConnection()
     : IPC::ServerConnection<AudioClientEndpoint, AudioServerEndpoint>(*this, "/tmp/portal/audio")
 {
@@ -39,6 +42,45 @@ bool ClientConnection::try_enqueue(Buffer const& buffer)
     return enqueue_buffer(buffer.anonymous_buffer(), buffer.id(), buffer.sample_count());
 }
 
+ErrorOr<void> ClientConnection::ensure_sample_ring()
+{
+    if (m_sample_ring.has_value())
+        return {};
+
+    auto sample_ring = TRY(SampleRing::create(sample_ring_capacity));
+    if (!set_sample_ring(sample_ring.anonymous_buffer()))
+        return Error::from_string_literal("AudioServer refused the sample ring"sv);
+    m_sample_ring = move(sample_ring);
+    return {};
+}
+
+ErrorOr<void> ClientConnection::write_samples(Span<Sample const> samples)
+{
+    TRY(ensure_sample_ring());
+
+    for (;;) {
+        samples = samples.slice(m_sample_ring->write(samples));
+        if (samples.is_empty())
+            return {};
+
+        // Wait for the server to tell us that it has played enough, instead of checking back on every period.
+        auto wanted_space = min(samples.size(), m_sample_ring->capacity() / 2);
+        m_sample_ring->request_wakeup(wanted_space);
+        // NOTE: The server may have played enough before it saw our request.
+        if (m_sample_ring->free_space() >= wanted_space) {
+            m_sample_ring->cancel_wakeup_request();
+            continue;
+        }
+        // NOTE: There may be a stale wakeup from an earlier request, but then we'll just end up back here.
+        if (!wait_for_specific_message<Messages::AudioClient::SampleRingSpaceAvailable>())
+            return Error::from_string_literal("Lost the connection to AudioServer"sv);
+    }
+}
+
+void ClientConnection::sample_ring_space_available()
+{
+}
+
 void ClientConnection::finished_playing_buffer(i32 buffer_id)
 {
     if (on_finish_playing_buffer)
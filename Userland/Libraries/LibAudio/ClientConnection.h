@@ -8,6 +8,9 @@
 
 #include <AudioServer/AudioClientEndpoint.h>
 #include <AudioServer/AudioServerEndpoint.h>
+#include <AK/Span.h>
+#include <LibAudio/Sample.h>
+#include <LibAudio/SampleRing.h>
 #include <LibIPC/ServerConnection.h>
 
 namespace Audio {
@@ -23,6 +26,11 @@ public:
     bool try_enqueue(Buffer const&);
     void async_enqueue(Buffer const&);
 
+    // Writes the samples into a ring that is shared with the server, waiting for it to play earlier samples if the ring
+    // is full. Once the ring has been set up, this doesn't send any IPC messages, so it's fine to write small periods.
+    // NOTE: The ring can only be set up before any buffers have been enqueued.
+    ErrorOr<void> write_samples(Span<Sample const>);
+
     Function<void(i32 buffer_id)> on_finish_playing_buffer;
     Function<void(bool muted)> on_main_mix_muted_state_change;
     Function<void(double volume)> on_main_mix_volume_change;
@@ -32,9 +40,14 @@ private:
     ClientConnection();
 
     virtual void finished_playing_buffer(i32) override;
+    virtual void sample_ring_space_available() override;
     virtual void main_mix_muted_state_changed(bool) override;
     virtual void main_mix_volume_changed(double) override;
     virtual void client_volume_changed(double) override;
+
+    ErrorOr<void> ensure_sample_ring();
+
+    Optional<SampleRing> m_sample_ring;
 };
 
 }
@@ -185,8 +185,13 @@ MaybeLoaderError FlacLoaderPlugin::reset()
 
 MaybeLoaderError FlacLoaderPlugin::seek(const int position)
 {
+    if (m_bit_stream)
+        m_bit_stream->handle_any_error();
+    m_bit_stream = nullptr;
     if (!m_stream->seek(position))
         return LoaderError { LoaderError::IO, m_loaded_samples, String::formatted("Invalid seek position {}", position) };
+    m_bit_stream = m_stream->bit_stream();
+    m_bit_stream->set_read_ahead(true);
     return {};
 }
 
@@ -215,7 +220,7 @@ LoaderSamples FlacLoaderPlugin::get_more_samples(size_t max_bytes_to_read_from_i
     while (sample_index < samples_to_read) {
         TRY(next_frame(samples.span().slice(sample_index)));
         sample_index += m_current_frame->sample_count;
-        if (m_stream->handle_any_error())
+        if (m_bit_stream->handle_any_error() || m_stream->handle_any_error())
             return LoaderError { LoaderError::Category::IO, m_loaded_samples, "Unknown I/O error" };
     }
 
@@ -234,7 +239,7 @@ MaybeLoaderError FlacLoaderPlugin::next_frame(Span<Sample> target_vector)
             return LoaderError { category, static_cast<size_t>(m_current_sample_or_frame), String::formatted("FLAC header: {}", msg) }; \
         }                                                                                                                               \
     } while (0)
-    InputBitStream bit_stream = m_stream->bit_stream();
+    auto& bit_stream = *m_bit_stream;
 
     // TODO: Check the CRC-16 checksum (and others) by keeping track of read data
 
@@ -289,13 +294,9 @@ MaybeLoaderError FlacLoaderPlugin::next_frame(Span<Sample> target_vector)
     };
 
     u8 subframe_count = frame_channel_type_to_channel_count(channel_type);
-    Vector<Vector<i32>> current_subframes;
-    current_subframes.ensure_capacity(subframe_count);
-
     for (u8 i = 0; i < subframe_count; ++i) {
         FlacSubframeHeader new_subframe = TRY(next_subframe_header(bit_stream, i));
-        Vector<i32> subframe_samples = TRY(parse_subframe(new_subframe, bit_stream));
-        current_subframes.unchecked_append(move(subframe_samples));
+        TRY(parse_subframe(new_subframe, bit_stream, m_subframe_samples[i]));
     }
 
     bit_stream.align_to_byte_boundary();
@@ -304,13 +305,13 @@ MaybeLoaderError FlacLoaderPlugin::next_frame(Span<Sample> target_vector)
     [[maybe_unused]] u16 footer_checksum = static_cast<u16>(bit_stream.read_bits_big_endian(16));
     dbgln_if(AFLACLOADER_DEBUG, "Subframe footer checksum: {}", footer_checksum);
 
-    Vector<i32> left;
-    Vector<i32> right;
+    // The channels are decorrelated in place, so left and right end up in the buffers of the first two subframes.
+    auto* left = m_subframe_samples[0].data();
+    auto* right = m_subframe_samples[subframe_count > 1 ? 1 : 0].data();
+    size_t const decoded_sample_count = m_subframe_samples[0].size();
 
     switch (channel_type) {
     case FlacFrameChannelType::Mono:
-        left = right = current_subframes[0];
-        break;
     case FlacFrameChannelType::Stereo:
     // TODO mix together surround channels on each side?
     case FlacFrameChannelType::StereoCenter:
@@ -319,43 +320,35 @@ MaybeLoaderError FlacLoaderPlugin::next_frame(Span<Sample> target_vector)
     case FlacFrameChannelType::Surround5p1:
     case FlacFrameChannelType::Surround6p1:
     case FlacFrameChannelType::Surround7p1:
-        left = current_subframes[0];
-        right = current_subframes[1];
         break;
     case FlacFrameChannelType::LeftSideStereo:
         // channels are left (0) and side (1)
-        left = current_subframes[0];
-        right.ensure_capacity(left.size());
-        for (size_t i = 0; i < left.size(); ++i) {
+        for (size_t i = 0; i < decoded_sample_count; ++i) {
             // right = left - side
-            right.unchecked_append(left[i] - current_subframes[1][i]);
+            right[i] = left[i] - right[i];
         }
         break;
     case FlacFrameChannelType::RightSideStereo:
         // channels are side (0) and right (1)
-        right = current_subframes[1];
-        left.ensure_capacity(right.size());
-        for (size_t i = 0; i < right.size(); ++i) {
+        for (size_t i = 0; i < decoded_sample_count; ++i) {
             // left = right + side
-            left.unchecked_append(right[i] + current_subframes[0][i]);
+            left[i] = right[i] + left[i];
         }
         break;
     case FlacFrameChannelType::MidSideStereo:
         // channels are mid (0) and side (1)
-        left.ensure_capacity(current_subframes[0].size());
-        right.ensure_capacity(current_subframes[0].size());
-        for (size_t i = 0; i < current_subframes[0].size(); ++i) {
-            i64 mid = current_subframes[0][i];
-            i64 side = current_subframes[1][i];
+        for (size_t i = 0; i < decoded_sample_count; ++i) {
+            i64 mid = left[i];
+            i64 side = right[i];
             mid *= 2;
             // prevent integer division errors
-            left.unchecked_append(static_cast<i32>((mid + side) / 2));
-            right.unchecked_append(static_cast<i32>((mid - side) / 2));
+            left[i] = static_cast<i32>((mid + side) / 2);
+            right[i] = static_cast<i32>((mid - side) / 2);
         }
         break;
     }
 
-    VERIFY(left.size() == right.size() && left.size() == m_current_frame->sample_count);
+    VERIFY(m_subframe_samples[subframe_count > 1 ? 1 : 0].size() == decoded_sample_count && decoded_sample_count == m_current_frame->sample_count);
 
     double sample_rescale = static_cast<double>(1 << (pcm_bits_per_sample(m_current_frame->bit_depth) - 1));
     dbgln_if(AFLACLOADER_DEBUG, "Sample rescaled from {} bits: factor {:.1f}", pcm_bits_per_sample(m_current_frame->bit_depth), sample_rescale);
@@ -527,78 +520,104 @@ ErrorOr<FlacSubframeHeader, LoaderError> FlacLoaderPlugin::next_subframe_header(
     };
 }
 
-ErrorOr<Vector<i32>, LoaderError> FlacLoaderPlugin::parse_subframe(FlacSubframeHeader& subframe_header, InputBitStream& bit_input)
+MaybeLoaderError FlacLoaderPlugin::parse_subframe(FlacSubframeHeader& subframe_header, InputBitStream& bit_input, Vector<i32>& samples)
 {
-    Vector<i32> samples;
+    // NOTE: This only allocates if the frame is bigger than any frame before it.
+    if (samples.try_resize_and_keep_capacity(m_current_frame->sample_count).is_error())
+        return LoaderError { LoaderError::Category::Internal, static_cast<size_t>(m_current_sample_or_frame), "Couldn't allocate subframe buffer" };
 
     switch (subframe_header.type) {
     case FlacSubframeType::Constant: {
         u64 constant_value = bit_input.read_bits_big_endian(subframe_header.bits_per_sample - subframe_header.wasted_bits_per_sample);
         dbgln_if(AFLACLOADER_DEBUG, "Constant subframe: {}", constant_value);
 
-        samples.ensure_capacity(m_current_frame->sample_count);
         VERIFY(subframe_header.bits_per_sample - subframe_header.wasted_bits_per_sample != 0);
         i32 constant = sign_extend(static_cast<u32>(constant_value), subframe_header.bits_per_sample - subframe_header.wasted_bits_per_sample);
-        for (u32 i = 0; i < m_current_frame->sample_count; ++i) {
-            samples.unchecked_append(constant);
-        }
+        samples.span().fill(constant);
         break;
     }
     case FlacSubframeType::Fixed: {
         dbgln_if(AFLACLOADER_DEBUG, "Fixed LPC subframe order {}", subframe_header.order);
-        samples = TRY(decode_fixed_lpc(subframe_header, bit_input));
+        TRY(decode_fixed_lpc(subframe_header, bit_input, samples));
         break;
     }
     case FlacSubframeType::Verbatim: {
         dbgln_if(AFLACLOADER_DEBUG, "Verbatim subframe");
-        samples = TRY(decode_verbatim(subframe_header, bit_input));
+        TRY(decode_verbatim(subframe_header, bit_input, samples));
         break;
     }
     case FlacSubframeType::LPC: {
         dbgln_if(AFLACLOADER_DEBUG, "Custom LPC subframe order {}", subframe_header.order);
-        samples = TRY(decode_custom_lpc(subframe_header, bit_input));
+        TRY(decode_custom_lpc(subframe_header, bit_input, samples));
         break;
     }
     default:
         return LoaderError { LoaderError::Category::Unimplemented, static_cast<size_t>(m_current_sample_or_frame), "Unhandled FLAC subframe type" };
     }
 
-    for (size_t i = 0; i < samples.size(); ++i) {
-        samples[i] <<= subframe_header.wasted_bits_per_sample;
+    if (subframe_header.wasted_bits_per_sample != 0) {
+        for (auto& sample : samples)
+            sample <<= subframe_header.wasted_bits_per_sample;
     }
 
-    ResampleHelper<i32> resampler(m_current_frame->sample_rate, m_sample_rate);
-    return resampler.resample(samples);
+    if (m_current_frame->sample_rate != m_sample_rate) {
+        ResampleHelper<i32> resampler(m_current_frame->sample_rate, m_sample_rate);
+        samples = resampler.resample(move(samples));
+    }
+    return {};
 }
 
 // Decode a subframe that isn't actually encoded, usually seen in random data
-ErrorOr<Vector<i32>, LoaderError> FlacLoaderPlugin::decode_verbatim(FlacSubframeHeader& subframe, InputBitStream& bit_input)
+MaybeLoaderError FlacLoaderPlugin::decode_verbatim(FlacSubframeHeader& subframe, InputBitStream& bit_input, Span<i32> decoded)
 {
-    Vector<i32> decoded;
-    decoded.ensure_capacity(m_current_frame->sample_count);
-
     VERIFY(subframe.bits_per_sample - subframe.wasted_bits_per_sample != 0);
-    for (size_t i = 0; i < m_current_frame->sample_count; ++i) {
-        decoded.unchecked_append(sign_extend(
+    for (auto& sample : decoded) {
+        sample = sign_extend(
             static_cast<u32>(bit_input.read_bits_big_endian(subframe.bits_per_sample - subframe.wasted_bits_per_sample)),
-            subframe.bits_per_sample - subframe.wasted_bits_per_sample));
+            subframe.bits_per_sample - subframe.wasted_bits_per_sample);
     }
 
-    return decoded;
+    return {};
+}
+
+// Restores the signal from the residual (which is already in the buffer) with the predictor.
+// Every sample is predicted from the ones just before it, so there is nothing to compute in parallel across samples.
+// Instead, the orders that encoders use most get a fully unrolled loop, and the products are summed up in 32 bits where
+// that can't overflow. The arithmetic is unsigned so that it wraps around (instead of being undefined) on invalid input.
+template<typename Accumulator, size_t Order = 1>
+static void restore_lpc_signal(Span<i32> decoded, Span<i32 const> coefficients, u8 shift)
+{
+    static_assert(IsSame<Accumulator, u32> || IsSame<Accumulator, u64>);
+    constexpr size_t max_unrolled_order = 12;
+
+    if constexpr (Order <= max_unrolled_order) {
+        if (coefficients.size() != Order)
+            return restore_lpc_signal<Accumulator, Order + 1>(decoded, coefficients, shift);
+    }
+
+    size_t const order = Order <= max_unrolled_order ? Order : coefficients.size();
+    auto* samples = decoded.data();
+    auto const* coefficient = coefficients.data();
+    for (size_t i = order; i < decoded.size(); ++i) {
+        Accumulator prediction = 0;
+        for (size_t t = 0; t < order; ++t)
+            prediction += static_cast<Accumulator>(coefficient[t]) * static_cast<Accumulator>(samples[i - t - 1]);
+        samples[i] += static_cast<MakeSigned<Accumulator>>(prediction) >> shift;
+    }
 }
 
 // Decode a subframe encoded with a custom linear predictor coding, i.e. the subframe provides the polynomial order and coefficients
-ErrorOr<Vector<i32>, LoaderError> FlacLoaderPlugin::decode_custom_lpc(FlacSubframeHeader& subframe, InputBitStream& bit_input)
+MaybeLoaderError FlacLoaderPlugin::decode_custom_lpc(FlacSubframeHeader& subframe, InputBitStream& bit_input, Span<i32> decoded)
 {
-    Vector<i32> decoded;
-    decoded.ensure_capacity(m_current_frame->sample_count);
+    if (subframe.order > decoded.size())
+        return LoaderError { LoaderError::Category::Format, static_cast<size_t>(m_current_sample_or_frame), "Predictor order is larger than the frame" };
 
     VERIFY(subframe.bits_per_sample - subframe.wasted_bits_per_sample != 0);
     // warm-up samples
     for (auto i = 0; i < subframe.order; ++i) {
-        decoded.unchecked_append(sign_extend(
+        decoded[i] = sign_extend(
             static_cast<u32>(bit_input.read_bits_big_endian(subframe.bits_per_sample - subframe.wasted_bits_per_sample)),
-            subframe.bits_per_sample - subframe.wasted_bits_per_sample));
+            subframe.bits_per_sample - subframe.wasted_bits_per_sample);
     }
 
     // precision of the coefficients
@@ -609,150 +628,137 @@ ErrorOr<Vector<i32>, LoaderError> FlacLoaderPlugin::decode_custom_lpc(FlacSubfra
 
     // shift needed on the data (signed!)
     i8 lpc_shift = sign_extend(static_cast<u32>(bit_input.read_bits_big_endian(5)), 5);
+    if (lpc_shift < 0)
+        return LoaderError { LoaderError::Category::Format, static_cast<size_t>(m_current_sample_or_frame), "Negative linear predictor shift" };
 
-    Vector<i32> coefficients;
-    coefficients.ensure_capacity(subframe.order);
+    Array<i32, 32> coefficients;
     // read coefficients
     for (auto i = 0; i < subframe.order; ++i) {
         u32 raw_coefficient = static_cast<u32>(bit_input.read_bits_big_endian(lpc_precision));
-        i32 coefficient = static_cast<i32>(sign_extend(raw_coefficient, lpc_precision));
-        coefficients.unchecked_append(coefficient);
+        coefficients[i] = static_cast<i32>(sign_extend(raw_coefficient, lpc_precision));
     }
 
-    dbgln_if(AFLACLOADER_DEBUG, "{}-bit {} shift coefficients: {}", lpc_precision, lpc_shift, coefficients);
+    dbgln_if(AFLACLOADER_DEBUG, "{} {}-bit {} shift coefficients", subframe.order, lpc_precision, lpc_shift);
 
-    TRY(decode_residual(decoded, subframe, bit_input));
+    TRY(decode_residual(subframe, bit_input, decoded));
 
     // approximate the waveform with the predictor
-    for (size_t i = subframe.order; i < m_current_frame->sample_count; ++i) {
-        // (see below)
-        i64 sample = 0;
-        for (size_t t = 0; t < subframe.order; ++t) {
-            // It's really important that we compute in 64-bit land here.
-            // Even though FLAC operates at a maximum bit depth of 32 bits, modern encoders use super-large coefficients for maximum compression.
-            // These will easily overflow 32 bits and cause strange white noise that abruptly stops intermittently (at the end of a frame).
-            // The simple fix of course is to do intermediate computations in 64 bits.
-            sample += static_cast<i64>(coefficients[t]) * static_cast<i64>(decoded[i - t - 1]);
-        }
-        decoded[i] += sample >> lpc_shift;
-    }
+    // It's really important that we compute in 64-bit land here, unless we know that the sum fits into 32 bits.
+    // Even though FLAC operates at a maximum bit depth of 32 bits, modern encoders use super-large coefficients for maximum compression.
+    // These will easily overflow 32 bits and cause strange white noise that abruptly stops intermittently (at the end of a frame).
+    // NOTE: AK::log2() is the number of bits needed for the order, which is one more than needed for the sum.
+    if (subframe.bits_per_sample - subframe.wasted_bits_per_sample + lpc_precision + AK::log2(subframe.order) <= 32)
+        restore_lpc_signal<u32>(decoded, coefficients.span().trim(subframe.order), lpc_shift);
+    else
+        restore_lpc_signal<u64>(decoded, coefficients.span().trim(subframe.order), lpc_shift);
 
-    return decoded;
+    return {};
 }
 
 // Decode a subframe encoded with one of the fixed linear predictor codings
-ErrorOr<Vector<i32>, LoaderError> FlacLoaderPlugin::decode_fixed_lpc(FlacSubframeHeader& subframe, InputBitStream& bit_input)
+MaybeLoaderError FlacLoaderPlugin::decode_fixed_lpc(FlacSubframeHeader& subframe, InputBitStream& bit_input, Span<i32> decoded)
 {
-    Vector<i32> decoded;
-    decoded.ensure_capacity(m_current_frame->sample_count);
+    if (subframe.order > decoded.size())
+        return LoaderError { LoaderError::Category::Format, static_cast<size_t>(m_current_sample_or_frame), "Predictor order is larger than the frame" };
 
     VERIFY(subframe.bits_per_sample - subframe.wasted_bits_per_sample != 0);
     // warm-up samples
     for (auto i = 0; i < subframe.order; ++i) {
-        decoded.unchecked_append(sign_extend(
+        decoded[i] = sign_extend(
             static_cast<u32>(bit_input.read_bits_big_endian(subframe.bits_per_sample - subframe.wasted_bits_per_sample)),
-            subframe.bits_per_sample - subframe.wasted_bits_per_sample));
+            subframe.bits_per_sample - subframe.wasted_bits_per_sample);
     }
 
-    TRY(decode_residual(decoded, subframe, bit_input));
+    TRY(decode_residual(subframe, bit_input, decoded));
 
     dbgln_if(AFLACLOADER_DEBUG, "decoded length {}, {} order predictor", decoded.size(), subframe.order);
 
+    auto* samples = decoded.data();
     switch (subframe.order) {
     case 0:
         // s_0(t) = 0
-        for (u32 i = subframe.order; i < m_current_frame->sample_count; ++i)
-            decoded[i] += 0;
         break;
     case 1:
         // s_1(t) = s(t-1)
         for (u32 i = subframe.order; i < m_current_frame->sample_count; ++i)
-            decoded[i] += decoded[i - 1];
+            samples[i] += samples[i - 1];
         break;
     case 2:
         // s_2(t) = 2s(t-1) - s(t-2)
         for (u32 i = subframe.order; i < m_current_frame->sample_count; ++i)
-            decoded[i] += 2 * decoded[i - 1] - decoded[i - 2];
+            samples[i] += 2 * samples[i - 1] - samples[i - 2];
         break;
     case 3:
         // s_3(t) = 3s(t-1) - 3s(t-2) + s(t-3)
         for (u32 i = subframe.order; i < m_current_frame->sample_count; ++i)
-            decoded[i] += 3 * decoded[i - 1] - 3 * decoded[i - 2] + decoded[i - 3];
+            samples[i] += 3 * samples[i - 1] - 3 * samples[i - 2] + samples[i - 3];
         break;
     case 4:
         // s_4(t) = 4s(t-1) - 6s(t-2) + 4s(t-3) - s(t-4)
         for (u32 i = subframe.order; i < m_current_frame->sample_count; ++i)
-            decoded[i] += 4 * decoded[i - 1] - 6 * decoded[i - 2] + 4 * decoded[i - 3] - decoded[i - 4];
+            samples[i] += 4 * samples[i - 1] - 6 * samples[i - 2] + 4 * samples[i - 3] - samples[i - 4];
         break;
     default:
         return LoaderError { LoaderError::Category::Format, static_cast<size_t>(m_current_sample_or_frame), String::formatted("Unrecognized predictor order {}", subframe.order) };
     }
-    return decoded;
+    return {};
 }
 
 // Decode the residual, the "error" between the function approximation and the actual audio data
-MaybeLoaderError FlacLoaderPlugin::decode_residual(Vector<i32>& decoded, FlacSubframeHeader& subframe, InputBitStream& bit_input)
+MaybeLoaderError FlacLoaderPlugin::decode_residual(FlacSubframeHeader& subframe, InputBitStream& bit_input, Span<i32> decoded)
 {
     u8 residual_mode = static_cast<u8>(bit_input.read_bits_big_endian(2));
     u8 partition_order = static_cast<u8>(bit_input.read_bits_big_endian(4));
     size_t partitions = 1 << partition_order;
 
-    if (residual_mode == FlacResidualMode::Rice4Bit) {
-        // decode a single Rice partition with four bits for the order k
-        for (size_t i = 0; i < partitions; ++i) {
-            auto rice_partition = decode_rice_partition(4, partitions, i, subframe, bit_input);
-            decoded.extend(move(rice_partition));
-        }
-    } else if (residual_mode == FlacResidualMode::Rice5Bit) {
+    // The first partition is short by the warm-up samples.
+    size_t partition_sample_count = decoded.size() / partitions;
+    if (partition_sample_count * partitions != decoded.size() || partition_sample_count < subframe.order)
+        return LoaderError { LoaderError::Category::Format, static_cast<size_t>(m_current_sample_or_frame), "Invalid residual partition order" };
+
+    u8 partition_type;
+    if (residual_mode == FlacResidualMode::Rice4Bit)
+        // decode Rice partitions with four bits for the order k
+        partition_type = 4;
+    else if (residual_mode == FlacResidualMode::Rice5Bit)
         // five bits equivalent
-        for (size_t i = 0; i < partitions; ++i) {
-            auto rice_partition = decode_rice_partition(5, partitions, i, subframe, bit_input);
-            decoded.extend(move(rice_partition));
-        }
-    } else
+        partition_type = 5;
+    else
         return LoaderError { LoaderError::Category::Format, static_cast<size_t>(m_current_sample_or_frame), "Reserved residual coding method" };
 
+    decode_rice_partition(partition_type, bit_input, decoded.slice(subframe.order, partition_sample_count - subframe.order));
+    for (size_t i = 1; i < partitions; ++i)
+        decode_rice_partition(partition_type, bit_input, decoded.slice(i * partition_sample_count, partition_sample_count));
+
     return {};
 }
 
 // Decode a single Rice partition as part of the residual, every partition can have its own Rice parameter k
-ALWAYS_INLINE Vector<i32> FlacLoaderPlugin::decode_rice_partition(u8 partition_type, u32 partitions, u32 partition_index, FlacSubframeHeader& subframe, InputBitStream& bit_input)
+ALWAYS_INLINE void FlacLoaderPlugin::decode_rice_partition(u8 partition_type, InputBitStream& bit_input, Span<i32> residuals)
 {
     // Rice parameter / Exp-Golomb order
     u8 k = static_cast<u8>(bit_input.read_bits_big_endian(partition_type));
 
-    u32 residual_sample_count;
-    if (partitions == 0)
-        residual_sample_count = m_current_frame->sample_count - subframe.order;
-    else
-        residual_sample_count = m_current_frame->sample_count / partitions;
-    if (partition_index == 0)
-        residual_sample_count -= subframe.order;
-
-    Vector<i32> rice_partition;
-    rice_partition.resize(residual_sample_count);
-
     // escape code for unencoded binary partition
     if (k == (1 << partition_type) - 1) {
         u8 unencoded_bps = static_cast<u8>(bit_input.read_bits_big_endian(5));
-        for (size_t r = 0; r < residual_sample_count; ++r) {
-            rice_partition[r] = static_cast<u8>(bit_input.read_bits_big_endian(unencoded_bps));
+        for (auto& residual : residuals) {
+            if (unencoded_bps == 0)
+                residual = 0;
+            else
+                residual = sign_extend(static_cast<u32>(bit_input.read_bits_big_endian(unencoded_bps)), unencoded_bps);
         }
     } else {
-        for (size_t r = 0; r < residual_sample_count; ++r) {
-            rice_partition[r] = decode_unsigned_exp_golomb(k, bit_input);
-        }
+        for (auto& residual : residuals)
+            residual = decode_unsigned_exp_golomb(k, bit_input);
     }
-
-    return rice_partition;
 }
 
 // Decode a single number encoded with Rice/Exponential-Golomb encoding (the unsigned variant)
 ALWAYS_INLINE i32 decode_unsigned_exp_golomb(u8 k, InputBitStream& bit_input)
 {
-    u8 q = 0;
-    while (bit_input.read_bit_big_endian() == 0)
-        ++q;
+    // most significant bits (quotient), in unary
+    u32 q = bit_input.read_unary_big_endian();
 
     // least significant bits (remainder)
     u32 rem = static_cast<u32>(bit_input.read_bits_big_endian(k));
@@ -9,6 +9,7 @@
 #include "Buffer.h"
 #include "FlacTypes.h"
 #include "Loader.h"
+#include <AK/Array.h>
 #include <AK/BitStream.h>
 #include <AK/Buffered.h>
 #include <AK/Error.h>
@@ -57,11 +58,11 @@ public:
             });
     }
 
-    InputBitStream bit_stream()
+    NonnullOwnPtr<InputBitStream> bit_stream()
     {
         return this->visit(
             [&](auto& stream) {
-                return InputBitStream(stream);
+                return make<InputBitStream>(stream);
             });
     }
 };
@@ -85,6 +86,8 @@ public:
     explicit FlacLoaderPlugin(const ByteBuffer& buffer);
     ~FlacLoaderPlugin()
     {
+        if (m_bit_stream)
+            m_bit_stream->handle_any_error();
         if (m_stream)
             m_stream->handle_any_error();
     }
@@ -115,15 +118,15 @@ private:
     MaybeLoaderError next_frame(Span<Sample>);
     // Helper of next_frame that fetches a sub frame's header
     ErrorOr<FlacSubframeHeader, LoaderError> next_subframe_header(InputBitStream& bit_input, u8 channel_index);
-    // Helper of next_frame that decompresses a subframe
-    ErrorOr<Vector<i32>, LoaderError> parse_subframe(FlacSubframeHeader& subframe_header, InputBitStream& bit_input);
-    // Subframe-internal data decoders (heavy lifting)
-    ErrorOr<Vector<i32>, LoaderError> decode_fixed_lpc(FlacSubframeHeader& subframe, InputBitStream& bit_input);
-    ErrorOr<Vector<i32>, LoaderError> decode_verbatim(FlacSubframeHeader& subframe, InputBitStream& bit_input);
-    ErrorOr<Vector<i32>, LoaderError> decode_custom_lpc(FlacSubframeHeader& subframe, InputBitStream& bit_input);
-    MaybeLoaderError decode_residual(Vector<i32>& decoded, FlacSubframeHeader& subframe, InputBitStream& bit_input);
+    // Helper of next_frame that decompresses a subframe into a buffer that is reused from frame to frame
+    MaybeLoaderError parse_subframe(FlacSubframeHeader& subframe_header, InputBitStream& bit_input, Vector<i32>& samples);
+    // Subframe-internal data decoders (heavy lifting), which decode exactly one sample per sample of the frame
+    MaybeLoaderError decode_fixed_lpc(FlacSubframeHeader& subframe, InputBitStream& bit_input, Span<i32> decoded);
+    MaybeLoaderError decode_verbatim(FlacSubframeHeader& subframe, InputBitStream& bit_input, Span<i32> decoded);
+    MaybeLoaderError decode_custom_lpc(FlacSubframeHeader& subframe, InputBitStream& bit_input, Span<i32> decoded);
+    MaybeLoaderError decode_residual(FlacSubframeHeader& subframe, InputBitStream& bit_input, Span<i32> decoded);
     // decode a single rice partition that has its own rice parameter
-    ALWAYS_INLINE Vector<i32> decode_rice_partition(u8 partition_type, u32 partitions, u32 partition_index, FlacSubframeHeader& subframe, InputBitStream& bit_input);
+    ALWAYS_INLINE void decode_rice_partition(u8 partition_type, InputBitStream& bit_input, Span<i32> residuals);
 
     // Converters for special coding used in frame headers
     ALWAYS_INLINE ErrorOr<u32, LoaderError> convert_sample_count_code(u8 sample_count_code);
@@ -150,7 +153,11 @@ private:
     // keep track of the start of the data in the FLAC stream to seek back more easily
     u64 m_data_start_location { 0 };
     OwnPtr<FlacInputStream<FLAC_BUFFER_SIZE>> m_stream;
+    // Frames are read through a single bit stream that reads ahead, which is replaced whenever we seek.
+    OwnPtr<InputBitStream> m_bit_stream;
     Optional<FlacFrameHeader> m_current_frame;
+    // The decoded samples of each channel of the current frame.
+    Array<Vector<i32>, 8> m_subframe_samples;
     // Whatever the last get_more_samples() call couldn't return gets stored here.
     Vector<Sample, FLAC_BUFFER_SIZE> m_unread_data;
     u64 m_current_sample_or_frame { 0 };
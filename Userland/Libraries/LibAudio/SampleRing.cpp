@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Atomic.h>
+#include <LibAudio/SampleRing.h>
+
+namespace Audio {
+
+// The positions only ever grow and wrap around at 2^32, so the capacity has to be a power of two.
+static bool is_valid_capacity(size_t capacity)
+{
+    return capacity > 0 && capacity <= SampleRing::max_capacity && (capacity & (capacity - 1)) == 0;
+}
+
+ErrorOr<SampleRing> SampleRing::create(size_t capacity)
+{
+    VERIFY(is_valid_capacity(capacity));
+    auto buffer = TRY(Core::AnonymousBuffer::create_with_size(sizeof(Header) + capacity * sizeof(Sample)));
+    return SampleRing { move(buffer) };
+}
+
+ErrorOr<SampleRing> SampleRing::create_with_anonymous_buffer(Core::AnonymousBuffer buffer)
+{
+    if (!buffer.is_valid() || buffer.size() <= sizeof(Header) || (buffer.size() - sizeof(Header)) % sizeof(Sample) != 0
+        || !is_valid_capacity((buffer.size() - sizeof(Header)) / sizeof(Sample)))
+        return Error::from_string_literal("SampleRing: Invalid size"sv);
+    return SampleRing { move(buffer) };
+}
+
+SampleRing::SampleRing(Core::AnonymousBuffer buffer)
+    : m_buffer(move(buffer))
+    , m_capacity((m_buffer.size() - sizeof(Header)) / sizeof(Sample))
+{
+}
+
+size_t SampleRing::free_space() const
+{
+    u32 write_position = header()->write_position;
+    u32 read_position = AK::atomic_load(&header()->read_position, AK::memory_order_acquire);
+    return m_capacity - min<size_t>(write_position - read_position, m_capacity);
+}
+
+size_t SampleRing::write(Span<Sample const> samples)
+{
+    auto count = min(samples.size(), free_space());
+    u32 write_position = header()->write_position;
+    size_t start = write_position & (m_capacity - 1);
+    size_t first_part = min(count, m_capacity - start);
+    memcpy(this->samples() + start, samples.data(), first_part * sizeof(Sample));
+    memcpy(this->samples(), samples.data() + first_part, (count - first_part) * sizeof(Sample));
+    // This has to be ordered before we look at a wakeup request, hence seq_cst.
+    AK::atomic_store(&header()->write_position, static_cast<u32>(write_position + count));
+    return count;
+}
+
+void SampleRing::request_wakeup(size_t free_space)
+{
+    AK::atomic_store(&header()->wakeup_threshold, static_cast<u32>(clamp<size_t>(free_space, 1, m_capacity)));
+}
+
+void SampleRing::cancel_wakeup_request()
+{
+    AK::atomic_store(&header()->wakeup_threshold, 0u);
+}
+
+size_t SampleRing::available() const
+{
+    u32 write_position = AK::atomic_load(&header()->write_position, AK::memory_order_acquire);
+    u32 read_position = header()->read_position;
+    return min<size_t>(write_position - read_position, m_capacity);
+}
+
+u32 SampleRing::write_position() const
+{
+    return AK::atomic_load(&header()->write_position, AK::memory_order_acquire);
+}
+
+size_t SampleRing::mix_into(Span<Sample> output, double factor)
+{
+    auto count = min(output.size(), available());
+    u32 read_position = header()->read_position;
+
+    // The samples up to the end of the ring and the ones after wrapping around are mixed in separate straight loops,
+    // which the compiler can vectorize.
+    if (factor != 0) {
+        size_t start = read_position & (m_capacity - 1);
+        size_t first_part = min(count, m_capacity - start);
+        auto const* source = samples() + start;
+        for (size_t i = 0; i < first_part; ++i) {
+            output[i].left += source[i].left * factor;
+            output[i].right += source[i].right * factor;
+        }
+        source = samples();
+        for (size_t i = first_part; i < count; ++i) {
+            output[i].left += source[i - first_part].left * factor;
+            output[i].right += source[i - first_part].right * factor;
+        }
+    }
+
+    // This has to be ordered before we look at a wakeup request, hence seq_cst.
+    AK::atomic_store(&header()->read_position, static_cast<u32>(read_position + count));
+    return count;
+}
+
+void SampleRing::discard_until(u32 write_position)
+{
+    u32 read_position = header()->read_position;
+    auto distance = static_cast<i32>(write_position - read_position);
+    if (distance <= 0)
+        return;
+    AK::atomic_store(&header()->read_position, static_cast<u32>(read_position + min(static_cast<size_t>(distance), available())));
+}
+
+bool SampleRing::take_wakeup_request()
+{
+    u32 threshold = AK::atomic_load(&header()->wakeup_threshold);
+    if (threshold == 0 || m_capacity - available() < min<size_t>(threshold, m_capacity))
+        return false;
+    return AK::atomic_exchange(&header()->wakeup_threshold, 0u) != 0;
+}
+
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Error.h>
+#include <AK/Span.h>
+#include <AK/Types.h>
+#include <LibAudio/Sample.h>
+#include <LibCore/AnonymousBuffer.h>
+
+namespace Audio {
+
+// A single-producer single-consumer queue of samples in memory shared between a client, which writes samples into it,
+// and AudioServer, which mixes them into its output. Once the ring has been handed to the server, playing samples takes
+// no IPC at all: the only message is a wakeup, which the server sends when the client is waiting for space and asked to
+// be woken up once enough of the ring has been played.
+//
+// The server can't trust anything that the client writes into the shared memory, so every position it reads from there is
+// clamped to the capacity, which is only ever derived from the size of the buffer.
+class SampleRing {
+public:
+    static constexpr size_t max_capacity = 1 * MiB;
+
+    // The capacity has to be a power of two.
+    static ErrorOr<SampleRing> create(size_t capacity);
+    static ErrorOr<SampleRing> create_with_anonymous_buffer(Core::AnonymousBuffer);
+
+    Core::AnonymousBuffer const& anonymous_buffer() const { return m_buffer; }
+    size_t capacity() const { return m_capacity; }
+
+    // Producer (client) side.
+    size_t free_space() const;
+    // Writes as many of the samples as there is space for, and returns how many were written.
+    size_t write(Span<Sample const>);
+    // Asks the consumer to wake us up once at least this many samples are free.
+    void request_wakeup(size_t free_space);
+    void cancel_wakeup_request();
+
+    // Consumer (server) side.
+    size_t available() const;
+    u32 write_position() const;
+    // Adds the next available samples (multiplied by the factor) to the output, and returns how many were mixed.
+    size_t mix_into(Span<Sample> output, double factor);
+    // Drops every sample that was written before the given write position.
+    void discard_until(u32 write_position);
+    // Returns true (once) if the producer asked to be woken up and there is now enough free space.
+    bool take_wakeup_request();
+
+private:
+    struct Header {
+        u32 write_position;
+        u32 read_position;
+        // The free space the producer is waiting for, or 0 if it isn't waiting.
+        u32 wakeup_threshold;
+        u32 padding;
+    };
+
+    explicit SampleRing(Core::AnonymousBuffer);
+
+    Header* header() { return m_buffer.data<Header>(); }
+    Header const* header() const { return m_buffer.data<Header>(); }
+    Sample* samples() { return reinterpret_cast<Sample*>(m_buffer.data<u8>() + sizeof(Header)); }
+
+    Core::AnonymousBuffer m_buffer;
+    size_t m_capacity { 0 };
+};
+
+}
@@ -6,6 +6,7 @@
 
 #include <AK/BuiltinWrappers.h>
 #include <AK/Debug.h>
+#include <AK/HashFunctions.h>
 #include <AK/ScopedValueRollback.h>
 #include <AK/Vector.h>
 #include <LibELF/AuxiliaryVector.h>
@@ -50,11 +51,21 @@ constexpr size_t number_of_hot_chunked_blocks_to_keep_around = 16;
 constexpr size_t number_of_cold_chunked_blocks_to_keep_around = 16;
 constexpr size_t number_of_big_blocks_to_keep_around_per_size_class = 8;
 
+// Each thread keeps a few freed chunks of the smaller size classes to itself, so that most
+// calls to malloc() and free() don't have to take s_malloc_mutex at all. Chunks are moved
+// between the thread cache and their blocks in batches, and a chunk freed by another thread
+// than the one that allocated it simply ends up in the freeing thread's cache.
+constexpr size_t largest_thread_cached_chunk_size = 1008;
+constexpr size_t number_of_thread_cached_chunks_per_size_class = 32;
+constexpr size_t number_of_chunks_to_move_per_thread_cache_batch = number_of_thread_cached_chunks_per_size_class / 2;
+
 static bool s_log_malloc = false;
 static bool s_scrub_malloc = true;
 static bool s_scrub_free = true;
 static bool s_profiling = false;
+static size_t s_profiling_sample_interval = 0;
 static bool s_in_userspace_emulator = false;
+static bool s_use_thread_cache = true;
 
 ALWAYS_INLINE static void ue_notify_malloc(const void* ptr, size_t size)
 {
@@ -96,6 +107,9 @@ struct MemoryAuditingSuppressor {
 struct MallocStats {
     size_t number_of_malloc_calls;
 
+    size_t number_of_thread_cache_hits;
+    size_t number_of_thread_cache_refills;
+
     size_t number_of_big_allocator_hits;
     size_t number_of_big_allocator_purge_hits;
     size_t number_of_big_allocs;
@@ -108,6 +122,9 @@ struct MallocStats {
 
     size_t number_of_free_calls;
 
+    size_t number_of_thread_cache_keeps;
+    size_t number_of_thread_cache_flushes;
+
     size_t number_of_big_allocator_keeps;
     size_t number_of_big_allocator_frees;
 
@@ -155,14 +172,22 @@ static inline BigAllocator (&big_allocators())[1]
 
 static Allocator* allocator_for_size(size_t size, size_t& good_size)
 {
-    for (size_t i = 0; size_classes[i]; ++i) {
-        if (size <= size_classes[i]) {
-            good_size = size_classes[i];
-            return &allocators()[i];
-        }
+    // size_classes is sorted, so look for the smallest size class that fits.
+    size_t low = 0;
+    size_t high = num_size_classes;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (size_classes[middle] < size)
+            low = middle + 1;
+        else
+            high = middle;
     }
-    good_size = PAGE_ROUND_UP(size);
-    return nullptr;
+    if (low == num_size_classes) {
+        good_size = PAGE_ROUND_UP(size);
+        return nullptr;
+    }
+    good_size = size_classes[low];
+    return &allocators()[low];
 }
 
 #ifdef RECYCLE_BIG_ALLOCATIONS
@@ -204,64 +229,11 @@ enum class CallerWillInitializeMemory {
 __thread bool s_allocation_enabled;
 #endif
 
-static void* malloc_impl(size_t size, CallerWillInitializeMemory caller_will_initialize_memory)
+// Takes a chunk from one of the allocator's blocks. Must be called with s_malloc_mutex held.
+static void* allocate_chunk(Allocator& allocator, size_t good_size)
 {
-#ifndef NO_TLS
-    VERIFY(s_allocation_enabled);
-#endif
-
-    if (s_log_malloc)
-        dbgln("LibC: malloc({})", size);
-
-    if (!size) {
-        // Legally we could just return a null pointer here, but this is more
-        // compatible with existing software.
-        size = 1;
-    }
-
-    g_malloc_stats.number_of_malloc_calls++;
-
-    size_t good_size;
-    auto* allocator = allocator_for_size(size, good_size);
-
-    PthreadMutexLocker locker(s_malloc_mutex);
-
-    if (!allocator) {
-        size_t real_size = round_up_to_power_of_two(sizeof(BigAllocationBlock) + size, ChunkedBlock::block_size);
-#ifdef RECYCLE_BIG_ALLOCATIONS
-        if (auto* allocator = big_allocator_for_size(real_size)) {
-            if (!allocator->blocks.is_empty()) {
-                g_malloc_stats.number_of_big_allocator_hits++;
-                auto* block = allocator->blocks.take_last();
-                int rc = madvise(block, real_size, MADV_SET_NONVOLATILE);
-                bool this_block_was_purged = rc == 1;
-                if (rc < 0) {
-                    perror("madvise");
-                    VERIFY_NOT_REACHED();
-                }
-                if (mprotect(block, real_size, PROT_READ | PROT_WRITE) < 0) {
-                    perror("mprotect");
-                    VERIFY_NOT_REACHED();
-                }
-                if (this_block_was_purged) {
-                    g_malloc_stats.number_of_big_allocator_purge_hits++;
-                    new (block) BigAllocationBlock(real_size);
-                }
-
-                ue_notify_malloc(&block->m_slot[0], size);
-                return &block->m_slot[0];
-            }
-        }
-#endif
-        g_malloc_stats.number_of_big_allocs++;
-        auto* block = (BigAllocationBlock*)os_alloc(real_size, "malloc: BigAllocationBlock");
-        new (block) BigAllocationBlock(real_size);
-        ue_notify_malloc(&block->m_slot[0], size);
-        return &block->m_slot[0];
-    }
-
     ChunkedBlock* block = nullptr;
-    for (auto& current : allocator->usable_blocks) {
+    for (auto& current : allocator.usable_blocks) {
         if (current.free_chunks()) {
             block = &current;
             break;
@@ -278,7 +250,7 @@ static void* malloc_impl(size_t size, CallerWillInitializeMemory caller_will_ini
             snprintf(buffer, sizeof(buffer), "malloc: ChunkedBlock(%zu)", good_size);
             set_mmap_name(block, ChunkedBlock::block_size, buffer);
         }
-        allocator->usable_blocks.append(*block);
+        allocator.usable_blocks.append(*block);
     }
 
     if (!block && s_cold_empty_block_count) {
@@ -301,7 +273,7 @@ static void* malloc_impl(size_t size, CallerWillInitializeMemory caller_will_ini
             new (block) ChunkedBlock(good_size);
             ue_notify_chunk_size_changed(block, good_size);
         }
-        allocator->usable_blocks.append(*block);
+        allocator.usable_blocks.append(*block);
     }
 
     if (!block) {
@@ -310,8 +282,8 @@ static void* malloc_impl(size_t size, CallerWillInitializeMemory caller_will_ini
         snprintf(buffer, sizeof(buffer), "malloc: ChunkedBlock(%zu)", good_size);
         block = (ChunkedBlock*)os_alloc(ChunkedBlock::block_size, buffer);
         new (block) ChunkedBlock(good_size);
-        allocator->usable_blocks.append(*block);
-        ++allocator->block_count;
+        allocator.usable_blocks.append(*block);
+        ++allocator.block_count;
     }
 
     --block->m_free_chunks;
@@ -326,16 +298,202 @@ static void* malloc_impl(size_t size, CallerWillInitializeMemory caller_will_ini
     if (block->is_full()) {
         g_malloc_stats.number_of_blocks_full++;
         dbgln_if(MALLOC_DEBUG, "Block {:p} is now full in size class {}", block, good_size);
+        allocator.usable_blocks.remove(*block);
+        allocator.full_blocks.append(*block);
+    }
+
+    return ptr;
+}
+
+// Returns a chunk to its block. Must be called with s_malloc_mutex held.
+static void free_chunk(ChunkedBlock* block, void* ptr)
+{
+    auto* entry = (FreelistEntry*)ptr;
+    entry->next = block->m_freelist;
+    block->m_freelist = entry;
+
+    if (block->is_full()) {
+        size_t good_size;
+        auto* allocator = allocator_for_size(block->m_size, good_size);
+        dbgln_if(MALLOC_DEBUG, "Block {:p} no longer full in size class {}", block, good_size);
+        g_malloc_stats.number_of_freed_full_blocks++;
+        allocator->full_blocks.remove(*block);
+        allocator->usable_blocks.prepend(*block);
+    }
+
+    ++block->m_free_chunks;
+
+    if (!block->used_chunks()) {
+        size_t good_size;
+        auto* allocator = allocator_for_size(block->m_size, good_size);
+        if (s_hot_empty_block_count < number_of_hot_chunked_blocks_to_keep_around) {
+            dbgln_if(MALLOC_DEBUG, "Keeping hot block {:p} around", block);
+            g_malloc_stats.number_of_hot_keeps++;
+            allocator->usable_blocks.remove(*block);
+            s_hot_empty_blocks[s_hot_empty_block_count++] = block;
+            return;
+        }
+        if (s_cold_empty_block_count < number_of_cold_chunked_blocks_to_keep_around) {
+            dbgln_if(MALLOC_DEBUG, "Keeping cold block {:p} around", block);
+            g_malloc_stats.number_of_cold_keeps++;
+            allocator->usable_blocks.remove(*block);
+            s_cold_empty_blocks[s_cold_empty_block_count++] = block;
+            mprotect(block, ChunkedBlock::block_size, PROT_NONE);
+            madvise(block, ChunkedBlock::block_size, MADV_SET_VOLATILE);
+            return;
+        }
+        dbgln_if(MALLOC_DEBUG, "Releasing block {:p} for size class {}", block, good_size);
+        g_malloc_stats.number_of_frees++;
         allocator->usable_blocks.remove(*block);
-        allocator->full_blocks.append(*block);
+        --allocator->block_count;
+        os_free(block, ChunkedBlock::block_size);
     }
-    dbgln_if(MALLOC_DEBUG, "LibC: allocated {:p} (chunk in block {:p}, size {})", ptr, block, block->bytes_per_chunk());
+}
 
-    if (s_scrub_malloc && caller_will_initialize_memory == CallerWillInitializeMemory::No)
-        memset(ptr, MALLOC_SCRUB_BYTE, block->m_size);
+#ifndef NO_TLS
+static consteval size_t number_of_thread_cached_size_classes()
+{
+    size_t count = 0;
+    while (size_classes[count] && size_classes[count] <= largest_thread_cached_chunk_size)
+        ++count;
+    return count;
+}
+
+struct ThreadCache {
+    struct Bin {
+        FreelistEntry* freelist;
+        size_t count;
+    };
+
+    Bin bins[number_of_thread_cached_size_classes()];
+};
+
+// NOTE: This is zero-initialized, as the thread cache starts out empty.
+__thread ThreadCache s_thread_cache;
+
+static size_t size_class_index(Allocator const& allocator)
+{
+    return &allocator - allocators();
+}
+
+static ThreadCache::Bin* thread_cache_bin_for(Allocator const& allocator)
+{
+    if (!s_use_thread_cache)
+        return nullptr;
+    auto index = size_class_index(allocator);
+    if (index >= number_of_thread_cached_size_classes())
+        return nullptr;
+    return &s_thread_cache.bins[index];
+}
+
+static void refill_thread_cache_bin(ThreadCache::Bin& bin, Allocator& allocator, size_t good_size)
+{
+    g_malloc_stats.number_of_thread_cache_refills++;
+    PthreadMutexLocker locker(s_malloc_mutex);
+    for (size_t i = 0; i < number_of_chunks_to_move_per_thread_cache_batch; ++i) {
+        auto* entry = (FreelistEntry*)allocate_chunk(allocator, good_size);
+        entry->next = bin.freelist;
+        bin.freelist = entry;
+        ++bin.count;
+    }
+}
+
+static void flush_thread_cache_bin(ThreadCache::Bin& bin, size_t count)
+{
+    g_malloc_stats.number_of_thread_cache_flushes++;
+    PthreadMutexLocker locker(s_malloc_mutex);
+    for (size_t i = 0; i < count && bin.freelist; ++i) {
+        auto* entry = bin.freelist;
+        bin.freelist = entry->next;
+        --bin.count;
+        auto* block = (ChunkedBlock*)((FlatPtr)entry & ChunkedBlock::block_mask);
+        free_chunk(block, entry);
+    }
+}
+#endif
+
+static void* malloc_impl(size_t size, CallerWillInitializeMemory caller_will_initialize_memory)
+{
+#ifndef NO_TLS
+    VERIFY(s_allocation_enabled);
+#endif
+
+    if (s_log_malloc)
+        dbgln("LibC: malloc({})", size);
+
+    if (!size) {
+        // Legally we could just return a null pointer here, but this is more
+        // compatible with existing software.
+        size = 1;
+    }
+
+    g_malloc_stats.number_of_malloc_calls++;
+
+    size_t good_size;
+    auto* allocator = allocator_for_size(size, good_size);
+
+    void* ptr = nullptr;
+    if (allocator) {
+#ifndef NO_TLS
+        if (auto* bin = thread_cache_bin_for(*allocator)) {
+            if (bin->freelist)
+                g_malloc_stats.number_of_thread_cache_hits++;
+            else
+                refill_thread_cache_bin(*bin, *allocator, good_size);
+            ptr = bin->freelist;
+            bin->freelist = bin->freelist->next;
+            --bin->count;
+        }
+#endif
+        if (!ptr) {
+            PthreadMutexLocker locker(s_malloc_mutex);
+            ptr = allocate_chunk(*allocator, good_size);
+        }
+        dbgln_if(MALLOC_DEBUG, "LibC: allocated {:p} (chunk in block {:p}, size {})", ptr, (void*)((FlatPtr)ptr & ChunkedBlock::block_mask), good_size);
+
+        if (s_scrub_malloc && caller_will_initialize_memory == CallerWillInitializeMemory::No)
+            memset(ptr, MALLOC_SCRUB_BYTE, good_size);
+
+        ue_notify_malloc(ptr, size);
+        return ptr;
+    }
+
+    PthreadMutexLocker locker(s_malloc_mutex);
+
+    {
+        size_t real_size = round_up_to_power_of_two(sizeof(BigAllocationBlock) + size, ChunkedBlock::block_size);
+#ifdef RECYCLE_BIG_ALLOCATIONS
+        if (auto* allocator = big_allocator_for_size(real_size)) {
+            if (!allocator->blocks.is_empty()) {
+                g_malloc_stats.number_of_big_allocator_hits++;
+                auto* block = allocator->blocks.take_last();
+                int rc = madvise(block, real_size, MADV_SET_NONVOLATILE);
+                bool this_block_was_purged = rc == 1;
+                if (rc < 0) {
+                    perror("madvise");
+                    VERIFY_NOT_REACHED();
+                }
+                if (mprotect(block, real_size, PROT_READ | PROT_WRITE) < 0) {
+                    perror("mprotect");
+                    VERIFY_NOT_REACHED();
+                }
+                if (this_block_was_purged) {
+                    g_malloc_stats.number_of_big_allocator_purge_hits++;
+                    new (block) BigAllocationBlock(real_size);
+                }
+
+                ue_notify_malloc(&block->m_slot[0], size);
+                return &block->m_slot[0];
+            }
+        }
+#endif
+        g_malloc_stats.number_of_big_allocs++;
+        auto* block = (BigAllocationBlock*)os_alloc(real_size, "malloc: BigAllocationBlock");
+        new (block) BigAllocationBlock(real_size);
+        ue_notify_malloc(&block->m_slot[0], size);
+        return &block->m_slot[0];
+    }
 
-    ue_notify_malloc(ptr, size);
-    return ptr;
 }
 
 static void free_impl(void* ptr)
@@ -354,9 +512,8 @@ static void free_impl(void* ptr)
     void* block_base = (void*)((FlatPtr)ptr & ChunkedBlock::ChunkedBlock::block_mask);
     size_t magic = *(size_t*)block_base;
 
-    PthreadMutexLocker locker(s_malloc_mutex);
-
     if (magic == MAGIC_BIGALLOC_HEADER) {
+        PthreadMutexLocker locker(s_malloc_mutex);
         auto* block = (BigAllocationBlock*)block_base;
 #ifdef RECYCLE_BIG_ALLOCATIONS
         if (auto* allocator = big_allocator_for_size(block->m_size)) {
@@ -389,54 +546,164 @@ static void free_impl(void* ptr)
     if (s_scrub_free)
         memset(ptr, FREE_SCRUB_BYTE, block->bytes_per_chunk());
 
-    auto* entry = (FreelistEntry*)ptr;
-    entry->next = block->m_freelist;
-    block->m_freelist = entry;
+#ifndef NO_TLS
+    size_t good_size;
+    if (auto* bin = thread_cache_bin_for(*allocator_for_size(block->m_size, good_size))) {
+        if (bin->count == number_of_thread_cached_chunks_per_size_class)
+            flush_thread_cache_bin(*bin, number_of_chunks_to_move_per_thread_cache_batch);
+        else
+            g_malloc_stats.number_of_thread_cache_keeps++;
+        auto* entry = (FreelistEntry*)ptr;
+        entry->next = bin->freelist;
+        bin->freelist = entry;
+        ++bin->count;
+        return;
+    }
+#endif
 
-    if (block->is_full()) {
-        size_t good_size;
-        auto* allocator = allocator_for_size(block->m_size, good_size);
-        dbgln_if(MALLOC_DEBUG, "Block {:p} no longer full in size class {}", block, good_size);
-        g_malloc_stats.number_of_freed_full_blocks++;
-        allocator->full_blocks.remove(*block);
-        allocator->usable_blocks.prepend(*block);
+    PthreadMutexLocker locker(s_malloc_mutex);
+    free_chunk(block, ptr);
+}
+
+// With LIBC_PROFILE_MALLOC_SAMPLE_INTERVAL, only about one allocation in every so many bytes is recorded, along with
+// its stack. A sampled PERF_EVENT_MALLOC carries the number of bytes it stands for rather than the size that was
+// requested, so the samples still add up to where the memory was allocated. Only frees of sampled allocations are
+// recorded, which means the sampled allocations have to be remembered in a table that doesn't use the heap itself.
+constexpr size_t sampled_allocations_table_size = 16384;
+constexpr size_t max_sampled_allocations = sampled_allocations_table_size / 4 * 3;
+static pthread_mutex_t s_sampled_allocations_mutex = PTHREAD_MUTEX_INITIALIZER;
+static FlatPtr* s_sampled_allocations;
+static size_t s_sampled_allocation_count;
+
+#ifndef NO_TLS
+__thread size_t s_bytes_until_next_sample;
+__thread u32 s_sample_random_state;
+#endif
+
+static size_t sampled_allocation_slot(FlatPtr ptr)
+{
+    return ptr_hash(ptr) & (sampled_allocations_table_size - 1);
+}
+
+// Must be called with s_sampled_allocations_mutex held.
+static bool add_sampled_allocation(FlatPtr ptr)
+{
+    if (s_sampled_allocation_count >= max_sampled_allocations)
+        return false;
+    size_t slot = sampled_allocation_slot(ptr);
+    while (s_sampled_allocations[slot])
+        slot = (slot + 1) & (sampled_allocations_table_size - 1);
+    s_sampled_allocations[slot] = ptr;
+    ++s_sampled_allocation_count;
+    return true;
+}
+
+// Must be called with s_sampled_allocations_mutex held.
+static bool remove_sampled_allocation(FlatPtr ptr)
+{
+    constexpr size_t mask = sampled_allocations_table_size - 1;
+    size_t slot = sampled_allocation_slot(ptr);
+    while (s_sampled_allocations[slot] != ptr) {
+        if (!s_sampled_allocations[slot])
+            return false;
+        slot = (slot + 1) & mask;
     }
 
-    ++block->m_free_chunks;
+    // Move the entries that follow back into the hole, so that lookups don't stop at it.
+    size_t hole = slot;
+    for (size_t i = (slot + 1) & mask; s_sampled_allocations[i]; i = (i + 1) & mask) {
+        size_t home = sampled_allocation_slot(s_sampled_allocations[i]);
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            s_sampled_allocations[hole] = s_sampled_allocations[i];
+            hole = i;
+        }
+    }
+    s_sampled_allocations[hole] = 0;
+    --s_sampled_allocation_count;
+    return true;
+}
 
-    if (!block->used_chunks()) {
-        size_t good_size;
-        auto* allocator = allocator_for_size(block->m_size, good_size);
-        if (s_hot_empty_block_count < number_of_hot_chunked_blocks_to_keep_around) {
-            dbgln_if(MALLOC_DEBUG, "Keeping hot block {:p} around", block);
-            g_malloc_stats.number_of_hot_keeps++;
-            allocator->usable_blocks.remove(*block);
-            s_hot_empty_blocks[s_hot_empty_block_count++] = block;
+#ifndef NO_TLS
+// The distance between samples is randomized, so that allocation patterns that repeat every so many bytes don't
+// always end up sampled at the same allocation. NOTE: This can't use arc4random(), which may allocate.
+static size_t next_sample_distance()
+{
+    if (!s_sample_random_state)
+        s_sample_random_state = ptr_hash(reinterpret_cast<FlatPtr>(&s_sample_random_state)) | 1;
+    u32 x = s_sample_random_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    s_sample_random_state = x;
+    return 1 + x % (2 * s_profiling_sample_interval);
+}
+#endif
+
+// Returns the number of bytes this allocation stands for if it should be sampled, or 0 if it shouldn't.
+static size_t bytes_represented_by_sample(size_t size)
+{
+#ifndef NO_TLS
+    // A new thread starts out without a distance to its first sample.
+    if (!s_bytes_until_next_sample)
+        s_bytes_until_next_sample = next_sample_distance();
+    if (size < s_bytes_until_next_sample) {
+        s_bytes_until_next_sample -= size;
+        return 0;
+    }
+    // The bytes past the sample count towards the next one, or large allocations would be underrepresented.
+    size -= s_bytes_until_next_sample;
+    size_t sample_count = 1 + size / s_profiling_sample_interval;
+    size %= s_profiling_sample_interval;
+    size_t distance = next_sample_distance();
+    s_bytes_until_next_sample = distance > size ? distance - size : 1;
+    return sample_count * s_profiling_sample_interval;
+#else
+    (void)size;
+    return 0;
+#endif
+}
+
+static void profile_malloc(void* ptr, size_t size)
+{
+    if (!s_profiling)
+        return;
+    if (!s_profiling_sample_interval) {
+        perf_event(PERF_EVENT_MALLOC, size, reinterpret_cast<FlatPtr>(ptr));
+        return;
+    }
+
+    if (!ptr)
+        return;
+    size_t bytes = bytes_represented_by_sample(size);
+    if (!bytes)
+        return;
+    {
+        PthreadMutexLocker locker(s_sampled_allocations_mutex);
+        if (!add_sampled_allocation(reinterpret_cast<FlatPtr>(ptr)))
             return;
-        }
-        if (s_cold_empty_block_count < number_of_cold_chunked_blocks_to_keep_around) {
-            dbgln_if(MALLOC_DEBUG, "Keeping cold block {:p} around", block);
-            g_malloc_stats.number_of_cold_keeps++;
-            allocator->usable_blocks.remove(*block);
-            s_cold_empty_blocks[s_cold_empty_block_count++] = block;
-            mprotect(block, ChunkedBlock::block_size, PROT_NONE);
-            madvise(block, ChunkedBlock::block_size, MADV_SET_VOLATILE);
+    }
+    perf_event(PERF_EVENT_MALLOC, bytes, reinterpret_cast<FlatPtr>(ptr));
+}
+
+static void profile_free(void* ptr)
+{
+    if (!s_profiling)
+        return;
+    if (s_profiling_sample_interval) {
+        if (!ptr)
+            return;
+        PthreadMutexLocker locker(s_sampled_allocations_mutex);
+        if (!remove_sampled_allocation(reinterpret_cast<FlatPtr>(ptr)))
             return;
-        }
-        dbgln_if(MALLOC_DEBUG, "Releasing block {:p} for size class {}", block, good_size);
-        g_malloc_stats.number_of_frees++;
-        allocator->usable_blocks.remove(*block);
-        --allocator->block_count;
-        os_free(block, ChunkedBlock::block_size);
     }
+    perf_event(PERF_EVENT_FREE, reinterpret_cast<FlatPtr>(ptr), 0);
 }
 
 void* malloc(size_t size)
 {
     MemoryAuditingSuppressor suppressor;
     void* ptr = malloc_impl(size, CallerWillInitializeMemory::No);
-    if (s_profiling)
-        perf_event(PERF_EVENT_MALLOC, size, reinterpret_cast<FlatPtr>(ptr));
+    profile_malloc(ptr, size);
     return ptr;
 }
 
@@ -474,8 +741,7 @@ void* _aligned_malloc(size_t size, size_t alignment)
 void free(void* ptr)
 {
     MemoryAuditingSuppressor suppressor;
-    if (s_profiling)
-        perf_event(PERF_EVENT_FREE, reinterpret_cast<FlatPtr>(ptr), 0);
+    profile_free(ptr);
     ue_notify_free(ptr);
     free_impl(ptr);
 }
@@ -497,6 +763,7 @@ void* calloc(size_t count, size_t size)
     auto* ptr = malloc_impl(new_size, CallerWillInitializeMemory::Yes);
     if (ptr)
         memset(ptr, 0, new_size);
+    profile_malloc(ptr, new_size);
     return ptr;
 }
 
@@ -546,6 +813,17 @@ void* realloc(void* ptr, size_t size)
     return new_ptr;
 }
 
+void __malloc_thread_exit()
+{
+#ifndef NO_TLS
+    // Give the exiting thread's cached chunks back to their blocks, or nobody could ever use them again.
+    for (auto& bin : s_thread_cache.bins) {
+        if (bin.freelist)
+            flush_thread_cache_bin(bin, bin.count);
+    }
+#endif
+}
+
 void __malloc_init()
 {
 #ifndef NO_TLS
@@ -560,6 +838,8 @@ void __malloc_init()
         // keeps track of heap memory anyway.
         s_scrub_malloc = false;
         s_scrub_free = false;
+        // UE tracks every chunk individually, so keep them going back to their blocks right away.
+        s_use_thread_cache = false;
     }
 
     if (secure_getenv("LIBC_NOSCRUB_MALLOC"))
@@ -570,6 +850,16 @@ void __malloc_init()
         s_log_malloc = true;
     if (secure_getenv("LIBC_PROFILE_MALLOC"))
         s_profiling = true;
+#ifndef NO_TLS
+    if (auto* sample_interval = secure_getenv("LIBC_PROFILE_MALLOC_SAMPLE_INTERVAL")) {
+        s_profiling_sample_interval = strtoul(sample_interval, nullptr, 10);
+        if (s_profiling_sample_interval) {
+            s_sampled_allocations = static_cast<FlatPtr*>(mmap_with_name(nullptr, sampled_allocations_table_size * sizeof(FlatPtr), PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, 0, 0, "Sampled allocations"));
+            VERIFY(s_sampled_allocations != MAP_FAILED);
+            s_profiling = true;
+        }
+    }
+#endif
 
     for (size_t i = 0; i < num_size_classes; ++i) {
         new (&allocators()[i]) Allocator();
@@ -583,6 +873,9 @@ void serenity_dump_malloc_stats()
 {
     dbgln("# malloc() calls: {}", g_malloc_stats.number_of_malloc_calls);
     dbgln();
+    dbgln("thread cache hits: {}", g_malloc_stats.number_of_thread_cache_hits);
+    dbgln("thread cache refills: {}", g_malloc_stats.number_of_thread_cache_refills);
+    dbgln();
     dbgln("big alloc hits: {}", g_malloc_stats.number_of_big_allocator_hits);
     dbgln("big alloc hits that were purged: {}", g_malloc_stats.number_of_big_allocator_purge_hits);
     dbgln("big allocs: {}", g_malloc_stats.number_of_big_allocs);
@@ -595,6 +888,9 @@ void serenity_dump_malloc_stats()
     dbgln();
     dbgln("# free() calls: {}", g_malloc_stats.number_of_free_calls);
     dbgln();
+    dbgln("thread cache keeps: {}", g_malloc_stats.number_of_thread_cache_keeps);
+    dbgln("thread cache flushes: {}", g_malloc_stats.number_of_thread_cache_flushes);
+    dbgln();
     dbgln("big alloc keeps: {}", g_malloc_stats.number_of_big_allocator_keeps);
     dbgln("big alloc frees: {}", g_malloc_stats.number_of_big_allocator_frees);
     dbgln();
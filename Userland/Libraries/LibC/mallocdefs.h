@@ -16,7 +16,17 @@
 
 #define PAGE_ROUND_UP(x) ((((size_t)(x)) + PAGE_SIZE - 1) & (~(PAGE_SIZE - 1)))
 
-static constexpr unsigned short size_classes[] = { 16, 32, 64, 128, 256, 496, 1008, 2032, 4080, 8176, 16368, 32752, 0 };
+// Up to 128 bytes the classes are 16 bytes apart. After that there are four classes per power
+// of two up to 1 KiB, and two per power of two beyond that.
+static constexpr unsigned short size_classes[] = {
+    16, 32, 48, 64, 80, 96, 112, 128,
+    160, 192, 224, 256,
+    320, 384, 448, 496,
+    640, 768, 896, 1008,
+    1360, 2032, 2720, 4080,
+    5440, 8176, 10912, 16368,
+    32752, 0
+};
 static constexpr size_t num_size_classes = (sizeof(size_classes) / sizeof(unsigned short)) - 1;
 
 #ifndef NO_TLS
@@ -35,6 +45,16 @@ consteval bool check_size_classes_alignment()
 }
 static_assert(check_size_classes_alignment());
 
+consteval bool check_size_classes_are_sorted()
+{
+    for (size_t i = 1; i < num_size_classes; i++) {
+        if (size_classes[i - 1] >= size_classes[i])
+            return false;
+    }
+    return true;
+}
+static_assert(check_size_classes_are_sorted());
+
 struct CommonHeader {
     size_t m_magic;
     size_t m_size;
@@ -97,6 +97,9 @@ static constexpr u32 MUTEX_UNLOCKED = 0;
 static constexpr u32 MUTEX_LOCKED_NO_NEED_TO_WAKE = 1;
 static constexpr u32 MUTEX_LOCKED_NEED_TO_WAKE = 2;
 
+// How many times we check on a locked mutex before going to sleep on it.
+static constexpr size_t MUTEX_SPIN_COUNT = 100;
+
 int __pthread_mutex_init(pthread_mutex_t* mutex, const pthread_mutexattr_t* attributes)
 {
     mutex->lock = 0;
@@ -150,6 +153,22 @@ int __pthread_mutex_lock(pthread_mutex_t* mutex)
         }
     }
 
+    // Most critical sections are short, so spin for a little while before going to sleep.
+    // If someone is already sleeping on the mutex, it's likely to stay locked for a while,
+    // so don't bother in that case.
+    for (size_t i = 0; i < MUTEX_SPIN_COUNT && value == MUTEX_LOCKED_NO_NEED_TO_WAKE; ++i) {
+#if ARCH(I386) || ARCH(X86_64)
+        __builtin_ia32_pause();
+#endif
+        value = AK::atomic_load(&mutex->lock, AK::memory_order_relaxed);
+        if (value == MUTEX_UNLOCKED && AK::atomic_compare_exchange_strong(&mutex->lock, value, MUTEX_LOCKED_NO_NEED_TO_WAKE, AK::memory_order_acquire)) {
+            if (mutex->type == __PTHREAD_MUTEX_RECURSIVE)
+                AK::atomic_store(&mutex->owner, __pthread_self(), AK::memory_order_relaxed);
+            mutex->level = 0;
+            return 0;
+        }
+    }
+
     // Slow path: wait, record the fact that we're going to wait, and always
     // remember to wake the next thread up once we release the mutex.
     if (value != MUTEX_LOCKED_NEED_TO_WAKE)
@@ -6,7 +6,9 @@
 
 #include <AK/Assertions.h>
 #include <AK/QuickSort.h>
+#include <AK/Types.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/types.h>
 
 class SizedObject {
@@ -34,7 +36,17 @@ inline void swap(const SizedObject& a, const SizedObject& b)
     const size_t size = a.size();
     const auto a_data = reinterpret_cast<char*>(a.data());
     const auto b_data = reinterpret_cast<char*>(b.data());
-    for (auto i = 0u; i < size; ++i) {
+    // Most arrays hold pointers, integers or small structs of them, so swap whole words where possible.
+    size_t i = 0;
+    for (; i + sizeof(u64) <= size; i += sizeof(u64)) {
+        u64 a_word;
+        u64 b_word;
+        memcpy(&a_word, a_data + i, sizeof(u64));
+        memcpy(&b_word, b_data + i, sizeof(u64));
+        memcpy(a_data + i, &b_word, sizeof(u64));
+        memcpy(b_data + i, &a_word, sizeof(u64));
+    }
+    for (; i < size; ++i) {
         swap(a_data[i], b_data[i]);
     }
 }
@@ -842,22 +842,31 @@ void rewind(FILE* stream)
     clearerr(stream);
 }
 
-ALWAYS_INLINE void stdout_putch(char*&, char ch)
-{
-    putchar(ch);
-}
-
-static FILE* __current_stream = nullptr;
-ALWAYS_INLINE static void stream_putch(char*&, char ch)
-{
-    fputc(ch, __current_stream);
-}
-
 // https://pubs.opengroup.org/onlinepubs/9699919799/functions/vfprintf.html
 int vfprintf(FILE* stream, const char* fmt, va_list ap)
 {
-    __current_stream = stream;
-    return printf_internal(stream_putch, nullptr, fmt, ap);
+    VERIFY(stream);
+    ScopedFileLock lock(stream);
+
+    // The output is collected on the stack and written to the stream in chunks, instead of locking the stream and
+    // going through its buffer (or even making a syscall, if it's unbuffered) for every single character.
+    u8 chunk[256];
+    size_t chunk_size = 0;
+    bool failed = false;
+    auto write_chunk = [&] {
+        if (stream->write(chunk, chunk_size) < chunk_size)
+            failed = true;
+        chunk_size = 0;
+    };
+    auto putch = [&](char*&, char ch) {
+        chunk[chunk_size++] = ch;
+        if (chunk_size == sizeof(chunk))
+            write_chunk();
+    };
+
+    int ret = printf_internal(putch, nullptr, fmt, ap);
+    write_chunk();
+    return failed ? -1 : ret;
 }
 
 // https://pubs.opengroup.org/onlinepubs/9699919799/functions/fprintf.html
@@ -873,7 +882,7 @@ int fprintf(FILE* stream, const char* fmt, ...)
 // https://pubs.opengroup.org/onlinepubs/9699919799/functions/vprintf.html
 int vprintf(const char* fmt, va_list ap)
 {
-    return printf_internal(stdout_putch, nullptr, fmt, ap);
+    return vfprintf(stdout, fmt, ap);
 }
 
 // https://pubs.opengroup.org/onlinepubs/9699919799/functions/printf.html
@@ -934,25 +943,18 @@ int sprintf(char* buffer, const char* fmt, ...)
     return ret;
 }
 
-static size_t __vsnprintf_space_remaining;
-ALWAYS_INLINE void sized_buffer_putch(char*& bufptr, char ch)
-{
-    if (__vsnprintf_space_remaining) {
-        *bufptr++ = ch;
-        --__vsnprintf_space_remaining;
-    }
-}
-
 // https://pubs.opengroup.org/onlinepubs/9699919799/functions/vsnprintf.html
 int vsnprintf(char* buffer, size_t size, const char* fmt, va_list ap)
 {
-    if (size) {
-        __vsnprintf_space_remaining = size - 1;
-    } else {
-        __vsnprintf_space_remaining = 0;
-    }
+    size_t space_remaining = size ? size - 1 : 0;
+    auto sized_buffer_putch = [&](char*& bufptr, char ch) {
+        if (space_remaining) {
+            *bufptr++ = ch;
+            --space_remaining;
+        }
+    };
     int ret = printf_internal(sized_buffer_putch, buffer, fmt, ap);
-    if (__vsnprintf_space_remaining) {
+    if (space_remaining) {
         buffer[ret] = '\0';
     } else if (size > 0) {
         buffer[size - 1] = '\0';
@@ -4,10 +4,12 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/BuiltinWrappers.h>
 #include <AK/Format.h>
 #include <AK/MemMem.h>
 #include <AK/Memory.h>
 #include <AK/Platform.h>
+#include <AK/SIMD.h>
 #include <AK/StdLibExtras.h>
 #include <AK/Types.h>
 #include <assert.h>
@@ -18,6 +20,65 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if ARCH(X86_64)
+// SSE2 is part of the x86_64 baseline, so these don't need to check which instructions the CPU supports. Anything wider
+// (AVX) can't be used here, since the kernel only saves and restores the SSE part of a thread's register state.
+using ByteVector = AK::SIMD::c8x16 __attribute__((may_alias));
+using UnalignedByteVector = AK::SIMD::c8x16 __attribute__((aligned(1), may_alias));
+using UnalignedU64 = u64 __attribute__((aligned(1), may_alias));
+using UnalignedU32 = u32 __attribute__((aligned(1), may_alias));
+
+static constexpr size_t vector_size = sizeof(ByteVector);
+// Up to this size, memcpy() and memset() use vector loops instead of rep movsb and rep stosb.
+static constexpr size_t medium_copy_limit = 256;
+
+static ALWAYS_INLINE ByteVector load_unaligned(void const* address)
+{
+    return *static_cast<UnalignedByteVector const*>(address);
+}
+
+static ALWAYS_INLINE void store_unaligned(void* address, ByteVector value)
+{
+    *static_cast<UnalignedByteVector*>(address) = value;
+}
+
+static ALWAYS_INLINE ByteVector splat(char value)
+{
+    return ByteVector {} + value;
+}
+
+// Returns a mask with the Nth bit set if the Nth bytes of both vectors are equal.
+static ALWAYS_INLINE u32 equal_bytes_mask(ByteVector a, ByteVector b)
+{
+    return __builtin_ia32_pmovmskb128(static_cast<ByteVector>(a == b));
+}
+
+// Aligned loads never cross a page boundary, so they can look at the bytes around (and past the end of) a string
+// without faulting.
+static ALWAYS_INLINE ByteVector const* vector_containing(void const* address)
+{
+    return reinterpret_cast<ByteVector const*>(reinterpret_cast<FlatPtr>(address) & ~(vector_size - 1));
+}
+
+// Returns the first byte that is either the given character or the null terminator.
+static char const* find_character_or_null_terminator(char const* str, char character)
+{
+    auto needle = splat(character);
+    auto const* chunk = vector_containing(str);
+    // The bits for the bytes before the start of the string are shifted out.
+    auto offset = str - reinterpret_cast<char const*>(chunk);
+    u32 mask = (equal_bytes_mask(*chunk, needle) | equal_bytes_mask(*chunk, ByteVector {})) >> offset;
+    if (mask)
+        return str + count_trailing_zeroes(mask);
+    while (true) {
+        ++chunk;
+        mask = equal_bytes_mask(*chunk, needle) | equal_bytes_mask(*chunk, ByteVector {});
+        if (mask)
+            return reinterpret_cast<char const*>(chunk) + count_trailing_zeroes(mask);
+    }
+}
+#endif
+
 extern "C" {
 
 // https://pubs.opengroup.org/onlinepubs/9699919799/functions/strspn.html
@@ -51,10 +112,24 @@ size_t strcspn(const char* s, const char* reject)
 // https://pubs.opengroup.org/onlinepubs/9699919799/functions/strlen.html
 size_t strlen(const char* str)
 {
+#if ARCH(X86_64)
+    auto const* chunk = vector_containing(str);
+    auto offset = str - reinterpret_cast<char const*>(chunk);
+    u32 mask = equal_bytes_mask(*chunk, ByteVector {}) >> offset;
+    if (mask)
+        return count_trailing_zeroes(mask);
+    while (true) {
+        ++chunk;
+        mask = equal_bytes_mask(*chunk, ByteVector {});
+        if (mask)
+            return reinterpret_cast<char const*>(chunk) + count_trailing_zeroes(mask) - str;
+    }
+#else
     size_t len = 0;
     while (*(str++))
         ++len;
     return len;
+#endif
 }
 
 // https://pubs.opengroup.org/onlinepubs/9699919799/functions/strnlen.html
@@ -114,6 +189,15 @@ int memcmp(const void* v1, const void* v2, size_t n)
 {
     auto* s1 = (const uint8_t*)v1;
     auto* s2 = (const uint8_t*)v2;
+#if ARCH(X86_64)
+    for (; n >= vector_size; s1 += vector_size, s2 += vector_size, n -= vector_size) {
+        u32 mask = equal_bytes_mask(load_unaligned(s1), load_unaligned(s2)) ^ 0xffff;
+        if (mask) {
+            auto index = count_trailing_zeroes(mask);
+            return s1[index] < s2[index] ? -1 : 1;
+        }
+    }
+#endif
     while (n-- > 0) {
         if (*s1++ != *s2++)
             return s1[-1] < s2[-1] ? -1 : 1;
@@ -124,6 +208,42 @@ int memcmp(const void* v1, const void* v2, size_t n)
 // https://pubs.opengroup.org/onlinepubs/9699919799/functions/memcpy.html
 void* memcpy(void* dest_ptr, const void* src_ptr, size_t n)
 {
+#if ARCH(X86_64)
+    // Small copies are done with (possibly overlapping) copies of the first and last bytes, and medium ones with a
+    // vector loop, since starting up rep movsb takes a while. For large copies, it's the fastest option there is.
+    // memmove() relies on this working for overlapping buffers when dest comes before src, which is why every chunk
+    // is loaded before it's stored, and the last one before anything is stored.
+    auto* dest = static_cast<u8*>(dest_ptr);
+    auto const* src = static_cast<u8 const*>(src_ptr);
+    if (n <= vector_size) {
+        if (n >= sizeof(u64)) {
+            u64 head = *reinterpret_cast<UnalignedU64 const*>(src);
+            u64 tail = *reinterpret_cast<UnalignedU64 const*>(src + n - sizeof(u64));
+            *reinterpret_cast<UnalignedU64*>(dest) = head;
+            *reinterpret_cast<UnalignedU64*>(dest + n - sizeof(u64)) = tail;
+        } else if (n >= sizeof(u32)) {
+            u32 head = *reinterpret_cast<UnalignedU32 const*>(src);
+            u32 tail = *reinterpret_cast<UnalignedU32 const*>(src + n - sizeof(u32));
+            *reinterpret_cast<UnalignedU32*>(dest) = head;
+            *reinterpret_cast<UnalignedU32*>(dest + n - sizeof(u32)) = tail;
+        } else if (n > 0) {
+            u8 first = src[0];
+            u8 middle = src[n / 2];
+            u8 last = src[n - 1];
+            dest[0] = first;
+            dest[n / 2] = middle;
+            dest[n - 1] = last;
+        }
+        return dest_ptr;
+    }
+    if (n <= medium_copy_limit) {
+        auto tail = load_unaligned(src + n - vector_size);
+        for (size_t i = 0; i < n - vector_size; i += vector_size)
+            store_unaligned(dest + i, load_unaligned(src + i));
+        store_unaligned(dest + n - vector_size, tail);
+        return dest_ptr;
+    }
+#endif
     void* original_dest = dest_ptr;
     asm volatile(
         "rep movsb"
@@ -134,6 +254,31 @@ void* memcpy(void* dest_ptr, const void* src_ptr, size_t n)
 // https://pubs.opengroup.org/onlinepubs/9699919799/functions/memset.html
 void* memset(void* dest_ptr, int c, size_t n)
 {
+#if ARCH(X86_64)
+    // Like memcpy(), small and medium sizes are filled with (possibly overlapping) plain and vector stores.
+    if (n <= medium_copy_limit) {
+        auto* dest = static_cast<u8*>(dest_ptr);
+        if (n >= vector_size) {
+            auto value = splat(static_cast<char>(c));
+            for (size_t i = 0; i < n - vector_size; i += vector_size)
+                store_unaligned(dest + i, value);
+            store_unaligned(dest + n - vector_size, value);
+        } else if (n >= sizeof(u64)) {
+            u64 value = explode_byte(static_cast<u8>(c));
+            *reinterpret_cast<UnalignedU64*>(dest) = value;
+            *reinterpret_cast<UnalignedU64*>(dest + n - sizeof(u64)) = value;
+        } else if (n >= sizeof(u32)) {
+            u32 value = explode_byte(static_cast<u8>(c));
+            *reinterpret_cast<UnalignedU32*>(dest) = value;
+            *reinterpret_cast<UnalignedU32*>(dest + n - sizeof(u32)) = value;
+        } else if (n > 0) {
+            dest[0] = c;
+            dest[n / 2] = c;
+            dest[n - 1] = c;
+        }
+        return dest_ptr;
+    }
+#endif
     size_t dest = (size_t)dest_ptr;
     // FIXME: Support starting at an unaligned address.
     if (!(dest & 0x3) && n >= 12) {
@@ -218,6 +363,10 @@ size_t strlcpy(char* dest, const char* src, size_t n)
 // https://pubs.opengroup.org/onlinepubs/9699919799/functions/strchr.html
 char* strchr(const char* str, int c)
 {
+#if ARCH(X86_64)
+    auto const* result = find_character_or_null_terminator(str, c);
+    return *result == static_cast<char>(c) ? const_cast<char*>(result) : nullptr;
+#else
     char ch = c;
     for (;; ++str) {
         if (*str == ch)
@@ -225,6 +374,7 @@ char* strchr(const char* str, int c)
         if (!*str)
             return nullptr;
     }
+#endif
 }
 
 // https://pubs.opengroup.org/onlinepubs/9699959399/functions/index.html
@@ -235,11 +385,15 @@ char* index(const char* str, int c)
 
 char* strchrnul(const char* str, int c)
 {
+#if ARCH(X86_64)
+    return const_cast<char*>(find_character_or_null_terminator(str, c));
+#else
     char ch = c;
     for (;; ++str) {
         if (*str == ch || !*str)
             return const_cast<char*>(str);
     }
+#endif
 }
 
 // https://pubs.opengroup.org/onlinepubs/9699919799/functions/memchr.html
@@ -247,11 +401,32 @@ void* memchr(const void* ptr, int c, size_t size)
 {
     char ch = c;
     auto* cptr = (const char*)ptr;
+#if ARCH(X86_64)
+    if (size == 0)
+        return nullptr;
+    auto needle = splat(ch);
+    auto const* chunk = vector_containing(cptr);
+    auto offset = cptr - reinterpret_cast<char const*>(chunk);
+    // The bits for the bytes before the start of the buffer are cleared.
+    u32 mask = equal_bytes_mask(*chunk, needle) & (0xffff << offset);
+    while (true) {
+        if (mask) {
+            // Matches past the end of the buffer don't count.
+            auto index = reinterpret_cast<char const*>(chunk) + count_trailing_zeroes(mask) - cptr;
+            return static_cast<size_t>(index) < size ? const_cast<char*>(cptr + index) : nullptr;
+        }
+        ++chunk;
+        if (static_cast<size_t>(reinterpret_cast<char const*>(chunk) - cptr) >= size)
+            return nullptr;
+        mask = equal_bytes_mask(*chunk, needle);
+    }
+#else
     for (size_t i = 0; i < size; ++i) {
         if (cptr[i] == ch)
             return const_cast<char*>(cptr + i);
     }
     return nullptr;
+#endif
 }
 
 // https://pubs.opengroup.org/onlinepubs/9699919799/functions/strrchr.html
@@ -0,0 +1,18 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <errno.h>
+#include <sys/io_batch.h>
+#include <syscall.h>
+
+extern "C" {
+
+int io_submit_batch(struct io_request* requests, size_t count)
+{
+    int rc = syscall(SC_io_submit_batch, requests, count);
+    __RETURN_WITH_ERRNO(rc, rc, -1);
+}
+}
@@ -0,0 +1,16 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <Kernel/API/POSIX/sys/io_batch.h>
+#include <sys/cdefs.h>
+
+__BEGIN_DECLS
+
+int io_submit_batch(struct io_request* requests, size_t count);
+
+__END_DECLS
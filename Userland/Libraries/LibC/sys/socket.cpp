@@ -69,6 +69,13 @@ ssize_t sendmsg(int sockfd, const struct msghdr* msg, int flags)
     __RETURN_WITH_ERRNO(rc, rc, -1);
 }
 
+// https://man7.org/linux/man-pages/man2/sendmmsg.2.html
+int sendmmsg(int sockfd, struct mmsghdr* msgvec, unsigned int vlen, int flags)
+{
+    int rc = syscall(SC_sendmmsg, sockfd, msgvec, vlen, flags);
+    __RETURN_WITH_ERRNO(rc, rc, -1);
+}
+
 // https://pubs.opengroup.org/onlinepubs/9699919799/functions/sendto.html
 ssize_t sendto(int sockfd, const void* data, size_t data_length, int flags, const struct sockaddr* addr, socklen_t addr_length)
 {
@@ -90,6 +97,19 @@ ssize_t recvmsg(int sockfd, struct msghdr* msg, int flags)
     __RETURN_WITH_ERRNO(rc, rc, -1);
 }
 
+// https://man7.org/linux/man-pages/man2/recvmmsg.2.html
+// NOTE: Only the first message is waited for, as if MSG_WAITFORONE was always set.
+int recvmmsg(int sockfd, struct mmsghdr* msgvec, unsigned int vlen, int flags, struct timespec* timeout)
+{
+    if (timeout) {
+        // FIXME: Implement the timeout (which is only checked after each message on Linux, too).
+        errno = ENOTSUP;
+        return -1;
+    }
+    int rc = syscall(SC_recvmmsg, sockfd, msgvec, vlen, flags);
+    __RETURN_WITH_ERRNO(rc, rc, -1);
+}
+
 // https://pubs.opengroup.org/onlinepubs/9699919799/functions/recvfrom.html
 ssize_t recvfrom(int sockfd, void* buffer, size_t buffer_length, int flags, struct sockaddr* addr, socklen_t* addr_length)
 {
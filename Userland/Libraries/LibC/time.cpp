@@ -4,14 +4,17 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Atomic.h>
 #include <AK/String.h>
 #include <AK/StringBuilder.h>
 #include <AK/Time.h>
 #include <Kernel/API/TimePage.h>
 #include <assert.h>
 #include <errno.h>
+#include <limits.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/time.h>
 #include <sys/times.h>
 #include <syscall.h>
@@ -370,22 +373,49 @@ clock_t clock()
 
 static Kernel::TimePage* get_kernel_time_page()
 {
-    static Kernel::TimePage* s_kernel_time_page;
-    // FIXME: Thread safety
-    if (!s_kernel_time_page) {
-        auto rc = syscall(SC_map_time_page);
-        if ((int)rc < 0 && (int)rc > -EMAXERRNO) {
-            errno = -(int)rc;
-            return nullptr;
-        }
-        s_kernel_time_page = (Kernel::TimePage*)rc;
+    static Atomic<Kernel::TimePage*> s_kernel_time_page;
+    if (auto* kernel_time_page = s_kernel_time_page.load(AK::memory_order_acquire))
+        return kernel_time_page;
+
+    auto rc = syscall(SC_map_time_page);
+    if ((int)rc < 0 && (int)rc > -EMAXERRNO) {
+        errno = -(int)rc;
+        return nullptr;
+    }
+    auto* kernel_time_page = (Kernel::TimePage*)rc;
+    Kernel::TimePage* expected = nullptr;
+    if (!s_kernel_time_page.compare_exchange_strong(expected, kernel_time_page, AK::memory_order_acq_rel)) {
+        // Another thread mapped the time page at the same time, so we use theirs.
+        munmap(kernel_time_page, PAGE_SIZE);
+        return expected;
     }
-    return s_kernel_time_page;
+    return kernel_time_page;
+}
+
+// Measures how long ago the clocks in the time page were updated. Returns false if we can't tell without asking the kernel.
+static bool ns_since_time_page_update(u64 tsc_at_update, u64 tsc_to_ns_multiplier, u32 max_ns_since_update, u32& ns)
+{
+#if ARCH(I386) || ARCH(X86_64)
+    if (tsc_to_ns_multiplier == 0)
+        return false;
+    // NOTE: The TSC of this processor may be a little behind the one that updated the time page, so this can't go below zero.
+    u64 elapsed_tsc = max(__builtin_ia32_rdtsc(), tsc_at_update) - tsc_at_update;
+    u64 max_elapsed_tsc = ((u64)max_ns_since_update << 32) / tsc_to_ns_multiplier;
+    ns = elapsed_tsc >= max_elapsed_tsc ? max_ns_since_update : (u32)((elapsed_tsc * tsc_to_ns_multiplier) >> 32);
+    return true;
+#else
+    (void)tsc_at_update;
+    (void)tsc_to_ns_multiplier;
+    (void)max_ns_since_update;
+    (void)ns;
+    return false;
+#endif
 }
 
 int clock_gettime(clockid_t clock_id, struct timespec* ts)
 {
-    if (Kernel::time_page_supports(clock_id)) {
+    bool needs_tsc = Kernel::time_page_supports_with_tsc(clock_id);
+    if (Kernel::time_page_supports(clock_id) || needs_tsc) {
         if (!ts) {
             errno = EFAULT;
             return -1;
@@ -393,11 +423,29 @@ int clock_gettime(clockid_t clock_id, struct timespec* ts)
 
         if (auto* kernel_time_page = get_kernel_time_page()) {
             u32 update_iteration;
+            u64 tsc_at_update;
+            u64 tsc_to_ns_multiplier;
+            u32 max_ns_since_update;
             do {
                 update_iteration = AK::atomic_load(&kernel_time_page->update1, AK::memory_order_acquire);
                 *ts = kernel_time_page->clocks[clock_id];
+                tsc_at_update = kernel_time_page->tsc_at_update;
+                tsc_to_ns_multiplier = kernel_time_page->tsc_to_ns_multiplier;
+                max_ns_since_update = kernel_time_page->max_ns_since_update;
             } while (update_iteration != AK::atomic_load(&kernel_time_page->update2, AK::memory_order_acquire));
-            return 0;
+
+            if (!needs_tsc)
+                return 0;
+
+            u32 ns;
+            if (ns_since_time_page_update(tsc_at_update, tsc_to_ns_multiplier, max_ns_since_update, ns)) {
+                ts->tv_nsec += ns;
+                if (ts->tv_nsec >= 1'000'000'000) {
+                    ts->tv_nsec -= 1'000'000'000;
+                    ++ts->tv_sec;
+                }
+                return 0;
+            }
         }
     }
 
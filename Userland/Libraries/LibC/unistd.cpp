@@ -19,6 +19,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/io_batch.h>
 #include <sys/ioctl.h>
 #include <sys/mman.h>
 #include <sys/select.h>
@@ -390,12 +391,14 @@ ssize_t write(int fd, const void* buf, size_t count)
 // https://pubs.opengroup.org/onlinepubs/9699919799/functions/pwrite.html
 ssize_t pwrite(int fd, const void* buf, size_t count, off_t offset)
 {
-    // FIXME: This is not thread safe and should be implemented in the kernel instead.
-    off_t old_offset = lseek(fd, 0, SEEK_CUR);
-    lseek(fd, offset, SEEK_SET);
-    ssize_t nwritten = write(fd, buf, count);
-    lseek(fd, old_offset, SEEK_SET);
-    return nwritten;
+    io_request request { IO_WRITE, fd, IO_POSITIONAL, offset, const_cast<void*>(buf), count, 0 };
+    if (io_submit_batch(&request, 1) < 0)
+        return -1;
+    if (request.result < 0) {
+        errno = static_cast<int>(-request.result);
+        return -1;
+    }
+    return request.result;
 }
 
 // https://pubs.opengroup.org/onlinepubs/9699919799/functions/ttyname_r.html
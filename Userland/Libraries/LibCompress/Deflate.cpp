@@ -63,6 +63,8 @@ Optional<CanonicalCode> CanonicalCode::from_bytes(ReadonlyBytes bytes)
         code.m_symbol_values.append(last_non_zero);
         code.m_bit_codes[last_non_zero] = 0;
         code.m_bit_code_lengths[last_non_zero] = 1;
+        for (size_t i = 0; i < code.m_fast_lookup.size(); i += 2)
+            code.m_fast_lookup[i] = (last_non_zero << 4) | 1;
         return code;
     }
 
@@ -83,6 +85,12 @@ Optional<CanonicalCode> CanonicalCode::from_bytes(ReadonlyBytes bytes)
             code.m_bit_codes[symbol] = fast_reverse16(start_bit | next_code, code_length); // DEFLATE writes huffman encoded symbols as lsb-first
             code.m_bit_code_lengths[symbol] = code_length;
 
+            // Every index that starts with this code (in stream order) decodes to this symbol
+            if (code_length <= fast_lookup_bits) {
+                for (size_t i = code.m_bit_codes[symbol]; i < code.m_fast_lookup.size(); i += 1 << code_length)
+                    code.m_fast_lookup[i] = (symbol << 4) | code_length;
+            }
+
             next_code++;
         }
     }
@@ -96,6 +104,12 @@ Optional<CanonicalCode> CanonicalCode::from_bytes(ReadonlyBytes bytes)
 
 u32 CanonicalCode::read_symbol(InputBitStream& stream) const
 {
+    auto const fast_lookup_entry = m_fast_lookup[stream.peek_bits(fast_lookup_bits)];
+    if (fast_lookup_entry != 0) {
+        stream.discard_previously_peeked_bits(fast_lookup_entry & 0xf);
+        return fast_lookup_entry >> 4;
+    }
+
     u32 code_bits = 1;
 
     for (;;) {
@@ -103,8 +117,6 @@ u32 CanonicalCode::read_symbol(InputBitStream& stream) const
         if (code_bits >= (1 << 16))
             return UINT32_MAX; // the maximum symbol in deflate is 288, so we use UINT32_MAX (an impossible value) to indicate an error
 
-        // FIXME: This is very inefficient and could greatly be improved by implementing this
-        //        algorithm: https://www.hanshq.net/zip.html#huffdec
         size_t index;
         if (binary_search(m_symbol_codes.span(), code_bits, &index))
             return m_symbol_values[index];
@@ -155,14 +167,9 @@ bool DeflateDecompressor::CompressedBlock::try_read_more()
         }
         const auto distance = m_decompressor.decode_distance(distance_symbol);
 
-        for (size_t idx = 0; idx < length; ++idx) {
-            u8 byte = 0;
-            m_decompressor.m_output_stream.read({ &byte, sizeof(byte) }, distance);
-            if (m_decompressor.m_output_stream.handle_any_error()) {
-                m_decompressor.set_fatal_error();
-                return false; // a back reference was requested that was too far back (outside our current sliding window)
-            }
-            m_decompressor.m_output_stream << byte;
+        if (!m_decompressor.m_output_stream.copy_from_seekback(distance, length)) {
+            m_decompressor.set_fatal_error();
+            return false; // a back reference was requested that was too far back (outside our current sliding window)
         }
 
         return true;
@@ -189,6 +196,12 @@ bool DeflateDecompressor::UncompressedBlock::try_read_more()
 }
 
 DeflateDecompressor::DeflateDecompressor(InputStream& stream)
+    : m_owned_input_stream(InputBitStream { stream })
+    , m_input_stream(m_owned_input_stream.value())
+{
+}
+
+DeflateDecompressor::DeflateDecompressor(InputBitStream& stream)
     : m_input_stream(stream)
 {
 }
@@ -373,6 +386,26 @@ Optional<ByteBuffer> DeflateDecompressor::decompress_all(ReadonlyBytes bytes)
     return output_stream.copy_into_contiguous_buffer();
 }
 
+Optional<size_t> DeflateDecompressor::decompress_into(ReadonlyBytes bytes, Bytes output)
+{
+    InputMemoryStream memory_stream { bytes };
+    DeflateDecompressor deflate_stream { memory_stream };
+
+    auto const nread = deflate_stream.read(output);
+
+    // If the output buffer was filled completely, make sure that there's no data left over that didn't fit
+    if (nread == output.size() && !deflate_stream.has_any_error() && !deflate_stream.unreliable_eof()) {
+        u8 byte = 0;
+        if (deflate_stream.read({ &byte, sizeof(byte) }) != 0)
+            return {};
+    }
+
+    if (deflate_stream.handle_any_error())
+        return {};
+
+    return nread;
+}
+
 u32 DeflateDecompressor::decode_length(u32 symbol)
 {
     // FIXME: I can't quite follow the algorithm here, but it seems to work.
@@ -590,7 +623,7 @@ size_t DeflateCompressor::find_back_match(size_t start, u16 hash, size_t previou
             break; // no remaining candidates
 
         VERIFY(candidate < start);
-        if (start - candidate > window_size)
+        if (start - candidate > max_back_reference_distance)
             break; // outside the window
 
         auto match_length = compare_match_candidate(start, candidate, previous_match_length, maximum_match_length);
@@ -700,6 +733,10 @@ void DeflateCompressor::lz77_compress_block()
         m_hash_head[hash] = window_pos;
     };
 
+    // make the end of the dictionary available for back references
+    for (auto position = block_size - m_history_size; position < block_size; position++)
+        insert_hash(position, hash_sequence(&m_rolling_window[position]));
+
     auto emit_literal = [&](auto literal) {
         VERIFY(m_pending_symbol_size <= block_size + 1);
         auto index = m_pending_symbol_size++;
@@ -1037,6 +1074,7 @@ void DeflateCompressor::flush()
         m_output_stream.align_to_byte_boundary();
 
     // reset all block specific members
+    m_history_size = 0; // only a dictionary is referred back to, later blocks are compressed on their own
     m_pending_block_size = 0;
     m_pending_symbol_size = 0;
     m_symbol_frequencies.fill(0);
@@ -1052,6 +1090,31 @@ void DeflateCompressor::final_flush()
     flush();
 }
 
+void DeflateCompressor::set_dictionary(ReadonlyBytes dictionary)
+{
+    VERIFY(!m_finished);
+    VERIFY(m_pending_block_size == 0);
+
+    auto history = dictionary.slice(dictionary.size() - min(dictionary.size(), block_size));
+    history.copy_to({ m_rolling_window + block_size - history.size(), history.size() });
+    m_history_size = history.size();
+}
+
+void DeflateCompressor::sync_flush()
+{
+    VERIFY(!m_finished);
+    if (m_pending_block_size != 0)
+        flush();
+    m_finished = true;
+
+    m_output_stream.write_bit(false);
+    m_output_stream.write_bits(0b00, 2); // no compression
+    m_output_stream.align_to_byte_boundary();
+    LittleEndian<u16> len = 0;
+    LittleEndian<u16> nlen = 0xffff;
+    m_output_stream << len << nlen;
+}
+
 Optional<ByteBuffer> DeflateCompressor::compress_all(ReadonlyBytes bytes, CompressionLevel compression_level)
 {
     DuplexMemoryStream output_stream;
@@ -28,6 +28,12 @@ public:
     static Optional<CanonicalCode> from_bytes(ReadonlyBytes);
 
 private:
+    static constexpr size_t fast_lookup_bits = 9;
+
+    // Decompression - indexed by the next fast_lookup_bits bits of the stream, holding (symbol << 4) | code length,
+    // or 0 for codes that are longer than fast_lookup_bits
+    Array<u16, 1 << fast_lookup_bits> m_fast_lookup {};
+
     // Decompression - indexed by code
     Vector<u16> m_symbol_codes;
     Vector<u16> m_symbol_values;
@@ -75,6 +81,8 @@ public:
     friend UncompressedBlock;
 
     DeflateDecompressor(InputStream&);
+    // NOTE: The input bit stream reads ahead, so anything following the deflate stream has to be read through it too.
+    DeflateDecompressor(InputBitStream&);
     ~DeflateDecompressor();
 
     size_t read(Bytes) override;
@@ -85,6 +93,8 @@ public:
     bool handle_any_error() override;
 
     static Optional<ByteBuffer> decompress_all(ReadonlyBytes);
+    // Returns the number of decompressed bytes, or nothing if an error occurred or the output buffer was too small.
+    static Optional<size_t> decompress_into(ReadonlyBytes, Bytes);
 
 private:
     u32 decode_length(u32);
@@ -99,7 +109,8 @@ private:
         UncompressedBlock m_uncompressed_block;
     };
 
-    InputBitStream m_input_stream;
+    Optional<InputBitStream> m_owned_input_stream;
+    InputBitStream& m_input_stream;
     CircularDuplexStream<32 * KiB> m_output_stream;
 };
 
@@ -118,6 +129,7 @@ public:
     static constexpr size_t max_huffman_distances = 32;
     static constexpr size_t min_match_length = 4;   // matches smaller than these are not worth the size of the back reference
     static constexpr size_t max_match_length = 258; // matches longer than these cannot be encoded using huffman codes
+    static constexpr size_t max_back_reference_distance = 32 * KiB;
     static constexpr u16 empty_slot = UINT16_MAX;
 
     struct CompressionConstants {
@@ -151,6 +163,13 @@ public:
     bool write_or_error(ReadonlyBytes) override;
     void final_flush();
 
+    // Lets the first block refer back to the end of the given data, as if it had been compressed right before.
+    // This has to be called before anything is written.
+    void set_dictionary(ReadonlyBytes);
+    // Ends the stream without a final block, padding it to a byte boundary with an empty uncompressed block instead,
+    // so that the blocks of another deflate stream can directly follow it.
+    void sync_flush();
+
     static Optional<ByteBuffer> compress_all(ReadonlyBytes bytes, CompressionLevel = CompressionLevel::GOOD);
 
 private:
@@ -188,6 +207,7 @@ private:
 
     u8 m_rolling_window[window_size];
     size_t m_pending_block_size { 0 };
+    size_t m_history_size { 0 }; // the number of bytes right before the pending block that can be referred back to
 
     struct [[gnu::packed]] {
         u16 distance; // back reference length
@@ -7,9 +7,11 @@
 
 #include <LibCompress/Gzip.h>
 
+#include <AK/Atomic.h>
 #include <AK/MemoryStream.h>
 #include <AK/String.h>
 #include <LibCore/DateTime.h>
+#include <LibThreading/Thread.h>
 
 namespace Compress {
 
@@ -70,6 +72,7 @@ size_t GzipDecompressor::read(Bytes bytes)
 
             if (nread < slice.size()) {
                 LittleEndian<u32> crc32, input_size;
+                m_input_stream.align_to_byte_boundary();
                 m_input_stream >> crc32 >> input_size;
 
                 if (crc32 != current_member().m_checksum.digest()) {
@@ -229,7 +232,7 @@ GzipCompressor::~GzipCompressor()
 {
 }
 
-size_t GzipCompressor::write(ReadonlyBytes bytes)
+void GzipCompressor::write_header(OutputStream& stream)
 {
     BlockHeader header;
     header.identification_1 = 0x1f;
@@ -239,7 +242,12 @@ size_t GzipCompressor::write(ReadonlyBytes bytes)
     header.modification_time = 0;
     header.extra_flags = 3;      // DEFLATE sets 2 for maximum compression and 4 for minimum compression
     header.operating_system = 3; // unix
-    m_output_stream << Bytes { &header, sizeof(header) };
+    stream << Bytes { &header, sizeof(header) };
+}
+
+size_t GzipCompressor::write(ReadonlyBytes bytes)
+{
+    write_header(m_output_stream);
     DeflateCompressor compressed_stream { m_output_stream };
     VERIFY(compressed_stream.write_or_error(bytes));
     compressed_stream.final_flush();
@@ -274,4 +282,69 @@ Optional<ByteBuffer> GzipCompressor::compress_all(ReadonlyBytes bytes)
     return output_stream.copy_into_contiguous_buffer();
 }
 
+Optional<ByteBuffer> GzipCompressor::compress_all_in_parallel(ReadonlyBytes bytes, size_t thread_count)
+{
+    auto const chunk_count = ceil_div(bytes.size(), parallel_chunk_size);
+    if (chunk_count < 2 || thread_count < 2)
+        return compress_all(bytes);
+
+    // Every chunk becomes a deflate stream of its own, where all but the last one end on a byte boundary without a
+    // final block, which lets them be concatenated into one deflate stream.
+    Vector<Optional<ByteBuffer>> compressed_chunks;
+    compressed_chunks.resize(chunk_count);
+    Atomic<size_t> next_chunk_index { 0 };
+
+    auto compress_chunks = [&]() -> intptr_t {
+        for (;;) {
+            auto const chunk_index = next_chunk_index.fetch_add(1);
+            if (chunk_index >= chunk_count)
+                return 0;
+
+            auto const chunk_start = chunk_index * parallel_chunk_size;
+            auto const chunk = bytes.slice(chunk_start, min(parallel_chunk_size, bytes.size() - chunk_start));
+
+            DuplexMemoryStream output_stream;
+            // NOTE: The compressor is too large to comfortably live on a secondary thread's stack.
+            auto deflate_stream = make<DeflateCompressor>(output_stream);
+            deflate_stream->set_dictionary(bytes.slice(0, chunk_start));
+            deflate_stream->write_or_error(chunk);
+            if (chunk_index == chunk_count - 1)
+                deflate_stream->final_flush();
+            else
+                deflate_stream->sync_flush();
+
+            if (!deflate_stream->handle_any_error())
+                compressed_chunks[chunk_index] = output_stream.copy_into_contiguous_buffer();
+        }
+    };
+
+    Vector<NonnullRefPtr<Threading::Thread>> threads;
+    for (size_t i = 1; i < min(thread_count, chunk_count); ++i) {
+        auto thread = Threading::Thread::construct([&compress_chunks] { return compress_chunks(); }, "Gzip"sv);
+        thread->start();
+        threads.append(move(thread));
+    }
+
+    // The checksum is calculated while the other threads are compressing, after which this thread helps out with the rest.
+    Crypto::Checksum::CRC32 crc32;
+    crc32.update(bytes);
+    compress_chunks();
+
+    for (auto& thread : threads)
+        (void)thread->join();
+
+    DuplexMemoryStream output_stream;
+    write_header(output_stream);
+    for (auto& compressed_chunk : compressed_chunks) {
+        if (!compressed_chunk.has_value())
+            return {};
+        output_stream.write_or_error(compressed_chunk.value());
+    }
+    LittleEndian<u32> digest = crc32.digest();
+    LittleEndian<u32> size = bytes.size();
+    output_stream << digest << size;
+
+    return output_stream.copy_into_contiguous_buffer();
+}
+
 }
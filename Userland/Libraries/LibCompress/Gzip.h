@@ -56,7 +56,7 @@ public:
 private:
     class Member {
     public:
-        Member(BlockHeader header, InputStream& stream)
+        Member(BlockHeader header, InputBitStream& stream)
             : m_header(header)
             , m_stream(stream)
         {
@@ -71,7 +71,8 @@ private:
     const Member& current_member() const { return m_current_member.value(); }
     Member& current_member() { return m_current_member.value(); }
 
-    InputStream& m_input_stream;
+    // NOTE: This is shared with the deflate stream of the current member, as it reads ahead of the compressed data.
+    InputBitStream m_input_stream;
     u8 m_partial_header[sizeof(BlockHeader)];
     size_t m_partial_header_offset { 0 };
     Optional<Member> m_current_member;
@@ -89,7 +90,14 @@ public:
 
     static Optional<ByteBuffer> compress_all(ReadonlyBytes bytes);
 
+    // Compresses chunks of parallel_chunk_size bytes on thread_count threads. Every chunk is primed with the end of the
+    // previous one as a dictionary, so the result is still a single gzip member that is only slightly larger.
+    static constexpr size_t parallel_chunk_size = 128 * KiB;
+    static Optional<ByteBuffer> compress_all_in_parallel(ReadonlyBytes bytes, size_t thread_count);
+
 private:
+    static void write_header(OutputStream&);
+
     OutputStream& m_output_stream;
 };
 
@@ -0,0 +1,600 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/BuiltinWrappers.h>
+#include <AK/Endian.h>
+#include <AK/MemoryStream.h>
+#include <LibCompress/Lz4.h>
+#include <string.h>
+
+namespace Compress {
+
+// An LZ4 block is a series of sequences, each starting with a token byte: the high nibble is the number of literal bytes
+// that follow, and the low nibble is the length of the match (minus 4) that follows them, as a 16-bit little endian
+// offset back into the output. Nibbles of 15 are followed by extra bytes that add to the length, up to and including the
+// first byte that isn't 255. The last sequence has no match.
+static constexpr size_t min_match_length = 4;
+static constexpr size_t max_match_offset = 0xffff;
+
+// The last 5 bytes of a block are always literals, and the last match has to start at least 12 bytes before its end.
+static constexpr size_t last_literals_length = 5;
+static constexpr size_t match_start_limit = 12;
+
+static constexpr u32 uncompressed_block_flag = 0x80000000;
+static constexpr u32 skippable_frame_magic = 0x184D2A50;
+static constexpr u32 skippable_frame_magic_mask = 0xfffffff0;
+
+struct FrameFlags {
+    static constexpr u8 VersionMask = 0b1100'0000;
+    static constexpr u8 Version = 0b0100'0000;
+    static constexpr u8 BlockIndependence = 1 << 5;
+    static constexpr u8 BlockChecksum = 1 << 4;
+    static constexpr u8 ContentSize = 1 << 3;
+    static constexpr u8 ContentChecksum = 1 << 2;
+    static constexpr u8 Reserved = 1 << 1;
+    static constexpr u8 DictionaryID = 1 << 0;
+};
+
+static constexpr u8 block_descriptor_reserved_mask = 0b1000'1111;
+static constexpr u8 block_descriptor_64kib = 4 << 4;
+
+static u32 read_u32(u8 const* data)
+{
+    u32 value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+static u64 read_u64(u8 const* data)
+{
+    u64 value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+static void copy_u64(u8* destination, u8 const* source)
+{
+    memcpy(destination, source, sizeof(u64));
+}
+
+static u8 header_checksum(ReadonlyBytes descriptor)
+{
+    return (Crypto::Checksum::XXHash32(descriptor).digest() >> 8) & 0xff;
+}
+
+// Decompresses a block to the given offset in the output, with everything before it as the history that matches can refer
+// to. Returns the offset at which the decompressed data ends.
+static Optional<size_t> decompress_sequences(ReadonlyBytes input, Bytes output, size_t output_offset)
+{
+    u8 const* in = input.data();
+    u8 const* const in_end = in + input.size();
+    u8* const out_begin = output.data();
+    u8* out = out_begin + output_offset;
+    u8* const out_end = out_begin + output.size();
+
+    auto read_extra_length = [&](size_t& length) {
+        for (;;) {
+            if (in == in_end)
+                return false;
+            u8 byte = *in++;
+            length += byte;
+            if (byte != 255)
+                return true;
+        }
+    };
+
+    for (;;) {
+        if (in == in_end)
+            return {};
+        u8 token = *in++;
+
+        size_t literal_length = token >> 4;
+        if (literal_length == 15 && !read_extra_length(literal_length))
+            return {};
+        if (literal_length > static_cast<size_t>(in_end - in) || literal_length > static_cast<size_t>(out_end - out))
+            return {};
+        // NOTE: Short runs of literals are copied 16 bytes at a time when there's room for it, the excess gets overwritten.
+        if (literal_length <= 16 && in_end - in >= 16 && out_end - out >= 16) {
+            copy_u64(out, in);
+            copy_u64(out + 8, in + 8);
+        } else {
+            memcpy(out, in, literal_length);
+        }
+        in += literal_length;
+        out += literal_length;
+
+        if (in == in_end)
+            break;
+
+        if (in_end - in < 2)
+            return {};
+        size_t match_offset = in[0] | (in[1] << 8);
+        in += 2;
+        size_t match_length = token & 0xf;
+        if (match_length == 15 && !read_extra_length(match_length))
+            return {};
+        match_length += min_match_length;
+        if (match_offset == 0 || match_offset > static_cast<size_t>(out - out_begin) || match_length > static_cast<size_t>(out_end - out))
+            return {};
+
+        // NOTE: The match may overlap the bytes it produces, which is fine as long as it's at least as far back as the
+        //       size of every copy. Matches that are closer than that repeat a short pattern, so once the first few
+        //       bytes are in place, the rest can be copied from a multiple of the pattern length back instead.
+        u8 const* match = out - match_offset;
+        if (static_cast<size_t>(out_end - out) >= match_length + 2 * sizeof(u64)) {
+            size_t i = 0;
+            if (match_offset < sizeof(u64)) {
+                for (; i < sizeof(u64); ++i)
+                    out[i] = match[i];
+                match = out - match_offset * ceil_div(sizeof(u64), match_offset);
+            }
+            for (; i < match_length; i += sizeof(u64))
+                copy_u64(out + i, match + i);
+        } else {
+            for (size_t i = 0; i < match_length; ++i)
+                out[i] = match[i];
+        }
+        out += match_length;
+    }
+
+    return out - out_begin;
+}
+
+Lz4Decompressor::Lz4Decompressor(InputStream& stream)
+    : m_input_stream(stream)
+{
+}
+
+Lz4Decompressor::~Lz4Decompressor()
+{
+}
+
+size_t Lz4Decompressor::read(Bytes bytes)
+{
+    size_t total_read = 0;
+    while (total_read < bytes.size()) {
+        if (has_any_error() || m_eof)
+            break;
+
+        if (m_buffer_offset < m_buffer_size) {
+            auto nread = m_buffer.span().slice(m_buffer_offset, m_buffer_size - m_buffer_offset).copy_trimmed_to(bytes.slice(total_read));
+            m_buffer_offset += nread;
+            total_read += nread;
+            continue;
+        }
+
+        if (!m_in_frame) {
+            if (!read_frame_header())
+                break;
+            continue;
+        }
+
+        if (!read_block())
+            break;
+    }
+    return total_read;
+}
+
+bool Lz4Decompressor::read_frame_header()
+{
+    for (;;) {
+        LittleEndian<u32> magic;
+        auto nread = m_input_stream.read({ &magic, sizeof(magic) });
+        if (nread == 0 && !m_input_stream.has_any_error()) {
+            m_eof = true;
+            return false;
+        }
+        if (!m_input_stream.read_or_error(Bytes { &magic, sizeof(magic) }.slice(nread))) {
+            set_fatal_error();
+            return false;
+        }
+
+        if ((magic & skippable_frame_magic_mask) == skippable_frame_magic) {
+            LittleEndian<u32> size;
+            m_input_stream >> size;
+            if (!m_input_stream.discard_or_error(size)) {
+                set_fatal_error();
+                return false;
+            }
+            continue;
+        }
+
+        if (magic != lz4_frame_magic) {
+            set_fatal_error();
+            return false;
+        }
+        break;
+    }
+
+    // The frame descriptor is the flags, the block descriptor, and the optional content size, followed by its checksum.
+    u8 descriptor[2 + sizeof(u64)];
+    size_t descriptor_size = 2;
+    if (!m_input_stream.read_or_error({ descriptor, descriptor_size })) {
+        set_fatal_error();
+        return false;
+    }
+
+    u8 flags = descriptor[0];
+    u8 block_descriptor = descriptor[1];
+    // FIXME: Support dictionaries.
+    if ((flags & FrameFlags::VersionMask) != FrameFlags::Version || (flags & (FrameFlags::Reserved | FrameFlags::DictionaryID)) || (block_descriptor & block_descriptor_reserved_mask)) {
+        set_fatal_error();
+        return false;
+    }
+
+    size_t block_size_id = block_descriptor >> 4;
+    if (block_size_id < 4) {
+        set_fatal_error();
+        return false;
+    }
+
+    // The content size is only informative, as the end of the frame is marked anyway.
+    if (flags & FrameFlags::ContentSize) {
+        if (!m_input_stream.read_or_error({ descriptor + descriptor_size, sizeof(u64) })) {
+            set_fatal_error();
+            return false;
+        }
+        descriptor_size += sizeof(u64);
+    }
+
+    u8 checksum = 0;
+    m_input_stream >> checksum;
+    if (m_input_stream.has_any_error() || checksum != header_checksum({ descriptor, descriptor_size })) {
+        set_fatal_error();
+        return false;
+    }
+
+    m_blocks_are_independent = flags & FrameFlags::BlockIndependence;
+    m_has_block_checksums = flags & FrameFlags::BlockChecksum;
+    m_has_content_checksum = flags & FrameFlags::ContentChecksum;
+    m_max_block_size = 1u << (2 * block_size_id + 8);
+    m_content_checksum = {};
+
+    if (m_buffer.try_resize(history_size + m_max_block_size).is_error() || m_compressed_block.try_resize(m_max_block_size).is_error()) {
+        set_fatal_error();
+        return false;
+    }
+    m_buffer_offset = 0;
+    m_buffer_size = 0;
+    m_in_frame = true;
+    return true;
+}
+
+bool Lz4Decompressor::read_block()
+{
+    LittleEndian<u32> block_header;
+    m_input_stream >> block_header;
+    if (m_input_stream.has_any_error()) {
+        set_fatal_error();
+        return false;
+    }
+
+    if (block_header == 0) {
+        // This marks the end of the frame.
+        if (m_has_content_checksum) {
+            LittleEndian<u32> checksum;
+            m_input_stream >> checksum;
+            if (m_input_stream.has_any_error() || checksum != m_content_checksum.digest()) {
+                set_fatal_error();
+                return false;
+            }
+        }
+        m_in_frame = false;
+        return true;
+    }
+
+    bool is_uncompressed = block_header & uncompressed_block_flag;
+    size_t block_size = block_header & ~uncompressed_block_flag;
+    if (block_size > m_max_block_size) {
+        set_fatal_error();
+        return false;
+    }
+
+    // Blocks that depend on the previous ones get the end of their data to refer back to.
+    size_t history_length = 0;
+    if (!m_blocks_are_independent) {
+        history_length = min(m_buffer_size, history_size);
+        memmove(m_buffer.data(), m_buffer.data() + m_buffer_size - history_length, history_length);
+    }
+
+    auto output = m_buffer.bytes().trim(history_length + m_max_block_size);
+    auto block = is_uncompressed ? output.slice(history_length, block_size) : m_compressed_block.bytes().trim(block_size);
+    if (!m_input_stream.read_or_error(block)) {
+        set_fatal_error();
+        return false;
+    }
+
+    if (m_has_block_checksums) {
+        LittleEndian<u32> checksum;
+        m_input_stream >> checksum;
+        if (m_input_stream.has_any_error() || checksum != Crypto::Checksum::XXHash32(block).digest()) {
+            set_fatal_error();
+            return false;
+        }
+    }
+
+    size_t end_offset = history_length + block_size;
+    if (!is_uncompressed) {
+        auto decompressed_end = decompress_sequences(block, output, history_length);
+        if (!decompressed_end.has_value()) {
+            set_fatal_error();
+            return false;
+        }
+        end_offset = decompressed_end.value();
+    }
+
+    m_buffer_offset = history_length;
+    m_buffer_size = end_offset;
+    if (m_has_content_checksum)
+        m_content_checksum.update(m_buffer.span().slice(m_buffer_offset, m_buffer_size - m_buffer_offset));
+    return true;
+}
+
+bool Lz4Decompressor::read_or_error(Bytes bytes)
+{
+    if (read(bytes) < bytes.size()) {
+        set_fatal_error();
+        return false;
+    }
+
+    return true;
+}
+
+bool Lz4Decompressor::discard_or_error(size_t count)
+{
+    u8 buffer[4096];
+
+    size_t ndiscarded = 0;
+    while (ndiscarded < count) {
+        if (unreliable_eof()) {
+            set_fatal_error();
+            return false;
+        }
+
+        ndiscarded += read({ buffer, min<size_t>(count - ndiscarded, sizeof(buffer)) });
+    }
+
+    return true;
+}
+
+bool Lz4Decompressor::unreliable_eof() const { return m_eof; }
+
+bool Lz4Decompressor::handle_any_error()
+{
+    bool handled_errors = m_input_stream.handle_any_error();
+    return Stream::handle_any_error() || handled_errors;
+}
+
+Optional<ByteBuffer> Lz4Decompressor::decompress_all(ReadonlyBytes bytes)
+{
+    InputMemoryStream memory_stream { bytes };
+    Lz4Decompressor lz4_stream { memory_stream };
+    DuplexMemoryStream output_stream;
+
+    u8 buffer[64 * KiB];
+    while (!lz4_stream.has_any_error() && !lz4_stream.unreliable_eof()) {
+        auto const nread = lz4_stream.read({ buffer, sizeof(buffer) });
+        output_stream.write_or_error({ buffer, nread });
+    }
+
+    if (lz4_stream.handle_any_error())
+        return {};
+
+    return output_stream.copy_into_contiguous_buffer();
+}
+
+bool Lz4Decompressor::is_likely_compressed(ReadonlyBytes bytes)
+{
+    return bytes.size() >= sizeof(u32) && AK::convert_between_host_and_little_endian(read_u32(bytes.data())) == lz4_frame_magic;
+}
+
+bool Lz4Decompressor::decompress_block(ReadonlyBytes input, Bytes output)
+{
+    auto decompressed_end = decompress_sequences(input, output, 0);
+    return decompressed_end.has_value() && decompressed_end.value() == output.size();
+}
+
+Lz4Compressor::Lz4Compressor(OutputStream& stream)
+    : m_output_stream(stream)
+{
+}
+
+Lz4Compressor::~Lz4Compressor()
+{
+}
+
+static size_t match_table_index(u32 value, size_t bits)
+{
+    return (value * 2654435761u) >> (32 - bits);
+}
+
+Optional<size_t> Lz4Compressor::compress_block(ReadonlyBytes input, Bytes output, u32* match_table)
+{
+    size_t output_offset = 0;
+    size_t literals_offset = 0;
+
+    auto write_byte = [&](u8 byte) {
+        if (output_offset >= output.size())
+            return false;
+        output[output_offset++] = byte;
+        return true;
+    };
+    auto write_extra_length = [&](size_t length) {
+        for (; length >= 255; length -= 255) {
+            if (!write_byte(255))
+                return false;
+        }
+        return write_byte(length);
+    };
+    auto write_sequence = [&](size_t literal_length, size_t match_length, size_t match_offset) {
+        u8 token = min(literal_length, 15u) << 4;
+        if (match_length != 0)
+            token |= min(match_length - min_match_length, 15u);
+        if (!write_byte(token))
+            return false;
+        if (literal_length >= 15 && !write_extra_length(literal_length - 15))
+            return false;
+        if (literal_length > output.size() - output_offset)
+            return false;
+        memcpy(output.offset_pointer(output_offset), input.offset_pointer(literals_offset), literal_length);
+        output_offset += literal_length;
+        if (match_length == 0)
+            return true;
+        if (!write_byte(match_offset & 0xff) || !write_byte(match_offset >> 8))
+            return false;
+        if (match_length - min_match_length >= 15 && !write_extra_length(match_length - min_match_length - 15))
+            return false;
+        return true;
+    };
+
+    if (input.size() > match_start_limit) {
+        __builtin_memset(match_table, 0, sizeof(u32) << match_table_bits);
+
+        u8 const* data = input.data();
+        size_t const match_end_limit = input.size() - last_literals_length;
+
+        size_t offset = 0;
+        while (offset + match_start_limit <= input.size()) {
+            auto value = read_u32(data + offset);
+            auto& entry = match_table[match_table_index(value, match_table_bits)];
+            size_t candidate = entry;
+            entry = offset;
+            if (candidate == offset || offset - candidate > max_match_offset || read_u32(data + candidate) != value) {
+                // NOTE: Skip ahead faster the longer we go without finding a match, as the data probably doesn't compress.
+                offset += 1 + ((offset - literals_offset) >> 6);
+                continue;
+            }
+
+            // Matches often start a bit earlier than where we found them.
+            while (offset > literals_offset && candidate > 0 && data[offset - 1] == data[candidate - 1]) {
+                --offset;
+                --candidate;
+            }
+
+            size_t match_length = min_match_length;
+            for (;;) {
+                if (offset + match_length + sizeof(u64) > match_end_limit) {
+                    while (offset + match_length < match_end_limit && data[candidate + match_length] == data[offset + match_length])
+                        ++match_length;
+                    break;
+                }
+                // NOTE: The first byte that differs is the lowest one that does, as the data is read as little endian.
+                auto difference = read_u64(data + offset + match_length) ^ read_u64(data + candidate + match_length);
+                if (difference != 0) {
+                    match_length += count_trailing_zeroes(difference) / 8;
+                    break;
+                }
+                match_length += sizeof(u64);
+            }
+
+            if (!write_sequence(offset - literals_offset, match_length, offset - candidate))
+                return {};
+            offset += match_length;
+            literals_offset = offset;
+
+            // Remember a position right before the end of the match, which tends to find the next match sooner.
+            if (offset + match_start_limit <= input.size())
+                match_table[match_table_index(read_u32(data + offset - 2), match_table_bits)] = offset - 2;
+        }
+    }
+
+    if (!write_sequence(input.size() - literals_offset, 0, 0))
+        return {};
+    return output_offset;
+}
+
+Optional<size_t> Lz4Compressor::compress_block(ReadonlyBytes input, Bytes output)
+{
+    u32 match_table[1 << match_table_bits];
+    return compress_block(input, output, match_table);
+}
+
+void Lz4Compressor::write_frame_header()
+{
+    // Blocks are independent of each other, and the content checksum lets readers notice if anything went wrong.
+    u8 descriptor[] = { FrameFlags::Version | FrameFlags::BlockIndependence | FrameFlags::ContentChecksum, block_descriptor_64kib };
+    static_assert(block_size == 64 * KiB);
+
+    LittleEndian<u32> magic = lz4_frame_magic;
+    m_output_stream << magic << ReadonlyBytes { descriptor, sizeof(descriptor) } << header_checksum({ descriptor, sizeof(descriptor) });
+    m_wrote_frame_header = true;
+}
+
+void Lz4Compressor::write_block()
+{
+    ReadonlyBytes block { m_block, m_block_size };
+
+    // Blocks that don't get any smaller are stored as they are.
+    auto compressed_size = compress_block(block, { m_compressed_block, m_block_size - 1 }, m_match_table);
+    if (compressed_size.has_value()) {
+        LittleEndian<u32> block_header = compressed_size.value();
+        m_output_stream << block_header << ReadonlyBytes { m_compressed_block, compressed_size.value() };
+    } else {
+        LittleEndian<u32> block_header = m_block_size | uncompressed_block_flag;
+        m_output_stream << block_header << block;
+    }
+    m_block_size = 0;
+}
+
+size_t Lz4Compressor::write(ReadonlyBytes bytes)
+{
+    VERIFY(!m_finished);
+
+    if (!m_wrote_frame_header)
+        write_frame_header();
+    m_content_checksum.update(bytes);
+
+    size_t total_written = 0;
+    while (total_written < bytes.size()) {
+        auto nwritten = bytes.slice(total_written).copy_trimmed_to({ m_block + m_block_size, block_size - m_block_size });
+        m_block_size += nwritten;
+        total_written += nwritten;
+        if (m_block_size == block_size)
+            write_block();
+    }
+    return total_written;
+}
+
+bool Lz4Compressor::write_or_error(ReadonlyBytes bytes)
+{
+    if (write(bytes) < bytes.size()) {
+        set_fatal_error();
+        return false;
+    }
+
+    return true;
+}
+
+void Lz4Compressor::final_flush()
+{
+    VERIFY(!m_finished);
+
+    if (!m_wrote_frame_header)
+        write_frame_header();
+    if (m_block_size > 0)
+        write_block();
+
+    LittleEndian<u32> end_mark = 0;
+    LittleEndian<u32> checksum = m_content_checksum.digest();
+    m_output_stream << end_mark << checksum;
+    m_finished = true;
+}
+
+Optional<ByteBuffer> Lz4Compressor::compress_all(ReadonlyBytes bytes)
+{
+    DuplexMemoryStream output_stream;
+    Lz4Compressor lz4_stream { output_stream };
+
+    lz4_stream.write_or_error(bytes);
+    lz4_stream.final_flush();
+
+    if (lz4_stream.handle_any_error())
+        return {};
+
+    return output_stream.copy_into_contiguous_buffer();
+}
+
+}
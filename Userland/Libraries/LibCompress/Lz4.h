@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/Optional.h>
+#include <AK/Stream.h>
+#include <LibCrypto/Checksum/XXHash32.h>
+
+namespace Compress {
+
+// The LZ4 frame format (https://github.com/lz4/lz4/blob/dev/doc/lz4_Frame_format.md), which trades compression ratio for
+// speed: compressing is cheap, and decompressing is little more than copying bytes around.
+constexpr u32 lz4_frame_magic = 0x184D2204;
+
+class Lz4Decompressor final : public InputStream {
+public:
+    Lz4Decompressor(InputStream&);
+    ~Lz4Decompressor();
+
+    size_t read(Bytes) override;
+    bool read_or_error(Bytes) override;
+    bool discard_or_error(size_t) override;
+
+    bool unreliable_eof() const override;
+    bool handle_any_error() override;
+
+    static Optional<ByteBuffer> decompress_all(ReadonlyBytes);
+    static bool is_likely_compressed(ReadonlyBytes bytes);
+
+    // Decompresses a single LZ4 block, which has to fill the output exactly.
+    static bool decompress_block(ReadonlyBytes input, Bytes output);
+
+private:
+    // Matches can reach back this far, into the previous blocks of a frame unless its blocks are independent.
+    static constexpr size_t history_size = 64 * KiB;
+
+    bool read_frame_header();
+    bool read_block();
+
+    InputStream& m_input_stream;
+
+    bool m_in_frame { false };
+    bool m_blocks_are_independent { false };
+    bool m_has_block_checksums { false };
+    bool m_has_content_checksum { false };
+    size_t m_max_block_size { 0 };
+    Crypto::Checksum::XXHash32 m_content_checksum;
+
+    // The decompressed data, which starts with the history of the current block if there is any.
+    ByteBuffer m_buffer;
+    ByteBuffer m_compressed_block;
+    size_t m_buffer_offset { 0 };
+    size_t m_buffer_size { 0 };
+
+    bool m_eof { false };
+};
+
+class Lz4Compressor final : public OutputStream {
+public:
+    Lz4Compressor(OutputStream&);
+    ~Lz4Compressor();
+
+    size_t write(ReadonlyBytes) override;
+    bool write_or_error(ReadonlyBytes) override;
+
+    // Writes out whatever is still buffered and ends the frame, after which nothing else can be written.
+    // NOTE: Without this, the output is cut off and won't decompress.
+    void final_flush();
+
+    static Optional<ByteBuffer> compress_all(ReadonlyBytes bytes);
+
+    // Compresses a single LZ4 block. Fails if the result doesn't fit into the output.
+    static Optional<size_t> compress_block(ReadonlyBytes input, Bytes output);
+
+    static constexpr size_t block_size = 64 * KiB;
+
+private:
+    static constexpr size_t match_table_bits = 12;
+
+    static Optional<size_t> compress_block(ReadonlyBytes input, Bytes output, u32* match_table);
+
+    void write_frame_header();
+    void write_block();
+
+    OutputStream& m_output_stream;
+    Crypto::Checksum::XXHash32 m_content_checksum;
+
+    u8 m_block[block_size];
+    size_t m_block_size { 0 };
+    u8 m_compressed_block[block_size];
+    u32 m_match_table[1 << match_table_bits];
+
+    bool m_wrote_frame_header { false };
+    bool m_finished { false };
+};
+
+}
@@ -49,7 +49,15 @@ int ElapsedTimer::elapsed() const
 
 Time ElapsedTimer::elapsed_time() const
 {
-    return Time::from_milliseconds(elapsed());
+    VERIFY(is_valid());
+    struct timeval now;
+    timespec now_spec;
+    clock_gettime(m_precise ? CLOCK_MONOTONIC : CLOCK_MONOTONIC_COARSE, &now_spec);
+    now.tv_sec = now_spec.tv_sec;
+    now.tv_usec = now_spec.tv_nsec / 1000;
+    struct timeval diff;
+    timeval_sub(now, m_origin_time, diff);
+    return Time::from_timeval(diff);
 }
 
 }
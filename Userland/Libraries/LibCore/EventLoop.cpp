@@ -7,10 +7,12 @@
 #include <AK/Badge.h>
 #include <AK/Debug.h>
 #include <AK/Format.h>
+#include <AK/HashMap.h>
 #include <AK/IDAllocator.h>
 #include <AK/JsonObject.h>
 #include <AK/JsonValue.h>
 #include <AK/NeverDestroyed.h>
+#include <AK/NumericLimits.h>
 #include <AK/Singleton.h>
 #include <AK/TemporaryChange.h>
 #include <AK/Time.h>
@@ -32,6 +34,10 @@
 #include <time.h>
 #include <unistd.h>
 
+#ifdef __serenity__
+#    include <sys/epoll.h>
+#endif
+
 namespace Core {
 
 class InspectorServerConnection;
@@ -45,11 +51,81 @@ struct EventLoopTimer {
     bool should_reload { false };
     TimerShouldFireWhenNotVisible fire_when_not_visible { TimerShouldFireWhenNotVisible::No };
     WeakPtr<Object> owner;
+    // Where this timer is in s_timer_queue, or not_queued if it expired while its owner wasn't visible.
+    static constexpr size_t not_queued = NumericLimits<size_t>::max();
+    size_t queue_index { not_queued };
 
     void reload(const Time& now);
     bool has_expired(const Time& now) const;
 };
 
+// A binary min-heap of timers ordered by their fire time, so that finding the next timer to expire doesn't have to look
+// at every timer. Every timer remembers its own position in the heap, so it can be removed without searching for it.
+class EventLoopTimerQueue {
+public:
+    bool is_empty() const { return m_timers.is_empty(); }
+    EventLoopTimer& first() { return *m_timers.first(); }
+
+    void clear() { m_timers.clear(); }
+
+    void insert(EventLoopTimer& timer)
+    {
+        VERIFY(timer.queue_index == EventLoopTimer::not_queued);
+        timer.queue_index = m_timers.size();
+        m_timers.append(&timer);
+        sift_up(timer.queue_index);
+    }
+
+    void remove(EventLoopTimer& timer)
+    {
+        auto index = timer.queue_index;
+        VERIFY(index < m_timers.size() && m_timers[index] == &timer);
+        swap_timers(index, m_timers.size() - 1);
+        m_timers.take_last();
+        timer.queue_index = EventLoopTimer::not_queued;
+        if (index < m_timers.size()) {
+            sift_up(index);
+            sift_down(index);
+        }
+    }
+
+private:
+    void swap_timers(size_t a, size_t b)
+    {
+        swap(m_timers[a], m_timers[b]);
+        m_timers[a]->queue_index = a;
+        m_timers[b]->queue_index = b;
+    }
+
+    void sift_up(size_t index)
+    {
+        while (index > 0) {
+            auto parent = (index - 1) / 2;
+            if (!(m_timers[index]->fire_time < m_timers[parent]->fire_time))
+                return;
+            swap_timers(index, parent);
+            index = parent;
+        }
+    }
+
+    void sift_down(size_t index)
+    {
+        while (true) {
+            auto smallest = index;
+            for (auto child : { 2 * index + 1, 2 * index + 2 }) {
+                if (child < m_timers.size() && m_timers[child]->fire_time < m_timers[smallest]->fire_time)
+                    smallest = child;
+            }
+            if (smallest == index)
+                return;
+            swap_timers(index, smallest);
+            index = smallest;
+        }
+    }
+
+    Vector<EventLoopTimer*> m_timers;
+};
+
 struct EventLoop::Private {
     Threading::Mutex lock;
 };
@@ -58,8 +134,17 @@ static EventLoop* s_main_event_loop;
 static Vector<EventLoop&>* s_event_loop_stack;
 static NeverDestroyed<IDAllocator> s_id_allocator;
 static HashMap<int, NonnullOwnPtr<EventLoopTimer>>* s_timers;
+static EventLoopTimerQueue* s_timer_queue;
+// Timers that expired while their owner wasn't visible. They fire as soon as it becomes visible again.
+static Vector<EventLoopTimer*>* s_hidden_expired_timers;
 static HashTable<Notifier*>* s_notifiers;
 static Threading::Mutex s_notifiers_mutex;
+#ifdef __serenity__
+// The kernel keeps track of the descriptors we're interested in, so waiting
+// for events doesn't have to walk every notifier.
+static HashMap<int, Vector<Notifier*, 1>>* s_notifiers_by_fd;
+static int s_event_queue_fd = -1;
+#endif
 
 int EventLoop::s_wake_pipe_fds[2];
 static RefPtr<InspectorServerConnection> s_inspector_server_connection;
@@ -264,7 +349,12 @@ EventLoop::EventLoop([[maybe_unused]] MakeInspectable make_inspectable)
     if (!s_event_loop_stack) {
         s_event_loop_stack = new Vector<EventLoop&>;
         s_timers = new HashMap<int, NonnullOwnPtr<EventLoopTimer>>;
+        s_timer_queue = new EventLoopTimerQueue;
+        s_hidden_expired_timers = new Vector<EventLoopTimer*>;
         s_notifiers = new HashTable<Notifier*>;
+#ifdef __serenity__
+        s_notifiers_by_fd = new HashMap<int, Vector<Notifier*, 1>>;
+#endif
     }
 
     if (!s_main_event_loop) {
@@ -279,6 +369,9 @@ EventLoop::EventLoop([[maybe_unused]] MakeInspectable make_inspectable)
 
 #endif
         VERIFY(rc == 0);
+#ifdef __serenity__
+        create_event_queue();
+#endif
         s_event_loop_stack->append(*this);
 
 #ifdef __serenity__
@@ -573,8 +666,18 @@ void EventLoop::notify_forked(ForkEvent event)
     case ForkEvent::Child:
         s_main_event_loop = nullptr;
         s_event_loop_stack->clear();
+        s_timer_queue->clear();
+        s_hidden_expired_timers->clear();
         s_timers->clear();
         s_notifiers->clear();
+#ifdef __serenity__
+        // The event queue is shared with our parent, so we have to stop using it.
+        s_notifiers_by_fd->clear();
+        if (s_event_queue_fd >= 0) {
+            ::close(s_event_queue_fd);
+            s_event_queue_fd = -1;
+        }
+#endif
         if (auto* info = signals_info<false>()) {
             info->signal_handlers.clear();
             info->next_signal_id = 0;
@@ -589,6 +692,197 @@ void EventLoop::notify_forked(ForkEvent event)
     VERIFY_NOT_REACHED();
 }
 
+#ifdef __serenity__
+void EventLoop::create_event_queue()
+{
+    s_event_queue_fd = epoll_create1(EPOLL_CLOEXEC);
+    VERIFY(s_event_queue_fd >= 0);
+
+    epoll_event wake_event {};
+    wake_event.events = EPOLLIN;
+    wake_event.data.fd = s_wake_pipe_fds[0];
+    int rc = epoll_ctl(s_event_queue_fd, EPOLL_CTL_ADD, s_wake_pipe_fds[0], &wake_event);
+    VERIFY(rc == 0);
+
+    // Notifiers may have been registered before we had an event queue to tell about them.
+    Threading::MutexLocker locker(s_notifiers_mutex);
+    for (auto& it : *s_notifiers_by_fd)
+        update_event_queue_interest(it.key);
+}
+
+void EventLoop::update_event_queue_interest(int fd)
+{
+    if (s_event_queue_fd < 0)
+        return;
+
+    epoll_event event {};
+    event.data.fd = fd;
+    if (auto it = s_notifiers_by_fd->find(fd); it != s_notifiers_by_fd->end()) {
+        for (auto* notifier : it->value) {
+            if (notifier->event_mask() & Notifier::Read)
+                event.events |= EPOLLIN;
+            if (notifier->event_mask() & Notifier::Write)
+                event.events |= EPOLLOUT;
+            if (notifier->event_mask() & Notifier::Exceptional)
+                VERIFY_NOT_REACHED();
+        }
+    }
+
+    if (event.events == 0) {
+        if (epoll_ctl(s_event_queue_fd, EPOLL_CTL_DEL, fd, nullptr) < 0 && errno != ENOENT)
+            dbgln("Core::EventLoop: Failed to stop watching fd {}: {}", fd, strerror(errno));
+        return;
+    }
+
+    int rc = epoll_ctl(s_event_queue_fd, EPOLL_CTL_ADD, fd, &event);
+    if (rc < 0 && errno == EEXIST)
+        rc = epoll_ctl(s_event_queue_fd, EPOLL_CTL_MOD, fd, &event);
+    if (rc < 0)
+        dbgln("Core::EventLoop: Failed to watch fd {}: {}", fd, strerror(errno));
+}
+#endif
+
+Optional<Time> EventLoop::compute_wait_timeout(WaitMode mode)
+{
+    bool queued_events_is_empty;
+    {
+        Threading::MutexLocker locker(m_private->lock);
+        queued_events_is_empty = m_queued_events.is_empty();
+    }
+
+    if (mode != WaitMode::WaitForEvents || !queued_events_is_empty)
+        return Time::zero();
+
+    auto next_timer_expiration = get_next_timer_expiration();
+    if (!next_timer_expiration.has_value())
+        return {};
+
+    auto computed_timeout = next_timer_expiration.value() - Time::now_monotonic_coarse();
+    if (computed_timeout.is_negative())
+        computed_timeout = Time::zero();
+    return computed_timeout;
+}
+
+bool EventLoop::read_from_wake_pipe()
+{
+    int wake_events[8];
+    auto nread = read(s_wake_pipe_fds[0], wake_events, sizeof(wake_events));
+    if (nread < 0) {
+        perror("read from wake pipe");
+        VERIFY_NOT_REACHED();
+    }
+    VERIFY(nread > 0);
+    bool wake_requested = false;
+    int event_count = nread / sizeof(wake_events[0]);
+    for (int i = 0; i < event_count; i++) {
+        if (wake_events[i] != 0)
+            dispatch_signal(wake_events[i]);
+        else
+            wake_requested = true;
+    }
+
+    // If we filled our buffer, there may still be more signals in the pipe.
+    return wake_requested || nread != sizeof(wake_events);
+}
+
+static void fire_timer(EventLoop& event_loop, EventLoopTimer& timer, Object* owner, Time const& now)
+{
+    dbgln_if(EVENTLOOP_DEBUG, "Core::EventLoop: Timer {} has expired, sending Core::TimerEvent to {}", timer.timer_id, owner);
+
+    if (owner)
+        event_loop.post_event(*owner, make<TimerEvent>(timer.timer_id));
+    if (timer.should_reload) {
+        timer.reload(now);
+        s_timer_queue->insert(timer);
+    } else {
+        // FIXME: Support removing expired timers that don't want to reload.
+        VERIFY_NOT_REACHED();
+    }
+}
+
+static bool timer_should_wait_for_owner(EventLoopTimer const& timer, Object const* owner)
+{
+    return timer.fire_when_not_visible == TimerShouldFireWhenNotVisible::No && owner && !owner->is_visible_for_timer_purposes();
+}
+
+void EventLoop::post_expired_timer_events()
+{
+    if (s_timer_queue->is_empty() && s_hidden_expired_timers->is_empty())
+        return;
+
+    auto now = Time::now_monotonic_coarse();
+
+    for (size_t i = 0; i < s_hidden_expired_timers->size();) {
+        auto& timer = *s_hidden_expired_timers->at(i);
+        auto owner = timer.owner.strong_ref();
+        if (timer_should_wait_for_owner(timer, owner.ptr())) {
+            ++i;
+            continue;
+        }
+        s_hidden_expired_timers->remove(i);
+        fire_timer(*this, timer, owner.ptr(), now);
+    }
+
+    while (!s_timer_queue->is_empty()) {
+        auto& timer = s_timer_queue->first();
+        if (!timer.has_expired(now))
+            break;
+        s_timer_queue->remove(timer);
+
+        auto owner = timer.owner.strong_ref();
+        if (timer_should_wait_for_owner(timer, owner.ptr())) {
+            s_hidden_expired_timers->append(&timer);
+            continue;
+        }
+        fire_timer(*this, timer, owner.ptr(), now);
+    }
+}
+
+#ifdef __serenity__
+void EventLoop::wait_for_event(WaitMode mode)
+{
+    epoll_event events[64];
+    int event_count;
+retry:
+    auto timeout = compute_wait_timeout(mode);
+    int timeout_ms = timeout.has_value() ? static_cast<int>(timeout->to_milliseconds()) : -1;
+
+    for (;;) {
+        event_count = epoll_wait(s_event_queue_fd, events, array_size(events), timeout_ms);
+        if (event_count >= 0)
+            break;
+        int saved_errno = errno;
+        if (saved_errno != EINTR) {
+            dbgln("Core::EventLoop::wait_for_event: {} ({}: {})", event_count, saved_errno, strerror(saved_errno));
+            VERIFY_NOT_REACHED();
+        }
+        if (m_exit_requested)
+            return;
+    }
+
+    for (int i = 0; i < event_count; ++i) {
+        if (events[i].data.fd != s_wake_pipe_fds[0])
+            continue;
+        if (!read_from_wake_pipe())
+            goto retry;
+    }
+
+    post_expired_timer_events();
+
+    Threading::MutexLocker locker(s_notifiers_mutex);
+    for (int i = 0; i < event_count; ++i) {
+        auto it = s_notifiers_by_fd->find(events[i].data.fd);
+        if (it == s_notifiers_by_fd->end())
+            continue;
+        for (auto* notifier : it->value) {
+            if ((events[i].events & EPOLLIN) && (notifier->event_mask() & Notifier::Event::Read))
+                post_event(*notifier, make<NotifierReadEvent>(notifier->fd()));
+            if ((events[i].events & EPOLLOUT) && (notifier->event_mask() & Notifier::Event::Write))
+                post_event(*notifier, make<NotifierWriteEvent>(notifier->fd()));
+        }
+    }
+}
+#else
 void EventLoop::wait_for_event(WaitMode mode)
 {
     fd_set rfds;
@@ -620,27 +914,11 @@ retry:
         }
     }
 
-    bool queued_events_is_empty;
-    {
-        Threading::MutexLocker locker(m_private->lock);
-        queued_events_is_empty = m_queued_events.is_empty();
-    }
-
-    Time now;
+    auto computed_timeout = compute_wait_timeout(mode);
     struct timeval timeout = { 0, 0 };
-    bool should_wait_forever = false;
-    if (mode == WaitMode::WaitForEvents && queued_events_is_empty) {
-        auto next_timer_expiration = get_next_timer_expiration();
-        if (next_timer_expiration.has_value()) {
-            now = Time::now_monotonic_coarse();
-            auto computed_timeout = next_timer_expiration.value() - now;
-            if (computed_timeout.is_negative())
-                computed_timeout = Time::zero();
-            timeout = computed_timeout.to_timeval();
-        } else {
-            should_wait_forever = true;
-        }
-    }
+    bool should_wait_forever = !computed_timeout.has_value();
+    if (computed_timeout.has_value())
+        timeout = computed_timeout->to_timeval();
 
 try_select_again:
     int marked_fd_count = select(max_fd + 1, &rfds, &wfds, nullptr, should_wait_forever ? nullptr : &timeout);
@@ -655,51 +933,11 @@ try_select_again:
         VERIFY_NOT_REACHED();
     }
     if (FD_ISSET(s_wake_pipe_fds[0], &rfds)) {
-        int wake_events[8];
-        auto nread = read(s_wake_pipe_fds[0], wake_events, sizeof(wake_events));
-        if (nread < 0) {
-            perror("read from wake pipe");
-            VERIFY_NOT_REACHED();
-        }
-        VERIFY(nread > 0);
-        bool wake_requested = false;
-        int event_count = nread / sizeof(wake_events[0]);
-        for (int i = 0; i < event_count; i++) {
-            if (wake_events[i] != 0)
-                dispatch_signal(wake_events[i]);
-            else
-                wake_requested = true;
-        }
-
-        if (!wake_requested && nread == sizeof(wake_events))
+        if (!read_from_wake_pipe())
             goto retry;
     }
 
-    if (!s_timers->is_empty()) {
-        now = Time::now_monotonic_coarse();
-    }
-
-    for (auto& it : *s_timers) {
-        auto& timer = *it.value;
-        if (!timer.has_expired(now))
-            continue;
-        auto owner = timer.owner.strong_ref();
-        if (timer.fire_when_not_visible == TimerShouldFireWhenNotVisible::No
-            && owner && !owner->is_visible_for_timer_purposes()) {
-            continue;
-        }
-
-        dbgln_if(EVENTLOOP_DEBUG, "Core::EventLoop: Timer {} has expired, sending Core::TimerEvent to {}", timer.timer_id, *owner);
-
-        if (owner)
-            post_event(*owner, make<TimerEvent>(timer.timer_id));
-        if (timer.should_reload) {
-            timer.reload(now);
-        } else {
-            // FIXME: Support removing expired timers that don't want to reload.
-            VERIFY_NOT_REACHED();
-        }
-    }
+    post_expired_timer_events();
 
     if (!marked_fd_count)
         return;
@@ -716,6 +954,7 @@ try_select_again:
         }
     }
 }
+#endif
 
 bool EventLoopTimer::has_expired(const Time& now) const
 {
@@ -729,18 +968,11 @@ void EventLoopTimer::reload(const Time& now)
 
 Optional<Time> EventLoop::get_next_timer_expiration()
 {
-    Optional<Time> soonest {};
-    for (auto& it : *s_timers) {
-        auto& fire_time = it.value->fire_time;
-        auto owner = it.value->owner.strong_ref();
-        if (it.value->fire_when_not_visible == TimerShouldFireWhenNotVisible::No
-            && owner && !owner->is_visible_for_timer_purposes()) {
-            continue;
-        }
-        if (!soonest.has_value() || fire_time < soonest.value())
-            soonest = fire_time;
-    }
-    return soonest;
+    // Timers whose owners aren't visible are only taken out of the queue once they expire,
+    // so this may wake us up once for nothing.
+    if (s_timer_queue->is_empty())
+        return {};
+    return s_timer_queue->first().fire_time;
 }
 
 int EventLoop::register_timer(Object& object, int milliseconds, bool should_reload, TimerShouldFireWhenNotVisible fire_when_not_visible)
@@ -754,6 +986,7 @@ int EventLoop::register_timer(Object& object, int milliseconds, bool should_relo
     timer->fire_when_not_visible = fire_when_not_visible;
     int timer_id = s_id_allocator->allocate();
     timer->timer_id = timer_id;
+    s_timer_queue->insert(*timer);
     s_timers->set(timer_id, move(timer));
     return timer_id;
 }
@@ -764,6 +997,11 @@ bool EventLoop::unregister_timer(int timer_id)
     auto it = s_timers->find(timer_id);
     if (it == s_timers->end())
         return false;
+    auto& timer = *it->value;
+    if (timer.queue_index != EventLoopTimer::not_queued)
+        s_timer_queue->remove(timer);
+    else
+        s_hidden_expired_timers->remove_first_matching([&](auto* entry) { return entry == &timer; });
     s_timers->remove(it);
     return true;
 }
@@ -772,12 +1010,37 @@ void EventLoop::register_notifier(Badge<Notifier>, Notifier& notifier)
 {
     Threading::MutexLocker locker(s_notifiers_mutex);
     s_notifiers->set(&notifier);
+#ifdef __serenity__
+    auto& notifiers = s_notifiers_by_fd->ensure(notifier.fd());
+    if (!notifiers.contains_slow(&notifier))
+        notifiers.append(&notifier);
+    update_event_queue_interest(notifier.fd());
+#endif
 }
 
 void EventLoop::unregister_notifier(Badge<Notifier>, Notifier& notifier)
 {
     Threading::MutexLocker locker(s_notifiers_mutex);
     s_notifiers->remove(&notifier);
+#ifdef __serenity__
+    if (auto it = s_notifiers_by_fd->find(notifier.fd()); it != s_notifiers_by_fd->end()) {
+        it->value.remove_first_matching([&](auto* entry) { return entry == &notifier; });
+        if (it->value.is_empty())
+            s_notifiers_by_fd->remove(it);
+    }
+    update_event_queue_interest(notifier.fd());
+#endif
+}
+
+void EventLoop::notifier_event_mask_changed(Badge<Notifier>, [[maybe_unused]] Notifier& notifier)
+{
+#ifdef __serenity__
+    if (!s_notifiers_by_fd)
+        return;
+    Threading::MutexLocker locker(s_notifiers_mutex);
+    if (s_notifiers->contains(&notifier))
+        update_event_queue_interest(notifier.fd());
+#endif
 }
 
 void EventLoop::wake()
@@ -58,6 +58,7 @@ public:
 
     static void register_notifier(Badge<Notifier>, Notifier&);
     static void unregister_notifier(Badge<Notifier>, Notifier&);
+    static void notifier_event_mask_changed(Badge<Notifier>, Notifier&);
 
     void quit(int);
     void unquit();
@@ -89,7 +90,14 @@ public:
 
 private:
     void wait_for_event(WaitMode);
+    Optional<Time> compute_wait_timeout(WaitMode);
+    bool read_from_wake_pipe();
+    void post_expired_timer_events();
     Optional<Time> get_next_timer_expiration();
+#ifdef __serenity__
+    static void create_event_queue();
+    static void update_event_queue_interest(int fd);
+#endif
     static void dispatch_signal(int);
     static void handle_signal(int);
 
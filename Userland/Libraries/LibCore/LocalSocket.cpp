@@ -95,6 +95,7 @@ pid_t LocalSocket::peer_pid() const
 
 HashMap<String, int> LocalSocket::s_overtaken_sockets {};
 bool LocalSocket::s_overtaken_sockets_parsed { false };
+bool LocalSocket::s_overtaken_sockets_are_prewarmed { false };
 
 void LocalSocket::parse_sockets_from_system_server()
 {
@@ -116,7 +117,34 @@ void LocalSocket::parse_sockets_from_system_server()
     // We wouldn't want our children to think we're passing
     // them a socket either, so unset the env variable.
     unsetenv(socket_takeover);
+
+    constexpr auto socket_takeover_prewarmed = "SOCKET_TAKEOVER_PREWARMED";
+    s_overtaken_sockets_are_prewarmed = getenv(socket_takeover_prewarmed) != nullptr;
+    unsetenv(socket_takeover_prewarmed);
+}
+
+#ifdef __serenity__
+// A prewarmed instance of a service is started before anybody connects to it, with a socket to SystemServer instead of
+// a client. Once a client does connect, SystemServer sends its socket over, along with a byte to wake us up.
+static ErrorOr<int> receive_accepted_socket_from_system_server(int handoff_fd)
+{
+    u8 byte;
+    for (;;) {
+        auto nread_or_error = Core::System::read(handoff_fd, { &byte, 1 });
+        if (nread_or_error.is_error()) {
+            if (nread_or_error.error().code() == EINTR)
+                continue;
+            return nread_or_error.release_error();
+        }
+        if (nread_or_error.value() == 0)
+            return Error::from_string_literal("SystemServer hung up before handing over a client"sv);
+        break;
+    }
+    auto fd = TRY(Core::System::recvfd(handoff_fd, O_CLOEXEC));
+    TRY(Core::System::close(handoff_fd));
+    return fd;
 }
+#endif
 
 ErrorOr<NonnullRefPtr<LocalSocket>> LocalSocket::take_over_accepted_socket_from_system_server(String const& socket_path)
 {
@@ -135,6 +163,14 @@ ErrorOr<NonnullRefPtr<LocalSocket>> LocalSocket::take_over_accepted_socket_from_
         fd = it->value;
     }
 
+    if (s_overtaken_sockets_are_prewarmed) {
+#ifdef __serenity__
+        fd = TRY(receive_accepted_socket_from_system_server(fd));
+#else
+        return Error::from_string_literal("Prewarmed sockets are only supported on Serenity"sv);
+#endif
+    }
+
     // Sanity check: it has to be a socket.
     auto stat = TRY(Core::System::fstat(fd));
 
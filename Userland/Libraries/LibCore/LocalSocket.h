@@ -30,6 +30,7 @@ private:
 
     static HashMap<String, int> s_overtaken_sockets;
     static bool s_overtaken_sockets_parsed;
+    static bool s_overtaken_sockets_are_prewarmed;
 };
 
 }
@@ -55,6 +55,7 @@ protected:
     void did_progress(Optional<u32> total_size, u32 downloaded);
 
     size_t do_write(ReadonlyBytes bytes) { return m_output_stream.write(bytes); }
+    OutputStream& output_stream() { return m_output_stream; }
 
 private:
     RefPtr<NetworkResponse> m_response;
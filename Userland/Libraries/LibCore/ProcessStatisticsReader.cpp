@@ -5,28 +5,62 @@
  */
 
 #include <AK/ByteBuffer.h>
-#include <AK/JsonArray.h>
-#include <AK/JsonObject.h>
-#include <AK/JsonValue.h>
+#include <Kernel/API/ProcessStatistics.h>
 #include <LibCore/File.h>
 #include <LibCore/ProcessStatisticsReader.h>
 #include <pwd.h>
+#include <string.h>
 
 namespace Core {
 
 HashMap<uid_t, String> ProcessStatisticsReader::s_usernames;
 
+namespace {
+
+class RecordReader {
+public:
+    explicit RecordReader(ReadonlyBytes bytes)
+        : m_bytes(bytes)
+    {
+    }
+
+    template<typename T>
+    Optional<T> read_record()
+    {
+        if (m_bytes.size() < sizeof(T))
+            return {};
+        T record;
+        memcpy(&record, m_bytes.data(), sizeof(T));
+        m_bytes = m_bytes.slice(sizeof(T));
+        return record;
+    }
+
+    Optional<String> read_string(size_t length)
+    {
+        if (m_bytes.size() < length)
+            return {};
+        auto string = String { StringView { m_bytes.data(), length } };
+        m_bytes = m_bytes.slice(length);
+        return string;
+    }
+
+private:
+    ReadonlyBytes m_bytes;
+};
+
+}
+
 Optional<AllProcessesStatistics> ProcessStatisticsReader::get_all(RefPtr<Core::File>& proc_all_file)
 {
     if (proc_all_file) {
         if (!proc_all_file->seek(0, Core::SeekMode::SetPosition)) {
-            warnln("ProcessStatisticsReader: Failed to refresh /proc/all: {}", proc_all_file->error_string());
+            warnln("ProcessStatisticsReader: Failed to refresh /proc/all_binary: {}", proc_all_file->error_string());
             return {};
         }
     } else {
-        proc_all_file = Core::File::construct("/proc/all");
+        proc_all_file = Core::File::construct("/proc/all_binary");
         if (!proc_all_file->open(Core::OpenMode::ReadOnly)) {
-            warnln("ProcessStatisticsReader: Failed to open /proc/all: {}", proc_all_file->error_string());
+            warnln("ProcessStatisticsReader: Failed to open /proc/all_binary: {}", proc_all_file->error_string());
             return {};
         }
     }
@@ -34,71 +68,89 @@ Optional<AllProcessesStatistics> ProcessStatisticsReader::get_all(RefPtr<Core::F
     AllProcessesStatistics all_processes_statistics;
 
     auto file_contents = proc_all_file->read_all();
-    auto json = JsonValue::from_string(file_contents);
-    if (json.is_error())
+    RecordReader reader { file_contents.bytes() };
+
+    auto header = reader.read_record<ProcessStatisticsHeader>();
+    if (!header.has_value() || header->version != PROCESS_STATISTICS_VERSION)
         return {};
 
-    auto& json_obj = json.value().as_object();
-    json_obj.get("processes").as_array().for_each([&](auto& value) {
-        const JsonObject& process_object = value.as_object();
+    all_processes_statistics.processes.ensure_capacity(header->process_count);
+    for (u32 i = 0; i < header->process_count; ++i) {
+        auto record = reader.read_record<ProcessStatisticsRecord>();
+        if (!record.has_value())
+            return {};
         Core::ProcessStatistics process;
 
         // kernel data first
-        process.pid = process_object.get("pid").to_u32();
-        process.pgid = process_object.get("pgid").to_u32();
-        process.pgp = process_object.get("pgp").to_u32();
-        process.sid = process_object.get("sid").to_u32();
-        process.uid = process_object.get("uid").to_u32();
-        process.gid = process_object.get("gid").to_u32();
-        process.ppid = process_object.get("ppid").to_u32();
-        process.nfds = process_object.get("nfds").to_u32();
-        process.kernel = process_object.get("kernel").to_bool();
-        process.name = process_object.get("name").to_string();
-        process.executable = process_object.get("executable").to_string();
-        process.tty = process_object.get("tty").to_string();
-        process.pledge = process_object.get("pledge").to_string();
-        process.veil = process_object.get("veil").to_string();
-        process.amount_virtual = process_object.get("amount_virtual").to_u32();
-        process.amount_resident = process_object.get("amount_resident").to_u32();
-        process.amount_shared = process_object.get("amount_shared").to_u32();
-        process.amount_dirty_private = process_object.get("amount_dirty_private").to_u32();
-        process.amount_clean_inode = process_object.get("amount_clean_inode").to_u32();
-        process.amount_purgeable_volatile = process_object.get("amount_purgeable_volatile").to_u32();
-        process.amount_purgeable_nonvolatile = process_object.get("amount_purgeable_nonvolatile").to_u32();
-
-        auto& thread_array = process_object.get_ptr("threads")->as_array();
-        process.threads.ensure_capacity(thread_array.size());
-        thread_array.for_each([&](auto& value) {
-            auto& thread_object = value.as_object();
+        process.pid = record->pid;
+        process.pgid = record->pgid;
+        process.pgp = record->pgp;
+        process.sid = record->sid;
+        process.uid = record->uid;
+        process.gid = record->gid;
+        process.ppid = record->ppid;
+        process.nfds = record->nfds;
+        process.kernel = record->kernel;
+        process.amount_virtual = record->amount_virtual;
+        process.amount_resident = record->amount_resident;
+        process.amount_shared = record->amount_shared;
+        process.amount_dirty_private = record->amount_dirty_private;
+        process.amount_clean_inode = record->amount_clean_inode;
+        process.amount_purgeable_volatile = record->amount_purgeable_volatile;
+        process.amount_purgeable_nonvolatile = record->amount_purgeable_nonvolatile;
+
+        auto name = reader.read_string(record->name_length);
+        auto executable = reader.read_string(record->executable_length);
+        auto tty = reader.read_string(record->tty_length);
+        auto pledge = reader.read_string(record->pledge_length);
+        auto veil = reader.read_string(record->veil_length);
+        if (!name.has_value() || !executable.has_value() || !tty.has_value() || !pledge.has_value() || !veil.has_value())
+            return {};
+        process.name = name.release_value();
+        process.executable = executable.release_value();
+        process.tty = tty.release_value();
+        process.pledge = pledge.release_value();
+        process.veil = veil.release_value();
+
+        process.threads.ensure_capacity(record->thread_count);
+        for (u32 j = 0; j < record->thread_count; ++j) {
+            auto thread_record = reader.read_record<ThreadStatisticsRecord>();
+            if (!thread_record.has_value())
+                return {};
             Core::ThreadStatistics thread;
-            thread.tid = thread_object.get("tid").to_u32();
-            thread.times_scheduled = thread_object.get("times_scheduled").to_u32();
-            thread.name = thread_object.get("name").to_string();
-            thread.state = thread_object.get("state").to_string();
-            thread.time_user = thread_object.get("time_user").to_u64();
-            thread.time_kernel = thread_object.get("time_kernel").to_u64();
-            thread.cpu = thread_object.get("cpu").to_u32();
-            thread.priority = thread_object.get("priority").to_u32();
-            thread.syscall_count = thread_object.get("syscall_count").to_u32();
-            thread.inode_faults = thread_object.get("inode_faults").to_u32();
-            thread.zero_faults = thread_object.get("zero_faults").to_u32();
-            thread.cow_faults = thread_object.get("cow_faults").to_u32();
-            thread.unix_socket_read_bytes = thread_object.get("unix_socket_read_bytes").to_u32();
-            thread.unix_socket_write_bytes = thread_object.get("unix_socket_write_bytes").to_u32();
-            thread.ipv4_socket_read_bytes = thread_object.get("ipv4_socket_read_bytes").to_u32();
-            thread.ipv4_socket_write_bytes = thread_object.get("ipv4_socket_write_bytes").to_u32();
-            thread.file_read_bytes = thread_object.get("file_read_bytes").to_u32();
-            thread.file_write_bytes = thread_object.get("file_write_bytes").to_u32();
+            thread.tid = thread_record->tid;
+            thread.times_scheduled = thread_record->times_scheduled;
+            thread.time_user = thread_record->time_user;
+            thread.time_kernel = thread_record->time_kernel;
+            thread.cpu = thread_record->cpu;
+            thread.priority = thread_record->priority;
+            thread.syscall_count = thread_record->syscall_count;
+            thread.inode_faults = thread_record->inode_faults;
+            thread.zero_faults = thread_record->zero_faults;
+            thread.cow_faults = thread_record->cow_faults;
+            thread.unix_socket_read_bytes = thread_record->unix_socket_read_bytes;
+            thread.unix_socket_write_bytes = thread_record->unix_socket_write_bytes;
+            thread.ipv4_socket_read_bytes = thread_record->ipv4_socket_read_bytes;
+            thread.ipv4_socket_write_bytes = thread_record->ipv4_socket_write_bytes;
+            thread.file_read_bytes = thread_record->file_read_bytes;
+            thread.file_write_bytes = thread_record->file_write_bytes;
+
+            auto thread_name = reader.read_string(thread_record->name_length);
+            auto state = reader.read_string(thread_record->state_length);
+            if (!thread_name.has_value() || !state.has_value())
+                return {};
+            thread.name = thread_name.release_value();
+            thread.state = state.release_value();
             process.threads.append(move(thread));
-        });
+        }
 
         // and synthetic data last
         process.username = username_from_uid(process.uid);
         all_processes_statistics.processes.append(move(process));
-    });
+    }
 
-    all_processes_statistics.total_time_scheduled = json_obj.get("total_time").to_u64();
-    all_processes_statistics.total_time_scheduled_kernel = json_obj.get("total_time_kernel").to_u64();
+    all_processes_statistics.total_time_scheduled = header->total_time;
+    all_processes_statistics.total_time_scheduled_kernel = header->total_time_kernel;
     return all_processes_statistics;
 }
 
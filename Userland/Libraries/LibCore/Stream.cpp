@@ -16,6 +16,9 @@
 #ifdef __serenity__
 #    include <serenity.h>
 #endif
+#if defined(__serenity__) || defined(__linux__)
+#    include <sys/sendfile.h>
+#endif
 
 namespace Core::Stream {
 
@@ -485,6 +488,27 @@ ErrorOr<TCPSocket> TCPSocket::adopt_fd(int fd)
     return socket;
 }
 
+ErrorOr<size_t> TCPSocket::send_file(int fd, off_t offset, size_t count)
+{
+    if (!is_open()) {
+        return ENOTCONN;
+    }
+
+#if defined(__serenity__) || defined(__linux__)
+    ssize_t rc = ::sendfile(m_helper.fd(), fd, &offset, count);
+    if (rc < 0) {
+        return Error::from_errno(errno);
+    }
+
+    return rc;
+#else
+    (void)fd;
+    (void)offset;
+    (void)count;
+    return ENOTSUP;
+#endif
+}
+
 ErrorOr<size_t> PosixSocketHelper::pending_bytes() const
 {
     if (!is_open()) {
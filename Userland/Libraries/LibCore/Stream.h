@@ -18,6 +18,7 @@
 #include <LibCore/SocketAddress.h>
 #include <errno.h>
 #include <netdb.h>
+#include <string.h>
 
 namespace Core::Stream {
 
@@ -341,6 +342,9 @@ public:
     ErrorOr<void> set_blocking(bool enabled) override { return m_helper.set_blocking(enabled); }
     ErrorOr<void> set_close_on_exec(bool enabled) override { return m_helper.set_close_on_exec(enabled); }
 
+    // Sends up to count bytes of the file behind fd, starting at offset, without copying them through userspace.
+    ErrorOr<size_t> send_file(int fd, off_t offset, size_t count);
+
     virtual ~TCPSocket() override { close(); }
 
 private:
@@ -507,6 +511,7 @@ public:
     BufferedHelper(BufferedHelper&& other)
         : m_stream(move(other.m_stream))
         , m_buffer(move(other.m_buffer))
+        , m_buffer_start(exchange(other.m_buffer_start, 0))
         , m_buffered_size(exchange(other.m_buffered_size, 0))
     {
     }
@@ -515,6 +520,7 @@ public:
     {
         m_stream = move(other.m_stream);
         m_buffer = move(other.m_buffer);
+        m_buffer_start = exchange(other.m_buffer_start, 0);
         m_buffered_size = exchange(other.m_buffered_size, 0);
         return *this;
     }
@@ -547,19 +553,10 @@ public:
         // Let's try to take all we can from the buffer first.
         size_t buffer_nread = 0;
         if (m_buffered_size > 0) {
-            // FIXME: Use a circular buffer to avoid shifting the buffer
-            //        contents.
             size_t amount_to_take = min(buffer.size(), m_buffered_size);
-            auto slice_to_take = m_buffer.span().slice(0, amount_to_take);
-            auto slice_to_shift = m_buffer.span().slice(amount_to_take);
-
-            slice_to_take.copy_to(buffer);
+            buffered_bytes().slice(0, amount_to_take).copy_to(buffer);
+            consume(amount_to_take);
             buffer_nread += amount_to_take;
-
-            if (amount_to_take < m_buffered_size) {
-                m_buffer.overwrite(0, slice_to_shift.data(), m_buffered_size - amount_to_take);
-            }
-            m_buffered_size -= amount_to_take;
         }
 
         // If the buffer satisfied the request, then we need not continue.
@@ -614,51 +611,73 @@ public:
                 return EMSGSIZE;
             }
 
-            m_buffer.span().slice(0, m_buffered_size).copy_to(buffer);
-            return exchange(m_buffered_size, 0);
+            buffered_bytes().copy_to(buffer);
+            auto nread = m_buffered_size;
+            consume(nread);
+            return nread;
         }
 
-        size_t longest_match = 0;
-        size_t maximum_offset = min(m_buffered_size, buffer.size());
-        for (size_t offset = 0; offset < maximum_offset; offset++) {
-            // The intention here is to try to match all of the possible
-            // delimiter candidates and try to find the longest one we can
-            // remove from the buffer after copying up to the delimiter to the
-            // user buffer.
-            StringView remaining_buffer { m_buffer.span().offset(offset), maximum_offset - offset };
-            for (auto candidate : candidates) {
-                if (candidate.length() > remaining_buffer.length())
-                    continue;
-                if (remaining_buffer.starts_with(candidate))
-                    longest_match = max(longest_match, candidate.length());
-            }
-
-            if (longest_match > 0) {
-                auto buffer_to_take = m_buffer.span().slice(0, offset);
-                auto buffer_to_shift = m_buffer.span().slice(offset + longest_match);
-
-                buffer_to_take.copy_to(buffer);
-                m_buffer.overwrite(0, buffer_to_shift.data(), buffer_to_shift.size());
-
-                m_buffered_size -= offset + longest_match;
-
-                return offset;
-            }
+        auto maximum_offset = min(m_buffered_size, buffer.size());
+        if (auto match = find_any_of(buffered_bytes().trim(maximum_offset), candidates); match.has_value()) {
+            buffered_bytes().slice(0, match->offset).copy_to(buffer);
+            consume(match->offset + match->length);
+            return match->offset;
         }
 
         // If we still haven't found anything, then it's most likely the case
         // that the delimiter ends beyond the length of the caller-passed
         // buffer. Let's just fill the caller's buffer up.
-        auto readable_size = min(m_buffered_size, buffer.size());
-        auto buffer_to_take = m_buffer.span().slice(0, readable_size);
-        auto buffer_to_shift = m_buffer.span().slice(readable_size);
+        buffered_bytes().slice(0, maximum_offset).copy_to(buffer);
+        consume(maximum_offset);
+        return maximum_offset;
+    }
+
+    // These work like the functions above, but instead of copying the data out, they return a view
+    // into the internal buffer. The view stays valid until the next call that reads from the stream.
+    // A line that doesn't fit into the buffer is returned in pieces of up to buffer_size() bytes.
+    ErrorOr<ReadonlyBytes> read_line_view()
+    {
+        return read_until_view("\n"sv);
+    }
 
-        buffer_to_take.copy_to(buffer);
-        m_buffer.overwrite(0, buffer_to_shift.data(), buffer_to_shift.size());
+    ErrorOr<ReadonlyBytes> read_until_view(StringView const& candidate)
+    {
+        return read_until_any_of_view(Array { candidate });
+    }
+
+    template<size_t N>
+    ErrorOr<ReadonlyBytes> read_until_any_of_view(Array<StringView, N> candidates)
+    {
+        if (!stream().is_open())
+            return ENOTCONN;
+
+        size_t longest_candidate = 0;
+        for (auto candidate : candidates)
+            longest_candidate = max(longest_candidate, candidate.length());
+
+        for (;;) {
+            auto bytes = buffered_bytes();
+            bool can_read_more = !stream().is_eof() && m_buffered_size < m_buffer.size() && stream().is_readable();
+
+            // A match that runs up to the end of the buffered data might be the start of a longer candidate (think
+            // "\r" and "\r\n"), so we only take it once we've seen what comes after it.
+            auto match = find_any_of(bytes, candidates);
+            if (match.has_value() && (match->offset + longest_candidate <= bytes.size() || !can_read_more)) {
+                consume(match->offset + match->length);
+                return bytes.trim(match->offset);
+            }
 
-        m_buffered_size -= readable_size;
+            if (!can_read_more) {
+                // Either the stream is at EOF and this is the last line, or the line doesn't fit into the buffer.
+                if (stream().is_eof() || m_buffered_size == m_buffer.size()) {
+                    consume(bytes.size());
+                    return bytes;
+                }
+                return ReadonlyBytes {};
+            }
 
-        return readable_size;
+            TRY(populate_read_buffer());
+        }
     }
 
     // Returns whether a line can be read, populating the buffer in the process.
@@ -667,7 +686,7 @@ public:
         if (stream().is_eof() && m_buffered_size > 0)
             return true;
 
-        if (m_buffer.span().slice(0, m_buffered_size).contains_slow('\n'))
+        if (contains_newline(buffered_bytes()))
             return true;
 
         if (!stream().is_readable())
@@ -682,7 +701,7 @@ public:
                 return m_buffered_size > 0;
             }
 
-            if (populated_slice.contains_slow('\n'))
+            if (contains_newline(populated_slice))
                 return true;
         }
 
@@ -705,30 +724,89 @@ public:
 
     void clear_buffer()
     {
+        m_buffer_start = 0;
         m_buffered_size = 0;
     }
 
 private:
+    struct Match {
+        size_t offset { 0 };
+        size_t length { 0 };
+    };
+
+    // Finds the first place where any of the candidates starts, and the longest candidate that starts there.
+    template<size_t N>
+    static Optional<Match> find_any_of(ReadonlyBytes haystack, Array<StringView, N> const& candidates)
+    {
+        Optional<Match> best_match;
+        for (auto candidate : candidates) {
+            if (candidate.is_empty())
+                continue;
+            // Only look for matches that start before (or together with) the best one so far.
+            auto search_end = best_match.has_value() ? min(haystack.size(), best_match->offset + candidate.length()) : haystack.size();
+            auto offset = find_candidate(haystack.trim(search_end), candidate.bytes());
+            if (!offset.has_value())
+                continue;
+            if (!best_match.has_value() || *offset < best_match->offset || (*offset == best_match->offset && candidate.length() > best_match->length))
+                best_match = Match { *offset, candidate.length() };
+        }
+        return best_match;
+    }
+
+    static Optional<size_t> find_candidate(ReadonlyBytes haystack, ReadonlyBytes candidate)
+    {
+        // Delimiters are short, so find their first byte with memchr() (which is vectorized) and only then compare the rest.
+        size_t offset = 0;
+        while (offset + candidate.size() <= haystack.size()) {
+            auto const* first_byte = static_cast<u8 const*>(memchr(haystack.data() + offset, candidate[0], haystack.size() - candidate.size() + 1 - offset));
+            if (!first_byte)
+                return {};
+            offset = first_byte - haystack.data();
+            if (__builtin_memcmp(first_byte, candidate.data(), candidate.size()) == 0)
+                return offset;
+            ++offset;
+        }
+        return {};
+    }
+
+    static bool contains_newline(ReadonlyBytes bytes)
+    {
+        return !bytes.is_empty() && memchr(bytes.data(), '\n', bytes.size()) != nullptr;
+    }
+
+    ReadonlyBytes buffered_bytes() const { return m_buffer.span().slice(m_buffer_start, m_buffered_size); }
+
+    // Consuming from the buffer only moves its start forward. The remaining data is moved back to
+    // the front only once we need the space at the end to read more.
+    void consume(size_t count)
+    {
+        VERIFY(count <= m_buffered_size);
+        m_buffer_start += count;
+        m_buffered_size -= count;
+        if (m_buffered_size == 0)
+            m_buffer_start = 0;
+    }
+
     ErrorOr<ReadonlyBytes> populate_read_buffer()
     {
         if (m_buffered_size == m_buffer.size())
             return ReadonlyBytes {};
 
-        auto fillable_slice = m_buffer.span().slice(m_buffered_size);
+        if (m_buffer_start + m_buffered_size == m_buffer.size()) {
+            m_buffer.overwrite(0, m_buffer.data() + m_buffer_start, m_buffered_size);
+            m_buffer_start = 0;
+        }
+
+        auto fillable_slice = m_buffer.span().slice(m_buffer_start + m_buffered_size);
         auto nread = TRY(m_stream.read(fillable_slice));
         m_buffered_size += nread;
         return fillable_slice.slice(0, nread);
     }
 
     T m_stream;
-    // FIXME: Replacing this with a circular buffer would be really nice and
-    //        would avoid excessive copies; however, right now
-    //        AK::CircularDuplexBuffer inlines its entire contents, and that
-    //        would make for a very large object on the stack.
-    //
-    //        The proper fix is to make a CircularQueue which uses a buffer on
-    //        the heap.
     ByteBuffer m_buffer;
+    // The buffered data lives at [m_buffer_start, m_buffer_start + m_buffered_size) in m_buffer.
+    size_t m_buffer_start { 0 };
     size_t m_buffered_size { 0 };
 };
 
@@ -766,6 +844,10 @@ public:
     ErrorOr<size_t> read_until(Bytes buffer, StringView const& candidate) { return m_helper.read_until(move(buffer), move(candidate)); }
     template<size_t N>
     ErrorOr<size_t> read_until_any_of(Bytes buffer, Array<StringView, N> candidates) { return m_helper.read_until_any_of(move(buffer), move(candidates)); }
+    ErrorOr<ReadonlyBytes> read_line_view() { return m_helper.read_line_view(); }
+    ErrorOr<ReadonlyBytes> read_until_view(StringView const& candidate) { return m_helper.read_until_view(candidate); }
+    template<size_t N>
+    ErrorOr<ReadonlyBytes> read_until_any_of_view(Array<StringView, N> candidates) { return m_helper.read_until_any_of_view(move(candidates)); }
     ErrorOr<bool> can_read_line() { return m_helper.can_read_line(); }
 
     size_t buffer_size() const { return m_helper.buffer_size(); }
@@ -823,8 +905,14 @@ public:
     ErrorOr<size_t> read_until(Bytes buffer, StringView const& candidate) { return m_helper.read_until(move(buffer), move(candidate)); }
     template<size_t N>
     ErrorOr<size_t> read_until_any_of(Bytes buffer, Array<StringView, N> candidates) { return m_helper.read_until_any_of(move(buffer), move(candidates)); }
+    ErrorOr<ReadonlyBytes> read_line_view() { return m_helper.read_line_view(); }
+    ErrorOr<ReadonlyBytes> read_until_view(StringView const& candidate) { return m_helper.read_until_view(candidate); }
+    template<size_t N>
+    ErrorOr<ReadonlyBytes> read_until_any_of_view(Array<StringView, N> candidates) { return m_helper.read_until_any_of_view(move(candidates)); }
     ErrorOr<bool> can_read_line() { return m_helper.can_read_line(); }
 
+    ErrorOr<size_t> send_file(int fd, off_t offset, size_t count) { return m_helper.stream().send_file(fd, offset, count); }
+
     size_t buffer_size() const { return m_helper.buffer_size(); }
 
     virtual ~BufferedSocket() override { }
@@ -10,6 +10,8 @@
 #include <LibCore/UDPServer.h>
 #include <errno.h>
 #include <stdio.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #ifndef SOCK_NONBLOCK
@@ -116,4 +118,105 @@ ErrorOr<size_t> UDPServer::send(ReadonlyBytes buffer, sockaddr_in const& to)
     return result;
 }
 
+ErrorOr<Vector<UDPServer::Datagram>> UDPServer::receive_many(size_t max_count, size_t max_size)
+{
+    if (m_fd < 0)
+        return Error::from_errno(EBADF);
+
+    Vector<Datagram> datagrams;
+    TRY(datagrams.try_resize(max_count));
+    for (auto& datagram : datagrams)
+        TRY(datagram.data.try_resize(max_size));
+
+#if defined(__serenity__) || defined(__linux__)
+    Vector<iovec> iovs;
+    Vector<mmsghdr> headers;
+    TRY(iovs.try_ensure_capacity(max_count));
+    TRY(headers.try_ensure_capacity(max_count));
+    for (auto& datagram : datagrams)
+        iovs.unchecked_append({ datagram.data.data(), max_size });
+    for (size_t i = 0; i < max_count; ++i) {
+        mmsghdr header {};
+        header.msg_hdr.msg_name = &datagrams[i].address;
+        header.msg_hdr.msg_namelen = sizeof(sockaddr_in);
+        header.msg_hdr.msg_iov = &iovs[i];
+        header.msg_hdr.msg_iovlen = 1;
+        headers.unchecked_append(header);
+    }
+
+    int count = ::recvmmsg(m_fd, headers.data(), max_count, 0, nullptr);
+    if (count < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+            return Vector<Datagram> {};
+        return Error::from_errno(errno);
+    }
+    datagrams.shrink(count);
+    for (int i = 0; i < count; ++i)
+        datagrams[i].data.resize(min<size_t>(headers[i].msg_len, max_size));
+#else
+    size_t count = 0;
+    for (; count < max_count; ++count) {
+        auto& datagram = datagrams[count];
+        socklen_t address_length = sizeof(datagram.address);
+        ssize_t length = ::recvfrom(m_fd, datagram.data.data(), max_size, 0, (sockaddr*)&datagram.address, &address_length);
+        if (length < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break;
+            if (count == 0)
+                return Error::from_errno(errno);
+            break;
+        }
+        datagram.data.resize(min<size_t>(length, max_size));
+    }
+    datagrams.shrink(count);
+#endif
+    return datagrams;
+}
+
+ErrorOr<size_t> UDPServer::send_many(Span<Datagram const> datagrams)
+{
+    if (m_fd < 0)
+        return Error::from_errno(EBADF);
+
+#if defined(__serenity__) || defined(__linux__)
+    Vector<iovec> iovs;
+    Vector<mmsghdr> headers;
+    TRY(iovs.try_ensure_capacity(datagrams.size()));
+    TRY(headers.try_ensure_capacity(datagrams.size()));
+    for (auto& datagram : datagrams)
+        iovs.unchecked_append({ const_cast<u8*>(datagram.data.data()), datagram.data.size() });
+    for (size_t i = 0; i < datagrams.size(); ++i) {
+        mmsghdr header {};
+        header.msg_hdr.msg_name = const_cast<sockaddr_in*>(&datagrams[i].address);
+        header.msg_hdr.msg_namelen = sizeof(sockaddr_in);
+        header.msg_hdr.msg_iov = &iovs[i];
+        header.msg_hdr.msg_iovlen = 1;
+        headers.unchecked_append(header);
+    }
+
+    size_t sent_count = 0;
+    while (sent_count < datagrams.size()) {
+        int count = ::sendmmsg(m_fd, headers.data() + sent_count, datagrams.size() - sent_count, 0);
+        if (count < 0) {
+            if (sent_count == 0)
+                return Error::from_errno(errno);
+            break;
+        }
+        sent_count += count;
+    }
+    return sent_count;
+#else
+    size_t sent_count = 0;
+    for (; sent_count < datagrams.size(); ++sent_count) {
+        auto result = send(datagrams[sent_count].data, datagrams[sent_count].address);
+        if (result.is_error()) {
+            if (sent_count == 0)
+                return result.release_error();
+            break;
+        }
+    }
+    return sent_count;
+#endif
+}
+
 }
@@ -9,6 +9,8 @@
 #include <AK/ByteBuffer.h>
 #include <AK/Forward.h>
 #include <AK/Function.h>
+#include <AK/Span.h>
+#include <AK/Vector.h>
 #include <LibCore/Forward.h>
 #include <LibCore/Object.h>
 #include <LibCore/SocketAddress.h>
@@ -32,6 +34,18 @@ public:
 
     ErrorOr<size_t> send(ReadonlyBytes, sockaddr_in const& to);
 
+    struct Datagram {
+        ByteBuffer data;
+        sockaddr_in address {};
+    };
+
+    // Receives up to max_count of the datagrams that are already queued up (each cut off after max_size bytes)
+    // with a single syscall. Returns an empty list if there aren't any.
+    ErrorOr<Vector<Datagram>> receive_many(size_t max_count, size_t max_size);
+
+    // Sends the datagrams with as few syscalls as possible, and returns how many of them were sent.
+    ErrorOr<size_t> send_many(Span<Datagram const>);
+
     Optional<IPv4Address> local_address() const;
     Optional<u16> local_port() const;
 
@@ -8,6 +8,7 @@
 #include <AK/JsonObject.h>
 #include <AK/JsonValue.h>
 #include <LibCompress/Gzip.h>
+#include <LibCompress/Lz4.h>
 #include <LibCore/File.h>
 #include <LibCoredump/Reader.h>
 #include <signal_numbers.h>
@@ -21,7 +22,8 @@ OwnPtr<Reader> Reader::create(StringView path)
     if (file_or_error.is_error())
         return {};
 
-    if (!Compress::GzipDecompressor::is_likely_compressed(file_or_error.value()->bytes())) {
+    auto bytes = file_or_error.value()->bytes();
+    if (!Compress::GzipDecompressor::is_likely_compressed(bytes) && !Compress::Lz4Decompressor::is_likely_compressed(bytes)) {
         // It's an uncompressed coredump.
         return AK::adopt_own_if_nonnull(new (nothrow) Reader(file_or_error.release_value()));
     }
@@ -62,7 +64,10 @@ Reader::Reader(ReadonlyBytes coredump_bytes)
 
 Optional<ByteBuffer> Reader::decompress_coredump(ReadonlyBytes raw_coredump)
 {
-    auto decompressed_coredump = Compress::GzipDecompressor::decompress_all(raw_coredump);
+    // CrashDaemon compresses coredumps with LZ4, but older ones are gzipped.
+    auto decompressed_coredump = Compress::Lz4Decompressor::is_likely_compressed(raw_coredump)
+        ? Compress::Lz4Decompressor::decompress_all(raw_coredump)
+        : Compress::GzipDecompressor::decompress_all(raw_coredump);
     if (!decompressed_coredump.has_value())
         return ByteBuffer::copy(raw_coredump); // if we didn't manage to decompress it, try and parse it as decompressed coredump
     return decompressed_coredump;
@@ -6,12 +6,16 @@
 
 #include <AK/ByteReader.h>
 #include <AK/Debug.h>
-#include <AK/MemoryStream.h>
+#include <AK/Platform.h>
 #include <AK/Types.h>
 #include <AK/Vector.h>
 #include <LibCrypto/Authentication/GHash.h>
 #include <LibCrypto/BigInt/UnsignedBigInteger.h>
 
+#if ARCH(X86_64)
+#    include <immintrin.h>
+#endif
+
 namespace {
 
 static u32 to_u32(const u8* b)
@@ -31,40 +35,155 @@ static void to_u8s(u8* b, const u32* w)
 namespace Crypto {
 namespace Authentication {
 
-GHash::TagType GHash::process(ReadonlyBytes aad, ReadonlyBytes cipher)
+#if ARCH(X86_64)
+static bool cpu_supports_pclmul()
 {
-    u32 tag[4] { 0, 0, 0, 0 };
-
-    auto transform_one = [&](auto& buf) {
-        size_t i = 0;
-        for (; i < buf.size(); i += 16) {
-            if (i + 16 <= buf.size()) {
-                for (auto j = 0; j < 4; ++j) {
-                    tag[j] ^= to_u32(buf.offset(i + j * 4));
-                }
-                galois_multiply(tag, m_key, tag);
-            }
-        }
+    static bool const supported = [] {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("ssse3");
+    }();
+    return supported;
+}
+
+// The vectorized functions work on blocks with their byte order reversed. This turns GHASH's bit-reflected representation
+// into one where the product of PCLMULQDQ only has to be shifted left by one bit, see Intel's "Carry-Less Multiplication
+// Instruction and its Usage for Computing the GCM Mode".
+static __m128i load_words(u32 const (&words)[4])
+{
+    return _mm_set_epi32(static_cast<int>(words[0]), static_cast<int>(words[1]), static_cast<int>(words[2]), static_cast<int>(words[3]));
+}
+
+static void store_words(u32 (&words)[4], __m128i value)
+{
+    u32 reversed_words[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(reversed_words), value);
+    for (auto i = 0; i < 4; ++i)
+        words[i] = reversed_words[3 - i];
+}
+
+[[gnu::target("ssse3")]] ALWAYS_INLINE static __m128i load_block(u8 const* data)
+{
+    auto const reverse_bytes = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    return _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const*>(data)), reverse_bytes);
+}
+
+// Adds the unreduced 256-bit product of x and y to low, middle and high, where middle overlaps the other two by 64 bits.
+[[gnu::target("pclmul")]] ALWAYS_INLINE static void multiply_accumulate(__m128i x, __m128i y, __m128i& low, __m128i& middle, __m128i& high)
+{
+    low = _mm_xor_si128(low, _mm_clmulepi64_si128(x, y, 0x00));
+    middle = _mm_xor_si128(middle, _mm_clmulepi64_si128(x, y, 0x10));
+    middle = _mm_xor_si128(middle, _mm_clmulepi64_si128(x, y, 0x01));
+    high = _mm_xor_si128(high, _mm_clmulepi64_si128(x, y, 0x11));
+}
+
+[[gnu::target("pclmul")]] ALWAYS_INLINE static __m128i reduce(__m128i low, __m128i middle, __m128i high)
+{
+    low = _mm_xor_si128(low, _mm_slli_si128(middle, 8));
+    high = _mm_xor_si128(high, _mm_srli_si128(middle, 8));
+
+    // Shift the product left by one bit
+    auto carry_low = _mm_srli_epi32(low, 31);
+    auto carry_high = _mm_srli_epi32(high, 31);
+    low = _mm_or_si128(_mm_slli_epi32(low, 1), _mm_slli_si128(carry_low, 4));
+    high = _mm_or_si128(_mm_slli_epi32(high, 1), _mm_slli_si128(carry_high, 4));
+    high = _mm_or_si128(high, _mm_srli_si128(carry_low, 12));
+
+    // Reduce it modulo x^128 + x^7 + x^2 + x + 1
+    auto first_phase = _mm_xor_si128(_mm_xor_si128(_mm_slli_epi32(low, 31), _mm_slli_epi32(low, 30)), _mm_slli_epi32(low, 25));
+    low = _mm_xor_si128(low, _mm_slli_si128(first_phase, 12));
+    auto second_phase = _mm_xor_si128(_mm_xor_si128(_mm_srli_epi32(low, 1), _mm_srli_epi32(low, 2)), _mm_srli_epi32(low, 7));
+    second_phase = _mm_xor_si128(second_phase, _mm_srli_si128(first_phase, 4));
+    return _mm_xor_si128(high, _mm_xor_si128(low, second_phase));
+}
+
+[[gnu::target("pclmul,ssse3")]] static void galois_multiply_pclmul(u32 (&z)[4], u32 const (&x)[4], u32 const (&y)[4])
+{
+    auto low = _mm_setzero_si128();
+    auto middle = _mm_setzero_si128();
+    auto high = _mm_setzero_si128();
+    multiply_accumulate(load_words(x), load_words(y), low, middle, high);
+    store_words(z, reduce(low, middle, high));
+}
 
-        if (i > buf.size()) {
-            static u8 buffer[16];
-            Bytes buffer_bytes { buffer, 16 };
-            OutputMemoryStream stream { buffer_bytes };
-            stream.write(buf.slice(i - 16));
-            stream.fill_to_end(0);
-
-            for (auto j = 0; j < 4; ++j) {
-                tag[j] ^= to_u32(buffer_bytes.offset(j * 4));
-            }
-            galois_multiply(tag, m_key, tag);
+// Processes four blocks at a time as tag = (tag + B0) * H^4 + B1 * H^3 + B2 * H^2 + B3 * H, which only needs a single reduction.
+[[gnu::target("pclmul,ssse3")]] static void transform_blocks_pclmul(u32 (&tag_words)[4], u32 const (&key)[4], u32 const (&key_powers)[3][4], u8 const* data, size_t blocks)
+{
+    auto tag = load_words(tag_words);
+    auto const h1 = load_words(key);
+    auto const h2 = load_words(key_powers[0]);
+    auto const h3 = load_words(key_powers[1]);
+    auto const h4 = load_words(key_powers[2]);
+
+    for (; blocks >= 4; blocks -= 4, data += 64) {
+        auto low = _mm_setzero_si128();
+        auto middle = _mm_setzero_si128();
+        auto high = _mm_setzero_si128();
+        multiply_accumulate(_mm_xor_si128(tag, load_block(data)), h4, low, middle, high);
+        multiply_accumulate(load_block(data + 16), h3, low, middle, high);
+        multiply_accumulate(load_block(data + 32), h2, low, middle, high);
+        multiply_accumulate(load_block(data + 48), h1, low, middle, high);
+        tag = reduce(low, middle, high);
+    }
+
+    for (; blocks > 0; --blocks, data += 16) {
+        auto low = _mm_setzero_si128();
+        auto middle = _mm_setzero_si128();
+        auto high = _mm_setzero_si128();
+        multiply_accumulate(_mm_xor_si128(tag, load_block(data)), h1, low, middle, high);
+        tag = reduce(low, middle, high);
+    }
+
+    store_words(tag_words, tag);
+}
+#endif
+
+static void transform_blocks(u32 (&tag)[4], u32 const (&key)[4], u32 const (&key_powers)[3][4], u8 const* data, size_t blocks)
+{
+#if ARCH(X86_64)
+    if (cpu_supports_pclmul()) {
+        transform_blocks_pclmul(tag, key, key_powers, data, blocks);
+        return;
+    }
+#endif
+
+    for (; blocks > 0; --blocks, data += 16) {
+        for (auto j = 0; j < 4; ++j) {
+            tag[j] ^= to_u32(data + j * 4);
         }
-    };
+        galois_multiply(tag, key, tag);
+    }
+}
 
-    transform_one(aad);
-    transform_one(cipher);
+GHash::TagType GHash::process(ReadonlyBytes aad, ReadonlyBytes cipher)
+{
+    reset();
+    update(aad);
+    update(cipher);
+    return digest(aad.size(), cipher.size());
+}
 
-    auto aad_bits = 8 * (u64)aad.size();
-    auto cipher_bits = 8 * (u64)cipher.size();
+void GHash::reset()
+{
+    __builtin_memset(m_tag, 0, sizeof(m_tag));
+}
+
+void GHash::update(ReadonlyBytes data)
+{
+    auto full_blocks = data.size() / 16;
+    transform_blocks(m_tag, m_key, m_key_powers, data.data(), full_blocks);
+
+    auto remainder = data.slice(full_blocks * 16);
+    if (!remainder.is_empty()) {
+        u8 buffer[16] {};
+        remainder.copy_to({ buffer, sizeof(buffer) });
+        transform_blocks(m_tag, m_key, m_key_powers, buffer, 1);
+    }
+}
+
+GHash::TagType GHash::digest(u64 aad_size, u64 cipher_size)
+{
+    auto aad_bits = 8 * aad_size;
+    auto cipher_bits = 8 * cipher_size;
 
     auto high = [](u64 value) -> u32 { return value >> 32; };
     auto low = [](u64 value) -> u32 { return value & 0xffffffff; };
@@ -72,20 +191,20 @@ GHash::TagType GHash::process(ReadonlyBytes aad, ReadonlyBytes cipher)
     if constexpr (GHASH_PROCESS_DEBUG) {
         dbgln("AAD bits: {} : {}", high(aad_bits), low(aad_bits));
         dbgln("Cipher bits: {} : {}", high(cipher_bits), low(cipher_bits));
-        dbgln("Tag bits: {} : {} : {} : {}", tag[0], tag[1], tag[2], tag[3]);
+        dbgln("Tag bits: {} : {} : {} : {}", m_tag[0], m_tag[1], m_tag[2], m_tag[3]);
     }
 
-    tag[0] ^= high(aad_bits);
-    tag[1] ^= low(aad_bits);
-    tag[2] ^= high(cipher_bits);
-    tag[3] ^= low(cipher_bits);
+    m_tag[0] ^= high(aad_bits);
+    m_tag[1] ^= low(aad_bits);
+    m_tag[2] ^= high(cipher_bits);
+    m_tag[3] ^= low(cipher_bits);
 
-    dbgln_if(GHASH_PROCESS_DEBUG, "Tag bits: {} : {} : {} : {}", tag[0], tag[1], tag[2], tag[3]);
+    dbgln_if(GHASH_PROCESS_DEBUG, "Tag bits: {} : {} : {} : {}", m_tag[0], m_tag[1], m_tag[2], m_tag[3]);
 
-    galois_multiply(tag, m_key, tag);
+    galois_multiply(m_tag, m_key, m_tag);
 
     TagType digest;
-    to_u8s(digest.data, tag);
+    to_u8s(digest.data, m_tag);
 
     return digest;
 }
@@ -94,6 +213,13 @@ GHash::TagType GHash::process(ReadonlyBytes aad, ReadonlyBytes cipher)
 /// Note that x, y, and z are strictly BE.
 void galois_multiply(u32 (&z)[4], const u32 (&_x)[4], const u32 (&_y)[4])
 {
+#if ARCH(X86_64)
+    if (cpu_supports_pclmul()) {
+        galois_multiply_pclmul(z, _x, _y);
+        return;
+    }
+#endif
+
     u32 x[4] { _x[0], _x[1], _x[2], _x[3] };
     u32 y[4] { _y[0], _y[1], _y[2], _y[3] };
     __builtin_memset(z, 0, sizeof(z));
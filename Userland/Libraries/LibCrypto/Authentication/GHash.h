@@ -40,6 +40,11 @@ public:
         for (size_t i = 0; i < 16; i += 4) {
             m_key[i / 4] = AK::convert_between_host_and_big_endian(ByteReader::load32(key.offset(i)));
         }
+
+        // H^2, H^3 and H^4, so that four blocks can be multiplied independently and reduced together
+        galois_multiply(m_key_powers[0], m_key, m_key);
+        galois_multiply(m_key_powers[1], m_key_powers[0], m_key);
+        galois_multiply(m_key_powers[2], m_key_powers[1], m_key);
     }
 
     constexpr static size_t digest_size() { return TagType::Size; }
@@ -48,10 +53,18 @@ public:
 
     TagType process(ReadonlyBytes aad, ReadonlyBytes cipher);
 
+    // Incremental version of process(), for modes that authenticate the data while they produce it.
+    // Every update() must be a multiple of 16 bytes long, except for the last one of the AAD and of the ciphertext.
+    void reset();
+    void update(ReadonlyBytes);
+    TagType digest(u64 aad_size, u64 cipher_size);
+
 private:
     inline void transform(ReadonlyBytes, ReadonlyBytes);
 
     u32 m_key[4];
+    u32 m_key_powers[3][4];
+    u32 m_tag[4] { 0, 0, 0, 0 };
 };
 
 }
@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ByteReader.h>
+#include <AK/Endian.h>
+#include <LibCrypto/Authentication/Poly1305.h>
+
+namespace Crypto {
+namespace Authentication {
+
+ALWAYS_INLINE static u32 load_le32(u8 const* data)
+{
+    return AK::convert_between_host_and_little_endian(ByteReader::load32(data));
+}
+
+Poly1305::Poly1305(ReadonlyBytes key)
+{
+    VERIFY(key.size() == KeySize);
+
+    // r is "clamped" as described in section 2.5.1, and split into 26-bit limbs.
+    m_r[0] = load_le32(key.offset(0)) & 0x3ffffff;
+    m_r[1] = (load_le32(key.offset(3)) >> 2) & 0x3ffff03;
+    m_r[2] = (load_le32(key.offset(6)) >> 4) & 0x3ffc0ff;
+    m_r[3] = (load_le32(key.offset(9)) >> 6) & 0x3f03fff;
+    m_r[4] = (load_le32(key.offset(12)) >> 8) & 0x00fffff;
+
+    for (size_t i = 0; i < 4; ++i)
+        m_s[i] = load_le32(key.offset(16 + i * 4));
+}
+
+void Poly1305::process_blocks(ReadonlyBytes data, u32 high_bit)
+{
+    u32 r0 = m_r[0], r1 = m_r[1], r2 = m_r[2], r3 = m_r[3], r4 = m_r[4];
+    // 2^130 = 5 (mod 2^130 - 5), so the limbs that overflow past 2^130 wrap around multiplied by 5.
+    u32 s1 = r1 * 5, s2 = r2 * 5, s3 = r3 * 5, s4 = r4 * 5;
+    u32 h0 = m_accumulator[0], h1 = m_accumulator[1], h2 = m_accumulator[2], h3 = m_accumulator[3], h4 = m_accumulator[4];
+
+    for (size_t offset = 0; offset + BlockSize <= data.size(); offset += BlockSize) {
+        auto const* block = data.offset_pointer(offset);
+
+        // h += m[i]
+        h0 += load_le32(block + 0) & 0x3ffffff;
+        h1 += (load_le32(block + 3) >> 2) & 0x3ffffff;
+        h2 += (load_le32(block + 6) >> 4) & 0x3ffffff;
+        h3 += (load_le32(block + 9) >> 6) & 0x3ffffff;
+        h4 += (load_le32(block + 12) >> 8) | high_bit;
+
+        // h *= r
+        u64 d0 = (u64)h0 * r0 + (u64)h1 * s4 + (u64)h2 * s3 + (u64)h3 * s2 + (u64)h4 * s1;
+        u64 d1 = (u64)h0 * r1 + (u64)h1 * r0 + (u64)h2 * s4 + (u64)h3 * s3 + (u64)h4 * s2;
+        u64 d2 = (u64)h0 * r2 + (u64)h1 * r1 + (u64)h2 * r0 + (u64)h3 * s4 + (u64)h4 * s3;
+        u64 d3 = (u64)h0 * r3 + (u64)h1 * r2 + (u64)h2 * r1 + (u64)h3 * r0 + (u64)h4 * s4;
+        u64 d4 = (u64)h0 * r4 + (u64)h1 * r3 + (u64)h2 * r2 + (u64)h3 * r1 + (u64)h4 * r0;
+
+        // (partial) h %= p
+        u32 carry = (u32)(d0 >> 26);
+        h0 = (u32)d0 & 0x3ffffff;
+        d1 += carry;
+        carry = (u32)(d1 >> 26);
+        h1 = (u32)d1 & 0x3ffffff;
+        d2 += carry;
+        carry = (u32)(d2 >> 26);
+        h2 = (u32)d2 & 0x3ffffff;
+        d3 += carry;
+        carry = (u32)(d3 >> 26);
+        h3 = (u32)d3 & 0x3ffffff;
+        d4 += carry;
+        carry = (u32)(d4 >> 26);
+        h4 = (u32)d4 & 0x3ffffff;
+        h0 += carry * 5;
+        carry = h0 >> 26;
+        h0 &= 0x3ffffff;
+        h1 += carry;
+    }
+
+    m_accumulator[0] = h0;
+    m_accumulator[1] = h1;
+    m_accumulator[2] = h2;
+    m_accumulator[3] = h3;
+    m_accumulator[4] = h4;
+}
+
+void Poly1305::update(ReadonlyBytes data)
+{
+    if (m_buffer_used) {
+        auto count = min(BlockSize - m_buffer_used, data.size());
+        __builtin_memcpy(m_buffer + m_buffer_used, data.data(), count);
+        m_buffer_used += count;
+        data = data.slice(count);
+        if (m_buffer_used < BlockSize)
+            return;
+        process_blocks({ m_buffer, BlockSize }, 1 << 24);
+        m_buffer_used = 0;
+    }
+
+    auto whole_blocks_size = data.size() - data.size() % BlockSize;
+    process_blocks(data.trim(whole_blocks_size), 1 << 24);
+
+    m_buffer_used = data.size() - whole_blocks_size;
+    __builtin_memcpy(m_buffer, data.offset_pointer(whole_blocks_size), m_buffer_used);
+}
+
+Poly1305::TagType Poly1305::digest()
+{
+    // The final partial block is padded with a one byte followed by zeroes, instead of getting the 2^128 bit.
+    if (m_buffer_used) {
+        m_buffer[m_buffer_used] = 1;
+        __builtin_memset(m_buffer + m_buffer_used + 1, 0, BlockSize - m_buffer_used - 1);
+        process_blocks({ m_buffer, BlockSize }, 0);
+        m_buffer_used = 0;
+    }
+
+    u32 h0 = m_accumulator[0], h1 = m_accumulator[1], h2 = m_accumulator[2], h3 = m_accumulator[3], h4 = m_accumulator[4];
+
+    // Fully carry h
+    u32 carry = h1 >> 26;
+    h1 &= 0x3ffffff;
+    h2 += carry;
+    carry = h2 >> 26;
+    h2 &= 0x3ffffff;
+    h3 += carry;
+    carry = h3 >> 26;
+    h3 &= 0x3ffffff;
+    h4 += carry;
+    carry = h4 >> 26;
+    h4 &= 0x3ffffff;
+    h0 += carry * 5;
+    carry = h0 >> 26;
+    h0 &= 0x3ffffff;
+    h1 += carry;
+
+    // Compute h - p, and select it in constant time if it didn't underflow.
+    u32 g0 = h0 + 5;
+    carry = g0 >> 26;
+    g0 &= 0x3ffffff;
+    u32 g1 = h1 + carry;
+    carry = g1 >> 26;
+    g1 &= 0x3ffffff;
+    u32 g2 = h2 + carry;
+    carry = g2 >> 26;
+    g2 &= 0x3ffffff;
+    u32 g3 = h3 + carry;
+    carry = g3 >> 26;
+    g3 &= 0x3ffffff;
+    u32 g4 = h4 + carry - (1 << 26);
+
+    u32 mask = (g4 >> 31) - 1;
+    h0 = (h0 & ~mask) | (g0 & mask);
+    h1 = (h1 & ~mask) | (g1 & mask);
+    h2 = (h2 & ~mask) | (g2 & mask);
+    h3 = (h3 & ~mask) | (g3 & mask);
+    h4 = (h4 & ~mask) | (g4 & mask);
+
+    // h = h % 2^128, repacked into 32-bit words
+    u32 words[4] = {
+        h0 | (h1 << 26),
+        (h1 >> 6) | (h2 << 20),
+        (h2 >> 12) | (h3 << 14),
+        (h3 >> 18) | (h4 << 8),
+    };
+
+    // tag = (h + s) % 2^128
+    TagType tag;
+    u64 sum = 0;
+    for (size_t i = 0; i < 4; ++i) {
+        sum += (u64)words[i] + m_s[i];
+        ByteReader::store(tag.data() + i * 4, AK::convert_between_host_and_little_endian((u32)sum));
+        sum >>= 32;
+    }
+    return tag;
+}
+
+}
+}
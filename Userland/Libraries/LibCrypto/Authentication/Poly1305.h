@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Array.h>
+#include <AK/Span.h>
+#include <AK/String.h>
+#include <AK/Types.h>
+
+namespace Crypto {
+namespace Authentication {
+
+// RFC 8439 section 2.5: The Poly1305 one-time authenticator. A key must never be used for more than one message.
+class Poly1305 final {
+public:
+    constexpr static size_t KeySize = 32;
+    constexpr static size_t BlockSize = 16;
+    constexpr static size_t TagSize = 16;
+    using TagType = Array<u8, TagSize>;
+
+    explicit Poly1305(ReadonlyBytes key);
+
+    constexpr static size_t digest_size() { return TagSize; }
+
+    String class_name() const { return "Poly1305"; }
+
+    void update(ReadonlyBytes);
+    TagType digest();
+
+private:
+    void process_blocks(ReadonlyBytes, u32 high_bit);
+
+    // The accumulator and r are kept in 26-bit limbs, so that the products fit in 64 bits on every platform.
+    u32 m_r[5];
+    u32 m_accumulator[5] { 0, 0, 0, 0, 0 };
+    u32 m_s[4];
+    u8 m_buffer[BlockSize];
+    size_t m_buffer_used { 0 };
+};
+
+}
+}
@@ -6,6 +6,7 @@
  */
 
 #include "UnsignedBigIntegerAlgorithms.h"
+#include <AK/BuiltinWrappers.h>
 
 namespace Crypto {
 
@@ -70,42 +71,21 @@ ALWAYS_INLINE static u32 inverse_wrapped(u32 value)
     return static_cast<u32>(-k0);
 }
 
-/**
- * Computes z = x * y + c. z_carry contains the top bits, z contains the bottom bits.
- */
-ALWAYS_INLINE static void linear_multiplication_with_carry(u32 x, u32 y, u32 c, u32& z_carry, u32& z)
-{
-    u64 result = static_cast<u64>(x) * static_cast<u64>(y) + static_cast<u64>(c);
-    z_carry = static_cast<u32>(result >> 32);
-    z = static_cast<u32>(result);
-}
-
-/**
- * Computes z = a + b. z_carry contains the top bit (1 or 0), z contains the bottom bits.
- */
-ALWAYS_INLINE static void addition_with_carry(u32 a, u32 b, u32& z_carry, u32& z)
-{
-    u64 result = static_cast<u64>(a) + static_cast<u64>(b);
-    z_carry = static_cast<u32>(result >> 32);
-    z = static_cast<u32>(result);
-}
-
 /**
  * Computes a montgomery "fragment" for y_i. This computes "z[i] += x[i] * y_i" for all words while rippling the carry, and returns the carry.
  * Algorithm from: Gueron, "Efficient Software Implementations of Modular Exponentiation". (https://eprint.iacr.org/2011/239.pdf)
  */
 UnsignedBigInteger::Word UnsignedBigIntegerAlgorithms::montgomery_fragment(UnsignedBigInteger& z, size_t offset_in_z, UnsignedBigInteger const& x, UnsignedBigInteger::Word y_digit, size_t num_words)
 {
-    UnsignedBigInteger::Word carry { 0 };
+    // Note: The callers have already checked that both x and z are long enough, so skip the bounds checks in this hot loop.
+    auto* z_words = z.m_words.data() + offset_in_z;
+    auto const* x_words = x.m_words.data();
+    // Note: x[i] * y_i + z[i] + carry can never overflow 64 bits, as (2^32 - 1)^2 + 2 * (2^32 - 1) = 2^64 - 1.
+    u64 carry { 0 };
     for (size_t i = 0; i < num_words; ++i) {
-        UnsignedBigInteger::Word a_carry;
-        UnsignedBigInteger::Word a;
-        linear_multiplication_with_carry(x.m_words[i], y_digit, z.m_words[offset_in_z + i], a_carry, a);
-        UnsignedBigInteger::Word b_carry;
-        UnsignedBigInteger::Word b;
-        addition_with_carry(a, carry, b_carry, b);
-        z.m_words[offset_in_z + i] = b;
-        carry = a_carry + b_carry;
+        carry += static_cast<u64>(x_words[i]) * y_digit + z_words[i];
+        z_words[i] = static_cast<UnsignedBigInteger::Word>(carry);
+        carry >>= UnsignedBigInteger::BITS_IN_WORD;
     }
     return carry;
 }
@@ -178,9 +158,33 @@ void UnsignedBigIntegerAlgorithms::almost_montgomery_multiplication_without_allo
     result.resize_with_leading_zeros(num_words);
 }
 
+/**
+ * Picks the sliding window size that minimizes the number of multiplications for an exponent of the given length.
+ * Thresholds from: Menezes, van Oorschot, Vanstone, "Handbook of Applied Cryptography", table 14.16.
+ */
+static size_t window_size_for_exponent(size_t exponent_bits)
+{
+    if (exponent_bits > 671)
+        return 6;
+    if (exponent_bits > 239)
+        return 5;
+    if (exponent_bits > 79)
+        return 4;
+    if (exponent_bits > 23)
+        return 3;
+    return 1;
+}
+
+ALWAYS_INLINE static bool exponent_bit(UnsignedBigInteger const& exponent, size_t bit)
+{
+    return (exponent.words()[bit / UnsignedBigInteger::BITS_IN_WORD] >> (bit % UnsignedBigInteger::BITS_IN_WORD)) & 1;
+}
+
 /**
  * Complexity: still O(N^3) with N the number of words in the largest word, but less complex than the classical mod power.
  * Note: the montgomery multiplications requires an inverse modulo over 2^32, which is only defined for odd numbers.
+ * The exponent is scanned from the top with a sliding window, so only the odd powers of the base need to be precomputed,
+ * and runs of zero bits only cost a squaring each.
  */
 void UnsignedBigIntegerAlgorithms::montgomery_modular_power_with_minimal_allocations(
     UnsignedBigInteger const& base,
@@ -197,9 +201,7 @@ void UnsignedBigIntegerAlgorithms::montgomery_modular_power_with_minimal_allocat
 {
     VERIFY(modulo.is_odd());
 
-    // Note: While this is a constexpr variable for clarity and could be changed in theory,
-    // various optimized parts of the algorithm rely on this value being exactly 4.
-    constexpr size_t window_size = 4;
+    constexpr size_t max_window_size = 6;
 
     size_t num_words = modulo.trimmed_length();
     UnsignedBigInteger::Word k = inverse_wrapped(modulo.m_words[0]);
@@ -220,39 +222,58 @@ void UnsignedBigIntegerAlgorithms::montgomery_modular_power_with_minimal_allocat
     one.set_to(1);
     one.resize_with_leading_zeros(num_words);
 
-    // Compute the montgomery powers from 0 to 2^window_size. powers[i] = x^i
-    UnsignedBigInteger powers[1 << window_size];
-    almost_montgomery_multiplication_without_allocation(one, rr, modulo, temp_z, k, num_words, powers[0]);
-    almost_montgomery_multiplication_without_allocation(x, rr, modulo, temp_z, k, num_words, powers[1]);
-    for (size_t i = 2; i < (1 << window_size); ++i)
-        almost_montgomery_multiplication_without_allocation(powers[i - 1], powers[1], modulo, temp_z, k, num_words, powers[i]);
+    size_t exponent_bits = 0;
+    if (auto exponent_length = exponent.trimmed_length(); exponent_length > 0)
+        exponent_bits = exponent_length * UnsignedBigInteger::BITS_IN_WORD - count_leading_zeroes(exponent.m_words[exponent_length - 1]);
+    size_t window_size = window_size_for_exponent(exponent_bits);
+
+    // Compute the odd montgomery powers below 2^window_size. powers[i] = x^(2 * i + 1)
+    UnsignedBigInteger powers[1 << (max_window_size - 1)];
+    almost_montgomery_multiplication_without_allocation(x, rr, modulo, temp_z, k, num_words, powers[0]);
+    almost_montgomery_multiplication_without_allocation(powers[0], powers[0], modulo, temp_z, k, num_words, temp_extra);
+    for (size_t i = 1; i < (1u << (window_size - 1)); ++i)
+        almost_montgomery_multiplication_without_allocation(powers[i - 1], temp_extra, modulo, temp_z, k, num_words, powers[i]);
 
-    z.set_to(powers[0]);
-    z.resize_with_leading_zeros(num_words);
+    // z = 1, in montgomery form
+    almost_montgomery_multiplication_without_allocation(one, rr, modulo, temp_z, k, num_words, z);
     zz.set_to(0);
     zz.resize_with_leading_zeros(num_words);
 
-    ssize_t exponent_length = exponent.trimmed_length();
-    for (ssize_t word_in_exponent = exponent_length - 1; word_in_exponent >= 0; --word_in_exponent) {
-        UnsignedBigInteger::Word exponent_word = exponent.m_words[word_in_exponent];
-        size_t bit_in_word = 0;
-        while (bit_in_word < UnsignedBigInteger::BITS_IN_WORD) {
-            if (word_in_exponent != exponent_length - 1 || bit_in_word != 0) {
+    bool z_is_one = true;
+    ssize_t bit = static_cast<ssize_t>(exponent_bits) - 1;
+    while (bit >= 0) {
+        if (!exponent_bit(exponent, bit)) {
+            if (!z_is_one) {
                 almost_montgomery_multiplication_without_allocation(z, z, modulo, temp_z, k, num_words, zz);
-                almost_montgomery_multiplication_without_allocation(zz, zz, modulo, temp_z, k, num_words, z);
+                swap(z, zz);
+            }
+            --bit;
+            continue;
+        }
+
+        // Find the longest window of at most window_size bits that starts at this bit and ends in a set bit.
+        ssize_t window_end = max<ssize_t>(bit - static_cast<ssize_t>(window_size) + 1, 0);
+        while (!exponent_bit(exponent, window_end))
+            ++window_end;
+
+        size_t window_value = 0;
+        for (ssize_t i = bit; i >= window_end; --i)
+            window_value = (window_value << 1) | exponent_bit(exponent, i);
+
+        auto& power = powers[window_value >> 1];
+        if (z_is_one) {
+            z.set_to(power);
+            z_is_one = false;
+        } else {
+            for (ssize_t i = bit; i >= window_end; --i) {
                 almost_montgomery_multiplication_without_allocation(z, z, modulo, temp_z, k, num_words, zz);
-                almost_montgomery_multiplication_without_allocation(zz, zz, modulo, temp_z, k, num_words, z);
+                swap(z, zz);
             }
-            auto power_index = exponent_word >> (UnsignedBigInteger::BITS_IN_WORD - window_size);
-            auto& power = powers[power_index];
             almost_montgomery_multiplication_without_allocation(z, power, modulo, temp_z, k, num_words, zz);
-
             swap(z, zz);
-
-            // Move to the next window
-            exponent_word <<= window_size;
-            bit_in_word += window_size;
         }
+
+        bit = window_end - 1;
     }
 
     almost_montgomery_multiplication_without_allocation(z, one, modulo, temp_z, k, num_words, zz);
@@ -9,13 +9,134 @@
 
 namespace Crypto {
 
+using Word = UnsignedBigInteger::Word;
+
+// Below this many words, the extra additions of Karatsuba cost more than the multiplications they save.
+static constexpr size_t karatsuba_threshold = 32;
+static_assert(karatsuba_threshold >= 4);
+
+/**
+ * Computes output[0..length) += value[0..length) and returns the carry out of the top word.
+ */
+ALWAYS_INLINE static Word add_words(Word* output, Word const* value, size_t length)
+{
+    u64 carry = 0;
+    for (size_t i = 0; i < length; ++i) {
+        carry += static_cast<u64>(output[i]) + value[i];
+        output[i] = static_cast<Word>(carry);
+        carry >>= UnsignedBigInteger::BITS_IN_WORD;
+    }
+    return static_cast<Word>(carry);
+}
+
+/**
+ * Computes output[0..length) -= value[0..length) and returns the borrow out of the top word.
+ */
+ALWAYS_INLINE static Word subtract_words(Word* output, Word const* value, size_t length)
+{
+    Word borrow = 0;
+    for (size_t i = 0; i < length; ++i) {
+        u64 difference = static_cast<u64>(output[i]) - value[i] - borrow;
+        output[i] = static_cast<Word>(difference);
+        borrow = static_cast<Word>(difference >> 63);
+    }
+    return borrow;
+}
+
+/**
+ * Adds carry into output[0..length), rippling it upwards until it is absorbed.
+ */
+ALWAYS_INLINE static void propagate_carry(Word* output, size_t length, Word carry)
+{
+    for (size_t i = 0; carry && i < length; ++i) {
+        output[i] += carry;
+        carry = output[i] < carry ? 1 : 0;
+    }
+}
+
+/**
+ * Complexity: O(N*M) where N and M are the number of words in the operands
+ * Writes the left_length + right_length words of the product to output.
+ */
+static void schoolbook_multiply(Word const* left, size_t left_length, Word const* right, size_t right_length, Word* output)
+{
+    __builtin_memset(output, 0, (left_length + right_length) * sizeof(Word));
+    for (size_t i = 0; i < left_length; ++i) {
+        u64 carry = 0;
+        u64 left_word = left[i];
+        for (size_t j = 0; j < right_length; ++j) {
+            carry += left_word * right[j] + output[i + j];
+            output[i + j] = static_cast<Word>(carry);
+            carry >>= UnsignedBigInteger::BITS_IN_WORD;
+        }
+        output[i + right_length] = static_cast<Word>(carry);
+    }
+}
+
+static constexpr size_t karatsuba_scratch_size(size_t length)
+{
+    if (length < karatsuba_threshold)
+        return 0;
+    size_t half_length = length - length / 2 + 1;
+    return 4 * half_length + karatsuba_scratch_size(half_length);
+}
+
 /**
- * Complexity: O(N^2) where N is the number of words in the larger number
+ * Complexity: O(N^1.58) where N is the number of words in each operand
+ * Multiplies two numbers of the same length, writing the 2 * length words of the product to output.
+ * Splitting x = x1 * B + x0 and y = y1 * B + y0, the product is
+ *   z2 * B^2 + ((x0 + x1) * (y0 + y1) - z2 - z0) * B + z0, with z2 = x1 * y1 and z0 = x0 * y0,
+ * which only needs three half-sized multiplications instead of four.
+ */
+static void karatsuba_multiply(Word const* left, Word const* right, size_t length, Word* output, Word* scratch)
+{
+    if (length < karatsuba_threshold) {
+        schoolbook_multiply(left, length, right, length, output);
+        return;
+    }
+
+    size_t low_length = length / 2;
+    size_t high_length = length - low_length;
+    size_t sum_length = high_length + 1;
+
+    // z0 and z2 go straight into their final position in the output.
+    karatsuba_multiply(left, right, low_length, output, scratch);
+    karatsuba_multiply(left + low_length, right + low_length, high_length, output + 2 * low_length, scratch);
+
+    Word* left_sum = scratch;
+    Word* right_sum = left_sum + sum_length;
+    Word* middle = right_sum + sum_length;
+    Word* next_scratch = middle + 2 * sum_length;
+
+    __builtin_memcpy(left_sum, left + low_length, high_length * sizeof(Word));
+    left_sum[high_length] = 0;
+    propagate_carry(left_sum + low_length, sum_length - low_length, add_words(left_sum, left, low_length));
+
+    __builtin_memcpy(right_sum, right + low_length, high_length * sizeof(Word));
+    right_sum[high_length] = 0;
+    propagate_carry(right_sum + low_length, sum_length - low_length, add_words(right_sum, right, low_length));
+
+    karatsuba_multiply(left_sum, right_sum, sum_length, middle, next_scratch);
+
+    // middle = (x0 + x1) * (y0 + y1) - z0 - z2, which can never go negative.
+    auto borrow = subtract_words(middle, output, 2 * low_length);
+    for (size_t i = 2 * low_length; borrow && i < 2 * sum_length; ++i)
+        borrow = middle[i]-- == 0 ? 1 : 0;
+    borrow = subtract_words(middle, output + 2 * low_length, 2 * high_length);
+    for (size_t i = 2 * high_length; borrow && i < 2 * sum_length; ++i)
+        borrow = middle[i]-- == 0 ? 1 : 0;
+
+    // The full product fits in 2 * length words, so anything past that is zero.
+    size_t middle_length = min(2 * sum_length, 2 * length - low_length);
+    propagate_carry(output + low_length + middle_length, 2 * length - low_length - middle_length, add_words(output + low_length, middle, middle_length));
+}
+
+/**
+ * Complexity: O(N^2) where N is the number of words in the larger number, O(N^1.58) once both are at least karatsuba_threshold words long
  * Multiplication method:
- * An integer is equal to the sum of the powers of two
- * according to the indices of its 'on' bits.
- * So to multiple x*y, we go over each '1' bit in x (say the i'th bit),
- * and add y<<i to the result.
+ * Small operands use the schoolbook method, multiplying word by word with 64-bit intermediate products.
+ * Larger operands use Karatsuba multiplication, cutting the longer operand into chunks as long as the shorter one.
+ * The temporaries provide the scratch space for the intermediate results.
  */
 FLATTEN void UnsignedBigIntegerAlgorithms::multiply_without_allocation(
     UnsignedBigInteger const& left,
@@ -27,19 +148,50 @@ FLATTEN void UnsignedBigIntegerAlgorithms::multiply_without_allocation(
 {
     output.set_to_0();
 
-    // iterate all bits
-    for (size_t word_index = 0; word_index < left.length(); ++word_index) {
-        for (size_t bit_index = 0; bit_index < UnsignedBigInteger::BITS_IN_WORD; ++bit_index) {
-            // If the bit is off - skip over it
-            if (!(left.m_words[word_index] & (1 << bit_index)))
-                continue;
+    UnsignedBigInteger const* longer = &left;
+    UnsignedBigInteger const* shorter = &right;
+    if (longer->trimmed_length() < shorter->trimmed_length())
+        swap(longer, shorter);
 
-            size_t shift_amount = word_index * UnsignedBigInteger::BITS_IN_WORD + bit_index;
+    size_t longer_length = longer->trimmed_length();
+    size_t shorter_length = shorter->trimmed_length();
+    if (shorter_length == 0)
+        return;
 
-            // output += (right << shift_amount);
-            shift_left_without_allocation(right, shift_amount, temp_shift_result, temp_shift_plus, temp_shift);
-            add_into_accumulator_without_allocation(output, temp_shift);
+    output.m_words.resize_and_keep_capacity(longer_length + shorter_length);
+    Word* output_words = output.m_words.data();
+
+    if (shorter_length < karatsuba_threshold) {
+        schoolbook_multiply(longer->m_words.data(), longer_length, shorter->m_words.data(), shorter_length, output_words);
+        return;
+    }
+
+    temp_shift_result.set_to_0();
+    temp_shift_result.m_words.resize_and_keep_capacity(karatsuba_scratch_size(shorter_length));
+    temp_shift_plus.set_to_0();
+    temp_shift_plus.m_words.resize_and_keep_capacity(2 * shorter_length);
+    temp_shift.set_to_0();
+    temp_shift.m_words.resize_and_keep_capacity(shorter_length);
+
+    Word* scratch = temp_shift_result.m_words.data();
+    Word* chunk_product = temp_shift_plus.m_words.data();
+    Word* padded_chunk = temp_shift.m_words.data();
+
+    __builtin_memset(output_words, 0, (longer_length + shorter_length) * sizeof(Word));
+    for (size_t offset = 0; offset < longer_length; offset += shorter_length) {
+        size_t chunk_length = min(shorter_length, longer_length - offset);
+        Word const* chunk = longer->m_words.data() + offset;
+        if (chunk_length < shorter_length) {
+            __builtin_memcpy(padded_chunk, chunk, chunk_length * sizeof(Word));
+            __builtin_memset(padded_chunk + chunk_length, 0, (shorter_length - chunk_length) * sizeof(Word));
+            chunk = padded_chunk;
         }
+        karatsuba_multiply(chunk, shorter->m_words.data(), shorter_length, chunk_product, scratch);
+
+        // output += chunk_product << (offset words)
+        size_t product_length = chunk_length + shorter_length;
+        auto carry = add_words(output_words + offset, chunk_product, product_length);
+        propagate_carry(output_words + offset + product_length, longer_length + shorter_length - offset - product_length, carry);
     }
 }
 
@@ -15,7 +15,7 @@
 namespace Crypto {
 
 struct UnsignedDivisionResult;
-constexpr size_t STARTING_WORD_SIZE = 32;
+constexpr size_t STARTING_WORD_SIZE = 64;
 
 class UnsignedBigInteger {
 public:
@@ -4,17 +4,97 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Platform.h>
 #include <AK/Span.h>
 #include <AK/Types.h>
 #include <LibCrypto/Checksum/Adler32.h>
 
+#if ARCH(X86_64)
+#    include <immintrin.h>
+#endif
+
 namespace Crypto::Checksum {
 
+static constexpr u32 modulus = 65521;
+
+// The largest number of bytes that can be summed up before the sums have to be reduced, so that they don't overflow
+static constexpr size_t max_bytes_per_reduction = 5552;
+
+#if ARCH(X86_64)
+static constexpr size_t bytes_per_vector_block = 32;
+
+// Sums up 32 bytes per iteration, where the contribution of every byte to b is weighted by its distance from the end of the block.
+// The size has to be a multiple of 32.
+[[gnu::target("ssse3")]] static void update_ssse3(u32& a, u32& b, u8 const* data, size_t size)
+{
+    VERIFY(size % bytes_per_vector_block == 0);
+
+    auto const weights_1 = _mm_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17);
+    auto const weights_2 = _mm_setr_epi8(16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+    auto const zero = _mm_setzero_si128();
+    auto const ones = _mm_set1_epi16(1);
+
+    auto remaining_blocks = size / bytes_per_vector_block;
+    while (remaining_blocks > 0) {
+        auto blocks = min(remaining_blocks, max_bytes_per_reduction / bytes_per_vector_block);
+        remaining_blocks -= blocks;
+
+        // a is added to b once for every byte
+        auto previous_a_sums = _mm_setr_epi32(static_cast<int>(a * blocks), 0, 0, 0);
+        auto a_sums = zero;
+        auto b_sums = _mm_setr_epi32(static_cast<int>(b), 0, 0, 0);
+
+        for (; blocks > 0; blocks--, data += bytes_per_vector_block) {
+            auto const bytes_1 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(data));
+            auto const bytes_2 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(data + 16));
+
+            previous_a_sums = _mm_add_epi32(previous_a_sums, a_sums);
+            a_sums = _mm_add_epi32(a_sums, _mm_sad_epu8(bytes_1, zero));
+            a_sums = _mm_add_epi32(a_sums, _mm_sad_epu8(bytes_2, zero));
+            b_sums = _mm_add_epi32(b_sums, _mm_madd_epi16(_mm_maddubs_epi16(bytes_1, weights_1), ones));
+            b_sums = _mm_add_epi32(b_sums, _mm_madd_epi16(_mm_maddubs_epi16(bytes_2, weights_2), ones));
+        }
+
+        b_sums = _mm_add_epi32(b_sums, _mm_slli_epi32(previous_a_sums, 5));
+
+        a_sums = _mm_add_epi32(a_sums, _mm_shuffle_epi32(a_sums, _MM_SHUFFLE(1, 0, 3, 2)));
+        b_sums = _mm_add_epi32(b_sums, _mm_shuffle_epi32(b_sums, _MM_SHUFFLE(2, 3, 0, 1)));
+        b_sums = _mm_add_epi32(b_sums, _mm_shuffle_epi32(b_sums, _MM_SHUFFLE(1, 0, 3, 2)));
+
+        a = (a + static_cast<u32>(_mm_cvtsi128_si32(a_sums))) % modulus;
+        b = static_cast<u32>(_mm_cvtsi128_si32(b_sums)) % modulus;
+    }
+}
+
+static bool cpu_supports_ssse3()
+{
+    static bool const supported = [] {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("ssse3");
+    }();
+    return supported;
+}
+#endif
+
 void Adler32::update(ReadonlyBytes data)
 {
-    for (size_t i = 0; i < data.size(); i++) {
-        m_state_a = (m_state_a + data.at(i)) % 65521;
-        m_state_b = (m_state_b + m_state_a) % 65521;
+#if ARCH(X86_64)
+    if (data.size() >= bytes_per_vector_block && cpu_supports_ssse3()) {
+        auto const vector_size = data.size() - data.size() % bytes_per_vector_block;
+        update_ssse3(m_state_a, m_state_b, data.data(), vector_size);
+        data = data.slice(vector_size);
+    }
+#endif
+
+    while (!data.is_empty()) {
+        auto const chunk = data.trim(max_bytes_per_reduction);
+        for (auto byte : chunk) {
+            m_state_a += byte;
+            m_state_b += m_state_a;
+        }
+        m_state_a %= modulus;
+        m_state_b %= modulus;
+        data = data.slice(chunk.size());
     }
 };
 
@@ -4,17 +4,152 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Array.h>
+#include <AK/Endian.h>
+#include <AK/Platform.h>
 #include <AK/Span.h>
 #include <AK/Types.h>
 #include <LibCrypto/Checksum/CRC32.h>
+#include <string.h>
+
+#if ARCH(X86_64)
+#    include <immintrin.h>
+#endif
 
 namespace Crypto::Checksum {
 
+static constexpr u32 polynomial = 0xEDB88320;
+
+// The tables for slicing-by-8, where tables[n][byte] is the CRC of the byte followed by n zero bytes.
+static consteval Array<Array<u32, 256>, 8> generate_tables()
+{
+    Array<Array<u32, 256>, 8> tables {};
+
+    for (u32 i = 0; i < 256; i++) {
+        u32 value = i;
+
+        for (auto j = 0; j < 8; j++) {
+            if (value & 1) {
+                value = polynomial ^ (value >> 1);
+            } else {
+                value = value >> 1;
+            }
+        }
+
+        tables[0][i] = value;
+    }
+
+    for (size_t n = 1; n < tables.size(); n++) {
+        for (u32 i = 0; i < 256; i++)
+            tables[n][i] = (tables[n - 1][i] >> 8) ^ tables[0][tables[n - 1][i] & 0xFF];
+    }
+
+    return tables;
+}
+
+static constexpr auto tables = generate_tables();
+
+static u32 update_slicing_by_8(u32 state, ReadonlyBytes data)
+{
+    auto const* bytes = data.data();
+    auto size = data.size();
+
+    for (; size >= 8; bytes += 8, size -= 8) {
+        u32 low;
+        u32 high;
+        memcpy(&low, bytes, sizeof(low));
+        memcpy(&high, bytes + sizeof(low), sizeof(high));
+        low = AK::convert_between_host_and_little_endian(low) ^ state;
+        high = AK::convert_between_host_and_little_endian(high);
+
+        state = tables[7][low & 0xFF] ^ tables[6][(low >> 8) & 0xFF] ^ tables[5][(low >> 16) & 0xFF] ^ tables[4][low >> 24]
+            ^ tables[3][high & 0xFF] ^ tables[2][(high >> 8) & 0xFF] ^ tables[1][(high >> 16) & 0xFF] ^ tables[0][high >> 24];
+    }
+
+    for (; size > 0; bytes++, size--)
+        state = tables[0][(state ^ *bytes) & 0xFF] ^ (state >> 8);
+
+    return state;
+}
+
+#if ARCH(X86_64)
+[[gnu::target("pclmul,sse4.1")]] ALWAYS_INLINE static __m128i fold_16_bytes(__m128i value, __m128i constants, __m128i next)
+{
+    auto const low = _mm_clmulepi64_si128(value, constants, 0x00);
+    auto const high = _mm_clmulepi64_si128(value, constants, 0x11);
+    return _mm_xor_si128(_mm_xor_si128(low, high), next);
+}
+
+// Folds the data into four 128-bit accumulators with carry-less multiplications, and then reduces those to the 32-bit CRC
+// with a Barrett reduction, as described in Intel's "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction".
+// The size has to be a multiple of 16 that is at least 64.
+[[gnu::target("pclmul,sse4.1")]] static u32 update_pclmul(u32 state, u8 const* data, size_t size)
+{
+    VERIFY(size >= 64 && size % 16 == 0);
+
+    auto const* blocks = reinterpret_cast<__m128i const*>(data);
+    auto x1 = _mm_xor_si128(_mm_loadu_si128(blocks), _mm_cvtsi32_si128(static_cast<int>(state)));
+    auto x2 = _mm_loadu_si128(blocks + 1);
+    auto x3 = _mm_loadu_si128(blocks + 2);
+    auto x4 = _mm_loadu_si128(blocks + 3);
+    blocks += 4;
+    size -= 64;
+
+    // x^(4*128+32) mod P and x^(4*128-32) mod P, bit-reflected
+    auto constants = _mm_set_epi64x(0x1c6e41596, 0x154442bd4);
+    for (; size >= 64; blocks += 4, size -= 64) {
+        x1 = fold_16_bytes(x1, constants, _mm_loadu_si128(blocks));
+        x2 = fold_16_bytes(x2, constants, _mm_loadu_si128(blocks + 1));
+        x3 = fold_16_bytes(x3, constants, _mm_loadu_si128(blocks + 2));
+        x4 = fold_16_bytes(x4, constants, _mm_loadu_si128(blocks + 3));
+    }
+
+    // x^(128+32) mod P and x^(128-32) mod P, bit-reflected
+    constants = _mm_set_epi64x(0x0ccaa009e, 0x1751997d0);
+    x1 = fold_16_bytes(x1, constants, x2);
+    x1 = fold_16_bytes(x1, constants, x3);
+    x1 = fold_16_bytes(x1, constants, x4);
+    for (; size >= 16; blocks++, size -= 16)
+        x1 = fold_16_bytes(x1, constants, _mm_loadu_si128(blocks));
+
+    // Fold 128 bits down to 64 bits, and then to 32 bits
+    auto const mask32 = _mm_setr_epi32(-1, 0, 0, 0);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), _mm_clmulepi64_si128(x1, constants, 0x10));
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask32), _mm_set_epi64x(0, 0x163cd6124), 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    // Barrett reduction with the polynomial and its reciprocal
+    constants = _mm_set_epi64x(0x1f7011641, 0x1db710641);
+    x2 = x1;
+    x1 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask32), constants, 0x10);
+    x1 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask32), constants, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    return static_cast<u32>(_mm_extract_epi32(x1, 1));
+}
+
+static bool cpu_supports_pclmul()
+{
+    static bool const supported = [] {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+    }();
+    return supported;
+}
+#endif
+
 void CRC32::update(ReadonlyBytes data)
 {
-    for (size_t i = 0; i < data.size(); i++) {
-        m_state = table[(m_state ^ data.at(i)) & 0xFF] ^ (m_state >> 8);
+#if ARCH(X86_64)
+    if (data.size() >= 64 && cpu_supports_pclmul()) {
+        auto const folded_size = data.size() & ~static_cast<size_t>(15);
+        m_state = update_pclmul(m_state, data.data(), folded_size);
+        data = data.slice(folded_size);
     }
+#endif
+
+    m_state = update_slicing_by_8(m_state, data);
 };
 
 u32 CRC32::digest()
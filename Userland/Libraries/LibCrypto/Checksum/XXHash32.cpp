@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ByteReader.h>
+#include <AK/Endian.h>
+#include <LibCrypto/Checksum/XXHash32.h>
+
+namespace Crypto::Checksum {
+
+static constexpr u32 prime_1 = 0x9E3779B1u;
+static constexpr u32 prime_2 = 0x85EBCA77u;
+static constexpr u32 prime_3 = 0xC2B2AE3Du;
+static constexpr u32 prime_4 = 0x27D4EB2Fu;
+static constexpr u32 prime_5 = 0x165667B1u;
+
+static constexpr u32 rotate_left(u32 value, size_t bits)
+{
+    return (value << bits) | (value >> (32 - bits));
+}
+
+static u32 read_u32(u8 const* data)
+{
+    u32 value;
+    ByteReader::load(data, value);
+    return AK::convert_between_host_and_little_endian(value);
+}
+
+static constexpr u32 round(u32 accumulator, u32 lane)
+{
+    return rotate_left(accumulator + lane * prime_2, 13) * prime_1;
+}
+
+XXHash32::XXHash32(u32 seed)
+    : m_seed(seed)
+    , m_accumulators { seed + prime_1 + prime_2, seed + prime_2, seed, seed - prime_1 }
+{
+}
+
+void XXHash32::update(ReadonlyBytes data)
+{
+    m_total_length += data.size();
+
+    auto consume_stripe = [this](u8 const* stripe) {
+        for (size_t i = 0; i < 4; ++i)
+            m_accumulators[i] = round(m_accumulators[i], read_u32(stripe + i * 4));
+    };
+
+    if (m_pending_size > 0) {
+        auto count = min(data.size(), stripe_size - m_pending_size);
+        data.trim(count).copy_to(m_pending.span().slice(m_pending_size));
+        m_pending_size += count;
+        data = data.slice(count);
+        if (m_pending_size < stripe_size)
+            return;
+        consume_stripe(m_pending.data());
+        m_pending_size = 0;
+    }
+
+    size_t offset = 0;
+    for (; offset + stripe_size <= data.size(); offset += stripe_size)
+        consume_stripe(data.offset_pointer(offset));
+
+    m_pending_size = data.slice(offset).copy_to(m_pending.span());
+}
+
+u32 XXHash32::digest()
+{
+    u32 hash;
+    if (m_total_length >= stripe_size)
+        hash = rotate_left(m_accumulators[0], 1) + rotate_left(m_accumulators[1], 7) + rotate_left(m_accumulators[2], 12) + rotate_left(m_accumulators[3], 18);
+    else
+        hash = m_seed + prime_5;
+    hash += static_cast<u32>(m_total_length);
+
+    size_t offset = 0;
+    for (; offset + 4 <= m_pending_size; offset += 4)
+        hash = rotate_left(hash + read_u32(m_pending.data() + offset) * prime_3, 17) * prime_4;
+    for (; offset < m_pending_size; ++offset)
+        hash = rotate_left(hash + m_pending[offset] * prime_5, 11) * prime_1;
+
+    hash ^= hash >> 15;
+    hash *= prime_2;
+    hash ^= hash >> 13;
+    hash *= prime_3;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+}
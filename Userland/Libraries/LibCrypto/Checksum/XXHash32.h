@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Array.h>
+#include <AK/Span.h>
+#include <AK/Types.h>
+#include <LibCrypto/Checksum/ChecksumFunction.h>
+
+namespace Crypto::Checksum {
+
+// xxHash32, as used by the LZ4 frame format (https://github.com/Cyan4973/xxHash/blob/dev/doc/xxhash_spec.md).
+class XXHash32 : public ChecksumFunction<u32> {
+public:
+    XXHash32(u32 seed = 0);
+    XXHash32(ReadonlyBytes data)
+        : XXHash32()
+    {
+        update(data);
+    }
+
+    virtual void update(ReadonlyBytes data) override;
+    virtual u32 digest() override;
+
+private:
+    static constexpr size_t stripe_size = 16;
+
+    u32 m_seed { 0 };
+    u32 m_accumulators[4];
+    u64 m_total_length { 0 };
+
+    // The input is consumed 16 bytes at a time, so whatever is left over from an update is kept until the next one.
+    Array<u8, stripe_size> m_pending {};
+    size_t m_pending_size { 0 };
+};
+
+}
@@ -4,10 +4,19 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/ByteReader.h>
+#include <AK/Endian.h>
+#include <AK/Platform.h>
 #include <AK/StringBuilder.h>
 #include <LibCrypto/Cipher/AES.h>
 #include <LibCrypto/Cipher/AESTables.h>
 
+// The kernel is built without SSE, so it always uses the table-based implementation.
+#if ARCH(X86_64) && !defined(KERNEL)
+#    define AES_HAS_AES_NI
+#    include <immintrin.h>
+#endif
+
 namespace Crypto {
 namespace Cipher {
 
@@ -24,6 +33,96 @@ constexpr void swap_keys(u32* keys, size_t i, size_t j)
     keys[j] = temp;
 }
 
+#ifdef AES_HAS_AES_NI
+static bool cpu_supports_aes_ni()
+{
+    static bool const supported = [] {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("aes");
+    }();
+    return supported;
+}
+
+// The round keys are stored as big-endian words, while AES-NI expects them in memory order.
+ALWAYS_INLINE static __m128i load_round_key(const u32* round_key)
+{
+    return _mm_setr_epi32(
+        static_cast<int>(__builtin_bswap32(round_key[0])),
+        static_cast<int>(__builtin_bswap32(round_key[1])),
+        static_cast<int>(__builtin_bswap32(round_key[2])),
+        static_cast<int>(__builtin_bswap32(round_key[3])));
+}
+
+[[gnu::target("aes")]] static void encrypt_block_aes_ni(const u32* round_keys, size_t rounds, const u8* in, u8* out)
+{
+    auto state = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in)), load_round_key(round_keys));
+    for (size_t i = 1; i < rounds; ++i)
+        state = _mm_aesenc_si128(state, load_round_key(round_keys + 4 * i));
+    state = _mm_aesenclast_si128(state, load_round_key(round_keys + 4 * rounds));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), state);
+}
+
+// The decryption key schedule is already in the form of the equivalent inverse cipher that AESDEC expects.
+[[gnu::target("aes")]] static void decrypt_block_aes_ni(const u32* round_keys, size_t rounds, const u8* in, u8* out)
+{
+    auto state = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in)), load_round_key(round_keys));
+    for (size_t i = 1; i < rounds; ++i)
+        state = _mm_aesdec_si128(state, load_round_key(round_keys + 4 * i));
+    state = _mm_aesdeclast_si128(state, load_round_key(round_keys + 4 * rounds));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), state);
+}
+
+// Encrypts eight counter blocks at a time, so that the latency of AESENC is hidden behind the other blocks.
+[[gnu::target("aes")]] static size_t encrypt_counter_mode_blocks_aes_ni(const u32* round_keys, size_t rounds, const u8* in, u8* out, size_t blocks, u8* counter_bytes)
+{
+    static constexpr size_t blocks_per_iteration = 8;
+    static constexpr size_t max_rounds = 14;
+
+    __m128i keys[max_rounds + 1];
+    for (size_t i = 0; i <= rounds; ++i)
+        keys[i] = load_round_key(round_keys + 4 * i);
+
+    u64 counter_high = AK::convert_between_host_and_big_endian(ByteReader::load64(counter_bytes));
+    u64 counter_low = AK::convert_between_host_and_big_endian(ByteReader::load64(counter_bytes + 8));
+    auto next_counter_block = [&] {
+        auto block = _mm_set_epi64x(static_cast<i64>(__builtin_bswap64(counter_low)), static_cast<i64>(__builtin_bswap64(counter_high)));
+        if (++counter_low == 0)
+            ++counter_high;
+        return block;
+    };
+
+    size_t processed_blocks = 0;
+    for (; blocks - processed_blocks >= blocks_per_iteration; processed_blocks += blocks_per_iteration) {
+        __m128i states[blocks_per_iteration];
+        for (auto& state : states)
+            state = _mm_xor_si128(next_counter_block(), keys[0]);
+        for (size_t round = 1; round < rounds; ++round) {
+            for (auto& state : states)
+                state = _mm_aesenc_si128(state, keys[round]);
+        }
+        for (size_t i = 0; i < blocks_per_iteration; ++i) {
+            auto offset = (processed_blocks + i) * 16;
+            auto input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + offset));
+            auto output = _mm_xor_si128(_mm_aesenclast_si128(states[i], keys[rounds]), input);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + offset), output);
+        }
+    }
+
+    for (; processed_blocks < blocks; ++processed_blocks) {
+        auto state = _mm_xor_si128(next_counter_block(), keys[0]);
+        for (size_t round = 1; round < rounds; ++round)
+            state = _mm_aesenc_si128(state, keys[round]);
+        auto offset = processed_blocks * 16;
+        auto input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + offset));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + offset), _mm_xor_si128(_mm_aesenclast_si128(state, keys[rounds]), input));
+    }
+
+    ByteReader::store(counter_bytes, AK::convert_between_host_and_big_endian(counter_high));
+    ByteReader::store(counter_bytes + 8, AK::convert_between_host_and_big_endian(counter_low));
+    return blocks * 16;
+}
+#endif
+
 String AESCipherBlock::to_string() const
 {
     StringBuilder builder;
@@ -203,6 +302,13 @@ void AESCipher::encrypt_block(const AESCipherBlock& in, AESCipherBlock& out)
     const auto& dec_key = key();
     const auto* round_keys = dec_key.round_keys();
 
+#ifdef AES_HAS_AES_NI
+    if (cpu_supports_aes_ni()) {
+        encrypt_block_aes_ni(round_keys, dec_key.rounds(), in.bytes().data(), out.bytes().data());
+        return;
+    }
+#endif
+
     s0 = get_key(in.bytes().offset_pointer(0)) ^ round_keys[0];
     s1 = get_key(in.bytes().offset_pointer(4)) ^ round_keys[1];
     s2 = get_key(in.bytes().offset_pointer(8)) ^ round_keys[2];
@@ -295,6 +401,13 @@ void AESCipher::decrypt_block(const AESCipherBlock& in, AESCipherBlock& out)
     const auto& dec_key = key();
     const auto* round_keys = dec_key.round_keys();
 
+#ifdef AES_HAS_AES_NI
+    if (cpu_supports_aes_ni()) {
+        decrypt_block_aes_ni(round_keys, dec_key.rounds(), in.bytes().data(), out.bytes().data());
+        return;
+    }
+#endif
+
     s0 = get_key(in.bytes().offset_pointer(0)) ^ round_keys[0];
     s1 = get_key(in.bytes().offset_pointer(4)) ^ round_keys[1];
     s2 = get_key(in.bytes().offset_pointer(8)) ^ round_keys[2];
@@ -376,6 +489,20 @@ void AESCipher::decrypt_block(const AESCipherBlock& in, AESCipherBlock& out)
     // clang-format on
 }
 
+size_t AESCipher::encrypt_counter_mode_blocks(ReadonlyBytes in, Bytes out, Bytes counter)
+{
+    VERIFY(in.size() <= out.size());
+    VERIFY(counter.size() == block_size());
+
+#ifdef AES_HAS_AES_NI
+    const auto& enc_key = m_key;
+    if (cpu_supports_aes_ni())
+        return encrypt_counter_mode_blocks_aes_ni(enc_key.round_keys(), enc_key.rounds(), in.data(), out.data(), in.size() / block_size(), counter.data());
+#endif
+
+    return 0;
+}
+
 void AESCipherBlock::overwrite(ReadonlyBytes bytes)
 {
     auto data = bytes.data();
@@ -110,6 +110,10 @@ public:
     virtual void encrypt_block(const BlockType& in, BlockType& out) override;
     virtual void decrypt_block(const BlockType& in, BlockType& out) override;
 
+    // Encrypts (or decrypts) the whole blocks of `in` in counter mode, starting at the big-endian `counter`, which is incremented for every block.
+    // Returns how many bytes were processed, which is zero if there is no faster way to do this than going block by block.
+    size_t encrypt_counter_mode_blocks(ReadonlyBytes in, Bytes out, Bytes counter);
+
     virtual String class_name() const override { return "AES"; }
 
 protected:
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ByteReader.h>
+#include <AK/Endian.h>
+#include <LibCrypto/Cipher/ChaCha20.h>
+
+namespace Crypto {
+namespace Cipher {
+
+static constexpr u32 rotate_left(u32 value, size_t bits)
+{
+    return (value << bits) | (value >> (32 - bits));
+}
+
+ALWAYS_INLINE static void quarter_round(u32 (&x)[16], size_t a, size_t b, size_t c, size_t d)
+{
+    x[a] += x[b];
+    x[d] = rotate_left(x[d] ^ x[a], 16);
+    x[c] += x[d];
+    x[b] = rotate_left(x[b] ^ x[c], 12);
+    x[a] += x[b];
+    x[d] = rotate_left(x[d] ^ x[a], 8);
+    x[c] += x[d];
+    x[b] = rotate_left(x[b] ^ x[c], 7);
+}
+
+ChaCha20::ChaCha20(ReadonlyBytes key, ReadonlyBytes nonce, u32 initial_counter)
+{
+    VERIFY(key.size() == KeySize);
+    VERIFY(nonce.size() == NonceSize);
+
+    // "expand 32-byte k"
+    m_state[0] = 0x61707865;
+    m_state[1] = 0x3320646e;
+    m_state[2] = 0x79622d32;
+    m_state[3] = 0x6b206574;
+    for (size_t i = 0; i < 8; ++i)
+        m_state[4 + i] = AK::convert_between_host_and_little_endian(ByteReader::load32(key.offset(i * 4)));
+    m_state[12] = initial_counter;
+    for (size_t i = 0; i < 3; ++i)
+        m_state[13 + i] = AK::convert_between_host_and_little_endian(ByteReader::load32(nonce.offset(i * 4)));
+}
+
+void ChaCha20::generate_block()
+{
+    u32 x[16];
+    __builtin_memcpy(x, m_state, sizeof(x));
+
+    for (size_t i = 0; i < 10; ++i) {
+        quarter_round(x, 0, 4, 8, 12);
+        quarter_round(x, 1, 5, 9, 13);
+        quarter_round(x, 2, 6, 10, 14);
+        quarter_round(x, 3, 7, 11, 15);
+        quarter_round(x, 0, 5, 10, 15);
+        quarter_round(x, 1, 6, 11, 12);
+        quarter_round(x, 2, 7, 8, 13);
+        quarter_round(x, 3, 4, 9, 14);
+    }
+
+    for (size_t i = 0; i < 16; ++i)
+        ByteReader::store(m_block + i * 4, AK::convert_between_host_and_little_endian(x[i] + m_state[i]));
+
+    ++m_state[12];
+    m_block_offset = 0;
+}
+
+void ChaCha20::encrypt(ReadonlyBytes input, Bytes output)
+{
+    VERIFY(output.size() >= input.size());
+
+    size_t offset = 0;
+    while (offset < input.size()) {
+        if (m_block_offset == BlockSize)
+            generate_block();
+
+        auto count = min(BlockSize - m_block_offset, input.size() - offset);
+        auto const* in = input.data() + offset;
+        auto* out = output.data() + offset;
+        auto const* keystream = m_block + m_block_offset;
+        for (size_t i = 0; i < count; ++i)
+            out[i] = in[i] ^ keystream[i];
+
+        offset += count;
+        m_block_offset += count;
+    }
+}
+
+}
+}
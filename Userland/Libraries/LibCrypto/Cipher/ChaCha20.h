@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Span.h>
+#include <AK/String.h>
+#include <AK/Types.h>
+
+namespace Crypto {
+namespace Cipher {
+
+// RFC 8439 section 2.4: ChaCha20 with a 256-bit key, a 96-bit nonce and a 32-bit block counter.
+class ChaCha20 {
+public:
+    constexpr static size_t KeySize = 32;
+    constexpr static size_t NonceSize = 12;
+    constexpr static size_t BlockSize = 64;
+
+    ChaCha20(ReadonlyBytes key, ReadonlyBytes nonce, u32 initial_counter = 0);
+
+    // This is a stream cipher, so encryption and decryption are the same operation.
+    // Consecutive calls continue where the keystream left off.
+    void encrypt(ReadonlyBytes input, Bytes output);
+    void decrypt(ReadonlyBytes input, Bytes output) { encrypt(input, output); }
+
+    String class_name() const { return "ChaCha20"; }
+
+private:
+    void generate_block();
+
+    u32 m_state[16];
+    u8 m_block[BlockSize];
+    size_t m_block_offset { BlockSize };
+};
+
+}
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ByteReader.h>
+#include <AK/Endian.h>
+#include <AK/Memory.h>
+#include <LibCrypto/Authentication/Poly1305.h>
+#include <LibCrypto/Cipher/ChaCha20.h>
+#include <LibCrypto/Cipher/ChaCha20Poly1305.h>
+
+namespace Crypto {
+namespace Cipher {
+
+ChaCha20Poly1305::ChaCha20Poly1305(ReadonlyBytes key)
+{
+    VERIFY(key.size() == KeySize);
+    key.copy_to({ m_key, KeySize });
+}
+
+void ChaCha20Poly1305::compute_tag(ReadonlyBytes ciphertext, ReadonlyBytes nonce, ReadonlyBytes aad, Bytes tag) const
+{
+    VERIFY(tag.size() == TagSize);
+
+    // The one-time Poly1305 key is the start of the keystream block with counter 0.
+    u8 one_time_key[Authentication::Poly1305::KeySize] {};
+    ChaCha20 key_generator { { m_key, KeySize }, nonce, 0 };
+    key_generator.encrypt({ one_time_key, sizeof(one_time_key) }, { one_time_key, sizeof(one_time_key) });
+
+    static constexpr u8 zeroes[Authentication::Poly1305::BlockSize] {};
+    auto padding_for = [](size_t size) {
+        return ReadonlyBytes { zeroes, (Authentication::Poly1305::BlockSize - size % Authentication::Poly1305::BlockSize) % Authentication::Poly1305::BlockSize };
+    };
+
+    Authentication::Poly1305 poly1305 { { one_time_key, sizeof(one_time_key) } };
+    poly1305.update(aad);
+    poly1305.update(padding_for(aad.size()));
+    poly1305.update(ciphertext);
+    poly1305.update(padding_for(ciphertext.size()));
+
+    u8 lengths[16];
+    ByteReader::store(lengths, AK::convert_between_host_and_little_endian((u64)aad.size()));
+    ByteReader::store(lengths + 8, AK::convert_between_host_and_little_endian((u64)ciphertext.size()));
+    poly1305.update({ lengths, sizeof(lengths) });
+
+    poly1305.digest().span().copy_to(tag);
+    secure_zero(one_time_key, sizeof(one_time_key));
+}
+
+void ChaCha20Poly1305::encrypt(ReadonlyBytes in, Bytes out, ReadonlyBytes nonce, ReadonlyBytes aad, Bytes tag) const
+{
+    ChaCha20 chacha { { m_key, KeySize }, nonce, 1 };
+    chacha.encrypt(in, out);
+    compute_tag(out.trim(in.size()), nonce, aad, tag);
+}
+
+VerificationConsistency ChaCha20Poly1305::decrypt(ReadonlyBytes in, Bytes out, ReadonlyBytes nonce, ReadonlyBytes aad, ReadonlyBytes tag) const
+{
+    if (tag.size() != TagSize)
+        return VerificationConsistency::Inconsistent;
+
+    u8 expected_tag[TagSize];
+    compute_tag(in, nonce, aad, { expected_tag, TagSize });
+
+    // Compare in constant time, so that the position of the first mismatch doesn't leak.
+    u8 difference = 0;
+    for (size_t i = 0; i < TagSize; ++i)
+        difference |= expected_tag[i] ^ tag[i];
+    if (difference != 0)
+        return VerificationConsistency::Inconsistent;
+
+    ChaCha20 chacha { { m_key, KeySize }, nonce, 1 };
+    chacha.decrypt(in, out);
+    return VerificationConsistency::Consistent;
+}
+
+}
+}
@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Span.h>
+#include <AK/String.h>
+#include <AK/Types.h>
+#include <LibCrypto/Verification.h>
+
+namespace Crypto {
+namespace Cipher {
+
+// RFC 8439 section 2.8: AEAD_CHACHA20_POLY1305, as used by TLS (RFC 7905).
+class ChaCha20Poly1305 {
+public:
+    constexpr static size_t KeySize = 32;
+    constexpr static size_t NonceSize = 12;
+    constexpr static size_t TagSize = 16;
+
+    explicit ChaCha20Poly1305(ReadonlyBytes key);
+
+    String class_name() const { return "ChaCha20_Poly1305"; }
+
+    void encrypt(ReadonlyBytes in, Bytes out, ReadonlyBytes nonce, ReadonlyBytes aad, Bytes tag) const;
+    // Nothing is written to `out` unless the tag matches.
+    VerificationConsistency decrypt(ReadonlyBytes in, Bytes out, ReadonlyBytes nonce, ReadonlyBytes aad, ReadonlyBytes tag) const;
+
+private:
+    void compute_tag(ReadonlyBytes ciphertext, ReadonlyBytes nonce, ReadonlyBytes aad, Bytes tag) const;
+
+    u8 m_key[KeySize];
+};
+
+}
+}
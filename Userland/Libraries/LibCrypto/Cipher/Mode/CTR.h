@@ -163,6 +163,14 @@ protected:
         size_t offset { 0 };
         auto block_size = cipher.block_size();
 
+        if constexpr (IsSame<IncrementFunctionType, IncrementInplace> && requires { cipher.encrypt_counter_mode_blocks(ReadonlyBytes {}, Bytes {}, Bytes {}); }) {
+            // Let the cipher encrypt as many whole blocks at once as it can, and do the rest one by one.
+            if (in) {
+                offset = cipher.encrypt_counter_mode_blocks(in->slice(0, length), out, iv);
+                length -= offset;
+            }
+        }
+
         while (length > 0) {
             m_cipher_block.overwrite(iv.slice(0, block_size));
 
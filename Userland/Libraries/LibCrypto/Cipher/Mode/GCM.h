@@ -84,12 +84,27 @@ public:
         // Skip past block 0
         CTR<T>::increment(iv);
 
-        if (in.is_empty())
+        m_ghash->reset();
+        m_ghash->update(aad);
+
+        size_t cipher_size;
+        if (in.is_empty()) {
             CTR<T>::key_stream(out, iv);
-        else
-            CTR<T>::encrypt(in, out, iv);
+            m_ghash->update(out);
+            cipher_size = out.size();
+        } else {
+            VERIFY(in.size() <= out.size());
+            // Authenticate every chunk of the ciphertext right after producing it, while it is still in the cache.
+            for (size_t offset = 0; offset < in.size(); offset += chunk_size) {
+                auto chunk_in = in.slice(offset, min(chunk_size, in.size() - offset));
+                auto chunk_out = out.slice(offset, chunk_in.size());
+                CTR<T>::encrypt(chunk_in, chunk_out, iv, &iv);
+                m_ghash->update(chunk_out);
+            }
+            cipher_size = in.size();
+        }
 
-        auto auth_tag = m_ghash->process(aad, out);
+        auto auth_tag = m_ghash->digest(aad.size(), cipher_size);
         block0.apply_initialization_vector({ auth_tag.data, array_size(auth_tag.data) });
         block0.bytes().copy_to(tag);
     }
@@ -112,7 +127,17 @@ public:
         // Skip past block 0
         CTR<T>::increment(iv);
 
-        auto auth_tag = m_ghash->process(aad, in);
+        m_ghash->reset();
+        m_ghash->update(aad);
+        // Authenticate every chunk of the ciphertext right before decrypting it, so that it only has to be loaded into the cache once.
+        for (size_t offset = 0; offset < in.size(); offset += chunk_size) {
+            auto chunk_in = in.slice(offset, min(chunk_size, in.size() - offset));
+            auto chunk_out = out.slice(offset, chunk_in.size());
+            m_ghash->update(chunk_in);
+            CTR<T>::encrypt(chunk_in, chunk_out, iv, &iv);
+        }
+
+        auto auth_tag = m_ghash->digest(aad.size(), in.size());
         block0.apply_initialization_vector({ auth_tag.data, array_size(auth_tag.data) });
 
         auto test_consistency = [&] {
@@ -123,17 +148,16 @@ public:
         };
         // FIXME: This block needs constant-time comparisons.
 
-        if (in.is_empty()) {
+        if (in.is_empty())
             out = {};
-            return test_consistency();
-        }
 
-        CTR<T>::encrypt(in, out, iv);
         return test_consistency();
     }
 
 private:
     static constexpr auto block_size = T::BlockType::BlockSizeInBits / 8;
+    // Small enough for the plaintext and ciphertext of a chunk to stay in the L1 cache between encryption and authentication
+    static constexpr size_t chunk_size = 4 * KiB;
     u8 m_auth_key_storage[block_size];
     Bytes m_auth_key { m_auth_key_storage, block_size };
     Optional<Authentication::GHash> m_ghash;
@@ -0,0 +1,249 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ByteReader.h>
+#include <AK/Endian.h>
+#include <AK/Memory.h>
+#include <AK/Random.h>
+#include <AK/StdLibExtras.h>
+#include <LibCrypto/Curves/X25519.h>
+
+namespace Crypto {
+namespace Curves {
+
+// Elements of GF(2^255 - 19) are stored in ten limbs of alternately 26 and 25 bits ("radix 2^25.5"),
+// so that limb products and their sums fit in 64 bits without needing 128-bit arithmetic.
+struct FieldElement {
+    u32 limbs[10];
+};
+
+static constexpr size_t limb_bits(size_t index) { return index % 2 == 0 ? 26 : 25; }
+static constexpr u32 limb_mask(size_t index) { return (1u << limb_bits(index)) - 1; }
+static constexpr size_t limb_position[10] = { 0, 26, 51, 77, 102, 128, 153, 179, 204, 230 };
+
+// Reduces 64-bit limb accumulators back into 26/25-bit limbs, folding the carry out of the top limb back in as 2^255 = 19.
+static void carry(u64 (&h)[10], FieldElement& out)
+{
+    for (size_t i = 0; i < 10; ++i) {
+        u64 carry = h[i] >> limb_bits(i);
+        h[i] &= limb_mask(i);
+        if (i < 9)
+            h[i + 1] += carry;
+        else
+            h[0] += carry * 19;
+    }
+    h[1] += h[0] >> 26;
+    h[0] &= limb_mask(0);
+
+    for (size_t i = 0; i < 10; ++i)
+        out.limbs[i] = static_cast<u32>(h[i]);
+}
+
+static void add(FieldElement& out, FieldElement const& a, FieldElement const& b)
+{
+    u64 h[10];
+    for (size_t i = 0; i < 10; ++i)
+        h[i] = static_cast<u64>(a.limbs[i]) + b.limbs[i];
+    carry(h, out);
+}
+
+static void subtract(FieldElement& out, FieldElement const& a, FieldElement const& b)
+{
+    // Add 2p first, so that none of the limbs can go negative.
+    u64 h[10];
+    for (size_t i = 0; i < 10; ++i) {
+        u64 two_p_limb = i == 0 ? 0x7ffffda : 2 * static_cast<u64>(limb_mask(i));
+        h[i] = a.limbs[i] + two_p_limb - b.limbs[i];
+    }
+    carry(h, out);
+}
+
+// Column k of the product: the sum of a[i] * b[k - i], where products that land past 2^255 wrap around multiplied by 19,
+// and two 25-bit limbs multiply into a position that is one bit further than their indices suggest, so those products are doubled.
+// This is spelled out with index sequences so that it always compiles down to straight-line code.
+template<unsigned k, unsigned... i>
+ALWAYS_INLINE static u64 multiply_column(u32 const (&a)[10], u32 const (&a2)[10], u32 const (&b)[10], u32 const (&b19)[10], IndexSequence<i...>)
+{
+    return (... + (static_cast<u64>(k % 2 == 1 || i % 2 == 0 ? a[i] : a2[i]) * (i <= k ? b : b19)[(k + 10 - i) % 10]));
+}
+
+template<unsigned... k>
+ALWAYS_INLINE static void multiply_columns(u64 (&h)[10], u32 const (&a)[10], u32 const (&a2)[10], u32 const (&b)[10], u32 const (&b19)[10], IndexSequence<k...>)
+{
+    ((h[k] = multiply_column<k>(a, a2, b, b19, MakeIndexSequence<10>())), ...);
+}
+
+static void multiply(FieldElement& out, FieldElement const& a, FieldElement const& b)
+{
+    u32 b19[10];
+    u32 a2[10];
+    for (size_t i = 0; i < 10; ++i) {
+        b19[i] = 19 * b.limbs[i];
+        a2[i] = 2 * a.limbs[i];
+    }
+
+    u64 h[10];
+    multiply_columns(h, a.limbs, a2, b.limbs, b19, MakeIndexSequence<10>());
+    carry(h, out);
+}
+
+static void square(FieldElement& out, FieldElement const& a)
+{
+    multiply(out, a, a);
+}
+
+// Computes a^(p - 2) = a^-1. The exponent 2^255 - 21 has every bit set, except for the low five bits which are 01011.
+static void invert(FieldElement& out, FieldElement const& a)
+{
+    FieldElement result { { 1 } };
+    for (int bit = 254; bit >= 0; --bit) {
+        square(result, result);
+        if (bit >= 5 || ((0b01011 >> bit) & 1))
+            multiply(result, result, a);
+    }
+    out = result;
+}
+
+static void conditional_swap(FieldElement& a, FieldElement& b, u32 swap)
+{
+    u32 mask = 0 - swap;
+    for (size_t i = 0; i < 10; ++i) {
+        u32 difference = (a.limbs[i] ^ b.limbs[i]) & mask;
+        a.limbs[i] ^= difference;
+        b.limbs[i] ^= difference;
+    }
+}
+
+static FieldElement decode_u_coordinate(ReadonlyBytes bytes)
+{
+    // The most significant bit is masked off, as required by RFC 7748 section 5.
+    u8 buffer[X25519::KeySize + 4] {};
+    bytes.copy_to({ buffer, X25519::KeySize });
+    buffer[31] &= 0x7f;
+
+    FieldElement element;
+    for (size_t i = 0; i < 10; ++i) {
+        u32 word = AK::convert_between_host_and_little_endian(ByteReader::load32(buffer + limb_position[i] / 8));
+        element.limbs[i] = (word >> (limb_position[i] % 8)) & limb_mask(i);
+    }
+    return element;
+}
+
+static void encode_u_coordinate(FieldElement const& element, Bytes output)
+{
+    u32 words[8] {};
+    for (size_t i = 0; i < 10; ++i) {
+        u64 carry = static_cast<u64>(element.limbs[i]) << (limb_position[i] % 32);
+        for (size_t j = limb_position[i] / 32; j < 8; ++j) {
+            carry += words[j];
+            words[j] = static_cast<u32>(carry);
+            carry >>= 32;
+        }
+    }
+
+    // Fold anything above 2^255 back in (twice, as the first fold can carry all the way up again).
+    for (size_t pass = 0; pass < 2; ++pass) {
+        u64 carry = 19 * static_cast<u64>(words[7] >> 31);
+        words[7] &= 0x7fffffff;
+        for (size_t j = 0; j < 8; ++j) {
+            carry += words[j];
+            words[j] = static_cast<u32>(carry);
+            carry >>= 32;
+        }
+    }
+
+    // The value is now below 2^255, so it is at most one p too large: subtract p if value + 19 reaches 2^255.
+    u32 reduced[8];
+    u64 carry = 19;
+    for (size_t j = 0; j < 8; ++j) {
+        carry += words[j];
+        reduced[j] = static_cast<u32>(carry);
+        carry >>= 32;
+    }
+    u32 mask = 0 - (reduced[7] >> 31);
+    reduced[7] &= 0x7fffffff;
+
+    for (size_t j = 0; j < 8; ++j) {
+        u32 word = (words[j] & ~mask) | (reduced[j] & mask);
+        ByteReader::store(output.offset(j * 4), AK::convert_between_host_and_little_endian(word));
+    }
+}
+
+void X25519::compute_coordinate(ReadonlyBytes scalar_bytes, ReadonlyBytes u_coordinate, Bytes output)
+{
+    VERIFY(scalar_bytes.size() == KeySize);
+    VERIFY(u_coordinate.size() == KeySize);
+    VERIFY(output.size() >= KeySize);
+
+    // Clamp the scalar, as described in RFC 7748 section 5.
+    u8 scalar[KeySize];
+    scalar_bytes.copy_to({ scalar, KeySize });
+    scalar[0] &= 248;
+    scalar[31] &= 127;
+    scalar[31] |= 64;
+
+    FieldElement const a24 { { 121665 } };
+    FieldElement x1 = decode_u_coordinate(u_coordinate);
+    FieldElement x2 { { 1 } };
+    FieldElement z2 { { 0 } };
+    FieldElement x3 = x1;
+    FieldElement z3 { { 1 } };
+    FieldElement a, aa, b, bb, e, c, d, da, cb;
+
+    // The Montgomery ladder from RFC 7748 section 5, with constant-time swaps.
+    u32 swap = 0;
+    for (int t = 254; t >= 0; --t) {
+        u32 bit = (scalar[t / 8] >> (t % 8)) & 1;
+        swap ^= bit;
+        conditional_swap(x2, x3, swap);
+        conditional_swap(z2, z3, swap);
+        swap = bit;
+
+        add(a, x2, z2);
+        square(aa, a);
+        subtract(b, x2, z2);
+        square(bb, b);
+        subtract(e, aa, bb);
+        add(c, x3, z3);
+        subtract(d, x3, z3);
+        multiply(da, d, a);
+        multiply(cb, c, b);
+
+        add(x3, da, cb);
+        square(x3, x3);
+        subtract(z3, da, cb);
+        square(z3, z3);
+        multiply(z3, z3, x1);
+        multiply(x2, aa, bb);
+        multiply(z2, a24, e);
+        add(z2, z2, aa);
+        multiply(z2, z2, e);
+    }
+    conditional_swap(x2, x3, swap);
+    conditional_swap(z2, z3, swap);
+
+    invert(z2, z2);
+    multiply(x2, x2, z2);
+    encode_u_coordinate(x2, output);
+
+    secure_zero(scalar, sizeof(scalar));
+}
+
+void X25519::generate_private_key(Bytes output)
+{
+    VERIFY(output.size() >= KeySize);
+    fill_with_random(output.data(), KeySize);
+}
+
+void X25519::generate_public_key(ReadonlyBytes private_key, Bytes output)
+{
+    // The base point has u = 9.
+    u8 base_point[KeySize] { 9 };
+    compute_coordinate(private_key, { base_point, KeySize }, output);
+}
+
+}
+}
@@ -0,0 +1,28 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Span.h>
+#include <AK/Types.h>
+
+namespace Crypto {
+namespace Curves {
+
+// RFC 7748: Elliptic curve Diffie-Hellman over Curve25519.
+class X25519 {
+public:
+    constexpr static size_t KeySize = 32;
+
+    // Computes X25519(scalar, u_coordinate), as described in RFC 7748 section 5.
+    static void compute_coordinate(ReadonlyBytes scalar, ReadonlyBytes u_coordinate, Bytes output);
+
+    static void generate_private_key(Bytes output);
+    static void generate_public_key(ReadonlyBytes private_key, Bytes output);
+};
+
+}
+}
@@ -4,11 +4,18 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/ByteReader.h>
 #include <AK/Endian.h>
 #include <AK/Memory.h>
+#include <AK/Platform.h>
+#include <AK/StdLibExtras.h>
 #include <AK/Types.h>
 #include <LibCrypto/Hash/SHA1.h>
 
+#if ARCH(X86_64)
+#    include <immintrin.h>
+#endif
+
 namespace Crypto {
 namespace Hash {
 
@@ -17,11 +24,78 @@ static constexpr auto ROTATE_LEFT(u32 value, size_t bits)
     return (value << bits) | (value >> (32 - bits));
 }
 
+#if ARCH(X86_64)
+static bool cpu_supports_sha_ni()
+{
+    static bool const supported = [] {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("sha") && __builtin_cpu_supports("sse4.1");
+    }();
+    return supported;
+}
+
+// Does rounds 4 * i to 4 * i + 3, and computes the message schedule four words at a time alongside, with messages[i % 4]
+// holding the words 4 * i to 4 * i + 3. This is a template because SHA1RNDS4 needs the round function as an immediate.
+template<unsigned i>
+[[gnu::target("sha")]] ALWAYS_INLINE static void sha1_four_rounds(__m128i& abcd, __m128i (&e)[2], __m128i (&messages)[4])
+{
+    auto& message = messages[i % 4];
+    e[i % 2] = _mm_sha1nexte_epu32(e[i % 2], message);
+    e[(i + 1) % 2] = abcd;
+    if constexpr (i >= 3 && i <= 18)
+        messages[(i + 1) % 4] = _mm_sha1msg2_epu32(messages[(i + 1) % 4], message);
+    abcd = _mm_sha1rnds4_epu32(abcd, e[i % 2], i / 5);
+    if constexpr (i <= 16)
+        messages[(i + 3) % 4] = _mm_sha1msg1_epu32(messages[(i + 3) % 4], message);
+    if constexpr (i >= 2 && i <= 17)
+        messages[(i + 2) % 4] = _mm_xor_si128(messages[(i + 2) % 4], message);
+}
+
+template<unsigned... i>
+[[gnu::target("sha")]] ALWAYS_INLINE static void sha1_rounds(__m128i& abcd, __m128i (&e)[2], __m128i (&messages)[4], IndexSequence<i...>)
+{
+    (sha1_four_rounds<i + 1>(abcd, e, messages), ...);
+}
+
+[[gnu::target("sha,sse4.1")]] static void transform_sha_ni(u32 (&state)[5], const u8* data)
+{
+    auto const byte_swap = _mm_set_epi64x(0x0001020304050607, 0x08090a0b0c0d0e0f);
+
+    auto abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0x1b);
+    auto e0 = _mm_set_epi32(static_cast<int>(state[4]), 0, 0, 0);
+    auto const saved_abcd = abcd;
+    auto const saved_e = e0;
+
+    __m128i messages[4];
+    for (size_t i = 0; i < 4; ++i)
+        messages[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16 * i)), byte_swap);
+
+    // The first four rounds add E to the message instead of deriving it from A
+    __m128i e[2] = { _mm_add_epi32(e0, messages[0]), abcd };
+    abcd = _mm_sha1rnds4_epu32(abcd, e[0], 0);
+
+    sha1_rounds(abcd, e, messages, MakeIndexSequence<19>());
+
+    e0 = _mm_sha1nexte_epu32(e[0], saved_e);
+    abcd = _mm_add_epi32(abcd, saved_abcd);
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_shuffle_epi32(abcd, 0x1b));
+    state[4] = static_cast<u32>(_mm_extract_epi32(e0, 3));
+}
+#endif
+
 inline void SHA1::transform(const u8* data)
 {
+#if ARCH(X86_64)
+    if (cpu_supports_sha_ni()) {
+        transform_sha_ni(m_state, data);
+        return;
+    }
+#endif
+
     u32 blocks[80];
     for (size_t i = 0; i < 16; ++i)
-        blocks[i] = AK::convert_between_host_and_network_endian(((const u32*)data)[i]);
+        blocks[i] = AK::convert_between_host_and_network_endian(ByteReader::load32(data + i * 4));
 
     // w[i] = (w[i-3] xor w[i-8] xor w[i-14] xor w[i-16]) leftrotate 1
     for (size_t i = 16; i < Rounds; ++i)
@@ -69,13 +143,26 @@ inline void SHA1::transform(const u8* data)
 
 void SHA1::update(const u8* message, size_t length)
 {
-    for (size_t i = 0; i < length; ++i) {
+    while (length > 0) {
         if (m_data_length == BlockSize) {
             transform(m_data_buffer);
             m_bit_length += 512;
             m_data_length = 0;
         }
-        m_data_buffer[m_data_length++] = message[i];
+
+        // Hash whole blocks straight out of the message while nothing is buffered
+        if (m_data_length == 0) {
+            for (; length >= BlockSize; message += BlockSize, length -= BlockSize) {
+                transform(message);
+                m_bit_length += 512;
+            }
+        }
+
+        auto copy_length = min(length, BlockSize - m_data_length);
+        __builtin_memcpy(m_data_buffer + m_data_length, message, copy_length);
+        m_data_length += copy_length;
+        message += copy_length;
+        length -= copy_length;
     }
 }
 
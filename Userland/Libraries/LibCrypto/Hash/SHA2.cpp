@@ -4,9 +4,17 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Platform.h>
+#include <AK/StdLibExtras.h>
 #include <AK/Types.h>
 #include <LibCrypto/Hash/SHA2.h>
 
+// The kernel is built without SSE, so it always uses the scalar implementation.
+#if ARCH(X86_64) && !defined(KERNEL)
+#    define SHA2_HAS_SHA_NI
+#    include <immintrin.h>
+#endif
+
 namespace Crypto {
 namespace Hash {
 constexpr static auto ROTRIGHT(u32 a, size_t b) { return (a >> b) | (a << (32 - b)); }
@@ -25,8 +33,76 @@ constexpr static auto EP1(u64 x) { return ROTRIGHT(x, 14) ^ ROTRIGHT(x, 18) ^ RO
 constexpr static auto SIGN0(u64 x) { return ROTRIGHT(x, 1) ^ ROTRIGHT(x, 8) ^ (x >> 7); }
 constexpr static auto SIGN1(u64 x) { return ROTRIGHT(x, 19) ^ ROTRIGHT(x, 61) ^ (x >> 6); }
 
+#ifdef SHA2_HAS_SHA_NI
+static bool cpu_supports_sha_ni()
+{
+    static bool const supported = [] {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("sha") && __builtin_cpu_supports("sse4.1");
+    }();
+    return supported;
+}
+
+// Does rounds 4 * i to 4 * i + 3, and computes the message schedule four words at a time alongside, with messages[i % 4]
+// holding the words 4 * i to 4 * i + 3. SHA256RNDS2 wants the state as ABEF and CDGH.
+template<unsigned i>
+[[gnu::target("sha,ssse3")]] ALWAYS_INLINE static void sha256_four_rounds(__m128i& abef, __m128i& cdgh, __m128i (&messages)[4])
+{
+    auto& message = messages[i % 4];
+    auto message_and_constants = _mm_add_epi32(message, _mm_loadu_si128(reinterpret_cast<const __m128i*>(&SHA256Constants::RoundConstants[4 * i])));
+    cdgh = _mm_sha256rnds2_epu32(cdgh, abef, message_and_constants);
+    if constexpr (i >= 3 && i <= 14) {
+        auto& next_message = messages[(i + 1) % 4];
+        next_message = _mm_add_epi32(next_message, _mm_alignr_epi8(message, messages[(i + 3) % 4], 4));
+        next_message = _mm_sha256msg2_epu32(next_message, message);
+    }
+    abef = _mm_sha256rnds2_epu32(abef, cdgh, _mm_shuffle_epi32(message_and_constants, 0x0e));
+    if constexpr (i >= 1 && i <= 12)
+        messages[(i + 3) % 4] = _mm_sha256msg1_epu32(messages[(i + 3) % 4], message);
+}
+
+template<unsigned... i>
+[[gnu::target("sha,ssse3")]] ALWAYS_INLINE static void sha256_rounds(__m128i& abef, __m128i& cdgh, __m128i (&messages)[4], IndexSequence<i...>)
+{
+    (sha256_four_rounds<i>(abef, cdgh, messages), ...);
+}
+
+[[gnu::target("sha,sse4.1")]] static void sha256_transform_sha_ni(u32 (&state)[8], const u8* data)
+{
+    auto const byte_swap = _mm_set_epi64x(0x0c0d0e0f08090a0b, 0x0405060700010203);
+
+    auto dcba = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0xb1);
+    auto hgfe = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state + 4)), 0x1b);
+    auto abef = _mm_alignr_epi8(dcba, hgfe, 8);
+    auto cdgh = _mm_blend_epi16(hgfe, dcba, 0xf0);
+    auto const saved_abef = abef;
+    auto const saved_cdgh = cdgh;
+
+    __m128i messages[4];
+    for (size_t i = 0; i < 4; ++i)
+        messages[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16 * i)), byte_swap);
+
+    sha256_rounds(abef, cdgh, messages, MakeIndexSequence<16>());
+
+    abef = _mm_add_epi32(abef, saved_abef);
+    cdgh = _mm_add_epi32(cdgh, saved_cdgh);
+
+    auto feba = _mm_shuffle_epi32(abef, 0x1b);
+    auto dchg = _mm_shuffle_epi32(cdgh, 0xb1);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_blend_epi16(feba, dchg, 0xf0));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state + 4), _mm_alignr_epi8(dchg, feba, 8));
+}
+#endif
+
 inline void SHA256::transform(const u8* data)
 {
+#ifdef SHA2_HAS_SHA_NI
+    if (cpu_supports_sha_ni()) {
+        sha256_transform_sha_ni(m_state, data);
+        return;
+    }
+#endif
+
     u32 m[64];
 
     size_t i = 0;
@@ -68,13 +144,26 @@ inline void SHA256::transform(const u8* data)
 
 void SHA256::update(const u8* message, size_t length)
 {
-    for (size_t i = 0; i < length; ++i) {
+    while (length > 0) {
         if (m_data_length == BlockSize) {
             transform(m_data_buffer);
             m_bit_length += 512;
             m_data_length = 0;
         }
-        m_data_buffer[m_data_length++] = message[i];
+
+        // Hash whole blocks straight out of the message while nothing is buffered
+        if (m_data_length == 0) {
+            for (; length >= BlockSize; message += BlockSize, length -= BlockSize) {
+                transform(message);
+                m_bit_length += 512;
+            }
+        }
+
+        auto copy_length = min(length, BlockSize - m_data_length);
+        __builtin_memcpy(m_data_buffer + m_data_length, message, copy_length);
+        m_data_length += copy_length;
+        message += copy_length;
+        length -= copy_length;
     }
 }
 
@@ -186,13 +275,26 @@ inline void SHA384::transform(const u8* data)
 
 void SHA384::update(const u8* message, size_t length)
 {
-    for (size_t i = 0; i < length; ++i) {
+    while (length > 0) {
         if (m_data_length == BlockSize) {
             transform(m_data_buffer);
             m_bit_length += 1024;
             m_data_length = 0;
         }
-        m_data_buffer[m_data_length++] = message[i];
+
+        // Hash whole blocks straight out of the message while nothing is buffered
+        if (m_data_length == 0) {
+            for (; length >= BlockSize; message += BlockSize, length -= BlockSize) {
+                transform(message);
+                m_bit_length += 1024;
+            }
+        }
+
+        auto copy_length = min(length, BlockSize - m_data_length);
+        __builtin_memcpy(m_data_buffer + m_data_length, message, copy_length);
+        m_data_length += copy_length;
+        message += copy_length;
+        length -= copy_length;
     }
 }
 
@@ -301,13 +403,26 @@ inline void SHA512::transform(const u8* data)
 
 void SHA512::update(const u8* message, size_t length)
 {
-    for (size_t i = 0; i < length; ++i) {
+    while (length > 0) {
         if (m_data_length == BlockSize) {
             transform(m_data_buffer);
             m_bit_length += 1024;
             m_data_length = 0;
         }
-        m_data_buffer[m_data_length++] = message[i];
+
+        // Hash whole blocks straight out of the message while nothing is buffered
+        if (m_data_length == 0) {
+            for (; length >= BlockSize; message += BlockSize, length -= BlockSize) {
+                transform(message);
+                m_bit_length += 1024;
+            }
+        }
+
+        auto copy_length = min(length, BlockSize - m_data_length);
+        __builtin_memcpy(m_data_buffer + m_data_length, message, copy_length);
+        m_data_length += copy_length;
+        message += copy_length;
+        length -= copy_length;
     }
 }
 
@@ -14,6 +14,7 @@
 #include <AK/LexicalPath.h>
 #include <AK/NonnullRefPtrVector.h>
 #include <AK/ScopeGuard.h>
+#include <AK/Time.h>
 #include <AK/Vector.h>
 #include <LibC/bits/pthread_integration.h>
 #include <LibC/link.h>
@@ -36,6 +37,10 @@ namespace ELF {
 static HashMap<String, NonnullRefPtr<ELF::DynamicLoader>> s_loaders;
 static String s_main_program_name;
 static OrderedHashMap<String, NonnullRefPtr<ELF::DynamicObject>> s_global_objects;
+// The libraries that are being loaded mostly look up the same symbols (malloc, free, ...) in the same global objects,
+// which walks every one of them each time. Since the global objects don't change while the libraries are being linked,
+// the results are remembered until load_main_library() is done. The keys point into the string tables of loaded objects.
+static HashMap<StringView, Optional<DynamicObject::SymbolLookupResult>> s_symbol_lookup_cache;
 
 using EntryPointFunction = int (*)(int, char**, char**);
 using LibCExitFunction = void (*)(int);
@@ -53,6 +58,8 @@ static __pthread_mutex_t s_loader_lock = __PTHREAD_MUTEX_INITIALIZER;
 
 static bool s_allowed_to_check_environment_variables { false };
 static bool s_do_breakpoint_trap_before_entry { false };
+static bool s_bind_now { false };
+static bool s_print_timings { false };
 static StringView s_ld_library_path;
 
 static Result<void, DlErrorMessage> __dlclose(void* handle);
@@ -79,6 +86,16 @@ Optional<DynamicObject::SymbolLookupResult> DynamicLinker::lookup_global_symbol(
     return weak_result;
 }
 
+Optional<DynamicObject::SymbolLookupResult> DynamicLinker::lookup_global_symbol_while_loading(StringView name)
+{
+    if (auto it = s_symbol_lookup_cache.find(name); it != s_symbol_lookup_cache.end())
+        return it->value;
+
+    auto result = lookup_global_symbol(name);
+    s_symbol_lookup_cache.set(name, result);
+    return result;
+}
+
 static String get_library_name(String path)
 {
     return LexicalPath::basename(move(path));
@@ -301,6 +318,10 @@ static NonnullRefPtrVector<DynamicLoader> collect_loaders_for_library(const Stri
 
 static Result<NonnullRefPtr<DynamicLoader>, DlErrorMessage> load_main_library(const String& name, int flags, bool skip_global_objects)
 {
+    ScopeGuard clear_symbol_lookup_cache = [] { s_symbol_lookup_cache.clear(); };
+
+    auto start_time = Time::now_monotonic();
+
     auto main_library_loader = *s_loaders.get(name);
     auto main_library_object = main_library_loader->map();
     s_global_objects.set(name, *main_library_object);
@@ -313,6 +334,8 @@ static Result<NonnullRefPtr<DynamicLoader>, DlErrorMessage> load_main_library(co
             s_global_objects.set(dynamic_object->filename(), *dynamic_object);
     }
 
+    auto mapped_time = Time::now_monotonic();
+
     for (auto& loader : loaders) {
         bool success = loader.link(flags);
         if (!success) {
@@ -339,10 +362,24 @@ static Result<NonnullRefPtr<DynamicLoader>, DlErrorMessage> load_main_library(co
         }
     }
 
+    // Initializers may dlopen() more libraries, which would change the results.
+    s_symbol_lookup_cache.clear();
+
+    auto linked_time = Time::now_monotonic();
+
     for (auto& loader : loaders) {
         loader.load_stage_4();
     }
 
+    if (s_print_timings) {
+        auto initialized_time = Time::now_monotonic();
+        dbgln("Loader.so: Loaded {} ({} objects): mapping took {}us, relocation {}us, initializers {}us",
+            name, loaders.size(),
+            (mapped_time - start_time).to_microseconds(),
+            (linked_time - mapped_time).to_microseconds(),
+            (initialized_time - linked_time).to_microseconds());
+    }
+
     return NonnullRefPtr<DynamicLoader>(*main_library_loader);
 }
 
@@ -392,9 +429,11 @@ static Optional<DlErrorMessage> verify_tls_for_dlopen(const DynamicLoader& loade
 
 static Result<void*, DlErrorMessage> __dlopen(const char* filename, int flags)
 {
-    // FIXME: RTLD_NOW and RTLD_LOCAL are not supported
-    flags &= ~RTLD_NOW;
-    flags |= RTLD_LAZY;
+    // FIXME: RTLD_LOCAL is not supported
+    if (s_bind_now || (flags & RTLD_NOW))
+        flags &= ~RTLD_LAZY;
+    else
+        flags |= RTLD_LAZY;
     flags &= ~RTLD_LOCAL;
     flags |= RTLD_GLOBAL;
 
@@ -513,6 +552,15 @@ static void read_environment_variables()
             s_do_breakpoint_trap_before_entry = true;
         }
 
+        if (env_string == "_LOADER_TIMINGS=1"sv) {
+            s_print_timings = true;
+        }
+
+        // Like on other systems, any value (even an empty one) makes us bind every function at load time.
+        if (env_string.starts_with("LD_BIND_NOW="sv)) {
+            s_bind_now = true;
+        }
+
         constexpr auto library_path_string = "LD_LIBRARY_PATH="sv;
         if (env_string.starts_with(library_path_string)) {
             s_ld_library_path = env_string.substring_view(library_path_string.length());
@@ -532,6 +580,8 @@ void ELF::DynamicLinker::linker_main(String&& main_program_name, int main_progra
 
     auto library_name = get_library_name(main_program_name);
 
+    auto start_time = Time::now_monotonic();
+
     // NOTE: We always map the main library first, since it may require
     //       placement at a specific address.
     auto result1 = map_library(main_program_name, main_program_fd);
@@ -550,6 +600,8 @@ void ELF::DynamicLinker::linker_main(String&& main_program_name, int main_progra
     }
 
     dbgln_if(DYNAMIC_LOAD_DEBUG, "loaded all dependencies");
+    if (s_print_timings)
+        dbgln("Loader.so: Opening {} and its dependencies took {}us", library_name, (Time::now_monotonic() - start_time).to_microseconds());
     for ([[maybe_unused]] auto& lib : s_loaders) {
         dbgln_if(DYNAMIC_LOAD_DEBUG, "{} - tls size: {}, tls offset: {}", lib.key, lib.value->tls_size_of_current_object(), lib.value->tls_offset());
     }
@@ -558,7 +610,7 @@ void ELF::DynamicLinker::linker_main(String&& main_program_name, int main_progra
 
     auto entry_point_function = [&main_program_name] {
         auto library_name = get_library_name(main_program_name);
-        auto result = load_main_library(library_name, RTLD_GLOBAL | RTLD_LAZY, false);
+        auto result = load_main_library(library_name, RTLD_GLOBAL | (s_bind_now ? RTLD_NOW : RTLD_LAZY), false);
         if (result.is_error()) {
             warnln("{}", result.error().text);
             _exit(1);
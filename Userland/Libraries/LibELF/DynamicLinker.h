@@ -15,6 +15,9 @@ namespace ELF {
 class DynamicLinker {
 public:
     static Optional<DynamicObject::SymbolLookupResult> lookup_global_symbol(StringView symbol);
+    // Like lookup_global_symbol(), but remembers the result until the libraries that are being loaded have been linked.
+    // This isn't thread-safe, so it may only be used while loading libraries.
+    static Optional<DynamicObject::SymbolLookupResult> lookup_global_symbol_while_loading(StringView symbol);
     [[noreturn]] static void linker_main(String&& main_program_name, int fd, bool is_secure, int argc, char** argv, char** envp);
 
 private:
@@ -159,6 +159,10 @@ bool DynamicLoader::load_stage_2(unsigned flags)
 {
     VERIFY(flags & RTLD_GLOBAL);
 
+    // Functions are only bound once they are first called, unless the object or the caller asked for all of them to
+    // be bound right away.
+    m_bind_now = m_dynamic_object->must_bind_now() || !(flags & RTLD_LAZY);
+
     if (m_dynamic_object->has_text_relocations()) {
         for (auto& text_segment : m_text_segments) {
             VERIFY(text_segment.address().get() != 0);
@@ -199,13 +203,11 @@ void DynamicLoader::do_main_relocations()
     m_dynamic_object->plt_relocation_section().for_each_relocation(do_single_relocation);
 }
 
-Result<NonnullRefPtr<DynamicObject>, DlErrorMessage> DynamicLoader::load_stage_3(unsigned flags)
+Result<NonnullRefPtr<DynamicObject>, DlErrorMessage> DynamicLoader::load_stage_3(unsigned)
 {
     do_lazy_relocations();
-    if (flags & RTLD_LAZY) {
-        if (m_dynamic_object->has_plt())
-            setup_plt_trampoline();
-    }
+    if (!m_bind_now && m_dynamic_object->has_plt())
+        setup_plt_trampoline();
 
     for (auto& text_segment : m_text_segments) {
         if (mprotect(text_segment.address().as_ptr(), text_segment.size(), PROT_READ | PROT_EXEC) < 0) {
@@ -400,6 +402,16 @@ void DynamicLoader::load_program_headers()
     // FIXME: Initialize the values in the TLS section. Currently, it is zeroed.
 }
 
+// Relocations are only done while libraries are being loaded, with the loader lock held (or before there are any other
+// threads), so they can make use of the linker's symbol lookup cache. Lazy PLT fixups can happen on any thread at any
+// time, so they go through lookup_symbol() instead.
+static Optional<DynamicObject::SymbolLookupResult> lookup_symbol_while_loading(const ELF::DynamicObject::Symbol& symbol)
+{
+    if (symbol.is_undefined() || symbol.bind() == STB_WEAK)
+        return DynamicLinker::lookup_global_symbol_while_loading(symbol.name());
+    return DynamicLoader::lookup_symbol(symbol);
+}
+
 DynamicLoader::RelocationResult DynamicLoader::do_relocation(const ELF::DynamicObject::Relocation& relocation, ShouldInitializeWeak should_initialize_weak)
 {
     FlatPtr* patch_ptr = nullptr;
@@ -423,7 +435,7 @@ DynamicLoader::RelocationResult DynamicLoader::do_relocation(const ELF::DynamicO
     case R_X86_64_64: {
 #endif
         auto symbol = relocation.symbol();
-        auto res = lookup_symbol(symbol);
+        auto res = lookup_symbol_while_loading(symbol);
         if (!res.has_value()) {
             if (symbol.bind() == STB_WEAK)
                 return RelocationResult::ResolveLater;
@@ -440,7 +452,7 @@ DynamicLoader::RelocationResult DynamicLoader::do_relocation(const ELF::DynamicO
 #if ARCH(I386)
     case R_386_PC32: {
         auto symbol = relocation.symbol();
-        auto result = lookup_symbol(symbol);
+        auto result = lookup_symbol_while_loading(symbol);
         if (!result.has_value())
             return RelocationResult::Failed;
         auto relative_offset = result.value().address - m_dynamic_object->base_address().offset(relocation.offset());
@@ -452,7 +464,7 @@ DynamicLoader::RelocationResult DynamicLoader::do_relocation(const ELF::DynamicO
     case R_X86_64_GLOB_DAT: {
 #endif
         auto symbol = relocation.symbol();
-        auto res = lookup_symbol(symbol);
+        auto res = lookup_symbol_while_loading(symbol);
         VirtualAddress symbol_location;
         if (!res.has_value()) {
             if (symbol.bind() == STB_WEAK) {
@@ -494,7 +506,7 @@ DynamicLoader::RelocationResult DynamicLoader::do_relocation(const ELF::DynamicO
         FlatPtr symbol_value;
         DynamicObject const* dynamic_object_of_symbol;
         if (relocation.symbol_index() != 0) {
-            auto res = lookup_symbol(symbol);
+            auto res = lookup_symbol_while_loading(symbol);
             if (!res.has_value())
                 break;
             symbol_value = res.value().value;
@@ -513,8 +525,7 @@ DynamicLoader::RelocationResult DynamicLoader::do_relocation(const ELF::DynamicO
 #else
     case R_X86_64_JUMP_SLOT: {
 #endif
-        // FIXME: Or BIND_NOW flag passed in?
-        if (m_dynamic_object->must_bind_now()) {
+        if (m_bind_now) {
             // Eagerly BIND_NOW the PLT entries, doing all the symbol looking goodness
             // The patch method returns the address for the LAZY fixup path, but we don't need it here
             m_dynamic_object->patch_plt_entry(relocation.offset_in_section());
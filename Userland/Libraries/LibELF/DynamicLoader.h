@@ -155,6 +155,7 @@ private:
     size_t m_tls_size_of_current_object { 0 };
 
     Vector<DynamicObject::Relocation> m_unresolved_relocations;
+    bool m_bind_now { false };
 
     mutable RefPtr<DynamicObject> m_cached_dynamic_object;
 };
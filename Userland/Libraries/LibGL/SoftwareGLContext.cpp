@@ -291,10 +291,19 @@ void SoftwareGLContext::gl_end()
         && m_current_draw_mode != GL_POLYGON) {
 
         m_vertex_list.clear_with_capacity();
+        m_vertex_indices.clear_with_capacity();
         dbgln_if(GL_DEBUG, "gl_end: draw mode {:#x} unsupported", m_current_draw_mode);
         RETURN_WITH_ERROR_IF(true, GL_INVALID_ENUM);
     }
 
+    draw_primitives(m_current_draw_mode, m_vertex_list, m_vertex_indices);
+
+    m_vertex_list.clear_with_capacity();
+    m_vertex_indices.clear_with_capacity();
+}
+
+void SoftwareGLContext::draw_primitives(GLenum mode, Vector<SoftGPU::Vertex> const& vertices, Vector<u32> const& indices)
+{
     Vector<size_t, 32> enabled_texture_units;
     for (size_t i = 0; i < m_texture_units.size(); ++i) {
         if (m_texture_units[i].texture_2d_enabled())
@@ -304,7 +313,7 @@ void SoftwareGLContext::gl_end()
     sync_device_config();
 
     SoftGPU::PrimitiveType primitive_type;
-    switch (m_current_draw_mode) {
+    switch (mode) {
     case GL_TRIANGLES:
         primitive_type = SoftGPU::PrimitiveType::Triangles;
         break;
@@ -332,9 +341,7 @@ void SoftwareGLContext::gl_end()
         mv_elements[0][2], mv_elements[1][2], mv_elements[2][2]);
     auto const& normal_transform = model_view_transposed.inverse();
 
-    m_rasterizer.draw_primitives(primitive_type, m_model_view_matrix, normal_transform, m_projection_matrix, m_texture_matrix, m_vertex_list, enabled_texture_units);
-
-    m_vertex_list.clear_with_capacity();
+    m_rasterizer.draw_primitives(primitive_type, m_model_view_matrix, normal_transform, m_projection_matrix, m_texture_matrix, vertices, indices, enabled_texture_units);
 }
 
 void SoftwareGLContext::gl_frustum(GLdouble left, GLdouble right, GLdouble bottom, GLdouble top, GLdouble near_val, GLdouble far_val)
@@ -914,10 +921,8 @@ void SoftwareGLContext::gl_tex_image_2d(GLenum target, GLint level, GLint intern
         // All images that were attached before the device image was created need to be stored somewhere to be used to initialize the device image once complete.
         SoftGPU::ImageFormat device_format;
         switch (internal_format) {
+        // RGB textures are stored with an opaque alpha channel so that the sampler can fetch them as 32-bit texels
         case GL_RGB:
-            device_format = SoftGPU::ImageFormat::RGB888;
-            break;
-
         case GL_RGBA:
             device_format = SoftGPU::ImageFormat::RGBA8888;
             break;
@@ -1070,18 +1075,127 @@ void SoftwareGLContext::invoke_list(size_t list_index)
     for (auto& entry : listing.entries) {
         entry.function.visit([&](auto& function) {
             entry.arguments.visit([&](auto& arguments) {
-                auto apply = [&]<typename... Args>(Args && ... args)
-                {
-                    if constexpr (requires { (this->*function)(forward<Args>(args)...); })
+                using Arguments = Listing::TupleTypeForArgumentListOf<RemoveCVReference<decltype(function)>>;
+                if constexpr (IsSame<RemoveCVReference<decltype(arguments)>, Arguments>) {
+                    auto apply = [&]<typename... Args>(Args && ... args)
+                    {
                         (this->*function)(forward<Args>(args)...);
-                };
+                    };
 
-                arguments.apply_as_args(apply);
+                    arguments.apply_as_args(apply);
+                }
             });
         });
     }
 }
 
+void SoftwareGLContext::draw_vertex_batch(VertexBatch const& batch)
+{
+    RETURN_WITH_ERROR_IF(m_in_draw_state, GL_INVALID_OPERATION);
+
+    static Vector<u32> const no_indices;
+    if (batch.vertices_with_current_color == 0 && batch.vertices_with_current_tex_coord == 0 && batch.vertices_with_current_normal == 0) {
+        draw_primitives(batch.mode, batch.vertices, no_indices);
+    } else {
+        m_vertex_list.extend(batch.vertices);
+        for (size_t i = 0; i < batch.vertices_with_current_color; ++i)
+            m_vertex_list[i].color = m_current_vertex_color;
+        for (size_t i = 0; i < batch.vertices_with_current_tex_coord; ++i)
+            m_vertex_list[i].tex_coord = m_current_vertex_tex_coord;
+        for (size_t i = 0; i < batch.vertices_with_current_normal; ++i)
+            m_vertex_list[i].normal = m_current_vertex_normal;
+
+        draw_primitives(batch.mode, m_vertex_list, no_indices);
+        m_vertex_list.clear_with_capacity();
+    }
+
+    if (batch.final_color.has_value())
+        m_current_vertex_color = batch.final_color.value();
+    if (batch.final_tex_coord.has_value())
+        m_current_vertex_tex_coord = batch.final_tex_coord.value();
+    if (batch.final_normal.has_value())
+        m_current_vertex_normal = batch.final_normal.value();
+}
+
+void SoftwareGLContext::compile_vertex_batches(Listing& listing)
+{
+    using BeginArguments = Listing::ArgumentsFor<&SoftwareGLContext::gl_begin>;
+    using ColorArguments = Listing::ArgumentsFor<&SoftwareGLContext::gl_color>;
+    using TexCoordArguments = Listing::ArgumentsFor<&SoftwareGLContext::gl_tex_coord>;
+    using NormalArguments = Listing::ArgumentsFor<&SoftwareGLContext::gl_normal>;
+    using VertexArguments = Listing::ArgumentsFor<&SoftwareGLContext::gl_vertex>;
+
+    auto is_call_to = []<auto member>(Listing::FunctionsAndArgs const& entry) {
+        auto const* function = entry.function.get_pointer<decltype(member)>();
+        return function && *function == member;
+    };
+
+    // Turns the entries from entries[begin_index] up to a matching glEnd() into a batch, if they only consist of
+    // vertices and vertex attributes for a primitive type that we can draw.
+    auto compile_batch = [&](size_t begin_index, size_t& end_index) -> Optional<VertexBatch> {
+        auto mode = listing.entries[begin_index].arguments.get<BeginArguments>().get<0>();
+        if (mode != GL_TRIANGLES
+            && mode != GL_TRIANGLE_FAN
+            && mode != GL_TRIANGLE_STRIP
+            && mode != GL_QUADS
+            && mode != GL_QUAD_STRIP
+            && mode != GL_POLYGON)
+            return {};
+
+        VertexBatch batch { mode, {}, 0, 0, 0, {}, {}, {} };
+        SoftGPU::Vertex vertex;
+        for (size_t i = begin_index + 1; i < listing.entries.size(); ++i) {
+            auto const& entry = listing.entries[i];
+            if (is_call_to.operator()<&SoftwareGLContext::gl_end>(entry)) {
+                end_index = i;
+                return batch;
+            }
+
+            if (is_call_to.operator()<&SoftwareGLContext::gl_color>(entry)) {
+                auto const& arguments = entry.arguments.get<ColorArguments>();
+                vertex.color = { (float)arguments.get<0>(), (float)arguments.get<1>(), (float)arguments.get<2>(), (float)arguments.get<3>() };
+                batch.final_color = vertex.color;
+            } else if (is_call_to.operator()<&SoftwareGLContext::gl_tex_coord>(entry)) {
+                auto const& arguments = entry.arguments.get<TexCoordArguments>();
+                vertex.tex_coord = { arguments.get<0>(), arguments.get<1>(), arguments.get<2>(), arguments.get<3>() };
+                batch.final_tex_coord = vertex.tex_coord;
+            } else if (is_call_to.operator()<&SoftwareGLContext::gl_normal>(entry)) {
+                auto const& arguments = entry.arguments.get<NormalArguments>();
+                vertex.normal = { arguments.get<0>(), arguments.get<1>(), arguments.get<2>() };
+                batch.final_normal = vertex.normal;
+            } else if (is_call_to.operator()<&SoftwareGLContext::gl_vertex>(entry)) {
+                auto const& arguments = entry.arguments.get<VertexArguments>();
+                vertex.position = { static_cast<float>(arguments.get<0>()), static_cast<float>(arguments.get<1>()), static_cast<float>(arguments.get<2>()), static_cast<float>(arguments.get<3>()) };
+                if (!batch.final_color.has_value())
+                    ++batch.vertices_with_current_color;
+                if (!batch.final_tex_coord.has_value())
+                    ++batch.vertices_with_current_tex_coord;
+                if (!batch.final_normal.has_value())
+                    ++batch.vertices_with_current_normal;
+                batch.vertices.append(vertex);
+            } else {
+                return {};
+            }
+        }
+        return {};
+    };
+
+    Vector<Listing::FunctionsAndArgs> entries;
+    for (size_t i = 0; i < listing.entries.size(); ++i) {
+        size_t end_index = 0;
+        if (is_call_to.operator()<&SoftwareGLContext::gl_begin>(listing.entries[i])) {
+            if (auto batch = compile_batch(i, end_index); batch.has_value()) {
+                listing.vertex_batches.append(make<VertexBatch>(batch.release_value()));
+                entries.empend(&SoftwareGLContext::draw_vertex_batch, Listing::ArgumentsFor<&SoftwareGLContext::draw_vertex_batch> { *listing.vertex_batches.last() });
+                i = end_index;
+                continue;
+            }
+        }
+        entries.append(move(listing.entries[i]));
+    }
+    listing.entries = move(entries);
+}
+
 void SoftwareGLContext::gl_call_list(GLuint list)
 {
     if (m_gl_call_depth > max_allowed_gl_call_depth)
@@ -1180,6 +1294,7 @@ void SoftwareGLContext::gl_end_list()
     RETURN_WITH_ERROR_IF(m_in_draw_state, GL_INVALID_OPERATION);
     RETURN_WITH_ERROR_IF(!m_current_listing_index.has_value(), GL_INVALID_OPERATION);
 
+    compile_vertex_batches(m_current_listing_index->listing);
     m_listings[m_current_listing_index->index] = move(m_current_listing_index->listing);
     m_current_listing_index.clear();
 }
@@ -2128,6 +2243,10 @@ void SoftwareGLContext::gl_draw_elements(GLenum mode, GLsizei count, GLenum type
     if (!m_client_side_vertex_array_enabled)
         return;
 
+    // Every vertex is only read once, no matter how many times it's referenced. The rasterizer gets the
+    // indices as well, so it doesn't have to transform and light shared vertices more than once either.
+    m_vertex_list_index_for_array_index.clear_with_capacity();
+
     gl_begin(mode);
     for (int index = 0; index < count; index++) {
         int i = 0;
@@ -2143,6 +2262,13 @@ void SoftwareGLContext::gl_draw_elements(GLenum mode, GLsizei count, GLenum type
             break;
         }
 
+        if (auto vertex_list_index = m_vertex_list_index_for_array_index.get(i); vertex_list_index.has_value()) {
+            m_vertex_indices.append(vertex_list_index.value());
+            continue;
+        }
+        m_vertex_list_index_for_array_index.set(i, m_vertex_list.size());
+        m_vertex_indices.append(m_vertex_list.size());
+
         if (m_client_side_texture_coord_array_enabled) {
             float tex_coords[4] { 0, 0, 0, 0 };
             read_from_vertex_attribute_pointer(m_client_tex_coord_pointer, i, tex_coords, false);
@@ -2883,13 +3009,13 @@ void SoftwareGLContext::sync_device_sampler_config()
             config.mipmap_filter = SoftGPU::MipMapFilter::Nearest;
             break;
         case GL_LINEAR_MIPMAP_NEAREST:
-            config.texture_min_filter = SoftGPU::TextureFilter::Nearest;
-            config.mipmap_filter = SoftGPU::MipMapFilter::Linear;
-            break;
-        case GL_NEAREST_MIPMAP_LINEAR:
             config.texture_min_filter = SoftGPU::TextureFilter::Linear;
             config.mipmap_filter = SoftGPU::MipMapFilter::Nearest;
             break;
+        case GL_NEAREST_MIPMAP_LINEAR:
+            config.texture_min_filter = SoftGPU::TextureFilter::Nearest;
+            config.mipmap_filter = SoftGPU::MipMapFilter::Linear;
+            break;
         case GL_LINEAR_MIPMAP_LINEAR:
             config.texture_min_filter = SoftGPU::TextureFilter::Linear;
             config.mipmap_filter = SoftGPU::MipMapFilter::Linear;
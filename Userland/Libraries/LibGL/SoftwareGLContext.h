@@ -147,6 +147,9 @@ public:
     virtual void gl_materialfv(GLenum face, GLenum pname, GLfloat const* params) override;
     virtual void present() override;
 
+    SoftGPU::DeviceStatistics const& device_statistics() const { return m_rasterizer.statistics(); }
+    void reset_device_statistics() { m_rasterizer.reset_statistics(); }
+
 private:
     void sync_device_config();
     void sync_device_sampler_config();
@@ -174,6 +177,11 @@ private:
     template<typename T>
     void get_floating_point(GLenum pname, T* params);
 
+    void draw_primitives(GLenum mode, Vector<SoftGPU::Vertex> const& vertices, Vector<u32> const& indices);
+
+    struct VertexBatch;
+    void draw_vertex_batch(VertexBatch const&);
+
     void invoke_list(size_t list_index);
     [[nodiscard]] bool should_append_to_listing() const { return m_current_listing_index.has_value(); }
     [[nodiscard]] bool should_execute_after_appending_to_listing() const { return m_current_listing_index.has_value() && m_current_listing_index->mode == GL_COMPILE_AND_EXECUTE; }
@@ -200,6 +208,8 @@ private:
     FloatVector3 m_current_vertex_normal = { 0.0f, 0.0f, 1.0f };
 
     Vector<SoftGPU::Vertex> m_vertex_list;
+    Vector<u32> m_vertex_indices;
+    HashMap<u32, u32> m_vertex_list_index_for_array_index;
 
     GLenum m_error = GL_NO_ERROR;
     bool m_in_draw_state = false;
@@ -297,6 +307,23 @@ private:
     bool m_sampler_config_is_dirty { true };
     bool m_light_state_is_dirty { true };
 
+    // A glBegin()/glEnd() pair recorded in a display list, together with the vertices and vertex attributes specified
+    // in between. Calling the list draws the whole batch at once instead of replaying every single call.
+    struct VertexBatch {
+        GLenum mode;
+        Vector<SoftGPU::Vertex> vertices;
+
+        // Vertices specified before the batch sets an attribute use the current value of that attribute when drawn
+        size_t vertices_with_current_color { 0 };
+        size_t vertices_with_current_tex_coord { 0 };
+        size_t vertices_with_current_normal { 0 };
+
+        // Values of the attributes after the batch, if the batch sets them
+        Optional<FloatVector4> final_color;
+        Optional<FloatVector4> final_tex_coord;
+        Optional<FloatVector3> final_normal;
+    };
+
     struct Listing {
 
         template<typename F>
@@ -378,15 +405,19 @@ private:
             decltype(&SoftwareGLContext::gl_lightf),
             decltype(&SoftwareGLContext::gl_lightfv),
             decltype(&SoftwareGLContext::gl_materialf),
-            decltype(&SoftwareGLContext::gl_materialfv)>;
+            decltype(&SoftwareGLContext::gl_materialfv),
+            decltype(&SoftwareGLContext::draw_vertex_batch)>;
 
         using ExtraSavedArguments = Variant<
             FloatMatrix4x4>;
 
         Vector<NonnullOwnPtr<ExtraSavedArguments>> saved_arguments;
+        Vector<NonnullOwnPtr<VertexBatch>> vertex_batches;
         Vector<FunctionsAndArgs> entries;
     };
 
+    static void compile_vertex_batches(Listing&);
+
     static constexpr size_t max_allowed_gl_call_depth { 128 };
     size_t m_gl_call_depth { 0 };
     Vector<Listing> m_listings;
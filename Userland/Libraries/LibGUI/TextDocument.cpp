@@ -12,6 +12,7 @@
 #include <LibCore/Timer.h>
 #include <LibGUI/TextDocument.h>
 #include <LibRegex/Regex.h>
+#include <string.h>
 
 namespace GUI {
 
@@ -50,18 +51,29 @@ bool TextDocument::set_text(StringView text, AllowCallback allow_callback)
         set_text({});
     });
 
+    // The lines aren't decoded here, they keep pointing into our own copy of the text until something needs their code points.
+    // That keeps loading a big file fast, and its memory use close to the size of the file.
+    auto text_buffer = ByteBuffer::copy(text.bytes());
+    if (!text_buffer.has_value())
+        return false;
+    m_loaded_text = text_buffer.release_value();
+    StringView loaded_text { m_loaded_text.bytes() };
+
     size_t start_of_current_line = 0;
 
     auto add_line = [&](size_t current_position) -> bool {
-        size_t line_length = current_position - start_of_current_line;
+        auto line_text = loaded_text.substring_view(start_of_current_line, current_position - start_of_current_line);
         auto line = make<TextDocumentLine>(*this);
 
-        bool success = true;
-        if (line_length)
-            success = line->set_text(*this, text.substring_view(start_of_current_line, current_position - start_of_current_line));
-
-        if (!success)
-            return false;
+        if (!line_text.is_empty()) {
+            if (!Utf8View(line_text).validate())
+                return false;
+            // Every byte that isn't a continuation byte starts a code point.
+            size_t length = 0;
+            for (auto byte : line_text.bytes())
+                length += (byte & 0xc0) != 0x80;
+            line->set_undecoded_text(line_text, length);
+        }
 
         append_line(move(line));
         start_of_current_line = current_position + 1;
@@ -69,18 +81,16 @@ bool TextDocument::set_text(StringView text, AllowCallback allow_callback)
         return true;
     };
 
-    size_t i = 0;
-    for (i = 0; i < text.length(); ++i) {
-        if (text[i] != '\n')
-            continue;
-
-        auto success = add_line(i);
-        if (!success)
+    while (start_of_current_line < loaded_text.length()) {
+        auto* start = loaded_text.characters_without_null_termination() + start_of_current_line;
+        auto* newline = static_cast<char const*>(memchr(start, '\n', loaded_text.length() - start_of_current_line));
+        if (!newline)
+            break;
+        if (!add_line(newline - loaded_text.characters_without_null_termination()))
             return false;
     }
 
-    auto success = add_line(i);
-    if (!success)
+    if (!add_line(loaded_text.length()))
         return false;
 
     // Don't show the file's trailing newline as an actual new line.
@@ -141,8 +151,8 @@ bool TextDocumentLine::can_select() const
 size_t TextDocumentLine::leading_spaces() const
 {
     size_t count = 0;
-    for (; count < m_text.size(); ++count) {
-        if (m_text[count] != ' ') {
+    for (; count < length(); ++count) {
+        if (code_points()[count] != ' ') {
             break;
         }
     }
@@ -151,6 +161,8 @@ size_t TextDocumentLine::leading_spaces() const
 
 String TextDocumentLine::to_utf8() const
 {
+    if (!m_undecoded_text.is_empty())
+        return m_undecoded_text;
     StringBuilder builder;
     builder.append(view());
     return builder.to_string();
@@ -166,15 +178,34 @@ TextDocumentLine::TextDocumentLine(TextDocument& document, StringView text)
     set_text(document, text);
 }
 
+void TextDocumentLine::set_undecoded_text(StringView text, size_t length)
+{
+    m_text.clear();
+    m_undecoded_text = text;
+    m_undecoded_length = length;
+}
+
+void TextDocumentLine::ensure_decoded() const
+{
+    if (m_undecoded_text.is_empty())
+        return;
+    m_text.ensure_capacity(m_undecoded_length);
+    for (auto code_point : Utf8View(m_undecoded_text))
+        m_text.unchecked_append(code_point);
+    m_undecoded_text = {};
+}
+
 void TextDocumentLine::clear(TextDocument& document)
 {
     m_text.clear();
+    m_undecoded_text = {};
     document.update_views({});
 }
 
 void TextDocumentLine::set_text(TextDocument& document, const Vector<u32> text)
 {
     m_text = move(text);
+    m_undecoded_text = {};
     document.update_views({});
 }
 
@@ -184,11 +215,12 @@ bool TextDocumentLine::set_text(TextDocument& document, StringView text)
         clear(document);
         return true;
     }
-    m_text.clear();
     Utf8View utf8_view(text);
     if (!utf8_view.validate()) {
         return false;
     }
+    m_text.clear();
+    m_undecoded_text = {};
     for (auto code_point : utf8_view)
         m_text.append(code_point);
     document.update_views({});
@@ -199,6 +231,7 @@ void TextDocumentLine::append(TextDocument& document, const u32* code_points, si
 {
     if (length == 0)
         return;
+    ensure_decoded();
     m_text.append(code_points, length);
     document.update_views({});
 }
@@ -215,6 +248,7 @@ void TextDocumentLine::prepend(TextDocument& document, u32 code_point)
 
 void TextDocumentLine::insert(TextDocument& document, size_t index, u32 code_point)
 {
+    ensure_decoded();
     if (index == length()) {
         m_text.append(code_point);
     } else {
@@ -225,6 +259,7 @@ void TextDocumentLine::insert(TextDocument& document, size_t index, u32 code_poi
 
 void TextDocumentLine::remove(TextDocument& document, size_t index)
 {
+    ensure_decoded();
     if (index == length()) {
         m_text.take_last();
     } else {
@@ -235,6 +270,7 @@ void TextDocumentLine::remove(TextDocument& document, size_t index)
 
 void TextDocumentLine::remove_range(TextDocument& document, size_t start, size_t length)
 {
+    ensure_decoded();
     VERIFY(length <= m_text.size());
 
     Vector<u32> new_data;
@@ -249,6 +285,7 @@ void TextDocumentLine::remove_range(TextDocument& document, size_t start, size_t
 
 void TextDocumentLine::truncate(TextDocument& document, size_t length)
 {
+    ensure_decoded();
     m_text.resize(length);
     document.update_views({});
 }
@@ -331,7 +368,10 @@ String TextDocument::text() const
     StringBuilder builder;
     for (size_t i = 0; i < line_count(); ++i) {
         auto& line = this->line(i);
-        builder.append(line.view());
+        if (auto undecoded_text = line.undecoded_text(); undecoded_text.has_value())
+            builder.append(*undecoded_text);
+        else
+            builder.append(line.view());
         if (i != line_count() - 1)
             builder.append('\n');
     }
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/ByteBuffer.h>
 #include <AK/HashTable.h>
 #include <AK/NonnullOwnPtrVector.h>
 #include <AK/NonnullRefPtr.h>
@@ -149,9 +150,14 @@ private:
 
     bool m_regex_needs_update { true };
     String m_regex_needle;
+
+    // The text the document was last set to. Lines that haven't been decoded yet still point into it.
+    ByteBuffer m_loaded_text;
 };
 
 class TextDocumentLine {
+    friend class TextDocument;
+
 public:
     explicit TextDocumentLine(TextDocument&);
     explicit TextDocumentLine(TextDocument&, StringView);
@@ -159,8 +165,21 @@ public:
     String to_utf8() const;
 
     Utf32View view() const { return { code_points(), length() }; }
-    const u32* code_points() const { return m_text.data(); }
-    size_t length() const { return m_text.size(); }
+    const u32* code_points() const
+    {
+        ensure_decoded();
+        return m_text.data();
+    }
+    size_t length() const { return m_undecoded_text.is_empty() ? m_text.size() : m_undecoded_length; }
+
+    // The text of a line that hasn't been decoded into code points yet, so it can be used without decoding it.
+    Optional<StringView> undecoded_text() const
+    {
+        if (m_undecoded_text.is_empty())
+            return {};
+        return m_undecoded_text;
+    }
+
     bool set_text(TextDocument&, StringView);
     void set_text(TextDocument&, Vector<u32>);
     void append(TextDocument&, u32);
@@ -180,8 +199,16 @@ public:
     size_t leading_spaces() const;
 
 private:
+    void set_undecoded_text(StringView text, size_t length);
+    void ensure_decoded() const;
+
     // NOTE: This vector is null terminated.
-    Vector<u32> m_text;
+    mutable Vector<u32> m_text;
+
+    // Lines of a document that was loaded from some text are only decoded once something needs their code points.
+    // Until then, they're just the (already validated) UTF-8 text they were loaded from.
+    mutable StringView m_undecoded_text;
+    size_t m_undecoded_length { 0 };
 };
 
 class TextDocumentUndoCommand : public Command {
@@ -10,6 +10,7 @@
 #include <AK/ScopeGuard.h>
 #include <AK/StringBuilder.h>
 #include <AK/TemporaryChange.h>
+#include <AK/Utf8View.h>
 #include <LibCore/Timer.h>
 #include <LibGUI/Action.h>
 #include <LibGUI/AutocompleteProvider.h>
@@ -1702,6 +1703,15 @@ void TextEditor::recompute_visual_lines(size_t line_index)
     auto& line = document().line(line_index);
     auto& visual_data = m_line_visual_data[line_index];
 
+    // NOTE: Lines that haven't been decoded yet are measured as UTF-8, so laying out a big document doesn't decode all of it.
+    if (auto undecoded_text = line.undecoded_text(); undecoded_text.has_value())
+        recompute_visual_lines(line, visual_data, Utf8View(*undecoded_text));
+    else
+        recompute_visual_lines(line, visual_data, line.view());
+}
+
+void TextEditor::recompute_visual_lines(TextDocumentLine const& line, LineVisualData& visual_data, auto const& text)
+{
     visual_data.visual_line_breaks.clear_with_capacity();
 
     int available_width = visible_text_rect_in_inner_coordinates().width();
@@ -1712,8 +1722,8 @@ void TextEditor::recompute_visual_lines(size_t line_index)
         size_t last_whitespace_index = 0;
         size_t line_width_since_last_whitespace = 0;
         auto glyph_spacing = font().glyph_spacing();
-        for (size_t i = 0; i < line.length(); ++i) {
-            auto code_point = line.code_points()[i];
+        size_t i = 0;
+        for (auto code_point : text) {
             if (is_ascii_space(code_point)) {
                 last_whitespace_index = i;
                 line_width_since_last_whitespace = 0;
@@ -1731,9 +1741,11 @@ void TextEditor::recompute_visual_lines(size_t line_index)
                     visual_data.visual_line_breaks.append(i);
                     line_width_so_far = glyph_width + glyph_spacing;
                 }
+                ++i;
                 continue;
             }
             line_width_so_far += glyph_width + glyph_spacing;
+            ++i;
         }
     }
 
@@ -1742,7 +1754,7 @@ void TextEditor::recompute_visual_lines(size_t line_index)
     if (is_wrapping_enabled())
         visual_data.visual_rect = { m_horizontal_content_padding, 0, available_width, static_cast<int>(visual_data.visual_line_breaks.size()) * line_height() };
     else
-        visual_data.visual_rect = { m_horizontal_content_padding, 0, text_width_for_font(line.view(), font()), line_height() };
+        visual_data.visual_rect = { m_horizontal_content_padding, 0, text_width_for_font(text, font()), line_height() };
 }
 
 template<typename Callback>
@@ -386,6 +386,8 @@ private:
         Gfx::IntRect visual_rect;
     };
 
+    void recompute_visual_lines(TextDocumentLine const&, LineVisualData&, auto const& text);
+
     NonnullOwnPtrVector<LineVisualData> m_line_visual_data;
 
     OwnPtr<Syntax::Highlighter> m_highlighter;
@@ -46,7 +46,10 @@ void GeminiJob::start(NonnullRefPtr<Core::Socket> socket)
     if (m_socket->is_established()) {
         deferred_invoke([this] { on_socket_connected(); });
     } else {
-        m_socket->set_root_certificates(m_override_ca_certificates ? *m_override_ca_certificates : DefaultRootCACertificates::the().certificates());
+        if (m_override_ca_certificates)
+            m_socket->set_root_certificates(*m_override_ca_certificates);
+        else
+            m_socket->set_trust_store(DefaultRootCACertificates::the().trust_store());
         m_socket->on_tls_connected = [this] {
             on_socket_connected();
         };
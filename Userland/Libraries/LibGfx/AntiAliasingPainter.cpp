@@ -4,10 +4,10 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
-#include "FillPathImplementation.h"
 #include <AK/Function.h>
 #include <LibGfx/AntiAliasingPainter.h>
 #include <LibGfx/Path.h>
+#include <LibGfx/PathRasterizer.h>
 
 static float fractional_part(float x)
 {
@@ -108,7 +108,7 @@ void Gfx::AntiAliasingPainter::draw_line(FloatPoint const& actual_from, FloatPoi
 
 void Gfx::AntiAliasingPainter::fill_path(Path& path, Color color, Painter::WindingRule rule)
 {
-    Detail::fill_path<Detail::FillPathMode::AllowFloatingPoints>(*this, path, color, rule);
+    PathRasterizer::fill_path(m_underlying_painter, path, color, rule, PathRasterizer::AntiAliasing::Yes, m_transform);
 }
 
 void Gfx::AntiAliasingPainter::stroke_path(Path const& path, Color color, float thickness)
@@ -15,6 +15,7 @@
 #include <LibCore/MappedFile.h>
 #include <LibCore/System.h>
 #include <LibGfx/Bitmap.h>
+#include <LibGfx/IconCache.h>
 #include <LibGfx/ImageDecoder.h>
 #include <LibGfx/ShareableBitmap.h>
 #include <errno.h>
@@ -102,6 +103,16 @@ ErrorOr<NonnullRefPtr<Bitmap>> Bitmap::try_create_wrapper(BitmapFormat format, I
     return adopt_ref(*new Bitmap(format, size, scale_factor, pitch, data));
 }
 
+static RefPtr<Bitmap> try_load_from_icon_cache(String const& path, int scale_factor)
+{
+    if (!path.starts_with(IconCache::system_icons_directory))
+        return nullptr;
+    auto* icon_cache = IconCache::the();
+    if (!icon_cache)
+        return nullptr;
+    return icon_cache->get(path, scale_factor);
+}
+
 ErrorOr<NonnullRefPtr<Bitmap>> Bitmap::try_load_from_file(String const& path, int scale_factor)
 {
     if (scale_factor > 1 && path.starts_with("/res/")) {
@@ -114,6 +125,8 @@ ErrorOr<NonnullRefPtr<Bitmap>> Bitmap::try_load_from_file(String const& path, in
         highdpi_icon_path.append(lexical_path.extension());
 
         auto highdpi_icon_string = highdpi_icon_path.to_string();
+        if (auto bitmap = try_load_from_icon_cache(highdpi_icon_string, scale_factor))
+            return bitmap.release_nonnull();
         auto fd = TRY(Core::System::open(highdpi_icon_string, O_RDONLY));
 
         auto bitmap = TRY(try_load_from_fd_and_close(fd, highdpi_icon_string));
@@ -125,6 +138,9 @@ ErrorOr<NonnullRefPtr<Bitmap>> Bitmap::try_load_from_file(String const& path, in
         return bitmap;
     }
 
+    if (auto bitmap = try_load_from_icon_cache(path, 1))
+        return bitmap.release_nonnull();
+
     auto fd = TRY(Core::System::open(path, O_RDONLY));
     return try_load_from_fd_and_close(fd, path);
 }
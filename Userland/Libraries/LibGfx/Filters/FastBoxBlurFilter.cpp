@@ -4,144 +4,143 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
-#include <AK/Function.h>
+#include <AK/SIMD.h>
+#include <AK/SIMDExtras.h>
 #include <AK/Vector.h>
 #include <LibGfx/Filters/FastBoxBlurFilter.h>
 
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+
 namespace Gfx {
 
-ALWAYS_INLINE static constexpr u8 red_value(Color color)
+using AK::SIMD::f32x4;
+using AK::SIMD::to_f32x4;
+using AK::SIMD::to_u32x4;
+using AK::SIMD::u32x4;
+
+// Each pixel is summed as a vector of its four channels, in the same order as they're laid out in memory (BGRA).
+ALWAYS_INLINE static u32x4 unpack_channels(RGBA32 pixel)
 {
-    return (color.alpha() == 0) ? 0xFF : color.red();
+    return u32x4 { pixel & 0xff, (pixel >> 8) & 0xff, (pixel >> 16) & 0xff, pixel >> 24 };
 }
-ALWAYS_INLINE static constexpr u8 green_value(Color color)
+
+ALWAYS_INLINE static RGBA32 pack_channels(u32x4 channels)
 {
-    return (color.alpha() == 0) ? 0xFF : color.green();
+    return channels[0] | (channels[1] << 8) | (channels[2] << 16) | (channels[3] << 24);
 }
-ALWAYS_INLINE static constexpr u8 blue_value(Color color)
+
+template<BitmapFormat format>
+ALWAYS_INLINE static u32x4 source_channels(RGBA32 pixel)
 {
-    return (color.alpha() == 0) ? 0xFF : color.blue();
+    if constexpr (format == BitmapFormat::BGRx8888)
+        return unpack_channels(pixel | 0xff000000);
+    // Fully transparent pixels count as white, so they don't darken the edges of whatever they're blurred into.
+    if ((pixel >> 24) == 0)
+        return u32x4 { 0xff, 0xff, 0xff, 0 };
+    return unpack_channels(pixel);
 }
 
+class WindowDivider {
+public:
+    explicit WindowDivider(u32 divisor)
+        : m_divisor(divisor)
+        , m_reciprocal(1.0f / divisor)
+    {
+    }
+
+    // Every sum is at most 255 * divisor, so as long as the divisor is small enough for the rounding error
+    // of the multiplication to stay below 0.5 / divisor, ((sum + 0.5) * reciprocal) truncates to exactly
+    // the same quotient as the integer division.
+    ALWAYS_INLINE u32x4 operator()(u32x4 sum) const
+    {
+        if (m_divisor <= max_divisor_for_reciprocal) [[likely]]
+            return to_u32x4((to_f32x4(sum) + 0.5f) * m_reciprocal);
+        return sum / m_divisor;
+    }
+
+private:
+    static constexpr u32 max_divisor_for_reciprocal = 8191;
+
+    u32 m_divisor { 1 };
+    float m_reciprocal { 1 };
+};
+
 FastBoxBlurFilter::FastBoxBlurFilter(Bitmap& bitmap)
     : m_bitmap(bitmap)
 {
 }
 
-// Based on the super fast blur algorithm by Quasimondo, explored here: https://stackoverflow.com/questions/21418892/understanding-super-fast-blur-algorithm
-void FastBoxBlurFilter::apply_single_pass(int radius)
+template<BitmapFormat format>
+static void apply_single_pass_impl(Bitmap& bitmap, int radius)
 {
-    VERIFY(radius >= 0);
+    int height = bitmap.height();
+    int width = bitmap.width();
 
-    auto format = m_bitmap.format();
-    VERIFY(format == BitmapFormat::BGRA8888 || format == BitmapFormat::BGRx8888);
+    WindowDivider divide { static_cast<u32>(2 * radius + 1) };
 
-    Function<Color(int, int)> get_pixel_function;
-    Function<void(int, int, Color)> set_pixel_function;
-    switch (format) {
-    case BitmapFormat::BGRx8888:
-        get_pixel_function = [&](int x, int y) { return m_bitmap.get_pixel<StorageFormat::BGRx8888>(x, y); };
-        set_pixel_function = [&](int x, int y, Color color) { return m_bitmap.set_pixel<StorageFormat::BGRx8888>(x, y, color); };
-        break;
-    case BitmapFormat::BGRA8888:
-        get_pixel_function = [&](int x, int y) { return m_bitmap.get_pixel<StorageFormat::BGRA8888>(x, y); };
-        set_pixel_function = [&](int x, int y, Color color) { return m_bitmap.set_pixel<StorageFormat::BGRA8888>(x, y, color); };
-        break;
-    default:
-        VERIFY_NOT_REACHED();
-    }
+    Vector<RGBA32, 1024> intermediate;
+    intermediate.resize(width * height);
 
-    int height = m_bitmap.height();
-    int width = m_bitmap.width();
+    // First pass: horizontal, sliding a window along each row.
+    Vector<u32x4, 256> row_channels;
+    row_channels.ensure_capacity(width);
+    for (int y = 0; y < height; ++y) {
+        auto const* source_row = bitmap.scanline(y);
+        row_channels.clear_with_capacity();
+        for (int x = 0; x < width; ++x)
+            row_channels.unchecked_append(source_channels<format>(source_row[x]));
 
-    int div = 2 * radius + 1;
+        u32x4 sum {};
+        for (int i = -radius; i <= radius; ++i)
+            sum += row_channels[clamp(i, 0, width - 1)];
 
-    Vector<u8, 1024> intermediate_red;
-    Vector<u8, 1024> intermediate_green;
-    Vector<u8, 1024> intermediate_blue;
-    Vector<u8, 1024> intermediate_alpha;
+        auto* intermediate_row = intermediate.data() + y * width;
+        for (int x = 0; x < width; ++x) {
+            intermediate_row[x] = pack_channels(divide(sum));
+            sum -= row_channels[max(x - radius, 0)];
+            sum += row_channels[min(x + radius + 1, width - 1)];
+        }
+    }
 
-    intermediate_red.resize(width * height);
-    intermediate_green.resize(width * height);
-    intermediate_blue.resize(width * height);
-    intermediate_alpha.resize(width * height);
+    // Second pass: vertical. The windows of all columns slide down together, one row at a time, so both
+    // the intermediate buffer and the bitmap are only ever walked along their scanlines.
+    Vector<u32x4, 256> column_sums;
+    column_sums.ensure_capacity(width);
+    for (int x = 0; x < width; ++x)
+        column_sums.unchecked_append(u32x4 {});
+    for (int i = -radius; i <= radius; ++i) {
+        auto const* intermediate_row = intermediate.data() + clamp(i, 0, height - 1) * width;
+        for (int x = 0; x < width; ++x)
+            column_sums[x] += unpack_channels(intermediate_row[x]);
+    }
 
-    // First pass: vertical
     for (int y = 0; y < height; ++y) {
-        size_t sum_red = 0;
-        size_t sum_green = 0;
-        size_t sum_blue = 0;
-        size_t sum_alpha = 0;
-
-        // Setup sliding window
-        for (int i = -radius; i <= radius; ++i) {
-            auto color_at_px = get_pixel_function(clamp(i, 0, width - 1), y);
-            sum_red += red_value(color_at_px);
-            sum_green += green_value(color_at_px);
-            sum_blue += blue_value(color_at_px);
-            sum_alpha += color_at_px.alpha();
-        }
-        // Slide horizontally
+        auto* destination_row = bitmap.scanline(y);
+        auto const* topmost_row = intermediate.data() + max(y - radius, 0) * width;
+        auto const* bottommost_row = intermediate.data() + min(y + radius + 1, height - 1) * width;
         for (int x = 0; x < width; ++x) {
-            intermediate_red[y * width + x] = (sum_red / div);
-            intermediate_green[y * width + x] = (sum_green / div);
-            intermediate_blue[y * width + x] = (sum_blue / div);
-            intermediate_alpha[y * width + x] = (sum_alpha / div);
-
-            auto leftmost_x_coord = max(x - radius, 0);
-            auto rightmost_x_coord = min(x + radius + 1, width - 1);
-
-            auto leftmost_x_color = get_pixel_function(leftmost_x_coord, y);
-            auto rightmost_x_color = get_pixel_function(rightmost_x_coord, y);
-
-            sum_red -= red_value(leftmost_x_color);
-            sum_red += red_value(rightmost_x_color);
-            sum_green -= green_value(leftmost_x_color);
-            sum_green += green_value(rightmost_x_color);
-            sum_blue -= blue_value(leftmost_x_color);
-            sum_blue += blue_value(rightmost_x_color);
-            sum_alpha -= leftmost_x_color.alpha();
-            sum_alpha += rightmost_x_color.alpha();
+            destination_row[x] = pack_channels(divide(column_sums[x]));
+            column_sums[x] += unpack_channels(bottommost_row[x]);
+            column_sums[x] -= unpack_channels(topmost_row[x]);
         }
     }
+}
 
-    // Second pass: horizontal
-    for (int x = 0; x < width; ++x) {
-        size_t sum_red = 0;
-        size_t sum_green = 0;
-        size_t sum_blue = 0;
-        size_t sum_alpha = 0;
-
-        // Setup sliding window
-        for (int i = -radius; i <= radius; ++i) {
-            int offset = clamp(i, 0, height - 1) * width + x;
-            sum_red += intermediate_red[offset];
-            sum_green += intermediate_green[offset];
-            sum_blue += intermediate_blue[offset];
-            sum_alpha += intermediate_alpha[offset];
-        }
+// Based on the super fast blur algorithm by Quasimondo, explored here: https://stackoverflow.com/questions/21418892/understanding-super-fast-blur-algorithm
+void FastBoxBlurFilter::apply_single_pass(int radius)
+{
+    VERIFY(radius >= 0);
 
-        for (int y = 0; y < height; ++y) {
-            auto color = Color(
-                sum_red / div,
-                sum_green / div,
-                sum_blue / div,
-                sum_alpha / div);
-
-            set_pixel_function(x, y, color);
-
-            auto topmost_y_coord = max(y - radius, 0);
-            auto bottommost_y_coord = min(y + radius + 1, height - 1);
-
-            sum_red += intermediate_red[x + bottommost_y_coord * width];
-            sum_red -= intermediate_red[x + topmost_y_coord * width];
-            sum_green += intermediate_green[x + bottommost_y_coord * width];
-            sum_green -= intermediate_green[x + topmost_y_coord * width];
-            sum_blue += intermediate_blue[x + bottommost_y_coord * width];
-            sum_blue -= intermediate_blue[x + topmost_y_coord * width];
-            sum_alpha += intermediate_alpha[x + bottommost_y_coord * width];
-            sum_alpha -= intermediate_alpha[x + topmost_y_coord * width];
-        }
+    switch (m_bitmap.format()) {
+    case BitmapFormat::BGRx8888:
+        apply_single_pass_impl<BitmapFormat::BGRx8888>(m_bitmap, radius);
+        break;
+    case BitmapFormat::BGRA8888:
+        apply_single_pass_impl<BitmapFormat::BGRA8888>(m_bitmap, radius);
+        break;
+    default:
+        VERIFY_NOT_REACHED();
     }
 }
 
@@ -169,3 +168,5 @@ void FastBoxBlurFilter::apply_three_passes(size_t radius)
 }
 
 }
+
+#pragma GCC diagnostic pop
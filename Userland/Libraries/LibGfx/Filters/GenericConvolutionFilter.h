@@ -7,8 +7,14 @@
 #pragma once
 
 #include "Filter.h"
+#include <AK/Array.h>
+#include <AK/SIMD.h>
+#include <AK/SIMDExtras.h>
+#include <AK/SIMDMath.h>
+#include <AK/Vector.h>
 #include <LibGfx/Matrix.h>
 #include <LibGfx/Matrix4x4.h>
+#include <math.h>
 
 namespace Gfx {
 
@@ -100,8 +106,138 @@ public:
 
         Bitmap* render_target_bitmap = (&target != &source) ? &target : apply_cache.m_target.ptr();
 
+        if (!apply_separable(*render_target_bitmap, target_rect, source, source_rect, source_delta_x, source_delta_y, parameters))
+            apply_naive(*render_target_bitmap, target_rect, source, source_rect, source_delta_x, source_delta_y, parameters);
+
+        if (render_target_bitmap != &target) {
+            // FIXME: Substitute for some sort of faster "blit" method.
+            for (auto i_ = 0; i_ < target_rect.width(); ++i_) {
+                auto i = i_ + target_rect.x();
+                for (auto j_ = 0; j_ < target_rect.height(); ++j_) {
+                    auto j = j_ + target_rect.y();
+                    target.set_pixel(i, j, render_target_bitmap->get_pixel(i_, j_));
+                }
+            }
+        }
+    }
+
+private:
+    constexpr static ssize_t offset = N / 2;
+
+    // Splits the kernel into a horizontal and a vertical kernel whose outer product it is, if there are such.
+    // When the kernel is separable, every row sum is proportional to the horizontal kernel, and every column
+    // sum to the vertical one.
+    static bool separate_kernel(Gfx::Matrix<N, float> const& kernel, Array<float, N>& horizontal, Array<float, N>& vertical)
+    {
+        Array<float, N> row_sums {};
+        Array<float, N> column_sums {};
+        float total = 0;
+        float largest_element = 0;
+        for (size_t k = 0; k < N; ++k) {
+            for (size_t l = 0; l < N; ++l) {
+                auto element = kernel.elements()[k][l];
+                row_sums[k] += element;
+                column_sums[l] += element;
+                total += element;
+                largest_element = max(largest_element, fabsf(element));
+            }
+        }
+
+        auto tolerance = largest_element * 1e-5f;
+        if (fabsf(total) <= tolerance)
+            return false;
+
+        for (size_t k = 0; k < N; ++k) {
+            for (size_t l = 0; l < N; ++l) {
+                if (fabsf(row_sums[k] * column_sums[l] / total - kernel.elements()[k][l]) > tolerance)
+                    return false;
+            }
+        }
+
+        horizontal = row_sums;
+        for (size_t l = 0; l < N; ++l)
+            vertical[l] = column_sums[l] / total;
+        return true;
+    }
+
+    // Separable kernels (such as box and gaussian blurs) are applied as a horizontal pass followed by a vertical
+    // one, which takes 2N instead of N * N taps per pixel. Taps outside of source_rect are skipped or wrapped
+    // exactly like they are in apply_naive(), as that only ever depends on one of the two coordinates.
+    static bool apply_separable(Bitmap& render_target_bitmap, IntRect const& target_rect, Bitmap const& source, IntRect const& source_rect, int source_delta_x, int source_delta_y, GenericConvolutionFilter::Parameters const& parameters)
+    {
+        using AK::SIMD::f32x4;
+
+        if (source.format() != BitmapFormat::BGRx8888 && source.format() != BitmapFormat::BGRA8888)
+            return false;
+
+        Array<float, N> horizontal;
+        Array<float, N> vertical;
+        if (!separate_kernel(parameters.kernel(), horizontal, vertical))
+            return false;
+
+        auto wrap_or_skip = [&](ssize_t coordinate, int first, int last, int size) -> Optional<ssize_t> {
+            if (coordinate >= first && coordinate <= last)
+                return coordinate;
+            if (!parameters.should_wrap())
+                return {};
+            return (coordinate + size) % size; // TODO: fix up using source_rect
+        };
+
+        // Wrapped vertical taps may land on any row of the source bitmap, unwrapped ones only on rows of source_rect.
+        int first_row = parameters.should_wrap() ? 0 : source_rect.y();
+        int last_row = parameters.should_wrap() ? source.height() - 1 : source_rect.bottom();
+        int width = target_rect.width();
+
+        Vector<f32x4> horizontal_pass;
+        if (horizontal_pass.try_ensure_capacity(width * (last_row - first_row + 1)).is_error())
+            return false;
+        for (int y = first_row; y <= last_row; ++y) {
+            auto const* scanline = source.scanline(y);
+            for (auto i_ = 0; i_ < width; ++i_) {
+                ssize_t i = i_ + target_rect.x();
+                f32x4 value {};
+                for (auto k = 0l; k < (ssize_t)N; ++k) {
+                    auto ki = wrap_or_skip(i + k - offset, source_rect.x(), source_rect.right(), source.size().width());
+                    if (!ki.has_value())
+                        continue;
+                    auto pixel = scanline[ki.value()];
+                    f32x4 pixel_value { (float)((pixel >> 16) & 0xff), (float)((pixel >> 8) & 0xff), (float)(pixel & 0xff), 0 };
+                    value += pixel_value * horizontal[k];
+                }
+                horizontal_pass.unchecked_append(value);
+            }
+        }
+
+        Vector<f32x4> row;
+        if (row.try_ensure_capacity(width).is_error())
+            return false;
+        for (auto j_ = 0; j_ < target_rect.height(); ++j_) {
+            ssize_t j = j_ + target_rect.y();
+            row.clear_with_capacity();
+            for (auto i_ = 0; i_ < width; ++i_)
+                row.unchecked_append(f32x4 {});
+
+            for (auto l = 0l; l < (ssize_t)N; ++l) {
+                auto lj = wrap_or_skip(j + l - offset, source_rect.y(), source_rect.bottom(), source.size().height());
+                if (!lj.has_value())
+                    continue;
+                auto const* taps = horizontal_pass.data() + (lj.value() - first_row) * width;
+                for (auto i_ = 0; i_ < width; ++i_)
+                    row[i_] += taps[i_] * vertical[l];
+            }
+
+            for (auto i_ = 0; i_ < width; ++i_) {
+                ssize_t i = i_ + target_rect.x();
+                auto value = AK::SIMD::clamp(row[i_], f32x4 { 0, 0, 0, 0 }, f32x4 { 255, 255, 255, 255 });
+                render_target_bitmap.set_pixel(i, j, Color(value[0], value[1], value[2], source.get_pixel(i + source_delta_x, j + source_delta_y).alpha()));
+            }
+        }
+        return true;
+    }
+
+    static void apply_naive(Bitmap& render_target_bitmap, IntRect const& target_rect, Bitmap const& source, IntRect const& source_rect, int source_delta_x, int source_delta_y, GenericConvolutionFilter::Parameters const& parameters)
+    {
         // FIXME: Help! I am naive!
-        constexpr static ssize_t offset = N / 2;
         for (auto i_ = 0; i_ < target_rect.width(); ++i_) {
             ssize_t i = i_ + target_rect.x();
             for (auto j_ = 0; j_ < target_rect.height(); ++j_) {
@@ -133,18 +269,7 @@ public:
                 }
 
                 value.clamp(0, 255);
-                render_target_bitmap->set_pixel(i, j, Color(value.x(), value.y(), value.z(), source.get_pixel(i + source_delta_x, j + source_delta_y).alpha()));
-            }
-        }
-
-        if (render_target_bitmap != &target) {
-            // FIXME: Substitute for some sort of faster "blit" method.
-            for (auto i_ = 0; i_ < target_rect.width(); ++i_) {
-                auto i = i_ + target_rect.x();
-                for (auto j_ = 0; j_ < target_rect.height(); ++j_) {
-                    auto j = j_ + target_rect.y();
-                    target.set_pixel(i, j, render_target_bitmap->get_pixel(i_, j_));
-                }
+                render_target_bitmap.set_pixel(i, j, Color(value.x(), value.y(), value.z(), source.get_pixel(i + source_delta_x, j + source_delta_y).alpha()));
             }
         }
     }
@@ -9,6 +9,7 @@
 #include <LibCore/DirIterator.h>
 #include <LibGfx/Font.h>
 #include <LibGfx/FontDatabase.h>
+#include <LibGfx/FontIndex.h>
 #include <LibGfx/TrueTypeFont/Font.h>
 #include <LibGfx/Typeface.h>
 #include <stdlib.h>
@@ -76,14 +77,26 @@ Font& FontDatabase::default_fixed_width_font()
 }
 
 struct FontDatabase::Private {
-    HashMap<String, NonnullRefPtr<Gfx::Font>> full_name_to_font_map;
+    struct BitmapFontEntry {
+        NonnullRefPtr<Typeface> typeface;
+        unsigned presentation_size { 0 };
+        bool is_fixed_width { false };
+    };
+    // Bitmap fonts by qualified name. The font itself is only loaded once it's needed, by its typeface.
+    HashMap<String, BitmapFontEntry> full_name_to_font_map;
     Vector<RefPtr<Typeface>> typefaces;
 };
 
 FontDatabase::FontDatabase()
     : m_private(make<Private>())
 {
-    Core::DirIterator dir_iterator("/res/fonts", Core::DirIterator::SkipDots);
+    auto index_or_error = FontIndex::try_open(FontIndex::system_index_path, FontIndex::system_fonts_directory);
+    if (!index_or_error.is_error()) {
+        load_from_index(*index_or_error.value());
+        return;
+    }
+
+    Core::DirIterator dir_iterator(FontIndex::system_fonts_directory, Core::DirIterator::SkipDots);
     if (dir_iterator.has_error()) {
         warnln("DirIterator: {}", dir_iterator.error_string());
         exit(1);
@@ -93,9 +106,9 @@ FontDatabase::FontDatabase()
 
         if (path.ends_with(".font"sv)) {
             if (auto font = Gfx::BitmapFont::load_from_file(path)) {
-                m_private->full_name_to_font_map.set(font->qualified_name(), *font);
                 auto typeface = get_or_create_typeface(font->family(), font->variant());
                 typeface->add_bitmap_font(font);
+                m_private->full_name_to_font_map.set(font->qualified_name(), { *typeface, font->presentation_size(), font->is_fixed_width() });
             }
         } else if (path.ends_with(".ttf"sv)) {
             // FIXME: What about .otf and .woff
@@ -112,28 +125,49 @@ FontDatabase::~FontDatabase()
 {
 }
 
+void FontDatabase::load_from_index(FontIndex const& index)
+{
+    for (size_t i = 0; i < index.entry_count(); ++i) {
+        auto entry = index.entry(i);
+        auto path = String::formatted("{}/{}", FontIndex::system_fonts_directory, entry.file_name);
+        auto typeface = get_or_create_typeface(entry.family, entry.variant);
+        if (entry.is_truetype) {
+            typeface->set_ttf_font(move(path), entry.weight, entry.is_fixed_width);
+            continue;
+        }
+        typeface->add_bitmap_font(move(path), entry.presentation_size, entry.weight, entry.is_fixed_width);
+        // NOTE: This is what BitmapFont::qualified_name() would be once the font is loaded.
+        auto qualified_name = String::formatted("{} {} {}", entry.family, entry.presentation_size, entry.weight);
+        m_private->full_name_to_font_map.set(move(qualified_name), { *typeface, entry.presentation_size, entry.is_fixed_width });
+    }
+}
+
 void FontDatabase::for_each_font(Function<void(const Gfx::Font&)> callback)
 {
-    Vector<RefPtr<Gfx::Font>> fonts;
-    fonts.ensure_capacity(m_private->full_name_to_font_map.size());
+    Vector<String> names;
+    names.ensure_capacity(m_private->full_name_to_font_map.size());
     for (auto& it : m_private->full_name_to_font_map)
-        fonts.append(it.value);
-    quick_sort(fonts, [](auto& a, auto& b) { return a->qualified_name() < b->qualified_name(); });
-    for (auto& font : fonts)
-        callback(*font);
+        names.append(it.key);
+    quick_sort(names);
+    for (auto& name : names) {
+        if (auto font = get_by_name(name))
+            callback(*font);
+    }
 }
 
 void FontDatabase::for_each_fixed_width_font(Function<void(const Gfx::Font&)> callback)
 {
-    Vector<RefPtr<Gfx::Font>> fonts;
-    fonts.ensure_capacity(m_private->full_name_to_font_map.size());
+    Vector<String> names;
+    names.ensure_capacity(m_private->full_name_to_font_map.size());
     for (auto& it : m_private->full_name_to_font_map) {
-        if (it.value->is_fixed_width())
-            fonts.append(it.value);
+        if (it.value.is_fixed_width)
+            names.append(it.key);
+    }
+    quick_sort(names);
+    for (auto& name : names) {
+        if (auto font = get_by_name(name))
+            callback(*font);
     }
-    quick_sort(fonts, [](auto& a, auto& b) { return a->qualified_name() < b->qualified_name(); });
-    for (auto& font : fonts)
-        callback(*font);
 }
 
 RefPtr<Gfx::Font> FontDatabase::get_by_name(StringView name)
@@ -150,7 +184,7 @@ RefPtr<Gfx::Font> FontDatabase::get_by_name(StringView name)
         dbgln("Font lookup failed: '{}'", name);
         return nullptr;
     }
-    return it->value;
+    return it->value.typeface->get_font(it->value.presentation_size);
 }
 
 RefPtr<Gfx::Font> FontDatabase::get(const String& family, unsigned size, unsigned weight)
@@ -54,6 +54,7 @@ private:
     FontDatabase();
     ~FontDatabase();
 
+    void load_from_index(FontIndex const&);
     RefPtr<Typeface> get_or_create_typeface(const String& family, const String& variant);
 
     struct Private;
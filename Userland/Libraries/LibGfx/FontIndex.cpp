@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/LexicalPath.h>
+#include <AK/Vector.h>
+#include <LibCore/DirIterator.h>
+#include <LibCore/System.h>
+#include <LibGfx/BitmapFont.h>
+#include <LibGfx/FontIndex.h>
+#include <LibGfx/TrueTypeFont/Font.h>
+
+namespace Gfx {
+
+static constexpr u32 font_index_magic = 0x78496e46; // "FnIx"
+static constexpr u32 font_index_version = 1;
+
+struct [[gnu::packed]] FontIndexHeader {
+    u32 magic;
+    u32 version;
+    u32 entry_count;
+    u32 strings_size;
+    i64 directory_modification_time;
+};
+
+// Offset and length into the strings that follow the entries.
+struct [[gnu::packed]] FontIndexString {
+    u32 offset;
+    u32 length;
+};
+
+enum FontIndexFlags : u8 {
+    TrueType = 1 << 0,
+    FixedWidth = 1 << 1,
+};
+
+struct [[gnu::packed]] FontIndexEntry {
+    FontIndexString file_name;
+    FontIndexString family;
+    FontIndexString variant;
+    u16 weight;
+    u8 presentation_size;
+    u8 flags;
+};
+
+FontIndex::FontIndex(NonnullRefPtr<Core::MappedFile> file, size_t entry_count)
+    : m_file(move(file))
+    , m_entry_count(entry_count)
+{
+}
+
+ErrorOr<NonnullOwnPtr<FontIndex>> FontIndex::try_open(String const& path, String const& fonts_directory)
+{
+    auto file = TRY(Core::MappedFile::map(path));
+    if (file->size() < sizeof(FontIndexHeader))
+        return Error::from_string_literal("Font index is truncated"sv);
+    auto const& header = *reinterpret_cast<FontIndexHeader const*>(file->data());
+    if (header.magic != font_index_magic || header.version != font_index_version)
+        return Error::from_string_literal("Font index has an unknown format"sv);
+    if (file->size() != sizeof(FontIndexHeader) + header.entry_count * sizeof(FontIndexEntry) + header.strings_size)
+        return Error::from_string_literal("Font index is truncated"sv);
+
+    // Adding, removing or renaming a font updates the directory's modification time, after which the index is stale.
+    auto directory_stat = TRY(Core::System::stat(fonts_directory));
+    if (directory_stat.st_mtime != header.directory_modification_time)
+        return Error::from_string_literal("Font index is out of date"sv);
+
+    auto const* entries = reinterpret_cast<FontIndexEntry const*>(file->bytes().offset(sizeof(FontIndexHeader)));
+    auto is_valid = [&](FontIndexString const& string) {
+        return string.offset <= header.strings_size && string.length <= header.strings_size - string.offset;
+    };
+    for (size_t i = 0; i < header.entry_count; ++i) {
+        auto& entry = entries[i];
+        if (!is_valid(entry.file_name) || !is_valid(entry.family) || !is_valid(entry.variant))
+            return Error::from_string_literal("Font index is corrupt"sv);
+    }
+
+    return adopt_nonnull_own_or_enomem(new (nothrow) FontIndex(move(file), header.entry_count));
+}
+
+FontIndex::Entry FontIndex::entry(size_t index) const
+{
+    VERIFY(index < m_entry_count);
+    auto bytes = m_file->bytes();
+    auto const& raw_entry = reinterpret_cast<FontIndexEntry const*>(bytes.offset(sizeof(FontIndexHeader)))[index];
+    auto strings = bytes.slice(sizeof(FontIndexHeader) + m_entry_count * sizeof(FontIndexEntry));
+    auto string = [&](FontIndexString const& string) {
+        return StringView { strings.slice(string.offset, string.length) };
+    };
+
+    return {
+        .file_name = string(raw_entry.file_name),
+        .family = string(raw_entry.family),
+        .variant = string(raw_entry.variant),
+        .weight = raw_entry.weight,
+        .presentation_size = raw_entry.presentation_size,
+        .is_truetype = (raw_entry.flags & FontIndexFlags::TrueType) != 0,
+        .is_fixed_width = (raw_entry.flags & FontIndexFlags::FixedWidth) != 0,
+    };
+}
+
+ErrorOr<ByteBuffer> FontIndex::generate(String const& fonts_directory)
+{
+    // Stat the directory first, so that anything changing it while we're scanning makes the index stale right away.
+    auto directory_stat = TRY(Core::System::stat(fonts_directory));
+
+    Vector<FontIndexEntry> entries;
+    ByteBuffer strings;
+    auto add_string = [&](StringView string) -> ErrorOr<FontIndexString> {
+        FontIndexString index_string { static_cast<u32>(strings.size()), static_cast<u32>(string.length()) };
+        TRY(strings.try_append(string.bytes()));
+        return index_string;
+    };
+    auto add_entry = [&](String const& path, auto const& font, u8 presentation_size, u8 flags) -> ErrorOr<void> {
+        FontIndexEntry entry;
+        entry.file_name = TRY(add_string(LexicalPath::basename(path)));
+        entry.family = TRY(add_string(font.family()));
+        entry.variant = TRY(add_string(font.variant()));
+        entry.weight = font.weight();
+        entry.presentation_size = presentation_size;
+        entry.flags = flags | (font.is_fixed_width() ? FontIndexFlags::FixedWidth : 0);
+        TRY(entries.try_append(entry));
+        return {};
+    };
+
+    // NOTE: The entries are in directory order, just like the fonts are when FontDatabase scans the directory itself.
+    Core::DirIterator dir_iterator(fonts_directory, Core::DirIterator::SkipDots);
+    if (dir_iterator.has_error())
+        return Error::from_errno(dir_iterator.error());
+    while (dir_iterator.has_next()) {
+        auto path = dir_iterator.next_full_path();
+        if (path.ends_with(".font"sv)) {
+            if (auto font = BitmapFont::load_from_file(path))
+                TRY(add_entry(path, *font, font->presentation_size(), 0));
+        } else if (path.ends_with(".ttf"sv)) {
+            // FIXME: What about .otf and .woff
+            if (auto font_or_error = TTF::Font::try_load_from_file(path); !font_or_error.is_error())
+                TRY(add_entry(path, *font_or_error.value(), 0, FontIndexFlags::TrueType));
+        }
+    }
+
+    FontIndexHeader header {
+        .magic = font_index_magic,
+        .version = font_index_version,
+        .entry_count = static_cast<u32>(entries.size()),
+        .strings_size = static_cast<u32>(strings.size()),
+        .directory_modification_time = directory_stat.st_mtime,
+    };
+
+    ByteBuffer index;
+    TRY(index.try_append(&header, sizeof(header)));
+    TRY(index.try_append(entries.data(), entries.size() * sizeof(FontIndexEntry)));
+    TRY(index.try_append(strings.bytes()));
+    return index;
+}
+
+}
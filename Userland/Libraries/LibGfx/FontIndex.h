@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/Error.h>
+#include <AK/OwnPtr.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/StringView.h>
+#include <LibCore/MappedFile.h>
+
+namespace Gfx {
+
+// The font index lists every font in a directory, along with what FontDatabase needs to know about it. Processes map
+// it instead of scanning the directory and parsing every font on startup, so a font file is only mapped once it's used.
+// It's written by mkfontindex(8), and ignored once the directory has changed since.
+class FontIndex {
+public:
+    struct Entry {
+        StringView file_name;
+        StringView family;
+        StringView variant;
+        unsigned weight { 0 };
+        unsigned presentation_size { 0 };
+        bool is_truetype { false };
+        bool is_fixed_width { false };
+    };
+
+    static constexpr StringView system_fonts_directory = "/res/fonts"sv;
+    static constexpr StringView system_index_path = "/res/fonts.index"sv;
+
+    static ErrorOr<NonnullOwnPtr<FontIndex>> try_open(String const& path, String const& fonts_directory);
+    static ErrorOr<ByteBuffer> generate(String const& fonts_directory);
+
+    size_t entry_count() const { return m_entry_count; }
+    Entry entry(size_t index) const;
+
+private:
+    FontIndex(NonnullRefPtr<Core::MappedFile>, size_t entry_count);
+
+    NonnullRefPtr<Core::MappedFile> m_file;
+    size_t m_entry_count { 0 };
+};
+
+}
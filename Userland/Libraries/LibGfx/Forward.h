@@ -14,7 +14,9 @@ class Color;
 class DisjointRectSet;
 class Emoji;
 class Font;
+class FontIndex;
 class GlyphBitmap;
+class IconCache;
 class ImageDecoder;
 struct FontMetrics;
 
@@ -28,7 +28,9 @@ struct GIFImageDescriptor {
     bool interlaced { false };
     Color color_map[256];
     u8 lzw_min_code_size { 0 };
-    Vector<u8> lzw_encoded_bytes;
+    // Offset of the image data sub-blocks in the file. They're decoded from there every time the frame is
+    // needed, instead of keeping a copy around.
+    size_t lzw_data_offset { 0 };
 
     // Fields from optional graphic control extension block
     enum DisposalMethod : u8 {
@@ -104,13 +106,44 @@ static Optional<GIFFormat> decode_gif_header(InputMemoryStream& stream)
     return {};
 }
 
+// Reads the bytes of a run of data sub-blocks, straight out of the encoded file.
+class SubBlockReader {
+public:
+    SubBlockReader(ReadonlyBytes data, size_t first_block_offset)
+        : m_data(data)
+        , m_offset(first_block_offset)
+    {
+    }
+
+    Optional<u8> next_byte()
+    {
+        if (m_remaining_in_block == 0) {
+            if (m_offset >= m_data.size() || m_data[m_offset] == 0)
+                return {};
+            m_remaining_in_block = m_data[m_offset++];
+        }
+        if (m_offset >= m_data.size())
+            return {};
+        --m_remaining_in_block;
+        return m_data[m_offset++];
+    }
+
+private:
+    ReadonlyBytes m_data;
+    size_t m_offset { 0 };
+    u8 m_remaining_in_block { 0 };
+};
+
+// The code table stores every string as its prefix code plus one more byte, so adding a string is
+// constant time and the table is a few fixed-size arrays instead of a vector per string.
 class LZWDecoder {
 private:
     static constexpr int max_code_size = 12;
+    static constexpr size_t max_table_size = 1 << max_code_size;
 
 public:
-    explicit LZWDecoder(const Vector<u8>& lzw_bytes, u8 min_code_size)
-        : m_lzw_bytes(lzw_bytes)
+    LZWDecoder(SubBlockReader reader, u8 min_code_size)
+        : m_reader(reader)
         , m_code_size(min_code_size)
         , m_original_code_size(min_code_size)
         , m_table_capacity(AK::exp2<u32>(min_code_size))
@@ -120,10 +153,10 @@ public:
 
     u16 add_control_code()
     {
-        const u16 control_code = m_code_table.size();
-        m_code_table.append(Vector<u8> {});
-        m_original_code_table.append(Vector<u8> {});
-        if (m_code_table.size() >= m_table_capacity && m_code_size < max_code_size) {
+        const u16 control_code = m_table_size;
+        m_lengths[m_table_size++] = 0;
+        m_original_table_size = m_table_size;
+        if (m_table_size >= m_table_capacity && m_code_size < max_code_size) {
 
             ++m_code_size;
             ++m_original_code_size;
@@ -134,101 +167,117 @@ public:
 
     void reset()
     {
-        m_code_table.clear();
-        m_code_table.extend(m_original_code_table);
+        m_table_size = m_original_table_size;
         m_code_size = m_original_code_size;
         m_table_capacity = AK::exp2<u32>(m_code_size);
-        m_output.clear();
+        m_previous_code = {};
     }
 
     Optional<u16> next_code()
     {
-        size_t current_byte_index = m_current_bit_index / 8;
-        if (current_byte_index >= m_lzw_bytes.size()) {
+        // Codes are packed starting from the least significant bit. If the data runs out in the
+        // middle of a code, its missing bits are read as zeroes.
+        if (m_bits_in_buffer == 0 && !refill_bit_buffer())
             return {};
-        }
+        while (m_bits_in_buffer < m_code_size && refill_bit_buffer()) { }
 
-        // Extract the code bits using a 32-bit mask to cover the possibility that if
-        // the current code size > 9 bits then the code can span 3 bytes.
-        u8 current_bit_offset = m_current_bit_index % 8;
-        u32 mask = (u32)(m_table_capacity - 1) << current_bit_offset;
+        m_current_code = m_bit_buffer & (m_table_capacity - 1);
 
-        // Make a padded copy of the final bytes in the data to ensure we don't read past the end.
-        if (current_byte_index + sizeof(mask) > m_lzw_bytes.size()) {
-            u8 padded_last_bytes[sizeof(mask)] = { 0 };
-            for (int i = 0; current_byte_index + i < m_lzw_bytes.size(); ++i) {
-                padded_last_bytes[i] = m_lzw_bytes[current_byte_index + i];
-            }
-            const u32* addr = (const u32*)&padded_last_bytes;
-            m_current_code = (*addr & mask) >> current_bit_offset;
-        } else {
-            u32 tmp_word;
-            memcpy(&tmp_word, &m_lzw_bytes.at(current_byte_index), sizeof(u32));
-            m_current_code = (tmp_word & mask) >> current_bit_offset;
-        }
-
-        if (m_current_code > m_code_table.size()) {
-            dbgln_if(GIF_DEBUG, "Corrupted LZW stream, invalid code: {} at bit index {}, code table size: {}",
+        if (m_current_code > m_table_size) {
+            dbgln_if(GIF_DEBUG, "Corrupted LZW stream, invalid code: {}, code table size: {}",
                 m_current_code,
-                m_current_bit_index,
-                m_code_table.size());
+                m_table_size);
             return {};
-        } else if (m_current_code == m_code_table.size() && m_output.is_empty()) {
-            dbgln_if(GIF_DEBUG, "Corrupted LZW stream, valid new code but output buffer is empty: {} at bit index {}, code table size: {}",
+        } else if (m_current_code == m_table_size && !m_previous_code.has_value()) {
+            dbgln_if(GIF_DEBUG, "Corrupted LZW stream, valid new code but output buffer is empty: {}, code table size: {}",
                 m_current_code,
-                m_current_bit_index,
-                m_code_table.size());
+                m_table_size);
             return {};
         }
 
-        m_current_bit_index += m_code_size;
+        m_bit_buffer >>= m_code_size;
+        m_bits_in_buffer -= min(m_bits_in_buffer, (u32)m_code_size);
 
         return m_current_code;
     }
 
-    Vector<u8>& get_output()
+    ReadonlyBytes get_output()
     {
-        VERIFY(m_current_code <= m_code_table.size());
-        if (m_current_code < m_code_table.size()) {
-            Vector<u8> new_entry = m_output;
-            m_output = m_code_table.at(m_current_code);
-            new_entry.append(m_output[0]);
-            extend_code_table(new_entry);
-        } else if (m_current_code == m_code_table.size()) {
-            VERIFY(!m_output.is_empty());
-            m_output.append(m_output[0]);
-            extend_code_table(m_output);
+        VERIFY(m_current_code <= m_table_size);
+        if (m_current_code < m_table_size) {
+            if (m_previous_code.has_value())
+                extend_code_table(m_previous_code.value(), m_first_bytes[m_current_code]);
+        } else {
+            VERIFY(m_previous_code.has_value());
+            extend_code_table(m_previous_code.value(), m_first_bytes[m_previous_code.value()]);
         }
-        return m_output;
+
+        // If the table was already full, a code one past its end is its previous string plus that string's first byte.
+        u16 code = m_current_code;
+        size_t length = code < m_table_size ? m_lengths[code] : m_lengths[m_previous_code.value()] + 1;
+        size_t position = length;
+        if (code >= m_table_size) {
+            m_output[--position] = m_first_bytes[m_previous_code.value()];
+            code = m_previous_code.value();
+        }
+        while (position > 0) {
+            m_output[--position] = m_suffixes[code];
+            code = m_prefixes[code];
+        }
+
+        m_previous_code = m_current_code;
+        return { m_output.data(), length };
     }
 
 private:
     void init_code_table()
     {
-        m_code_table.ensure_capacity(m_table_capacity);
         for (u16 i = 0; i < m_table_capacity; ++i) {
-            m_code_table.unchecked_append({ (u8)i });
+            m_prefixes[i] = 0;
+            m_suffixes[i] = i;
+            m_first_bytes[i] = i;
+            m_lengths[i] = 1;
         }
-        m_original_code_table = m_code_table;
+        m_table_size = m_table_capacity;
+        m_original_table_size = m_table_size;
     }
 
-    void extend_code_table(const Vector<u8>& entry)
+    bool refill_bit_buffer()
     {
-        if (entry.size() > 1 && m_code_table.size() < 4096) {
-            m_code_table.append(entry);
-            if (m_code_table.size() >= m_table_capacity && m_code_size < max_code_size) {
+        auto byte = m_reader.next_byte();
+        if (!byte.has_value())
+            return false;
+        m_bit_buffer |= (u32)byte.value() << m_bits_in_buffer;
+        m_bits_in_buffer += 8;
+        return true;
+    }
+
+    void extend_code_table(u16 prefix, u8 suffix)
+    {
+        if (m_table_size < max_table_size) {
+            m_prefixes[m_table_size] = prefix;
+            m_suffixes[m_table_size] = suffix;
+            m_first_bytes[m_table_size] = m_first_bytes[prefix];
+            m_lengths[m_table_size] = m_lengths[prefix] + 1;
+            ++m_table_size;
+            if (m_table_size >= m_table_capacity && m_code_size < max_code_size) {
                 ++m_code_size;
                 m_table_capacity *= 2;
             }
         }
     }
 
-    const Vector<u8>& m_lzw_bytes;
+    SubBlockReader m_reader;
 
-    int m_current_bit_index { 0 };
+    u32 m_bit_buffer { 0 };
+    u32 m_bits_in_buffer { 0 };
 
-    Vector<Vector<u8>> m_code_table {};
-    Vector<Vector<u8>> m_original_code_table {};
+    Array<u16, max_table_size> m_prefixes;
+    Array<u8, max_table_size> m_suffixes;
+    Array<u8, max_table_size> m_first_bytes;
+    Array<u16, max_table_size> m_lengths;
+    u16 m_table_size { 0 };
+    u16 m_original_table_size { 0 };
 
     u8 m_code_size { 0 };
     u8 m_original_code_size { 0 };
@@ -236,7 +285,10 @@ private:
     u32 m_table_capacity { 0 };
 
     u16 m_current_code { 0 };
-    Vector<u8> m_output {};
+    Optional<u16> m_previous_code;
+
+    // No string can be longer than the number of codes that it took to build it.
+    Array<u8, max_table_size> m_output;
 };
 
 static void copy_frame_buffer(Bitmap& dest, const Bitmap& src)
@@ -320,7 +372,7 @@ static bool decode_frame(GIFLoadingContext& context, size_t frame_index)
         if (image.lzw_min_code_size > 8)
             return false;
 
-        LZWDecoder decoder(image.lzw_encoded_bytes, image.lzw_min_code_size);
+        LZWDecoder decoder({ { context.data, context.data_size }, image.lzw_data_offset }, image.lzw_min_code_size);
 
         // Add GIF-specific control codes
         const int clear_code = decoder.add_control_code();
@@ -328,9 +380,20 @@ static bool decode_frame(GIFLoadingContext& context, size_t frame_index)
 
         const auto& color_map = image.use_global_color_map ? context.logical_screen.color_map : image.color_map;
 
-        int pixel_index = 0;
+        // Only the part of the image that's inside the logical screen is drawn.
+        auto& frame_buffer = *context.frame_buffer;
+        int visible_columns = clamp((int)context.logical_screen.width - image.x, 0, (int)image.width);
+
+        int column = 0;
         int row = 0;
         int interlace_pass = 0;
+        RGBA32* scanline = nullptr;
+        auto update_scanline = [&] {
+            int y = row + image.y;
+            scanline = (visible_columns > 0 && row < image.height && y < frame_buffer.height()) ? frame_buffer.scanline(y) + image.x : nullptr;
+        };
+        update_scanline();
+
         while (true) {
             Optional<u16> code = decoder.next_code();
             if (!code.has_value()) {
@@ -348,32 +411,28 @@ static bool decode_frame(GIFLoadingContext& context, size_t frame_index)
                 continue;
 
             auto colors = decoder.get_output();
-            for (const auto& color : colors) {
-                auto c = color_map[color];
-
-                int x = pixel_index % image.width + image.x;
-                int y = row + image.y;
+            for (auto color : colors) {
+                if (scanline && column < visible_columns && (!image.transparent || color != image.transparency_index))
+                    scanline[column] = color_map[color].value();
 
-                if (context.frame_buffer->rect().contains(x, y) && (!image.transparent || color != image.transparency_index)) {
-                    context.frame_buffer->set_pixel(x, y, c);
-                }
+                if (++column < image.width)
+                    continue;
 
-                ++pixel_index;
-                if (pixel_index % image.width == 0) {
-                    if (image.interlaced) {
-                        if (interlace_pass < 4) {
-                            if (row + INTERLACE_ROW_STRIDES[interlace_pass] >= image.height) {
-                                ++interlace_pass;
-                                if (interlace_pass < 4)
-                                    row = INTERLACE_ROW_OFFSETS[interlace_pass];
-                            } else {
-                                row += INTERLACE_ROW_STRIDES[interlace_pass];
-                            }
+                column = 0;
+                if (image.interlaced) {
+                    if (interlace_pass < 4) {
+                        if (row + INTERLACE_ROW_STRIDES[interlace_pass] >= image.height) {
+                            ++interlace_pass;
+                            if (interlace_pass < 4)
+                                row = INTERLACE_ROW_OFFSETS[interlace_pass];
+                        } else {
+                            row += INTERLACE_ROW_STRIDES[interlace_pass];
                         }
-                    } else {
-                        ++row;
                     }
+                } else {
+                    ++row;
                 }
+                update_scanline();
             }
         }
 
@@ -561,6 +620,8 @@ static bool load_gif_frame_descriptors(GIFLoadingContext& context)
             if (stream.handle_any_error())
                 return false;
 
+            image.lzw_data_offset = stream.offset();
+
             u8 lzw_encoded_bytes_expected = 0;
 
             for (;;) {
@@ -572,15 +633,9 @@ static bool load_gif_frame_descriptors(GIFLoadingContext& context)
                 if (lzw_encoded_bytes_expected == 0)
                     break;
 
-                Array<u8, 256> buffer;
-                stream >> buffer.span().trim(lzw_encoded_bytes_expected);
-
+                stream.discard_or_error(lzw_encoded_bytes_expected);
                 if (stream.handle_any_error())
                     return false;
-
-                for (int i = 0; i < lzw_encoded_bytes_expected; ++i) {
-                    image.lzw_encoded_bytes.append(buffer[i]);
-                }
             }
 
             current_image = make<GIFImageDescriptor>();
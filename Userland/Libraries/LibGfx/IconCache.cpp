@@ -0,0 +1,264 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/QuickSort.h>
+#include <AK/Vector.h>
+#include <LibCore/DirIterator.h>
+#include <LibCore/System.h>
+#include <LibGfx/Bitmap.h>
+#include <LibGfx/IconCache.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+namespace Gfx {
+
+static constexpr u32 icon_cache_magic = 0x63496649; // "IfIc"
+static constexpr u32 icon_cache_version = 1;
+static constexpr int max_icon_dimension = 4096;
+
+struct [[gnu::packed]] IconCacheHeader {
+    u32 magic;
+    u32 version;
+    u32 entry_count;
+    u32 strings_size;
+    // This includes the files that couldn't be decoded, which aren't in the cache.
+    u32 file_count;
+};
+
+// The entries are sorted by path. Their pixels follow the paths, and are stored without any padding between rows.
+struct [[gnu::packed]] IconCacheEntry {
+    u32 path_offset;
+    u32 path_length;
+    u32 width;
+    u32 height;
+    u32 format;
+    u32 pixels_offset;
+    i64 modification_time;
+    u64 file_size;
+};
+
+static size_t pixels_size(IconCacheEntry const& entry)
+{
+    return static_cast<size_t>(entry.width) * entry.height * sizeof(RGBA32);
+}
+
+IconCache::IconCache(NonnullRefPtr<Core::MappedFile> file, size_t entry_count)
+    : m_file(move(file))
+    , m_entry_count(entry_count)
+{
+}
+
+IconCache const* IconCache::the()
+{
+    // NOTE: This is never destroyed, since the cached bitmaps point into the mapping.
+    static IconCache const* s_the = []() -> IconCache const* {
+        auto cache_or_error = try_open(system_cache_path);
+        if (cache_or_error.is_error())
+            return nullptr;
+        return cache_or_error.release_value().leak_ptr();
+    }();
+    return s_the;
+}
+
+ErrorOr<NonnullOwnPtr<IconCache>> IconCache::try_open(String const& path)
+{
+    auto file = TRY(Core::MappedFile::map(path));
+    if (file->size() < sizeof(IconCacheHeader))
+        return Error::from_string_literal("Icon cache is truncated"sv);
+    auto const& header = *reinterpret_cast<IconCacheHeader const*>(file->data());
+    if (header.magic != icon_cache_magic || header.version != icon_cache_version)
+        return Error::from_string_literal("Icon cache has an unknown format"sv);
+
+    size_t strings_offset = sizeof(IconCacheHeader) + static_cast<size_t>(header.entry_count) * sizeof(IconCacheEntry);
+    if (strings_offset > file->size() || header.strings_size > file->size() - strings_offset)
+        return Error::from_string_literal("Icon cache is truncated"sv);
+
+    auto const* entries = reinterpret_cast<IconCacheEntry const*>(file->bytes().offset(sizeof(IconCacheHeader)));
+    for (size_t i = 0; i < header.entry_count; ++i) {
+        auto& entry = entries[i];
+        bool is_valid = entry.path_offset <= header.strings_size
+            && entry.path_length <= header.strings_size - entry.path_offset
+            && (entry.format == static_cast<u32>(BitmapFormat::BGRx8888) || entry.format == static_cast<u32>(BitmapFormat::BGRA8888))
+            && entry.width > 0 && entry.width <= max_icon_dimension
+            && entry.height > 0 && entry.height <= max_icon_dimension
+            && entry.pixels_offset % sizeof(RGBA32) == 0
+            && entry.pixels_offset <= file->size()
+            && pixels_size(entry) <= file->size() - entry.pixels_offset;
+        if (!is_valid)
+            return Error::from_string_literal("Icon cache is corrupt"sv);
+    }
+
+    return adopt_nonnull_own_or_enomem(new (nothrow) IconCache(move(file), header.entry_count));
+}
+
+static IconCacheEntry const* entries_of(ReadonlyBytes bytes)
+{
+    return reinterpret_cast<IconCacheEntry const*>(bytes.offset(sizeof(IconCacheHeader)));
+}
+
+static StringView path_of(ReadonlyBytes bytes, IconCacheEntry const& entry)
+{
+    auto const& header = *reinterpret_cast<IconCacheHeader const*>(bytes.data());
+    auto strings = bytes.slice(sizeof(IconCacheHeader) + header.entry_count * sizeof(IconCacheEntry), header.strings_size);
+    return StringView { strings.slice(entry.path_offset, entry.path_length) };
+}
+
+static bool is_entry_up_to_date(IconCacheEntry const& entry, StringView path)
+{
+    auto stat_or_error = Core::System::stat(path);
+    if (stat_or_error.is_error())
+        return false;
+    auto& stat = stat_or_error.value();
+    return stat.st_mtime == entry.modification_time && static_cast<u64>(stat.st_size) == entry.file_size;
+}
+
+RefPtr<Bitmap> IconCache::get(StringView path, int scale_factor) const
+{
+    auto bytes = m_file->bytes();
+    auto const* entries = entries_of(bytes);
+    IconCacheEntry const* entry = nullptr;
+    size_t low = 0;
+    size_t high = m_entry_count;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        auto middle_path = path_of(bytes, entries[middle]);
+        if (middle_path == path) {
+            entry = &entries[middle];
+            break;
+        }
+        if (middle_path < path)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    if (!entry || !is_entry_up_to_date(*entry, path))
+        return nullptr;
+
+    if (entry->width % scale_factor != 0 || entry->height % scale_factor != 0)
+        return nullptr;
+    IntSize size { entry->width / scale_factor, entry->height / scale_factor };
+    auto* pixels = const_cast<u8*>(bytes.offset(entry->pixels_offset));
+    auto bitmap_or_error = Bitmap::try_create_wrapper(static_cast<BitmapFormat>(entry->format), size, scale_factor, entry->width * sizeof(RGBA32), pixels);
+    if (bitmap_or_error.is_error())
+        return nullptr;
+    return bitmap_or_error.release_value();
+}
+
+template<typename Callback>
+static ErrorOr<void> for_each_icon_file(String const& directory, Callback const& callback)
+{
+    Core::DirIterator dir_iterator(directory, Core::DirIterator::SkipDots);
+    if (dir_iterator.has_error())
+        return Error::from_errno(dir_iterator.error());
+    while (dir_iterator.has_next()) {
+        auto path = dir_iterator.next_full_path();
+        auto stat = TRY(Core::System::lstat(path));
+        if (S_ISDIR(stat.st_mode))
+            TRY(for_each_icon_file(path, callback));
+        else if (S_ISREG(stat.st_mode) && Bitmap::is_path_a_supported_image_format(path))
+            TRY(callback(path, stat));
+    }
+    return {};
+}
+
+bool IconCache::is_up_to_date(String const& icons_directory) const
+{
+    auto bytes = m_file->bytes();
+    auto const& header = *reinterpret_cast<IconCacheHeader const*>(bytes.data());
+
+    // An icon that was added shows up in the file count, and one that was removed or changed in its entry.
+    size_t file_count = 0;
+    auto result = for_each_icon_file(icons_directory, [&](auto&, auto&) -> ErrorOr<void> {
+        ++file_count;
+        return {};
+    });
+    if (result.is_error() || file_count != header.file_count)
+        return false;
+
+    auto const* entries = entries_of(bytes);
+    for (size_t i = 0; i < m_entry_count; ++i) {
+        if (!is_entry_up_to_date(entries[i], path_of(bytes, entries[i])))
+            return false;
+    }
+    return true;
+}
+
+ErrorOr<ByteBuffer> IconCache::generate(String const& icons_directory)
+{
+    struct Icon {
+        String path;
+        struct stat stat;
+        NonnullRefPtr<Bitmap> bitmap;
+    };
+    Vector<Icon> icons;
+    size_t file_count = 0;
+    TRY(for_each_icon_file(icons_directory, [&](auto& path, auto& stat) -> ErrorOr<void> {
+        ++file_count;
+        // NOTE: This decodes the file itself, rather than going through Bitmap::try_load_from_file() and the cache.
+        auto fd = TRY(Core::System::open(path, O_RDONLY));
+        auto bitmap_or_error = Bitmap::try_load_from_fd_and_close(fd, path);
+        if (bitmap_or_error.is_error())
+            return {};
+        auto bitmap = bitmap_or_error.release_value();
+        if (bitmap->format() != BitmapFormat::BGRx8888 && bitmap->format() != BitmapFormat::BGRA8888)
+            return {};
+        if (bitmap->physical_width() > max_icon_dimension || bitmap->physical_height() > max_icon_dimension)
+            return {};
+        TRY(icons.try_append({ path, stat, move(bitmap) }));
+        return {};
+    }));
+    quick_sort(icons, [](auto& a, auto& b) { return a.path < b.path; });
+
+    Vector<IconCacheEntry> entries;
+    TRY(entries.try_ensure_capacity(icons.size()));
+    ByteBuffer strings;
+    size_t pixels_offset = sizeof(IconCacheHeader) + icons.size() * sizeof(IconCacheEntry);
+    for (auto& icon : icons)
+        pixels_offset += icon.path.length();
+    pixels_offset = align_up_to(pixels_offset, sizeof(RGBA32));
+
+    for (auto& icon : icons) {
+        IconCacheEntry entry;
+        entry.path_offset = strings.size();
+        entry.path_length = icon.path.length();
+        entry.width = icon.bitmap->physical_width();
+        entry.height = icon.bitmap->physical_height();
+        entry.format = static_cast<u32>(icon.bitmap->format());
+        entry.pixels_offset = pixels_offset;
+        entry.modification_time = icon.stat.st_mtime;
+        entry.file_size = icon.stat.st_size;
+        TRY(strings.try_append(icon.path.bytes()));
+        pixels_offset += pixels_size(entry);
+        if (pixels_offset > NumericLimits<u32>::max())
+            return Error::from_string_literal("Icon cache would be too large"sv);
+        entries.unchecked_append(entry);
+    }
+
+    IconCacheHeader header {
+        .magic = icon_cache_magic,
+        .version = icon_cache_version,
+        .entry_count = static_cast<u32>(entries.size()),
+        .strings_size = static_cast<u32>(strings.size()),
+        .file_count = static_cast<u32>(file_count),
+    };
+
+    ByteBuffer cache;
+    TRY(cache.try_ensure_capacity(pixels_offset));
+    TRY(cache.try_append(&header, sizeof(header)));
+    TRY(cache.try_append(entries.data(), entries.size() * sizeof(IconCacheEntry)));
+    TRY(cache.try_append(strings.bytes()));
+    while (cache.size() % sizeof(RGBA32) != 0)
+        TRY(cache.try_append(0));
+    for (auto& icon : icons) {
+        auto& bitmap = *icon.bitmap;
+        for (int y = 0; y < bitmap.physical_height(); ++y)
+            TRY(cache.try_append(bitmap.scanline(y), bitmap.physical_width() * sizeof(RGBA32)));
+    }
+    VERIFY(cache.size() == pixels_offset);
+    return cache;
+}
+
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/Error.h>
+#include <AK/OwnPtr.h>
+#include <AK/RefPtr.h>
+#include <AK/StringView.h>
+#include <LibCore/MappedFile.h>
+#include <LibGfx/Forward.h>
+
+namespace Gfx {
+
+// The icon cache holds every icon in a directory, already decoded. Since the cache file is mapped read-only, all
+// processes share the same copy of an icon, and no longer decode it themselves. It's written by mkiconcache(8).
+class IconCache {
+public:
+    static constexpr StringView system_icons_directory = "/res/icons"sv;
+    static constexpr StringView system_cache_path = "/res/icons.cache"sv;
+
+    // The system icon cache, or nullptr if there isn't one.
+    static IconCache const* the();
+
+    static ErrorOr<NonnullOwnPtr<IconCache>> try_open(String const& path);
+    static ErrorOr<ByteBuffer> generate(String const& icons_directory);
+
+    // Icons that were changed since the cache was written aren't returned, so they're decoded from the file instead.
+    // NOTE: The bitmap's pixels are read-only, so it has to be cloned before it can be painted on.
+    RefPtr<Bitmap> get(StringView path, int scale_factor = 1) const;
+
+    // Whether the cache has every icon in the directory, and nothing else.
+    bool is_up_to_date(String const& icons_directory) const;
+
+    size_t entry_count() const { return m_entry_count; }
+
+private:
+    IconCache(NonnullRefPtr<Core::MappedFile>, size_t entry_count);
+
+    NonnullRefPtr<Core::MappedFile> m_file;
+    size_t m_entry_count { 0 };
+};
+
+}
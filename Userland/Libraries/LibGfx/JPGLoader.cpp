@@ -155,8 +155,16 @@ struct HuffmanTableSpec {
     u8 code_counts[16] = { 0 };
     Vector<u8> symbols;
     Vector<u16> codes;
+    // The codes of each length are consecutive, so we only need the first code and symbol index for each length.
+    u16 first_code_of_length[16] = { 0 };
+    u16 first_symbol_of_length[16] = { 0 };
+    // Maps the next huffman_lookup_bits bits of the stream to the length of the code they start with in the high
+    // byte and its symbol in the low byte, or to 0 if the code is longer than that.
+    Vector<u16> lookup;
 };
 
+static constexpr size_t huffman_lookup_bits = 9;
+
 struct HuffmanStreamState {
     Vector<u8> stream;
     u8 bit_offset { 0 };
@@ -193,11 +201,27 @@ struct JPGLoadingContext {
 static void generate_huffman_codes(HuffmanTableSpec& table)
 {
     unsigned code = 0;
-    for (auto number_of_codes : table.code_counts) {
-        for (int i = 0; i < number_of_codes; i++)
+    for (size_t length = 0; length < 16; length++) {
+        table.first_code_of_length[length] = code;
+        table.first_symbol_of_length[length] = table.codes.size();
+        for (int i = 0; i < table.code_counts[length]; i++)
             table.codes.append(code++);
         code <<= 1;
     }
+
+    table.lookup.resize(1 << huffman_lookup_bits);
+    size_t code_index = 0;
+    for (size_t length = 1; length <= huffman_lookup_bits; length++) {
+        for (int i = 0; i < table.code_counts[length - 1]; i++, code_index++) {
+            if (code_index >= table.symbols.size())
+                return;
+            // Every sequence of bits that starts with this code decodes to its symbol.
+            size_t unused_bits = huffman_lookup_bits - length;
+            size_t first_entry = table.codes[code_index] << unused_bits;
+            for (size_t entry = first_entry; entry < first_entry + (1u << unused_bits); entry++)
+                table.lookup[entry] = (length << 8) | table.symbols[code_index];
+        }
+    }
 }
 
 static Optional<size_t> read_huffman_bits(HuffmanStreamState& hstream, size_t count = 1)
@@ -207,15 +231,19 @@ static Optional<size_t> read_huffman_bits(HuffmanStreamState& hstream, size_t co
         return {};
     }
     size_t value = 0;
-    while (count--) {
+    while (count > 0) {
         if (hstream.byte_offset >= hstream.stream.size()) {
             dbgln_if(JPG_DEBUG, "Huffman stream exhausted. This could be an error!");
             return {};
         }
+        // Take as many bits as we need from the current byte at once, MSB first.
         u8 current_byte = hstream.stream[hstream.byte_offset];
-        u8 current_bit = 1u & (u32)(current_byte >> (7 - hstream.bit_offset)); // MSB first.
-        hstream.bit_offset++;
-        value = (value << 1) | (size_t)current_bit;
+        size_t bits_left_in_byte = 8 - hstream.bit_offset;
+        size_t bits_to_read = min(count, bits_left_in_byte);
+        u8 bits = (current_byte >> (bits_left_in_byte - bits_to_read)) & ((1u << bits_to_read) - 1);
+        value = (value << bits_to_read) | bits;
+        count -= bits_to_read;
+        hstream.bit_offset += bits_to_read;
         if (hstream.bit_offset == 8) {
             hstream.byte_offset++;
             hstream.bit_offset = 0;
@@ -226,17 +254,37 @@ static Optional<size_t> read_huffman_bits(HuffmanStreamState& hstream, size_t co
 
 static Optional<u8> get_next_symbol(HuffmanStreamState& hstream, const HuffmanTableSpec& table)
 {
+    // Most codes are short, so look at the next few bits at once and see if they start with one we know.
+    if (hstream.byte_offset < hstream.stream.size() && !table.lookup.is_empty()) {
+        u32 next_bytes = 0;
+        for (size_t i = 0; i < 3; i++) {
+            size_t offset = hstream.byte_offset + i;
+            next_bytes = (next_bytes << 8) | (offset < hstream.stream.size() ? hstream.stream[offset] : 0);
+        }
+        size_t available_bits = (hstream.stream.size() - hstream.byte_offset) * 8 - hstream.bit_offset;
+        u16 entry = table.lookup[(next_bytes >> (24 - hstream.bit_offset - huffman_lookup_bits)) & ((1 << huffman_lookup_bits) - 1)];
+        size_t length = entry >> 8;
+        if (length != 0 && length <= available_bits) {
+            hstream.bit_offset += length;
+            hstream.byte_offset += hstream.bit_offset / 8;
+            hstream.bit_offset %= 8;
+            return entry & 0xff;
+        }
+    }
+
     unsigned code = 0;
-    size_t code_cursor = 0;
     for (int i = 0; i < 16; i++) { // Codes can't be longer than 16 bits.
         auto result = read_huffman_bits(hstream);
         if (!result.has_value())
             return {};
         code = (code << 1) | (i32)result.release_value();
-        for (int j = 0; j < table.code_counts[i]; j++) {
-            if (code == table.codes[code_cursor])
-                return table.symbols[code_cursor];
-            code_cursor++;
+        // NOTE: This wraps around for codes before the first one of this length.
+        unsigned index_in_length = code - table.first_code_of_length[i];
+        if (index_in_length < table.code_counts[i]) {
+            size_t symbol_index = table.first_symbol_of_length[i] + index_in_length;
+            if (symbol_index >= table.symbols.size())
+                return {};
+            return table.symbols[symbol_index];
         }
     }
 
@@ -281,14 +329,14 @@ static bool build_macroblocks(JPGLoadingContext& context, Vector<Macroblock>& ma
         if (component.ac_destination_id >= context.ac_tables.size())
             return false;
 
+        auto& dc_table = context.dc_tables.find(component.dc_destination_id)->value;
+        auto& ac_table = context.ac_tables.find(component.ac_destination_id)->value;
+
         for (u8 vfactor_i = 0; vfactor_i < component.vsample_factor; vfactor_i++) {
             for (u8 hfactor_i = 0; hfactor_i < component.hsample_factor; hfactor_i++) {
                 u32 mb_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hfactor_i + hcursor);
                 Macroblock& block = macroblocks[mb_index];
 
-                auto& dc_table = context.dc_tables.find(component.dc_destination_id)->value;
-                auto& ac_table = context.ac_tables.find(component.ac_destination_id)->value;
-
                 auto symbol_or_error = get_next_symbol(context.huffman_stream, dc_table);
                 if (!symbol_or_error.has_value())
                     return false;
@@ -1025,6 +1073,12 @@ static void inverse_dct(const JPGLoadingContext& context, Vector<Macroblock>& ma
 
 static void ycbcr_to_rgb(const JPGLoadingContext& context, Vector<Macroblock>& macroblocks)
 {
+    // The conversion factors in 16.16 fixed point: 1.402, 0.344, 0.714 and 1.772.
+    constexpr i32 cr_to_r = 91881;
+    constexpr i32 cb_to_g = 22544;
+    constexpr i32 cr_to_g = 46793;
+    constexpr i32 cb_to_b = 116130;
+
     for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.vsample_factor) {
         for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
             const u32 chroma_block_index = vcursor * context.mblock_meta.hpadded_count + hcursor;
@@ -1036,15 +1090,23 @@ static void ycbcr_to_rgb(const JPGLoadingContext& context, Vector<Macroblock>& m
                     i32* y = macroblocks[mb_index].y;
                     i32* cb = macroblocks[mb_index].cb;
                     i32* cr = macroblocks[mb_index].cr;
+                    // Work out where each row and column of this block samples the chroma block once, so we don't
+                    // have to divide by the sampling factors for every pixel.
+                    u8 chroma_pxrows[8];
+                    u8 chroma_pxcols[8];
+                    for (u8 k = 0; k < 8; ++k) {
+                        chroma_pxrows[k] = (k / context.vsample_factor) + 4 * vfactor_i;
+                        chroma_pxcols[k] = (k / context.hsample_factor) + 4 * hfactor_i;
+                    }
                     for (u8 i = 7; i < 8; --i) {
                         for (u8 j = 7; j < 8; --j) {
                             const u8 pixel = i * 8 + j;
-                            const u32 chroma_pxrow = (i / context.vsample_factor) + 4 * vfactor_i;
-                            const u32 chroma_pxcol = (j / context.hsample_factor) + 4 * hfactor_i;
-                            const u32 chroma_pixel = chroma_pxrow * 8 + chroma_pxcol;
-                            int r = y[pixel] + 1.402f * chroma.cr[chroma_pixel] + 128;
-                            int g = y[pixel] - 0.344f * chroma.cb[chroma_pixel] - 0.714f * chroma.cr[chroma_pixel] + 128;
-                            int b = y[pixel] + 1.772f * chroma.cb[chroma_pixel] + 128;
+                            const u32 chroma_pixel = chroma_pxrows[i] * 8 + chroma_pxcols[j];
+                            const i32 chroma_cb = chroma.cb[chroma_pixel];
+                            const i32 chroma_cr = chroma.cr[chroma_pixel];
+                            int r = y[pixel] + ((cr_to_r * chroma_cr) >> 16) + 128;
+                            int g = y[pixel] + ((-cb_to_g * chroma_cb - cr_to_g * chroma_cr) >> 16) + 128;
+                            int b = y[pixel] + ((cb_to_b * chroma_cb) >> 16) + 128;
                             y[pixel] = r < 0 ? 0 : (r > 255 ? 255 : r);
                             cb[pixel] = g < 0 ? 0 : (g > 255 ? 255 : g);
                             cr[pixel] = b < 0 ? 0 : (b > 255 ? 255 : b);
@@ -1065,16 +1127,15 @@ static bool compose_bitmap(JPGLoadingContext& context, const Vector<Macroblock>&
     if (bitmap_or_error.is_error())
         return false;
 
-    for (u32 y = context.frame.height - 1; y < context.frame.height; y--) {
+    for (u32 y = 0; y < context.frame.height; y++) {
         const u32 block_row = y / 8;
         const u32 pixel_row = y % 8;
+        auto* scanline = context.bitmap->scanline(y);
+        auto const* blocks_in_row = &macroblocks[block_row * context.mblock_meta.hpadded_count];
         for (u32 x = 0; x < context.frame.width; x++) {
-            const u32 block_column = x / 8;
-            auto& block = macroblocks[block_row * context.mblock_meta.hpadded_count + block_column];
-            const u32 pixel_column = x % 8;
-            const u32 pixel_index = pixel_row * 8 + pixel_column;
-            const Color color { (u8)block.y[pixel_index], (u8)block.cb[pixel_index], (u8)block.cr[pixel_index] };
-            context.bitmap->set_pixel(x, y, color);
+            auto& block = blocks_in_row[x / 8];
+            const u32 pixel_index = pixel_row * 8 + x % 8;
+            scanline[x] = 0xff000000 | (block.y[pixel_index] << 16) | (block.cb[pixel_index] << 8) | block.cr[pixel_index];
         }
     }
 
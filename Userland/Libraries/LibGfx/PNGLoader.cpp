@@ -6,7 +6,10 @@
 
 #include <AK/Debug.h>
 #include <AK/Endian.h>
+#include <AK/MemoryStream.h>
+#include <AK/SIMD.h>
 #include <AK/Vector.h>
+#include <LibCompress/Deflate.h>
 #include <LibCompress/Zlib.h>
 #include <LibGfx/PNGLoader.h>
 #include <fcntl.h>
@@ -17,7 +20,6 @@
 #include <unistd.h>
 
 #ifdef __serenity__
-#    include <LibCompress/Deflate.h>
 #    include <serenity.h>
 #endif
 
@@ -37,11 +39,6 @@ struct PNG_IHDR {
 
 static_assert(AssertSize<PNG_IHDR, 13>());
 
-struct Scanline {
-    u8 filter { 0 };
-    ReadonlyBytes data {};
-};
-
 struct [[gnu::packed]] PaletteEntry {
     u8 r;
     u8 g;
@@ -49,27 +46,6 @@ struct [[gnu::packed]] PaletteEntry {
     // u8 a;
 };
 
-template<typename T>
-struct [[gnu::packed]] Tuple {
-    T gray;
-    T a;
-};
-
-template<typename T>
-struct [[gnu::packed]] Triplet {
-    T r;
-    T g;
-    T b;
-};
-
-template<typename T>
-struct [[gnu::packed]] Quad {
-    T r;
-    T g;
-    T b;
-    T a;
-};
-
 enum PngInterlaceMethod {
     Null = 0,
     Adam7 = 1
@@ -97,9 +73,7 @@ struct PNGLoadingContext {
     u8 channels { 0 };
     bool has_seen_zlib_header { false };
     bool has_alpha() const { return color_type & 4 || palette_transparency_data.size() > 0; }
-    Vector<Scanline> scanlines;
     RefPtr<Gfx::Bitmap> bitmap;
-    ByteBuffer* decompression_buffer { nullptr };
     Vector<u8> compressed_data;
     Vector<PaletteEntry> palette_data;
     Vector<u8> palette_transparency_data;
@@ -117,6 +91,10 @@ struct PNGLoadingContext {
         }
         return row_size;
     }
+
+    // Filters work on bytes, and refer back to the same byte of the previous pixel, or to the previous byte for
+    // pixels smaller than a byte.
+    size_t bytes_per_complete_pixel() const { return max(1, channels * bit_depth / 8); }
 };
 
 class Streamer {
@@ -180,169 +158,195 @@ ALWAYS_INLINE static u8 paeth_predictor(int a, int b, int c)
     return c;
 }
 
-union [[gnu::packed]] Pixel {
-    RGBA32 rgba { 0 };
-    u8 v[4];
-    struct {
-        u8 r;
-        u8 g;
-        u8 b;
-        u8 a;
-    };
-};
-static_assert(AssertSize<Pixel, 4>());
+using AK::SIMD::i16x4;
 
-template<bool has_alpha, u8 filter_type>
-ALWAYS_INLINE static void unfilter_impl(Gfx::Bitmap& bitmap, int y, const void* dummy_scanline_data)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+// Pixels of three or four bytes are unfiltered one whole pixel at a time, with each byte in its own 16-bit lane.
+// The lanes of unused bytes are never stored, so their contents don't matter.
+template<size_t bytes_per_pixel>
+ALWAYS_INLINE static i16x4 load_pixel(u8 const* data)
 {
-    auto* dummy_scanline = (const Pixel*)dummy_scanline_data;
-    if constexpr (filter_type == 0) {
-        auto* pixels = (Pixel*)bitmap.scanline(y);
-        for (int i = 0; i < bitmap.width(); ++i) {
-            auto& x = pixels[i];
-            swap(x.r, x.b);
-        }
-    }
+    if constexpr (bytes_per_pixel == 4)
+        return i16x4 { data[0], data[1], data[2], data[3] };
+    else
+        return i16x4 { data[0], data[1], data[2], 0 };
+}
 
-    if constexpr (filter_type == 1) {
-        auto* pixels = (Pixel*)bitmap.scanline(y);
-        swap(pixels[0].r, pixels[0].b);
-        for (int i = 1; i < bitmap.width(); ++i) {
-            auto& x = pixels[i];
-            swap(x.r, x.b);
-            auto& a = (const Pixel&)pixels[i - 1];
-            x.v[0] += a.v[0];
-            x.v[1] += a.v[1];
-            x.v[2] += a.v[2];
-            if constexpr (has_alpha)
-                x.v[3] += a.v[3];
-        }
-        return;
-    }
-    if constexpr (filter_type == 2) {
-        auto* pixels = (Pixel*)bitmap.scanline(y);
-        auto* pixels_y_minus_1 = y == 0 ? dummy_scanline : (const Pixel*)bitmap.scanline(y - 1);
-        for (int i = 0; i < bitmap.width(); ++i) {
-            auto& x = pixels[i];
-            swap(x.r, x.b);
-            const Pixel& b = pixels_y_minus_1[i];
-            x.v[0] += b.v[0];
-            x.v[1] += b.v[1];
-            x.v[2] += b.v[2];
-            if constexpr (has_alpha)
-                x.v[3] += b.v[3];
+template<size_t bytes_per_pixel>
+ALWAYS_INLINE static void store_pixel(u8* data, i16x4 pixel)
+{
+    data[0] = pixel[0];
+    data[1] = pixel[1];
+    data[2] = pixel[2];
+    if constexpr (bytes_per_pixel == 4)
+        data[3] = pixel[3];
+}
+
+ALWAYS_INLINE static i16x4 absolute_value(i16x4 value)
+{
+    auto sign = value >> 15;
+    return (value ^ sign) - sign;
+}
+
+ALWAYS_INLINE static i16x4 paeth_predictor(i16x4 a, i16x4 b, i16x4 c)
+{
+    // The distances of p = a + b - c to a, b and c, without computing p itself.
+    auto pa = absolute_value(b - c);
+    auto pb = absolute_value(a - c);
+    auto pc = absolute_value(a + b - c - c);
+    auto use_a = (pa <= pb) & (pa <= pc);
+    auto use_b = ~use_a & (pb <= pc);
+    auto use_c = ~(use_a | use_b);
+    return (a & use_a) | (b & use_b) | (c & use_c);
+}
+
+template<size_t bytes_per_pixel>
+ALWAYS_INLINE static void unfilter_scanline_by_pixel(u8 filter, Bytes scanline, ReadonlyBytes previous_scanline)
+{
+    auto* x = scanline.data();
+    auto const* b = previous_scanline.data();
+    i16x4 a {};
+    i16x4 c {};
+
+    switch (filter) {
+    case 1:
+        for (size_t i = 0; i < scanline.size(); i += bytes_per_pixel) {
+            a = (load_pixel<bytes_per_pixel>(x + i) + a) & 0xff;
+            store_pixel<bytes_per_pixel>(x + i, a);
         }
-        return;
-    }
-    if constexpr (filter_type == 3) {
-        auto* pixels = (Pixel*)bitmap.scanline(y);
-        auto* pixels_y_minus_1 = y == 0 ? dummy_scanline : (const Pixel*)bitmap.scanline(y - 1);
-        for (int i = 0; i < bitmap.width(); ++i) {
-            auto& x = pixels[i];
-            swap(x.r, x.b);
-            Pixel a;
-            if (i != 0)
-                a = pixels[i - 1];
-            const Pixel& b = pixels_y_minus_1[i];
-            x.v[0] = x.v[0] + ((a.v[0] + b.v[0]) / 2);
-            x.v[1] = x.v[1] + ((a.v[1] + b.v[1]) / 2);
-            x.v[2] = x.v[2] + ((a.v[2] + b.v[2]) / 2);
-            if constexpr (has_alpha)
-                x.v[3] = x.v[3] + ((a.v[3] + b.v[3]) / 2);
+        break;
+    case 3:
+        for (size_t i = 0; i < scanline.size(); i += bytes_per_pixel) {
+            a = (load_pixel<bytes_per_pixel>(x + i) + ((a + load_pixel<bytes_per_pixel>(b + i)) >> 1)) & 0xff;
+            store_pixel<bytes_per_pixel>(x + i, a);
         }
-        return;
-    }
-    if constexpr (filter_type == 4) {
-        auto* pixels = (Pixel*)bitmap.scanline(y);
-        auto* pixels_y_minus_1 = y == 0 ? dummy_scanline : (Pixel*)bitmap.scanline(y - 1);
-        for (int i = 0; i < bitmap.width(); ++i) {
-            auto& x = pixels[i];
-            swap(x.r, x.b);
-            Pixel a;
-            const Pixel& b = pixels_y_minus_1[i];
-            Pixel c;
-            if (i != 0) {
-                a = pixels[i - 1];
-                c = pixels_y_minus_1[i - 1];
-            }
-            x.v[0] += paeth_predictor(a.v[0], b.v[0], c.v[0]);
-            x.v[1] += paeth_predictor(a.v[1], b.v[1], c.v[1]);
-            x.v[2] += paeth_predictor(a.v[2], b.v[2], c.v[2]);
-            if constexpr (has_alpha)
-                x.v[3] += paeth_predictor(a.v[3], b.v[3], c.v[3]);
+        break;
+    case 4:
+        for (size_t i = 0; i < scanline.size(); i += bytes_per_pixel) {
+            auto above = load_pixel<bytes_per_pixel>(b + i);
+            a = (load_pixel<bytes_per_pixel>(x + i) + paeth_predictor(a, above, c)) & 0xff;
+            store_pixel<bytes_per_pixel>(x + i, a);
+            c = above;
         }
+        break;
+    default:
+        VERIFY_NOT_REACHED();
     }
 }
 
-template<typename T>
-ALWAYS_INLINE static void unpack_grayscale_without_alpha(PNGLoadingContext& context)
+#pragma GCC diagnostic pop
+
+template<size_t bytes_per_pixel>
+ALWAYS_INLINE static void unfilter_scanline_by_byte(u8 filter, Bytes scanline, ReadonlyBytes previous_scanline)
 {
-    for (int y = 0; y < context.height; ++y) {
-        auto* gray_values = reinterpret_cast<const T*>(context.scanlines[y].data.data());
-        for (int i = 0; i < context.width; ++i) {
-            auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
-            pixel.r = gray_values[i];
-            pixel.g = gray_values[i];
-            pixel.b = gray_values[i];
-            pixel.a = 0xff;
-        }
+    auto* x = scanline.data();
+    auto const* b = previous_scanline.data();
+    size_t first_pixel_size = min(bytes_per_pixel, scanline.size());
+
+    switch (filter) {
+    case 1:
+        for (size_t i = bytes_per_pixel; i < scanline.size(); ++i)
+            x[i] += x[i - bytes_per_pixel];
+        break;
+    case 3:
+        for (size_t i = 0; i < first_pixel_size; ++i)
+            x[i] += b[i] / 2;
+        for (size_t i = bytes_per_pixel; i < scanline.size(); ++i)
+            x[i] += (x[i - bytes_per_pixel] + b[i]) / 2;
+        break;
+    case 4:
+        for (size_t i = 0; i < first_pixel_size; ++i)
+            x[i] += b[i];
+        for (size_t i = bytes_per_pixel; i < scanline.size(); ++i)
+            x[i] += paeth_predictor(x[i - bytes_per_pixel], b[i], b[i - bytes_per_pixel]);
+        break;
+    default:
+        VERIFY_NOT_REACHED();
     }
 }
 
-template<typename T>
-ALWAYS_INLINE static void unpack_grayscale_with_alpha(PNGLoadingContext& context)
+template<size_t bytes_per_pixel>
+static void unfilter_scanline_impl(u8 filter, Bytes scanline, ReadonlyBytes previous_scanline)
 {
-    for (int y = 0; y < context.height; ++y) {
-        auto* tuples = reinterpret_cast<const Tuple<T>*>(context.scanlines[y].data.data());
-        for (int i = 0; i < context.width; ++i) {
-            auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
-            pixel.r = tuples[i].gray;
-            pixel.g = tuples[i].gray;
-            pixel.b = tuples[i].gray;
-            pixel.a = tuples[i].a;
-        }
+    if (filter == 2) {
+        auto* x = scanline.data();
+        auto const* b = previous_scanline.data();
+        for (size_t i = 0; i < scanline.size(); ++i)
+            x[i] += b[i];
+        return;
     }
+
+    if constexpr (bytes_per_pixel == 3 || bytes_per_pixel == 4)
+        unfilter_scanline_by_pixel<bytes_per_pixel>(filter, scanline, previous_scanline);
+    else
+        unfilter_scanline_by_byte<bytes_per_pixel>(filter, scanline, previous_scanline);
 }
 
-template<typename T>
-ALWAYS_INLINE static void unpack_triplets_without_alpha(PNGLoadingContext& context)
+// https://www.w3.org/TR/png/#9Filters
+NEVER_INLINE FLATTEN static void unfilter_scanline(u8 filter, size_t bytes_per_pixel, Bytes scanline, ReadonlyBytes previous_scanline)
 {
-    for (int y = 0; y < context.height; ++y) {
-        auto* triplets = reinterpret_cast<const Triplet<T>*>(context.scanlines[y].data.data());
-        for (int i = 0; i < context.width; ++i) {
-            auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
-            pixel.r = triplets[i].r;
-            pixel.g = triplets[i].g;
-            pixel.b = triplets[i].b;
-            pixel.a = 0xff;
-        }
+    VERIFY(filter <= 4);
+    VERIFY(scanline.size() == previous_scanline.size());
+    if (filter == 0)
+        return;
+
+    switch (bytes_per_pixel) {
+    case 1:
+        return unfilter_scanline_impl<1>(filter, scanline, previous_scanline);
+    case 2:
+        return unfilter_scanline_impl<2>(filter, scanline, previous_scanline);
+    case 3:
+        return unfilter_scanline_impl<3>(filter, scanline, previous_scanline);
+    case 4:
+        return unfilter_scanline_impl<4>(filter, scanline, previous_scanline);
+    case 6:
+        return unfilter_scanline_impl<6>(filter, scanline, previous_scanline);
+    case 8:
+        return unfilter_scanline_impl<8>(filter, scanline, previous_scanline);
+    default:
+        VERIFY_NOT_REACHED();
     }
 }
 
-NEVER_INLINE FLATTEN static ErrorOr<void> unfilter(PNGLoadingContext& context)
+ALWAYS_INLINE static RGBA32 make_pixel(u8 r, u8 g, u8 b, u8 a)
 {
-    // First unpack the scanlines to RGBA:
+    return (a << 24) | (r << 16) | (g << 8) | b;
+}
+
+// Converts an unfiltered scanline to pixels. Only the most significant byte of 16-bit samples is used.
+static ErrorOr<void> unpack_scanline(PNGLoadingContext const& context, ReadonlyBytes scanline, Span<RGBA32> pixels)
+{
+    auto const* data = scanline.data();
+    auto sample_at = [&](int index) -> u8 {
+        auto pixels_per_byte = 8 / context.bit_depth;
+        auto bit_offset = (8 - context.bit_depth) - (context.bit_depth * (index % pixels_per_byte));
+        return (data[index / pixels_per_byte] >> bit_offset) & ((1 << context.bit_depth) - 1);
+    };
+    auto palette_color = [&](u8 palette_index) -> ErrorOr<RGBA32> {
+        if (palette_index >= context.palette_data.size())
+            return Error::from_string_literal("PNGImageDecoderPlugin: Palette index out of range"sv);
+        auto& color = context.palette_data[palette_index];
+        auto transparency = context.palette_transparency_data.size() >= palette_index + 1u
+            ? context.palette_transparency_data[palette_index]
+            : 0xff;
+        return make_pixel(color.r, color.g, color.b, transparency);
+    };
+
     switch (context.color_type) {
     case 0:
         if (context.bit_depth == 8) {
-            unpack_grayscale_without_alpha<u8>(context);
+            for (size_t i = 0; i < pixels.size(); ++i)
+                pixels[i] = make_pixel(data[i], data[i], data[i], 0xff);
         } else if (context.bit_depth == 16) {
-            unpack_grayscale_without_alpha<u16>(context);
+            for (size_t i = 0; i < pixels.size(); ++i)
+                pixels[i] = make_pixel(data[i * 2], data[i * 2], data[i * 2], 0xff);
         } else if (context.bit_depth == 1 || context.bit_depth == 2 || context.bit_depth == 4) {
             auto bit_depth_squared = context.bit_depth * context.bit_depth;
-            auto pixels_per_byte = 8 / context.bit_depth;
-            auto mask = (1 << context.bit_depth) - 1;
-            for (int y = 0; y < context.height; ++y) {
-                auto* gray_values = context.scanlines[y].data.data();
-                for (int x = 0; x < context.width; ++x) {
-                    auto bit_offset = (8 - context.bit_depth) - (context.bit_depth * (x % pixels_per_byte));
-                    auto value = (gray_values[x / pixels_per_byte] >> bit_offset) & mask;
-                    auto& pixel = (Pixel&)context.bitmap->scanline(y)[x];
-                    pixel.r = value * (0xff / bit_depth_squared);
-                    pixel.g = value * (0xff / bit_depth_squared);
-                    pixel.b = value * (0xff / bit_depth_squared);
-                    pixel.a = 0xff;
-                }
+            for (size_t i = 0; i < pixels.size(); ++i) {
+                u8 value = sample_at(i) * (0xff / bit_depth_squared);
+                pixels[i] = make_pixel(value, value, value, 0xff);
             }
         } else {
             VERIFY_NOT_REACHED();
@@ -350,81 +354,44 @@ NEVER_INLINE FLATTEN static ErrorOr<void> unfilter(PNGLoadingContext& context)
         break;
     case 4:
         if (context.bit_depth == 8) {
-            unpack_grayscale_with_alpha<u8>(context);
+            for (size_t i = 0; i < pixels.size(); ++i)
+                pixels[i] = make_pixel(data[i * 2], data[i * 2], data[i * 2], data[i * 2 + 1]);
         } else if (context.bit_depth == 16) {
-            unpack_grayscale_with_alpha<u16>(context);
+            for (size_t i = 0; i < pixels.size(); ++i)
+                pixels[i] = make_pixel(data[i * 4], data[i * 4], data[i * 4], data[i * 4 + 2]);
         } else {
             VERIFY_NOT_REACHED();
         }
         break;
     case 2:
         if (context.bit_depth == 8) {
-            unpack_triplets_without_alpha<u8>(context);
+            for (size_t i = 0; i < pixels.size(); ++i)
+                pixels[i] = make_pixel(data[i * 3], data[i * 3 + 1], data[i * 3 + 2], 0xff);
         } else if (context.bit_depth == 16) {
-            unpack_triplets_without_alpha<u16>(context);
+            for (size_t i = 0; i < pixels.size(); ++i)
+                pixels[i] = make_pixel(data[i * 6], data[i * 6 + 2], data[i * 6 + 4], 0xff);
         } else {
             VERIFY_NOT_REACHED();
         }
         break;
     case 6:
         if (context.bit_depth == 8) {
-            for (int y = 0; y < context.height; ++y) {
-                memcpy(context.bitmap->scanline(y), context.scanlines[y].data.data(), context.scanlines[y].data.size());
-            }
+            for (size_t i = 0; i < pixels.size(); ++i)
+                pixels[i] = make_pixel(data[i * 4], data[i * 4 + 1], data[i * 4 + 2], data[i * 4 + 3]);
         } else if (context.bit_depth == 16) {
-            for (int y = 0; y < context.height; ++y) {
-                auto* triplets = reinterpret_cast<const Quad<u16>*>(context.scanlines[y].data.data());
-                for (int i = 0; i < context.width; ++i) {
-                    auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
-                    pixel.r = triplets[i].r & 0xFF;
-                    pixel.g = triplets[i].g & 0xFF;
-                    pixel.b = triplets[i].b & 0xFF;
-                    pixel.a = triplets[i].a & 0xFF;
-                }
-            }
+            for (size_t i = 0; i < pixels.size(); ++i)
+                pixels[i] = make_pixel(data[i * 8], data[i * 8 + 2], data[i * 8 + 4], data[i * 8 + 6]);
         } else {
             VERIFY_NOT_REACHED();
         }
         break;
     case 3:
         if (context.bit_depth == 8) {
-            for (int y = 0; y < context.height; ++y) {
-                auto* palette_index = context.scanlines[y].data.data();
-                for (int i = 0; i < context.width; ++i) {
-                    auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
-                    if (palette_index[i] >= context.palette_data.size())
-                        return Error::from_string_literal("PNGImageDecoderPlugin: Palette index out of range"sv);
-                    auto& color = context.palette_data.at((int)palette_index[i]);
-                    auto transparency = context.palette_transparency_data.size() >= palette_index[i] + 1u
-                        ? context.palette_transparency_data.data()[palette_index[i]]
-                        : 0xff;
-                    pixel.r = color.r;
-                    pixel.g = color.g;
-                    pixel.b = color.b;
-                    pixel.a = transparency;
-                }
-            }
+            for (size_t i = 0; i < pixels.size(); ++i)
+                pixels[i] = TRY(palette_color(data[i]));
         } else if (context.bit_depth == 1 || context.bit_depth == 2 || context.bit_depth == 4) {
-            auto pixels_per_byte = 8 / context.bit_depth;
-            auto mask = (1 << context.bit_depth) - 1;
-            for (int y = 0; y < context.height; ++y) {
-                auto* palette_indices = context.scanlines[y].data.data();
-                for (int i = 0; i < context.width; ++i) {
-                    auto bit_offset = (8 - context.bit_depth) - (context.bit_depth * (i % pixels_per_byte));
-                    auto palette_index = (palette_indices[i / pixels_per_byte] >> bit_offset) & mask;
-                    auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
-                    if ((size_t)palette_index >= context.palette_data.size())
-                        return Error::from_string_literal("PNGImageDecoderPlugin: Palette index out of range"sv);
-                    auto& color = context.palette_data.at(palette_index);
-                    auto transparency = context.palette_transparency_data.size() >= palette_index + 1u
-                        ? context.palette_transparency_data.data()[palette_index]
-                        : 0xff;
-                    pixel.r = color.r;
-                    pixel.g = color.g;
-                    pixel.b = color.b;
-                    pixel.a = transparency;
-                }
-            }
+            for (size_t i = 0; i < pixels.size(); ++i)
+                pixels[i] = TRY(palette_color(sample_at(i)));
         } else {
             VERIFY_NOT_REACHED();
         }
@@ -434,48 +401,6 @@ NEVER_INLINE FLATTEN static ErrorOr<void> unfilter(PNGLoadingContext& context)
         break;
     }
 
-    u8 dummy_scanline[context.width * sizeof(RGBA32)];
-    memset(dummy_scanline, 0, sizeof(dummy_scanline));
-
-    for (int y = 0; y < context.height; ++y) {
-        auto filter = context.scanlines[y].filter;
-        if (filter == 0) {
-            if (context.has_alpha())
-                unfilter_impl<true, 0>(*context.bitmap, y, dummy_scanline);
-            else
-                unfilter_impl<false, 0>(*context.bitmap, y, dummy_scanline);
-            continue;
-        }
-        if (filter == 1) {
-            if (context.has_alpha())
-                unfilter_impl<true, 1>(*context.bitmap, y, dummy_scanline);
-            else
-                unfilter_impl<false, 1>(*context.bitmap, y, dummy_scanline);
-            continue;
-        }
-        if (filter == 2) {
-            if (context.has_alpha())
-                unfilter_impl<true, 2>(*context.bitmap, y, dummy_scanline);
-            else
-                unfilter_impl<false, 2>(*context.bitmap, y, dummy_scanline);
-            continue;
-        }
-        if (filter == 3) {
-            if (context.has_alpha())
-                unfilter_impl<true, 3>(*context.bitmap, y, dummy_scanline);
-            else
-                unfilter_impl<false, 3>(*context.bitmap, y, dummy_scanline);
-            continue;
-        }
-        if (filter == 4) {
-            if (context.has_alpha())
-                unfilter_impl<true, 4>(*context.bitmap, y, dummy_scanline);
-            else
-                unfilter_impl<false, 4>(*context.bitmap, y, dummy_scanline);
-            continue;
-        }
-    }
-
     return {};
 }
 
@@ -556,36 +481,67 @@ static bool decode_png_chunks(PNGLoadingContext& context)
     return true;
 }
 
-static ErrorOr<void> decode_png_bitmap_simple(PNGLoadingContext& context)
+// Reads the next scanline from the decompressed image data, and unfilters it in place.
+static ErrorOr<void> read_scanline(PNGLoadingContext& context, InputStream& stream, Bytes scanline, ReadonlyBytes previous_scanline)
 {
-    Streamer streamer(context.decompression_buffer->data(), context.decompression_buffer->size());
+    u8 filter;
+    if (!stream.read_or_error({ &filter, sizeof(filter) }) || !stream.read_or_error(scanline)) {
+        stream.handle_any_error();
+        context.state = PNGLoadingContext::State::Error;
+        return Error::from_string_literal("PNGImageDecoderPlugin: Decoding failed"sv);
+    }
 
-    for (int y = 0; y < context.height; ++y) {
-        u8 filter;
-        if (!streamer.read(filter)) {
-            context.state = PNGLoadingContext::State::Error;
-            return Error::from_string_literal("PNGImageDecoderPlugin: Decoding failed"sv);
-        }
+    if (filter > 4) {
+        context.state = PNGLoadingContext::State::Error;
+        return Error::from_string_literal("PNGImageDecoderPlugin: Invalid PNG filter"sv);
+    }
 
-        if (filter > 4) {
-            context.state = PNGLoadingContext::State::Error;
-            return Error::from_string_literal("PNGImageDecoderPlugin: Invalid PNG filter"sv);
-        }
+    unfilter_scanline(filter, context.bytes_per_complete_pixel(), scanline, previous_scanline);
+    return {};
+}
 
-        context.scanlines.append({ filter });
-        auto& scanline_buffer = context.scanlines.last().data;
-        auto row_size = context.compute_row_size_for_width(context.width);
+// Scanlines are decoded straight out of the decompressor, so only the current and the previous one are kept around.
+class ScanlineBuffers {
+public:
+    static ErrorOr<ScanlineBuffers> create(PNGLoadingContext& context, int width)
+    {
+        auto row_size = context.compute_row_size_for_width(width);
         if (row_size.has_overflow())
             return Error::from_string_literal("PNGImageDecoderPlugin: Row size overflow"sv);
 
-        if (!streamer.wrap_bytes(scanline_buffer, row_size.value())) {
-            context.state = PNGLoadingContext::State::Error;
-            return Error::from_string_literal("PNGImageDecoderPlugin: Decoding failed"sv);
-        }
+        auto current = ByteBuffer::create_zeroed(row_size.value());
+        auto previous = ByteBuffer::create_zeroed(row_size.value());
+        if (!current.has_value() || !previous.has_value())
+            return Error::from_errno(ENOMEM);
+        return ScanlineBuffers { current.release_value(), previous.release_value() };
+    }
+
+    Bytes current() { return m_current; }
+    ReadonlyBytes previous() const { return m_previous; }
+    void advance() { swap(m_current, m_previous); }
+
+private:
+    ScanlineBuffers(ByteBuffer current, ByteBuffer previous)
+        : m_current(move(current))
+        , m_previous(move(previous))
+    {
     }
 
+    ByteBuffer m_current;
+    ByteBuffer m_previous;
+};
+
+static ErrorOr<void> decode_png_bitmap_simple(PNGLoadingContext& context, InputStream& stream)
+{
+    auto scanlines = TRY(ScanlineBuffers::create(context, context.width));
     context.bitmap = TRY(Bitmap::try_create(context.has_alpha() ? BitmapFormat::BGRA8888 : BitmapFormat::BGRx8888, { context.width, context.height }));
-    return unfilter(context);
+
+    for (int y = 0; y < context.height; ++y) {
+        TRY(read_scanline(context, stream, scanlines.current(), scanlines.previous()));
+        TRY(unpack_scanline(context, scanlines.current(), { context.bitmap->scanline(y), static_cast<size_t>(context.width) }));
+        scanlines.advance();
+    }
+    return {};
 }
 
 static int adam7_height(PNGLoadingContext& context, int pass)
@@ -638,65 +594,37 @@ static int adam7_startx[8] = { 0, 0, 4, 0, 2, 0, 1, 0 };
 static int adam7_stepy[8] = { 1, 8, 8, 8, 4, 4, 2, 2 };
 static int adam7_stepx[8] = { 1, 8, 8, 4, 4, 2, 2, 1 };
 
-static ErrorOr<void> decode_adam7_pass(PNGLoadingContext& context, Streamer& streamer, int pass)
+static ErrorOr<void> decode_adam7_pass(PNGLoadingContext& context, InputStream& stream, int pass)
 {
-    PNGLoadingContext subimage_context;
-    subimage_context.width = adam7_width(context, pass);
-    subimage_context.height = adam7_height(context, pass);
-    subimage_context.channels = context.channels;
-    subimage_context.color_type = context.color_type;
-    subimage_context.palette_data = context.palette_data;
-    subimage_context.palette_transparency_data = context.palette_transparency_data;
-    subimage_context.bit_depth = context.bit_depth;
-    subimage_context.filter_method = context.filter_method;
+    auto width = adam7_width(context, pass);
+    auto height = adam7_height(context, pass);
 
     // For small images, some passes might be empty
-    if (!subimage_context.width || !subimage_context.height)
+    if (!width || !height)
         return {};
 
-    subimage_context.scanlines.clear_with_capacity();
-    for (int y = 0; y < subimage_context.height; ++y) {
-        u8 filter;
-        if (!streamer.read(filter)) {
-            context.state = PNGLoadingContext::State::Error;
-            return Error::from_string_literal("PNGImageDecoderPlugin: Decoding failed"sv);
-        }
-
-        if (filter > 4) {
-            context.state = PNGLoadingContext::State::Error;
-            return Error::from_string_literal("PNGImageDecoderPlugin: Invalid PNG filter"sv);
-        }
+    auto scanlines = TRY(ScanlineBuffers::create(context, width));
+    Vector<RGBA32> pixels;
+    TRY(pixels.try_resize(width));
 
-        subimage_context.scanlines.append({ filter });
-        auto& scanline_buffer = subimage_context.scanlines.last().data;
+    // Copy the pass's pixels into the main image according to the pass pattern
+    for (int y = 0, dy = adam7_starty[pass]; y < height && dy < context.height; ++y, dy += adam7_stepy[pass]) {
+        TRY(read_scanline(context, stream, scanlines.current(), scanlines.previous()));
+        TRY(unpack_scanline(context, scanlines.current(), pixels.span()));
+        scanlines.advance();
 
-        auto row_size = context.compute_row_size_for_width(subimage_context.width);
-        if (row_size.has_overflow())
-            return Error::from_string_literal("PNGImageDecoderPlugin: Row size overflow"sv);
-        if (!streamer.wrap_bytes(scanline_buffer, row_size.value())) {
-            context.state = PNGLoadingContext::State::Error;
-            return Error::from_string_literal("PNGImageDecoderPlugin: Decoding failed"sv);
-        }
-    }
-
-    subimage_context.bitmap = TRY(Bitmap::try_create(context.bitmap->format(), { subimage_context.width, subimage_context.height }));
-    TRY(unfilter(subimage_context));
-
-    // Copy the subimage data into the main image according to the pass pattern
-    for (int y = 0, dy = adam7_starty[pass]; y < subimage_context.height && dy < context.height; ++y, dy += adam7_stepy[pass]) {
-        for (int x = 0, dx = adam7_startx[pass]; x < subimage_context.width && dy < context.width; ++x, dx += adam7_stepx[pass]) {
-            context.bitmap->set_pixel(dx, dy, subimage_context.bitmap->get_pixel(x, y));
-        }
+        auto* destination = context.bitmap->scanline(dy);
+        for (int x = 0, dx = adam7_startx[pass]; x < width && dx < context.width; ++x, dx += adam7_stepx[pass])
+            destination[dx] = pixels[x];
     }
     return {};
 }
 
-static ErrorOr<void> decode_png_adam7(PNGLoadingContext& context)
+static ErrorOr<void> decode_png_adam7(PNGLoadingContext& context, InputStream& stream)
 {
-    Streamer streamer(context.decompression_buffer->data(), context.decompression_buffer->size());
     context.bitmap = TRY(Bitmap::try_create(context.has_alpha() ? BitmapFormat::BGRA8888 : BitmapFormat::BGRx8888, { context.width, context.height }));
     for (int pass = 1; pass <= 7; ++pass)
-        TRY(decode_adam7_pass(context, streamer, pass));
+        TRY(decode_adam7_pass(context, stream, pass));
     return {};
 }
 
@@ -716,28 +644,29 @@ static ErrorOr<void> decode_png_bitmap(PNGLoadingContext& context)
     if (context.color_type == 3 && context.palette_data.is_empty())
         return Error::from_string_literal("PNGImageDecoderPlugin: Didn't see a PLTE chunk for a palletized image, or it was empty."sv);
 
-    auto result = Compress::Zlib::decompress_all(context.compressed_data.span());
-    if (!result.has_value()) {
+    auto zlib = Compress::Zlib::try_create(context.compressed_data.span());
+    if (!zlib.has_value()) {
         context.state = PNGLoadingContext::State::Error;
         return Error::from_string_literal("PNGImageDecoderPlugin: Decompression failed"sv);
     }
-    context.decompression_buffer = &result.value();
-    context.compressed_data.clear();
 
-    context.scanlines.ensure_capacity(context.height);
+    // The image data is inflated one scanline at a time as it's being decoded, instead of all at once up front.
+    InputMemoryStream memory_stream { zlib->compressed_data() };
+    Compress::DeflateDecompressor stream { memory_stream };
+
     switch (context.interlace_method) {
     case PngInterlaceMethod::Null:
-        TRY(decode_png_bitmap_simple(context));
+        TRY(decode_png_bitmap_simple(context, stream));
         break;
     case PngInterlaceMethod::Adam7:
-        TRY(decode_png_adam7(context));
+        TRY(decode_png_adam7(context, stream));
         break;
     default:
         context.state = PNGLoadingContext::State::Error;
         return Error::from_string_literal("PNGImageDecoderPlugin: Invalid interlace method"sv);
     }
 
-    context.decompression_buffer = nullptr;
+    context.compressed_data.clear();
 
     context.state = PNGLoadingContext::State::BitmapDecoded;
     return {};
@@ -13,6 +13,7 @@
 #include "Font.h"
 #include "FontDatabase.h"
 #include "Gamma.h"
+#include <AK/Array.h>
 #include <AK/Assertions.h>
 #include <AK/Debug.h>
 #include <AK/Function.h>
@@ -20,14 +21,16 @@
 #include <AK/Memory.h>
 #include <AK/Queue.h>
 #include <AK/QuickSort.h>
+#include <AK/SIMDExtras.h>
 #include <AK/StdLibExtras.h>
 #include <AK/StringBuilder.h>
 #include <AK/Utf32View.h>
 #include <AK/Utf8View.h>
 #include <LibGfx/CharacterBitmap.h>
-#include <LibGfx/FillPathImplementation.h>
+#include <LibGfx/DisjointRectSet.h>
 #include <LibGfx/Palette.h>
 #include <LibGfx/Path.h>
+#include <LibGfx/PathRasterizer.h>
 #include <LibGfx/TextDirection.h>
 #include <LibGfx/TextLayout.h>
 #include <stdio.h>
@@ -56,6 +59,57 @@ ALWAYS_INLINE Color get_pixel(Gfx::Bitmap const& bitmap, int x, int y)
     return bitmap.get_pixel(x, y);
 }
 
+// These functions operate on four pixels at a time. They are static and always inlined, so the vector calling
+// convention never leaks out of this translation unit.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+using AK::SIMD::u32x4;
+
+ALWAYS_INLINE static u32x4 load_four_pixels(RGBA32 const* pixels)
+{
+    u32x4 result;
+    __builtin_memcpy(&result, pixels, sizeof(result));
+    return result;
+}
+
+ALWAYS_INLINE static void store_four_pixels(RGBA32* pixels, u32x4 value)
+{
+    __builtin_memcpy(pixels, &value, sizeof(value));
+}
+
+ALWAYS_INLINE static bool are_all_four_pixels_opaque(u32x4 pixels)
+{
+    return ((pixels[0] & pixels[1] & pixels[2] & pixels[3]) >> 24) == 0xff;
+}
+
+ALWAYS_INLINE static void fill_physical_scanline_with_opaque_color(RGBA32* dst, int width, u32 value)
+{
+    auto const four_pixels = AK::SIMD::expand4(value);
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        store_four_pixels(dst + x, four_pixels);
+        store_four_pixels(dst + x + 4, four_pixels);
+    }
+    for (; x < width; ++x)
+        dst[x] = value;
+}
+
+// Blends source pixels with the given alphas onto opaque destination pixels. For an opaque destination,
+// Color::blend() reduces to (dst * (255 - alpha) + src * alpha) / 255 per channel, which we can compute without
+// a per-pixel division. (x + 1 + (x >> 8)) >> 8 is exactly x / 255 for every value this can produce.
+ALWAYS_INLINE static u32x4 blend_four_pixels_onto_opaque(u32x4 dst, u32x4 src, u32x4 alpha)
+{
+    auto inverse_alpha = 255 - alpha;
+    auto blend_channel = [&](int shift) {
+        auto value = ((dst >> shift) & 0xff) * inverse_alpha + ((src >> shift) & 0xff) * alpha;
+        return ((value + 1 + (value >> 8)) >> 8) << shift;
+    };
+    return blend_channel(0) | blend_channel(8) | blend_channel(16) | 0xff000000;
+}
+
+#pragma GCC diagnostic pop
+
 Painter::Painter(Gfx::Bitmap& bitmap)
     : m_target(bitmap)
 {
@@ -99,13 +153,17 @@ void Painter::clear_rect(IntRect const& a_rect, Color color)
         return;
 
     VERIFY(m_target->rect().contains(rect));
-    rect *= scale();
+    clear_physical_rect(rect * scale(), color);
+}
 
-    RGBA32* dst = m_target->scanline(rect.top()) + rect.left();
+void Painter::clear_physical_rect(IntRect const& physical_rect, Color color)
+{
+    // Callers must do clipping.
+    RGBA32* dst = m_target->scanline(physical_rect.top()) + physical_rect.left();
     size_t const dst_skip = m_target->pitch() / sizeof(RGBA32);
 
-    for (int i = rect.height() - 1; i >= 0; --i) {
-        fast_u32_fill(dst, color.value(), rect.width());
+    for (int i = physical_rect.height() - 1; i >= 0; --i) {
+        fill_physical_scanline_with_opaque_color(dst, physical_rect.width(), color.value());
         dst += dst_skip;
     }
 }
@@ -116,8 +174,22 @@ void Painter::fill_physical_rect(IntRect const& physical_rect, Color color)
     RGBA32* dst = m_target->scanline(physical_rect.top()) + physical_rect.left();
     size_t const dst_skip = m_target->pitch() / sizeof(RGBA32);
 
+    auto const source = AK::SIMD::expand4(color.value());
+    auto const alpha = AK::SIMD::expand4(static_cast<u32>(color.alpha()));
+    int const width = physical_rect.width();
+
     for (int i = physical_rect.height() - 1; i >= 0; --i) {
-        for (int j = 0; j < physical_rect.width(); ++j)
+        int j = 0;
+        for (; j + 4 <= width; j += 4) {
+            auto pixels = load_four_pixels(dst + j);
+            if (!are_all_four_pixels_opaque(pixels)) {
+                for (int k = j; k < j + 4; ++k)
+                    dst[k] = Color::from_rgba(dst[k]).blend(color).value();
+                continue;
+            }
+            store_four_pixels(dst + j, blend_four_pixels_onto_opaque(pixels, source, alpha));
+        }
+        for (; j < width; ++j)
             dst[j] = Color::from_rgba(dst[j]).blend(color).value();
         dst += dst_skip;
     }
@@ -146,6 +218,36 @@ void Painter::fill_rect(IntRect const& a_rect, Color color)
     fill_physical_rect(rect * scale(), color);
 }
 
+void Painter::fill_rects(Span<IntRect const> rects, Color color)
+{
+    if (color.alpha() == 0)
+        return;
+
+    if (draw_op() != DrawOp::Copy) {
+        for (auto& rect : rects)
+            fill_rect_with_draw_op(rect, color);
+        return;
+    }
+
+    // Clip against the clip rect moved into the rects' coordinate space, so we only translate the rects that survive.
+    auto clip_rect = this->clip_rect().translated(-translation());
+    for (auto& a_rect : rects) {
+        auto rect = a_rect.intersected(clip_rect);
+        if (rect.is_empty())
+            continue;
+        auto physical_rect = rect.translated(translation()) * scale();
+        if (color.alpha() == 0xff)
+            clear_physical_rect(physical_rect, color);
+        else
+            fill_physical_rect(physical_rect, color);
+    }
+}
+
+void Painter::fill_rects(DisjointRectSet const& rect_set, Color color)
+{
+    fill_rects(rect_set.rects().span(), color);
+}
+
 void Painter::fill_rect_with_dither_pattern(IntRect const& a_rect, Color color_a, Color color_b)
 {
     VERIFY(scale() == 1); // FIXME: Add scaling support.
@@ -770,20 +872,51 @@ struct BlitState {
 template<BlitState::AlphaState has_alpha>
 static void do_blit_with_opacity(BlitState& state)
 {
+    // The effective alpha of a source pixel only depends on its own alpha, so work it out once for each value.
+    Array<u8, 256> source_alpha_with_opacity;
+    for (size_t alpha = 0; alpha < source_alpha_with_opacity.size(); ++alpha) {
+        float pixel_opacity = alpha / 255.0;
+        source_alpha_with_opacity[alpha] = 255 * (state.opacity * pixel_opacity);
+    }
+    u8 const constant_alpha = state.opacity * 255;
+
+    auto blend_pixel = [&](int x) {
+        Color dest_color = (has_alpha & BlitState::DstAlpha) ? Color::from_rgba(state.dst[x]) : Color::from_rgb(state.dst[x]);
+        Color src_color_with_alpha = Color::from_rgb(state.src[x]);
+        if constexpr (has_alpha & BlitState::SrcAlpha)
+            src_color_with_alpha.set_alpha(source_alpha_with_opacity[state.src[x] >> 24]);
+        else
+            src_color_with_alpha.set_alpha(constant_alpha);
+        state.dst[x] = dest_color.blend(src_color_with_alpha).value();
+    };
+
     for (int row = 0; row < state.row_count; ++row) {
-        for (int x = 0; x < state.column_count; ++x) {
-            Color dest_color = (has_alpha & BlitState::DstAlpha) ? Color::from_rgba(state.dst[x]) : Color::from_rgb(state.dst[x]);
+        int x = 0;
+        for (; x + 4 <= state.column_count; x += 4) {
+            auto dst = load_four_pixels(state.dst + x);
+            if constexpr (has_alpha & BlitState::DstAlpha) {
+                if (!are_all_four_pixels_opaque(dst)) {
+                    for (int i = x; i < x + 4; ++i)
+                        blend_pixel(i);
+                    continue;
+                }
+            }
+            auto src = load_four_pixels(state.src + x);
+            u32x4 alpha;
             if constexpr (has_alpha & BlitState::SrcAlpha) {
-                Color src_color_with_alpha = Color::from_rgba(state.src[x]);
-                float pixel_opacity = src_color_with_alpha.alpha() / 255.0;
-                src_color_with_alpha.set_alpha(255 * (state.opacity * pixel_opacity));
-                state.dst[x] = dest_color.blend(src_color_with_alpha).value();
+                alpha = u32x4 {
+                    source_alpha_with_opacity[src[0] >> 24],
+                    source_alpha_with_opacity[src[1] >> 24],
+                    source_alpha_with_opacity[src[2] >> 24],
+                    source_alpha_with_opacity[src[3] >> 24],
+                };
             } else {
-                Color src_color_with_alpha = Color::from_rgb(state.src[x]);
-                src_color_with_alpha.set_alpha(state.opacity * 255);
-                state.dst[x] = dest_color.blend(src_color_with_alpha).value();
+                alpha = AK::SIMD::expand4(static_cast<u32>(constant_alpha));
             }
+            store_four_pixels(state.dst + x, blend_four_pixels_onto_opaque(dst, src, alpha));
         }
+        for (; x < state.column_count; ++x)
+            blend_pixel(x);
         state.dst += state.dst_pitch;
         state.src += state.src_pitch;
     }
@@ -1075,28 +1208,24 @@ ALWAYS_INLINE static void do_draw_integer_scaled_bitmap(Gfx::Bitmap& target, Int
     }
 }
 
-template<bool has_alpha_channel, bool do_bilinear_blend, typename GetPixel>
-ALWAYS_INLINE static void do_draw_scaled_bitmap(Gfx::Bitmap& target, IntRect const& dst_rect, IntRect const& clipped_rect, Gfx::Bitmap const& source, FloatRect const& src_rect, GetPixel get_pixel, float opacity)
+template<bool has_alpha_channel, typename GetPixel>
+ALWAYS_INLINE static void do_draw_nearest_neighbor_scaled_bitmap(Gfx::Bitmap& target, IntRect const& dst_rect, IntRect const& clipped_rect, Gfx::Bitmap const& source, FloatRect const& src_rect, GetPixel get_pixel, float opacity)
 {
-    if constexpr (!do_bilinear_blend) {
-        IntRect int_src_rect = enclosing_int_rect(src_rect);
-        if (dst_rect == clipped_rect && int_src_rect == src_rect && !(dst_rect.width() % int_src_rect.width()) && !(dst_rect.height() % int_src_rect.height())) {
-            int hfactor = dst_rect.width() / int_src_rect.width();
-            int vfactor = dst_rect.height() / int_src_rect.height();
-            if (hfactor == 2 && vfactor == 2)
-                return do_draw_integer_scaled_bitmap<has_alpha_channel>(target, dst_rect, int_src_rect, source, 2, 2, get_pixel, opacity);
-            if (hfactor == 3 && vfactor == 3)
-                return do_draw_integer_scaled_bitmap<has_alpha_channel>(target, dst_rect, int_src_rect, source, 3, 3, get_pixel, opacity);
-            if (hfactor == 4 && vfactor == 4)
-                return do_draw_integer_scaled_bitmap<has_alpha_channel>(target, dst_rect, int_src_rect, source, 4, 4, get_pixel, opacity);
-            return do_draw_integer_scaled_bitmap<has_alpha_channel>(target, dst_rect, int_src_rect, source, hfactor, vfactor, get_pixel, opacity);
-        }
+    IntRect int_src_rect = enclosing_int_rect(src_rect);
+    if (dst_rect == clipped_rect && int_src_rect == src_rect && !(dst_rect.width() % int_src_rect.width()) && !(dst_rect.height() % int_src_rect.height())) {
+        int hfactor = dst_rect.width() / int_src_rect.width();
+        int vfactor = dst_rect.height() / int_src_rect.height();
+        if (hfactor == 2 && vfactor == 2)
+            return do_draw_integer_scaled_bitmap<has_alpha_channel>(target, dst_rect, int_src_rect, source, 2, 2, get_pixel, opacity);
+        if (hfactor == 3 && vfactor == 3)
+            return do_draw_integer_scaled_bitmap<has_alpha_channel>(target, dst_rect, int_src_rect, source, 3, 3, get_pixel, opacity);
+        if (hfactor == 4 && vfactor == 4)
+            return do_draw_integer_scaled_bitmap<has_alpha_channel>(target, dst_rect, int_src_rect, source, 4, 4, get_pixel, opacity);
+        return do_draw_integer_scaled_bitmap<has_alpha_channel>(target, dst_rect, int_src_rect, source, hfactor, vfactor, get_pixel, opacity);
     }
 
     bool has_opacity = opacity != 1.0f;
     i64 shift = (i64)1 << 32;
-    i64 fractional_mask = (shift - (u64)1);
-    i64 half_pixel = (i64)1 << 31;
     i64 hscale = (src_rect.width() * shift) / dst_rect.width();
     i64 vscale = (src_rect.height() * shift) / dst_rect.height();
     i64 src_left = src_rect.left() * shift;
@@ -1104,25 +1233,158 @@ ALWAYS_INLINE static void do_draw_scaled_bitmap(Gfx::Bitmap& target, IntRect con
 
     for (int y = clipped_rect.top(); y <= clipped_rect.bottom(); ++y) {
         auto* scanline = (Color*)target.scanline(y);
+        auto scaled_y = ((y - dst_rect.y()) * vscale + src_top) >> 32;
         for (int x = clipped_rect.left(); x <= clipped_rect.right(); ++x) {
-            auto desired_x = ((x - dst_rect.x()) * hscale + src_left);
-            auto desired_y = ((y - dst_rect.y()) * vscale + src_top);
+            auto scaled_x = ((x - dst_rect.x()) * hscale + src_left) >> 32;
+            auto src_pixel = get_pixel(source, scaled_x, scaled_y);
+            if (has_opacity)
+                src_pixel.set_alpha(src_pixel.alpha() * opacity);
+            if constexpr (has_alpha_channel) {
+                scanline[x] = scanline[x].blend(src_pixel);
+            } else {
+                scanline[x] = src_pixel;
+            }
+        }
+    }
+}
+
+// The two source pixels to interpolate between along one axis, and the weight of the second one in 1/256ths.
+struct BilinearSample {
+    int first;
+    int second;
+    u32 weight;
+};
+
+static Vector<BilinearSample> compute_bilinear_samples(int dst_origin, int first, int last, float src_origin, float src_size, int dst_size)
+{
+    i64 shift = (i64)1 << 32;
+    i64 half_pixel = (i64)1 << 31;
+    i64 scale = (src_size * shift) / dst_size;
+    i64 src_start = src_origin * shift;
+    int min_position = src_origin;
+    int max_position = max(min_position, (int)ceilf(src_origin + src_size) - 1);
+
+    Vector<BilinearSample> samples;
+    samples.ensure_capacity(last - first + 1);
+    for (int position = first; position <= last; ++position) {
+        auto desired = (position - dst_origin) * scale + src_start;
+        samples.unchecked_append({
+            .first = (int)clamp((desired - half_pixel) >> 32, min_position, max_position),
+            .second = (int)clamp((desired + half_pixel) >> 32, min_position, max_position),
+            .weight = (u32)(((desired + half_pixel) & (shift - 1)) >> 24),
+        });
+    }
+    return samples;
+}
 
-            Color src_pixel;
-            if constexpr (do_bilinear_blend) {
-                auto scaled_x0 = clamp((desired_x - half_pixel) >> 32, 0, src_rect.width() - 1);
-                auto scaled_x1 = clamp((desired_x + half_pixel) >> 32, 0, src_rect.width() - 1);
-                auto scaled_y0 = clamp((desired_y - half_pixel) >> 32, 0, src_rect.height() - 1);
-                auto scaled_y1 = clamp((desired_y + half_pixel) >> 32, 0, src_rect.height() - 1);
+// Interpolates all four channels at once, two at a time in the even and odd bytes of a 32-bit word.
+ALWAYS_INLINE static u32 interpolate_pixels(u32 a, u32 b, u32 weight)
+{
+    u32 inverse_weight = 256 - weight;
+    u32 red_and_blue = (((a & 0x00ff00ff) * inverse_weight + (b & 0x00ff00ff) * weight) >> 8) & 0x00ff00ff;
+    u32 alpha_and_green = (((a >> 8) & 0x00ff00ff) * inverse_weight + ((b >> 8) & 0x00ff00ff) * weight) & 0xff00ff00;
+    return alpha_and_green | red_and_blue;
+}
 
-                float x_ratio = (((desired_x + half_pixel) & fractional_mask) / (float)shift);
-                float y_ratio = (((desired_y + half_pixel) & fractional_mask) / (float)shift);
+template<bool has_alpha_channel, typename GetPixel>
+ALWAYS_INLINE static void do_draw_bilinear_scaled_bitmap(Gfx::Bitmap& target, IntRect const& dst_rect, IntRect const& clipped_rect, Gfx::Bitmap const& source, FloatRect const& src_rect, GetPixel get_pixel, float opacity)
+{
+    bool has_opacity = opacity != 1.0f;
+
+    // The source positions and weights only depend on the column or the row, so work them out once up front.
+    auto columns = compute_bilinear_samples(dst_rect.x(), clipped_rect.left(), clipped_rect.right(), src_rect.x(), src_rect.width(), dst_rect.width());
+    auto rows = compute_bilinear_samples(dst_rect.y(), clipped_rect.top(), clipped_rect.bottom(), src_rect.y(), src_rect.height(), dst_rect.height());
 
-                src_pixel = get_pixel(source, scaled_x0, scaled_y0).interpolate(get_pixel(source, scaled_x1, scaled_y0), x_ratio).interpolate(get_pixel(source, scaled_x0, scaled_y1).interpolate(get_pixel(source, scaled_x1, scaled_y1), x_ratio), y_ratio);
+    for (int y = clipped_rect.top(); y <= clipped_rect.bottom(); ++y) {
+        auto* scanline = (Color*)target.scanline(y);
+        auto const& row = rows[y - clipped_rect.top()];
+        for (int x = clipped_rect.left(); x <= clipped_rect.right(); ++x) {
+            auto const& column = columns[x - clipped_rect.left()];
+            auto top = interpolate_pixels(get_pixel(source, column.first, row.first).value(), get_pixel(source, column.second, row.first).value(), column.weight);
+            auto bottom = interpolate_pixels(get_pixel(source, column.first, row.second).value(), get_pixel(source, column.second, row.second).value(), column.weight);
+            auto src_pixel = Color::from_rgba(interpolate_pixels(top, bottom, row.weight));
+
+            if (has_opacity)
+                src_pixel.set_alpha(src_pixel.alpha() * opacity);
+            if constexpr (has_alpha_channel) {
+                scanline[x] = scanline[x].blend(src_pixel);
             } else {
-                auto scaled_x = desired_x >> 32;
-                auto scaled_y = desired_y >> 32;
-                src_pixel = get_pixel(source, scaled_x, scaled_y);
+                scanline[x] = src_pixel;
+            }
+        }
+    }
+}
+
+// The source pixels covered by one destination pixel along one axis. The weights of those pixels, i.e. how much of
+// each one the destination pixel covers, are stored back to back in a shared buffer starting at first_weight.
+struct BoxSampleSpan {
+    int first;
+    int count;
+    size_t first_weight;
+};
+
+static void compute_box_sample_spans(int dst_origin, int first, int last, float src_origin, float src_size, int dst_size, Vector<BoxSampleSpan>& spans, Vector<float>& weights)
+{
+    float scale = src_size / dst_size;
+    float src_end = src_origin + src_size;
+
+    spans.ensure_capacity(last - first + 1);
+    for (int position = first; position <= last; ++position) {
+        // When magnifying, a destination pixel covers less than a source pixel. Widen the box to a single source
+        // pixel so that we still average neighboring pixels rather than degrading into nearest neighbor sampling.
+        float center = src_origin + (position - dst_origin + 0.5f) * scale;
+        float radius = max(scale, 1.0f) / 2;
+        float begin = clamp(center - radius, src_origin, src_end);
+        float end = clamp(center + radius, src_origin, src_end);
+
+        int first_pixel = floorf(begin);
+        int last_pixel = max(first_pixel, (int)ceilf(end) - 1);
+        spans.unchecked_append({ first_pixel, last_pixel - first_pixel + 1, weights.size() });
+        for (int pixel = first_pixel; pixel <= last_pixel; ++pixel)
+            weights.append(max(min(end, pixel + 1.0f) - max(begin, (float)pixel), 0.0f));
+    }
+}
+
+template<bool has_alpha_channel, typename GetPixel>
+ALWAYS_INLINE static void do_draw_box_sampled_bitmap(Gfx::Bitmap& target, IntRect const& dst_rect, IntRect const& clipped_rect, Gfx::Bitmap const& source, FloatRect const& src_rect, GetPixel get_pixel, float opacity)
+{
+    bool has_opacity = opacity != 1.0f;
+
+    Vector<BoxSampleSpan> columns;
+    Vector<BoxSampleSpan> rows;
+    Vector<float> weights;
+    compute_box_sample_spans(dst_rect.x(), clipped_rect.left(), clipped_rect.right(), src_rect.x(), src_rect.width(), dst_rect.width(), columns, weights);
+    compute_box_sample_spans(dst_rect.y(), clipped_rect.top(), clipped_rect.bottom(), src_rect.y(), src_rect.height(), dst_rect.height(), rows, weights);
+
+    for (int y = clipped_rect.top(); y <= clipped_rect.bottom(); ++y) {
+        auto* scanline = (Color*)target.scanline(y);
+        auto const& row = rows[y - clipped_rect.top()];
+        for (int x = clipped_rect.left(); x <= clipped_rect.right(); ++x) {
+            auto const& column = columns[x - clipped_rect.left()];
+
+            // Colors are weighted by their alpha, so that fully transparent pixels don't bleed into their neighbors.
+            float red = 0, green = 0, blue = 0, alpha = 0, total_weight = 0;
+            for (int i = 0; i < row.count; ++i) {
+                float row_weight = weights[row.first_weight + i];
+                for (int j = 0; j < column.count; ++j) {
+                    float weight = row_weight * weights[column.first_weight + j];
+                    auto pixel = get_pixel(source, column.first + j, row.first + i);
+                    float alpha_weight = weight * pixel.alpha();
+                    red += pixel.red() * alpha_weight;
+                    green += pixel.green() * alpha_weight;
+                    blue += pixel.blue() * alpha_weight;
+                    alpha += alpha_weight;
+                    total_weight += weight;
+                }
+            }
+
+            Color src_pixel = Color::Transparent;
+            if (alpha > 0) {
+                src_pixel = Color(
+                    clamp(lroundf(red / alpha), 0, 255),
+                    clamp(lroundf(green / alpha), 0, 255),
+                    clamp(lroundf(blue / alpha), 0, 255),
+                    clamp(lroundf(alpha / total_weight), 0, 255));
             }
 
             if (has_opacity)
@@ -1141,10 +1403,13 @@ ALWAYS_INLINE static void do_draw_scaled_bitmap(Gfx::Bitmap& target, IntRect con
 {
     switch (scaling_mode) {
     case Painter::ScalingMode::NearestNeighbor:
-        do_draw_scaled_bitmap<has_alpha_channel, false>(target, dst_rect, clipped_rect, source, src_rect, get_pixel, opacity);
+        do_draw_nearest_neighbor_scaled_bitmap<has_alpha_channel>(target, dst_rect, clipped_rect, source, src_rect, get_pixel, opacity);
         break;
     case Painter::ScalingMode::BilinearBlend:
-        do_draw_scaled_bitmap<has_alpha_channel, true>(target, dst_rect, clipped_rect, source, src_rect, get_pixel, opacity);
+        do_draw_bilinear_scaled_bitmap<has_alpha_channel>(target, dst_rect, clipped_rect, source, src_rect, get_pixel, opacity);
+        break;
+    case Painter::ScalingMode::BoxSampling:
+        do_draw_box_sampled_bitmap<has_alpha_channel>(target, dst_rect, clipped_rect, source, src_rect, get_pixel, opacity);
         break;
     }
 }
@@ -2100,8 +2365,7 @@ void Painter::stroke_path(Path const& path, Color color, int thickness)
 
 void Painter::fill_path(Path const& path, Color color, WindingRule winding_rule)
 {
-    VERIFY(scale() == 1); // FIXME: Add scaling support.
-    Detail::fill_path<Detail::FillPathMode::PlaceOnIntGrid>(*this, path, color, winding_rule);
+    PathRasterizer::fill_path(*this, path, color, winding_rule, PathRasterizer::AntiAliasing::No);
 }
 
 void Painter::blit_disabled(IntPoint const& location, Gfx::Bitmap const& bitmap, IntRect const& rect, Palette const& palette)
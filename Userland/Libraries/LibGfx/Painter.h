@@ -36,10 +36,13 @@ public:
     enum class ScalingMode {
         NearestNeighbor,
         BilinearBlend,
+        BoxSampling,
     };
 
     void clear_rect(IntRect const&, Color);
     void fill_rect(IntRect const&, Color);
+    void fill_rects(Span<IntRect const>, Color);
+    void fill_rects(DisjointRectSet const&, Color);
     void fill_rect_with_dither_pattern(IntRect const&, Color, Color);
     void fill_rect_with_checkerboard(IntRect const&, IntSize const&, Color color_dark, Color color_light);
     void fill_rect_with_gradient(Orientation, IntRect const&, Color gradient_start, Color gradient_end);
@@ -165,12 +168,15 @@ protected:
     State const& state() const { return m_state_stack.last(); }
 
     void fill_physical_rect(IntRect const&, Color);
+    void clear_physical_rect(IntRect const&, Color);
 
     IntRect m_clip_origin;
     NonnullRefPtr<Gfx::Bitmap> m_target;
     Vector<State, 4> m_state_stack;
 
 private:
+    friend class PathRasterizer;
+
     Vector<DirectionalRun> split_text_into_directional_runs(Utf8View const&, TextDirection initial_direction);
     bool text_contains_bidirectional_text(Utf8View const&, TextDirection);
     template<typename DrawGlyphFunction>
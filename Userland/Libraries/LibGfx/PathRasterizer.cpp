@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Function.h>
+#include <LibGfx/PathRasterizer.h>
+#include <math.h>
+
+namespace Gfx {
+
+PathRasterizer::PathRasterizer(IntSize size)
+    : m_size(size)
+    , m_stride(size.width() + 2)
+{
+    m_data.resize(m_stride * m_size.height());
+}
+
+void PathRasterizer::draw_path(Path const& path, AffineTransform const& transform)
+{
+    Optional<FloatPoint> start_of_subpath;
+    FloatPoint cursor;
+
+    Function<void(FloatPoint const&, FloatPoint const&)> add_line = [&](FloatPoint const& from, FloatPoint const& to) {
+        draw_line(transform.map(from), transform.map(to));
+    };
+    auto close_subpath = [&] {
+        if (start_of_subpath.has_value() && cursor != *start_of_subpath)
+            add_line(cursor, *start_of_subpath);
+    };
+
+    for (auto& segment : path.segments()) {
+        switch (segment.type()) {
+        case Segment::Type::MoveTo:
+            close_subpath();
+            cursor = segment.point();
+            start_of_subpath = cursor;
+            break;
+        case Segment::Type::LineTo:
+            add_line(cursor, segment.point());
+            cursor = segment.point();
+            break;
+        case Segment::Type::QuadraticBezierCurveTo: {
+            auto& control = static_cast<QuadraticBezierCurveSegment const&>(segment).through();
+            Painter::for_each_line_segment_on_bezier_curve(control, cursor, segment.point(), add_line);
+            cursor = segment.point();
+            break;
+        }
+        case Segment::Type::CubicBezierCurveTo: {
+            auto& curve = static_cast<CubicBezierCurveSegment const&>(segment);
+            Painter::for_each_line_segment_on_cubic_bezier_curve(curve.through_0(), curve.through_1(), cursor, segment.point(), add_line);
+            cursor = segment.point();
+            break;
+        }
+        case Segment::Type::EllipticalArcTo: {
+            auto& arc = static_cast<EllipticalArcSegment const&>(segment);
+            Painter::for_each_line_segment_on_elliptical_arc(cursor, arc.point(), arc.center(), arc.radii(), arc.x_axis_rotation(), arc.theta_1(), arc.theta_delta(), add_line);
+            cursor = segment.point();
+            break;
+        }
+        case Segment::Type::Invalid:
+            VERIFY_NOT_REACHED();
+        }
+        if (!start_of_subpath.has_value())
+            start_of_subpath = FloatPoint {};
+    }
+    close_subpath();
+}
+
+void PathRasterizer::draw_line(FloatPoint p0, FloatPoint p1)
+{
+    // Horizontal lines don't cover any area.
+    if (p0.y() == p1.y())
+        return;
+
+    // Split lines where they cross the left or right edge. Whatever is left of the rasterizer still adds to the
+    // winding of the pixels to its right, so those parts are flattened onto the left edge. Whatever is right of it
+    // isn't visible, and goes into the spare cell at the end of the row.
+    float width = m_size.width();
+    for (float edge : { 0.0f, width }) {
+        if (p0.x() != edge && p1.x() != edge && (p0.x() < edge) != (p1.x() < edge)) {
+            float t = (edge - p0.x()) / (p1.x() - p0.x());
+            FloatPoint crossing { edge, p0.y() + t * (p1.y() - p0.y()) };
+            draw_line(p0, crossing);
+            draw_line(crossing, p1);
+            return;
+        }
+    }
+    p0.set_x(clamp(p0.x(), 0.0f, width));
+    p1.set_x(clamp(p1.x(), 0.0f, width));
+
+    float direction = -1.0f;
+    if (p1.y() < p0.y()) {
+        direction = 1.0f;
+        swap(p0, p1);
+    }
+
+    float dxdy = (p1.x() - p0.x()) / (p1.y() - p0.y());
+    int first_row = max(0, (int)floorf(p0.y()));
+    int last_row = min(m_size.height(), (int)ceilf(p1.y()));
+    float x = p0.x() + (max((float)first_row, p0.y()) - p0.y()) * dxdy;
+
+    for (int y = first_row; y < last_row; ++y) {
+        float* row = &m_data[y * m_stride];
+        float dy = min(y + 1.0f, p1.y()) - max((float)y, p0.y());
+        float x_next = clamp(x + dxdy * dy, 0.0f, width);
+        float directed_dy = dy * direction;
+
+        float x0 = min(x, x_next);
+        float x1 = max(x, x_next);
+        float x0_floor = floorf(x0);
+        int x0i = x0_floor;
+        float x1_ceil = ceilf(x1);
+        int x1i = x1_ceil;
+
+        if (x1i <= x0i + 1) {
+            // The line stays within a single pixel, which it covers up to its midpoint.
+            float area = ((x + x_next) * 0.5f) - x0_floor;
+            row[x0i] += directed_dy * (1.0f - area);
+            row[x0i + 1] += directed_dy * area;
+        } else {
+            float dydx = 1.0f / (x1 - x0);
+            float x0_fraction = x0 - x0_floor;
+            float first_area = 0.5f * dydx * (1.0f - x0_fraction) * (1.0f - x0_fraction);
+            float x1_fraction = x1 - x1_ceil + 1.0f;
+            float last_area = 0.5f * dydx * x1_fraction * x1_fraction;
+            row[x0i] += directed_dy * first_area;
+            if (x1i == x0i + 2) {
+                row[x0i + 1] += directed_dy * (1.0f - first_area - last_area);
+            } else {
+                float area_so_far = dydx * (1.5f - x0_fraction);
+                row[x0i + 1] += directed_dy * (area_so_far - first_area);
+                for (int xi = x0i + 2; xi < x1i - 1; ++xi)
+                    row[xi] += directed_dy * dydx;
+                float middle_area = area_so_far + (x1i - x0i - 3) * dydx;
+                row[x1i - 1] += directed_dy * (1.0f - middle_area - last_area);
+            }
+            row[x1i] += directed_dy * last_area;
+        }
+
+        x = x_next;
+    }
+}
+
+RefPtr<Bitmap> PathRasterizer::accumulate(Painter::WindingRule winding_rule) const
+{
+    auto bitmap_or_error = Bitmap::try_create(BitmapFormat::BGRA8888, m_size);
+    if (bitmap_or_error.is_error())
+        return {};
+    auto bitmap = bitmap_or_error.release_value_but_fixme_should_propagate_errors();
+    for_each_row(winding_rule, [&](int y, Span<u8> coverage) {
+        auto* scanline = bitmap->scanline(y);
+        for (size_t x = 0; x < coverage.size(); ++x)
+            scanline[x] = Color(Color::White).with_alpha(coverage[x]).value();
+    });
+    return bitmap;
+}
+
+void PathRasterizer::fill_path(Painter& painter, Path const& path, Color color, Painter::WindingRule winding_rule, AntiAliasing anti_aliasing, AffineTransform const& transform)
+{
+    if (color.alpha() == 0 || path.segments().is_empty())
+        return;
+
+    int scale = painter.scale();
+    auto to_physical = AffineTransform()
+                           .scale(scale, scale)
+                           .translate(painter.translation().to_type<float>())
+                           .multiply(transform);
+
+    // Nothing outside the bounding box can be covered. We leave a pixel of room for the anti-aliased edges.
+    auto bounding_box = enclosing_int_rect(to_physical.map(path.bounding_box())).inflated(2, 2);
+    auto rect = bounding_box.intersected(painter.clip_rect() * scale).intersected(painter.target()->rect());
+    if (rect.is_empty())
+        return;
+
+    PathRasterizer rasterizer(rect.size());
+    rasterizer.draw_path(path, AffineTransform().translate(-rect.x(), -rect.y()).multiply(to_physical));
+
+    auto& target = *painter.target();
+    rasterizer.for_each_row(winding_rule, [&](int y, Span<u8> coverage) {
+        auto* scanline = target.scanline(rect.y() + y) + rect.x();
+        for (size_t x = 0; x < coverage.size(); ++x) {
+            u8 alpha = coverage[x];
+            if (anti_aliasing == AntiAliasing::No) {
+                if (alpha < 128)
+                    continue;
+                alpha = 255;
+            } else if (alpha == 0) {
+                continue;
+            }
+            auto source = color.with_alpha(color.alpha() * alpha / 255);
+            if (source.alpha() == 255)
+                scanline[x] = source.value();
+            else
+                scanline[x] = Color::from_rgba(scanline[x]).blend(source).value();
+        }
+    });
+}
+
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Vector.h>
+#include <LibGfx/AffineTransform.h>
+#include <LibGfx/Bitmap.h>
+#include <LibGfx/Painter.h>
+#include <LibGfx/Path.h>
+
+namespace Gfx {
+
+// A sparse coverage accumulation rasterizer, in the style of font-rs. Every line adds the signed area it covers to
+// the cells it crosses, and a running sum along each row then yields the winding number of each pixel, with
+// fractional coverage along the edges for free. Lines outside the rasterizer are clipped, so paths may extend
+// past its bounds.
+class PathRasterizer {
+public:
+    explicit PathRasterizer(IntSize);
+
+    // Subpaths are implicitly closed, as they are for filling in SVG, canvas and PDF.
+    void draw_path(Path const&, AffineTransform const& = {});
+    void draw_line(FloatPoint, FloatPoint);
+
+    // Calls the callback with the y coordinate and the coverage of every pixel in it, for every row.
+    template<typename Callback>
+    void for_each_row(Painter::WindingRule winding_rule, Callback callback) const
+    {
+        Vector<u8> coverage;
+        coverage.resize(m_size.width());
+        for (int y = 0; y < m_size.height(); ++y) {
+            float const* row = &m_data[y * m_stride];
+            float accumulator = 0;
+            for (int x = 0; x < m_size.width(); ++x) {
+                accumulator += row[x];
+                coverage[x] = coverage_from_winding(accumulator, winding_rule);
+            }
+            callback(y, coverage.span());
+        }
+    }
+
+    // Returns a white bitmap with the coverage of each pixel in its alpha channel.
+    RefPtr<Bitmap> accumulate(Painter::WindingRule = Painter::WindingRule::Nonzero) const;
+
+    // Fills the path with the painter's translation, scale and clip applied. Without anti-aliasing, pixels that are
+    // at least half covered are filled.
+    enum class AntiAliasing {
+        No,
+        Yes,
+    };
+    static void fill_path(Painter&, Path const&, Color, Painter::WindingRule, AntiAliasing, AffineTransform const& = {});
+
+private:
+    ALWAYS_INLINE static u8 coverage_from_winding(float winding, Painter::WindingRule winding_rule)
+    {
+        float value = fabsf(winding);
+        if (winding_rule == Painter::WindingRule::EvenOdd) {
+            value = fmodf(value, 2.0f);
+            if (value > 1.0f)
+                value = 2.0f - value;
+        } else if (value > 1.0f) {
+            value = 1.0f;
+        }
+        return value * 255.0f + 0.5f;
+    }
+
+    IntSize m_size;
+    // One extra cell on the right of each row catches the area of lines that end on the right edge.
+    int m_stride { 0 };
+    Vector<float> m_data;
+};
+
+}
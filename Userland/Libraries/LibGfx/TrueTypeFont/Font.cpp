@@ -14,6 +14,7 @@
 #include <LibGfx/TrueTypeFont/Cmap.h>
 #include <LibGfx/TrueTypeFont/Font.h>
 #include <LibGfx/TrueTypeFont/Glyf.h>
+#include <LibGfx/TrueTypeFont/GlyphBitmapCache.h>
 #include <LibGfx/TrueTypeFont/Tables.h>
 #include <LibTextCodec/Decoder.h>
 #include <math.h>
@@ -225,6 +226,11 @@ GlyphHorizontalMetrics Hmtx::get_glyph_horizontal_metrics(u32 glyph_id) const
     };
 }
 
+Font::~Font()
+{
+    GlyphBitmapCache::the().purge_font(*this);
+}
+
 ErrorOr<NonnullRefPtr<Font>> Font::try_load_from_file(String path, unsigned index)
 {
     auto file = TRY(Core::MappedFile::map(path));
@@ -508,12 +514,12 @@ ALWAYS_INLINE int ScaledFont::unicode_view_width(T const& view) const
 
 RefPtr<Gfx::Bitmap> ScaledFont::rasterize_glyph(u32 glyph_id) const
 {
-    auto glyph_iterator = m_cached_glyph_bitmaps.find(glyph_id);
-    if (glyph_iterator != m_cached_glyph_bitmaps.end())
-        return glyph_iterator->value;
+    GlyphBitmapCache::Key key { m_font.ptr(), glyph_id, m_x_scale, m_y_scale };
+    if (auto cached_bitmap = GlyphBitmapCache::the().get(key); cached_bitmap.has_value())
+        return cached_bitmap.release_value();
 
     auto glyph_bitmap = m_font->rasterize_glyph(glyph_id, m_x_scale, m_y_scale);
-    m_cached_glyph_bitmaps.set(glyph_id, glyph_bitmap);
+    GlyphBitmapCache::the().set(key, glyph_bitmap);
     return glyph_bitmap;
 }
 
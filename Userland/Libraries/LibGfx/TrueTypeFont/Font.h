@@ -47,6 +47,7 @@ class Font : public RefCounted<Font> {
 public:
     static ErrorOr<NonnullRefPtr<Font>> try_load_from_file(String path, unsigned index = 0);
     static ErrorOr<NonnullRefPtr<Font>> try_load_from_externally_owned_memory(ReadonlyBytes bytes, unsigned index = 0);
+    ~Font();
 
     ScaledFontMetrics metrics(float x_scale, float y_scale) const;
     ScaledGlyphMetrics glyph_metrics(u32 glyph_id, float x_scale, float y_scale) const;
@@ -151,7 +152,6 @@ private:
     float m_y_scale { 0.0f };
     float m_point_width { 0.0f };
     float m_point_height { 0.0f };
-    mutable HashMap<u32, RefPtr<Gfx::Bitmap>> m_cached_glyph_bitmaps;
 
     template<typename T>
     int unicode_view_width(T const& view) const;
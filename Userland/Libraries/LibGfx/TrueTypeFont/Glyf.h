@@ -10,24 +10,12 @@
 #include <AK/Vector.h>
 #include <LibGfx/AffineTransform.h>
 #include <LibGfx/Bitmap.h>
+#include <LibGfx/Path.h>
 #include <LibGfx/TrueTypeFont/Tables.h>
 #include <math.h>
 
 namespace TTF {
 
-class Rasterizer {
-public:
-    Rasterizer(Gfx::IntSize);
-    void draw_path(Gfx::Path&);
-    RefPtr<Gfx::Bitmap> accumulate();
-
-private:
-    void draw_line(Gfx::FloatPoint, Gfx::FloatPoint);
-
-    Gfx::IntSize m_size;
-    Vector<float> m_data;
-};
-
 class Loca {
 public:
     static Optional<Loca> from_slice(ReadonlyBytes, u32 num_glyphs, IndexToLocFormat);
@@ -101,14 +89,15 @@ public:
             u32 m_offset { 0 };
         };
 
-        void rasterize_impl(Rasterizer&, Gfx::AffineTransform const&) const;
+        void append_to_path(Gfx::Path&, Gfx::AffineTransform const&) const;
+        static RefPtr<Gfx::Bitmap> rasterize_path(Gfx::Path const&, Gfx::IntSize);
         RefPtr<Gfx::Bitmap> rasterize_simple(i16 ascender, i16 descender, float x_scale, float y_scale) const;
         template<typename GlyphCb>
         RefPtr<Gfx::Bitmap> rasterize_composite(i16 font_ascender, i16 font_descender, float x_scale, float y_scale, GlyphCb glyph_callback) const
         {
             u32 width = (u32)(ceilf((m_xmax - m_xmin) * x_scale)) + 1;
             u32 height = (u32)(ceilf((font_ascender - font_descender) * y_scale)) + 1;
-            Rasterizer rasterizer(Gfx::IntSize(width, height));
+            Gfx::Path path;
             auto affine = Gfx::AffineTransform().scale(x_scale, -y_scale).translate(-m_xmin, -font_ascender);
             ComponentIterator component_iterator(m_slice);
             while (true) {
@@ -119,9 +108,9 @@ public:
                 auto item = opt_item.value();
                 auto affine_here = affine.multiply(item.affine);
                 auto glyph = glyph_callback(item.glyph_id);
-                glyph.rasterize_impl(rasterizer, affine_here);
+                glyph.append_to_path(path, affine_here);
             }
-            return rasterizer.accumulate();
+            return rasterize_path(path, Gfx::IntSize(width, height));
         }
 
         Type m_type { Type::Composite };
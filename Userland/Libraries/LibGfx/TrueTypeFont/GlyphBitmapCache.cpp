@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibGfx/TrueTypeFont/GlyphBitmapCache.h>
+
+namespace TTF {
+
+GlyphBitmapCache& GlyphBitmapCache::the()
+{
+    static GlyphBitmapCache s_the;
+    return s_the;
+}
+
+size_t GlyphBitmapCache::Entry::size_in_bytes() const
+{
+    // Even an empty glyph costs us the bookkeeping.
+    return sizeof(Entry) + (bitmap ? bitmap->size_in_bytes() : 0);
+}
+
+Optional<RefPtr<Gfx::Bitmap>> GlyphBitmapCache::get(Key const& key)
+{
+    auto it = m_entries.find(key);
+    if (it == m_entries.end())
+        return {};
+    auto& entry = *it->value;
+    m_least_recently_used.remove(entry);
+    m_least_recently_used.append(entry);
+    return entry.bitmap;
+}
+
+void GlyphBitmapCache::set(Key const& key, RefPtr<Gfx::Bitmap> bitmap)
+{
+    if (auto it = m_entries.find(key); it != m_entries.end())
+        remove(*it->value);
+
+    auto entry = make<Entry>(key, move(bitmap));
+    m_size_in_bytes += entry->size_in_bytes();
+    m_least_recently_used.append(*entry);
+    m_entries.set(key, move(entry));
+    evict_until_within_budget();
+}
+
+void GlyphBitmapCache::purge_font(Font const& font)
+{
+    Vector<Entry&> entries_to_remove;
+    for (auto& entry : m_least_recently_used) {
+        if (entry.key.font == &font)
+            entries_to_remove.append(entry);
+    }
+    for (auto& entry : entries_to_remove)
+        remove(entry);
+}
+
+void GlyphBitmapCache::set_budget_in_bytes(size_t budget_in_bytes)
+{
+    m_budget_in_bytes = budget_in_bytes;
+    evict_until_within_budget();
+}
+
+void GlyphBitmapCache::remove(Entry& entry)
+{
+    m_size_in_bytes -= entry.size_in_bytes();
+    m_least_recently_used.remove(entry);
+    // NOTE: This destroys the entry, so we have to take a copy of the key first.
+    auto key = entry.key;
+    m_entries.remove(key);
+}
+
+void GlyphBitmapCache::evict_until_within_budget()
+{
+    while (m_size_in_bytes > m_budget_in_bytes && !m_least_recently_used.is_empty())
+        remove(*m_least_recently_used.first());
+}
+
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/IntrusiveList.h>
+#include <AK/NonnullOwnPtr.h>
+#include <LibGfx/Bitmap.h>
+
+namespace TTF {
+
+class Font;
+
+// Rasterized glyphs shared between all ScaledFonts, no matter which Typeface created them. The cache is bounded by
+// the memory used by the glyph bitmaps, and throws out the least recently used glyphs first.
+class GlyphBitmapCache {
+public:
+    static GlyphBitmapCache& the();
+
+    struct Key {
+        Font const* font { nullptr };
+        u32 glyph_id { 0 };
+        float x_scale { 0 };
+        float y_scale { 0 };
+
+        bool operator==(Key const&) const = default;
+    };
+
+    // A null bitmap is a valid entry, since some glyphs (like spaces) don't have any outline to rasterize.
+    Optional<RefPtr<Gfx::Bitmap>> get(Key const&);
+    void set(Key const&, RefPtr<Gfx::Bitmap>);
+
+    void purge_font(Font const&);
+
+    size_t size_in_bytes() const { return m_size_in_bytes; }
+    size_t budget_in_bytes() const { return m_budget_in_bytes; }
+    void set_budget_in_bytes(size_t);
+
+private:
+    GlyphBitmapCache() = default;
+
+    struct Entry {
+        Entry(Key key, RefPtr<Gfx::Bitmap> bitmap)
+            : key(key)
+            , bitmap(move(bitmap))
+        {
+        }
+
+        Key key;
+        RefPtr<Gfx::Bitmap> bitmap;
+        IntrusiveListNode<Entry> list_node;
+
+        size_t size_in_bytes() const;
+    };
+
+    void remove(Entry&);
+    void evict_until_within_budget();
+
+    HashMap<Key, NonnullOwnPtr<Entry>> m_entries;
+    IntrusiveList<&Entry::list_node> m_least_recently_used;
+    size_t m_size_in_bytes { 0 };
+    size_t m_budget_in_bytes { 8 * MiB };
+};
+
+}
+
+namespace AK {
+
+template<>
+struct Traits<TTF::GlyphBitmapCache::Key> : public GenericTraits<TTF::GlyphBitmapCache::Key> {
+    static unsigned hash(TTF::GlyphBitmapCache::Key const& key)
+    {
+        auto scale_hash = pair_int_hash(bit_cast<u32>(key.x_scale), bit_cast<u32>(key.y_scale));
+        return pair_int_hash(ptr_hash(key.font), pair_int_hash(key.glyph_id, scale_hash));
+    }
+};
+
+}
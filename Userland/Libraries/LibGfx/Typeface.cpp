@@ -10,51 +10,85 @@ namespace Gfx {
 
 unsigned Typeface::weight() const
 {
-    VERIFY(m_ttf_font || m_bitmap_fonts.size() > 0);
+    VERIFY(m_ttf_font.has_value() || m_bitmap_fonts.size() > 0);
 
     if (is_fixed_size())
-        return m_bitmap_fonts[0]->weight();
+        return m_bitmap_fonts[0].weight;
 
-    return m_ttf_font->weight();
+    return m_ttf_font->weight;
 }
 
 bool Typeface::is_fixed_width() const
 {
-    VERIFY(m_ttf_font || m_bitmap_fonts.size() > 0);
+    VERIFY(m_ttf_font.has_value() || m_bitmap_fonts.size() > 0);
 
     if (is_fixed_size())
-        return m_bitmap_fonts[0]->is_fixed_width();
+        return m_bitmap_fonts[0].is_fixed_width;
 
-    return m_ttf_font->is_fixed_width();
+    return m_ttf_font->is_fixed_width;
 }
 
 void Typeface::add_bitmap_font(RefPtr<BitmapFont> font)
 {
-    m_bitmap_fonts.append(font);
+    m_bitmap_fonts.append({ {}, font->presentation_size(), font->weight(), font->is_fixed_width(), font });
 }
 
 void Typeface::set_ttf_font(RefPtr<TTF::Font> font)
 {
-    m_ttf_font = move(font);
+    m_ttf_font = FontFile<TTF::Font> { {}, 0, font->weight(), font->is_fixed_width(), move(font) };
+}
+
+void Typeface::add_bitmap_font(String path, unsigned presentation_size, unsigned weight, bool is_fixed_width)
+{
+    m_bitmap_fonts.append({ move(path), presentation_size, weight, is_fixed_width, nullptr });
+}
+
+void Typeface::set_ttf_font(String path, unsigned weight, bool is_fixed_width)
+{
+    m_ttf_font = FontFile<TTF::Font> { move(path), 0, weight, is_fixed_width, nullptr };
+}
+
+template<typename FontType>
+RefPtr<FontType> Typeface::load(FontFile<FontType>& file)
+{
+    if (file.font || file.path.is_null())
+        return file.font;
+
+    if constexpr (IsSame<FontType, BitmapFont>) {
+        file.font = BitmapFont::load_from_file(file.path);
+    } else {
+        if (auto font_or_error = TTF::Font::try_load_from_file(file.path); !font_or_error.is_error())
+            file.font = font_or_error.release_value();
+    }
+    if (!file.font)
+        dbgln("Typeface: Failed to load {}", file.path);
+    // A font that failed to load isn't tried again.
+    file.path = {};
+    return file.font;
 }
 
 RefPtr<Font> Typeface::get_font(unsigned size) const
 {
-    for (auto font : m_bitmap_fonts) {
-        if (font->presentation_size() == size)
-            return font;
+    for (auto& file : m_bitmap_fonts) {
+        if (file.presentation_size == size) {
+            if (auto font = load(file))
+                return font;
+        }
     }
 
-    if (m_ttf_font)
-        return adopt_ref(*new TTF::ScaledFont(*m_ttf_font, size, size));
+    if (m_ttf_font.has_value()) {
+        if (auto font = load(*m_ttf_font))
+            return adopt_ref(*new TTF::ScaledFont(*font, size, size));
+    }
 
     return {};
 }
 
 void Typeface::for_each_fixed_size_font(Function<void(const Font&)> callback) const
 {
-    for (auto font : m_bitmap_fonts) {
-        callback(*font);
+    for (auto& file : m_bitmap_fonts) {
+        if (auto font = load(file))
+            callback(*font);
     }
 }
 
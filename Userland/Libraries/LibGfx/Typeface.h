@@ -7,6 +7,7 @@
 #pragma once
 
 #include <AK/Function.h>
+#include <AK/Optional.h>
 #include <AK/RefCounted.h>
 #include <AK/String.h>
 #include <AK/Vector.h>
@@ -35,14 +36,30 @@ public:
     void add_bitmap_font(RefPtr<BitmapFont>);
     void set_ttf_font(RefPtr<TTF::Font>);
 
+    // Fonts known from the font index, which are only loaded once they're asked for.
+    void add_bitmap_font(String path, unsigned presentation_size, unsigned weight, bool is_fixed_width);
+    void set_ttf_font(String path, unsigned weight, bool is_fixed_width);
+
     RefPtr<Font> get_font(unsigned size) const;
 
 private:
+    template<typename FontType>
+    struct FontFile {
+        String path;
+        unsigned presentation_size { 0 };
+        unsigned weight { 0 };
+        bool is_fixed_width { false };
+        RefPtr<FontType> font;
+    };
+
+    template<typename FontType>
+    static RefPtr<FontType> load(FontFile<FontType>&);
+
     String m_family;
     String m_variant;
 
-    Vector<RefPtr<BitmapFont>> m_bitmap_fonts;
-    RefPtr<TTF::Font> m_ttf_font;
+    mutable Vector<FontFile<BitmapFont>> m_bitmap_fonts;
+    mutable Optional<FontFile<TTF::Font>> m_ttf_font;
 };
 
 }
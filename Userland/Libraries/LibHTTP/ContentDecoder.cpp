@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ByteBuffer.h>
+#include <AK/FileStream.h>
+#include <AK/ScopeGuard.h>
+#include <LibCompress/Deflate.h>
+#include <LibCompress/Gzip.h>
+#include <LibHTTP/ContentDecoder.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+namespace HTTP {
+
+// How long the thread waits for the output to drain before it checks whether it has been cancelled.
+static constexpr int output_poll_timeout_ms = 100;
+
+// Reads a few bytes that were already taken from a stream, then carries on with the rest of that stream.
+class PrefixedInputStream final : public InputStream {
+public:
+    PrefixedInputStream(ReadonlyBytes prefix, InputStream& stream)
+        : m_prefix(prefix)
+        , m_stream(stream)
+    {
+    }
+
+    virtual size_t read(Bytes bytes) override
+    {
+        auto nread = m_prefix.copy_trimmed_to(bytes);
+        m_prefix = m_prefix.slice(nread);
+        return nread + m_stream.read(bytes.slice(nread));
+    }
+
+    virtual bool unreliable_eof() const override { return m_prefix.is_empty() && m_stream.unreliable_eof(); }
+
+    virtual bool read_or_error(Bytes bytes) override
+    {
+        if (read(bytes) < bytes.size()) {
+            set_fatal_error();
+            return false;
+        }
+        return true;
+    }
+
+    virtual bool discard_or_error(size_t count) override
+    {
+        auto ndiscarded = min(count, m_prefix.size());
+        m_prefix = m_prefix.slice(ndiscarded);
+        return m_stream.discard_or_error(count - ndiscarded);
+    }
+
+    virtual bool handle_any_error() override
+    {
+        bool handled_errors = m_stream.handle_any_error();
+        return Stream::handle_any_error() || handled_errors;
+    }
+
+private:
+    ReadonlyBytes m_prefix;
+    InputStream& m_stream;
+};
+
+bool ContentDecoder::is_supported(StringView content_encoding)
+{
+    return content_encoding == "gzip"sv || content_encoding == "deflate"sv;
+}
+
+ErrorOr<NonnullOwnPtr<ContentDecoder>> ContentDecoder::try_create(StringView content_encoding, OutputStream& output, int output_fd)
+{
+    VERIFY(is_supported(content_encoding));
+    auto encoding = content_encoding == "gzip"sv ? Encoding::Gzip : Encoding::Deflate;
+
+    int input_fds[2];
+    if (pipe(input_fds) < 0)
+        return Error::from_errno(errno);
+    int done_fds[2];
+    if (pipe(done_fds) < 0) {
+        auto saved_errno = errno;
+        close(input_fds[0]);
+        close(input_fds[1]);
+        return Error::from_errno(saved_errno);
+    }
+    // Only the thread's end of the input pipe blocks.
+    fcntl(input_fds[1], F_SETFL, fcntl(input_fds[1], F_GETFL) | O_NONBLOCK);
+
+    return adopt_nonnull_own_or_enomem(new (nothrow) ContentDecoder(encoding, output, output_fd, input_fds[1], input_fds[0], done_fds[0], done_fds[1]));
+}
+
+ContentDecoder::ContentDecoder(Encoding encoding, OutputStream& output, int output_fd, int input_fd, int pipe_read_fd, int done_read_fd, int done_write_fd)
+    : m_encoding(encoding)
+    , m_output(output)
+    , m_output_fd(output_fd)
+    , m_input_fd(input_fd)
+    , m_pipe_read_fd(pipe_read_fd)
+    , m_done_read_fd(done_read_fd)
+    , m_done_write_fd(done_write_fd)
+{
+    m_done_notifier = Core::Notifier::construct(m_done_read_fd, Core::Notifier::Read);
+    m_done_notifier->on_ready_to_read = [this] {
+        m_done_notifier->set_enabled(false);
+        u8 success = 0;
+        if (read(m_done_read_fd, &success, 1) != 1)
+            success = 0;
+        (void)m_thread->join();
+        if (on_finish)
+            on_finish(success);
+    };
+
+    m_thread = Threading::Thread::construct([this] {
+        u8 success = decode();
+        // The notifier is on the other end of this pipe, so this wakes up the event loop too.
+        (void)::write(m_done_write_fd, &success, 1);
+        return 0;
+    },
+        "ContentDecoder"sv);
+    m_thread->start();
+}
+
+ContentDecoder::~ContentDecoder()
+{
+    m_done_notifier->set_enabled(false);
+    if (m_thread->tid() != 0) {
+        // Closing the pipe gets the thread out of reading, and the flag gets it out of waiting for the output.
+        m_cancelled = true;
+        if (m_input_fd >= 0) {
+            close(m_input_fd);
+            m_input_fd = -1;
+        }
+        (void)m_thread->join();
+    }
+    if (m_input_fd >= 0)
+        close(m_input_fd);
+    close(m_done_read_fd);
+    close(m_done_write_fd);
+}
+
+size_t ContentDecoder::write(ReadonlyBytes bytes)
+{
+    VERIFY(m_input_fd >= 0);
+    auto nwritten = ::write(m_input_fd, bytes.data(), bytes.size());
+    if (nwritten < 0)
+        return 0;
+    return nwritten;
+}
+
+void ContentDecoder::finish_input()
+{
+    VERIFY(m_input_fd >= 0);
+    close(m_input_fd);
+    m_input_fd = -1;
+}
+
+bool ContentDecoder::decode()
+{
+    // Takes over (and eventually closes) the thread's end of the pipe.
+    InputFileStream input { m_pipe_read_fd };
+    ScopeGuard clear_input_errors = [&] { input.handle_any_error(); };
+
+    if (m_encoding == Encoding::Gzip)
+        return decode_stream(input);
+
+    // "deflate" is supposed to be wrapped in zlib, but some servers send plain deflate data, see RFC 7230 section 4.2.2.
+    u8 header[2];
+    auto header_size = input.read({ header, sizeof(header) });
+    bool is_zlib = header_size == 2
+        && (header[0] & 0xf) == 8
+        && (header[0] >> 4) <= 7
+        && ((header[0] << 8) | header[1]) % 31 == 0
+        && !(header[1] & 0x20);
+    if (is_zlib)
+        return decode_stream(input);
+    PrefixedInputStream prefixed_input { { header, header_size }, input };
+    return decode_stream(prefixed_input);
+}
+
+bool ContentDecoder::decode_stream(InputStream& input)
+{
+    OwnPtr<InputStream> decompressor;
+    if (m_encoding == Encoding::Gzip)
+        decompressor = make<Compress::GzipDecompressor>(input);
+    else
+        decompressor = make<Compress::DeflateDecompressor>(input);
+
+    auto buffer_or_error = ByteBuffer::create_uninitialized(64 * KiB);
+    if (!buffer_or_error.has_value())
+        return false;
+    auto buffer = buffer_or_error.release_value();
+
+    bool success = true;
+    while (success && !m_cancelled) {
+        auto nread = decompressor->read(buffer);
+        if (nread == 0)
+            break;
+        success = write_output(buffer.bytes().trim(nread));
+    }
+    if (decompressor->handle_any_error())
+        success = false;
+    return success && !m_cancelled;
+}
+
+bool ContentDecoder::write_output(ReadonlyBytes bytes)
+{
+    while (!bytes.is_empty()) {
+        if (m_cancelled)
+            return false;
+        auto nwritten = m_output.write(bytes);
+        bytes = bytes.slice(nwritten);
+        if (bytes.is_empty())
+            break;
+        m_output.handle_any_error();
+        // The reader is behind (or gone). This doesn't block indefinitely, so that the decoder can be cancelled.
+        pollfd output_poll { m_output_fd, POLLOUT, 0 };
+        if (poll(&output_poll, 1, output_poll_timeout_ms) < 0 && errno != EINTR)
+            return false;
+        if (output_poll.revents & (POLLERR | POLLHUP | POLLNVAL))
+            return false;
+    }
+    return true;
+}
+
+}
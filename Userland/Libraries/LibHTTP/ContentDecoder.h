@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/Error.h>
+#include <AK/Function.h>
+#include <AK/Noncopyable.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Stream.h>
+#include <LibCore/Notifier.h>
+#include <LibThreading/Thread.h>
+
+namespace HTTP {
+
+// Decodes a gzip or deflate response body on a thread of its own, while the body is still coming in.
+//
+// The encoded body goes into a pipe that the thread reads from, and the decoded body goes to the output stream. When
+// whoever reads the output falls behind, the thread waits, the pipe fills up, and write() starts taking less than it
+// is given, which is the job's cue to stop reading from the network for a while.
+class ContentDecoder {
+    AK_MAKE_NONCOPYABLE(ContentDecoder);
+    AK_MAKE_NONMOVABLE(ContentDecoder);
+
+public:
+    static bool is_supported(StringView content_encoding);
+
+    // The output stream has to write to the (non-blocking) file descriptor, which the thread waits on when it's full.
+    // Nothing else may write to the output stream until the decoder is done.
+    static ErrorOr<NonnullOwnPtr<ContentDecoder>> try_create(StringView content_encoding, OutputStream& output, int output_fd);
+    ~ContentDecoder();
+
+    // Takes as much of the encoded data as fits in the pipe, which may be nothing at all. Once input_fd() becomes
+    // writable, there's room for more.
+    size_t write(ReadonlyBytes);
+    int input_fd() const { return m_input_fd; }
+
+    // Called once the whole body has been written. on_finish is called when everything has been decoded and written out,
+    // or when decoding failed.
+    void finish_input();
+    Function<void(bool success)> on_finish;
+
+private:
+    enum class Encoding {
+        Gzip,
+        Deflate,
+    };
+
+    ContentDecoder(Encoding, OutputStream&, int output_fd, int input_fd, int pipe_read_fd, int done_read_fd, int done_write_fd);
+
+    bool decode();
+    bool decode_stream(InputStream&);
+    bool write_output(ReadonlyBytes);
+
+    Encoding m_encoding;
+    OutputStream& m_output;
+    int m_output_fd { -1 };
+    // The ends of the pipe the encoded body goes through.
+    int m_input_fd { -1 };
+    int m_pipe_read_fd { -1 };
+    // The thread writes its result into this pipe when it's done.
+    int m_done_read_fd { -1 };
+    int m_done_write_fd { -1 };
+
+    RefPtr<Threading::Thread> m_thread;
+    RefPtr<Core::Notifier> m_done_notifier;
+    Atomic<bool> m_cancelled { false };
+};
+
+}
@@ -8,6 +8,8 @@
 
 namespace HTTP {
 
+class ContentDecoder;
+class Http2Connection;
 class HttpRequest;
 class HttpResponse;
 class HttpJob;
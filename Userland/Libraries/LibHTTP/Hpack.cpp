@@ -0,0 +1,418 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Array.h>
+#include <AK/StringBuilder.h>
+#include <LibHTTP/Hpack.h>
+
+namespace HTTP::Hpack {
+
+// RFC 7541 section 4.1: Every entry costs 32 bytes on top of its name and value.
+static constexpr size_t entry_overhead = 32;
+
+static size_t entry_size(Header const& header)
+{
+    return header.name.length() + header.value.length() + entry_overhead;
+}
+
+// RFC 7541 appendix A
+static Array<Header, 61> const& static_table()
+{
+    static Array<Header, 61> const table { {
+        { ":authority", "" },
+        { ":method", "GET" },
+        { ":method", "POST" },
+        { ":path", "/" },
+        { ":path", "/index.html" },
+        { ":scheme", "http" },
+        { ":scheme", "https" },
+        { ":status", "200" },
+        { ":status", "204" },
+        { ":status", "206" },
+        { ":status", "304" },
+        { ":status", "400" },
+        { ":status", "404" },
+        { ":status", "500" },
+        { "accept-charset", "" },
+        { "accept-encoding", "gzip, deflate" },
+        { "accept-language", "" },
+        { "accept-ranges", "" },
+        { "accept", "" },
+        { "access-control-allow-origin", "" },
+        { "age", "" },
+        { "allow", "" },
+        { "authorization", "" },
+        { "cache-control", "" },
+        { "content-disposition", "" },
+        { "content-encoding", "" },
+        { "content-language", "" },
+        { "content-length", "" },
+        { "content-location", "" },
+        { "content-range", "" },
+        { "content-type", "" },
+        { "cookie", "" },
+        { "date", "" },
+        { "etag", "" },
+        { "expect", "" },
+        { "expires", "" },
+        { "from", "" },
+        { "host", "" },
+        { "if-match", "" },
+        { "if-modified-since", "" },
+        { "if-none-match", "" },
+        { "if-range", "" },
+        { "if-unmodified-since", "" },
+        { "last-modified", "" },
+        { "link", "" },
+        { "location", "" },
+        { "max-forwards", "" },
+        { "proxy-authenticate", "" },
+        { "proxy-authorization", "" },
+        { "range", "" },
+        { "referer", "" },
+        { "refresh", "" },
+        { "retry-after", "" },
+        { "server", "" },
+        { "set-cookie", "" },
+        { "strict-transport-security", "" },
+        { "transfer-encoding", "" },
+        { "user-agent", "" },
+        { "vary", "" },
+        { "via", "" },
+        { "www-authenticate", "" },
+    } };
+    return table;
+}
+
+HeaderTable::HeaderTable(size_t max_size)
+    : m_max_size(max_size)
+{
+}
+
+Header const* HeaderTable::get(size_t index) const
+{
+    if (index == 0)
+        return nullptr;
+    if (index <= static_table().size())
+        return &static_table()[index - 1];
+    index -= static_table().size() + 1;
+    if (index >= m_entries.size())
+        return nullptr;
+    return &m_entries[m_entries.size() - 1 - index];
+}
+
+void HeaderTable::add(Header header)
+{
+    auto size = entry_size(header);
+    // RFC 7541 section 4.4: An entry that is larger than the whole table empties it, and isn't added.
+    if (size > m_max_size) {
+        evict_down_to(0);
+        return;
+    }
+    evict_down_to(m_max_size - size);
+    m_size += size;
+    m_entries.append(move(header));
+}
+
+void HeaderTable::set_max_size(size_t max_size)
+{
+    m_max_size = max_size;
+    evict_down_to(max_size);
+}
+
+void HeaderTable::evict_down_to(size_t size)
+{
+    size_t evicted_count = 0;
+    while (m_size > size) {
+        m_size -= entry_size(m_entries[evicted_count]);
+        ++evicted_count;
+    }
+    m_entries.remove(0, evicted_count);
+}
+
+Optional<HeaderTable::Match> HeaderTable::find(StringView name, StringView value) const
+{
+    Optional<Match> name_match;
+    for (size_t i = 0; i < static_table().size(); ++i) {
+        auto& header = static_table()[i];
+        if (header.name != name)
+            continue;
+        if (header.value == value)
+            return Match { i + 1, true };
+        if (!name_match.has_value())
+            name_match = Match { i + 1, false };
+    }
+    for (size_t i = 0; i < m_entries.size(); ++i) {
+        auto& header = m_entries[m_entries.size() - 1 - i];
+        if (header.name != name)
+            continue;
+        if (header.value == value)
+            return Match { static_table().size() + 1 + i, true };
+        if (!name_match.has_value())
+            name_match = Match { static_table().size() + 1 + i, false };
+    }
+    return name_match;
+}
+
+// RFC 7541 appendix B: The length in bits of the code of every symbol, with EOS last. The code is canonical (codes of the
+// same length are consecutive and ordered by symbol), so the codes themselves follow from the lengths.
+static constexpr Array<u8, 257> huffman_code_lengths = {
+    13, 23, 28, 28, 28, 28, 28, 28, 28, 24, 30, 28, 28, 30, 28, 28,
+    28, 28, 28, 28, 28, 28, 30, 28, 28, 28, 28, 28, 28, 28, 28, 28,
+    6, 10, 10, 12, 13, 6, 8, 11, 10, 10, 8, 11, 8, 6, 6, 6,
+    5, 5, 5, 6, 6, 6, 6, 6, 6, 6, 7, 8, 15, 6, 12, 10,
+    13, 6, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 8, 7, 8, 13, 19, 13, 14, 6,
+    15, 5, 6, 5, 6, 5, 6, 6, 6, 5, 7, 7, 6, 6, 6, 5,
+    6, 7, 6, 5, 5, 6, 7, 7, 7, 7, 7, 15, 11, 14, 13, 28,
+    20, 22, 20, 20, 22, 22, 22, 23, 22, 23, 23, 23, 23, 23, 24, 23,
+    24, 24, 22, 23, 24, 23, 23, 23, 23, 21, 22, 23, 22, 23, 23, 24,
+    22, 21, 20, 22, 22, 23, 23, 21, 23, 22, 22, 24, 21, 22, 23, 23,
+    21, 21, 22, 21, 23, 22, 23, 23, 20, 22, 22, 22, 23, 22, 22, 23,
+    26, 26, 20, 19, 22, 23, 22, 25, 26, 26, 26, 27, 27, 26, 24, 25,
+    19, 21, 26, 27, 27, 26, 27, 24, 21, 21, 26, 26, 28, 27, 27, 27,
+    20, 24, 20, 21, 22, 21, 21, 23, 22, 22, 25, 25, 24, 24, 26, 23,
+    26, 27, 26, 26, 27, 27, 27, 27, 27, 28, 27, 27, 27, 27, 27, 26,
+    30,
+};
+
+static constexpr size_t huffman_eos_symbol = 256;
+static constexpr size_t huffman_max_code_length = 30;
+
+struct HuffmanDecodingTable {
+    Array<u16, huffman_max_code_length + 1> code_count_by_length;
+    Array<u16, 257> symbols_by_code;
+};
+
+static consteval HuffmanDecodingTable generate_huffman_decoding_table()
+{
+    HuffmanDecodingTable table {};
+    for (auto length : huffman_code_lengths)
+        ++table.code_count_by_length[length];
+    size_t index = 0;
+    for (size_t length = 1; length <= huffman_max_code_length; ++length) {
+        for (size_t symbol = 0; symbol < huffman_code_lengths.size(); ++symbol) {
+            if (huffman_code_lengths[symbol] == length)
+                table.symbols_by_code[index++] = symbol;
+        }
+    }
+    return table;
+}
+
+static constexpr auto huffman_decoding_table = generate_huffman_decoding_table();
+
+ErrorOr<String> decode_huffman(ReadonlyBytes bytes)
+{
+    StringBuilder builder;
+    // The code read so far, the first code of its length, and the index of that code in symbols_by_code.
+    u32 code = 0;
+    u32 first_code = 0;
+    size_t first_index = 0;
+    size_t length = 0;
+    bool code_is_all_ones = true;
+
+    for (auto byte : bytes) {
+        for (int bit_index = 7; bit_index >= 0; --bit_index) {
+            u32 bit = (byte >> bit_index) & 1;
+            code |= bit;
+            code_is_all_ones &= bit == 1;
+            ++length;
+
+            auto count = huffman_decoding_table.code_count_by_length[length];
+            if (code < first_code + count) {
+                auto symbol = huffman_decoding_table.symbols_by_code[first_index + code - first_code];
+                if (symbol == huffman_eos_symbol)
+                    return Error::from_string_literal("Huffman-encoded string contains EOS"sv);
+                builder.append((char)symbol);
+                code = 0;
+                first_code = 0;
+                first_index = 0;
+                length = 0;
+                code_is_all_ones = true;
+                continue;
+            }
+
+            if (length == huffman_max_code_length)
+                return Error::from_string_literal("Invalid Huffman code"sv);
+            first_index += count;
+            first_code = (first_code + count) << 1;
+            code <<= 1;
+        }
+    }
+
+    // RFC 7541 section 5.2: The string is padded to a whole byte with the most significant bits of EOS, which are all ones.
+    if (length > 7 || !code_is_all_ones)
+        return Error::from_string_literal("Invalid Huffman padding"sv);
+    return builder.to_string();
+}
+
+// RFC 7541 section 5.1
+static ErrorOr<size_t> decode_integer(ReadonlyBytes bytes, size_t& offset, u8 prefix_bits)
+{
+    VERIFY(offset < bytes.size());
+    size_t max_prefix = (1u << prefix_bits) - 1;
+    size_t value = bytes[offset++] & max_prefix;
+    if (value < max_prefix)
+        return value;
+    // Nothing we decode comes anywhere close to 2^28, so anything beyond that is an attack or garbage.
+    for (size_t shift = 0; shift <= 21; shift += 7) {
+        if (offset >= bytes.size())
+            return Error::from_string_literal("Truncated integer"sv);
+        u8 byte = bytes[offset++];
+        value += (size_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return value;
+    }
+    return Error::from_string_literal("Integer is too large"sv);
+}
+
+static void encode_integer(ByteBuffer& buffer, u8 first_byte, u8 prefix_bits, size_t value)
+{
+    size_t max_prefix = (1u << prefix_bits) - 1;
+    if (value < max_prefix) {
+        buffer.append((u8)(first_byte | value));
+        return;
+    }
+    buffer.append((u8)(first_byte | max_prefix));
+    value -= max_prefix;
+    while (value >= 0x80) {
+        buffer.append((u8)((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    buffer.append((u8)value);
+}
+
+// RFC 7541 section 5.2
+static ErrorOr<String> decode_string(ReadonlyBytes bytes, size_t& offset)
+{
+    if (offset >= bytes.size())
+        return Error::from_string_literal("Truncated string"sv);
+    bool is_huffman_encoded = bytes[offset] & 0x80;
+    auto length = TRY(decode_integer(bytes, offset, 7));
+    if (length > bytes.size() - offset)
+        return Error::from_string_literal("Truncated string"sv);
+    auto string = bytes.slice(offset, length);
+    offset += length;
+    if (is_huffman_encoded)
+        return decode_huffman(string);
+    return String { string };
+}
+
+// We don't bother Huffman-encoding what we send, the dynamic table does most of the work for the headers we repeat.
+static void encode_string(ByteBuffer& buffer, StringView string)
+{
+    encode_integer(buffer, 0, 7, string.length());
+    buffer.append(string.bytes());
+}
+
+Decoder::Decoder(size_t table_size_limit)
+    : m_table(table_size_limit)
+    , m_table_size_limit(table_size_limit)
+{
+}
+
+ErrorOr<Vector<Header>> Decoder::decode(ReadonlyBytes header_block)
+{
+    Vector<Header> headers;
+    size_t offset = 0;
+    // RFC 7541 section 4.2: Table size updates may only come at the start of a header block.
+    bool may_update_table_size = true;
+    while (offset < header_block.size()) {
+        u8 first_byte = header_block[offset];
+
+        if (first_byte & 0x80) {
+            // Indexed Header Field, see RFC 7541 section 6.1.
+            auto index = TRY(decode_integer(header_block, offset, 7));
+            auto const* header = m_table.get(index);
+            if (!header)
+                return Error::from_string_literal("Invalid header table index"sv);
+            headers.append(*header);
+        } else if ((first_byte & 0xe0) == 0x20) {
+            // Dynamic Table Size Update, see RFC 7541 section 6.3.
+            if (!may_update_table_size)
+                return Error::from_string_literal("Table size update in the middle of a header block"sv);
+            auto max_size = TRY(decode_integer(header_block, offset, 5));
+            if (max_size > m_table_size_limit)
+                return Error::from_string_literal("Table size update beyond the limit"sv);
+            m_table.set_max_size(max_size);
+            continue;
+        } else {
+            // Literal Header Field with Incremental Indexing (01), without Indexing (0000) or Never Indexed (0001), see RFC
+            // 7541 section 6.2. The name either refers to the table or follows as a string.
+            bool add_to_table = first_byte & 0x40;
+            auto name_index = TRY(decode_integer(header_block, offset, add_to_table ? 6 : 4));
+            Header header;
+            if (name_index == 0) {
+                header.name = TRY(decode_string(header_block, offset));
+            } else {
+                auto const* named_header = m_table.get(name_index);
+                if (!named_header)
+                    return Error::from_string_literal("Invalid header table index"sv);
+                header.name = named_header->name;
+            }
+            header.value = TRY(decode_string(header_block, offset));
+            if (add_to_table)
+                m_table.add(header);
+            headers.append(move(header));
+        }
+        may_update_table_size = false;
+    }
+    return headers;
+}
+
+Encoder::Encoder(size_t table_size)
+    : m_table(table_size)
+{
+}
+
+void Encoder::set_table_size_limit(size_t limit)
+{
+    auto table_size = min(limit, default_table_size);
+    if (table_size == m_table.max_size())
+        return;
+    m_table.set_max_size(table_size);
+    m_table_size_changed = true;
+}
+
+// Credentials stay out of the dynamic table, so a compression oracle can't be used to guess them, see RFC 7541 section 7.1.
+static bool is_sensitive(Header const& header)
+{
+    return header.name == "authorization"sv || header.name == "proxy-authorization"sv;
+}
+
+ByteBuffer Encoder::encode(Vector<Header> const& headers)
+{
+    ByteBuffer buffer;
+    if (m_table_size_changed) {
+        encode_integer(buffer, 0x20, 5, m_table.max_size());
+        m_table_size_changed = false;
+    }
+
+    for (auto& header : headers) {
+        auto match = m_table.find(header.name, header.value);
+        if (match.has_value() && match->value_matches) {
+            encode_integer(buffer, 0x80, 7, match->index);
+            continue;
+        }
+
+        size_t name_index = match.has_value() ? match->index : 0;
+        if (is_sensitive(header)) {
+            encode_integer(buffer, 0x10, 4, name_index);
+        } else if (entry_size(header) > m_table.max_size() / 2) {
+            // Indexing this would push out most of what is in the table, and it's unlikely to be worth it.
+            encode_integer(buffer, 0x00, 4, name_index);
+        } else {
+            encode_integer(buffer, 0x40, 6, name_index);
+            m_table.add(header);
+        }
+        if (name_index == 0)
+            encode_string(buffer, header.name);
+        encode_string(buffer, header.value);
+    }
+    return buffer;
+}
+
+}
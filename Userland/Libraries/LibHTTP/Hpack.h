@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/Error.h>
+#include <AK/Optional.h>
+#include <AK/String.h>
+#include <AK/Vector.h>
+
+// HPACK, the header compression of HTTP/2, see RFC 7541.
+namespace HTTP::Hpack {
+
+// The size of the dynamic table until the peer says otherwise, see RFC 7540 section 6.5.2.
+static constexpr size_t default_table_size = 4096;
+
+struct Header {
+    String name;
+    String value;
+};
+
+// The static table followed by the dynamic table, which both ends of a connection keep in sync, see RFC 7541 section 2.3.
+// Indices start at 1.
+class HeaderTable {
+public:
+    explicit HeaderTable(size_t max_size);
+
+    Header const* get(size_t index) const;
+    void add(Header);
+
+    size_t max_size() const { return m_max_size; }
+    void set_max_size(size_t);
+
+    struct Match {
+        size_t index;
+        bool value_matches;
+    };
+    // Prefers an entry that matches both the name and the value over one that only matches the name.
+    Optional<Match> find(StringView name, StringView value) const;
+
+private:
+    void evict_down_to(size_t size);
+
+    // Oldest first, so the newest entry (index 62) is at the end.
+    Vector<Header> m_entries;
+    size_t m_size { 0 };
+    size_t m_max_size { 0 };
+};
+
+class Decoder {
+public:
+    // The limit is the SETTINGS_HEADER_TABLE_SIZE we announced, which the peer's encoder may not exceed.
+    explicit Decoder(size_t table_size_limit = default_table_size);
+
+    ErrorOr<Vector<Header>> decode(ReadonlyBytes header_block);
+
+private:
+    HeaderTable m_table;
+    size_t m_table_size_limit { 0 };
+};
+
+class Encoder {
+public:
+    explicit Encoder(size_t table_size = default_table_size);
+
+    ByteBuffer encode(Vector<Header> const&);
+
+    // Called with the peer's SETTINGS_HEADER_TABLE_SIZE. We never grow the table past the default, as that only costs the
+    // peer memory.
+    void set_table_size_limit(size_t);
+
+private:
+    HeaderTable m_table;
+    bool m_table_size_changed { false };
+};
+
+ErrorOr<String> decode_huffman(ReadonlyBytes);
+
+}
@@ -0,0 +1,619 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <AK/StringBuilder.h>
+#include <LibHTTP/Http2Connection.h>
+
+namespace HTTP {
+
+// RFC 7540 section 3.5
+static constexpr StringView connection_preface = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n"sv;
+
+static constexpr size_t frame_header_size = 9;
+// We never raise SETTINGS_MAX_FRAME_SIZE, so this is the most the server may send us in one frame.
+static constexpr size_t max_received_frame_size = 16384;
+// A header block split over CONTINUATION frames may not grow past this, or a server could make us buffer forever.
+static constexpr size_t max_header_block_size = 256 * KiB;
+static constexpr i64 max_window_size = 0x7fffffff;
+
+// How much a stream, and the whole connection, may receive before we send a WINDOW_UPDATE. The defaults of 64 KiB
+// would leave us waiting a round trip for every 64 KiB of a download.
+static constexpr i64 stream_receive_window = 1 * MiB;
+static constexpr i64 connection_receive_window = 16 * MiB;
+static constexpr i64 default_window_size = 65535;
+
+static constexpr u8 flag_end_stream = 0x1;
+static constexpr u8 flag_ack = 0x1;
+static constexpr u8 flag_end_headers = 0x4;
+static constexpr u8 flag_padded = 0x8;
+static constexpr u8 flag_priority = 0x20;
+
+// RFC 7540 section 6.5.2
+enum class Setting : u16 {
+    HeaderTableSize = 0x1,
+    EnablePush = 0x2,
+    MaxConcurrentStreams = 0x3,
+    InitialWindowSize = 0x4,
+    MaxFrameSize = 0x5,
+    MaxHeaderListSize = 0x6,
+};
+
+static u16 read_u16(ReadonlyBytes bytes, size_t offset)
+{
+    return (bytes[offset] << 8) | bytes[offset + 1];
+}
+
+static u32 read_u32(ReadonlyBytes bytes, size_t offset)
+{
+    return ((u32)bytes[offset] << 24) | (bytes[offset + 1] << 16) | (bytes[offset + 2] << 8) | bytes[offset + 3];
+}
+
+static void append_u16(ByteBuffer& buffer, u16 value)
+{
+    buffer.append((u8)(value >> 8));
+    buffer.append((u8)value);
+}
+
+static void append_u32(ByteBuffer& buffer, u32 value)
+{
+    buffer.append((u8)(value >> 24));
+    buffer.append((u8)(value >> 16));
+    buffer.append((u8)(value >> 8));
+    buffer.append((u8)value);
+}
+
+// Returns the payload without the padding, or nothing if the padding doesn't fit in the payload.
+static Optional<ReadonlyBytes> remove_padding(u8 flags, ReadonlyBytes payload)
+{
+    if (!(flags & flag_padded))
+        return payload;
+    if (payload.is_empty())
+        return {};
+    size_t padding_length = payload[0];
+    if (padding_length >= payload.size())
+        return {};
+    return payload.slice(1, payload.size() - 1 - padding_length);
+}
+
+void Http2Connection::offer_through_alpn(TLS::TLSv12& socket)
+{
+    if (socket.has_alpn(alpn_protocol))
+        return;
+    socket.add_alpn(alpn_protocol);
+    socket.add_alpn("http/1.1"sv);
+}
+
+Http2Connection::Http2Connection(NonnullRefPtr<TLS::TLSv12> socket)
+    : m_socket(move(socket))
+{
+    m_socket->on_tls_ready_to_read = [this](auto&) {
+        did_become_readable();
+    };
+    m_socket->on_tls_error = [this](auto) {
+        m_has_failed = true;
+        fail_all_streams(Core::NetworkJob::Error::TransmissionFailed);
+    };
+    m_socket->on_tls_finished = [this] {
+        m_is_going_away = true;
+        fail_all_streams(Core::NetworkJob::Error::TransmissionFailed);
+    };
+    m_socket->on_tls_connected = nullptr;
+    m_socket->set_on_tls_ready_to_write(nullptr);
+    m_socket->set_idle(false);
+
+    m_send_buffer.append(connection_preface.bytes());
+
+    ByteBuffer settings;
+    append_u16(settings, (u16)Setting::EnablePush);
+    append_u32(settings, 0);
+    append_u16(settings, (u16)Setting::InitialWindowSize);
+    append_u32(settings, stream_receive_window);
+    send_frame(FrameType::Settings, 0, 0, settings);
+
+    // The window of the connection isn't covered by the settings, so it's raised separately, see RFC 7540 section 6.9.2.
+    m_receive_window = connection_receive_window;
+    send_window_update(0, connection_receive_window - default_window_size);
+    flush();
+
+    // Whatever arrived along with the end of the handshake is already waiting for us.
+    if (m_socket->can_read())
+        deferred_invoke([this] { did_become_readable(); });
+}
+
+Http2Connection::~Http2Connection()
+{
+    m_socket->on_tls_ready_to_read = nullptr;
+    m_socket->on_tls_error = nullptr;
+    m_socket->on_tls_finished = nullptr;
+
+    if (!m_has_failed && m_socket->is_established()) {
+        ByteBuffer payload;
+        append_u32(payload, 0);
+        append_u32(payload, (u32)ErrorCode::NoError);
+        send_frame(FrameType::GoAway, 0, 0, payload);
+        flush();
+    }
+    m_socket->close();
+}
+
+bool Http2Connection::can_open_stream() const
+{
+    return !m_has_failed && !m_is_going_away && m_socket->is_established()
+        && m_streams.size() < m_max_concurrent_streams && m_next_stream_id < max_window_size;
+}
+
+u32 Http2Connection::open_stream(HttpRequest const& request, StreamClient client)
+{
+    VERIFY(can_open_stream());
+
+    auto stream_id = m_next_stream_id;
+    m_next_stream_id += 2;
+
+    auto const& url = request.url();
+    StringBuilder authority;
+    authority.append(url.host());
+    if (url.port_or_default() != URL::default_port_for_scheme(url.scheme()))
+        authority.appendff(":{}", url.port_or_default());
+
+    // RFC 7540 section 8.1.2.3
+    Vector<Hpack::Header> headers {
+        { ":method", request.method_name() },
+        { ":scheme", url.scheme() },
+        { ":authority", authority.to_string() },
+        { ":path", request.request_target() },
+    };
+    for (auto& header : request.headers()) {
+        auto name = header.name.to_lowercase();
+        // Connection-specific headers have no place in HTTP/2, and the host already went into :authority, see RFC 7540
+        // section 8.1.2.2.
+        if (name.is_one_of("connection", "keep-alive", "proxy-connection", "transfer-encoding", "upgrade", "host", "te"))
+            continue;
+        headers.append({ move(name), header.value });
+    }
+    if (!request.body().is_empty())
+        headers.append({ "content-length", String::number(request.body().size()) });
+
+    dbgln_if(HTTP2_DEBUG, "Http2Connection: Opening stream {} for {}", stream_id, url);
+
+    auto block = m_encoder.encode(headers);
+    bool has_body = !request.body().is_empty();
+
+    // A header block that doesn't fit in one frame continues in CONTINUATION frames.
+    ReadonlyBytes remaining = block;
+    auto fragment = remaining.trim(m_max_frame_size);
+    remaining = remaining.slice(fragment.size());
+    send_frame(FrameType::Headers, (has_body ? 0 : flag_end_stream) | (remaining.is_empty() ? flag_end_headers : 0), stream_id, fragment);
+    while (!remaining.is_empty()) {
+        fragment = remaining.trim(m_max_frame_size);
+        remaining = remaining.slice(fragment.size());
+        send_frame(FrameType::Continuation, remaining.is_empty() ? flag_end_headers : 0, stream_id, fragment);
+    }
+
+    auto stream = make<Stream>();
+    stream->client = move(client);
+    stream->send_window = m_initial_send_window;
+    stream->receive_window = stream_receive_window;
+    if (has_body)
+        stream->body = request.body();
+    m_streams.set(stream_id, move(stream));
+
+    send_pending_data();
+    flush();
+    return stream_id;
+}
+
+void Http2Connection::cancel_stream(u32 stream_id)
+{
+    if (!m_streams.remove(stream_id))
+        return;
+    dbgln_if(HTTP2_DEBUG, "Http2Connection: Cancelling stream {}", stream_id);
+    reset_stream(stream_id, ErrorCode::Cancel);
+    flush();
+}
+
+void Http2Connection::set_stream_paused(u32 stream_id, bool paused)
+{
+    auto it = m_streams.find(stream_id);
+    if (it == m_streams.end())
+        return;
+    auto& stream = *it->value;
+    if (stream.is_paused == paused)
+        return;
+    dbgln_if(HTTP2_DEBUG, "Http2Connection: {} stream {}", paused ? "Pausing" : "Resuming", stream_id);
+    stream.is_paused = paused;
+    if (paused || stream.receive_window >= stream_receive_window / 2)
+        return;
+    send_window_update(stream_id, stream_receive_window - stream.receive_window);
+    stream.receive_window = stream_receive_window;
+    flush();
+}
+
+void Http2Connection::did_become_readable()
+{
+    // The streams' clients may drop the last reference to us from their callbacks.
+    NonnullRefPtr protect = *this;
+
+    auto data = m_socket->read();
+    if (data.has_value())
+        m_receive_buffer.append(*data);
+
+    size_t offset = 0;
+    while (!m_has_failed && m_receive_buffer.size() - offset >= frame_header_size) {
+        auto bytes = m_receive_buffer.bytes().slice(offset);
+        size_t length = (bytes[0] << 16) | (bytes[1] << 8) | bytes[2];
+        if (length > max_received_frame_size) {
+            fail_connection(ErrorCode::FrameSizeError, "Frame is larger than SETTINGS_MAX_FRAME_SIZE"sv);
+            break;
+        }
+        if (bytes.size() < frame_header_size + length)
+            break;
+
+        auto type = (FrameType)bytes[3];
+        u8 flags = bytes[4];
+        u32 stream_id = read_u32(bytes, 5) & 0x7fffffff;
+        offset += frame_header_size + length;
+        handle_frame(type, flags, stream_id, bytes.slice(frame_header_size, length));
+    }
+
+    if (m_has_failed)
+        m_receive_buffer.clear();
+    else if (offset > 0)
+        m_receive_buffer = m_receive_buffer.slice(offset, m_receive_buffer.size() - offset);
+
+    flush();
+}
+
+void Http2Connection::handle_frame(FrameType type, u8 flags, u32 stream_id, ReadonlyBytes payload)
+{
+    dbgln_if(HTTP2_DEBUG, "Http2Connection: Received frame of type {} on stream {}, flags {:02x}, {} bytes", (u8)type, stream_id, flags, payload.size());
+
+    // RFC 7540 section 3.5
+    if (!m_has_received_settings && type != FrameType::Settings)
+        return fail_connection(ErrorCode::ProtocolError, "The server didn't start with SETTINGS"sv);
+
+    // RFC 7540 section 6.10
+    if (m_partial_header_block.has_value() && (type != FrameType::Continuation || stream_id != m_partial_header_block->stream_id))
+        return fail_connection(ErrorCode::ProtocolError, "Header block was interrupted"sv);
+
+    switch (type) {
+    case FrameType::Data:
+        return handle_data(flags, stream_id, payload);
+    case FrameType::Headers: {
+        if (stream_id == 0)
+            return fail_connection(ErrorCode::ProtocolError, "HEADERS on stream 0"sv);
+        auto fragment = remove_padding(flags, payload);
+        if (!fragment.has_value())
+            return fail_connection(ErrorCode::ProtocolError, "Invalid padding"sv);
+        // We don't prioritize anything, so the priority fields are skipped.
+        if (flags & flag_priority) {
+            if (fragment->size() < 5)
+                return fail_connection(ErrorCode::FrameSizeError, "HEADERS too short for its priority"sv);
+            fragment = fragment->slice(5);
+        }
+        if (flags & flag_end_headers)
+            return handle_header_block(stream_id, *fragment, flags & flag_end_stream);
+        m_partial_header_block = PartialHeaderBlock { stream_id, (flags & flag_end_stream) != 0, {} };
+        m_partial_header_block->block.append(*fragment);
+        return;
+    }
+    case FrameType::Continuation: {
+        if (!m_partial_header_block.has_value())
+            return fail_connection(ErrorCode::ProtocolError, "CONTINUATION without a header block"sv);
+        if (m_partial_header_block->block.size() + payload.size() > max_header_block_size)
+            return fail_connection(ErrorCode::ProtocolError, "Header block is too large"sv);
+        m_partial_header_block->block.append(payload);
+        if (flags & flag_end_headers) {
+            auto partial = m_partial_header_block.release_value();
+            handle_header_block(partial.stream_id, partial.block, partial.end_stream);
+        }
+        return;
+    }
+    case FrameType::Priority:
+        return;
+    case FrameType::RstStream: {
+        if (stream_id == 0)
+            return fail_connection(ErrorCode::ProtocolError, "RST_STREAM on stream 0"sv);
+        if (payload.size() != 4)
+            return fail_connection(ErrorCode::FrameSizeError, "RST_STREAM of the wrong size"sv);
+        dbgln_if(HTTP2_DEBUG, "Http2Connection: Server reset stream {} with error {}", stream_id, read_u32(payload, 0));
+        return fail_stream(stream_id, Core::NetworkJob::Error::ProtocolFailed);
+    }
+    case FrameType::Settings:
+        return handle_settings(flags, stream_id, payload);
+    case FrameType::PushPromise:
+        // We told the server not to push anything.
+        return fail_connection(ErrorCode::ProtocolError, "PUSH_PROMISE while push is disabled"sv);
+    case FrameType::Ping:
+        if (stream_id != 0)
+            return fail_connection(ErrorCode::ProtocolError, "PING on a stream"sv);
+        if (payload.size() != 8)
+            return fail_connection(ErrorCode::FrameSizeError, "PING of the wrong size"sv);
+        if (!(flags & flag_ack))
+            send_frame(FrameType::Ping, flag_ack, 0, payload);
+        return;
+    case FrameType::GoAway:
+        if (stream_id != 0)
+            return fail_connection(ErrorCode::ProtocolError, "GOAWAY on a stream"sv);
+        return handle_go_away(payload);
+    case FrameType::WindowUpdate:
+        return handle_window_update(stream_id, payload);
+    }
+
+    // Frames of unknown types are ignored, see RFC 7540 section 4.1.
+}
+
+void Http2Connection::handle_header_block(u32 stream_id, ReadonlyBytes block, bool end_stream)
+{
+    // The block is decoded even if nobody is waiting for it anymore, as it may still change the dynamic table.
+    auto headers_or_error = m_decoder.decode(block);
+    if (headers_or_error.is_error())
+        return fail_connection(ErrorCode::CompressionError, "Header block could not be decoded"sv);
+
+    auto it = m_streams.find(stream_id);
+    if (it == m_streams.end())
+        return;
+    it->value->client.on_headers(headers_or_error.value());
+    if (end_stream)
+        finish_stream(stream_id);
+}
+
+void Http2Connection::handle_data(u8 flags, u32 stream_id, ReadonlyBytes payload)
+{
+    if (stream_id == 0)
+        return fail_connection(ErrorCode::ProtocolError, "DATA on stream 0"sv);
+
+    // Flow control counts the whole payload, padding and all, see RFC 7540 section 6.9.1.
+    m_receive_window -= payload.size();
+    if (m_receive_window < 0)
+        return fail_connection(ErrorCode::FlowControlError, "Server exceeded the connection window"sv);
+    if (m_receive_window < connection_receive_window / 2) {
+        send_window_update(0, connection_receive_window - m_receive_window);
+        m_receive_window = connection_receive_window;
+    }
+
+    auto data = remove_padding(flags, payload);
+    if (!data.has_value())
+        return fail_connection(ErrorCode::ProtocolError, "Invalid padding"sv);
+
+    auto it = m_streams.find(stream_id);
+    if (it == m_streams.end())
+        return;
+    auto& stream = *it->value;
+
+    stream.receive_window -= payload.size();
+    if (stream.receive_window < 0) {
+        reset_stream(stream_id, ErrorCode::FlowControlError);
+        return fail_stream(stream_id, Core::NetworkJob::Error::ProtocolFailed);
+    }
+    // A paused stream doesn't get any more room, so the server stops sending on it once the window runs out.
+    if (!(flags & flag_end_stream) && !stream.is_paused && stream.receive_window < stream_receive_window / 2) {
+        send_window_update(stream_id, stream_receive_window - stream.receive_window);
+        stream.receive_window = stream_receive_window;
+    }
+
+    // The client may cancel the stream from on_data, so the stream can't be touched after it.
+    if (!data->is_empty())
+        stream.client.on_data(*data);
+    if (flags & flag_end_stream)
+        finish_stream(stream_id);
+}
+
+void Http2Connection::handle_settings(u8 flags, u32 stream_id, ReadonlyBytes payload)
+{
+    if (stream_id != 0)
+        return fail_connection(ErrorCode::ProtocolError, "SETTINGS on a stream"sv);
+    if (flags & flag_ack) {
+        if (!payload.is_empty())
+            return fail_connection(ErrorCode::FrameSizeError, "SETTINGS acknowledgement with a payload"sv);
+        return;
+    }
+    if (payload.size() % 6 != 0)
+        return fail_connection(ErrorCode::FrameSizeError, "SETTINGS of the wrong size"sv);
+
+    for (size_t offset = 0; offset < payload.size(); offset += 6) {
+        auto setting = (Setting)read_u16(payload, offset);
+        u32 value = read_u32(payload, offset + 2);
+        dbgln_if(HTTP2_DEBUG, "Http2Connection: Setting {} = {}", (u16)setting, value);
+
+        switch (setting) {
+        case Setting::HeaderTableSize:
+            m_encoder.set_table_size_limit(value);
+            break;
+        case Setting::MaxConcurrentStreams:
+            m_max_concurrent_streams = value;
+            break;
+        case Setting::InitialWindowSize: {
+            if (value > max_window_size)
+                return fail_connection(ErrorCode::FlowControlError, "SETTINGS_INITIAL_WINDOW_SIZE is too large"sv);
+            // The change applies to the windows of the streams that are already open, see RFC 7540 section 6.9.2.
+            i64 delta = (i64)value - m_initial_send_window;
+            for (auto& it : m_streams)
+                it.value->send_window += delta;
+            m_initial_send_window = value;
+            break;
+        }
+        case Setting::MaxFrameSize:
+            if (value < 16384 || value > 16777215)
+                return fail_connection(ErrorCode::ProtocolError, "SETTINGS_MAX_FRAME_SIZE is out of range"sv);
+            m_max_frame_size = value;
+            break;
+        default:
+            // Unknown settings are ignored, and so are the ones that don't concern a client.
+            break;
+        }
+    }
+
+    m_has_received_settings = true;
+    send_frame(FrameType::Settings, flag_ack, 0);
+    send_pending_data();
+}
+
+void Http2Connection::handle_go_away(ReadonlyBytes payload)
+{
+    if (payload.size() < 8)
+        return fail_connection(ErrorCode::FrameSizeError, "GOAWAY too short"sv);
+
+    u32 last_stream_id = read_u32(payload, 0) & 0x7fffffff;
+    dbgln_if(HTTP2_DEBUG, "Http2Connection: Server is going away with error {}, last stream {}", read_u32(payload, 4), last_stream_id);
+    m_is_going_away = true;
+
+    // The streams after the last one never got to the server, and never will, see RFC 7540 section 6.8.
+    Vector<u32> abandoned_streams;
+    for (auto& it : m_streams) {
+        if (it.key > last_stream_id)
+            abandoned_streams.append(it.key);
+    }
+    for (auto id : abandoned_streams)
+        fail_stream(id, Core::NetworkJob::Error::ConnectionFailed);
+}
+
+void Http2Connection::handle_window_update(u32 stream_id, ReadonlyBytes payload)
+{
+    if (payload.size() != 4)
+        return fail_connection(ErrorCode::FrameSizeError, "WINDOW_UPDATE of the wrong size"sv);
+    u32 increment = read_u32(payload, 0) & 0x7fffffff;
+
+    if (stream_id == 0) {
+        if (increment == 0)
+            return fail_connection(ErrorCode::ProtocolError, "WINDOW_UPDATE of zero"sv);
+        m_send_window += increment;
+        if (m_send_window > max_window_size)
+            return fail_connection(ErrorCode::FlowControlError, "Connection window overflowed"sv);
+    } else {
+        auto it = m_streams.find(stream_id);
+        if (it == m_streams.end())
+            return;
+        auto& stream = *it->value;
+        stream.send_window += increment;
+        if (increment == 0 || stream.send_window > max_window_size) {
+            reset_stream(stream_id, increment == 0 ? ErrorCode::ProtocolError : ErrorCode::FlowControlError);
+            return fail_stream(stream_id, Core::NetworkJob::Error::ProtocolFailed);
+        }
+    }
+
+    send_pending_data();
+}
+
+void Http2Connection::send_frame(FrameType type, u8 flags, u32 stream_id, ReadonlyBytes payload)
+{
+    VERIFY(payload.size() <= m_max_frame_size);
+    m_send_buffer.append((u8)(payload.size() >> 16));
+    m_send_buffer.append((u8)(payload.size() >> 8));
+    m_send_buffer.append((u8)payload.size());
+    m_send_buffer.append((u8)type);
+    m_send_buffer.append(flags);
+    append_u32(m_send_buffer, stream_id);
+    m_send_buffer.append(payload);
+}
+
+void Http2Connection::send_window_update(u32 stream_id, u32 increment)
+{
+    ByteBuffer payload;
+    append_u32(payload, increment);
+    send_frame(FrameType::WindowUpdate, 0, stream_id, payload);
+}
+
+void Http2Connection::send_pending_data()
+{
+    if (m_has_failed)
+        return;
+
+    // Bodies go out as far as the windows of the connection and of their stream allow, and the rest waits for a
+    // WINDOW_UPDATE, see RFC 7540 section 6.9.
+    for (auto& it : m_streams) {
+        auto& stream = *it.value;
+        while (stream.body_offset < stream.body.size() && m_send_window > 0 && stream.send_window > 0) {
+            size_t size = min(stream.body.size() - stream.body_offset, m_max_frame_size);
+            size = min(size, (size_t)min(m_send_window, stream.send_window));
+            bool is_last = stream.body_offset + size == stream.body.size();
+            send_frame(FrameType::Data, is_last ? flag_end_stream : 0, it.key, stream.body.bytes().slice(stream.body_offset, size));
+            stream.body_offset += size;
+            stream.send_window -= size;
+            m_send_window -= size;
+        }
+        if (stream.body_offset > 0 && stream.body_offset == stream.body.size()) {
+            stream.body.clear();
+            stream.body_offset = 0;
+        }
+    }
+}
+
+void Http2Connection::flush()
+{
+    if (m_send_buffer.is_empty())
+        return;
+    // Everything that piled up while handling a batch of frames goes out in one write.
+    if (!m_socket->write(m_send_buffer))
+        dbgln("Http2Connection: Failed to write {} bytes", m_send_buffer.size());
+    m_send_buffer.clear();
+}
+
+void Http2Connection::finish_stream(u32 stream_id)
+{
+    auto it = m_streams.find(stream_id);
+    if (it == m_streams.end())
+        return;
+    auto stream = move(it->value);
+    m_streams.remove(it);
+
+    // The server may answer before it has the whole request body, in which case the rest isn't wanted anymore, see
+    // RFC 7540 section 8.1.
+    if (stream->body_offset < stream->body.size())
+        reset_stream(stream_id, ErrorCode::NoError);
+
+    dbgln_if(HTTP2_DEBUG, "Http2Connection: Stream {} finished", stream_id);
+    stream->client.on_finish();
+}
+
+void Http2Connection::fail_stream(u32 stream_id, Core::NetworkJob::Error error)
+{
+    auto it = m_streams.find(stream_id);
+    if (it == m_streams.end())
+        return;
+    auto stream = move(it->value);
+    m_streams.remove(it);
+    stream->client.on_error(error);
+}
+
+void Http2Connection::reset_stream(u32 stream_id, ErrorCode error_code)
+{
+    ByteBuffer payload;
+    append_u32(payload, (u32)error_code);
+    send_frame(FrameType::RstStream, 0, stream_id, payload);
+}
+
+void Http2Connection::fail_connection(ErrorCode error_code, StringView reason)
+{
+    if (m_has_failed)
+        return;
+    dbgln("Http2Connection: {}, closing the connection", reason);
+
+    // We never accept streams from the server, so the last stream we processed is always 0.
+    ByteBuffer payload;
+    append_u32(payload, 0);
+    append_u32(payload, (u32)error_code);
+    send_frame(FrameType::GoAway, 0, 0, payload);
+    flush();
+
+    m_has_failed = true;
+    m_is_going_away = true;
+    m_partial_header_block.clear();
+    fail_all_streams(Core::NetworkJob::Error::ProtocolFailed);
+
+    // We may be in the middle of a callback from the socket, so it's closed once that returns.
+    deferred_invoke([this] { m_socket->close(); });
+}
+
+void Http2Connection::fail_all_streams(Core::NetworkJob::Error error)
+{
+    auto streams = move(m_streams);
+    m_streams.clear();
+    for (auto& it : streams)
+        it.value->client.on_error(error);
+}
+
+}
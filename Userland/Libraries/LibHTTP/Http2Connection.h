@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/Function.h>
+#include <AK/HashMap.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Optional.h>
+#include <LibCore/NetworkJob.h>
+#include <LibCore/Object.h>
+#include <LibHTTP/Hpack.h>
+#include <LibHTTP/HttpRequest.h>
+#include <LibTLS/TLSv12.h>
+
+namespace HTTP {
+
+// The client side of an HTTP/2 connection (RFC 7540), over a TLS socket that negotiated "h2" through ALPN. Any number of
+// requests run on it at the same time, each on a stream of its own, so all requests to an origin can share one socket.
+class Http2Connection final : public Core::Object {
+    C_OBJECT(Http2Connection);
+
+public:
+    static constexpr StringView alpn_protocol = "h2"sv;
+
+    // Makes the socket offer HTTP/2 (and HTTP/1.1 as a fallback) when it connects, see RFC 7540 section 3.3.
+    static void offer_through_alpn(TLS::TLSv12&);
+
+    // What a stream tells the job it belongs to. Once on_finish or on_error has been called, the stream is gone.
+    struct StreamClient {
+        // Called with every header block: informational responses, the response itself, and the trailers.
+        Function<void(Vector<Hpack::Header> const&)> on_headers;
+        Function<void(ReadonlyBytes)> on_data;
+        Function<void()> on_finish;
+        Function<void(Core::NetworkJob::Error)> on_error;
+    };
+
+    virtual ~Http2Connection() override;
+
+    TLS::TLSv12& socket() { return m_socket; }
+
+    // Whether another request can start on this connection right now. This is false once the connection is going away,
+    // or if the server's limit on concurrent streams has been reached.
+    bool can_open_stream() const;
+    size_t open_stream_count() const { return m_streams.size(); }
+
+    // Sends the request on a new stream, and returns the id of that stream.
+    u32 open_stream(HttpRequest const&, StreamClient);
+    // Stops the response from being received, if it hasn't been received in full yet. The client isn't called again.
+    void cancel_stream(u32 stream_id);
+    // Stops giving the server room to send more on the stream, for when the response can't be taken in any faster. The
+    // rest of the connection isn't affected.
+    void set_stream_paused(u32 stream_id, bool);
+
+private:
+    explicit Http2Connection(NonnullRefPtr<TLS::TLSv12>);
+
+    // RFC 7540 section 6
+    enum class FrameType : u8 {
+        Data = 0x0,
+        Headers = 0x1,
+        Priority = 0x2,
+        RstStream = 0x3,
+        Settings = 0x4,
+        PushPromise = 0x5,
+        Ping = 0x6,
+        GoAway = 0x7,
+        WindowUpdate = 0x8,
+        Continuation = 0x9,
+    };
+
+    // RFC 7540 section 7
+    enum class ErrorCode : u32 {
+        NoError = 0x0,
+        ProtocolError = 0x1,
+        InternalError = 0x2,
+        FlowControlError = 0x3,
+        SettingsTimeout = 0x4,
+        StreamClosed = 0x5,
+        FrameSizeError = 0x6,
+        RefusedStream = 0x7,
+        Cancel = 0x8,
+        CompressionError = 0x9,
+    };
+
+    struct Stream {
+        StreamClient client;
+        // How much we may still send, and how much the server may still send, before a WINDOW_UPDATE.
+        i64 send_window { 0 };
+        i64 receive_window { 0 };
+        bool is_paused { false };
+        // The part of the request body that hasn't been sent yet.
+        ByteBuffer body;
+        size_t body_offset { 0 };
+    };
+
+    void did_become_readable();
+    void handle_frame(FrameType, u8 flags, u32 stream_id, ReadonlyBytes payload);
+    void handle_header_block(u32 stream_id, ReadonlyBytes, bool end_stream);
+    void handle_data(u8 flags, u32 stream_id, ReadonlyBytes payload);
+    void handle_settings(u8 flags, u32 stream_id, ReadonlyBytes payload);
+    void handle_go_away(ReadonlyBytes payload);
+    void handle_window_update(u32 stream_id, ReadonlyBytes payload);
+
+    void send_frame(FrameType, u8 flags, u32 stream_id, ReadonlyBytes payload = {});
+    void send_window_update(u32 stream_id, u32 increment);
+    void send_pending_data();
+    void flush();
+
+    void finish_stream(u32 stream_id);
+    void fail_stream(u32 stream_id, Core::NetworkJob::Error);
+    void reset_stream(u32 stream_id, ErrorCode);
+    void fail_connection(ErrorCode, StringView reason);
+    void fail_all_streams(Core::NetworkJob::Error);
+
+    NonnullRefPtr<TLS::TLSv12> m_socket;
+    ByteBuffer m_receive_buffer;
+    ByteBuffer m_send_buffer;
+
+    Hpack::Encoder m_encoder;
+    Hpack::Decoder m_decoder;
+
+    HashMap<u32, NonnullOwnPtr<Stream>> m_streams;
+    u32 m_next_stream_id { 1 };
+
+    // The server's settings, see RFC 7540 section 6.5.2. We don't know how many streams it takes until it tells us.
+    size_t m_max_concurrent_streams { NumericLimits<u32>::max() };
+    i64 m_initial_send_window { 65535 };
+    size_t m_max_frame_size { 16384 };
+
+    i64 m_send_window { 65535 };
+    i64 m_receive_window { 0 };
+
+    // A header block that continues in CONTINUATION frames, see RFC 7540 section 6.10.
+    struct PartialHeaderBlock {
+        u32 stream_id { 0 };
+        bool end_stream { false };
+        ByteBuffer block;
+    };
+    Optional<PartialHeaderBlock> m_partial_header_block;
+
+    bool m_has_received_settings { false };
+    bool m_is_going_away { false };
+    bool m_has_failed { false };
+};
+
+}
@@ -46,6 +46,7 @@ void HttpJob::start(NonnullRefPtr<Core::Socket> socket)
 
 void HttpJob::shutdown(ShutdownMode mode)
 {
+    stop_writing_output();
     if (!m_socket)
         return;
     if (mode == ShutdownMode::CloseSocket) {
@@ -58,6 +59,14 @@ void HttpJob::shutdown(ShutdownMode mode)
     }
 }
 
+void HttpJob::set_reading_paused(bool paused)
+{
+    // What the socket has buffered already is still read, but nothing more comes in from the kernel, which in turn
+    // makes TCP flow control slow the server down.
+    if (m_socket)
+        m_socket->set_idle(paused);
+}
+
 void HttpJob::register_on_ready_to_read(Function<void()> callback)
 {
     m_socket->on_ready_to_read = [callback = move(callback), this] {
@@ -39,6 +39,7 @@ protected:
     virtual bool eof() const override;
     virtual bool write(ReadonlyBytes) override;
     virtual bool is_established() const override { return true; }
+    virtual void set_reading_paused(bool) override;
 
 private:
     explicit HttpJob(HttpRequest&& request, OutputStream& output_stream)
@@ -33,11 +33,9 @@ String HttpRequest::method_name() const
     }
 }
 
-ByteBuffer HttpRequest::to_raw_request() const
+String HttpRequest::request_target() const
 {
     StringBuilder builder;
-    builder.append(method_name());
-    builder.append(' ');
     // NOTE: The percent_encode is so that e.g. spaces are properly encoded.
     auto path = m_url.path();
     VERIFY(!path.is_empty());
@@ -46,6 +44,15 @@ ByteBuffer HttpRequest::to_raw_request() const
         builder.append('?');
         builder.append(URL::percent_encode(m_url.query(), URL::PercentEncodeSet::EncodeURI));
     }
+    return builder.to_string();
+}
+
+ByteBuffer HttpRequest::to_raw_request() const
+{
+    StringBuilder builder;
+    builder.append(method_name());
+    builder.append(' ');
+    builder.append(request_target());
     builder.append(" HTTP/1.1\r\nHost: ");
     builder.append(m_url.host());
     builder.append("\r\n");
@@ -163,6 +170,8 @@ Optional<HttpRequest> HttpRequest::from_raw_request(ReadonlyBytes raw_request)
     else
         return {};
 
+    // Anything older than HTTP/1.1 is treated as HTTP/1.0, which doesn't keep connections open unless asked to.
+    request.m_version = protocol == "HTTP/1.1" ? Version::HTTP_1_1 : Version::HTTP_1_0;
     request.m_resource = URL::percent_decode(resource);
     request.m_headers = move(headers);
 
@@ -46,12 +46,21 @@ void HttpsJob::start(NonnullRefPtr<Core::Socket> socket)
     m_socket->set_idle(false);
     if (m_socket->is_established()) {
         dbgln("Reusing previous connection for {}", url());
+        // A socket that was connected ahead of time may have settled on HTTP/2 without anyone speaking it yet.
+        if (m_socket->alpn() == Http2Connection::alpn_protocol)
+            return start_on_new_http2_connection();
         deferred_invoke([this] { on_socket_connected(); });
     } else {
         dbgln("Creating a new connection for {}", url());
-        m_socket->set_root_certificates(m_override_ca_certificates ? *m_override_ca_certificates : DefaultRootCACertificates::the().certificates());
+        if (m_override_ca_certificates)
+            m_socket->set_root_certificates(*m_override_ca_certificates);
+        else
+            m_socket->set_trust_store(DefaultRootCACertificates::the().trust_store());
+        Http2Connection::offer_through_alpn(*m_socket);
         m_socket->on_tls_connected = [this] {
             dbgln_if(HTTPSJOB_DEBUG, "HttpsJob: on_connected callback");
+            if (m_socket->alpn() == Http2Connection::alpn_protocol)
+                return start_on_new_http2_connection();
             on_socket_connected();
         };
         bool success = ((TLS::TLSv12&)*m_socket).connect(m_request.url().host(), m_request.url().port_or_default());
@@ -63,8 +72,98 @@ void HttpsJob::start(NonnullRefPtr<Core::Socket> socket)
     }
 }
 
+void HttpsJob::start_on_new_http2_connection()
+{
+    dbgln_if(HTTPSJOB_DEBUG, "HttpsJob: Server picked HTTP/2 for {}", url());
+    auto connection = Http2Connection::construct(*m_socket);
+    m_socket = nullptr;
+    start_on_http2_connection(connection);
+    if (on_http2_connection_established)
+        on_http2_connection_established(*connection);
+}
+
+void HttpsJob::start_on_http2_connection(Http2Connection& connection)
+{
+    VERIFY(!m_http2_connection);
+    // The socket is kept around so whoever started us can tell which connection we ran on.
+    m_socket = connection.socket();
+    m_http2_connection = connection;
+
+    Http2Connection::StreamClient client;
+    client.on_headers = [this](auto& headers) {
+        did_receive_http2_headers(headers);
+    };
+    client.on_data = [this](ReadonlyBytes data) {
+        if (m_state != State::InBody)
+            return fail_http2_stream(Core::NetworkJob::Error::ProtocolFailed);
+        did_receive_payload(data);
+    };
+    client.on_finish = [this] {
+        m_http2_stream_id = 0;
+        if (m_state != State::InBody)
+            return fail_http2_stream(Core::NetworkJob::Error::ProtocolFailed);
+        finish_up();
+    };
+    client.on_error = [this](auto error) {
+        m_http2_stream_id = 0;
+        fail_http2_stream(error);
+    };
+    m_http2_stream_id = connection.open_stream(m_request, move(client));
+}
+
+void HttpsJob::did_receive_http2_headers(Vector<Hpack::Header> const& headers)
+{
+    // Once the response has started, all that can follow is the trailers.
+    if (m_state == State::InBody) {
+        for (auto& header : headers) {
+            if (!header.name.starts_with(':'))
+                add_response_header(header.name, header.value);
+        }
+        return;
+    }
+
+    Optional<u32> status;
+    for (auto& header : headers) {
+        if (header.name == ":status")
+            status = header.value.to_uint();
+    }
+    if (!status.has_value()) {
+        dbgln("HttpsJob: HTTP/2 response without a valid :status");
+        return fail_http2_stream(Core::NetworkJob::Error::ProtocolFailed);
+    }
+    // Informational responses are followed by the actual one, see RFC 7540 section 8.1.
+    if (status.value() >= 100 && status.value() < 200)
+        return;
+
+    m_code = status.value();
+    for (auto& header : headers) {
+        if (!header.name.starts_with(':'))
+            add_response_header(header.name, header.value);
+    }
+    did_receive_response_headers();
+}
+
+void HttpsJob::fail_http2_stream(Core::NetworkJob::Error error)
+{
+    if (m_http2_stream_id != 0) {
+        m_http2_connection->cancel_stream(m_http2_stream_id);
+        m_http2_stream_id = 0;
+    }
+    deferred_invoke([this, error] { did_fail(error); });
+}
+
 void HttpsJob::shutdown(ShutdownMode mode)
 {
+    stop_writing_output();
+    if (m_http2_connection) {
+        // Other jobs share the connection, so it isn't ours to close, whatever the mode.
+        if (m_http2_stream_id != 0)
+            m_http2_connection->cancel_stream(m_http2_stream_id);
+        m_http2_stream_id = 0;
+        m_http2_connection = nullptr;
+        m_socket = nullptr;
+        return;
+    }
     if (!m_socket)
         return;
     if (mode == ShutdownMode::CloseSocket) {
@@ -95,6 +194,18 @@ void HttpsJob::read_while_data_available(Function<IterationDecision()> read)
     }
 }
 
+void HttpsJob::set_reading_paused(bool paused)
+{
+    if (m_http2_connection) {
+        if (m_http2_stream_id != 0)
+            m_http2_connection->set_stream_paused(m_http2_stream_id, paused);
+        return;
+    }
+    // Like HttpJob, this only stops the socket from taking in more, and what TLS has decrypted already is still read.
+    if (m_socket)
+        m_socket->set_idle(paused);
+}
+
 void HttpsJob::register_on_ready_to_read(Function<void()> callback)
 {
     m_socket->on_tls_ready_to_read = [callback = move(callback)](auto&) {
@@ -8,6 +8,7 @@
 
 #include <AK/HashMap.h>
 #include <LibCore/NetworkJob.h>
+#include <LibHTTP/Http2Connection.h>
 #include <LibHTTP/HttpRequest.h>
 #include <LibHTTP/HttpResponse.h>
 #include <LibHTTP/Job.h>
@@ -26,10 +27,15 @@ public:
     virtual void shutdown(ShutdownMode) override;
     void set_certificate(String certificate, String key);
 
+    // Runs the request on a stream of an HTTP/2 connection that is already up, instead of on a socket of its own.
+    void start_on_http2_connection(Http2Connection&);
+
     Core::Socket const* socket() const { return m_socket; }
     URL url() const { return m_request.url(); }
 
     Function<void(HttpsJob&)> on_certificate_requested;
+    // Called when the server picks HTTP/2 for the socket the job was started on, so other jobs can share the connection.
+    Function<void(Http2Connection&)> on_http2_connection_established;
 
 protected:
     virtual void register_on_ready_to_read(Function<void()>) override;
@@ -43,6 +49,7 @@ protected:
     virtual bool is_established() const override { return m_socket->is_established(); }
     virtual bool should_fail_on_empty_payload() const override { return false; }
     virtual void read_while_data_available(Function<IterationDecision()>) override;
+    virtual void set_reading_paused(bool) override;
 
 private:
     explicit HttpsJob(HttpRequest&& request, OutputStream& output_stream, const Vector<Certificate>* override_certs = nullptr)
@@ -51,7 +58,14 @@ private:
     {
     }
 
+    void start_on_new_http2_connection();
+    void did_receive_http2_headers(Vector<Hpack::Header> const&);
+    void fail_http2_stream(Core::NetworkJob::Error);
+
     RefPtr<TLS::TLSv12> m_socket;
+    RefPtr<Http2Connection> m_http2_connection;
+    // Zero once the stream is gone.
+    u32 m_http2_stream_id { 0 };
     const Vector<Certificate>* m_override_ca_certificates { nullptr };
 };
 
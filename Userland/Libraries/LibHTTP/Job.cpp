@@ -10,6 +10,7 @@
 #include <LibCompress/Zlib.h>
 #include <LibCore/Event.h>
 #include <LibCore/TCPSocket.h>
+#include <LibHTTP/ContentDecoder.h>
 #include <LibHTTP/HttpResponse.h>
 #include <LibHTTP/Job.h>
 #include <stdio.h>
@@ -17,6 +18,9 @@
 
 namespace HTTP {
 
+// When this much of the response is waiting for the output to catch up, we stop reading until half of it is gone.
+static constexpr size_t max_buffered_size_while_reading = 1 * MiB;
+
 static Optional<ByteBuffer> handle_content_encoding(const ByteBuffer& buf, const String& content_encoding)
 {
     dbgln_if(JOB_DEBUG, "Job::handle_content_encoding: buf has content_encoding={}", content_encoding);
@@ -89,7 +93,7 @@ void Job::flush_received_buffers()
     dbgln_if(JOB_DEBUG, "Job: Flushing received buffers: have {} bytes in {} buffers for {}", m_buffered_size, m_received_buffers.size(), m_request.url());
     for (size_t i = 0; i < m_received_buffers.size(); ++i) {
         auto& payload = m_received_buffers[i];
-        auto written = do_write(payload);
+        auto written = write_to_output(payload);
         m_buffered_size -= written;
         if (written == payload.size()) {
             // FIXME: Make this a take-first-friendly object?
@@ -102,6 +106,114 @@ void Job::flush_received_buffers()
         break;
     }
     dbgln_if(JOB_DEBUG, "Job: Flushing received buffers done: have {} bytes in {} buffers for {}", m_buffered_size, m_received_buffers.size(), m_request.url());
+
+    if (m_output_fd < 0)
+        return;
+    if (m_buffered_size != 0)
+        wait_for_room_in_output();
+    if (!m_is_reading_paused && m_buffered_size >= max_buffered_size_while_reading) {
+        dbgln_if(JOB_DEBUG, "Job: Output is falling behind with {} bytes buffered, pausing {}", m_buffered_size, m_request.url());
+        m_is_reading_paused = true;
+        set_reading_paused(true);
+    } else if (m_is_reading_paused && m_buffered_size < max_buffered_size_while_reading / 2) {
+        dbgln_if(JOB_DEBUG, "Job: Output caught up, resuming {}", m_request.url());
+        m_is_reading_paused = false;
+        set_reading_paused(false);
+    }
+}
+
+size_t Job::write_to_output(ReadonlyBytes bytes)
+{
+    if (m_content_decoder)
+        return m_content_decoder->write(bytes);
+    return do_write(bytes);
+}
+
+void Job::wait_for_room_in_output()
+{
+    int fd = m_content_decoder ? m_content_decoder->input_fd() : m_output_fd;
+    if (!m_output_notifier || m_output_notifier->fd() != fd) {
+        m_output_notifier = Core::Notifier::construct(fd, Core::Notifier::Write);
+        m_output_notifier->on_ready_to_write = [this] { did_get_room_in_output(); };
+    }
+    m_output_notifier->set_enabled(true);
+}
+
+void Job::did_get_room_in_output()
+{
+    m_output_notifier->set_enabled(false);
+    if (m_state == State::Finished) {
+        if (!m_has_scheduled_finish)
+            finish_up();
+        return;
+    }
+    flush_received_buffers();
+}
+
+void Job::stop_writing_output()
+{
+    m_output_notifier = nullptr;
+    m_content_decoder = nullptr;
+}
+
+void Job::add_response_header(String const& name, String value)
+{
+    if (name.equals_ignoring_case("Set-Cookie")) {
+        dbgln_if(JOB_DEBUG, "Job: Received Set-Cookie header: '{}'", value);
+        m_set_cookie_headers.append(move(value));
+        return;
+    }
+    if (auto existing_value = m_headers.get(name); existing_value.has_value()) {
+        StringBuilder builder;
+        builder.append(existing_value.value());
+        builder.append(',');
+        builder.append(value);
+        m_headers.set(name, builder.build());
+    } else {
+        m_headers.set(name, value);
+    }
+    if (name.equals_ignoring_case("Content-Length")) {
+        auto length = value.to_uint();
+        if (length.has_value())
+            m_content_length = length.value();
+    }
+    dbgln_if(JOB_DEBUG, "Job: [{}] = '{}'", name, value);
+}
+
+void Job::did_receive_response_headers()
+{
+    if (auto content_encoding = m_headers.get("Content-Encoding"sv); content_encoding.has_value()) {
+        auto encoding = content_encoding.value().trim_whitespace();
+        if (m_output_fd >= 0 && ContentDecoder::is_supported(encoding)) {
+            auto decoder_or_error = ContentDecoder::try_create(encoding, output_stream(), m_output_fd);
+            if (decoder_or_error.is_error())
+                dbgln("Job: Failed to create a decoder for Content-Encoding {}: {}", encoding, decoder_or_error.error());
+            else
+                m_content_decoder = decoder_or_error.release_value();
+        }
+        if (!m_content_decoder) {
+            // Without a decoder running alongside, the whole body has to be in before it can be decoded.
+            dbgln_if(JOB_DEBUG, "Content-Encoding {} detected, cannot stream output :(", encoding);
+            m_can_stream_response = false;
+        }
+    }
+
+    if (on_headers_received) {
+        if (!m_set_cookie_headers.is_empty())
+            m_headers.set("Set-Cookie", JsonArray { m_set_cookie_headers }.to_string());
+        on_headers_received(m_headers, m_code > 0 ? m_code : Optional<u32> {});
+    }
+    m_state = State::InBody;
+}
+
+void Job::did_receive_payload(ReadonlyBytes payload)
+{
+    m_received_buffers.append(ByteBuffer::copy(payload).release_value()); // FIXME: Handle possible OOM situation.
+    m_buffered_size += payload.size();
+    m_received_size += payload.size();
+    flush_received_buffers();
+
+    deferred_invoke([this] { did_progress(m_content_length, m_received_size); });
 }
 
 void Job::on_socket_connected()
@@ -177,16 +289,9 @@ void Job::on_socket_connected()
                 return did_fail(Core::NetworkJob::Error::ProtocolFailed);
             }
             if (line.is_empty()) {
-                if (m_state == State::Trailers) {
+                if (m_state == State::Trailers)
                     return finish_up();
-                } else {
-                    if (on_headers_received) {
-                        if (!m_set_cookie_headers.is_empty())
-                            m_headers.set("Set-Cookie", JsonArray { m_set_cookie_headers }.to_string());
-                        on_headers_received(m_headers, m_code > 0 ? m_code : Optional<u32> {});
-                    }
-                    m_state = State::InBody;
-                }
+                did_receive_response_headers();
 
                 // We've reached the end of the headers, there's a possibility that the server
                 // responds with nothing (content-length = 0 with normal encoding); if that's the case,
@@ -220,30 +325,7 @@ void Job::on_socket_connected()
                 return deferred_invoke([this] { did_fail(Core::NetworkJob::Error::ProtocolFailed); });
             }
             auto value = line.substring(name.length() + 2, line.length() - name.length() - 2);
-            if (name.equals_ignoring_case("Set-Cookie")) {
-                dbgln_if(JOB_DEBUG, "Job: Received Set-Cookie header: '{}'", value);
-                m_set_cookie_headers.append(move(value));
-                return;
-            }
-            if (auto existing_value = m_headers.get(name); existing_value.has_value()) {
-                StringBuilder builder;
-                builder.append(existing_value.value());
-                builder.append(',');
-                builder.append(value);
-                m_headers.set(name, builder.build());
-            } else {
-                m_headers.set(name, value);
-            }
-            if (name.equals_ignoring_case("Content-Encoding")) {
-                // Assume that any content-encoding means that we can't decode it as a stream :(
-                dbgln_if(JOB_DEBUG, "Content-Encoding {} detected, cannot stream output :(", value);
-                m_can_stream_response = false;
-            } else if (name.equals_ignoring_case("Content-Length")) {
-                auto length = value.to_uint();
-                if (length.has_value())
-                    m_content_length = length.value();
-            }
-            dbgln_if(JOB_DEBUG, "Job: [{}] = '{}'", name, value);
+            add_response_header(name, move(value));
             return;
         }
         VERIFY(m_state == State::InBody);
@@ -347,12 +429,7 @@ void Job::on_socket_connected()
                 }
             }
 
-            m_received_buffers.append(payload);
-            m_buffered_size += payload.size();
-            m_received_size += payload.size();
-            flush_received_buffers();
-
-            deferred_invoke([this] { did_progress(m_content_length, m_received_size); });
+            did_receive_payload(payload);
 
             if (read_everything) {
                 VERIFY(m_received_size <= m_content_length.value());
@@ -415,8 +492,7 @@ void Job::finish_up()
         }
         m_received_buffers.clear();
 
-        // For the time being, we cannot stream stuff with content-encoding set to _anything_.
-        // FIXME: LibCompress exposes a streaming interface, so this can be resolved
+        // Without an output fd to stream into, the content encoding is only dealt with once everything is in.
         auto content_encoding = m_headers.get("Content-Encoding");
         if (content_encoding.has_value()) {
             if (auto result = handle_content_encoding(flattened_buffer, content_encoding.value()); result.has_value())
@@ -431,6 +507,11 @@ void Job::finish_up()
     }
 
     flush_received_buffers();
+    if (m_buffered_size != 0 && m_output_fd >= 0) {
+        // flush_received_buffers() is waiting for the output to drain, and we're called again once it has.
+        dbgln_if(JOB_DEBUG, "Flush finished with {} bytes remaining, waiting for the output", m_buffered_size);
+        return;
+    }
     if (m_buffered_size != 0) {
         // We have to wait for the client to consume all the downloaded data
         // before we can actually call `did_finish`. in a normal flow, this should
@@ -442,6 +523,24 @@ void Job::finish_up()
         return;
     }
 
+    if (m_content_decoder) {
+        // The decoder may still be working through the end of the body, and on_finish tells us when it's done.
+        if (m_content_decoder->input_fd() < 0)
+            return;
+        m_output_notifier = nullptr;
+        m_content_decoder->on_finish = [this](bool success) {
+            // The decoder can't be destroyed from its own callback.
+            deferred_invoke([this, success] {
+                m_content_decoder = nullptr;
+                if (!success)
+                    return did_fail(Core::NetworkJob::Error::TransmissionFailed);
+                finish_up();
+            });
+        };
+        m_content_decoder->finish_input();
+        return;
+    }
+
     m_has_scheduled_finish = true;
     auto response = HttpResponse::create(m_code, move(m_headers));
     deferred_invoke([this, response = move(response)] {
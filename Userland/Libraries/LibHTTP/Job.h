@@ -9,8 +9,11 @@
 #include <AK/FileStream.h>
 #include <AK/HashMap.h>
 #include <AK/Optional.h>
+#include <AK/OwnPtr.h>
 #include <LibCore/NetworkJob.h>
+#include <LibCore/Notifier.h>
 #include <LibCore/TCPSocket.h>
+#include <LibHTTP/ContentDecoder.h>
 #include <LibHTTP/HttpRequest.h>
 #include <LibHTTP/HttpResponse.h>
 
@@ -27,10 +30,24 @@ public:
     HttpResponse* response() { return static_cast<HttpResponse*>(Core::NetworkJob::response()); }
     const HttpResponse* response() const { return static_cast<const HttpResponse*>(Core::NetworkJob::response()); }
 
+    // Tells the job that the output stream writes to this (non-blocking) file descriptor. The response body is then
+    // streamed into it as fast as it's read on the other end: when it falls behind, the job stops reading from the
+    // network until there's room again, and content encodings are decoded while the body is still coming in.
+    void set_output_fd(int fd) { m_output_fd = fd; }
+
 protected:
     void finish_up();
     void on_socket_connected();
     void flush_received_buffers();
+    // Shared between the HTTP/1.1 parser in on_socket_connected() and the HTTP/2 streams of HttpsJob.
+    void add_response_header(String const& name, String value);
+    void did_receive_response_headers();
+    void did_receive_payload(ReadonlyBytes);
+    // Stops the output from being written to, when the job is shut down.
+    void stop_writing_output();
+    // Called when the job wants to take in more (or no more) of the response from the network for now. Whatever was
+    // already read may still be handed over while paused.
+    virtual void set_reading_paused(bool) { }
     virtual void register_on_ready_to_read(Function<void()>) = 0;
     virtual void register_on_ready_to_write(Function<void()>) = 0;
     virtual bool can_read_line() const = 0;
@@ -67,6 +84,17 @@ protected:
     bool m_can_stream_response { true };
     bool m_should_read_chunk_ending_line { false };
     bool m_has_scheduled_finish { false };
+
+private:
+    size_t write_to_output(ReadonlyBytes);
+    void wait_for_room_in_output();
+    void did_get_room_in_output();
+
+    int m_output_fd { -1 };
+    // Watches the output fd, or the content decoder's input, while the received buffers can't be flushed.
+    RefPtr<Core::Notifier> m_output_notifier;
+    OwnPtr<ContentDecoder> m_content_decoder;
+    bool m_is_reading_paused { false };
 };
 
 }
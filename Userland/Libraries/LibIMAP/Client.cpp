@@ -15,7 +15,7 @@ Client::Client(StringView host, unsigned int port, bool start_with_tls)
 {
     if (start_with_tls) {
         m_tls_socket = TLS::TLSv12::construct(nullptr);
-        m_tls_socket->set_root_certificates(DefaultRootCACertificates::the().certificates());
+        m_tls_socket->set_trust_store(DefaultRootCACertificates::the().trust_store());
     } else {
         m_socket = Core::TCPSocket::construct();
     }
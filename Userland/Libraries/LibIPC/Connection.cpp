@@ -4,6 +4,8 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/ScopeGuard.h>
+#include <AK/TemporaryChange.h>
 #include <LibCore/System.h>
 #include <LibIPC/Connection.h>
 #include <LibIPC/Stub.h>
@@ -26,19 +28,41 @@ ConnectionBase::~ConnectionBase()
 
 ErrorOr<void> ConnectionBase::post_message(Message const& message)
 {
-    return post_message(message.encode());
+    // Messages are posted from within message handlers all the time, but if the send buffer
+    // is already in use further up the stack, fall back to a temporary one.
+    if (m_send_buffer_in_use) {
+        auto buffer = message.encode();
+        return post_message(buffer);
+    }
+
+    // Encode every message into the same buffer, leaving room for the size in front, so that
+    // steady traffic neither allocates nor has to move the encoded message around.
+    TemporaryChange in_use_change { m_send_buffer_in_use, true };
+    ScopeGuard release_file_descriptors = [&] { m_send_buffer.fds.clear(); };
+    m_send_buffer.data.clear_with_capacity();
+    m_send_buffer.data.resize_and_keep_capacity(sizeof(u32));
+    message.encode_into(m_send_buffer);
+    return post_framed_message(m_send_buffer);
 }
 
-ErrorOr<void> ConnectionBase::post_message(MessageBuffer buffer)
+ErrorOr<void> ConnectionBase::post_message(MessageBuffer& buffer)
+{
+    // Make room for the message size.
+    uint32_t message_size = 0;
+    TRY(buffer.data.try_prepend(reinterpret_cast<const u8*>(&message_size), sizeof(message_size)));
+    return post_framed_message(buffer);
+}
+
+ErrorOr<void> ConnectionBase::post_framed_message(MessageBuffer& buffer)
 {
     // NOTE: If this connection is being shut down, but has not yet been destroyed,
     //       the socket will be closed. Don't try to send more messages.
     if (!m_socket->is_open())
         return Error::from_string_literal("Trying to post_message during IPC shutdown"sv);
 
-    // Prepend the message size.
-    uint32_t message_size = buffer.data.size();
-    TRY(buffer.data.try_prepend(reinterpret_cast<const u8*>(&message_size), sizeof(message_size)));
+    VERIFY(buffer.data.size() >= sizeof(u32));
+    uint32_t message_size = buffer.data.size() - sizeof(message_size);
+    memcpy(buffer.data.data(), &message_size, sizeof(message_size));
 
 #ifdef __serenity__
     for (auto& fd : buffer.fds) {
@@ -53,9 +77,20 @@ ErrorOr<void> ConnectionBase::post_message(MessageBuffer buffer)
         warnln("fd passing is not supported on this platform, sorry :(");
 #endif
 
+    if (m_outgoing_ring.has_value())
+        TRY(post_message_through_shared_ring(buffer.data));
+    else
+        TRY(write_to_socket(buffer.data));
+
+    m_responsiveness_timer->start();
+    return {};
+}
+
+ErrorOr<void> ConnectionBase::write_to_socket(ReadonlyBytes bytes)
+{
     size_t total_nwritten = 0;
-    while (total_nwritten < buffer.data.size()) {
-        auto nwritten = write(m_socket->fd(), buffer.data.data() + total_nwritten, buffer.data.size() - total_nwritten);
+    while (total_nwritten < bytes.size()) {
+        auto nwritten = write(m_socket->fd(), bytes.data() + total_nwritten, bytes.size() - total_nwritten);
         if (nwritten < 0) {
             switch (errno) {
             case EPIPE:
@@ -71,9 +106,58 @@ ErrorOr<void> ConnectionBase::post_message(MessageBuffer buffer)
         }
         total_nwritten += nwritten;
     }
+    return {};
+}
 
-    m_responsiveness_timer->start();
+ErrorOr<void> ConnectionBase::write_marker_to_socket(FrameMarker marker)
+{
+    auto value = to_underlying(marker);
+    return write_to_socket({ &value, sizeof(value) });
+}
+
+ErrorOr<void> ConnectionBase::enable_shared_ring_transport(size_t capacity)
+{
+#ifdef __serenity__
+    VERIFY(!m_outgoing_ring.has_value());
+    auto ring = TRY(SharedRingBuffer::create(capacity));
+    TRY(Core::System::sendfd(m_socket->fd(), ring.fd()));
+
+    u32 handoff[2] = { to_underlying(FrameMarker::SharedRingHandoff), static_cast<u32>(ring.size()) };
+    TRY(write_to_socket({ handoff, sizeof(handoff) }));
+    m_outgoing_ring = move(ring);
     return {};
+#else
+    (void)capacity;
+    return Error::from_string_literal("IPC::Connection: Shared ring transport needs fd passing"sv);
+#endif
+}
+
+ErrorOr<void> ConnectionBase::post_message_through_shared_ring(ReadonlyBytes frame)
+{
+    auto& ring = *m_outgoing_ring;
+    // We always keep room for a ContinueOnSocket marker, so that we can fall back to the socket
+    // when the peer is falling behind or a message doesn't fit into the ring at all.
+    constexpr size_t marker_size = sizeof(u32);
+
+    if (m_outgoing_on_socket && ring.has_room_for(frame.size(), marker_size)) {
+        TRY(write_marker_to_socket(FrameMarker::ContinueInRing));
+        m_outgoing_on_socket = false;
+    }
+
+    if (!m_outgoing_on_socket) {
+        bool did_write = ring.try_write(frame, marker_size);
+        if (!did_write) {
+            auto marker = to_underlying(FrameMarker::ContinueOnSocket);
+            VERIFY(ring.try_write({ &marker, sizeof(marker) }));
+            m_outgoing_on_socket = true;
+        }
+        if (ring.take_doorbell_request())
+            TRY(write_marker_to_socket(FrameMarker::Doorbell));
+        if (did_write)
+            return {};
+    }
+
+    return write_to_socket(frame);
 }
 
 void ConnectionBase::shutdown()
@@ -116,18 +200,15 @@ void ConnectionBase::wait_for_socket_to_become_readable()
     }
 }
 
-ErrorOr<Vector<u8>> ConnectionBase::read_as_much_as_possible_from_socket_without_blocking()
+ErrorOr<void> ConnectionBase::read_as_much_as_possible_from_socket_without_blocking()
 {
-    Vector<u8> bytes;
-
-    if (!m_unprocessed_bytes.is_empty()) {
-        bytes.append(m_unprocessed_bytes.data(), m_unprocessed_bytes.size());
-        m_unprocessed_bytes.clear();
-    }
-
+    // m_receive_buffer may still start with a partial message from last time.
     while (m_socket->is_open()) {
-        u8 buffer[4096];
-        ssize_t nread = recv(m_socket->fd(), buffer, sizeof(buffer), MSG_DONTWAIT);
+        constexpr size_t read_size = 4096;
+        size_t size_before_read = m_receive_buffer.size();
+        TRY(m_receive_buffer.try_resize_and_keep_capacity(size_before_read + read_size));
+        ssize_t nread = recv(m_socket->fd(), m_receive_buffer.data() + size_before_read, read_size, MSG_DONTWAIT);
+        m_receive_buffer.shrink(size_before_read + max<ssize_t>(nread, 0), true);
         if (nread < 0) {
             if (errno == EAGAIN)
                 break;
@@ -135,44 +216,147 @@ ErrorOr<Vector<u8>> ConnectionBase::read_as_much_as_possible_from_socket_without
             exit(1);
         }
         if (nread == 0) {
-            if (bytes.is_empty()) {
+            if (m_receive_buffer.is_empty()) {
                 deferred_invoke([this] { shutdown(); });
                 return Error::from_string_literal("IPC connection EOF"sv);
             }
             break;
         }
-        bytes.append(buffer, nread);
     }
 
-    if (!bytes.is_empty()) {
+    if (!m_receive_buffer.is_empty()) {
         m_responsiveness_timer->stop();
         did_become_responsive();
     }
 
-    return bytes;
+    return {};
+}
+
+void ConnectionBase::try_parse_messages(Vector<u8> const& bytes, size_t& index)
+{
+    u32 message_size = 0;
+    for (; index + sizeof(message_size) < bytes.size(); index += message_size) {
+        memcpy(&message_size, bytes.data() + index, sizeof(message_size));
+        if (message_size == to_underlying(FrameMarker::SharedRingHandoff)) {
+            u32 ring_size = 0;
+            if (bytes.size() - index - sizeof(message_size) < sizeof(ring_size))
+                break;
+            memcpy(&ring_size, bytes.data() + index + sizeof(message_size), sizeof(ring_size));
+            index += sizeof(message_size) + sizeof(ring_size);
+            if (auto result = adopt_incoming_shared_ring(ring_size); result.is_error()) {
+                dbgln("IPC::ConnectionBase: Failed to adopt shared ring: {}", result.error());
+                shutdown();
+            }
+            // Everything after this has to be sequenced against the frames in the ring.
+            return;
+        }
+        if (message_size == 0 || bytes.size() - index - sizeof(uint32_t) < message_size)
+            break;
+        index += sizeof(message_size);
+        if (!try_parse_message({ bytes.data() + index, message_size }))
+            break;
+    }
+}
+
+ErrorOr<void> ConnectionBase::adopt_incoming_shared_ring(u32 size)
+{
+#ifdef __serenity__
+    int fd = TRY(Core::System::recvfd(m_socket->fd(), O_CLOEXEC));
+    auto ring = SharedRingBuffer::create_from_anon_fd(fd, size);
+    if (ring.is_error()) {
+        close(fd);
+        return ring.release_error();
+    }
+    m_incoming_ring = ring.release_value();
+    return {};
+#else
+    (void)size;
+    return Error::from_string_literal("IPC::Connection: Shared ring transport needs fd passing"sv);
+#endif
+}
+
+ErrorOr<void> ConnectionBase::drain_messages_from_shared_ring(Vector<u8> const& socket_bytes, size_t& index)
+{
+    auto& ring = *m_incoming_ring;
+    auto peek_socket_frame_size = [&]() -> Optional<u32> {
+        if (socket_bytes.size() - index < sizeof(u32))
+            return {};
+        u32 size = 0;
+        memcpy(&size, socket_bytes.data() + index, sizeof(size));
+        return size;
+    };
+
+    for (;;) {
+        if (m_incoming_on_socket) {
+            auto message_size = peek_socket_frame_size();
+            if (!message_size.has_value())
+                return {};
+            if (*message_size == to_underlying(FrameMarker::Doorbell)) {
+                index += sizeof(u32);
+                continue;
+            }
+            if (*message_size == to_underlying(FrameMarker::ContinueInRing)) {
+                index += sizeof(u32);
+                m_incoming_on_socket = false;
+                continue;
+            }
+            if (*message_size >= first_frame_marker)
+                return Error::from_string_literal("IPC::Connection: Unexpected frame marker on socket"sv);
+            if (socket_bytes.size() - index - sizeof(u32) < *message_size)
+                return {};
+            index += sizeof(u32);
+            if (!try_parse_message({ socket_bytes.data() + index, *message_size }))
+                return Error::from_string_literal("IPC::Connection: Failed to parse a message"sv);
+            index += *message_size;
+            continue;
+        }
+
+        // While we're reading from the ring, the socket only carries doorbells, which we're answering right now.
+        while (peek_socket_frame_size() == to_underlying(FrameMarker::Doorbell))
+            index += sizeof(u32);
+
+        auto frame = TRY(ring.peek(m_ring_scratch_buffer));
+        if (!frame.has_value()) {
+            ring.request_doorbell();
+            // The peer may have written something just before seeing our request.
+            if (ring.is_empty())
+                return {};
+            continue;
+        }
+        // The frame's payload is decoded in place, so only let the writer reuse its space afterwards.
+        ScopeGuard consume_frame = [&] { ring.consume(*frame); };
+        if (frame->size_field == to_underlying(FrameMarker::ContinueOnSocket)) {
+            m_incoming_on_socket = true;
+            continue;
+        }
+        if (frame->size_field >= first_frame_marker)
+            return Error::from_string_literal("IPC::Connection: Unexpected frame marker in shared ring"sv);
+        if (!try_parse_message(frame->payload))
+            return Error::from_string_literal("IPC::Connection: Failed to parse a message"sv);
+    }
 }
 
 ErrorOr<void> ConnectionBase::drain_messages_from_peer()
 {
-    auto bytes = TRY(read_as_much_as_possible_from_socket_without_blocking());
+    TRY(read_as_much_as_possible_from_socket_without_blocking());
 
+    // Messages are decoded straight out of the receive buffer (or the shared ring), which
+    // keeps its capacity from one drain to the next.
+    auto& bytes = m_receive_buffer;
     size_t index = 0;
-    try_parse_messages(bytes, index);
-
-    if (index < bytes.size()) {
-        // Sometimes we might receive a partial message. That's okay, just stash away
-        // the unprocessed bytes and we'll prepend them to the next incoming message
-        // in the next run of this function.
-        auto maybe_remaining_bytes = ByteBuffer::copy(bytes.span().slice(index));
-        if (!maybe_remaining_bytes.has_value())
-            return Error::from_string_literal("drain_messages_from_peer: Failed to allocate buffer"sv);
-        if (!m_unprocessed_bytes.is_empty()) {
+    if (!m_incoming_ring.has_value())
+        try_parse_messages(bytes, index);
+    if (m_incoming_ring.has_value()) {
+        if (auto result = drain_messages_from_shared_ring(bytes, index); result.is_error()) {
             shutdown();
-            return Error::from_string_literal("drain_messages_from_peer: Already have unprocessed bytes"sv);
+            return result;
         }
-        m_unprocessed_bytes = maybe_remaining_bytes.release_value();
     }
 
+    // Sometimes we might receive a partial message. That's okay, just keep the
+    // unprocessed bytes at the front of the buffer for the next run of this function.
+    bytes.remove(0, index);
+
     if (!m_unprocessed_messages.is_empty()) {
         deferred_invoke([this] {
             handle_messages();
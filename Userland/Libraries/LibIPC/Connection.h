@@ -16,6 +16,7 @@
 #include <LibCore/Timer.h>
 #include <LibIPC/Forward.h>
 #include <LibIPC/Message.h>
+#include <LibIPC/SharedRingBuffer.h>
 #include <errno.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -35,6 +36,10 @@ public:
     bool is_open() const { return m_socket->is_open(); }
     ErrorOr<void> post_message(Message const&);
 
+    // From now on, send messages to the peer through a ring in shared memory and only use the
+    // socket to wake it up when it is waiting. Meant for endpoints that send many small messages.
+    ErrorOr<void> enable_shared_ring_transport(size_t capacity = SharedRingBuffer::default_capacity);
+
     void shutdown();
     virtual void die() { }
 
@@ -45,14 +50,21 @@ protected:
 
     virtual void may_have_become_unresponsive() { }
     virtual void did_become_responsive() { }
-    virtual void try_parse_messages(Vector<u8> const& bytes, size_t& index) = 0;
+    virtual bool try_parse_message(ReadonlyBytes) = 0;
+    void try_parse_messages(Vector<u8> const& bytes, size_t& index);
+    ErrorOr<void> drain_messages_from_shared_ring(Vector<u8> const& socket_bytes, size_t& index);
+    ErrorOr<void> adopt_incoming_shared_ring(u32 size);
 
     OwnPtr<IPC::Message> wait_for_specific_endpoint_message_impl(u32 endpoint_magic, int message_id);
     void wait_for_socket_to_become_readable();
-    ErrorOr<Vector<u8>> read_as_much_as_possible_from_socket_without_blocking();
+    ErrorOr<void> read_as_much_as_possible_from_socket_without_blocking();
     ErrorOr<void> drain_messages_from_peer();
 
-    ErrorOr<void> post_message(MessageBuffer);
+    ErrorOr<void> post_message(MessageBuffer&);
+    ErrorOr<void> post_framed_message(MessageBuffer&);
+    ErrorOr<void> post_message_through_shared_ring(ReadonlyBytes);
+    ErrorOr<void> write_to_socket(ReadonlyBytes);
+    ErrorOr<void> write_marker_to_socket(FrameMarker);
     void handle_messages();
 
     IPC::Stub& m_local_stub;
@@ -62,9 +74,18 @@ protected:
 
     RefPtr<Core::Notifier> m_notifier;
     NonnullOwnPtrVector<Message> m_unprocessed_messages;
-    ByteBuffer m_unprocessed_bytes;
+    Vector<u8> m_receive_buffer;
+    Vector<u8> m_ring_scratch_buffer;
+
+    MessageBuffer m_send_buffer;
+    bool m_send_buffer_in_use { false };
 
     u32 m_local_endpoint_magic { 0 };
+
+    Optional<SharedRingBuffer> m_outgoing_ring;
+    bool m_outgoing_on_socket { false };
+    Optional<SharedRingBuffer> m_incoming_ring;
+    bool m_incoming_on_socket { false };
 };
 
 template<typename LocalEndpoint, typename PeerEndpoint>
@@ -113,24 +134,18 @@ protected:
         return {};
     }
 
-    virtual void try_parse_messages(Vector<u8> const& bytes, size_t& index) override
+    virtual bool try_parse_message(ReadonlyBytes bytes) override
     {
-        u32 message_size = 0;
-        for (; index + sizeof(message_size) < bytes.size(); index += message_size) {
-            memcpy(&message_size, bytes.data() + index, sizeof(message_size));
-            if (message_size == 0 || bytes.size() - index - sizeof(uint32_t) < message_size)
-                break;
-            index += sizeof(message_size);
-            auto remaining_bytes = ReadonlyBytes { bytes.data() + index, message_size };
-            if (auto message = LocalEndpoint::decode_message(remaining_bytes, m_socket->fd())) {
-                m_unprocessed_messages.append(message.release_nonnull());
-            } else if (auto message = PeerEndpoint::decode_message(remaining_bytes, m_socket->fd())) {
-                m_unprocessed_messages.append(message.release_nonnull());
-            } else {
-                dbgln("Failed to parse a message");
-                break;
-            }
+        if (auto message = LocalEndpoint::decode_message(bytes, m_socket->fd())) {
+            m_unprocessed_messages.append(message.release_nonnull());
+            return true;
+        }
+        if (auto message = PeerEndpoint::decode_message(bytes, m_socket->fd())) {
+            m_unprocessed_messages.append(message.release_nonnull());
+            return true;
         }
+        dbgln("Failed to parse a message");
+        return false;
     }
 };
 
@@ -16,4 +16,11 @@ Message::~Message()
 {
 }
 
+MessageBuffer Message::encode() const
+{
+    MessageBuffer buffer;
+    encode_into(buffer);
+    return buffer;
+}
+
 }
@@ -49,7 +49,9 @@ public:
     virtual int message_id() const = 0;
     virtual const char* message_name() const = 0;
     virtual bool valid() const = 0;
-    virtual MessageBuffer encode() const = 0;
+    MessageBuffer encode() const;
+    // Appends the message to the given buffer, which may already hold data.
+    virtual void encode_into(MessageBuffer&) const = 0;
 
 protected:
     Message();
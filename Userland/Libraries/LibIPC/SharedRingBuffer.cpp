@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Atomic.h>
+#include <LibIPC/SharedRingBuffer.h>
+
+namespace IPC {
+
+// The offsets only ever grow and wrap around at 2^32, so the capacity has to be a power of two.
+static bool is_valid_capacity(size_t capacity)
+{
+    return capacity >= sizeof(u32) && capacity <= NumericLimits<u32>::max() / 2 && (capacity & (capacity - 1)) == 0;
+}
+
+ErrorOr<SharedRingBuffer> SharedRingBuffer::create(size_t capacity)
+{
+    VERIFY(is_valid_capacity(capacity));
+    auto buffer = TRY(Core::AnonymousBuffer::create_with_size(sizeof(Header) + capacity));
+    SharedRingBuffer ring { move(buffer) };
+    // The reader hasn't seen the ring yet, so the first frame must always ring the doorbell.
+    ring.header()->reader_wants_doorbell = 1;
+    return ring;
+}
+
+ErrorOr<SharedRingBuffer> SharedRingBuffer::create_from_anon_fd(int fd, size_t size)
+{
+    if (size <= sizeof(Header) || !is_valid_capacity(size - sizeof(Header)))
+        return Error::from_string_literal("SharedRingBuffer: Invalid size"sv);
+    auto buffer = TRY(Core::AnonymousBuffer::create_from_anon_fd(fd, size));
+    return SharedRingBuffer { move(buffer) };
+}
+
+SharedRingBuffer::SharedRingBuffer(Core::AnonymousBuffer buffer)
+    : m_buffer(move(buffer))
+    , m_capacity(m_buffer.size() - sizeof(Header))
+{
+}
+
+void SharedRingBuffer::copy_in(u32 offset, ReadonlyBytes bytes)
+{
+    size_t start = offset & (m_capacity - 1);
+    size_t first_part = min(bytes.size(), m_capacity - start);
+    memcpy(data() + start, bytes.data(), first_part);
+    memcpy(data(), bytes.data() + first_part, bytes.size() - first_part);
+}
+
+void SharedRingBuffer::copy_out(u32 offset, Bytes bytes)
+{
+    size_t start = offset & (m_capacity - 1);
+    size_t first_part = min(bytes.size(), m_capacity - start);
+    memcpy(bytes.data(), data() + start, first_part);
+    memcpy(bytes.data() + first_part, data(), bytes.size() - first_part);
+}
+
+bool SharedRingBuffer::has_room_for(size_t frame_size, size_t reserve) const
+{
+    u32 write_offset = header()->write_offset;
+    u32 read_offset = AK::atomic_load(&header()->read_offset, AK::memory_order_acquire);
+    size_t used = write_offset - read_offset;
+    return used + frame_size + reserve <= m_capacity;
+}
+
+bool SharedRingBuffer::try_write(ReadonlyBytes frame, size_t reserve)
+{
+    if (!has_room_for(frame.size(), reserve))
+        return false;
+    u32 write_offset = header()->write_offset;
+    copy_in(write_offset, frame);
+    // This has to be ordered before we look at the doorbell request, hence seq_cst.
+    AK::atomic_store(&header()->write_offset, static_cast<u32>(write_offset + frame.size()));
+    return true;
+}
+
+bool SharedRingBuffer::take_doorbell_request()
+{
+    return AK::atomic_exchange(&header()->reader_wants_doorbell, 0u) != 0;
+}
+
+void SharedRingBuffer::request_doorbell()
+{
+    AK::atomic_store(&header()->reader_wants_doorbell, 1u);
+}
+
+bool SharedRingBuffer::is_empty() const
+{
+    return AK::atomic_load(&header()->write_offset) == header()->read_offset;
+}
+
+ErrorOr<Optional<SharedRingBuffer::Frame>> SharedRingBuffer::peek(Vector<u8>& scratch_buffer)
+{
+    u32 read_offset = header()->read_offset;
+    u32 write_offset = AK::atomic_load(&header()->write_offset, AK::memory_order_acquire);
+    size_t available = write_offset - read_offset;
+    if (available == 0)
+        return Optional<Frame> {};
+    if (available < sizeof(u32) || available > m_capacity)
+        return Error::from_string_literal("SharedRingBuffer: Corrupted offsets"sv);
+
+    Frame frame;
+    copy_out(read_offset, { &frame.size_field, sizeof(frame.size_field) });
+    size_t payload_size = frame.size_field >= first_frame_marker ? 0 : frame.size_field;
+    if (payload_size > available - sizeof(u32))
+        return Error::from_string_literal("SharedRingBuffer: Frame larger than the written data"sv);
+
+    size_t payload_start = (read_offset + sizeof(u32)) & (m_capacity - 1);
+    if (payload_start + payload_size <= m_capacity) {
+        frame.payload = { data() + payload_start, payload_size };
+    } else {
+        TRY(scratch_buffer.try_resize_and_keep_capacity(payload_size));
+        copy_out(read_offset + sizeof(u32), scratch_buffer.span());
+        frame.payload = scratch_buffer.span();
+    }
+    return frame;
+}
+
+void SharedRingBuffer::consume(Frame const& frame)
+{
+    size_t payload_size = frame.size_field >= first_frame_marker ? 0 : frame.size_field;
+    u32 read_offset = header()->read_offset;
+    AK::atomic_store(&header()->read_offset, static_cast<u32>(read_offset + sizeof(u32) + payload_size), AK::memory_order_release);
+}
+
+}
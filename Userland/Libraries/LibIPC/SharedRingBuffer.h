@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Error.h>
+#include <AK/Optional.h>
+#include <AK/Types.h>
+#include <AK/Vector.h>
+#include <LibCore/AnonymousBuffer.h>
+
+namespace IPC {
+
+// Values of the size field framing each message that don't describe a message (none is ever this big).
+enum class FrameMarker : u32 {
+    // Socket: the sender's frames continue in the shared ring that is passed along with this.
+    SharedRingHandoff = 0xffffffff,
+    // Socket: the receiver asked to be woken up and there is something for it in the ring.
+    Doorbell = 0xfffffffe,
+    // Ring: the following frames are on the socket, up to a ContinueInRing marker.
+    ContinueOnSocket = 0xfffffffd,
+    // Socket: the following frames are in the ring again.
+    ContinueInRing = 0xfffffffc,
+};
+static constexpr u32 first_frame_marker = 0xfffffffc;
+
+// A single-producer single-consumer queue of message frames in memory shared between two processes.
+// A frame is a u32 size field followed by that many bytes, just like on the IPC socket; the writer
+// only publishes whole frames. The reader declares when it is about to go to sleep, so that the
+// writer knows it has to wake it up, and only then.
+class SharedRingBuffer {
+public:
+    static constexpr size_t default_capacity = 256 * KiB;
+
+    static ErrorOr<SharedRingBuffer> create(size_t capacity = default_capacity);
+    static ErrorOr<SharedRingBuffer> create_from_anon_fd(int fd, size_t size);
+
+    int fd() const { return m_buffer.fd(); }
+    size_t size() const { return m_buffer.size(); }
+    size_t capacity() const { return m_capacity; }
+
+    // Writer side.
+    bool has_room_for(size_t frame_size, size_t reserve = 0) const;
+    bool try_write(ReadonlyBytes frame, size_t reserve = 0);
+    bool take_doorbell_request();
+
+    // Reader side.
+    struct Frame {
+        u32 size_field { 0 };
+        // Points into the ring itself unless the frame wraps around, and stays valid until consume().
+        ReadonlyBytes payload;
+    };
+    ErrorOr<Optional<Frame>> peek(Vector<u8>& scratch_buffer);
+    void consume(Frame const&);
+    void request_doorbell();
+    bool is_empty() const;
+
+private:
+    struct Header {
+        u32 write_offset;
+        u32 read_offset;
+        u32 reader_wants_doorbell;
+    };
+
+    explicit SharedRingBuffer(Core::AnonymousBuffer);
+
+    Header* header() { return m_buffer.data<Header>(); }
+    Header const* header() const { return m_buffer.data<Header>(); }
+    u8* data() { return m_buffer.data<u8>() + sizeof(Header); }
+
+    void copy_in(u32 offset, ReadonlyBytes);
+    void copy_out(u32 offset, Bytes);
+
+    Core::AnonymousBuffer m_buffer;
+    size_t m_capacity { 0 };
+};
+
+}
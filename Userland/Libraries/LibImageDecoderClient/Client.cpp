@@ -16,11 +16,18 @@ Client::Client()
 
 void Client::die()
 {
+    // Nothing is coming back for requests that were still in flight.
+    auto pending_decodes = move(m_pending_decodes);
+    for (auto& it : pending_decodes) {
+        if (it.value.on_rejected)
+            it.value.on_rejected();
+    }
+
     if (on_death)
         on_death();
 }
 
-Optional<DecodedImage> Client::decode_image(ReadonlyBytes encoded_data)
+static Optional<Core::AnonymousBuffer> copy_into_anonymous_buffer(ReadonlyBytes encoded_data)
 {
     if (encoded_data.is_empty())
         return {};
@@ -33,7 +40,30 @@ Optional<DecodedImage> Client::decode_image(ReadonlyBytes encoded_data)
     auto encoded_buffer = encoded_buffer_or_error.release_value();
 
     memcpy(encoded_buffer.data<void>(), encoded_data.data(), encoded_data.size());
-    auto response_or_error = try_decode_image(move(encoded_buffer));
+    return encoded_buffer;
+}
+
+static DecodedImage make_decoded_image(bool is_animated, u32 loop_count, Vector<Gfx::ShareableBitmap> const& bitmaps, Vector<u32> const& durations)
+{
+    DecodedImage image;
+    image.is_animated = is_animated;
+    image.loop_count = loop_count;
+    image.frames.resize(bitmaps.size());
+    for (size_t i = 0; i < image.frames.size(); ++i) {
+        auto& frame = image.frames[i];
+        frame.bitmap = bitmaps[i].bitmap();
+        frame.duration = durations[i];
+    }
+    return image;
+}
+
+Optional<DecodedImage> Client::decode_image(ReadonlyBytes encoded_data)
+{
+    auto encoded_buffer = copy_into_anonymous_buffer(encoded_data);
+    if (!encoded_buffer.has_value())
+        return {};
+
+    auto response_or_error = try_decode_image(encoded_buffer.release_value());
 
     if (response_or_error.is_error()) {
         dbgln("ImageDecoder died heroically");
@@ -45,16 +75,62 @@ Optional<DecodedImage> Client::decode_image(ReadonlyBytes encoded_data)
     if (response.bitmaps().is_empty())
         return {};
 
-    DecodedImage image;
-    image.is_animated = response.is_animated();
-    image.loop_count = response.loop_count();
-    image.frames.resize(response.bitmaps().size());
-    for (size_t i = 0; i < image.frames.size(); ++i) {
-        auto& frame = image.frames[i];
-        frame.bitmap = response.bitmaps()[i].bitmap();
-        frame.duration = response.durations()[i];
+    return make_decoded_image(response.is_animated(), response.loop_count(), response.bitmaps(), response.durations());
+}
+
+Optional<i32> Client::start_decoding_image(ReadonlyBytes encoded_data, Function<void(DecodedImage)> on_resolved, Function<void()> on_rejected)
+{
+    auto encoded_buffer = copy_into_anonymous_buffer(encoded_data);
+    if (!encoded_buffer.has_value())
+        return {};
+
+    auto request_id = m_next_request_id++;
+    if (post_message(Messages::ImageDecoderServer::StartDecodingImage { request_id, encoded_buffer.release_value() }).is_error()) {
+        dbgln("ImageDecoder died heroically");
+        return {};
     }
-    return image;
+
+    m_pending_decodes.set(request_id, { move(on_resolved), move(on_rejected) });
+    return request_id;
+}
+
+void Client::cancel_decoding(i32 request_id)
+{
+    if (m_pending_decodes.remove(request_id))
+        async_cancel_decoding(request_id);
+}
+
+Optional<Client::PendingDecode> Client::take_pending_decode(i32 request_id)
+{
+    auto it = m_pending_decodes.find(request_id);
+    if (it == m_pending_decodes.end())
+        return {};
+    auto pending_decode = move(it->value);
+    m_pending_decodes.remove(it);
+    return pending_decode;
+}
+
+void Client::did_decode_image(i32 request_id, bool is_animated, u32 loop_count, Vector<Gfx::ShareableBitmap> const& bitmaps, Vector<u32> const& durations)
+{
+    auto pending_decode = take_pending_decode(request_id);
+    if (!pending_decode.has_value())
+        return;
+
+    if (bitmaps.size() != durations.size()) {
+        if (pending_decode->on_rejected)
+            pending_decode->on_rejected();
+        return;
+    }
+
+    if (pending_decode->on_resolved)
+        pending_decode->on_resolved(make_decoded_image(is_animated, loop_count, bitmaps, durations));
+}
+
+void Client::did_fail_to_decode_image(i32 request_id)
+{
+    auto pending_decode = take_pending_decode(request_id);
+    if (pending_decode.has_value() && pending_decode->on_rejected)
+        pending_decode->on_rejected();
 }
 
 }
@@ -32,12 +32,30 @@ class Client final
 public:
     Optional<DecodedImage> decode_image(ReadonlyBytes);
 
+    // Decodes the image without waiting for it, and calls exactly one of the callbacks when done, unless the request
+    // is cancelled first. Results for different requests can arrive in any order. Returns the request ID, or an empty
+    // Optional (without calling either callback) if the request couldn't be sent.
+    Optional<i32> start_decoding_image(ReadonlyBytes, Function<void(DecodedImage)> on_resolved, Function<void()> on_rejected);
+    void cancel_decoding(i32 request_id);
+
     Function<void()> on_death;
 
 private:
     Client();
 
     virtual void die() override;
+
+    virtual void did_decode_image(i32 request_id, bool is_animated, u32 loop_count, Vector<Gfx::ShareableBitmap> const& bitmaps, Vector<u32> const& durations) override;
+    virtual void did_fail_to_decode_image(i32 request_id) override;
+
+    struct PendingDecode {
+        Function<void(DecodedImage)> on_resolved;
+        Function<void()> on_rejected;
+    };
+    Optional<PendingDecode> take_pending_decode(i32 request_id);
+
+    HashMap<i32, PendingDecode> m_pending_decodes;
+    i32 m_next_request_id { 1 };
 };
 
 }
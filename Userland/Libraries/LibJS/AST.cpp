@@ -3261,7 +3261,7 @@ Completion RegExpLiteral::execute(Interpreter& interpreter, GlobalObject& global
     auto flags = this->flags();
 
     // 3. Return RegExpCreate(pattern, flags).
-    Regex<ECMA262> regex(parsed_regex(), parsed_pattern(), parsed_flags());
+    auto regex = Regex<ECMA262>::compile_cached(parsed_pattern(), parsed_flags());
     return Value { RegExpObject::create(global_object, move(regex), move(pattern), move(flags)) };
 }
 
@@ -64,4 +64,11 @@ void BasicBlock::grow(size_t additional_size)
     VERIFY(m_buffer_size <= m_buffer_capacity);
 }
 
+// NOTE: Passes that remove instructions move the remaining ones down first, and destroy the removed ones themselves.
+void BasicBlock::shrink(size_t new_size)
+{
+    VERIFY(new_size <= m_buffer_size);
+    m_buffer_size = new_size;
+}
+
 }
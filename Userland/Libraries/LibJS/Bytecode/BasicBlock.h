@@ -35,6 +35,7 @@ public:
     void* next_slot() { return m_buffer + m_buffer_size; }
     bool can_grow(size_t additional_size) const { return m_buffer_size + additional_size <= m_buffer_capacity; }
     void grow(size_t additional_size);
+    void shrink(size_t new_size);
 
     void terminate(Badge<Generator>) { m_is_terminated = true; }
     bool is_terminated() const { return m_is_terminated; }
@@ -17,6 +17,7 @@
     O(BitwiseOr)                     \
     O(BitwiseXor)                    \
     O(Call)                          \
+    O(CompareAndJump)                \
     O(ConcatString)                  \
     O(ContinuePendingUnwind)         \
     O(CopyObjectExcludingProperties) \
@@ -80,6 +81,12 @@
 
 namespace JS::Bytecode {
 
+enum class RegisterAccess {
+    Read,
+    Write,
+    ReadWrite,
+};
+
 class Instruction {
 public:
     constexpr static bool IsTerminator = false;
@@ -99,6 +106,15 @@ public:
     void replace_references(BasicBlock const&, BasicBlock const&);
     static void destroy(Instruction&);
 
+    // Calls callback(Register&, RegisterAccess) for every register operand, so passes can inspect and rewrite them.
+    // The accumulator is not included unless an instruction names it explicitly.
+    template<typename Callback>
+    void for_each_register_operand(Callback);
+
+    // Instructions without register operands inherit this.
+    template<typename Callback>
+    void for_each_register_operand_impl(Callback&) { }
+
 protected:
     explicit Instruction(Type type)
         : m_type(type)
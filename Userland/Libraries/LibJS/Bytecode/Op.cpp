@@ -259,36 +259,45 @@ void ConcatString::execute_impl(Bytecode::Interpreter& interpreter) const
     interpreter.reg(m_lhs) = result_or_error.release_value();
 }
 
+// Follows a coordinate remembered from an earlier lookup of the same identifier to the environment it points at.
+// Returns nullptr (and forgets the coordinate) if a direct call to eval() may have added bindings in between.
+static DeclarativeEnvironment* environment_for_cached_coordinate(Bytecode::Interpreter& interpreter, Optional<EnvironmentCoordinate>& coordinate)
+{
+    auto* environment = interpreter.vm().running_execution_context().lexical_environment;
+    for (size_t i = 0; i < coordinate->hops; ++i)
+        environment = environment->outer_environment();
+    VERIFY(environment);
+    VERIFY(environment->is_declarative_environment());
+    if (environment->is_permanently_screwed_by_eval()) {
+        coordinate = {};
+        return nullptr;
+    }
+    return static_cast<DeclarativeEnvironment*>(environment);
+}
+
 void GetVariable::execute_impl(Bytecode::Interpreter& interpreter) const
 {
-    auto reference = [&] {
-        auto const& string = interpreter.current_executable().get_identifier(m_identifier);
-        if (m_cached_environment_coordinate.has_value()) {
-            auto* environment = interpreter.vm().running_execution_context().lexical_environment;
-            for (size_t i = 0; i < m_cached_environment_coordinate->hops; ++i)
-                environment = environment->outer_environment();
-            VERIFY(environment);
-            VERIFY(environment->is_declarative_environment());
-            if (!environment->is_permanently_screwed_by_eval()) {
-                return Reference { *environment, string, interpreter.vm().in_strict_mode(), m_cached_environment_coordinate };
-            }
-            m_cached_environment_coordinate = {};
-        }
+    auto& vm = interpreter.vm();
 
-        auto reference_or_error = interpreter.vm().resolve_binding(string);
-        if (reference_or_error.is_throw_completion()) {
-            interpreter.vm().throw_exception(interpreter.global_object(), *reference_or_error.release_error().value());
-            return Reference {};
+    if (m_cached_environment_coordinate.has_value()) {
+        if (auto* environment = environment_for_cached_coordinate(interpreter, m_cached_environment_coordinate)) {
+            auto value_or_error = environment->get_binding_value_direct(interpreter.global_object(), m_cached_environment_coordinate->index, vm.in_strict_mode());
+            if (value_or_error.is_error())
+                return;
+            interpreter.accumulator() = value_or_error.release_value();
+            return;
         }
+    }
 
-        auto reference = reference_or_error.release_value();
-        if (reference.environment_coordinate().has_value())
-            m_cached_environment_coordinate = reference.environment_coordinate();
-        return reference;
-    }();
-
-    if (interpreter.vm().exception())
+    auto reference_or_error = vm.resolve_binding(interpreter.current_executable().get_identifier(m_identifier));
+    if (reference_or_error.is_throw_completion()) {
+        vm.throw_exception(interpreter.global_object(), *reference_or_error.release_error().value());
         return;
+    }
+
+    auto reference = reference_or_error.release_value();
+    if (reference.environment_coordinate().has_value())
+        m_cached_environment_coordinate = reference.environment_coordinate();
 
     auto value_or_error = reference.get_value(interpreter.global_object());
     if (value_or_error.is_error())
@@ -299,36 +308,95 @@ void GetVariable::execute_impl(Bytecode::Interpreter& interpreter) const
 void SetVariable::execute_impl(Bytecode::Interpreter& interpreter) const
 {
     auto& vm = interpreter.vm();
+
+    if (m_cached_environment_coordinate.has_value()) {
+        if (auto* environment = environment_for_cached_coordinate(interpreter, m_cached_environment_coordinate)) {
+            // TODO: ThrowCompletionOr<void> return
+            (void)environment->set_mutable_binding_direct(interpreter.global_object(), m_cached_environment_coordinate->index, interpreter.accumulator(), vm.in_strict_mode());
+            return;
+        }
+    }
+
     auto reference_or_error = vm.resolve_binding(interpreter.current_executable().get_identifier(m_identifier));
     if (reference_or_error.is_throw_completion()) {
-        interpreter.vm().throw_exception(interpreter.global_object(), *reference_or_error.release_error().value());
+        vm.throw_exception(interpreter.global_object(), *reference_or_error.release_error().value());
         return;
     }
 
     auto reference = reference_or_error.release_value();
+    if (reference.environment_coordinate().has_value())
+        m_cached_environment_coordinate = reference.environment_coordinate();
+
     // TODO: ThrowCompletionOr<void> return
     (void)reference.put_value(interpreter.global_object(), interpreter.accumulator());
 }
 
+// Returns the storage offset of the given own data property if it can be cached for the object's shape.
+static Optional<size_t> cacheable_property_offset(Object& object, FlyString const& name, bool needs_writable)
+{
+    if (object.shape().is_unique() || !object.may_cache_property_lookups())
+        return {};
+    auto metadata = object.shape().lookup(name);
+    if (!metadata.has_value() || (needs_writable && !metadata->attributes.is_writable()))
+        return {};
+    if (object.get_direct(metadata->offset).is_accessor())
+        return {};
+    return metadata->offset;
+}
+
 void GetById::execute_impl(Bytecode::Interpreter& interpreter) const
 {
-    auto object_or_error = interpreter.accumulator().to_object(interpreter.global_object());
+    auto base = interpreter.accumulator();
+    if (base.is_object()) {
+        auto& object = base.as_object();
+        if (auto offset = m_cache.offset_for(object.shape()); offset.has_value()) {
+            // The slot of a non-writable data property can be turned into an accessor without a shape change.
+            auto value = object.get_direct(*offset);
+            if (!value.is_accessor()) {
+                interpreter.accumulator() = value;
+                return;
+            }
+        }
+    }
+
+    auto object_or_error = base.to_object(interpreter.global_object());
     if (object_or_error.is_error())
         return;
     auto* object = object_or_error.release_value();
-    auto value_or_error = object->get(interpreter.current_executable().get_identifier(m_property));
+    auto const& name = interpreter.current_executable().get_identifier(m_property);
+    auto value_or_error = object->get(name);
     if (value_or_error.is_error())
         return;
     interpreter.accumulator() = value_or_error.release_value();
+
+    if (base.is_object()) {
+        if (auto offset = cacheable_property_offset(*object, name, false); offset.has_value())
+            m_cache.remember(object->shape(), *offset);
+    }
 }
 
 void PutById::execute_impl(Bytecode::Interpreter& interpreter) const
 {
-    auto object_or_error = interpreter.reg(m_base).to_object(interpreter.global_object());
+    auto base = interpreter.reg(m_base);
+    if (base.is_object()) {
+        auto& object = base.as_object();
+        if (auto offset = m_cache.offset_for(object.shape()); offset.has_value()) {
+            object.put_direct(*offset, interpreter.accumulator());
+            return;
+        }
+    }
+
+    auto object_or_error = base.to_object(interpreter.global_object());
     if (object_or_error.is_error())
         return;
     auto* object = object_or_error.release_value();
-    MUST(object->set(interpreter.current_executable().get_identifier(m_property), interpreter.accumulator(), Object::ShouldThrowExceptions::Yes));
+    auto const& name = interpreter.current_executable().get_identifier(m_property);
+    MUST(object->set(name, interpreter.accumulator(), Object::ShouldThrowExceptions::Yes));
+
+    if (base.is_object()) {
+        if (auto offset = cacheable_property_offset(*object, name, true); offset.has_value())
+            m_cache.remember(object->shape(), *offset);
+    }
 }
 
 void Jump::execute_impl(Bytecode::Interpreter& interpreter) const
@@ -363,6 +431,46 @@ void JumpConditional::execute_impl(Bytecode::Interpreter& interpreter) const
         interpreter.jump(m_false_target.value());
 }
 
+bool CompareAndJump::is_fusable_comparison(Type type)
+{
+    switch (type) {
+#define __JS_ENUMERATE_COMPARISON(OpTitleCase, op_snake_case) \
+    case Type::OpTitleCase:
+        JS_ENUMERATE_COMPARISON_OPS(__JS_ENUMERATE_COMPARISON)
+#undef __JS_ENUMERATE_COMPARISON
+        return true;
+    default:
+        return false;
+    }
+}
+
+void CompareAndJump::execute_impl(Bytecode::Interpreter& interpreter) const
+{
+    VERIFY(m_true_target.has_value());
+    VERIFY(m_false_target.has_value());
+    auto lhs = interpreter.reg(m_lhs_reg);
+    auto rhs = interpreter.accumulator();
+    auto result_or_error = [&]() -> ThrowCompletionOr<Value> {
+        switch (m_comparison) {
+#define __JS_ENUMERATE_COMPARISON(OpTitleCase, op_snake_case) \
+    case Type::OpTitleCase:                                   \
+        return op_snake_case(interpreter.global_object(), lhs, rhs);
+            JS_ENUMERATE_COMPARISON_OPS(__JS_ENUMERATE_COMPARISON)
+#undef __JS_ENUMERATE_COMPARISON
+        default:
+            VERIFY_NOT_REACHED();
+        }
+    }();
+    if (result_or_error.is_error())
+        return;
+    auto result = result_or_error.release_value();
+    interpreter.accumulator() = result;
+    if (result.to_boolean())
+        interpreter.jump(m_true_target.value());
+    else
+        interpreter.jump(m_false_target.value());
+}
+
 void JumpNullish::execute_impl(Bytecode::Interpreter& interpreter) const
 {
     VERIFY(m_true_target.has_value());
@@ -436,6 +544,11 @@ void Return::execute_impl(Bytecode::Interpreter& interpreter) const
 
 void Increment::execute_impl(Bytecode::Interpreter& interpreter) const
 {
+    if (auto value = interpreter.accumulator(); value.type() == Value::Type::Int32 && value.as_i32() != NumericLimits<i32>::max()) {
+        interpreter.accumulator() = Value(value.as_i32() + 1);
+        return;
+    }
+
     auto old_value_or_error = interpreter.accumulator().to_numeric(interpreter.global_object());
     if (old_value_or_error.is_error())
         return;
@@ -449,6 +562,11 @@ void Increment::execute_impl(Bytecode::Interpreter& interpreter) const
 
 void Decrement::execute_impl(Bytecode::Interpreter& interpreter) const
 {
+    if (auto value = interpreter.accumulator(); value.type() == Value::Type::Int32 && value.as_i32() != NumericLimits<i32>::min()) {
+        interpreter.accumulator() = Value(value.as_i32() - 1);
+        return;
+    }
+
     auto old_value_or_error = interpreter.accumulator().to_numeric(interpreter.global_object());
     if (old_value_or_error.is_error())
         return;
@@ -731,6 +849,22 @@ String JumpConditional::to_string_impl(Bytecode::Executable const&) const
     return String::formatted("JumpConditional true:{} false:{}", true_string, false_string);
 }
 
+String CompareAndJump::to_string_impl(Bytecode::Executable const&) const
+{
+    auto comparison_name = [&] {
+        switch (m_comparison) {
+#define __JS_ENUMERATE_COMPARISON(OpTitleCase, op_snake_case) \
+    case Type::OpTitleCase:                                   \
+        return #OpTitleCase;
+            JS_ENUMERATE_COMPARISON_OPS(__JS_ENUMERATE_COMPARISON)
+#undef __JS_ENUMERATE_COMPARISON
+        default:
+            VERIFY_NOT_REACHED();
+        }
+    }();
+    return String::formatted("CompareAndJump {} {} true:{} false:{}", comparison_name, m_lhs_reg, *m_true_target, *m_false_target);
+}
+
 String JumpNullish::to_string_impl(Bytecode::Executable const&) const
 {
     auto true_string = m_true_target.has_value() ? String::formatted("{}", *m_true_target) : "<empty>";
@@ -12,6 +12,7 @@
 #include <LibJS/Bytecode/IdentifierTable.h>
 #include <LibJS/Bytecode/Instruction.h>
 #include <LibJS/Bytecode/Label.h>
+#include <LibJS/Bytecode/PropertyLookupCache.h>
 #include <LibJS/Bytecode/Register.h>
 #include <LibJS/Bytecode/StringTable.h>
 #include <LibJS/Heap/Cell.h>
@@ -33,6 +34,14 @@ public:
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
 
+    Register src() const { return m_src; }
+
+    template<typename Callback>
+    void for_each_register_operand_impl(Callback& callback)
+    {
+        callback(m_src, RegisterAccess::Read);
+    }
+
 private:
     Register m_src;
 };
@@ -65,6 +74,14 @@ public:
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
 
+    Register dst() const { return m_dst; }
+
+    template<typename Callback>
+    void for_each_register_operand_impl(Callback& callback)
+    {
+        callback(m_dst, RegisterAccess::Write);
+    }
+
 private:
     Register m_dst;
 };
@@ -93,6 +110,17 @@ private:
     O(RightShift, right_shift)                \
     O(UnsignedRightShift, unsigned_right_shift)
 
+// The binary operations that produce a boolean, and can therefore be fused with a following JumpConditional.
+#define JS_ENUMERATE_COMPARISON_OPS(O)        \
+    O(GreaterThan, greater_than)              \
+    O(GreaterThanEquals, greater_than_equals) \
+    O(LessThan, less_than)                    \
+    O(LessThanEquals, less_than_equals)       \
+    O(LooselyInequals, abstract_inequals)     \
+    O(LooselyEquals, abstract_equals)         \
+    O(StrictlyInequals, typed_inequals)       \
+    O(StrictlyEquals, typed_equals)
+
 #define JS_DECLARE_COMMON_BINARY_OP(OpTitleCase, op_snake_case)                \
     class OpTitleCase final : public Instruction {                             \
     public:                                                                    \
@@ -106,6 +134,14 @@ private:
         String to_string_impl(Bytecode::Executable const&) const;              \
         void replace_references_impl(BasicBlock const&, BasicBlock const&) { } \
                                                                                \
+        Register lhs() const { return m_lhs_reg; }                             \
+                                                                               \
+        template<typename Callback>                                            \
+        void for_each_register_operand_impl(Callback& callback)                \
+        {                                                                      \
+            callback(m_lhs_reg, RegisterAccess::Read);                         \
+        }                                                                      \
+                                                                               \
     private:                                                                   \
         Register m_lhs_reg;                                                    \
     };
@@ -200,6 +236,14 @@ public:
 
     size_t length_impl() const { return sizeof(*this) + sizeof(Register) * m_excluded_names_count; }
 
+    template<typename Callback>
+    void for_each_register_operand_impl(Callback& callback)
+    {
+        callback(m_from_object, RegisterAccess::Read);
+        for (size_t i = 0; i < m_excluded_names_count; ++i)
+            callback(m_excluded_names[i], RegisterAccess::Read);
+    }
+
 private:
     Register m_from_object;
     size_t m_excluded_names_count { 0 };
@@ -248,6 +292,13 @@ public:
         return sizeof(*this) + sizeof(Register) * m_element_count;
     }
 
+    template<typename Callback>
+    void for_each_register_operand_impl(Callback& callback)
+    {
+        for (size_t i = 0; i < m_element_count; ++i)
+            callback(m_elements[i], RegisterAccess::Read);
+    }
+
 private:
     size_t m_element_count { 0 };
     Register m_elements[];
@@ -277,6 +328,12 @@ public:
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
 
+    template<typename Callback>
+    void for_each_register_operand_impl(Callback& callback)
+    {
+        callback(m_lhs, RegisterAccess::ReadWrite);
+    }
+
 private:
     Register m_lhs;
 };
@@ -295,6 +352,8 @@ public:
 
 private:
     IdentifierTableIndex m_identifier;
+
+    Optional<EnvironmentCoordinate> mutable m_cached_environment_coordinate;
 };
 
 class GetVariable final : public Instruction {
@@ -329,6 +388,7 @@ public:
 
 private:
     IdentifierTableIndex m_property;
+    PropertyLookupCache mutable m_cache;
 };
 
 class PutById final : public Instruction {
@@ -344,9 +404,16 @@ public:
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
 
+    template<typename Callback>
+    void for_each_register_operand_impl(Callback& callback)
+    {
+        callback(m_base, RegisterAccess::Read);
+    }
+
 private:
     Register m_base;
     IdentifierTableIndex m_property;
+    PropertyLookupCache mutable m_cache;
 };
 
 class GetByValue final : public Instruction {
@@ -361,6 +428,12 @@ public:
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
 
+    template<typename Callback>
+    void for_each_register_operand_impl(Callback& callback)
+    {
+        callback(m_base, RegisterAccess::Read);
+    }
+
 private:
     Register m_base;
 };
@@ -378,6 +451,13 @@ public:
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
 
+    template<typename Callback>
+    void for_each_register_operand_impl(Callback& callback)
+    {
+        callback(m_base, RegisterAccess::Read);
+        callback(m_property, RegisterAccess::Read);
+    }
+
 private:
     Register m_base;
     Register m_property;
@@ -430,6 +510,34 @@ public:
     String to_string_impl(Bytecode::Executable const&) const;
 };
 
+// NOTE: This is never emitted by the generator, only by the peephole pass, which fuses a comparison
+//       followed by a JumpConditional into one of these. It leaves the result of the comparison in the
+//       accumulator, just like the two instructions it replaces.
+class CompareAndJump final : public Jump {
+public:
+    CompareAndJump(Type comparison, Register lhs_reg, Optional<Label> true_target, Optional<Label> false_target)
+        : Jump(Type::CompareAndJump, move(true_target), move(false_target))
+        , m_comparison(comparison)
+        , m_lhs_reg(lhs_reg)
+    {
+    }
+
+    static bool is_fusable_comparison(Type);
+
+    void execute_impl(Bytecode::Interpreter&) const;
+    String to_string_impl(Bytecode::Executable const&) const;
+
+    template<typename Callback>
+    void for_each_register_operand_impl(Callback& callback)
+    {
+        callback(m_lhs_reg, RegisterAccess::Read);
+    }
+
+private:
+    Type m_comparison;
+    Register m_lhs_reg;
+};
+
 class JumpNullish final : public Jump {
 public:
     explicit JumpNullish(Optional<Label> true_target = {}, Optional<Label> false_target = {})
@@ -480,6 +588,15 @@ public:
         return sizeof(*this) + sizeof(Register) * m_argument_count;
     }
 
+    template<typename Callback>
+    void for_each_register_operand_impl(Callback& callback)
+    {
+        callback(m_callee, RegisterAccess::Read);
+        callback(m_this_value, RegisterAccess::Read);
+        for (size_t i = 0; i < m_argument_count; ++i)
+            callback(m_arguments[i], RegisterAccess::Read);
+    }
+
 private:
     Register m_callee;
     Register m_this_value;
@@ -781,6 +898,22 @@ ALWAYS_INLINE void Instruction::replace_references(BasicBlock const& from, Basic
 #undef __BYTECODE_OP
 }
 
+template<typename Callback>
+ALWAYS_INLINE void Instruction::for_each_register_operand(Callback callback)
+{
+#define __BYTECODE_OP(op)       \
+    case Instruction::Type::op: \
+        return static_cast<Bytecode::Op::op&>(*this).for_each_register_operand_impl(callback);
+
+    switch (type()) {
+        ENUMERATE_BYTECODE_OPS(__BYTECODE_OP)
+    default:
+        VERIFY_NOT_REACHED();
+    }
+
+#undef __BYTECODE_OP
+}
+
 ALWAYS_INLINE size_t Instruction::length() const
 {
     if (type() == Type::Call)
@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/HashTable.h>
+#include <AK/QuickSort.h>
+#include <LibJS/Bytecode/Op.h>
+#include <LibJS/Bytecode/PassManager.h>
+
+namespace JS::Bytecode::Passes {
+
+// The accumulator and the global object live at fixed indices and are left alone.
+static constexpr u32 first_allocatable_register = 2;
+
+struct BlockLiveness {
+    HashTable<u32> uses;
+    HashTable<u32> defs;
+    HashTable<u32> live_in;
+    HashTable<u32> live_out;
+};
+
+template<typename Callback>
+static void for_each_allocatable_register(Instruction const& instruction, Callback callback)
+{
+    const_cast<Instruction&>(instruction).for_each_register_operand([&](Register& reg, RegisterAccess access) {
+        if (reg.index() >= first_allocatable_register)
+            callback(reg, access);
+    });
+}
+
+static void remove_dead_stores(BasicBlock& block, HashTable<u32> live, HashTable<u32> const& pinned_registers)
+{
+    Vector<size_t> offsets;
+    for (InstructionStreamIterator it { block.instruction_stream() }; !it.at_end(); ++it)
+        offsets.append(it.offset());
+
+    auto* data = const_cast<u8*>(block.instruction_stream().data());
+    auto instruction_at = [&](size_t offset) -> Instruction& { return *reinterpret_cast<Instruction*>(data + offset); };
+
+    HashTable<size_t> dead_offsets;
+    for (size_t i = offsets.size(); i > 0; --i) {
+        auto& instruction = instruction_at(offsets[i - 1]);
+        if (instruction.type() == Instruction::Type::Store) {
+            auto dst = static_cast<Op::Store const&>(instruction).dst().index();
+            if (dst >= first_allocatable_register && !live.contains(dst) && !pinned_registers.contains(dst)) {
+                dead_offsets.set(offsets[i - 1]);
+                continue;
+            }
+        }
+        for_each_allocatable_register(instruction, [&](Register& reg, RegisterAccess access) {
+            if (access == RegisterAccess::Write)
+                live.remove(reg.index());
+        });
+        for_each_allocatable_register(instruction, [&](Register& reg, RegisterAccess access) {
+            if (access != RegisterAccess::Write)
+                live.set(reg.index());
+        });
+    }
+
+    if (dead_offsets.is_empty())
+        return;
+
+    size_t write_offset = 0;
+    for (size_t i = 0; i < offsets.size(); ++i) {
+        auto offset = offsets[i];
+        auto& instruction = instruction_at(offset);
+        auto length = instruction.length();
+        if (dead_offsets.contains(offset)) {
+            Instruction::destroy(instruction);
+            continue;
+        }
+        if (offset != write_offset)
+            __builtin_memmove(data + write_offset, data + offset, length);
+        write_offset += length;
+    }
+    block.shrink(write_offset);
+}
+
+void AllocateRegisters::perform(PassPipelineExecutable& executable)
+{
+    started();
+
+    VERIFY(executable.cfg.has_value());
+    auto& cfg = *executable.cfg;
+    auto& blocks = executable.executable.basic_blocks;
+
+    HashMap<BasicBlock const*, BlockLiveness> liveness;
+    for (auto& block : blocks) {
+        auto& block_liveness = liveness.ensure(&block);
+        for (InstructionStreamIterator it { block.instruction_stream() }; !it.at_end(); ++it) {
+            for_each_allocatable_register(*it, [&](Register& reg, RegisterAccess access) {
+                if (access != RegisterAccess::Write && !block_liveness.defs.contains(reg.index()))
+                    block_liveness.uses.set(reg.index());
+                if (access != RegisterAccess::Read)
+                    block_liveness.defs.set(reg.index());
+            });
+        }
+    }
+
+    // Classic backwards data flow: a register is live on entry to a block if the block reads it before writing it,
+    // or if it's live on exit and the block doesn't write it. Visiting the blocks in reverse converges quickly.
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (size_t i = blocks.size(); i > 0; --i) {
+            auto const* block = &blocks[i - 1];
+            auto& block_liveness = liveness.find(block)->value;
+
+            if (auto successors = cfg.find(block); successors != cfg.end()) {
+                for (auto const* successor : successors->value) {
+                    for (auto reg : liveness.find(successor)->value.live_in)
+                        block_liveness.live_out.set(reg);
+                }
+            }
+
+            auto live_in_size = block_liveness.live_in.size();
+            for (auto reg : block_liveness.uses)
+                block_liveness.live_in.set(reg);
+            for (auto reg : block_liveness.live_out) {
+                if (!block_liveness.defs.contains(reg))
+                    block_liveness.live_in.set(reg);
+            }
+            if (block_liveness.live_in.size() != live_in_size)
+                changed = true;
+        }
+    }
+
+    // Registers that are read before being written on some path, or are read by an exception handler or finalizer,
+    // get a slot of their own, and stores to them are never removed. The former may rely on starting out empty, and
+    // the latter may be read after a throw from anywhere in the protected blocks, which the CFG doesn't model.
+    HashTable<u32> pinned_registers;
+    for (auto reg : liveness.find(&blocks.first())->value.live_in)
+        pinned_registers.set(reg);
+    for (auto& block : blocks) {
+        for (InstructionStreamIterator it { block.instruction_stream() }; !it.at_end(); ++it) {
+            if ((*it).type() != Instruction::Type::EnterUnwindContext)
+                continue;
+            auto& enter_unwind_context = static_cast<Op::EnterUnwindContext const&>(*it);
+            for (auto& target : { enter_unwind_context.handler_target(), enter_unwind_context.finalizer_target() }) {
+                if (!target.has_value())
+                    continue;
+                for (auto reg : liveness.find(&target->block())->value.live_in)
+                    pinned_registers.set(reg);
+            }
+        }
+    }
+
+    for (auto& block : blocks)
+        remove_dead_stores(block, liveness.find(&block)->value.live_out, pinned_registers);
+
+    // Number all instructions in block order, and give every register the smallest range of positions that contains
+    // all of its reads, writes and the block boundaries it's live across. Registers whose ranges don't overlap are
+    // never live at the same time, and can share a slot.
+    struct LiveRange {
+        u32 reg;
+        size_t start;
+        size_t end;
+    };
+    HashMap<u32, LiveRange> ranges;
+    auto extend_range = [&](u32 reg, size_t position) {
+        auto& range = ranges.ensure(reg, [&] { return LiveRange { reg, position, position }; });
+        range.start = min(range.start, position);
+        range.end = max(range.end, position);
+    };
+
+    size_t position = 0;
+    for (auto& block : blocks) {
+        auto& block_liveness = liveness.find(&block)->value;
+        for (auto reg : block_liveness.live_in)
+            extend_range(reg, position);
+        ++position;
+        for (InstructionStreamIterator it { block.instruction_stream() }; !it.at_end(); ++it) {
+            for_each_allocatable_register(*it, [&](Register& reg, RegisterAccess) { extend_range(reg.index(), position); });
+            ++position;
+        }
+        for (auto reg : block_liveness.live_out)
+            extend_range(reg, position);
+        ++position;
+    }
+
+    HashMap<u32, u32> assignments;
+    u32 next_register = first_allocatable_register;
+    for (auto reg : pinned_registers)
+        assignments.set(reg, next_register++);
+
+    Vector<LiveRange> sorted_ranges;
+    for (auto& entry : ranges) {
+        if (!pinned_registers.contains(entry.key))
+            sorted_ranges.append(entry.value);
+    }
+    quick_sort(sorted_ranges, [](auto& a, auto& b) { return a.start < b.start || (a.start == b.start && a.reg < b.reg); });
+
+    Vector<LiveRange> active_ranges;
+    Vector<u32> free_registers;
+    for (auto& range : sorted_ranges) {
+        active_ranges.remove_all_matching([&](auto& active_range) {
+            if (active_range.end >= range.start)
+                return false;
+            free_registers.append(assignments.get(active_range.reg).value());
+            return true;
+        });
+        auto assigned_register = free_registers.is_empty() ? next_register++ : free_registers.take_last();
+        assignments.set(range.reg, assigned_register);
+        active_ranges.append(range);
+    }
+
+    for (auto& block : blocks) {
+        for (InstructionStreamIterator it { block.instruction_stream() }; !it.at_end(); ++it) {
+            for_each_allocatable_register(*it, [&](Register& reg, RegisterAccess) {
+                reg = Register { assignments.get(reg.index()).value() };
+            });
+        }
+    }
+
+    executable.executable.number_of_registers = next_register;
+
+    finished();
+}
+
+}
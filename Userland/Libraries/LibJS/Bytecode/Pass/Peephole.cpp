@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibJS/Bytecode/Op.h>
+#include <LibJS/Bytecode/PassManager.h>
+
+namespace JS::Bytecode::Passes {
+
+// Instructions that replace the value in the accumulator without looking at it first.
+// If such an instruction throws, the old value is never looked at either: unwinding either
+// leaves the executable, or enters a handler with the exception in the accumulator.
+static bool overwrites_accumulator(Instruction const& instruction)
+{
+    switch (instruction.type()) {
+    case Instruction::Type::GetVariable:
+    case Instruction::Type::Load:
+    case Instruction::Type::LoadImmediate:
+    case Instruction::Type::NewArray:
+    case Instruction::Type::NewBigInt:
+    case Instruction::Type::NewFunction:
+    case Instruction::Type::NewObject:
+    case Instruction::Type::NewRegExp:
+    case Instruction::Type::NewString:
+    case Instruction::Type::ResolveThisBinding:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static Register comparison_lhs(Instruction const& instruction)
+{
+    switch (instruction.type()) {
+#define __JS_ENUMERATE_COMPARISON(OpTitleCase, op_snake_case) \
+    case Instruction::Type::OpTitleCase:                      \
+        return static_cast<Op::OpTitleCase const&>(instruction).lhs();
+        JS_ENUMERATE_COMPARISON_OPS(__JS_ENUMERATE_COMPARISON)
+#undef __JS_ENUMERATE_COMPARISON
+    default:
+        VERIFY_NOT_REACHED();
+    }
+}
+
+void Peephole::perform(PassPipelineExecutable& executable)
+{
+    started();
+
+    for (auto& block : executable.executable.basic_blocks) {
+        // Instructions are only ever removed or replaced by smaller ones, so the block is rewritten in place,
+        // with the instructions we keep moved down to write_offset.
+        auto* data = const_cast<u8*>(block.instruction_stream().data());
+        auto instruction_at = [&](size_t offset) -> Instruction& { return *reinterpret_cast<Instruction*>(data + offset); };
+
+        size_t read_offset = 0;
+        size_t write_offset = 0;
+        auto keep = [&](size_t offset, size_t length) {
+            if (offset != write_offset)
+                __builtin_memmove(data + write_offset, data + offset, length);
+            write_offset += length;
+        };
+
+        while (read_offset < block.size()) {
+            auto& instruction = instruction_at(read_offset);
+            auto length = instruction.length();
+            auto next_offset = read_offset + length;
+            if (next_offset >= block.size()) {
+                keep(read_offset, length);
+                break;
+            }
+            auto& next = instruction_at(next_offset);
+            auto next_length = next.length();
+
+            // Load $x or LoadImmediate, followed by something that replaces the accumulator anyway.
+            if ((instruction.type() == Instruction::Type::Load || instruction.type() == Instruction::Type::LoadImmediate) && overwrites_accumulator(next)) {
+                Instruction::destroy(instruction);
+                read_offset = next_offset;
+                continue;
+            }
+
+            // Store $x, Load $x: the accumulator still holds the value.
+            if (instruction.type() == Instruction::Type::Store && next.type() == Instruction::Type::Load
+                && static_cast<Op::Store const&>(instruction).dst().index() == static_cast<Op::Load const&>(next).src().index()) {
+                keep(read_offset, length);
+                Instruction::destroy(next);
+                read_offset = next_offset + next_length;
+                continue;
+            }
+
+            // A comparison, followed by a JumpConditional on its result.
+            if (Op::CompareAndJump::is_fusable_comparison(instruction.type()) && next.type() == Instruction::Type::JumpConditional) {
+                static_assert(sizeof(Op::CompareAndJump) <= sizeof(Op::LessThan) + sizeof(Op::JumpConditional));
+                auto comparison = instruction.type();
+                auto lhs = comparison_lhs(instruction);
+                auto& jump = static_cast<Op::JumpConditional const&>(next);
+                auto true_target = jump.true_target();
+                auto false_target = jump.false_target();
+                Instruction::destroy(instruction);
+                Instruction::destroy(next);
+                new (data + write_offset) Op::CompareAndJump(comparison, lhs, move(true_target), move(false_target));
+                write_offset += sizeof(Op::CompareAndJump);
+                read_offset = next_offset + next_length;
+                continue;
+            }
+
+            keep(read_offset, length);
+            read_offset = next_offset;
+        }
+
+        block.shrink(write_offset);
+    }
+
+    finished();
+}
+
+}
@@ -121,6 +121,27 @@ private:
     virtual void perform(PassPipelineExecutable&) override;
 };
 
+// Rewrites a few common instruction sequences into cheaper ones.
+class Peephole : public Pass {
+public:
+    Peephole() = default;
+    ~Peephole() override = default;
+
+private:
+    virtual void perform(PassPipelineExecutable&) override;
+};
+
+// Removes stores to registers that are never read and lets registers whose live ranges don't overlap share
+// a slot, which shrinks the register window of every call.
+class AllocateRegisters : public Pass {
+public:
+    AllocateRegisters() = default;
+    ~AllocateRegisters() override = default;
+
+private:
+    virtual void perform(PassPipelineExecutable&) override;
+};
+
 class DumpCFG : public Pass {
 public:
     DumpCFG(FILE* file)
@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Array.h>
+#include <AK/Optional.h>
+#include <AK/WeakPtr.h>
+#include <LibJS/Runtime/Shape.h>
+
+namespace JS::Bytecode {
+
+// Remembers, for the last few shapes an instruction has seen, at which storage offset
+// the object had the instruction's property as an own data property.
+//
+// Only non-unique shapes are ever cached: those never change once created, and any change
+// to an object's properties or prototype gives the object a different shape, so a cached
+// offset stays correct for as long as its shape is alive. Unique shapes are mutated in place.
+class PropertyLookupCache {
+public:
+    static constexpr size_t entry_count = 4;
+
+    Optional<size_t> offset_for(Shape const& shape) const
+    {
+        for (auto& entry : m_entries) {
+            if (entry.shape.ptr() == &shape)
+                return entry.offset;
+        }
+        return {};
+    }
+
+    void remember(Shape& shape, size_t offset)
+    {
+        VERIFY(!shape.is_unique());
+        auto& entry = m_entries[m_next_entry];
+        entry.shape = shape.make_weak_ptr();
+        entry.offset = offset;
+        m_next_entry = (m_next_entry + 1) % entry_count;
+    }
+
+private:
+    struct Entry {
+        WeakPtr<Shape> shape;
+        size_t offset { 0 };
+    };
+
+    AK::Array<Entry, entry_count> m_entries;
+    size_t m_next_entry { 0 };
+};
+
+}
@@ -36,7 +36,17 @@ BlockAllocator::~BlockAllocator()
     }
 }
 
-void* BlockAllocator::allocate_block([[maybe_unused]] char const* name)
+void* BlockAllocator::allocate_block(char const* name)
+{
+    auto* block = take_block(name);
+    auto address = bit_cast<FlatPtr>(block);
+    m_blocks_in_use.set(address);
+    m_lowest_block_address = min(m_lowest_block_address, address);
+    m_highest_block_address = max(m_highest_block_address, address);
+    return block;
+}
+
+void* BlockAllocator::take_block([[maybe_unused]] char const* name)
 {
     if (!m_blocks.is_empty()) {
         // To reduce predictability, take a random block from the cache.
@@ -65,6 +75,8 @@ void* BlockAllocator::allocate_block([[maybe_unused]] char const* name)
 void BlockAllocator::deallocate_block(void* block)
 {
     VERIFY(block);
+    VERIFY(m_blocks_in_use.remove(bit_cast<FlatPtr>(block)));
+
     if (m_blocks.size() >= max_cached_blocks) {
 #ifdef __serenity__
         if (munmap(block, HeapBlock::block_size) < 0) {
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/HashTable.h>
 #include <AK/Vector.h>
 #include <LibJS/Forward.h>
 
@@ -19,10 +20,27 @@ public:
     void* allocate_block(char const* name);
     void deallocate_block(void*);
 
+    // Whether the given address is the start of a block that is currently handed out, i.e. a live HeapBlock.
+    // This is asked about every word on the stack during conservative root scanning, so the common case of
+    // a value that's nowhere near the heap is rejected with a range check.
+    bool is_block_in_use(void const* block) const
+    {
+        auto address = bit_cast<FlatPtr>(block);
+        if (address < m_lowest_block_address || address > m_highest_block_address)
+            return false;
+        return m_blocks_in_use.contains(address);
+    }
+
 private:
     static constexpr size_t max_cached_blocks = 512;
 
+    void* take_block(char const* name);
+
     Vector<void*, max_cached_blocks> m_blocks;
+
+    HashTable<FlatPtr> m_blocks_in_use;
+    FlatPtr m_lowest_block_address { NumericLimits<FlatPtr>::max() };
+    FlatPtr m_highest_block_address { 0 };
 };
 
 }
@@ -38,6 +38,10 @@ public:
 #endif
     };
 
+    // Cells that the last garbage collection found unreachable are swept lazily, which leaves them in place for a while.
+    // Anything that can hand out a cell without keeping it alive (a weak pointer, a cache) must not hand out these.
+    bool is_pending_destruction() const;
+
     State state() const { return m_state; }
     void set_state(State state) { m_state = state; }
 
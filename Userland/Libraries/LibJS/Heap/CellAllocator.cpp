@@ -32,19 +32,39 @@ Cell* CellAllocator::allocate_cell(Heap& heap)
     return cell;
 }
 
-void CellAllocator::block_did_become_empty(Badge<Heap>, HeapBlock& block)
+size_t CellAllocator::prepare_blocks_for_sweep(Badge<Heap>)
 {
-    auto& heap = block.heap();
-    block.m_list_node.remove();
-    // NOTE: HeapBlocks are managed by the BlockAllocator, so we don't want to `delete` the block here.
-    block.~HeapBlock();
-    heap.block_allocator().deallocate_block(&block);
+    size_t block_count = 0;
+    auto move_to_awaiting_sweep = [&](BlockList& list) {
+        while (auto* block = list.first()) {
+            block->set_awaiting_sweep(true);
+            m_blocks_awaiting_sweep.append(*block);
+            ++block_count;
+        }
+    };
+    move_to_awaiting_sweep(m_full_blocks);
+    move_to_awaiting_sweep(m_usable_blocks);
+    return block_count;
 }
 
-void CellAllocator::block_did_become_usable(Badge<Heap>, HeapBlock& block)
+void CellAllocator::block_was_swept(Badge<Heap>, HeapBlock& block, bool has_live_cells)
 {
-    VERIFY(!block.is_full());
-    m_usable_blocks.append(block);
+    VERIFY(block.is_awaiting_sweep());
+    block.set_awaiting_sweep(false);
+
+    if (!has_live_cells) {
+        auto& heap = block.heap();
+        block.m_list_node.remove();
+        // NOTE: HeapBlocks are managed by the BlockAllocator, so we don't want to `delete` the block here.
+        block.~HeapBlock();
+        heap.block_allocator().deallocate_block(&block);
+        return;
+    }
+
+    if (block.is_full())
+        m_full_blocks.append(block);
+    else
+        m_usable_blocks.append(block);
 }
 
 }
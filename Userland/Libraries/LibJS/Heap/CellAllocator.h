@@ -34,11 +34,18 @@ public:
             if (callback(block) == IterationDecision::Break)
                 return IterationDecision::Break;
         }
+        for (auto& block : m_blocks_awaiting_sweep) {
+            if (callback(block) == IterationDecision::Break)
+                return IterationDecision::Break;
+        }
         return IterationDecision::Continue;
     }
 
-    void block_did_become_empty(Badge<Heap>, HeapBlock&);
-    void block_did_become_usable(Badge<Heap>, HeapBlock&);
+    bool has_usable_blocks() const { return !m_usable_blocks.is_empty(); }
+    HeapBlock* first_block_awaiting_sweep() const { return m_blocks_awaiting_sweep.first(); }
+
+    size_t prepare_blocks_for_sweep(Badge<Heap>);
+    void block_was_swept(Badge<Heap>, HeapBlock&, bool has_live_cells);
 
 private:
     const size_t m_cell_size;
@@ -46,6 +53,7 @@ private:
     using BlockList = IntrusiveList<&HeapBlock::m_list_node>;
     BlockList m_full_blocks;
     BlockList m_usable_blocks;
+    BlockList m_blocks_awaiting_sweep;
 };
 
 }
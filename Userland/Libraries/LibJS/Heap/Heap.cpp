@@ -78,6 +78,20 @@ Cell* Heap::allocate_cell(size_t size)
     }
 
     auto& allocator = allocator_for_size(size);
+
+    // Rather than sweeping the whole heap at the end of a collection, the work is spread out over the following
+    // allocations: each one sweeps a block, plus however many it takes to find a free cell without growing the heap.
+    if (m_blocks_awaiting_sweep) {
+        while (!allocator.has_usable_blocks()) {
+            auto* block = allocator.first_block_awaiting_sweep();
+            if (!block)
+                break;
+            SweepStatistics statistics;
+            sweep_block(*block, statistics);
+        }
+        sweep_next_block();
+    }
+
     return allocator.allocate_cell(*this);
 }
 
@@ -92,16 +106,24 @@ void Heap::collect_garbage(CollectionType collection_type, bool print_report)
 #endif
 
     auto collection_measurement_timer = Core::ElapsedTimer::start_new();
+    if (collection_type == CollectionType::CollectGarbage && m_gc_deferrals) {
+        m_should_gc_when_deferral_ends = true;
+        return;
+    }
+
+    // Marking reuses the mark bits, so whatever the previous collection left unswept has to go first.
+    sweep_dead_cells(false, collection_measurement_timer);
+
     if (collection_type == CollectionType::CollectGarbage) {
-        if (m_gc_deferrals) {
-            m_should_gc_when_deferral_ends = true;
-            return;
-        }
         HashTable<Cell*> roots;
         gather_roots(roots);
         mark_live_cells(roots);
     }
-    sweep_dead_cells(print_report, collection_measurement_timer);
+    prepare_blocks_for_sweep();
+
+    // Someone asking for a report wants to know what this collection freed, and tearing down the heap can't wait.
+    if (collection_type == CollectionType::CollectEverything || print_report)
+        sweep_dead_cells(print_report, collection_measurement_timer);
 }
 
 void Heap::gather_roots(HashTable<Cell*>& roots)
@@ -140,43 +162,35 @@ __attribute__((no_sanitize("address"))) void Heap::gather_conservative_roots(Has
     jmp_buf buf;
     setjmp(buf);
 
-    HashTable<FlatPtr> possible_pointers;
+    // Every word is checked against the block allocator as we go, so there's no need to collect them first;
+    // a cell that shows up more than once is deduplicated by the root set.
+    auto add_possible_pointer = [&](FlatPtr possible_pointer) {
+        if (!possible_pointer)
+            return;
+        auto* possible_heap_block = HeapBlock::from_cell(reinterpret_cast<const Cell*>(possible_pointer));
+        if (!m_block_allocator.is_block_in_use(possible_heap_block))
+            return;
+        dbgln_if(HEAP_DEBUG, "  ? {}", (const void*)possible_pointer);
+        if (auto* cell = possible_heap_block->cell_from_possible_pointer(possible_pointer)) {
+            if (cell->state() == Cell::State::Live) {
+                dbgln_if(HEAP_DEBUG, "  ?-> {}", (const void*)cell);
+                roots.set(cell);
+            } else {
+                dbgln_if(HEAP_DEBUG, "  #-> {}", (const void*)cell);
+            }
+        }
+    };
 
     auto* raw_jmp_buf = reinterpret_cast<FlatPtr const*>(buf);
 
-    for (size_t i = 0; i < ((size_t)sizeof(buf)) / sizeof(FlatPtr); i += sizeof(FlatPtr))
-        possible_pointers.set(raw_jmp_buf[i]);
+    for (size_t i = 0; i < ((size_t)sizeof(buf)) / sizeof(FlatPtr); ++i)
+        add_possible_pointer(raw_jmp_buf[i]);
 
     auto stack_reference = bit_cast<FlatPtr>(&dummy);
     auto& stack_info = m_vm.stack_info();
 
-    for (FlatPtr stack_address = stack_reference; stack_address < stack_info.top(); stack_address += sizeof(FlatPtr)) {
-        auto data = *reinterpret_cast<FlatPtr*>(stack_address);
-        possible_pointers.set(data);
-    }
-
-    HashTable<HeapBlock*> all_live_heap_blocks;
-    for_each_block([&](auto& block) {
-        all_live_heap_blocks.set(&block);
-        return IterationDecision::Continue;
-    });
-
-    for (auto possible_pointer : possible_pointers) {
-        if (!possible_pointer)
-            continue;
-        dbgln_if(HEAP_DEBUG, "  ? {}", (const void*)possible_pointer);
-        auto* possible_heap_block = HeapBlock::from_cell(reinterpret_cast<const Cell*>(possible_pointer));
-        if (all_live_heap_blocks.contains(possible_heap_block)) {
-            if (auto* cell = possible_heap_block->cell_from_possible_pointer(possible_pointer)) {
-                if (cell->state() == Cell::State::Live) {
-                    dbgln_if(HEAP_DEBUG, "  ?-> {}", (const void*)cell);
-                    roots.set(cell);
-                } else {
-                    dbgln_if(HEAP_DEBUG, "  #-> {}", (const void*)cell);
-                }
-            }
-        }
-    }
+    for (FlatPtr stack_address = stack_reference; stack_address < stack_info.top(); stack_address += sizeof(FlatPtr))
+        add_possible_pointer(*reinterpret_cast<FlatPtr*>(stack_address));
 }
 
 class MarkingVisitor final : public Cell::Visitor {
@@ -198,8 +212,19 @@ public:
 #endif
 
         cell.set_marked(true);
-        cell.visit_edges(*this);
+        m_work_queue.append(&cell);
+    }
+
+    // Edges are visited from a work queue rather than recursively, since some object graphs (like long chains of
+    // rope strings) are deep enough to run us out of stack space.
+    void mark_all_live_cells()
+    {
+        while (!m_work_queue.is_empty())
+            m_work_queue.take_last()->visit_edges(*this);
     }
+
+private:
+    Vector<Cell*> m_work_queue;
 };
 
 void Heap::mark_live_cells(const HashTable<Cell*>& roots)
@@ -209,6 +234,7 @@ void Heap::mark_live_cells(const HashTable<Cell*>& roots)
     MarkingVisitor visitor;
     for (auto* root : roots)
         visitor.visit(root);
+    visitor.mark_all_live_cells();
 
     for (auto& inverse_root : m_uprooted_cells)
         inverse_root->set_marked(false);
@@ -216,61 +242,78 @@ void Heap::mark_live_cells(const HashTable<Cell*>& roots)
     m_uprooted_cells.clear();
 }
 
-void Heap::sweep_dead_cells(bool print_report, const Core::ElapsedTimer& measurement_timer)
+void Heap::prepare_blocks_for_sweep()
 {
-    dbgln_if(HEAP_DEBUG, "sweep_dead_cells:");
-    Vector<HeapBlock*, 32> empty_blocks;
-    Vector<HeapBlock*, 32> full_blocks_that_became_usable;
-
-    size_t collected_cells = 0;
-    size_t live_cells = 0;
-    size_t collected_cell_bytes = 0;
-    size_t live_cell_bytes = 0;
-
-    for_each_block([&](auto& block) {
-        bool block_has_live_cells = false;
-        bool block_was_full = block.is_full();
-        block.template for_each_cell_in_state<Cell::State::Live>([&](Cell* cell) {
-            if (!cell->is_marked()) {
-                dbgln_if(HEAP_DEBUG, "  ~ {}", cell);
+    for (auto& allocator : m_allocators)
+        m_blocks_awaiting_sweep += allocator->prepare_blocks_for_sweep({});
+
+    // Every cell is now either marked or pending destruction, so weak containers can let go of the dead ones
+    // right away, before anything gets a chance to look them up. Some of them deregister themselves while at it.
+    for (auto it = m_weak_containers.begin(); it != m_weak_containers.end();) {
+        auto& weak_container = *it;
+        ++it;
+        weak_container.remove_dead_cells({});
+    }
+}
+
+void Heap::sweep_block(HeapBlock& block, SweepStatistics& statistics)
+{
+    VERIFY(block.is_awaiting_sweep());
+
+    bool block_has_live_cells = false;
+    block.for_each_cell_in_state<Cell::State::Live>([&](Cell* cell) {
+        if (!cell->is_marked()) {
+            dbgln_if(HEAP_DEBUG, "  ~ {}", cell);
 #ifdef JS_TRACK_ZOMBIE_CELLS
-                if (m_zombify_dead_cells) {
-                    cell->set_state(Cell::State::Zombie);
-                    cell->did_become_zombie();
-                } else {
+            if (m_zombify_dead_cells) {
+                cell->set_state(Cell::State::Zombie);
+                cell->did_become_zombie();
+            } else {
 #endif
-                    block.deallocate(cell);
+                block.deallocate(cell);
 #ifdef JS_TRACK_ZOMBIE_CELLS
-                }
-#endif
-                ++collected_cells;
-                collected_cell_bytes += block.cell_size();
-            } else {
-                cell->set_marked(false);
-                block_has_live_cells = true;
-                ++live_cells;
-                live_cell_bytes += block.cell_size();
             }
-        });
-        if (!block_has_live_cells)
-            empty_blocks.append(&block);
-        else if (block_was_full != block.is_full())
-            full_blocks_that_became_usable.append(&block);
-        return IterationDecision::Continue;
+#endif
+            ++statistics.collected_cells;
+            statistics.collected_cell_bytes += block.cell_size();
+        } else {
+            cell->set_marked(false);
+            block_has_live_cells = true;
+            ++statistics.live_cells;
+            statistics.live_cell_bytes += block.cell_size();
+        }
     });
 
-    for (auto& weak_container : m_weak_containers)
-        weak_container.remove_dead_cells({});
+    if (!block_has_live_cells) {
+        dbgln_if(HEAP_DEBUG, " - HeapBlock empty @ {}: cell_size={}", &block, block.cell_size());
+        ++statistics.freed_blocks;
+    }
+
+    --m_blocks_awaiting_sweep;
+    allocator_for_size(block.cell_size()).block_was_swept({}, block, block_has_live_cells);
+}
 
-    for (auto* block : empty_blocks) {
-        dbgln_if(HEAP_DEBUG, " - HeapBlock empty @ {}: cell_size={}", block, block->cell_size());
-        allocator_for_size(block->cell_size()).block_did_become_empty({}, *block);
+void Heap::sweep_next_block()
+{
+    for (auto& allocator : m_allocators) {
+        if (auto* block = allocator->first_block_awaiting_sweep()) {
+            SweepStatistics statistics;
+            sweep_block(*block, statistics);
+            return;
+        }
     }
+}
 
-    for (auto* block : full_blocks_that_became_usable) {
-        dbgln_if(HEAP_DEBUG, " - HeapBlock usable again @ {}: cell_size={}", block, block->cell_size());
-        allocator_for_size(block->cell_size()).block_did_become_usable({}, *block);
+void Heap::sweep_dead_cells(bool print_report, const Core::ElapsedTimer& measurement_timer)
+{
+    dbgln_if(HEAP_DEBUG, "sweep_dead_cells:");
+
+    SweepStatistics statistics;
+    for (auto& allocator : m_allocators) {
+        while (auto* block = allocator->first_block_awaiting_sweep())
+            sweep_block(*block, statistics);
     }
+    VERIFY(!m_blocks_awaiting_sweep);
 
     if constexpr (HEAP_DEBUG) {
         for_each_block([&](auto& block) {
@@ -291,10 +334,10 @@ void Heap::sweep_dead_cells(bool print_report, const Core::ElapsedTimer& measure
         dbgln("Garbage collection report");
         dbgln("=============================================");
         dbgln("     Time spent: {} ms", time_spent);
-        dbgln("     Live cells: {} ({} bytes)", live_cells, live_cell_bytes);
-        dbgln("Collected cells: {} ({} bytes)", collected_cells, collected_cell_bytes);
+        dbgln("     Live cells: {} ({} bytes)", statistics.live_cells, statistics.live_cell_bytes);
+        dbgln("Collected cells: {} ({} bytes)", statistics.collected_cells, statistics.collected_cell_bytes);
         dbgln("    Live blocks: {} ({} bytes)", live_block_count, live_block_count * HeapBlock::block_size);
-        dbgln("   Freed blocks: {} ({} bytes)", empty_blocks.size(), empty_blocks.size() * HeapBlock::block_size);
+        dbgln("   Freed blocks: {} ({} bytes)", statistics.freed_blocks, statistics.freed_blocks * HeapBlock::block_size);
         dbgln("=============================================");
     }
 }
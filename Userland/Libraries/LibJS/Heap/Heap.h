@@ -95,7 +95,18 @@ private:
     void gather_roots(HashTable<Cell*>&);
     void gather_conservative_roots(HashTable<Cell*>&);
     void mark_live_cells(const HashTable<Cell*>& live_cells);
+    void prepare_blocks_for_sweep();
     void sweep_dead_cells(bool print_report, const Core::ElapsedTimer&);
+    void sweep_next_block();
+
+    struct SweepStatistics {
+        size_t collected_cells { 0 };
+        size_t collected_cell_bytes { 0 };
+        size_t live_cells { 0 };
+        size_t live_cell_bytes { 0 };
+        size_t freed_blocks { 0 };
+    };
+    void sweep_block(HeapBlock&, SweepStatistics&);
 
     CellAllocator& allocator_for_size(size_t);
 
@@ -128,6 +139,8 @@ private:
 
     BlockAllocator m_block_allocator;
 
+    size_t m_blocks_awaiting_sweep { 0 };
+
     size_t m_gc_deferrals { 0 };
     bool m_should_gc_when_deferral_ends { false };
 
@@ -30,6 +30,10 @@ public:
     size_t cell_count() const { return (block_size - sizeof(HeapBlock)) / m_cell_size; }
     bool is_full() const { return !has_lazy_freelist() && !m_freelist; }
 
+    // Set from the end of a garbage collection's marking phase until the block's unmarked cells have been swept.
+    bool is_awaiting_sweep() const { return m_awaiting_sweep; }
+    void set_awaiting_sweep(bool awaiting_sweep) { m_awaiting_sweep = awaiting_sweep; }
+
     ALWAYS_INLINE Cell* allocate()
     {
         Cell* allocated_cell = nullptr;
@@ -110,6 +114,7 @@ private:
     size_t m_cell_size { 0 };
     size_t m_next_lazy_freelist_index { 0 };
     FreelistEntry* m_freelist { nullptr };
+    bool m_awaiting_sweep { false };
     alignas(Cell) u8 m_storage[];
 
 public:
@@ -643,18 +643,26 @@ Token Lexer::next()
     } else if (auto code_point = is_identifier_start(identifier_length); code_point.has_value()) {
         bool has_escaped_character = false;
         // identifier or keyword
+        // Unless it contains escape sequences, an identifier is just a slice of the source, so we only
+        // build it up separately once we see the first escaped character.
         StringBuilder builder;
         do {
-            builder.append_code_point(*code_point);
+            if (!has_escaped_character && identifier_length > 1) {
+                has_escaped_character = true;
+                builder.append(m_source.substring_view(value_start - 1, m_position - value_start));
+            }
+            if (has_escaped_character)
+                builder.append_code_point(*code_point);
             for (size_t i = 0; i < identifier_length; ++i)
                 consume();
 
-            has_escaped_character |= identifier_length > 1;
-
             code_point = is_identifier_middle(identifier_length);
         } while (code_point.has_value());
 
-        identifier = builder.string_view();
+        if (has_escaped_character)
+            identifier = builder.string_view();
+        else
+            identifier = m_source.substring_view(value_start - 1, m_position - value_start);
         m_parsed_identifiers->identifiers.set(*identifier);
 
         auto it = s_keywords.find(identifier->hash(), [&](auto& entry) { return entry.key == identifier; });
@@ -1489,13 +1489,14 @@ NonnullRefPtr<RegExpLiteral> Parser::parse_regexp_literal()
     }
 
     auto parsed_pattern = parse_regex_pattern(pattern, parsed_flags.has_flag_set(ECMAScriptFlags::Unicode));
-    auto parsed_regex = Regex<ECMA262>::parse_pattern(parsed_pattern, parsed_flags);
+    // NOTE: Compiling through the cache means evaluating the literal later on doesn't have to compile it again.
+    auto parsed_regex = Regex<ECMA262>::compile_cached(parsed_pattern, parsed_flags);
 
-    if (parsed_regex.error != regex::Error::NoError)
-        syntax_error(String::formatted("RegExp compile error: {}", Regex<ECMA262>(parsed_regex, parsed_pattern, parsed_flags).error_string()), rule_start.position());
+    if (parsed_regex.parser_result.error != regex::Error::NoError)
+        syntax_error(String::formatted("RegExp compile error: {}", parsed_regex.error_string()), rule_start.position());
 
     SourceRange range { m_state.current_token.filename(), rule_start.position(), position() };
-    return create_ast_node<RegExpLiteral>(move(range), move(parsed_regex), move(parsed_pattern), move(parsed_flags), pattern.to_string(), move(flags));
+    return create_ast_node<RegExpLiteral>(move(range), move(parsed_regex.parser_result), move(parsed_pattern), move(parsed_flags), pattern.to_string(), move(flags));
 }
 
 NonnullRefPtr<Expression> Parser::parse_unary_prefixed_expression()
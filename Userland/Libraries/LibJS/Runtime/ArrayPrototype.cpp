@@ -9,6 +9,7 @@
 
 #include <AK/Function.h>
 #include <AK/HashTable.h>
+#include <AK/MergeSort.h>
 #include <AK/ScopeGuard.h>
 #include <AK/StringBuilder.h>
 #include <LibJS/Runtime/AbstractOperations.h>
@@ -28,6 +29,21 @@ namespace JS {
 
 static HashTable<Object*> s_array_join_seen_objects;
 
+// Elements in anything but generic storage have the default attributes, so when an ordinary array has one at an index
+// that isn't an accessor, it's exactly what HasProperty() and Get() would find. A missing element may still be inherited.
+static Optional<Value> fast_array_element(Object const& object, size_t index)
+{
+    if (!is<Array>(object) || index > NumericLimits<u32>::max())
+        return {};
+    auto const& indexed_properties = object.indexed_properties();
+    if (indexed_properties.is_generic_storage())
+        return {};
+    auto element = indexed_properties.get(index);
+    if (!element.has_value() || element->value.is_accessor())
+        return {};
+    return element->value;
+}
+
 ArrayPrototype::ArrayPrototype(GlobalObject& global_object)
     : Array(*global_object.object_prototype())
 {
@@ -224,6 +240,11 @@ JS_DEFINE_NATIVE_FUNCTION(ArrayPrototype::for_each)
     // 4. Let k be 0.
     // 5. Repeat, while k < len,
     for (size_t k = 0; k < length; ++k) {
+        if (auto k_value = fast_array_element(*object, k); k_value.has_value()) {
+            TRY(vm.call(callback_function.as_function(), this_arg, *k_value, Value(k), object));
+            continue;
+        }
+
         // a. Let Pk be ! ToString(𝔽(k)).
         auto property_name = PropertyKey { k };
 
@@ -271,14 +292,22 @@ JS_DEFINE_NATIVE_FUNCTION(ArrayPrototype::map)
         // a. Let Pk be ! ToString(𝔽(k)).
         auto property_name = PropertyKey { k };
 
-        // b. Let kPresent be ? HasProperty(O, Pk).
-        auto k_present = TRY(object->has_property(property_name));
+        Value k_value;
+        if (auto fast_k_value = fast_array_element(*object, k); fast_k_value.has_value()) {
+            k_value = *fast_k_value;
+        } else {
+            // b. Let kPresent be ? HasProperty(O, Pk).
+            auto k_present = TRY(object->has_property(property_name));
+
+            // c. If kPresent is true, then
+            if (!k_present)
+                continue;
 
-        // c. If kPresent is true, then
-        if (k_present) {
             // i. Let kValue be ? Get(O, Pk).
-            auto k_value = TRY(object->get(property_name));
+            k_value = TRY(object->get(property_name));
+        }
 
+        {
             // ii. Let mappedValue be ? Call(callbackfn, thisArg, « kValue, 𝔽(k), O »).
             auto mapped_value = TRY(vm.call(callback_function.as_function(), this_arg, k_value, Value(k), object));
 
@@ -640,10 +669,37 @@ JS_DEFINE_NATIVE_FUNCTION(ArrayPrototype::index_of)
         k = max(length + n, 0);
     }
 
+    // Fast path: all elements of packed storage are present, and comparing numbers has no side effects. Whatever lies
+    // beyond the packed elements (if the array shrank while converting fromIndex) is left to the loop below.
+    if (is<Array>(*object)) {
+        Optional<size_t> found_index;
+        object->indexed_properties().with_packed_elements([&](auto elements) {
+            auto end = min(length, elements.size());
+            if (search_element.is_number()) {
+                auto search_number = search_element.as_double();
+                for (; k < end; ++k) {
+                    if (elements[k] == search_number) {
+                        found_index = k;
+                        return;
+                    }
+                }
+            }
+            k = max(k, end);
+        });
+        if (found_index.has_value())
+            return Value(*found_index);
+    }
+
     // 10. Repeat, while k < len,
     for (; k < length; ++k) {
         auto property_name = PropertyKey { k };
 
+        if (auto element_k = fast_array_element(*object, k); element_k.has_value()) {
+            if (is_strictly_equal(search_element, *element_k))
+                return Value(k);
+            continue;
+        }
+
         // a. Let kPresent be ? HasProperty(O, ! ToString(𝔽(k))).
         auto k_present = TRY(object->has_property(property_name));
 
@@ -866,6 +922,20 @@ JS_DEFINE_NATIVE_FUNCTION(ArrayPrototype::reverse)
     return this_object;
 }
 
+// The representation of an integer that SortCompare compares when there's no comparator, without allocating a String.
+static StringView int32_to_decimal_string(i32 value, char (&buffer)[11])
+{
+    auto magnitude = value < 0 ? static_cast<u32>(-static_cast<i64>(value)) : static_cast<u32>(value);
+    size_t position = sizeof(buffer);
+    do {
+        buffer[--position] = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while (magnitude);
+    if (value < 0)
+        buffer[--position] = '-';
+    return { buffer + position, sizeof(buffer) - position };
+}
+
 static ThrowCompletionOr<void> array_merge_sort(VM& vm, GlobalObject& global_object, FunctionObject* compare_func, MarkedValueList& arr_to_sort)
 {
     // FIXME: it would probably be better to switch to insertion sort for small arrays for
@@ -974,8 +1044,35 @@ JS_DEFINE_NATIVE_FUNCTION(ArrayPrototype::sort)
 
     auto length = TRY(length_of_array_like(global_object, *object));
 
+    // Fast path: without a comparator, the elements of a packed int32 array can be put in order by comparing their
+    // decimal representations directly. There are no holes and no undefineds to move to the end either.
+    if (callback.is_undefined() && is<Array>(*object)) {
+        Vector<i32> int32_items;
+        object->indexed_properties().with_packed_elements([&]<typename T>(Span<T const> elements) {
+            if constexpr (IsSame<T, i32>) {
+                if (elements.size() == length)
+                    int32_items.append(elements.data(), elements.size());
+            }
+        });
+        if (int32_items.size() == length && length > 0) {
+            merge_sort(int32_items, [](i32 a, i32 b) {
+                char a_buffer[11];
+                char b_buffer[11];
+                return int32_to_decimal_string(a, a_buffer) < int32_to_decimal_string(b, b_buffer);
+            });
+            for (size_t j = 0; j < int32_items.size(); ++j)
+                TRY(object->set(j, Value(int32_items[j]), Object::ShouldThrowExceptions::Yes));
+            return object;
+        }
+    }
+
     MarkedValueList items(vm.heap());
     for (size_t k = 0; k < length; ++k) {
+        if (auto k_value = fast_array_element(*object, k); k_value.has_value()) {
+            items.append(*k_value);
+            continue;
+        }
+
         auto k_present = TRY(object->has_property(k));
 
         if (k_present) {
@@ -44,9 +44,13 @@ bool FinalizationRegistry::remove_by_token(Object& unregister_token)
 
 void FinalizationRegistry::remove_dead_cells(Badge<Heap>)
 {
+    // A registry that is itself about to be swept has nobody left to run its cleanup callback for.
+    if (is_pending_destruction())
+        return;
+
     auto any_cells_were_removed = false;
     for (auto& record : m_records) {
-        if (!record.target || record.target->state() == Cell::State::Live)
+        if (!record.target || !record.target->is_pending_destruction())
             continue;
         record.target = nullptr;
         any_cells_were_removed = true;
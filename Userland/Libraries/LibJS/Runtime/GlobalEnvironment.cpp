@@ -146,7 +146,7 @@ ThrowCompletionOr<bool> GlobalEnvironment::delete_binding(GlobalObject& global_o
         if (status) {
             // i. Let varNames be envRec.[[VarNames]].
             // ii. If N is an element of varNames, remove that element from the varNames.
-            m_var_names.remove_all_matching([&](auto& entry) { return entry == name; });
+            m_var_names.remove(name);
         }
 
         // c. Return status.
@@ -163,7 +163,7 @@ bool GlobalEnvironment::has_var_declaration(FlyString const& name) const
     // 1. Let varDeclaredNames be envRec.[[VarNames]].
     // 2. If varDeclaredNames contains N, return true.
     // 3. Return false.
-    return m_var_names.contains_slow(name);
+    return m_var_names.contains(name);
 }
 
 // 9.1.1.4.13 HasLexicalDeclaration ( N ), https://tc39.es/ecma262/#sec-haslexicaldeclaration
@@ -264,9 +264,9 @@ ThrowCompletionOr<void> GlobalEnvironment::create_global_var_binding(FlyString c
 
     // 6. Let varDeclaredNames be envRec.[[VarNames]].
     // 7. If varDeclaredNames does not contain N, then
-    if (!m_var_names.contains_slow(name)) {
+    if (!m_var_names.contains(name)) {
         // a. Append N to varDeclaredNames.
-        m_var_names.append(name);
+        m_var_names.set(name);
     }
 
     // 8. Return NormalCompletion(empty).
@@ -304,9 +304,9 @@ ThrowCompletionOr<void> GlobalEnvironment::create_global_function_binding(FlyStr
 
     // 8. Let varDeclaredNames be envRec.[[VarNames]].
     // 9. If varDeclaredNames does not contain N, then
-    if (!m_var_names.contains_slow(name)) {
+    if (!m_var_names.contains(name)) {
         // a. Append N to varDeclaredNames.
-        m_var_names.append(name);
+        m_var_names.set(name);
     }
 
     // 10. Return NormalCompletion(empty).
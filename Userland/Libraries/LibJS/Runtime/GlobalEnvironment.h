@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/HashTable.h>
 #include <LibJS/Runtime/Environment.h>
 
 namespace JS {
@@ -46,7 +47,7 @@ private:
     ObjectEnvironment* m_object_record { nullptr };           // [[ObjectRecord]]
     Object* m_global_this_value { nullptr };                  // [[GlobalThisValue]]
     DeclarativeEnvironment* m_declarative_record { nullptr }; // [[DeclarativeRecord]]
-    Vector<FlyString> m_var_names;                            // [[VarNames]]
+    HashTable<FlyString> m_var_names;                         // [[VarNames]]
 };
 
 template<>
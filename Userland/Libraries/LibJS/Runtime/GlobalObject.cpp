@@ -336,6 +336,8 @@ void GlobalObject::visit_edges(Visitor& visitor)
 
 Realm* GlobalObject::associated_realm()
 {
+    if (m_associated_realm && m_associated_realm->is_pending_destruction())
+        return nullptr;
     return m_associated_realm;
 }
 
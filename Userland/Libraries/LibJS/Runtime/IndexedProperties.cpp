@@ -13,8 +13,96 @@ namespace JS {
 constexpr const size_t SPARSE_ARRAY_HOLE_THRESHOLD = 200;
 constexpr const size_t LENGTH_SETTER_GENERIC_STORAGE_THRESHOLD = 4 * MiB;
 
+template<typename T>
+PackedIndexedPropertyStorage<T>::PackedIndexedPropertyStorage()
+    : IndexedPropertyStorage(IsSame<T, i32> ? Kind::PackedInt32 : Kind::PackedDouble)
+{
+}
+
+template<typename T>
+PackedIndexedPropertyStorage<T>::PackedIndexedPropertyStorage(Vector<T>&& initial_elements)
+    : IndexedPropertyStorage(IsSame<T, i32> ? Kind::PackedInt32 : Kind::PackedDouble)
+    , m_elements(move(initial_elements))
+{
+}
+
+template<>
+bool PackedIndexedPropertyStorage<i32>::can_hold(Value value)
+{
+    return value.type() == Value::Type::Int32;
+}
+
+template<>
+bool PackedIndexedPropertyStorage<double>::can_hold(Value value)
+{
+    return value.is_number();
+}
+
+template<typename T>
+Optional<ValueAndAttributes> PackedIndexedPropertyStorage<T>::get(u32 index) const
+{
+    if (!has_index(index))
+        return {};
+    return ValueAndAttributes { Value(m_elements[index]), default_attributes };
+}
+
+template<typename T>
+void PackedIndexedPropertyStorage<T>::put(u32 index, Value value, PropertyAttributes attributes)
+{
+    VERIFY(attributes == default_attributes);
+    VERIFY(can_put(index, value));
+
+    T element;
+    if constexpr (IsSame<T, i32>)
+        element = value.as_i32();
+    else
+        element = value.as_double();
+
+    if (index == m_elements.size())
+        m_elements.append(element);
+    else
+        m_elements[index] = element;
+}
+
+template<typename T>
+void PackedIndexedPropertyStorage<T>::remove(u32)
+{
+    // Removing an element would leave a hole, so IndexedProperties moves to simple storage first.
+    VERIFY_NOT_REACHED();
+}
+
+template<typename T>
+ValueAndAttributes PackedIndexedPropertyStorage<T>::take_first()
+{
+    return { Value(m_elements.take_first()), default_attributes };
+}
+
+template<typename T>
+ValueAndAttributes PackedIndexedPropertyStorage<T>::take_last()
+{
+    return { Value(m_elements.take_last()), default_attributes };
+}
+
+template<typename T>
+bool PackedIndexedPropertyStorage<T>::set_array_like_size(size_t new_size)
+{
+    // Growing would leave holes, so IndexedProperties moves to simple storage first.
+    VERIFY(new_size <= m_elements.size());
+    m_elements.shrink(new_size);
+    return true;
+}
+
+template class PackedIndexedPropertyStorage<i32>;
+template class PackedIndexedPropertyStorage<double>;
+
+SimpleIndexedPropertyStorage::SimpleIndexedPropertyStorage()
+    : IndexedPropertyStorage(Kind::Simple)
+{
+}
+
 SimpleIndexedPropertyStorage::SimpleIndexedPropertyStorage(Vector<Value>&& initial_values)
-    : m_array_size(initial_values.size())
+    : IndexedPropertyStorage(Kind::Simple)
+    , m_array_size(initial_values.size())
     , m_packed_elements(move(initial_values))
 {
 }
@@ -78,6 +166,7 @@ bool SimpleIndexedPropertyStorage::set_array_like_size(size_t new_size)
 }
 
 GenericIndexedPropertyStorage::GenericIndexedPropertyStorage(SimpleIndexedPropertyStorage&& storage)
+    : IndexedPropertyStorage(Kind::Generic)
 {
     m_array_size = storage.array_like_size();
     for (size_t i = 0; i < storage.m_packed_elements.size(); ++i) {
@@ -213,6 +302,32 @@ void IndexedPropertyIterator::skip_empty_indices()
     m_index = m_indexed_properties.array_like_size();
 }
 
+IndexedProperties::IndexedProperties(Vector<Value> values)
+{
+    bool all_int32 = true;
+    bool all_numbers = true;
+    for (auto& value : values) {
+        all_int32 = all_int32 && PackedInt32IndexedPropertyStorage::can_hold(value);
+        all_numbers = all_numbers && PackedDoubleIndexedPropertyStorage::can_hold(value);
+    }
+
+    if (all_int32) {
+        Vector<i32> elements;
+        elements.ensure_capacity(values.size());
+        for (auto& value : values)
+            elements.unchecked_append(value.as_i32());
+        m_storage = make<PackedInt32IndexedPropertyStorage>(move(elements));
+    } else if (all_numbers) {
+        Vector<double> elements;
+        elements.ensure_capacity(values.size());
+        for (auto& value : values)
+            elements.unchecked_append(value.as_double());
+        m_storage = make<PackedDoubleIndexedPropertyStorage>(move(elements));
+    } else {
+        m_storage = make<SimpleIndexedPropertyStorage>(move(values));
+    }
+}
+
 Optional<ValueAndAttributes> IndexedProperties::get(u32 index) const
 {
     return m_storage->get(index);
@@ -220,8 +335,10 @@ Optional<ValueAndAttributes> IndexedProperties::get(u32 index) const
 
 void IndexedProperties::put(u32 index, Value value, PropertyAttributes attributes)
 {
-    if (m_storage->is_simple_storage() && (attributes != default_attributes || index > (array_like_size() + SPARSE_ARRAY_HOLE_THRESHOLD))) {
+    if (!m_storage->is_generic_storage() && (attributes != default_attributes || index > (array_like_size() + SPARSE_ARRAY_HOLE_THRESHOLD))) {
         switch_to_generic_storage();
+    } else {
+        unpack_storage_if_needed(index, value);
     }
 
     m_storage->put(index, value, attributes);
@@ -230,6 +347,8 @@ void IndexedProperties::put(u32 index, Value value, PropertyAttributes attribute
 void IndexedProperties::remove(u32 index)
 {
     VERIFY(m_storage->has_index(index));
+    if (m_storage->is_packed_storage())
+        switch_to_simple_storage();
     m_storage->remove(index);
 }
 
@@ -237,10 +356,13 @@ bool IndexedProperties::set_array_like_size(size_t new_size)
 {
     auto current_array_like_size = array_like_size();
 
+    if (m_storage->is_packed_storage() && new_size > current_array_like_size)
+        switch_to_simple_storage();
+
     // We can't use simple storage for lengths that don't fit in an i32.
     // Also, to avoid gigantic unused storage allocations, let's put an (arbitrary) 4M cap on simple storage here.
     // This prevents something like "a = []; a.length = 0x80000000;" from allocating 2G entries.
-    if (m_storage->is_simple_storage()
+    if (!m_storage->is_generic_storage()
         && (new_size > NumericLimits<i32>::max()
             || (current_array_like_size < LENGTH_SETTER_GENERIC_STORAGE_THRESHOLD && new_size > LENGTH_SETTER_GENERIC_STORAGE_THRESHOLD))) {
         switch_to_generic_storage();
@@ -251,6 +373,8 @@ bool IndexedProperties::set_array_like_size(size_t new_size)
 
 size_t IndexedProperties::real_size() const
 {
+    if (m_storage->is_packed_storage())
+        return m_storage->size();
     if (m_storage->is_simple_storage()) {
         auto& packed_elements = static_cast<const SimpleIndexedPropertyStorage&>(*m_storage).elements();
         size_t size = 0;
@@ -265,6 +389,13 @@ size_t IndexedProperties::real_size() const
 
 Vector<u32> IndexedProperties::indices() const
 {
+    if (m_storage->is_packed_storage()) {
+        Vector<u32> indices;
+        indices.ensure_capacity(m_storage->size());
+        for (size_t i = 0; i < m_storage->size(); ++i)
+            indices.unchecked_append(i);
+        return indices;
+    }
     if (m_storage->is_simple_storage()) {
         const auto& storage = static_cast<const SimpleIndexedPropertyStorage&>(*m_storage);
         const auto& elements = storage.elements();
@@ -282,8 +413,52 @@ Vector<u32> IndexedProperties::indices() const
     return indices;
 }
 
+void IndexedProperties::unpack_storage_if_needed(u32 index, Value value)
+{
+    switch (m_storage->kind()) {
+    case IndexedPropertyStorage::Kind::PackedInt32:
+        if (static_cast<PackedInt32IndexedPropertyStorage const&>(*m_storage).can_put(index, value))
+            return;
+        if (index > m_storage->size() || !PackedDoubleIndexedPropertyStorage::can_hold(value)) {
+            switch_to_simple_storage();
+            return;
+        }
+        switch_to_packed_double_storage();
+        return;
+    case IndexedPropertyStorage::Kind::PackedDouble:
+        if (!static_cast<PackedDoubleIndexedPropertyStorage const&>(*m_storage).can_put(index, value))
+            switch_to_simple_storage();
+        return;
+    default:
+        return;
+    }
+}
+
+void IndexedProperties::switch_to_packed_double_storage()
+{
+    auto const& int32_elements = static_cast<PackedInt32IndexedPropertyStorage const&>(*m_storage).elements();
+    Vector<double> elements;
+    elements.ensure_capacity(int32_elements.size());
+    for (auto element : int32_elements)
+        elements.unchecked_append(element);
+    m_storage = make<PackedDoubleIndexedPropertyStorage>(move(elements));
+}
+
+void IndexedProperties::switch_to_simple_storage()
+{
+    Vector<Value> values;
+    values.ensure_capacity(m_storage->size());
+    with_packed_elements([&](auto elements) {
+        for (auto element : elements)
+            values.unchecked_append(Value(element));
+    });
+    m_storage = make<SimpleIndexedPropertyStorage>(move(values));
+}
+
 void IndexedProperties::switch_to_generic_storage()
 {
+    if (m_storage->is_packed_storage())
+        switch_to_simple_storage();
     auto& storage = static_cast<SimpleIndexedPropertyStorage&>(*m_storage);
     m_storage = make<GenericIndexedPropertyStorage>(move(storage));
 }
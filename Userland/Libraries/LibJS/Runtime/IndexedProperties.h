@@ -7,6 +7,7 @@
 #pragma once
 
 #include <AK/NonnullOwnPtr.h>
+#include <AK/Span.h>
 #include <LibJS/Runtime/Shape.h>
 #include <LibJS/Runtime/Value.h>
 
@@ -23,6 +24,14 @@ class GenericIndexedPropertyStorage;
 
 class IndexedPropertyStorage {
 public:
+    // Storage starts out as packed int32, and moves down this list as elements are put that it can't hold.
+    enum class Kind {
+        PackedInt32,
+        PackedDouble,
+        Simple,
+        Generic,
+    };
+
     virtual ~IndexedPropertyStorage() {};
 
     virtual bool has_index(u32 index) const = 0;
@@ -37,12 +46,56 @@ public:
     virtual size_t array_like_size() const = 0;
     virtual bool set_array_like_size(size_t new_size) = 0;
 
-    virtual bool is_simple_storage() const { return false; }
+    Kind kind() const { return m_kind; }
+    bool is_packed_storage() const { return m_kind == Kind::PackedInt32 || m_kind == Kind::PackedDouble; }
+    bool is_simple_storage() const { return m_kind == Kind::Simple; }
+    bool is_generic_storage() const { return m_kind == Kind::Generic; }
+
+protected:
+    explicit IndexedPropertyStorage(Kind kind)
+        : m_kind(kind)
+    {
+    }
+
+private:
+    Kind m_kind;
 };
 
+// Storage for elements that are all int32 (or all numbers, for double) and have no holes in between,
+// which is a lot more compact than storing a full Value for each of them.
+template<typename T>
+class PackedIndexedPropertyStorage final : public IndexedPropertyStorage {
+public:
+    PackedIndexedPropertyStorage();
+    explicit PackedIndexedPropertyStorage(Vector<T>&& initial_elements);
+
+    static bool can_hold(Value);
+    bool can_put(u32 index, Value value) const { return index <= m_elements.size() && can_hold(value); }
+
+    virtual bool has_index(u32 index) const override { return index < m_elements.size(); }
+    virtual Optional<ValueAndAttributes> get(u32 index) const override;
+    virtual void put(u32 index, Value value, PropertyAttributes attributes = default_attributes) override;
+    virtual void remove(u32 index) override;
+
+    virtual ValueAndAttributes take_first() override;
+    virtual ValueAndAttributes take_last() override;
+
+    virtual size_t size() const override { return m_elements.size(); }
+    virtual size_t array_like_size() const override { return m_elements.size(); }
+    virtual bool set_array_like_size(size_t new_size) override;
+
+    Vector<T> const& elements() const { return m_elements; }
+
+private:
+    Vector<T> m_elements;
+};
+
+using PackedInt32IndexedPropertyStorage = PackedIndexedPropertyStorage<i32>;
+using PackedDoubleIndexedPropertyStorage = PackedIndexedPropertyStorage<double>;
+
 class SimpleIndexedPropertyStorage final : public IndexedPropertyStorage {
 public:
-    SimpleIndexedPropertyStorage() = default;
+    SimpleIndexedPropertyStorage();
     explicit SimpleIndexedPropertyStorage(Vector<Value>&& initial_values);
 
     virtual bool has_index(u32 index) const override;
@@ -57,7 +110,6 @@ public:
     virtual size_t array_like_size() const override { return m_array_size; }
     virtual bool set_array_like_size(size_t new_size) override;
 
-    virtual bool is_simple_storage() const override { return true; }
     const Vector<Value>& elements() const { return m_packed_elements; }
 
 private:
@@ -113,11 +165,7 @@ private:
 class IndexedProperties {
 public:
     IndexedProperties() = default;
-
-    explicit IndexedProperties(Vector<Value> values)
-        : m_storage(make<SimpleIndexedPropertyStorage>(move(values)))
-    {
-    }
+    explicit IndexedProperties(Vector<Value> values);
 
     bool has_index(u32 index) const { return m_storage->has_index(index); }
     Optional<ValueAndAttributes> get(u32 index) const;
@@ -137,9 +185,32 @@ public:
 
     Vector<u32> indices() const;
 
+    bool is_generic_storage() const { return m_storage->is_generic_storage(); }
+
+    // Calls the callback with the elements of packed storage as a Span<i32 const> or Span<double const>.
+    // Returns false without calling it for other kinds of storage.
+    template<typename Callback>
+    bool with_packed_elements(Callback callback) const
+    {
+        switch (m_storage->kind()) {
+        case IndexedPropertyStorage::Kind::PackedInt32:
+            callback(static_cast<PackedInt32IndexedPropertyStorage const&>(*m_storage).elements().span());
+            return true;
+        case IndexedPropertyStorage::Kind::PackedDouble:
+            callback(static_cast<PackedDoubleIndexedPropertyStorage const&>(*m_storage).elements().span());
+            return true;
+        default:
+            return false;
+        }
+    }
+
     template<typename Callback>
     void for_each_value(Callback callback)
     {
+        if (m_storage->is_packed_storage()) {
+            // Numbers aren't cells, so there's nothing in here a visitor would care about.
+            return;
+        }
         if (m_storage->is_simple_storage()) {
             for (auto& value : static_cast<SimpleIndexedPropertyStorage&>(*m_storage).elements())
                 callback(value);
@@ -150,9 +221,12 @@ public:
     }
 
 private:
+    void unpack_storage_if_needed(u32 index, Value);
+    void switch_to_packed_double_storage();
+    void switch_to_simple_storage();
     void switch_to_generic_storage();
 
-    NonnullOwnPtr<IndexedPropertyStorage> m_storage { make<SimpleIndexedPropertyStorage>() };
+    NonnullOwnPtr<IndexedPropertyStorage> m_storage { make<PackedInt32IndexedPropertyStorage>() };
 };
 
 }
@@ -4,12 +4,16 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/CharacterTypes.h>
+#include <AK/FlyString.h>
 #include <AK/Function.h>
+#include <AK/HashMap.h>
 #include <AK/JsonArray.h>
 #include <AK/JsonObject.h>
-#include <AK/JsonParser.h>
 #include <AK/StringBuilder.h>
+#include <AK/Utf16View.h>
 #include <AK/Utf8View.h>
+#include <LibJS/Heap/DeferGC.h>
 #include <LibJS/Runtime/AbstractOperations.h>
 #include <LibJS/Runtime/Array.h>
 #include <LibJS/Runtime/BigIntObject.h>
@@ -103,7 +107,9 @@ ThrowCompletionOr<String> JSONObject::stringify_impl(GlobalObject& global_object
 
     auto* wrapper = Object::create(global_object, global_object.object_prototype());
     MUST(wrapper->create_data_property_or_throw(String::empty(), value));
-    return serialize_json_property(global_object, state, String::empty(), wrapper);
+    if (!TRY(serialize_json_property(global_object, state, String::empty(), wrapper)))
+        return String {};
+    return state.builder.to_string();
 }
 
 // 25.5.2 JSON.stringify ( value [ , replacer [ , space ] ] ), https://tc39.es/ecma262/#sec-json.stringify
@@ -124,7 +130,7 @@ JS_DEFINE_NATIVE_FUNCTION(JSONObject::stringify)
 }
 
 // 25.5.2.1 SerializeJSONProperty ( state, key, holder ), https://tc39.es/ecma262/#sec-serializejsonproperty
-ThrowCompletionOr<String> JSONObject::serialize_json_property(GlobalObject& global_object, StringifyState& state, const PropertyKey& key, Object* holder)
+ThrowCompletionOr<bool> JSONObject::serialize_json_property(GlobalObject& global_object, StringifyState& state, const PropertyKey& key, Object* holder)
 {
     auto& vm = global_object.vm();
     auto value = TRY(holder->get(key));
@@ -150,30 +156,40 @@ ThrowCompletionOr<String> JSONObject::serialize_json_property(GlobalObject& glob
             value = Value(&static_cast<BigIntObject&>(value_object).bigint());
     }
 
-    if (value.is_null())
-        return "null";
-    if (value.is_boolean())
-        return value.as_bool() ? "true" : "false";
-    if (value.is_string())
-        return quote_json_string(value.as_string().string());
+    if (value.is_null()) {
+        state.builder.append("null");
+        return true;
+    }
+    if (value.is_boolean()) {
+        state.builder.append(value.as_bool() ? "true" : "false");
+        return true;
+    }
+    if (value.is_string()) {
+        quote_json_string(state.builder, value.as_string().string());
+        return true;
+    }
     if (value.is_number()) {
         if (value.is_finite_number())
-            return MUST(value.to_string(global_object));
-        return "null";
+            state.builder.append(MUST(value.to_string(global_object)));
+        else
+            state.builder.append("null");
+        return true;
     }
     if (value.is_bigint())
         return vm.throw_completion<TypeError>(global_object, ErrorType::JsonBigInt);
     if (value.is_object() && !value.is_function()) {
         auto is_array = TRY(value.is_array(global_object));
         if (is_array)
-            return serialize_json_array(global_object, state, static_cast<Array&>(value.as_object()));
-        return serialize_json_object(global_object, state, value.as_object());
+            TRY(serialize_json_array(global_object, state, static_cast<Array&>(value.as_object())));
+        else
+            TRY(serialize_json_object(global_object, state, value.as_object()));
+        return true;
     }
-    return String {};
+    return false;
 }
 
 // 25.5.2.4 SerializeJSONObject ( state, value ), https://tc39.es/ecma262/#sec-serializejsonobject
-ThrowCompletionOr<String> JSONObject::serialize_json_object(GlobalObject& global_object, StringifyState& state, Object& object)
+ThrowCompletionOr<void> JSONObject::serialize_json_object(GlobalObject& global_object, StringifyState& state, Object& object)
 {
     auto& vm = global_object.vm();
     if (state.seen_objects.contains(&object))
@@ -182,19 +198,31 @@ ThrowCompletionOr<String> JSONObject::serialize_json_object(GlobalObject& global
     state.seen_objects.set(&object);
     String previous_indent = state.indent;
     state.indent = String::formatted("{}{}", state.indent, state.gap);
-    Vector<String> property_strings;
+    auto& builder = state.builder;
+    bool is_empty = true;
 
+    builder.append('{');
     auto process_property = [&](const PropertyKey& key) -> ThrowCompletionOr<void> {
         if (key.is_symbol())
             return {};
-        auto serialized_property_string = TRY(serialize_json_property(global_object, state, key, &object));
-        if (!serialized_property_string.is_null()) {
-            property_strings.append(String::formatted(
-                "{}:{}{}",
-                quote_json_string(key.to_string()),
-                state.gap.is_empty() ? "" : " ",
-                serialized_property_string));
+
+        // The key goes in first, and is taken back out if the value turns out to be one that isn't serialized.
+        auto length_before_property = builder.length();
+        if (!is_empty)
+            builder.append(',');
+        if (!state.gap.is_empty()) {
+            builder.append('\n');
+            builder.append(state.indent);
         }
+        quote_json_string(builder, key.to_string());
+        builder.append(':');
+        if (!state.gap.is_empty())
+            builder.append(' ');
+
+        if (TRY(serialize_json_property(global_object, state, key, &object)))
+            is_empty = false;
+        else
+            builder.trim(builder.length() - length_before_property);
         return {};
     };
 
@@ -207,42 +235,19 @@ ThrowCompletionOr<String> JSONObject::serialize_json_object(GlobalObject& global
         for (auto& property : property_list)
             TRY(process_property(property.as_string().string()));
     }
-    StringBuilder builder;
-    if (property_strings.is_empty()) {
-        builder.append("{}");
-    } else {
-        bool first = true;
-        builder.append('{');
-        if (state.gap.is_empty()) {
-            for (auto& property_string : property_strings) {
-                if (!first)
-                    builder.append(',');
-                first = false;
-                builder.append(property_string);
-            }
-        } else {
-            builder.append('\n');
-            builder.append(state.indent);
-            auto separator = String::formatted(",\n{}", state.indent);
-            for (auto& property_string : property_strings) {
-                if (!first)
-                    builder.append(separator);
-                first = false;
-                builder.append(property_string);
-            }
-            builder.append('\n');
-            builder.append(previous_indent);
-        }
-        builder.append('}');
+    if (!is_empty && !state.gap.is_empty()) {
+        builder.append('\n');
+        builder.append(previous_indent);
     }
+    builder.append('}');
 
     state.seen_objects.remove(&object);
     state.indent = previous_indent;
-    return builder.to_string();
+    return {};
 }
 
 // 25.5.2.5 SerializeJSONArray ( state, value ), https://tc39.es/ecma262/#sec-serializejsonarray
-ThrowCompletionOr<String> JSONObject::serialize_json_array(GlobalObject& global_object, StringifyState& state, Object& object)
+ThrowCompletionOr<void> JSONObject::serialize_json_array(GlobalObject& global_object, StringifyState& state, Object& object)
 {
     auto& vm = global_object.vm();
     if (state.seen_objects.contains(&object))
@@ -251,63 +256,36 @@ ThrowCompletionOr<String> JSONObject::serialize_json_array(GlobalObject& global_
     state.seen_objects.set(&object);
     String previous_indent = state.indent;
     state.indent = String::formatted("{}{}", state.indent, state.gap);
-    Vector<String> property_strings;
+    auto& builder = state.builder;
 
     auto length = TRY(length_of_array_like(global_object, object));
 
-    // Optimization
-    property_strings.ensure_capacity(length);
-
+    builder.append('[');
     for (size_t i = 0; i < length; ++i) {
-        auto serialized_property_string = TRY(serialize_json_property(global_object, state, i, &object));
-        if (serialized_property_string.is_null()) {
-            property_strings.append("null");
-        } else {
-            property_strings.append(serialized_property_string);
-        }
-    }
-
-    StringBuilder builder;
-    if (property_strings.is_empty()) {
-        builder.append("[]");
-    } else {
-        if (state.gap.is_empty()) {
-            builder.append('[');
-            bool first = true;
-            for (auto& property_string : property_strings) {
-                if (!first)
-                    builder.append(',');
-                first = false;
-                builder.append(property_string);
-            }
-            builder.append(']');
-        } else {
-            builder.append("[\n");
-            builder.append(state.indent);
-            auto separator = String::formatted(",\n{}", state.indent);
-            bool first = true;
-            for (auto& property_string : property_strings) {
-                if (!first)
-                    builder.append(separator);
-                first = false;
-                builder.append(property_string);
-            }
+        if (i > 0)
+            builder.append(',');
+        if (!state.gap.is_empty()) {
             builder.append('\n');
-            builder.append(previous_indent);
-            builder.append(']');
+            builder.append(state.indent);
         }
+        if (!TRY(serialize_json_property(global_object, state, i, &object)))
+            builder.append("null");
     }
+    if (length > 0 && !state.gap.is_empty()) {
+        builder.append('\n');
+        builder.append(previous_indent);
+    }
+    builder.append(']');
 
     state.seen_objects.remove(&object);
     state.indent = previous_indent;
-    return builder.to_string();
+    return {};
 }
 
 // 25.5.2.2 QuoteJSONString ( value ), https://tc39.es/ecma262/#sec-quotejsonstring
-String JSONObject::quote_json_string(String string)
+void JSONObject::quote_json_string(StringBuilder& builder, StringView string)
 {
     // FIXME: Handle UTF16
-    StringBuilder builder;
     builder.append('"');
     auto utf_view = Utf8View(string);
     for (auto code_point : utf_view) {
@@ -342,19 +320,334 @@ String JSONObject::quote_json_string(String string)
         }
     }
     builder.append('"');
-    return builder.to_string();
 }
 
+// Parses JSON text (https://www.ecma-international.org/publications-and-standards/standards/ecma-404/) straight into JS
+// values, without building an AK::JsonValue tree first. Objects with the same keys in the same order share a shape.
+class JSONTextParser {
+public:
+    JSONTextParser(GlobalObject& global_object, StringView text)
+        : m_global_object(global_object)
+        , m_text(text)
+    {
+    }
+
+    ThrowCompletionOr<Value> parse()
+    {
+        auto value = TRY(parse_value());
+        skip_whitespace();
+        if (!at_end())
+            return syntax_error();
+        return value;
+    }
+
+private:
+    // Keeping these around for longer would only waste memory on layouts that don't come up again.
+    static constexpr size_t max_cached_shapes = 256;
+
+    struct CachedShape {
+        Vector<FlyString> keys;
+        Shape* shape { nullptr };
+    };
+
+    bool at_end() const { return m_offset >= m_text.length(); }
+    char peek() const { return at_end() ? 0 : m_text[m_offset]; }
+
+    bool consume_specific(char ch)
+    {
+        if (peek() != ch)
+            return false;
+        ++m_offset;
+        return true;
+    }
+
+    void skip_whitespace()
+    {
+        while (!at_end()) {
+            auto ch = m_text[m_offset];
+            if (ch != ' ' && ch != '\t' && ch != '\n' && ch != '\r')
+                break;
+            ++m_offset;
+        }
+    }
+
+    ThrowCompletionOr<Value> syntax_error()
+    {
+        return m_global_object.vm().throw_completion<SyntaxError>(m_global_object, ErrorType::JsonMalformed);
+    }
+
+    ThrowCompletionOr<Value> parse_value()
+    {
+        auto& vm = m_global_object.vm();
+        if (vm.did_reach_stack_space_limit())
+            return vm.throw_completion<InternalError>(m_global_object, ErrorType::CallStackSizeExceeded);
+
+        skip_whitespace();
+        switch (peek()) {
+        case '{':
+            return parse_object();
+        case '[':
+            return parse_array();
+        case '"': {
+            auto string = TRY(parse_string());
+            return js_string(vm, move(string));
+        }
+        case 't':
+            return parse_literal("true", Value(true));
+        case 'f':
+            return parse_literal("false", Value(false));
+        case 'n':
+            return parse_literal("null", js_null());
+        default:
+            return parse_number();
+        }
+    }
+
+    ThrowCompletionOr<Value> parse_literal(StringView literal, Value value)
+    {
+        if (!m_text.substring_view(m_offset).starts_with(literal))
+            return syntax_error();
+        m_offset += literal.length();
+        return value;
+    }
+
+    ThrowCompletionOr<Value> parse_number()
+    {
+        auto start = m_offset;
+        consume_specific('-');
+
+        auto consume_digits = [&] {
+            auto digits_start = m_offset;
+            while (is_ascii_digit(peek()))
+                ++m_offset;
+            return m_offset - digits_start;
+        };
+
+        if (!consume_specific('0') && (!is_ascii_digit(peek()) || consume_digits() == 0))
+            return syntax_error();
+
+        bool is_integer = true;
+        if (consume_specific('.')) {
+            is_integer = false;
+            if (consume_digits() == 0)
+                return syntax_error();
+        }
+        if (consume_specific('e') || consume_specific('E')) {
+            is_integer = false;
+            if (!consume_specific('+'))
+                consume_specific('-');
+            if (consume_digits() == 0)
+                return syntax_error();
+        }
+
+        auto number_text = m_text.substring_view(start, m_offset - start);
+
+        // Integers with up to 15 digits are always exactly representable, everything else is left to strtod().
+        bool is_negative = number_text[0] == '-';
+        if (is_integer && number_text.length() - is_negative <= 15) {
+            double value = 0;
+            for (auto ch : number_text.substring_view(is_negative))
+                value = value * 10 + (ch - '0');
+            return Value(is_negative ? -value : value);
+        }
+
+        String null_terminated_text { number_text };
+        return Value(strtod(null_terminated_text.characters(), nullptr));
+    }
+
+    ThrowCompletionOr<String> parse_string()
+    {
+        VERIFY(peek() == '"');
+        ++m_offset;
+
+        // Most strings don't have any escapes, so they can be taken straight from the text.
+        auto start = m_offset;
+        while (!at_end()) {
+            auto ch = m_text[m_offset];
+            if (ch == '"') {
+                ++m_offset;
+                return String(m_text.substring_view(start, m_offset - start - 1));
+            }
+            if (ch == '\\' || static_cast<u8>(ch) < 0x20)
+                break;
+            ++m_offset;
+        }
+
+        StringBuilder builder;
+        builder.append(m_text.substring_view(start, m_offset - start));
+        while (!at_end()) {
+            auto ch = m_text[m_offset++];
+            if (ch == '"')
+                return builder.to_string();
+            if (static_cast<u8>(ch) < 0x20)
+                break;
+            if (ch != '\\') {
+                builder.append(ch);
+                continue;
+            }
+
+            switch (peek()) {
+            case '"':
+            case '\\':
+            case '/':
+                builder.append(m_text[m_offset++]);
+                continue;
+            case 'b':
+                ++m_offset;
+                builder.append('\b');
+                continue;
+            case 'f':
+                ++m_offset;
+                builder.append('\f');
+                continue;
+            case 'n':
+                ++m_offset;
+                builder.append('\n');
+                continue;
+            case 'r':
+                ++m_offset;
+                builder.append('\r');
+                continue;
+            case 't':
+                ++m_offset;
+                builder.append('\t');
+                continue;
+            case 'u': {
+                ++m_offset;
+                auto code_unit = parse_hex_escape();
+                if (!code_unit.has_value())
+                    break;
+                u32 code_point = code_unit.value();
+                if (Utf16View::is_high_surrogate(code_point) && m_text.substring_view(m_offset).starts_with("\\u")) {
+                    auto saved_offset = m_offset;
+                    m_offset += 2;
+                    auto low_surrogate = parse_hex_escape();
+                    if (low_surrogate.has_value() && Utf16View::is_low_surrogate(low_surrogate.value()))
+                        code_point = Utf16View::decode_surrogate_pair(code_point, low_surrogate.value());
+                    else
+                        m_offset = saved_offset;
+                }
+                builder.append_code_point(code_point);
+                continue;
+            }
+            default:
+                break;
+            }
+            break;
+        }
+        return m_global_object.vm().throw_completion<SyntaxError>(m_global_object, ErrorType::JsonMalformed);
+    }
+
+    Optional<u16> parse_hex_escape()
+    {
+        if (m_text.length() - m_offset < 4)
+            return {};
+        u16 code_unit = 0;
+        for (size_t i = 0; i < 4; ++i) {
+            auto ch = m_text[m_offset + i];
+            if (!is_ascii_hex_digit(ch))
+                return {};
+            code_unit = (code_unit << 4) | parse_ascii_hex_digit(ch);
+        }
+        m_offset += 4;
+        return code_unit;
+    }
+
+    ThrowCompletionOr<Value> parse_array()
+    {
+        VERIFY(peek() == '[');
+        ++m_offset;
+
+        Vector<Value> elements;
+        skip_whitespace();
+        if (!consume_specific(']')) {
+            for (;;) {
+                elements.append(TRY(parse_value()));
+                skip_whitespace();
+                if (consume_specific(']'))
+                    break;
+                if (!consume_specific(','))
+                    return syntax_error();
+            }
+        }
+        return Value(Array::create_from(m_global_object, elements));
+    }
+
+    ThrowCompletionOr<Value> parse_object()
+    {
+        VERIFY(peek() == '{');
+        ++m_offset;
+
+        Vector<FlyString, 8> keys;
+        Vector<Value, 8> values;
+        skip_whitespace();
+        if (!consume_specific('}')) {
+            for (;;) {
+                skip_whitespace();
+                if (peek() != '"')
+                    return syntax_error();
+                keys.append(TRY(parse_string()));
+                skip_whitespace();
+                if (!consume_specific(':'))
+                    return syntax_error();
+                values.append(TRY(parse_value()));
+                skip_whitespace();
+                if (consume_specific('}'))
+                    break;
+                if (!consume_specific(','))
+                    return syntax_error();
+            }
+        }
+        return Value(create_object(keys, values));
+    }
+
+    Object* create_object(Span<FlyString const> keys, Span<Value const> values)
+    {
+        unsigned layout_hash = keys.size();
+        for (auto& key : keys)
+            layout_hash = pair_int_hash(layout_hash, ptr_hash(key.impl()));
+
+        if (auto it = m_shape_cache.find(layout_hash); it != m_shape_cache.end() && it->value.keys.span() == keys) {
+            auto* object = m_global_object.heap().allocate<Object>(m_global_object, *it->value.shape);
+            for (size_t i = 0; i < values.size(); ++i)
+                object->put_direct(i, values[i]);
+            return object;
+        }
+
+        auto* object = Object::create(m_global_object, m_global_object.object_prototype());
+        for (size_t i = 0; i < keys.size(); ++i)
+            object->define_direct_property(keys[i], values[i], default_attributes);
+
+        // Only layouts where every key ended up in the shape, in order, can be reused by filling in the storage directly.
+        // That rules out duplicate keys and integer keys, which go into the indexed properties.
+        auto& shape = object->shape();
+        if (!keys.is_empty() && !shape.is_unique() && shape.property_count() == keys.size() && object->indexed_properties().is_empty()
+            && m_shape_cache.size() < max_cached_shapes) {
+            CachedShape cached_shape { {}, &shape };
+            cached_shape.keys.append(keys.data(), keys.size());
+            m_shape_cache.set(layout_hash, move(cached_shape));
+        }
+        return object;
+    }
+
+    GlobalObject& m_global_object;
+    StringView m_text;
+    size_t m_offset { 0 };
+    HashMap<unsigned, CachedShape> m_shape_cache;
+};
+
 // 25.5.1 JSON.parse ( text [ , reviver ] ), https://tc39.es/ecma262/#sec-json.parse
 JS_DEFINE_NATIVE_FUNCTION(JSONObject::parse)
 {
     auto string = TRY(vm.argument(0).to_string(global_object));
     auto reviver = vm.argument(1);
 
-    auto json = JsonValue::from_string(string);
-    if (json.is_error())
-        return vm.throw_completion<SyntaxError>(global_object, ErrorType::JsonMalformed);
-    Value unfiltered = parse_json_value(global_object, json.value());
+    Value unfiltered;
+    {
+        // The values are only reachable from the parser's own vectors until the whole text has been parsed.
+        DeferGC defer_gc(global_object.heap());
+        unfiltered = TRY(JSONTextParser(global_object, string).parse());
+    }
     if (reviver.is_function()) {
         auto* root = Object::create(global_object, global_object.object_prototype());
         auto root_name = String::empty();
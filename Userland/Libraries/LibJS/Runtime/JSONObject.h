@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/StringBuilder.h>
 #include <LibJS/Runtime/Object.h>
 
 namespace JS {
@@ -31,13 +32,15 @@ private:
         String indent { String::empty() };
         String gap;
         Optional<Vector<String>> property_list;
+        StringBuilder builder;
     };
 
-    // Stringify helpers
-    static ThrowCompletionOr<String> serialize_json_property(GlobalObject&, StringifyState&, const PropertyKey& key, Object* holder);
-    static ThrowCompletionOr<String> serialize_json_object(GlobalObject&, StringifyState&, Object&);
-    static ThrowCompletionOr<String> serialize_json_array(GlobalObject&, StringifyState&, Object&);
-    static String quote_json_string(String);
+    // Stringify helpers, which all write to the state's builder.
+    // serialize_json_property() returns false if the value isn't serialized at all (e.g. undefined or a function).
+    static ThrowCompletionOr<bool> serialize_json_property(GlobalObject&, StringifyState&, const PropertyKey& key, Object* holder);
+    static ThrowCompletionOr<void> serialize_json_object(GlobalObject&, StringifyState&, Object&);
+    static ThrowCompletionOr<void> serialize_json_array(GlobalObject&, StringifyState&, Object&);
+    static void quote_json_string(StringBuilder&, StringView);
 
     // Parse helpers
     static Object* parse_json_object(GlobalObject&, const JsonObject&);
@@ -5,6 +5,7 @@
  */
 
 #include <AK/CharacterTypes.h>
+#include <AK/StringBuilder.h>
 #include <AK/Utf16View.h>
 #include <LibJS/Runtime/PrimitiveString.h>
 #include <LibJS/Runtime/VM.h>
@@ -23,13 +24,44 @@ PrimitiveString::PrimitiveString(Utf16String string)
 {
 }
 
+PrimitiveString::PrimitiveString(PrimitiveString& lhs, PrimitiveString& rhs)
+    : m_is_rope(true)
+    , m_lhs(&lhs)
+    , m_rhs(&rhs)
+{
+}
+
 PrimitiveString::~PrimitiveString()
 {
-    vm().string_cache().remove(m_utf8_string);
+    auto& string_cache = vm().string_cache();
+    if (auto it = string_cache.find(m_utf8_string); it != string_cache.end() && it->value == this)
+        string_cache.remove(it);
+}
+
+void PrimitiveString::visit_edges(Cell::Visitor& visitor)
+{
+    Cell::visit_edges(visitor);
+    if (m_is_rope) {
+        visitor.visit(m_lhs);
+        visitor.visit(m_rhs);
+    }
+}
+
+bool PrimitiveString::is_empty() const
+{
+    if (m_is_rope) {
+        // NOTE: We never make an empty rope string.
+        return false;
+    }
+
+    if (m_has_utf16_string)
+        return m_utf16_string.is_empty();
+    return m_utf8_string.is_empty();
 }
 
 String const& PrimitiveString::string() const
 {
+    resolve_rope_if_needed();
     if (!m_has_utf8_string) {
         m_utf8_string = m_utf16_string.to_utf8();
         m_has_utf8_string = true;
@@ -39,6 +71,7 @@ String const& PrimitiveString::string() const
 
 Utf16String const& PrimitiveString::utf16_string() const
 {
+    resolve_rope_if_needed();
     if (!m_has_utf16_string) {
         m_utf16_string = Utf16String(m_utf8_string);
         m_has_utf16_string = true;
@@ -51,6 +84,85 @@ Utf16View PrimitiveString::utf16_string_view() const
     return utf16_string().view();
 }
 
+// Lone surrogates are encoded like any other code point in the BMP, as 0xED 0xA0-0xBF 0x80-0xBF.
+static Optional<u16> decode_utf8_encoded_surrogate(StringView bytes)
+{
+    if (bytes.length() < 3)
+        return {};
+    auto byte0 = static_cast<u8>(bytes[0]);
+    auto byte1 = static_cast<u8>(bytes[1]);
+    auto byte2 = static_cast<u8>(bytes[2]);
+    if (byte0 != 0xed || (byte1 & 0xe0) != 0xa0 || (byte2 & 0xc0) != 0x80)
+        return {};
+    return static_cast<u16>(0xd000 | ((byte1 & 0x3f) << 6) | (byte2 & 0x3f));
+}
+
+void PrimitiveString::resolve_rope_if_needed() const
+{
+    if (!m_is_rope)
+        return;
+
+    // The rope tree is walked without recursion, since long sequences of concatenations (like `s += x` in a loop)
+    // make for very deep trees. This collects all of its leaves from left to right.
+    Vector<PrimitiveString const*> pieces;
+    Vector<PrimitiveString const*> stack;
+    stack.append(m_rhs);
+    stack.append(m_lhs);
+    bool all_pieces_are_utf16 = true;
+    while (!stack.is_empty()) {
+        auto const* current = stack.take_last();
+        if (current->m_is_rope) {
+            stack.append(current->m_rhs);
+            stack.append(current->m_lhs);
+            continue;
+        }
+        if (!current->m_has_utf16_string)
+            all_pieces_are_utf16 = false;
+        pieces.append(current);
+    }
+
+    if (all_pieces_are_utf16) {
+        size_t length_in_code_units = 0;
+        for (auto const* piece : pieces)
+            length_in_code_units += piece->m_utf16_string.length_in_code_units();
+
+        Vector<u16, 1> combined;
+        combined.ensure_capacity(length_in_code_units);
+        for (auto const* piece : pieces)
+            combined.extend(piece->m_utf16_string.string());
+
+        m_utf16_string = Utf16String(move(combined));
+        m_has_utf16_string = true;
+    } else {
+        StringBuilder builder;
+        for (auto const* piece : pieces) {
+            auto piece_string = piece->string().view();
+
+            // A surrogate pair may be split across two pieces, with each half encoded as its own 3-byte sequence.
+            // Those have to be combined into the UTF-8 encoding of the code point they make up together.
+            if (builder.length() >= 3) {
+                auto high_surrogate = decode_utf8_encoded_surrogate(builder.string_view().substring_view(builder.length() - 3));
+                auto low_surrogate = decode_utf8_encoded_surrogate(piece_string);
+                if (high_surrogate.has_value() && low_surrogate.has_value()
+                    && Utf16View::is_high_surrogate(*high_surrogate) && Utf16View::is_low_surrogate(*low_surrogate)) {
+                    builder.trim(3);
+                    builder.append_code_point(Utf16View::decode_surrogate_pair(*high_surrogate, *low_surrogate));
+                    piece_string = piece_string.substring_view(3);
+                }
+            }
+
+            builder.append(piece_string);
+        }
+
+        m_utf8_string = builder.to_string();
+        m_has_utf8_string = true;
+    }
+
+    m_is_rope = false;
+    m_lhs = nullptr;
+    m_rhs = nullptr;
+}
+
 PrimitiveString* js_string(Heap& heap, Utf16View const& view)
 {
     return js_string(heap, Utf16String(view));
@@ -93,7 +205,7 @@ PrimitiveString* js_string(Heap& heap, String string)
 
     auto& string_cache = heap.vm().string_cache();
     auto it = string_cache.find(string);
-    if (it == string_cache.end()) {
+    if (it == string_cache.end() || it->value->is_pending_destruction()) {
         auto* new_string = heap.allocate_without_global_object<PrimitiveString>(string);
         string_cache.set(move(string), new_string);
         return new_string;
@@ -106,4 +218,16 @@ PrimitiveString* js_string(VM& vm, String string)
     return js_string(vm.heap(), move(string));
 }
 
+PrimitiveString* js_rope_string(VM& vm, PrimitiveString& lhs, PrimitiveString& rhs)
+{
+    // We're here to concatenate two strings into a new rope string.
+    // However, if any of them are empty, no rope is required.
+    if (lhs.is_empty())
+        return &rhs;
+    if (rhs.is_empty())
+        return &lhs;
+
+    return vm.heap().allocate_without_global_object<PrimitiveString>(lhs, rhs);
+}
+
 }
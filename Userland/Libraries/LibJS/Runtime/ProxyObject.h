@@ -51,6 +51,7 @@ private:
 
     virtual bool is_function() const override { return m_target.is_function(); }
     virtual bool is_proxy_object() const final { return true; }
+    virtual bool may_cache_property_lookups() const override { return false; }
 
     Object& m_target;
     Object& m_handler;
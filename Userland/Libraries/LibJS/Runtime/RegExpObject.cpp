@@ -167,7 +167,7 @@ ThrowCompletionOr<RegExpObject*> RegExpObject::regexp_initialize(GlobalObject& g
     if (parsed_flags_or_error.is_error())
         return vm.throw_completion<SyntaxError>(global_object, parsed_flags_or_error.release_error());
 
-    Regex<ECMA262> regex(move(parsed_pattern), parsed_flags_or_error.release_value());
+    auto regex = Regex<ECMA262>::compile_cached(move(parsed_pattern), parsed_flags_or_error.release_value());
     if (regex.parser_result.error != regex::Error::NoError)
         return vm.throw_completion<SyntaxError>(global_object, ErrorType::RegExpCompileError, regex.error_string());
 
@@ -28,7 +28,7 @@ Shape* Shape::get_or_prune_cached_forward_transition(TransitionKey const& key)
     auto it = m_forward_transitions.find(key);
     if (it == m_forward_transitions.end())
         return nullptr;
-    if (!it->value) {
+    if (!it->value || it->value->is_pending_destruction()) {
         // The cached forward transition has gone stale (from garbage collection). Prune it.
         m_forward_transitions.remove(it);
         return nullptr;
@@ -41,7 +41,7 @@ Shape* Shape::get_or_prune_cached_prototype_transition(Object* prototype)
     auto it = m_prototype_transitions.find(prototype);
     if (it == m_prototype_transitions.end())
         return nullptr;
-    if (!it->value) {
+    if (!it->value || it->value->is_pending_destruction()) {
         // The cached prototype transition has gone stale (from garbage collection). Prune it.
         m_prototype_transitions.remove(it);
         return nullptr;
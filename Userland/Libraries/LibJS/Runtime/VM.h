@@ -300,4 +300,9 @@ ALWAYS_INLINE VM& Cell::vm() const
     return heap().vm();
 }
 
+ALWAYS_INLINE bool Cell::is_pending_destruction() const
+{
+    return HeapBlock::from_cell(this)->is_awaiting_sweep() && !is_marked();
+}
+
 }
@@ -995,28 +995,10 @@ ThrowCompletionOr<Value> add(GlobalObject& global_object, Value lhs, Value rhs)
     auto lhs_primitive = TRY(lhs.to_primitive(global_object));
     auto rhs_primitive = TRY(rhs.to_primitive(global_object));
 
-    if (lhs_primitive.is_string() && rhs_primitive.is_string()) {
-        auto const& lhs_string = lhs_primitive.as_string();
-        auto const& rhs_string = rhs_primitive.as_string();
-
-        if (lhs_string.has_utf16_string() && rhs_string.has_utf16_string()) {
-            auto const& lhs_utf16_string = lhs_string.utf16_string();
-            auto const& rhs_utf16_string = rhs_string.utf16_string();
-
-            Vector<u16, 1> combined;
-            combined.ensure_capacity(lhs_utf16_string.length_in_code_units() + rhs_utf16_string.length_in_code_units());
-            combined.extend(lhs_utf16_string.string());
-            combined.extend(rhs_utf16_string.string());
-            return Value(js_string(vm.heap(), Utf16String(move(combined))));
-        }
-    }
     if (lhs_primitive.is_string() || rhs_primitive.is_string()) {
-        auto lhs_string = TRY(lhs_primitive.to_string(global_object));
-        auto rhs_string = TRY(rhs_primitive.to_string(global_object));
-        StringBuilder builder(lhs_string.length() + rhs_string.length());
-        builder.append(lhs_string);
-        builder.append(rhs_string);
-        return Value(js_string(vm, builder.to_string()));
+        auto* lhs_string = TRY(lhs_primitive.to_primitive_string(global_object));
+        auto* rhs_string = TRY(rhs_primitive.to_primitive_string(global_object));
+        return Value(js_rope_string(vm, *lhs_string, *rhs_string));
     }
 
     auto lhs_numeric = TRY(lhs_primitive.to_numeric(global_object));
@@ -1031,6 +1013,13 @@ ThrowCompletionOr<Value> add(GlobalObject& global_object, Value lhs, Value rhs)
 // 13.8.2 The Subtraction Operator ( - ), https://tc39.es/ecma262/#sec-subtraction-operator-minus
 ThrowCompletionOr<Value> sub(GlobalObject& global_object, Value lhs, Value rhs)
 {
+    if (lhs.type() == Value::Type::Int32 && rhs.type() == Value::Type::Int32) {
+        Checked<i32> result = lhs.as_i32();
+        result -= rhs.as_i32();
+        if (!result.has_overflow())
+            return Value(result.value());
+    }
+
     auto& vm = global_object.vm();
     auto lhs_numeric = TRY(lhs.to_numeric(global_object));
     auto rhs_numeric = TRY(rhs.to_numeric(global_object));
@@ -1044,6 +1033,14 @@ ThrowCompletionOr<Value> sub(GlobalObject& global_object, Value lhs, Value rhs)
 // 13.7 Multiplicative Operators, https://tc39.es/ecma262/#sec-multiplicative-operators
 ThrowCompletionOr<Value> mul(GlobalObject& global_object, Value lhs, Value rhs)
 {
+    if (lhs.type() == Value::Type::Int32 && rhs.type() == Value::Type::Int32) {
+        Checked<i32> result = lhs.as_i32();
+        result *= rhs.as_i32();
+        // A zero product with a negative operand is -0, which can't be represented as an Int32.
+        if (!result.has_overflow() && (result.value() != 0 || (lhs.as_i32() >= 0 && rhs.as_i32() >= 0)))
+            return Value(result.value());
+    }
+
     auto& vm = global_object.vm();
     auto lhs_numeric = TRY(lhs.to_numeric(global_object));
     auto rhs_numeric = TRY(rhs.to_numeric(global_object));
@@ -26,7 +26,7 @@ WeakMap::~WeakMap()
 void WeakMap::remove_dead_cells(Badge<Heap>)
 {
     m_values.remove_all_matching([](Cell* key, Value) {
-        return key->state() != Cell::State::Live;
+        return key->is_pending_destruction();
     });
 }
 
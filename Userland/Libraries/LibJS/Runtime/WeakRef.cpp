@@ -28,7 +28,7 @@ WeakRef::~WeakRef()
 void WeakRef::remove_dead_cells(Badge<Heap>)
 {
     VERIFY(m_value);
-    if (m_value->state() == Cell::State::Live)
+    if (!m_value->is_pending_destruction())
         return;
 
     m_value = nullptr;
@@ -26,7 +26,7 @@ WeakSet::~WeakSet()
 void WeakSet::remove_dead_cells(Badge<Heap>)
 {
     m_values.remove_all_matching([](Cell* cell) {
-        return cell->state() != Cell::State::Live;
+        return cell->is_pending_destruction();
     });
 }
 
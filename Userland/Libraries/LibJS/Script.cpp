@@ -23,7 +23,12 @@ Result<NonnullRefPtr<Script>, Vector<Parser::Error>> Script::parse(StringView so
         return parser.errors();
 
     // 3. Return Script Record { [[Realm]]: realm, [[ECMAScriptCode]]: body, [[HostDefined]]: hostDefined }.
-    return adopt_ref(*new Script(realm, move(body)));
+    return create(realm, move(body));
+}
+
+NonnullRefPtr<Script> Script::create(Realm& realm, NonnullRefPtr<Program> parse_node)
+{
+    return adopt_ref(*new Script(realm, move(parse_node)));
 }
 
 Script::Script(Realm& realm, NonnullRefPtr<Program> parse_node)
@@ -21,6 +21,10 @@ public:
     ~Script();
     static Result<NonnullRefPtr<Script>, Vector<Parser::Error>> parse(StringView source_text, Realm&, StringView filename = {});
 
+    // Makes a Script Record for a body that has already been parsed. Parse nodes don't depend on the realm, so hosts
+    // may share one between all Script Records for the same source text.
+    static NonnullRefPtr<Script> create(Realm&, NonnullRefPtr<Program> parse_node);
+
     Realm& realm() { return *m_realm.cell(); }
     Program const& parse_node() const { return *m_parse_node; }
 
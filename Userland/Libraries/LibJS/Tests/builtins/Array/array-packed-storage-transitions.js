@@ -0,0 +1,68 @@
+describe("packed storage transitions", () => {
+    test("int32 elements growing into doubles and other values", () => {
+        var a = [1, 2, 3];
+        a.push(1.5);
+        expect(a).toEqual([1, 2, 3, 1.5]);
+        a.push(-0);
+        expect(Object.is(a[4], -0)).toBeTrue();
+        a.push("foo");
+        expect(a).toEqual([1, 2, 3, 1.5, -0, "foo"]);
+        expect(a.indexOf("foo")).toBe(5);
+        expect(a.indexOf(1.5)).toBe(3);
+    });
+
+    test("holes and length changes", () => {
+        var a = [1, 2, 3];
+        a.length = 1;
+        expect(a).toHaveLength(1);
+        a.length = 3;
+        expect(1 in a).toBeFalse();
+        expect(a.indexOf(undefined)).toBe(-1);
+
+        var b = [1, 2, 3];
+        delete b[1];
+        expect(1 in b).toBeFalse();
+        expect(b.indexOf(2)).toBe(-1);
+
+        var c = [1, 2];
+        c[5] = 3;
+        expect(c).toHaveLength(6);
+        expect(c.indexOf(3)).toBe(5);
+    });
+
+    test("accessor and non-default attributes on elements", () => {
+        var a = [1, 2, 3];
+        Object.defineProperty(a, 1, {
+            get() {
+                return 7;
+            },
+        });
+        expect(a.indexOf(7)).toBe(1);
+        expect(a.map(x => x)).toEqual([1, 7, 3]);
+
+        var b = [1, 2, 3];
+        Object.defineProperty(b, 0, { value: 4, writable: false });
+        expect(b.indexOf(4)).toBe(0);
+        expect(() => {
+            "use strict";
+            b[0] = 5;
+        }).toThrow(TypeError);
+    });
+
+    test("holes are looked up on the prototype", () => {
+        Array.prototype[1] = 42;
+        try {
+            var a = [1, , 3];
+            expect(a.indexOf(42)).toBe(1);
+            expect(a.map(x => x)).toEqual([1, 42, 3]);
+        } finally {
+            delete Array.prototype[1];
+        }
+    });
+
+    test("sorting int32 elements compares their string representations", () => {
+        var a = [10, 9, 1, -5, 100, -20, 0, 2147483647, -2147483648];
+        a.sort();
+        expect(a).toEqual([-20, -2147483648, -5, 0, 1, 10, 100, 2147483647, 9]);
+    });
+});
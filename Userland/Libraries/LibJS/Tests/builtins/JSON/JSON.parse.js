@@ -29,9 +29,52 @@ test("syntax errors", () => {
         "[1,2,3, ]",
         '{ "foo": "bar",}',
         '{ "foo": "bar", }',
+        "01",
+        "-",
+        "1.",
+        ".5",
+        "1e",
+        "+1",
+        '"\\x"',
+        '"\\u12"',
+        '"\n"',
+        "\u00a01",
+        "tru",
+        "[1] [2]",
     ].forEach(test => {
         expect(() => {
             JSON.parse(test);
         }).toThrow(SyntaxError);
     });
 });
+
+test("numbers", () => {
+    expect(JSON.parse("9007199254740993")).toBe(9007199254740992);
+    expect(JSON.parse("-123456789012")).toBe(-123456789012);
+    expect(JSON.parse("1.5e3")).toBe(1500);
+    expect(JSON.parse("-0.25E-2")).toBe(-0.0025);
+    expect(Object.is(JSON.parse("-0"), -0)).toBeTrue();
+});
+
+test("strings", () => {
+    expect(JSON.parse('"\\"\\\\\\/\\b\\f\\n\\r\\t"')).toBe('"\\/\b\f\n\r\t');
+    expect(JSON.parse('"\\u0041\\ud83d\\ude00"')).toBe("A\u{1f600}");
+    expect(JSON.parse('"ab\\u0063"')).toBe("abc");
+});
+
+test("objects with the same keys", () => {
+    const objects = JSON.parse('[{"a":1,"b":2},{"a":3,"b":4},{"b":5,"a":6},{"a":7,"a":8,"b":9},{"0":1,"a":2},{"0":3,"a":4}]');
+    expect(objects).toEqual([
+        { a: 1, b: 2 },
+        { a: 3, b: 4 },
+        { b: 5, a: 6 },
+        { a: 8, b: 9 },
+        { 0: 1, a: 2 },
+        { 0: 3, a: 4 },
+    ]);
+    expect(Object.keys(objects[2])).toEqual(["b", "a"]);
+
+    objects[1].c = 5;
+    expect(objects[0].c).toBeUndefined();
+    expect(Object.keys(objects[1])).toEqual(["a", "b", "c"]);
+});
@@ -0,0 +1,54 @@
+test("repeated concatenation", () => {
+    let s = "";
+    for (let i = 0; i < 100000; ++i) s += "ab";
+    expect(s).toHaveLength(200000);
+    expect(s.charAt(0)).toBe("a");
+    expect(s.charAt(199999)).toBe("b");
+    expect(s.indexOf("ba")).toBe(1);
+});
+
+test("concatenation of strings and other values", () => {
+    let s = "a";
+    s += 1;
+    s = 2 + s;
+    s += null;
+    s = undefined + s;
+    s += 1.5;
+    s += true;
+    expect(s).toBe("undefined2a1null1.5true");
+    expect(1 + 2 + "3").toBe("33");
+    expect("" + "").toBe("");
+    expect("" + "x").toBe("x");
+    expect("x" + "").toBe("x");
+});
+
+test("concatenated strings compare and hash like flat strings", () => {
+    const a = "foo" + "bar";
+    const b = "fo" + "ob" + "ar";
+    expect(a === b).toBeTrue();
+    expect(a === "foobar").toBeTrue();
+    expect(a < "foobaz").toBeTrue();
+
+    const object = {};
+    object[a] = 1;
+    expect(object.foobar).toBe(1);
+    expect(object[b]).toBe(1);
+
+    const map = new Map();
+    map.set(b, 2);
+    expect(map.get("foobar")).toBe(2);
+});
+
+test("surrogate pairs split across concatenated strings", () => {
+    const high = "\ud83d";
+    const low = "\ude00";
+    const s = high + low;
+    expect(s).toBe("😀");
+    expect(s).toHaveLength(2);
+    expect(s.codePointAt(0)).toBe(0x1f600);
+
+    const t = "a" + String.fromCharCode(0xd83d) + (String.fromCharCode(0xde00) + "b");
+    expect(t).toBe("a😀b");
+    expect(t.codePointAt(1)).toBe(0x1f600);
+    expect(high + "b" + low).toHaveLength(3);
+});
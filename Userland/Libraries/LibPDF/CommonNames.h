@@ -16,18 +16,22 @@
     V(BG2)                        \
     V(BM)                         \
     V(BaseFont)                   \
+    V(BitsPerComponent)           \
     V(BlackPoint)                 \
     V(C)                          \
     V(CA)                         \
     V(CCITTFaxDecode)             \
     V(CalRGB)                     \
     V(ColorSpace)                 \
+    V(Colors)                     \
+    V(Columns)                    \
     V(Contents)                   \
     V(Count)                      \
     V(CropBox)                    \
     V(Crypt)                      \
     V(D)                          \
     V(DCTDecode)                  \
+    V(DecodeParms)                \
     V(Dest)                       \
     V(DeviceCMYK)                 \
     V(DeviceGray)                 \
@@ -51,6 +55,7 @@
     V(H)                          \
     V(HT)                         \
     V(HTO)                        \
+    V(Index)                      \
     V(JBIG2Decode)                \
     V(JPXDecode)                  \
     V(Kids)                       \
@@ -70,11 +75,13 @@
     V(O)                          \
     V(OP)                         \
     V(OPM)                        \
+    V(ObjStm)                     \
     V(Outlines)                   \
     V(P)                          \
     V(Pages)                      \
     V(Parent)                     \
     V(Pattern)                    \
+    V(Predictor)                  \
     V(Prev)                       \
     V(RI)                         \
     V(Resources)                  \
@@ -84,6 +91,7 @@
     V(SA)                         \
     V(SM)                         \
     V(SMask)                      \
+    V(Size)                       \
     V(T)                          \
     V(TK)                         \
     V(TR)                         \
@@ -93,7 +101,10 @@
     V(UCR)                        \
     V(UseBlackPTComp)             \
     V(UserUnit)                   \
+    V(W)                          \
     V(WhitePoint)                 \
+    V(XRef)                       \
+    V(XRefStm)                    \
     V(XYZ)                        \
     V(ca)                         \
     V(op)
@@ -61,11 +61,51 @@ Value Document::get_or_load_value(u32 index)
     if (!value.has<Empty>()) // FIXME: Use Optional instead?
         return value;
 
+    if (auto stream = get_cached_stream(index))
+        return stream;
+
     auto object = m_parser->parse_object_with_index(index);
-    m_values.set(index, object);
+    if (object.has<NonnullRefPtr<Object>>() && object.get<NonnullRefPtr<Object>>()->is_stream())
+        cache_stream(index, object_cast<StreamObject>(object.get<NonnullRefPtr<Object>>()));
+    else
+        m_values.set(index, object);
     return object;
 }
 
+RefPtr<StreamObject> Document::get_cached_stream(u32 index)
+{
+    auto it = m_cached_streams.find(index);
+    if (it == m_cached_streams.end())
+        return {};
+    auto& entry = *it->value;
+    m_least_recently_used_streams.remove(entry);
+    m_least_recently_used_streams.append(entry);
+    return entry.stream;
+}
+
+void Document::cache_stream(u32 index, NonnullRefPtr<StreamObject> stream)
+{
+    if (auto it = m_cached_streams.find(index); it != m_cached_streams.end())
+        remove_cached_stream(*it->value);
+
+    auto entry = make<CachedStream>(index, move(stream));
+    m_cached_streams_size_in_bytes += entry->size_in_bytes();
+    m_least_recently_used_streams.append(*entry);
+    m_cached_streams.set(index, move(entry));
+
+    while (m_cached_streams_size_in_bytes > stream_cache_budget_in_bytes && !m_least_recently_used_streams.is_empty())
+        remove_cached_stream(*m_least_recently_used_streams.first());
+}
+
+void Document::remove_cached_stream(CachedStream& entry)
+{
+    m_cached_streams_size_in_bytes -= entry.size_in_bytes();
+    m_least_recently_used_streams.remove(entry);
+    // NOTE: This destroys the entry, so we have to take a copy of the index first.
+    auto index = entry.index;
+    m_cached_streams.remove(index);
+}
+
 u32 Document::get_first_page_index() const
 {
     // FIXME: A PDF can have a different default first page, which
@@ -82,10 +122,6 @@ Page Document::get_page(u32 index)
 {
     VERIFY(index < m_page_object_indices.size());
 
-    auto cached_page = m_pages.get(index);
-    if (cached_page.has_value())
-        return cached_page.value();
-
     auto page_object_index = m_page_object_indices[index];
     auto raw_page_object = resolve_to<DictObject>(get_or_load_value(page_object_index));
 
@@ -126,9 +162,8 @@ Page Document::get_page(u32 index)
         VERIFY(rotate % 90 == 0);
     }
 
-    Page page { move(resources), move(contents), media_box, crop_box, user_unit, rotate };
-    m_pages.set(index, page);
-    return page;
+    // NOTE: Pages aren't cached, as they would keep their contents alive. The objects they're made of are cached instead.
+    return Page { move(resources), move(contents), media_box, crop_box, user_unit, rotate };
 }
 
 Value Document::resolve(Value const& value)
@@ -8,6 +8,8 @@
 
 #include <AK/Format.h>
 #include <AK/HashMap.h>
+#include <AK/IntrusiveList.h>
+#include <AK/NonnullOwnPtr.h>
 #include <AK/RefCounted.h>
 #include <AK/Weakable.h>
 #include <LibGfx/Color.h>
@@ -132,11 +134,36 @@ private:
     NonnullRefPtr<OutlineItem> build_outline_item(NonnullRefPtr<DictObject> const& outline_item_dict);
     NonnullRefPtrVector<OutlineItem> build_outline_item_chain(Value const& first_ref, Value const& last_ref);
 
+    // Decoded streams (like page contents, images and object streams) can be big, so only the most
+    // recently used ones are kept, as long as they fit into the budget. They're decoded again when needed.
+    // All other objects are small, and are kept in m_values.
+    struct CachedStream {
+        CachedStream(u32 index, NonnullRefPtr<StreamObject> stream)
+            : index(index)
+            , stream(move(stream))
+        {
+        }
+
+        u32 index { 0 };
+        NonnullRefPtr<StreamObject> stream;
+        IntrusiveListNode<CachedStream> list_node;
+
+        size_t size_in_bytes() const { return sizeof(CachedStream) + stream->bytes().size(); }
+    };
+
+    static constexpr size_t stream_cache_budget_in_bytes = 16 * MiB;
+
+    RefPtr<StreamObject> get_cached_stream(u32 index);
+    void cache_stream(u32 index, NonnullRefPtr<StreamObject>);
+    void remove_cached_stream(CachedStream&);
+
     NonnullRefPtr<Parser> m_parser;
     RefPtr<DictObject> m_catalog;
     Vector<u32> m_page_object_indices;
-    HashMap<u32, Page> m_pages;
     HashMap<u32, Value> m_values;
+    HashMap<u32, NonnullOwnPtr<CachedStream>> m_cached_streams;
+    IntrusiveList<&CachedStream::list_node> m_least_recently_used_streams;
+    size_t m_cached_streams_size_in_bytes { 0 };
     RefPtr<OutlineDict> m_outline;
 };
 
@@ -37,6 +37,69 @@ Optional<ByteBuffer> Filter::decode(ReadonlyBytes bytes, FlyString const& encodi
     return {};
 }
 
+Optional<ByteBuffer> Filter::undo_png_prediction(ReadonlyBytes bytes, size_t columns, size_t colors, size_t bits_per_component)
+{
+    auto bytes_per_pixel = max<size_t>(1, (colors * bits_per_component + 7) / 8);
+    auto bytes_per_row = (columns * colors * bits_per_component + 7) / 8;
+    if (bytes_per_row == 0)
+        return {};
+
+    // Every row starts with a byte that says which predictor was used for it.
+    auto encoded_row_size = bytes_per_row + 1;
+    auto row_count = bytes.size() / encoded_row_size;
+
+    auto output_result = ByteBuffer::create_uninitialized(row_count * bytes_per_row);
+    if (!output_result.has_value())
+        return output_result;
+
+    auto output = output_result.release_value();
+
+    for (size_t row = 0; row < row_count; ++row) {
+        auto predictor = bytes[row * encoded_row_size];
+        auto const* encoded = bytes.offset(row * encoded_row_size + 1);
+        auto* decoded = output.data() + row * bytes_per_row;
+        auto const* above = row == 0 ? nullptr : decoded - bytes_per_row;
+
+        for (size_t i = 0; i < bytes_per_row; ++i) {
+            u8 left = i >= bytes_per_pixel ? decoded[i - bytes_per_pixel] : 0;
+            u8 up = above ? above[i] : 0;
+            u8 up_left = above && i >= bytes_per_pixel ? above[i - bytes_per_pixel] : 0;
+
+            switch (predictor) {
+            case 0: // None
+                decoded[i] = encoded[i];
+                break;
+            case 1: // Sub
+                decoded[i] = encoded[i] + left;
+                break;
+            case 2: // Up
+                decoded[i] = encoded[i] + up;
+                break;
+            case 3: // Average
+                decoded[i] = encoded[i] + (left + up) / 2;
+                break;
+            case 4: { // Paeth
+                int estimate = left + up - up_left;
+                int left_distance = abs(estimate - left);
+                int up_distance = abs(estimate - up);
+                int up_left_distance = abs(estimate - up_left);
+                if (left_distance <= up_distance && left_distance <= up_left_distance)
+                    decoded[i] = encoded[i] + left;
+                else if (up_distance <= up_left_distance)
+                    decoded[i] = encoded[i] + up;
+                else
+                    decoded[i] = encoded[i] + up_left;
+                break;
+            }
+            default:
+                return {};
+            }
+        }
+    }
+
+    return output;
+}
+
 Optional<ByteBuffer> Filter::decode_ascii_hex(ReadonlyBytes bytes)
 {
     if (bytes.size() % 2 == 0)
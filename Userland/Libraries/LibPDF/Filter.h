@@ -15,6 +15,10 @@ class Filter {
 public:
     static Optional<ByteBuffer> decode(ReadonlyBytes bytes, FlyString const& encoding_type);
 
+    // LZW and Flate encoded data can have been run through one of the PNG predictors first (a Predictor of 10
+    // or more in the DecodeParms), which often makes tables of numbers, like xref streams, compress much better.
+    static Optional<ByteBuffer> undo_png_prediction(ReadonlyBytes bytes, size_t columns, size_t colors, size_t bits_per_component);
+
 private:
     static Optional<ByteBuffer> decode_ascii_hex(ReadonlyBytes bytes);
     static Optional<ByteBuffer> decode_ascii85(ReadonlyBytes bytes);
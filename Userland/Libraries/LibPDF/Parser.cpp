@@ -4,7 +4,9 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Array.h>
 #include <AK/BitStream.h>
+#include <AK/HashTable.h>
 #include <AK/MemoryStream.h>
 #include <AK/ScopeGuard.h>
 #include <AK/TypeCasts.h>
@@ -79,6 +81,9 @@ bool Parser::initialize()
 Value Parser::parse_object_with_index(u32 index)
 {
     VERIFY(m_xref_table->has_object(index));
+    if (m_xref_table->is_object_compressed(index))
+        return parse_compressed_object_with_index(index);
+
     auto byte_offset = m_xref_table->byte_offset_for_object(index);
     m_reader.move_to(byte_offset);
     auto indirect_value = parse_indirect_value();
@@ -206,28 +211,11 @@ bool Parser::initialize_linearized_xref_table()
 {
     // The linearization parameter dictionary has just been parsed, and the xref table
     // comes immediately after it. We are in the correct spot.
-    if (!m_reader.matches("xref"))
-        return false;
-
-    m_xref_table = parse_xref_table();
-    if (!m_xref_table)
-        return false;
-
-    m_trailer = parse_file_trailer();
-    if (!m_trailer)
-        return false;
-
-    // Also parse the main xref table and merge into the first-page xref table. Note
-    // that we don't use the main xref table offset from the linearization dict because
-    // for some reason, it specified the offset of the whitespace after the object
-    // index start and length? So it's much easier to do it this way.
-    auto main_xref_table_offset = m_trailer->get_value(CommonNames::Prev).to_int();
-    m_reader.move_to(main_xref_table_offset);
-    auto main_xref_table = parse_xref_table();
-    if (!main_xref_table)
-        return false;
-
-    return m_xref_table->merge(move(*main_xref_table));
+    // The main xref table is found through the Prev entry of its trailer. Note that we
+    // don't use the main xref table offset from the linearization dict because for some
+    // reason, it specified the offset of the whitespace after the object index start and
+    // length? So it's much easier to do it this way.
+    return initialize_xref_table_and_trailer(m_reader.offset());
 }
 
 bool Parser::initialize_hint_tables()
@@ -316,12 +304,71 @@ bool Parser::initialize_non_linearized_xref_table()
         return false;
     auto xref_offset = xref_offset_value.get<int>();
 
-    m_reader.move_to(xref_offset);
-    m_xref_table = parse_xref_table();
-    if (!m_xref_table)
-        return false;
-    m_trailer = parse_file_trailer();
-    return m_trailer;
+    return initialize_xref_table_and_trailer(xref_offset);
+}
+
+bool Parser::initialize_xref_table_and_trailer(size_t xref_offset)
+{
+    // Every incremental update of a file adds an xref table (or stream) for the objects it changed, which
+    // points at the one before it with its Prev entry. We start with the newest one, so its entries win.
+    // NOTE: m_xref_table stays unset until we're done, so that parsing the xref streams doesn't try to
+    //       look up objects in an incomplete table.
+    RefPtr<XRefTable> xref_table;
+    HashTable<size_t> visited_offsets;
+    Optional<size_t> offset = xref_offset;
+
+    while (offset.has_value()) {
+        if (offset.value() >= m_reader.bytes().size())
+            return false;
+        if (visited_offsets.set(offset.value()) != AK::HashSetResult::InsertedNewEntry)
+            return false;
+        m_reader.move_to(offset.value());
+
+        RefPtr<XRefTable> table;
+        RefPtr<DictObject> trailer;
+
+        if (m_reader.matches("xref")) {
+            table = parse_xref_table();
+            if (!table)
+                return false;
+            trailer = parse_file_trailer();
+            if (!trailer)
+                return false;
+
+            if (trailer->contains(CommonNames::XRefStm)) {
+                auto stream_offset = trailer->get_value(CommonNames::XRefStm);
+                if (!stream_offset.has_u32() || stream_offset.get_u32() >= m_reader.bytes().size())
+                    return false;
+                m_reader.move_to(stream_offset.get_u32());
+                RefPtr<DictObject> stream_dict;
+                auto stream_table = parse_xref_stream(stream_dict);
+                if (!stream_table)
+                    return false;
+                table->merge_hybrid_xref_stream(*stream_table);
+            }
+        } else {
+            table = parse_xref_stream(trailer);
+            if (!table)
+                return false;
+        }
+
+        if (xref_table) {
+            xref_table->merge_older_table(*table);
+        } else {
+            xref_table = table;
+            m_trailer = trailer;
+        }
+
+        offset.clear();
+        if (auto previous_offset = trailer->get(CommonNames::Prev); previous_offset.has_value()) {
+            if (!previous_offset->has_u32())
+                return false;
+            offset = previous_offset->get_u32();
+        }
+    }
+
+    m_xref_table = xref_table;
+    return true;
 }
 
 RefPtr<XRefTable> Parser::parse_xref_table()
@@ -383,6 +430,169 @@ RefPtr<XRefTable> Parser::parse_xref_table()
     }
 }
 
+RefPtr<XRefTable> Parser::parse_xref_stream(RefPtr<DictObject>& trailer)
+{
+    auto indirect_value = parse_indirect_value();
+    if (!indirect_value)
+        return {};
+
+    auto value = indirect_value->value();
+    if (!value.has<NonnullRefPtr<Object>>() || !value.get<NonnullRefPtr<Object>>()->is_stream())
+        return {};
+
+    auto stream = object_cast<StreamObject>(value.get<NonnullRefPtr<Object>>());
+    auto dict = stream->dict();
+    if (!dict->contains(CommonNames::Type, CommonNames::Size, CommonNames::W))
+        return {};
+    if (dict->get_name(m_document, CommonNames::Type)->name() != CommonNames::XRef)
+        return {};
+
+    auto size_value = dict->get_value(CommonNames::Size);
+    if (!size_value.has_u32())
+        return {};
+    auto size = size_value.get_u32();
+
+    // Every entry is made up of three big-endian numbers: the type of the entry, followed by two
+    // fields whose meaning depends on the type. W has the width in bytes of each of them.
+    auto field_widths_array = dict->get_array(m_document, CommonNames::W);
+    if (field_widths_array->size() != 3)
+        return {};
+    Array<size_t, 3> field_widths;
+    for (size_t i = 0; i < 3; i++) {
+        auto width = field_widths_array->at(i);
+        if (!width.has_u32() || width.get_u32() > sizeof(u64))
+            return {};
+        field_widths[i] = width.get_u32();
+    }
+    auto entry_size = field_widths[0] + field_widths[1] + field_widths[2];
+    if (entry_size == 0)
+        return {};
+
+    // Index has pairs of the first object number and the object count of each section.
+    Vector<u32> sections { 0, size };
+    if (dict->contains(CommonNames::Index)) {
+        auto index_array = dict->get_array(m_document, CommonNames::Index);
+        if (index_array->size() % 2 != 0)
+            return {};
+        sections.clear();
+        for (auto& section_value : *index_array) {
+            if (!section_value.has_u32())
+                return {};
+            sections.append(section_value.get_u32());
+        }
+    }
+
+    auto bytes = stream->bytes();
+    size_t offset = 0;
+
+    // A missing field has a default value instead.
+    auto read_field = [&](size_t width, u64 default_value) -> u64 {
+        if (width == 0)
+            return default_value;
+        u64 field = 0;
+        for (size_t i = 0; i < width; i++)
+            field = (field << 8) | bytes[offset++];
+        return field;
+    };
+
+    auto table = adopt_ref(*new XRefTable());
+
+    for (size_t i = 0; i < sections.size(); i += 2) {
+        auto starting_index = sections[i];
+        auto object_count = sections[i + 1];
+        if (static_cast<u64>(starting_index) + object_count > size)
+            return {};
+        if (bytes.size() - offset < object_count * entry_size)
+            return {};
+
+        Vector<XRefEntry> entries;
+        entries.ensure_capacity(object_count);
+
+        for (u32 j = 0; j < object_count; j++) {
+            auto type = read_field(field_widths[0], 1);
+            auto field2 = read_field(field_widths[1], 0);
+            auto field3 = read_field(field_widths[2], 0);
+
+            switch (type) {
+            case 0:
+                // A free object, with the number of the next free object and its generation number.
+                entries.unchecked_append({ static_cast<long>(field2), static_cast<u16>(field3), false });
+                break;
+            case 1:
+                // An object with its byte offset and generation number, like in an xref table.
+                entries.unchecked_append({ static_cast<long>(field2), static_cast<u16>(field3), true });
+                break;
+            case 2:
+                // A compressed object, with the number of its object stream and its index in there.
+                if (field3 > NumericLimits<u16>::max())
+                    return {};
+                entries.unchecked_append({ static_cast<long>(field2), static_cast<u16>(field3), true, true });
+                break;
+            default:
+                // Other types are reserved, and references to them are references to the null object.
+                entries.unchecked_append({});
+                break;
+            }
+        }
+
+        table->add_section({ static_cast<int>(starting_index), static_cast<int>(object_count), move(entries) });
+    }
+
+    trailer = dict;
+    return table;
+}
+
+Value Parser::parse_compressed_object_with_index(u32 index)
+{
+    auto object_stream_index = m_xref_table->object_stream_for_object(index);
+    auto index_in_object_stream = m_xref_table->index_in_object_stream_for_object(index);
+
+    // Object streams can't be compressed themselves, which also keeps us from going around in circles.
+    if (!m_xref_table->has_object(object_stream_index) || m_xref_table->is_object_compressed(object_stream_index))
+        return {};
+
+    // The document caches the object stream, so it doesn't have to be decoded again for every object in it.
+    auto object_stream_value = m_document->get_or_load_value(object_stream_index);
+    if (!object_stream_value.has<NonnullRefPtr<Object>>() || !object_stream_value.get<NonnullRefPtr<Object>>()->is_stream())
+        return {};
+
+    auto object_stream = object_cast<StreamObject>(object_stream_value.get<NonnullRefPtr<Object>>());
+    auto dict = object_stream->dict();
+    if (!dict->contains(CommonNames::Type, CommonNames::N, CommonNames::First))
+        return {};
+    if (dict->get_name(m_document, CommonNames::Type)->name() != CommonNames::ObjStm)
+        return {};
+
+    auto object_count = dict->get_value(CommonNames::N);
+    auto first_object_offset = dict->get_value(CommonNames::First);
+    if (!object_count.has_u32() || !first_object_offset.has_u32() || index_in_object_stream >= object_count.get_u32())
+        return {};
+
+    // The stream starts with a pair of numbers for every object in it: the object number, and the offset
+    // of the object relative to First. The objects themselves follow, without any "obj" and "endobj".
+    auto stream_parser = adopt_ref(*new Parser(object_stream->bytes()));
+    stream_parser->m_document = m_document;
+    stream_parser->m_xref_table = m_xref_table;
+
+    stream_parser->consume_whitespace();
+    for (size_t i = 0; i < index_in_object_stream; i++) {
+        stream_parser->parse_number();
+        stream_parser->parse_number();
+    }
+
+    auto object_number = stream_parser->parse_number();
+    auto object_offset = stream_parser->parse_number();
+    if (!object_number.has_u32() || object_number.get_u32() != index || !object_offset.has_u32())
+        return {};
+
+    auto object_start = static_cast<size_t>(first_object_offset.get_u32()) + object_offset.get_u32();
+    if (object_start >= object_stream->bytes().size())
+        return {};
+
+    stream_parser->m_reader.move_to(object_start);
+    return stream_parser->parse_value();
+}
+
 RefPtr<DictObject> Parser::parse_file_trailer()
 {
     if (!m_reader.matches("trailer"))
@@ -973,6 +1183,20 @@ RefPtr<DictObject> Parser::conditionally_parse_page_tree_node(u32 object_index,
     ok = true;
 
     VERIFY(m_xref_table->has_object(object_index));
+
+    if (m_xref_table->is_object_compressed(object_index)) {
+        // There's no cheap way to peek into an object in an object stream, so we load all of it.
+        auto value = m_document->get_or_load_value(object_index);
+        if (!value.has<NonnullRefPtr<Object>>() || !value.get<NonnullRefPtr<Object>>()->is_dict()) {
+            ok = false;
+            return {};
+        }
+        auto dict = object_cast<DictObject>(value.get<NonnullRefPtr<Object>>());
+        if (!dict->contains(CommonNames::Type) || dict->get_name(m_document, CommonNames::Type)->name() != CommonNames::Pages)
+            return {};
+        return dict;
+    }
+
     auto byte_offset = m_xref_table->byte_offset_for_object(object_index);
 
     m_reader.move_to(byte_offset);
@@ -1073,12 +1297,40 @@ RefPtr<StreamObject> Parser::parse_stream(NonnullRefPtr<DictObject> dict)
         auto maybe_bytes = Filter::decode(bytes, filter_type);
         if (!maybe_bytes.has_value())
             return {};
+        if (dict->contains(CommonNames::DecodeParms) && filter_type.is_one_of(CommonNames::FlateDecode, CommonNames::LZWDecode)) {
+            maybe_bytes = undo_predictor(dict, maybe_bytes.release_value());
+            if (!maybe_bytes.has_value())
+                return {};
+        }
         return make_object<EncodedStreamObject>(dict, move(maybe_bytes.value()));
     }
 
     return make_object<PlainTextStreamObject>(dict, bytes);
 }
 
+Optional<ByteBuffer> Parser::undo_predictor(NonnullRefPtr<DictObject> const& dict, ByteBuffer bytes)
+{
+    auto decode_parms = dict->get_dict(m_document, CommonNames::DecodeParms);
+    auto parameter = [&](FlyString const& name, u32 default_value) {
+        auto value = decode_parms->get(name);
+        if (!value.has_value() || !value->has_u32())
+            return default_value;
+        return value->get_u32();
+    };
+
+    auto predictor = parameter(CommonNames::Predictor, 1);
+    if (predictor == 1)
+        return bytes;
+
+    if (predictor < 10) {
+        // FIXME: Support the TIFF predictor.
+        dbgln("Predictor {} is not supported", predictor);
+        return bytes;
+    }
+
+    return Filter::undo_png_prediction(bytes, parameter(CommonNames::Columns, 1), parameter(CommonNames::Colors, 1), parameter(CommonNames::BitsPerComponent, 8));
+}
+
 Vector<Command> Parser::parse_graphics_commands()
 {
     Vector<Command> commands;
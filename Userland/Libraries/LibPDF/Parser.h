@@ -93,12 +93,17 @@ private:
     LinearizationResult initialize_linearization_dict();
     bool initialize_linearized_xref_table();
     bool initialize_non_linearized_xref_table();
+    bool initialize_xref_table_and_trailer(size_t xref_offset);
     bool initialize_hint_tables();
     Optional<PageOffsetHintTable> parse_page_offset_hint_table(ReadonlyBytes hint_stream_bytes);
     Optional<Vector<PageOffsetHintTableEntry>> parse_all_page_offset_hint_table_entries(PageOffsetHintTable const&, ReadonlyBytes hint_stream_bytes);
     RefPtr<XRefTable> parse_xref_table();
+    // Xref streams don't have a separate trailer, their stream dictionary doubles as one.
+    RefPtr<XRefTable> parse_xref_stream(RefPtr<DictObject>& trailer);
     RefPtr<DictObject> parse_file_trailer();
 
+    Value parse_compressed_object_with_index(u32 index);
+
     bool navigate_to_before_eof_marker();
     bool navigate_to_after_startxref();
 
@@ -124,6 +129,7 @@ private:
     RefPtr<ArrayObject> parse_array();
     RefPtr<DictObject> parse_dict();
     RefPtr<StreamObject> parse_stream(NonnullRefPtr<DictObject> dict);
+    Optional<ByteBuffer> undo_predictor(NonnullRefPtr<DictObject> const& dict, ByteBuffer);
 
     Vector<Command> parse_graphics_commands();
 
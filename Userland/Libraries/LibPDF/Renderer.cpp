@@ -22,7 +22,12 @@ namespace PDF {
 
 void Renderer::render(Document& document, Page const& page, RefPtr<Gfx::Bitmap> bitmap)
 {
-    Renderer(document, page, bitmap).render();
+    render(document, page, parse_page_commands(document, page), move(bitmap));
+}
+
+void Renderer::render(Document& document, Page const& page, Vector<Command> const& commands, RefPtr<Gfx::Bitmap> bitmap)
+{
+    Renderer(document, page, bitmap).render(commands);
 }
 
 Renderer::Renderer(RefPtr<Document> document, Page const& page, RefPtr<Gfx::Bitmap> bitmap)
@@ -56,7 +61,7 @@ Renderer::Renderer(RefPtr<Document> document, Page const& page, RefPtr<Gfx::Bitm
     m_bitmap->fill(Gfx::Color::NamedColor::White);
 }
 
-void Renderer::render()
+Vector<Command> Renderer::parse_page_commands(Document& document, Page const& page)
 {
     // Use our own vector, as the /Content can be an array with multiple
     // streams which gets concatenated
@@ -65,20 +70,23 @@ void Renderer::render()
     // as one stream or multiple?
     ByteBuffer byte_buffer;
 
-    if (m_page.contents->is_array()) {
-        auto contents = object_cast<ArrayObject>(m_page.contents);
+    if (page.contents->is_array()) {
+        auto contents = object_cast<ArrayObject>(page.contents);
         for (auto& ref : *contents) {
-            auto bytes = m_document->resolve_to<StreamObject>(ref)->bytes();
+            auto bytes = document.resolve_to<StreamObject>(ref)->bytes();
             byte_buffer.append(bytes.data(), bytes.size());
         }
     } else {
-        VERIFY(m_page.contents->is_stream());
-        auto bytes = object_cast<StreamObject>(m_page.contents)->bytes();
+        VERIFY(page.contents->is_stream());
+        auto bytes = object_cast<StreamObject>(page.contents)->bytes();
         byte_buffer.append(bytes.data(), bytes.size());
     }
 
-    auto commands = Parser::parse_graphics_commands(byte_buffer);
+    return Parser::parse_graphics_commands(byte_buffer);
+}
 
+void Renderer::render(Vector<Command> const& commands)
+{
     for (auto& command : commands)
         handle_command(command);
 }
@@ -81,10 +81,15 @@ class Renderer {
 public:
     static void render(Document&, Page const&, RefPtr<Gfx::Bitmap>);
 
+    // Parsing the contents of a page doesn't depend on the size it's rendered at, so the commands
+    // can be kept around to render the same page again (e.g. at another zoom level) more quickly.
+    static Vector<Command> parse_page_commands(Document&, Page const&);
+    static void render(Document&, Page const&, Vector<Command> const&, RefPtr<Gfx::Bitmap>);
+
 private:
     Renderer(RefPtr<Document>, Page const&, RefPtr<Gfx::Bitmap>);
 
-    void render();
+    void render(Vector<Command> const&);
 
     void handle_command(Command const&);
 #define V(name, snake_name, symbol) \
@@ -19,6 +19,9 @@ struct XRefEntry {
     long byte_offset { invalid_byte_offset };
     u16 generation_number { 0 };
     bool in_use { false };
+    // Compressed objects are stored in an object stream, so they don't have a byte offset. Instead,
+    // byte_offset is the index of that stream, and generation_number the index of the object in it.
+    bool compressed { false };
 };
 
 struct XRefSection {
@@ -29,57 +32,44 @@ struct XRefSection {
 
 class XRefTable final : public RefCounted<XRefTable> {
 public:
-    bool merge(XRefTable&& other)
+    // Fills in the objects that this table doesn't know about from an older table,
+    // i.e. from the one that the file had before it was updated incrementally.
+    void merge_older_table(XRefTable const& older)
     {
-        auto this_size = m_entries.size();
-        auto other_size = other.m_entries.size();
-        m_entries.ensure_capacity(other_size);
-
-        for (size_t i = 0; i < other_size; i++) {
-            auto other_entry = other.m_entries[i];
-            if (i >= this_size) {
-                m_entries.unchecked_append(other_entry);
-                continue;
-            }
-
-            auto this_entry = m_entries[i];
-
-            if (this_entry.byte_offset == invalid_byte_offset) {
-                m_entries[i] = other_entry;
-            } else if (other_entry.byte_offset != invalid_byte_offset) {
-                // Both xref tables have an entry for the same object index
-                return false;
-            }
-        }
+        merge(older, [](auto& entry) { return entry.byte_offset == invalid_byte_offset; });
+    }
 
-        return true;
+    // Hybrid-reference files have an xref stream next to the xref table, for the objects that only readers
+    // which understand object streams should see. The xref table lists those objects as free, if at all.
+    void merge_hybrid_xref_stream(XRefTable const& stream)
+    {
+        merge(stream, [](auto& entry) { return !entry.in_use; });
     }
 
     void add_section(XRefSection const& section)
     {
-        m_entries.ensure_capacity(section.starting_index + section.count);
+        auto end_index = static_cast<size_t>(section.starting_index) + section.entries.size();
+        if (end_index > m_entries.size())
+            m_entries.resize(end_index);
 
-        for (int i = static_cast<int>(m_entries.size()); i < section.starting_index; i++)
-            m_entries.append(XRefEntry {});
-
-        for (auto& entry : section.entries)
-            m_entries.append(entry);
+        for (size_t i = 0; i < section.entries.size(); i++)
+            m_entries[section.starting_index + i] = section.entries[i];
     }
 
     [[nodiscard]] ALWAYS_INLINE bool has_object(size_t index) const
     {
-        return index < m_entries.size() && m_entries[index].byte_offset != -1;
+        return index < m_entries.size() && m_entries[index].byte_offset != invalid_byte_offset;
     }
 
     [[nodiscard]] ALWAYS_INLINE long byte_offset_for_object(size_t index) const
     {
-        VERIFY(has_object(index));
+        VERIFY(has_object(index) && !is_object_compressed(index));
         return m_entries[index].byte_offset;
     }
 
     [[nodiscard]] ALWAYS_INLINE u16 generation_number_for_object(size_t index) const
     {
-        VERIFY(has_object(index));
+        VERIFY(has_object(index) && !is_object_compressed(index));
         return m_entries[index].generation_number;
     }
 
@@ -89,9 +79,39 @@ public:
         return m_entries[index].in_use;
     }
 
+    [[nodiscard]] ALWAYS_INLINE bool is_object_compressed(size_t index) const
+    {
+        VERIFY(has_object(index));
+        return m_entries[index].compressed;
+    }
+
+    [[nodiscard]] ALWAYS_INLINE u32 object_stream_for_object(size_t index) const
+    {
+        VERIFY(is_object_compressed(index));
+        return m_entries[index].byte_offset;
+    }
+
+    [[nodiscard]] ALWAYS_INLINE u16 index_in_object_stream_for_object(size_t index) const
+    {
+        VERIFY(is_object_compressed(index));
+        return m_entries[index].generation_number;
+    }
+
 private:
     friend struct AK::Formatter<PDF::XRefTable>;
 
+    template<typename Callback>
+    void merge(XRefTable const& other, Callback should_replace_entry)
+    {
+        if (other.m_entries.size() > m_entries.size())
+            m_entries.resize(other.m_entries.size());
+
+        for (size_t i = 0; i < other.m_entries.size(); i++) {
+            if (other.m_entries[i].byte_offset != invalid_byte_offset && should_replace_entry(m_entries[i]))
+                m_entries[i] = other.m_entries[i];
+        }
+    }
+
     Vector<XRefEntry> m_entries;
 };
 
@@ -104,10 +124,11 @@ struct Formatter<PDF::XRefEntry> : Formatter<StringView> {
     ErrorOr<void> format(FormatBuilder& builder, PDF::XRefEntry const& entry)
     {
         return Formatter<StringView>::format(builder,
-            String::formatted("XRefEntry {{ offset={} generation={} used={} }}",
+            String::formatted("XRefEntry {{ offset={} generation={} used={} compressed={} }}",
                 entry.byte_offset,
                 entry.generation_number,
-                entry.in_use));
+                entry.in_use,
+                entry.compressed));
     }
 };
 
@@ -37,7 +37,8 @@ void Request::stream_into(OutputStream& stream)
     };
 
     notifier->on_ready_to_read = [this, &stream, user_on_finish = move(user_on_finish)] {
-        constexpr size_t buffer_size = 4096;
+        // RequestServer stops reading from the network while we fall behind, so take in as much as we can per wakeup.
+        constexpr size_t buffer_size = 64 * KiB;
         static char buf[buffer_size];
         auto nread = m_internal_stream_data->read_stream.read({ buf, buffer_size });
         if (!stream.write_or_error({ buf, nread })) {
@@ -20,6 +20,7 @@
 #include <signal.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/internals.h>
 #include <sys/mman.h>
 #include <syscall.h>
 #include <time.h>
@@ -94,6 +95,7 @@ static int create_thread(pthread_t* thread, void* (*entry)(void*), void* argumen
 [[noreturn]] static void exit_thread(void* code, void* stack_location, size_t stack_size)
 {
     __pthread_key_destroy_for_current_thread();
+    __malloc_thread_exit();
     syscall(SC_exit_thread, code, stack_location, stack_size);
     VERIFY_NOT_REACHED();
 }
@@ -624,8 +626,6 @@ int pthread_equal(pthread_t t1, pthread_t t2)
     return t1 == t2;
 }
 
-// FIXME: Use the fancy futex mechanism above to write an rw lock.
-//        For the time being, let's just use a less-than-good lock to get things working.
 // https://pubs.opengroup.org/onlinepubs/009695399/functions/pthread_rwlock_destroy.html
 int pthread_rwlock_destroy(pthread_rwlock_t* rl)
 {
@@ -634,18 +634,40 @@ int pthread_rwlock_destroy(pthread_rwlock_t* rl)
     return 0;
 }
 
-// In a very non-straightforward way, this value is composed of two 32-bit integers
-// the top 32 bits are reserved for the ID of write-locking thread (if any)
-// and the bottom 32 bits are:
-//     top 2 bits (30,31): reader wake mask, writer wake mask
-//     middle 16 bits: information
-//        bit 16: someone is waiting to write
-//        bit 17: locked for write
-//     bottom 16 bits (0..15): reader count
-constexpr static u32 reader_wake_mask = 1 << 30;
-constexpr static u32 writer_wake_mask = 1 << 31;
-constexpr static u32 writer_locked_mask = 1 << 17;
-constexpr static u32 writer_intent_mask = 1 << 16;
+// The lock is two 32-bit integers: the bottom one is the lock word that readers and writers wait on,
+// and the top one holds the ID of the thread that has locked it for writing (if any).
+//
+// The lock word is made up of:
+//     bit 31: locked for writing
+//     bit 30: some writers might be waiting
+//     bit 29: some readers might be waiting
+//     bits 0..28: reader count
+//
+// Writers are preferred: once a writer is waiting, new readers have to wait until it's done. This means
+// that a thread that already holds a read lock must not take it again while a writer might be waiting.
+//
+// Like with mutexes, the waiting flags are set pessimistically. A writer that had to sleep sets the writer
+// flag again once it gets the lock, as it doesn't know whether there are more writers behind it. An unlock
+// that finds nobody to wake up is what finally clears the flags.
+constexpr static u32 rwlock_write_locked = 1u << 31;
+constexpr static u32 rwlock_writers_waiting = 1u << 30;
+constexpr static u32 rwlock_readers_waiting = 1u << 29;
+constexpr static u32 rwlock_reader_count_mask = rwlock_readers_waiting - 1;
+
+// Readers and writers sleep on the same futex, but are woken separately.
+constexpr static u32 rwlock_reader_wake_bitset = 1;
+constexpr static u32 rwlock_writer_wake_bitset = 2;
+
+static u32* rwlock_word(pthread_rwlock_t* lockp)
+{
+    return reinterpret_cast<u32*>(lockp);
+}
+
+static i32* rwlock_writer_id(pthread_rwlock_t* lockp)
+{
+    return reinterpret_cast<i32*>(lockp) + 1;
+}
+
 // https://pubs.opengroup.org/onlinepubs/009695399/functions/pthread_rwlock_init.html
 int pthread_rwlock_init(pthread_rwlock_t* __restrict lockp, const pthread_rwlockattr_t* __restrict attr)
 {
@@ -657,100 +679,104 @@ int pthread_rwlock_init(pthread_rwlock_t* __restrict lockp, const pthread_rwlock
     return 0;
 }
 
-// Note that this function does not care about the top 32 bits at all.
-static int rwlock_rdlock_maybe_timed(u32* lockp, const struct timespec* timeout = nullptr, bool only_once = false, int value_if_timeout = -1, int value_if_okay = -2)
-{
-    auto current = AK::atomic_load(lockp);
-    for (; !only_once;) {
-        // First, see if this is locked for writing
-        // if it's not, try to add to the counter.
-        // If someone is waiting to write, and there is one or no other readers, let them have the lock.
-        if (!(current & writer_locked_mask)) {
-            auto count = (u16)current;
-            if (!(current & writer_intent_mask) || count > 1) {
-                ++count;
-                auto desired = (current & 0xffff0000u) | count;
-                auto did_exchange = AK::atomic_compare_exchange_strong(lockp, current, desired, AK::MemoryOrder::memory_order_acquire);
-                if (!did_exchange)
-                    continue; // tough luck, try again.
-                return value_if_okay;
-            }
-        }
+static int rwlock_wait(u32* word, u32 value, const struct timespec* abstime, u32 bitset)
+{
+    // POSIX measures the timeouts against CLOCK_REALTIME.
+    int op = abstime ? FUTEX_WAIT_BITSET | FUTEX_CLOCK_REALTIME : FUTEX_WAIT_BITSET;
+    int rc = futex(word, op, value, abstime, nullptr, bitset);
+    if (rc < 0 && errno != EAGAIN && errno != EINTR)
+        return errno;
+    return 0;
+}
 
-        // If no one else is waiting for the read wake bit, set it.
-        if (!(current & reader_wake_mask)) {
-            auto desired = current | reader_wake_mask;
-            auto did_exchange = AK::atomic_compare_exchange_strong(lockp, current, desired, AK::MemoryOrder::memory_order_acquire);
-            if (!did_exchange)
-                continue; // Something interesting happened!
+// Called after the lock has become free, with the flags of who might be waiting for it.
+static void rwlock_wake_waiters(u32* word)
+{
+    auto current = AK::atomic_load(word, AK::memory_order_relaxed);
+    while ((current & rwlock_writers_waiting) && !(current & rwlock_write_locked) && (current & rwlock_reader_count_mask) == 0) {
+        if (!AK::atomic_compare_exchange_strong(word, current, current & ~rwlock_writers_waiting, AK::memory_order_relaxed))
+            continue;
+        int rc = futex(word, FUTEX_WAKE_BITSET, 1, nullptr, nullptr, rwlock_writer_wake_bitset);
+        VERIFY(rc >= 0);
+        if (rc > 0)
+            return;
+        // Nobody was actually waiting to write (any more), so let the readers in.
+        current = AK::atomic_load(word, AK::memory_order_relaxed);
+    }
 
-            current = desired;
-        }
+    if (!(current & rwlock_readers_waiting) || (current & (rwlock_write_locked | rwlock_writers_waiting)))
+        return;
+    current = AK::atomic_fetch_and(word, ~rwlock_readers_waiting, AK::memory_order_relaxed);
+    if (current & rwlock_readers_waiting) {
+        int rc = futex(word, FUTEX_WAKE_BITSET, INT32_MAX, nullptr, nullptr, rwlock_reader_wake_bitset);
+        VERIFY(rc >= 0);
+    }
+}
 
-        // Seems like someone is writing (or is interested in writing and we let them have the lock)
-        // wait until they're done.
-        auto rc = futex(lockp, FUTEX_WAIT_BITSET, current, timeout, nullptr, reader_wake_mask);
-        if (rc < 0 && errno == ETIMEDOUT && timeout) {
-            return value_if_timeout;
+static int rwlock_rdlock(pthread_rwlock_t* lockp, const struct timespec* abstime, bool only_once)
+{
+    auto* word = rwlock_word(lockp);
+    auto current = AK::atomic_load(word, AK::memory_order_relaxed);
+    while (true) {
+        if (!(current & (rwlock_write_locked | rwlock_writers_waiting))) {
+            if ((current & rwlock_reader_count_mask) == rwlock_reader_count_mask)
+                return EAGAIN;
+            if (AK::atomic_compare_exchange_strong(word, current, current + 1, AK::memory_order_acquire))
+                return 0;
+            continue;
         }
-        if (rc < 0 && errno != EAGAIN) {
-            // Something broke. let's just bail out.
-            return errno;
+
+        if (only_once)
+            return EBUSY;
+
+        if (!(current & rwlock_readers_waiting)) {
+            if (!AK::atomic_compare_exchange_strong(word, current, current | rwlock_readers_waiting, AK::memory_order_relaxed))
+                continue;
+            current |= rwlock_readers_waiting;
         }
-        errno = 0;
-        // Reload the 'current' value
-        current = AK::atomic_load(lockp);
+
+        if (auto rc = rwlock_wait(word, current, abstime, rwlock_reader_wake_bitset); rc != 0)
+            return rc;
+        current = AK::atomic_load(word, AK::memory_order_relaxed);
     }
-    return value_if_timeout;
-}
-
-static int rwlock_wrlock_maybe_timed(pthread_rwlock_t* lockval_p, const struct timespec* timeout = nullptr, bool only_once = false, int value_if_timeout = -1, int value_if_okay = -2)
-{
-    u32* lockp = reinterpret_cast<u32*>(lockval_p);
-    auto current = AK::atomic_load(lockp);
-    for (; !only_once;) {
-        // First, see if this is locked for writing, and if there are any readers.
-        // if not, lock it.
-        // If someone is waiting to write, let them have the lock.
-        if (!(current & writer_locked_mask) && ((u16)current) == 0) {
-            if (!(current & writer_intent_mask)) {
-                auto desired = current | writer_locked_mask | writer_intent_mask;
-                auto did_exchange = AK::atomic_compare_exchange_strong(lockp, current, desired, AK::MemoryOrder::memory_order_acquire);
-                if (!did_exchange)
-                    continue;
-
-                // Now that we've locked the value, it's safe to set our thread ID.
-                AK::atomic_store(reinterpret_cast<i32*>(lockval_p) + 1, pthread_self());
-                return value_if_okay;
-            }
+}
+
+static int rwlock_wrlock(pthread_rwlock_t* lockp, const struct timespec* abstime, bool only_once)
+{
+    auto* word = rwlock_word(lockp);
+    auto current = AK::atomic_load(word, AK::memory_order_relaxed);
+    bool did_wait = false;
+    while (true) {
+        if (!(current & rwlock_write_locked) && (current & rwlock_reader_count_mask) == 0) {
+            auto desired = current | rwlock_write_locked;
+            if (did_wait)
+                desired |= rwlock_writers_waiting;
+            if (!AK::atomic_compare_exchange_strong(word, current, desired, AK::memory_order_acquire))
+                continue;
+
+            // Now that we've locked the value, it's safe to set our thread ID.
+            AK::atomic_store(rwlock_writer_id(lockp), pthread_self(), AK::memory_order_relaxed);
+            return 0;
         }
 
-        // That didn't work, if no one else is waiting for the write bit, set it.
-        if (!(current & writer_wake_mask)) {
-            auto desired = current | writer_wake_mask | writer_intent_mask;
-            auto did_exchange = AK::atomic_compare_exchange_strong(lockp, current, desired, AK::MemoryOrder::memory_order_acquire);
-            if (!did_exchange)
-                continue; // Something interesting happened!
+        if (only_once)
+            return EBUSY;
 
-            current = desired;
+        if (!(current & rwlock_writers_waiting)) {
+            if (!AK::atomic_compare_exchange_strong(word, current, current | rwlock_writers_waiting, AK::memory_order_relaxed))
+                continue;
+            current |= rwlock_writers_waiting;
         }
 
-        // Seems like someone is writing (or is interested in writing and we let them have the lock)
-        // wait until they're done.
-        auto rc = futex(lockp, FUTEX_WAIT_BITSET, current, timeout, nullptr, writer_wake_mask);
-        if (rc < 0 && errno == ETIMEDOUT && timeout) {
-            return value_if_timeout;
-        }
-        if (rc < 0 && errno != EAGAIN) {
-            // Something broke. let's just bail out.
-            return errno;
+        if (auto rc = rwlock_wait(word, current, abstime, rwlock_writer_wake_bitset); rc != 0) {
+            // We might have been the writer that the readers are holding back for, and the lock might have
+            // been released in the meantime. Give the wakeup we might have swallowed to someone else.
+            rwlock_wake_waiters(word);
+            return rc;
         }
-        errno = 0;
-        // Reload the 'current' value
-        current = AK::atomic_load(lockp);
+        did_wait = true;
+        current = AK::atomic_load(word, AK::memory_order_relaxed);
     }
-
-    return value_if_timeout;
 }
 
 // https://pubs.opengroup.org/onlinepubs/009695399/functions/pthread_rwlock_rdlock.html
@@ -759,7 +785,7 @@ int pthread_rwlock_rdlock(pthread_rwlock_t* lockp)
     if (!lockp)
         return EINVAL;
 
-    return rwlock_rdlock_maybe_timed(reinterpret_cast<u32*>(lockp), nullptr, false, 0, 0);
+    return rwlock_rdlock(lockp, nullptr, false);
 }
 
 // https://pubs.opengroup.org/onlinepubs/009695399/functions/pthread_rwlock_timedrdlock.html
@@ -768,12 +794,7 @@ int pthread_rwlock_timedrdlock(pthread_rwlock_t* __restrict lockp, const struct
     if (!lockp)
         return EINVAL;
 
-    auto rc = rwlock_rdlock_maybe_timed(reinterpret_cast<u32*>(lockp), timespec);
-    if (rc == -1) // "ok"
-        return 0;
-    if (rc == -2) // "timed out"
-        return 1;
-    return rc;
+    return rwlock_rdlock(lockp, timespec, false);
 }
 
 // https://pubs.opengroup.org/onlinepubs/009695399/functions/pthread_rwlock_timedwrlock.html
@@ -782,12 +803,7 @@ int pthread_rwlock_timedwrlock(pthread_rwlock_t* __restrict lockp, const struct
     if (!lockp)
         return EINVAL;
 
-    auto rc = rwlock_wrlock_maybe_timed(lockp, timespec);
-    if (rc == -1) // "ok"
-        return 0;
-    if (rc == -2) // "timed out"
-        return 1;
-    return rc;
+    return rwlock_wrlock(lockp, timespec, false);
 }
 
 // https://pubs.opengroup.org/onlinepubs/009695399/functions/pthread_rwlock_tryrdlock.html
@@ -796,7 +812,7 @@ int pthread_rwlock_tryrdlock(pthread_rwlock_t* lockp)
     if (!lockp)
         return EINVAL;
 
-    return rwlock_rdlock_maybe_timed(reinterpret_cast<u32*>(lockp), nullptr, true, EBUSY, 0);
+    return rwlock_rdlock(lockp, nullptr, true);
 }
 
 // https://pubs.opengroup.org/onlinepubs/009695399/functions/pthread_rwlock_trywrlock.html
@@ -805,50 +821,41 @@ int pthread_rwlock_trywrlock(pthread_rwlock_t* lockp)
     if (!lockp)
         return EINVAL;
 
-    return rwlock_wrlock_maybe_timed(lockp, nullptr, true, EBUSY, 0);
+    return rwlock_wrlock(lockp, nullptr, true);
 }
 
 // https://pubs.opengroup.org/onlinepubs/009695399/functions/pthread_rwlock_unlock.html
-int pthread_rwlock_unlock(pthread_rwlock_t* lockval_p)
+int pthread_rwlock_unlock(pthread_rwlock_t* lockp)
 {
-    if (!lockval_p)
+    if (!lockp)
         return EINVAL;
 
     // This is a weird API, we don't really know whether we're unlocking write or read...
-    auto lockp = reinterpret_cast<u32*>(lockval_p);
-    auto current = AK::atomic_load(lockp, AK::MemoryOrder::memory_order_relaxed);
-    if (current & writer_locked_mask) {
+    auto* word = rwlock_word(lockp);
+    auto current = AK::atomic_load(word, AK::memory_order_relaxed);
+    if (current & rwlock_write_locked) {
         // If this lock is locked for writing, its owner better be us!
-        auto owner_id = AK::atomic_load(reinterpret_cast<i32*>(lockval_p) + 1);
-        auto my_id = pthread_self();
-        if (owner_id != my_id)
+        if (AK::atomic_load(rwlock_writer_id(lockp), AK::memory_order_relaxed) != pthread_self())
             return EINVAL; // you don't own this lock, silly.
 
-        // Now just unlock it.
-        auto desired = current & ~(writer_locked_mask | writer_intent_mask);
-        AK::atomic_store(lockp, desired, AK::MemoryOrder::memory_order_release);
-        // Then wake both readers and writers, if any.
-        auto rc = futex(lockp, FUTEX_WAKE_BITSET, current, nullptr, nullptr, (current & writer_wake_mask) | reader_wake_mask);
-        if (rc < 0)
-            return errno;
-        return 0;
-    }
+        AK::atomic_store(rwlock_writer_id(lockp), 0, AK::memory_order_relaxed);
+        current = AK::atomic_fetch_and(word, ~rwlock_write_locked, AK::memory_order_release);
+    } else {
+        do {
+            if ((current & rwlock_reader_count_mask) == 0) {
+                // Are you crazy? this isn't even locked!
+                return EINVAL;
+            }
+        } while (!AK::atomic_compare_exchange_strong(word, current, current - 1, AK::memory_order_release));
 
-    for (;;) {
-        auto count = (u16)current;
-        if (!count) {
-            // Are you crazy? this isn't even locked!
-            return EINVAL;
-        }
-        --count;
-        auto desired = (current & 0xffff0000u) | count;
-        auto did_exchange = AK::atomic_compare_exchange_strong(lockp, current, desired, AK::MemoryOrder::memory_order_release);
-        if (did_exchange)
-            break;
-        // tough luck, try again.
+        // Other readers are still holding the lock, they'll take care of waking up whoever is waiting.
+        if ((current & rwlock_reader_count_mask) > 1)
+            return 0;
     }
 
-    // Finally, unlocked at last!
+    // Fast path: nobody is waiting.
+    if (current & (rwlock_writers_waiting | rwlock_readers_waiting))
+        rwlock_wake_waiters(word);
     return 0;
 }
 
@@ -858,7 +865,7 @@ int pthread_rwlock_wrlock(pthread_rwlock_t* lockp)
     if (!lockp)
         return EINVAL;
 
-    return rwlock_wrlock_maybe_timed(lockp, nullptr, false, 0, 0);
+    return rwlock_wrlock(lockp, nullptr, false);
 }
 
 // https://pubs.opengroup.org/onlinepubs/009695399/functions/pthread_rwlockattr_destroy.html
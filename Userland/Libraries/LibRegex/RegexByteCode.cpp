@@ -154,8 +154,8 @@ static bool restore_string_position(MatchInput const& input, MatchState& state)
     return true;
 }
 
-OwnPtr<OpCode> ByteCode::s_opcodes[(size_t)OpCodeId::Last + 1];
-bool ByteCode::s_opcodes_initialized { false };
+__thread OpCode* ByteCode::s_opcodes[(size_t)OpCodeId::Last + 1];
+__thread bool ByteCode::s_opcodes_initialized { false };
 
 void ByteCode::ensure_opcodes_initialized()
 {
@@ -163,9 +163,9 @@ void ByteCode::ensure_opcodes_initialized()
         return;
     for (u32 i = (u32)OpCodeId::First; i <= (u32)OpCodeId::Last; ++i) {
         switch ((OpCodeId)i) {
-#define __ENUMERATE_OPCODE(OpCode)              \
-    case OpCodeId::OpCode:                      \
-        s_opcodes[i] = make<OpCode_##OpCode>(); \
+#define __ENUMERATE_OPCODE(OpCode)          \
+    case OpCodeId::OpCode:                  \
+        s_opcodes[i] = new OpCode_##OpCode; \
         break;
 
             ENUMERATE_OPCODES
@@ -180,6 +180,8 @@ ALWAYS_INLINE OpCode& ByteCode::get_opcode_by_id(OpCodeId id) const
 {
     VERIFY(id >= OpCodeId::First && id <= OpCodeId::Last);
 
+    // The bytecode may have been created on another thread.
+    ensure_opcodes_initialized();
     auto& opcode = s_opcodes[(u32)id];
     opcode->set_bytecode(*const_cast<ByteCode*>(this));
     return *opcode;
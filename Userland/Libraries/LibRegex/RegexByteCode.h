@@ -512,10 +512,13 @@ private:
             empend((ByteCodeValueType)view[i]);
     }
 
-    void ensure_opcodes_initialized();
+    static void ensure_opcodes_initialized();
     ALWAYS_INLINE OpCode& get_opcode_by_id(OpCodeId id) const;
-    static OwnPtr<OpCode> s_opcodes[(size_t)OpCodeId::Last + 1];
-    static bool s_opcodes_initialized;
+
+    // The opcodes carry the state of the current match, so every thread needs its own set. They are never freed, as
+    // there is no way to run destructors for thread-local variables.
+    static __thread OpCode* s_opcodes[(size_t)OpCodeId::Last + 1];
+    static __thread bool s_opcodes_initialized;
 };
 
 #define ENUMERATE_EXECUTION_RESULTS                          \
@@ -0,0 +1,369 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/CharacterTypes.h>
+#include <AK/HashTable.h>
+#include <AK/QuickSort.h>
+#include <AK/Utf16View.h>
+#include <AK/Utf32View.h>
+#include <AK/Utf8View.h>
+#include <LibRegex/RegexLazyDFA.h>
+
+namespace regex {
+
+LazyDFA::LazyDFA(ByteCode const& bytecode)
+    : m_bytecode(bytecode)
+{
+    m_supported = check_supported();
+}
+
+bool LazyDFA::check_supported() const
+{
+    for (size_t instruction_position = 0; instruction_position < m_bytecode.size();) {
+        MatchState state;
+        state.instruction_position = instruction_position;
+        auto& opcode = m_bytecode.get_opcode(state);
+
+        switch ((OpCodeId)m_bytecode.at(instruction_position)) {
+        case OpCodeId::Save:
+        case OpCodeId::Restore:
+        case OpCodeId::GoBack:
+            // Lookaround.
+            return false;
+        case OpCodeId::Compare: {
+            auto arguments_count = m_bytecode.at(instruction_position + 1);
+            size_t offset = instruction_position + 3;
+            for (size_t i = 0; i < arguments_count; ++i) {
+                switch ((CharacterCompareType)m_bytecode.at(offset++)) {
+                case CharacterCompareType::Inverse:
+                case CharacterCompareType::TemporaryInverse:
+                case CharacterCompareType::AnyChar:
+                    break;
+                case CharacterCompareType::Char:
+                case CharacterCompareType::CharClass:
+                case CharacterCompareType::CharRange:
+                case CharacterCompareType::Property:
+                case CharacterCompareType::GeneralCategory:
+                case CharacterCompareType::Script:
+                case CharacterCompareType::ScriptExtension:
+                    ++offset;
+                    break;
+                case CharacterCompareType::LookupTable:
+                    offset += m_bytecode.at(offset) + 1;
+                    break;
+                case CharacterCompareType::String:
+                    // Strings are matched one character at a time, which only works if nothing else is compared alongside them.
+                    if (arguments_count != 1)
+                        return false;
+                    offset += m_bytecode.at(offset) + 1;
+                    break;
+                default:
+                    // Backreferences.
+                    return false;
+                }
+            }
+            break;
+        }
+        default:
+            break;
+        }
+
+        instruction_position += opcode.size();
+    }
+    return true;
+}
+
+bool LazyDFA::is_string_compare(size_t instruction_position) const
+{
+    return m_bytecode.at(instruction_position + 1) == 1 && (CharacterCompareType)m_bytecode.at(instruction_position + 3) == CharacterCompareType::String;
+}
+
+static void sort_and_remove_duplicates(Vector<u64>& positions)
+{
+    quick_sort(positions);
+    size_t unique_count = 0;
+    for (size_t i = 0; i < positions.size(); ++i) {
+        if (unique_count == 0 || positions[unique_count - 1] != positions[i])
+            positions[unique_count++] = positions[i];
+    }
+    positions.shrink(unique_count);
+}
+
+// Collects the Compare positions that can be reached from the given instruction without consuming any input.
+// Assertions (^, $, \b) are assumed to hold, and forks follow both paths; both only ever allow more input to match.
+LazyDFA::Closure const& LazyDFA::closure(size_t instruction_position)
+{
+    if (auto it = m_closures.find(instruction_position); it != m_closures.end())
+        return it->value;
+
+    Closure closure;
+    HashTable<size_t> visited;
+    Vector<size_t> to_visit;
+    to_visit.append(instruction_position);
+
+    while (!to_visit.is_empty()) {
+        auto ip = to_visit.take_last();
+        if (ip >= m_bytecode.size()) {
+            closure.accepting = true;
+            continue;
+        }
+        if (visited.set(ip) != AK::HashSetResult::InsertedNewEntry)
+            continue;
+
+        MatchState state;
+        state.instruction_position = ip;
+        auto& opcode = m_bytecode.get_opcode(state);
+        auto next = ip + opcode.size();
+
+        switch ((OpCodeId)m_bytecode.at(ip)) {
+        case OpCodeId::Compare:
+            // A lone empty string matches without consuming anything.
+            if (is_string_compare(ip) && m_bytecode.at(ip + 4) == 0)
+                to_visit.append(next);
+            else
+                closure.positions.append(position(ip, 0));
+            break;
+        case OpCodeId::Jump:
+            to_visit.append(next + static_cast<ssize_t>(m_bytecode.at(ip + 1)));
+            break;
+        case OpCodeId::ForkJump:
+        case OpCodeId::ForkStay:
+        case OpCodeId::ForkReplaceJump:
+        case OpCodeId::ForkReplaceStay:
+        case OpCodeId::JumpNonEmpty:
+            to_visit.append(next + static_cast<ssize_t>(m_bytecode.at(ip + 1)));
+            to_visit.append(next);
+            break;
+        case OpCodeId::Repeat:
+            to_visit.append(ip - m_bytecode.at(ip + 1));
+            to_visit.append(next);
+            break;
+        case OpCodeId::FailForks:
+        case OpCodeId::Exit:
+            // Both fail the current path; reaching the end of the bytecode is what succeeds.
+            break;
+        default:
+            to_visit.append(next);
+            break;
+        }
+    }
+
+    sort_and_remove_duplicates(closure.positions);
+    m_closures.set(instruction_position, move(closure));
+    return m_closures.find(instruction_position)->value;
+}
+
+void LazyDFA::add_closure(size_t instruction_position, Vector<u64>& positions, bool& accepting)
+{
+    auto& closure = this->closure(instruction_position);
+    positions.extend(closure.positions);
+    accepting |= closure.accepting;
+}
+
+// Runs the Compare at the given position against a single code point, so it matches exactly like it would in the backtracking matcher.
+bool LazyDFA::compare_matches(size_t instruction_position, u32 code_point) const
+{
+    MatchInput input;
+    input.view = Utf32View { &code_point, 1 };
+    input.regex_options = m_options;
+
+    MatchState state;
+    state.instruction_position = instruction_position;
+    auto& opcode = m_bytecode.get_opcode(state);
+    auto result = opcode.execute(input, state);
+    return result == ExecutionResult::Continue && state.string_position == 1;
+}
+
+Optional<u32> LazyDFA::state_for(Automaton& automaton, Vector<u64>&& positions, bool accepting)
+{
+    // States with the same positions differ if only one of them has reached the end of the bytecode.
+    auto key = positions;
+    if (accepting)
+        key.append(accepting_position);
+
+    if (auto it = automaton.state_ids.find(key); it != automaton.state_ids.end())
+        return it->value;
+
+    if (automaton.states.size() >= max_state_count)
+        return {};
+
+    auto state = make<State>();
+    state->positions = move(positions);
+    state->accepting = accepting;
+    state->ascii_transitions.fill(unknown_state);
+
+    u32 state_id = automaton.states.size();
+    automaton.states.append(move(state));
+    automaton.state_ids.set(move(key), state_id);
+    return state_id;
+}
+
+Optional<u32> LazyDFA::start_state(Automaton& automaton)
+{
+    if (!automaton.start_state.has_value()) {
+        Vector<u64> positions;
+        bool accepting = false;
+        add_closure(0, positions, accepting);
+        automaton.start_state = state_for(automaton, move(positions), accepting);
+    }
+    return automaton.start_state;
+}
+
+Optional<u32> LazyDFA::transition(Automaton& automaton, u32 state_id, u32 code_point, bool anchored)
+{
+    auto& state = automaton.states[state_id];
+    if (code_point < state.ascii_transitions.size()) {
+        if (state.ascii_transitions[code_point] != unknown_state)
+            return state.ascii_transitions[code_point];
+    } else if (auto it = state.transitions.find(code_point); it != state.transitions.end()) {
+        return it->value;
+    }
+
+    Vector<u64> positions;
+    bool accepting = false;
+    for (auto current : state.positions) {
+        auto ip = instruction_position_of(current);
+        MatchState opcode_state;
+        opcode_state.instruction_position = ip;
+        auto next = ip + m_bytecode.get_opcode(opcode_state).size();
+
+        if (!is_string_compare(ip)) {
+            if (compare_matches(ip, code_point))
+                add_closure(next, positions, accepting);
+            continue;
+        }
+
+        auto string_offset = string_offset_of(current);
+        auto length = m_bytecode.at(ip + 4);
+        auto expected = m_bytecode.at(ip + 5 + string_offset);
+        bool equal;
+        if (expected >= 0x80 || code_point >= 0x80)
+            equal = true; // FIXME: Compare non-ASCII characters the way the view being matched against does.
+        else if (m_options & AllFlags::Insensitive)
+            equal = to_ascii_lowercase(expected) == to_ascii_lowercase(code_point);
+        else
+            equal = expected == code_point;
+
+        if (!equal)
+            continue;
+        if (string_offset + 1 < length)
+            positions.append(position(ip, string_offset + 1));
+        else
+            add_closure(next, positions, accepting);
+    }
+
+    // Without an anchor, a new match may start after every character.
+    if (!anchored)
+        add_closure(0, positions, accepting);
+
+    sort_and_remove_duplicates(positions);
+    auto next_state_id = state_for(automaton, move(positions), accepting);
+    if (!next_state_id.has_value())
+        return {};
+
+    if (code_point < state.ascii_transitions.size())
+        state.ascii_transitions[code_point] = *next_state_id;
+    else
+        state.transitions.set(code_point, *next_state_id);
+    return next_state_id;
+}
+
+bool LazyDFA::may_match(RegexStringView view, size_t start_position, AllOptions options, bool anchored, bool must_reach_end)
+{
+    if (!m_supported || start_position > view.length())
+        return true;
+
+    if (options.value() != m_options.value()) {
+        m_options = options;
+        m_anchored = {};
+        m_unanchored = {};
+    }
+
+    auto& automaton = anchored ? m_anchored : m_unanchored;
+    auto current = start_state(automaton);
+    if (!current.has_value())
+        return true;
+    if (automaton.states[*current].accepting && !must_reach_end)
+        return true;
+
+    Optional<bool> result;
+    auto feed = [&](u32 code_point) {
+        current = transition(automaton, *current, code_point, anchored);
+        if (!current.has_value()) {
+            result = true;
+            return false;
+        }
+        auto& state = automaton.states[*current];
+        if (state.accepting && !must_reach_end) {
+            result = true;
+            return false;
+        }
+        if (state.positions.is_empty() && !state.accepting) {
+            result = false;
+            return false;
+        }
+        return true;
+    };
+
+    view.visit(
+        [&](StringView string) {
+            for (size_t i = start_position; i < string.length(); ++i) {
+                u8 byte = string[i];
+                // In unicode mode, the matcher advances over bytes as if they were code points.
+                if (byte >= 0x80 && view.unicode()) {
+                    result = true;
+                    return;
+                }
+                if (!feed(byte))
+                    return;
+            }
+        },
+        [&](Utf32View const& utf32) {
+            for (size_t i = start_position; i < utf32.length(); ++i) {
+                if (!feed(utf32[i]))
+                    return;
+            }
+        },
+        [&](Utf16View const& utf16) {
+            if (view.unicode()) {
+                // Lone surrogates are matched as they are, rather than as replacement characters.
+                for (size_t i = utf16.code_unit_offset_of(start_position); i < utf16.length_in_code_units();) {
+                    auto code_point = utf16.code_point_at(i);
+                    if (!feed(code_point))
+                        return;
+                    i += code_point < 0x10000 ? 1 : 2;
+                }
+                return;
+            }
+            for (size_t i = start_position; i < utf16.length_in_code_units(); ++i) {
+                auto code_unit = utf16.code_unit_at(i);
+                // Outside of unicode mode, the matcher doesn't read surrogates consistently.
+                if (Utf16View::is_high_surrogate(code_unit) || Utf16View::is_low_surrogate(code_unit)) {
+                    result = true;
+                    return;
+                }
+                if (!feed(code_unit))
+                    return;
+            }
+        },
+        [&](Utf8View const& utf8) {
+            // Outside of unicode mode, the matcher doesn't read UTF-8 consistently.
+            if (!view.unicode()) {
+                result = true;
+                return;
+            }
+            for (auto code_point : utf8.unicode_substring_view(start_position)) {
+                if (!feed(code_point))
+                    return;
+            }
+        });
+
+    if (result.has_value())
+        return *result;
+    return automaton.states[*current].accepting;
+}
+
+}
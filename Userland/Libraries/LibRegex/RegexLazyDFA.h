@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include "RegexByteCode.h"
+#include "RegexMatch.h"
+#include "RegexOptions.h"
+
+#include <AK/Array.h>
+#include <AK/HashFunctions.h>
+#include <AK/HashMap.h>
+#include <AK/NonnullOwnPtrVector.h>
+#include <AK/NumericLimits.h>
+#include <AK/Traits.h>
+#include <AK/Types.h>
+#include <AK/Vector.h>
+
+namespace regex {
+
+// A DFA that is built lazily, one transition at a time, from the bytecode of a pattern.
+// Its states are sets of positions in the bytecode, so running it over the input takes linear time and
+// doesn't allocate once the transitions it needs have been built.
+//
+// The backtracking matcher prefers some paths over others and gives up on paths it has replaced or
+// failed (e.g. in atomic groups), which the DFA knows nothing about. The DFA accepts a superset of what the
+// backtracking matcher accepts, so it is only used to reject input that cannot match at all.
+// Patterns with backreferences or lookaround are not supported, and leave all the work to the backtracking matcher.
+class LazyDFA {
+public:
+    explicit LazyDFA(ByteCode const&);
+
+    bool is_supported() const { return m_supported; }
+
+    // Returns false if no match can start at or after start_position in the view.
+    // If anchored, only matches starting at start_position are considered; if must_reach_end, only matches ending at the end of the view are.
+    bool may_match(RegexStringView, size_t start_position, AllOptions, bool anchored, bool must_reach_end);
+
+private:
+    static constexpr size_t max_state_count = 4096;
+    static constexpr u32 unknown_state = NumericLimits<u32>::max();
+    static constexpr u64 accepting_position = NumericLimits<u64>::max();
+
+    // A position is the instruction position of a Compare and, for String compares, the number of characters already compared.
+    static u64 position(size_t instruction_position, size_t string_offset) { return (static_cast<u64>(instruction_position) << 32) | string_offset; }
+    static size_t instruction_position_of(u64 position) { return position >> 32; }
+    static size_t string_offset_of(u64 position) { return position & 0xffffffff; }
+
+    struct PositionSetTraits : public GenericTraits<Vector<u64>> {
+        static unsigned hash(Vector<u64> const& positions)
+        {
+            unsigned hash = 0;
+            for (auto position : positions)
+                hash = pair_int_hash(hash, u64_hash(position));
+            return hash;
+        }
+    };
+
+    struct Closure {
+        Vector<u64> positions;
+        bool accepting { false };
+    };
+
+    struct State {
+        Vector<u64> positions;
+        bool accepting { false };
+        Array<u32, 128> ascii_transitions;
+        HashMap<u32, u32> transitions;
+    };
+
+    struct Automaton {
+        NonnullOwnPtrVector<State> states;
+        HashMap<Vector<u64>, u32, PositionSetTraits> state_ids;
+        Optional<u32> start_state;
+    };
+
+    bool check_supported() const;
+    bool is_string_compare(size_t instruction_position) const;
+    Closure const& closure(size_t instruction_position);
+    void add_closure(size_t instruction_position, Vector<u64>& positions, bool& accepting);
+    bool compare_matches(size_t instruction_position, u32 code_point) const;
+    Optional<u32> state_for(Automaton&, Vector<u64>&& positions, bool accepting);
+    Optional<u32> start_state(Automaton&);
+    Optional<u32> transition(Automaton&, u32 state_id, u32 code_point, bool anchored);
+
+    ByteCode const& m_bytecode;
+    bool m_supported { false };
+    AllOptions m_options;
+    HashMap<size_t, Closure> m_closures;
+    Automaton m_anchored;
+    Automaton m_unanchored;
+};
+
+}
@@ -80,6 +80,12 @@ public:
     bool unicode() const { return m_unicode; }
     void set_unicode(bool unicode) { m_unicode = unicode; }
 
+    template<typename... Visitors>
+    decltype(auto) visit(Visitors&&... visitors) const
+    {
+        return m_view.visit(forward<Visitors>(visitors)...);
+    }
+
     bool is_empty() const
     {
         return m_view.visit([](auto& view) { return view.is_empty(); });
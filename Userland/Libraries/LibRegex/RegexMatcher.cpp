@@ -4,12 +4,15 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
-#include <AK/BumpAllocator.h>
 #include <AK/Debug.h>
+#include <AK/IntrusiveList.h>
+#include <AK/ObjectPool.h>
 #include <AK/String.h>
 #include <AK/StringBuilder.h>
+#include <AK/StringSearcher.h>
 #include <LibRegex/RegexMatcher.h>
 #include <LibRegex/RegexParser.h>
+#include <LibThreading/Mutex.h>
 
 #if REGEX_DEBUG
 #    include <LibRegex/RegexDebug.h>
@@ -21,6 +24,95 @@ namespace regex {
 static RegexDebug s_regex_dbg(stderr);
 #endif
 
+// Optimized parse results of recently compiled patterns, shared by everyone compiling patterns with the same parser.
+// The cache is bounded by the memory used by the bytecode, and throws out the least recently used patterns first.
+template<class Parser>
+class CompiledPatternCache {
+public:
+    static CompiledPatternCache& the()
+    {
+        static CompiledPatternCache s_the;
+        return s_the;
+    }
+
+    struct Key {
+        String pattern;
+        FlagsUnderlyingType options { 0 };
+
+        bool operator==(Key const&) const = default;
+    };
+
+    struct Entry {
+        // NOTE: Named capture groups point into the pattern, so whoever uses the bytecode has to keep this string alive.
+        String pattern;
+        regex::Parser::Result parser_result;
+    };
+
+    Optional<Entry> get(Key const& key)
+    {
+        Threading::MutexLocker locker(m_mutex);
+        auto it = m_entries.find(key);
+        if (it == m_entries.end())
+            return {};
+        auto& node = *it->value;
+        m_least_recently_used.remove(node);
+        m_least_recently_used.append(node);
+        return Entry { node.key.pattern, node.parser_result };
+    }
+
+    void set(Key const& key, regex::Parser::Result const& parser_result)
+    {
+        Threading::MutexLocker locker(m_mutex);
+        if (auto it = m_entries.find(key); it != m_entries.end())
+            remove(*it->value);
+
+        auto node = make<Node>(key, parser_result);
+        if (node->size_in_bytes() > m_budget_in_bytes)
+            return;
+        m_size_in_bytes += node->size_in_bytes();
+        m_least_recently_used.append(*node);
+        m_entries.set(key, move(node));
+        while (m_size_in_bytes > m_budget_in_bytes)
+            remove(*m_least_recently_used.first());
+    }
+
+private:
+    CompiledPatternCache() = default;
+
+    struct KeyTraits : public GenericTraits<Key> {
+        static unsigned hash(Key const& key) { return pair_int_hash(key.pattern.hash(), key.options); }
+    };
+
+    struct Node {
+        Node(Key key, regex::Parser::Result parser_result)
+            : key(move(key))
+            , parser_result(move(parser_result))
+        {
+        }
+
+        Key key;
+        regex::Parser::Result parser_result;
+        IntrusiveListNode<Node> list_node;
+
+        size_t size_in_bytes() const { return sizeof(Node) + key.pattern.length() + parser_result.bytecode.size() * sizeof(ByteCodeValueType); }
+    };
+
+    void remove(Node& node)
+    {
+        m_size_in_bytes -= node.size_in_bytes();
+        m_least_recently_used.remove(node);
+        // NOTE: This destroys the node, so we have to take a copy of the key first.
+        auto key = node.key;
+        m_entries.remove(key);
+    }
+
+    Threading::Mutex m_mutex;
+    HashMap<Key, NonnullOwnPtr<Node>, KeyTraits> m_entries;
+    IntrusiveList<&Node::list_node> m_least_recently_used;
+    size_t m_size_in_bytes { 0 };
+    size_t m_budget_in_bytes { 4 * MiB };
+};
+
 template<class Parser>
 regex::Parser::Result Regex<Parser>::parse_pattern(StringView pattern, typename ParserTraits<Parser>::OptionsType regex_options)
 {
@@ -54,6 +146,26 @@ Regex<Parser>::Regex(regex::Parser::Result parse_result, String pattern, typenam
         matcher = make<Matcher<Parser>>(this, regex_options);
 }
 
+template<class Parser>
+Regex<Parser> Regex<Parser>::compile_cached(String pattern, typename ParserTraits<Parser>::OptionsType regex_options)
+{
+    auto& cache = CompiledPatternCache<Parser>::the();
+    typename CompiledPatternCache<Parser>::Key key { move(pattern), static_cast<FlagsUnderlyingType>(regex_options.value()) };
+
+    if (auto entry = cache.get(key); entry.has_value()) {
+        Regex regex;
+        regex.pattern_value = move(entry->pattern);
+        regex.parser_result = move(entry->parser_result);
+        if (regex.parser_result.error == regex::Error::NoError)
+            regex.matcher = make<Matcher<Parser>>(&regex, regex_options);
+        return regex;
+    }
+
+    Regex regex(key.pattern, regex_options);
+    cache.set(key, regex.parser_result);
+    return regex;
+}
+
 template<class Parser>
 Regex<Parser>::Regex(Regex&& regex)
     : pattern_value(move(regex.pattern_value))
@@ -112,6 +224,22 @@ RegexResult Matcher<Parser>::match(RegexStringView view, Optional<typename Parse
     return match(views, regex_options);
 }
 
+// Returns the bytes of the view from the given position on, if positions in the view are byte offsets.
+static Optional<ReadonlyBytes> bytes_from(RegexStringView const& view, size_t position)
+{
+    if (position > view.length_in_code_units())
+        return {};
+
+    return view.visit(
+        [&](StringView string) -> Optional<ReadonlyBytes> { return string.bytes().slice(position); },
+        [&](Utf8View const& utf8) -> Optional<ReadonlyBytes> {
+            if (view.unicode())
+                return {};
+            return utf8.as_string().bytes().slice(position);
+        },
+        [](auto const&) -> Optional<ReadonlyBytes> { return {}; });
+}
+
 template<typename Parser>
 RegexResult Matcher<Parser>::match(Vector<RegexStringView> const& views, Optional<typename ParserTraits<Parser>::OptionsType> regex_options) const
 {
@@ -181,6 +309,24 @@ RegexResult Matcher<Parser>::match(Vector<RegexStringView> const& views, Optiona
     if (input.regex_options.has_flag_set(AllFlags::Internal_Stateful))
         continue_search = false;
 
+    // Stateful matches carry their start offset over from one view to the next, so views are only skipped for them if there is just one.
+    bool is_stateful = input.regex_options.has_flag_set(AllFlags::Internal_Stateful);
+    bool can_skip_views = !is_stateful || views.size() == 1;
+    if (can_skip_views && !m_lazy_dfa)
+        m_lazy_dfa = make<LazyDFA>(m_pattern->parser_result.bytecode);
+
+    // Literals that every match starts with or contains are searched for directly, which is much faster than
+    // running the bytecode at every position. The optimizer only collects them for case-sensitive matching.
+    auto const& optimization_data = m_pattern->parser_result.optimization_data;
+    Optional<StringSearcher> required_literal_searcher;
+    Optional<StringSearcher> literal_prefix_searcher;
+    if (!input.regex_options.has_flag_set(AllFlags::Insensitive)) {
+        if (!optimization_data.required_literal.is_empty())
+            required_literal_searcher.emplace(optimization_data.required_literal.view());
+        if (!optimization_data.literal_prefix.is_empty() && continue_search)
+            literal_prefix_searcher.emplace(optimization_data.literal_prefix.view());
+    }
+
     for (auto const& view : views) {
         if (lines_to_skip != 0) {
             ++input.line;
@@ -190,6 +336,24 @@ RegexResult Matcher<Parser>::match(Vector<RegexStringView> const& views, Optiona
         input.view = view;
         dbgln_if(REGEX_DEBUG, "[match] Starting match with view ({}): _{}_", view.length(), view);
 
+        // Without continue_search, a match has to start at the start offset, and unless the match is stateful, a single view has to be matched in full.
+        bool must_reach_end = !continue_search && !is_stateful && views.size() == 1;
+        bool cannot_match = false;
+        if (can_skip_views && required_literal_searcher.has_value()) {
+            if (auto bytes = bytes_from(view, m_pattern->start_offset); bytes.has_value())
+                cannot_match = !required_literal_searcher->is_in(*bytes);
+        }
+        if (can_skip_views && !cannot_match)
+            cannot_match = !m_lazy_dfa->may_match(view, m_pattern->start_offset, input.regex_options, !continue_search, must_reach_end);
+        if (cannot_match) {
+            dbgln_if(REGEX_DEBUG, "[match] View cannot match");
+            if (is_stateful)
+                return { false, 0, {}, {}, {}, operations };
+            ++input.line;
+            input.global_offset += view.length() + 1; // +1 includes the line break character
+            continue;
+        }
+
         auto view_length = view.length();
         size_t view_index = m_pattern->start_offset;
         state.string_position = view_index;
@@ -225,6 +389,15 @@ RegexResult Matcher<Parser>::match(Vector<RegexStringView> const& views, Optiona
         }
 
         for (; view_index < view_length; ++view_index) {
+            if (literal_prefix_searcher.has_value()) {
+                if (auto bytes = bytes_from(view, view_index); bytes.has_value()) {
+                    auto offset = literal_prefix_searcher->find(*bytes);
+                    if (!offset.has_value())
+                        break;
+                    view_index += *offset;
+                }
+            }
+
             auto& match_length_minimum = m_pattern->parser_result.match_length_minimum;
             // FIXME: More performant would be to know the remaining minimum string
             //        length needed to match from the current position onwards within
@@ -327,13 +500,21 @@ RegexResult Matcher<Parser>::match(Vector<RegexStringView> const& views, Optiona
 }
 
 template<typename T>
-class BumpAllocatedLinkedList {
+class PooledLinkedList {
 public:
-    BumpAllocatedLinkedList() = default;
+    PooledLinkedList() = default;
+    ~PooledLinkedList()
+    {
+        for (auto* node = m_first; node;) {
+            auto* next = node->next;
+            m_pool.deallocate(node);
+            node = next;
+        }
+    }
 
     ALWAYS_INLINE void append(T value)
     {
-        auto node_ptr = m_allocator.allocate(move(value));
+        auto node_ptr = m_pool.allocate(move(value));
         VERIFY(node_ptr);
 
         if (!m_first) {
@@ -350,7 +531,8 @@ public:
     ALWAYS_INLINE T take_last()
     {
         VERIFY(m_last);
-        T value = move(m_last->value);
+        auto* node = m_last;
+        T value = move(node->value);
         if (m_last == m_first) {
             m_last = nullptr;
             m_first = nullptr;
@@ -358,6 +540,8 @@ public:
             m_last = m_last->previous;
             m_last->next = nullptr;
         }
+        // Backtracking pushes and pops states all the time, so give the node back to be reused right away.
+        m_pool.deallocate(node);
         return value;
     }
 
@@ -402,7 +586,7 @@ private:
         Node* m_node;
     };
 
-    UniformBumpAllocator<Node, true, 2 * MiB> m_allocator;
+    ObjectPool<Node, 64 * KiB> m_pool;
     Node* m_first { nullptr };
     Node* m_last { nullptr };
 };
@@ -410,7 +594,7 @@ private:
 template<class Parser>
 Optional<bool> Matcher<Parser>::execute(MatchInput const& input, MatchState& state, size_t& operations) const
 {
-    BumpAllocatedLinkedList<MatchState> states_to_try_next;
+    PooledLinkedList<MatchState> states_to_try_next;
     size_t recursion_level = 0;
 
     auto& bytecode = m_pattern->parser_result.bytecode;
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "RegexByteCode.h"
+#include "RegexLazyDFA.h"
 #include "RegexMatch.h"
 #include "RegexOptions.h"
 #include "RegexParser.h"
@@ -71,6 +72,7 @@ public:
     void reset_pattern(Badge<Regex<Parser>>, Regex<Parser> const* pattern)
     {
         m_pattern = pattern;
+        m_lazy_dfa = nullptr;
     }
 
 private:
@@ -78,6 +80,7 @@ private:
 
     Regex<Parser> const* m_pattern;
     typename ParserTraits<Parser>::OptionsType const m_regex_options;
+    mutable OwnPtr<LazyDFA> m_lazy_dfa;
 };
 
 template<class Parser>
@@ -90,6 +93,10 @@ public:
 
     static regex::Parser::Result parse_pattern(StringView pattern, typename ParserTraits<Parser>::OptionsType regex_options = {});
 
+    // Compiles the pattern like the constructor does, but copies the optimized bytecode from a process-wide cache
+    // if the same pattern has been compiled with the same options before.
+    static Regex<Parser> compile_cached(String pattern, typename ParserTraits<Parser>::OptionsType regex_options = {});
+
     explicit Regex(String pattern, typename ParserTraits<Parser>::OptionsType regex_options = {});
     Regex(regex::Parser::Result parse_result, String pattern, typename ParserTraits<Parser>::OptionsType regex_options = {});
     ~Regex() = default;
@@ -231,8 +238,11 @@ public:
     static BasicBlockList split_basic_blocks(ByteCode const&);
 
 private:
+    Regex() = default;
+
     void run_optimization_passes();
     void attempt_rewrite_loops_as_atomic_groups(BasicBlockList const&);
+    void fill_optimization_data();
 };
 
 // free standing functions for match, search and has_match
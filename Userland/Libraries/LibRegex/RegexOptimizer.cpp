@@ -24,6 +24,124 @@ void Regex<Parser>::run_optimization_passes()
     attempt_rewrite_loops_as_atomic_groups(split_basic_blocks(parser_result.bytecode));
 
     parser_result.bytecode.flatten();
+
+    if (parser_result.error == Error::NoError)
+        fill_optimization_data();
+}
+
+template<typename Parser>
+void Regex<Parser>::fill_optimization_data()
+{
+    auto& bytecode = parser_result.bytecode;
+    auto bytecode_size = bytecode.size();
+
+    // An instruction that is jumped over by some forward jump or fork may not run; any other instruction runs on
+    // every path that reaches the end of the bytecode. Count the forward jumps over each instruction.
+    Vector<int> jumps_over;
+    jumps_over.resize(bytecode_size + 1);
+    MatchState state;
+    for (state.instruction_position = 0; state.instruction_position < bytecode_size;) {
+        auto& opcode = bytecode.get_opcode(state);
+        auto next = state.instruction_position + opcode.size();
+        ssize_t offset = 0;
+
+        switch (opcode.opcode_id()) {
+        case OpCodeId::Jump:
+            offset = static_cast<OpCode_Jump const&>(opcode).offset();
+            break;
+        case OpCodeId::JumpNonEmpty:
+            offset = static_cast<OpCode_JumpNonEmpty const&>(opcode).offset();
+            break;
+        case OpCodeId::ForkJump:
+        case OpCodeId::ForkReplaceJump:
+            offset = static_cast<OpCode_ForkJump const&>(opcode).offset();
+            break;
+        case OpCodeId::ForkStay:
+        case OpCodeId::ForkReplaceStay:
+            offset = static_cast<OpCode_ForkStay const&>(opcode).offset();
+            break;
+        case OpCodeId::Save:
+        case OpCodeId::Restore:
+        case OpCodeId::GoBack:
+            // Lookarounds look at input outside of the match.
+            return;
+        default:
+            break;
+        }
+
+        if (offset > 0) {
+            ++jumps_over[next];
+            --jumps_over[min(next + offset, bytecode_size)];
+        }
+        state.instruction_position = next;
+    }
+
+    // Runs of literal characters that run on every path are substrings of every match.
+    auto& optimization_data = parser_result.optimization_data;
+    StringBuilder literal;
+    bool literal_is_prefix = true;
+    auto end_literal = [&] {
+        if (literal.is_empty())
+            return;
+        auto string = literal.build();
+        literal.clear();
+        if (literal_is_prefix)
+            optimization_data.literal_prefix = string;
+        if (string.length() > optimization_data.required_literal.length())
+            optimization_data.required_literal = move(string);
+    };
+
+    int jumped_over = 0;
+    size_t checked_up_to = 0;
+    for (state.instruction_position = 0; state.instruction_position < bytecode_size;) {
+        auto& opcode = bytecode.get_opcode(state);
+        for (; checked_up_to <= state.instruction_position; ++checked_up_to)
+            jumped_over += jumps_over[checked_up_to];
+
+        switch (opcode.opcode_id()) {
+        case OpCodeId::SaveLeftCaptureGroup:
+        case OpCodeId::SaveRightCaptureGroup:
+        case OpCodeId::SaveRightNamedCaptureGroup:
+        case OpCodeId::ClearCaptureGroup:
+        case OpCodeId::Checkpoint:
+        case OpCodeId::CheckBegin:
+        case OpCodeId::CheckEnd:
+        case OpCodeId::CheckBoundary:
+            // These don't consume anything, so a literal can go on past them.
+            break;
+        case OpCodeId::Compare: {
+            auto& compare = static_cast<OpCode_Compare const&>(opcode);
+            auto compares = compare.flat_compares();
+            bool is_literal = jumped_over == 0 && compares.size() == 1;
+            if (is_literal && compares.first().type == CharacterCompareType::Char) {
+                is_literal = compares.first().value < 0x80;
+                if (is_literal)
+                    literal.append(static_cast<char>(compares.first().value));
+            } else if (is_literal && compares.first().type == CharacterCompareType::String) {
+                auto offset = state.instruction_position + 4;
+                auto length = bytecode.at(offset++);
+                for (size_t i = 0; is_literal && i < length; ++i)
+                    is_literal = bytecode.at(offset + i) < 0x80;
+                for (size_t i = 0; is_literal && i < length; ++i)
+                    literal.append(static_cast<char>(bytecode.at(offset + i)));
+            } else {
+                is_literal = false;
+            }
+            if (!is_literal) {
+                end_literal();
+                literal_is_prefix = false;
+            }
+            break;
+        }
+        default:
+            end_literal();
+            literal_is_prefix = false;
+            break;
+        }
+
+        state.instruction_position += opcode.size();
+    }
+    end_literal();
 }
 
 template<typename Parser>
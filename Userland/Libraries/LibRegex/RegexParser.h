@@ -54,6 +54,12 @@ public:
         Error error;
         Token error_token;
         Vector<FlyString> capture_groups;
+
+        // Filled in by the optimizer. Both are ASCII, and only hold for case-sensitive matches.
+        struct {
+            String literal_prefix;   // Every match starts with this.
+            String required_literal; // Every match contains this.
+        } optimization_data {};
     };
 
     explicit Parser(Lexer& lexer)
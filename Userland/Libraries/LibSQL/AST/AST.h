@@ -300,6 +300,7 @@ struct ExecutionContext {
     RefPtr<SQLResult> result { nullptr };
     class Statement const* statement;
     Tuple* current_row { nullptr };
+    Vector<Value> placeholder_values {};
 };
 
 class Expression : public ASTNode {
@@ -356,6 +357,20 @@ public:
     virtual Value evaluate(ExecutionContext&) const override;
 };
 
+class Placeholder : public Expression {
+public:
+    explicit Placeholder(size_t parameter_index)
+        : m_parameter_index(parameter_index)
+    {
+    }
+
+    size_t parameter_index() const { return m_parameter_index; }
+    virtual Value evaluate(ExecutionContext&) const override;
+
+private:
+    size_t m_parameter_index { 0 };
+};
+
 class NestedExpression : public Expression {
 public:
     const NonnullRefPtr<Expression>& expression() const { return m_expression; }
@@ -724,7 +739,7 @@ private:
 
 class Statement : public ASTNode {
 public:
-    RefPtr<SQLResult> execute(AK::NonnullRefPtr<Database> database) const;
+    RefPtr<SQLResult> execute(AK::NonnullRefPtr<Database> database, Vector<Value> placeholder_values = {}) const;
     virtual RefPtr<SQLResult> execute(ExecutionContext&) const { return nullptr; }
 };
 
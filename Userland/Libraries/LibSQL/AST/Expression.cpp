@@ -40,6 +40,17 @@ Value NullLiteral::evaluate(ExecutionContext&) const
     return Value::null();
 }
 
+Value Placeholder::evaluate(ExecutionContext& context) const
+{
+    if (context.result->has_error())
+        return Value::null();
+    if (m_parameter_index >= context.placeholder_values.size()) {
+        context.result->set_error(SQLErrorCode::InvalidNumberOfPlaceholderValues);
+        return Value::null();
+    }
+    return context.placeholder_values[m_parameter_index];
+}
+
 Value NestedExpression::evaluate(ExecutionContext& context) const
 {
     if (context.result->has_error())
@@ -17,6 +17,8 @@ Parser::Parser(Lexer lexer)
 
 NonnullRefPtr<Statement> Parser::next_statement()
 {
+    m_parser_state.m_placeholder_count = 0;
+
     auto terminate_statement = [this](auto statement) {
         consume(TokenType::SemiColon);
         return statement;
@@ -388,7 +390,6 @@ NonnullRefPtr<Expression> Parser::parse_expression()
     if (match_secondary_expression())
         expression = parse_secondary_expression(move(expression));
 
-    // FIXME: Parse 'bind-parameter'.
     // FIXME: Parse 'function-name'.
     // FIXME: Parse 'raise-function'.
 
@@ -401,6 +402,9 @@ NonnullRefPtr<Expression> Parser::parse_primary_expression()
     if (auto expression = parse_literal_value_expression())
         return expression.release_nonnull();
 
+    if (auto expression = parse_bind_parameter_expression())
+        return expression.release_nonnull();
+
     if (auto expression = parse_column_name_expression())
         return expression.release_nonnull();
 
@@ -515,6 +519,15 @@ RefPtr<Expression> Parser::parse_literal_value_expression()
     return {};
 }
 
+RefPtr<Expression> Parser::parse_bind_parameter_expression()
+{
+    // https://sqlite.org/lang_expr.html#varparam
+    // FIXME: Support numbered and named parameters ("?NNN", ":AAAA", "@AAAA", and "$AAAA").
+    if (consume_if(TokenType::QuestionMark))
+        return create_ast_node<Placeholder>(m_parser_state.m_placeholder_count++);
+    return {};
+}
+
 RefPtr<Expression> Parser::parse_column_name_expression(String with_parsed_identifier, bool with_parsed_period)
 {
     if (with_parsed_identifier.is_null() && !match(TokenType::Identifier))
@@ -4,6 +4,9 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/HashMap.h>
+#include <AK/QuickSort.h>
+#include <AK/TypeCasts.h>
 #include <LibSQL/AST/AST.h>
 #include <LibSQL/Database.h>
 #include <LibSQL/Meta.h>
@@ -11,6 +14,514 @@
 
 namespace SQL::AST {
 
+// The planner splits the WHERE clause into its AND-ed conjuncts and attaches every conjunct to
+// the earliest point where all the columns it uses are available: a filter on a single table is
+// applied while that table is scanned, and a filter over several tables right after the last of
+// them is joined in. An equality between columns of two tables is used to hash join them, which
+// keeps the intermediate results from growing into the full cartesian product.
+// FIXME: Tables don't carry secondary indexes yet. Once they do, equality and range conjuncts on
+//        indexed columns should become BTree or HashIndex scans instead of filtered table scans.
+
+struct ColumnReference {
+    size_t table { 0 };
+    size_t column { 0 };
+};
+
+struct JoinKey {
+    ColumnReference outer;
+    size_t inner_column { 0 };
+};
+
+struct TableScan {
+    RefPtr<TableDef> table;
+    NonnullRefPtr<TupleDescriptor> descriptor;
+    size_t offset { 0 };
+    Vector<Expression const*> filters;
+    Vector<Expression const*> join_filters;
+    Optional<JoinKey> join_key;
+};
+
+static void collect_conjuncts(Expression const& expression, Vector<Expression const*>& conjuncts)
+{
+    if (is<BinaryOperatorExpression>(expression)) {
+        auto& binary_expression = static_cast<BinaryOperatorExpression const&>(expression);
+        if (binary_expression.type() == BinaryOperator::And) {
+            collect_conjuncts(*binary_expression.lhs(), conjuncts);
+            collect_conjuncts(*binary_expression.rhs(), conjuncts);
+            return;
+        }
+    }
+    conjuncts.append(&expression);
+}
+
+// Mirrors the lookup in ColumnNameExpression::evaluate, but across all tables. Columns that
+// don't exist or are ambiguous are left for the final filter, which reports the error.
+static Optional<ColumnReference> resolve_column(ColumnNameExpression const& column, Vector<TableScan> const& scans)
+{
+    Optional<ColumnReference> reference;
+    for (auto table_ix = 0u; table_ix < scans.size(); table_ix++) {
+        auto& descriptor = *scans[table_ix].descriptor;
+        for (auto ix = 0u; ix < descriptor.size(); ix++) {
+            if (!column.table_name().is_empty() && descriptor[ix].table != column.table_name())
+                continue;
+            if (descriptor[ix].name != column.column_name())
+                continue;
+            if (reference.has_value())
+                return {};
+            reference = ColumnReference { table_ix, ix };
+        }
+    }
+    return reference;
+}
+
+// Returns false if the expression uses something the planner can't attribute to a set of tables.
+static bool collect_tables(Expression const& expression, Vector<TableScan> const& scans, Vector<bool>& tables)
+{
+    if (is<NumericLiteral>(expression) || is<StringLiteral>(expression) || is<BlobLiteral>(expression) || is<NullLiteral>(expression))
+        return true;
+    if (is<ColumnNameExpression>(expression)) {
+        auto reference = resolve_column(static_cast<ColumnNameExpression const&>(expression), scans);
+        if (!reference.has_value())
+            return false;
+        tables[reference->table] = true;
+        return true;
+    }
+    if (is<UnaryOperatorExpression>(expression) || is<CastExpression>(expression) || is<CollateExpression>(expression))
+        return collect_tables(*static_cast<NestedExpression const&>(expression).expression(), scans, tables);
+    if (is<BinaryOperatorExpression>(expression)) {
+        auto& binary_expression = static_cast<BinaryOperatorExpression const&>(expression);
+        return collect_tables(*binary_expression.lhs(), scans, tables) && collect_tables(*binary_expression.rhs(), scans, tables);
+    }
+    if (is<MatchExpression>(expression)) {
+        auto& match_expression = static_cast<MatchExpression const&>(expression);
+        if (match_expression.escape() && !collect_tables(*match_expression.escape(), scans, tables))
+            return false;
+        return collect_tables(*match_expression.lhs(), scans, tables) && collect_tables(*match_expression.rhs(), scans, tables);
+    }
+    if (is<ChainedExpression>(expression)) {
+        for (auto& chained_expression : static_cast<ChainedExpression const&>(expression).expressions()) {
+            if (!collect_tables(chained_expression, scans, tables))
+                return false;
+        }
+        return true;
+    }
+    return false;
+}
+
+// An equality between columns of two different tables of the same type can be hash joined.
+// This is limited to types where equal values also hash the same.
+static Optional<JoinKey> join_key_for(Expression const& expression, Vector<TableScan> const& scans, size_t table)
+{
+    if (!is<BinaryOperatorExpression>(expression))
+        return {};
+    auto& binary_expression = static_cast<BinaryOperatorExpression const&>(expression);
+    if (binary_expression.type() != BinaryOperator::Equals)
+        return {};
+    if (!is<ColumnNameExpression>(*binary_expression.lhs()) || !is<ColumnNameExpression>(*binary_expression.rhs()))
+        return {};
+    auto lhs = resolve_column(static_cast<ColumnNameExpression const&>(*binary_expression.lhs()), scans);
+    auto rhs = resolve_column(static_cast<ColumnNameExpression const&>(*binary_expression.rhs()), scans);
+    if (!lhs.has_value() || !rhs.has_value())
+        return {};
+    if (rhs->table != table)
+        swap(lhs, rhs);
+    if (rhs->table != table || lhs->table >= table)
+        return {};
+    auto type = (*scans[table].descriptor)[rhs->column].type;
+    if (type != (*scans[lhs->table].descriptor)[lhs->column].type)
+        return {};
+    if (type != SQLType::Text && type != SQLType::Integer)
+        return {};
+    return JoinKey { lhs.value(), rhs->column };
+}
+
+static Optional<bool> evaluate_filters(Vector<Expression const*> const& filters, ExecutionContext& context, Tuple& row)
+{
+    context.current_row = &row;
+    for (auto* filter : filters) {
+        auto value = filter->evaluate(context);
+        if (context.result->has_error())
+            return {};
+        if (value.is_null())
+            return false;
+        auto matches = value.to_bool();
+        if (!matches.has_value()) {
+            context.result->set_error(SQLErrorCode::BooleanOperatorTypeMismatch, BinaryOperator_name(BinaryOperator::And));
+            return {};
+        }
+        if (!matches.value())
+            return false;
+    }
+    return true;
+}
+
+// The rows of a SELECT are produced by a pipeline of operators. Every operator pulls rows from the
+// one below it only when asked for its next row, so rows reach the client as they are found, and a
+// LIMIT stops the scan as soon as it has produced enough rows. Only the inner side of a join and
+// the input of an ORDER BY have to be kept in memory.
+class Operator {
+public:
+    virtual ~Operator() = default;
+
+    // Returns an empty Optional when there are no more rows, or when an error was set on the result.
+    virtual Optional<Tuple> next(ExecutionContext&) = 0;
+};
+
+class ScanOperator final : public Operator {
+public:
+    ScanOperator(TableScan const& scan, NonnullRefPtr<TupleDescriptor> descriptor)
+        : m_scan(scan)
+        , m_descriptor(move(descriptor))
+        , m_pointer(scan.table->pointer())
+    {
+    }
+
+    virtual Optional<Tuple> next(ExecutionContext& context) override
+    {
+        while (m_pointer) {
+            auto row_or_error = context.database->read_row(*m_scan.table, m_pointer);
+            if (row_or_error.is_error()) {
+                context.result->set_error(SQLErrorCode::InternalError, row_or_error.error().string_literal());
+                return {};
+            }
+            auto row = row_or_error.release_value();
+            m_pointer = row.next_pointer();
+            auto matches = evaluate_filters(m_scan.filters, context, row);
+            if (!matches.has_value())
+                return {};
+            if (!matches.value())
+                continue;
+            Tuple result_row(m_descriptor);
+            result_row.clear();
+            result_row.append(Value(SQLType::Boolean, true));
+            result_row.extend(row);
+            return result_row;
+        }
+        return {};
+    }
+
+private:
+    TableScan const& m_scan;
+    NonnullRefPtr<TupleDescriptor> m_descriptor;
+    u32 m_pointer { 0 };
+};
+
+class JoinOperator final : public Operator {
+public:
+    JoinOperator(NonnullOwnPtr<Operator> outer, Vector<TableScan> const& scans, size_t table, NonnullRefPtr<TupleDescriptor> descriptor)
+        : m_outer(move(outer))
+        , m_scans(scans)
+        , m_scan(scans[table])
+        , m_descriptor(move(descriptor))
+    {
+    }
+
+    virtual Optional<Tuple> next(ExecutionContext& context) override
+    {
+        if (!m_loaded && !load(context))
+            return {};
+        for (;;) {
+            while (m_outer_row.has_value() && m_candidate < m_candidates.size()) {
+                auto& table_row = m_table_rows[m_candidates[m_candidate++]];
+                if (m_scan.join_key.has_value() && outer_value().compare(table_row[m_scan.join_key->inner_column]) != 0)
+                    continue;
+                Tuple joined_row(m_descriptor);
+                joined_row.clear();
+                joined_row.extend(m_outer_row.value());
+                joined_row.extend(table_row);
+                auto matches = evaluate_filters(m_scan.join_filters, context, joined_row);
+                if (!matches.has_value())
+                    return {};
+                if (matches.value())
+                    return joined_row;
+            }
+            m_outer_row = m_outer->next(context);
+            if (!m_outer_row.has_value())
+                return {};
+            m_candidate = 0;
+            m_candidates.clear_with_capacity();
+            if (!m_scan.join_key.has_value()) {
+                for (size_t ix = 0; ix < m_table_rows.size(); ix++)
+                    m_candidates.append(ix);
+            } else if (!outer_value().is_null()) {
+                if (auto it = m_hashed_rows.find(outer_value().hash()); it != m_hashed_rows.end())
+                    m_candidates.extend(it->value);
+            }
+        }
+    }
+
+private:
+    Value const& outer_value() const
+    {
+        auto& key = m_scan.join_key.value();
+        return m_outer_row.value()[m_scans[key.outer.table].offset + key.outer.column];
+    }
+
+    bool load(ExecutionContext& context)
+    {
+        m_loaded = true;
+        auto table_rows_or_error = context.database->select_all(*m_scan.table);
+        if (table_rows_or_error.is_error()) {
+            context.result->set_error(SQLErrorCode::InternalError, table_rows_or_error.error().string_literal());
+            return false;
+        }
+        for (auto& table_row : table_rows_or_error.value()) {
+            auto matches = evaluate_filters(m_scan.filters, context, table_row);
+            if (!matches.has_value())
+                return false;
+            if (matches.value())
+                m_table_rows.append(move(table_row));
+        }
+        if (m_scan.join_key.has_value()) {
+            for (auto ix = 0u; ix < m_table_rows.size(); ix++) {
+                auto& value = m_table_rows[ix][m_scan.join_key->inner_column];
+                if (!value.is_null())
+                    m_hashed_rows.ensure(value.hash()).append(ix);
+            }
+        }
+        return true;
+    }
+
+    NonnullOwnPtr<Operator> m_outer;
+    Vector<TableScan> const& m_scans;
+    TableScan const& m_scan;
+    NonnullRefPtr<TupleDescriptor> m_descriptor;
+    bool m_loaded { false };
+    Vector<Row> m_table_rows;
+    HashMap<u32, Vector<size_t>> m_hashed_rows;
+    Optional<Tuple> m_outer_row;
+    Vector<size_t> m_candidates;
+    size_t m_candidate { 0 };
+};
+
+// Stands in for the scan when a SELECT doesn't name any table with columns.
+class UnityOperator final : public Operator {
+public:
+    explicit UnityOperator(NonnullRefPtr<TupleDescriptor> descriptor)
+        : m_descriptor(move(descriptor))
+    {
+    }
+
+    virtual Optional<Tuple> next(ExecutionContext&) override
+    {
+        if (m_done)
+            return {};
+        m_done = true;
+        Tuple row(m_descriptor);
+        row.clear();
+        row.append(Value(SQLType::Boolean, true));
+        return row;
+    }
+
+private:
+    NonnullRefPtr<TupleDescriptor> m_descriptor;
+    bool m_done { false };
+};
+
+class FilterOperator final : public Operator {
+public:
+    FilterOperator(NonnullOwnPtr<Operator> input, Vector<Expression const*> filters)
+        : m_input(move(input))
+        , m_filters(move(filters))
+    {
+    }
+
+    virtual Optional<Tuple> next(ExecutionContext& context) override
+    {
+        for (auto row = m_input->next(context); row.has_value(); row = m_input->next(context)) {
+            auto matches = evaluate_filters(m_filters, context, row.value());
+            if (!matches.has_value())
+                return {};
+            if (matches.value())
+                return row;
+        }
+        return {};
+    }
+
+private:
+    NonnullOwnPtr<Operator> m_input;
+    Vector<Expression const*> m_filters;
+};
+
+class SortOperator final : public Operator {
+public:
+    SortOperator(NonnullOwnPtr<Operator> input, NonnullRefPtrVector<OrderingTerm> const& ordering_terms)
+        : m_input(move(input))
+        , m_ordering_terms(ordering_terms)
+    {
+    }
+
+    virtual Optional<Tuple> next(ExecutionContext& context) override
+    {
+        if (!m_sorted && !sort(context))
+            return {};
+        if (m_index == m_rows.size())
+            return {};
+        return move(m_rows[m_index++].row);
+    }
+
+private:
+    struct SortedRow {
+        Tuple row;
+        Vector<Value> keys;
+        size_t position { 0 };
+    };
+
+    bool sort(ExecutionContext& context)
+    {
+        m_sorted = true;
+        for (auto row = m_input->next(context); row.has_value(); row = m_input->next(context)) {
+            SortedRow sorted_row { row.release_value(), {}, m_rows.size() };
+            context.current_row = &sorted_row.row;
+            for (auto& term : m_ordering_terms) {
+                sorted_row.keys.append(term.expression()->evaluate(context));
+                if (context.result->has_error())
+                    return false;
+            }
+            m_rows.append(move(sorted_row));
+        }
+        if (context.result->has_error())
+            return false;
+        quick_sort(m_rows, [&](auto& a, auto& b) { return compare(a, b) < 0; });
+        return true;
+    }
+
+    int compare(SortedRow const& a, SortedRow const& b) const
+    {
+        for (size_t ix = 0; ix < m_ordering_terms.size(); ix++) {
+            auto& term = m_ordering_terms[ix];
+            auto& lhs = a.keys[ix];
+            auto& rhs = b.keys[ix];
+            int result = 0;
+            if (lhs.is_null() || rhs.is_null()) {
+                if (lhs.is_null() == rhs.is_null())
+                    continue;
+                result = (lhs.is_null() == (term.nulls() == Nulls::First)) ? -1 : 1;
+            } else {
+                result = lhs.compare(rhs);
+                if (term.order() == Order::Descending)
+                    result = -result;
+            }
+            if (result != 0)
+                return result;
+        }
+        // Keep rows that compare equal in the order they were produced.
+        return a.position < b.position ? -1 : 1;
+    }
+
+    NonnullOwnPtr<Operator> m_input;
+    NonnullRefPtrVector<OrderingTerm> const& m_ordering_terms;
+    bool m_sorted { false };
+    Vector<SortedRow> m_rows;
+    size_t m_index { 0 };
+};
+
+class ProjectOperator final : public Operator {
+public:
+    ProjectOperator(NonnullOwnPtr<Operator> input, NonnullRefPtrVector<ResultColumn> columns)
+        : m_input(move(input))
+        , m_columns(move(columns))
+        , m_descriptor(adopt_ref(*new TupleDescriptor))
+    {
+    }
+
+    virtual Optional<Tuple> next(ExecutionContext& context) override
+    {
+        auto row = m_input->next(context);
+        if (!row.has_value())
+            return {};
+        context.current_row = &row.value();
+        Tuple tuple(m_descriptor);
+        tuple.clear();
+        for (auto& column : m_columns) {
+            auto value = column.expression()->evaluate(context);
+            if (context.result->has_error())
+                return {};
+            tuple.append(value);
+        }
+        return tuple;
+    }
+
+private:
+    NonnullOwnPtr<Operator> m_input;
+    NonnullRefPtrVector<ResultColumn> m_columns;
+    NonnullRefPtr<TupleDescriptor> m_descriptor;
+};
+
+class LimitOperator final : public Operator {
+public:
+    LimitOperator(NonnullOwnPtr<Operator> input, Optional<size_t> limit, size_t offset)
+        : m_input(move(input))
+        , m_limit(limit)
+        , m_offset(offset)
+    {
+    }
+
+    virtual Optional<Tuple> next(ExecutionContext& context) override
+    {
+        for (; m_offset > 0; m_offset--) {
+            if (!m_input->next(context).has_value())
+                return {};
+        }
+        if (m_limit.has_value()) {
+            if (m_limit.value() == 0)
+                return {};
+            m_limit = m_limit.value() - 1;
+        }
+        return m_input->next(context);
+    }
+
+private:
+    NonnullOwnPtr<Operator> m_input;
+    Optional<size_t> m_limit;
+    size_t m_offset { 0 };
+};
+
+class SelectResultSource final : public ResultSource {
+public:
+    SelectResultSource(Select const& select, ExecutionContext const& context, Vector<TableScan> scans)
+        : m_select(select)
+        , m_context({ context.database, nullptr, &select, nullptr, context.placeholder_values })
+        , m_scans(move(scans))
+    {
+    }
+
+    Vector<TableScan>& scans() { return m_scans; }
+    ExecutionContext& context() { return m_context; }
+    void set_root(NonnullOwnPtr<Operator> root) { m_root = move(root); }
+
+    virtual Optional<Tuple> next(SQLResult& result) override
+    {
+        m_context.result = &result;
+        auto row = m_root->next(m_context);
+        m_context.current_row = nullptr;
+        m_context.result = nullptr;
+        if (result.has_error())
+            return {};
+        return row;
+    }
+
+private:
+    NonnullRefPtr<Select const> m_select;
+    ExecutionContext m_context;
+    Vector<TableScan> m_scans;
+    OwnPtr<Operator> m_root;
+};
+
+static Optional<i64> evaluate_limit(Expression const& expression, ExecutionContext& context)
+{
+    context.current_row = nullptr;
+    auto value = expression.evaluate(context);
+    if (context.result->has_error())
+        return {};
+    auto limit = value.to_int();
+    if (!limit.has_value()) {
+        context.result->set_error(SQLErrorCode::SyntaxError, "LIMIT");
+        return {};
+    }
+    return limit.value();
+}
+
 RefPtr<SQLResult> Select::execute(ExecutionContext& context) const
 {
     NonnullRefPtrVector<ResultColumn> columns;
@@ -47,54 +558,89 @@ RefPtr<SQLResult> Select::execute(ExecutionContext& context) const
 
     context.result = SQLResult::construct();
     AK::NonnullRefPtr<TupleDescriptor> descriptor = AK::adopt_ref(*new TupleDescriptor);
-    Tuple tuple(descriptor);
-    Vector<Tuple> rows;
     descriptor->empend("__unity__");
-    tuple.append(Value(SQLType::Boolean, true));
-    rows.append(tuple);
 
+    Vector<TableScan> scans;
     for (auto& table_descriptor : table_or_subquery_list()) {
-        if (!table_descriptor.is_table())
-            return SQLResult::construct(SQLCommand::Select, SQLErrorCode::NotYetImplemented, "Sub-selects are not yet implemented");
         auto table_def_or_error = context.database->get_table(table_descriptor.schema_name(), table_descriptor.table_name());
         if (table_def_or_error.is_error())
             return SQLResult::construct(SQLCommand::Select, SQLErrorCode::InternalError, table_def_or_error.error());
         auto table = table_def_or_error.value();
         if (table->num_columns() == 0)
             continue;
-        auto old_descriptor_size = descriptor->size();
-        descriptor->extend(table->to_tuple_descriptor());
-        for (auto cartesian_row = rows.first(); cartesian_row.size() == old_descriptor_size; cartesian_row = rows.first()) {
-            rows.remove(0);
-            auto table_rows_or_error = context.database->select_all(*table);
-            if (table_rows_or_error.is_error())
-                return SQLResult::construct(SQLCommand::Create, SQLErrorCode::InternalError, table_rows_or_error.error());
-            for (auto& table_row : table_rows_or_error.value()) {
-                auto new_row = cartesian_row;
-                new_row.extend(table_row);
-                rows.append(new_row);
-            }
-        }
+        auto offset = scans.is_empty() ? 1 : scans.last().offset + scans.last().descriptor->size();
+        scans.append({ table, table->to_tuple_descriptor(), offset, {}, {}, {} });
     }
 
-    for (auto& row : rows) {
-        context.current_row = &row;
-        if (where_clause()) {
-            auto where_result = where_clause()->evaluate(context);
-            if (context.result->has_error())
-                return context.result;
-            if (!where_result)
-                continue;
+    Vector<Expression const*> conjuncts;
+    Vector<Expression const*> remaining_filters;
+    if (where_clause())
+        collect_conjuncts(*where_clause(), conjuncts);
+    for (auto* conjunct : conjuncts) {
+        Vector<bool> tables;
+        tables.resize(scans.size());
+        if (!collect_tables(*conjunct, scans, tables) || !tables.contains_slow(true)) {
+            remaining_filters.append(conjunct);
+            continue;
         }
-        tuple.clear();
-        for (auto& col : columns) {
-            auto value = col.expression()->evaluate(context);
-            if (context.result->has_error())
+        auto first_table = tables.find_first_index(true).value();
+        size_t last_table = first_table;
+        for (auto ix = first_table; ix < tables.size(); ix++) {
+            if (tables[ix])
+                last_table = ix;
+        }
+        auto& scan = scans[last_table];
+        if (first_table == last_table) {
+            scan.filters.append(conjunct);
+        } else if (auto join_key = join_key_for(*conjunct, scans, last_table); join_key.has_value() && !scan.join_key.has_value()) {
+            scan.join_key = join_key;
+        } else {
+            scan.join_filters.append(conjunct);
+        }
+    }
+
+    Optional<size_t> limit;
+    size_t offset = 0;
+    if (limit_clause()) {
+        auto limit_value = evaluate_limit(*limit_clause()->limit_expression(), context);
+        if (!limit_value.has_value())
+            return context.result;
+        // A negative LIMIT means there is no limit.
+        if (limit_value.value() >= 0)
+            limit = limit_value.value();
+        if (limit_clause()->offset_expression()) {
+            auto offset_value = evaluate_limit(*limit_clause()->offset_expression(), context);
+            if (!offset_value.has_value())
                 return context.result;
-            tuple.append(value);
+            offset = max<i64>(offset_value.value(), 0);
         }
-        context.result->append(tuple);
     }
+
+    auto source = make<SelectResultSource>(*this, context, move(scans));
+    OwnPtr<Operator> root;
+    if (source->scans().is_empty()) {
+        root = make<UnityOperator>(descriptor);
+    }
+    for (size_t ix = 0; ix < source->scans().size(); ix++) {
+        auto& scan = source->scans()[ix];
+        auto step_descriptor = AK::adopt_ref(*new TupleDescriptor);
+        step_descriptor->extend(*descriptor);
+        step_descriptor->extend(*scan.descriptor);
+        descriptor = step_descriptor;
+        if (!root)
+            root = make<ScanOperator>(scan, descriptor);
+        else
+            root = make<JoinOperator>(root.release_nonnull(), source->scans(), ix, descriptor);
+    }
+    if (!remaining_filters.is_empty())
+        root = make<FilterOperator>(root.release_nonnull(), move(remaining_filters));
+    if (!ordering_term_list().is_empty())
+        root = make<SortOperator>(root.release_nonnull(), ordering_term_list());
+    root = make<ProjectOperator>(root.release_nonnull(), move(columns));
+    if (limit.has_value() || offset > 0)
+        root = make<LimitOperator>(root.release_nonnull(), limit, offset);
+    source->set_root(root.release_nonnull());
+    context.result->set_source(move(source));
     return context.result;
 }
 
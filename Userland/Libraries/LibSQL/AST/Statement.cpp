@@ -11,9 +11,9 @@
 
 namespace SQL::AST {
 
-RefPtr<SQLResult> Statement::execute(AK::NonnullRefPtr<Database> database) const
+RefPtr<SQLResult> Statement::execute(AK::NonnullRefPtr<Database> database, Vector<Value> placeholder_values) const
 {
-    ExecutionContext context { move(database), nullptr, this, nullptr };
+    ExecutionContext context { move(database), nullptr, this, nullptr, move(placeholder_values) };
     return execute(context);
 }
 
@@ -189,6 +189,7 @@ namespace SQL::AST {
     __ENUMERATE_SQL_TOKEN(".", Period, Operator)                          \
     __ENUMERATE_SQL_TOKEN("|", Pipe, Operator)                            \
     __ENUMERATE_SQL_TOKEN("+", Plus, Operator)                            \
+    __ENUMERATE_SQL_TOKEN("?", QuestionMark, Punctuation)                 \
     __ENUMERATE_SQL_TOKEN(";", SemiColon, Punctuation)                    \
     __ENUMERATE_SQL_TOKEN("<<", ShiftLeft, Operator)                      \
     __ENUMERATE_SQL_TOKEN(">>", ShiftRight, Operator)                     \
@@ -4,7 +4,9 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Debug.h>
 #include <AK/Format.h>
+#include <AK/QuickSort.h>
 #include <LibSQL/BTree.h>
 #include <LibSQL/Meta.h>
 
@@ -70,6 +72,104 @@ bool BTree::insert(Key const& key)
     return m_root->insert(key);
 }
 
+// Splits a level of sorted entries into nodes of roughly target_length bytes. Returns the index
+// of the first entry of every node. The entry just before each node after the first one becomes
+// a separator key in the level above.
+Vector<size_t> BTree::plan_bulk_load_level(Vector<Key> const& entries, size_t target_length) const
+{
+    Vector<size_t> node_starts;
+    size_t ix = 0;
+    while (ix < entries.size()) {
+        auto node_start = ix;
+        size_t length = 2 * sizeof(u32);
+        for (; ix < entries.size(); ix++) {
+            auto entry_length = TreeNode::entry_length(entries[ix], ix > node_start ? &entries[ix - 1] : nullptr);
+            if (ix > node_start && length + entry_length > target_length)
+                break;
+            length += entry_length;
+        }
+        VERIFY(length <= BLOCKSIZE);
+        node_starts.append(node_start);
+        if (ix == entries.size())
+            break;
+
+        // entries[ix] is the separator between this node and the next one. If it is the last
+        // entry, there would be nothing left for the next node, so the last entry of this node
+        // becomes the separator instead.
+        if (ix == entries.size() - 1) {
+            VERIFY(ix - 1 > node_start);
+            node_starts.append(ix);
+            break;
+        }
+        ix++;
+    }
+    return node_starts;
+}
+
+// Builds the tree bottom-up from a set of keys instead of inserting them one at a time. Nodes
+// are filled to fill_factor of a block, so that later inserts do not immediately split them, and
+// every node is written exactly once. The tree must be empty.
+bool BTree::bulk_load(Vector<Key> keys, float fill_factor)
+{
+    VERIFY(fill_factor > 0.0f && fill_factor <= 1.0f);
+    if (!m_root)
+        initialize_root();
+    VERIFY(m_root);
+    if (m_root->size() > 0)
+        return false;
+    if (keys.is_empty())
+        return true;
+
+    quick_sort(keys, [](auto& key, auto& other) { return key < other; });
+    if (!duplicates_allowed()) {
+        for (auto ix = 1u; ix < keys.size(); ix++) {
+            if (keys[ix] == keys[ix - 1])
+                return false;
+        }
+    }
+
+    auto target_length = max(static_cast<size_t>(fill_factor * BLOCKSIZE), static_cast<size_t>(1));
+    auto entries = move(keys);
+    Vector<u32> children;
+    while (true) {
+        auto node_starts = plan_bulk_load_level(entries, target_length);
+        auto is_root = node_starts.size() == 1;
+        Vector<Key> separators;
+        Vector<u32> nodes;
+        for (auto node_ix = 0u; node_ix < node_starts.size(); node_ix++) {
+            auto first = node_starts[node_ix];
+            auto last = (node_ix + 1 < node_starts.size()) ? node_starts[node_ix + 1] - 1 : entries.size();
+
+            OwnPtr<TreeNode> new_node;
+            if (is_root)
+                new_node = make<TreeNode>(*this, nullptr, pointer());
+            else
+                new_node = make<TreeNode>(*this, nullptr, new_record_pointer());
+            auto& node = *new_node;
+            node.m_down.clear();
+            node.m_is_leaf = children.is_empty();
+            for (auto ix = first; ix < last; ix++) {
+                node.m_entries.append(entries[ix]);
+                node.m_down.empend(&node, node.is_leaf() ? 0u : children[ix]);
+            }
+            node.m_down.empend(&node, node.is_leaf() ? 0u : children[last]);
+            serializer().serialize_and_write(node, node.pointer());
+
+            nodes.append(node.pointer());
+            if (last < entries.size())
+                separators.append(entries[last]);
+            if (is_root)
+                m_root = move(new_node);
+        }
+        if (is_root)
+            break;
+        entries = move(separators);
+        children = move(nodes);
+    }
+    m_root->dump_if(SQL_DEBUG, "bulk_load");
+    return true;
+}
+
 bool BTree::update_key_pointer(Key const& key)
 {
     if (!m_root)
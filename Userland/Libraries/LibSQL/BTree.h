@@ -76,7 +76,14 @@ public:
     void serialize(Serializer&) const;
 
 private:
+    struct KeyPrefix {
+        u8 fields { 0 };
+        u16 characters { 0 };
+    };
+
     TreeNode(BTree&, TreeNode*, DownPointer&, u32 = 0);
+    static KeyPrefix shared_prefix(Key const&, Key const* previous);
+    static size_t entry_length(Key const&, Key const* previous);
     void dump_if(int, String&& = "");
     bool insert_in_leaf(Key const&);
     void just_insert(Key const&, TreeNode* = nullptr);
@@ -101,6 +108,7 @@ public:
 
     u32 root() const { return (m_root) ? m_root->pointer() : 0; }
     bool insert(Key const&);
+    bool bulk_load(Vector<Key>, float fill_factor = DEFAULT_BULK_LOAD_FILL_FACTOR);
     bool update_key_pointer(Key const&);
     Optional<u32> get(Key&);
     BTreeIterator find(Key const& key);
@@ -110,10 +118,13 @@ public:
 
     Function<void(void)> on_new_root;
 
+    static constexpr float DEFAULT_BULK_LOAD_FILL_FACTOR = 0.9f;
+
 private:
     BTree(Serializer&, NonnullRefPtr<TupleDescriptor> const&, bool unique, u32 pointer);
     BTree(Serializer&, NonnullRefPtr<TupleDescriptor> const&, u32 pointer);
     void initialize_root();
+    Vector<size_t> plan_bulk_load_level(Vector<Key> const& entries, size_t target_length) const;
     TreeNode* new_root();
     OwnPtr<TreeNode> m_root { nullptr };
 
@@ -168,6 +168,13 @@ ErrorOr<Vector<Row>> Database::select_all(TableDef const& table)
     return ret;
 }
 
+ErrorOr<Row> Database::read_row(TableDef const& table, u32 pointer)
+{
+    VERIFY(m_table_cache.get(table.key().hash()).has_value());
+    VERIFY(pointer);
+    return m_serializer.deserialize_block<Row>(pointer, table, pointer);
+}
+
 ErrorOr<Vector<Row>> Database::match(TableDef const& table, Key const& key)
 {
     VERIFY(m_table_cache.get(table.key().hash()).has_value());
@@ -39,6 +39,7 @@ public:
     ErrorOr<RefPtr<TableDef>> get_table(String const&, String const&);
 
     ErrorOr<Vector<Row>> select_all(TableDef const&);
+    ErrorOr<Row> read_row(TableDef const&, u32 pointer);
     ErrorOr<Vector<Row>> match(TableDef const&, Key const&);
     ErrorOr<void> insert(Row&);
     ErrorOr<void> update(Row&);
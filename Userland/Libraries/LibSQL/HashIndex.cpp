@@ -43,7 +43,7 @@ void HashDirectoryNode::deserialize(Serializer& serializer)
         auto bucket_pointer = serializer.deserialize<u32>();
         auto local_depth = serializer.deserialize<u32>();
         dbgln_if(SQL_DEBUG, "--Index {} bucket pointer {} local depth {}", ix, bucket_pointer, local_depth);
-        m_hash_index.append_bucket(ix, local_depth, bucket_pointer);
+        m_hash_index.append_bucket(m_hash_index.m_buckets.size(), local_depth, bucket_pointer);
     }
 }
 
@@ -255,49 +255,40 @@ HashBucket* HashIndex::get_bucket_for_insert(Key const& key)
     do {
         dbgln_if(SQL_DEBUG, "HashIndex::get_bucket_for_insert({}) bucket {} of {}", key.to_string(), key_hash % size(), size());
         auto bucket = get_bucket(key_hash % size());
+        if (!bucket->m_inflated)
+            serializer().deserialize_block_to(bucket->pointer(), *bucket);
         if (bucket->length() + key.length() < BLOCKSIZE) {
             return bucket;
         }
         dbgln_if(SQL_DEBUG, "Bucket is full (bucket size {}/length {} key length {}). Expanding directory", bucket->size(), bucket->length(), key.length());
 
         // We previously doubled the directory but the target bucket is
-        // still at an older depth. Create new buckets at the current global
-        // depth and allocate the contents of the existing buckets to the
-        // newly created ones:
+        // still at an older depth. Split it into itself and its sibling
+        // one level deeper, which is the slot its index maps to with the
+        // next bit of the hash set, and move the entries that belong there:
         while (bucket->local_depth() < global_depth()) {
             auto base_index = bucket->index();
-            auto step = 1 << (global_depth() - bucket->local_depth());
-            auto total_moved = 0;
-            for (auto ix = base_index + step; ix < size(); ix += step) {
-                auto& sub_bucket = m_buckets[ix];
-                sub_bucket->set_local_depth(bucket->local_depth() + 1);
-                auto moved = 0;
-                for (auto entry_index = (int)bucket->m_entries.size() - 1; entry_index >= 0; entry_index--) {
-                    if (bucket->m_entries[entry_index].hash() % size() == ix) {
-                        if (!sub_bucket->pointer()) {
-                            sub_bucket->set_pointer(new_record_pointer());
-                        }
-                        sub_bucket->insert(bucket->m_entries.take(entry_index));
-                        moved++;
-                    }
-                }
-                if (moved > 0) {
-                    dbgln_if(SQL_DEBUG, "Moved {} entries from bucket #{} to #{}", moved, base_index, ix);
-                    serializer().serialize_and_write(*sub_bucket, sub_bucket->pointer());
-                }
-                total_moved += moved;
+            auto sibling_index = base_index + (1u << bucket->local_depth());
+            auto sibling_modulus = 1u << (bucket->local_depth() + 1);
+            auto& sibling = m_buckets[sibling_index];
+            VERIFY(!sibling->pointer());
+            sibling->set_pointer(new_record_pointer());
+            sibling->set_local_depth(bucket->local_depth() + 1);
+            sibling->m_inflated = true;
+            for (auto entry_index = (int)bucket->m_entries.size() - 1; entry_index >= 0; entry_index--) {
+                if (bucket->m_entries[entry_index].hash() % sibling_modulus == sibling_index)
+                    sibling->m_entries.append(bucket->m_entries.take(entry_index));
             }
-            if (total_moved)
-                dbgln_if(SQL_DEBUG, "Redistributed {} entries from bucket #{}", total_moved, base_index);
-            else
-                dbgln_if(SQL_DEBUG, "Nothing redistributed from bucket #{}", base_index);
+            dbgln_if(SQL_DEBUG, "Moved {} entries from bucket #{} to #{}", sibling->m_entries.size(), base_index, sibling_index);
             bucket->set_local_depth(bucket->local_depth() + 1);
             serializer().serialize_and_write(*bucket, bucket->pointer());
-            write_directory_to_write_ahead_log();
+            serializer().serialize_and_write(*sibling, sibling->pointer());
+            write_directory_node_to_write_ahead_log(base_index);
+            write_directory_node_to_write_ahead_log(sibling_index);
 
-            auto bucket_after_redistribution = get_bucket(key_hash % size());
-            if (bucket_after_redistribution->length() + key.length() < BLOCKSIZE)
-                return bucket_after_redistribution;
+            bucket = get_bucket(key_hash % size());
+            if (bucket->length() + key.length() < BLOCKSIZE)
+                return bucket;
         }
         expand();
     } while (true);
@@ -329,9 +320,19 @@ void HashIndex::write_directory_to_write_ahead_log()
         HashDirectoryNode node(*this, num_node, offset);
         serializer().serialize_and_write(node, node.pointer());
         offset += node.number_of_pointers();
+        num_node++;
     }
 }
 
+// Only rewrites the directory node holding the pointer for the bucket at the given index.
+void HashIndex::write_directory_node_to_write_ahead_log(u32 bucket_index)
+{
+    auto node_number = bucket_index / HashDirectoryNode::max_pointers_in_node();
+    VERIFY(node_number < m_nodes.size());
+    HashDirectoryNode node(*this, node_number, node_number * HashDirectoryNode::max_pointers_in_node());
+    serializer().serialize_and_write(node, node.pointer());
+}
+
 HashBucket* HashIndex::append_bucket(u32 index, u32 local_depth, u32 pointer)
 {
     m_buckets.append(make<HashBucket>(*this, index, local_depth, pointer));
@@ -360,10 +361,10 @@ bool HashIndex::insert(Key const& key)
 {
     dbgln_if(SQL_DEBUG, "HashIndex::insert({})", key.to_string());
     auto bucket = get_bucket_for_insert(key);
-    bucket->insert(key);
+    auto inserted = bucket->insert(key);
     if constexpr (SQL_DEBUG)
         bucket->list_bucket();
-    return true;
+    return inserted;
 }
 
 HashIndexIterator HashIndex::begin()
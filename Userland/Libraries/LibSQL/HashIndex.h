@@ -83,6 +83,7 @@ private:
 
     void expand();
     void write_directory_to_write_ahead_log();
+    void write_directory_node_to_write_ahead_log(u32 bucket_index);
     HashBucket* append_bucket(u32 index, u32 local_depth, u32 pointer);
     HashBucket* get_bucket_for_insert(Key const&);
     [[nodiscard]] HashBucket* get_bucket_by_index(u32 index);
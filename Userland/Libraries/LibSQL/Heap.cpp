@@ -8,10 +8,17 @@
 #include <AK/QuickSort.h>
 #include <AK/String.h>
 #include <LibCore/IODevice.h>
+#include <LibCrypto/Checksum/CRC32.h>
 #include <LibSQL/Heap.h>
 #include <LibSQL/Serializer.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <unistd.h>
+
+#ifdef __serenity__
+#    include <errno.h>
+#    include <sys/io_batch.h>
+#endif
 
 namespace SQL {
 
@@ -20,12 +27,46 @@ Heap::Heap(String file_name)
     set_name(move(file_name));
 }
 
+// Every record in the write-ahead log starts with a header: a magic number, a CRC32 of the rest
+// of the record, the record type, the block number, and a sequence number. Block records are
+// followed by the contents of the block. A commit record makes every record before it durable.
+constexpr static u32 WAL_MAGIC = 0x57514c53;
+constexpr static size_t WAL_RECORD_HEADER_SIZE = 4 * sizeof(u32) + sizeof(u64);
+constexpr static size_t WAL_CHECKSUMMED_HEADER_OFFSET = 2 * sizeof(u32);
+constexpr static size_t WAL_BLOCK_RECORD_SIZE = WAL_RECORD_HEADER_SIZE + BLOCKSIZE;
+constexpr static size_t CHECKPOINT_BATCH_SIZE = 64;
+
+struct WalRecordHeader {
+    u32 magic { WAL_MAGIC };
+    u32 checksum { 0 };
+    u32 type { 0 };
+    u32 block { 0 };
+    u64 sequence { 0 };
+};
+static_assert(sizeof(WalRecordHeader) == WAL_RECORD_HEADER_SIZE);
+
+static u32 wal_record_checksum(WalRecordHeader const& header, ReadonlyBytes payload)
+{
+    auto header_bytes = ReadonlyBytes { reinterpret_cast<u8 const*>(&header), sizeof(header) }.slice(WAL_CHECKSUMMED_HEADER_OFFSET);
+    Crypto::Checksum::CRC32 crc(header_bytes);
+    crc.update(payload);
+    return crc.digest();
+}
+
 Heap::~Heap()
 {
-    if (m_file && !m_write_ahead_log.is_empty()) {
-        if (auto maybe_error = flush(); maybe_error.is_error())
-            warnln("~Heap({}): {}", name(), maybe_error.error());
+    if (!m_file)
+        return;
+    if (auto maybe_error = flush(); maybe_error.is_error()) {
+        warnln("~Heap({}): {}", name(), maybe_error.error());
+        return;
+    }
+    if (auto maybe_error = checkpoint(); maybe_error.is_error()) {
+        warnln("~Heap({}): {}", name(), maybe_error.error());
+        return;
     }
+    if (m_wal)
+        unlink(wal_name().characters());
 }
 
 ErrorOr<void> Heap::open()
@@ -43,8 +84,6 @@ ErrorOr<void> Heap::open()
     } else {
         file_size = stat_buffer.st_size;
     }
-    if (file_size > 0)
-        m_next_block = m_end_of_file = file_size / BLOCKSIZE;
 
     auto file_or_error = Core::File::open(name(), Core::OpenMode::ReadWrite);
     if (file_or_error.is_error()) {
@@ -52,48 +91,168 @@ ErrorOr<void> Heap::open()
         return Error::from_string_literal("Heap::open(): could not open file"sv);
     }
     m_file = file_or_error.value();
+
     if (file_size > 0) {
+        if (auto error_maybe = recover_from_wal(); error_maybe.is_error()) {
+            m_file = nullptr;
+            m_wal = nullptr;
+            return error_maybe.error();
+        }
+        if (fstat(m_file->fd(), &stat_buffer) != 0) {
+            m_file = nullptr;
+            return Error::from_errno(errno);
+        }
+        file_size = stat_buffer.st_size;
+        m_next_block = m_end_of_file = file_size / BLOCKSIZE;
         if (auto error_maybe = read_zero_block(); error_maybe.is_error()) {
             m_file = nullptr;
             return error_maybe.error();
         }
     } else {
+        // A log left behind without its heap file belongs to a heap that has been removed.
+        if (unlink(wal_name().characters()) < 0 && errno != ENOENT)
+            return Error::from_errno(errno);
         initialize_zero_block();
+
+        // The zero block goes straight into the new file, so that a log can never be
+        // mistaken for a leftover of a removed heap once it has been written to.
+        auto* zero_page = TRY(fetch_page(0, false));
+        TRY(write_block(0, zero_page->buffer));
+        zero_page->dirty = false;
     }
     dbgln_if(SQL_DEBUG, "Heap file {} opened. Size = {}", name(), size());
     return {};
 }
 
 ErrorOr<ByteBuffer> Heap::read_block(u32 block)
+{
+    auto bytes = TRY(pin_block(block));
+    auto buffer_or_error = ByteBuffer::copy(bytes);
+    unpin_block(block);
+    if (!buffer_or_error.has_value())
+        return Error::from_errno(ENOMEM);
+    return buffer_or_error.release_value();
+}
+
+ErrorOr<Bytes> Heap::pin_block(u32 block)
 {
     if (m_file.is_null()) {
         warnln("Heap({})::read_block({}): Heap file not opened"sv, name(), block);
         return Error::from_string_literal("Heap()::read_block(): Heap file not opened"sv);
     }
-    auto buffer_or_empty = m_write_ahead_log.get(block);
-    if (buffer_or_empty.has_value())
-        return buffer_or_empty.release_value();
+    auto* page = TRY(fetch_page(block, true));
+    page->pin_count++;
+    return page->buffer.bytes();
+}
+
+void Heap::unpin_block(u32 block, bool dirty)
+{
+    auto index = m_page_index.get(block);
+    VERIFY(index.has_value());
+    auto& page = m_pages[index.value()];
+    VERIFY(page.pin_count > 0);
+    page.pin_count--;
+    page.dirty |= dirty;
+}
+
+ErrorOr<void> Heap::add_to_wal(u32 block, ByteBuffer const& buffer)
+{
+    dbgln_if(SQL_DEBUG, "Adding to WAL: block #{}, size {}", block, buffer.size());
+    if (buffer.size() > BLOCKSIZE) {
+        warnln("Heap({})::write_block({}): Oversized block ({} > {})"sv, name(), block, buffer.size(), BLOCKSIZE);
+        return Error::from_string_literal("Heap()::write_block(): Oversized block"sv);
+    }
+    auto* page = TRY(fetch_page(block, false));
+    page->buffer.overwrite(0, buffer.data(), buffer.size());
+    memset(page->buffer.offset_pointer(buffer.size()), 0, BLOCKSIZE - buffer.size());
+    page->dirty = true;
+    return {};
+}
+
+size_t Heap::dirty_page_count() const
+{
+    size_t count = 0;
+    for (auto& page : m_pages) {
+        if (page.in_use && page.dirty)
+            count++;
+    }
+    return count;
+}
+
+// Returns the page holding the given block, loading it from the file if it isn't resident
+// and read_from_file is set. Otherwise a new page is handed out and the caller fills it in.
+ErrorOr<Heap::Page*> Heap::fetch_page(u32 block, bool read_from_file)
+{
+    if (auto index = m_page_index.get(block); index.has_value()) {
+        auto& page = m_pages[index.value()];
+        page.last_used = ++m_page_clock;
+        return &page;
+    }
 
     if (block >= m_next_block) {
         warnln("Heap({})::read_block({}): block # out of range (>= {})"sv, name(), block, m_next_block);
         return Error::from_string_literal("Heap()::read_block(): block # out of range"sv);
     }
-    dbgln_if(SQL_DEBUG, "Read heap block {}", block);
-    TRY(seek_block(block));
-    auto ret = m_file->read(BLOCKSIZE);
-    if (ret.is_empty()) {
-        warnln("Heap({})::read_block({}): Could not read block"sv, name(), block);
-        return Error::from_string_literal("Heap()::read_block(): Could not read block"sv);
+
+    auto* page = TRY(allocate_page());
+    if (read_from_file) {
+        // Blocks that were logged since the last checkpoint are only up to date in the log.
+        auto wal_offset = m_wal_index.get(block);
+        dbgln_if(SQL_DEBUG, "Read heap block {} from {}", block, wal_offset.has_value() ? "log" : "file");
+        auto nread = wal_offset.has_value()
+            ? pread(m_wal->fd(), page->buffer.data(), BLOCKSIZE, static_cast<off_t>(wal_offset.value()))
+            : pread(m_file->fd(), page->buffer.data(), BLOCKSIZE, static_cast<off_t>(block) * BLOCKSIZE);
+        if (nread < 0)
+            return Error::from_errno(errno);
+        if (nread != BLOCKSIZE) {
+            warnln("Heap({})::read_block({}): Could not read block"sv, name(), block);
+            return Error::from_string_literal("Heap()::read_block(): Could not read block"sv);
+        }
     }
-    dbgln_if(SQL_DEBUG, "{:02x} {:02x} {:02x} {:02x} {:02x} {:02x} {:02x} {:02x}",
-        *ret.offset_pointer(0), *ret.offset_pointer(1),
-        *ret.offset_pointer(2), *ret.offset_pointer(3),
-        *ret.offset_pointer(4), *ret.offset_pointer(5),
-        *ret.offset_pointer(6), *ret.offset_pointer(7));
-    return ret;
+    page->block = block;
+    page->in_use = true;
+    page->dirty = false;
+    page->last_used = ++m_page_clock;
+    TRY(m_page_index.try_set(block, page - m_pages.data()));
+    return page;
 }
 
-ErrorOr<void> Heap::write_block(u32 block, ByteBuffer& buffer)
+// Hands out a page that isn't holding any block. Until the pool is full a new page is
+// allocated, after that the least recently used unpinned page is written back if needed
+// and reused.
+ErrorOr<Heap::Page*> Heap::allocate_page()
+{
+    if (m_pages.size() < m_page_pool_size) {
+        // Reserve the whole pool up front, so the pages never move while they are pinned.
+        TRY(m_pages.try_ensure_capacity(m_page_pool_size));
+        auto buffer = ByteBuffer::create_zeroed(BLOCKSIZE);
+        if (!buffer.has_value())
+            return Error::from_errno(ENOMEM);
+        m_pages.unchecked_append({ .buffer = buffer.release_value() });
+        return &m_pages.last();
+    }
+
+    Page* victim = nullptr;
+    for (auto& page : m_pages) {
+        if (!page.in_use)
+            return &page;
+        if (page.pin_count == 0 && (!victim || page.last_used < victim->last_used))
+            victim = &page;
+    }
+    if (!victim) {
+        warnln("Heap({}): All {} pages are pinned"sv, name(), m_pages.size());
+        return Error::from_string_literal("Heap(): All pages are pinned"sv);
+    }
+    if (victim->dirty) {
+        dbgln_if(SQL_DEBUG, "Evicting dirty block {} from {}", victim->block, name());
+        TRY(append_to_wal(Vector<Page*> { victim }, false));
+    }
+    m_page_index.remove(victim->block);
+    victim->in_use = false;
+    return victim;
+}
+
+ErrorOr<void> Heap::write_block(u32 block, ReadonlyBytes buffer)
 {
     if (m_file.is_null()) {
         warnln("Heap({})::write_block({}): Heap file not opened"sv, name(), block);
@@ -103,55 +262,189 @@ ErrorOr<void> Heap::write_block(u32 block, ByteBuffer& buffer)
         warnln("Heap({})::write_block({}): block # out of range (> {})"sv, name(), block, m_next_block);
         return Error::from_string_literal("Heap()::write_block(): block # out of range"sv);
     }
-    TRY(seek_block(block));
+    VERIFY(buffer.size() == BLOCKSIZE);
     dbgln_if(SQL_DEBUG, "Write heap block {} size {}", block, buffer.size());
-    if (buffer.size() > BLOCKSIZE) {
-        warnln("Heap({})::write_block({}): Oversized block ({} > {})"sv, name(), block, buffer.size(), BLOCKSIZE);
-        return Error::from_string_literal("Heap()::write_block(): Oversized block"sv);
+    dbgln_if(SQL_DEBUG, "{:02x} {:02x} {:02x} {:02x} {:02x} {:02x} {:02x} {:02x}",
+        buffer[0], buffer[1], buffer[2], buffer[3], buffer[4], buffer[5], buffer[6], buffer[7]);
+    // Pages can be evicted in any order, so this may leave a hole in the file that is
+    // filled in when the blocks before it are written.
+    auto nwritten = pwrite(m_file->fd(), buffer.data(), BLOCKSIZE, static_cast<off_t>(block) * BLOCKSIZE);
+    if (nwritten < 0)
+        return Error::from_errno(errno);
+    if (nwritten != BLOCKSIZE) {
+        warnln("Heap({})::write_block({}): Could not full write block"sv, name(), block);
+        return Error::from_string_literal("Heap()::write_block(): Could not full write block"sv);
     }
-    auto sz = buffer.size();
-    if (sz < BLOCKSIZE) {
-        if (buffer.try_resize(BLOCKSIZE).is_error()) {
-            warnln("Heap({})::write_block({}): Could not align block of size {} to {}"sv, name(), block, buffer.size(), BLOCKSIZE);
-            return Error::from_string_literal("Heap()::write_block(): Could not align block"sv);
+    m_end_of_file = max(m_end_of_file, block + 1);
+    return {};
+}
+
+// Writes out the given blocks, which must be sorted by block number. On Serenity this takes
+// one syscall per IO_BATCH_MAX blocks instead of a write for every one of them.
+ErrorOr<void> Heap::write_blocks(Vector<BlockWrite> const& writes)
+{
+#ifdef __serenity__
+    Vector<io_request> requests;
+    TRY(requests.try_ensure_capacity(min(writes.size(), static_cast<size_t>(IO_BATCH_MAX))));
+    for (size_t first = 0; first < writes.size(); first += IO_BATCH_MAX) {
+        auto batch = writes.span().slice(first, min(writes.size() - first, static_cast<size_t>(IO_BATCH_MAX)));
+        requests.clear_with_capacity();
+        for (auto& write : batch) {
+            if (write.block > m_next_block) {
+                warnln("Heap({})::write_block({}): block # out of range (> {})"sv, name(), write.block, m_next_block);
+                return Error::from_string_literal("Heap()::write_block(): block # out of range"sv);
+            }
+            VERIFY(write.bytes.size() == BLOCKSIZE);
+            requests.unchecked_append({ IO_WRITE, m_file->fd(), IO_POSITIONAL, static_cast<off_t>(write.block) * BLOCKSIZE, const_cast<u8*>(write.bytes.data()), BLOCKSIZE, 0 });
+        }
+
+        if (io_submit_batch(requests.data(), requests.size()) < 0)
+            return Error::from_errno(errno);
+        for (size_t i = 0; i < requests.size(); ++i) {
+            if (requests[i].result != BLOCKSIZE) {
+                warnln("Heap({})::write_block({}): Could not full write block"sv, name(), batch[i].block);
+                return Error::from_string_literal("Heap()::write_block(): Could not full write block"sv);
+            }
+            m_end_of_file = max(m_end_of_file, batch[i].block + 1);
         }
-        memset(buffer.offset_pointer((int)sz), 0, BLOCKSIZE - sz);
     }
-    dbgln_if(SQL_DEBUG, "{:02x} {:02x} {:02x} {:02x} {:02x} {:02x} {:02x} {:02x}",
-        *buffer.offset_pointer(0), *buffer.offset_pointer(1),
-        *buffer.offset_pointer(2), *buffer.offset_pointer(3),
-        *buffer.offset_pointer(4), *buffer.offset_pointer(5),
-        *buffer.offset_pointer(6), *buffer.offset_pointer(7));
-    if (m_file->write(buffer.data(), (int)buffer.size())) {
-        if (block == m_end_of_file)
-            m_end_of_file++;
-        return {};
+#else
+    for (auto& write : writes)
+        TRY(write_block(write.block, write.bytes));
+#endif
+    return {};
+}
+
+// Appends the given pages to the log, followed by a commit record if commit is set. All
+// records go out in a single write, and a commit is made durable with a single fsync.
+ErrorOr<void> Heap::append_to_wal(Vector<Page*> const& pages, bool commit)
+{
+    if (!m_wal) {
+        auto wal_or_error = Core::File::open(wal_name(), Core::OpenMode::ReadWrite);
+        if (wal_or_error.is_error()) {
+            warnln("Heap({}): could not open log {}: {}"sv, name(), wal_name(), wal_or_error.error());
+            return Error::from_string_literal("Heap(): could not open write-ahead log"sv);
+        }
+        m_wal = wal_or_error.release_value();
+    }
+
+    ByteBuffer records;
+    TRY(records.try_ensure_capacity(pages.size() * WAL_BLOCK_RECORD_SIZE + (commit ? WAL_RECORD_HEADER_SIZE : 0)));
+    auto append_record = [&](WalRecordType type, u32 block, ReadonlyBytes payload) {
+        WalRecordHeader header;
+        header.type = to_underlying(type);
+        header.block = block;
+        header.sequence = ++m_wal_sequence;
+        header.checksum = wal_record_checksum(header, payload);
+        records.append(&header, sizeof(header));
+        records.append(payload);
+    };
+    for (auto* page : pages)
+        append_record(WalRecordType::Block, page->block, page->buffer.bytes());
+    if (commit)
+        append_record(WalRecordType::Commit, 0, {});
+
+    for (size_t written = 0; written < records.size();) {
+        auto nwritten = pwrite(m_wal->fd(), records.offset_pointer(written), records.size() - written, static_cast<off_t>(m_wal_size + written));
+        if (nwritten < 0)
+            return Error::from_errno(errno);
+        written += nwritten;
+    }
+    if (commit && fsync(m_wal->fd()) < 0)
+        return Error::from_errno(errno);
+
+    for (size_t ix = 0; ix < pages.size(); ix++) {
+        auto* page = pages[ix];
+        TRY(m_wal_index.try_set(page->block, m_wal_size + ix * WAL_BLOCK_RECORD_SIZE + WAL_RECORD_HEADER_SIZE));
+        m_end_of_file = max(m_end_of_file, page->block + 1);
+        page->dirty = false;
     }
-    warnln("Heap({})::write_block({}): Could not full write block"sv, name(), block);
-    return Error::from_string_literal("Heap()::write_block(): Could not full write block"sv);
+    m_wal_size += records.size();
+    if (commit)
+        m_wal_has_uncommitted_records = false;
+    else if (!pages.is_empty())
+        m_wal_has_uncommitted_records = true;
+    dbgln_if(SQL_DEBUG, "Logged {} blocks{} to {}", pages.size(), commit ? " and a commit" : "", wal_name());
+    return {};
 }
 
-ErrorOr<void> Heap::seek_block(u32 block)
+// Copies the blocks of every complete transaction in a log left behind by a heap that was not
+// closed cleanly into the heap file. Anything after the last valid commit record is dropped.
+ErrorOr<void> Heap::recover_from_wal()
 {
-    if (m_file.is_null()) {
-        warnln("Heap({})::seek_block({}): Heap file not opened"sv, name(), block);
-        return Error::from_string_literal("Heap()::seek_block(): Heap file not opened"sv);
-    }
-    if (block == m_end_of_file) {
-        off_t pos;
-        if (!m_file->seek(0, Core::SeekMode::FromEndPosition, &pos)) {
-            warnln("Heap({})::seek_block({}): Error seeking end of file: {}"sv, name(), block, m_file->error_string());
-            return Error::from_string_literal("Heap()::seek_block(): Error seeking end of file"sv);
+    struct stat stat_buffer;
+    if (stat(wal_name().characters(), &stat_buffer) != 0) {
+        if (errno == ENOENT)
+            return {};
+        return Error::from_errno(errno);
+    }
+    auto wal_or_error = Core::File::open(wal_name(), Core::OpenMode::ReadWrite);
+    if (wal_or_error.is_error()) {
+        warnln("Heap({}): could not open log {}: {}"sv, name(), wal_name(), wal_or_error.error());
+        return Error::from_string_literal("Heap(): could not open write-ahead log"sv);
+    }
+    m_wal = wal_or_error.release_value();
+
+    auto buffer_or_error = ByteBuffer::create_uninitialized(BLOCKSIZE);
+    if (!buffer_or_error.has_value())
+        return Error::from_errno(ENOMEM);
+    auto buffer = buffer_or_error.release_value();
+
+    HashMap<u32, u64> committed;
+    HashMap<u32, u64> pending;
+    u64 offset = 0;
+    Optional<u64> expected_sequence;
+    while (true) {
+        WalRecordHeader header;
+        if (pread(m_wal->fd(), &header, sizeof(header), static_cast<off_t>(offset)) != sizeof(header))
+            break;
+        if (header.magic != WAL_MAGIC)
+            break;
+        if (expected_sequence.has_value() && header.sequence != expected_sequence.value())
+            break;
+
+        ReadonlyBytes payload;
+        if (header.type == to_underlying(WalRecordType::Block)) {
+            if (pread(m_wal->fd(), buffer.data(), BLOCKSIZE, static_cast<off_t>(offset + sizeof(header))) != BLOCKSIZE)
+                break;
+            payload = buffer.bytes();
+        } else if (header.type != to_underlying(WalRecordType::Commit)) {
+            break;
         }
-    } else if (block > m_end_of_file) {
-        warnln("Heap({})::seek_block({}): Cannot seek beyond end of file at block {}"sv, name(), block, m_end_of_file);
-        return Error::from_string_literal("Heap()::seek_block(): Cannot seek beyond end of file"sv);
-    } else {
-        if (!m_file->seek(block * BLOCKSIZE)) {
-            warnln("Heap({})::seek_block({}): Error seeking: {}"sv, name(), block, m_file->error_string());
-            return Error::from_string_literal("Heap()::seek_block(): Error seeking: {}"sv);
+        if (wal_record_checksum(header, payload) != header.checksum)
+            break;
+
+        if (header.type == to_underlying(WalRecordType::Block)) {
+            TRY(pending.try_set(header.block, offset + sizeof(header)));
+        } else {
+            for (auto& it : pending)
+                TRY(committed.try_set(it.key, it.value));
+            pending.clear();
+        }
+        expected_sequence = header.sequence + 1;
+        offset += sizeof(header) + payload.size();
+    }
+
+    if (!committed.is_empty()) {
+        dbgln("Heap({}): recovering {} blocks from {}", name(), committed.size(), wal_name());
+        Vector<u32> blocks;
+        TRY(blocks.try_ensure_capacity(committed.size()));
+        for (auto& it : committed)
+            blocks.unchecked_append(it.key);
+        quick_sort(blocks);
+        for (auto block : blocks) {
+            if (pread(m_wal->fd(), buffer.data(), BLOCKSIZE, static_cast<off_t>(committed.get(block).value())) != BLOCKSIZE)
+                return Error::from_errno(errno);
+            m_next_block = max(m_next_block, block + 1);
+            TRY(write_block(block, buffer));
         }
+        if (fsync(m_file->fd()) < 0)
+            return Error::from_errno(errno);
     }
+
+    if (ftruncate(m_wal->fd(), 0) < 0 || fsync(m_wal->fd()) < 0)
+        return Error::from_errno(errno);
+    m_wal_size = 0;
     return {};
 }
 
@@ -172,22 +465,70 @@ u32 Heap::new_record_pointer()
     return m_next_block++;
 }
 
+// Commits all changes made so far by logging the dirty pages together with a commit record.
+// Checkpoints once the log has grown beyond the checkpoint threshold.
 ErrorOr<void> Heap::flush()
 {
     VERIFY(!m_file.is_null());
-    Vector<u32> blocks;
-    for (auto& wal_entry : m_write_ahead_log) {
-        blocks.append(wal_entry.key);
+    Vector<Page*> pages;
+    for (auto& page : m_pages) {
+        if (page.in_use && page.dirty)
+            pages.append(&page);
     }
+    if (pages.is_empty() && !m_wal_has_uncommitted_records)
+        return {};
+    quick_sort(pages, [](auto* a, auto* b) { return a->block < b->block; });
+    TRY(append_to_wal(pages, true));
+    dbgln_if(SQL_DEBUG, "Pages flushed. Heap size = {}", size());
+
+    if (m_wal_size >= m_checkpoint_threshold * WAL_BLOCK_RECORD_SIZE)
+        TRY(checkpoint());
+    return {};
+}
+
+// Copies the latest logged version of every block into the heap file and empties the log.
+// Everything in the log must have been committed.
+ErrorOr<void> Heap::checkpoint()
+{
+    VERIFY(!m_file.is_null());
+    VERIFY(!m_wal_has_uncommitted_records);
+    if (!m_wal || m_wal_size == 0)
+        return {};
+
+    Vector<u32> blocks;
+    TRY(blocks.try_ensure_capacity(m_wal_index.size()));
+    for (auto& it : m_wal_index)
+        blocks.unchecked_append(it.key);
     quick_sort(blocks);
-    for (auto& block : blocks) {
-        auto buffer_it = m_write_ahead_log.find(block);
-        VERIFY(buffer_it != m_write_ahead_log.end());
-        dbgln_if(SQL_DEBUG, "Flushing block {} to {}", block, name());
-        TRY(write_block(block, buffer_it->value));
-    }
-    m_write_ahead_log.clear();
-    dbgln_if(SQL_DEBUG, "WAL flushed. Heap size = {}", size());
+
+    Vector<ByteBuffer> buffers;
+    Vector<BlockWrite> writes;
+    TRY(writes.try_ensure_capacity(CHECKPOINT_BATCH_SIZE));
+    for (size_t first = 0; first < blocks.size(); first += CHECKPOINT_BATCH_SIZE) {
+        auto batch = blocks.span().slice(first, min(blocks.size() - first, CHECKPOINT_BATCH_SIZE));
+        for (size_t ix = buffers.size(); ix < batch.size(); ix++) {
+            auto buffer = ByteBuffer::create_uninitialized(BLOCKSIZE);
+            if (!buffer.has_value())
+                return Error::from_errno(ENOMEM);
+            TRY(buffers.try_append(buffer.release_value()));
+        }
+        writes.clear_with_capacity();
+        for (size_t ix = 0; ix < batch.size(); ix++) {
+            auto offset = m_wal_index.get(batch[ix]).value();
+            if (pread(m_wal->fd(), buffers[ix].data(), BLOCKSIZE, static_cast<off_t>(offset)) != BLOCKSIZE)
+                return Error::from_errno(errno);
+            writes.unchecked_append({ batch[ix], buffers[ix].bytes() });
+        }
+        TRY(write_blocks(writes));
+    }
+    if (fsync(m_file->fd()) < 0)
+        return Error::from_errno(errno);
+
+    if (ftruncate(m_wal->fd(), 0) < 0 || fsync(m_wal->fd()) < 0)
+        return Error::from_errno(errno);
+    dbgln_if(SQL_DEBUG, "Checkpointed {} blocks from {}", blocks.size(), wal_name());
+    m_wal_size = 0;
+    m_wal_index.clear();
     return {};
 }
 
@@ -211,6 +552,10 @@ ErrorOr<void> Heap::read_zero_block()
     dbgln_if(SQL_DEBUG, "Read zero block from {}", name());
     memcpy(&m_version, buffer.offset_pointer(VERSION_OFFSET), sizeof(u32));
     dbgln_if(SQL_DEBUG, "Version: {}.{}", (m_version & 0xFFFF0000) >> 16, (m_version & 0x0000FFFF));
+    if (m_version != HEAP_VERSION) {
+        warnln("{}: Heap file version {:#08x} is not supported; expected {:#08x}"sv, name(), m_version, HEAP_VERSION);
+        return Error::from_string_literal("Heap()::read_zero_block(): Unsupported heap file version"sv);
+    }
     memcpy(&m_schemas_root, buffer.offset_pointer(SCHEMAS_ROOT_OFFSET), sizeof(u32));
     dbgln_if(SQL_DEBUG, "Schemas root node: {}", m_tables_root);
     memcpy(&m_tables_root, buffer.offset_pointer(TABLES_ROOT_OFFSET), sizeof(u32));
@@ -252,12 +597,13 @@ void Heap::update_zero_block()
     buffer.overwrite(FREE_LIST_OFFSET, &m_free_list, sizeof(u32));
     buffer.overwrite(USER_VALUES_OFFSET, m_user_values.data(), m_user_values.size() * sizeof(u32));
 
-    add_to_wal(0, buffer);
+    // FIXME: Handle a failure to write back an evicted page here.
+    MUST(add_to_wal(0, buffer));
 }
 
 void Heap::initialize_zero_block()
 {
-    m_version = 0x00000001;
+    m_version = HEAP_VERSION;
     m_schemas_root = 0;
     m_tables_root = 0;
     m_table_columns_root = 0;
@@ -17,6 +17,12 @@
 namespace SQL {
 
 constexpr static u32 BLOCKSIZE = 1024;
+constexpr static size_t DEFAULT_PAGE_POOL_SIZE = 256;
+constexpr static size_t DEFAULT_CHECKPOINT_THRESHOLD = 1024;
+
+// Version 2 stores rows in the compact fixed-slot layout described in Row.cpp.
+// Version 3 stores B-tree keys prefix-compressed, as described in TreeNode.cpp.
+constexpr static u32 HEAP_VERSION = 0x00000003;
 
 /**
  * A Heap is a logical container for database (SQL) data. Conceptually a
@@ -28,6 +34,20 @@ constexpr static u32 BLOCKSIZE = 1024;
  * assumed that a single SQL database is backed by a single Heap.
  *
  * Currently only B-Trees and tuple stores are implemented.
+ *
+ * Blocks are accessed through a fixed-size pool of in-memory pages. A page
+ * can be pinned to keep it resident while its bytes are being used. When the
+ * pool is full, the least recently used unpinned page is evicted.
+ *
+ * Modified blocks are never written over the heap file directly. They are
+ * appended to a write-ahead log next to it (the heap file name with "-wal"
+ * appended) when their page is evicted or when flush() commits them. A
+ * commit is a single sequential write of the log followed by an fsync.
+ * Once the log grows beyond the checkpoint threshold, a checkpoint copies
+ * the latest version of every logged block into the heap file and empties
+ * the log. When a heap is opened, the committed part of a leftover log is
+ * replayed into the heap file. Log records are checksummed, so a log
+ * that was only partially written is cut off at the last complete commit.
  */
 class Heap : public Core::Object {
     C_OBJECT(Heap);
@@ -38,6 +58,8 @@ public:
     ErrorOr<void> open();
     u32 size() const { return m_end_of_file; }
     ErrorOr<ByteBuffer> read_block(u32);
+    ErrorOr<Bytes> pin_block(u32);
+    void unpin_block(u32, bool dirty = false);
     [[nodiscard]] u32 new_record_pointer();
     [[nodiscard]] bool has_block(u32 block) const { return block < size(); }
     [[nodiscard]] bool valid() const { return m_file != nullptr; }
@@ -80,38 +102,75 @@ public:
         update_zero_block();
     }
 
-    void add_to_wal(u32 block, ByteBuffer& buffer)
+    ErrorOr<void> add_to_wal(u32 block, ByteBuffer const& buffer);
+    ErrorOr<void> flush();
+    ErrorOr<void> checkpoint();
+
+    String wal_name() const { return String::formatted("{}-wal", name()); }
+    u64 wal_size() const { return m_wal_size; }
+    size_t checkpoint_threshold() const { return m_checkpoint_threshold; }
+    void set_checkpoint_threshold(size_t blocks) { m_checkpoint_threshold = blocks; }
+
+    size_t page_pool_size() const { return m_page_pool_size; }
+    void set_page_pool_size(size_t size)
     {
-        dbgln_if(SQL_DEBUG, "Adding to WAL: block #{}, size {}", block, buffer.size());
-        dbgln_if(SQL_DEBUG, "{:02x} {:02x} {:02x} {:02x} {:02x} {:02x} {:02x} {:02x}",
-            *buffer.offset_pointer(0), *buffer.offset_pointer(1),
-            *buffer.offset_pointer(2), *buffer.offset_pointer(3),
-            *buffer.offset_pointer(4), *buffer.offset_pointer(5),
-            *buffer.offset_pointer(6), *buffer.offset_pointer(7));
-        m_write_ahead_log.set(block, buffer);
+        VERIFY(size > 0);
+        VERIFY(m_pages.is_empty());
+        m_page_pool_size = size;
     }
-
-    ErrorOr<void> flush();
+    size_t dirty_page_count() const;
 
 private:
+    struct Page {
+        u32 block { 0 };
+        bool in_use { false };
+        bool dirty { false };
+        u32 pin_count { 0 };
+        u64 last_used { 0 };
+        ByteBuffer buffer;
+    };
+
+    struct BlockWrite {
+        u32 block { 0 };
+        ReadonlyBytes bytes;
+    };
+
+    enum class WalRecordType : u32 {
+        Block = 1,
+        Commit = 2,
+    };
+
     explicit Heap(String);
 
-    ErrorOr<void> write_block(u32, ByteBuffer&);
-    ErrorOr<void> seek_block(u32);
+    ErrorOr<Page*> fetch_page(u32, bool read_from_file);
+    ErrorOr<Page*> allocate_page();
+    ErrorOr<void> append_to_wal(Vector<Page*> const&, bool commit);
+    ErrorOr<void> recover_from_wal();
+    ErrorOr<void> write_block(u32, ReadonlyBytes);
+    ErrorOr<void> write_blocks(Vector<BlockWrite> const&);
     ErrorOr<void> read_zero_block();
     void initialize_zero_block();
     void update_zero_block();
 
     RefPtr<Core::File> m_file { nullptr };
+    RefPtr<Core::File> m_wal { nullptr };
+    u64 m_wal_size { 0 };
+    u64 m_wal_sequence { 0 };
+    bool m_wal_has_uncommitted_records { false };
+    HashMap<u32, u64> m_wal_index;
+    size_t m_checkpoint_threshold { DEFAULT_CHECKPOINT_THRESHOLD };
     u32 m_free_list { 0 };
     u32 m_next_block { 1 };
     u32 m_end_of_file { 1 };
     u32 m_schemas_root { 0 };
     u32 m_tables_root { 0 };
     u32 m_table_columns_root { 0 };
-    u32 m_version { 0x00000001 };
+    u32 m_version { HEAP_VERSION };
     Array<u32, 16> m_user_values { 0 };
-    HashMap<u32, ByteBuffer> m_write_ahead_log;
+    Vector<Page> m_pages;
+    HashMap<u32, size_t> m_page_index;
+    size_t m_page_pool_size { DEFAULT_PAGE_POOL_SIZE };
+    u64 m_page_clock { 0 };
 };
 
 }
@@ -34,16 +34,163 @@ Row::Row(RefPtr<TableDef> table, u32 pointer, Serializer& serializer)
     Row::deserialize(serializer);
 }
 
+// Rows are stored in a fixed layout that follows the columns of their table: a bitmap marking
+// the null fields, then a slot for every column, then the contents of the text fields. A column's
+// slot is at the same offset in every row of the table, and a text slot holds the offset and
+// length of the text, so any field can be located without decoding the ones before it.
+static size_t slot_size(SQLType type)
+{
+    switch (type) {
+    case SQLType::Integer:
+        return sizeof(i32);
+    case SQLType::Float:
+        return sizeof(double);
+    case SQLType::Boolean:
+        return sizeof(u8);
+    case SQLType::Text:
+        return 2 * sizeof(u16);
+    default:
+        VERIFY_NOT_REACHED();
+    }
+}
+
+static size_t null_bitmap_size(size_t column_count)
+{
+    return (column_count + 7) / 8;
+}
+
+bool Row::is_stored_as_null(size_t ix) const
+{
+    auto& value = (*this)[ix];
+    if (value.is_null())
+        return true;
+    switch ((*descriptor())[ix].type) {
+    case SQLType::Integer:
+        return !value.to_int().has_value();
+    case SQLType::Float:
+        return !value.to_double().has_value();
+    case SQLType::Boolean:
+        return !value.to_bool().has_value();
+    default:
+        return false;
+    }
+}
+
+size_t Row::length() const
+{
+    size_t length = 2 * sizeof(u32) + sizeof(u16) + null_bitmap_size(size());
+    for (auto ix = 0u; ix < size(); ix++) {
+        auto type = (*descriptor())[ix].type;
+        length += slot_size(type);
+        if (type == SQLType::Text && !is_stored_as_null(ix))
+            length += (*this)[ix].to_string().length();
+    }
+    return length;
+}
+
 void Row::deserialize(Serializer& serializer)
 {
-    Tuple::deserialize(serializer);
+    set_pointer(serializer.deserialize<u32>());
     m_next_pointer = serializer.deserialize<u32>();
+    auto column_count = serializer.deserialize<u16>();
+    VERIFY(column_count == size());
+    auto null_bitmap = serializer.deserialize_bytes(null_bitmap_size(column_count));
+
+    struct TextField {
+        size_t column;
+        u16 offset;
+        u16 length;
+    };
+    Vector<TextField> text_fields;
+    size_t text_length = 0;
+    for (auto ix = 0u; ix < column_count; ix++) {
+        auto type = (*descriptor())[ix].type;
+        auto is_null = (null_bitmap[ix / 8] & (1 << (ix % 8))) != 0;
+        if (is_null)
+            (*this)[ix] = Value(type);
+        switch (type) {
+        case SQLType::Integer: {
+            auto value = serializer.deserialize<i32>();
+            if (!is_null)
+                (*this)[ix] = static_cast<int>(value);
+            break;
+        }
+        case SQLType::Float: {
+            auto value = serializer.deserialize<double>();
+            if (!is_null)
+                (*this)[ix] = value;
+            break;
+        }
+        case SQLType::Boolean: {
+            auto value = serializer.deserialize<u8>();
+            if (!is_null)
+                (*this)[ix] = value != 0;
+            break;
+        }
+        case SQLType::Text: {
+            auto offset = serializer.deserialize<u16>();
+            auto length = serializer.deserialize<u16>();
+            if (!is_null) {
+                text_fields.append({ ix, offset, length });
+                text_length = max(text_length, static_cast<size_t>(offset + length));
+            }
+            break;
+        }
+        default:
+            VERIFY_NOT_REACHED();
+        }
+    }
+    auto text = serializer.deserialize_bytes(text_length);
+    for (auto& field : text_fields)
+        (*this)[field.column] = String(text.slice(field.offset, field.length));
 }
 
 void Row::serialize(Serializer& serializer) const
 {
-    Tuple::serialize(serializer);
+    VERIFY(size() == descriptor()->size());
+    VERIFY(size() <= NumericLimits<u16>::max());
+    serializer.serialize<u32>(pointer());
     serializer.serialize<u32>(next_pointer());
+    serializer.serialize<u16>(static_cast<u16>(size()));
+
+    Vector<u8> null_bitmap;
+    null_bitmap.resize(null_bitmap_size(size()));
+    for (auto ix = 0u; ix < size(); ix++) {
+        if (is_stored_as_null(ix))
+            null_bitmap[ix / 8] |= 1 << (ix % 8);
+    }
+    serializer.serialize_bytes(null_bitmap.span());
+
+    Vector<String> texts;
+    u16 text_offset = 0;
+    for (auto ix = 0u; ix < size(); ix++) {
+        auto& value = (*this)[ix];
+        auto is_null = is_stored_as_null(ix);
+        switch ((*descriptor())[ix].type) {
+        case SQLType::Integer:
+            serializer.serialize<i32>(is_null ? 0 : value.to_int().value());
+            break;
+        case SQLType::Float:
+            serializer.serialize<double>(is_null ? 0 : value.to_double().value());
+            break;
+        case SQLType::Boolean:
+            serializer.serialize<u8>(is_null ? 0 : value.to_bool().value());
+            break;
+        case SQLType::Text: {
+            auto text = is_null ? String::empty() : value.to_string();
+            VERIFY(text_offset + text.length() <= NumericLimits<u16>::max());
+            serializer.serialize<u16>(text_offset);
+            serializer.serialize<u16>(static_cast<u16>(text.length()));
+            text_offset += text.length();
+            texts.append(move(text));
+            break;
+        }
+        default:
+            VERIFY_NOT_REACHED();
+        }
+    }
+    for (auto& text : texts)
+        serializer.serialize_bytes(text.bytes());
 }
 
 void Row::copy_from(Row const& other)
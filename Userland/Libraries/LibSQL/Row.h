@@ -36,7 +36,7 @@ public:
     [[nodiscard]] u32 next_pointer() const { return m_next_pointer; }
     void next_pointer(u32 ptr) { m_next_pointer = ptr; }
     RefPtr<TableDef> table() const { return m_table; }
-    [[nodiscard]] virtual size_t length() const override { return Tuple::length() + sizeof(u32); }
+    [[nodiscard]] virtual size_t length() const override;
     virtual void serialize(Serializer&) const override;
     virtual void deserialize(Serializer&) override;
 
@@ -44,6 +44,8 @@ protected:
     void copy_from(Row const&);
 
 private:
+    bool is_stored_as_null(size_t) const;
+
     RefPtr<TableDef> m_table;
     u32 m_next_pointer { 0 };
 };
@@ -8,6 +8,7 @@
 #pragma once
 
 #include <AK/NonnullOwnPtrVector.h>
+#include <AK/OwnPtr.h>
 #include <AK/Vector.h>
 #include <LibCore/Object.h>
 #include <LibSQL/Tuple.h>
@@ -41,27 +42,28 @@ constexpr char const* command_tag(SQLCommand command)
     }
 }
 
-#define ENUMERATE_SQL_ERRORS(S)                                                          \
-    S(NoError, "No error")                                                               \
-    S(InternalError, "{}")                                                               \
-    S(NotYetImplemented, "{}")                                                           \
-    S(DatabaseUnavailable, "Database Unavailable")                                       \
-    S(StatementUnavailable, "Statement with id '{}' Unavailable")                        \
-    S(SyntaxError, "Syntax Error")                                                       \
-    S(DatabaseDoesNotExist, "Database '{}' does not exist")                              \
-    S(SchemaDoesNotExist, "Schema '{}' does not exist")                                  \
-    S(SchemaExists, "Schema '{}' already exist")                                         \
-    S(TableDoesNotExist, "Table '{}' does not exist")                                    \
-    S(ColumnDoesNotExist, "Column '{}' does not exist")                                  \
-    S(AmbiguousColumnName, "Column name '{}' is ambiguous")                              \
-    S(TableExists, "Table '{}' already exist")                                           \
-    S(InvalidType, "Invalid type '{}'")                                                  \
-    S(InvalidDatabaseName, "Invalid database name '{}'")                                 \
-    S(InvalidValueType, "Invalid type for attribute '{}'")                               \
-    S(InvalidNumberOfValues, "Number of values does not match number of columns")        \
-    S(BooleanOperatorTypeMismatch, "Cannot apply '{}' operator to non-boolean operands") \
-    S(NumericOperatorTypeMismatch, "Cannot apply '{}' operator to non-numeric operands") \
-    S(IntegerOperatorTypeMismatch, "Cannot apply '{}' operator to non-numeric operands") \
+#define ENUMERATE_SQL_ERRORS(S)                                                                   \
+    S(NoError, "No error")                                                                        \
+    S(InternalError, "{}")                                                                        \
+    S(NotYetImplemented, "{}")                                                                    \
+    S(DatabaseUnavailable, "Database Unavailable")                                                \
+    S(StatementUnavailable, "Statement with id '{}' Unavailable")                                 \
+    S(SyntaxError, "Syntax Error")                                                                \
+    S(DatabaseDoesNotExist, "Database '{}' does not exist")                                       \
+    S(SchemaDoesNotExist, "Schema '{}' does not exist")                                           \
+    S(SchemaExists, "Schema '{}' already exist")                                                  \
+    S(TableDoesNotExist, "Table '{}' does not exist")                                             \
+    S(ColumnDoesNotExist, "Column '{}' does not exist")                                           \
+    S(AmbiguousColumnName, "Column name '{}' is ambiguous")                                       \
+    S(TableExists, "Table '{}' already exist")                                                    \
+    S(InvalidType, "Invalid type '{}'")                                                           \
+    S(InvalidDatabaseName, "Invalid database name '{}'")                                          \
+    S(InvalidValueType, "Invalid type for attribute '{}'")                                        \
+    S(InvalidNumberOfValues, "Number of values does not match number of columns")                 \
+    S(InvalidNumberOfPlaceholderValues, "Number of values does not match number of placeholders") \
+    S(BooleanOperatorTypeMismatch, "Cannot apply '{}' operator to non-boolean operands")          \
+    S(NumericOperatorTypeMismatch, "Cannot apply '{}' operator to non-numeric operands")          \
+    S(IntegerOperatorTypeMismatch, "Cannot apply '{}' operator to non-numeric operands")          \
     S(InvalidOperator, "Invalid operator '{}'")
 
 enum class SQLErrorCode {
@@ -106,6 +108,16 @@ struct SQLError {
     }
 };
 
+class SQLResult;
+
+// Produces the rows of a result one at a time, for example by running the operators of a SELECT.
+// Errors are reported by setting them on the result passed to next().
+class ResultSource {
+public:
+    virtual ~ResultSource() = default;
+    virtual Optional<Tuple> next(SQLResult&) = 0;
+};
+
 class SQLResult : public Core::Object {
     C_OBJECT(SQLResult)
 
@@ -116,6 +128,32 @@ public:
         m_result_set.append(tuple);
     }
 
+    // The first row is fetched right away, so that errors evaluating it are reported by the
+    // statement's execute() like they were when results were always built up front.
+    void set_source(NonnullOwnPtr<ResultSource> source)
+    {
+        m_source = move(source);
+        m_next_row = m_source->next(*this);
+        m_has_results = m_next_row.has_value();
+        if (!m_has_results)
+            m_source = nullptr;
+    }
+
+    // Returns the next row, either from the rows appended to the result or from its source.
+    // Rows taken from the source are not kept.
+    Optional<Tuple> next_row()
+    {
+        if (m_result_set_index < m_result_set.size())
+            return m_result_set[m_result_set_index++];
+        if (!m_next_row.has_value())
+            return {};
+        auto row = m_next_row.release_value();
+        m_next_row = m_source->next(*this);
+        if (!m_next_row.has_value())
+            m_source = nullptr;
+        return row;
+    }
+
     SQLCommand command() const { return m_command; }
     int updated() const { return m_update_count; }
     int inserted() const { return m_insert_count; }
@@ -129,7 +167,15 @@ public:
     bool has_error() const { return m_error.code != SQLErrorCode::NoError; }
     SQLError const& error() const { return m_error; }
     bool has_results() const { return m_has_results; }
-    Vector<Tuple> const& results() const { return m_result_set; }
+    Vector<Tuple> const& results()
+    {
+        while (m_next_row.has_value()) {
+            m_result_set.append(m_next_row.release_value());
+            m_next_row = m_source->next(*this);
+        }
+        m_source = nullptr;
+        return m_result_set;
+    }
 
 private:
     SQLResult() = default;
@@ -162,6 +208,9 @@ private:
     int m_delete_count { 0 };
     bool m_has_results { false };
     Vector<Tuple> m_result_set;
+    size_t m_result_set_index { 0 };
+    OwnPtr<ResultSource> m_source;
+    Optional<Tuple> m_next_row;
 };
 
 }
@@ -29,10 +29,13 @@ public:
     void get_block(u32 pointer)
     {
         VERIFY(m_heap.ptr() != nullptr);
-        auto buffer_or_error = m_heap->read_block(pointer);
-        if (buffer_or_error.is_error())
+        auto block_or_error = m_heap->pin_block(pointer);
+        if (block_or_error.is_error())
             VERIFY_NOT_REACHED();
-        m_buffer = buffer_or_error.value();
+        auto block = block_or_error.release_value();
+        m_buffer.resize(block.size());
+        m_buffer.overwrite(0, block.data(), block.size());
+        m_heap->unpin_block(pointer);
         m_current_offset = 0;
     }
 
@@ -107,13 +110,26 @@ public:
 
     void serialize(String const&);
 
+    void serialize_bytes(ReadonlyBytes bytes)
+    {
+        write(bytes.data(), bytes.size());
+    }
+
+    ReadonlyBytes deserialize_bytes(size_t size)
+    {
+        return { read(size), size };
+    }
+
     template<typename T>
     bool serialize_and_write(T const& t, u32 pointer)
     {
         VERIFY(m_heap.ptr() != nullptr);
         reset();
         serialize<T>(t);
-        m_heap->add_to_wal(pointer, m_buffer);
+        if (auto result = m_heap->add_to_wal(pointer, m_buffer); result.is_error()) {
+            warnln("Could not write block {}: {}", pointer, result.error());
+            return false;
+        }
         return true;
     }
 
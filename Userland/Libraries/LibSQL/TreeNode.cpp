@@ -111,11 +111,123 @@ TreeNode::TreeNode(BTree& tree, TreeNode* up, TreeNode* left, u32 pointer)
     m_is_leaf = left->pointer() == 0;
 }
 
+// Keys in a node are stored in sort order, so neighbouring keys often start the same way. Each
+// key is stored as the number of leading fields it shares with the key before it, and if the
+// first differing field is text, the number of leading characters of that field it shares with
+// the previous key. Only the remainder of the key is written out.
+static bool is_same_value(Value const& value, Value const& other)
+{
+    if (value.is_null() || other.is_null())
+        return value.is_null() && other.is_null();
+    return value == other;
+}
+
+TreeNode::KeyPrefix TreeNode::shared_prefix(Key const& key, Key const* previous)
+{
+    KeyPrefix prefix;
+    if (!previous)
+        return prefix;
+    while (prefix.fields < key.size() && prefix.fields < NumericLimits<u8>::max() && is_same_value(key[prefix.fields], (*previous)[prefix.fields]))
+        prefix.fields++;
+    if (prefix.fields == key.size())
+        return prefix;
+
+    auto& value = key[prefix.fields];
+    auto& previous_value = (*previous)[prefix.fields];
+    if ((*key.descriptor())[prefix.fields].type != SQLType::Text || value.is_null() || previous_value.is_null())
+        return prefix;
+    auto text = value.to_string();
+    auto previous_text = previous_value.to_string();
+    auto max_characters = min(min(text.length(), previous_text.length()), static_cast<size_t>(NumericLimits<u16>::max()));
+    while (prefix.characters < max_characters && text[prefix.characters] == previous_text[prefix.characters])
+        prefix.characters++;
+    return prefix;
+}
+
+static size_t field_length(Value const& value, SQLType type, size_t shared_characters)
+{
+    if (value.is_null())
+        return sizeof(u8);
+    switch (type) {
+    case SQLType::Integer:
+        return sizeof(u8) + sizeof(i32);
+    case SQLType::Float:
+        return sizeof(u8) + sizeof(double);
+    case SQLType::Boolean:
+        return sizeof(u8) + sizeof(u8);
+    case SQLType::Text:
+        return sizeof(u8) + sizeof(u16) + value.to_string().length() - shared_characters;
+    default:
+        VERIFY_NOT_REACHED();
+    }
+}
+
+static void serialize_field(Serializer& serializer, Value const& value, SQLType type, size_t shared_characters)
+{
+    serializer.serialize<u8>(value.is_null());
+    if (value.is_null())
+        return;
+    switch (type) {
+    case SQLType::Integer:
+        serializer.serialize<i32>(value.to_int().value());
+        break;
+    case SQLType::Float:
+        serializer.serialize<double>(value.to_double().value());
+        break;
+    case SQLType::Boolean:
+        serializer.serialize<u8>(value.to_bool().value());
+        break;
+    case SQLType::Text: {
+        auto suffix = value.to_string().substring_view(shared_characters);
+        VERIFY(suffix.length() <= NumericLimits<u16>::max());
+        serializer.serialize<u16>(static_cast<u16>(suffix.length()));
+        serializer.serialize_bytes(suffix.bytes());
+        break;
+    }
+    default:
+        VERIFY_NOT_REACHED();
+    }
+}
+
+static Value deserialize_field(Serializer& serializer, SQLType type, StringView shared_text)
+{
+    if (serializer.deserialize<u8>())
+        return Value(type);
+    switch (type) {
+    case SQLType::Integer:
+        return Value(static_cast<int>(serializer.deserialize<i32>()));
+    case SQLType::Float:
+        return Value(serializer.deserialize<double>());
+    case SQLType::Boolean:
+        return Value(serializer.deserialize<u8>() != 0);
+    case SQLType::Text: {
+        auto length = serializer.deserialize<u16>();
+        auto suffix = serializer.deserialize_bytes(length);
+        StringBuilder builder(shared_text.length() + length);
+        builder.append(shared_text);
+        builder.append(StringView(suffix));
+        return Value(builder.build());
+    }
+    default:
+        VERIFY_NOT_REACHED();
+    }
+}
+
+size_t TreeNode::entry_length(Key const& key, Key const* previous)
+{
+    auto prefix = shared_prefix(key, previous);
+    size_t length = 2 * sizeof(u32) + sizeof(u8) + sizeof(u16);
+    for (auto ix = static_cast<size_t>(prefix.fields); ix < key.size(); ix++)
+        length += field_length(key[ix], (*key.descriptor())[ix].type, ix == prefix.fields ? prefix.characters : 0);
+    return length;
+}
+
 void TreeNode::deserialize(Serializer& serializer)
 {
     auto nodes = serializer.deserialize<u32>();
     dbgln_if(SQL_DEBUG, "Deserializing node. Size {}", nodes);
     if (nodes > 0) {
+        m_down.clear();
         for (u32 i = 0; i < nodes; i++) {
             auto left = serializer.deserialize<u32>();
             dbgln_if(SQL_DEBUG, "Down[{}] {}", i, left);
@@ -123,7 +235,24 @@ void TreeNode::deserialize(Serializer& serializer)
                 VERIFY((left == 0) == m_is_leaf);
             else
                 m_is_leaf = (left == 0);
-            m_entries.append(serializer.deserialize<Key>(m_tree.descriptor()));
+
+            Key key(m_tree.descriptor());
+            key.set_pointer(serializer.deserialize<u32>());
+            auto shared_fields = serializer.deserialize<u8>();
+            auto shared_characters = serializer.deserialize<u16>();
+            VERIFY(shared_fields == 0 || !m_entries.is_empty());
+            for (auto ix = 0u; ix < key.size(); ix++) {
+                auto type = (*key.descriptor())[ix].type;
+                if (ix < shared_fields) {
+                    key[ix] = m_entries.last()[ix];
+                } else if (ix == shared_fields && shared_characters > 0) {
+                    auto shared_text = m_entries.last()[ix].to_string();
+                    key[ix] = deserialize_field(serializer, type, shared_text.substring_view(0, shared_characters));
+                } else {
+                    key[ix] = deserialize_field(serializer, type, {});
+                }
+            }
+            m_entries.append(move(key));
             m_down.empend(this, left);
         }
         auto right = serializer.deserialize<u32>();
@@ -142,7 +271,12 @@ void TreeNode::serialize(Serializer& serializer) const
             auto& entry = m_entries[ix];
             dbgln_if(SQL_DEBUG, "Serializing Left[{}] = {}", ix, m_down[ix].pointer());
             serializer.serialize<u32>(is_leaf() ? 0u : m_down[ix].pointer());
-            serializer.serialize<Key>(entry);
+            serializer.serialize<u32>(entry.pointer());
+            auto prefix = shared_prefix(entry, ix > 0 ? &m_entries[ix - 1] : nullptr);
+            serializer.serialize<u8>(prefix.fields);
+            serializer.serialize<u16>(prefix.characters);
+            for (auto field = static_cast<size_t>(prefix.fields); field < entry.size(); field++)
+                serialize_field(serializer, entry[field], (*entry.descriptor())[field].type, field == prefix.fields ? prefix.characters : 0);
         }
         dbgln_if(SQL_DEBUG, "Serializing Right = {}", m_down[size()].pointer());
         serializer.serialize<u32>(is_leaf() ? 0u : m_down[size()].pointer());
@@ -153,26 +287,32 @@ size_t TreeNode::length() const
 {
     if (!size())
         return 0;
-    size_t len = sizeof(u32);
-    for (auto& key : m_entries) {
-        len += sizeof(u32) + key.length();
-    }
+    size_t len = 2 * sizeof(u32);
+    for (auto ix = 0u; ix < size(); ix++)
+        len += entry_length(m_entries[ix], ix > 0 ? &m_entries[ix - 1] : nullptr);
     return len;
 }
 
 bool TreeNode::insert(Key const& key)
 {
     dbgln_if(SQL_DEBUG, "[#{}] INSERT({})", pointer(), key.to_string());
-    if (!is_leaf())
-        return node_for(key)->insert_in_leaf(key);
+    if (!is_leaf()) {
+        auto* node = node_for(key);
+        // node_for() only stops at a non-leaf node if it holds the key already:
+        if (!node->is_leaf())
+            return false;
+        return node->insert_in_leaf(key);
+    }
     return insert_in_leaf(key);
 }
 
 bool TreeNode::update_key_pointer(Key const& key)
 {
     dbgln_if(SQL_DEBUG, "[#{}] UPDATE({}, {})", pointer(), key.to_string(), key.pointer());
-    if (!is_leaf())
-        return node_for(key)->update_key_pointer(key);
+    if (!is_leaf()) {
+        if (auto* node = node_for(key); node != this)
+            return node->update_key_pointer(key);
+    }
 
     for (auto ix = 0u; ix < size(); ix++) {
         if (key == m_entries[ix]) {
@@ -224,6 +364,9 @@ TreeNode* TreeNode::down_node(size_t ix)
     return m_down[ix].node();
 }
 
+// Returns the leaf the key belongs in. If duplicates are not allowed and a
+// non-leaf node holds the key, that node is returned instead, since the key
+// cannot also be in one of the leaves below it.
 TreeNode* TreeNode::node_for(Key const& key)
 {
     dump_if(SQL_DEBUG, String::formatted("node_for(Key {})", key.to_string()));
@@ -235,6 +378,8 @@ TreeNode* TreeNode::node_for(Key const& key)
                 pointer(), (String)key, (String)m_entries[ix], m_down[ix].pointer());
             return down_node(ix)->node_for(key);
         }
+        if (!m_tree.duplicates_allowed() && key == m_entries[ix])
+            return this;
     }
     dbgln_if(SQL_DEBUG, "[#{}] {} >= {} v{}",
         pointer(), key.to_string(), (String)m_entries[size() - 1], m_down[size()].pointer());
@@ -346,7 +491,7 @@ void TreeNode::split()
     dump_if(SQL_DEBUG, "Split Left To WAL");
     tree().serializer().serialize_and_write(*this, pointer());
     new_node->dump_if(SQL_DEBUG, "Split Right to WAL");
-    tree().serializer().serialize_and_write(*new_node, pointer());
+    tree().serializer().serialize_and_write(*new_node, new_node->pointer());
 
     m_up->just_insert(median, new_node);
 }
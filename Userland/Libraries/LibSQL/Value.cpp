@@ -315,7 +315,8 @@ Value& Value::operator=(Vector<Value> const& vector)
 
 size_t Value::length() const
 {
-    return m_impl.visit([&](auto& impl) { return impl.length(); });
+    // Every serialized value starts with its type flags, see Value::serialize().
+    return sizeof(u8) + m_impl.visit([&](auto& impl) { return impl.length(); });
 }
 
 u32 Value::hash() const
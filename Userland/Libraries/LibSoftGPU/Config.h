@@ -19,6 +19,10 @@ static constexpr int NUM_SAMPLERS = 32;
 static constexpr int SUBPIXEL_BITS = 5;
 static constexpr int NUM_LIGHTS = 8;
 
+// Triangles are sorted into square tiles of this size, which are then rasterized in parallel.
+// This has to be a multiple of 2, so that pixel quads never straddle two tiles.
+static constexpr int RASTERIZER_TILE_SIZE = 64;
+
 // See: https://www.khronos.org/opengl/wiki/Common_Mistakes#Texture_edge_color_problem
 // FIXME: make this dynamically configurable through ConfigServer
 static constexpr bool CLAMP_DEPRECATED_BEHAVIOR = false;
@@ -11,7 +11,13 @@ namespace SoftGPU {
 DepthBuffer::DepthBuffer(Gfx::IntSize const& size)
     : m_size(size)
     , m_data(new float[size.width() * size.height()])
+    , m_tile_columns(ceil_div(size.width(), tile_size))
+    , m_tile_rows(ceil_div(size.height(), tile_size))
 {
+    m_tile_max_depth.resize(m_tile_columns * m_tile_rows);
+    m_tile_is_dirty.resize(m_tile_columns * m_tile_rows);
+    m_tile_is_dirty.span().fill(true);
+    m_tile_lowered_writes.resize(m_tile_columns * m_tile_rows);
 }
 
 DepthBuffer::~DepthBuffer()
@@ -31,6 +37,10 @@ void DepthBuffer::clear(float depth)
     for (int i = 0; i < num_entries; ++i) {
         m_data[i] = depth;
     }
+
+    m_tile_max_depth.span().fill(depth);
+    m_tile_is_dirty.span().fill(false);
+    m_tile_lowered_writes.span().fill(0);
 }
 
 void DepthBuffer::clear(Gfx::IntRect bounds, float depth)
@@ -39,6 +49,38 @@ void DepthBuffer::clear(Gfx::IntRect bounds, float depth)
     for (int y = bounds.top(); y <= bounds.bottom(); ++y)
         for (int x = bounds.left(); x <= bounds.right(); ++x)
             m_data[y * m_size.width() + x] = depth;
+
+    if (bounds.is_empty())
+        return;
+
+    for (int tile_y = bounds.top() / tile_size; tile_y <= bounds.bottom() / tile_size; ++tile_y)
+        for (int tile_x = bounds.left() / tile_size; tile_x <= bounds.right() / tile_size; ++tile_x)
+            m_tile_is_dirty[tile_y * m_tile_columns + tile_x] = true;
+}
+
+float DepthBuffer::max_depth_in_tile(int tile_x, int tile_y)
+{
+    VERIFY(tile_x >= 0 && tile_x < m_tile_columns);
+    VERIFY(tile_y >= 0 && tile_y < m_tile_rows);
+
+    auto const index = tile_y * m_tile_columns + tile_x;
+    if (!m_tile_is_dirty[index])
+        return m_tile_max_depth[index];
+
+    int const x0 = tile_x * tile_size;
+    int const y0 = tile_y * tile_size;
+    int const x1 = min(x0 + tile_size, m_size.width());
+    int const y1 = min(y0 + tile_size, m_size.height());
+
+    float max_depth = m_data[y0 * m_size.width() + x0];
+    for (int y = y0; y < y1; ++y)
+        for (int x = x0; x < x1; ++x)
+            max_depth = max(max_depth, m_data[y * m_size.width() + x]);
+
+    m_tile_max_depth[index] = max_depth;
+    m_tile_is_dirty[index] = false;
+    m_tile_lowered_writes[index] = 0;
+    return max_depth;
 }
 
 }
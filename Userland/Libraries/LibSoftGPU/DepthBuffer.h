@@ -6,13 +6,18 @@
 
 #pragma once
 
+#include <AK/Vector.h>
 #include <LibGfx/Rect.h>
 #include <LibGfx/Size.h>
 
 namespace SoftGPU {
 
+// Besides the per-pixel depth values, the buffer keeps track of the farthest depth value within each tile of
+// tile_size x tile_size pixels. This allows rejecting triangles that lie behind a whole tile without testing its pixels.
 class DepthBuffer final {
 public:
+    static constexpr int tile_size = 8;
+
     DepthBuffer(Gfx::IntSize const&);
     ~DepthBuffer();
 
@@ -21,9 +26,33 @@ public:
     void clear(float depth);
     void clear(Gfx::IntRect bounds, float depth);
 
+    // Has to be called after changing any depth value of the tile containing the pixel at x, y
+    void invalidate_tile(int x, int y) { m_tile_is_dirty[tile_index(x, y)] = true; }
+
+    // Writing depth values that are lower than the previous ones keeps the cached maximum a valid upper bound,
+    // so it only gets recalculated once enough of those writes have piled up.
+    void did_lower_depth_values(int x, int y)
+    {
+        auto index = tile_index(x, y);
+        if (++m_tile_lowered_writes[index] >= max_lowered_writes_per_tile)
+            m_tile_is_dirty[index] = true;
+    }
+
+    float max_depth_in_tile(int tile_x, int tile_y);
+
 private:
+    static constexpr u8 max_lowered_writes_per_tile = tile_size * tile_size / 4;
+
+    int tile_index(int x, int y) const { return (y / tile_size) * m_tile_columns + x / tile_size; }
+
     Gfx::IntSize m_size;
     float* m_data { nullptr };
+
+    int m_tile_columns { 0 };
+    int m_tile_rows { 0 };
+    Vector<float> m_tile_max_depth;
+    Vector<bool> m_tile_is_dirty;
+    Vector<u8> m_tile_lowered_writes;
 };
 
 }
@@ -5,6 +5,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Atomic.h>
 #include <AK/Function.h>
 #include <AK/Math.h>
 #include <AK/SIMDExtras.h>
@@ -17,15 +18,26 @@
 #include <LibSoftGPU/Device.h>
 #include <LibSoftGPU/PixelQuad.h>
 #include <LibSoftGPU/SIMD.h>
+#include <LibThreading/Parallel.h>
 
 namespace SoftGPU {
 
-static long long g_num_rasterized_triangles;
-static long long g_num_pixels;
-static long long g_num_pixels_shaded;
-static long long g_num_pixels_blended;
-static long long g_num_sampler_calls;
-static long long g_num_quads;
+// These are updated from all rasterizer threads
+static Atomic<long long> g_num_rasterized_triangles;
+static Atomic<long long> g_num_pixels;
+static Atomic<long long> g_num_pixels_shaded;
+static Atomic<long long> g_num_pixels_blended;
+static Atomic<long long> g_num_sampler_calls;
+static Atomic<long long> g_num_quads;
+
+// Below this many pixels covered by the bounding boxes of the triangles of a draw call, waking up the
+// rasterizer threads costs more than it saves.
+static constexpr size_t parallel_rasterization_threshold = 16384;
+
+// All coarse depth buffer tiles touched by one rasterizer tile need to fit in a 64-bit mask
+static constexpr int depth_tiles_per_rasterizer_tile = RASTERIZER_TILE_SIZE / DepthBuffer::tile_size;
+static_assert(RASTERIZER_TILE_SIZE % DepthBuffer::tile_size == 0);
+static_assert(depth_tiles_per_rasterizer_tile * depth_tiles_per_rasterizer_tile <= 64);
 
 using IntVector2 = Gfx::Vector2<int>;
 using IntVector3 = Gfx::Vector3<int>;
@@ -185,14 +197,71 @@ void Device::setup_blend_factors()
     }
 }
 
-void Device::rasterize_triangle(const Triangle& triangle)
+void Device::bin_triangle(size_t triangle_index, Gfx::IntRect const& render_bounds)
 {
     INCREASE_STATISTICS_COUNTER(g_num_rasterized_triangles, 1);
 
-    // Return if alpha testing is a no-op
-    if (m_options.enable_alpha_test && m_options.alpha_test_func == AlphaTestFunction::Never)
+    auto const& triangle = m_processed_triangles[triangle_index];
+    auto const& p0 = triangle.vertices[0].window_coordinates;
+    auto const& p1 = triangle.vertices[1].window_coordinates;
+    auto const& p2 = triangle.vertices[2].window_coordinates;
+
+    // This is a bit more generous than the pixel coverage tests in rasterize_triangle(), so that no tile misses
+    // a triangle because of rounding.
+    int const x0 = static_cast<int>(floorf(min(min(p0.x(), p1.x()), p2.x()))) - 1;
+    int const x1 = static_cast<int>(floorf(max(max(p0.x(), p1.x()), p2.x()))) + 1;
+    int const y0 = static_cast<int>(floorf(min(min(p0.y(), p1.y()), p2.y()))) - 1;
+    int const y1 = static_cast<int>(floorf(max(max(p0.y(), p1.y()), p2.y()))) + 1;
+    auto const bounds = Gfx::IntRect::from_two_points({ x0, y0 }, { x1 + 1, y1 + 1 }).intersected(render_bounds);
+    if (bounds.is_empty())
         return;
 
+    m_binned_area += bounds.width() * bounds.height();
+
+    for (int tile_y = bounds.top() / RASTERIZER_TILE_SIZE; tile_y <= bounds.bottom() / RASTERIZER_TILE_SIZE; ++tile_y) {
+        for (int tile_x = bounds.left() / RASTERIZER_TILE_SIZE; tile_x <= bounds.right() / RASTERIZER_TILE_SIZE; ++tile_x) {
+            u32 tile_index = tile_y * m_tile_columns + tile_x;
+            auto& bin = m_tile_bins[tile_index];
+            if (bin.is_empty())
+                m_binned_tiles.append(tile_index);
+            bin.append(static_cast<u32>(triangle_index));
+        }
+    }
+}
+
+void Device::rasterize_binned_triangles(Gfx::IntRect const& render_bounds)
+{
+    // Every tile is rasterized on its own, with its triangles in the order they were submitted in. Since tiles
+    // don't share any pixels, they can be spread over all threads without changing the result.
+    auto rasterize_tile = [&](size_t index) {
+        u32 tile_index = m_binned_tiles[index];
+        Gfx::IntRect tile_rect {
+            static_cast<int>(tile_index % m_tile_columns) * RASTERIZER_TILE_SIZE,
+            static_cast<int>(tile_index / m_tile_columns) * RASTERIZER_TILE_SIZE,
+            RASTERIZER_TILE_SIZE,
+            RASTERIZER_TILE_SIZE,
+        };
+        auto const tile_bounds = tile_rect.intersected(render_bounds);
+        auto& bin = m_tile_bins[tile_index];
+        for (auto triangle_index : bin)
+            rasterize_triangle(m_processed_triangles[triangle_index], tile_bounds);
+        bin.clear_with_capacity();
+    };
+
+    if (m_binned_area < parallel_rasterization_threshold) {
+        for (size_t i = 0; i < m_binned_tiles.size(); ++i)
+            rasterize_tile(i);
+    } else {
+        // Tiles vary a lot in how many triangles they have, so they are handed out one at a time.
+        Threading::parallel_for(m_binned_tiles.size(), rasterize_tile, 1);
+    }
+
+    m_binned_tiles.clear_with_capacity();
+    m_binned_area = 0;
+}
+
+void Device::rasterize_triangle(const Triangle& triangle, Gfx::IntRect const& render_bounds)
+{
     // Vertices
     Vertex const vertex0 = triangle.vertices[0];
     Vertex const vertex1 = triangle.vertices[1];
@@ -211,10 +280,6 @@ void Device::rasterize_triangle(const Triangle& triangle)
 
     auto const one_over_area = 1.0f / area;
 
-    auto render_bounds = m_render_target->rect();
-    if (m_options.scissor_enabled)
-        render_bounds.intersect(window_coordinates_to_target_coordinates(m_options.scissor_box, m_render_target->rect()));
-
     // Obey top-left rule:
     // This sets up "zero" for later pixel coverage tests.
     // Depending on where on the triangle the edge is located
@@ -252,6 +317,30 @@ void Device::rasterize_triangle(const Triangle& triangle)
     int const by1 = (min(render_bounds.bottom(), max(max(v0.y(), v1.y()), v2.y()) / subpixel_factor) & ~1) + 2;
     // clang-format on
 
+    // Reject the coarse depth buffer tiles that lie entirely in front of the triangle. Since the interpolated depth
+    // values may end up a few ULPs below the closest vertex, the comparison allows for a small error.
+    u64 occluded_tiles = 0;
+    int const first_tile_x = bx0 / DepthBuffer::tile_size;
+    int const first_tile_y = by0 / DepthBuffer::tile_size;
+    if (m_options.enable_depth_test
+        && (m_options.depth_func == DepthTestFunction::Less
+            || m_options.depth_func == DepthTestFunction::LessOrEqual
+            || m_options.depth_func == DepthTestFunction::Equal)) {
+        float const min_depth = min(min(vertex0.window_coordinates.z(), vertex1.window_coordinates.z()), vertex2.window_coordinates.z())
+            + m_options.depth_offset_constant * NumericLimits<float>::epsilon()
+            - 8 * NumericLimits<float>::epsilon();
+        int const last_tile_x = (bx1 - 1) / DepthBuffer::tile_size;
+        int const last_tile_y = (by1 - 1) / DepthBuffer::tile_size;
+        for (int tile_y = first_tile_y; tile_y <= last_tile_y; ++tile_y) {
+            for (int tile_x = first_tile_x; tile_x <= last_tile_x; ++tile_x) {
+                auto const max_depth = m_depth_buffer->max_depth_in_tile(tile_x, tile_y);
+                bool const is_occluded = m_options.depth_func == DepthTestFunction::Less ? min_depth >= max_depth : min_depth > max_depth;
+                if (is_occluded)
+                    occluded_tiles |= 1ull << ((tile_y - first_tile_y) * depth_tiles_per_rasterizer_tile + tile_x - first_tile_x);
+            }
+        }
+    }
+
     // Fog depths
     float const vertex0_eye_absz = fabs(vertex0.eye_coordinates.z());
     float const vertex1_eye_absz = fabs(vertex1.eye_coordinates.z());
@@ -273,6 +362,9 @@ void Device::rasterize_triangle(const Triangle& triangle)
     for (int by = by0; by < by1; by += 2) {
         for (int bx = bx0; bx < bx1; bx += 2) {
 
+            if (occluded_tiles & (1ull << ((by / DepthBuffer::tile_size - first_tile_y) * depth_tiles_per_rasterizer_tile + bx / DepthBuffer::tile_size - first_tile_x)))
+                continue;
+
             PixelQuad quad;
 
             quad.screen_coordinates = {
@@ -417,6 +509,10 @@ void Device::rasterize_triangle(const Triangle& triangle)
             // Write to depth buffer
             if (m_options.enable_depth_test && m_options.enable_depth_write) {
                 store4_masked(quad.depth, depth_ptrs[0], depth_ptrs[1], depth_ptrs[2], depth_ptrs[3], quad.mask);
+                if (m_options.depth_func == DepthTestFunction::Less || m_options.depth_func == DepthTestFunction::LessOrEqual || m_options.depth_func == DepthTestFunction::Equal)
+                    m_depth_buffer->did_lower_depth_values(bx, by);
+                else
+                    m_depth_buffer->invalidate_tile(bx, by);
             }
 
             // We will not update the color buffer at all
@@ -548,9 +644,183 @@ static void generate_texture_coordinates(Vertex& vertex, RasterizerOptions const
     };
 }
 
+ALWAYS_INLINE static Vector4<f32x4> gather4(Array<Vertex*, 4> const& vertices, FloatVector4 Vertex::*member)
+{
+    auto const& a = vertices[0]->*member;
+    auto const& b = vertices[1]->*member;
+    auto const& c = vertices[2]->*member;
+    auto const& d = vertices[3]->*member;
+    return {
+        f32x4 { a.x(), b.x(), c.x(), d.x() },
+        f32x4 { a.y(), b.y(), c.y(), d.y() },
+        f32x4 { a.z(), b.z(), c.z(), d.z() },
+        f32x4 { a.w(), b.w(), c.w(), d.w() },
+    };
+}
+
+ALWAYS_INLINE static Vector3<f32x4> gather4(Array<Vertex*, 4> const& vertices, FloatVector3 Vertex::*member)
+{
+    auto const& a = vertices[0]->*member;
+    auto const& b = vertices[1]->*member;
+    auto const& c = vertices[2]->*member;
+    auto const& d = vertices[3]->*member;
+    return {
+        f32x4 { a.x(), b.x(), c.x(), d.x() },
+        f32x4 { a.y(), b.y(), c.y(), d.y() },
+        f32x4 { a.z(), b.z(), c.z(), d.z() },
+    };
+}
+
+ALWAYS_INLINE static void scatter4(Array<Vertex*, 4> const& vertices, size_t count, FloatVector4 Vertex::*member, Vector4<f32x4> const& value)
+{
+    for (size_t i = 0; i < count; ++i)
+        vertices[i]->*member = { value.x()[i], value.y()[i], value.z()[i], value.w()[i] };
+}
+
+ALWAYS_INLINE static void scatter4(Array<Vertex*, 4> const& vertices, size_t count, FloatVector3 Vertex::*member, Vector3<f32x4> const& value)
+{
+    for (size_t i = 0; i < count; ++i)
+        vertices[i]->*member = { value.x()[i], value.y()[i], value.z()[i] };
+}
+
+// These do the same math as the operators of Matrix4x4, for four vectors at once
+ALWAYS_INLINE static Vector4<f32x4> transform4(FloatMatrix4x4 const& m, Vector4<f32x4> const& v)
+{
+    auto const& elements = m.elements();
+    return {
+        v.x() * elements[0][0] + v.y() * elements[0][1] + v.z() * elements[0][2] + v.w() * elements[0][3],
+        v.x() * elements[1][0] + v.y() * elements[1][1] + v.z() * elements[1][2] + v.w() * elements[1][3],
+        v.x() * elements[2][0] + v.y() * elements[2][1] + v.z() * elements[2][2] + v.w() * elements[2][3],
+        v.x() * elements[3][0] + v.y() * elements[3][1] + v.z() * elements[3][2] + v.w() * elements[3][3],
+    };
+}
+
+ALWAYS_INLINE static Vector3<f32x4> transform_direction4(FloatMatrix4x4 const& m, Vector3<f32x4> const& d)
+{
+    auto const& elements = m.elements();
+    return {
+        d.x() * elements[0][0] + d.y() * elements[0][1] + d.z() * elements[0][2],
+        d.x() * elements[1][0] + d.y() * elements[1][1] + d.z() * elements[1][2],
+        d.x() * elements[2][0] + d.y() * elements[2][1] + d.z() * elements[2][2],
+    };
+}
+
+ALWAYS_INLINE static f32x4 sqrt4(f32x4 v)
+{
+    return f32x4 { AK::sqrt(v[0]), AK::sqrt(v[1]), AK::sqrt(v[2]), AK::sqrt(v[3]) };
+}
+
+Vector4<f32x4> Device::light_vertices(Vector4<f32x4> const& eye_coordinates, Vector3<f32x4> const& normal) const
+{
+    auto const& front_material = m_materials.at(0);
+    auto result_color = expand4(front_material.emissive + (front_material.ambient * m_lighting_model.scene_ambient_color));
+
+    for (auto const& light : m_lights) {
+        if (!light.is_enabled)
+            continue;
+
+        Vector4<f32x4> vertex_to_light;
+
+        // Light attenuation value.
+        auto light_attenuation_factor = expand4(1.0f);
+        if (light.position.w() != 0.0f) {
+            vertex_to_light = expand4(light.position) - eye_coordinates;
+            auto const vertex_to_light_length = sqrt4(vertex_to_light.dot(vertex_to_light));
+            auto const vertex_to_light_length_squared = vertex_to_light_length * vertex_to_light_length;
+
+            light_attenuation_factor = 1.0f / (light.constant_attenuation + (light.linear_attenuation * vertex_to_light_length) + (light.quadratic_attenuation * vertex_to_light_length_squared));
+            vertex_to_light = vertex_to_light / vertex_to_light_length;
+        } else {
+            vertex_to_light = expand4(light.position.normalized());
+        }
+
+        // Spotlight factor
+        auto spotlight_factor = expand4(1.0f);
+        if (light.spotlight_cutoff_angle != 180.0f) {
+            auto const spotlight_direction_normalized = expand4(light.spotlight_direction.normalized());
+            auto const light_to_vertex_dot_normalized_spotlight_direction = spotlight_direction_normalized.x() * vertex_to_light.x()
+                + spotlight_direction_normalized.y() * vertex_to_light.y()
+                + spotlight_direction_normalized.z() * vertex_to_light.z();
+            auto const cos_spotlight_cutoff = AK::cos<float>(light.spotlight_cutoff_angle);
+
+            for (size_t i = 0; i < 4; ++i) {
+                if (light_to_vertex_dot_normalized_spotlight_direction[i] >= cos_spotlight_cutoff)
+                    spotlight_factor[i] = AK::pow<float>(light_to_vertex_dot_normalized_spotlight_direction[i], light.spotlight_exponent);
+                else
+                    spotlight_factor[i] = 0.0f;
+            }
+        }
+
+        // FIXME: Specular. The math for it doesn't quite make sense...
+        (void)m_lighting_model.viewer_at_infinity;
+
+        // FIXME: The spec allows for splitting the colors calculated here into multiple different colors (primary/secondary color). Investigate what this means.
+        (void)m_lighting_model.single_color;
+
+        // FIXME: Two sided lighting should be implemented eventually (I believe this is where the normals are -ve and then lighting is calculated with the BACK material)
+        (void)m_lighting_model.two_sided_lighting;
+
+        // Ambient
+        auto const ambient_component = expand4(front_material.ambient * light.ambient_intensity);
+
+        // Diffuse
+        auto const normal_dot_vertex_to_light = normal.x() * vertex_to_light.x() + normal.y() * vertex_to_light.y() + normal.z() * vertex_to_light.z();
+        auto const diffuse_component = (expand4(front_material.diffuse * light.diffuse_intensity) * normal_dot_vertex_to_light).clamped(expand4(0.0f), expand4(1.0f));
+
+        auto color = ambient_component;
+        color += diffuse_component;
+        color = color * light_attenuation_factor * spotlight_factor;
+        result_color += color;
+    }
+
+    result_color.set_w(expand4(front_material.diffuse.w())); // OpenGL 1.5 spec, page 59: "The A produced by lighting is the alpha value associated with diffuse color material"
+    result_color.clamp(expand4(0.0f), expand4(1.0f));
+    return result_color;
+}
+
+void Device::transform_vertices(FloatMatrix4x4 const& model_view_transform, FloatMatrix3x3 const& normal_transform, FloatMatrix4x4 const& projection_transform, FloatMatrix4x4 const& texture_transform)
+{
+    // Positions, normals and lighting are handled four vertices at a time
+    for (size_t i = 0; i < m_transformed_vertices.size(); i += 4) {
+        size_t const count = min(m_transformed_vertices.size() - i, 4u);
+        Array<Vertex*, 4> vertices;
+        for (size_t j = 0; j < 4; ++j)
+            vertices[j] = &m_transformed_vertices[i + min(j, count - 1)];
+
+        // Transform vertices into eye coordinates using the model-view transform
+        auto const eye_coordinates = transform4(model_view_transform, gather4(vertices, &Vertex::position));
+        scatter4(vertices, count, &Vertex::eye_coordinates, eye_coordinates);
+
+        // Transform the vertex normals into eye-space
+        auto const normal = transform_direction4(model_view_transform, gather4(vertices, &Vertex::normal));
+        scatter4(vertices, count, &Vertex::normal, normal);
+
+        // Transform eye coordinates into clip coordinates using the projection transform
+        scatter4(vertices, count, &Vertex::clip_coordinates, transform4(projection_transform, eye_coordinates));
+
+        if (m_options.lighting_enabled)
+            scatter4(vertices, count, &Vertex::color, light_vertices(eye_coordinates, normal));
+    }
+
+    for (auto& vertex : m_transformed_vertices) {
+        // Transform normals
+        vertex.normal = normal_transform * vertex.normal;
+        if (m_options.normalization_enabled)
+            vertex.normal.normalize();
+
+        // Generate texture coordinates if at least one coordinate is enabled
+        if (m_options.texcoord_generation_enabled_coordinates != TexCoordGenerationCoordinate::None)
+            generate_texture_coordinates(vertex, m_options);
+
+        // Apply texture transformation
+        // FIXME: implement multi-texturing: texcoords should be stored per texture unit
+        vertex.tex_coord = texture_transform * vertex.tex_coord;
+    }
+}
+
 void Device::draw_primitives(PrimitiveType primitive_type, FloatMatrix4x4 const& model_view_transform, FloatMatrix3x3 const& normal_transform,
     FloatMatrix4x4 const& projection_transform, FloatMatrix4x4 const& texture_transform, Vector<Vertex> const& vertices,
-    Vector<size_t> const& enabled_texture_units)
+    Vector<u32> const& indices, Vector<size_t> const& enabled_texture_units)
 {
     // At this point, the user has effectively specified that they are done with defining the geometry
     // of what they want to draw. We now need to do a few things (https://www.khronos.org/opengl/wiki/Rendering_Pipeline_Overview):
@@ -561,71 +831,90 @@ void Device::draw_primitives(PrimitiveType primitive_type, FloatMatrix4x4 const&
     // 4.   Each element of the vertex is then divided by w to bring the positions into NDC (Normalized Device Coordinates)
     // 5.   The vertices are sorted (for the rasterizer, how are we doing this? 3Dfx did this top to bottom in terms of vertex y coordinates)
     // 6.   The vertices are then sent off to the rasterizer and drawn to the screen
+    //
+    // Every vertex is only transformed and lit once, before the primitives are assembled from them. If there are
+    // indices, they refer to the given vertices, so vertices shared by multiple primitives aren't processed again.
+
+    Core::ElapsedTimer vertex_processing_timer { true };
+    vertex_processing_timer.start();
+    ++m_statistics.num_draw_calls;
+    m_statistics.num_vertices += vertices.size();
 
     m_enabled_texture_units = enabled_texture_units;
 
     m_triangle_list.clear_with_capacity();
     m_processed_triangles.clear_with_capacity();
 
+    m_transformed_vertices.clear_with_capacity();
+    m_transformed_vertices.extend(vertices);
+    transform_vertices(model_view_transform, normal_transform, projection_transform, texture_transform);
+
+    auto const vertex_count = indices.is_empty() ? m_transformed_vertices.size() : indices.size();
+    auto vertex_at = [&](size_t i) -> Vertex const& {
+        return m_transformed_vertices[indices.is_empty() ? i : indices[i]];
+    };
+
     // Let's construct some triangles
     if (primitive_type == PrimitiveType::Triangles) {
         Triangle triangle;
-        if (vertices.size() < 3)
+        if (vertex_count < 3)
             return;
-        for (size_t i = 0; i < vertices.size() - 2; i += 3) {
-            triangle.vertices[0] = vertices.at(i);
-            triangle.vertices[1] = vertices.at(i + 1);
-            triangle.vertices[2] = vertices.at(i + 2);
+        for (size_t i = 0; i < vertex_count - 2; i += 3) {
+            triangle.vertices[0] = vertex_at(i);
+            triangle.vertices[1] = vertex_at(i + 1);
+            triangle.vertices[2] = vertex_at(i + 2);
 
             m_triangle_list.append(triangle);
         }
     } else if (primitive_type == PrimitiveType::Quads) {
         // We need to construct two triangles to form the quad
         Triangle triangle;
-        if (vertices.size() < 4)
+        if (vertex_count < 4)
             return;
-        for (size_t i = 0; i < vertices.size() - 3; i += 4) {
+        for (size_t i = 0; i < vertex_count - 3; i += 4) {
             // Triangle 1
-            triangle.vertices[0] = vertices.at(i);
-            triangle.vertices[1] = vertices.at(i + 1);
-            triangle.vertices[2] = vertices.at(i + 2);
+            triangle.vertices[0] = vertex_at(i);
+            triangle.vertices[1] = vertex_at(i + 1);
+            triangle.vertices[2] = vertex_at(i + 2);
             m_triangle_list.append(triangle);
 
             // Triangle 2
-            triangle.vertices[0] = vertices.at(i + 2);
-            triangle.vertices[1] = vertices.at(i + 3);
-            triangle.vertices[2] = vertices.at(i);
+            triangle.vertices[0] = vertex_at(i + 2);
+            triangle.vertices[1] = vertex_at(i + 3);
+            triangle.vertices[2] = vertex_at(i);
             m_triangle_list.append(triangle);
         }
     } else if (primitive_type == PrimitiveType::TriangleFan) {
         Triangle triangle;
-        triangle.vertices[0] = vertices.at(0); // Root vertex is always the vertex defined first
+        if (vertex_count < 3)
+            return;
+        triangle.vertices[0] = vertex_at(0); // Root vertex is always the vertex defined first
 
-        for (size_t i = 1; i < vertices.size() - 1; i++) // This is technically `n-2` triangles. We start at index 1
+        for (size_t i = 1; i < vertex_count - 1; i++) // This is technically `n-2` triangles. We start at index 1
         {
-            triangle.vertices[1] = vertices.at(i);
-            triangle.vertices[2] = vertices.at(i + 1);
+            triangle.vertices[1] = vertex_at(i);
+            triangle.vertices[2] = vertex_at(i + 1);
             m_triangle_list.append(triangle);
         }
     } else if (primitive_type == PrimitiveType::TriangleStrip) {
         Triangle triangle;
-        if (vertices.size() < 3)
+        if (vertex_count < 3)
             return;
-        for (size_t i = 0; i < vertices.size() - 2; i++) {
+        for (size_t i = 0; i < vertex_count - 2; i++) {
             if (i % 2 == 0) {
-                triangle.vertices[0] = vertices.at(i);
-                triangle.vertices[1] = vertices.at(i + 1);
-                triangle.vertices[2] = vertices.at(i + 2);
+                triangle.vertices[0] = vertex_at(i);
+                triangle.vertices[1] = vertex_at(i + 1);
+                triangle.vertices[2] = vertex_at(i + 2);
             } else {
-                triangle.vertices[0] = vertices.at(i + 1);
-                triangle.vertices[1] = vertices.at(i);
-                triangle.vertices[2] = vertices.at(i + 2);
+                triangle.vertices[0] = vertex_at(i + 1);
+                triangle.vertices[1] = vertex_at(i);
+                triangle.vertices[2] = vertex_at(i + 2);
             }
             m_triangle_list.append(triangle);
         }
     }
 
-    // Now let's transform each triangle and send that to the GPU
+    // Now let's clip each triangle and send that to the GPU
     auto const viewport = window_coordinates_to_target_coordinates(m_options.viewport, m_render_target->rect());
     auto const viewport_half_width = viewport.width() / 2.0f;
     auto const viewport_half_height = viewport.height() / 2.0f;
@@ -634,21 +923,6 @@ void Device::draw_primitives(PrimitiveType primitive_type, FloatMatrix4x4 const&
     auto const depth_half_range = (m_options.depth_max - m_options.depth_min) / 2;
     auto const depth_halfway = (m_options.depth_min + m_options.depth_max) / 2;
     for (auto& triangle : m_triangle_list) {
-        // Transform vertices into eye coordinates using the model-view transform
-        triangle.vertices[0].eye_coordinates = model_view_transform * triangle.vertices[0].position;
-        triangle.vertices[1].eye_coordinates = model_view_transform * triangle.vertices[1].position;
-        triangle.vertices[2].eye_coordinates = model_view_transform * triangle.vertices[2].position;
-
-        // Transform the vertex normals into eye-space
-        triangle.vertices[0].normal = transform_direction(model_view_transform, triangle.vertices[0].normal);
-        triangle.vertices[1].normal = transform_direction(model_view_transform, triangle.vertices[1].normal);
-        triangle.vertices[2].normal = transform_direction(model_view_transform, triangle.vertices[2].normal);
-
-        // Transform eye coordinates into clip coordinates using the projection transform
-        triangle.vertices[0].clip_coordinates = projection_transform * triangle.vertices[0].eye_coordinates;
-        triangle.vertices[1].clip_coordinates = projection_transform * triangle.vertices[1].eye_coordinates;
-        triangle.vertices[2].clip_coordinates = projection_transform * triangle.vertices[2].eye_coordinates;
-
         // At this point, we're in clip space
         // Here's where we do the clipping. This is a really crude implementation of the
         // https://learnopengl.com/Getting-started/Coordinate-Systems
@@ -668,72 +942,6 @@ void Device::draw_primitives(PrimitiveType primitive_type, FloatMatrix4x4 const&
         if (m_clipped_vertices.size() < 3)
             continue;
 
-        if (m_options.lighting_enabled) {
-            auto const& front_material = m_materials.at(0);
-            // Walk through each vertex
-            for (auto& vertex : m_clipped_vertices) {
-                FloatVector4 result_color = front_material.emissive + (front_material.ambient * m_lighting_model.scene_ambient_color);
-
-                for (auto const& light : m_lights) {
-                    if (!light.is_enabled)
-                        continue;
-
-                    FloatVector4 vertex_to_light;
-
-                    // Light attenuation value.
-                    float light_attenuation_factor = 1.0f;
-                    if (light.position.w() != 0.0f) {
-                        vertex_to_light = light.position - vertex.eye_coordinates;
-                        auto const vertex_to_light_length = vertex_to_light.length();
-                        auto const vertex_to_light_length_squared = vertex_to_light_length * vertex_to_light_length;
-
-                        light_attenuation_factor = 1.0f / (light.constant_attenuation + (light.linear_attenuation * vertex_to_light_length) + (light.quadratic_attenuation * vertex_to_light_length_squared));
-                        vertex_to_light = vertex_to_light / vertex_to_light_length;
-                    } else {
-                        vertex_to_light = light.position.normalized();
-                    }
-
-                    // Spotlight factor
-                    float spotlight_factor = 1.0f;
-                    if (light.spotlight_cutoff_angle != 180.0f) {
-                        const auto spotlight_direction_normalized = light.spotlight_direction.normalized();
-                        const auto light_to_vertex_dot_normalized_spotlight_direction = spotlight_direction_normalized.dot(FloatVector3(vertex_to_light.x(), vertex_to_light.y(), vertex_to_light.z()));
-                        const auto cos_spotlight_cutoff = AK::cos<float>(light.spotlight_cutoff_angle);
-
-                        if (light_to_vertex_dot_normalized_spotlight_direction >= cos_spotlight_cutoff)
-                            spotlight_factor = AK::pow<float>(light_to_vertex_dot_normalized_spotlight_direction, light.spotlight_exponent);
-                        else
-                            spotlight_factor = 0.0f;
-                    }
-
-                    // FIXME: Specular. The math for it doesn't quite make sense...
-                    (void)m_lighting_model.viewer_at_infinity;
-
-                    // FIXME: The spec allows for splitting the colors calculated here into multiple different colors (primary/secondary color). Investigate what this means.
-                    (void)m_lighting_model.single_color;
-
-                    // FIXME: Two sided lighting should be implemented eventually (I believe this is where the normals are -ve and then lighting is calculated with the BACK material)
-                    (void)m_lighting_model.two_sided_lighting;
-
-                    // Ambient
-                    auto const ambient_component = front_material.ambient * light.ambient_intensity;
-
-                    // Diffuse
-                    auto const normal_dot_vertex_to_light = vertex.normal.dot(FloatVector3(vertex_to_light.x(), vertex_to_light.y(), vertex_to_light.z()));
-                    auto const diffuse_component = ((front_material.diffuse * light.diffuse_intensity) * normal_dot_vertex_to_light).clamped(0.0f, 1.0f);
-
-                    FloatVector4 color = ambient_component;
-                    color += diffuse_component;
-                    color = color * light_attenuation_factor * spotlight_factor;
-                    result_color += color;
-                }
-
-                vertex.color = result_color;
-                vertex.color.set_w(front_material.diffuse.w()); // OpenGL 1.5 spec, page 59: "The A produced by lighting is the alpha value associated with diffuse color material"
-                vertex.color.clamp(0.0f, 1.0f);
-            }
-        }
-
         for (auto& vec : m_clipped_vertices) {
             // To normalized device coordinates (NDC)
             auto const one_over_w = 1 / vec.clip_coordinates.w();
@@ -762,7 +970,20 @@ void Device::draw_primitives(PrimitiveType primitive_type, FloatMatrix4x4 const&
         }
     }
 
-    for (auto& triangle : m_processed_triangles) {
+    // Return if alpha testing is a no-op
+    if (m_options.enable_alpha_test && m_options.alpha_test_func == AlphaTestFunction::Never)
+        return;
+
+    auto render_bounds = m_render_target->rect();
+    if (m_options.scissor_enabled)
+        render_bounds.intersect(window_coordinates_to_target_coordinates(m_options.scissor_box, m_render_target->rect()));
+
+    m_tile_columns = ceil_div(m_render_target->width(), RASTERIZER_TILE_SIZE);
+    m_tile_bins.resize(m_tile_columns * ceil_div(m_render_target->height(), RASTERIZER_TILE_SIZE));
+
+    for (size_t triangle_index = 0; triangle_index < m_processed_triangles.size(); ++triangle_index) {
+        auto& triangle = m_processed_triangles[triangle_index];
+
         // Let's calculate the (signed) area of the triangle
         // https://cp-algorithms.com/geometry/oriented-triangle-area.html
         float dxAB = triangle.vertices[0].window_coordinates.x() - triangle.vertices[1].window_coordinates.x(); // A.x - B.x
@@ -787,31 +1008,16 @@ void Device::draw_primitives(PrimitiveType primitive_type, FloatMatrix4x4 const&
         if (area > 0)
             swap(triangle.vertices[0], triangle.vertices[1]);
 
-        // Transform normals
-        triangle.vertices[0].normal = normal_transform * triangle.vertices[0].normal;
-        triangle.vertices[1].normal = normal_transform * triangle.vertices[1].normal;
-        triangle.vertices[2].normal = normal_transform * triangle.vertices[2].normal;
-        if (m_options.normalization_enabled) {
-            triangle.vertices[0].normal.normalize();
-            triangle.vertices[1].normal.normalize();
-            triangle.vertices[2].normal.normalize();
-        }
-
-        // Generate texture coordinates if at least one coordinate is enabled
-        if (m_options.texcoord_generation_enabled_coordinates != TexCoordGenerationCoordinate::None) {
-            generate_texture_coordinates(triangle.vertices[0], m_options);
-            generate_texture_coordinates(triangle.vertices[1], m_options);
-            generate_texture_coordinates(triangle.vertices[2], m_options);
-        }
+        bin_triangle(triangle_index, render_bounds);
+        ++m_statistics.num_triangles;
+    }
 
-        // Apply texture transformation
-        // FIXME: implement multi-texturing: texcoords should be stored per texture unit
-        triangle.vertices[0].tex_coord = texture_transform * triangle.vertices[0].tex_coord;
-        triangle.vertices[1].tex_coord = texture_transform * triangle.vertices[1].tex_coord;
-        triangle.vertices[2].tex_coord = texture_transform * triangle.vertices[2].tex_coord;
+    m_statistics.vertex_processing_time += vertex_processing_timer.elapsed_time();
 
-        rasterize_triangle(triangle);
-    }
+    Core::ElapsedTimer rasterization_timer { true };
+    rasterization_timer.start();
+    rasterize_binned_triangles(render_bounds);
+    m_statistics.rasterization_time += rasterization_timer.elapsed_time();
 }
 
 ALWAYS_INLINE void Device::shade_fragments(PixelQuad& quad)
@@ -965,8 +1171,12 @@ void Device::blit_to(Gfx::Bitmap& target)
 {
     wait_for_all_threads();
 
+    Core::ElapsedTimer present_timer { true };
+    present_timer.start();
     Gfx::Painter painter { target };
     painter.blit({ 0, 0 }, *m_render_target, m_render_target->rect(), 1.0f, false);
+    m_statistics.present_time += present_timer.elapsed_time();
+    ++m_statistics.num_frames;
 
     if constexpr (ENABLE_STATISTICS_OVERLAY)
         draw_statistics_overlay(target);
@@ -995,14 +1205,14 @@ void Device::draw_statistics_overlay(Gfx::Bitmap& target)
         builder.append(String::formatted("Timings      : {:.1}ms {:.1}FPS\n",
             static_cast<double>(milliseconds) / frame_counter,
             (milliseconds > 0) ? 1000.0 * frame_counter / milliseconds : 9999.0));
-        builder.append(String::formatted("Triangles    : {}\n", g_num_rasterized_triangles));
+        builder.append(String::formatted("Triangles    : {}\n", g_num_rasterized_triangles.load()));
         builder.append(String::formatted("SIMD usage   : {}%\n", g_num_quads > 0 ? g_num_pixels_shaded * 25 / g_num_quads : 0));
         builder.append(String::formatted("Pixels       : {}, Shaded: {}%, Blended: {}%, Overdraw: {}%\n",
-            g_num_pixels,
+            g_num_pixels.load(),
             g_num_pixels > 0 ? g_num_pixels_shaded * 100 / g_num_pixels : 0,
             g_num_pixels_shaded > 0 ? g_num_pixels_blended * 100 / g_num_pixels_shaded : 0,
             num_rendertarget_pixels > 0 ? g_num_pixels_shaded * 100 / num_rendertarget_pixels - 100 : 0));
-        builder.append(String::formatted("Sampler calls: {}\n", g_num_sampler_calls));
+        builder.append(String::formatted("Sampler calls: {}\n", g_num_sampler_calls.load()));
 
         debug_string = builder.to_string();
 
@@ -1029,7 +1239,8 @@ void Device::draw_statistics_overlay(Gfx::Bitmap& target)
 
 void Device::wait_for_all_threads() const
 {
-    // FIXME: Wait for all render threads to finish when multithreading is being implemented
+    // FIXME: Rasterization is finished by the time draw_primitives() returns. Wait for the render threads here
+    //        once they keep working on the triangles in the background.
 }
 
 void Device::set_options(const RasterizerOptions& options)
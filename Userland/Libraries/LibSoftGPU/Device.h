@@ -9,6 +9,7 @@
 #include <AK/Array.h>
 #include <AK/NonnullRefPtr.h>
 #include <AK/OwnPtr.h>
+#include <AK/SIMD.h>
 #include <LibGfx/Bitmap.h>
 #include <LibGfx/Matrix3x3.h>
 #include <LibGfx/Matrix4x4.h>
@@ -19,6 +20,7 @@
 #include <LibSoftGPU/Config.h>
 #include <LibSoftGPU/DepthBuffer.h>
 #include <LibSoftGPU/DeviceInfo.h>
+#include <LibSoftGPU/DeviceStatistics.h>
 #include <LibSoftGPU/Enums.h>
 #include <LibSoftGPU/Image.h>
 #include <LibSoftGPU/ImageFormat.h>
@@ -87,7 +89,7 @@ public:
 
     DeviceInfo info() const;
 
-    void draw_primitives(PrimitiveType, FloatMatrix4x4 const& model_view_transform, FloatMatrix3x3 const& normal_transform, FloatMatrix4x4 const& projection_transform, FloatMatrix4x4 const& texture_transform, Vector<Vertex> const& vertices, Vector<size_t> const& enabled_texture_units);
+    void draw_primitives(PrimitiveType, FloatMatrix4x4 const& model_view_transform, FloatMatrix3x3 const& normal_transform, FloatMatrix4x4 const& projection_transform, FloatMatrix4x4 const& texture_transform, Vector<Vertex> const& vertices, Vector<u32> const& indices, Vector<size_t> const& enabled_texture_units);
     void resize(const Gfx::IntSize& min_size);
     void clear_color(const FloatVector4&);
     void clear_depth(float);
@@ -103,6 +105,9 @@ public:
 
     NonnullRefPtr<Image> create_image(ImageFormat, unsigned width, unsigned height, unsigned depth, unsigned levels, unsigned layers);
 
+    DeviceStatistics const& statistics() const { return m_statistics; }
+    void reset_statistics() { m_statistics = {}; }
+
     void set_sampler_config(unsigned, SamplerConfig const&);
     void set_light_state(unsigned, Light const&);
     void set_material_state(unsigned, Material const&);
@@ -110,7 +115,11 @@ public:
 private:
     void draw_statistics_overlay(Gfx::Bitmap&);
 
-    void rasterize_triangle(const Triangle& triangle);
+    void transform_vertices(FloatMatrix4x4 const& model_view_transform, FloatMatrix3x3 const& normal_transform, FloatMatrix4x4 const& projection_transform, FloatMatrix4x4 const& texture_transform);
+    Vector4<AK::SIMD::f32x4> light_vertices(Vector4<AK::SIMD::f32x4> const& eye_coordinates, Vector3<AK::SIMD::f32x4> const& normal) const;
+    void bin_triangle(size_t triangle_index, Gfx::IntRect const& render_bounds);
+    void rasterize_binned_triangles(Gfx::IntRect const& render_bounds);
+    void rasterize_triangle(const Triangle& triangle, Gfx::IntRect const& render_bounds);
     void setup_blend_factors();
     void shade_fragments(PixelQuad&);
     bool test_alpha(PixelQuad&);
@@ -121,14 +130,20 @@ private:
     RasterizerOptions m_options;
     LightModelParameters m_lighting_model;
     Clipper m_clipper;
+    Vector<Vertex> m_transformed_vertices;
     Vector<Triangle> m_triangle_list;
     Vector<Triangle> m_processed_triangles;
     Vector<Vertex> m_clipped_vertices;
+    Vector<Vector<u32>> m_tile_bins;
+    Vector<u32> m_binned_tiles;
+    int m_tile_columns { 0 };
+    size_t m_binned_area { 0 };
     Array<Sampler, NUM_SAMPLERS> m_samplers;
     Vector<size_t> m_enabled_texture_units;
     AlphaBlendFactors m_alpha_blend_factors;
     Array<Light, NUM_LIGHTS> m_lights;
     Array<Material, 2u> m_materials;
+    DeviceStatistics m_statistics;
 };
 
 }
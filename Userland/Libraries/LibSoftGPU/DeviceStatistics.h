@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Time.h>
+#include <AK/Types.h>
+
+namespace SoftGPU {
+
+// Accumulated since the device was created or Device::reset_statistics() was last called
+struct DeviceStatistics final {
+    u64 num_draw_calls { 0 };
+    u64 num_vertices { 0 };
+    u64 num_triangles { 0 };
+    u64 num_frames { 0 };
+
+    // Transformation, lighting, primitive assembly, clipping, culling and binning
+    Time vertex_processing_time;
+
+    // Coverage and depth testing, fragment shading and blending
+    Time rasterization_time;
+
+    // Copying the color buffer to the presented bitmap
+    Time present_time;
+};
+
+}
@@ -30,19 +30,25 @@ Image::Image(ImageFormat format, unsigned width, unsigned height, unsigned depth
     if ((depth & (depth - 1)) == 0)
         m_depth_is_power_of_two = true;
 
-    m_mipmap_sizes.append({ width, height, depth });
-    m_mipmap_offsets.append(0);
+    auto append_level = [&] {
+        auto tile_columns = ceil_div(width, tile_size);
+        auto tile_rows = ceil_div(height, tile_size);
+        m_mipmap_sizes.append({ width, height, depth });
+        m_mipmap_tile_columns.append(tile_columns);
+        m_mipmap_tile_rows.append(tile_rows);
+        m_mipmap_offsets.append(m_mipchain_size);
+        m_level_is_defined.append(false);
 
-    m_mipchain_size += width * height * depth * element_size(format);
+        m_mipchain_size += tile_columns * tile_rows * tile_size * tile_size * depth * element_size(format);
+    };
+
+    append_level();
 
     while (--levels && (width > 1 || height > 1 || depth > 1)) {
         width = max(width / 2, 1);
         height = max(height / 2, 1);
         depth = max(depth / 2, 1);
-        m_mipmap_sizes.append({ width, height, depth });
-        m_mipmap_offsets.append(m_mipchain_size);
-
-        m_mipchain_size += width * height * depth * element_size(format);
+        append_level();
     }
 
     m_num_levels = m_mipmap_sizes.size();
@@ -67,6 +73,8 @@ void Image::write_texels(unsigned layer, unsigned level, Vector3<unsigned> const
             }
         }
     }
+
+    m_level_is_defined[level] = true;
 }
 
 void Image::read_texels(unsigned layer, unsigned level, Vector3<unsigned> const& offset, Vector3<unsigned> const& size, void* data, ImageDataLayout const& layout) const
@@ -109,6 +117,8 @@ void Image::copy_texels(Image const& source, unsigned source_layer, unsigned sou
             }
         }
     }
+
+    m_level_is_defined[destination_level] = true;
 }
 
 }
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <AK/RefCounted.h>
+#include <AK/SIMD.h>
 #include <AK/Vector.h>
 #include <LibGfx/Vector3.h>
 #include <LibGfx/Vector4.h>
@@ -15,8 +16,12 @@
 
 namespace SoftGPU {
 
+// Texels are stored in square tiles of tile_size x tile_size texels, so that the neighbouring texels fetched by a filtered
+// lookup on a rotated or minified texture usually share a cache line.
 class Image final : public RefCounted<Image> {
 public:
+    static constexpr unsigned tile_size = 4;
+
     Image(ImageFormat format, unsigned width, unsigned height, unsigned depth, unsigned levels, unsigned layers);
 
     ImageFormat format() const { return m_format; }
@@ -32,6 +37,27 @@ public:
     bool height_is_power_of_two() const { return m_height_is_power_of_two; }
     bool depth_is_power_of_two() const { return m_depth_is_power_of_two; }
 
+    // Number of consecutive levels, starting at level 0, that have been written to
+    unsigned num_defined_levels() const
+    {
+        unsigned count = 0;
+        while (count < m_num_levels && m_level_is_defined[count])
+            ++count;
+        return count;
+    }
+
+    void const* level_data(unsigned layer, unsigned level) const
+    {
+        return &m_data[m_mipchain_size * layer + m_mipmap_offsets[level]];
+    }
+
+    // Element indices into level_data() of 4 texels in the first slice of a level
+    AK::SIMD::u32x4 texel_indices(unsigned level, AK::SIMD::u32x4 x, AK::SIMD::u32x4 y) const
+    {
+        static_assert(tile_size == 4);
+        return ((y >> 2) * m_mipmap_tile_columns[level] + (x >> 2)) * (tile_size * tile_size) + ((y & 3) << 2) + (x & 3);
+    }
+
     FloatVector4 texel(unsigned layer, unsigned level, unsigned x, unsigned y, unsigned z) const
     {
         return unpack_color(texel_pointer(layer, level, x, y, z), m_format);
@@ -47,16 +73,22 @@ public:
     void copy_texels(Image const& source, unsigned source_layer, unsigned source_level, Vector3<unsigned> const& source_offset, Vector3<unsigned> const& size, unsigned destination_layer, unsigned destination_level, Vector3<unsigned> const& destination_offset);
 
 private:
+    size_t texel_index(unsigned level, unsigned x, unsigned y, unsigned z) const
+    {
+        auto tile_columns = m_mipmap_tile_columns[level];
+        auto tile_rows = m_mipmap_tile_rows[level];
+        auto tile = (z * tile_rows + y / tile_size) * tile_columns + x / tile_size;
+        return tile * tile_size * tile_size + (y % tile_size) * tile_size + x % tile_size;
+    }
+
     void const* texel_pointer(unsigned layer, unsigned level, unsigned x, unsigned y, unsigned z) const
     {
-        auto size = m_mipmap_sizes[level];
-        return &m_data[m_mipchain_size * layer + m_mipmap_offsets[level] + (z * size.x() * size.y() + y * size.x() + x) * element_size(m_format)];
+        return &m_data[m_mipchain_size * layer + m_mipmap_offsets[level] + texel_index(level, x, y, z) * element_size(m_format)];
     }
 
     void* texel_pointer(unsigned layer, unsigned level, unsigned x, unsigned y, unsigned z)
     {
-        auto size = m_mipmap_sizes[level];
-        return &m_data[m_mipchain_size * layer + m_mipmap_offsets[level] + (z * size.x() * size.y() + y * size.x() + x) * element_size(m_format)];
+        return &m_data[m_mipchain_size * layer + m_mipmap_offsets[level] + texel_index(level, x, y, z) * element_size(m_format)];
     }
 
 private:
@@ -70,6 +102,9 @@ private:
     size_t m_mipchain_size { 0 };
     Vector<size_t, 16> m_mipmap_offsets;
     Vector<Vector3<unsigned>, 16> m_mipmap_sizes;
+    Vector<unsigned, 16> m_mipmap_tile_columns;
+    Vector<unsigned, 16> m_mipmap_tile_rows;
+    Vector<bool, 16> m_level_is_defined;
     Vector<u8> m_data;
     bool m_width_is_power_of_two { false };
     bool m_height_is_power_of_two { false };
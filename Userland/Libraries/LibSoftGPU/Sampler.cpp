@@ -72,29 +72,39 @@ static f32x4 wrap(f32x4 value, TextureWrapMode mode, u32x4 num_texels)
     }
 }
 
-ALWAYS_INLINE static Vector4<f32x4> texel4(Image const& image, u32x4 layer, u32x4 level, u32x4 x, u32x4 y, u32x4 z)
+ALWAYS_INLINE static Vector4<f32x4> unpack_rgba8888(u32x4 rgba)
 {
-    auto t0 = image.texel(layer[0], level[0], x[0], y[0], z[0]);
-    auto t1 = image.texel(layer[1], level[1], x[1], y[1], z[1]);
-    auto t2 = image.texel(layer[2], level[2], x[2], y[2], z[2]);
-    auto t3 = image.texel(layer[3], level[3], x[3], y[3], z[3]);
-
+    constexpr auto one_over_255 = 1.0f / 255;
     return Vector4<f32x4> {
-        f32x4 { t0.x(), t1.x(), t2.x(), t3.x() },
-        f32x4 { t0.y(), t1.y(), t2.y(), t3.y() },
-        f32x4 { t0.z(), t1.z(), t2.z(), t3.z() },
-        f32x4 { t0.w(), t1.w(), t2.w(), t3.w() },
+        to_f32x4(rgba & 0xff) * one_over_255,
+        to_f32x4((rgba >> 8) & 0xff) * one_over_255,
+        to_f32x4((rgba >> 16) & 0xff) * one_over_255,
+        to_f32x4((rgba >> 24) & 0xff) * one_over_255,
     };
 }
 
-ALWAYS_INLINE static Vector4<f32x4> texel4border(Image const& image, u32x4 layer, u32x4 level, u32x4 x, u32x4 y, u32x4 z, FloatVector4 const& border, u32x4 w, u32x4 h)
+ALWAYS_INLINE static Vector4<f32x4> texel4(Image const& image, unsigned layer, unsigned level, u32x4 x, u32x4 y)
 {
-    auto border_mask = maskbits(x < 0 || x >= w || y < 0 || y >= h);
+    // Fetch all 4 texels of 32-bit formats with a single gather and unpack them in vector registers
+    auto const format = image.format();
+    if (format == ImageFormat::RGBA8888 || format == ImageFormat::BGRA8888) {
+        auto const* texels = static_cast<u32 const*>(image.level_data(layer, level));
+        auto const indices = image.texel_indices(level, x, y);
+        auto const texel = unpack_rgba8888(u32x4 {
+            texels[indices[0]],
+            texels[indices[1]],
+            texels[indices[2]],
+            texels[indices[3]],
+        });
+        if (format == ImageFormat::BGRA8888)
+            return { texel.z(), texel.y(), texel.x(), texel.w() };
+        return texel;
+    }
 
-    auto t0 = border_mask & 1 ? border : image.texel(layer[0], level[0], x[0], y[0], z[0]);
-    auto t1 = border_mask & 2 ? border : image.texel(layer[1], level[1], x[1], y[1], z[1]);
-    auto t2 = border_mask & 4 ? border : image.texel(layer[2], level[2], x[2], y[2], z[2]);
-    auto t3 = border_mask & 8 ? border : image.texel(layer[3], level[3], x[3], y[3], z[3]);
+    auto t0 = image.texel(layer, level, x[0], y[0], 0);
+    auto t1 = image.texel(layer, level, x[1], y[1], 0);
+    auto t2 = image.texel(layer, level, x[2], y[2], 0);
+    auto t3 = image.texel(layer, level, x[3], y[3], 0);
 
     return Vector4<f32x4> {
         f32x4 { t0.x(), t1.x(), t2.x(), t3.x() },
@@ -104,6 +114,26 @@ ALWAYS_INLINE static Vector4<f32x4> texel4border(Image const& image, u32x4 layer
     };
 }
 
+ALWAYS_INLINE static Vector4<f32x4> texel4border(Image const& image, unsigned layer, unsigned level, u32x4 x, u32x4 y, FloatVector4 const& border, u32x4 w, u32x4 h)
+{
+    auto const is_border = x >= w || y >= h;
+    auto const border_mask = maskbits(is_border);
+    if (border_mask == 0)
+        return texel4(image, layer, level, x, y);
+    if (border_mask == 0b1111)
+        return expand4(border);
+
+    // Fetch texel 0,0 for lanes outside of the image and replace them with the border color afterwards
+    auto const inside = ~(u32x4)is_border;
+    auto texel = texel4(image, layer, level, x & inside, y & inside);
+    return Vector4<f32x4> {
+        is_border ? expand4(border.x()) : texel.x(),
+        is_border ? expand4(border.y()) : texel.y(),
+        is_border ? expand4(border.z()) : texel.z(),
+        is_border ? expand4(border.w()) : texel.w(),
+    };
+}
+
 Vector4<AK::SIMD::f32x4> Sampler::sample_2d(Vector2<AK::SIMD::f32x4> const& uv) const
 {
     if (m_config.bound_image.is_null())
@@ -111,22 +141,51 @@ Vector4<AK::SIMD::f32x4> Sampler::sample_2d(Vector2<AK::SIMD::f32x4> const& uv)
 
     auto const& image = *m_config.bound_image;
 
-    u32x4 const layer = expand4(0u);
-    // FIXME: calculate actual mipmap level  to use
-    u32x4 const level = expand4(0u);
+    // Calculate the level of detail from the texture coordinate derivatives across the quad.
+    // Lanes 0 and 1 are horizontal neighbours, lanes 0 and 2 are vertical neighbours.
+    float const width = image.level_width(0);
+    float const height = image.level_height(0);
+    float const dudx = (uv.x()[1] - uv.x()[0]) * width;
+    float const dvdx = (uv.y()[1] - uv.y()[0]) * height;
+    float const dudy = (uv.x()[2] - uv.x()[0]) * width;
+    float const dvdy = (uv.y()[2] - uv.y()[0]) * height;
+    float const rho_squared = max(dudx * dudx + dvdx * dvdx, dudy * dudy + dvdy * dvdy);
+    float const lambda = 0.5f * log2f(rho_squared);
+
+    if (!(lambda > 0) || m_config.mipmap_filter == MipMapFilter::None)
+        return sample_2d_lod(uv, 0, lambda > 0 ? m_config.texture_min_filter : m_config.texture_mag_filter);
+
+    // Only sample levels that were actually uploaded, applications often attach just the base level
+    auto const max_level = max(image.num_defined_levels(), 1u) - 1;
+
+    if (m_config.mipmap_filter == MipMapFilter::Nearest) {
+        auto const level = lambda <= 0.5f ? 0u : static_cast<unsigned>(ceilf(lambda + 0.5f)) - 1;
+        return sample_2d_lod(uv, min(level, max_level), m_config.texture_min_filter);
+    }
 
-    u32x4 const width = {
-        image.level_width(level[0]),
-        image.level_width(level[1]),
-        image.level_width(level[2]),
-        image.level_width(level[3]),
-    };
-    u32x4 const height = {
-        image.level_height(level[0]),
-        image.level_height(level[1]),
-        image.level_height(level[2]),
-        image.level_height(level[3]),
-    };
+    auto const level = static_cast<unsigned>(lambda);
+    if (level >= max_level)
+        return sample_2d_lod(uv, max_level, m_config.texture_min_filter);
+
+    auto const lower = sample_2d_lod(uv, level, m_config.texture_min_filter);
+    auto const upper = sample_2d_lod(uv, level + 1, m_config.texture_min_filter);
+    return mix(lower, upper, expand4(lambda - level));
+}
+
+Vector4<AK::SIMD::f32x4> Sampler::sample_2d_lod(Vector2<AK::SIMD::f32x4> const& uv, unsigned level, TextureFilter filter) const
+{
+    auto const& image = *m_config.bound_image;
+
+    // FIXME: Support array textures
+    unsigned const layer = 0;
+
+    unsigned const level_width = image.level_width(level);
+    unsigned const level_height = image.level_height(level);
+    bool const width_is_power_of_two = (level_width & (level_width - 1)) == 0;
+    bool const height_is_power_of_two = (level_height & (level_height - 1)) == 0;
+
+    u32x4 const width = expand4(level_width);
+    u32x4 const height = expand4(level_height);
 
     u32x4 width_mask = width - 1;
     u32x4 height_mask = height - 1;
@@ -137,15 +196,14 @@ Vector4<AK::SIMD::f32x4> Sampler::sample_2d(Vector2<AK::SIMD::f32x4> const& uv)
     f32x4 u = s * to_f32x4(width);
     f32x4 v = t * to_f32x4(height);
 
-    if (m_config.texture_mag_filter == TextureFilter::Nearest) {
+    if (filter == TextureFilter::Nearest) {
         u32x4 i = to_u32x4(u);
         u32x4 j = to_u32x4(v);
-        u32x4 k = expand4(0u);
 
-        i = image.width_is_power_of_two() ? i & width_mask : i % width;
-        j = image.height_is_power_of_two() ? j & height_mask : j % height;
+        i = width_is_power_of_two ? i & width_mask : i % width;
+        j = height_is_power_of_two ? j & height_mask : j % height;
 
-        return texel4(image, layer, level, i, j, k);
+        return texel4(image, layer, level, i, j);
     }
 
     u -= 0.5f;
@@ -157,7 +215,7 @@ Vector4<AK::SIMD::f32x4> Sampler::sample_2d(Vector2<AK::SIMD::f32x4> const& uv)
     i32x4 j1 = j0 + 1;
 
     if (m_config.texture_wrap_u == TextureWrapMode::Repeat) {
-        if (image.width_is_power_of_two()) {
+        if (width_is_power_of_two) {
             i0 = (i32x4)(i0 & width_mask);
             i1 = (i32x4)(i1 & width_mask);
         } else {
@@ -167,7 +225,7 @@ Vector4<AK::SIMD::f32x4> Sampler::sample_2d(Vector2<AK::SIMD::f32x4> const& uv)
     }
 
     if (m_config.texture_wrap_v == TextureWrapMode::Repeat) {
-        if (image.height_is_power_of_two()) {
+        if (height_is_power_of_two) {
             j0 = (i32x4)(j0 & height_mask);
             j1 = (i32x4)(j1 & height_mask);
         } else {
@@ -176,20 +234,18 @@ Vector4<AK::SIMD::f32x4> Sampler::sample_2d(Vector2<AK::SIMD::f32x4> const& uv)
         }
     }
 
-    u32x4 k = expand4(0u);
-
     Vector4<f32x4> t0, t1, t2, t3;
 
     if (m_config.texture_wrap_u == TextureWrapMode::Repeat && m_config.texture_wrap_v == TextureWrapMode::Repeat) {
-        t0 = texel4(image, layer, level, to_u32x4(i0), to_u32x4(j0), k);
-        t1 = texel4(image, layer, level, to_u32x4(i1), to_u32x4(j0), k);
-        t2 = texel4(image, layer, level, to_u32x4(i0), to_u32x4(j1), k);
-        t3 = texel4(image, layer, level, to_u32x4(i1), to_u32x4(j1), k);
+        t0 = texel4(image, layer, level, to_u32x4(i0), to_u32x4(j0));
+        t1 = texel4(image, layer, level, to_u32x4(i1), to_u32x4(j0));
+        t2 = texel4(image, layer, level, to_u32x4(i0), to_u32x4(j1));
+        t3 = texel4(image, layer, level, to_u32x4(i1), to_u32x4(j1));
     } else {
-        t0 = texel4border(image, layer, level, to_u32x4(i0), to_u32x4(j0), k, m_config.border_color, width, height);
-        t1 = texel4border(image, layer, level, to_u32x4(i1), to_u32x4(j0), k, m_config.border_color, width, height);
-        t2 = texel4border(image, layer, level, to_u32x4(i0), to_u32x4(j1), k, m_config.border_color, width, height);
-        t3 = texel4border(image, layer, level, to_u32x4(i1), to_u32x4(j1), k, m_config.border_color, width, height);
+        t0 = texel4border(image, layer, level, to_u32x4(i0), to_u32x4(j0), m_config.border_color, width, height);
+        t1 = texel4border(image, layer, level, to_u32x4(i1), to_u32x4(j0), m_config.border_color, width, height);
+        t2 = texel4border(image, layer, level, to_u32x4(i0), to_u32x4(j1), m_config.border_color, width, height);
+        t3 = texel4border(image, layer, level, to_u32x4(i1), to_u32x4(j1), m_config.border_color, width, height);
     }
 
     f32x4 const alpha = frac_int_range(u);
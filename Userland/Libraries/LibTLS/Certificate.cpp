@@ -476,4 +476,31 @@ Optional<Certificate> Certificate::parse_asn1(ReadonlyBytes buffer, bool)
 #undef READ_OBJECT_OR_FAIL
 }
 
+TrustStore::TrustStore(Vector<Certificate> certificates)
+    : m_certificates(move(certificates))
+{
+    for (size_t i = 0; i < m_certificates.size(); ++i)
+        m_certificate_index_by_subject.set(m_certificates[i].subject.subject, i);
+}
+
+const Certificate* TrustStore::find_by_subject(const String& subject) const
+{
+    auto index = m_certificate_index_by_subject.get(subject);
+    if (!index.has_value())
+        return nullptr;
+    return &m_certificates[index.value()];
+}
+
+bool TrustStore::is_trusted_issuer(const String& subject) const
+{
+    return m_certificate_index_by_subject.contains(subject) || m_verified_intermediates.contains(subject);
+}
+
+void TrustStore::add_verified_intermediate(const String& subject, const String& issuer) const
+{
+    if (m_verified_intermediates.size() >= max_verified_intermediates)
+        m_verified_intermediates.clear();
+    m_verified_intermediates.set(subject, issuer);
+}
+
 }
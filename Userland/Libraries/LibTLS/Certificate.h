@@ -8,7 +8,9 @@
 
 #include <AK/ByteBuffer.h>
 #include <AK/Forward.h>
+#include <AK/HashMap.h>
 #include <AK/Optional.h>
+#include <AK/RefCounted.h>
 #include <AK/Singleton.h>
 #include <AK/Types.h>
 #include <LibCore/DateTime.h>
@@ -58,21 +60,51 @@ public:
     bool is_valid() const;
 };
 
+// A set of trusted root certificates indexed by subject, along with the intermediate certificates
+// that have already been chained up to one of them. Sharing one store between connections means
+// neither the roots nor the intermediates have to be walked again for every handshake.
+class TrustStore : public RefCounted<TrustStore> {
+public:
+    static NonnullRefPtr<TrustStore> create(Vector<Certificate> certificates)
+    {
+        return adopt_ref(*new TrustStore(move(certificates)));
+    }
+
+    const Vector<Certificate>& certificates() const { return m_certificates; }
+
+    const Certificate* find_by_subject(const String& subject) const;
+    bool is_trusted_issuer(const String& subject) const;
+
+    // FIXME: Signatures aren't checked yet, so "verified" only means that the names chain up to a root.
+    void add_verified_intermediate(const String& subject, const String& issuer) const;
+
+private:
+    explicit TrustStore(Vector<Certificate>);
+
+    static constexpr size_t max_verified_intermediates = 256;
+
+    Vector<Certificate> m_certificates;
+    HashMap<String, size_t> m_certificate_index_by_subject;
+    mutable HashMap<String, String> m_verified_intermediates;
+};
+
 class DefaultRootCACertificates {
 public:
     DefaultRootCACertificates();
 
-    const Vector<Certificate>& certificates() const { return m_ca_certificates; }
+    const Vector<Certificate>& certificates() const { return m_trust_store->certificates(); }
+    const NonnullRefPtr<TrustStore>& trust_store() const { return m_trust_store; }
 
     static DefaultRootCACertificates& the() { return s_the; }
 
 private:
     static Singleton<DefaultRootCACertificates> s_the;
 
-    Vector<Certificate> m_ca_certificates;
+    NonnullRefPtr<TrustStore> m_trust_store;
 };
 
 }
 
 using TLS::Certificate;
 using TLS::DefaultRootCACertificates;
+using TLS::TrustStore;
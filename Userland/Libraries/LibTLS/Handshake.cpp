@@ -34,6 +34,22 @@ ByteBuffer TLSv12::build_hello()
     builder.append(version);
     builder.append(m_context.local_random, sizeof(m_context.local_random));
 
+    // Offer to resume a previous session if we have one, see RFC 5246 section 7.4.1.2 and RFC 5077 section 3.4.
+    m_context.session_id_size = 0;
+    size_t session_ticket_length = 0;
+    if (m_context.session_to_resume.has_value()) {
+        auto& session = *m_context.session_to_resume;
+        session_ticket_length = session.ticket.size();
+        if (session.session_id_size) {
+            memcpy(m_context.session_id, session.session_id, session.session_id_size);
+            m_context.session_id_size = session.session_id_size;
+        } else if (session_ticket_length) {
+            // The server echoes this back if it accepts the ticket, which is how we tell that the session was resumed.
+            fill_with_random(m_context.session_id, sizeof(m_context.session_id));
+            m_context.session_id_size = sizeof(m_context.session_id);
+        }
+    }
+
     builder.append(m_context.session_id_size);
     if (m_context.session_id_size)
         builder.append(m_context.session_id, m_context.session_id_size);
@@ -77,6 +93,26 @@ ByteBuffer TLSv12::build_hello()
     if (sni_length)
         extension_length += sni_length + 9;
 
+    // session_ticket: 2b extension ID, 2b extension length, the ticket (empty if we don't have one yet)
+    extension_length += 2 + 2 + session_ticket_length;
+
+    // RFC 8422 section 5.1: Only advertise the curves if we actually offer an ECDHE cipher suite.
+    bool offers_elliptic_curves = false;
+    for (auto suite : m_context.options.usable_cipher_suites) {
+        auto key_exchange = get_key_exchange_algorithm(suite);
+        if (key_exchange == KeyExchangeAlgorithm::ECDHE_RSA || key_exchange == KeyExchangeAlgorithm::ECDHE_ECDSA) {
+            offers_elliptic_curves = true;
+            break;
+        }
+    }
+
+    if (offers_elliptic_curves) {
+        // supported_groups: 2b extension ID, 2b extension length, 2b vector length, 2xN curves
+        extension_length += 2 + 2 + 2 + 2 * m_context.options.elliptic_curves.size();
+        // ec_point_formats: 2b extension ID, 2b extension length, 1b vector length, 1xN formats
+        extension_length += 2 + 2 + 1 + m_context.options.supported_ec_point_formats.size();
+    }
+
     builder.append((u16)extension_length);
 
     if (sni_length) {
@@ -105,9 +141,42 @@ ByteBuffer TLSv12::build_hello()
         builder.append((u8)entry.signature);
     }
 
+    // session_ticket extension
+    builder.append((u16)HandshakeExtension::SessionTicket);
+    builder.append((u16)session_ticket_length);
+    if (session_ticket_length)
+        builder.append(m_context.session_to_resume->ticket.bytes());
+
+    if (offers_elliptic_curves) {
+        // supported_groups extension
+        builder.append((u16)HandshakeExtension::SupportedGroups);
+        builder.append((u16)(2 + 2 * m_context.options.elliptic_curves.size()));
+        builder.append((u16)(2 * m_context.options.elliptic_curves.size()));
+        for (auto curve : m_context.options.elliptic_curves)
+            builder.append((u16)curve);
+
+        // ec_point_formats extension
+        builder.append((u16)HandshakeExtension::ECPointFormats);
+        builder.append((u16)(1 + m_context.options.supported_ec_point_formats.size()));
+        builder.append((u8)m_context.options.supported_ec_point_formats.size());
+        for (auto format : m_context.options.supported_ec_point_formats)
+            builder.append((u8)format);
+    }
+
     if (alpn_length) {
-        // TODO
-        VERIFY_NOT_REACHED();
+        // application_layer_protocol_negotiation extension, see RFC 7301 section 3.1
+        builder.append((u16)HandshakeExtension::ApplicationLayerProtocolNegotiation);
+        builder.append((u16)(alpn_length + 2));
+        builder.append((u16)alpn_length);
+        if (alpn_negotiated_length) {
+            builder.append((u8)alpn_negotiated_length);
+            builder.append(m_context.negotiated_alpn.bytes());
+        } else {
+            for (auto& alpn : m_context.alpn) {
+                builder.append((u8)alpn.length());
+                builder.append(alpn.bytes());
+            }
+        }
     }
 
     // set the "length" field of the packet
@@ -193,6 +262,20 @@ ssize_t TLSv12::handle_handshake_finished(ReadonlyBytes buffer, WritePacketStage
 
     // TODO: Compare Hashes
     dbgln_if(TLS_DEBUG, "FIXME: handle_handshake_finished :: Check message validity");
+
+    if (m_context.is_resumed_session) {
+        // RFC 5246 section 7.3: In an abbreviated handshake the server finishes first, and we answer with our own Finished.
+        write_packets = WritePacketStage::Finished;
+        return index + size;
+    }
+
+    set_connection_established();
+
+    return index + size;
+}
+
+void TLSv12::set_connection_established()
+{
     m_context.connection_status = ConnectionStatus::Established;
 
     if (m_handshake_timeout_timer) {
@@ -204,8 +287,32 @@ ssize_t TLSv12::handle_handshake_finished(ReadonlyBytes buffer, WritePacketStage
 
     if (on_tls_ready_to_write)
         on_tls_ready_to_write(*this);
+}
 
-    return index + size;
+ssize_t TLSv12::handle_new_session_ticket(ReadonlyBytes buffer)
+{
+    // RFC 5077 section 3.3: struct { uint32 ticket_lifetime_hint; opaque ticket<0..2^16-1>; } NewSessionTicket;
+    if (buffer.size() < 9)
+        return (i8)Error::NeedMoreData;
+
+    size_t size = buffer[0] * 0x10000 + buffer[1] * 0x100 + buffer[2];
+    if (buffer.size() - 3 < size)
+        return (i8)Error::NeedMoreData;
+
+    size_t ticket_length = AK::convert_between_host_and_network_endian(ByteReader::load16(buffer.offset_pointer(7)));
+    if (size < 6 + ticket_length)
+        return (i8)Error::BrokenPacket;
+
+    // Not having a ticket just means that the next connection does a full handshake.
+    auto ticket_result = ByteBuffer::copy(buffer.slice(9, ticket_length));
+    if (ticket_result.has_value())
+        m_context.session_ticket = ticket_result.release_value();
+    else
+        m_context.session_ticket.clear();
+
+    dbgln_if(TLS_DEBUG, "Received a session ticket of {} bytes", ticket_length);
+
+    return size + 3;
 }
 
 ssize_t TLSv12::handle_handshake_payload(ReadonlyBytes vbuffer)
@@ -274,6 +381,15 @@ ssize_t TLSv12::handle_handshake_payload(ReadonlyBytes vbuffer)
             dbgln("unsupported: DTLS");
             payload_res = (i8)Error::UnexpectedMessage;
             break;
+        case NewSessionTicket:
+            dbgln_if(TLS_DEBUG, "new session ticket");
+            if (m_context.is_server || m_context.connection_status != ConnectionStatus::KeyExchange) {
+                dbgln("unexpected new session ticket message");
+                payload_res = (i8)Error::UnexpectedMessage;
+                break;
+            }
+            payload_res = handle_new_session_ticket(buffer.slice(1, payload_size));
+            break;
         case CertificateMessage:
             if (m_context.handshake_messages[4] >= 1) {
                 dbgln("unexpected certificate message");
@@ -522,7 +638,7 @@ ssize_t TLSv12::handle_handshake_payload(ReadonlyBytes vbuffer)
                 auto packet = build_handshake_finished();
                 write_packet(packet);
             }
-            m_context.connection_status = ConnectionStatus::Established;
+            set_connection_established();
             break;
         }
         payload_size++;
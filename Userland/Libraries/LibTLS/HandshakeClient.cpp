@@ -5,9 +5,11 @@
  */
 
 #include <AK/Debug.h>
+#include <AK/Memory.h>
 #include <AK/Random.h>
 #include <LibCrypto/ASN1/DER.h>
 #include <LibCrypto/BigInt/UnsignedBigInteger.h>
+#include <LibCrypto/Curves/X25519.h>
 #include <LibCrypto/NumberTheory/ModularFunctions.h>
 #include <LibCrypto/PK/Code/EMSA_PSS.h>
 #include <LibTLS/TLSv12.h>
@@ -40,7 +42,8 @@ bool TLSv12::expand_key()
 
     size_t offset = 0;
     if (is_aead) {
-        iv_size = 4; // Explicit IV size.
+        // Implicit IV size: a 4-byte salt for GCM, the whole 12-byte IV for ChaCha20-Poly1305.
+        iv_size = get_cipher_algorithm(m_context.cipher) == CipherAlgorithm::CHACHA20_POLY1305 ? 12 : 4;
     } else {
         memcpy(m_context.crypto.local_mac, key + offset, mac_size);
         offset += mac_size;
@@ -95,6 +98,15 @@ bool TLSv12::expand_key()
         m_cipher_remote = Crypto::Cipher::AESCipher::GCMMode(ReadonlyBytes { server_key, key_size }, key_size * 8, Crypto::Cipher::Intent::Decryption, Crypto::Cipher::PaddingMode::RFC5246);
         break;
     }
+    case CipherAlgorithm::CHACHA20_POLY1305: {
+        VERIFY(is_aead);
+        memcpy(m_context.crypto.local_aead_iv, client_iv, iv_size);
+        memcpy(m_context.crypto.remote_aead_iv, server_iv, iv_size);
+
+        m_cipher_local = Crypto::Cipher::ChaCha20Poly1305(ReadonlyBytes { client_key, key_size });
+        m_cipher_remote = Crypto::Cipher::ChaCha20Poly1305(ReadonlyBytes { server_key, key_size });
+        break;
+    }
     case CipherAlgorithm::AES_128_CCM:
         dbgln("Requested unimplemented AES CCM cipher");
         TODO();
@@ -281,6 +293,55 @@ void TLSv12::build_dhe_rsa_pre_master_secret(PacketBuilder& builder)
     builder.append(dh_Yc_bytes);
 }
 
+void TLSv12::build_ecdhe_rsa_pre_master_secret(PacketBuilder& builder)
+{
+    auto& ecdh = m_context.server_elliptic_curve_diffie_hellman_params;
+    if (ecdh.curve != NamedCurve::x25519 || ecdh.public_key.size() != Crypto::Curves::X25519::KeySize) {
+        dbgln("Failed to build ECDHE_RSA premaster secret: unsupported curve parameters");
+        return;
+    }
+
+    u8 private_key[Crypto::Curves::X25519::KeySize];
+    u8 public_key[Crypto::Curves::X25519::KeySize];
+    Crypto::Curves::X25519::generate_private_key({ private_key, sizeof(private_key) });
+    Crypto::Curves::X25519::generate_public_key({ private_key, sizeof(private_key) }, { public_key, sizeof(public_key) });
+
+    auto premaster_key_result = ByteBuffer::create_uninitialized(Crypto::Curves::X25519::KeySize);
+    if (!premaster_key_result.has_value()) {
+        dbgln("Failed to build ECDHE_RSA premaster secret: not enough memory");
+        return;
+    }
+    m_context.premaster_key = premaster_key_result.release_value();
+    Crypto::Curves::X25519::compute_coordinate({ private_key, sizeof(private_key) }, ecdh.public_key, m_context.premaster_key);
+    secure_zero(private_key, sizeof(private_key));
+    ecdh.public_key.clear();
+
+    // RFC 8422 section 5.11: A shared secret of all zeroes means the server sent a low-order point.
+    u8 all_bits = 0;
+    for (auto byte : m_context.premaster_key.bytes())
+        all_bits |= byte;
+    if (all_bits == 0) {
+        dbgln("Failed to build ECDHE_RSA premaster secret: the server's public key is invalid");
+        m_context.premaster_key.clear();
+        alert(AlertLevel::Critical, AlertDescription::IllegalParameter);
+        return;
+    }
+
+    if constexpr (TLS_DEBUG) {
+        dbgln("client public key: {:hex-dump}", ReadonlyBytes { public_key, sizeof(public_key) });
+        dbgln("premaster key: {:hex-dump}", (ReadonlyBytes)m_context.premaster_key);
+    }
+
+    if (!compute_master_secret_from_pre_master_secret(48)) {
+        dbgln("oh noes we could not derive a master key :(");
+        return;
+    }
+
+    builder.append_u24(sizeof(public_key) + 1);
+    builder.append((u8)sizeof(public_key));
+    builder.append(public_key, sizeof(public_key));
+}
+
 ByteBuffer TLSv12::build_certificate()
 {
     PacketBuilder builder { MessageType::Handshake, m_context.options.version };
@@ -360,11 +421,13 @@ ByteBuffer TLSv12::build_client_key_exchange()
         TODO();
         break;
     case KeyExchangeAlgorithm::ECDHE_RSA:
+        build_ecdhe_rsa_pre_master_secret(builder);
+        break;
     case KeyExchangeAlgorithm::ECDH_ECDSA:
     case KeyExchangeAlgorithm::ECDH_RSA:
     case KeyExchangeAlgorithm::ECDHE_ECDSA:
     case KeyExchangeAlgorithm::ECDH_anon:
-        dbgln("Client key exchange for ECDHE algorithms is not implemented");
+        dbgln("Client key exchange for ECDH(E) algorithms other than ECDHE_RSA is not implemented");
         TODO();
         break;
     default:
@@ -10,6 +10,7 @@
 
 #include <LibCore/Timer.h>
 #include <LibCrypto/ASN1/DER.h>
+#include <LibCrypto/Curves/X25519.h>
 #include <LibCrypto/PK/Code/EMSA_PSS.h>
 #include <LibTLS/TLSv12.h>
 
@@ -55,6 +56,10 @@ ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& writ
         return (i8)Error::NeedMoreData;
     }
 
+    // RFC 5246 section 7.4.1.3: The server echoes the session ID we offered if it agrees to resume that session.
+    bool is_resuming_offered_session = m_context.session_to_resume.has_value() && session_length && session_length == m_context.session_id_size
+        && memcmp(m_context.session_id, buffer.offset_pointer(res), session_length) == 0;
+
     if (session_length && session_length <= 32) {
         memcpy(m_context.session_id, buffer.offset_pointer(res), session_length);
         m_context.session_id_size = session_length;
@@ -78,8 +83,13 @@ ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& writ
         dbgln("No supported cipher could be agreed upon");
         return (i8)Error::NoCommonCipher;
     }
+    if (is_resuming_offered_session && cipher != m_context.session_to_resume->cipher) {
+        dbgln("Server resumed a session with a different cipher");
+        return (i8)Error::BrokenPacket;
+    }
     m_context.cipher = cipher;
-    dbgln_if(TLS_DEBUG, "Cipher: {}", (u16)cipher);
+    m_context.is_resumed_session = is_resuming_offered_session;
+    dbgln_if(TLS_DEBUG, "Cipher: {}, resumed session: {}", (u16)cipher, is_resuming_offered_session);
 
     // Simplification: We only support handshake hash functions via HMAC
     m_context.handshake_hash.initialize(hmac_hash());
@@ -144,28 +154,34 @@ ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& writ
                 dbgln("SNI host_name: {}", m_context.extensions.SNI);
             }
         } else if (extension_type == HandshakeExtension::ApplicationLayerProtocolNegotiation && m_context.alpn.size()) {
-            if (buffer.size() - res > 2) {
-                auto alpn_length = AK::convert_between_host_and_network_endian(ByteReader::load16(buffer.offset_pointer(res)));
-                if (alpn_length && alpn_length <= extension_length - 2) {
-                    const u8* alpn = buffer.offset_pointer(res + 2);
-                    size_t alpn_position = 0;
-                    while (alpn_position < alpn_length) {
-                        u8 alpn_size = alpn[alpn_position++];
-                        if (alpn_size + alpn_position >= extension_length)
-                            break;
-                        String alpn_str { (const char*)alpn + alpn_position, alpn_length };
-                        if (alpn_size && m_context.alpn.contains_slow(alpn_str)) {
-                            m_context.negotiated_alpn = alpn_str;
-                            dbgln("negotiated alpn: {}", alpn_str);
-                            break;
-                        }
-                        alpn_position += alpn_length;
-                        if (!m_context.is_server) // server hello must contain one ALPN
-                            break;
-                    }
-                }
+            // RFC 7301 section 3.1: The server answers with a ProtocolNameList that holds exactly the one protocol it picked.
+            if (extension_length < 3)
+                return (i8)Error::BrokenPacket;
+            auto protocol_name_list_length = AK::convert_between_host_and_network_endian(ByteReader::load16(buffer.offset_pointer(res)));
+            u8 protocol_name_length = buffer[res + 2];
+            if (protocol_name_list_length + 2u != extension_length || protocol_name_length == 0 || protocol_name_length + 1u != protocol_name_list_length)
+                return (i8)Error::BrokenPacket;
+            String protocol_name { (const char*)buffer.offset_pointer(res + 3), protocol_name_length };
+            if (!m_context.alpn.contains_slow(protocol_name)) {
+                dbgln("Server picked an application protocol we didn't offer: {}", protocol_name);
+                return (i8)Error::NotUnderstood;
+            }
+            dbgln_if(TLS_DEBUG, "Negotiated application protocol: {}", protocol_name);
+            m_context.negotiated_alpn = move(protocol_name);
+            res += extension_length;
+        } else if (extension_type == HandshakeExtension::ECPointFormats) {
+            // RFC 8422 section 5.2: The server may echo the point formats it supports; uncompressed is mandatory for everyone.
+            if (extension_length < 1 || buffer[res] + 1u > extension_length)
+                return (i8)Error::BrokenPacket;
+            auto formats = buffer.slice(res + 1, buffer[res]);
+            if (!formats.contains_slow((u8)ECPointFormat::Uncompressed)) {
+                dbgln("Server does not support uncompressed elliptic curve points");
+                return (i8)Error::NotUnderstood;
             }
             res += extension_length;
+        } else if (extension_type == HandshakeExtension::SessionTicket) {
+            // RFC 5077 section 3.2: The server will send us a NewSessionTicket before its ChangeCipherSpec.
+            res += extension_length;
         } else if (extension_type == HandshakeExtension::SignatureAlgorithms) {
             dbgln("supported signatures: ");
             print_buffer(buffer.slice(res, extension_length));
@@ -177,6 +193,20 @@ ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& writ
         }
     }
 
+    if (m_context.is_resumed_session) {
+        // RFC 5246 section 7.3: The server skips straight to ChangeCipherSpec and Finished,
+        // so there is no certificate or key exchange, only new keys from the old master secret.
+        auto master_key_result = ByteBuffer::copy(m_context.session_to_resume->master_key);
+        if (!master_key_result.has_value()) {
+            dbgln("Failed to resume session: not enough memory");
+            return (i8)Error::NotUnderstood;
+        }
+        m_context.master_key = master_key_result.release_value();
+        if (!expand_key())
+            return (i8)Error::NotUnderstood;
+        m_context.connection_status = ConnectionStatus::KeyExchange;
+    }
+
     return res;
 }
 
@@ -221,11 +251,12 @@ ssize_t TLSv12::handle_server_key_exchange(ReadonlyBytes buffer)
         TODO();
         break;
     case KeyExchangeAlgorithm::ECDHE_RSA:
+        return handle_ecdhe_rsa_server_key_exchange(buffer);
     case KeyExchangeAlgorithm::ECDH_ECDSA:
     case KeyExchangeAlgorithm::ECDH_RSA:
     case KeyExchangeAlgorithm::ECDHE_ECDSA:
     case KeyExchangeAlgorithm::ECDH_anon:
-        dbgln("Server key exchange for ECDHE algorithms is not implemented");
+        dbgln("Server key exchange for ECDH(E) algorithms other than ECDHE_RSA is not implemented");
         TODO();
         break;
     default:
@@ -276,4 +307,49 @@ ssize_t TLSv12::handle_dhe_rsa_server_key_exchange(ReadonlyBytes buffer)
     return 0;
 }
 
+ssize_t TLSv12::handle_ecdhe_rsa_server_key_exchange(ReadonlyBytes buffer)
+{
+    // RFC 8422 section 5.4: ServerECDHParams { ECParameters { curve_type, namedcurve }, ECPoint { opaque point<1..2^8-1> } }
+    if (buffer.size() < 8)
+        return (i8)Error::NeedMoreData;
+
+    auto curve_type = (ECCurveType)buffer[3];
+    if (curve_type != ECCurveType::NamedCurve) {
+        dbgln("ecdhe_rsa_server_key_exchange failed: Unsupported curve type {}", (u8)curve_type);
+        return (i8)Error::NotUnderstood;
+    }
+
+    auto curve = (NamedCurve)AK::convert_between_host_and_network_endian(ByteReader::load16(buffer.offset_pointer(4)));
+    if (!m_context.options.elliptic_curves.contains_slow(curve)) {
+        dbgln("ecdhe_rsa_server_key_exchange failed: Server picked a curve we did not offer ({})", (u16)curve);
+        return (i8)Error::NotUnderstood;
+    }
+
+    auto public_key_length = buffer[6];
+    if (public_key_length != Crypto::Curves::X25519::KeySize) {
+        dbgln("ecdhe_rsa_server_key_exchange failed: Invalid public key length {}", public_key_length);
+        return (i8)Error::BrokenPacket;
+    }
+    if (buffer.size() - 7 < public_key_length)
+        return (i8)Error::NeedMoreData;
+
+    auto public_key = buffer.slice(7, public_key_length);
+    auto public_key_result = ByteBuffer::copy(public_key);
+    if (!public_key_result.has_value()) {
+        dbgln("ecdhe_rsa_server_key_exchange failed: Not enough memory");
+        return (i8)Error::NotUnderstood;
+    }
+    m_context.server_elliptic_curve_diffie_hellman_params.curve = curve;
+    m_context.server_elliptic_curve_diffie_hellman_params.public_key = public_key_result.release_value();
+
+    if constexpr (TLS_DEBUG) {
+        dbgln("ecdhe curve: {}", (u16)curve);
+        dbgln("ecdhe public key: {:hex-dump}", public_key);
+    }
+
+    // FIXME: Validate signature of the elliptic curve parameters as defined in RFC 8422 section 5.4.
+
+    return 0;
+}
+
 }
@@ -63,6 +63,15 @@ void TLSv12::write_packet(ByteBuffer& packet)
     schedule_or_perform_flush(false);
 }
 
+// RFC 7905 section 2: The per-record nonce is the sequence number, left-padded to 12 bytes, XORed with the static IV.
+static void chacha20_poly1305_nonce(const u8* static_iv, u64 sequence_number, u8* nonce)
+{
+    for (size_t i = 0; i < 4; ++i)
+        nonce[i] = static_iv[i];
+    for (size_t i = 0; i < 8; ++i)
+        nonce[4 + i] = static_iv[4 + i] ^ (u8)(sequence_number >> (56 - 8 * i));
+}
+
 void TLSv12::update_packet(ByteBuffer& packet)
 {
     u32 header_size = 5;
@@ -89,6 +98,10 @@ void TLSv12::update_packet(ByteBuffer& packet)
                     padding = 0;
                     mac_size = 0; // AEAD provides its own authentication scheme.
                 },
+                [&](Crypto::Cipher::ChaCha20Poly1305&) {
+                    VERIFY(is_aead());
+                    mac_size = 0; // AEAD provides its own authentication scheme.
+                },
                 [&](Crypto::Cipher::AESCipher::CBCMode& cbc) {
                     VERIFY(!is_aead());
                     block_size = cbc.cipher().block_size();
@@ -174,6 +187,43 @@ void TLSv12::update_packet(ByteBuffer& packet)
 
                         VERIFY(header_size + 8 + length + 16 == ct.size());
                     },
+                    [&](Crypto::Cipher::ChaCha20Poly1305& chacha) {
+                        VERIFY(is_aead());
+                        // RFC 7905 section 2: There is no explicit nonce, we need room for the header, the data and a tag.
+                        auto ct_buffer_result = ByteBuffer::create_uninitialized(length + header_size + 16);
+                        if (!ct_buffer_result.has_value()) {
+                            dbgln("LibTLS: Failed to allocate enough memory for the ciphertext");
+                            VERIFY_NOT_REACHED();
+                        }
+                        ct = ct_buffer_result.release_value();
+
+                        // copy the header over
+                        ct.overwrite(0, packet.data(), header_size - 2);
+
+                        u8 aad[13];
+                        Bytes aad_bytes { aad, 13 };
+                        OutputMemoryStream aad_stream { aad_bytes };
+
+                        u64 seq_no = AK::convert_between_host_and_network_endian(m_context.local_sequence_number);
+                        u16 len = AK::convert_between_host_and_network_endian((u16)(packet.size() - header_size));
+
+                        aad_stream.write({ &seq_no, sizeof(seq_no) });
+                        aad_stream.write(packet.bytes().slice(0, 3)); // content-type + version
+                        aad_stream.write({ &len, sizeof(len) });      // length
+                        VERIFY(aad_stream.is_end());
+
+                        u8 nonce[Crypto::Cipher::ChaCha20Poly1305::NonceSize];
+                        chacha20_poly1305_nonce(m_context.crypto.local_aead_iv, m_context.local_sequence_number, nonce);
+
+                        chacha.encrypt(
+                            packet.bytes().slice(header_size, length),
+                            ct.bytes().slice(header_size, length),
+                            { nonce, sizeof(nonce) },
+                            aad_bytes,
+                            ct.bytes().slice(header_size + length, 16));
+
+                        VERIFY(header_size + length + 16 == ct.size());
+                    },
                     [&](Crypto::Cipher::AESCipher::CBCMode& cbc) {
                         VERIFY(!is_aead());
                         // We need enough space for a header, iv_length bytes of IV and whatever the packet contains
@@ -426,6 +476,61 @@ ssize_t TLSv12::handle_message(ReadonlyBytes buffer)
 
                 plain = decrypted;
             },
+            [&](Crypto::Cipher::ChaCha20Poly1305& chacha) {
+                VERIFY(is_aead());
+                if (length < 16) {
+                    dbgln("Invalid packet length");
+                    auto packet = build_alert(true, (u8)AlertDescription::DecryptError);
+                    write_packet(packet);
+                    return_value = Error::BrokenPacket;
+                    return;
+                }
+
+                auto packet_length = length - 16;
+                auto decrypted_result = ByteBuffer::create_uninitialized(packet_length);
+                if (!decrypted_result.has_value()) {
+                    dbgln("Failed to allocate memory for the packet");
+                    return_value = Error::DecryptionFailed;
+                    return;
+                }
+                decrypted = decrypted_result.release_value();
+
+                u8 aad[13];
+                Bytes aad_bytes { aad, 13 };
+                OutputMemoryStream aad_stream { aad_bytes };
+
+                u64 seq_no = AK::convert_between_host_and_network_endian(m_context.remote_sequence_number);
+                u16 len = AK::convert_between_host_and_network_endian((u16)packet_length);
+
+                aad_stream.write({ &seq_no, sizeof(seq_no) });      // Sequence number
+                aad_stream.write(buffer.slice(0, header_size - 2)); // content-type + version
+                aad_stream.write({ &len, sizeof(u16) });
+                VERIFY(aad_stream.is_end());
+
+                u8 nonce[Crypto::Cipher::ChaCha20Poly1305::NonceSize];
+                chacha20_poly1305_nonce(m_context.crypto.remote_aead_iv, m_context.remote_sequence_number, nonce);
+
+                auto ciphertext = plain.slice(0, packet_length);
+                auto tag = plain.slice(packet_length, 16);
+
+                auto consistency = chacha.decrypt(
+                    ciphertext,
+                    decrypted,
+                    { nonce, sizeof(nonce) },
+                    aad_bytes,
+                    tag);
+
+                if (consistency != Crypto::VerificationConsistency::Consistent) {
+                    dbgln("integrity check failed (tag length {})", tag.size());
+                    auto packet = build_alert(true, (u8)AlertDescription::BadRecordMAC);
+                    write_packet(packet);
+
+                    return_value = Error::IntegrityCheckFailed;
+                    return;
+                }
+
+                plain = decrypted;
+            },
             [&](Crypto::Cipher::AESCipher::CBCMode& cbc) {
                 VERIFY(!is_aead());
                 auto iv_size = iv_length();
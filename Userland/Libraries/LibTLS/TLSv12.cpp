@@ -174,15 +174,64 @@ void TLSv12::try_disambiguate_error() const
 
 void TLSv12::set_root_certificates(Vector<Certificate> certificates)
 {
-    if (!m_context.root_certificates.is_empty())
-        dbgln("TLS warn: resetting root certificates!");
-
     for (auto& cert : certificates) {
         if (!cert.is_valid())
             dbgln("Certificate for {} by {} is invalid, things may or may not work!", cert.subject.subject, cert.issuer.subject);
         // FIXME: Figure out what we should do when our root certs are invalid.
     }
-    m_context.root_certificates = move(certificates);
+    set_trust_store(TrustStore::create(move(certificates)));
+}
+
+void TLSv12::set_trust_store(NonnullRefPtr<TrustStore> trust_store)
+{
+    if (m_context.root_certificates)
+        dbgln("TLS warn: resetting root certificates!");
+
+    m_context.root_certificates = move(trust_store);
+}
+
+void TLSv12::add_alpn(StringView alpn)
+{
+    if (m_context.is_server || m_context.critical_error || m_context.connection_status != ConnectionStatus::Disconnected) {
+        dbgln("invalid state for add_alpn");
+        return;
+    }
+    // RFC 7301 section 3.1: Protocol names are between 1 and 255 bytes long.
+    VERIFY(!alpn.is_empty() && alpn.length() <= 255);
+    m_context.alpn.append(alpn);
+}
+
+bool TLSv12::has_alpn(StringView alpn) const
+{
+    return m_context.alpn.contains_slow(alpn);
+}
+
+Optional<Session> TLSv12::session() const
+{
+    if (!is_established() || m_context.master_key.is_empty())
+        return {};
+
+    Session session;
+    session.cipher = m_context.cipher;
+    memcpy(session.session_id, m_context.session_id, m_context.session_id_size);
+    session.session_id_size = m_context.session_id_size;
+
+    // Prefer a freshly issued ticket, but a resumed session may keep using the one it was resumed with.
+    auto const* ticket = &m_context.session_ticket;
+    if (ticket->is_empty() && m_context.is_resumed_session && m_context.session_to_resume.has_value())
+        ticket = &m_context.session_to_resume->ticket;
+
+    if (session.session_id_size == 0 && ticket->is_empty())
+        return {};
+
+    auto master_key_result = ByteBuffer::copy(m_context.master_key);
+    auto ticket_result = ByteBuffer::copy(*ticket);
+    if (!master_key_result.has_value() || !ticket_result.has_value())
+        return {};
+    session.master_key = master_key_result.release_value();
+    session.ticket = ticket_result.release_value();
+
+    return session;
 }
 
 bool Context::verify_chain() const
@@ -199,15 +248,12 @@ bool Context::verify_chain() const
     }
 
     // FIXME: Actually verify the signature, instead of just checking the name.
-    HashMap<String, String> chain;
-    HashTable<String> roots;
-    // First, walk the root certs.
-    for (auto& cert : root_certificates) {
-        roots.set(cert.subject.subject);
-        chain.set(cert.subject.subject, cert.issuer.subject);
-    }
+    auto is_trusted_issuer = [&](const String& name) {
+        return root_certificates && root_certificates->is_trusted_issuer(name);
+    };
 
-    // Then, walk the local certs.
+    // The roots are looked up in the trust store's index, so only the local certs need walking.
+    HashMap<String, String> chain;
     for (auto& cert : *local_chain) {
         auto& issuer_unique_name = cert.issuer.unit.is_empty() ? cert.issuer.subject : cert.issuer.unit;
         chain.set(cert.subject.subject, issuer_unique_name);
@@ -216,11 +262,15 @@ bool Context::verify_chain() const
     // Then verify the chain.
     for (auto& it : chain) {
         if (it.key == it.value) { // Allow self-signed certificates.
-            if (!roots.contains(it.key))
+            if (!root_certificates || !root_certificates->find_by_subject(it.key))
                 dbgln("Self-signed warning: Certificate for {} is self-signed", it.key);
             continue;
         }
 
+        // Either a root or an intermediate we've already seen chain up to one.
+        if (is_trusted_issuer(it.value))
+            continue;
+
         auto ref = chain.get(it.value);
         if (!ref.has_value()) {
             dbgln("Certificate for {} is not signed by anyone we trust ({})", it.key, it.value);
@@ -231,6 +281,27 @@ bool Context::verify_chain() const
             dbgln("Co-dependency warning: Certificate for {} is issued by {}, which itself is issued by {}", ref.value(), it.key, ref.value());
     }
 
+    // Remember the intermediates that lead up to a trusted issuer, so later chains through them
+    // stop early (and still verify if the server forgets to send them). The leaf is not worth keeping.
+    if (root_certificates) {
+        for (size_t i = 1; i < local_chain->size(); ++i) {
+            auto& subject = local_chain->at(i).subject.subject;
+            auto issuer = chain.get(subject);
+            if (!issuer.has_value() || issuer.value() == subject)
+                continue;
+
+            auto name = issuer.value();
+            for (size_t depth = 0; depth < chain.size() && !is_trusted_issuer(name); ++depth) {
+                auto next = chain.get(name);
+                if (!next.has_value() || next.value() == name)
+                    break;
+                name = next.value();
+            }
+            if (is_trusted_issuer(name))
+                root_certificates->add_verified_intermediate(subject, issuer.value());
+        }
+    }
+
     return true;
 }
 
@@ -349,12 +420,14 @@ bool TLSv12::add_client_key(ReadonlyBytes certificate_pem_buffer, ReadonlyBytes
 
 Singleton<DefaultRootCACertificates> DefaultRootCACertificates::s_the;
 DefaultRootCACertificates::DefaultRootCACertificates()
+    : m_trust_store(TrustStore::create({}))
 {
     // FIXME: This might not be the best format, find a better way to represent CA certificates.
     auto config = Core::ConfigFile::open_for_system("ca_certs");
     auto now = Core::DateTime::now();
     auto last_year = Core::DateTime::create(now.year() - 1);
     auto next_year = Core::DateTime::create(now.year() + 1);
+    Vector<Certificate> ca_certificates;
     for (auto& entity : config->groups()) {
         Certificate cert;
         cert.subject.subject = entity;
@@ -362,7 +435,8 @@ DefaultRootCACertificates::DefaultRootCACertificates()
         cert.subject.country = config->read_entry(entity, "country");
         cert.not_before = Crypto::ASN1::parse_generalized_time(config->read_entry(entity, "not_before", "")).value_or(last_year);
         cert.not_after = Crypto::ASN1::parse_generalized_time(config->read_entry(entity, "not_after", "")).value_or(next_year);
-        m_ca_certificates.append(move(cert));
+        ca_certificates.append(move(cert));
     }
+    m_trust_store = TrustStore::create(move(ca_certificates));
 }
 }
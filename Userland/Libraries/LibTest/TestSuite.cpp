@@ -8,10 +8,15 @@
 #include <LibTest/Macros.h> // intentionally first -- we redefine VERIFY and friends in here
 
 #include <AK/Function.h>
+#include <AK/JsonObject.h>
+#include <AK/LexicalPath.h>
+#include <AK/QuickSort.h>
 #include <LibCore/ArgsParser.h>
+#include <LibCore/File.h>
 #include <LibTest/TestSuite.h>
 #include <stdlib.h>
 #include <sys/time.h>
+#include <time.h>
 
 namespace Test {
 
@@ -38,6 +43,24 @@ private:
     struct timeval m_started = {};
 };
 
+static u64 monotonic_nanoseconds()
+{
+    struct timespec now = {};
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<u64>(now.tv_sec) * 1'000'000'000 + now.tv_nsec;
+}
+
+static String human_readable_duration(u64 nanoseconds)
+{
+    if (nanoseconds < 1'000)
+        return String::formatted("{}ns", nanoseconds);
+    if (nanoseconds < 1'000'000)
+        return String::formatted("{:.2}us", nanoseconds / 1'000.0);
+    if (nanoseconds < 1'000'000'000)
+        return String::formatted("{:.2}ms", nanoseconds / 1'000'000.0);
+    return String::formatted("{:.2}s", nanoseconds / 1'000'000'000.0);
+}
+
 // Declared in Macros.h
 void current_test_case_did_fail()
 {
@@ -70,9 +93,24 @@ int TestSuite::main(const String& suite_name, int argc, char** argv)
     args_parser.add_option(do_tests_only, "Only run tests.", "tests", 0);
     args_parser.add_option(do_benchmarks_only, "Only run benchmarks.", "bench", 0);
     args_parser.add_option(do_list_cases, "List available test cases.", "list", 0);
+    args_parser.add_option(m_benchmark_time_ms, "Roughly how long to run each benchmark for.", "bench-time", 0, "milliseconds");
+    args_parser.add_option(m_benchmark_results_path, "Write the benchmark results to a JSON file.", "bench-json", 0, "path");
+    args_parser.add_option(m_benchmark_baseline_path, "Compare the benchmark results to the ones in a JSON file, and fail if they got slower.", "compare", 0, "path");
+    args_parser.add_option(m_benchmark_regression_threshold, "How much slower a benchmark may get before --compare fails.", "compare-threshold", 0, "percent");
     args_parser.add_positional_argument(search_string, "Only run matching cases.", "pattern", Core::ArgsParser::Required::No);
     args_parser.parse(argc, argv);
 
+    // run-tests passes these on, so the results of every test suite end up next to each other.
+    auto benchmark_file_name = String::formatted("{}.json", LexicalPath::basename(suite_name));
+    if (auto* directory = getenv("BENCHMARK_RESULTS_DIRECTORY"); directory && m_benchmark_results_path.is_null())
+        m_benchmark_results_path = LexicalPath::join(directory, benchmark_file_name).string();
+    if (auto* directory = getenv("BENCHMARK_BASELINE_DIRECTORY"); directory && m_benchmark_baseline_path.is_null()) {
+        auto path = LexicalPath::join(directory, benchmark_file_name).string();
+        // Suites that didn't have any benchmarks yet when the baseline was taken have nothing to compare against.
+        if (Core::File::exists(path))
+            m_benchmark_baseline_path = path;
+    }
+
     if (m_setup)
         m_setup();
 
@@ -125,7 +163,12 @@ int TestSuite::run(const NonnullRefPtrVector<TestCase>& tests)
         m_current_test_case_passed = true;
 
         TestElapsedTimer timer;
-        t.func()();
+        if (t.is_benchmark()) {
+            if (auto result = run_benchmark(t); result.has_value())
+                m_benchmark_results.append(result.release_value());
+        } else {
+            t.func()();
+        }
         const auto time = timer.elapsed_milliseconds();
 
         dbgln("{} {} '{}' in {}ms", m_current_test_case_passed ? "Completed" : "Failed", test_type, t.name(), time);
@@ -152,7 +195,120 @@ int TestSuite::run(const NonnullRefPtrVector<TestCase>& tests)
         global_timer.elapsed_milliseconds() - (m_testtime + m_benchtime));
     dbgln("Out of {} tests, {} passed and {} failed.", test_count, test_count - test_failed_count, test_failed_count);
 
+    if (!m_benchmark_results_path.is_null()) {
+        if (auto result = write_benchmark_results(m_benchmark_results_path); result.is_error()) {
+            warnln("Couldn't write the benchmark results to {}: {}", m_benchmark_results_path, result.error());
+            test_failed_count++;
+        }
+    }
+
+    if (!m_benchmark_baseline_path.is_null()) {
+        auto regression_count_or_error = compare_benchmark_results(m_benchmark_baseline_path);
+        if (regression_count_or_error.is_error()) {
+            warnln("Couldn't compare the benchmark results to {}: {}", m_benchmark_baseline_path, regression_count_or_error.error());
+            test_failed_count++;
+        } else {
+            test_failed_count += regression_count_or_error.value();
+        }
+    }
+
     return (int)test_failed_count;
 }
 
+Optional<TestSuite::BenchmarkResult> TestSuite::run_benchmark(TestCase const& benchmark)
+{
+    constexpr size_t min_iterations = 3;
+    constexpr size_t max_iterations = 100'000;
+    u64 time_budget = static_cast<u64>(m_benchmark_time_ms) * 1'000'000;
+
+    // The first runs fill the caches and initialize whatever the benchmark sets up lazily, so they aren't measured.
+    auto warmup_start = monotonic_nanoseconds();
+    do {
+        benchmark.func()();
+    } while (m_current_test_case_passed && monotonic_nanoseconds() - warmup_start < time_budget / 10);
+
+    // Fast benchmarks run many times, so a single slow run doesn't skew the results. Slow ones still run a few times.
+    Vector<u64> samples;
+    auto start = monotonic_nanoseconds();
+    while (m_current_test_case_passed && samples.size() < max_iterations) {
+        if (samples.size() >= min_iterations && monotonic_nanoseconds() - start >= time_budget)
+            break;
+        auto iteration_start = monotonic_nanoseconds();
+        benchmark.func()();
+        samples.append(monotonic_nanoseconds() - iteration_start);
+    }
+    if (!m_current_test_case_passed)
+        return {};
+
+    quick_sort(samples);
+    u64 total = 0;
+    for (auto sample : samples)
+        total += sample;
+
+    BenchmarkResult result;
+    result.name = benchmark.name();
+    result.iterations = samples.size();
+    result.min_ns = samples.first();
+    if (samples.size() % 2 == 0)
+        result.median_ns = (samples[samples.size() / 2 - 1] + samples[samples.size() / 2]) / 2;
+    else
+        result.median_ns = samples[samples.size() / 2];
+    result.p99_ns = samples[ceil_div(samples.size() * 99, static_cast<size_t>(100)) - 1];
+    result.mean_ns = total / samples.size();
+
+    outln("{}: {} iterations, min {}, median {}, p99 {}", result.name, result.iterations,
+        human_readable_duration(result.min_ns), human_readable_duration(result.median_ns), human_readable_duration(result.p99_ns));
+    return result;
+}
+
+ErrorOr<void> TestSuite::write_benchmark_results(String const& path) const
+{
+    JsonObject benchmarks;
+    for (auto& result : m_benchmark_results) {
+        JsonObject object;
+        object.set("iterations", result.iterations);
+        object.set("min_ns", result.min_ns);
+        object.set("median_ns", result.median_ns);
+        object.set("p99_ns", result.p99_ns);
+        object.set("mean_ns", result.mean_ns);
+        benchmarks.set(result.name, move(object));
+    }
+    JsonObject results;
+    results.set("suite", LexicalPath::basename(m_suite_name));
+    results.set("benchmarks", move(benchmarks));
+
+    auto file = TRY(Core::File::open(path, Core::OpenMode::WriteOnly | Core::OpenMode::Truncate));
+    if (!file->write(results.to_string()))
+        return Error::from_errno(file->error());
+    return {};
+}
+
+ErrorOr<size_t> TestSuite::compare_benchmark_results(String const& baseline_path) const
+{
+    auto file = TRY(Core::File::open(baseline_path, Core::OpenMode::ReadOnly));
+    auto json = TRY(JsonValue::from_string(file->read_all()));
+    if (!json.is_object() || !json.as_object().get("benchmarks").is_object())
+        return Error::from_string_literal("Not a file with benchmark results"sv);
+    auto const& baseline = json.as_object().get("benchmarks").as_object();
+
+    // The median is compared, since it's what is least affected by whatever else the system was doing at the time.
+    size_t regression_count = 0;
+    for (auto& result : m_benchmark_results) {
+        auto const* baseline_result = baseline.get_ptr(result.name);
+        if (!baseline_result || !baseline_result->is_object())
+            continue;
+        auto baseline_median = baseline_result->as_object().get("median_ns").to_u64();
+        if (baseline_median == 0)
+            continue;
+
+        double change = (static_cast<double>(result.median_ns) - baseline_median) * 100 / baseline_median;
+        bool is_regression = change > m_benchmark_regression_threshold;
+        outln("{}: median {} -> {} ({}{:.1}%){}", result.name, human_readable_duration(baseline_median), human_readable_duration(result.median_ns),
+            change >= 0 ? "+" : "", change, is_regression ? ", slower than allowed" : "");
+        if (is_regression)
+            regression_count++;
+    }
+    return regression_count;
+}
+
 }
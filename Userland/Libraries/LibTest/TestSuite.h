@@ -9,10 +9,13 @@
 
 #include <LibTest/Macros.h> // intentionally first -- we redefine VERIFY and friends in here
 
+#include <AK/Error.h>
 #include <AK/Format.h>
 #include <AK/Function.h>
 #include <AK/NonnullRefPtrVector.h>
+#include <AK/Optional.h>
 #include <AK/String.h>
+#include <AK/Vector.h>
 #include <LibTest/TestCase.h>
 
 namespace Test {
@@ -46,6 +49,19 @@ public:
     void set_suite_setup(Function<void()> setup) { m_setup = move(setup); }
 
 private:
+    struct BenchmarkResult {
+        String name;
+        size_t iterations { 0 };
+        u64 min_ns { 0 };
+        u64 median_ns { 0 };
+        u64 p99_ns { 0 };
+        u64 mean_ns { 0 };
+    };
+
+    Optional<BenchmarkResult> run_benchmark(TestCase const&);
+    ErrorOr<void> write_benchmark_results(String const& path) const;
+    ErrorOr<size_t> compare_benchmark_results(String const& baseline_path) const;
+
     static TestSuite* s_global;
     NonnullRefPtrVector<TestCase> m_cases;
     u64 m_testtime = 0;
@@ -53,6 +69,12 @@ private:
     String m_suite_name;
     bool m_current_test_case_passed = true;
     Function<void()> m_setup;
+
+    unsigned m_benchmark_time_ms { 1000 };
+    String m_benchmark_results_path;
+    String m_benchmark_baseline_path;
+    double m_benchmark_regression_threshold { 10 };
+    Vector<BenchmarkResult> m_benchmark_results;
 };
 
 }
@@ -7,37 +7,24 @@
 
 #pragma once
 
+#include <AK/Atomic.h>
 #include <AK/Function.h>
 #include <AK/NonnullRefPtr.h>
 #include <AK/Optional.h>
-#include <AK/Queue.h>
 #include <LibCore/Event.h>
 #include <LibCore/EventLoop.h>
 #include <LibCore/Object.h>
-#include <LibThreading/Thread.h>
+#include <LibThreading/ThreadPool.h>
 
 namespace Threading {
 
 template<typename Result>
-class BackgroundAction;
-
-class BackgroundActionBase {
-    template<typename Result>
-    friend class BackgroundAction;
-
-private:
-    BackgroundActionBase() { }
-
-    static void enqueue_work(Function<void()>);
-    static Thread& background_thread();
-};
-
-template<typename Result>
-class BackgroundAction final : public Core::Object
-    , private BackgroundActionBase {
+class BackgroundAction final : public Core::Object {
     C_OBJECT(BackgroundAction);
 
 public:
+    // An action that is cancelled before it starts is dropped, along with its completion handler. One that has already
+    // started is expected to check is_cancelled() itself.
     void cancel()
     {
         m_cancelled = true;
@@ -51,26 +38,26 @@ public:
     virtual ~BackgroundAction() { }
 
 private:
-    BackgroundAction(Function<Result(BackgroundAction&)> action, Function<void(Result)> on_complete)
-        : Core::Object(&background_thread())
+    BackgroundAction(Function<Result(BackgroundAction&)> action, Function<void(Result)> on_complete, ThreadPool::Priority priority = ThreadPool::Priority::Normal)
+        : Core::Object(&ThreadPool::the())
         , m_action(move(action))
         , m_on_complete(move(on_complete))
     {
-        enqueue_work([this] {
-            m_result = m_action(*this);
-            if (m_on_complete) {
-                deferred_invoke([this] {
+        ThreadPool::the().submit([this] {
+            if (!m_cancelled)
+                m_result = m_action(*this);
+            // The pool's list of children is only ever touched on the main thread.
+            deferred_invoke([this] {
+                if (m_on_complete && m_result.has_value())
                     m_on_complete(m_result.release_value());
-                    remove_from_parent();
-                });
-                Core::EventLoop::wake();
-            } else {
-                this->remove_from_parent();
-            }
-        });
+                remove_from_parent();
+            });
+            Core::EventLoop::wake();
+        },
+            priority);
     }
 
-    bool m_cancelled { false };
+    Atomic<bool> m_cancelled { false };
     Function<Result(BackgroundAction&)> m_action;
     Function<void(Result)> m_on_complete;
     Optional<Result> m_result;
@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ScopeGuard.h>
+#include <AK/StringBuilder.h>
+#include <LibThreading/DirectoryWalker.h>
+#include <LibThreading/ThreadPool.h>
+#include <fcntl.h>
+#include <string.h>
+
+namespace Threading {
+
+// Reading ahead stops once this many directories per worker have been read (or are being read) that the walk hasn't
+// gotten to yet, so walking a huge flat directory doesn't end up with the whole tree in memory.
+static constexpr size_t max_listings_per_worker = 16;
+
+static unsigned char directory_entry_type_from_mode(mode_t mode)
+{
+    if (S_ISREG(mode))
+        return DT_REG;
+    if (S_ISDIR(mode))
+        return DT_DIR;
+    if (S_ISLNK(mode))
+        return DT_LNK;
+    if (S_ISCHR(mode))
+        return DT_CHR;
+    if (S_ISBLK(mode))
+        return DT_BLK;
+    if (S_ISFIFO(mode))
+        return DT_FIFO;
+    if (S_ISSOCK(mode))
+        return DT_SOCK;
+    return DT_UNKNOWN;
+}
+
+// Copies the string into a StringImpl of its own. Short strings are otherwise shared with every other thread (see
+// StringImpl::create()), and reference counts aren't atomic, so anything that crosses threads has to be unshared.
+static String unshared_string(StringView string)
+{
+    char* buffer;
+    auto impl = StringImpl::create_uninitialized(string.length(), buffer);
+    memcpy(buffer, string.characters_without_null_termination(), string.length());
+    return impl;
+}
+
+DirectoryWalker::DirectoryWalker(StatEntries stat_entries, Core::DirIterator::Flags flags)
+    : m_stat_entries(stat_entries)
+    , m_flags(flags)
+{
+}
+
+DirectoryWalker::~DirectoryWalker()
+{
+    MutexLocker locker(m_mutex);
+    while (m_reads_in_flight > 0)
+        m_listing_done.wait();
+}
+
+ErrorOr<Vector<DirectoryWalker::Entry>> DirectoryWalker::read_directory(String const& path, ReadAhead read_ahead)
+{
+    Optional<ErrorOr<Vector<Entry>>> result;
+    {
+        MutexLocker locker(m_mutex);
+        if (auto it = m_listings.find(path); it != m_listings.end() && it->value->state != Listing::State::Taken) {
+            auto& listing = *it->value;
+            if (listing.state == Listing::State::Queued) {
+                // The pool hasn't gotten to it yet, so we're better off reading it ourselves than waiting. The task
+                // still refers to the listing, so it's left to the task to remove it.
+                listing.state = Listing::State::Taken;
+            } else {
+                m_listing_done.wait_while([&] { return listing.state != Listing::State::Done; });
+                result = move(listing.result);
+                m_listings.remove(it);
+            }
+        }
+    }
+
+    if (!result.has_value())
+        result = read_entries(path);
+
+    if (read_ahead == ReadAhead::Yes && !result->is_error()) {
+        for (auto& entry : result->value()) {
+            if (entry.type == DT_DIR)
+                start_reading_ahead(entry.path);
+        }
+    }
+
+    return result.release_value();
+}
+
+void DirectoryWalker::start_reading_ahead(String const& path)
+{
+    MutexLocker locker(m_mutex);
+    if (m_listings.size() >= ThreadPool::the().worker_count() * max_listings_per_worker || m_listings.contains(path))
+        return;
+
+    auto listing = make<Listing>();
+    auto& listing_ref = *listing;
+    // The key is only ever touched with the mutex held, so it can't share its StringImpl with anything outside.
+    m_listings.set(unshared_string(path), move(listing));
+    ++m_reads_in_flight;
+
+    // The task gets a copy of the path of its own, see unshared_string().
+    ThreadPool::the().submit([this, &listing_ref, path = unshared_string(path)] {
+        {
+            MutexLocker locker(m_mutex);
+            if (listing_ref.state == Listing::State::Taken) {
+                m_listings.remove(path);
+                --m_reads_in_flight;
+                m_listing_done.broadcast();
+                return;
+            }
+            listing_ref.state = Listing::State::Reading;
+        }
+
+        auto entries = read_entries(path);
+
+        MutexLocker locker(m_mutex);
+        listing_ref.result = move(entries);
+        listing_ref.state = Listing::State::Done;
+        --m_reads_in_flight;
+        m_listing_done.broadcast();
+    },
+        ThreadPool::Priority::High);
+}
+
+ErrorOr<Vector<DirectoryWalker::Entry>> DirectoryWalker::read_entries(String const& path) const
+{
+    // This runs on the pool, so it reads the directory itself rather than going through Core::DirIterator, which would
+    // hand out shared strings.
+    auto* dir = opendir(path.characters());
+    if (!dir)
+        return Error::from_errno(errno);
+    ScopeGuard close_dir = [&] { closedir(dir); };
+
+    Vector<Entry> entries;
+    for (;;) {
+        errno = 0;
+        auto* directory_entry = readdir(dir);
+        if (!directory_entry) {
+            if (errno != 0)
+                return Error::from_errno(errno);
+            break;
+        }
+
+        StringView name { directory_entry->d_name, strlen(directory_entry->d_name) };
+        if ((m_flags & Core::DirIterator::SkipDots) && name.starts_with('.'))
+            continue;
+        if ((m_flags & Core::DirIterator::SkipParentAndBaseDir) && (name == "." || name == ".."))
+            continue;
+
+        StringBuilder builder;
+        builder.append(path);
+        if (!path.ends_with('/'))
+            builder.append('/');
+        builder.append(name);
+
+        Entry entry { unshared_string(name), unshared_string(builder.string_view()), directory_entry->d_type, {} };
+        if (m_stat_entries == StatEntries::Always || entry.type == DT_UNKNOWN) {
+            struct stat st;
+            if (fstatat(dirfd(dir), directory_entry->d_name, &st, AT_SYMLINK_NOFOLLOW) == 0) {
+                entry.type = directory_entry_type_from_mode(st.st_mode);
+                entry.stat = st;
+            }
+        }
+        entries.append(move(entry));
+    }
+    return entries;
+}
+
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Error.h>
+#include <AK/HashMap.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Noncopyable.h>
+#include <AK/Optional.h>
+#include <AK/String.h>
+#include <AK/Vector.h>
+#include <LibCore/DirIterator.h>
+#include <LibThreading/ConditionVariable.h>
+#include <LibThreading/Mutex.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+namespace Threading {
+
+// Reads the directories of a tree that is being walked, reading ahead on the thread pool.
+//
+// Whenever a directory is read, the subdirectories in it start being read in the background, so by the time the walk
+// gets to one of them, its entries are usually waiting. The walk itself stays on the calling thread and visits
+// everything in the same order as a plain recursive walk would.
+class DirectoryWalker {
+    AK_MAKE_NONCOPYABLE(DirectoryWalker);
+    AK_MAKE_NONMOVABLE(DirectoryWalker);
+
+public:
+    enum class StatEntries {
+        // Only stat() the entries the file system doesn't know the type of.
+        IfTypeIsUnknown,
+        Always,
+    };
+
+    struct Entry {
+        String name;
+        // The path of the directory joined with the name.
+        String path;
+        // One of the DT_* types. If the entry was stat()ed, this comes from its lstat().
+        unsigned char type { DT_UNKNOWN };
+        // The lstat() of the entry, if it was stat()ed.
+        Optional<struct stat> stat;
+    };
+
+    enum class ReadAhead {
+        No,
+        Yes,
+    };
+
+    explicit DirectoryWalker(StatEntries = StatEntries::IfTypeIsUnknown, Core::DirIterator::Flags = Core::DirIterator::SkipParentAndBaseDir);
+    ~DirectoryWalker();
+
+    // Returns the entries of the directory at the path that pass the DirIterator flags, in the order the directory lists them.
+    // Pass ReadAhead::No if the walk isn't going to descend into the subdirectories.
+    ErrorOr<Vector<Entry>> read_directory(String const& path, ReadAhead = ReadAhead::Yes);
+
+private:
+    struct Listing {
+        enum class State {
+            Queued,
+            Reading,
+            Done,
+            // The walk got to the directory before the pool did, and read it itself.
+            Taken,
+        };
+        State state { State::Queued };
+        Optional<ErrorOr<Vector<Entry>>> result;
+    };
+
+    ErrorOr<Vector<Entry>> read_entries(String const& path) const;
+    void start_reading_ahead(String const& path);
+
+    StatEntries const m_stat_entries;
+    Core::DirIterator::Flags const m_flags;
+
+    Mutex m_mutex;
+    ConditionVariable m_listing_done { m_mutex };
+    HashMap<String, NonnullOwnPtr<Listing>> m_listings;
+    // Reads that have been handed to the pool and haven't finished yet. We can't go away until they have.
+    size_t m_reads_in_flight { 0 };
+};
+
+}
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/MergeSort.h>
+#include <AK/QuickSort.h>
+#include <AK/Span.h>
+#include <AK/Vector.h>
+#include <LibThreading/ThreadPool.h>
+
+namespace Threading {
+
+// Algorithms that spread their work over ThreadPool::the(). The work is split into chunks of grain_size elements, which
+// the calling thread and the workers take turns picking up. With the default grain size of 0, there are a few chunks
+// per worker, which balances the load well enough when some elements are more expensive than others. Pass a larger
+// grain size when each element is cheap.
+//
+// The callbacks are called concurrently, so they must not rely on shared mutable state.
+
+namespace Detail {
+
+inline size_t parallel_chunk_size(size_t count, size_t grain_size)
+{
+    if (grain_size != 0)
+        return grain_size;
+    constexpr size_t chunks_per_worker = 4;
+    return max<size_t>(1, ceil_div(count, ThreadPool::the().worker_count() * chunks_per_worker));
+}
+
+}
+
+// Calls callback(i) for every i in [0, count).
+template<typename Callback>
+void parallel_for(size_t count, Callback callback, size_t grain_size = 0)
+{
+    auto chunk_size = Detail::parallel_chunk_size(count, grain_size);
+    ThreadPool::the().run_in_parallel(ceil_div(count, chunk_size), [&](size_t chunk) {
+        auto end = min(count, (chunk + 1) * chunk_size);
+        for (size_t i = chunk * chunk_size; i < end; ++i)
+            callback(i);
+    });
+}
+
+// Calls callback(value) for every value.
+template<typename T, typename Callback>
+void parallel_for(Span<T> values, Callback callback, size_t grain_size = 0)
+{
+    parallel_for(
+        values.size(), [&](size_t i) { callback(values[i]); }, grain_size);
+}
+
+// Folds each chunk of the values into a copy of the identity with accumulate(result, value), and then folds the results
+// of the chunks together in order with combine(result, chunk_result). As the chunks are combined in order, the result
+// doesn't depend on the number of threads as long as combine() is associative.
+template<typename Result, typename T, typename Accumulate, typename Combine>
+Result parallel_reduce(Span<T> values, Result identity, Accumulate accumulate, Combine combine, size_t grain_size = 0)
+{
+    auto chunk_size = Detail::parallel_chunk_size(values.size(), grain_size);
+    auto chunk_count = ceil_div(values.size(), chunk_size);
+
+    Vector<Result> chunk_results;
+    chunk_results.ensure_capacity(chunk_count);
+    for (size_t i = 0; i < chunk_count; ++i)
+        chunk_results.unchecked_append(identity);
+    ThreadPool::the().run_in_parallel(chunk_count, [&](size_t chunk) {
+        auto end = min(values.size(), (chunk + 1) * chunk_size);
+        auto& result = chunk_results[chunk];
+        for (size_t i = chunk * chunk_size; i < end; ++i)
+            result = accumulate(move(result), values[i]);
+    });
+
+    auto result = move(identity);
+    for (auto& chunk_result : chunk_results)
+        result = combine(move(result), move(chunk_result));
+    return result;
+}
+
+// Below this many elements, spreading the work costs more than it saves.
+static constexpr size_t parallel_sort_threshold = 64 * KiB;
+
+// Sorts one chunk per worker concurrently, and then merges neighboring chunks, with all merges of the same width running
+// concurrently as well. The sort is not stable.
+template<typename T, typename LessThan>
+void parallel_sort(Span<T> values, LessThan less_than, size_t chunk_count = 0)
+{
+    if (chunk_count == 0)
+        chunk_count = ThreadPool::the().worker_count();
+    if (values.size() < parallel_sort_threshold || chunk_count < 2) {
+        quick_sort(values, move(less_than));
+        return;
+    }
+
+    size_t chunk_size = ceil_div(values.size(), chunk_count);
+    ThreadPool::the().run_in_parallel(ceil_div(values.size(), chunk_size), [&](size_t chunk) {
+        auto less_than_copy = less_than;
+        dual_pivot_quick_sort(values, chunk * chunk_size, min(values.size(), (chunk + 1) * chunk_size) - 1, less_than_copy);
+    });
+
+    for (size_t width = chunk_size; width < values.size(); width *= 2) {
+        auto merge_count = ceil_div(values.size() - width, 2 * width);
+        ThreadPool::the().run_in_parallel(merge_count, [&](size_t merge) {
+            auto less_than_copy = less_than;
+            auto start = merge * 2 * width;
+            Vector<T> buffer;
+            buffer.ensure_capacity(width);
+            AK::Detail::merge_adjacent_runs(values, start, start + width, min(start + 2 * width, values.size()), buffer, less_than_copy);
+        });
+    }
+}
+
+template<typename T, size_t inline_capacity, typename LessThan>
+void parallel_sort(Vector<T, inline_capacity>& values, LessThan less_than, size_t chunk_count = 0)
+{
+    parallel_sort(values.span(), move(less_than), chunk_count);
+}
+
+template<typename T, size_t inline_capacity>
+void parallel_sort(Vector<T, inline_capacity>& values)
+{
+    parallel_sort(values.span(), [](auto& a, auto& b) { return a < b; });
+}
+
+}
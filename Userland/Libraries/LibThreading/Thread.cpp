@@ -33,17 +33,18 @@ void Threading::Thread::start()
         nullptr,
         [](void* arg) -> void* {
             Thread* self = static_cast<Thread*>(arg);
+            // NOTE: The thread names itself, as a short-lived thread may already be gone by the time pthread_create() returns.
+            if (!self->m_thread_name.is_empty()) {
+                int rc = pthread_setname_np(pthread_self(), self->m_thread_name.characters());
+                VERIFY(rc == 0);
+            }
+            // NOTE: m_tid is left alone here, as the thread still has to be joined with it.
             auto exit_code = self->m_action();
-            self->m_tid = 0;
             return reinterpret_cast<void*>(exit_code);
         },
         static_cast<void*>(this));
 
     VERIFY(rc == 0);
-    if (!m_thread_name.is_empty()) {
-        rc = pthread_setname_np(m_tid, m_thread_name.characters());
-        VERIFY(rc == 0);
-    }
     dbgln("Started thread \"{}\", tid = {}", m_thread_name, m_tid);
 }
 
@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/String.h>
+#include <LibThreading/ThreadPool.h>
+#include <unistd.h>
+
+namespace Threading {
+
+// The pool and index of the worker running on the current thread, so that tasks submitted from a worker can be put
+// onto its own deque.
+static __thread ThreadPool* s_current_pool;
+static __thread size_t s_current_worker_index;
+
+ThreadPool& ThreadPool::the()
+{
+    static ThreadPool* s_the;
+    if (!s_the) {
+        auto processor_count = sysconf(_SC_NPROCESSORS_ONLN);
+        s_the = &ThreadPool::construct(processor_count > 1 ? static_cast<size_t>(processor_count) : 1).leak_ref();
+    }
+    return *s_the;
+}
+
+ThreadPool::ThreadPool(size_t worker_count)
+{
+    VERIFY(worker_count > 0);
+    for (size_t i = 0; i < worker_count; ++i) {
+        auto thread = Thread::construct([this, i] {
+            run_worker(i);
+            return 0;
+        },
+            String::formatted("Pool worker {}", i));
+        m_workers.append(make<Worker>(move(thread)));
+    }
+    // Only start the workers once they can all see each other.
+    for (auto& worker : m_workers)
+        worker.thread->start();
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        MutexLocker locker(m_mutex);
+        m_shutting_down = true;
+        m_task_available.broadcast();
+    }
+    for (auto& worker : m_workers)
+        (void)worker.thread->join();
+}
+
+void ThreadPool::submit(Function<void()> task, Priority priority)
+{
+    auto priority_index = to_underlying(priority);
+    if (s_current_pool == this) {
+        auto& worker = m_workers[s_current_worker_index];
+        MutexLocker locker(worker.mutex);
+        worker.deques[priority_index].append(move(task));
+    } else {
+        MutexLocker locker(m_mutex);
+        m_shared_queues[priority_index].enqueue(move(task));
+    }
+
+    // The count is only ever raised while holding the mutex, so a worker that is about to go to sleep can't miss it.
+    MutexLocker locker(m_mutex);
+    ++m_pending_task_count;
+    m_task_available.signal();
+}
+
+namespace {
+
+// Shared between the caller of run_in_parallel() and the helper tasks. A helper may only get to run after all chunks are
+// done and the caller has returned, so the last one of them to let go of it deletes it.
+struct ParallelRun {
+    ParallelRun(Function<void(size_t)> const& run_chunk, size_t chunk_count, size_t reference_count)
+        : run_chunk(run_chunk)
+        , chunk_count(chunk_count)
+        , unfinished_chunk_count(chunk_count)
+        , reference_count(reference_count)
+    {
+    }
+
+    void run_chunks()
+    {
+        while (true) {
+            auto index = next_chunk.fetch_add(1);
+            if (index >= chunk_count)
+                return;
+            run_chunk(index);
+            if (--unfinished_chunk_count == 0) {
+                MutexLocker locker(mutex);
+                all_chunks_done.broadcast();
+            }
+        }
+    }
+
+    void unref()
+    {
+        if (--reference_count == 0)
+            delete this;
+    }
+
+    Function<void(size_t)> const& run_chunk;
+    size_t const chunk_count;
+    Atomic<size_t> next_chunk { 0 };
+    Atomic<size_t> unfinished_chunk_count;
+    Atomic<size_t> reference_count;
+    Mutex mutex;
+    ConditionVariable all_chunks_done { mutex };
+};
+
+}
+
+void ThreadPool::run_in_parallel(size_t chunk_count, Function<void(size_t)> const& run_chunk)
+{
+    if (chunk_count <= 1 || worker_count() == 1) {
+        for (size_t i = 0; i < chunk_count; ++i)
+            run_chunk(i);
+        return;
+    }
+
+    auto helper_count = min(chunk_count - 1, worker_count());
+    auto* run = new ParallelRun(run_chunk, chunk_count, helper_count + 1);
+    // The caller is blocked until the chunks are done, so they go ahead of everything else.
+    for (size_t i = 0; i < helper_count; ++i) {
+        submit([run] {
+            run->run_chunks();
+            run->unref();
+        },
+            Priority::High);
+    }
+
+    // Chunks that haven't been picked up by a helper yet are run right here, so we only ever wait for chunks that are
+    // already running.
+    run->run_chunks();
+    {
+        MutexLocker locker(run->mutex);
+        run->all_chunks_done.wait_while([run] { return run->unfinished_chunk_count > 0; });
+    }
+    run->unref();
+}
+
+void ThreadPool::run_worker(size_t index)
+{
+    s_current_pool = this;
+    s_current_worker_index = index;
+
+    while (true) {
+        if (auto task = take_task(index); task.has_value()) {
+            (*task)();
+            continue;
+        }
+
+        MutexLocker locker(m_mutex);
+        m_task_available.wait_while([this] { return m_pending_task_count == 0 && !m_shutting_down; });
+        if (m_shutting_down)
+            return;
+    }
+}
+
+Optional<ThreadPool::Task> ThreadPool::take_task(size_t worker_index)
+{
+    for (size_t priority = 0; priority < priority_count; ++priority) {
+        if (auto task = take_task(worker_index, priority); task.has_value()) {
+            --m_pending_task_count;
+            return task;
+        }
+    }
+    return {};
+}
+
+Optional<ThreadPool::Task> ThreadPool::take_task(size_t worker_index, size_t priority)
+{
+    // Our own most recently submitted task is the one most likely to still have its data in the cache.
+    {
+        auto& worker = m_workers[worker_index];
+        MutexLocker locker(worker.mutex);
+        if (!worker.deques[priority].is_empty())
+            return worker.deques[priority].take_last();
+    }
+
+    {
+        MutexLocker locker(m_mutex);
+        if (!m_shared_queues[priority].is_empty())
+            return m_shared_queues[priority].dequeue();
+    }
+
+    // Steal the oldest task of another worker, since it's likely to spawn more work of its own.
+    for (size_t i = 1; i < m_workers.size(); ++i) {
+        auto& victim = m_workers[(worker_index + i) % m_workers.size()];
+        MutexLocker locker(victim.mutex);
+        if (!victim.deques[priority].is_empty())
+            return victim.deques[priority].take_first();
+    }
+
+    return {};
+}
+
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Array.h>
+#include <AK/Atomic.h>
+#include <AK/Function.h>
+#include <AK/NonnullOwnPtrVector.h>
+#include <AK/Queue.h>
+#include <AK/Vector.h>
+#include <LibCore/Object.h>
+#include <LibThreading/ConditionVariable.h>
+#include <LibThreading/Mutex.h>
+#include <LibThreading/Thread.h>
+
+namespace Threading {
+
+// A pool of worker threads, one per processor, that runs tasks in the background.
+//
+// Every worker has a deque of tasks for each priority. Tasks submitted from a worker go onto the back of its own deque,
+// and it takes them back from there, while tasks submitted from any other thread go into a shared queue and run in the
+// order they were submitted. A worker that runs out of tasks steals from the front of the other workers' deques.
+// Tasks of a higher priority always run first, but a running task is never interrupted.
+class ThreadPool final : public Core::Object {
+    C_OBJECT(ThreadPool);
+
+public:
+    enum class Priority {
+        High,
+        Normal,
+        Low,
+    };
+
+    static ThreadPool& the();
+
+    virtual ~ThreadPool() override;
+
+    size_t worker_count() const { return m_workers.size(); }
+
+    void submit(Function<void()>, Priority = Priority::Normal);
+
+    // Calls run_chunk(i) for every i in [0, chunk_count) on the pool, and returns once all of them are done. The calling
+    // thread runs chunks as well, so this can also be used from inside a task without tying up the pool.
+    void run_in_parallel(size_t chunk_count, Function<void(size_t)> const& run_chunk);
+
+private:
+    static constexpr size_t priority_count = 3;
+
+    using Task = Function<void()>;
+
+    struct Worker {
+        explicit Worker(NonnullRefPtr<Thread> thread)
+            : thread(move(thread))
+        {
+        }
+
+        NonnullRefPtr<Thread> thread;
+        Mutex mutex;
+        Array<Vector<Task>, priority_count> deques;
+    };
+
+    explicit ThreadPool(size_t worker_count);
+
+    void run_worker(size_t index);
+    Optional<Task> take_task(size_t worker_index);
+    Optional<Task> take_task(size_t worker_index, size_t priority);
+
+    NonnullOwnPtrVector<Worker> m_workers;
+
+    // Guards the shared queues and sleeping on m_task_available.
+    Mutex m_mutex;
+    ConditionVariable m_task_available { m_mutex };
+    Array<Queue<Task>, priority_count> m_shared_queues;
+    Atomic<size_t> m_pending_task_count { 0 };
+    bool m_shutting_down { false };
+};
+
+}
@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/AllOf.h>
 #include <AK/CharacterTypes.h>
 #include <AK/Platform.h>
 #include <AK/StringBuilder.h>
@@ -157,15 +158,26 @@ static bool is_followed_by_combining_dot_above(Utf8View const& string, size_t in
     return false;
 }
 
-static SpecialCasing const* find_matching_special_case(u32 code_point, Utf8View const& string, Optional<StringView> locale, size_t index, size_t byte_length)
+static Locale special_casing_locale(Optional<StringView> locale)
 {
-    auto requested_locale = Locale::None;
-
     if (locale.has_value()) {
         if (auto maybe_locale = locale_from_string(*locale); maybe_locale.has_value())
-            requested_locale = *maybe_locale;
+            return *maybe_locale;
     }
 
+    return Locale::None;
+}
+
+// Only some locales have special casings for ASCII code points, so ASCII text is otherwise mapped like it is in ASCII.
+static bool can_use_ascii_case_mapping(StringView string, Locale locale)
+{
+    if (locale != Locale::None)
+        return false;
+    return all_of(string.bytes(), [](u8 byte) { return is_ascii(byte); });
+}
+
+static SpecialCasing const* find_matching_special_case(u32 code_point, Utf8View const& string, Locale requested_locale, size_t index, size_t byte_length)
+{
     auto special_casings = special_case_mapping(code_point);
 
     for (auto const* special_casing : special_casings) {
@@ -221,6 +233,10 @@ u32 __attribute__((weak)) to_unicode_uppercase(u32 code_point)
 String to_unicode_lowercase_full(StringView string, [[maybe_unused]] Optional<StringView> locale)
 {
 #if ENABLE_UNICODE_DATA
+    auto requested_locale = special_casing_locale(locale);
+    if (can_use_ascii_case_mapping(string, requested_locale))
+        return string.to_lowercase_string();
+
     Utf8View view { string };
     StringBuilder builder;
 
@@ -231,7 +247,7 @@ String to_unicode_lowercase_full(StringView string, [[maybe_unused]] Optional<St
         u32 code_point = *it;
         byte_length = it.underlying_code_point_length_in_bytes();
 
-        auto const* special_casing = find_matching_special_case(code_point, view, locale, index, byte_length);
+        auto const* special_casing = find_matching_special_case(code_point, view, requested_locale, index, byte_length);
         if (!special_casing) {
             builder.append_code_point(to_unicode_lowercase(code_point));
             continue;
@@ -250,6 +266,10 @@ String to_unicode_lowercase_full(StringView string, [[maybe_unused]] Optional<St
 String to_unicode_uppercase_full(StringView string, [[maybe_unused]] Optional<StringView> locale)
 {
 #if ENABLE_UNICODE_DATA
+    auto requested_locale = special_casing_locale(locale);
+    if (can_use_ascii_case_mapping(string, requested_locale))
+        return string.to_uppercase_string();
+
     Utf8View view { string };
     StringBuilder builder;
 
@@ -260,7 +280,7 @@ String to_unicode_uppercase_full(StringView string, [[maybe_unused]] Optional<St
         u32 code_point = *it;
         byte_length = it.underlying_code_point_length_in_bytes();
 
-        auto const* special_casing = find_matching_special_case(code_point, view, locale, index, byte_length);
+        auto const* special_casing = find_matching_special_case(code_point, view, requested_locale, index, byte_length);
         if (!special_casing) {
             builder.append_code_point(to_unicode_uppercase(code_point));
             continue;
@@ -124,8 +124,8 @@ void Line::clear_range(size_t first_column, size_t last_column, const Attribute&
     VERIFY(last_column < m_cells.size());
     for (size_t i = first_column; i <= last_column; ++i) {
         auto& cell = m_cells[i];
-        if (!m_dirty)
-            m_dirty = cell.code_point != ' ' || cell.attribute != attribute;
+        if (cell.code_point != ' ' || cell.attribute != attribute)
+            set_dirty_columns(i, i);
         cell = Cell { .code_point = ' ', .attribute = attribute };
     }
 }
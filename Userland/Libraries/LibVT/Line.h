@@ -7,6 +7,7 @@
 #pragma once
 
 #include <AK/Noncopyable.h>
+#include <AK/NumericLimits.h>
 #include <AK/String.h>
 #include <AK/Vector.h>
 #include <LibVT/Attribute.h>
@@ -72,8 +73,28 @@ public:
         m_cells[index].code_point = code_point;
     }
 
-    bool is_dirty() const { return m_dirty; }
-    void set_dirty(bool b) { m_dirty = b; }
+    bool is_dirty() const { return m_first_dirty_column < m_end_of_dirty_columns; }
+    void set_dirty(bool b)
+    {
+        m_first_dirty_column = 0;
+        m_end_of_dirty_columns = b ? NumericLimits<u16>::max() : 0;
+    }
+
+    // Only marks the given columns as dirty, so they can be repainted without the rest of the line.
+    void set_dirty_columns(size_t first_column, size_t last_column)
+    {
+        if (!is_dirty()) {
+            m_first_dirty_column = first_column;
+            m_end_of_dirty_columns = last_column + 1;
+            return;
+        }
+        m_first_dirty_column = min<size_t>(m_first_dirty_column, first_column);
+        m_end_of_dirty_columns = max<size_t>(m_end_of_dirty_columns, last_column + 1);
+    }
+
+    size_t first_dirty_column() const { return m_first_dirty_column; }
+    // NOTE: This is past the end of the line if the whole line is dirty.
+    size_t end_of_dirty_columns() const { return m_end_of_dirty_columns; }
 
     Optional<u16> termination_column() const { return m_terminated_at; }
     void set_terminated(u16 column) { m_terminated_at = column; }
@@ -83,7 +104,8 @@ private:
     void push_cells_into_next_line(size_t new_length, Line* next_line, bool cursor_is_on_next_line, CursorPosition* cursor);
 
     Vector<Cell> m_cells;
-    bool m_dirty { false };
+    u16 m_first_dirty_column { 0 };
+    u16 m_end_of_dirty_columns { 0 };
     // Note: The alignment is 8, so this member lives in the padding (that already existed before it was introduced)
     [[no_unique_address]] Optional<u16> m_terminated_at;
 };
@@ -865,7 +865,7 @@ void Terminal::put_character_at(unsigned row, unsigned column, u32 code_point)
     line.set_code_point(column, code_point);
     line.attribute_at(column) = m_current_state.attribute;
     line.attribute_at(column).flags |= Attribute::Touched;
-    line.set_dirty(true);
+    line.set_dirty_columns(column, column);
 
     m_last_code_point = code_point;
 }
@@ -1636,7 +1636,7 @@ void Terminal::set_size(u16 columns, u16 rows)
 void Terminal::invalidate_cursor()
 {
     if (cursor_row() < active_buffer().size())
-        active_buffer()[cursor_row()].set_dirty(true);
+        active_buffer()[cursor_row()].set_dirty_columns(cursor_column(), cursor_column());
 }
 
 Attribute Terminal::attribute_at(const Position& position) const
@@ -92,7 +92,19 @@ TerminalWidget::TerminalWidget(int ptm_fd, bool automatic_size_policy)
     m_scrollbar = add<GUI::Scrollbar>(Orientation::Vertical);
     m_scrollbar->set_relative_rect(0, 0, 16, 0);
     m_scrollbar->on_change = [this](int) {
-        update();
+        // NOTE: When the scrollbar only moves along with new output, the lines that scrolled into view are dirty anyway.
+        if (!m_is_following_output)
+            update();
+    };
+
+    m_repaint_timer = add<Core::Timer>();
+    m_repaint_timer->set_single_shot(true);
+    m_repaint_timer->set_interval(minimum_repaint_interval_ms);
+    m_repaint_timer->on_timeout = [this] {
+        if (!m_has_pending_repaint)
+            return;
+        m_has_pending_repaint = false;
+        flush_dirty_lines();
     };
 
     m_cursor_blink_timer->set_interval(Config::read_i32("Terminal", "Text",
@@ -306,10 +318,25 @@ void TerminalWidget::paint_event(GUI::PaintEvent& event)
         }
     }
 
+    // Only the columns that the repainted rect touches are painted.
+    auto cell_width = font().glyph_width('x');
+    auto columns_origin = frame_thickness() + m_inset;
+    size_t first_column_in_rect = max(0, (event.rect().left() - columns_origin) / cell_width);
+    size_t end_of_columns_in_rect = max(0, (event.rect().right() - columns_origin) / cell_width + 1);
+
+    auto should_reverse_fill_for_cursor_or_selection = [&](u16 visual_row, size_t column) {
+        bool is_block_cursor = m_cursor_blink_state
+            && (m_cursor_style == VT::CursorStyle::SteadyBlock || m_cursor_style == VT::CursorStyle::BlinkingBlock)
+            && m_has_logical_focus
+            && visual_row == row_with_cursor
+            && column == m_terminal.cursor_column();
+        return is_block_cursor || selection_contains({ first_row_from_history + visual_row, (int)column });
+    };
+
     // Pass: Paint background & text decorations.
     for (u16 visual_row = 0; visual_row < m_terminal.rows(); ++visual_row) {
         auto row_rect = this->row_rect(visual_row);
-        if (!event.rect().contains(row_rect))
+        if (!event.rect().intersects(row_rect))
             continue;
         auto& line = m_terminal.line(first_row_from_history + visual_row);
         bool has_only_one_background_color = line.has_only_one_background_color();
@@ -318,24 +345,39 @@ void TerminalWidget::paint_event(GUI::PaintEvent& event)
         else if (has_only_one_background_color)
             painter.clear_rect(row_rect, terminal_color_to_rgb(line.attribute_at(0).effective_background_color()).with_alpha(m_opacity));
 
-        for (size_t column = 0; column < line.length(); ++column) {
-            bool should_reverse_fill_for_cursor_or_selection = m_cursor_blink_state
-                && (m_cursor_style == VT::CursorStyle::SteadyBlock || m_cursor_style == VT::CursorStyle::BlinkingBlock)
-                && m_has_logical_focus
-                && visual_row == row_with_cursor
-                && column == m_terminal.cursor_column();
-            should_reverse_fill_for_cursor_or_selection |= selection_contains({ first_row_from_history + visual_row, (int)column });
-            auto attribute = line.attribute_at(column);
-            auto character_rect = glyph_rect(visual_row, column);
-            auto cell_rect = character_rect.inflated(0, m_line_spacing);
-            auto text_color_before_bold_change = should_reverse_fill_for_cursor_or_selection ? attribute.effective_background_color() : attribute.effective_foreground_color();
-            auto text_color = terminal_color_to_rgb(m_show_bold_text_as_bright ? text_color_before_bold_change.to_bright() : text_color_before_bold_change);
-            if ((!visual_beep_active && !has_only_one_background_color) || should_reverse_fill_for_cursor_or_selection)
-                painter.clear_rect(cell_rect, terminal_color_to_rgb(should_reverse_fill_for_cursor_or_selection ? attribute.effective_foreground_color() : attribute.effective_background_color()));
+        // Neighboring cells with the same background are filled together.
+        Optional<Gfx::Color> run_color;
+        size_t run_start = 0;
+        auto fill_run = [&](size_t end_of_run) {
+            if (!run_color.has_value())
+                return;
+            auto run_rect = glyph_rect(visual_row, run_start).inflated(0, m_line_spacing);
+            run_rect.set_width((end_of_run - run_start) * cell_width);
+            painter.clear_rect(run_rect, *run_color);
+            run_color = {};
+        };
+
+        auto end_of_columns = min(line.length(), end_of_columns_in_rect);
+        for (size_t column = first_column_in_rect; column < end_of_columns; ++column) {
+            bool should_reverse_fill = should_reverse_fill_for_cursor_or_selection(visual_row, column);
+            auto const& attribute = line.attribute_at(column);
+
+            Optional<Gfx::Color> cell_color;
+            if ((!visual_beep_active && !has_only_one_background_color) || should_reverse_fill)
+                cell_color = terminal_color_to_rgb(should_reverse_fill ? attribute.effective_foreground_color() : attribute.effective_background_color());
+            if (cell_color != run_color) {
+                fill_run(column);
+                run_color = cell_color;
+                run_start = column;
+            }
+
+            auto cell_rect = glyph_rect(visual_row, column).inflated(0, m_line_spacing);
 
             if constexpr (TERMINAL_DEBUG) {
-                if (line.termination_column() == column)
+                if (line.termination_column() == column) {
+                    fill_run(column);
                     painter.clear_rect(cell_rect, Gfx::Color::Magenta);
+                }
             }
 
             enum class UnderlineStyle {
@@ -345,25 +387,30 @@ void TerminalWidget::paint_event(GUI::PaintEvent& event)
             };
 
             auto underline_style = UnderlineStyle::None;
-            auto underline_color = text_color;
-
             if (attribute.flags & VT::Attribute::Underline) {
                 // Content has specified underline
                 underline_style = UnderlineStyle::Solid;
             } else if (!attribute.href.is_empty()) {
                 // We're hovering a hyperlink
-                if (m_hovered_href_id == attribute.href_id || m_active_href_id == attribute.href_id) {
+                if (m_hovered_href_id == attribute.href_id || m_active_href_id == attribute.href_id)
                     underline_style = UnderlineStyle::Solid;
-                    underline_color = palette().active_link();
-                } else {
+                else
                     underline_style = UnderlineStyle::Dotted;
-                    underline_color = text_color.darkened(0.6f);
-                }
             }
+            if (underline_style == UnderlineStyle::None)
+                continue;
+
+            // The underline goes on top of the background, so that has to be painted first.
+            fill_run(column + 1);
+
+            auto text_color_before_bold_change = should_reverse_fill ? attribute.effective_background_color() : attribute.effective_foreground_color();
+            auto text_color = terminal_color_to_rgb(m_show_bold_text_as_bright ? text_color_before_bold_change.to_bright() : text_color_before_bold_change);
 
             if (underline_style == UnderlineStyle::Solid) {
+                auto underline_color = attribute.flags & VT::Attribute::Underline ? text_color : palette().active_link();
                 painter.draw_line(cell_rect.bottom_left(), cell_rect.bottom_right(), underline_color);
             } else if (underline_style == UnderlineStyle::Dotted) {
+                auto underline_color = text_color.darkened(0.6f);
                 int x1 = cell_rect.bottom_left().x();
                 int x2 = cell_rect.bottom_right().x();
                 int y = cell_rect.bottom_left().y();
@@ -373,6 +420,7 @@ void TerminalWidget::paint_event(GUI::PaintEvent& event)
                 }
             }
         }
+        fill_run(end_of_columns);
     }
 
     // Paint the hovered link rects, if any.
@@ -388,35 +436,37 @@ void TerminalWidget::paint_event(GUI::PaintEvent& event)
     // Pass: Paint foreground (text).
     for (u16 visual_row = 0; visual_row < m_terminal.rows(); ++visual_row) {
         auto row_rect = this->row_rect(visual_row);
-        if (!event.rect().contains(row_rect))
+        if (!event.rect().intersects(row_rect))
             continue;
         auto& line = m_terminal.line(first_row_from_history + visual_row);
-        for (size_t column = 0; column < line.length(); ++column) {
-            auto attribute = line.attribute_at(column);
-            bool should_reverse_fill_for_cursor_or_selection = m_cursor_blink_state
-                && (m_cursor_style == VT::CursorStyle::SteadyBlock || m_cursor_style == VT::CursorStyle::BlinkingBlock)
-                && m_has_logical_focus
-                && visual_row == row_with_cursor
-                && column == m_terminal.cursor_column();
-            should_reverse_fill_for_cursor_or_selection |= selection_contains({ first_row_from_history + visual_row, (int)column });
-            auto text_color_before_bold_change = should_reverse_fill_for_cursor_or_selection ? attribute.effective_background_color() : attribute.effective_foreground_color();
-            auto text_color = terminal_color_to_rgb(m_show_bold_text_as_bright ? text_color_before_bold_change.to_bright() : text_color_before_bold_change);
-            u32 code_point = line.code_point(column);
 
+        // Some glyphs (like emoji) are wider than their cell, so the one in the column before the rect is painted too.
+        auto first_column = first_column_in_rect > 0 ? first_column_in_rect - 1 : 0;
+        auto end_of_columns = min(line.length(), end_of_columns_in_rect);
+
+        // The font and color only change between runs of cells with the same attributes, so they're only looked up once per run.
+        Optional<VT::Attribute> run_attribute;
+        bool run_is_reverse_filled = false;
+        Gfx::Font const* run_font = nullptr;
+        Gfx::Color run_text_color;
+        for (size_t column = first_column; column < end_of_columns; ++column) {
+            u32 code_point = line.code_point(column);
             if (code_point == ' ')
                 continue;
 
-            auto character_rect = glyph_rect(visual_row, column);
-
-            if (!m_hovered_href_id.is_null() && attribute.href_id == m_hovered_href_id) {
-                text_color = palette().base_text();
+            auto const& attribute = line.attribute_at(column);
+            bool should_reverse_fill = should_reverse_fill_for_cursor_or_selection(visual_row, column);
+            if (!run_attribute.has_value() || *run_attribute != attribute || run_attribute->href_id != attribute.href_id || run_is_reverse_filled != should_reverse_fill) {
+                run_attribute = attribute;
+                run_is_reverse_filled = should_reverse_fill;
+                run_font = attribute.flags & VT::Attribute::Bold ? &bold_font : &font;
+                auto text_color_before_bold_change = should_reverse_fill ? attribute.effective_background_color() : attribute.effective_foreground_color();
+                run_text_color = terminal_color_to_rgb(m_show_bold_text_as_bright ? text_color_before_bold_change.to_bright() : text_color_before_bold_change);
+                if (!m_hovered_href_id.is_null() && attribute.href_id == m_hovered_href_id)
+                    run_text_color = palette().base_text();
             }
 
-            painter.draw_glyph_or_emoji(
-                character_rect.location(),
-                code_point,
-                attribute.flags & VT::Attribute::Bold ? bold_font : font,
-                text_color);
+            painter.draw_glyph_or_emoji(glyph_rect(visual_row, column).location(), code_point, *run_font, run_text_color);
         }
     }
 
@@ -476,20 +526,45 @@ void TerminalWidget::invalidate_cursor()
 
 void TerminalWidget::flush_dirty_lines()
 {
+    // Output can arrive much faster than it could be shown. After a repaint, the next one waits for the repaint timer, so
+    // all the output in between is shown at once, and the scroll positions it went through are never painted.
+    if (m_repaint_timer->is_active()) {
+        m_has_pending_repaint = true;
+        return;
+    }
+    m_repaint_timer->start();
+
     // FIXME: Update smarter when scrolled
     if (m_terminal.m_need_full_flush || m_scrollbar->value() != m_scrollbar->max()) {
         update();
         m_terminal.m_need_full_flush = false;
         return;
     }
+
+    // Only the dirty columns of each line are repainted. Lines after each other with the same dirty columns
+    // (like all the ones that just scrolled) are repainted together.
+    auto cell_width = font().glyph_width('x');
     Gfx::IntRect rect;
     for (int i = 0; i < m_terminal.rows(); ++i) {
-        if (m_terminal.visible_line(i).is_dirty()) {
-            rect = rect.united(row_rect(i));
-            m_terminal.visible_line(i).set_dirty(false);
+        auto& line = m_terminal.visible_line(i);
+        if (!line.is_dirty())
+            continue;
+        auto dirty_rect = row_rect(i);
+        auto end_of_dirty_columns = min(line.end_of_dirty_columns(), static_cast<size_t>(m_terminal.columns()));
+        dirty_rect.set_x(dirty_rect.x() + line.first_dirty_column() * cell_width);
+        dirty_rect.set_width((end_of_dirty_columns - min(line.first_dirty_column(), end_of_dirty_columns)) * cell_width);
+        line.set_dirty(false);
+
+        if (!rect.is_empty() && rect.left() == dirty_rect.left() && rect.right() == dirty_rect.right() && rect.bottom() + 1 >= dirty_rect.top()) {
+            rect = rect.united(dirty_rect);
+            continue;
         }
+        if (!rect.is_empty())
+            update(rect);
+        rect = dirty_rect;
     }
-    update(rect);
+    if (!rect.is_empty())
+        update(rect);
 }
 
 void TerminalWidget::resize_event(GUI::ResizeEvent& event)
@@ -974,6 +1049,7 @@ int TerminalWidget::last_selection_column_on_row(int row) const
 void TerminalWidget::terminal_history_changed(int delta)
 {
     bool was_max = m_scrollbar->value() == m_scrollbar->max();
+    TemporaryChange following_output_change(m_is_following_output, was_max);
     m_scrollbar->set_max(m_terminal.history_size());
     if (was_max)
         m_scrollbar->set_value(m_scrollbar->max());
@@ -186,6 +186,7 @@ private:
 
     bool m_has_logical_focus { false };
     bool m_in_relayout { false };
+    bool m_is_following_output { false };
 
     RefPtr<Core::Notifier> m_notifier;
 
@@ -209,6 +210,11 @@ private:
     RefPtr<Core::Timer> m_visual_beep_timer;
     RefPtr<Core::Timer> m_auto_scroll_timer;
 
+    // About 60 repaints per second, at most.
+    static constexpr int minimum_repaint_interval_ms = 16;
+    RefPtr<Core::Timer> m_repaint_timer;
+    bool m_has_pending_repaint { false };
+
     RefPtr<GUI::Scrollbar> m_scrollbar;
 
     RefPtr<GUI::Action> m_copy_action;
@@ -159,12 +159,15 @@ bool Decoder::predict_intra(size_t, u32, u32, bool, bool, bool, TXSize, u32)
 bool Decoder::predict_inter(size_t, u32, u32, u32, u32, u32)
 {
     // TODO: Implement
+    //       The 8-tap sub-pixel interpolation filters work on whole rows of pixels, and are a good fit for AK/SIMD.h.
     return true;
 }
 
 bool Decoder::reconstruct(size_t, u32, u32, TXSize)
 {
     // TODO: Implement
+    //       The inverse DCT and ADST butterflies operate on a whole row (or column) of coefficients at once, and are a
+    //       good fit for AK/SIMD.h.
     return true;
 }
 
@@ -753,6 +753,9 @@ bool Parser::decode_tiles()
     auto tile_rows = 1 << m_tile_rows_log2;
     allocate_tile_data();
     SAFE_CALL(clear_above_context());
+    // FIXME: Tile columns within a tile row don't depend on each other, and could be decoded concurrently.
+    //        For that, the bit stream, the left contexts, the syntax element counts and the per-block state that is
+    //        currently kept in the Parser itself would need to be split out into a context per tile.
     for (auto tile_row = 0; tile_row < tile_rows; tile_row++) {
         for (auto tile_col = 0; tile_col < tile_cols; tile_col++) {
             auto last_tile = (tile_row == tile_rows - 1) && (tile_col == tile_cols - 1);
@@ -11,6 +11,7 @@
 #include <AK/HashTable.h>
 #include <AK/OwnPtr.h>
 #include <AK/Result.h>
+#include <LibWasm/AbstractMachine/PredecodedExpression.h>
 #include <LibWasm/Types.h>
 
 namespace Wasm {
@@ -264,17 +265,21 @@ public:
         : m_type(type)
         , m_module(module)
         , m_code(code)
+        , m_predecoded_body(make<PredecodedExpression>(PredecodedExpression::predecode(code.body())))
     {
     }
 
     auto& type() const { return m_type; }
     auto& module() const { return m_module; }
     auto& code() const { return m_code; }
+    auto& predecoded_body() const { return *m_predecoded_body; }
 
 private:
     FunctionType m_type;
     ModuleInstance const& m_module;
     Module::Function const& m_code;
+    // NOTE: This is heap-allocated so frames can keep pointing to it when the store moves its functions around.
+    NonnullOwnPtr<PredecodedExpression> m_predecoded_body;
 };
 
 class HostFunction {
@@ -355,6 +360,14 @@ public:
                 return false;
         }
         auto previous_size = m_size;
+        if (new_size > m_data.capacity()) {
+            // Grow the capacity geometrically (up to the limit of the memory), so that a module growing its memory a page
+            // at a time doesn't have the whole memory copied over on every grow.
+            u64 new_capacity = max(new_size, static_cast<u64>(m_data.capacity()) * 2);
+            new_capacity = min(new_capacity, max_size());
+            if (m_data.try_ensure_capacity(new_capacity).is_error() && m_data.try_ensure_capacity(new_size).is_error())
+                return false;
+        }
         if (m_data.try_resize(new_size).is_error())
             return false;
         m_size = new_size;
@@ -364,6 +377,14 @@ public:
     }
 
 private:
+    u64 max_size() const
+    {
+        u64 max_pages = 65535;
+        if (auto max = m_type.limits().max(); max.has_value())
+            max_pages = min(max_pages, static_cast<u64>(max.value()));
+        return max_pages * Constants::page_size;
+    }
+
     MemoryType const& m_type;
     size_t m_size { 0 };
     ByteBuffer m_data;
@@ -469,10 +490,11 @@ private:
 
 class Frame {
 public:
-    explicit Frame(ModuleInstance const& module, Vector<Value> locals, Expression const& expression, size_t arity)
+    explicit Frame(ModuleInstance const& module, Vector<Value> locals, Expression const& expression, size_t arity, PredecodedExpression const* predecoded_expression = nullptr)
         : m_module(module)
         , m_locals(move(locals))
         , m_expression(expression)
+        , m_predecoded_expression(predecoded_expression)
         , m_arity(arity)
     {
     }
@@ -481,12 +503,14 @@ public:
     auto& locals() const { return m_locals; }
     auto& locals() { return m_locals; }
     auto& expression() const { return m_expression; }
+    auto predecoded_expression() const { return m_predecoded_expression; }
     auto arity() const { return m_arity; }
 
 private:
     ModuleInstance const& m_module;
     Vector<Value> m_locals;
     Expression const& m_expression;
+    PredecodedExpression const* m_predecoded_expression { nullptr };
     size_t m_arity { 0 };
 };
 
@@ -32,6 +32,17 @@ namespace Wasm {
 void BytecodeInterpreter::interpret(Configuration& configuration)
 {
     m_trap.clear();
+    if constexpr (!WASM_TRACE_DEBUG) {
+        if (auto* predecoded_expression = configuration.frame().predecoded_expression()) {
+            interpret_predecoded(configuration, *predecoded_expression);
+            return;
+        }
+    }
+    interpret_instruction_by_instruction(configuration);
+}
+
+void BytecodeInterpreter::interpret_instruction_by_instruction(Configuration& configuration)
+{
     auto& instructions = configuration.frame().expression().instructions();
     auto max_ip_value = InstructionPointer { instructions.size() };
     auto& current_ip_value = configuration.ip();
@@ -55,11 +66,179 @@ void BytecodeInterpreter::interpret(Configuration& configuration)
     }
 }
 
+template<typename PopType, typename PushType, typename Operator>
+ALWAYS_INLINE static void binary_numeric_operation_with_local_operand(Configuration& configuration, Value& local)
+{
+    auto& lhs_entry = configuration.stack().peek();
+    auto lhs = lhs_entry.get<Value>().to<PopType>();
+    auto rhs = local.to<PopType>();
+    PushType result = Operator {}(lhs.value(), rhs.value());
+    lhs_entry = Value(result);
+}
+
+// Runs the predecoded form of the current function, jumping straight from one operation to the next through a table
+// of label addresses instead of going back through a loop and a switch. Whatever doesn't have its own operation is
+// handed to the generic implementation.
+void BytecodeInterpreter::interpret_predecoded(Configuration& configuration, PredecodedExpression const& expression)
+{
+    static void* const s_dispatch_table[] = {
+#define M(name) &&handle_##name,
+        ENUMERATE_PREDECODED_OPERATIONS(M)
+#undef M
+#define M(name, ...) &&handle_##name, &&handle_##name##_local,
+            ENUMERATE_PREDECODED_BINARY_OPERATIONS(M)
+#undef M
+    };
+
+    auto& instructions = expression.instructions();
+    auto& stack = configuration.stack();
+    // NOTE: The locals live in their own allocation, which stays put even when the stack (and the frame on it) moves.
+    auto* locals = configuration.frame().locals().data();
+    auto const should_limit_instruction_count = configuration.should_limit_instruction_count();
+    u64 executed_instructions = 0;
+    size_t ip = configuration.ip().value();
+    PredecodedInstruction const* instruction = nullptr;
+
+#define DISPATCH(instructions_to_skip)                                                                                  \
+    do {                                                                                                                \
+        ip += instructions_to_skip;                                                                                     \
+        goto dispatch;                                                                                                  \
+    } while (false)
+
+dispatch:
+    if (ip >= instructions.size()) {
+        configuration.ip() = ip;
+        return;
+    }
+    instruction = &instructions[ip];
+    if (should_limit_instruction_count) {
+        if (executed_instructions++ >= Constants::max_allowed_executed_instructions_per_call) [[unlikely]] {
+            m_trap = Trap { "Exceeded maximum allowed number of instructions" };
+            return;
+        }
+    }
+    goto* s_dispatch_table[to_underlying(instruction->operation)];
+
+handle_generic : {
+    configuration.ip() = ip;
+    BytecodeInterpreter::interpret(configuration, configuration.ip(), *instruction->instruction);
+    if (m_trap.has_value())
+        return;
+    goto after_jump;
+}
+after_jump:
+    // Just like interpret_instruction_by_instruction(), a jump to the instruction itself counts as no jump.
+    if (configuration.ip() == ip)
+        DISPATCH(1);
+    ip = configuration.ip().value();
+    DISPATCH(0);
+
+handle_nop:
+    DISPATCH(1);
+handle_drop:
+    stack.pop();
+    DISPATCH(1);
+handle_local_get:
+    stack.push(Value(locals[instruction->index]));
+    DISPATCH(1);
+handle_local_set : {
+    auto entry = stack.pop();
+    locals[instruction->index] = move(entry.get<Value>());
+    DISPATCH(1);
+}
+handle_local_tee:
+    locals[instruction->index] = stack.peek().get<Value>();
+    DISPATCH(1);
+handle_i32_const:
+    stack.push(Value(bit_cast<i32>(static_cast<u32>(instruction->value))));
+    DISPATCH(1);
+handle_i64_const:
+    stack.push(Value(bit_cast<i64>(instruction->value)));
+    DISPATCH(1);
+handle_i32_eqz:
+    unary_operation<i32, i32, Operators::EqualsZero>(configuration);
+    DISPATCH(1);
+handle_i64_eqz:
+    unary_operation<i64, i32, Operators::EqualsZero>(configuration);
+    DISPATCH(1);
+handle_block:
+    stack.push(Label(instruction->index, instruction->value));
+    DISPATCH(1);
+handle_loop:
+    stack.push(Label(instruction->index, instruction->value));
+    DISPATCH(1);
+handle_if_ : {
+    auto entry = stack.pop();
+    auto& args = instruction->instruction->arguments().get<Instruction::StructuredInstructionArgs>();
+    if (entry.get<Value>().to<i32>().value() != 0) {
+        stack.push(Label(instruction->index, instruction->value));
+        DISPATCH(1);
+    }
+    if (args.else_ip.has_value()) {
+        stack.push(Label(instruction->index, instruction->value));
+        ip = args.else_ip->value();
+        DISPATCH(0);
+    }
+    ip = args.end_ip.value() + 1;
+    DISPATCH(0);
+}
+handle_structured_else : {
+    auto index = configuration.nth_label_index(0);
+    ip = stack.entries()[*index].get<Label>().continuation().value();
+    stack.entries().remove(*index, 1);
+    DISPATCH(0);
+}
+handle_structured_end : {
+    auto index = configuration.nth_label_index(0);
+    stack.entries().remove(*index, 1);
+    DISPATCH(1);
+}
+handle_br:
+    configuration.ip() = ip;
+    branch_to_label(configuration, instruction->index);
+    goto after_jump;
+handle_br_if : {
+    auto entry = stack.pop();
+    if (entry.get<Value>().to<i32>().value_or(0) == 0)
+        DISPATCH(1);
+    configuration.ip() = ip;
+    branch_to_label(configuration, instruction->index);
+    goto after_jump;
+}
+
+#define M(name, PopType, PushType, Operator)                                                                  \
+    handle_##name:                                                                                            \
+    binary_numeric_operation<PopType, PushType, Operator>(configuration);                                     \
+    DISPATCH(1);                                                                                              \
+    handle_##name##_local:                                                                                    \
+    /* This stands in for the local.get and the operation after it. */                                        \
+    executed_instructions++;                                                                                  \
+    binary_numeric_operation_with_local_operand<PopType, PushType, Operator>(configuration, locals[instruction->index]); \
+    DISPATCH(2);
+    ENUMERATE_PREDECODED_BINARY_OPERATIONS(M)
+#undef M
+
+#undef DISPATCH
+}
+
 void BytecodeInterpreter::branch_to_label(Configuration& configuration, LabelIndex index)
 {
     dbgln_if(WASM_TRACE_DEBUG, "Branch to label with index {}...", index.value());
-    auto label = configuration.nth_label(index.value());
+    auto label_index = configuration.nth_label_index(index.value());
+    Optional<Label> label = configuration.stack().entries()[*label_index].get<Label>();
     dbgln_if(WASM_TRACE_DEBUG, "...which is actually IP {}, and has {} result(s)", label->continuation().value(), label->arity());
+
+    if (label->arity() <= 1) {
+        // Everything between the label and the result (if any) goes away, which doesn't need the result to be set aside.
+        auto& entries = configuration.stack().entries();
+        auto first_to_remove = *label_index + 1;
+        auto last_to_remove = entries.size() - label->arity();
+        if (last_to_remove > first_to_remove)
+            entries.remove(first_to_remove, last_to_remove - first_to_remove);
+        configuration.ip() = label->continuation();
+        return;
+    }
+
     auto results = pop_values(configuration, label->arity());
 
     size_t drop_count = index.value() + 1;
@@ -94,10 +273,9 @@ void BytecodeInterpreter::load_and_push(Configuration& configuration, Instructio
         m_trap = Trap { "Memory access out of bounds" };
         return;
     }
+    // NOTE: Both the base and the offset are 32-bit, so this can't overflow.
     u64 instance_address = static_cast<u64>(bit_cast<u32>(base.value())) + arg.offset;
-    Checked addition { instance_address };
-    addition += sizeof(ReadType);
-    if (addition.has_overflow() || addition.value() > memory->size()) {
+    if (instance_address + sizeof(ReadType) > memory->size()) [[unlikely]] {
         m_trap = Trap { "Memory access out of bounds" };
         dbgln("LibWasm: Memory access out of bounds (expected {} to be less than or equal to {})", instance_address + sizeof(ReadType), memory->size());
         return;
@@ -237,10 +415,9 @@ void BytecodeInterpreter::store_to_memory(Configuration& configuration, Instruct
     auto& address = configuration.frame().module().memories().first();
     auto memory = configuration.store().get(address);
     auto& arg = instruction.arguments().get<Instruction::MemoryArgument>();
+    // NOTE: Both the base and the offset are 32-bit, so this can't overflow.
     u64 instance_address = static_cast<u64>(bit_cast<u32>(base)) + arg.offset;
-    Checked addition { instance_address };
-    addition += data.size();
-    if (addition.has_overflow() || addition.value() > memory->size()) {
+    if (instance_address + data.size() > memory->size()) [[unlikely]] {
         m_trap = Trap { "Memory access out of bounds" };
         dbgln("LibWasm: Memory access out of bounds (expected 0 <= {} and {} <= {})", instance_address, instance_address + data.size(), memory->size());
         return;
@@ -963,6 +1140,13 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
     }
 }
 
+void DebuggerBytecodeInterpreter::interpret(Configuration& configuration)
+{
+    // The hooks need to see every instruction, so the predecoded form is never used here.
+    m_trap.clear();
+    interpret_instruction_by_instruction(configuration);
+}
+
 void DebuggerBytecodeInterpreter::interpret(Configuration& configuration, InstructionPointer& ip, Instruction const& instruction)
 {
     if (pre_interpret_hook) {
@@ -33,6 +33,8 @@ struct BytecodeInterpreter : public Interpreter {
     };
 
 protected:
+    void interpret_instruction_by_instruction(Configuration&);
+    void interpret_predecoded(Configuration&, PredecodedExpression const&);
     virtual void interpret(Configuration&, InstructionPointer&, Instruction const&);
     void branch_to_label(Configuration&, LabelIndex);
     template<typename ReadT, typename PushT>
@@ -70,6 +72,7 @@ protected:
 };
 
 struct DebuggerBytecodeInterpreter : public BytecodeInterpreter {
+    virtual void interpret(Configuration&) override;
     virtual ~DebuggerBytecodeInterpreter() override = default;
 
     Function<bool(Configuration&, InstructionPointer&, Instruction const&)> pre_interpret_hook;
@@ -52,6 +52,7 @@ Result Configuration::call(Interpreter& interpreter, FunctionAddress address, Ve
             move(locals),
             wasm_function->code().body(),
             wasm_function->type().results().size(),
+            &wasm_function->predecoded_body(),
         });
         m_ip = 0;
         return execute(interpreter);
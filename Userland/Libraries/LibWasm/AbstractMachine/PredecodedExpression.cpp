@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibWasm/AbstractMachine/PredecodedExpression.h>
+#include <LibWasm/Opcode.h>
+
+namespace Wasm {
+
+using Operation = PredecodedInstruction::Operation;
+
+static Optional<Operation> binary_operation(OpCode opcode)
+{
+    switch (opcode.value()) {
+#define M(name, ...)                 \
+    case Instructions::name.value(): \
+        return Operation::name;
+        ENUMERATE_PREDECODED_BINARY_OPERATIONS(M)
+#undef M
+    default:
+        return {};
+    }
+}
+
+static Operation with_local_operand(Operation operation)
+{
+    // Every binary operation is immediately followed by its variant that reads the right hand side from a local.
+    return static_cast<Operation>(to_underlying(operation) + 1);
+}
+
+// Blocks whose type is an index may take parameters, and the arity of their label depends on the module's types.
+// Those are left to the generic implementation.
+static Optional<u32> label_arity(BlockType const& block_type)
+{
+    switch (block_type.kind()) {
+    case BlockType::Empty:
+        return 0;
+    case BlockType::Type:
+        return 1;
+    case BlockType::Index:
+        return {};
+    }
+    VERIFY_NOT_REACHED();
+}
+
+PredecodedExpression PredecodedExpression::predecode(Expression const& expression)
+{
+    auto& instructions = expression.instructions();
+    Vector<PredecodedInstruction> predecoded;
+    predecoded.ensure_capacity(instructions.size());
+
+    for (size_t ip = 0; ip < instructions.size(); ++ip) {
+        auto& instruction = instructions[ip];
+        PredecodedInstruction result { Operation::generic, 0, 0, &instruction };
+
+        switch (instruction.opcode().value()) {
+        case Instructions::nop.value():
+            result.operation = Operation::nop;
+            break;
+        case Instructions::drop.value():
+            result.operation = Operation::drop;
+            break;
+        case Instructions::local_get.value(): {
+            result.index = instruction.arguments().get<LocalIndex>().value();
+            result.operation = Operation::local_get;
+            if (ip + 1 < instructions.size()) {
+                if (auto operation = binary_operation(instructions[ip + 1].opcode()); operation.has_value())
+                    result.operation = with_local_operand(*operation);
+            }
+            break;
+        }
+        case Instructions::local_set.value():
+            result.operation = Operation::local_set;
+            result.index = instruction.arguments().get<LocalIndex>().value();
+            break;
+        case Instructions::local_tee.value():
+            result.operation = Operation::local_tee;
+            result.index = instruction.arguments().get<LocalIndex>().value();
+            break;
+        case Instructions::i32_const.value():
+            result.operation = Operation::i32_const;
+            result.value = bit_cast<u32>(instruction.arguments().get<i32>());
+            break;
+        case Instructions::i64_const.value():
+            result.operation = Operation::i64_const;
+            result.value = bit_cast<u64>(instruction.arguments().get<i64>());
+            break;
+        case Instructions::i32_eqz.value():
+            result.operation = Operation::i32_eqz;
+            break;
+        case Instructions::i64_eqz.value():
+            result.operation = Operation::i64_eqz;
+            break;
+        case Instructions::block.value():
+        case Instructions::loop.value():
+        case Instructions::if_.value(): {
+            auto& args = instruction.arguments().get<Instruction::StructuredInstructionArgs>();
+            auto arity = label_arity(args.block_type);
+            if (!arity.has_value())
+                break;
+            result.index = *arity;
+            if (instruction.opcode() == Instructions::block) {
+                result.operation = Operation::block;
+                result.value = args.end_ip.value();
+            } else if (instruction.opcode() == Instructions::loop) {
+                result.operation = Operation::loop;
+                result.value = ip + 1;
+            } else {
+                result.operation = Operation::if_;
+                result.value = args.end_ip.value();
+            }
+            break;
+        }
+        case Instructions::structured_else.value():
+            result.operation = Operation::structured_else;
+            break;
+        case Instructions::structured_end.value():
+            result.operation = Operation::structured_end;
+            break;
+        case Instructions::br.value():
+            result.operation = Operation::br;
+            result.index = instruction.arguments().get<LabelIndex>().value();
+            break;
+        case Instructions::br_if.value():
+            result.operation = Operation::br_if;
+            result.index = instruction.arguments().get<LabelIndex>().value();
+            break;
+        default:
+            if (auto operation = binary_operation(instruction.opcode()); operation.has_value())
+                result.operation = *operation;
+            break;
+        }
+
+        predecoded.unchecked_append(result);
+    }
+
+    return PredecodedExpression { move(predecoded) };
+}
+
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Vector.h>
+#include <LibWasm/Types.h>
+
+namespace Wasm {
+
+// Binary operations that can't trap, as (name, pop type, push type, operator).
+// Each of them also gets a variant that takes its right hand side from a local, replacing a preceding local.get.
+#define ENUMERATE_PREDECODED_BINARY_OPERATIONS(M)            \
+    M(i32_eq, i32, i32, Operators::Equals)                   \
+    M(i32_ne, i32, i32, Operators::NotEquals)                \
+    M(i32_lts, i32, i32, Operators::LessThan)                \
+    M(i32_ltu, u32, i32, Operators::LessThan)                \
+    M(i32_gts, i32, i32, Operators::GreaterThan)             \
+    M(i32_gtu, u32, i32, Operators::GreaterThan)             \
+    M(i32_les, i32, i32, Operators::LessThanOrEquals)        \
+    M(i32_leu, u32, i32, Operators::LessThanOrEquals)        \
+    M(i32_ges, i32, i32, Operators::GreaterThanOrEquals)     \
+    M(i32_geu, u32, i32, Operators::GreaterThanOrEquals)     \
+    M(i64_eq, i64, i32, Operators::Equals)                   \
+    M(i64_ne, i64, i32, Operators::NotEquals)                \
+    M(i64_lts, i64, i32, Operators::LessThan)                \
+    M(i64_ltu, u64, i32, Operators::LessThan)                \
+    M(i64_gts, i64, i32, Operators::GreaterThan)             \
+    M(i64_gtu, u64, i32, Operators::GreaterThan)             \
+    M(i64_les, i64, i32, Operators::LessThanOrEquals)        \
+    M(i64_leu, u64, i32, Operators::LessThanOrEquals)        \
+    M(i64_ges, i64, i32, Operators::GreaterThanOrEquals)     \
+    M(i64_geu, u64, i32, Operators::GreaterThanOrEquals)     \
+    M(i32_add, u32, i32, Operators::Add)                     \
+    M(i32_sub, u32, i32, Operators::Subtract)                \
+    M(i32_mul, u32, i32, Operators::Multiply)                \
+    M(i32_and, i32, i32, Operators::BitAnd)                  \
+    M(i32_or, i32, i32, Operators::BitOr)                    \
+    M(i32_xor, i32, i32, Operators::BitXor)                  \
+    M(i32_shl, u32, i32, Operators::BitShiftLeft)            \
+    M(i32_shrs, i32, i32, Operators::BitShiftRight)          \
+    M(i32_shru, u32, i32, Operators::BitShiftRight)          \
+    M(i64_add, u64, i64, Operators::Add)                     \
+    M(i64_sub, u64, i64, Operators::Subtract)                \
+    M(i64_mul, u64, i64, Operators::Multiply)                \
+    M(i64_and, i64, i64, Operators::BitAnd)                  \
+    M(i64_or, i64, i64, Operators::BitOr)                    \
+    M(i64_xor, i64, i64, Operators::BitXor)                  \
+    M(i64_shl, u64, i64, Operators::BitShiftLeft)            \
+    M(i64_shrs, i64, i64, Operators::BitShiftRight)          \
+    M(i64_shru, u64, i64, Operators::BitShiftRight)
+
+#define ENUMERATE_PREDECODED_OPERATIONS(M) \
+    M(generic)                             \
+    M(nop)                                 \
+    M(drop)                                \
+    M(local_get)                           \
+    M(local_set)                           \
+    M(local_tee)                           \
+    M(i32_const)                           \
+    M(i64_const)                           \
+    M(i32_eqz)                             \
+    M(i64_eqz)                             \
+    M(block)                               \
+    M(loop)                                \
+    M(if_)                                 \
+    M(structured_else)                     \
+    M(structured_end)                      \
+    M(br)                                  \
+    M(br_if)
+
+// An instruction with its arguments taken out of the Instruction variant, and the arity of any label it pushes
+// worked out ahead of time. Anything without a dedicated operation is "generic", and runs the original instruction.
+struct PredecodedInstruction {
+    enum class Operation : u8 {
+#define M(name) name,
+        ENUMERATE_PREDECODED_OPERATIONS(M)
+#undef M
+#define M(name, ...) name, name##_local,
+        ENUMERATE_PREDECODED_BINARY_OPERATIONS(M)
+#undef M
+    };
+
+    Operation operation { Operation::generic };
+    u32 index { 0 }; // Local index, label index, or arity of the pushed label.
+    u64 value { 0 }; // Constant, or continuation of the pushed label.
+    Instruction const* instruction { nullptr };
+};
+
+// A function body lowered into a form that the BytecodeInterpreter can dispatch on directly. There is exactly one
+// predecoded instruction per original instruction, so instruction pointers (and branch targets) are the same in both.
+// A local.get that is fused into the operation after it skips over that operation, which is never a branch target.
+class PredecodedExpression {
+public:
+    static PredecodedExpression predecode(Expression const&);
+
+    auto& instructions() const { return m_instructions; }
+
+private:
+    explicit PredecodedExpression(Vector<PredecodedInstruction> instructions)
+        : m_instructions(move(instructions))
+    {
+    }
+
+    Vector<PredecodedInstruction> m_instructions;
+};
+
+}
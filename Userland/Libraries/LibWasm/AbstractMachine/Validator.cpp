@@ -4,10 +4,14 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Atomic.h>
 #include <AK/HashTable.h>
+#include <AK/NumericLimits.h>
 #include <AK/Result.h>
 #include <AK/SourceLocation.h>
 #include <AK/Try.h>
+#include <LibThreading/Mutex.h>
+#include <LibThreading/Thread.h>
 #include <LibWasm/AbstractMachine/Validator.h>
 #include <LibWasm/Printer/Printer.h>
 
@@ -248,27 +252,79 @@ ErrorOr<void, ValidationError> Validator::validate(TableSection const& section)
 
 ErrorOr<void, ValidationError> Validator::validate(CodeSection const& section)
 {
-    size_t index = m_context.imported_function_count;
-    for (auto& entry : section.functions()) {
-        auto function_index = index++;
-        TRY(validate(FunctionIndex { function_index }));
-        auto& function_type = m_context.functions[function_index];
-        auto& function = entry.func();
+    auto& functions = section.functions();
+    size_t total_code_size = 0;
+    for (auto& entry : functions)
+        total_code_size += entry.size();
 
+    // NOTE: Each function body only changes the locals and labels of the validator it's validated with, so a single fork
+    //       can be reused for all of them (and one fork per thread can validate them concurrently).
+    if (functions.size() < 2 || total_code_size < parallel_validation_threshold) {
         auto function_validator = fork();
-        function_validator.m_context.locals = {};
-        function_validator.m_context.locals.extend(function_type.parameters());
-        for (auto& local : function.locals()) {
-            for (size_t i = 0; i < local.n(); ++i)
-                function_validator.m_context.locals.append(local.type());
-        }
+        for (size_t i = 0; i < functions.size(); ++i)
+            TRY(function_validator.validate_function(m_context.imported_function_count + i, functions[i].func()));
+        return {};
+    }
+
+    // Threads take the next function that hasn't been validated yet, and stop once a function before it turned out to be invalid.
+    // The error is always the one for the first invalid function, just like when validating them one after the other.
+    Atomic<size_t> next_function { 0 };
+    Atomic<size_t> first_invalid_function { NumericLimits<size_t>::max() };
+    Threading::Mutex error_mutex;
+    Optional<ValidationError> first_error;
+
+    Vector<NonnullRefPtr<Threading::Thread>> threads;
+    for (size_t i = 0; i < validation_thread_count; ++i) {
+        auto thread = Threading::Thread::construct([&]() -> intptr_t {
+            auto function_validator = fork();
+            for (;;) {
+                auto index = next_function.fetch_add(1);
+                if (index >= functions.size() || index > first_invalid_function.load())
+                    break;
+                auto result = function_validator.validate_function(m_context.imported_function_count + index, functions[index].func());
+                if (!result.is_error())
+                    continue;
+                Threading::MutexLocker locker(error_mutex);
+                if (index < first_invalid_function.load()) {
+                    first_invalid_function.store(index);
+                    first_error = result.release_error();
+                }
+            }
+            return 0;
+        },
+            "Wasm validation"sv);
+        thread->start();
+        threads.append(move(thread));
+    }
+    for (auto& thread : threads)
+        (void)thread->join();
+
+    if (first_error.has_value())
+        return first_error.release_value();
+    return {};
+}
 
-        function_validator.m_context.labels = { ResultType { function_type.results() } };
-        function_validator.m_context.return_ = ResultType { function_type.results() };
+ErrorOr<void, ValidationError> Validator::validate_function(FunctionIndex index, CodeSection::Func const& function)
+{
+    TRY(validate(index));
+    auto& function_type = m_context.functions[index.value()];
+
+    m_parent_labels.clear_with_capacity();
+    m_entered_scopes.clear_with_capacity();
+    m_block_details.clear_with_capacity();
+    m_entered_blocks.clear_with_capacity();
 
-        TRY(function_validator.validate(function.body(), function_type.results()));
+    m_context.locals.clear_with_capacity();
+    m_context.locals.extend(function_type.parameters());
+    for (auto& local : function.locals()) {
+        for (size_t i = 0; i < local.n(); ++i)
+            m_context.locals.append(local.type());
     }
 
+    m_context.labels = { ResultType { function_type.results() } };
+    m_context.return_ = ResultType { function_type.results() };
+
+    TRY(validate(function.body(), function_type.results()));
     return {};
 }
 
@@ -2379,17 +2435,17 @@ VALIDATE_INSTRUCTION(structured_end)
         return Errors::invalid("usage of structured end");
 
     auto last_scope = m_entered_scopes.take_last();
-    m_context = m_parent_contexts.take_last();
+    m_context.labels = m_parent_labels.take_last();
     auto last_block_type = m_entered_blocks.take_last();
+    auto block_details = m_block_details.take_last();
 
     if (last_scope == ChildScopeKind::Block) {
-        auto details = m_block_details.take_last();
         // FIXME: Validate the returns.
         return {};
     }
 
     if (last_scope == ChildScopeKind::Else) {
-        auto details = m_block_details.take_last().details.get<BlockDetails::IfDetails>();
+        auto& details = block_details.details.get<BlockDetails::IfDetails>();
         if (details.true_branch_stack != stack)
             return Errors::invalid("stack configuration after if-else", details.true_branch_stack.release_vector(), stack.release_vector());
 
@@ -2411,7 +2467,7 @@ VALIDATE_INSTRUCTION(structured_else)
     m_entered_scopes.last() = ChildScopeKind::Else;
     auto& if_details = m_block_details.last().details.get<BlockDetails::IfDetails>();
     if_details.true_branch_stack = exchange(stack, move(if_details.initial_stack));
-    m_context = m_parent_contexts.last();
+    m_context.labels = m_parent_labels.last();
     return {};
 }
 
@@ -2434,7 +2490,7 @@ VALIDATE_INSTRUCTION(block)
 
     m_entered_scopes.append(ChildScopeKind::Block);
     m_block_details.empend(stack.actual_size(), Empty {});
-    m_parent_contexts.append(m_context);
+    m_parent_labels.append(m_context.labels);
     m_entered_blocks.append(block_type);
     m_context.labels.prepend(ResultType { block_type.results() });
     return {};
@@ -2459,7 +2515,7 @@ VALIDATE_INSTRUCTION(loop)
 
     m_entered_scopes.append(ChildScopeKind::Block);
     m_block_details.empend(stack.actual_size(), Empty {});
-    m_parent_contexts.append(m_context);
+    m_parent_labels.append(m_context.labels);
     m_entered_blocks.append(block_type);
     m_context.labels.prepend(ResultType { block_type.results() });
     return {};
@@ -2487,7 +2543,7 @@ VALIDATE_INSTRUCTION(if_)
 
     m_entered_scopes.append(args.else_ip.has_value() ? ChildScopeKind::IfWithElse : ChildScopeKind::IfWithoutElse);
     m_block_details.empend(stack.actual_size(), BlockDetails::IfDetails { stack, {} });
-    m_parent_contexts.append(m_context);
+    m_parent_labels.append(m_context.labels);
     m_entered_blocks.append(block_type);
     m_context.labels.prepend(ResultType { block_type.results() });
     return {};
@@ -64,6 +64,7 @@ public:
     ErrorOr<void, ValidationError> validate(MemorySection const&);
     ErrorOr<void, ValidationError> validate(TableSection const&);
     ErrorOr<void, ValidationError> validate(CodeSection const&);
+    ErrorOr<void, ValidationError> validate_function(FunctionIndex, CodeSection::Func const&);
     ErrorOr<void, ValidationError> validate(FunctionSection const&) { return {}; }
     ErrorOr<void, ValidationError> validate(DataCountSection const&) { return {}; }
     ErrorOr<void, ValidationError> validate(TypeSection const&) { return {}; }
@@ -226,6 +227,10 @@ public:
     ErrorOr<void, ValidationError> validate(GlobalType const&) { return {}; }
 
 private:
+    // Below this many bytes of function bodies, starting threads costs more than it saves.
+    static constexpr size_t parallel_validation_threshold = 256 * KiB;
+    static constexpr size_t validation_thread_count = 4;
+
     explicit Validator(Context context)
         : m_context(move(context))
     {
@@ -276,7 +281,8 @@ private:
     };
 
     Context m_context;
-    Vector<Context> m_parent_contexts;
+    // Blocks only ever add labels to the context, so only the labels need to be restored when leaving them.
+    Vector<Vector<ResultType>> m_parent_labels;
     Vector<ChildScopeKind> m_entered_scopes;
     Vector<BlockDetails> m_block_details;
     Vector<FunctionType> m_entered_blocks;
@@ -14,9 +14,22 @@ Wrappable::~Wrappable()
 {
 }
 
+Wrapper* Wrappable::wrapper()
+{
+    // A wrapper the garbage collector has already given up on must not be handed out again.
+    if (m_wrapper && m_wrapper->is_pending_destruction())
+        return nullptr;
+    return m_wrapper;
+}
+
+const Wrapper* Wrappable::wrapper() const
+{
+    return const_cast<Wrappable&>(*this).wrapper();
+}
+
 void Wrappable::set_wrapper(Wrapper& wrapper)
 {
-    VERIFY(!m_wrapper);
+    VERIFY(!this->wrapper());
     m_wrapper = wrapper.make_weak_ptr();
 }
 
@@ -9,6 +9,7 @@
 #include <AK/URL.h>
 #include <LibWeb/CSS/CSSImportRule.h>
 #include <LibWeb/CSS/Parser/Parser.h>
+#include <LibWeb/CSS/StyleComputer.h>
 #include <LibWeb/DOM/Document.h>
 #include <LibWeb/Loader/ResourceLoader.h>
 
@@ -80,6 +81,8 @@ void CSSImportRule::resource_did_load()
     }
 
     m_style_sheet = move(sheet);
+
+    m_document->style_computer().invalidate_rule_cache();
 }
 
 }
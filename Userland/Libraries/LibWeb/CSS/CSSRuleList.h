@@ -52,7 +52,8 @@ public:
     DOM::ExceptionOr<unsigned> insert_a_css_rule(NonnullRefPtr<CSSRule>, u32 index);
 
     void for_each_effective_style_rule(Function<void(CSSStyleRule const&)> const& callback) const;
-    void evaluate_media_queries(DOM::Window const&);
+    // Returns whether the result of any media query changed.
+    bool evaluate_media_queries(DOM::Window const&);
 
 private:
     explicit CSSRuleList(NonnullRefPtrVector<CSSRule>&&);
@@ -15,14 +15,29 @@ CSSStyleRule::CSSStyleRule(NonnullRefPtrVector<Selector>&& selectors, NonnullRef
 {
 }
 
+CSSStyleRule::CSSStyleRule(NonnullRefPtrVector<Selector>&& selectors, Function<NonnullRefPtr<CSSStyleDeclaration>()>&& parse_declaration)
+    : m_selectors(move(selectors))
+    , m_parse_declaration(move(parse_declaration))
+{
+}
+
 CSSStyleRule::~CSSStyleRule()
 {
 }
 
+CSSStyleDeclaration const& CSSStyleRule::declaration() const
+{
+    if (!m_declaration) {
+        m_declaration = m_parse_declaration();
+        m_parse_declaration = nullptr;
+    }
+    return *m_declaration;
+}
+
 // https://www.w3.org/TR/cssom/#dom-cssstylerule-style
 CSSStyleDeclaration* CSSStyleRule::style()
 {
-    return m_declaration;
+    return const_cast<CSSStyleDeclaration*>(&declaration());
 }
 
 // https://www.w3.org/TR/cssom/#serialize-a-css-rule
@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <AK/Function.h>
 #include <AK/NonnullRefPtr.h>
 #include <AK/NonnullRefPtrVector.h>
 #include <LibWeb/CSS/CSSRule.h>
@@ -27,10 +28,16 @@ public:
         return adopt_ref(*new CSSStyleRule(move(selectors), move(declaration)));
     }
 
+    // Most rules in a large style sheet never match anything, so the declarations are only parsed once they're needed.
+    static NonnullRefPtr<CSSStyleRule> create_with_lazy_declaration(NonnullRefPtrVector<Selector>&& selectors, Function<NonnullRefPtr<CSSStyleDeclaration>()>&& parse_declaration)
+    {
+        return adopt_ref(*new CSSStyleRule(move(selectors), move(parse_declaration)));
+    }
+
     virtual ~CSSStyleRule() override;
 
     const NonnullRefPtrVector<Selector>& selectors() const { return m_selectors; }
-    const CSSStyleDeclaration& declaration() const { return m_declaration; }
+    const CSSStyleDeclaration& declaration() const;
 
     virtual StringView class_name() const override { return "CSSStyleRule"; };
     virtual Type type() const override { return Type::Style; };
@@ -42,11 +49,13 @@ public:
 
 private:
     CSSStyleRule(NonnullRefPtrVector<Selector>&&, NonnullRefPtr<CSSStyleDeclaration>&&);
+    CSSStyleRule(NonnullRefPtrVector<Selector>&&, Function<NonnullRefPtr<CSSStyleDeclaration>()>&&);
 
     virtual String serialized() const override;
 
     NonnullRefPtrVector<Selector> m_selectors;
-    NonnullRefPtr<CSSStyleDeclaration> m_declaration;
+    mutable RefPtr<CSSStyleDeclaration> m_declaration;
+    mutable Function<NonnullRefPtr<CSSStyleDeclaration>()> m_parse_declaration;
 };
 
 template<>
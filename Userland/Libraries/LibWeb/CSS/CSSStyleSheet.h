@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/Badge.h>
 #include <AK/Function.h>
 #include <AK/NonnullRefPtrVector.h>
 #include <LibWeb/CSS/CSSRule.h>
@@ -17,6 +18,7 @@
 namespace Web::CSS {
 
 class CSSImportRule;
+class StyleSheetList;
 
 class CSSStyleSheet final
     : public StyleSheet
@@ -33,6 +35,8 @@ public:
 
     void set_owner_css_rule(CSSRule* rule) { m_owner_css_rule = rule; }
 
+    void set_style_sheet_list(Badge<StyleSheetList>, StyleSheetList* list) { m_style_sheet_list = list; }
+
     virtual String type() const override { return "text/css"; }
 
     CSSRuleList const& rules() const { return m_rules; }
@@ -47,7 +51,8 @@ public:
     DOM::ExceptionOr<void> delete_rule(unsigned index);
 
     void for_each_effective_style_rule(Function<void(CSSStyleRule const&)> const& callback) const;
-    void evaluate_media_queries(DOM::Window const&);
+    // Returns whether the result of any media query changed.
+    bool evaluate_media_queries(DOM::Window const&);
 
 private:
     explicit CSSStyleSheet(NonnullRefPtrVector<CSSRule>);
@@ -55,6 +60,8 @@ private:
     NonnullRefPtr<CSSRuleList> m_rules;
 
     WeakPtr<CSSRule> m_owner_css_rule;
+
+    StyleSheetList* m_style_sheet_list { nullptr };
 };
 
 }
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Array.h>
+#include <AK/NumericLimits.h>
+#include <AK/Types.h>
+
+namespace Web::CSS {
+
+// A Bloom filter that supports removing keys, by keeping a count per bucket instead of a bit.
+// Each key is put into two buckets, derived from its lower and upper 16 bits. Counters that
+// reach their maximum value stay there, so the filter never reports a false negative.
+template<typename CounterType, size_t key_bits>
+class CountingBloomFilter {
+public:
+    static_assert(key_bits <= 16);
+
+    void increment(u32 key)
+    {
+        auto& first = first_bucket(key);
+        if (first < NumericLimits<CounterType>::max())
+            ++first;
+        auto& second = second_bucket(key);
+        if (second < NumericLimits<CounterType>::max())
+            ++second;
+    }
+
+    void decrement(u32 key)
+    {
+        auto& first = first_bucket(key);
+        VERIFY(first > 0);
+        if (first < NumericLimits<CounterType>::max())
+            --first;
+        auto& second = second_bucket(key);
+        VERIFY(second > 0);
+        if (second < NumericLimits<CounterType>::max())
+            --second;
+    }
+
+    bool may_contain(u32 key) const
+    {
+        return first_bucket(key) && second_bucket(key);
+    }
+
+private:
+    static constexpr u32 bucket_count = 1 << key_bits;
+    static constexpr u32 key_mask = bucket_count - 1;
+
+    CounterType& first_bucket(u32 key) { return m_buckets[key & key_mask]; }
+    CounterType& second_bucket(u32 key) { return m_buckets[(key >> 16) & key_mask]; }
+    CounterType const& first_bucket(u32 key) const { return m_buckets[key & key_mask]; }
+    CounterType const& second_bucket(u32 key) const { return m_buckets[(key >> 16) & key_mask]; }
+
+    Array<CounterType, bucket_count> m_buckets {};
+};
+
+}
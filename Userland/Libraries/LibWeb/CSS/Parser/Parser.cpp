@@ -2019,13 +2019,21 @@ RefPtr<CSSRule> Parser::convert_to_rule(NonnullRefPtr<StyleRule> rule)
             return {};
         }
 
-        auto declaration = convert_to_declaration(*rule->m_block);
-        if (!declaration) {
+        if (!rule->m_block->is_curly()) {
             dbgln("CSSParser: style rule declaration invalid; discarding.");
             return {};
         }
 
-        return CSSStyleRule::create(move(selectors.value()), move(*declaration));
+        // Parsing the declarations only needs the block and what the parsing context knows about the document.
+        WeakPtr<DOM::Document> document;
+        if (m_context.document())
+            document = m_context.document()->make_weak_ptr<DOM::Document>();
+        return CSSStyleRule::create_with_lazy_declaration(move(selectors.value()), [block = NonnullRefPtr { *rule->m_block }, document = move(document)]() -> NonnullRefPtr<CSSStyleDeclaration> {
+            Parser parser(document ? ParsingContext(*document) : ParsingContext(), "");
+            if (auto declaration = parser.convert_to_declaration(block))
+                return declaration.release_nonnull();
+            return PropertyOwningCSSStyleDeclaration::create({}, {});
+        });
     }
 
     return {};
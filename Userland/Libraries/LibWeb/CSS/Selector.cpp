@@ -12,6 +12,32 @@ namespace Web::CSS {
 Selector::Selector(Vector<CompoundSelector>&& compound_selectors)
     : m_compound_selectors(move(compound_selectors))
 {
+    collect_ancestor_hashes();
+}
+
+void Selector::collect_ancestor_hashes()
+{
+    size_t next_hash_index = 0;
+
+    // A compound selector followed by a descendant or child combinator has to match an ancestor of the element
+    // matched by the next one, and therefore an ancestor of the subject as well.
+    for (size_t i = m_compound_selectors.size(); i > 1; --i) {
+        auto combinator = m_compound_selectors[i - 1].combinator;
+        if (combinator != Combinator::Descendant && combinator != Combinator::ImmediateChild)
+            continue;
+        for (auto const& simple_selector : m_compound_selectors[i - 2].simple_selectors) {
+            if (simple_selector.type != SimpleSelector::Type::Id
+                && simple_selector.type != SimpleSelector::Type::Class
+                && simple_selector.type != SimpleSelector::Type::TagName)
+                continue;
+            auto hash = ancestor_hash(simple_selector.type, simple_selector.value);
+            if (hash == 0)
+                continue;
+            m_ancestor_hashes[next_hash_index++] = hash;
+            if (next_hash_index == max_ancestor_hashes)
+                return;
+        }
+    }
 }
 
 Selector::~Selector()
@@ -7,10 +7,12 @@
 
 #pragma once
 
+#include <AK/Array.h>
 #include <AK/FlyString.h>
 #include <AK/NonnullRefPtrVector.h>
 #include <AK/RefCounted.h>
 #include <AK/String.h>
+#include <AK/StringHash.h>
 #include <AK/Vector.h>
 
 namespace Web::CSS {
@@ -134,10 +136,24 @@ public:
     u32 specificity() const;
     String serialize() const;
 
+    // Hashes of ids, classes and tag names that some ancestor of a matching element must have, for a quick
+    // rejection with StyleComputer's ancestor filter. Unused entries are 0.
+    static constexpr size_t max_ancestor_hashes = 8;
+    Array<u32, max_ancestor_hashes> const& ancestor_hashes() const { return m_ancestor_hashes; }
+
+    // Case is ignored, so that the same hashes work for class names in quirks mode.
+    static u32 ancestor_hash(SimpleSelector::Type type, StringView name)
+    {
+        return AK::case_insensitive_string_hash(name.characters_without_null_termination(), name.length(), to_underlying(type));
+    }
+
 private:
     explicit Selector(Vector<CompoundSelector>&&);
 
+    void collect_ancestor_hashes();
+
     Vector<CompoundSelector> m_compound_selectors;
+    Array<u32, max_ancestor_hashes> m_ancestor_hashes {};
 };
 
 constexpr StringView pseudo_element_name(Selector::SimpleSelector::PseudoElement);
@@ -19,6 +19,7 @@
 #include <LibWeb/DOM/Element.h>
 #include <LibWeb/Dump.h>
 #include <LibWeb/FontCache.h>
+#include <LibWeb/HTML/AttributeNames.h>
 #include <LibWeb/HTML/BrowsingContext.h>
 #include <ctype.h>
 #include <stdio.h>
@@ -56,6 +57,12 @@ static StyleSheet& quirks_mode_stylesheet()
     return *sheet;
 }
 
+void StyleComputer::load_user_agent_style_sheets()
+{
+    (void)default_stylesheet();
+    (void)quirks_mode_stylesheet();
+}
+
 template<typename Callback>
 void StyleComputer::for_each_stylesheet(CascadeOrigin cascade_origin, Callback callback) const
 {
@@ -71,28 +78,69 @@ void StyleComputer::for_each_stylesheet(CascadeOrigin cascade_origin, Callback c
     }
 }
 
-Vector<MatchingRule> StyleComputer::collect_matching_rules(DOM::Element const& element, CascadeOrigin declaration_type) const
+Vector<MatchingRule> StyleComputer::collect_matching_rules(DOM::Element const& element, CascadeOrigin cascade_origin) const
 {
+    if (cascade_origin == CascadeOrigin::Any) {
+        auto matching_rules = collect_matching_rules(element, CascadeOrigin::UserAgent);
+        auto number_of_user_agent_style_sheets = rule_cache_for_cascade_origin(CascadeOrigin::UserAgent).number_of_style_sheets;
+        for (auto& matching_rule : collect_matching_rules(element, CascadeOrigin::Author)) {
+            matching_rule.style_sheet_index += number_of_user_agent_style_sheets;
+            matching_rules.append(move(matching_rule));
+        }
+        return matching_rules;
+    }
+
+    auto const& rule_cache = rule_cache_for_cascade_origin(cascade_origin);
+
+    Vector<MatchingRule const*> rules_to_run;
+    auto add_rules_to_run = [&](auto const& rules_by_key, FlyString const& key) {
+        auto it = rules_by_key.find(key);
+        if (it == rules_by_key.end())
+            return;
+        for (auto const& rule : it->value)
+            rules_to_run.append(&rule);
+    };
+
+    // Class selectors match case-insensitively in quirks mode, so the cache is keyed by lowercase class names then.
+    for (auto const& class_name : element.class_names())
+        add_rules_to_run(rule_cache.rules_by_class, m_rule_cache_is_for_quirks_mode ? class_name.to_lowercase() : class_name);
+    if (auto id = element.attribute(HTML::AttributeNames::id); !id.is_null())
+        add_rules_to_run(rule_cache.rules_by_id, id);
+    add_rules_to_run(rule_cache.rules_by_tag_name, element.local_name());
+    for (auto const& rule : rule_cache.other_rules)
+        rules_to_run.append(&rule);
+
+    bool can_use_ancestor_filter = can_use_ancestor_filter_for(element);
+
     Vector<MatchingRule> matching_rules;
+    for (auto const* rule_to_run : rules_to_run) {
+        auto const& selector = rule_to_run->rule->selectors()[rule_to_run->selector_index];
+        if (can_use_ancestor_filter && should_reject_with_ancestor_filter(selector))
+            continue;
+        if (SelectorEngine::matches(selector, element))
+            matching_rules.append(*rule_to_run);
+    }
 
-    size_t style_sheet_index = 0;
-    for_each_stylesheet(declaration_type, [&](auto& sheet) {
-        size_t rule_index = 0;
-        static_cast<CSSStyleSheet const&>(sheet).for_each_effective_style_rule([&](auto const& rule) {
-            size_t selector_index = 0;
-            for (auto& selector : rule.selectors()) {
-                if (SelectorEngine::matches(selector, element)) {
-                    matching_rules.append({ rule, style_sheet_index, rule_index, selector_index, selector.specificity() });
-                    break;
-                }
-                ++selector_index;
-            }
-            ++rule_index;
-        });
-        ++style_sheet_index;
+    // A rule matches at most once, through the first of its selectors that matches the element.
+    quick_sort(matching_rules, [](MatchingRule const& a, MatchingRule const& b) {
+        if (a.style_sheet_index != b.style_sheet_index)
+            return a.style_sheet_index < b.style_sheet_index;
+        if (a.rule_index != b.rule_index)
+            return a.rule_index < b.rule_index;
+        return a.selector_index < b.selector_index;
     });
+    Vector<MatchingRule> unique_matching_rules;
+    unique_matching_rules.ensure_capacity(matching_rules.size());
+    for (auto& matching_rule : matching_rules) {
+        if (!unique_matching_rules.is_empty()) {
+            auto const& previous = unique_matching_rules.last();
+            if (previous.style_sheet_index == matching_rule.style_sheet_index && previous.rule_index == matching_rule.rule_index)
+                continue;
+        }
+        unique_matching_rules.unchecked_append(move(matching_rule));
+    }
 
-    return matching_rules;
+    return unique_matching_rules;
 }
 
 void StyleComputer::sort_matching_rules(Vector<MatchingRule>& matching_rules) const
@@ -111,6 +159,285 @@ void StyleComputer::sort_matching_rules(Vector<MatchingRule>& matching_rules) co
     });
 }
 
+template<typename Callback>
+static void for_each_ancestor_hash(DOM::Element const& element, Callback callback)
+{
+    callback(Selector::ancestor_hash(Selector::SimpleSelector::Type::TagName, element.local_name()));
+    if (auto id = element.attribute(HTML::AttributeNames::id); !id.is_empty())
+        callback(Selector::ancestor_hash(Selector::SimpleSelector::Type::Id, id));
+    for (auto const& class_name : element.class_names())
+        callback(Selector::ancestor_hash(Selector::SimpleSelector::Type::Class, class_name));
+}
+
+void StyleComputer::push_ancestor(DOM::Element const& element)
+{
+    auto const* parent = element.parent_element();
+    bool is_complete_chain = m_ancestors.is_empty()
+        ? !parent
+        : m_ancestors.last().is_complete_chain && m_ancestors.last().element == parent;
+    Ancestor ancestor { &element, is_complete_chain, {} };
+    for_each_ancestor_hash(element, [&](u32 hash) {
+        ancestor.hashes.append(hash);
+        m_ancestor_filter.increment(hash);
+    });
+    m_ancestors.append(move(ancestor));
+}
+
+void StyleComputer::pop_ancestor(DOM::Element const& element)
+{
+    VERIFY(!m_ancestors.is_empty());
+    VERIFY(m_ancestors.last().element == &element);
+    for (auto hash : m_ancestors.take_last().hashes)
+        m_ancestor_filter.decrement(hash);
+}
+
+bool StyleComputer::can_use_ancestor_filter_for(DOM::Element const& element) const
+{
+    if (m_ancestors.is_empty() || !m_ancestors.last().is_complete_chain)
+        return false;
+    return m_ancestors.last().element == element.parent_element();
+}
+
+bool StyleComputer::should_reject_with_ancestor_filter(Selector const& selector) const
+{
+    for (auto hash : selector.ancestor_hashes()) {
+        if (hash == 0)
+            break;
+        if (!m_ancestor_filter.may_contain(hash))
+            return true;
+    }
+    return false;
+}
+
+static bool is_structural_selector(Selector const& selector)
+{
+    for (auto const& compound_selector : selector.compound_selectors()) {
+        if (compound_selector.combinator == Selector::Combinator::NextSibling || compound_selector.combinator == Selector::Combinator::SubsequentSibling)
+            return true;
+        for (auto const& simple_selector : compound_selector.simple_selectors) {
+            if (simple_selector.type != Selector::SimpleSelector::Type::PseudoClass)
+                continue;
+            switch (simple_selector.pseudo_class.type) {
+            case Selector::SimpleSelector::PseudoClass::Type::FirstChild:
+            case Selector::SimpleSelector::PseudoClass::Type::LastChild:
+            case Selector::SimpleSelector::PseudoClass::Type::OnlyChild:
+            case Selector::SimpleSelector::PseudoClass::Type::Empty:
+            case Selector::SimpleSelector::PseudoClass::Type::FirstOfType:
+            case Selector::SimpleSelector::PseudoClass::Type::LastOfType:
+            case Selector::SimpleSelector::PseudoClass::Type::NthChild:
+            case Selector::SimpleSelector::PseudoClass::Type::NthLastChild:
+                return true;
+            case Selector::SimpleSelector::PseudoClass::Type::Not:
+                for (auto const& not_selector : simple_selector.pseudo_class.not_selector) {
+                    if (is_structural_selector(not_selector))
+                        return true;
+                }
+                break;
+            default:
+                break;
+            }
+        }
+    }
+    return false;
+}
+
+void StyleComputer::invalidate_rule_cache()
+{
+    m_author_rule_cache = nullptr;
+    m_user_agent_rule_cache = nullptr;
+    m_invalidation_set = nullptr;
+}
+
+static void add_to_invalidation_set(HashMap<FlyString, InvalidationScope>& map, FlyString const& name, InvalidationScope scope)
+{
+    auto& entry = map.ensure(name, [] { return InvalidationScope::None; });
+    entry |= scope;
+}
+
+static void collect_invalidation_set(Selector const& selector, InvalidationScope scope, auto& invalidation_set)
+{
+    auto const& compound_selectors = selector.compound_selectors();
+    for (size_t i = compound_selectors.size(); i > 0; --i) {
+        auto const& compound_selector = compound_selectors[i - 1];
+        for (auto const& simple_selector : compound_selector.simple_selectors) {
+            switch (simple_selector.type) {
+            case Selector::SimpleSelector::Type::Id:
+                add_to_invalidation_set(invalidation_set.ids, simple_selector.value, scope);
+                break;
+            case Selector::SimpleSelector::Type::Class:
+                add_to_invalidation_set(invalidation_set.classes, simple_selector.value.to_lowercase(), scope);
+                break;
+            case Selector::SimpleSelector::Type::Attribute:
+                add_to_invalidation_set(invalidation_set.attribute_names, simple_selector.attribute.name.to_lowercase(), scope);
+                break;
+            case Selector::SimpleSelector::Type::PseudoClass:
+                switch (simple_selector.pseudo_class.type) {
+                case Selector::SimpleSelector::PseudoClass::Type::Link:
+                    // An element is a link if it or any of its ancestors has an href.
+                    add_to_invalidation_set(invalidation_set.attribute_names, HTML::AttributeNames::href, scope | InvalidationScope::Descendants);
+                    break;
+                case Selector::SimpleSelector::PseudoClass::Type::Checked:
+                    add_to_invalidation_set(invalidation_set.attribute_names, HTML::AttributeNames::checked, scope);
+                    break;
+                case Selector::SimpleSelector::PseudoClass::Type::Disabled:
+                case Selector::SimpleSelector::PseudoClass::Type::Enabled:
+                    add_to_invalidation_set(invalidation_set.attribute_names, HTML::AttributeNames::disabled, scope);
+                    break;
+                case Selector::SimpleSelector::PseudoClass::Type::Not:
+                    for (auto const& not_selector : simple_selector.pseudo_class.not_selector)
+                        collect_invalidation_set(not_selector, scope, invalidation_set);
+                    break;
+                default:
+                    break;
+                }
+                break;
+            default:
+                break;
+            }
+        }
+
+        // Everything to the left of this combinator matches an ancestor or a previous sibling of what's on its right.
+        switch (compound_selector.combinator) {
+        case Selector::Combinator::Descendant:
+        case Selector::Combinator::ImmediateChild:
+            scope |= InvalidationScope::Descendants;
+            break;
+        case Selector::Combinator::NextSibling:
+        case Selector::Combinator::SubsequentSibling:
+            scope |= InvalidationScope::SubsequentSiblings;
+            break;
+        case Selector::Combinator::None:
+        case Selector::Combinator::Column:
+            break;
+        }
+    }
+}
+
+NonnullOwnPtr<StyleComputer::InvalidationSet> StyleComputer::make_invalidation_set() const
+{
+    auto invalidation_set = make<InvalidationSet>();
+
+    auto collect_from_rules = [&](Vector<MatchingRule> const& rules) {
+        for (auto const& rule : rules)
+            collect_invalidation_set(rule.rule->selectors()[rule.selector_index], InvalidationScope::None, *invalidation_set);
+    };
+    for (auto const* rule_cache : { m_user_agent_rule_cache.ptr(), m_author_rule_cache.ptr() }) {
+        for (auto const& it : rule_cache->rules_by_id)
+            collect_from_rules(it.value);
+        for (auto const& it : rule_cache->rules_by_class)
+            collect_from_rules(it.value);
+        for (auto const& it : rule_cache->rules_by_tag_name)
+            collect_from_rules(it.value);
+        collect_from_rules(rule_cache->other_rules);
+    }
+
+    return invalidation_set;
+}
+
+InvalidationScope StyleComputer::invalidation_scope_for(Selector::SimpleSelector::Type type, FlyString const& name) const
+{
+    build_rule_cache_if_needed();
+    if (!m_invalidation_set)
+        m_invalidation_set = make_invalidation_set();
+
+    auto scope_in = [](HashMap<FlyString, InvalidationScope> const& map, FlyString const& name) {
+        return map.get(name).value_or(InvalidationScope::None);
+    };
+    switch (type) {
+    case Selector::SimpleSelector::Type::Id:
+        return scope_in(m_invalidation_set->ids, name);
+    case Selector::SimpleSelector::Type::Class:
+        return scope_in(m_invalidation_set->classes, name.to_lowercase());
+    case Selector::SimpleSelector::Type::Attribute:
+        return scope_in(m_invalidation_set->attribute_names, name.to_lowercase());
+    default:
+        VERIFY_NOT_REACHED();
+    }
+}
+
+void StyleComputer::build_rule_cache_if_needed() const
+{
+    if (m_rule_cache_is_for_quirks_mode != document().in_quirks_mode()) {
+        m_author_rule_cache = nullptr;
+        m_user_agent_rule_cache = nullptr;
+        m_invalidation_set = nullptr;
+        m_rule_cache_is_for_quirks_mode = document().in_quirks_mode();
+    }
+    if (!m_author_rule_cache)
+        m_author_rule_cache = make_rule_cache_for_cascade_origin(CascadeOrigin::Author);
+    if (!m_user_agent_rule_cache)
+        m_user_agent_rule_cache = make_rule_cache_for_cascade_origin(CascadeOrigin::UserAgent);
+}
+
+StyleComputer::RuleCache const& StyleComputer::rule_cache_for_cascade_origin(CascadeOrigin cascade_origin) const
+{
+    build_rule_cache_if_needed();
+    if (cascade_origin == CascadeOrigin::Author)
+        return *m_author_rule_cache;
+    if (cascade_origin == CascadeOrigin::UserAgent)
+        return *m_user_agent_rule_cache;
+    VERIFY_NOT_REACHED();
+}
+
+NonnullOwnPtr<StyleComputer::RuleCache> StyleComputer::make_rule_cache_for_cascade_origin(CascadeOrigin cascade_origin) const
+{
+    auto rule_cache = make<RuleCache>();
+
+    size_t style_sheet_index = 0;
+    for_each_stylesheet(cascade_origin, [&](auto& sheet) {
+        size_t rule_index = 0;
+        static_cast<CSSStyleSheet const&>(sheet).for_each_effective_style_rule([&](auto const& rule) {
+            size_t selector_index = 0;
+            for (auto& selector : rule.selectors()) {
+                MatchingRule matching_rule { rule, style_sheet_index, rule_index, selector_index, selector.specificity() };
+                ++selector_index;
+
+                if (!rule_cache->has_structural_selectors && is_structural_selector(selector))
+                    rule_cache->has_structural_selectors = true;
+
+                // Only the rightmost compound selector has to match the element itself, so that's where the key comes from.
+                // Ids are the most selective, then classes, then tag names.
+                Selector::SimpleSelector const* key_selector = nullptr;
+                if (!selector.compound_selectors().is_empty()) {
+                    for (auto const& simple_selector : selector.compound_selectors().last().simple_selectors) {
+                        if (simple_selector.type == Selector::SimpleSelector::Type::Id) {
+                            key_selector = &simple_selector;
+                            break;
+                        }
+                        if (simple_selector.type == Selector::SimpleSelector::Type::Class && (!key_selector || key_selector->type == Selector::SimpleSelector::Type::TagName))
+                            key_selector = &simple_selector;
+                        else if (simple_selector.type == Selector::SimpleSelector::Type::TagName && !key_selector)
+                            key_selector = &simple_selector;
+                    }
+                }
+
+                if (!key_selector) {
+                    rule_cache->other_rules.append(move(matching_rule));
+                    continue;
+                }
+                switch (key_selector->type) {
+                case Selector::SimpleSelector::Type::Id:
+                    rule_cache->rules_by_id.ensure(key_selector->value).append(move(matching_rule));
+                    break;
+                case Selector::SimpleSelector::Type::Class:
+                    rule_cache->rules_by_class.ensure(m_rule_cache_is_for_quirks_mode ? key_selector->value.to_lowercase() : key_selector->value).append(move(matching_rule));
+                    break;
+                case Selector::SimpleSelector::Type::TagName:
+                    rule_cache->rules_by_tag_name.ensure(key_selector->value).append(move(matching_rule));
+                    break;
+                default:
+                    VERIFY_NOT_REACHED();
+                }
+            }
+            ++rule_index;
+        });
+        ++style_sheet_index;
+    });
+    rule_cache->number_of_style_sheets = style_sheet_index;
+
+    return rule_cache;
+}
+
 enum class Edge {
     Top,
     Right,
@@ -880,8 +1207,68 @@ NonnullRefPtr<StyleProperties> StyleComputer::create_document_style() const
     return style;
 }
 
+static bool is_eligible_for_style_sharing(DOM::Element const& element)
+{
+    if (element.inline_style())
+        return false;
+
+    // These pseudo-classes depend on state that isn't reflected in the attributes.
+    auto const& document = element.document();
+    if (element.is_focused() || element.is_active())
+        return false;
+    if (auto const* hovered_node = document.hovered_node(); hovered_node && (hovered_node == &element || element.is_ancestor_of(*hovered_node)))
+        return false;
+
+    return true;
+}
+
+static bool can_share_style(DOM::Element const& candidate, DOM::Element const& element)
+{
+    if (candidate.local_name() != element.local_name() || candidate.namespace_uri() != element.namespace_uri())
+        return false;
+
+    // Ids, classes and presentational hints all come from attributes, so requiring the same attributes covers all of them.
+    auto const& candidate_attributes = *candidate.attributes();
+    auto const& attributes = *element.attributes();
+    if (candidate_attributes.length() != attributes.length())
+        return false;
+    for (size_t i = 0; i < attributes.length(); ++i) {
+        auto const& candidate_attribute = *candidate_attributes.item(i);
+        auto const& attribute = *attributes.item(i);
+        if (candidate_attribute.name() != attribute.name() || candidate_attribute.value() != attribute.value())
+            return false;
+    }
+
+    return true;
+}
+
+Vector<StyleComputer::StyleSharingCandidate>* StyleComputer::style_sharing_candidates_for(DOM::Element const& element) const
+{
+    // Sharing is only safe between siblings, whose parent is at the top of the ancestor stack of an ongoing tree walk.
+    if (!can_use_ancestor_filter_for(element))
+        return nullptr;
+
+    auto const& user_agent_rule_cache = rule_cache_for_cascade_origin(CascadeOrigin::UserAgent);
+    auto const& author_rule_cache = rule_cache_for_cascade_origin(CascadeOrigin::Author);
+    if (user_agent_rule_cache.has_structural_selectors || author_rule_cache.has_structural_selectors)
+        return nullptr;
+
+    if (!is_eligible_for_style_sharing(element))
+        return nullptr;
+
+    return &m_ancestors.last().style_sharing_candidates;
+}
+
 NonnullRefPtr<StyleProperties> StyleComputer::compute_style(DOM::Element& element) const
 {
+    auto* style_sharing_candidates = style_sharing_candidates_for(element);
+    if (style_sharing_candidates) {
+        for (auto const& candidate : *style_sharing_candidates) {
+            if (can_share_style(*candidate.element, element))
+                return candidate.style;
+        }
+    }
+
     auto style = StyleProperties::create();
     // 1. Perform the cascade. This produces the "specified style"
     compute_cascaded_values(style, element);
@@ -895,6 +1282,12 @@ NonnullRefPtr<StyleProperties> StyleComputer::compute_style(DOM::Element& elemen
     // 4. Default the values, applying inheritance and 'initial' as needed
     compute_defaulted_values(style, &element);
 
+    if (style_sharing_candidates) {
+        if (style_sharing_candidates->size() == max_style_sharing_candidates)
+            style_sharing_candidates->take_first();
+        style_sharing_candidates->append({ &element, style });
+    }
+
     return style;
 }
 
@@ -7,11 +7,14 @@
 
 #pragma once
 
+#include <AK/EnumBits.h>
 #include <AK/HashMap.h>
 #include <AK/NonnullRefPtrVector.h>
 #include <AK/OwnPtr.h>
 #include <LibWeb/CSS/CSSStyleDeclaration.h>
+#include <LibWeb/CSS/CountingBloomFilter.h>
 #include <LibWeb/CSS/Parser/StyleComponentValueRule.h>
+#include <LibWeb/CSS/Selector.h>
 #include <LibWeb/CSS/StyleProperties.h>
 #include <LibWeb/Forward.h>
 
@@ -25,6 +28,16 @@ struct MatchingRule {
     u32 specificity { 0 };
 };
 
+// The elements other than the changed one itself that may start or stop matching a selector when a class,
+// id or attribute of an element changes.
+enum class InvalidationScope : u8 {
+    None = 0,
+    Descendants = 1 << 0,
+    SubsequentSiblings = 1 << 1,
+};
+
+AK_ENUM_BITWISE_OPERATORS(InvalidationScope);
+
 class PropertyDependencyNode : public RefCounted<PropertyDependencyNode> {
 public:
     static NonnullRefPtr<PropertyDependencyNode> create(String name)
@@ -48,6 +61,9 @@ public:
     explicit StyleComputer(DOM::Document&);
     ~StyleComputer();
 
+    // Parses the built-in style sheets ahead of time, instead of when the first page needs them.
+    static void load_user_agent_style_sheets();
+
     DOM::Document& document() { return m_document; }
     DOM::Document const& document() const { return m_document; }
 
@@ -73,6 +89,16 @@ public:
     CustomPropertyResolutionTuple resolve_custom_property_with_specificity(DOM::Element&, String const&) const;
     Optional<StyleProperty> resolve_custom_property(DOM::Element&, String const&) const;
 
+    void invalidate_rule_cache();
+
+    // Type is one of Id, Class or Attribute, and name is the id, class or attribute name.
+    InvalidationScope invalidation_scope_for(Selector::SimpleSelector::Type, FlyString const& name) const;
+
+    // A tree walk that computes style for the descendants of an element should push it around visiting them.
+    // This lets us reject most selectors with descendant and child combinators without looking at the ancestors.
+    void push_ancestor(DOM::Element const&);
+    void pop_ancestor(DOM::Element const&);
+
 private:
     void compute_cascaded_values(StyleProperties&, DOM::Element&) const;
     void compute_font(StyleProperties&, DOM::Element const*) const;
@@ -94,7 +120,61 @@ private:
 
     void cascade_declarations(StyleProperties&, DOM::Element&, Vector<MatchingRule> const&, CascadeOrigin, bool important) const;
 
+    // Every selector of every effective style rule, bucketed by a simple selector that an element has to satisfy
+    // for the selector to match it. This lets us skip most of the rules without running the selector engine.
+    struct RuleCache {
+        HashMap<FlyString, Vector<MatchingRule>> rules_by_id;
+        HashMap<FlyString, Vector<MatchingRule>> rules_by_class;
+        HashMap<FlyString, Vector<MatchingRule>> rules_by_tag_name;
+        Vector<MatchingRule> other_rules;
+        size_t number_of_style_sheets { 0 };
+        // Whether any selector looks at the siblings or children of an element, which rules out style sharing.
+        bool has_structural_selectors { false };
+    };
+
+    NonnullOwnPtr<RuleCache> make_rule_cache_for_cascade_origin(CascadeOrigin) const;
+    RuleCache const& rule_cache_for_cascade_origin(CascadeOrigin) const;
+    void build_rule_cache_if_needed() const;
+
+    // Where the ids, classes and attribute names in the selectors of the rule caches are used, relative to the
+    // subject of the selector. Class and attribute names are lowercase.
+    struct InvalidationSet {
+        HashMap<FlyString, InvalidationScope> ids;
+        HashMap<FlyString, InvalidationScope> classes;
+        HashMap<FlyString, InvalidationScope> attribute_names;
+    };
+
+    NonnullOwnPtr<InvalidationSet> make_invalidation_set() const;
+
     DOM::Document& m_document;
+
+    mutable OwnPtr<InvalidationSet> m_invalidation_set;
+    mutable OwnPtr<RuleCache> m_author_rule_cache;
+    mutable OwnPtr<RuleCache> m_user_agent_rule_cache;
+    mutable bool m_rule_cache_is_for_quirks_mode { false };
+
+    bool can_use_ancestor_filter_for(DOM::Element const&) const;
+    bool should_reject_with_ancestor_filter(Selector const&) const;
+
+    // Recently styled children of an ancestor on the stack, whose style can be reused for later siblings
+    // that are indistinguishable to every selector and presentational hint.
+    struct StyleSharingCandidate {
+        DOM::Element const* element { nullptr };
+        NonnullRefPtr<StyleProperties> style;
+    };
+    static constexpr size_t max_style_sharing_candidates = 8;
+    Vector<StyleSharingCandidate>* style_sharing_candidates_for(DOM::Element const&) const;
+
+    struct Ancestor {
+        DOM::Element const* element { nullptr };
+        // Whether this element and all of its ancestors are on the stack, which is when the filter can be trusted.
+        bool is_complete_chain { false };
+        // Remembered so that we remove exactly what we added, even if the element changes in between.
+        Vector<u32, 8> hashes;
+        mutable Vector<StyleSharingCandidate> style_sharing_candidates;
+    };
+    Vector<Ancestor> m_ancestors;
+    CountingBloomFilter<u8, 14> m_ancestor_filter;
 };
 
 }
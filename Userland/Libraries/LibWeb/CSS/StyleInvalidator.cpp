@@ -4,52 +4,77 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
-#include <LibWeb/CSS/CSSStyleRule.h>
+#include <AK/HashTable.h>
 #include <LibWeb/CSS/StyleInvalidator.h>
 #include <LibWeb/DOM/Document.h>
 #include <LibWeb/DOM/Element.h>
+#include <LibWeb/HTML/AttributeNames.h>
 
 namespace Web::CSS {
 
-StyleInvalidator::StyleInvalidator(DOM::Document& document)
-    : m_document(document)
+StyleInvalidator::StyleInvalidator(DOM::Element& element, FlyString const& attribute_name)
+    : m_element(element)
+    , m_attribute_name(attribute_name.to_lowercase())
+    , m_should_invalidate(element.document().should_invalidate_styles_on_attribute_changes())
 {
-    if (!m_document.should_invalidate_styles_on_attribute_changes())
-        return;
-    auto& style_computer = m_document.style_computer();
-    m_document.for_each_in_inclusive_subtree_of_type<DOM::Element>([&](auto& element) {
-        m_elements_and_matching_rules_before.set(&element, style_computer.collect_matching_rules(element));
+    if (m_should_invalidate)
+        m_old_value = m_element.attribute(m_attribute_name);
+}
+
+static void invalidate_inclusive_subtree(DOM::Element& element)
+{
+    element.for_each_in_inclusive_subtree_of_type<DOM::Element>([&](auto& descendant) {
+        descendant.set_needs_style_update(true);
         return IterationDecision::Continue;
     });
 }
 
 StyleInvalidator::~StyleInvalidator()
 {
-    if (!m_document.should_invalidate_styles_on_attribute_changes())
+    if (!m_should_invalidate)
         return;
-    auto& style_computer = m_document.style_computer();
-    m_document.for_each_in_inclusive_subtree_of_type<DOM::Element>([&](auto& element) {
-        auto matching_rules_before_iter = m_elements_and_matching_rules_before.find(&element);
-        if (matching_rules_before_iter == m_elements_and_matching_rules_before.end()) {
-            element.set_needs_style_update(true);
-            return IterationDecision::Continue;
-        }
-        auto& matching_rules_before = matching_rules_before_iter->value;
-        auto matching_rules_after = style_computer.collect_matching_rules(element);
-        if (matching_rules_before.size() != matching_rules_after.size()) {
-            element.set_needs_style_update(true);
-            return IterationDecision::Continue;
+
+    auto new_value = m_element.attribute(m_attribute_name);
+    if (new_value == m_old_value)
+        return;
+
+    // The element itself is always restyled, as it may match a selector through its rightmost compound
+    // selector, or get a presentational hint from the attribute.
+    m_element.set_needs_style_update(true);
+
+    auto& style_computer = m_element.document().style_computer();
+    auto scope = style_computer.invalidation_scope_for(Selector::SimpleSelector::Type::Attribute, m_attribute_name);
+
+    if (m_attribute_name == HTML::AttributeNames::id) {
+        if (!m_old_value.is_empty())
+            scope |= style_computer.invalidation_scope_for(Selector::SimpleSelector::Type::Id, m_old_value);
+        if (!new_value.is_empty())
+            scope |= style_computer.invalidation_scope_for(Selector::SimpleSelector::Type::Id, new_value);
+    } else if (m_attribute_name == HTML::AttributeNames::class_) {
+        // Only the classes that were added or removed matter.
+        HashTable<StringView> old_classes;
+        for (auto class_name : m_old_value.split_view(' '))
+            old_classes.set(class_name);
+        HashTable<StringView> new_classes;
+        for (auto class_name : new_value.split_view(' '))
+            new_classes.set(class_name);
+        for (auto class_name : old_classes) {
+            if (!new_classes.contains(class_name))
+                scope |= style_computer.invalidation_scope_for(Selector::SimpleSelector::Type::Class, class_name);
         }
-        style_computer.sort_matching_rules(matching_rules_before);
-        style_computer.sort_matching_rules(matching_rules_after);
-        for (size_t i = 0; i < matching_rules_before.size(); ++i) {
-            if (matching_rules_before[i].rule != matching_rules_after[i].rule) {
-                element.set_needs_style_update(true);
-                break;
-            }
+        for (auto class_name : new_classes) {
+            if (!old_classes.contains(class_name))
+                scope |= style_computer.invalidation_scope_for(Selector::SimpleSelector::Type::Class, class_name);
         }
-        return IterationDecision::Continue;
-    });
+    }
+
+    if (has_flag(scope, InvalidationScope::Descendants))
+        invalidate_inclusive_subtree(m_element);
+
+    if (has_flag(scope, InvalidationScope::SubsequentSiblings)) {
+        for (auto* sibling = m_element.next_element_sibling(); sibling; sibling = sibling->next_element_sibling())
+            invalidate_inclusive_subtree(*sibling);
+    }
 }
 
 }
@@ -4,19 +4,25 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <LibWeb/CSS/StyleComputer.h>
 #include <LibWeb/CSS/StyleSheetList.h>
+#include <LibWeb/DOM/Document.h>
 
 namespace Web::CSS {
 
 void StyleSheetList::add_sheet(NonnullRefPtr<CSSStyleSheet> sheet)
 {
     VERIFY(!m_sheets.contains_slow(sheet));
+    sheet->set_style_sheet_list({}, this);
     m_sheets.append(move(sheet));
+    m_document.style_computer().invalidate_rule_cache();
 }
 
 void StyleSheetList::remove_sheet(CSSStyleSheet& sheet)
 {
+    sheet.set_style_sheet_list({}, nullptr);
     m_sheets.remove_first_matching([&](auto& entry) { return &*entry == &sheet; });
+    m_document.style_computer().invalidate_rule_cache();
 }
 
 StyleSheetList::StyleSheetList(DOM::Document& document)
@@ -24,6 +30,12 @@ StyleSheetList::StyleSheetList(DOM::Document& document)
 {
 }
 
+StyleSheetList::~StyleSheetList()
+{
+    for (auto& sheet : m_sheets)
+        sheet.set_style_sheet_list({}, nullptr);
+}
+
 // https://www.w3.org/TR/cssom/#ref-for-dfn-supported-property-indices%E2%91%A1
 bool StyleSheetList::is_supported_property_index(u32 index) const
 {
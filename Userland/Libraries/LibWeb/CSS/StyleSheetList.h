@@ -25,6 +25,8 @@ public:
         return adopt_ref(*new StyleSheetList(document));
     }
 
+    ~StyleSheetList();
+
     void add_sheet(NonnullRefPtr<CSSStyleSheet>);
     void remove_sheet(CSSStyleSheet&);
 
@@ -42,6 +44,9 @@ public:
 
     bool is_supported_property_index(u32) const;
 
+    DOM::Document& document() { return m_document; }
+    DOM::Document const& document() const { return m_document; }
+
 private:
     explicit StyleSheetList(DOM::Document&);
 
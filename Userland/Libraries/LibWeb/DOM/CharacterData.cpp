@@ -6,6 +6,8 @@
 
 #include <LibWeb/DOM/CharacterData.h>
 #include <LibWeb/DOM/Document.h>
+#include <LibWeb/DOM/Text.h>
+#include <LibWeb/Layout/Node.h>
 
 namespace Web::DOM {
 
@@ -25,6 +27,12 @@ void CharacterData::set_data(String data)
         return;
     m_data = move(data);
     set_needs_style_update(true);
+
+    // Text is only shaped during layout, so an existing layout node just has to be laid out again.
+    if (layout_node())
+        layout_node()->set_needs_layout();
+    else if (is<Text>(*this) && parent() && parent()->layout_node())
+        document().invalidate_layout_tree();
 }
 
 }
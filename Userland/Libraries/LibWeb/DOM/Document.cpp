@@ -82,7 +82,7 @@ Document::Document(const AK::URL& url)
     });
 
     m_layout_update_timer = Core::Timer::create_single_shot(0, [this] {
-        force_layout();
+        update_layout();
     });
 }
 
@@ -375,6 +375,16 @@ AK::URL Document::parse_url(String const& url) const
 }
 
 void Document::set_needs_layout()
+{
+    if (m_layout_root) {
+        m_layout_root->set_needs_layout();
+        return;
+    }
+    m_needs_layout = true;
+    schedule_layout_update();
+}
+
+void Document::set_needs_layout(Badge<Layout::Node>)
 {
     if (m_needs_layout)
         return;
@@ -382,6 +392,13 @@ void Document::set_needs_layout()
     schedule_layout_update();
 }
 
+void Document::invalidate_layout_tree()
+{
+    m_layout_tree_needs_rebuild = true;
+    m_needs_layout = true;
+    schedule_layout_update();
+}
+
 void Document::force_layout()
 {
     tear_down_layout_tree();
@@ -404,6 +421,11 @@ void Document::update_layout()
 
     update_style();
 
+    if (m_layout_tree_needs_rebuild) {
+        tear_down_layout_tree();
+        m_layout_tree_needs_rebuild = false;
+    }
+
     if (!m_layout_root) {
         Layout::TreeBuilder tree_builder;
         m_layout_root = static_ptr_cast<Layout::InitialContainingBlock>(tree_builder.build(*this));
@@ -411,6 +433,7 @@ void Document::update_layout()
 
     Layout::BlockFormattingContext root_formatting_context(*m_layout_root, nullptr);
     root_formatting_context.run(*m_layout_root, Layout::LayoutMode::Default);
+    m_layout_root->clear_needs_layout();
 
     m_layout_root->set_needs_display();
 
@@ -430,11 +453,16 @@ static void update_style_recursively(DOM::Node& node)
     node.set_needs_style_update(false);
 
     if (node.child_needs_style_update()) {
+        auto* element = is<Element>(node) ? &static_cast<Element&>(node) : nullptr;
+        if (element)
+            node.document().style_computer().push_ancestor(*element);
         node.for_each_child([&](auto& child) {
             if (child.needs_style_update() || child.child_needs_style_update())
                 update_style_recursively(child);
             return IterationDecision::Continue;
         });
+        if (element)
+            node.document().style_computer().pop_ancestor(*element);
     }
 
     node.set_child_needs_style_update(false);
@@ -448,7 +476,6 @@ void Document::update_style()
         return;
     update_style_recursively(*this);
     m_style_update_timer->stop();
-    set_needs_layout();
 }
 
 RefPtr<Layout::Node> Document::create_layout_node()
@@ -1135,9 +1162,14 @@ void Document::evaluate_media_queries_and_report_changes()
     }
 
     // Also not in the spec, but this is as good a place as any to evaluate @media rules!
+    bool any_media_queries_changed_match_state = false;
     for (auto& style_sheet : style_sheets().sheets()) {
-        style_sheet.evaluate_media_queries(window());
+        if (style_sheet.evaluate_media_queries(window()))
+            any_media_queries_changed_match_state = true;
     }
+
+    if (any_media_queries_changed_match_state)
+        style_computer().invalidate_rule_cache();
 }
 
 NonnullRefPtr<DOMImplementation> Document::implementation() const
@@ -147,6 +147,10 @@ public:
     void update_layout();
 
     void set_needs_layout();
+    void set_needs_layout(Badge<Layout::Node>);
+
+    // Throws away the layout tree at the next layout update, for changes that the existing tree can't represent.
+    void invalidate_layout_tree();
 
     virtual bool is_child_allowed(const Node&) const override;
 
@@ -399,6 +403,7 @@ private:
     Vector<WeakPtr<CSS::MediaQueryList>> m_media_query_lists;
 
     bool m_needs_layout { false };
+    bool m_layout_tree_needs_rebuild { false };
 };
 
 }
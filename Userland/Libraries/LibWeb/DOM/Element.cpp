@@ -31,7 +31,6 @@
 #include <LibWeb/Layout/TableCellBox.h>
 #include <LibWeb/Layout/TableRowBox.h>
 #include <LibWeb/Layout/TableRowGroupBox.h>
-#include <LibWeb/Layout/TreeBuilder.h>
 #include <LibWeb/Namespace.h>
 
 namespace Web::DOM {
@@ -70,7 +69,7 @@ ExceptionOr<void> Element::set_attribute(const FlyString& name, const String& va
     if (name.is_empty())
         return InvalidCharacterError::create("Attribute name must not be empty");
 
-    CSS::StyleInvalidator style_invalidator(document());
+    CSS::StyleInvalidator style_invalidator(*this, name);
 
     // 2. If this is in the HTML namespace and its node document is an HTML document, then set qualifiedName to qualifiedName in ASCII lowercase.
     // FIXME: Handle the second condition, assume it is an HTML document for now.
@@ -93,14 +92,21 @@ ExceptionOr<void> Element::set_attribute(const FlyString& name, const String& va
     }
 
     parse_attribute(attribute->local_name(), value);
+
+    // Attributes like width and height on replaced elements are read during layout.
+    if (layout_node())
+        layout_node()->set_needs_layout();
     return {};
 }
 
 // https://dom.spec.whatwg.org/#dom-element-removeattribute
 void Element::remove_attribute(const FlyString& name)
 {
-    CSS::StyleInvalidator style_invalidator(document());
+    CSS::StyleInvalidator style_invalidator(*this, name);
     m_attributes->remove_attribute(name);
+
+    if (layout_node())
+        layout_node()->set_needs_layout();
 }
 
 // https://dom.spec.whatwg.org/#dom-element-hasattribute
@@ -206,27 +212,28 @@ enum class StyleDifference {
     NeedsRelayout,
 };
 
-static StyleDifference compute_style_difference(CSS::StyleProperties const& old_style, CSS::StyleProperties const& new_style, Layout::NodeWithStyle const& node)
+static StyleDifference compute_style_difference(CSS::StyleProperties const& old_style, CSS::StyleProperties const& new_style)
 {
     if (old_style == new_style)
         return StyleDifference::None;
 
-    bool needs_repaint = false;
-    bool needs_relayout = false;
-
-    if (new_style.display() != old_style.display())
-        needs_relayout = true;
-
-    if (new_style.color_or_fallback(CSS::PropertyID::Color, node, Color::Black) != old_style.color_or_fallback(CSS::PropertyID::Color, node, Color::Black))
-        needs_repaint = true;
-    else if (new_style.color_or_fallback(CSS::PropertyID::BackgroundColor, node, Color::Black) != old_style.color_or_fallback(CSS::PropertyID::BackgroundColor, node, Color::Black))
-        needs_repaint = true;
-
-    if (needs_relayout)
-        return StyleDifference::NeedsRelayout;
-    if (needs_repaint)
-        return StyleDifference::NeedsRepaint;
-    return StyleDifference::None;
+    // Changes to the colors only need a repaint, everything else may affect layout.
+    auto differs = [](CSS::StyleProperties const& style, CSS::PropertyID property_id, CSS::StyleValue const& value) {
+        auto other_value = style.property(property_id);
+        return !other_value.has_value() || *other_value.value() != value;
+    };
+    auto only_needs_repaint = [](CSS::PropertyID property_id) {
+        return property_id == CSS::PropertyID::Color || property_id == CSS::PropertyID::BackgroundColor;
+    };
+    for (auto const& it : new_style.properties()) {
+        if (!only_needs_repaint(it.key) && differs(old_style, it.key, *it.value))
+            return StyleDifference::NeedsRelayout;
+    }
+    for (auto const& it : old_style.properties()) {
+        if (!only_needs_repaint(it.key) && differs(new_style, it.key, *it.value))
+            return StyleDifference::NeedsRelayout;
+    }
+    return StyleDifference::NeedsRepaint;
 }
 
 void Element::recompute_style()
@@ -236,23 +243,37 @@ void Element::recompute_style()
     auto old_specified_css_values = m_specified_css_values;
     auto new_specified_css_values = document().style_computer().compute_style(*this);
     m_specified_css_values = new_specified_css_values;
+
+    auto diff = StyleDifference::NeedsRelayout;
+    if (old_specified_css_values)
+        diff = compute_style_difference(*old_specified_css_values, *new_specified_css_values);
+    if (diff == StyleDifference::None)
+        return;
+
+    // The children may inherit some of what changed.
+    for_each_child_of_type<Element>([](auto& child) {
+        child.set_needs_style_update(true);
+        return IterationDecision::Continue;
+    });
+
     if (!layout_node()) {
         if (new_specified_css_values->display().is_none())
             return;
-        // We need a new layout tree here!
-        Layout::TreeBuilder tree_builder;
-        (void)tree_builder.build(*this);
+        // We need a new layout tree here, unless we're inside something that isn't rendered.
+        if (auto* parent = parent_or_shadow_host(); parent && parent->layout_node())
+            document().invalidate_layout_tree();
         return;
     }
 
-    auto diff = StyleDifference::NeedsRelayout;
-    if (old_specified_css_values && layout_node())
-        diff = compute_style_difference(*old_specified_css_values, *new_specified_css_values, *layout_node());
-    if (diff == StyleDifference::None)
+    // A different display type may need a different kind of layout node.
+    if (!old_specified_css_values || old_specified_css_values->display() != new_specified_css_values->display()) {
+        document().invalidate_layout_tree();
         return;
+    }
+
     layout_node()->apply_style(*new_specified_css_values);
     if (diff == StyleDifference::NeedsRelayout) {
-        document().set_needs_layout();
+        layout_node()->set_needs_layout();
         return;
     }
     if (diff == StyleDifference::NeedsRepaint) {
@@ -337,6 +358,8 @@ void Element::set_shadow_root(RefPtr<ShadowRoot> shadow_root)
         return;
     m_shadow_root = move(shadow_root);
     invalidate_style();
+    if (layout_node())
+        document().invalidate_layout_tree();
 }
 
 NonnullRefPtr<CSS::CSSStyleDeclaration> Element::style_for_bindings()
@@ -309,6 +309,9 @@ void Node::insert_before(NonnullRefPtr<Node> node, RefPtr<Node> child, bool supp
         // FIXME: queue a tree mutation record for parent with nodes, « », previousSibling, and child.
     }
 
+    if (layout_node())
+        document().invalidate_layout_tree();
+
     children_changed();
 }
 
@@ -393,6 +396,9 @@ void Node::remove(bool suppress_observers)
         // FIXME: queue a tree mutation record for parent with « », « node », oldPreviousSibling, and oldNextSibling.
     }
 
+    if (parent->layout_node())
+        document().invalidate_layout_tree();
+
     parent->children_changed();
 }
 
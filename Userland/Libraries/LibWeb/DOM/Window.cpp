@@ -119,6 +119,18 @@ Window::~Window()
 {
 }
 
+Bindings::WindowObject* Window::wrapper()
+{
+    if (m_wrapper && m_wrapper->is_pending_destruction())
+        return nullptr;
+    return m_wrapper;
+}
+
+Bindings::WindowObject const* Window::wrapper() const
+{
+    return const_cast<Window&>(*this).wrapper();
+}
+
 void Window::set_wrapper(Badge<Bindings::WindowObject>, Bindings::WindowObject& wrapper)
 {
     m_wrapper = wrapper.make_weak_ptr();
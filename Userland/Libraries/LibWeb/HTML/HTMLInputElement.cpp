@@ -41,6 +41,15 @@ void HTMLInputElement::did_click_button(Badge<Layout::ButtonBox>)
     }
 }
 
+void HTMLInputElement::parse_attribute(FlyString const& name, String const& value)
+{
+    HTMLElement::parse_attribute(name, value);
+
+    // The type decides what kind of layout node we get.
+    if (name == HTML::AttributeNames::type && layout_node())
+        document().invalidate_layout_tree();
+}
+
 RefPtr<Layout::Node> HTMLInputElement::create_layout_node()
 {
     if (type() == "hidden")
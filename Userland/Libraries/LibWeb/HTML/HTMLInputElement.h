@@ -37,6 +37,9 @@ public:
     void did_click_button(Badge<Layout::ButtonBox>);
 
 private:
+    // ^DOM::Element
+    virtual void parse_attribute(FlyString const& name, String const& value) override;
+
     // ^DOM::Node
     virtual void inserted() override;
     virtual void removed_from(Node*) override;
@@ -21,11 +21,15 @@ HTMLObjectElement::HTMLObjectElement(DOM::Document& document, QualifiedName qual
     m_image_loader.on_load = [this] {
         m_should_show_fallback_content = false;
         set_needs_style_update(true);
+        if (layout_node())
+            this->document().invalidate_layout_tree();
     };
 
     m_image_loader.on_fail = [this] {
         m_should_show_fallback_content = true;
         set_needs_style_update(true);
+        if (layout_node())
+            this->document().invalidate_layout_tree();
     };
 }
 
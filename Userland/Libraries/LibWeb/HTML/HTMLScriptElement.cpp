@@ -291,28 +291,9 @@ void HTMLScriptElement::prepare_script()
         if (m_script_type == ScriptType::Classic) {
             // -> "classic"
             //    Fetch a classic script given url, settings object, options, classic script CORS setting, and encoding.
+            //    NOTE: This goes through the resource cache, so we pick up anything the parser's preload scanner has already fetched.
             auto request = LoadRequest::create_for_url_on_page(url, document().page());
-
-            ResourceLoader::the().load(
-                request,
-                [this, url](auto data, auto&, auto) {
-                    if (data.is_null()) {
-                        dbgln("HTMLScriptElement: Failed to load {}", url);
-                        return;
-                    }
-
-                    // FIXME: This is all ad-hoc and needs work.
-                    auto script = ClassicScript::create(url.to_string(), data, document().realm(), AK::URL());
-
-                    // When the chosen algorithm asynchronously completes, set the script's script to the result. At that time, the script is ready.
-                    m_script = script;
-                    script_became_ready();
-                },
-                [this](auto&, auto) {
-                    m_failed_to_load = true;
-                    dbgln("HONK! Failed to load script, but ready nonetheless.");
-                    script_became_ready();
-                });
+            set_resource(ResourceLoader::the().load_resource(Resource::Type::Generic, request));
         } else if (m_script_type == ScriptType::Module) {
             // FIXME: -> "module"
             //        Fetch an external module script graph given url, settings object, and options.
@@ -437,6 +418,25 @@ void HTMLScriptElement::prepare_script()
     }
 }
 
+void HTMLScriptElement::resource_did_load()
+{
+    VERIFY(resource());
+
+    // FIXME: This is all ad-hoc and needs work.
+    auto script = ClassicScript::create(resource()->url().to_string(), resource()->encoded_data(), document().realm(), AK::URL());
+
+    // When the chosen algorithm asynchronously completes, set the script's script to the result. At that time, the script is ready.
+    m_script = script;
+    script_became_ready();
+}
+
+void HTMLScriptElement::resource_did_fail()
+{
+    m_failed_to_load = true;
+    dbgln("HONK! Failed to load script, but ready nonetheless.");
+    script_became_ready();
+}
+
 void HTMLScriptElement::script_became_ready()
 {
     m_script_ready = true;
@@ -27,6 +27,7 @@
 #include <LibWeb/HTML/Parser/HTMLEncodingDetection.h>
 #include <LibWeb/HTML/Parser/HTMLParser.h>
 #include <LibWeb/HTML/Parser/HTMLToken.h>
+#include <LibWeb/HTML/Parser/PreloadScanner.h>
 #include <LibWeb/Namespace.h>
 #include <LibWeb/SVG/TagNames.h>
 
@@ -141,6 +142,17 @@ HTMLParser::~HTMLParser()
     m_document->set_should_invalidate_styles_on_attribute_changes(true);
 }
 
+void HTMLParser::run_preload_scanner()
+{
+    // Nothing can add to the input while we're blocked, so whatever is left only ever has to be scanned once.
+    if (m_has_run_preload_scanner)
+        return;
+    m_has_run_preload_scanner = true;
+
+    PreloadScanner preload_scanner(document(), m_tokenizer.remaining_input());
+    preload_scanner.run();
+}
+
 void HTMLParser::run(const AK::URL& url)
 {
     m_document->set_url(url);
@@ -2020,6 +2032,8 @@ void HTMLParser::handle_text(HTMLToken& token)
                 // that is blocking scripts and the script's "ready to be parser-executed"
                 // flag is set.
                 if (m_document->has_a_style_sheet_that_is_blocking_scripts() || !script->is_ready_to_be_parser_executed()) {
+                    // While we wait, start fetching what the rest of the document is going to need.
+                    run_preload_scanner();
                     main_thread_event_loop().spin_until([&] {
                         return !m_document->has_a_style_sheet_that_is_blocking_scripts() && script->is_ready_to_be_parser_executed();
                     });
@@ -70,6 +70,8 @@ private:
 
     DOM::QuirksMode which_quirks_mode(const HTMLToken&) const;
 
+    void run_preload_scanner();
+
     void handle_initial(HTMLToken&);
     void handle_before_html(HTMLToken&);
     void handle_before_head(HTMLToken&);
@@ -162,6 +164,7 @@ private:
     bool m_aborted { false };
     bool m_parser_pause_flag { false };
     bool m_stop_parsing { false };
+    bool m_has_run_preload_scanner { false };
     size_t m_script_nesting_level { 0 };
 
     NonnullRefPtr<DOM::Document> m_document;
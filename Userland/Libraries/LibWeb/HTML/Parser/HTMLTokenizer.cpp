@@ -5,7 +5,9 @@
  */
 
 #include <AK/CharacterTypes.h>
+#include <AK/BuiltinWrappers.h>
 #include <AK/Debug.h>
+#include <AK/SIMD.h>
 #include <AK/SourceLocation.h>
 #include <LibTextCodec/Decoder.h>
 #include <LibWeb/HTML/Parser/Entities.h>
@@ -224,6 +226,85 @@ HTMLToken::Position HTMLTokenizer::nth_last_position(size_t n)
     return m_source_positions.at(m_source_positions.size() - 1 - n);
 }
 
+// Returns the length of the run of ASCII characters at the start of the input that doesn't contain any of the stop
+// characters or NUL. This looks at 16 bytes at a time, as the runs are usually long.
+template<char... stop_characters>
+static size_t length_of_plain_ascii_run(ReadonlyBytes input)
+{
+    using AK::SIMD::u8x16;
+
+    size_t offset = 0;
+    for (; offset + sizeof(u8x16) <= input.size(); offset += sizeof(u8x16)) {
+        u8x16 bytes;
+        memcpy(&bytes, input.offset_pointer(offset), sizeof(bytes));
+
+        // Every lane that compares true is all ones. Subtracting one wraps NUL around, so one comparison catches it along
+        // with all non-ASCII bytes.
+        auto stops = (bytes - 1) >= 0x7f;
+        ((stops |= bytes == static_cast<u8>(stop_characters)), ...);
+
+        u64 halves[2];
+        memcpy(halves, &stops, sizeof(halves));
+        if (halves[0] != 0)
+            return offset + count_trailing_zeroes(halves[0]) / 8;
+        if (halves[1] != 0)
+            return offset + 8 + count_trailing_zeroes(halves[1]) / 8;
+    }
+
+    for (; offset < input.size(); ++offset) {
+        auto byte = input[offset];
+        if (byte == 0 || byte >= 0x80 || ((byte == static_cast<u8>(stop_characters)) || ...))
+            break;
+    }
+    return offset;
+}
+
+template<char... stop_characters>
+StringView HTMLTokenizer::consume_plain_ascii_text(size_t max_length)
+{
+    auto offset = m_utf8_view.byte_offset_of(m_utf8_iterator);
+    auto input = m_decoded_input.bytes().slice(offset);
+    auto length = length_of_plain_ascii_run<stop_characters...>(input.trim(max_length));
+    if (length == 0)
+        return {};
+
+    // Every byte is a code point of its own, so there's no need to decode anything.
+    StringView text { input.trim(length) };
+    auto position = m_source_positions.last();
+    for (auto ch : text) {
+        if (ch == '\n') {
+            position.column = 0;
+            position.line++;
+        } else {
+            position.column++;
+        }
+    }
+    m_source_positions.append(position);
+    m_prev_utf8_iterator = m_utf8_view.iterator_at_byte_offset_without_validation(offset + length - 1);
+    m_utf8_iterator = m_utf8_view.iterator_at_byte_offset_without_validation(offset + length);
+    return text;
+}
+
+template<char... stop_characters>
+void HTMLTokenizer::queue_plain_ascii_character_tokens()
+{
+    // Every character becomes a token of its own, so don't run too far ahead of the tree builder.
+    static constexpr size_t max_queued_characters = 256;
+
+    auto position = m_source_positions.last();
+    for (auto ch : consume_plain_ascii_text<stop_characters...>(max_queued_characters)) {
+        if (ch == '\n') {
+            position.column = 0;
+            position.line++;
+        } else {
+            position.column++;
+        }
+        auto token = HTMLToken::make_character(ch);
+        token.set_start_position({}, position);
+        m_queued_tokens.enqueue(move(token));
+    }
+}
+
 Optional<HTMLToken> HTMLTokenizer::next_token()
 {
     {
@@ -260,7 +341,11 @@ _StartOfFunction:
                 }
                 ANYTHING_ELSE
                 {
-                    EMIT_CURRENT_CHARACTER;
+                    create_new_token(HTMLToken::Type::Character);
+                    m_current_token.set_code_point(current_input_character.value());
+                    m_queued_tokens.enqueue(move(m_current_token));
+                    queue_plain_ascii_character_tokens<'&', '<'>();
+                    return m_queued_tokens.dequeue();
                 }
             }
             END_STATE
@@ -1196,6 +1281,7 @@ _StartOfFunction:
                 ANYTHING_ELSE
                 {
                     m_current_builder.append_code_point(current_input_character.value());
+                    m_current_builder.append(consume_plain_ascii_text<'"', '&'>());
                     continue;
                 }
             }
@@ -1227,6 +1313,7 @@ _StartOfFunction:
                 ANYTHING_ELSE
                 {
                     m_current_builder.append_code_point(current_input_character.value());
+                    m_current_builder.append(consume_plain_ascii_text<'\'', '&'>());
                     continue;
                 }
             }
@@ -1291,6 +1378,7 @@ _StartOfFunction:
                 {
                 AnythingElseAttributeValueUnquoted:
                     m_current_builder.append_code_point(current_input_character.value());
+                    m_current_builder.append(consume_plain_ascii_text<'\t', '\n', '\f', ' ', '&', '>', '"', '\'', '<', '=', '`'>());
                     continue;
                 }
             }
@@ -1816,7 +1904,11 @@ _StartOfFunction:
                 }
                 ANYTHING_ELSE
                 {
-                    EMIT_CURRENT_CHARACTER;
+                    create_new_token(HTMLToken::Type::Character);
+                    m_current_token.set_code_point(current_input_character.value());
+                    m_queued_tokens.enqueue(move(m_current_token));
+                    queue_plain_ascii_character_tokens<'&', '<'>();
+                    return m_queued_tokens.dequeue();
                 }
             }
             END_STATE
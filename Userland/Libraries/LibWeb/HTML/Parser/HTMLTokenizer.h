@@ -121,6 +121,9 @@ public:
 
     String source() const { return m_decoded_input; }
 
+    // The part of the input that hasn't been consumed yet.
+    StringView remaining_input() const { return m_decoded_input.substring_view(m_utf8_view.byte_offset_of(m_utf8_iterator)); }
+
 private:
     void skip(size_t count);
     Optional<u32> next_code_point();
@@ -130,6 +133,13 @@ private:
     bool current_end_tag_token_is_appropriate() const;
     String consume_current_builder();
 
+    // Plain text makes up most of a typical document, so the states where it's common consume it in bulk.
+    // These take the run of ASCII characters up to the next NUL, non-ASCII or stop character.
+    template<char... stop_characters>
+    StringView consume_plain_ascii_text(size_t max_length = NumericLimits<size_t>::max());
+    template<char... stop_characters>
+    void queue_plain_ascii_character_tokens();
+
     static char const* state_name(State state)
     {
         switch (state) {
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <LibWeb/DOM/Document.h>
+#include <LibWeb/HTML/AttributeNames.h>
+#include <LibWeb/HTML/Parser/HTMLToken.h>
+#include <LibWeb/HTML/Parser/PreloadScanner.h>
+#include <LibWeb/HTML/TagNames.h>
+#include <LibWeb/Loader/ResourceLoader.h>
+
+namespace Web::HTML {
+
+PreloadScanner::PreloadScanner(DOM::Document& document, StringView input)
+    : m_document(document)
+    , m_tokenizer(input, "utf-8")
+{
+}
+
+static bool is_stylesheet_link(HTMLToken& token)
+{
+    bool is_stylesheet = false;
+    bool is_alternate = false;
+    token.attribute(HTML::AttributeNames::rel).for_each_split_view(' ', false, [&](auto part) {
+        if (part.equals_ignoring_case("stylesheet"sv))
+            is_stylesheet = true;
+        else if (part.equals_ignoring_case("alternate"sv))
+            is_alternate = true;
+    });
+    return is_stylesheet && !is_alternate;
+}
+
+static bool is_classic_script(HTMLToken& token)
+{
+    if (token.has_attribute(HTML::AttributeNames::nomodule))
+        return false;
+    auto type = token.attribute(HTML::AttributeNames::type).trim_whitespace();
+    return type.is_empty() || type.equals_ignoring_case("text/javascript"sv) || type.equals_ignoring_case("application/javascript"sv);
+}
+
+void PreloadScanner::run()
+{
+    for (;;) {
+        auto token = m_tokenizer.next_token();
+        if (!token.has_value() || token->is_end_of_file())
+            break;
+        if (!token->is_start_tag())
+            continue;
+
+        auto const& tag_name = token->tag_name();
+        if (tag_name == HTML::TagNames::script) {
+            if (token->has_attribute(HTML::AttributeNames::src) && is_classic_script(*token))
+                preload(Resource::Type::Generic, token->attribute(HTML::AttributeNames::src));
+            m_tokenizer.switch_to(HTMLTokenizer::State::ScriptData);
+        } else if (tag_name == HTML::TagNames::link) {
+            if (is_stylesheet_link(*token))
+                preload(Resource::Type::Generic, token->attribute(HTML::AttributeNames::href));
+        } else if (tag_name == HTML::TagNames::img) {
+            if (token->has_attribute(HTML::AttributeNames::src))
+                preload(Resource::Type::Image, token->attribute(HTML::AttributeNames::src));
+        } else if (tag_name.is_one_of(HTML::TagNames::style, HTML::TagNames::xmp, HTML::TagNames::iframe, HTML::TagNames::noembed, HTML::TagNames::noframes)) {
+            m_tokenizer.switch_to(HTMLTokenizer::State::RAWTEXT);
+        } else if (tag_name.is_one_of(HTML::TagNames::title, HTML::TagNames::textarea)) {
+            m_tokenizer.switch_to(HTMLTokenizer::State::RCDATA);
+        } else if (tag_name == HTML::TagNames::plaintext) {
+            break;
+        }
+    }
+}
+
+void PreloadScanner::preload(Resource::Type type, StringView url_string)
+{
+    auto url = m_document.parse_url(url_string.trim_whitespace());
+    if (!url.is_valid())
+        return;
+
+    // Anything that doesn't go through the cache would only be fetched twice.
+    if (!ResourceLoader::is_cacheable(url))
+        return;
+
+    dbgln_if(PARSER_DEBUG, "PreloadScanner: Preloading {}", url);
+    auto request = LoadRequest::create_for_url_on_page(url, m_document.page());
+    (void)ResourceLoader::the().load_resource(type, request);
+}
+
+}
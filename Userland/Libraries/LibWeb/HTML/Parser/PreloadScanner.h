@@ -0,0 +1,33 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/StringView.h>
+#include <LibWeb/Forward.h>
+#include <LibWeb/HTML/Parser/HTMLTokenizer.h>
+#include <LibWeb/Loader/Resource.h>
+
+namespace Web::HTML {
+
+// Tokenizes input ahead of the parser while the parser is blocked on a script, and starts fetching the scripts,
+// style sheets and images it finds. The fetched resources land in the ResourceLoader cache, where the elements
+// pick them up once the parser gets to them.
+// NOTE: This doesn't build a tree, so its idea of where raw text starts and stops is only a good guess.
+class PreloadScanner {
+public:
+    PreloadScanner(DOM::Document&, StringView input);
+
+    void run();
+
+private:
+    void preload(Resource::Type, StringView url);
+
+    DOM::Document& m_document;
+    HTMLTokenizer m_tokenizer;
+};
+
+}
@@ -6,10 +6,71 @@
 
 #include <LibCore/ElapsedTimer.h>
 #include <LibJS/Interpreter.h>
+#include <LibJS/Lexer.h>
 #include <LibWeb/HTML/Scripting/ClassicScript.h>
 
 namespace Web::HTML {
 
+// Library scripts tend to be loaded over and over with the exact same source text, by reloads and by navigating
+// between pages of the same site. Their parse nodes don't depend on the realm they run in, so we keep the most
+// recently used ones around and give them to every new script record for the same filename and source text.
+struct ClassicScript::CachedParseNode : public RefCounted<CachedParseNode> {
+    CachedParseNode(String filename, String source, unsigned source_hash, NonnullRefPtr<JS::Program> parse_node)
+        : filename(move(filename))
+        , source(move(source))
+        , source_hash(source_hash)
+        , parse_node(move(parse_node))
+    {
+    }
+
+    // Source ranges in the parse node point into the filename, so each cache entry carries its own copy.
+    String filename;
+    String source;
+    unsigned source_hash { 0 };
+    NonnullRefPtr<JS::Program> parse_node;
+};
+
+// Small scripts are quick to parse anyway, and would only push the big ones out of the cache.
+static constexpr size_t minimum_cached_source_length = 4 * KiB;
+static constexpr size_t max_cached_parse_nodes = 32;
+
+// Ordered from least to most recently used.
+static Vector<NonnullRefPtr<ClassicScript::CachedParseNode>>& cached_parse_nodes()
+{
+    static Vector<NonnullRefPtr<ClassicScript::CachedParseNode>> cache;
+    return cache;
+}
+
+static RefPtr<ClassicScript::CachedParseNode> find_cached_parse_node(String const& filename, StringView source, unsigned source_hash)
+{
+    auto& cache = cached_parse_nodes();
+    for (size_t i = 0; i < cache.size(); ++i) {
+        auto& entry = cache[i];
+        if (entry->source_hash != source_hash || entry->filename != filename || entry->source != source)
+            continue;
+        auto found_entry = cache.take(i);
+        cache.append(found_entry);
+        return found_entry;
+    }
+    return nullptr;
+}
+
+static RefPtr<ClassicScript::CachedParseNode> parse_and_cache(String const& filename, StringView source, unsigned source_hash)
+{
+    auto entry_filename = filename;
+    auto parser = JS::Parser(JS::Lexer(source, entry_filename));
+    auto parse_node = parser.parse_program();
+    if (parser.has_errors())
+        return nullptr;
+
+    auto entry = adopt_ref(*new ClassicScript::CachedParseNode(move(entry_filename), source, source_hash, move(parse_node)));
+    auto& cache = cached_parse_nodes();
+    if (cache.size() >= max_cached_parse_nodes)
+        cache.take_first();
+    cache.append(entry);
+    return entry;
+}
+
 // https://html.spec.whatwg.org/multipage/webappapis.html#creating-a-classic-script
 NonnullRefPtr<ClassicScript> ClassicScript::create(String filename, StringView source, JS::Realm& realm, AK::URL base_url, MutedErrors muted_errors)
 {
@@ -37,6 +98,24 @@ NonnullRefPtr<ClassicScript> ClassicScript::create(String filename, StringView s
 
     // 10. Let result be ParseScript(source, settings's Realm, script).
     auto parse_timer = Core::ElapsedTimer::start_new();
+    if (source.length() >= minimum_cached_source_length) {
+        auto source_hash = source.hash();
+        if (auto entry = find_cached_parse_node(script->filename(), source, source_hash)) {
+            dbgln("ClassicScript: Reused parse node for {}", script->filename());
+            script->m_script_record = JS::Script::create(realm, entry->parse_node);
+            script->m_cached_parse_node = move(entry);
+            return script;
+        }
+
+        // NOTE: Sources with errors are not cached, and take the regular path below so their errors are reported.
+        if (auto entry = parse_and_cache(script->filename(), source, source_hash)) {
+            dbgln("ClassicScript: Parsed {} in {}ms", script->filename(), parse_timer.elapsed());
+            script->m_script_record = JS::Script::create(realm, entry->parse_node);
+            script->m_cached_parse_node = move(entry);
+            return script;
+        }
+    }
+
     auto result = JS::Script::parse(source, realm, script->filename());
     dbgln("ClassicScript: Parsed {} in {}ms", script->filename(), parse_timer.elapsed());
 
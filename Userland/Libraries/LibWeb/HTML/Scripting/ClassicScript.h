@@ -31,10 +31,13 @@ public:
     };
     JS::Value run(RethrowErrors = RethrowErrors::No);
 
+    struct CachedParseNode;
+
 private:
     ClassicScript(AK::URL base_url, String filename);
 
     RefPtr<JS::Script> m_script_record;
+    RefPtr<CachedParseNode> m_cached_parse_node;
     MutedErrors m_muted_errors { MutedErrors::No };
 };
 
@@ -379,6 +379,28 @@ void BlockFormattingContext::layout_inline_children(BlockContainer& block_contai
     context.run(block_container, layout_mode);
 }
 
+// Floating and absolutely positioned boxes take part in the layout of boxes outside of their parent.
+bool BlockFormattingContext::is_self_contained_for_layout(Box const& box)
+{
+    bool is_self_contained = true;
+    box.for_each_in_subtree([&](auto& descendant) {
+        if (descendant.is_floating() || descendant.is_absolutely_positioned()) {
+            is_self_contained = false;
+            return IterationDecision::Break;
+        }
+        return IterationDecision::Continue;
+    });
+    return is_self_contained;
+}
+
+bool BlockFormattingContext::can_reuse_layout_inside(Box const& box, LayoutMode layout_mode)
+{
+    if (layout_mode != LayoutMode::Default || box.needs_layout())
+        return false;
+    auto width_at_last_layout = box.width_at_last_self_contained_layout();
+    return width_at_last_layout.has_value() && width_at_last_layout.value() == box.width();
+}
+
 void BlockFormattingContext::layout_block_level_children(BlockContainer& block_container, LayoutMode layout_mode)
 {
     float content_height = 0;
@@ -398,7 +420,11 @@ void BlockFormattingContext::layout_block_level_children(BlockContainer& block_c
         }
 
         compute_width(child_box);
-        (void)layout_inside(child_box, layout_mode);
+        if (!can_reuse_layout_inside(child_box, layout_mode)) {
+            (void)layout_inside(child_box, layout_mode);
+            if (layout_mode == LayoutMode::Default && is_self_contained_for_layout(child_box))
+                child_box.set_width_at_last_self_contained_layout(child_box.width());
+        }
         compute_height(child_box);
 
         if (child_box.computed_values().position() == CSS::Position::Relative)
@@ -47,6 +47,8 @@ private:
     void layout_initial_containing_block(LayoutMode);
 
     void layout_block_level_children(BlockContainer&, LayoutMode);
+    static bool is_self_contained_for_layout(Box const&);
+    static bool can_reuse_layout_inside(Box const&, LayoutMode);
     void layout_inline_children(BlockContainer&, LayoutMode);
 
     void place_block_level_replaced_element_in_normal_flow(Box& child, BlockContainer const&);
@@ -160,7 +160,15 @@ HitTestResult Box::hit_test(const Gfx::IntPoint& position, HitTestType type) con
 void Box::set_needs_display()
 {
     if (!is_inline()) {
-        browsing_context().set_needs_display(enclosing_int_rect(absolute_rect()));
+        // Backgrounds, borders and shadows are painted outside of the content box as well.
+        auto rect = enclosing_int_rect(bordered_rect());
+        if (auto box_shadow_data = computed_values().box_shadow(); box_shadow_data.has_value()) {
+            auto offset_x = (int)box_shadow_data->offset_x.resolved_or_zero(*this, width()).to_px(*this);
+            auto offset_y = (int)box_shadow_data->offset_y.resolved_or_zero(*this, width()).to_px(*this);
+            auto blur_radius = (int)box_shadow_data->blur_radius.resolved_or_zero(*this, width()).to_px(*this);
+            rect = rect.united(rect.translated(offset_x, offset_y).inflated(blur_radius * 2, blur_radius * 2));
+        }
+        browsing_context().set_needs_display(rect);
         return;
     }
 
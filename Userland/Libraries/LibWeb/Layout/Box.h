@@ -161,6 +161,12 @@ public:
 
     void clear_overflow_data() { m_overflow_data = nullptr; }
 
+    // The width this box had when its contents were last laid out in normal flow, if nothing inside it depends
+    // on boxes outside of it. If the box doesn't need layout and has the same width again, the layout of its
+    // contents can be reused as is.
+    Optional<float> width_at_last_self_contained_layout() const { return m_width_at_last_self_contained_layout; }
+    void set_width_at_last_self_contained_layout(Optional<float> width) { m_width_at_last_self_contained_layout = width; }
+
     virtual void before_children_paint(PaintContext&, PaintPhase) override;
     virtual void after_children_paint(PaintContext&, PaintPhase) override;
 
@@ -189,6 +195,8 @@ private:
     OwnPtr<StackingContext> m_stacking_context;
 
     OwnPtr<OverflowData> m_overflow_data;
+
+    Optional<float> m_width_at_last_self_contained_layout;
 };
 
 template<>
@@ -109,6 +109,8 @@ OwnPtr<FormattingContext> FormattingContext::layout_inside(Box& child_box, Layou
     if (!child_box.can_have_children())
         return {};
 
+    child_box.set_width_at_last_self_contained_layout({});
+
     auto independent_formatting_context = create_independent_formatting_context_if_needed(child_box);
     if (independent_formatting_context)
         independent_formatting_context->run(child_box, layout_mode);
@@ -152,6 +152,28 @@ Gfx::FloatPoint Node::box_type_agnostic_position() const
     return position;
 }
 
+void Node::set_needs_layout()
+{
+    for_each_in_inclusive_subtree([](auto& node) {
+        node.m_needs_layout = true;
+        return IterationDecision::Continue;
+    });
+    for (auto* ancestor = parent(); ancestor && !ancestor->m_needs_layout; ancestor = ancestor->parent())
+        ancestor->m_needs_layout = true;
+    document().set_needs_layout({});
+}
+
+void Node::clear_needs_layout()
+{
+    // The ancestors of a node that needs layout always need layout as well, so we only have to look inside those.
+    if (!m_needs_layout)
+        return;
+    m_needs_layout = false;
+    for_each_child([](auto& child) {
+        child.clear_needs_layout();
+    });
+}
+
 bool Node::is_floating() const
 {
     if (!has_style())
@@ -141,6 +141,12 @@ public:
 
     virtual void set_needs_display();
 
+    // Whether this node, or anything in its subtree, has to be laid out again.
+    // Marking a node marks its whole subtree, as well as its ancestors.
+    bool needs_layout() const { return m_needs_layout; }
+    void set_needs_layout();
+    void clear_needs_layout();
+
     bool children_are_inline() const { return m_children_are_inline; }
     void set_children_are_inline(bool value) { m_children_are_inline = value; }
 
@@ -189,6 +195,7 @@ private:
     bool m_has_style { false };
     bool m_visible { true };
     bool m_children_are_inline { false };
+    bool m_needs_layout { true };
     SelectionState m_selection_state { SelectionState::None };
 
     bool m_is_flex_item { false };
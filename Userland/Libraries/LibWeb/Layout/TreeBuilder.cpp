@@ -6,6 +6,7 @@
 
 #include <AK/Optional.h>
 #include <AK/TemporaryChange.h>
+#include <LibWeb/CSS/StyleComputer.h>
 #include <LibWeb/DOM/Document.h>
 #include <LibWeb/DOM/Element.h>
 #include <LibWeb/DOM/ParentNode.h>
@@ -120,12 +121,17 @@ void TreeBuilder::create_layout_tree(DOM::Node& dom_node, TreeBuilder::Context&
     auto* shadow_root = is<DOM::Element>(dom_node) ? verify_cast<DOM::Element>(dom_node).shadow_root() : nullptr;
 
     if ((dom_node.has_children() || shadow_root) && layout_node->can_have_children()) {
+        auto* element = is<DOM::Element>(dom_node) ? &verify_cast<DOM::Element>(dom_node) : nullptr;
         push_parent(verify_cast<NodeWithStyle>(*layout_node));
+        if (element)
+            dom_node.document().style_computer().push_ancestor(*element);
         if (shadow_root)
             create_layout_tree(*shadow_root, context);
         verify_cast<DOM::ParentNode>(dom_node).for_each_child([&](auto& dom_child) {
             create_layout_tree(dom_child, context);
         });
+        if (element)
+            dom_node.document().style_computer().pop_ancestor(*element);
         pop_parent();
     }
 }
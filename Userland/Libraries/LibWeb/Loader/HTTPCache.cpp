@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <LibCore/DateTime.h>
+#include <LibWeb/Loader/HTTPCache.h>
+
+namespace Web {
+
+static constexpr size_t max_cache_size_in_bytes = 64 * MiB;
+static constexpr size_t max_entry_size_in_bytes = 8 * MiB;
+
+static String cache_key(AK::URL const& url)
+{
+    // The fragment is never sent to the server, so it doesn't matter for caching.
+    auto url_without_fragment = url;
+    url_without_fragment.set_fragment({});
+    return url_without_fragment.to_string();
+}
+
+// https://httpwg.org/specs/rfc9110.html#http.date
+static Optional<Core::DateTime> parse_http_date(Optional<String> const& value)
+{
+    if (!value.has_value())
+        return {};
+    // NOTE: We only accept the preferred IMF-fixdate format, as the obsolete formats are rare in practice.
+    return Core::DateTime::parse("%a, %d %b %Y %H:%M:%S GMT", value->trim_whitespace());
+}
+
+struct CacheControl {
+    bool no_store { false };
+    bool no_cache { false };
+    bool must_revalidate { false };
+    Optional<i64> max_age;
+};
+
+// https://httpwg.org/specs/rfc9111.html#field.cache-control
+static CacheControl parse_cache_control(HTTPCache::Headers const& headers)
+{
+    CacheControl cache_control;
+    auto value = headers.get("Cache-Control");
+    if (!value.has_value()) {
+        // https://httpwg.org/specs/rfc9111.html#field.pragma
+        if (auto pragma = headers.get("Pragma"); pragma.has_value() && pragma->contains("no-cache"sv, CaseSensitivity::CaseInsensitive))
+            cache_control.no_cache = true;
+        return cache_control;
+    }
+
+    for (auto directive : value->split_view(',')) {
+        directive = directive.trim_whitespace();
+        auto name = directive;
+        StringView argument;
+        if (auto equals = directive.find('='); equals.has_value()) {
+            name = directive.substring_view(0, *equals).trim_whitespace();
+            argument = directive.substring_view(*equals + 1).trim_whitespace();
+            if (argument.length() >= 2 && argument.starts_with('"') && argument.ends_with('"'))
+                argument = argument.substring_view(1, argument.length() - 2);
+        }
+
+        if (name.equals_ignoring_case("no-store"sv)) {
+            cache_control.no_store = true;
+        } else if (name.equals_ignoring_case("no-cache"sv)) {
+            cache_control.no_cache = true;
+        } else if (name.equals_ignoring_case("must-revalidate"sv)) {
+            cache_control.must_revalidate = true;
+        } else if (name.equals_ignoring_case("max-age"sv)) {
+            // A max-age we can't make sense of makes the response stale.
+            auto max_age = argument.to_uint<u32>();
+            cache_control.max_age = max_age.has_value() ? *max_age : 0;
+        }
+    }
+    return cache_control;
+}
+
+// https://httpwg.org/specs/rfc9111.html#response.cacheability
+static bool is_storable(CacheControl const& cache_control, HTTPCache::Headers const& headers, Optional<u32> status_code)
+{
+    if (cache_control.no_store)
+        return false;
+    if (!status_code.has_value() || (*status_code != 200 && *status_code != 203 && *status_code != 301))
+        return false;
+    // We always send the same request headers, so only Accept-Encoding can make a difference.
+    if (auto vary = headers.get("Vary"); vary.has_value() && !vary->trim_whitespace().equals_ignoring_case("Accept-Encoding"sv))
+        return false;
+    return true;
+}
+
+bool HTTPCache::update_freshness(Entry& entry)
+{
+    auto cache_control = parse_cache_control(entry.headers);
+    if (!is_storable(cache_control, entry.headers, entry.status_code))
+        return false;
+
+    auto date = parse_http_date(entry.headers.get("Date"));
+    auto date_timestamp = date.has_value() ? date->timestamp() : Core::DateTime::now().timestamp();
+
+    // https://httpwg.org/specs/rfc9111.html#calculating.freshness.lifetime
+    if (cache_control.max_age.has_value()) {
+        entry.freshness_lifetime = Time::from_seconds(*cache_control.max_age);
+    } else if (auto expires = parse_http_date(entry.headers.get("Expires")); expires.has_value()) {
+        entry.freshness_lifetime = Time::from_seconds(max<i64>(0, expires->timestamp() - date_timestamp));
+    } else if (auto last_modified = parse_http_date(entry.headers.get("Last-Modified")); last_modified.has_value()) {
+        // https://httpwg.org/specs/rfc9111.html#heuristic.freshness
+        entry.freshness_lifetime = Time::from_seconds(max<i64>(0, date_timestamp - last_modified->timestamp()) / 10);
+    } else {
+        entry.freshness_lifetime = {};
+    }
+
+    // https://httpwg.org/specs/rfc9111.html#age.calculations
+    auto age = entry.headers.get("Age").value_or({}).to_uint<u32>();
+    entry.initial_age = Time::from_seconds(age.value_or(0));
+    entry.age_timer.start();
+    entry.must_revalidate = cache_control.no_cache;
+
+    // There's no point in keeping a stale response that can't be revalidated.
+    return entry.is_fresh() || entry.has_validator();
+}
+
+HTTPCache::Entry const* HTTPCache::find(AK::URL const& url) const
+{
+    auto it = m_entries.find(cache_key(url));
+    if (it == m_entries.end())
+        return nullptr;
+    return it->value.ptr();
+}
+
+void HTTPCache::add_validation_headers(Entry const& entry, HashMap<String, String>& request_headers)
+{
+    // https://httpwg.org/specs/rfc9111.html#validation.sent
+    if (auto etag = entry.headers.get("ETag"); etag.has_value())
+        request_headers.set("If-None-Match", *etag);
+    if (auto last_modified = entry.headers.get("Last-Modified"); last_modified.has_value())
+        request_headers.set("If-Modified-Since", *last_modified);
+}
+
+void HTTPCache::store(AK::URL const& url, ReadonlyBytes body, Headers const& headers, Optional<u32> status_code)
+{
+    remove(url);
+
+    if (body.size() > max_entry_size_in_bytes)
+        return;
+
+    auto body_copy = ByteBuffer::copy(body);
+    if (!body_copy.has_value())
+        return;
+
+    auto entry = make<Entry>();
+    entry->body = body_copy.release_value();
+    entry->headers = headers;
+    entry->status_code = status_code;
+    if (!update_freshness(*entry))
+        return;
+
+    dbgln_if(CACHE_DEBUG, "HTTPCache: Storing {} ({} bytes, fresh for {}s)", url, body.size(), entry->freshness_lifetime.to_seconds());
+    evict_until_size_is_at_most(max_cache_size_in_bytes - body.size());
+    entry->serial = m_next_serial++;
+    m_size_in_bytes += entry->body.size();
+    m_entries.set(cache_key(url), move(entry));
+}
+
+// https://httpwg.org/specs/rfc9111.html#freshening.responses
+HTTPCache::Entry const* HTTPCache::did_revalidate(AK::URL const& url, Headers const& headers)
+{
+    auto it = m_entries.find(cache_key(url));
+    if (it == m_entries.end())
+        return nullptr;
+
+    auto& entry = *it->value;
+    for (auto& header : headers) {
+        // These describe the (empty) 304 response itself, and not the stored one.
+        if (header.key.equals_ignoring_case("Content-Length") || header.key.equals_ignoring_case("Content-Encoding") || header.key.equals_ignoring_case("Transfer-Encoding"))
+            continue;
+        entry.headers.set(header.key, header.value);
+    }
+    if (!update_freshness(entry)) {
+        remove(url);
+        return nullptr;
+    }
+    entry.serial = m_next_serial++;
+    dbgln_if(CACHE_DEBUG, "HTTPCache: Revalidated {} (fresh for {}s)", url, entry.freshness_lifetime.to_seconds());
+    return &entry;
+}
+
+void HTTPCache::remove(AK::URL const& url)
+{
+    auto it = m_entries.find(cache_key(url));
+    if (it == m_entries.end())
+        return;
+    m_size_in_bytes -= it->value->body.size();
+    m_entries.remove(it);
+}
+
+void HTTPCache::clear()
+{
+    m_entries.clear();
+    m_size_in_bytes = 0;
+}
+
+void HTTPCache::evict_until_size_is_at_most(size_t size_in_bytes)
+{
+    // Throw out the entries that were stored or revalidated the longest time ago first.
+    while (m_size_in_bytes > size_in_bytes && !m_entries.is_empty()) {
+        auto oldest = m_entries.begin();
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (it->value->serial < oldest->value->serial)
+                oldest = it;
+        }
+        m_size_in_bytes -= oldest->value->body.size();
+        m_entries.remove(oldest);
+    }
+}
+
+}
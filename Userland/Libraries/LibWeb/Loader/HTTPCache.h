@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/HashMap.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/String.h>
+#include <AK/Time.h>
+#include <AK/URL.h>
+#include <LibCore/ElapsedTimer.h>
+
+namespace Web {
+
+// A private, in-memory HTTP cache for responses to GET requests, as described by RFC 9111.
+// Stale responses with a validator (ETag or Last-Modified) are kept around, so that they can be revalidated
+// with a conditional request instead of being fetched again.
+class HTTPCache {
+public:
+    using Headers = HashMap<String, String, CaseInsensitiveStringTraits>;
+
+    struct Entry {
+        ByteBuffer body;
+        Headers headers;
+        Optional<u32> status_code;
+
+        Time freshness_lifetime;
+        Time initial_age;
+        Core::ElapsedTimer age_timer;
+        bool must_revalidate { false };
+        u64 serial { 0 };
+
+        Time current_age() const { return initial_age + age_timer.elapsed_time(); }
+        bool is_fresh() const { return !must_revalidate && current_age() < freshness_lifetime; }
+        bool has_validator() const { return headers.contains("ETag") || headers.contains("Last-Modified"); }
+    };
+
+    Entry const* find(AK::URL const&) const;
+
+    // Adds the headers that turn a request for the stale entry into a conditional request.
+    static void add_validation_headers(Entry const&, HashMap<String, String>& request_headers);
+
+    void store(AK::URL const&, ReadonlyBytes body, Headers const&, Optional<u32> status_code);
+
+    // Updates the entry for a 304 (Not Modified) response. Returns null if there is no entry for the URL anymore.
+    Entry const* did_revalidate(AK::URL const&, Headers const&);
+
+    void remove(AK::URL const&);
+    void clear();
+
+private:
+    static bool update_freshness(Entry&);
+    void evict_until_size_is_at_most(size_t);
+
+    HashMap<String, NonnullOwnPtr<Entry>> m_entries;
+    size_t m_size_in_bytes { 0 };
+    u64 m_next_serial { 0 };
+};
+
+}
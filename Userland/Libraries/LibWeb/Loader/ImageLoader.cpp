@@ -62,6 +62,18 @@ void ImageLoader::resource_did_load()
         }
     }
 
+    // Hold off on telling anyone until the image has been decoded, which happens in the background.
+    resource()->start_decoding();
+    if (!resource()->is_decoding())
+        resource_did_decode();
+}
+
+void ImageLoader::resource_did_decode()
+{
+    // Other clients of the same resource may have been the ones to start decoding it.
+    if (m_loading_state != LoadingState::Loaded)
+        return;
+
     if (resource()->is_animated() && resource()->frame_count() > 1) {
         m_timer->set_interval(resource()->frame_duration(0));
         m_timer->on_timeout = [this] { animate(); };
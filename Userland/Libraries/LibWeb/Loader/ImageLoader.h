@@ -38,6 +38,7 @@ private:
     // ^ImageResourceClient
     virtual void resource_did_load() override;
     virtual void resource_did_fail() override;
+    virtual void resource_did_decode() override;
     virtual bool is_visible_in_viewport() const override { return m_visible_in_viewport; }
 
     void animate();
@@ -4,12 +4,26 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Debug.h>
+#include <LibCore/EventLoop.h>
 #include <LibGfx/Bitmap.h>
 #include <LibWeb/ImageDecoding.h>
 #include <LibWeb/Loader/ImageResource.h>
 
 namespace Web {
 
+// Decoded images are kept around in least recently used order, and the ones that aren't visible get thrown out
+// (to be decoded again when needed) once all of them together take up more memory than this.
+static constexpr size_t decoded_image_budget_in_bytes = 256 * MiB;
+
+IntrusiveList<&ImageResource::m_decoded_images_list_node>& ImageResource::decoded_images()
+{
+    static IntrusiveList<&ImageResource::m_decoded_images_list_node> list;
+    return list;
+}
+
+static size_t s_decoded_size_in_bytes { 0 };
+
 ImageResource::ImageResource(const LoadRequest& request)
     : Resource(Type::Image, request)
 {
@@ -17,6 +31,9 @@ ImageResource::ImageResource(const LoadRequest& request)
 
 ImageResource::~ImageResource()
 {
+    if (m_pending_decode_request_id.has_value())
+        image_decoder_client().cancel_decoding(*m_pending_decode_request_id);
+    discard_decoded_frames();
 }
 
 int ImageResource::frame_duration(size_t frame_index) const
@@ -39,20 +56,112 @@ void ImageResource::decode_if_needed() const
         return;
 
     NonnullRefPtr decoder = image_decoder_client();
+
+    // The frames are needed right now, so don't wait for a background decode to finish. Its clients still expect to
+    // hear about it, but not from under whoever is asking for the frames.
+    if (m_pending_decode_request_id.has_value()) {
+        decoder->cancel_decoding(m_pending_decode_request_id.release_value());
+        Core::deferred_invoke([self = NonnullRefPtr(const_cast<ImageResource&>(*this))]() mutable {
+            self->notify_clients_did_decode();
+        });
+    }
+
     auto image = decoder->decode_image(encoded_data());
+    did_decode(image.has_value() ? &image.value() : nullptr);
+}
+
+void ImageResource::start_decoding()
+{
+    if (!has_encoded_data() || m_has_attempted_decode || !m_decoded_frames.is_empty() || is_decoding())
+        return;
 
-    if (image.has_value()) {
-        m_loop_count = image.value().loop_count;
-        m_animated = image.value().is_animated;
-        m_decoded_frames.resize(image.value().frames.size());
+    m_pending_decode_request_id = image_decoder_client().start_decoding_image(
+        encoded_data(),
+        [this](auto image) {
+            m_pending_decode_request_id.clear();
+            did_decode(&image);
+            notify_clients_did_decode();
+        },
+        [this] {
+            m_pending_decode_request_id.clear();
+            did_decode(nullptr);
+            notify_clients_did_decode();
+        });
+}
+
+void ImageResource::notify_clients_did_decode()
+{
+    for_each_client([](auto& client) {
+        static_cast<ImageResourceClient&>(client).resource_did_decode();
+    });
+}
+
+void ImageResource::did_decode(ImageDecoderClient::DecodedImage const* image) const
+{
+    if (image) {
+        m_loop_count = image->loop_count;
+        m_animated = image->is_animated;
+        m_decoded_frames.resize(image->frames.size());
         for (size_t i = 0; i < m_decoded_frames.size(); ++i) {
             auto& frame = m_decoded_frames[i];
-            frame.bitmap = image.value().frames[i].bitmap;
-            frame.duration = image.value().frames[i].duration;
+            frame.bitmap = image->frames[i].bitmap;
+            frame.duration = image->frames[i].duration;
+            if (frame.bitmap)
+                m_decoded_size_in_bytes += frame.bitmap->size_in_bytes();
         }
     }
 
     m_has_attempted_decode = true;
+
+    if (m_decoded_size_in_bytes == 0)
+        return;
+    s_decoded_size_in_bytes += m_decoded_size_in_bytes;
+    decoded_images().append(const_cast<ImageResource&>(*this));
+    evict_decoded_frames_until_within_budget(*this);
+}
+
+void ImageResource::discard_decoded_frames() const
+{
+    if (m_decoded_images_list_node.is_in_list()) {
+        decoded_images().remove(const_cast<ImageResource&>(*this));
+        s_decoded_size_in_bytes -= m_decoded_size_in_bytes;
+    }
+    m_decoded_size_in_bytes = 0;
+    m_decoded_frames.clear();
+    m_has_attempted_decode = false;
+}
+
+bool ImageResource::is_visible_in_viewport() const
+{
+    bool visible_in_viewport = false;
+    const_cast<ImageResource&>(*this).for_each_client([&](auto& client) {
+        if (static_cast<const ImageResourceClient&>(client).is_visible_in_viewport())
+            visible_in_viewport = true;
+    });
+    return visible_in_viewport;
+}
+
+void ImageResource::did_use_decoded_frames() const
+{
+    if (!m_decoded_images_list_node.is_in_list())
+        return;
+    // Move to the most recently used end of the list.
+    auto& self = const_cast<ImageResource&>(*this);
+    decoded_images().remove(self);
+    decoded_images().append(self);
+}
+
+void ImageResource::evict_decoded_frames_until_within_budget(ImageResource const& keep)
+{
+    auto it = decoded_images().begin();
+    while (s_decoded_size_in_bytes > decoded_image_budget_in_bytes && it != decoded_images().end()) {
+        auto& image = *it;
+        ++it;
+        if (&image == &keep || image.is_visible_in_viewport())
+            continue;
+        dbgln_if(CACHE_DEBUG, "ImageResource: Discarding {} bytes of decoded frames for {}", image.m_decoded_size_in_bytes, image.url());
+        image.discard_decoded_frames();
+    }
 }
 
 const Gfx::Bitmap* ImageResource::bitmap(size_t frame_index) const
@@ -60,18 +169,13 @@ const Gfx::Bitmap* ImageResource::bitmap(size_t frame_index) const
     decode_if_needed();
     if (frame_index >= m_decoded_frames.size())
         return nullptr;
+    did_use_decoded_frames();
     return m_decoded_frames[frame_index].bitmap;
 }
 
 void ImageResource::update_volatility()
 {
-    bool visible_in_viewport = false;
-    for_each_client([&](auto& client) {
-        if (static_cast<const ImageResourceClient&>(client).is_visible_in_viewport())
-            visible_in_viewport = true;
-    });
-
-    if (!visible_in_viewport) {
+    if (!is_visible_in_viewport()) {
         for (auto& frame : m_decoded_frames) {
             if (frame.bitmap)
                 frame.bitmap->set_volatile();
@@ -93,8 +197,7 @@ void ImageResource::update_volatility()
     if (still_has_decoded_image)
         return;
 
-    m_decoded_frames.clear();
-    m_has_attempted_decode = false;
+    discard_decoded_frames();
 }
 
 ImageResourceClient::~ImageResourceClient()
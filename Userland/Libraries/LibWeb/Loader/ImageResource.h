@@ -6,8 +6,13 @@
 
 #pragma once
 
+#include <AK/IntrusiveList.h>
 #include <LibWeb/Loader/Resource.h>
 
+namespace ImageDecoderClient {
+struct DecodedImage;
+}
+
 namespace Web {
 
 class ImageResource final : public Resource {
@@ -41,15 +46,31 @@ public:
 
     void update_volatility();
 
+    // Starts decoding the image in the ImageDecoder service without waiting for it, so that many images can be
+    // decoded at once. Clients are told when it's done through ImageResourceClient::resource_did_decode().
+    void start_decoding();
+    bool is_decoding() const { return m_pending_decode_request_id.has_value(); }
+
 private:
     explicit ImageResource(const LoadRequest&);
 
     void decode_if_needed() const;
+    void did_decode(ImageDecoderClient::DecodedImage const*) const;
+    void notify_clients_did_decode();
+    void discard_decoded_frames() const;
+    bool is_visible_in_viewport() const;
+    void did_use_decoded_frames() const;
+    static void evict_decoded_frames_until_within_budget(ImageResource const& keep);
+
+    mutable IntrusiveListNode<ImageResource> m_decoded_images_list_node;
+    mutable size_t m_decoded_size_in_bytes { 0 };
+    static IntrusiveList<&ImageResource::m_decoded_images_list_node>& decoded_images();
 
     mutable bool m_animated { false };
     mutable int m_loop_count { 0 };
     mutable Vector<Frame> m_decoded_frames;
     mutable bool m_has_attempted_decode { false };
+    mutable Optional<i32> m_pending_decode_request_id;
 };
 
 class ImageResourceClient : public ResourceClient {
@@ -57,6 +78,7 @@ public:
     virtual ~ImageResourceClient();
 
     virtual bool is_visible_in_viewport() const { return false; }
+    virtual void resource_did_decode() { }
 
 protected:
     ImageResource* resource() { return static_cast<ImageResource*>(ResourceClient::resource()); }
@@ -64,17 +64,32 @@ void ResourceLoader::preconnect(AK::URL const& url)
 
 static HashMap<LoadRequest, NonnullRefPtr<Resource>> s_resource_cache;
 
+bool ResourceLoader::is_cacheable(AK::URL const& url)
+{
+    return url.protocol() != "file";
+}
+
 RefPtr<Resource> ResourceLoader::load_resource(Resource::Type type, LoadRequest& request)
 {
     if (!request.is_valid())
         return nullptr;
 
-    bool use_cache = request.url().protocol() != "file";
+    bool use_cache = is_cacheable(request.url());
 
     if (use_cache) {
         auto it = s_resource_cache.find(request);
         if (it != s_resource_cache.end()) {
-            if (it->value->type() != type) {
+            auto& cached_resource = *it->value;
+            // A resource that has finished loading is only as good as the response it was made from.
+            bool is_pending = !cached_resource.is_loaded() && !cached_resource.is_failed();
+            bool may_be_reused = is_pending || !can_use_http_cache_for(request);
+            if (!may_be_reused) {
+                auto const* entry = m_http_cache.find(request.url());
+                may_be_reused = entry && entry->is_fresh();
+            }
+            if (!may_be_reused) {
+                dbgln_if(CACHE_DEBUG, "Not reusing stale cached resource for: {}", request.url());
+            } else if (cached_resource.type() != type) {
                 dbgln("FIXME: Not using cached resource for {} since there's a type mismatch.", request.url());
             } else {
                 dbgln_if(CACHE_DEBUG, "Reusing cached resource for: {}", request.url());
@@ -193,6 +208,21 @@ void ResourceLoader::load(LoadRequest& request, Function<void(ReadonlyBytes, con
     }
 
     if (url.protocol() == "http" || url.protocol() == "https" || url.protocol() == "gemini") {
+        bool use_http_cache = can_use_http_cache_for(request);
+        auto const* cache_entry = use_http_cache ? m_http_cache.find(url) : nullptr;
+        if (cache_entry && cache_entry->is_fresh()) {
+            dbgln_if(CACHE_DEBUG, "ResourceLoader: Using fresh cached response for: {}", url);
+            log_success(request);
+            deferred_invoke([body = cache_entry->body, headers = cache_entry->headers, status_code = cache_entry->status_code, success_callback = move(success_callback)] {
+                success_callback(body, headers, status_code);
+            });
+            return;
+        }
+
+        // Requests with side effects may change what the server would return for the URL.
+        if (!use_http_cache && request.method() != "HEAD")
+            m_http_cache.remove(url);
+
         HashMap<String, String> headers;
         headers.set("User-Agent", m_user_agent);
         headers.set("Accept-Encoding", "gzip, deflate");
@@ -201,6 +231,10 @@ void ResourceLoader::load(LoadRequest& request, Function<void(ReadonlyBytes, con
             headers.set(it.key, it.value);
         }
 
+        bool is_revalidating = cache_entry && cache_entry->has_validator();
+        if (is_revalidating)
+            HTTPCache::add_validation_headers(*cache_entry, headers);
+
         auto protocol_request = protocol_client().start_request(request.method(), url, headers, request.body());
         if (!protocol_request) {
             auto start_request_failure_msg = "Failed to initiate load"sv;
@@ -210,7 +244,7 @@ void ResourceLoader::load(LoadRequest& request, Function<void(ReadonlyBytes, con
             return;
         }
         m_active_requests.set(*protocol_request);
-        protocol_request->on_buffered_request_finish = [this, success_callback = move(success_callback), error_callback = move(error_callback), log_success, log_failure, request, &protocol_request = *protocol_request](bool success, auto, auto& response_headers, auto status_code, ReadonlyBytes payload) {
+        protocol_request->on_buffered_request_finish = [this, success_callback = move(success_callback), error_callback = move(error_callback), log_success, log_failure, request, use_http_cache, is_revalidating, &protocol_request = *protocol_request](bool success, auto, auto& response_headers, auto status_code, ReadonlyBytes payload) {
             --m_pending_loads;
             if (on_load_counter_change)
                 on_load_counter_change();
@@ -222,7 +256,20 @@ void ResourceLoader::load(LoadRequest& request, Function<void(ReadonlyBytes, con
                 return;
             }
             log_success(request);
-            success_callback(payload, response_headers, status_code);
+            if (is_revalidating && status_code == 304) {
+                if (auto const* cache_entry = m_http_cache.did_revalidate(request.url(), response_headers)) {
+                    dbgln_if(CACHE_DEBUG, "ResourceLoader: Cached response is still valid for: {}", request.url());
+                    auto body = cache_entry->body;
+                    auto headers = cache_entry->headers;
+                    success_callback(body, headers, cache_entry->status_code);
+                } else {
+                    success_callback(payload, response_headers, status_code);
+                }
+            } else {
+                if (use_http_cache)
+                    m_http_cache.store(request.url(), payload, response_headers, status_code);
+                success_callback(payload, response_headers, status_code);
+            }
             deferred_invoke([this, &protocol_request] {
                 m_active_requests.remove(protocol_request);
             });
@@ -250,6 +297,21 @@ void ResourceLoader::load(const AK::URL& url, Function<void(ReadonlyBytes, const
     load(request, move(success_callback), move(error_callback));
 }
 
+bool ResourceLoader::can_use_http_cache_for(LoadRequest const& request)
+{
+    auto const& protocol = request.url().protocol();
+    if (protocol != "http" && protocol != "https")
+        return false;
+    if (request.method() != "GET" || !request.body().is_empty())
+        return false;
+    // Requests that carry credentials or cache directives of their own are left alone.
+    for (auto& it : request.headers()) {
+        if (it.key.equals_ignoring_case("Authorization") || it.key.equals_ignoring_case("Cache-Control") || it.key.equals_ignoring_case("Range"))
+            return false;
+    }
+    return true;
+}
+
 bool ResourceLoader::is_port_blocked(int port)
 {
     int ports[] { 1, 7, 9, 11, 13, 15, 17, 19, 20, 21, 22, 23, 25, 37, 42,
@@ -265,6 +327,7 @@ bool ResourceLoader::is_port_blocked(int port)
 
 void ResourceLoader::clear_cache()
 {
+    m_http_cache.clear();
     dbgln_if(CACHE_DEBUG, "Clearing {} items from ResourceLoader cache", s_resource_cache.size());
     s_resource_cache.clear();
 }
@@ -9,6 +9,7 @@
 #include <AK/Function.h>
 #include <AK/URL.h>
 #include <LibCore/Object.h>
+#include <LibWeb/Loader/HTTPCache.h>
 #include <LibWeb/Loader/Resource.h>
 
 namespace Protocol {
@@ -32,6 +33,7 @@ public:
     static ResourceLoader& the();
 
     RefPtr<Resource> load_resource(Resource::Type, LoadRequest&);
+    static bool is_cacheable(AK::URL const&);
 
     void load(LoadRequest&, Function<void(ReadonlyBytes, const HashMap<String, String, CaseInsensitiveStringTraits>& response_headers, Optional<u32> status_code)> success_callback, Function<void(const String&, Optional<u32> status_code)> error_callback = nullptr);
     void load(const AK::URL&, Function<void(ReadonlyBytes, const HashMap<String, String, CaseInsensitiveStringTraits>& response_headers, Optional<u32> status_code)> success_callback, Function<void(const String&, Optional<u32> status_code)> error_callback = nullptr);
@@ -54,12 +56,14 @@ public:
 private:
     ResourceLoader();
     static bool is_port_blocked(int port);
+    static bool can_use_http_cache_for(LoadRequest const&);
 
     int m_pending_loads { 0 };
 
     HashTable<NonnullRefPtr<Protocol::Request>> m_active_requests;
     RefPtr<Protocol::RequestClient> m_protocol_client;
     String m_user_agent;
+    HTTPCache m_http_cache;
 };
 
 }
@@ -5,6 +5,9 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/HashMap.h>
+#include <AK/IntrusiveList.h>
+#include <AK/NonnullOwnPtr.h>
 #include <LibGfx/DisjointRectSet.h>
 #include <LibGfx/Filters/FastBoxBlurFilter.h>
 #include <LibGfx/Painter.h>
@@ -13,6 +16,124 @@
 
 namespace Web::Painting {
 
+struct ShadowBitmapKey {
+    Gfx::IntSize content_size;
+    int blur_radius { 0 };
+    Gfx::Color color;
+
+    bool operator==(ShadowBitmapKey const&) const = default;
+};
+
+}
+
+namespace AK {
+
+template<>
+struct Traits<Web::Painting::ShadowBitmapKey> : public GenericTraits<Web::Painting::ShadowBitmapKey> {
+    static unsigned hash(Web::Painting::ShadowBitmapKey const& key)
+    {
+        auto size_hash = pair_int_hash(key.content_size.width(), key.content_size.height());
+        return pair_int_hash(size_hash, pair_int_hash(key.blur_radius, key.color.value()));
+    }
+};
+
+}
+
+namespace Web::Painting {
+
+// The blurred shadow only depends on the size of the box, the blur radius and the colour, so repainting the same
+// box (or painting lots of identical ones) can reuse it. The cache throws out the least recently used shadows
+// once their bitmaps exceed the budget.
+class ShadowBitmapCache {
+public:
+    static ShadowBitmapCache& the()
+    {
+        static ShadowBitmapCache s_the;
+        return s_the;
+    }
+
+    RefPtr<Gfx::Bitmap> get(ShadowBitmapKey const& key)
+    {
+        auto it = m_entries.find(key);
+        if (it == m_entries.end())
+            return {};
+        auto& entry = *it->value;
+        m_least_recently_used.remove(entry);
+        m_least_recently_used.append(entry);
+        return entry.bitmap;
+    }
+
+    void set(ShadowBitmapKey const& key, NonnullRefPtr<Gfx::Bitmap> bitmap)
+    {
+        // Don't let a single huge shadow flush everything else out of the cache.
+        if (bitmap->size_in_bytes() > m_budget_in_bytes / 4)
+            return;
+
+        if (auto it = m_entries.find(key); it != m_entries.end())
+            remove(*it->value);
+
+        auto entry = make<Entry>(key, move(bitmap));
+        m_size_in_bytes += entry->bitmap->size_in_bytes();
+        m_least_recently_used.append(*entry);
+        m_entries.set(key, move(entry));
+
+        while (m_size_in_bytes > m_budget_in_bytes && !m_least_recently_used.is_empty())
+            remove(*m_least_recently_used.first());
+    }
+
+private:
+    ShadowBitmapCache() = default;
+
+    struct Entry {
+        Entry(ShadowBitmapKey key, NonnullRefPtr<Gfx::Bitmap> bitmap)
+            : key(key)
+            , bitmap(move(bitmap))
+        {
+        }
+
+        ShadowBitmapKey key;
+        NonnullRefPtr<Gfx::Bitmap> bitmap;
+        IntrusiveListNode<Entry> list_node;
+    };
+
+    void remove(Entry& entry)
+    {
+        m_size_in_bytes -= entry.bitmap->size_in_bytes();
+        m_least_recently_used.remove(entry);
+        // NOTE: This destroys the entry, so we have to take a copy of the key first.
+        auto key = entry.key;
+        m_entries.remove(key);
+    }
+
+    HashMap<ShadowBitmapKey, NonnullOwnPtr<Entry>> m_entries;
+    IntrusiveList<&Entry::list_node> m_least_recently_used;
+    size_t m_size_in_bytes { 0 };
+    size_t m_budget_in_bytes { 16 * MiB };
+};
+
+static RefPtr<Gfx::Bitmap> blurred_shadow_bitmap(Gfx::IntSize const& content_size, Gfx::IntRect const& bitmap_rect, BoxShadowData const& box_shadow_data)
+{
+    ShadowBitmapKey key { content_size, box_shadow_data.blur_radius, box_shadow_data.color };
+    if (auto bitmap = ShadowBitmapCache::the().get(key))
+        return bitmap;
+
+    auto bitmap_or_error = Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRA8888, bitmap_rect.size());
+    if (bitmap_or_error.is_error()) {
+        dbgln("Unable to allocate temporary bitmap for box-shadow rendering: {}", bitmap_or_error.error());
+        return {};
+    }
+    auto new_bitmap = bitmap_or_error.release_value_but_fixme_should_propagate_errors();
+
+    Gfx::Painter painter(*new_bitmap);
+    painter.fill_rect({ { 2 * box_shadow_data.blur_radius, 2 * box_shadow_data.blur_radius }, content_size }, box_shadow_data.color);
+
+    Gfx::FastBoxBlurFilter filter(*new_bitmap);
+    filter.apply_three_passes(box_shadow_data.blur_radius);
+
+    ShadowBitmapCache::the().set(key, new_bitmap);
+    return new_bitmap;
+}
+
 void paint_box_shadow(PaintContext& context, Gfx::IntRect const& content_rect, BoxShadowData const& box_shadow_data)
 {
     Gfx::IntRect bitmap_rect = {
@@ -30,18 +151,9 @@ void paint_box_shadow(PaintContext& context, Gfx::IntRect const& content_rect, B
     if (bitmap_rect.is_empty())
         return;
 
-    auto bitmap_or_error = Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRA8888, bitmap_rect.size());
-    if (bitmap_or_error.is_error()) {
-        dbgln("Unable to allocate temporary bitmap for box-shadow rendering: {}", bitmap_or_error.error());
+    auto new_bitmap = blurred_shadow_bitmap(content_rect.size(), bitmap_rect, box_shadow_data);
+    if (!new_bitmap)
         return;
-    }
-    auto new_bitmap = bitmap_or_error.release_value_but_fixme_should_propagate_errors();
-
-    Gfx::Painter painter(*new_bitmap);
-    painter.fill_rect({ { 2 * box_shadow_data.blur_radius, 2 * box_shadow_data.blur_radius }, content_rect.size() }, box_shadow_data.color);
-
-    Gfx::FastBoxBlurFilter filter(*new_bitmap);
-    filter.apply_three_passes(box_shadow_data.blur_radius);
 
     Gfx::DisjointRectSet rect_set;
     rect_set.add(bitmap_rect);
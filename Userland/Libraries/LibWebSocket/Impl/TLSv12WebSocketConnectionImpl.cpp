@@ -26,7 +26,7 @@ void TLSv12WebSocketConnectionImpl::connect(ConnectionInfo const& connection)
     VERIFY(on_ready_to_read);
     m_socket = TLS::TLSv12::construct(this);
 
-    m_socket->set_root_certificates(DefaultRootCACertificates::the().certificates());
+    m_socket->set_trust_store(DefaultRootCACertificates::the().trust_store());
     m_socket->on_tls_error = [this](TLS::AlertDescription) {
         on_connection_error();
     };
@@ -43,6 +43,11 @@ void ClientConnection::did_finish_playing_buffer(Badge<ClientAudioStream>, int b
     async_finished_playing_buffer(buffer_id);
 }
 
+void ClientConnection::did_free_sample_ring_space(Badge<ClientAudioStream>)
+{
+    async_sample_ring_space_available();
+}
+
 void ClientConnection::did_change_main_mix_muted_state(Badge<Mixer>, bool muted)
 {
     async_main_mix_muted_state_changed(muted);
@@ -102,6 +107,22 @@ Messages::AudioServer::EnqueueBufferResponse ClientConnection::enqueue_buffer(Co
     return true;
 }
 
+Messages::AudioServer::SetSampleRingResponse ClientConnection::set_sample_ring(Core::AnonymousBuffer const& buffer)
+{
+    // The mixer reads from the ring without any locking, so it can only be handed over before the mixer knows about us.
+    if (m_queue)
+        return false;
+
+    auto sample_ring = Audio::SampleRing::create_with_anonymous_buffer(buffer);
+    if (sample_ring.is_error()) {
+        dbgln("Client {} sent an invalid sample ring: {}", client_id(), sample_ring.error());
+        return false;
+    }
+
+    m_queue = m_mixer.create_queue(*this, sample_ring.release_value());
+    return true;
+}
+
 Messages::AudioServer::GetRemainingSamplesResponse ClientConnection::get_remaining_samples()
 {
     int remaining = 0;
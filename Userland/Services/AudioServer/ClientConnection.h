@@ -26,6 +26,7 @@ public:
     ~ClientConnection() override;
 
     void did_finish_playing_buffer(Badge<ClientAudioStream>, int buffer_id);
+    void did_free_sample_ring_space(Badge<ClientAudioStream>);
     void did_change_client_volume(Badge<ClientAudioStream>, double volume);
     void did_change_main_mix_muted_state(Badge<Mixer>, bool muted);
     void did_change_main_mix_volume(Badge<Mixer>, double volume);
@@ -42,6 +43,7 @@ private:
     virtual Messages::AudioServer::GetSelfVolumeResponse get_self_volume() override;
     virtual void set_self_volume(double) override;
     virtual Messages::AudioServer::EnqueueBufferResponse enqueue_buffer(Core::AnonymousBuffer const&, i32, int) override;
+    virtual Messages::AudioServer::SetSampleRingResponse set_sample_ring(Core::AnonymousBuffer const&) override;
     virtual Messages::AudioServer::GetRemainingSamplesResponse get_remaining_samples() override;
     virtual Messages::AudioServer::GetPlayedSamplesResponse get_played_samples() override;
     virtual void set_paused(bool) override;
@@ -8,7 +8,7 @@
 #include "Mixer.h"
 #include "AK/Format.h"
 #include <AK/Array.h>
-#include <AK/MemoryStream.h>
+#include <AK/Endian.h>
 #include <AK/NumericLimits.h>
 #include <AudioServer/ClientConnection.h>
 #include <AudioServer/Mixer.h>
@@ -47,9 +47,9 @@ Mixer::~Mixer()
 {
 }
 
-NonnullRefPtr<ClientAudioStream> Mixer::create_queue(ClientConnection& client)
+NonnullRefPtr<ClientAudioStream> Mixer::create_queue(ClientConnection& client, Optional<Audio::SampleRing> sample_ring)
 {
-    auto queue = adopt_ref(*new ClientAudioStream(client));
+    auto queue = adopt_ref(*new ClientAudioStream(client, move(sample_ring)));
     m_pending_mutex.lock();
 
     m_pending_mixing.append(*queue);
@@ -77,61 +77,45 @@ void Mixer::mix()
 
         active_mix_queues.remove_all_matching([&](auto& entry) { return !entry->client(); });
 
-        Audio::Sample mixed_buffer[1024];
-        auto mixed_buffer_length = (int)(sizeof(mixed_buffer) / sizeof(Audio::Sample));
+        Array<Audio::Sample, 1024> mixed_buffer;
 
         m_main_volume.advance_time();
 
-        int active_queues = 0;
+        // The volumes only change once per period, so the (logarithmic) gain is worked out once per period as well, and
+        // every sample is just multiplied by it.
+        double const headroom_factor = Audio::Sample {}.linear_to_log(SAMPLE_HEADROOM);
+
         // Mix the buffers together into the output
         for (auto& queue : active_mix_queues) {
             if (!queue->client()) {
                 queue->clear();
                 continue;
             }
-            ++active_queues;
             queue->volume().advance_time();
 
-            for (int i = 0; i < mixed_buffer_length; ++i) {
-                auto& mixed_sample = mixed_buffer[i];
-                Audio::Sample sample;
-                if (!queue->get_next_sample(sample))
-                    break;
-                if (queue->is_muted())
-                    continue;
-                sample.log_multiply(SAMPLE_HEADROOM);
-                sample.log_multiply(queue->volume());
-                mixed_sample += sample;
-            }
+            double factor = queue->is_muted() ? 0 : headroom_factor * Audio::Sample {}.linear_to_log(queue->volume());
+            queue->mix_into(mixed_buffer.span(), factor);
         }
 
         if (m_muted) {
             m_device->write(m_zero_filled_buffer, sizeof(m_zero_filled_buffer));
         } else {
-            Array<u8, 4096> buffer;
-            OutputMemoryStream stream { buffer };
+            // Even though it's not realistic, the user expects no sound at 0%.
+            double main_factor = m_main_volume < 0.01 ? 0 : Audio::Sample {}.linear_to_log(m_main_volume);
 
-            for (int i = 0; i < mixed_buffer_length; ++i) {
-                auto& mixed_sample = mixed_buffer[i];
+            Array<LittleEndian<i16>, mixed_buffer.size() * 2> output;
+            static_assert(sizeof(output) == sizeof(m_zero_filled_buffer));
 
-                // Even though it's not realistic, the user expects no sound at 0%.
-                if (m_main_volume < 0.01)
-                    mixed_sample = Audio::Sample { 0 };
-                else
-                    mixed_sample.log_multiply(m_main_volume);
+            for (size_t i = 0; i < mixed_buffer.size(); ++i) {
+                auto& mixed_sample = mixed_buffer[i];
+                mixed_sample *= main_factor;
                 mixed_sample.clip();
 
-                LittleEndian<i16> out_sample;
-                out_sample = mixed_sample.left * NumericLimits<i16>::max();
-                stream << out_sample;
-
-                out_sample = mixed_sample.right * NumericLimits<i16>::max();
-                stream << out_sample;
+                output[i * 2] = static_cast<i16>(mixed_sample.left * NumericLimits<i16>::max());
+                output[i * 2 + 1] = static_cast<i16>(mixed_sample.right * NumericLimits<i16>::max());
             }
 
-            VERIFY(stream.is_end());
-            VERIFY(!stream.has_any_error());
-            m_device->write(stream.data(), stream.size());
+            m_device->write(reinterpret_cast<u8 const*>(output.data()), sizeof(output));
         }
     }
 }
@@ -197,14 +181,108 @@ void Mixer::request_setting_sync()
     }
 }
 
-ClientAudioStream::ClientAudioStream(ClientConnection& client)
-    : m_client(client)
+ClientAudioStream::ClientAudioStream(ClientConnection& client, Optional<Audio::SampleRing> sample_ring)
+    : m_sample_ring(move(sample_ring))
+    , m_client(client)
+{
+}
+
+int ClientAudioStream::get_remaining_samples() const
 {
+    int remaining_samples = max(0, m_remaining_samples.load());
+    if (m_sample_ring.has_value())
+        remaining_samples += m_sample_ring->available();
+    return remaining_samples;
 }
 
 void ClientAudioStream::enqueue(NonnullRefPtr<Audio::Buffer>&& buffer)
 {
+    VERIFY(!is_full());
+    auto index = m_enqueued_count.load();
     m_remaining_samples += buffer->sample_count();
-    m_queue.enqueue(move(buffer));
+    m_ring[index % m_ring.size()] = move(buffer);
+    // NOTE: Only now can the mixer see the buffer.
+    m_enqueued_count.store(index + 1);
+}
+
+void ClientAudioStream::clear(bool paused)
+{
+    m_paused = paused;
+    m_remaining_samples = 0;
+    m_played_samples = 0;
+    m_playing_buffer_id = -1;
+    // NOTE: The client is waiting for us to reply, so it can't write any more samples in the meantime.
+    if (m_sample_ring.has_value())
+        m_clear_requested_ring_position.store(m_sample_ring->write_position());
+    m_clear_requested_count.store(m_enqueued_count.load());
+}
+
+void ClientAudioStream::skip_cleared_buffers()
+{
+    auto clear_requested_count = m_clear_requested_count.load();
+    if (clear_requested_count == m_cleared_count)
+        return;
+
+    m_current = nullptr;
+    m_position = 0;
+    for (auto index = m_dequeued_count.load(); index < clear_requested_count; ++index)
+        m_ring[index % m_ring.size()] = nullptr;
+    m_dequeued_count.store(clear_requested_count);
+    m_cleared_count = clear_requested_count;
+    if (m_sample_ring.has_value())
+        m_sample_ring->discard_until(m_clear_requested_ring_position.load());
+}
+
+size_t ClientAudioStream::mix_into(Span<Audio::Sample> output, double factor)
+{
+    skip_cleared_buffers();
+    if (m_paused)
+        return 0;
+
+    size_t mixed_count = 0;
+    while (mixed_count < output.size()) {
+        if (!m_current) {
+            auto index = m_dequeued_count.load();
+            if (index == m_enqueued_count.load())
+                break;
+            m_current = move(m_ring[index % m_ring.size()]);
+            // NOTE: Only now can the connection reuse the slot.
+            m_dequeued_count.store(index + 1);
+            m_position = 0;
+            m_playing_buffer_id = m_current->id();
+        }
+
+        auto const* samples = m_current->samples() + m_position;
+        auto count = min(output.size() - mixed_count, static_cast<size_t>(m_current->sample_count() - m_position));
+        if (factor != 0) {
+            auto* destination = output.offset(mixed_count);
+            for (size_t i = 0; i < count; ++i) {
+                destination[i].left += samples[i].left * factor;
+                destination[i].right += samples[i].right * factor;
+            }
+        }
+        m_position += count;
+        mixed_count += count;
+
+        m_played_samples += count;
+        auto remaining_samples = m_remaining_samples.load();
+        m_remaining_samples -= min(static_cast<int>(count), max(remaining_samples, 0));
+
+        if (m_position >= m_current->sample_count()) {
+            m_client->did_finish_playing_buffer({}, m_current->id());
+            m_current = nullptr;
+            m_position = 0;
+            m_playing_buffer_id = -1;
+        }
+    }
+
+    if (m_sample_ring.has_value()) {
+        auto count = m_sample_ring->mix_into(output.slice(mixed_count), factor);
+        mixed_count += count;
+        m_played_samples += count;
+        if (m_sample_ring->take_wakeup_request())
+            m_client->did_free_sample_ring_space({});
+    }
+    return mixed_count;
 }
 }
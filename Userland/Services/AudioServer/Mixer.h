@@ -9,14 +9,16 @@
 
 #include "ClientConnection.h"
 #include "FadingProperty.h"
+#include <AK/Array.h>
 #include <AK/Atomic.h>
 #include <AK/Badge.h>
 #include <AK/ByteBuffer.h>
 #include <AK/NonnullRefPtrVector.h>
-#include <AK/Queue.h>
 #include <AK/RefCounted.h>
+#include <AK/Span.h>
 #include <AK/WeakPtr.h>
 #include <LibAudio/Buffer.h>
+#include <LibAudio/SampleRing.h>
 #include <LibCore/File.h>
 #include <LibCore/Timer.h>
 #include <LibThreading/ConditionVariable.h>
@@ -32,63 +34,35 @@ constexpr double SAMPLE_HEADROOM = 0.7;
 
 class ClientConnection;
 
+// The client's connection (the producer) enqueues buffers while the mixer thread (the consumer) plays them, without either
+// of them ever waiting for the other: buffers are passed through a small single-producer single-consumer ring.
+// Everything that only the mixer thread touches (the buffer being played, and the position in it) is left alone by the
+// connection; clearing the stream only records how far the mixer should skip ahead the next time it mixes.
+// A client may also write samples into a ring that it shares with us, which are played after any enqueued buffers.
 class ClientAudioStream : public RefCounted<ClientAudioStream> {
 public:
-    explicit ClientAudioStream(ClientConnection&);
+    ClientAudioStream(ClientConnection&, Optional<Audio::SampleRing>);
     ~ClientAudioStream() { }
 
-    bool is_full() const { return m_queue.size() >= 3; }
+    // Called from the client's connection.
+    bool is_full() const { return m_enqueued_count.load() - m_dequeued_count.load() >= max_queued_buffers; }
     void enqueue(NonnullRefPtr<Audio::Buffer>&&);
+    void clear(bool paused = false);
 
-    bool get_next_sample(Audio::Sample& sample)
-    {
-        if (m_paused)
-            return false;
-
-        while (!m_current && !m_queue.is_empty())
-            m_current = m_queue.dequeue();
-
-        if (!m_current)
-            return false;
-
-        sample = m_current->samples()[m_position++];
-        if (m_remaining_samples > 0)
-            --m_remaining_samples;
-        ++m_played_samples;
-
-        if (m_position >= m_current->sample_count()) {
-            m_client->did_finish_playing_buffer({}, m_current->id());
-            m_current = nullptr;
-            m_position = 0;
-        }
-        return true;
-    }
+    // Called from the mixer thread. Adds the next samples (multiplied by the factor) to the output, and returns how many
+    // samples were available.
+    size_t mix_into(Span<Audio::Sample> output, double factor);
 
     ClientConnection* client() { return m_client.ptr(); }
 
-    void clear(bool paused = false)
-    {
-        m_queue.clear();
-        m_position = 0;
-        m_remaining_samples = 0;
-        m_played_samples = 0;
-        m_current = nullptr;
-        m_paused = paused;
-    }
-
     void set_paused(bool paused)
     {
         m_paused = paused;
     }
 
-    int get_remaining_samples() const { return m_remaining_samples; }
+    int get_remaining_samples() const;
     int get_played_samples() const { return m_played_samples; }
-    int get_playing_buffer() const
-    {
-        if (m_current)
-            return m_current->id();
-        return -1;
-    }
+    int get_playing_buffer() const { return m_playing_buffer_id; }
 
     FadingProperty<double>& volume() { return m_volume; }
     double volume() const { return m_volume; }
@@ -97,13 +71,30 @@ public:
     void set_muted(bool muted) { m_muted = muted; }
 
 private:
+    static constexpr size_t max_queued_buffers = 3;
+
+    void skip_cleared_buffers();
+
+    // Only touched by the mixer thread.
     RefPtr<Audio::Buffer> m_current;
-    Queue<NonnullRefPtr<Audio::Buffer>> m_queue;
     int m_position { 0 };
-    int m_remaining_samples { 0 };
-    int m_played_samples { 0 };
-    bool m_paused { false };
-    bool m_muted { false };
+    u64 m_cleared_count { 0 };
+
+    // Slot i % size is written by the connection once i has been enqueued, and emptied by the mixer once i has been dequeued.
+    Array<RefPtr<Audio::Buffer>, max_queued_buffers + 1> m_ring;
+    Atomic<u64> m_enqueued_count { 0 };
+    Atomic<u64> m_dequeued_count { 0 };
+    // Everything enqueued before this count (and written into the sample ring before this position) was cleared by the client.
+    Atomic<u64> m_clear_requested_count { 0 };
+    Atomic<u32> m_clear_requested_ring_position { 0 };
+
+    Optional<Audio::SampleRing> m_sample_ring;
+
+    Atomic<int> m_remaining_samples { 0 };
+    Atomic<int> m_played_samples { 0 };
+    Atomic<int> m_playing_buffer_id { -1 };
+    Atomic<bool> m_paused { false };
+    Atomic<bool> m_muted { false };
 
     WeakPtr<ClientConnection> m_client;
     FadingProperty<double> m_volume { 1 };
@@ -114,7 +105,7 @@ class Mixer : public Core::Object {
 public:
     virtual ~Mixer() override;
 
-    NonnullRefPtr<ClientAudioStream> create_queue(ClientConnection&);
+    NonnullRefPtr<ClientAudioStream> create_queue(ClientConnection&, Optional<Audio::SampleRing> = {});
 
     // To the outside world, we pretend that the target volume is already reached, even though it may be still fading.
     double main_volume() const { return m_main_volume.target(); }
@@ -6,9 +6,13 @@
 
 #include <AK/LexicalPath.h>
 #include <Kernel/API/InodeWatcherEvent.h>
+#include <LibCompress/Lz4.h>
+#include <LibCore/File.h>
+#include <LibCore/FileStream.h>
 #include <LibCore/FileWatcher.h>
-#include <LibCore/MappedFile.h>
 #include <LibCore/System.h>
+#include <LibCoredump/Backtrace.h>
+#include <LibCoredump/Reader.h>
 #include <LibMain/Main.h>
 #include <serenity.h>
 #include <spawn.h>
@@ -31,6 +35,58 @@ static void wait_until_coredump_is_ready(const String& coredump_path)
     }
 }
 
+static void print_backtrace(String const& coredump_path)
+{
+    auto coredump = Coredump::Reader::create(coredump_path);
+    if (!coredump) {
+        dbgln("Could not open coredump '{}'", coredump_path);
+        return;
+    }
+
+    // Every thread's backtrace is logged as soon as it's been symbolicated, so a crash that brings down the
+    // whole system still leaves a trace of the threads we got through.
+    size_t thread_index = 0;
+    coredump->for_each_thread_info([&](auto& thread_info) {
+        Coredump::Backtrace backtrace(*coredump, thread_info);
+        if (thread_index > 0)
+            dbgln();
+        dbgln("--- Backtrace for thread #{} (TID {}) ---", thread_index, thread_info.tid);
+        for (auto& entry : backtrace.entries())
+            dbgln("{}", entry.to_string(true));
+        ++thread_index;
+        return IterationDecision::Continue;
+    });
+}
+
+// Coredumps are compressed a chunk at a time, so this takes the same amount of memory no matter how big they are.
+// LZ4 is used as the crashed process is only gone once this is done, and it's many times faster than gzip.
+static constexpr size_t compression_chunk_size = 1 * MiB;
+
+static ErrorOr<String> compress_coredump(String const& coredump_path)
+{
+    auto input_file = TRY(Core::File::open(coredump_path, Core::OpenMode::ReadOnly));
+    auto output_path = String::formatted("{}.lz4", coredump_path);
+    auto output_file = TRY(Core::File::open(output_path, Core::OpenMode::WriteOnly | Core::OpenMode::MustBeNew, 0600));
+
+    Core::OutputFileStream output_stream { output_file };
+    Compress::Lz4Compressor compressor { output_stream };
+    for (;;) {
+        auto chunk = input_file->read(compression_chunk_size);
+        if (input_file->has_error())
+            return Error::from_errno(input_file->error());
+        if (chunk.is_empty())
+            break;
+        compressor.write_or_error(chunk);
+        auto compressor_failed = compressor.handle_any_error();
+        if (output_stream.handle_any_error() || compressor_failed)
+            return Error::from_string_literal("Failed to write compressed coredump"sv);
+    }
+    compressor.final_flush();
+    if (output_stream.handle_any_error())
+        return Error::from_string_literal("Failed to write compressed coredump"sv);
+    return output_path;
+}
+
 static void launch_crash_reporter(const String& coredump_path, bool unlink_on_exit)
 {
     pid_t child;
@@ -64,15 +120,23 @@ ErrorOr<int> serenity_main(Main::Arguments)
         if (event.value().type != Core::FileWatcherEvent::Type::ChildCreated)
             continue;
         auto& coredump_path = event.value().event_path;
+        // Don't pick up the coredumps we compressed ourselves.
+        if (coredump_path.ends_with(".lz4"sv))
+            continue;
         dbgln("New coredump file: {}", coredump_path);
         wait_until_coredump_is_ready(coredump_path);
 
-        auto file_or_error = Core::MappedFile::map(coredump_path);
-        if (file_or_error.is_error()) {
-            dbgln("Unable to map coredump {}: {}", coredump_path, file_or_error.error());
+        print_backtrace(coredump_path);
+
+        auto compressed_path_or_error = compress_coredump(coredump_path);
+        if (compressed_path_or_error.is_error()) {
+            dbgln("Unable to compress coredump {}: {}", coredump_path, compressed_path_or_error.error());
+            launch_crash_reporter(coredump_path, true);
             continue;
         }
 
-        launch_crash_reporter(coredump_path, true);
+        if (auto result = Core::System::unlink(coredump_path); result.is_error())
+            dbgln("Unable to remove uncompressed coredump {}: {}", coredump_path, result.error());
+        launch_crash_reporter(compressed_path_or_error.value(), true);
     }
 }
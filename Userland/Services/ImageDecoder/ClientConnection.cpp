@@ -7,8 +7,11 @@
 #include <AK/Debug.h>
 #include <ImageDecoder/ClientConnection.h>
 #include <ImageDecoder/ImageDecoderClientEndpoint.h>
+#include <LibCore/EventLoop.h>
+#include <LibCore/System.h>
 #include <LibGfx/Bitmap.h>
 #include <LibGfx/ImageDecoder.h>
+#include <fcntl.h>
 
 namespace ImageDecoder {
 
@@ -19,6 +22,22 @@ ClientConnection::ClientConnection(NonnullRefPtr<Core::LocalSocket> socket)
 
 ClientConnection::~ClientConnection()
 {
+    {
+        Threading::MutexLocker locker(m_jobs_mutex);
+        m_shutting_down = true;
+        m_pending_jobs.clear();
+        m_jobs_condition.broadcast();
+    }
+    for (auto& worker : m_workers)
+        (void)worker.join();
+
+    m_finished_jobs.clear();
+    if (m_wake_notifier)
+        m_wake_notifier->close();
+    for (auto fd : m_wake_pipe_fds) {
+        if (fd >= 0)
+            (void)Core::System::close(fd);
+    }
 }
 
 void ClientConnection::die()
@@ -26,40 +45,151 @@ void ClientConnection::die()
     Core::EventLoop::current().quit(0);
 }
 
-Messages::ImageDecoderServer::DecodeImageResponse ClientConnection::decode_image(Core::AnonymousBuffer const& encoded_buffer)
+ClientConnection::DecodedImage ClientConnection::decode(Core::AnonymousBuffer const& encoded_buffer)
 {
-    if (!encoded_buffer.is_valid()) {
-        dbgln_if(IMAGE_DECODER_DEBUG, "Encoded data is invalid");
-        return nullptr;
-    }
-
     auto decoder = Gfx::ImageDecoder::try_create(ReadonlyBytes { encoded_buffer.data<u8>(), encoded_buffer.size() });
 
     if (!decoder) {
         dbgln_if(IMAGE_DECODER_DEBUG, "Could not find suitable image decoder plugin for data");
-        return { false, 0, Vector<Gfx::ShareableBitmap> {}, Vector<u32> {} };
+        return {};
     }
 
     if (!decoder->frame_count()) {
         dbgln_if(IMAGE_DECODER_DEBUG, "Could not decode image from encoded data");
-        return { false, 0, Vector<Gfx::ShareableBitmap> {}, Vector<u32> {} };
+        return {};
     }
 
-    Vector<Gfx::ShareableBitmap> bitmaps;
-    Vector<u32> durations;
+    DecodedImage image;
     for (size_t i = 0; i < decoder->frame_count(); ++i) {
         auto frame_or_error = decoder->frame(i);
         if (frame_or_error.is_error()) {
-            bitmaps.append(Gfx::ShareableBitmap {});
-            durations.append(0);
+            image.bitmaps.append(Gfx::ShareableBitmap {});
+            image.durations.append(0);
         } else {
             auto frame = frame_or_error.release_value();
-            bitmaps.append(frame.image->to_shareable_bitmap());
-            durations.append(frame.duration);
+            image.bitmaps.append(frame.image->to_shareable_bitmap());
+            image.durations.append(frame.duration);
         }
     }
+    image.is_animated = decoder->is_animated();
+    image.loop_count = static_cast<u32>(decoder->loop_count());
+    return image;
+}
 
-    return { decoder->is_animated(), static_cast<u32>(decoder->loop_count()), bitmaps, durations };
+Messages::ImageDecoderServer::DecodeImageResponse ClientConnection::decode_image(Core::AnonymousBuffer const& encoded_buffer)
+{
+    if (!encoded_buffer.is_valid()) {
+        dbgln_if(IMAGE_DECODER_DEBUG, "Encoded data is invalid");
+        return nullptr;
+    }
+
+    auto image = decode(encoded_buffer);
+    return { image.is_animated, image.loop_count, move(image.bitmaps), move(image.durations) };
+}
+
+void ClientConnection::start_decoding_image(i32 request_id, Core::AnonymousBuffer const& encoded_buffer)
+{
+    auto reject = [&](auto reason) {
+        dbgln_if(IMAGE_DECODER_DEBUG, "Rejecting decode request {}: {}", request_id, reason);
+        async_did_fail_to_decode_image(request_id);
+    };
+
+    if (!encoded_buffer.is_valid())
+        return reject("Encoded data is invalid"sv);
+    if (m_active_request_ids.contains(request_id))
+        return reject("Request ID is already in use"sv);
+    if (auto result = start_workers_if_needed(); result.is_error())
+        return reject(result.error());
+
+    // The workers get a mapping of their own, since the buffer's reference count can't be shared across threads.
+    auto fd_or_error = Core::System::dup(encoded_buffer.fd());
+    if (fd_or_error.is_error())
+        return reject(fd_or_error.error());
+    auto buffer_or_error = Core::AnonymousBuffer::create_from_anon_fd(fd_or_error.value(), encoded_buffer.size());
+    if (buffer_or_error.is_error())
+        return reject(buffer_or_error.error());
+
+    m_active_request_ids.set(request_id);
+
+    Threading::MutexLocker locker(m_jobs_mutex);
+    m_pending_jobs.append({ request_id, buffer_or_error.release_value() });
+    m_jobs_condition.signal();
+}
+
+void ClientConnection::cancel_decoding(i32 request_id)
+{
+    if (!m_active_request_ids.remove(request_id))
+        return;
+
+    // A request that a worker has already picked up is left alone, and its result is dropped in did_finish_jobs().
+    Threading::MutexLocker locker(m_jobs_mutex);
+    m_pending_jobs.remove_first_matching([&](auto& job) { return job.request_id == request_id; });
+}
+
+ErrorOr<void> ClientConnection::start_workers_if_needed()
+{
+    if (!m_workers.is_empty())
+        return {};
+
+    auto fds = TRY(Core::System::pipe2(O_CLOEXEC));
+    m_wake_pipe_fds[0] = fds[0];
+    m_wake_pipe_fds[1] = fds[1];
+    m_wake_notifier = Core::Notifier::construct(m_wake_pipe_fds[0], Core::Notifier::Event::Read, this);
+    m_wake_notifier->on_ready_to_read = [this] {
+        u8 buffer[64];
+        (void)Core::System::read(m_wake_pipe_fds[0], { buffer, sizeof(buffer) });
+        did_finish_jobs();
+    };
+
+    for (size_t i = 0; i < max_concurrent_decodes; ++i) {
+        auto worker = Threading::Thread::construct([this] { return worker_main(); }, "ImageDecoder[worker]"sv);
+        worker->start();
+        m_workers.append(move(worker));
+    }
+    return {};
+}
+
+intptr_t ClientConnection::worker_main()
+{
+    for (;;) {
+        Job job;
+        {
+            Threading::MutexLocker locker(m_jobs_mutex);
+            m_jobs_condition.wait_while([this] { return m_pending_jobs.is_empty() && !m_shutting_down; });
+            if (m_shutting_down)
+                return 0;
+            job = m_pending_jobs.take_first();
+        }
+
+        auto image = decode(job.encoded_buffer);
+
+        {
+            Threading::MutexLocker locker(m_jobs_mutex);
+            m_finished_jobs.append({ job.request_id, move(image) });
+        }
+        u8 wake = 0;
+        (void)Core::System::write(m_wake_pipe_fds[1], { &wake, sizeof(wake) });
+    }
+}
+
+void ClientConnection::did_finish_jobs()
+{
+    Vector<FinishedJob> finished_jobs;
+    {
+        Threading::MutexLocker locker(m_jobs_mutex);
+        finished_jobs = move(m_finished_jobs);
+    }
+
+    // Replies go out in the order the jobs finished in, which needn't be the order they were started in.
+    for (auto& job : finished_jobs) {
+        if (!m_active_request_ids.remove(job.request_id))
+            continue;
+        if (job.image.bitmaps.is_empty()) {
+            async_did_fail_to_decode_image(job.request_id);
+            continue;
+        }
+        async_did_decode_image(job.request_id, job.image.is_animated, job.image.loop_count, move(job.image.bitmaps), move(job.image.durations));
+    }
 }
 
 }
@@ -7,10 +7,16 @@
 #pragma once
 
 #include <AK/HashMap.h>
+#include <AK/HashTable.h>
+#include <AK/NonnullRefPtrVector.h>
 #include <ImageDecoder/Forward.h>
 #include <ImageDecoder/ImageDecoderClientEndpoint.h>
 #include <ImageDecoder/ImageDecoderServerEndpoint.h>
+#include <LibCore/Notifier.h>
 #include <LibIPC/ClientConnection.h>
+#include <LibThreading/ConditionVariable.h>
+#include <LibThreading/Mutex.h>
+#include <LibThreading/Thread.h>
 #include <LibWeb/Forward.h>
 
 namespace ImageDecoder {
@@ -28,6 +34,47 @@ private:
     explicit ClientConnection(NonnullRefPtr<Core::LocalSocket>);
 
     virtual Messages::ImageDecoderServer::DecodeImageResponse decode_image(Core::AnonymousBuffer const&) override;
+    virtual void start_decoding_image(i32 request_id, Core::AnonymousBuffer const&) override;
+    virtual void cancel_decoding(i32 request_id) override;
+
+    struct DecodedImage {
+        bool is_animated { false };
+        u32 loop_count { 0 };
+        Vector<Gfx::ShareableBitmap> bitmaps;
+        Vector<u32> durations;
+    };
+    static DecodedImage decode(Core::AnonymousBuffer const&);
+
+    struct Job {
+        i32 request_id { 0 };
+        Core::AnonymousBuffer encoded_buffer;
+    };
+    struct FinishedJob {
+        i32 request_id { 0 };
+        DecodedImage image;
+    };
+    ErrorOr<void> start_workers_if_needed();
+    intptr_t worker_main();
+    void did_finish_jobs();
+
+    // Asynchronous requests are decoded on a small pool of worker threads, so a slow image doesn't hold up the
+    // ones behind it. Every client gets an ImageDecoder process of its own, so this also caps how much of the
+    // machine a single client can keep busy.
+    static constexpr size_t max_concurrent_decodes = 4;
+
+    Threading::Mutex m_jobs_mutex;
+    Threading::ConditionVariable m_jobs_condition { m_jobs_mutex };
+    Vector<Job> m_pending_jobs;
+    Vector<FinishedJob> m_finished_jobs;
+    bool m_shutting_down { false };
+    NonnullRefPtrVector<Threading::Thread> m_workers;
+
+    // Workers write a byte here whenever they finish a job, to wake up the main thread.
+    int m_wake_pipe_fds[2] { -1, -1 };
+    RefPtr<Core::Notifier> m_wake_notifier;
+
+    // Requests that have been started and neither finished nor cancelled yet. Only touched on the main thread.
+    HashTable<i32> m_active_request_ids;
 };
 
 }
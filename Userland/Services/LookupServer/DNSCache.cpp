@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "DNSCache.h"
+#include <AK/Debug.h>
+#include <time.h>
+
+namespace LookupServer {
+
+static constexpr size_t max_entries = 1024;
+// RFC 2308 section 5 suggests capping how long negative answers are cached, to one to three hours.
+static constexpr u32 max_negative_ttl = 3 * 3600;
+// An entry counts as popular once it has been used this many times since it was last updated.
+static constexpr u32 popular_hit_count = 3;
+
+Optional<DNSCache::Hit> DNSCache::get(DNSName const& name, DNSRecordType type)
+{
+    auto it = m_entries.find({ name, type });
+    if (it == m_entries.end())
+        return {};
+    auto& entry = *it->value;
+    auto now = time(nullptr);
+
+    Hit hit;
+    time_t expiry_time;
+    u32 ttl;
+    if (entry.negative_expiry_time != 0) {
+        expiry_time = entry.negative_expiry_time;
+        ttl = 0;
+    } else {
+        entry.answers.remove_all_matching([](auto& answer) { return answer.has_expired(); });
+        if (entry.answers.is_empty()) {
+            remove(entry);
+            return {};
+        }
+        // The whole entry has to be looked up again once the first of its answers expires.
+        expiry_time = entry.answers[0].received_time() + entry.answers[0].ttl();
+        ttl = entry.answers[0].ttl();
+        for (auto& answer : entry.answers) {
+            if (answer.received_time() + answer.ttl() < expiry_time) {
+                expiry_time = answer.received_time() + answer.ttl();
+                ttl = answer.ttl();
+            }
+        }
+        hit.answers = entry.answers;
+    }
+    if (now >= expiry_time) {
+        remove(entry);
+        return {};
+    }
+
+    m_least_recently_used.remove(entry);
+    m_least_recently_used.append(entry);
+    ++entry.hit_count;
+
+    // Refreshing in the last tenth of the TTL keeps popular names from ever having to wait on a nameserver.
+    bool is_about_to_expire = expiry_time - now <= max<time_t>(ttl / 10, 1);
+    if (ttl != 0 && is_about_to_expire && entry.hit_count >= popular_hit_count && !entry.has_requested_refresh) {
+        dbgln_if(LOOKUPSERVER_DEBUG, "DNSCache: {} ({}) is about to expire, refreshing it", name, type);
+        entry.has_requested_refresh = true;
+        hit.should_refresh = true;
+    }
+    return hit;
+}
+
+void DNSCache::add(DNSAnswer const& answer)
+{
+    if (answer.has_expired())
+        return;
+
+    auto& entry = ensure({ answer.name(), answer.type() });
+    entry.negative_expiry_time = 0;
+
+    if (answer.mdns_cache_flush()) {
+        // The sender has all the records for the name, so the ones we already have are outdated, see RFC 6762
+        // section 10.2. It may send them in several packets though, so those from the last second are kept.
+        auto now = time(nullptr);
+        entry.answers.remove_all_matching([&](DNSAnswer const& other_answer) {
+            if (other_answer.class_code() != answer.class_code() || other_answer.received_time() >= now - 1)
+                return false;
+            dbgln_if(LOOKUPSERVER_DEBUG, "Removing cache entry: {}", other_answer.name());
+            return true;
+        });
+    }
+
+    // A record we already have just gets its TTL updated.
+    entry.answers.remove_first_matching([&](DNSAnswer const& other_answer) {
+        return other_answer.class_code() == answer.class_code() && other_answer.record_data() == answer.record_data();
+    });
+    entry.answers.append(answer);
+}
+
+void DNSCache::add_negative(DNSName const& name, DNSRecordType type, u32 ttl)
+{
+    if (ttl == 0)
+        return;
+    auto& entry = ensure({ name, type });
+    entry.answers.clear();
+    entry.negative_expiry_time = time(nullptr) + min(ttl, max_negative_ttl);
+}
+
+DNSCache::Entry& DNSCache::ensure(Key const& key)
+{
+    if (auto it = m_entries.find(key); it != m_entries.end()) {
+        auto& entry = *it->value;
+        m_least_recently_used.remove(entry);
+        m_least_recently_used.append(entry);
+        entry.hit_count = 0;
+        entry.has_requested_refresh = false;
+        return entry;
+    }
+
+    if (m_entries.size() >= max_entries)
+        remove(*m_least_recently_used.first());
+
+    auto entry = make<Entry>(key);
+    auto& entry_ref = *entry;
+    m_least_recently_used.append(entry_ref);
+    m_entries.set(key, move(entry));
+    return entry_ref;
+}
+
+void DNSCache::remove(Entry& entry)
+{
+    m_least_recently_used.remove(entry);
+    // NOTE: This destroys the entry, so we have to take a copy of the key first.
+    auto key = entry.key;
+    m_entries.remove(key);
+}
+
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include "DNSAnswer.h"
+#include "DNSName.h"
+#include <AK/HashMap.h>
+#include <AK/IntrusiveList.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Optional.h>
+#include <AK/Vector.h>
+
+namespace LookupServer {
+
+// Answers we got from nameservers or over mDNS, by name and record type. That a name doesn't exist (or has no records
+// of some type) is cached as well, see RFC 2308. The number of entries is bounded, and the least recently used ones
+// are thrown out first.
+class DNSCache {
+public:
+    struct Key {
+        DNSName name;
+        DNSRecordType type;
+
+        bool operator==(Key const& other) const { return name == other.name && type == other.type; }
+    };
+
+    struct Hit {
+        // Empty if the name is known not to have any records of the type.
+        Vector<DNSAnswer> answers;
+        // The entry is used a lot and is about to expire, so it should be looked up again before it does. This is
+        // only ever set once per entry, until it's updated.
+        bool should_refresh { false };
+    };
+
+    Optional<Hit> get(DNSName const&, DNSRecordType);
+    void add(DNSAnswer const&);
+    void add_negative(DNSName const&, DNSRecordType, u32 ttl);
+
+    size_t size() const { return m_entries.size(); }
+
+private:
+    struct Entry {
+        explicit Entry(Key key)
+            : key(move(key))
+        {
+        }
+
+        Key key;
+        Vector<DNSAnswer> answers;
+        // When a negative entry expires, zero for a positive one.
+        time_t negative_expiry_time { 0 };
+        u32 hit_count { 0 };
+        bool has_requested_refresh { false };
+        IntrusiveListNode<Entry> list_node;
+    };
+
+    Entry& ensure(Key const&);
+    void remove(Entry&);
+
+    HashMap<Key, NonnullOwnPtr<Entry>> m_entries;
+    IntrusiveList<&Entry::list_node> m_least_recently_used;
+};
+
+}
+
+namespace AK {
+
+template<>
+struct Traits<LookupServer::DNSCache::Key> : public GenericTraits<LookupServer::DNSCache::Key> {
+    static unsigned hash(LookupServer::DNSCache::Key const& key)
+    {
+        return pair_int_hash(LookupServer::DNSName::Traits::hash(key.name), (u16)key.type);
+    }
+};
+
+}
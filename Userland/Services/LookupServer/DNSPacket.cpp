@@ -115,8 +115,8 @@ Optional<DNSPacket> DNSPacket::from_raw_packet(const u8* raw_data, size_t raw_si
     packet.m_query_or_response = header.is_response();
     packet.m_code = header.response_code();
 
-    // FIXME: Should we parse further in this case?
-    if (packet.code() != Code::NOERROR)
+    // FIXME: Should we parse further in other cases?
+    if (packet.code() != Code::NOERROR && packet.code() != Code::NXDOMAIN)
         return packet;
 
     size_t offset = sizeof(DNSPacketHeader);
@@ -174,6 +174,25 @@ Optional<DNSPacket> DNSPacket::from_raw_packet(const u8* raw_data, size_t raw_si
         offset += record.data_length();
     }
 
+    // A negative answer comes with the SOA record of the zone, which says how long it may be cached, see RFC 2308 section 3.
+    for (u16 i = 0; i < header.authority_count(); ++i) {
+        DNSName::parse(raw_data, offset, raw_size);
+        if (offset + sizeof(DNSRecordWithoutName) > raw_size)
+            break;
+        auto& record = *(const DNSRecordWithoutName*)(&raw_data[offset]);
+        offset += sizeof(DNSRecordWithoutName);
+        if (offset + record.data_length() > raw_size)
+            break;
+
+        // MINIMUM is the last field of the SOA record, after two names and four other 32-bit fields.
+        if ((DNSRecordType)record.type() == DNSRecordType::SOA && record.data_length() >= 2 + 5 * sizeof(u32)) {
+            auto minimum = *(const NetworkOrdered<u32>*)(&raw_data[offset + record.data_length() - sizeof(u32)]);
+            packet.m_negative_answer_ttl = min(record.ttl(), (u32)minimum);
+            dbgln_if(LOOKUPSERVER_DEBUG, "Authority #{}: SOA, ttl={}, minimum={}", i, record.ttl(), (u32)minimum);
+        }
+        offset += record.data_length();
+    }
+
     return packet;
 }
 
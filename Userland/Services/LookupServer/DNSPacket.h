@@ -75,6 +75,9 @@ public:
     Code code() const { return (Code)m_code; }
     void set_code(Code code) { m_code = (u8)code; }
 
+    // How long an NXDOMAIN or empty answer may be cached for. Without an SOA record to go by, it shouldn't be cached.
+    Optional<u32> negative_answer_ttl() const { return m_negative_answer_ttl; }
+
 private:
     u16 m_id { 0 };
     u8 m_code { 0 };
@@ -84,6 +87,7 @@ private:
     bool m_recursion_available { true };
     Vector<DNSQuestion> m_questions;
     Vector<DNSAnswer> m_answers;
+    Optional<u32> m_negative_answer_ttl;
 };
 
 }
@@ -16,24 +16,42 @@ DNSServer::DNSServer(Object* parent)
 {
     bind(IPv4Address(), 53);
     on_ready_to_receive = [this]() {
-        handle_client();
+        handle_clients();
     };
 }
 
-void DNSServer::handle_client()
+void DNSServer::handle_clients()
+{
+    // Answer all the requests that are already queued up together, so a burst of them only takes a couple of syscalls.
+    auto requests_or_error = receive_many(max_requests_per_batch, 1024);
+    if (requests_or_error.is_error()) {
+        dbgln("Failed to receive DNS requests: {}", requests_or_error.error());
+        return;
+    }
+
+    Vector<Datagram> responses;
+    for (auto& request : requests_or_error.value()) {
+        auto response = handle_request(request.data);
+        if (response.has_value())
+            responses.append({ response.release_value(), request.address });
+    }
+
+    // FIXME: We should be handling errors here.
+    [[maybe_unused]] auto result = send_many(responses);
+}
+
+Optional<ByteBuffer> DNSServer::handle_request(ReadonlyBytes buffer)
 {
-    sockaddr_in client_address;
-    auto buffer = receive(1024, client_address);
     auto optional_request = DNSPacket::from_raw_packet(buffer.data(), buffer.size());
     if (!optional_request.has_value()) {
         dbgln("Got an invalid DNS packet");
-        return;
+        return {};
     }
     auto& request = optional_request.value();
 
     if (!request.is_query()) {
         dbgln("It's not a request");
-        return;
+        return {};
     }
 
     LookupServer& lookup_server = LookupServer::the();
@@ -57,10 +75,7 @@ void DNSServer::handle_client()
     else
         response.set_code(DNSPacket::Code::NOERROR);
 
-    buffer = response.to_byte_buffer();
-
-    // FIXME: We should be handling errors here.
-    [[maybe_unused]] auto result = send(buffer, client_address);
+    return response.to_byte_buffer();
 }
 
 }
@@ -16,7 +16,10 @@ class DNSServer : public Core::UDPServer {
 private:
     explicit DNSServer(Object* parent = nullptr);
 
-    void handle_client();
+    static constexpr size_t max_requests_per_batch = 32;
+
+    void handle_clients();
+    Optional<ByteBuffer> handle_request(ReadonlyBytes);
 };
 
 }
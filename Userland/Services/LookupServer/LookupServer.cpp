@@ -7,15 +7,14 @@
 #include "LookupServer.h"
 #include "ClientConnection.h"
 #include "DNSPacket.h"
+#include "UpstreamQuery.h"
 #include <AK/Debug.h>
 #include <AK/HashMap.h>
-#include <AK/Random.h>
 #include <AK/String.h>
 #include <AK/StringBuilder.h>
 #include <LibCore/ConfigFile.h>
 #include <LibCore/File.h>
 #include <LibCore/LocalServer.h>
-#include <LibCore/UDPSocket.h>
 #include <stdio.h>
 #include <time.h>
 #include <unistd.h>
@@ -169,181 +168,67 @@ Vector<DNSAnswer> LookupServer::lookup(const DNSName& name, DNSRecordType record
     }
 
     // Third, try our cache.
-    if (auto cached_answers = m_lookup_cache.find(name); cached_answers != m_lookup_cache.end()) {
-        for (auto& answer : cached_answers->value) {
-            // TODO: Actually remove expired answers from the cache.
-            if (answer.type() == record_type && !answer.has_expired()) {
-                dbgln_if(LOOKUPSERVER_DEBUG, "Cache hit: {} -> {}", name.as_string(), answer.record_data());
-                add_answer(answer);
-            }
+    if (auto hit = m_lookup_cache.get(name, record_type); hit.has_value()) {
+        if (hit->should_refresh)
+            refresh_in_background(name, record_type);
+        for (auto& answer : hit->answers) {
+            dbgln_if(LOOKUPSERVER_DEBUG, "Cache hit: {} -> {}", name.as_string(), answer.record_data());
+            add_answer(answer);
         }
-        if (!answers.is_empty())
-            return answers;
+        // No answers means that the name is known not to have any, so there's no point in asking again.
+        return answers;
     }
 
     // Fourth, look up .local names using mDNS instead of DNS nameservers.
     if (name.as_string().ends_with(".local")) {
         answers = m_mdns->lookup(name, record_type);
         for (auto& answer : answers)
-            put_in_cache(answer);
+            m_lookup_cache.add(answer);
         return answers;
     }
 
-    // Fifth, ask the upstream nameservers.
-    for (auto& nameserver : m_nameservers) {
-        dbgln_if(LOOKUPSERVER_DEBUG, "Doing lookup using nameserver '{}'", nameserver);
-        bool did_get_response = false;
-        int retries = 3;
-        Vector<DNSAnswer> upstream_answers;
-        do {
-            upstream_answers = lookup(name, nameserver, did_get_response, record_type);
-            if (did_get_response)
-                break;
-        } while (--retries);
-        if (!upstream_answers.is_empty()) {
-            for (auto& answer : upstream_answers)
-                add_answer(answer);
-            break;
-        } else {
-            if (!did_get_response)
-                dbgln("Never got a response from '{}', trying next nameserver", nameserver);
-            else
-                dbgln("Received response from '{}' but no result(s), trying next nameserver", nameserver);
-        }
-    }
+    // Fifth, ask the upstream nameservers, all at once.
+    auto query = UpstreamQuery::construct(m_nameservers, name, record_type);
+    auto response = query->wait();
 
     // Sixth, fail.
-    if (answers.is_empty()) {
-        dbgln("Tried all nameservers but never got a response :(");
+    if (!response.has_value())
         return {};
-    }
 
+    for (auto& answer : put_in_cache(name, record_type, response.value()))
+        add_answer(answer);
     return answers;
 }
 
-Vector<DNSAnswer> LookupServer::lookup(const DNSName& name, const String& nameserver, bool& did_get_response, DNSRecordType record_type, ShouldRandomizeCase should_randomize_case)
+Vector<DNSAnswer> LookupServer::put_in_cache(const DNSName& name, DNSRecordType record_type, const DNSPacket& response)
 {
-    DNSPacket request;
-    request.set_is_query();
-    request.set_id(get_random_uniform(UINT16_MAX));
-    DNSName name_in_question = name;
-    if (should_randomize_case == ShouldRandomizeCase::Yes)
-        name_in_question.randomize_case();
-    request.add_question({ name_in_question, record_type, DNSRecordClass::IN, false });
-
-    auto buffer = request.to_byte_buffer();
-
-    auto udp_socket = Core::UDPSocket::construct();
-    udp_socket->set_blocking(true);
-
-    struct timeval timeout {
-        1, 0
-    };
-
-    int rc = setsockopt(udp_socket->fd(), SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
-    if (rc < 0) {
-        perror("setsockopt(SOL_SOCKET, SO_RCVTIMEO)");
-        return {};
-    }
-
-    if (!udp_socket->connect(nameserver, 53))
-        return {};
-
-    if (!udp_socket->write(buffer))
-        return {};
-
-    u8 response_buffer[4096];
-    int nrecv = udp_socket->read(response_buffer, sizeof(response_buffer));
-    if (nrecv == 0)
-        return {};
-
-    did_get_response = true;
-
-    auto o_response = DNSPacket::from_raw_packet(response_buffer, nrecv);
-    if (!o_response.has_value())
-        return {};
-
-    auto& response = o_response.value();
-
-    if (response.id() != request.id()) {
-        dbgln("LookupServer: ID mismatch ({} vs {}) :(", response.id(), request.id());
-        return {};
-    }
-
-    if (response.code() == DNSPacket::Code::REFUSED) {
-        if (should_randomize_case == ShouldRandomizeCase::Yes) {
-            // Retry with 0x20 case randomization turned off.
-            return lookup(name, nameserver, did_get_response, record_type, ShouldRandomizeCase::No);
-        }
-        return {};
-    }
-
-    if (response.question_count() != request.question_count()) {
-        dbgln("LookupServer: Question count ({} vs {}) :(", response.question_count(), request.question_count());
-        return {};
-    }
-
-    // Verify the questions in our request and in their response match exactly, including case.
-    for (size_t i = 0; i < request.question_count(); ++i) {
-        auto& request_question = request.questions()[i];
-        auto& response_question = response.questions()[i];
-        bool exact_match = request_question.class_code() == response_question.class_code()
-            && request_question.record_type() == response_question.record_type()
-            && request_question.name().as_string() == response_question.name().as_string();
-        if (!exact_match) {
-            dbgln("Request and response questions do not match");
-            dbgln("   Request: name=_{}_, type={}, class={}", request_question.name().as_string(), response_question.record_type(), response_question.class_code());
-            dbgln("  Response: name=_{}_, type={}, class={}", response_question.name().as_string(), response_question.record_type(), response_question.class_code());
-            return {};
-        }
-    }
-
-    if (response.answer_count() < 1) {
-        dbgln("LookupServer: No answers :(");
-        return {};
-    }
-
-    Vector<DNSAnswer, 8> answers;
+    Vector<DNSAnswer> answers;
     for (auto& answer : response.answers()) {
-        put_in_cache(answer);
-        if (answer.type() != record_type)
-            continue;
-        answers.append(answer);
+        m_lookup_cache.add(answer);
+        if (answer.type() == record_type)
+            answers.append(answer);
     }
 
+    if (answers.is_empty()) {
+        dbgln("LookupServer: No answers for {} ({}) :(", name.as_string(), record_type);
+        if (auto ttl = response.negative_answer_ttl(); ttl.has_value())
+            m_lookup_cache.add_negative(name, record_type, ttl.value());
+    }
     return answers;
 }
 
-void LookupServer::put_in_cache(const DNSAnswer& answer)
+void LookupServer::refresh_in_background(const DNSName& name, DNSRecordType record_type)
 {
-    if (answer.has_expired())
+    // mDNS answers are kept fresh by their senders announcing them again.
+    if (name.as_string().ends_with(".local"))
         return;
 
-    // Prevent the cache from growing too big.
-    // TODO: Evict least used entries.
-    if (m_lookup_cache.size() >= 256)
-        m_lookup_cache.remove(m_lookup_cache.begin());
-
-    auto it = m_lookup_cache.find(answer.name());
-    if (it == m_lookup_cache.end())
-        m_lookup_cache.set(answer.name(), { answer });
-    else {
-        if (answer.mdns_cache_flush()) {
-            auto now = time(nullptr);
-
-            it->value.remove_all_matching([&](DNSAnswer const& other_answer) {
-                if (other_answer.type() != answer.type() || other_answer.class_code() != answer.class_code())
-                    return false;
-
-                if (other_answer.received_time() >= now - 1)
-                    return false;
-
-                dbgln_if(LOOKUPSERVER_DEBUG, "Removing cache entry: {}", other_answer.name());
-                return true;
-            });
-        }
-        it->value.append(answer);
-    }
+    auto query = UpstreamQuery::construct(m_nameservers, name, record_type, this);
+    query->start_in_background([this, name, record_type, query = query.ptr()](auto response) {
+        if (response.has_value())
+            put_in_cache(name, record_type, response.value());
+        deferred_invoke([query] { query->remove_from_parent(); });
+    });
 }
 
 }
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "ClientConnection.h"
+#include "DNSCache.h"
 #include "DNSName.h"
 #include "DNSPacket.h"
 #include "DNSServer.h"
@@ -30,9 +31,8 @@ private:
     LookupServer();
 
     void load_etc_hosts();
-    void put_in_cache(const DNSAnswer&);
-
-    Vector<DNSAnswer> lookup(const DNSName& hostname, const String& nameserver, bool& did_get_response, DNSRecordType record_type, ShouldRandomizeCase = ShouldRandomizeCase::Yes);
+    Vector<DNSAnswer> put_in_cache(const DNSName&, DNSRecordType, const DNSPacket& response);
+    void refresh_in_background(const DNSName&, DNSRecordType);
 
     OwnPtr<IPC::MultiServer<ClientConnection>> m_server;
     RefPtr<DNSServer> m_dns_server;
@@ -40,7 +40,7 @@ private:
     Vector<String> m_nameservers;
     RefPtr<Core::FileWatcher> m_file_watcher;
     HashMap<DNSName, Vector<DNSAnswer>, DNSName::Traits> m_etc_hosts;
-    HashMap<DNSName, Vector<DNSAnswer>, DNSName::Traits> m_lookup_cache;
+    DNSCache m_lookup_cache;
 };
 
 }
@@ -43,25 +43,33 @@ MulticastDNS::MulticastDNS(Object* parent)
     bind(IPv4Address(), 5353);
 
     on_ready_to_receive = [this]() {
-        handle_packet();
+        handle_packets();
     };
 
     // TODO: Announce on startup. We cannot just call announce() here,
     // because it races with the network interfaces getting configured.
 }
 
-void MulticastDNS::handle_packet()
+void MulticastDNS::handle_packets()
 {
-    auto buffer = receive(1024);
-    auto optional_packet = DNSPacket::from_raw_packet(buffer.data(), buffer.size());
-    if (!optional_packet.has_value()) {
-        dbgln("Got an invalid mDNS packet");
+    // Everyone on the link sees every query, so take all the ones that are queued up with a single syscall.
+    auto datagrams_or_error = receive_many(max_packets_per_batch, 1024);
+    if (datagrams_or_error.is_error()) {
+        dbgln("Failed to receive mDNS packets: {}", datagrams_or_error.error());
         return;
     }
-    auto& packet = optional_packet.value();
 
-    if (packet.is_query())
-        handle_query(packet);
+    for (auto& datagram : datagrams_or_error.value()) {
+        auto optional_packet = DNSPacket::from_raw_packet(datagram.data.data(), datagram.data.size());
+        if (!optional_packet.has_value()) {
+            dbgln("Got an invalid mDNS packet");
+            continue;
+        }
+        auto& packet = optional_packet.value();
+
+        if (packet.is_query())
+            handle_query(packet);
+    }
 }
 
 void MulticastDNS::handle_query(const DNSPacket& packet)
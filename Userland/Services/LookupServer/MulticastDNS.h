@@ -26,7 +26,9 @@ private:
     void announce();
     ErrorOr<size_t> emit_packet(const DNSPacket&, const sockaddr_in* destination = nullptr);
 
-    void handle_packet();
+    static constexpr size_t max_packets_per_batch = 32;
+
+    void handle_packets();
     void handle_query(const DNSPacket&);
 
     Vector<IPv4Address> local_addresses() const;
@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "UpstreamQuery.h"
+#include <AK/Debug.h>
+#include <AK/IPv4Address.h>
+#include <AK/Random.h>
+#include <AK/Time.h>
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+
+namespace LookupServer {
+
+static constexpr int retransmit_interval_ms = 1000;
+
+static DNSPacket make_request(DNSName const& name, DNSRecordType record_type, ShouldRandomizeCase should_randomize_case)
+{
+    DNSPacket request;
+    request.set_is_query();
+    request.set_id(get_random_uniform(UINT16_MAX));
+    DNSName name_in_question = name;
+    if (should_randomize_case == ShouldRandomizeCase::Yes)
+        name_in_question.randomize_case();
+    request.add_question({ name_in_question, record_type, DNSRecordClass::IN, false });
+    return request;
+}
+
+UpstreamQuery::UpstreamQuery(Vector<String> const& nameservers, DNSName const& name, DNSRecordType record_type, Core::Object* parent)
+    : Core::Object(parent)
+    , m_name(name)
+    , m_record_type(record_type)
+{
+    for (auto& nameserver : nameservers) {
+        auto address = IPv4Address::from_string(nameserver);
+        if (!address.has_value()) {
+            dbgln("LookupServer: Nameserver '{}' is not an IPv4 address", nameserver);
+            continue;
+        }
+        auto socket = Core::UDPSocket::construct(this);
+        socket->set_blocking(false);
+        if (!socket->connect(address.value(), 53))
+            continue;
+        m_nameservers.append({ move(socket), make_request(name, record_type, ShouldRandomizeCase::Yes) });
+    }
+
+    if (m_nameservers.is_empty()) {
+        m_has_failed = true;
+        return;
+    }
+    for (auto& nameserver : m_nameservers)
+        send_request(nameserver);
+}
+
+void UpstreamQuery::send_request(Nameserver& nameserver)
+{
+    dbgln_if(LOOKUPSERVER_DEBUG, "Asking {} for {} ({})", nameserver.socket->destination_address(), m_name, m_record_type);
+    auto buffer = nameserver.request.to_byte_buffer();
+    if (::send(nameserver.socket->fd(), buffer.data(), buffer.size(), 0) < 0) {
+        dbgln("LookupServer: Failed to send a request to {}: {}", nameserver.socket->destination_address(), strerror(errno));
+        fail(nameserver);
+    }
+}
+
+void UpstreamQuery::fail(Nameserver& nameserver)
+{
+    nameserver.has_failed = true;
+    if (all_of(m_nameservers, [](auto& nameserver) { return nameserver.has_failed; })) {
+        dbgln("Tried all nameservers but never got a response :(");
+        m_has_failed = true;
+    }
+}
+
+void UpstreamQuery::handle_response(Nameserver& nameserver)
+{
+    auto fail = [&] { this->fail(nameserver); };
+
+    u8 response_buffer[4096];
+    auto nrecv = ::recv(nameserver.socket->fd(), response_buffer, sizeof(response_buffer), 0);
+    // Whatever arrives after the fact is still read, so it doesn't keep the socket readable.
+    if (nameserver.has_failed || is_finished())
+        return;
+    if (nrecv < 0) {
+        if (errno == EAGAIN || errno == EINTR)
+            return;
+        // Most likely an ICMP error, like the port being unreachable.
+        dbgln("LookupServer: Failed to receive from {}: {}", nameserver.socket->destination_address(), strerror(errno));
+        return fail();
+    }
+
+    auto o_response = DNSPacket::from_raw_packet(response_buffer, nrecv);
+    if (!o_response.has_value())
+        return;
+    auto& response = o_response.value();
+    auto& request = nameserver.request;
+
+    // Whatever doesn't answer our latest request is ignored, just like anything a spoofer might send.
+    if (response.id() != request.id()) {
+        dbgln("LookupServer: ID mismatch ({} vs {}) :(", response.id(), request.id());
+        return;
+    }
+
+    if (response.code() == DNSPacket::Code::REFUSED) {
+        if (nameserver.should_randomize_case == ShouldRandomizeCase::Yes) {
+            // Retry with 0x20 case randomization turned off.
+            nameserver.should_randomize_case = ShouldRandomizeCase::No;
+            request = make_request(m_name, m_record_type, ShouldRandomizeCase::No);
+            return send_request(nameserver);
+        }
+        return fail();
+    }
+    if (response.code() != DNSPacket::Code::NOERROR && response.code() != DNSPacket::Code::NXDOMAIN) {
+        dbgln("LookupServer: {} failed to look up {}: response code {}", nameserver.socket->destination_address(), m_name, (u8)response.code());
+        return fail();
+    }
+
+    if (response.question_count() != request.question_count()) {
+        dbgln("LookupServer: Question count ({} vs {}) :(", response.question_count(), request.question_count());
+        return fail();
+    }
+
+    // Verify the questions in our request and in their response match exactly, including case.
+    for (size_t i = 0; i < request.question_count(); ++i) {
+        auto& request_question = request.questions()[i];
+        auto& response_question = response.questions()[i];
+        bool exact_match = request_question.class_code() == response_question.class_code()
+            && request_question.record_type() == response_question.record_type()
+            && request_question.name().as_string() == response_question.name().as_string();
+        if (!exact_match) {
+            dbgln("Request and response questions do not match");
+            dbgln("   Request: name=_{}_, type={}, class={}", request_question.name().as_string(), response_question.record_type(), response_question.class_code());
+            dbgln("  Response: name=_{}_, type={}, class={}", response_question.name().as_string(), response_question.record_type(), response_question.class_code());
+            return fail();
+        }
+    }
+
+    dbgln_if(LOOKUPSERVER_DEBUG, "Got the answer for {} from {}", m_name, nameserver.socket->destination_address());
+    m_response = move(response);
+}
+
+void UpstreamQuery::did_time_out()
+{
+    if (--m_attempts_left == 0) {
+        dbgln("LookupServer: Never got a response for {} :(", m_name);
+        m_has_failed = true;
+        return;
+    }
+    for (auto& nameserver : m_nameservers) {
+        if (!nameserver.has_failed)
+            send_request(nameserver);
+    }
+}
+
+Optional<DNSPacket> UpstreamQuery::wait()
+{
+    VERIFY(!m_on_finish);
+
+    auto next_retransmit_time = Time::now_monotonic() + Time::from_milliseconds(retransmit_interval_ms);
+    Vector<pollfd> poll_fds;
+    Vector<Nameserver&> polled_nameservers;
+    while (!is_finished()) {
+        poll_fds.clear_with_capacity();
+        polled_nameservers.clear_with_capacity();
+        for (auto& nameserver : m_nameservers) {
+            if (nameserver.has_failed)
+                continue;
+            poll_fds.append({ nameserver.socket->fd(), POLLIN, 0 });
+            polled_nameservers.append(nameserver);
+        }
+
+        auto timeout = max<i64>((next_retransmit_time - Time::now_monotonic()).to_milliseconds(), 0);
+        int rc = poll(poll_fds.data(), poll_fds.size(), timeout);
+        if (rc < 0) {
+            if (errno == EINTR)
+                continue;
+            perror("poll");
+            m_has_failed = true;
+            break;
+        }
+        if (rc == 0) {
+            did_time_out();
+            next_retransmit_time = Time::now_monotonic() + Time::from_milliseconds(retransmit_interval_ms);
+            continue;
+        }
+        for (size_t i = 0; i < poll_fds.size() && !is_finished(); ++i) {
+            if (poll_fds[i].revents)
+                handle_response(polled_nameservers[i]);
+        }
+    }
+    return m_response;
+}
+
+void UpstreamQuery::start_in_background(Function<void(Optional<DNSPacket>)> on_finish)
+{
+    VERIFY(!m_on_finish);
+    m_on_finish = move(on_finish);
+
+    auto finish_if_done = [this] {
+        if (!is_finished())
+            return;
+        m_timer->stop();
+        for (auto& nameserver : m_nameservers)
+            nameserver.socket->on_ready_to_read = nullptr;
+        // The callback may well get rid of us, so it's called last.
+        auto on_finish = move(m_on_finish);
+        on_finish(m_response);
+    };
+
+    m_timer = Core::Timer::create_repeating(
+        retransmit_interval_ms, [this, finish_if_done] {
+            did_time_out();
+            finish_if_done();
+        },
+        this);
+    for (auto& nameserver : m_nameservers) {
+        nameserver.socket->on_ready_to_read = [this, &nameserver, finish_if_done] {
+            handle_response(nameserver);
+            finish_if_done();
+        };
+    }
+
+    if (is_finished()) {
+        deferred_invoke([finish_if_done] { finish_if_done(); });
+        return;
+    }
+    m_timer->start();
+}
+
+}
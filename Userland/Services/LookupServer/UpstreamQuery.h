@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include "DNSName.h"
+#include "DNSPacket.h"
+#include <AK/Function.h>
+#include <AK/NonnullRefPtrVector.h>
+#include <AK/Optional.h>
+#include <LibCore/Object.h>
+#include <LibCore/Timer.h>
+#include <LibCore/UDPSocket.h>
+
+namespace LookupServer {
+
+// Asks all the nameservers the same question at once, and takes the first usable response. This is either one with
+// answers, or one that says there aren't any (NXDOMAIN, or no records of the type). Nameservers that haven't answered
+// get the question again every second, up to a few times.
+class UpstreamQuery final : public Core::Object {
+    C_OBJECT(UpstreamQuery);
+
+public:
+    virtual ~UpstreamQuery() override = default;
+
+    // Blocks until there's a response, or until all the nameservers have failed or timed out.
+    Optional<DNSPacket> wait();
+
+    // Waits for the response in the event loop instead. on_finish gets no packet if there wasn't any usable response.
+    void start_in_background(Function<void(Optional<DNSPacket>)> on_finish);
+
+private:
+    UpstreamQuery(Vector<String> const& nameservers, DNSName const&, DNSRecordType, Core::Object* parent = nullptr);
+
+    struct Nameserver {
+        RefPtr<Core::UDPSocket> socket;
+        DNSPacket request;
+        ShouldRandomizeCase should_randomize_case { ShouldRandomizeCase::Yes };
+        bool has_failed { false };
+    };
+
+    void send_request(Nameserver&);
+    void fail(Nameserver&);
+    void handle_response(Nameserver&);
+    void did_time_out();
+    bool is_finished() const { return m_response.has_value() || m_has_failed; }
+
+    DNSName m_name;
+    DNSRecordType m_record_type;
+    Vector<Nameserver> m_nameservers;
+    int m_attempts_left { 3 };
+
+    Optional<DNSPacket> m_response;
+    bool m_has_failed { false };
+
+    RefPtr<Core::Timer> m_timer;
+    Function<void(Optional<DNSPacket>)> m_on_finish;
+};
+
+}
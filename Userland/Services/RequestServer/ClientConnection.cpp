@@ -142,7 +142,8 @@ void ClientConnection::ensure_connection(URL const& url, ::RequestServer::CacheL
 
             bool did_connect;
             if (is_tls) {
-                tls_instance->set_root_certificates(DefaultRootCACertificates::the().certificates());
+                tls_instance->set_trust_store(DefaultRootCACertificates::the().trust_store());
+                HTTP::Http2Connection::offer_through_alpn(*tls_instance);
                 tls_instance->on_tls_connected = [socket = socket.ptr(), url = m_url, tls_instance] {
                     tls_instance->set_on_tls_ready_to_write([socket, url](auto&) {
                         ConnectionCache::request_did_finish(url, socket);
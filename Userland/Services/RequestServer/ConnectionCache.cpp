@@ -11,6 +11,8 @@ namespace RequestServer::ConnectionCache {
 
 HashMap<ConnectionKey, NonnullOwnPtr<NonnullOwnPtrVector<Connection<Core::TCPSocket>>>> g_tcp_connection_cache {};
 HashMap<ConnectionKey, NonnullOwnPtr<NonnullOwnPtrVector<Connection<TLS::TLSv12>>>> g_tls_connection_cache {};
+HashMap<ConnectionKey, TLS::Session> g_tls_session_cache {};
+HashTable<ConnectionKey> g_http2_origins {};
 
 void request_did_finish(URL const& url, Core::Socket const* socket)
 {
@@ -35,6 +37,31 @@ void request_did_finish(URL const& url, Core::Socket const* socket)
         }
 
         auto& connection = *connection_it;
+        using SocketType = RemoveCVReference<decltype(*connection->socket)>;
+        auto has_new_socket = false;
+        if constexpr (IsSame<SocketType, TLS::TLSv12>) {
+            if (auto session = connection->socket->session(); session.has_value())
+                g_tls_session_cache.set(key, session.release_value());
+
+            if (connection->http2_connection) {
+                auto& http2_connection = *connection->http2_connection;
+                while (!connection->request_queue.is_empty() && http2_connection.can_open_stream())
+                    connection->request_queue.take_first()(*connection);
+                // Other requests are still running on the connection.
+                if (http2_connection.open_stream_count() > 0)
+                    return;
+                if (!http2_connection.can_open_stream()) {
+                    // The server is done with the connection (which closes its socket once we let go of it).
+                    connection->http2_connection = nullptr;
+                    connection->socket = create_socket<SocketType>(key);
+                    has_new_socket = true;
+                    dbgln("HTTP/2 connection for {} went away, new socket {}", url, connection->socket);
+                }
+            } else if (connection->socket->is_established() && connection->socket->alpn() != HTTP::Http2Connection::alpn_protocol) {
+                g_http2_origins.remove(key);
+            }
+        }
+
         if (connection->request_queue.is_empty()) {
             connection->has_started = false;
             connection->current_url = {};
@@ -49,22 +76,21 @@ void request_did_finish(URL const& url, Core::Socket const* socket)
             };
             connection->removal_timer->start();
         } else {
-            using SocketType = RemoveCVReference<decltype(*connection->socket)>;
             bool is_connected;
             if constexpr (IsSame<SocketType, TLS::TLSv12>)
                 is_connected = connection->socket->is_established();
             else
                 is_connected = connection->socket->is_connected();
-            if (!is_connected) {
+            if (!is_connected && !has_new_socket) {
                 // Create another socket for the connection.
-                connection->socket = SocketType::construct(nullptr);
+                connection->socket = create_socket<SocketType>(key);
                 dbgln("Creating a new socket for {} -> {}", url, connection->socket);
             }
             dbgln("Running next job in queue for connection {} @{}", &connection, connection->socket);
             auto request = connection->request_queue.take_first();
             connection->timer.start();
             connection->current_url = url;
-            request(connection->socket);
+            request(*connection);
         }
     };
 
@@ -83,6 +109,8 @@ void dump_jobs()
         dbgln(" - {}:{}", connection.key.hostname, connection.key.port);
         for (auto& entry : *connection.value) {
             dbgln("  - Connection {} (started={}) (socket={})", &entry, entry.has_started, entry.socket);
+            if (entry.http2_connection)
+                dbgln("    HTTP/2 with {} open streams", entry.http2_connection->open_stream_count());
             dbgln("    Currently loading {} ({} elapsed)", entry.current_url, entry.timer.elapsed());
             dbgln("    Request Queue:");
             for (auto& job : entry.request_queue)
@@ -8,12 +8,14 @@
 
 #include <AK/Debug.h>
 #include <AK/HashMap.h>
+#include <AK/HashTable.h>
 #include <AK/NonnullOwnPtrVector.h>
 #include <AK/URL.h>
 #include <AK/Vector.h>
 #include <LibCore/ElapsedTimer.h>
 #include <LibCore/TCPSocket.h>
 #include <LibCore/Timer.h>
+#include <LibHTTP/Http2Connection.h>
 #include <LibTLS/TLSv12.h>
 
 namespace RequestServer {
@@ -29,7 +31,7 @@ namespace RequestServer::ConnectionCache {
 
 template<typename Socket>
 struct Connection {
-    using QueueType = Vector<Function<void(Core::Socket&)>>;
+    using QueueType = Vector<Function<void(Connection&)>>;
     using SocketType = Socket;
 
     NonnullRefPtr<Socket> socket;
@@ -38,6 +40,9 @@ struct Connection {
     bool has_started { false };
     URL current_url {};
     Core::ElapsedTimer timer {};
+    // Set once the server picked HTTP/2 for the socket. From then on, requests run side by side on streams of it, and
+    // only queue up when the server's limit on streams has been reached.
+    RefPtr<HTTP::Http2Connection> http2_connection {};
 };
 
 struct ConnectionKey {
@@ -61,6 +66,10 @@ namespace RequestServer::ConnectionCache {
 
 extern HashMap<ConnectionKey, NonnullOwnPtr<NonnullOwnPtrVector<Connection<Core::TCPSocket>>>> g_tcp_connection_cache;
 extern HashMap<ConnectionKey, NonnullOwnPtr<NonnullOwnPtrVector<Connection<TLS::TLSv12>>>> g_tls_connection_cache;
+extern HashMap<ConnectionKey, TLS::Session> g_tls_session_cache;
+// Origins whose last connection spoke HTTP/2. Requests to them wait for the connection that is being set up, rather
+// than each opening one of their own.
+extern HashTable<ConnectionKey> g_http2_origins;
 
 void request_did_finish(URL const&, Core::Socket const*);
 void dump_jobs();
@@ -68,19 +77,72 @@ void dump_jobs();
 constexpr static inline size_t MaxConcurrentConnectionsPerURL = 2;
 constexpr static inline size_t ConnectionKeepAliveTimeMilliseconds = 10'000;
 
+template<typename SocketType>
+NonnullRefPtr<SocketType> create_socket(ConnectionKey const& key)
+{
+    auto socket = SocketType::construct(nullptr);
+    if constexpr (IsSame<SocketType, TLS::TLSv12>) {
+        // Reconnecting to a host we've talked to before can skip the certificate chain and key exchange.
+        if (auto session = g_tls_session_cache.get(key); session.has_value())
+            socket->set_session_to_resume(*session);
+    }
+    return socket;
+}
+
+template<typename ConnectionType>
+void start_job_on_connection(ConnectionType& connection, ConnectionKey const& key, auto& job)
+{
+    if constexpr (requires { job.start_on_http2_connection(*connection.http2_connection); }) {
+        if (connection.http2_connection) {
+            if (connection.http2_connection->can_open_stream())
+                return job.start_on_http2_connection(*connection.http2_connection);
+            // The server is done with the connection, so the job needs a new one.
+            connection.http2_connection = nullptr;
+            connection.socket = create_socket<typename ConnectionType::SocketType>(key);
+        }
+        job.on_http2_connection_established = [&connection, key](HTTP::Http2Connection& http2_connection) {
+            dbgln("Connection {} to {}:{} is now HTTP/2", &connection, key.hostname, key.port);
+            connection.http2_connection = http2_connection;
+            g_http2_origins.set(key);
+            // Whatever queued up behind the handshake can start right away.
+            while (!connection.request_queue.is_empty() && http2_connection.can_open_stream())
+                connection.request_queue.take_first()(connection);
+        };
+    }
+    job.start(connection.socket);
+}
+
 decltype(auto) get_or_create_connection(auto& cache, URL const& url, auto& job)
 {
     using CacheEntryType = RemoveCVReference<decltype(*cache.begin()->value)>;
-    auto start_job = [&job](auto& socket) {
-        job.start(socket);
+    ConnectionKey key { url.host(), url.port_or_default() };
+    auto start_job = [&job, key](auto& connection) {
+        start_job_on_connection(connection, key, job);
     };
-    auto& sockets_for_url = *cache.ensure({ url.host(), url.port_or_default() }, [] { return make<CacheEntryType>(); });
+    auto& sockets_for_url = *cache.ensure(key, [] { return make<CacheEntryType>(); });
+
+    // An HTTP/2 connection takes the request no matter how many others are running on it.
+    auto http2_it = sockets_for_url.find_if([](auto& connection) { return connection->http2_connection && connection->http2_connection->can_open_stream(); });
+    if (!http2_it.is_end()) {
+        auto& connection = sockets_for_url[http2_it.index()];
+        dbgln("Start request for url {} on HTTP/2 connection {}", url, &connection);
+        if (!connection.has_started) {
+            connection.has_started = true;
+            connection.removal_timer->stop();
+            connection.timer.start();
+        }
+        connection.current_url = url;
+        start_job(connection);
+        return connection;
+    }
+
     auto it = sockets_for_url.find_if([](auto& connection) { return connection->request_queue.is_empty(); });
     auto did_add_new_connection = false;
-    if (it.is_end() && sockets_for_url.size() < ConnectionCache::MaxConcurrentConnectionsPerURL) {
+    auto may_add_connection = sockets_for_url.is_empty() || !g_http2_origins.contains(key);
+    if (it.is_end() && may_add_connection && sockets_for_url.size() < ConnectionCache::MaxConcurrentConnectionsPerURL) {
         using ConnectionType = RemoveCVReference<decltype(cache.begin()->value->at(0))>;
         sockets_for_url.append(make<ConnectionType>(
-            ConnectionType::SocketType::construct(nullptr),
+            create_socket<typename ConnectionType::SocketType>(key),
             typename ConnectionType::QueueType {},
             Core::Timer::create_single_shot(ConnectionKeepAliveTimeMilliseconds, nullptr)));
         did_add_new_connection = true;
@@ -110,7 +172,7 @@ decltype(auto) get_or_create_connection(auto& cache, URL const& url, auto& job)
         connection.removal_timer->stop();
         connection.timer.start();
         connection.current_url = url;
-        start_job(*connection.socket);
+        start_job(connection);
     } else {
         dbgln("Enqueue request for URL {} in {} - {}", url, &connection, connection.socket);
         connection.request_queue.append(move(start_job));
@@ -82,6 +82,8 @@ OwnPtr<Request> start_request(TBadgedProtocol&& protocol, ClientConnection& clie
     auto output_stream = make<OutputFileStream>(pipe_result.value().write_fd);
     output_stream->make_unbuffered();
     auto job = TJob::construct(move(request), *output_stream);
+    // The pipe doesn't block, so the job can tell when the client falls behind and stop reading until it catches up.
+    job->set_output_fd(pipe_result.value().write_fd);
     auto protocol_request = TRequest::create_with_job(forward<TBadgedProtocol>(protocol), client, (TJob&)*job, move(output_stream));
     protocol_request->set_request_fd(pipe_result.value().read_fd);
 
@@ -69,6 +69,18 @@ Messages::SQLServer::SqlStatementResponse ClientConnection::sql_statement(int co
     }
 }
 
+void ClientConnection::statement_bind(int statement_id, Vector<String> const& placeholder_values)
+{
+    dbgln_if(SQLSERVER_DEBUG, "ClientConnection::statement_bind(statement_id: {}, {} values)", statement_id, placeholder_values.size());
+    auto statement = SQLStatement::statement_for(statement_id);
+    if (statement && statement->connection()->client_id() == client_id()) {
+        statement->bind(placeholder_values);
+    } else {
+        dbgln_if(SQLSERVER_DEBUG, "Statement has disappeared");
+        async_execution_error(statement_id, (int)SQL::SQLErrorCode::StatementUnavailable, String::formatted("{}", statement_id));
+    }
+}
+
 void ClientConnection::statement_execute(int statement_id)
 {
     dbgln_if(SQLSERVER_DEBUG, "ClientConnection::statement_execute_query(statement_id: {})", statement_id);
@@ -81,4 +93,16 @@ void ClientConnection::statement_execute(int statement_id)
     }
 }
 
+void ClientConnection::statement_fetch(int statement_id, int max_rows)
+{
+    dbgln_if(SQLSERVER_DEBUG, "ClientConnection::statement_fetch(statement_id: {}, max_rows: {})", statement_id, max_rows);
+    auto statement = SQLStatement::statement_for(statement_id);
+    if (statement && statement->connection()->client_id() == client_id() && max_rows >= 0) {
+        statement->fetch(max_rows);
+    } else {
+        dbgln_if(SQLSERVER_DEBUG, "Statement has disappeared");
+        async_execution_error(statement_id, (int)SQL::SQLErrorCode::StatementUnavailable, String::formatted("{}", statement_id));
+    }
+}
+
 }
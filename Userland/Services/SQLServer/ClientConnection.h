@@ -29,7 +29,9 @@ private:
 
     virtual Messages::SQLServer::ConnectResponse connect(String const&) override;
     virtual Messages::SQLServer::SqlStatementResponse sql_statement(int, String const&) override;
+    virtual void statement_bind(int, Vector<String> const&) override;
     virtual void statement_execute(int) override;
+    virtual void statement_fetch(int, int) override;
     virtual void disconnect(int) override;
 };
 
@@ -23,6 +23,11 @@ RefPtr<DatabaseConnection> DatabaseConnection::connection_for(int connection_id)
 
 static int s_next_connection_id = 0;
 
+// All connections to the same database share one Database object, so that they see each
+// other's changes and can have their commits grouped together.
+static HashMap<String, WeakPtr<SQL::Database>> s_databases;
+static HashMap<SQL::Database*, Vector<Function<void(Optional<SQL::SQLError>)>>> s_pending_commits;
+
 DatabaseConnection::DatabaseConnection(String database_name, int client_id)
     : Object()
     , m_database_name(move(database_name))
@@ -38,11 +43,17 @@ DatabaseConnection::DatabaseConnection(String database_name, int client_id)
     dbgln_if(SQLSERVER_DEBUG, "DatabaseConnection {} initiating connection with database '{}'", connection_id(), m_database_name);
     s_connections.set(m_connection_id, *this);
     deferred_invoke([this]() {
-        m_database = SQL::Database::construct(String::formatted("/home/anon/sql/{}.db", m_database_name));
         auto client_connection = ClientConnection::client_connection_for(m_client_id);
-        if (auto maybe_error = m_database->open(); maybe_error.is_error()) {
-            client_connection->async_connection_error(m_connection_id, (int)SQL::SQLErrorCode::InternalError, maybe_error.error().string_literal());
-            return;
+        if (auto database = s_databases.get(m_database_name); database.has_value() && database.value()) {
+            m_database = database.value().ptr();
+        } else {
+            auto new_database = SQL::Database::construct(String::formatted("/home/anon/sql/{}.db", m_database_name));
+            if (auto maybe_error = new_database->open(); maybe_error.is_error()) {
+                client_connection->async_connection_error(m_connection_id, (int)SQL::SQLErrorCode::InternalError, maybe_error.error().string_literal());
+                return;
+            }
+            s_databases.set(m_database_name, new_database->make_weak_ptr<SQL::Database>());
+            m_database = move(new_database);
         }
         m_accept_statements = true;
         if (client_connection)
@@ -67,6 +78,28 @@ void DatabaseConnection::disconnect()
     });
 }
 
+// Changes are committed once per event loop iteration. Every statement that asks for a commit
+// in the meantime, from any connection to the same database, is covered by that one commit.
+void DatabaseConnection::commit(Function<void(Optional<SQL::SQLError>)> on_committed)
+{
+    VERIFY(m_database);
+    auto& waiting = s_pending_commits.ensure(m_database.ptr());
+    waiting.append(move(on_committed));
+    if (waiting.size() > 1)
+        return;
+
+    Core::deferred_invoke([database = NonnullRefPtr(*m_database)]() mutable {
+        auto waiting = move(s_pending_commits.find(database.ptr())->value);
+        s_pending_commits.remove(database.ptr());
+        dbgln_if(SQLSERVER_DEBUG, "Committing {} statements in one transaction", waiting.size());
+        Optional<SQL::SQLError> maybe_error;
+        if (auto result = database->commit(); result.is_error())
+            maybe_error = SQL::SQLError { SQL::SQLErrorCode::InternalError, result.error().string_literal() };
+        for (auto& on_committed : waiting)
+            on_committed(maybe_error);
+    });
+}
+
 int DatabaseConnection::sql_statement(String const& sql)
 {
     dbgln_if(SQLSERVER_DEBUG, "DatabaseConnection::sql_statement(connection_id {}, database '{}', sql '{}'", connection_id(), m_database_name, sql);
@@ -79,7 +112,19 @@ int DatabaseConnection::sql_statement(String const& sql)
         client_connection->async_execution_error(-1, (int)SQL::SQLErrorCode::DatabaseUnavailable, m_database_name);
         return -1;
     }
-    auto statement = SQLStatement::construct(*this, sql);
+    // Statements are kept after they finish, so running the same SQL again skips parsing it.
+    RefPtr<SQLStatement> statement;
+    for_each_child_of_type<SQLStatement>([&](auto& child) {
+        if (child.is_in_use() || child.sql() != sql)
+            return IterationDecision::Continue;
+        statement = child;
+        return IterationDecision::Break;
+    });
+    if (statement) {
+        statement->reuse();
+        return statement->statement_id();
+    }
+    statement = SQLStatement::construct(*this, sql);
     return statement->statement_id();
 }
 
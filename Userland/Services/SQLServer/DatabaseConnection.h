@@ -6,8 +6,10 @@
 
 #pragma once
 
+#include <AK/Function.h>
 #include <LibCore/Object.h>
 #include <LibSQL/Database.h>
+#include <LibSQL/SQLResult.h>
 #include <SQLServer/Forward.h>
 
 namespace SQLServer {
@@ -24,6 +26,7 @@ public:
     RefPtr<SQL::Database> database() { return m_database; }
     void disconnect();
     int sql_statement(String const& sql);
+    void commit(Function<void(Optional<SQL::SQLError>)> on_committed);
 
 private:
     DatabaseConnection(String database_name, int client_id);
@@ -51,9 +51,72 @@ void SQLStatement::report_error(SQL::SQLError error)
     m_result = nullptr;
 }
 
+// A statement is handed out again by its connection once its previous execution has finished.
+// The parsed statement is kept, so executing it again only needs new placeholder values.
+void SQLStatement::reuse()
+{
+    VERIFY(!m_in_use);
+    m_in_use = true;
+    m_placeholder_values.clear();
+}
+
+// Placeholder values are given as SQL literals: a number, a quoted string, or NULL.
+static Optional<SQL::Value> parse_placeholder_value(String const& literal)
+{
+    SQL::AST::Lexer lexer(literal);
+    auto token = lexer.next();
+    auto is_negative = token.type() == SQL::AST::TokenType::Minus;
+    if (is_negative)
+        token = lexer.next();
+
+    SQL::Value value;
+    switch (token.type()) {
+    case SQL::AST::TokenType::NumericLiteral:
+        value = SQL::Value(is_negative ? -token.double_value() : token.double_value());
+        break;
+    case SQL::AST::TokenType::StringLiteral:
+        if (is_negative)
+            return {};
+        value = SQL::Value(token.value());
+        break;
+    case SQL::AST::TokenType::Null:
+        if (is_negative)
+            return {};
+        break;
+    default:
+        return {};
+    }
+    if (lexer.next().type() != SQL::AST::TokenType::Eof)
+        return {};
+    return value;
+}
+
+void SQLStatement::bind(Vector<String> const& placeholder_values)
+{
+    dbgln_if(SQLSERVER_DEBUG, "SQLStatement::bind(statement_id {}, {} values)", statement_id(), placeholder_values.size());
+    m_placeholder_values.clear();
+    for (auto& literal : placeholder_values) {
+        auto value = parse_placeholder_value(literal);
+        if (!value.has_value()) {
+            report_error({ SQL::SQLErrorCode::SyntaxError, String::formatted("Invalid placeholder value '{}'", literal) });
+            return;
+        }
+        m_placeholder_values.append(value.release_value());
+    }
+}
+
 void SQLStatement::execute()
+{
+    execute({});
+}
+
+// Rows are sent as they are produced by the statement. If max_rows is given, no more than that
+// many rows are sent until the client asks for more with fetch().
+void SQLStatement::execute(Optional<size_t> max_rows)
 {
     dbgln_if(SQLSERVER_DEBUG, "SQLStatement::execute(statement_id {}", statement_id());
+    m_executed = true;
+    m_rows_to_send = max_rows;
     auto client_connection = ClientConnection::client_connection_for(connection()->client_id());
     if (!client_connection) {
         warnln("Cannot yield next result. Client disconnected");
@@ -61,30 +124,50 @@ void SQLStatement::execute()
     }
 
     deferred_invoke([this]() {
-        auto maybe_error = parse();
-        if (maybe_error.has_value()) {
-            report_error(maybe_error.value());
-            return;
+        if (!m_statement) {
+            auto maybe_error = parse();
+            if (maybe_error.has_value()) {
+                report_error(maybe_error.value());
+                return;
+            }
         }
         VERIFY(!connection()->database().is_null());
-        m_result = m_statement->execute(connection()->database().release_nonnull());
+        m_result = m_statement->execute(connection()->database().release_nonnull(), m_placeholder_values);
         if (m_result->error().code != SQL::SQLErrorCode::NoError) {
             report_error(m_result->error());
             return;
         }
-        auto client_connection = ClientConnection::client_connection_for(connection()->client_id());
-        if (!client_connection) {
-            warnln("Cannot return statement execution results. Client disconnected");
+        if (m_result->inserted() == 0 && m_result->updated() == 0 && m_result->deleted() == 0) {
+            report_success();
             return;
         }
-        client_connection->async_execution_success(statement_id(), m_result->has_results(), m_result->updated(), m_result->inserted(), m_result->deleted());
-        if (m_result->has_results()) {
-            m_index = 0;
-            next();
-        }
+        // Success is only reported once the changes have been committed.
+        connection()->commit([this, strong_this = NonnullRefPtr(*this)](Optional<SQL::SQLError> maybe_error) {
+            if (maybe_error.has_value()) {
+                report_error(maybe_error.release_value());
+                return;
+            }
+            report_success();
+        });
     });
 }
 
+void SQLStatement::report_success()
+{
+    auto client_connection = ClientConnection::client_connection_for(connection()->client_id());
+    if (!client_connection) {
+        warnln("Cannot return statement execution results. Client disconnected");
+        return;
+    }
+    client_connection->async_execution_success(statement_id(), m_result->has_results(), m_result->updated(), m_result->inserted(), m_result->deleted());
+    if (m_result->has_results()) {
+        m_index = 0;
+        next();
+    } else {
+        finish();
+    }
+}
+
 Optional<SQL::SQLError> SQLStatement::parse()
 {
     auto parser = SQL::AST::Parser(SQL::AST::Lexer(m_sql));
@@ -95,6 +178,21 @@ Optional<SQL::SQLError> SQLStatement::parse()
     return {};
 }
 
+void SQLStatement::fetch(size_t max_rows)
+{
+    dbgln_if(SQLSERVER_DEBUG, "SQLStatement::fetch(statement_id {}, max_rows {})", statement_id(), max_rows);
+    if (!m_executed) {
+        execute(max_rows);
+        return;
+    }
+    if (!m_rows_to_send.has_value())
+        return;
+    auto was_waiting = m_rows_to_send.value() == 0;
+    m_rows_to_send = m_rows_to_send.value() + max_rows;
+    if (was_waiting && m_result && m_result->has_results())
+        next();
+}
+
 void SQLStatement::next()
 {
     VERIFY(m_result->has_results());
@@ -103,15 +201,36 @@ void SQLStatement::next()
         warnln("Cannot yield next result. Client disconnected");
         return;
     }
-    if (m_index < m_result->results().size()) {
-        auto& tuple = m_result->results()[m_index++];
-        client_connection->async_next_result(statement_id(), tuple.to_string_vector());
-        deferred_invoke([this]() {
-            next();
-        });
+    if (m_rows_to_send.has_value() && m_rows_to_send.value() == 0)
+        return;
+    auto tuple = m_result->next_row();
+    if (m_result->has_error()) {
+        report_error(m_result->error());
+        return;
+    }
+    if (tuple.has_value()) {
+        m_index++;
+        if (m_rows_to_send.has_value())
+            m_rows_to_send = m_rows_to_send.value() - 1;
+        client_connection->async_next_result(statement_id(), tuple->to_string_vector());
+        // Once the client has all the rows it asked for, the next fetch() picks up from here.
+        if (!m_rows_to_send.has_value() || m_rows_to_send.value() > 0) {
+            deferred_invoke([this]() {
+                next();
+            });
+        }
     } else {
         client_connection->async_results_exhausted(statement_id(), (int)m_index);
+        finish();
     }
 }
 
+void SQLStatement::finish()
+{
+    m_executed = false;
+    m_rows_to_send.clear();
+    m_result = nullptr;
+    m_in_use = false;
+}
+
 }
@@ -26,17 +26,28 @@ public:
     int statement_id() const { return m_statement_id; }
     String const& sql() const { return m_sql; }
     DatabaseConnection* connection() { return dynamic_cast<DatabaseConnection*>(parent()); }
+    bool is_in_use() const { return m_in_use; }
+    void reuse();
+    void bind(Vector<String> const& placeholder_values);
     void execute();
+    void fetch(size_t max_rows);
 
 private:
     SQLStatement(DatabaseConnection&, String sql);
     Optional<SQL::SQLError> parse();
+    void execute(Optional<size_t> max_rows);
+    void report_success();
     void next();
+    void finish();
     void report_error(SQL::SQLError);
 
     int m_statement_id;
     String m_sql;
     size_t m_index { 0 };
+    bool m_executed { false };
+    bool m_in_use { true };
+    Optional<size_t> m_rows_to_send;
+    Vector<SQL::Value> m_placeholder_values;
     RefPtr<SQL::AST::Statement> m_statement { nullptr };
     RefPtr<SQL::SQLResult> m_result { nullptr };
 };
@@ -7,6 +7,7 @@
 #include "Service.h"
 #include <AK/Debug.h>
 #include <AK/HashMap.h>
+#include <AK/HashTable.h>
 #include <AK/JsonArray.h>
 #include <AK/JsonObject.h>
 #include <AK/StringBuilder.h>
@@ -15,11 +16,15 @@
 #include <LibCore/Socket.h>
 #include <fcntl.h>
 #include <sched.h>
+#include <signal.h>
 #include <stdio.h>
 #include <sys/ioctl.h>
+#include <sys/socket.h>
 #include <unistd.h>
 
 static HashMap<pid_t, Service*> s_service_map;
+// Started along with SystemServer, for the boot timing log.
+static Core::ElapsedTimer const s_uptime_timer = Core::ElapsedTimer::start_new();
 
 Service* Service::find_by_pid(pid_t pid)
 {
@@ -110,8 +115,12 @@ void Service::handle_socket_connection()
             perror("accept");
             return;
         }
-        spawn(accepted_fd);
+        if (!hand_off_to_prewarmed_instance(accepted_fd))
+            spawn(accepted_fd);
         close(accepted_fd);
+        // Replace the instance we've just used once the client is on its way.
+        if (m_prewarmed_instance_count > 0)
+            deferred_invoke([this] { spawn_prewarmed_instances(); });
     } else {
         remove_child(*m_socket_notifier);
         m_socket_notifier = nullptr;
@@ -119,26 +128,155 @@ void Service::handle_socket_connection()
     }
 }
 
+void Service::spawn_prewarmed_instances()
+{
+    while (m_prewarmed_instances.size() < static_cast<size_t>(m_prewarmed_instance_count)) {
+        int handoff_fds[2];
+        if (socketpair(AF_LOCAL, SOCK_STREAM | SOCK_CLOEXEC, 0, handoff_fds) < 0) {
+            perror("socketpair");
+            return;
+        }
+        pid_t pid = spawn(handoff_fds[1], SpawnMode::Prewarmed);
+        close(handoff_fds[1]);
+        if (pid < 0) {
+            close(handoff_fds[0]);
+            return;
+        }
+        dbgln_if(SERVICE_DEBUG, "Prewarmed an instance of {}, pid {}", name(), pid);
+        m_prewarmed_instances.append({ pid, handoff_fds[0] });
+        s_service_map.set(pid, this);
+    }
+}
+
+bool Service::hand_off_to_prewarmed_instance(int accepted_fd)
+{
+    while (!m_prewarmed_instances.is_empty()) {
+        auto instance = m_prewarmed_instances.take_first();
+        // From here on, the instance is just like any other one of a multi-instance service.
+        s_service_map.remove(instance.pid);
+
+        // The byte wakes the instance up, and tells it the socket is there.
+        u8 byte = 0;
+        bool did_hand_off = sendfd(instance.handoff_fd, accepted_fd) == 0 && write(instance.handoff_fd, &byte, 1) == 1;
+        close(instance.handoff_fd);
+        if (did_hand_off) {
+            dbgln_if(SERVICE_DEBUG, "Handed a client of {} off to pid {}", name(), instance.pid);
+            return true;
+        }
+        dbgln("{}: Failed to hand a client off to prewarmed instance {}: {}", name(), instance.pid, strerror(errno));
+    }
+    return false;
+}
+
+void Service::resolve_dependencies(NonnullRefPtrVector<Service>& services)
+{
+    for (auto& service : services) {
+        for (auto& name : service.m_dependency_names) {
+            Service* dependency = nullptr;
+            for (auto& other_service : services) {
+                if (other_service.name() == name)
+                    dependency = &other_service;
+            }
+            if (!dependency) {
+                dbgln("{}: Ignoring the dependency on {}, which isn't enabled", service.name(), name);
+                continue;
+            }
+            service.m_dependencies.append(*dependency);
+            dependency->m_dependents.append(service);
+        }
+    }
+
+    // Every service in a cycle would wait for the others forever, so the dependency that closes it is dropped.
+    HashTable<Service*> visited_services;
+    HashTable<Service*> services_being_visited;
+    Function<void(Service&)> visit = [&](Service& service) {
+        visited_services.set(&service);
+        services_being_visited.set(&service);
+        for (size_t i = 0; i < service.m_dependencies.size();) {
+            auto& dependency = service.m_dependencies[i];
+            if (services_being_visited.contains(&dependency)) {
+                dbgln("{}: Ignoring the dependency on {}, which depends on it in turn", service.name(), dependency.name());
+                dependency.m_dependents.remove_first_matching([&](auto& dependent) { return &dependent == &service; });
+                service.m_dependencies.remove(i);
+                continue;
+            }
+            if (!visited_services.contains(&dependency))
+                visit(dependency);
+            ++i;
+        }
+        services_being_visited.remove(&service);
+    };
+    for (auto& service : services) {
+        if (!visited_services.contains(&service))
+            visit(service);
+    }
+}
+
+bool Service::has_all_dependencies_ready() const
+{
+    return all_of(m_dependencies, [](auto& dependency) { return dependency.m_is_ready; });
+}
+
 void Service::activate()
 {
     VERIFY(m_pid < 0);
 
-    if (m_lazy)
+    if (m_activation_time < 0)
+        m_activation_time = s_uptime_timer.elapsed();
+
+    // Everything that doesn't depend on anything is started right away, without waiting for the others. The rest is
+    // started as soon as what they depend on is ready, see did_become_ready().
+    if (!has_all_dependencies_ready()) {
+        dbgln_if(SERVICE_DEBUG, "{} is waiting for its dependencies", name());
+        m_is_waiting_for_dependencies = true;
+        return;
+    }
+    m_is_waiting_for_dependencies = false;
+
+    if (m_lazy) {
         setup_notifier();
-    else
-        spawn();
+    } else if (spawn() < 0) {
+        return;
+    }
+
+    spawn_prewarmed_instances();
+
+    if (!m_oneshot)
+        did_become_ready();
+}
+
+void Service::did_become_ready()
+{
+    if (m_is_ready)
+        return;
+    m_is_ready = true;
+
+    auto ready_time = s_uptime_timer.elapsed();
+    if (m_spawn_time >= 0) {
+        dbgln("Boot timing: {} was activated at {} ms, spawned at {} ms, and ready at {} ms ({} ms after spawning)",
+            name(), m_activation_time, m_spawn_time, ready_time, ready_time - m_spawn_time);
+    } else {
+        dbgln("Boot timing: {} was activated at {} ms, and its socket was ready at {} ms", name(), m_activation_time, ready_time);
+    }
+
+    for (auto& dependent : m_dependents) {
+        if (dependent.m_is_waiting_for_dependencies && dependent.has_all_dependencies_ready())
+            dependent.activate();
+    }
 }
 
-void Service::spawn(int socket_fd)
+pid_t Service::spawn(int socket_fd, SpawnMode mode)
 {
     if (!Core::File::exists(m_executable_path)) {
         dbgln("{}: binary \"{}\" does not exist, skipping service.", name(), m_executable_path);
-        return;
+        return -1;
     }
 
     dbgln_if(SERVICE_DEBUG, "Spawning {}", name());
 
     m_run_timer.start();
+    if (m_spawn_time < 0)
+        m_spawn_time = s_uptime_timer.elapsed();
     pid_t pid = fork();
 
     if (pid < 0) {
@@ -147,6 +285,9 @@ void Service::spawn(int socket_fd)
     } else if (pid == 0) {
         // We are the child.
 
+        // We ignore SIGPIPE so that a dead prewarmed instance can't take us down, but the service shouldn't.
+        signal(SIGPIPE, SIG_DFL);
+
         if (!m_working_directory.is_null()) {
             if (chdir(m_working_directory.characters()) < 0) {
                 perror("chdir");
@@ -217,6 +358,10 @@ void Service::spawn(int socket_fd)
             setenv("SOCKET_TAKEOVER", builder.to_string().characters(), true);
         }
 
+        // The socket is a connection to us, over which we send the accepted socket later on.
+        if (mode == SpawnMode::Prewarmed)
+            setenv("SOCKET_TAKEOVER_PREWARMED", "1", true);
+
         if (m_account.has_value()) {
             auto& account = m_account.value();
             if (setgid(account.gid()) < 0 || setgroups(account.extra_gids().size(), account.extra_gids().data()) < 0 || setuid(account.uid()) < 0) {
@@ -244,18 +389,39 @@ void Service::spawn(int socket_fd)
         m_pid = pid;
         s_service_map.set(pid, this);
     }
+    return pid;
 }
 
-void Service::did_exit(int exit_code)
+void Service::did_exit(pid_t pid, int exit_code)
 {
-    VERIFY(m_pid > 0);
+    s_service_map.remove(pid);
+
+    // A prewarmed instance that dies before it's used is simply replaced once the next client has been served, so
+    // that one which keeps crashing doesn't keep us busy.
+    for (size_t i = 0; i < m_prewarmed_instances.size(); ++i) {
+        if (m_prewarmed_instances[i].pid != pid)
+            continue;
+        dbgln("Prewarmed instance {} of {} has exited with exit code {}", pid, name(), exit_code);
+        close(m_prewarmed_instances[i].handoff_fd);
+        m_prewarmed_instances.remove(i);
+        return;
+    }
+
+    VERIFY(m_pid == pid);
     VERIFY(!m_multi_instance);
 
     dbgln("Service {} has exited with exit code {}", name(), exit_code);
 
-    s_service_map.remove(m_pid);
     m_pid = -1;
 
+    if (m_oneshot) {
+        if (exit_code == 0)
+            did_become_ready();
+        else if (!m_dependents.is_empty())
+            dbgln("{} has failed, so the services that depend on it won't be started", name());
+        return;
+    }
+
     if (!m_keep_alive)
         return;
 
@@ -317,6 +483,10 @@ Service::Service(const Core::ConfigFile& config, StringView name)
     m_system_modes = config.read_entry(name, "SystemModes", "graphical").split(',');
     m_multi_instance = config.read_bool_entry(name, "MultiInstance");
     m_accept_socket_connections = config.read_bool_entry(name, "AcceptSocketConnections");
+    m_prewarmed_instance_count = config.read_num_entry(name, "PrewarmedInstances");
+    m_oneshot = config.read_bool_entry(name, "Oneshot");
+    for (auto& dependency_name : config.read_entry(name, "Dependencies", "").split(','))
+        m_dependency_names.append(dependency_name.trim_whitespace());
 
     String socket_entry = config.read_entry(name, "Socket");
     String socket_permissions_entry = config.read_entry(name, "SocketPermissions", "0600");
@@ -348,6 +518,10 @@ Service::Service(const Core::ConfigFile& config, StringView name)
     VERIFY(!m_accept_socket_connections || (m_sockets.size() == 1 && m_lazy && m_multi_instance));
     // MultiInstance doesn't work with KeepAlive.
     VERIFY(!m_multi_instance || !m_keep_alive);
+    // PrewarmedInstances requires AcceptSocketConnections.
+    VERIFY(m_prewarmed_instance_count == 0 || m_accept_socket_connections);
+    // Oneshot doesn't work with Lazy, KeepAlive or MultiInstance.
+    VERIFY(!m_oneshot || (!m_lazy && !m_keep_alive && !m_multi_instance));
 
     if (is_enabled())
         setup_sockets();
@@ -393,6 +567,9 @@ void Service::save_to(JsonObject& json)
     json.set("user", m_user);
     json.set("multi_instance", m_multi_instance);
     json.set("accept_socket_connections", m_accept_socket_connections);
+    json.set("prewarmed_instance_count", m_prewarmed_instance_count);
+    json.set("oneshot", m_oneshot);
+    json.set("is_ready", m_is_ready);
 
     if (m_pid > 0)
         json.set("pid", m_pid);
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/NonnullRefPtrVector.h>
 #include <AK/RefPtr.h>
 #include <AK/String.h>
 #include <LibCore/Account.h>
@@ -18,8 +19,14 @@ class Service final : public Core::Object {
 
 public:
     bool is_enabled() const;
+
+    // Links the services to the ones they depend on. Dependencies on services that aren't enabled are ignored, and so
+    // are ones that would make a cycle.
+    static void resolve_dependencies(NonnullRefPtrVector<Service>&);
+
+    // Starts the service, once all the services it depends on are ready.
     void activate();
-    void did_exit(int exit_code);
+    void did_exit(pid_t, int exit_code);
 
     static Service* find_by_pid(pid_t);
 
@@ -29,7 +36,11 @@ public:
 private:
     Service(const Core::ConfigFile&, StringView name);
 
-    void spawn(int socket_fd = -1);
+    enum class SpawnMode {
+        Normal,
+        Prewarmed,
+    };
+    pid_t spawn(int socket_fd = -1, SpawnMode = SpawnMode::Normal);
 
     /// SocketDescriptor describes the details of a single socket that was
     /// requested by a service.
@@ -57,6 +68,9 @@ private:
     bool m_accept_socket_connections { false };
     // Whether we should only spawn this service once somebody connects to the socket.
     bool m_lazy;
+    // How many instances to keep running ahead of time for services that accept socket connections. Each one waits
+    // to be handed a client, so that clients don't have to wait for the service to start up.
+    int m_prewarmed_instance_count { 0 };
     // The name of the user we should run this service as.
     String m_user;
     // The working directory in which to spawn the service.
@@ -65,6 +79,11 @@ private:
     Vector<String> m_system_modes;
     // Whether several instances of this service can run at once.
     bool m_multi_instance { false };
+    // Whether this is a task that is done once it exits, rather than something that keeps running. Services that
+    // depend on it wait for it to exit successfully.
+    bool m_oneshot { false };
+    // Names of the services that have to be ready before this one is started.
+    Vector<String> m_dependency_names;
     // Environment variables to pass to the service.
     Vector<String> m_environment;
     // Socket descriptors for this service.
@@ -77,8 +96,25 @@ private:
     pid_t m_pid { -1 };
     RefPtr<Core::Notifier> m_socket_notifier;
 
+    struct PrewarmedInstance {
+        pid_t pid { -1 };
+        // Our end of a socket pair, over which the instance gets the accepted socket.
+        int handoff_fd { -1 };
+    };
+    Vector<PrewarmedInstance> m_prewarmed_instances;
+
     // Timer since we last spawned the service.
     Core::ElapsedTimer m_run_timer;
+
+    Vector<Service&> m_dependencies;
+    Vector<Service&> m_dependents;
+    bool m_is_waiting_for_dependencies { false };
+    // A service is ready once clients can use it, which is as soon as its sockets are listening. For services without
+    // sockets, it's once they've been spawned, or once they've exited successfully if they're oneshot.
+    bool m_is_ready { false };
+    // Milliseconds since SystemServer started, for the boot timing log.
+    int m_activation_time { -1 };
+    int m_spawn_time { -1 };
     // How many times we have tried to restart this service, only counting those
     // times where it has exited unsuccessfully and too quickly.
     int m_restart_attempts { 0 };
@@ -87,4 +123,8 @@ private:
     void setup_sockets();
     void setup_notifier();
     void handle_socket_connection();
+    void spawn_prewarmed_instances();
+    bool hand_off_to_prewarmed_instance(int accepted_fd);
+    bool has_all_dependencies_ready() const;
+    void did_become_ready();
 };
@@ -50,7 +50,7 @@ static void sigchld_handler(int)
             continue;
         }
 
-        service->did_exit(status);
+        service->did_exit(pid, status);
     }
 }
 
@@ -433,6 +433,8 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     Core::EventLoop event_loop;
 
     event_loop.register_signal(SIGCHLD, sigchld_handler);
+    // Handing a client to a prewarmed instance that has just died must not take us down.
+    signal(SIGPIPE, SIG_IGN);
 
     // Read our config and instantiate services.
     // This takes care of setting up sockets.
@@ -446,6 +448,8 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
             services.append(service);
     }
 
+    Service::resolve_dependencies(services);
+
     // After we've set them all up, activate them!
     dbgln("Activating {} services...", services.size());
     for (auto& service : services)
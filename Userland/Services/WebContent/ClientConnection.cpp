@@ -34,6 +34,9 @@ ClientConnection::ClientConnection(NonnullRefPtr<Core::LocalSocket> socket)
     , m_page_host(PageHost::create(*this))
 {
     m_paint_flush_timer = Core::Timer::create_single_shot(0, [this] { flush_pending_paint_requests(); });
+
+    if (auto result = enable_shared_ring_transport(); result.is_error())
+        dbgln("WebContent: Using the socket to talk to the client: {}", result.error());
 }
 
 ClientConnection::~ClientConnection()
@@ -107,6 +110,8 @@ void ClientConnection::add_backing_store(i32 backing_store_id, const Gfx::Sharea
 
 void ClientConnection::remove_backing_store(i32 backing_store_id)
 {
+    if (auto it = m_backing_stores.find(backing_store_id); it != m_backing_stores.end())
+        m_page_host->forget_backing_store(*it->value);
     m_backing_stores.remove(backing_store_id);
 }
 
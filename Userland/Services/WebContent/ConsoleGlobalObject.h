@@ -34,6 +34,7 @@ public:
     virtual JS::ThrowCompletionOr<bool> internal_set(JS::PropertyKey const&, JS::Value value, JS::Value receiver) override;
     virtual JS::ThrowCompletionOr<bool> internal_delete(JS::PropertyKey const& name) override;
     virtual JS::ThrowCompletionOr<JS::MarkedValueList> internal_own_property_keys() const override;
+    virtual bool may_cache_property_lookups() const override { return false; }
 
     virtual void initialize_global_object() override;
 
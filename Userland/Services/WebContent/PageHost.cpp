@@ -51,11 +51,19 @@ Gfx::Palette PageHost::palette() const
 void PageHost::set_palette_impl(const Gfx::PaletteImpl& impl)
 {
     m_palette_impl = impl;
+    invalidate_backing_stores();
+}
+
+void PageHost::set_should_show_line_box_borders(bool b)
+{
+    m_should_show_line_box_borders = b;
+    invalidate_backing_stores();
 }
 
 void PageHost::set_preferred_color_scheme(Web::CSS::PreferredColorScheme color_scheme)
 {
     m_preferred_color_scheme = color_scheme;
+    invalidate_backing_stores();
     if (auto* document = page().top_level_browsing_context().active_document())
         document->invalidate_style();
 }
@@ -68,9 +76,35 @@ Web::Layout::InitialContainingBlock* PageHost::layout_root()
     return document->layout_node();
 }
 
+// Moves the pixels of the bitmap by the given (physical) delta, leaving the uncovered parts as they were.
+static void move_bitmap_contents(Gfx::Bitmap& bitmap, Gfx::IntPoint const& delta)
+{
+    auto width = bitmap.physical_width();
+    auto height = bitmap.physical_height();
+    auto columns = width - abs(delta.x());
+    auto rows = height - abs(delta.y());
+    if (columns <= 0 || rows <= 0)
+        return;
+
+    auto source_x = max(0, -delta.x());
+    auto destination_x = max(0, delta.x());
+    auto copy_row = [&](int row) {
+        auto source_y = delta.y() < 0 ? row - delta.y() : row;
+        auto destination_y = delta.y() < 0 ? row : row + delta.y();
+        __builtin_memmove(bitmap.scanline(destination_y) + destination_x, bitmap.scanline(source_y) + source_x, columns * sizeof(Gfx::RGBA32));
+    };
+    // Copy in the direction that never overwrites rows we have yet to read.
+    if (delta.y() > 0) {
+        for (int row = rows - 1; row >= 0; --row)
+            copy_row(row);
+    } else {
+        for (int row = 0; row < rows; ++row)
+            copy_row(row);
+    }
+}
+
 void PageHost::paint(const Gfx::IntRect& content_rect, Gfx::Bitmap& target)
 {
-    Gfx::Painter painter(target);
     Gfx::IntRect bitmap_rect { {}, content_rect.size() };
 
     if (auto* document = page().top_level_browsing_context().active_document())
@@ -78,14 +112,56 @@ void PageHost::paint(const Gfx::IntRect& content_rect, Gfx::Bitmap& target)
 
     auto* layout_root = this->layout_root();
     if (!layout_root) {
+        forget_backing_store(target);
+        Gfx::Painter painter(target);
         painter.fill_rect(bitmap_rect, Color::White);
         return;
     }
 
-    Web::PaintContext context(painter, palette(), content_rect.top_left());
-    context.set_should_show_line_box_borders(m_should_show_line_box_borders);
-    context.set_viewport_rect(content_rect);
-    layout_root->paint_all_phases(context);
+    // If the backing store already shows some of the same content, we only need to move it into place and
+    // repaint whatever was invalidated since, and whatever scrolled into view.
+    Gfx::DisjointRectSet rects_to_paint;
+    auto& state = m_backing_store_states.ensure(&target);
+    auto const& previous_content_rect = state.content_rect;
+    if (previous_content_rect.size() == content_rect.size() && previous_content_rect.intersects(content_rect)
+        && (previous_content_rect.location() == content_rect.location() || !m_has_fixed_position_content)) {
+        auto delta = previous_content_rect.location() - content_rect.location();
+        if (!delta.is_null())
+            move_bitmap_contents(target, delta.scaled(target.scale(), target.scale()));
+        rects_to_paint.add_many(content_rect.shatter(previous_content_rect));
+        state.invalidated_rects.for_each_intersected(content_rect, [&](auto& rect) {
+            rects_to_paint.add(rect);
+            return IterationDecision::Continue;
+        });
+    } else {
+        rects_to_paint.add(content_rect);
+    }
+    state = { content_rect, {} };
+
+    // Every paint walks the whole layout tree, so don't let badly fragmented invalidations get out of hand.
+    static constexpr size_t max_rects_to_paint = 8;
+    if (rects_to_paint.size() > max_rects_to_paint) {
+        Gfx::IntRect bounding_rect;
+        for (auto& rect : rects_to_paint.rects())
+            bounding_rect = bounding_rect.united(rect);
+        rects_to_paint.clear();
+        rects_to_paint.add(bounding_rect);
+    }
+
+    for (auto& rect : rects_to_paint.rects()) {
+        Gfx::Painter painter(target);
+        painter.add_clip_rect(rect.translated(-content_rect.location()));
+
+        Web::PaintContext context(painter, palette(), content_rect.top_left());
+        context.set_should_show_line_box_borders(m_should_show_line_box_borders);
+        context.set_viewport_rect(content_rect);
+        layout_root->paint_all_phases(context);
+    }
+}
+
+void PageHost::forget_backing_store(Gfx::Bitmap const& bitmap)
+{
+    m_backing_store_states.remove(&bitmap);
 }
 
 void PageHost::set_viewport_rect(const Gfx::IntRect& rect)
@@ -95,6 +171,9 @@ void PageHost::set_viewport_rect(const Gfx::IntRect& rect)
 
 void PageHost::page_did_invalidate(Gfx::IntRect const& content_rect)
 {
+    for (auto& it : m_backing_store_states)
+        it.value.invalidated_rects.add(content_rect);
+
     m_invalidation_rect = m_invalidation_rect.united(content_rect);
     if (!m_invalidation_coalescing_timer->is_active())
         m_invalidation_coalescing_timer->start();
@@ -114,6 +193,19 @@ void PageHost::page_did_layout()
 {
     auto* layout_root = this->layout_root();
     VERIFY(layout_root);
+
+    // Boxes may have moved anywhere, so none of what we painted before can be reused.
+    invalidate_backing_stores();
+
+    // Fixed position boxes don't move along with the rest of the content when scrolling.
+    m_has_fixed_position_content = false;
+    layout_root->for_each_in_inclusive_subtree_of_type<Web::Layout::Box>([&](auto& box) {
+        if (!box.is_fixed_position())
+            return IterationDecision::Continue;
+        m_has_fixed_position_content = true;
+        return IterationDecision::Break;
+    });
+
     Gfx::IntSize content_size;
     if (layout_root->has_overflow())
         content_size = enclosing_int_rect(layout_root->scrollable_overflow_rect().value()).size();
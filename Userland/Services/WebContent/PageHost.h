@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include <AK/HashMap.h>
+#include <LibGfx/DisjointRectSet.h>
 #include <LibGfx/Rect.h>
 #include <LibWeb/Page/Page.h>
 
@@ -25,13 +27,14 @@ public:
     const Web::Page& page() const { return *m_page; }
 
     void paint(const Gfx::IntRect& content_rect, Gfx::Bitmap&);
+    void forget_backing_store(Gfx::Bitmap const&);
 
     void set_palette_impl(const Gfx::PaletteImpl&);
     void set_viewport_rect(const Gfx::IntRect&);
     void set_screen_rects(const Vector<Gfx::IntRect, 4>& rects, size_t main_screen_index) { m_screen_rect = rects[main_screen_index]; };
     void set_preferred_color_scheme(Web::CSS::PreferredColorScheme);
 
-    void set_should_show_line_box_borders(bool b) { m_should_show_line_box_borders = b; }
+    void set_should_show_line_box_borders(bool);
 
 private:
     // ^PageClient
@@ -69,6 +72,14 @@ private:
     Web::Layout::InitialContainingBlock* layout_root();
     void setup_palette();
 
+    // What we last painted into a backing store, and which parts of it have been invalidated since.
+    // This lets us repaint only the invalidated and newly exposed parts of a backing store.
+    struct BackingStoreState {
+        Gfx::IntRect content_rect;
+        Gfx::DisjointRectSet invalidated_rects;
+    };
+    void invalidate_backing_stores() { m_backing_store_states.clear(); }
+
     ClientConnection& m_client;
     NonnullOwnPtr<Web::Page> m_page;
     RefPtr<Gfx::PaletteImpl> m_palette_impl;
@@ -77,6 +88,9 @@ private:
 
     RefPtr<Core::Timer> m_invalidation_coalescing_timer;
     Gfx::IntRect m_invalidation_rect;
+
+    HashMap<Gfx::Bitmap const*, BackingStoreState> m_backing_store_states;
+    bool m_has_fixed_position_content { false };
     Web::CSS::PreferredColorScheme m_preferred_color_scheme { Web::CSS::PreferredColorScheme::Auto };
 };
 
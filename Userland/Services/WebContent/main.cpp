@@ -7,10 +7,23 @@
 #include <LibCore/EventLoop.h>
 #include <LibCore/LocalServer.h>
 #include <LibCore/System.h>
+#include <LibGfx/FontDatabase.h>
 #include <LibIPC/SingleServer.h>
 #include <LibMain/Main.h>
+#include <LibWeb/Bindings/MainThreadVM.h>
+#include <LibWeb/CSS/StyleComputer.h>
 #include <WebContent/ClientConnection.h>
 
+// Every page needs these, and they take a while to set up. When SystemServer starts us ahead of time, this happens
+// before there's a client, so that it can get to its first paint right away.
+static void prepare_for_first_page()
+{
+    (void)Gfx::FontDatabase::default_font();
+    (void)Gfx::FontDatabase::default_fixed_width_font();
+    Web::CSS::StyleComputer::load_user_agent_style_sheets();
+    (void)Web::Bindings::main_thread_vm();
+}
+
 ErrorOr<int> serenity_main(Main::Arguments)
 {
     Core::EventLoop event_loop;
@@ -21,6 +34,8 @@ ErrorOr<int> serenity_main(Main::Arguments)
     TRY(Core::System::unveil("/tmp/portal/websocket", "rw"));
     TRY(Core::System::unveil(nullptr, nullptr));
 
+    prepare_for_first_page();
+
     auto client = TRY(IPC::take_over_accepted_client_from_system_server<WebContent::ClientConnection>());
     return event_loop.exec();
 }
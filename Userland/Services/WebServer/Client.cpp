@@ -8,95 +8,172 @@
 #include <AK/Base64.h>
 #include <AK/Debug.h>
 #include <AK/LexicalPath.h>
-#include <AK/MemoryStream.h>
+#include <AK/MemMem.h>
 #include <AK/QuickSort.h>
 #include <AK/StringBuilder.h>
 #include <AK/URL.h>
 #include <LibCore/DateTime.h>
 #include <LibCore/DirIterator.h>
 #include <LibCore/File.h>
-#include <LibCore/FileStream.h>
 #include <LibCore/MappedFile.h>
 #include <LibCore/MimeData.h>
+#include <LibCore/System.h>
 #include <LibHTTP/HttpRequest.h>
 #include <LibHTTP/HttpResponse.h>
 #include <WebServer/Client.h>
 #include <WebServer/Configuration.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
 #include <stdio.h>
+#include <sys/sendfile.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
 namespace WebServer {
 
-Client::Client(Core::Stream::BufferedTCPSocket socket, Core::Object* parent)
-    : Core::Object(parent)
-    , m_socket(move(socket))
+// A request header that doesn't fit in this is refused. Pipelined requests also stop being read once this much is
+// waiting to be answered.
+static constexpr size_t max_buffered_input_size = 64 * KiB;
+static constexpr size_t read_chunk_size = 4 * KiB;
+
+Client::Client(int fd)
+    : m_fd(fd)
+    , m_last_activity_time(Time::now_monotonic_coarse())
 {
 }
 
-void Client::die()
+Client::~Client()
 {
-    m_socket.close();
-    deferred_invoke([this] { remove_from_parent(); });
+    if (m_file_fd >= 0)
+        close(m_file_fd);
+    close(m_fd);
 }
 
-void Client::start()
+short Client::events() const
 {
-    m_socket.on_ready_to_read = [this] {
-        StringBuilder builder;
-
-        auto maybe_buffer = ByteBuffer::create_uninitialized(m_socket.buffer_size());
-        if (!maybe_buffer.has_value()) {
-            warnln("Could not create buffer for client (possibly out of memory)");
-            die();
-            return;
-        }
+    short events = 0;
+    if (!m_is_eof && m_input.size() < max_buffered_input_size)
+        events |= POLLIN;
+    if (has_pending_output())
+        events |= POLLOUT;
+    return events;
+}
+
+bool Client::handle_events(short revents)
+{
+    m_last_activity_time = Time::now_monotonic_coarse();
+
+    auto should_stay_open_or_error = [&]() -> ErrorOr<bool> {
+        if (revents & (POLLIN | POLLHUP | POLLERR))
+            TRY(read_from_socket());
 
-        auto buffer = maybe_buffer.release_value();
+        // Answer as many of the buffered requests as the socket takes without blocking.
         for (;;) {
-            auto maybe_can_read = m_socket.can_read_without_blocking();
-            if (maybe_can_read.is_error()) {
-                warnln("Failed to get the blocking status for the socket: {}", maybe_can_read.error());
-                die();
-                return;
-            }
-
-            if (!maybe_can_read.value())
+            if (!TRY(send_pending_output()))
+                return true;
+            if (m_should_close_after_response)
+                return false;
+            if (!TRY(handle_next_request()))
                 break;
+        }
+        return !m_is_eof;
+    }();
+
+    if (should_stay_open_or_error.is_error()) {
+        auto error = should_stay_open_or_error.release_error();
+        // The other end going away while we're still talking is business as usual.
+        if (!error.is_errno() || (error.code() != ECONNRESET && error.code() != EPIPE))
+            warnln("Failed to handle the client: {}", error);
+        return false;
+    }
+    return should_stay_open_or_error.value();
+}
 
-            auto maybe_nread = m_socket.read_until_any_of(buffer, Array { "\r"sv, "\n"sv, "\r\n"sv });
-            if (maybe_nread.is_error()) {
-                warnln("Failed to read a line from the request: {}", maybe_nread.error());
-                die();
-                return;
-            }
-
-            if (m_socket.is_eof()) {
-                die();
+ErrorOr<void> Client::read_from_socket()
+{
+    while (!m_is_eof && m_input.size() < max_buffered_input_size) {
+        auto old_size = m_input.size();
+        TRY(m_input.try_resize(old_size + read_chunk_size));
+        auto nread_or_error = Core::System::read(m_fd, m_input.bytes().slice(old_size));
+        m_input.resize(old_size + (nread_or_error.is_error() ? 0 : nread_or_error.value()));
+        if (nread_or_error.is_error()) {
+            if (nread_or_error.error().code() == EAGAIN)
                 break;
-            }
+            return nread_or_error.release_error();
+        }
+        if (nread_or_error.value() == 0)
+            m_is_eof = true;
+    }
+    return {};
+}
 
-            builder.append(StringView { buffer.data(), maybe_nread.value() });
-            builder.append("\r\n");
+ErrorOr<bool> Client::send_pending_output()
+{
+    while (m_output_offset < m_output.size()) {
+        auto nwritten_or_error = Core::System::write(m_fd, m_output.bytes().slice(m_output_offset));
+        if (nwritten_or_error.is_error()) {
+            if (nwritten_or_error.error().code() == EAGAIN)
+                return false;
+            return nwritten_or_error.release_error();
+        }
+        m_output_offset += nwritten_or_error.value();
+    }
+    m_output.clear();
+    m_output_offset = 0;
+
+    // Let the kernel move the file contents straight to the socket.
+    while (m_file_fd >= 0 && m_file_offset < m_file_end) {
+        auto nsent = ::sendfile(m_fd, m_file_fd, &m_file_offset, m_file_end - m_file_offset);
+        if (nsent < 0) {
+            if (errno == EAGAIN)
+                return false;
+            return Error::from_errno(errno);
         }
+        // The file got shorter since we looked at it. There's no way to tell the client other than hanging up.
+        if (nsent == 0)
+            return Error::from_string_literal("File was truncated while it was being sent"sv);
+    }
+    if (m_file_fd >= 0) {
+        close(m_file_fd);
+        m_file_fd = -1;
+    }
+    return true;
+}
 
-        auto request = builder.to_byte_buffer();
-        dbgln_if(WEBSERVER_DEBUG, "Got raw request: '{}'", String::copy(request));
+ErrorOr<bool> Client::handle_next_request()
+{
+    // Clients may send empty lines between pipelined requests, see RFC 7230 section 3.5.
+    size_t start = 0;
+    while (start + 1 < m_input.size() && m_input[start] == '\r' && m_input[start + 1] == '\n')
+        start += 2;
+
+    auto header_end = AK::memmem_optional(m_input.data() + start, m_input.size() - start, "\r\n\r\n", 4);
+    if (!header_end.has_value()) {
+        if (m_input.size() < max_buffered_input_size)
+            return false;
+        m_should_close_after_response = true;
+        send_error_response(400, {});
+        return true;
+    }
 
-        auto maybe_did_handle = handle_request(request);
-        if (maybe_did_handle.is_error()) {
-            warnln("Failed to handle the request: {}", maybe_did_handle.error());
-        }
+    auto request_size = start + header_end.value() + 4;
+    dbgln_if(WEBSERVER_DEBUG, "Got raw request: '{}'", StringView { m_input.bytes().slice(start, request_size - start) });
+    TRY(handle_request(m_input.bytes().slice(start, request_size - start)));
 
-        die();
-    };
+    memmove(m_input.data(), m_input.data() + request_size, m_input.size() - request_size);
+    m_input.resize(m_input.size() - request_size);
+    return true;
 }
 
-ErrorOr<bool> Client::handle_request(ReadonlyBytes raw_request)
+ErrorOr<void> Client::handle_request(ReadonlyBytes raw_request)
 {
     auto request_or_error = HTTP::HttpRequest::from_raw_request(raw_request);
-    if (!request_or_error.has_value())
-        return false;
+    if (!request_or_error.has_value()) {
+        m_should_close_after_response = true;
+        send_error_response(400, {});
+        return {};
+    }
     auto& request = request_or_error.value();
 
     if constexpr (WEBSERVER_DEBUG) {
@@ -106,17 +183,37 @@ ErrorOr<bool> Client::handle_request(ReadonlyBytes raw_request)
         }
     }
 
-    if (request.method() != HTTP::HttpRequest::Method::GET) {
-        TRY(send_error_response(501, request));
-        return false;
+    Optional<StringView> connection;
+    bool has_body = false;
+    for (auto& header : request.headers()) {
+        if (header.name.equals_ignoring_case("Connection"))
+            connection = header.value.view();
+        else if (header.name.equals_ignoring_case("Content-Length"))
+            has_body = header.value.to_uint<u64>().value_or(1) != 0;
+        else if (header.name.equals_ignoring_case("Transfer-Encoding"))
+            has_body = true;
+    }
+    // HTTP/1.1 connections stay open unless the client says otherwise, HTTP/1.0 ones only if it asks for it.
+    if (request.version() == HTTP::HttpRequest::Version::HTTP_1_1)
+        m_should_close_after_response = connection.has_value() && connection->contains("close"sv, CaseSensitivity::CaseInsensitive);
+    else
+        m_should_close_after_response = !connection.has_value() || !connection->contains("keep-alive"sv, CaseSensitivity::CaseInsensitive);
+    // We never read request bodies, so we wouldn't know where the next request starts.
+    if (has_body)
+        m_should_close_after_response = true;
+
+    if (request.method() != HTTP::HttpRequest::Method::GET && request.method() != HTTP::HttpRequest::Method::HEAD) {
+        m_should_close_after_response = true;
+        send_error_response(501, request);
+        return {};
     }
 
     // Check for credentials if they are required
     if (Configuration::the().credentials().has_value()) {
         bool has_authenticated = verify_credentials(request.headers());
         if (!has_authenticated) {
-            TRY(send_error_response(401, request, { "WWW-Authenticate: Basic realm=\"WebServer\", charset=\"UTF-8\"" }));
-            return false;
+            send_error_response(401, request, { "WWW-Authenticate: Basic realm=\"WebServer\", charset=\"UTF-8\"" });
+            return {};
         }
     }
 
@@ -136,8 +233,8 @@ ErrorOr<bool> Client::handle_request(ReadonlyBytes raw_request)
             red.append(requested_path);
             red.append("/");
 
-            TRY(send_redirect(red.to_string(), request));
-            return true;
+            send_redirect(red.to_string(), request);
+            return {};
         }
 
         StringBuilder index_html_path_builder;
@@ -145,104 +242,186 @@ ErrorOr<bool> Client::handle_request(ReadonlyBytes raw_request)
         index_html_path_builder.append("/index.html");
         auto index_html_path = index_html_path_builder.to_string();
         if (!Core::File::exists(index_html_path)) {
-            TRY(handle_directory_listing(requested_path, real_path, request));
-            return true;
+            handle_directory_listing(requested_path, real_path, request);
+            return {};
         }
         real_path = index_html_path;
     }
 
-    auto file = Core::File::construct(real_path);
-    if (!file->open(Core::OpenMode::ReadOnly)) {
-        TRY(send_error_response(404, request));
-        return false;
+    auto fd_or_error = Core::System::open(real_path, O_RDONLY | O_CLOEXEC);
+    if (fd_or_error.is_error()) {
+        send_error_response(404, request);
+        return {};
     }
+    auto fd = fd_or_error.release_value();
 
-    if (file->is_device()) {
-        TRY(send_error_response(403, request));
-        return false;
+    auto stat_or_error = Core::System::fstat(fd);
+    if (stat_or_error.is_error()) {
+        close(fd);
+        return stat_or_error.release_error();
+    }
+    if (!S_ISREG(stat_or_error.value().st_mode)) {
+        close(fd);
+        send_error_response(403, request);
+        return {};
     }
 
-    Core::InputFileStream stream { file };
-
-    TRY(send_response(stream, request, Core::guess_mime_type_based_on_filename(real_path)));
-    return true;
+    send_file_response(fd, stat_or_error.value().st_size, request, Core::guess_mime_type_based_on_filename(real_path));
+    return {};
 }
 
-ErrorOr<void> Client::send_response(InputStream& response, HTTP::HttpRequest const& request, String const& content_type)
+void Client::send_response_header(unsigned code, HTTP::HttpRequest const& request, StringView content_type, off_t content_length, Vector<String> const& headers)
 {
     StringBuilder builder;
-    builder.append("HTTP/1.0 200 OK\r\n");
+    builder.appendff("HTTP/1.1 {} ", code);
+    builder.append(HTTP::HttpResponse::reason_phrase_for_code(code));
+    builder.append("\r\n");
     builder.append("Server: WebServer (SerenityOS)\r\n");
     builder.append("X-Frame-Options: SAMEORIGIN\r\n");
     builder.append("X-Content-Type-Options: nosniff\r\n");
     builder.append("Pragma: no-cache\r\n");
-    builder.append("Content-Type: ");
-    builder.append(content_type);
-    builder.append("\r\n");
+    for (auto& header : headers) {
+        builder.append(header);
+        builder.append("\r\n");
+    }
+    if (!content_type.is_empty()) {
+        builder.append("Content-Type: ");
+        builder.append(content_type);
+        builder.append("\r\n");
+    }
+    builder.appendff("Content-Length: {}\r\n", content_length);
+    if (m_should_close_after_response)
+        builder.append("Connection: close\r\n");
+    else if (request.version() == HTTP::HttpRequest::Version::HTTP_1_0)
+        builder.append("Connection: keep-alive\r\n");
     builder.append("\r\n");
 
-    auto builder_contents = builder.to_byte_buffer();
-    TRY(m_socket.write(builder_contents));
-    log_response(200, request);
+    m_output.append(builder.string_view().bytes());
+    log_response(code, request);
+}
 
-    char buffer[PAGE_SIZE];
-    do {
-        auto size = response.read({ buffer, sizeof(buffer) });
-        if (response.unreliable_eof() && size == 0)
-            break;
+void Client::send_response(ReadonlyBytes response, HTTP::HttpRequest const& request, StringView content_type)
+{
+    send_response_header(200, request, content_type, response.size());
+    if (request.method() != HTTP::HttpRequest::Method::HEAD)
+        m_output.append(response);
+}
 
-        ReadonlyBytes write_buffer { buffer, size };
-        while (!write_buffer.is_empty()) {
-            auto nwritten = TRY(m_socket.write(write_buffer));
+struct ByteRangeRequest {
+    enum class Type {
+        WholeFile,
+        Satisfiable,
+        Unsatisfiable,
+    };
+    Type type { Type::WholeFile };
+    off_t start { 0 };
+    off_t end { 0 };
+};
+
+// Only a single range is supported, which is what clients resuming a download or seeking in a video ask for. Several
+// ranges would need a multipart/byteranges response, so those get the whole file instead, see RFC 7233 section 3.1.
+static ByteRangeRequest parse_byte_range(StringView value, off_t file_size)
+{
+    if (!value.starts_with("bytes="sv, CaseSensitivity::CaseInsensitive))
+        return {};
+    auto range = value.substring_view(6).trim_whitespace();
+    if (range.contains(','))
+        return {};
+    auto dash = range.find('-');
+    if (!dash.has_value())
+        return {};
+    auto first = range.substring_view(0, dash.value()).trim_whitespace();
+    auto last = range.substring_view(dash.value() + 1).trim_whitespace();
+
+    if (first.is_empty()) {
+        // A suffix range, the last N bytes of the file.
+        auto suffix_length = last.to_uint<u64>();
+        if (!suffix_length.has_value())
+            return {};
+        if (suffix_length.value() == 0 || file_size == 0)
+            return { ByteRangeRequest::Type::Unsatisfiable };
+        auto length = min<u64>(suffix_length.value(), file_size);
+        return { ByteRangeRequest::Type::Satisfiable, static_cast<off_t>(file_size - length), file_size };
+    }
 
-            if (nwritten == 0) {
-                dbgln("EEEEEE got 0 bytes written!");
-            }
+    auto first_byte = first.to_uint<u64>();
+    if (!first_byte.has_value())
+        return {};
+    u64 end = file_size;
+    if (!last.is_empty()) {
+        auto last_byte = last.to_uint<u64>();
+        if (!last_byte.has_value() || last_byte.value() < first_byte.value())
+            return {};
+        end = min<u64>(last_byte.value() + 1, file_size);
+    }
+    if (first_byte.value() >= static_cast<u64>(file_size))
+        return { ByteRangeRequest::Type::Unsatisfiable };
+    return { ByteRangeRequest::Type::Satisfiable, static_cast<off_t>(first_byte.value()), static_cast<off_t>(end) };
+}
 
-            write_buffer = write_buffer.slice(nwritten);
+void Client::send_file_response(int fd, off_t file_size, HTTP::HttpRequest const& request, StringView content_type)
+{
+    ByteRangeRequest range;
+    for (auto& header : request.headers()) {
+        if (header.name.equals_ignoring_case("Range")) {
+            range = parse_byte_range(header.value, file_size);
+        } else if (header.name.equals_ignoring_case("If-Range")) {
+            // We have no validators to compare against, so the file may have changed. Play it safe.
+            range = {};
+            break;
         }
-    } while (true);
+    }
 
-    return {};
-}
+    if (range.type == ByteRangeRequest::Type::Unsatisfiable) {
+        close(fd);
+        send_error_response(416, request, { String::formatted("Content-Range: bytes */{}", file_size) });
+        return;
+    }
 
-ErrorOr<void> Client::send_redirect(StringView redirect_path, HTTP::HttpRequest const& request)
-{
-    StringBuilder builder;
-    builder.append("HTTP/1.0 301 Moved Permanently\r\n");
-    builder.append("Location: ");
-    builder.append(redirect_path);
-    builder.append("\r\n");
-    builder.append("\r\n");
+    if (range.type == ByteRangeRequest::Type::Satisfiable) {
+        send_response_header(206, request, content_type, range.end - range.start,
+            { "Accept-Ranges: bytes", String::formatted("Content-Range: bytes {}-{}/{}", range.start, range.end - 1, file_size) });
+    } else {
+        range.start = 0;
+        range.end = file_size;
+        send_response_header(200, request, content_type, file_size, { "Accept-Ranges: bytes" });
+    }
 
-    auto builder_contents = builder.to_byte_buffer();
-    TRY(m_socket.write(builder_contents));
+    if (request.method() == HTTP::HttpRequest::Method::HEAD || range.start == range.end) {
+        close(fd);
+        return;
+    }
+    VERIFY(m_file_fd < 0);
+    m_file_fd = fd;
+    m_file_offset = range.start;
+    m_file_end = range.end;
+}
 
-    log_response(301, request);
-    return {};
+void Client::send_redirect(StringView redirect_path, HTTP::HttpRequest const& request)
+{
+    send_response_header(301, request, {}, 0, { String::formatted("Location: {}", redirect_path) });
 }
 
 static String folder_image_data()
 {
-    static String cache;
-    if (cache.is_empty()) {
+    // NOTE: Workers run on several threads, and the initialization of a static local is thread-safe.
+    static String cache = [] {
         auto file = Core::MappedFile::map("/res/icons/16x16/filetype-folder.png").release_value_but_fixme_should_propagate_errors();
-        cache = encode_base64(file->bytes());
-    }
+        return encode_base64(file->bytes());
+    }();
     return cache;
 }
 
 static String file_image_data()
 {
-    static String cache;
-    if (cache.is_empty()) {
+    static String cache = [] {
         auto file = Core::MappedFile::map("/res/icons/16x16/filetype-unknown.png").release_value_but_fixme_should_propagate_errors();
-        cache = encode_base64(file->bytes());
-    }
+        return encode_base64(file->bytes());
+    }();
     return cache;
 }
 
-ErrorOr<void> Client::handle_directory_listing(String const& requested_path, String const& real_path, HTTP::HttpRequest const& request)
+void Client::handle_directory_listing(String const& requested_path, String const& real_path, HTTP::HttpRequest const& request)
 {
     StringBuilder builder;
 
@@ -315,36 +494,21 @@ ErrorOr<void> Client::handle_directory_listing(String const& requested_path, Str
     builder.append("</body>\n");
     builder.append("</html>\n");
 
-    auto response = builder.to_string();
-    InputMemoryStream stream { response.bytes() };
-    return send_response(stream, request, "text/html");
+    send_response(builder.string_view().bytes(), request, "text/html");
 }
 
-ErrorOr<void> Client::send_error_response(unsigned code, HTTP::HttpRequest const& request, Vector<String> const& headers)
+void Client::send_error_response(unsigned code, HTTP::HttpRequest const& request, Vector<String> const& headers)
 {
     auto reason_phrase = HTTP::HttpResponse::reason_phrase_for_code(code);
     StringBuilder builder;
-    builder.appendff("HTTP/1.0 {} ", code);
-    builder.append(reason_phrase);
-    builder.append("\r\n");
-
-    for (auto& header : headers) {
-        builder.append(header);
-        builder.append("\r\n");
-    }
-    builder.append("Content-Type: text/html; charset=UTF-8\r\n");
-
-    builder.append("\r\n");
     builder.append("<!DOCTYPE html><html><body><h1>");
     builder.appendff("{} ", code);
     builder.append(reason_phrase);
     builder.append("</h1></body></html>");
 
-    auto builder_contents = builder.to_byte_buffer();
-    TRY(m_socket.write(builder_contents));
-
-    log_response(code, request);
-    return {};
+    send_response_header(code, request, "text/html; charset=UTF-8", builder.length(), headers);
+    if (request.method() != HTTP::HttpRequest::Method::HEAD)
+        m_output.append(builder.string_view().bytes());
 }
 
 void Client::log_response(unsigned code, HTTP::HttpRequest const& request)
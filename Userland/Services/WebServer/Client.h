@@ -6,32 +6,63 @@
 
 #pragma once
 
-#include <LibCore/Object.h>
-#include <LibCore/Stream.h>
+#include <AK/ByteBuffer.h>
+#include <AK/Noncopyable.h>
+#include <AK/Time.h>
 #include <LibHTTP/Forward.h>
 #include <LibHTTP/HttpRequest.h>
 
 namespace WebServer {
 
-class Client final : public Core::Object {
-    C_OBJECT(Client);
+// One connection, driven by the Worker that accepted it. Requests are answered one at a time and in order, so any
+// pipelined requests wait in the input buffer until the response before them has been sent.
+class Client {
+    AK_MAKE_NONCOPYABLE(Client);
+    AK_MAKE_NONMOVABLE(Client);
 
 public:
-    void start();
+    explicit Client(int fd);
+    ~Client();
+
+    int fd() const { return m_fd; }
+
+    // What to poll the socket for.
+    short events() const;
+    // Returns false once the connection should be closed.
+    bool handle_events(short revents);
+
+    Time last_activity_time() const { return m_last_activity_time; }
 
 private:
-    Client(Core::Stream::BufferedTCPSocket, Core::Object* parent);
+    ErrorOr<void> read_from_socket();
+    ErrorOr<bool> send_pending_output();
+    bool has_pending_output() const { return m_output_offset < m_output.size() || m_file_fd >= 0; }
+    ErrorOr<bool> handle_next_request();
 
-    ErrorOr<bool> handle_request(ReadonlyBytes);
-    ErrorOr<void> send_response(InputStream&, HTTP::HttpRequest const&, String const& content_type);
-    ErrorOr<void> send_redirect(StringView redirect, HTTP::HttpRequest const&);
-    ErrorOr<void> send_error_response(unsigned code, HTTP::HttpRequest const&, Vector<String> const& headers = {});
-    void die();
+    ErrorOr<void> handle_request(ReadonlyBytes);
+    void send_response_header(unsigned code, HTTP::HttpRequest const&, StringView content_type, off_t content_length, Vector<String> const& headers = {});
+    void send_response(ReadonlyBytes, HTTP::HttpRequest const&, StringView content_type);
+    void send_file_response(int fd, off_t file_size, HTTP::HttpRequest const&, StringView content_type);
+    void send_redirect(StringView redirect, HTTP::HttpRequest const&);
+    void send_error_response(unsigned code, HTTP::HttpRequest const&, Vector<String> const& headers = {});
     void log_response(unsigned code, HTTP::HttpRequest const&);
-    ErrorOr<void> handle_directory_listing(String const& requested_path, String const& real_path, HTTP::HttpRequest const&);
+    void handle_directory_listing(String const& requested_path, String const& real_path, HTTP::HttpRequest const&);
     bool verify_credentials(Vector<HTTP::HttpRequest::Header> const&);
 
-    Core::Stream::BufferedTCPSocket m_socket;
+    int m_fd { -1 };
+    ByteBuffer m_input;
+    bool m_is_eof { false };
+    Time m_last_activity_time;
+
+    // The response header (or a response generated in memory), and how much of it has been sent.
+    ByteBuffer m_output;
+    size_t m_output_offset { 0 };
+    // The part of a file that still has to be sent after m_output, if any.
+    int m_file_fd { -1 };
+    off_t m_file_offset { 0 };
+    off_t m_file_end { 0 };
+
+    bool m_should_close_after_response { false };
 };
 
 }
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibCore/System.h>
+#include <WebServer/Worker.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/socket.h>
+
+namespace WebServer {
+
+// Connections that neither send nor take anything for this long are closed.
+static constexpr Time keep_alive_timeout = Time::from_seconds(15);
+static constexpr int idle_check_interval_ms = 1000;
+// Taking only a few connections at a time leaves the rest of a burst to the other workers.
+static constexpr size_t max_accepts_per_wakeup = 4;
+
+Worker::Worker(int listen_fd)
+    : m_listen_fd(listen_fd)
+{
+}
+
+ErrorOr<void> Worker::run()
+{
+    Vector<pollfd> poll_fds;
+    for (;;) {
+        poll_fds.clear_with_capacity();
+        poll_fds.append({ m_listen_fd, POLLIN, 0 });
+        for (auto& client : m_clients)
+            poll_fds.append({ client.fd(), client.events(), 0 });
+
+        auto rc = poll(poll_fds.data(), poll_fds.size(), m_clients.is_empty() ? -1 : idle_check_interval_ms);
+        if (rc < 0) {
+            if (errno == EINTR)
+                continue;
+            return Error::from_syscall("poll", -errno);
+        }
+
+        // Going backwards keeps the indices of the clients we haven't looked at yet in line with poll_fds.
+        for (size_t i = m_clients.size(); i-- > 0;) {
+            auto revents = poll_fds[i + 1].revents;
+            if (revents != 0 && !m_clients[i].handle_events(revents))
+                m_clients.remove(i);
+        }
+
+        auto idle_cutoff_time = Time::now_monotonic_coarse() - keep_alive_timeout;
+        m_clients.remove_all_matching([&](auto& client) { return client->last_activity_time() < idle_cutoff_time; });
+
+        if (poll_fds[0].revents & POLLIN)
+            accept_clients();
+    }
+}
+
+void Worker::accept_clients()
+{
+    for (size_t i = 0; i < max_accepts_per_wakeup; ++i) {
+        // The listening socket doesn't block, so this fails if another worker got there first.
+        auto fd_or_error = Core::System::accept4(m_listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd_or_error.is_error()) {
+            if (fd_or_error.error().code() != EAGAIN)
+                warnln("Failed to accept the client: {}", fd_or_error.error());
+            return;
+        }
+        m_clients.append(make<Client>(fd_or_error.value()));
+    }
+}
+
+}
@@ -0,0 +1,33 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/NonnullOwnPtrVector.h>
+#include <WebServer/Client.h>
+
+namespace WebServer {
+
+// Serves connections on one thread, without ever blocking on any of them. Every worker accepts connections from the
+// same listening socket, so new connections go to whichever worker gets to them first. They stay with it until closed.
+class Worker {
+    AK_MAKE_NONCOPYABLE(Worker);
+    AK_MAKE_NONMOVABLE(Worker);
+
+public:
+    explicit Worker(int listen_fd);
+
+    // Only returns if polling fails.
+    ErrorOr<void> run();
+
+private:
+    void accept_clients();
+
+    int m_listen_fd { -1 };
+    NonnullOwnPtrVector<Client> m_clients;
+};
+
+}
@@ -5,19 +5,32 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/NonnullOwnPtrVector.h>
+#include <AK/NonnullRefPtrVector.h>
 #include <LibCore/ArgsParser.h>
-#include <LibCore/EventLoop.h>
 #include <LibCore/File.h>
-#include <LibCore/MappedFile.h>
+#include <LibCore/SocketAddress.h>
 #include <LibCore/System.h>
-#include <LibCore/TCPServer.h>
 #include <LibHTTP/HttpRequest.h>
 #include <LibMain/Main.h>
-#include <WebServer/Client.h>
+#include <LibThreading/Thread.h>
 #include <WebServer/Configuration.h>
+#include <WebServer/Worker.h>
+#include <signal.h>
 #include <stdio.h>
+#include <sys/socket.h>
 #include <unistd.h>
 
+static ErrorOr<int> listen_on(IPv4Address const& address, u16 port)
+{
+    // Every worker accepts from this, so it must not block any of them when another one was faster.
+    int fd = TRY(Core::System::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0));
+    auto in = Core::SocketAddress(address, port).to_sockaddr_in();
+    TRY(Core::System::bind(fd, (sockaddr const*)&in, sizeof(in)));
+    TRY(Core::System::listen(fd, SOMAXCONN));
+    return fd;
+}
+
 ErrorOr<int> serenity_main(Main::Arguments arguments)
 {
     String default_listen_address = "0.0.0.0";
@@ -28,12 +41,14 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     int port = default_port;
     String username;
     String password;
+    int thread_count = 0;
 
     Core::ArgsParser args_parser;
     args_parser.add_option(listen_address, "IP address to listen on", "listen-address", 'l', "listen_address");
     args_parser.add_option(port, "Port to listen on", "port", 'p', "port");
     args_parser.add_option(username, "HTTP basic authentication username", "user", 'U', "username");
     args_parser.add_option(password, "HTTP basic authentication password", "pass", 'P', "password");
+    args_parser.add_option(thread_count, "Number of worker threads (default: one per CPU)", "threads", 'j', "count");
     args_parser.add_positional_argument(root_path, "Path to serve the contents of", "path", Core::ArgsParser::Required::No);
     args_parser.parse(arguments);
 
@@ -60,37 +75,22 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
         return 1;
     }
 
-    TRY(Core::System::pledge("stdio accept rpath inet unix"));
+    if (thread_count <= 0) {
+        auto processor_count = sysconf(_SC_NPROCESSORS_ONLN);
+        thread_count = processor_count > 1 ? static_cast<int>(processor_count) : 1;
+    }
+
+    TRY(Core::System::pledge("stdio accept rpath inet unix thread"));
 
     WebServer::Configuration configuration(real_root_path);
 
     if (!username.is_empty() && !password.is_empty())
         configuration.set_credentials(HTTP::HttpRequest::BasicAuthenticationCredentials { username, password });
 
-    Core::EventLoop loop;
-
-    auto server = TRY(Core::TCPServer::try_create());
+    // A client going away while we send it something shouldn't take the whole server with it.
+    TRY(Core::System::signal(SIGPIPE, SIG_IGN));
 
-    server->on_ready_to_accept = [&] {
-        auto maybe_client_socket = server->accept();
-        if (maybe_client_socket.is_error()) {
-            warnln("Failed to accept the client: {}", maybe_client_socket.error());
-            return;
-        }
-
-        auto maybe_buffered_socket = Core::Stream::BufferedTCPSocket::create(maybe_client_socket.release_value());
-        if (maybe_buffered_socket.is_error()) {
-            warnln("Could not obtain a buffered socket for the client: {}", maybe_buffered_socket.error());
-            return;
-        }
-
-        // FIXME: Propagate errors
-        MUST(maybe_buffered_socket.value().set_blocking(true));
-        auto client = WebServer::Client::construct(maybe_buffered_socket.release_value(), server);
-        client->start();
-    };
-
-    TRY(server->listen(ipv4_address.value(), port));
+    auto listen_fd = TRY(listen_on(ipv4_address.value(), port));
 
     outln("Listening on {}:{}", ipv4_address.value(), port);
 
@@ -98,6 +98,25 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     TRY(Core::System::unveil(real_root_path.characters(), "r"));
     TRY(Core::System::unveil(nullptr, nullptr));
 
-    TRY(Core::System::pledge("stdio accept rpath"));
-    return loop.exec();
+    TRY(Core::System::pledge("stdio accept rpath thread"));
+
+    NonnullOwnPtrVector<WebServer::Worker> workers;
+    for (int i = 0; i < thread_count; ++i)
+        workers.append(make<WebServer::Worker>(listen_fd));
+
+    // Workers only stop if polling fails, which would leave part of the server dead. Better to go down completely.
+    auto run_worker = [](WebServer::Worker& worker) -> intptr_t {
+        if (auto result = worker.run(); result.is_error())
+            warnln("Worker failed: {}", result.error());
+        exit(1);
+    };
+
+    // The first worker runs on the main thread.
+    NonnullRefPtrVector<Threading::Thread> threads;
+    for (size_t i = 1; i < workers.size(); ++i) {
+        auto thread = Threading::Thread::construct([&run_worker, &worker = workers[i]] { return run_worker(worker); }, "WebServer"sv);
+        thread->start();
+        threads.append(move(thread));
+    }
+    return run_worker(workers[0]);
 }
@@ -52,6 +52,10 @@ ClientConnection::ClientConnection(NonnullRefPtr<Core::LocalSocket> client_socke
         s_connections = new HashMap<int, NonnullRefPtr<ClientConnection>>;
     s_connections->set(client_id, *this);
 
+    // Input events and paint notifications are many small messages, let the client pick them up in batches.
+    if (auto result = enable_shared_ring_transport(); result.is_error())
+        dbgln("WindowServer: Using the socket for client {}: {}", client_id, result.error());
+
     auto& wm = WindowManager::the();
     async_fast_greet(Screen::rects(), Screen::main().index(), wm.window_stack_rows(), wm.window_stack_columns(), Gfx::current_system_theme_buffer(), Gfx::FontDatabase::default_font_query(), Gfx::FontDatabase::fixed_width_font_query(), client_id);
 }
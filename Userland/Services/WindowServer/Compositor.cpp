@@ -63,6 +63,14 @@ Compositor::Compositor()
         },
         this);
 
+    m_cursor_compose_timer = Core::Timer::create_single_shot(
+        0,
+        [this] {
+            if (m_invalidated_cursor)
+                compose_cursor_only();
+        },
+        this);
+
     init_bitmaps();
 }
 
@@ -95,12 +103,14 @@ void CompositorScreenData::init_bitmaps(Compositor& compositor, Screen& screen)
 
     m_has_flipped = false;
     m_have_flush_rects = false;
+    m_defer_back_buffer_sync = false;
     m_buffers_are_flipped = false;
     m_screen_can_set_buffer = screen.can_set_buffer();
 
     m_flush_rects.clear_with_capacity();
     m_flush_transparent_rects.clear_with_capacity();
     m_flush_special_rects.clear_with_capacity();
+    m_stale_back_buffer_rects.clear_with_capacity();
 
     auto size = screen.size();
     m_front_bitmap = nullptr;
@@ -174,6 +184,10 @@ void Compositor::compose()
         return;
     }
 
+    // Most of the time the mouse moves, the cursor is the only thing that needs to be redrawn.
+    if (m_invalidated_cursor && !is_anything_but_the_cursor_invalidated() && compose_cursor_only())
+        return;
+
     if (m_occlusions_dirty) {
         m_occlusions_dirty = false;
         recompute_occlusions();
@@ -188,6 +202,11 @@ void Compositor::compose()
 
     // Mark window regions as dirty that need to be re-rendered
     wm.for_each_visible_window_from_back_to_front([&](Window& window) {
+        // Windows that are completely covered by others don't render anything, so there's nothing to mark
+        // as dirty. Their dirty rects are cleared after painting, just like everyone else's.
+        if (window.opaque_rects().is_empty() && window.transparency_rects().is_empty())
+            return IterationDecision::Continue;
+
         auto transition_offset = window_transition_offset(window);
         auto frame_rect = window.frame().render_rect();
         auto frame_rect_on_screen = frame_rect.translated(transition_offset);
@@ -250,6 +269,28 @@ void Compositor::compose()
         return IterationDecision::Continue;
     });
 
+    // An opaque fullscreen window is the only thing painted on the screens it covers, so every frame repaints its
+    // dirty rects of the back buffer in full. Games and video players usually present entire frames, so instead of
+    // copying each flipped frame back into the back buffer right after flipping, we wait until we know what the next
+    // frame repaints and only copy the rest. That leaves one full-screen copy per frame instead of two.
+    Window* direct_flip_window = nullptr;
+    if (m_invalidated_window && m_overlay_list.is_empty() && m_animations.is_empty() && !m_flash_flush && !window_stack_transition_in_progress) {
+        auto* fullscreen_window = wm.active_fullscreen_window();
+        if (fullscreen_window && fullscreen_window->is_opaque())
+            direct_flip_window = fullscreen_window;
+    }
+    Optional<Gfx::DisjointRectSet> direct_flip_repainted_rects;
+    if (direct_flip_window)
+        direct_flip_repainted_rects = direct_flip_window->opaque_rects().intersected(direct_flip_window->dirty_rects());
+
+    Screen::for_each([&](auto& screen) {
+        auto& screen_data = screen.compositor_screen_data();
+        bool is_direct_flip = direct_flip_window && screen_data.m_screen_can_set_buffer && direct_flip_window->rect().contains(screen.rect());
+        screen_data.sync_stale_back_buffer_rects(screen, is_direct_flip ? &direct_flip_repainted_rects.value() : nullptr);
+        screen_data.m_defer_back_buffer_sync = is_direct_flip;
+        return IterationDecision::Continue;
+    });
+
     auto cursor_rect = current_cursor_rect();
 
     bool need_to_draw_cursor = false;
@@ -573,9 +614,10 @@ void Compositor::compose()
             auto screen_rect = screen.rect();
             auto& screen_data = screen.compositor_screen_data();
             for (auto& rect : screen_data.m_flush_transparent_rects.rects())
-                screen_data.m_back_painter->blit(rect.location(), *screen_data.m_temp_bitmap, rect.translated(-screen_rect.location()));
+                m_parallel_copier.add(*screen_data.m_back_bitmap, *screen_data.m_temp_bitmap, rect.translated(-screen_rect.location()) * screen.scale_factor());
             return IterationDecision::Continue;
         });
+        m_parallel_copier.run();
     }
 
     m_invalidated_any = false;
@@ -600,20 +642,27 @@ void Compositor::compose()
         screen_data.draw_cursor(cursor_screen, cursor_rect);
     }
 
+    // The pixels of all screens are copied in one go, so that they can be spread over the copier's threads together.
+    Vector<Screen&, 4> flushed_screens;
     Screen::for_each([&](auto& screen) {
-        flush(screen);
+        if (flush(screen))
+            flushed_screens.append(screen);
         return IterationDecision::Continue;
     });
+    m_parallel_copier.run();
+    for (auto& screen : flushed_screens)
+        finish_flush(screen);
 }
 
-void Compositor::flush(Screen& screen)
+// Queues up the pixels to copy for this screen, which finish_flush() then hands over to the device.
+bool Compositor::flush(Screen& screen)
 {
     auto& screen_data = screen.compositor_screen_data();
 
     bool device_can_flush_buffers = screen.can_device_flush_buffers();
     if (!screen_data.m_have_flush_rects && (!screen_data.m_screen_can_set_buffer || screen_data.m_has_flipped)) {
         dbgln_if(COMPOSE_DEBUG, "Nothing to flush on screen #{} {}", screen.index(), screen_data.m_have_flush_rects);
-        return;
+        return false;
     }
     screen_data.m_have_flush_rects = false;
 
@@ -666,15 +715,17 @@ void Compositor::flush(Screen& screen)
 
     auto do_flush = [&](Gfx::IntRect rect) {
         VERIFY(screen_rect.contains(rect));
+        if (screen_data.m_screen_can_set_buffer && screen_data.m_defer_back_buffer_sync) {
+            // We'll copy this back once we know how much of it the next frame repaints, see compose().
+            screen_data.m_stale_back_buffer_rects.add(rect);
+            return;
+        }
         rect.translate_by(-screen_rect.location());
 
         // Almost everything in Compositor is in logical coordinates, with the painters having
         // a scale applied. But this routine accesses the backbuffer pixels directly, so it
         // must work in physical coordinates.
         auto scaled_rect = rect * screen.scale_factor();
-        Gfx::RGBA32* front_ptr = screen_data.m_front_bitmap->scanline(scaled_rect.y()) + scaled_rect.x();
-        Gfx::RGBA32* back_ptr = screen_data.m_back_bitmap->scanline(scaled_rect.y()) + scaled_rect.x();
-        size_t pitch = screen_data.m_back_bitmap->pitch();
 
         // NOTE: The meaning of a flush depends on whether we can flip buffers or not.
         //
@@ -684,23 +735,11 @@ void Compositor::flush(Screen& screen)
         //
         //       If flipping is not supported, flushing means that we copy the changed
         //       rects from the backing bitmap to the display framebuffer.
+        if (screen_data.m_screen_can_set_buffer)
+            m_parallel_copier.add(*screen_data.m_back_bitmap, *screen_data.m_front_bitmap, scaled_rect);
+        else
+            m_parallel_copier.add(*screen_data.m_front_bitmap, *screen_data.m_back_bitmap, scaled_rect);
 
-        Gfx::RGBA32* to_ptr;
-        const Gfx::RGBA32* from_ptr;
-
-        if (screen_data.m_screen_can_set_buffer) {
-            to_ptr = back_ptr;
-            from_ptr = front_ptr;
-        } else {
-            to_ptr = front_ptr;
-            from_ptr = back_ptr;
-        }
-
-        for (int y = 0; y < scaled_rect.height(); ++y) {
-            fast_u32_copy(to_ptr, from_ptr, scaled_rect.width());
-            from_ptr = (const Gfx::RGBA32*)((const u8*)from_ptr + pitch);
-            to_ptr = (Gfx::RGBA32*)((u8*)to_ptr + pitch);
-        }
         if (device_can_flush_buffers) {
             // Whether or not we need to flush buffers, we need to at least track what we modified
             // so that we can flush these areas next time before we flip buffers. Or, if we don't
@@ -714,7 +753,13 @@ void Compositor::flush(Screen& screen)
         do_flush(rect);
     for (auto& rect : screen_data.m_flush_special_rects.rects())
         do_flush(rect);
-    if (device_can_flush_buffers && !screen_data.m_screen_can_set_buffer) {
+    return true;
+}
+
+void Compositor::finish_flush(Screen& screen)
+{
+    auto& screen_data = screen.compositor_screen_data();
+    if (screen.can_device_flush_buffers() && !screen_data.m_screen_can_set_buffer) {
         // If we also support flipping buffers we don't really need to flush these areas right now.
         // Instead, we skip this step and just keep track of them until shortly before the next flip.
         // If we however don't support flipping buffers then we need to flush the changed areas right
@@ -807,12 +852,18 @@ bool Compositor::set_wallpaper_mode(const String& mode)
 
 bool Compositor::set_wallpaper(const String& path, Function<void(bool)>&& callback)
 {
+    // Wallpapers are loaded on a thread pool, so a later request may finish first. Only the latest one gets applied.
+    auto generation = ++m_wallpaper_generation;
     (void)Threading::BackgroundAction<ErrorOr<NonnullRefPtr<Gfx::Bitmap>>>::construct(
         [path](auto&) {
             return Gfx::Bitmap::try_load_from_file(path);
         },
 
-        [this, path, callback = move(callback)](ErrorOr<NonnullRefPtr<Gfx::Bitmap>> bitmap) {
+        [this, path, generation, callback = move(callback)](ErrorOr<NonnullRefPtr<Gfx::Bitmap>> bitmap) {
+            if (generation != m_wallpaper_generation) {
+                callback(false);
+                return;
+            }
             if (bitmap.is_error() && !path.is_empty()) {
                 callback(false);
                 return;
@@ -828,6 +879,31 @@ bool Compositor::set_wallpaper(const String& path, Function<void(bool)>&& callba
     return true;
 }
 
+void CompositorScreenData::sync_stale_back_buffer_rects(Screen& screen, Gfx::DisjointRectSet const* rects_to_be_repainted)
+{
+    if (m_stale_back_buffer_rects.is_empty())
+        return;
+
+    auto rects_to_sync = rects_to_be_repainted ? m_stale_back_buffer_rects.shatter(*rects_to_be_repainted) : move(m_stale_back_buffer_rects);
+    m_stale_back_buffer_rects.clear_with_capacity();
+
+    auto screen_rect = screen.rect();
+    for (auto rect : rects_to_sync.rects()) {
+        rect.translate_by(-screen_rect.location());
+        auto scaled_rect = rect * screen.scale_factor();
+        Gfx::RGBA32 const* from_ptr = m_front_bitmap->scanline(scaled_rect.y()) + scaled_rect.x();
+        Gfx::RGBA32* to_ptr = m_back_bitmap->scanline(scaled_rect.y()) + scaled_rect.x();
+        size_t pitch = m_back_bitmap->pitch();
+        for (int y = 0; y < scaled_rect.height(); ++y) {
+            fast_u32_copy(to_ptr, from_ptr, scaled_rect.width());
+            from_ptr = (Gfx::RGBA32 const*)((u8 const*)from_ptr + pitch);
+            to_ptr = (Gfx::RGBA32*)((u8*)to_ptr + pitch);
+        }
+        if (screen.can_device_flush_buffers())
+            screen.queue_flush_display_rect(rect);
+    }
+}
+
 void CompositorScreenData::flip_buffers(Screen& screen)
 {
     VERIFY(m_screen_can_set_buffer);
@@ -862,10 +938,49 @@ void Compositor::invalidate_cursor(bool compose_immediately)
     m_invalidated_cursor = true;
     m_invalidated_any = true;
 
-    if (compose_immediately)
+    if (compose_immediately) {
         compose();
-    else
+    } else if (m_compose_timer->is_active()) {
+        // Don't make the cursor wait for the pending composition, it can usually be redrawn on its own right away.
+        m_cursor_compose_timer->start();
+    } else {
+        start_compose_async_timer();
+    }
+}
+
+// Restores what's behind the cursor and draws it at its current location, without composing anything else.
+// Returns false if that's not possible, in which case the cursor is left for the next composition.
+bool Compositor::compose_cursor_only()
+{
+    change_cursor(&WindowManager::the().active_cursor());
+
+    auto& cursor_screen = ScreenInput::the().cursor_location_screen();
+    if (&cursor_screen != m_current_cursor_screen)
+        return false;
+    auto& screen_data = cursor_screen.compositor_screen_data();
+    // When flipping, the back buffer becomes the front buffer, so it can't be missing anything but the cursor.
+    if (!screen_data.m_cursor_back_bitmap || !screen_data.m_stale_back_buffer_rects.is_empty())
+        return false;
+
+    screen_data.m_flush_rects.clear_with_capacity();
+    screen_data.m_flush_transparent_rects.clear_with_capacity();
+    screen_data.m_flush_special_rects.clear_with_capacity();
+
+    Gfx::IntRect previous_cursor_rect;
+    screen_data.restore_cursor_back(cursor_screen, previous_cursor_rect);
+    screen_data.draw_cursor(cursor_screen, current_cursor_rect());
+    m_invalidated_cursor = false;
+
+    if (flush(cursor_screen)) {
+        m_parallel_copier.run();
+        finish_flush(cursor_screen);
+    }
+
+    if (is_anything_but_the_cursor_invalidated())
         start_compose_async_timer();
+    else
+        m_invalidated_any = false;
+    return true;
 }
 
 void Compositor::change_cursor(const Cursor* cursor)
@@ -1209,12 +1324,19 @@ void Compositor::recompute_occlusions()
                     invalidate_previous_render_rects(rect);
             }
 
+            auto render_rect_on_screen = w.frame().render_rect().translated(transition_offset);
+            if (!remaining_visible_screen_rects.intersects(render_rect_on_screen)) {
+                // The windows in front of this one already cover everything it could render, so there's no
+                // need to work out which parts of it the windows in front of it cover.
+                w.set_occluded(!never_occlude(w.window_stack()));
+                return IterationDecision::Continue;
+            }
+
             if (auto transparent_render_rects = transparent_frame_render_rects.intersected(remaining_visible_screen_rects); !transparent_render_rects.is_empty())
                 transparency_rects = move(transparent_render_rects);
             if (auto opaque_render_rects = opaque_frame_render_rects.intersected(remaining_visible_screen_rects); !opaque_render_rects.is_empty())
                 visible_opaque = move(opaque_render_rects);
 
-            auto render_rect_on_screen = w.frame().render_rect().translated(transition_offset);
             auto visible_window_rects = remaining_visible_screen_rects.intersected(w.rect().translated(transition_offset));
             Gfx::DisjointRectSet opaque_covering;
             Gfx::DisjointRectSet transparent_covering;
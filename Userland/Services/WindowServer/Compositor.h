@@ -13,6 +13,7 @@
 #include <LibGfx/DisjointRectSet.h>
 #include <LibGfx/Font.h>
 #include <WindowServer/Overlays.h>
+#include <WindowServer/ParallelCopier.h>
 
 namespace WindowServer {
 
@@ -49,15 +50,20 @@ struct CompositorScreenData {
     bool m_has_flipped { false };
     bool m_cursor_back_is_valid { false };
     bool m_have_flush_rects { false };
+    bool m_defer_back_buffer_sync { false };
 
     Gfx::DisjointRectSet m_flush_rects;
     Gfx::DisjointRectSet m_flush_transparent_rects;
     Gfx::DisjointRectSet m_flush_special_rects;
 
+    // Rects that were flipped to the front buffer, but not copied back into the back buffer yet.
+    Gfx::DisjointRectSet m_stale_back_buffer_rects;
+
     Gfx::Painter& overlay_painter() { return *m_temp_painter; }
 
     void init_bitmaps(Compositor&, Screen&);
     void flip_buffers(Screen&);
+    void sync_stale_back_buffer_rects(Screen&, Gfx::DisjointRectSet const* rects_to_be_repainted);
     void draw_cursor(Screen&, const Gfx::IntRect&);
     bool restore_cursor_back(Screen&, Gfx::IntRect&);
 
@@ -203,7 +209,10 @@ private:
     void recompute_overlay_rects();
     void recompute_occlusions();
     void change_cursor(const Cursor*);
-    void flush(Screen&);
+    bool compose_cursor_only();
+    bool is_anything_but_the_cursor_invalidated() const { return m_invalidated_window || m_occlusions_dirty || !m_dirty_screen_rects.is_empty() || !m_animations.is_empty(); }
+    bool flush(Screen&);
+    void finish_flush(Screen&);
     Gfx::IntPoint window_transition_offset(Window&);
     void update_animations(Screen&, Gfx::DisjointRectSet& flush_rects);
     void create_window_stack_switch_overlay(WindowStack&);
@@ -214,6 +223,7 @@ private:
 
     RefPtr<Core::Timer> m_compose_timer;
     RefPtr<Core::Timer> m_immediate_compose_timer;
+    RefPtr<Core::Timer> m_cursor_compose_timer;
     bool m_flash_flush { false };
     bool m_occlusions_dirty { true };
     bool m_invalidated_any { true };
@@ -227,9 +237,12 @@ private:
     Gfx::DisjointRectSet m_opaque_wallpaper_rects;
     Gfx::DisjointRectSet m_transparent_wallpaper_rects;
 
+    ParallelCopier m_parallel_copier;
+
     String m_wallpaper_path { "" };
     WallpaperMode m_wallpaper_mode { WallpaperMode::Unchecked };
     RefPtr<Gfx::Bitmap> m_wallpaper;
+    u64 m_wallpaper_generation { 0 };
 
     const Cursor* m_current_cursor { nullptr };
     Screen* m_current_cursor_screen { nullptr };
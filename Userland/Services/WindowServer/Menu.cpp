@@ -238,8 +238,7 @@ void Menu::draw(MenuItem const& item, bool is_drawing_all)
     if (!is_drawing_all) {
         // If we're redrawing all of them then we already did this in draw()
         painter.fill_rect(stripe_rect, palette.menu_stripe());
-        for (auto& rect : item.rect().shatter(stripe_rect))
-            painter.fill_rect(rect, palette.menu_base());
+        painter.fill_rects(item.rect().shatter(stripe_rect), palette.menu_base());
     }
 
     if (item.type() == MenuItem::Text) {
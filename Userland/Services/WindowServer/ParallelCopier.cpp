@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Memory.h>
+#include <AK/ScopeGuard.h>
+#include <WindowServer/ParallelCopier.h>
+
+namespace WindowServer {
+
+ParallelCopier::~ParallelCopier()
+{
+    {
+        Threading::MutexLocker locker(m_mutex);
+        m_shutting_down = true;
+        m_bands_available.broadcast();
+    }
+    for (auto& worker : m_workers)
+        (void)worker.join();
+}
+
+void ParallelCopier::add(Gfx::Bitmap& destination, Gfx::Bitmap const& source, Gfx::IntRect const& physical_rect)
+{
+    if (physical_rect.is_empty())
+        return;
+    VERIFY(destination.physical_rect().contains(physical_rect));
+    VERIFY(source.physical_rect().contains(physical_rect));
+
+    m_copies.append({
+        destination.scanline(physical_rect.y()) + physical_rect.x(),
+        destination.pitch(),
+        source.scanline(physical_rect.y()) + physical_rect.x(),
+        source.pitch(),
+        physical_rect.width(),
+        physical_rect.height(),
+    });
+    m_bytes_to_copy += physical_rect.width() * physical_rect.height() * sizeof(Gfx::RGBA32);
+}
+
+void ParallelCopier::Copy::perform() const
+{
+    auto* to = destination;
+    auto const* from = source;
+    for (int y = 0; y < height; ++y) {
+        fast_u32_copy(to, from, width);
+        to = (Gfx::RGBA32*)((u8*)to + destination_pitch);
+        from = (Gfx::RGBA32 const*)((u8 const*)from + source_pitch);
+    }
+}
+
+void ParallelCopier::run()
+{
+    ScopeGuard clear_copies = [&] {
+        m_copies.clear_with_capacity();
+        m_bytes_to_copy = 0;
+    };
+
+    if (m_bytes_to_copy < parallel_copy_threshold) {
+        for (auto& copy : m_copies)
+            copy.perform();
+        return;
+    }
+
+    start_workers_if_needed();
+
+    {
+        Threading::MutexLocker locker(m_mutex);
+        VERIFY(m_unfinished_bands == 0);
+        m_bands.clear_with_capacity();
+        m_next_band = 0;
+        // Cut every copy into bands of rows, so that one large rect gets spread over all threads too.
+        for (auto& copy : m_copies) {
+            int rows_per_band = max(1, (int)(band_size_in_bytes / (copy.width * sizeof(Gfx::RGBA32))));
+            for (int y = 0; y < copy.height; y += rows_per_band) {
+                auto band = copy;
+                band.destination = (Gfx::RGBA32*)((u8*)copy.destination + y * copy.destination_pitch);
+                band.source = (Gfx::RGBA32 const*)((u8 const*)copy.source + y * copy.source_pitch);
+                band.height = min(rows_per_band, copy.height - y);
+                m_bands.append(band);
+            }
+        }
+        m_unfinished_bands = m_bands.size();
+        m_bands_available.broadcast();
+    }
+
+    // The calling thread helps out instead of just waiting.
+    perform_pending_bands();
+
+    Threading::MutexLocker locker(m_mutex);
+    m_bands_done.wait_while([this] { return m_unfinished_bands > 0; });
+}
+
+void ParallelCopier::perform_pending_bands()
+{
+    for (;;) {
+        Copy band;
+        {
+            Threading::MutexLocker locker(m_mutex);
+            if (m_next_band >= m_bands.size())
+                return;
+            band = m_bands[m_next_band++];
+        }
+
+        band.perform();
+
+        Threading::MutexLocker locker(m_mutex);
+        if (--m_unfinished_bands == 0)
+            m_bands_done.broadcast();
+    }
+}
+
+void ParallelCopier::start_workers_if_needed()
+{
+    if (!m_workers.is_empty())
+        return;
+
+    for (size_t i = 0; i < worker_count; ++i) {
+        auto worker = Threading::Thread::construct([this] { return worker_main(); }, "WindowServer[copy]"sv);
+        worker->start();
+        m_workers.append(move(worker));
+    }
+}
+
+intptr_t ParallelCopier::worker_main()
+{
+    for (;;) {
+        {
+            Threading::MutexLocker locker(m_mutex);
+            m_bands_available.wait_while([this] { return m_next_band >= m_bands.size() && !m_shutting_down; });
+            if (m_shutting_down)
+                return 0;
+        }
+        perform_pending_bands();
+    }
+}
+
+}
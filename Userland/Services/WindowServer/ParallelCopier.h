@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/NonnullRefPtrVector.h>
+#include <AK/Vector.h>
+#include <LibGfx/Bitmap.h>
+#include <LibThreading/ConditionVariable.h>
+#include <LibThreading/Mutex.h>
+#include <LibThreading/Thread.h>
+
+namespace WindowServer {
+
+// Copies rectangles of pixels between bitmaps, spreading big batches over a few worker threads.
+// The compositor copies whole areas between its temporary, back and front buffers on every frame,
+// which is most of the work for large dirty areas, and every screen's buffers are independent of
+// the others'. The workers never touch anything but the pixels they were handed.
+class ParallelCopier {
+public:
+    ParallelCopier() = default;
+    ~ParallelCopier();
+
+    // Queues a copy of the given physical rect, which is at the same location in both bitmaps.
+    void add(Gfx::Bitmap& destination, Gfx::Bitmap const& source, Gfx::IntRect const& physical_rect);
+
+    // Performs all queued copies, and returns once they're done.
+    void run();
+
+private:
+    struct Copy {
+        Gfx::RGBA32* destination { nullptr };
+        size_t destination_pitch { 0 };
+        Gfx::RGBA32 const* source { nullptr };
+        size_t source_pitch { 0 };
+        int width { 0 };
+        int height { 0 };
+
+        void perform() const;
+    };
+
+    // Below this many bytes, waking up the workers costs more than it saves.
+    static constexpr size_t parallel_copy_threshold = 512 * KiB;
+    static constexpr size_t band_size_in_bytes = 128 * KiB;
+    static constexpr size_t worker_count = 3;
+
+    void start_workers_if_needed();
+    intptr_t worker_main();
+    void perform_pending_bands();
+
+    Vector<Copy> m_copies;
+    size_t m_bytes_to_copy { 0 };
+
+    Threading::Mutex m_mutex;
+    Threading::ConditionVariable m_bands_available { m_mutex };
+    Threading::ConditionVariable m_bands_done { m_mutex };
+    Vector<Copy> m_bands;
+    size_t m_next_band { 0 };
+    size_t m_unfinished_bands { 0 };
+    bool m_shutting_down { false };
+    NonnullRefPtrVector<Threading::Thread> m_workers;
+};
+
+}
@@ -62,7 +62,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
                 fflush(stdout);
                 resampler.reset();
                 auto resampled_samples = TRY(Audio::resample_buffer(resampler, *samples.value()));
-                audio_client->async_enqueue(*resampled_samples);
+                TRY(audio_client->write_samples({ resampled_samples->samples(), static_cast<size_t>(resampled_samples->sample_count()) }));
             } else if (should_loop) {
                 // We're done: now loop
                 auto result = loader->reset();
@@ -10,10 +10,10 @@
 #include <AK/Vector.h>
 #include <LibCore/ArgsParser.h>
 #include <LibCore/DateTime.h>
-#include <LibCore/DirIterator.h>
 #include <LibCore/File.h>
 #include <LibCore/System.h>
 #include <LibMain/Main.h>
+#include <LibThreading/DirectoryWalker.h>
 #include <limits.h>
 #include <string.h>
 #include <sys/stat.h>
@@ -35,7 +35,7 @@ struct DuOption {
 };
 
 static ErrorOr<void> parse_args(Main::Arguments arguments, Vector<String>& files, DuOption& du_option, int& max_depth);
-static ErrorOr<off_t> print_space_usage(const String& path, const DuOption& du_option, int max_depth);
+static ErrorOr<off_t> print_space_usage(const String& path, struct stat const& path_stat, const DuOption& du_option, int max_depth, Threading::DirectoryWalker&);
 
 ErrorOr<int> serenity_main(Main::Arguments arguments)
 {
@@ -45,8 +45,12 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
 
     TRY(parse_args(arguments, files, du_option, max_depth));
 
-    for (const auto& file : files)
-        TRY(print_space_usage(file, du_option, max_depth));
+    // We need the size of everything, so the walker might as well stat() the entries while it's reading ahead.
+    Threading::DirectoryWalker walker(Threading::DirectoryWalker::StatEntries::Always);
+    for (const auto& file : files) {
+        auto path_stat = TRY(Core::System::lstat(file.characters()));
+        TRY(print_space_usage(file, path_stat, du_option, max_depth, walker));
+    }
 
     return 0;
 }
@@ -118,21 +122,21 @@ ErrorOr<void> parse_args(Main::Arguments arguments, Vector<String>& files, DuOpt
     return {};
 }
 
-ErrorOr<off_t> print_space_usage(const String& path, const DuOption& du_option, int max_depth)
+ErrorOr<off_t> print_space_usage(const String& path, struct stat const& path_stat, const DuOption& du_option, int max_depth, Threading::DirectoryWalker& walker)
 {
-    struct stat path_stat = TRY(Core::System::lstat(path.characters()));
     off_t directory_size = 0;
     const bool is_directory = S_ISDIR(path_stat.st_mode);
     if (--max_depth >= 0 && is_directory) {
-        auto di = Core::DirIterator(path, Core::DirIterator::SkipParentAndBaseDir);
-        if (di.has_error()) {
-            outln("du: cannot read directory '{}': {}", path, di.error_string());
+        auto read_ahead = max_depth > 0 ? Threading::DirectoryWalker::ReadAhead::Yes : Threading::DirectoryWalker::ReadAhead::No;
+        auto entries_or_error = walker.read_directory(path, read_ahead);
+        if (entries_or_error.is_error()) {
+            outln("du: cannot read directory '{}': {}", path, strerror(entries_or_error.error().code()));
             return Error::from_string_literal("An error occurred. See previous error."sv);
         }
 
-        while (di.has_next()) {
-            const auto child_path = di.next_full_path();
-            directory_size += TRY(print_space_usage(child_path, du_option, max_depth));
+        for (auto const& entry : entries_or_error.value()) {
+            auto child_stat = entry.stat.has_value() ? entry.stat.value() : TRY(Core::System::lstat(entry.path.characters()));
+            directory_size += TRY(print_space_usage(entry.path, child_stat, du_option, max_depth, walker));
         }
     }
 
@@ -4,9 +4,8 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
-#include "AK/String.h"
-#include <AK/Assertions.h>
 #include <AK/Format.h>
+#include <AK/StringSearcher.h>
 #include <LibCore/System.h>
 #include <LibMain/Main.h>
 #include <stdio.h>
@@ -17,13 +16,13 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
         warnln("usage: fgrep <str>");
         return 1;
     }
+    StringSearcher searcher { arguments.strings[1] };
     for (;;) {
         char buffer[4096];
         auto str = StringView(fgets(buffer, sizeof(buffer), stdin));
-        if (str.contains(arguments.strings[1]))
+        if (searcher.is_in(str))
             TRY(Core::System::write(1, str.bytes()));
         if (feof(stdin))
             return 0;
-        VERIFY(str.to_string().characters());
     }
 }
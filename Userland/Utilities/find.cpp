@@ -12,6 +12,7 @@
 #include <AK/Vector.h>
 #include <LibCore/System.h>
 #include <LibMain/Main.h>
+#include <LibThreading/DirectoryWalker.h>
 #include <dirent.h>
 #include <errno.h>
 #include <fcntl.h>
@@ -472,7 +473,8 @@ static NonnullOwnPtr<Command> parse_all_commands(Vector<char*>& args)
     return make<AndCommand>(command.release_nonnull(), make<PrintCommand>());
 }
 
-static void walk_tree(FileData& root_data, Command& command)
+// The path is the one the directory was found at, which is what the walker knows it by; full_path is canonicalized.
+static void walk_tree(FileData& root_data, String const& path, Command& command, Threading::DirectoryWalker& walker)
 {
     command.evaluate(root_data);
 
@@ -493,46 +495,32 @@ static void walk_tree(FileData& root_data, Command& command)
         return;
     }
 
-    int dirfd = openat(root_data.dirfd, root_data.basename, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
-    if (dirfd < 0) {
-        if (errno == ENOTDIR) {
+    auto entries_or_error = walker.read_directory(path);
+    if (entries_or_error.is_error()) {
+        auto error_code = entries_or_error.error().code();
+        if (error_code == ENOTDIR) {
             // Above we decided to try to open this file because it could
             // be a directory, but turns out it's not. This is fine though.
             return;
         }
-        perror(root_data.full_path.string().characters());
+        warnln("{}: {}", root_data.full_path, strerror(error_code));
         g_there_was_an_error = true;
         return;
     }
 
-    DIR* dir = fdopendir(dirfd);
-
-    while (true) {
-        errno = 0;
-        auto* dirent = readdir(dir);
-        if (!dirent)
-            break;
-
-        if (strcmp(dirent->d_name, ".") == 0 || strcmp(dirent->d_name, "..") == 0)
-            continue;
-
+    for (auto& entry : entries_or_error.value()) {
+        // The walker only stat()s entries of unknown type, and it doesn't follow symlinks.
+        bool stat_is_valid = entry.stat.has_value() && !g_follow_symlinks;
         FileData file_data {
-            root_data.full_path.append(dirent->d_name),
-            dirfd,
-            dirent->d_name,
-            (struct stat) {},
-            false,
-            dirent->d_type,
+            root_data.full_path.append(entry.name),
+            AT_FDCWD,
+            entry.path.characters(),
+            stat_is_valid ? entry.stat.value() : (struct stat) {},
+            stat_is_valid,
+            entry.type,
         };
-        walk_tree(file_data, command);
-    }
-
-    if (errno != 0) {
-        perror(root_data.full_path.string().characters());
-        g_there_was_an_error = true;
+        walk_tree(file_data, entry.path, command, walker);
     }
-
-    closedir(dir);
 }
 
 ErrorOr<int> serenity_main(Main::Arguments arguments)
@@ -563,6 +551,8 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     if (paths.is_empty())
         paths.append(LexicalPath("."));
 
+    Threading::DirectoryWalker walker;
+
     for (auto& path : paths) {
         String dirname = path.dirname();
         String basename = path.basename();
@@ -577,7 +567,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
             false,
             DT_UNKNOWN,
         };
-        walk_tree(file_data, *command);
+        walk_tree(file_data, path.string(), *command, walker);
         close(dirfd);
     }
 
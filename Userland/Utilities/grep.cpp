@@ -13,8 +13,13 @@
 #include <LibCore/ArgsParser.h>
 #include <LibCore/DirIterator.h>
 #include <LibCore/File.h>
+#include <LibCore/MappedFile.h>
 #include <LibRegex/Regex.h>
+#include <LibThreading/DirectoryWalker.h>
+#include <LibThreading/Parallel.h>
 #include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 enum class BinaryFileMode {
@@ -23,6 +28,44 @@ enum class BinaryFileMode {
     Skip,
 };
 
+// Calls callback() with every line in the given bytes, without its line ending, until it returns IterationDecision::Break.
+template<typename Callback>
+static void for_each_line(ReadonlyBytes bytes, Callback callback)
+{
+    StringView remaining { bytes };
+    while (!remaining.is_empty()) {
+        auto const* newline = static_cast<char const*>(memchr(remaining.characters_without_null_termination(), '\n', remaining.length()));
+        size_t length = newline ? newline - remaining.characters_without_null_termination() : remaining.length();
+        auto line = remaining.substring_view(0, length);
+        remaining = remaining.substring_view(min(length + 1, remaining.length()));
+        while (line.ends_with('\r'))
+            line = line.substring_view(0, line.length() - 1);
+        if (callback(line) == IterationDecision::Break)
+            return;
+    }
+}
+
+// Splits the bytes into about chunk_count chunks that each end after a newline.
+static Vector<ReadonlyBytes> split_into_line_chunks(ReadonlyBytes bytes, size_t chunk_count)
+{
+    Vector<ReadonlyBytes> chunks;
+    auto chunk_size = ceil_div(bytes.size(), chunk_count);
+    while (!bytes.is_empty()) {
+        auto end = min(chunk_size, bytes.size());
+        if (end < bytes.size()) {
+            auto const* newline = static_cast<u8 const*>(memchr(bytes.data() + end, '\n', bytes.size() - end));
+            end = newline ? newline - bytes.data() + 1 : bytes.size();
+        }
+        chunks.append(bytes.trim(end));
+        bytes = bytes.slice(end);
+    }
+    return chunks;
+}
+
+// Below this size, searching a file on a single thread is faster than spreading the work.
+static constexpr size_t parallel_search_threshold = 4 * MiB;
+static constexpr size_t parallel_search_chunk_size = 1 * MiB;
+
 template<typename... Ts>
 void fail(StringView format, Ts... args)
 {
@@ -34,7 +77,7 @@ void fail(StringView format, Ts... args)
 
 int main(int argc, char** argv)
 {
-    if (pledge("stdio rpath", nullptr) < 0) {
+    if (pledge("stdio rpath thread", nullptr) < 0) {
         perror("pledge");
         return 1;
     }
@@ -189,7 +232,67 @@ int main(int argc, char** argv)
             return false;
         };
 
-        auto handle_file = [&matches, binary_mode, suppress_errors, count_lines, quiet_mode,
+        // Finds the lines that are selected by any of the expressions, spreading the file over the thread pool, and
+        // then hands just those lines to matches() in order. Each chunk gets its own copy of the expressions, as
+        // matching caches state in them.
+        auto handle_mapped_file_in_parallel = [&](ReadonlyBytes bytes, StringView filename, bool print_filename) {
+            using RegexType = typename RemoveCVReference<decltype(regular_expressions)>::ValueType;
+
+            auto chunk_count = min(ceil_div(bytes.size(), parallel_search_chunk_size), Threading::ThreadPool::the().worker_count() * 4);
+            auto chunks = split_into_line_chunks(bytes, chunk_count);
+
+            struct ChunkResult {
+                Vector<RegexType> regular_expressions;
+                Vector<size_t> selected_line_indices;
+                size_t line_count { 0 };
+            };
+            Vector<ChunkResult> chunk_results;
+            chunk_results.resize(chunks.size());
+            for (auto& chunk_result : chunk_results) {
+                for (auto& re : regular_expressions)
+                    chunk_result.regular_expressions.append(RegexType(String(re.pattern_value.view()), re.options()));
+            }
+
+            Threading::parallel_for(
+                chunks.size(), [&](size_t chunk) {
+                    auto& result = chunk_results[chunk];
+                    for_each_line(chunks[chunk], [&](StringView line) {
+                        for (auto& re : result.regular_expressions) {
+                            if (re.has_match(line, PosixFlags::Global) ^ invert_match) {
+                                result.selected_line_indices.append(result.line_count);
+                                break;
+                            }
+                        }
+                        result.line_count++;
+                        return IterationDecision::Continue;
+                    });
+                },
+                1);
+
+            size_t first_line_number = 1;
+            for (size_t chunk = 0; chunk < chunks.size(); ++chunk) {
+                auto& result = chunk_results[chunk];
+                size_t line_index = 0;
+                size_t next_selected = 0;
+                auto decision = IterationDecision::Continue;
+                for_each_line(chunks[chunk], [&](StringView line) {
+                    if (next_selected == result.selected_line_indices.size())
+                        return IterationDecision::Break;
+                    if (result.selected_line_indices[next_selected] != line_index++)
+                        return IterationDecision::Continue;
+                    next_selected++;
+                    auto is_binary = line.contains(0);
+                    if (matches(line, filename, first_line_number + line_index - 1, print_filename, is_binary) && is_binary && binary_mode == BinaryFileMode::Binary)
+                        decision = IterationDecision::Break;
+                    return decision;
+                });
+                if (decision == IterationDecision::Break)
+                    return;
+                first_line_number += result.line_count;
+            }
+        };
+
+        auto handle_file = [&matches, &handle_mapped_file_in_parallel, binary_mode, suppress_errors, count_lines, quiet_mode,
                                user_specified_multiple_files, &matched_line_count](StringView filename, bool print_filename) -> bool {
             auto file = Core::File::construct(filename);
             if (!file->open(Core::OpenMode::ReadOnly)) {
@@ -198,12 +301,33 @@ int main(int argc, char** argv)
                 return false;
             }
 
-            for (size_t line_number = 1; file->can_read_line(); ++line_number) {
-                auto line = file->read_line();
-                auto is_binary = memchr(line.characters(), 0, line.length()) != nullptr;
+            // Regular files are mapped, so we can look at the lines in place instead of copying each into a String.
+            RefPtr<Core::MappedFile> mapped_file;
+            struct stat st;
+            if (fstat(file->fd(), &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+                auto mapped_file_or_error = Core::MappedFile::map_from_fd_and_close(dup(file->fd()), filename);
+                if (!mapped_file_or_error.is_error())
+                    mapped_file = mapped_file_or_error.release_value();
+            }
 
-                if (matches(line, filename, line_number, print_filename, is_binary) && is_binary && binary_mode == BinaryFileMode::Binary)
-                    break;
+            if (mapped_file && mapped_file->size() >= parallel_search_threshold) {
+                handle_mapped_file_in_parallel(mapped_file->bytes(), filename, print_filename);
+            } else if (mapped_file) {
+                size_t line_number = 1;
+                for_each_line(mapped_file->bytes(), [&](StringView line) {
+                    auto is_binary = line.contains(0);
+                    if (matches(line, filename, line_number++, print_filename, is_binary) && is_binary && binary_mode == BinaryFileMode::Binary)
+                        return IterationDecision::Break;
+                    return IterationDecision::Continue;
+                });
+            } else {
+                for (size_t line_number = 1; file->can_read_line(); ++line_number) {
+                    auto line = file->read_line();
+                    auto is_binary = memchr(line.characters(), 0, line.length()) != nullptr;
+
+                    if (matches(line, filename, line_number, print_filename, is_binary) && is_binary && binary_mode == BinaryFileMode::Binary)
+                        break;
+                }
             }
 
             if (count_lines && !quiet_mode) {
@@ -217,11 +341,16 @@ int main(int argc, char** argv)
             return true;
         };
 
-        auto add_directory = [&handle_file, user_has_specified_files](String base, Optional<String> recursive, auto handle_directory) -> void {
-            Core::DirIterator it(recursive.value_or(base), Core::DirIterator::Flags::SkipDots);
-            while (it.has_next()) {
-                auto path = it.next_full_path();
-                if (!Core::File::is_directory(path)) {
+        Threading::DirectoryWalker walker { Threading::DirectoryWalker::StatEntries::IfTypeIsUnknown, Core::DirIterator::SkipDots };
+        auto add_directory = [&handle_file, &walker, user_has_specified_files](String base, Optional<String> recursive, auto handle_directory) -> void {
+            auto entries_or_error = walker.read_directory(recursive.value_or(base));
+            if (entries_or_error.is_error())
+                return;
+            for (auto& entry : entries_or_error.value()) {
+                auto const& path = entry.path;
+                // Symlinks are followed, so only those need a stat() to find out whether they point to a directory.
+                bool is_directory = entry.type == DT_DIR || (entry.type == DT_LNK && Core::File::is_directory(path));
+                if (!is_directory) {
                     auto key = user_has_specified_files ? path.view() : path.substring_view(base.length() + 1, path.length() - base.length() - 1);
                     handle_file(key, true);
                 } else {
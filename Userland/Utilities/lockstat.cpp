@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/JsonArray.h>
+#include <AK/JsonObject.h>
+#include <AK/QuickSort.h>
+#include <AK/String.h>
+#include <AK/Vector.h>
+#include <LibCore/ArgsParser.h>
+#include <LibCore/File.h>
+#include <LibCore/System.h>
+#include <LibMain/Main.h>
+
+static constexpr StringView statistics_path = "/sys/locking/statistics"sv;
+
+struct LockInfo {
+    String kind;
+    String name;
+    u64 acquisitions { 0 };
+    u64 contentions { 0 };
+    u64 total_wait_cycles { 0 };
+    Vector<u64> wait_histogram;
+};
+
+// Returns the upper bound (in cycles) of the histogram bucket that contains the given percentile of all waits.
+static u64 wait_percentile(LockInfo const& lock, u64 percentile)
+{
+    if (lock.contentions == 0)
+        return 0;
+    u64 target = (lock.contentions * percentile + 99) / 100;
+    u64 seen = 0;
+    for (size_t i = 0; i < lock.wait_histogram.size(); ++i) {
+        seen += lock.wait_histogram[i];
+        if (seen >= target)
+            return 2ull << i;
+    }
+    return 2ull << (lock.wait_histogram.size() - 1);
+}
+
+static ErrorOr<void> set_recording(bool enabled)
+{
+    auto file = TRY(Core::File::open(statistics_path, Core::OpenMode::WriteOnly));
+    if (!file->write(enabled ? "1"sv : "0"sv))
+        return Error::from_errno(file->error());
+    return {};
+}
+
+ErrorOr<int> serenity_main(Main::Arguments arguments)
+{
+    bool enable = false;
+    bool disable = false;
+    bool sort_by_wait_time = false;
+    int count = 20;
+
+    Core::ArgsParser args_parser;
+    args_parser.set_general_help("Show kernel lock contention statistics.");
+    args_parser.add_option(enable, "Start recording lock statistics, discarding the previous ones", "enable", 'e');
+    args_parser.add_option(disable, "Stop recording lock statistics", "disable", 'd');
+    args_parser.add_option(sort_by_wait_time, "Sort by total wait time instead of number of contentions", "wait-time", 'w');
+    args_parser.add_option(count, "Show at most this many locks", "count", 'n', "N");
+    args_parser.parse(arguments);
+
+    TRY(Core::System::pledge("stdio rpath wpath"));
+    TRY(Core::System::unveil(statistics_path, "rw"));
+    TRY(Core::System::unveil(nullptr, nullptr));
+
+    if (enable && disable) {
+        warnln("Can't both enable and disable recording");
+        return 1;
+    }
+    if (enable || disable) {
+        TRY(set_recording(enable));
+        return 0;
+    }
+
+    TRY(Core::System::pledge("stdio rpath"));
+
+    auto file = TRY(Core::File::open(statistics_path, Core::OpenMode::ReadOnly));
+    auto json = TRY(JsonValue::from_string(file->read_all()));
+    auto const& statistics = json.as_object();
+
+    if (!statistics.get("enabled").to_bool())
+        warnln("Lock statistics are not being recorded, use `lockstat -e` to start.");
+
+    Vector<LockInfo> locks;
+    statistics.get("locks").as_array().for_each([&](auto& value) {
+        auto const& object = value.as_object();
+        LockInfo lock;
+        lock.kind = object.get("kind").to_string();
+        lock.name = object.get("name").to_string();
+        if (lock.name.is_empty())
+            lock.name = String::formatted("{:p}", object.get("address").to_u64());
+        lock.acquisitions = object.get("acquisitions").to_u64();
+        lock.contentions = object.get("contentions").to_u64();
+        lock.total_wait_cycles = object.get("total_wait_cycles").to_u64();
+        object.get("wait_histogram").as_array().for_each([&](auto& bucket) {
+            lock.wait_histogram.append(bucket.to_u64());
+        });
+        locks.append(move(lock));
+    });
+
+    quick_sort(locks, [&](auto& a, auto& b) {
+        if (sort_by_wait_time)
+            return a.total_wait_cycles > b.total_wait_cycles;
+        return a.contentions > b.contentions;
+    });
+
+    outln("{:>12} {:>10} {:>6} {:>14} {:>10} {:>10}  {:18} {}", "acquired", "contended", "%", "wait cycles", "p50 wait", "p99 wait", "kind", "lock");
+    for (size_t i = 0; i < min(locks.size(), static_cast<size_t>(max(count, 0))); ++i) {
+        auto const& lock = locks[i];
+        auto percentage = lock.acquisitions ? lock.contentions * 100 / lock.acquisitions : 0;
+        outln("{:>12} {:>10} {:>6} {:>14} {:>10} {:>10}  {:18} {}",
+            lock.acquisitions, lock.contentions, percentage, lock.total_wait_cycles,
+            wait_percentile(lock, 50), wait_percentile(lock, 99), lock.kind, lock.name);
+    }
+
+    auto dropped = statistics.get("dropped_acquisitions").to_u64();
+    if (dropped)
+        warnln("{} acquisitions were not recorded because the lock table was full", dropped);
+
+    return 0;
+}
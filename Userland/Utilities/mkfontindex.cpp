@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibCore/ArgsParser.h>
+#include <LibCore/System.h>
+#include <LibGfx/FontIndex.h>
+#include <LibMain/Main.h>
+#include <fcntl.h>
+
+static ErrorOr<void> write_index(String const& fonts_directory, String const& index_path)
+{
+    auto index = TRY(Gfx::FontIndex::generate(fonts_directory));
+
+    // Programs may be mapping the old index, so the new one takes its place in one go.
+    auto temporary_path = String::formatted("{}.new", index_path);
+    auto fd = TRY(Core::System::open(temporary_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644));
+    auto write = [&]() -> ErrorOr<void> {
+        for (size_t offset = 0; offset < index.size();)
+            offset += TRY(Core::System::write(fd, index.bytes().slice(offset)));
+        TRY(Core::System::fchmod(fd, 0644));
+        return {};
+    };
+    auto result = write();
+    TRY(Core::System::close(fd));
+    if (result.is_error()) {
+        (void)Core::System::unlink(temporary_path);
+        return result.release_error();
+    }
+    return Core::System::rename(temporary_path, index_path);
+}
+
+ErrorOr<int> serenity_main(Main::Arguments arguments)
+{
+    TRY(Core::System::pledge("stdio rpath wpath cpath fattr"));
+
+    bool force = false;
+    bool verbose = false;
+    String fonts_directory = Gfx::FontIndex::system_fonts_directory;
+    String index_path = Gfx::FontIndex::system_index_path;
+
+    Core::ArgsParser args_parser;
+    args_parser.set_general_help("Write the index that lets programs find fonts without loading all of them.");
+    args_parser.add_option(force, "Write the index even if it is up to date", "force", 'f');
+    args_parser.add_option(verbose, "List the indexed fonts", "verbose", 'v');
+    args_parser.add_option(index_path, "Where to write the index", "output", 'o', "path");
+    args_parser.add_positional_argument(fonts_directory, "Directory with the fonts", "directory", Core::ArgsParser::Required::No);
+    args_parser.parse(arguments);
+
+    if (force || Gfx::FontIndex::try_open(index_path, fonts_directory).is_error())
+        TRY(write_index(fonts_directory, index_path));
+
+    if (verbose) {
+        auto index = TRY(Gfx::FontIndex::try_open(index_path, fonts_directory));
+        for (size_t i = 0; i < index->entry_count(); ++i) {
+            auto entry = index->entry(i);
+            outln("{}: {} {}, weight {}{}{}", entry.file_name, entry.family, entry.variant, entry.weight,
+                entry.is_truetype ? String(", scalable") : String::formatted(", size {}", entry.presentation_size),
+                entry.is_fixed_width ? ", fixed width"sv : ""sv);
+        }
+    }
+    return 0;
+}
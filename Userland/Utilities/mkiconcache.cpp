@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibCore/ArgsParser.h>
+#include <LibCore/System.h>
+#include <LibGfx/IconCache.h>
+#include <LibMain/Main.h>
+#include <fcntl.h>
+
+static ErrorOr<void> write_cache(String const& icons_directory, String const& cache_path)
+{
+    auto cache = TRY(Gfx::IconCache::generate(icons_directory));
+
+    // Programs have the old cache mapped, so it mustn't be written to. The new one takes its place in one go instead.
+    auto temporary_path = String::formatted("{}.new", cache_path);
+    auto fd = TRY(Core::System::open(temporary_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644));
+    auto write = [&]() -> ErrorOr<void> {
+        for (size_t offset = 0; offset < cache.size();)
+            offset += TRY(Core::System::write(fd, cache.bytes().slice(offset)));
+        TRY(Core::System::fchmod(fd, 0644));
+        return {};
+    };
+    auto result = write();
+    TRY(Core::System::close(fd));
+    if (result.is_error()) {
+        (void)Core::System::unlink(temporary_path);
+        return result.release_error();
+    }
+    return Core::System::rename(temporary_path, cache_path);
+}
+
+ErrorOr<int> serenity_main(Main::Arguments arguments)
+{
+    TRY(Core::System::pledge("stdio rpath wpath cpath fattr"));
+
+    bool force = false;
+    bool verbose = false;
+    String icons_directory = Gfx::IconCache::system_icons_directory;
+    String cache_path = Gfx::IconCache::system_cache_path;
+
+    Core::ArgsParser args_parser;
+    args_parser.set_general_help("Write the cache of decoded icons that programs share.");
+    args_parser.add_option(force, "Write the cache even if it is up to date", "force", 'f');
+    args_parser.add_option(verbose, "Show how many icons are cached", "verbose", 'v');
+    args_parser.add_option(cache_path, "Where to write the cache", "output", 'o', "path");
+    args_parser.add_positional_argument(icons_directory, "Directory with the icons", "directory", Core::ArgsParser::Required::No);
+    args_parser.parse(arguments);
+
+    auto cache_or_error = Gfx::IconCache::try_open(cache_path);
+    if (force || cache_or_error.is_error() || !cache_or_error.value()->is_up_to_date(icons_directory)) {
+        TRY(write_cache(icons_directory, cache_path));
+        cache_or_error = Gfx::IconCache::try_open(cache_path);
+    }
+
+    if (verbose) {
+        auto cache = TRY(move(cache_or_error));
+        auto stat = TRY(Core::System::stat(cache_path));
+        outln("{}: {} icons, {} bytes", cache_path, cache->entry_count(), stat.st_size);
+    }
+    return 0;
+}
@@ -39,7 +39,7 @@ int main(int argc, char** argv)
             if (event_type == "sample")
                 event_mask |= PERF_EVENT_SAMPLE;
             else if (event_type == "context_switch")
-                event_mask |= PERF_EVENT_CONTEXT_SWITCH;
+                event_mask |= PERF_EVENT_CONTEXT_SWITCH | PERF_EVENT_THREAD_WAKEUP;
             else if (event_type == "kmalloc")
                 event_mask |= PERF_EVENT_KMALLOC;
             else if (event_type == "kfree")
@@ -277,6 +277,8 @@ int main(int argc, char** argv)
     bool print_json = false;
     bool print_all_output = false;
     bool run_benchmarks = false;
+    String benchmark_results_directory;
+    String benchmark_baseline_directory;
     const char* specified_test_root = nullptr;
     String test_glob;
     String exclude_pattern;
@@ -301,6 +303,8 @@ int main(int argc, char** argv)
     args_parser.add_option(print_json, "Show results as JSON", "json", 'j');
     args_parser.add_option(print_all_output, "Show all test output", "verbose", 'v');
     args_parser.add_option(run_benchmarks, "Run benchmarks as well", "benchmarks", 'b');
+    args_parser.add_option(benchmark_results_directory, "Write the benchmark results of each test to a directory", "benchmark-results", 0, "directory");
+    args_parser.add_option(benchmark_baseline_directory, "Fail tests whose benchmarks got slower than the results in a directory", "compare-benchmarks", 0, "directory");
     args_parser.add_option(test_glob, "Only run tests matching the given glob", "filter", 'f', "glob");
     args_parser.add_option(exclude_pattern, "Regular expression to use to exclude paths from being considered tests", "exclude-pattern", 'e', "pattern");
     args_parser.add_option(config_file, "Configuration file to use", "config-file", 'c', "filename");
@@ -316,6 +320,15 @@ int main(int argc, char** argv)
     // Make UBSAN deadly for all tests we run by default.
     setenv("UBSAN_OPTIONS", "halt_on_error=1", true);
 
+    if (!benchmark_results_directory.is_null()) {
+        run_benchmarks = true;
+        setenv("BENCHMARK_RESULTS_DIRECTORY", Core::File::absolute_path(benchmark_results_directory).characters(), true);
+    }
+    if (!benchmark_baseline_directory.is_null()) {
+        run_benchmarks = true;
+        setenv("BENCHMARK_BASELINE_DIRECTORY", Core::File::absolute_path(benchmark_baseline_directory).characters(), true);
+    }
+
     if (!run_benchmarks)
         setenv("TESTS_ONLY", "1", true);
 
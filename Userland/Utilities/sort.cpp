@@ -4,40 +4,70 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
-#include <AK/QuickSort.h>
-#include <AK/String.h>
+#include <AK/ByteBuffer.h>
+#include <AK/StringView.h>
 #include <AK/Vector.h>
+#include <LibCore/MappedFile.h>
+#include <LibThreading/Parallel.h>
 #include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
 {
-    if (pledge("stdio", nullptr) > 0) {
+    if (pledge("stdio thread", nullptr) > 0) {
         perror("pledge");
         return 1;
     }
 
-    Vector<String> lines;
-
-    for (;;) {
-        char* buffer = nullptr;
-        ssize_t buflen = 0;
-        size_t n;
-        errno = 0;
-        buflen = getline(&buffer, &n, stdin);
-        if (buflen == -1 && errno != 0) {
-            perror("getline");
-            exit(1);
+    // The lines are views into the input, so it has to stay around until we're done. If it's a regular file,
+    // we map it instead of reading it into memory.
+    RefPtr<Core::MappedFile> mapped_input;
+    ByteBuffer read_input;
+    ReadonlyBytes input;
+
+    struct stat st;
+    if (fstat(STDIN_FILENO, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        auto mapped_file_or_error = Core::MappedFile::map_from_fd_and_close(dup(STDIN_FILENO), "stdin");
+        if (!mapped_file_or_error.is_error()) {
+            mapped_input = mapped_file_or_error.release_value();
+            input = mapped_input->bytes();
+        }
+    }
+
+    if (!mapped_input) {
+        u8 buffer[64 * KiB];
+        for (;;) {
+            auto nread = read(STDIN_FILENO, buffer, sizeof(buffer));
+            if (nread < 0) {
+                if (errno == EINTR)
+                    continue;
+                perror("read");
+                exit(1);
+            }
+            if (nread == 0)
+                break;
+            read_input.append(buffer, nread);
         }
-        if (buflen == -1)
-            break;
-        lines.append({ buffer, AK::ShouldChomp::Chomp });
+        input = read_input.bytes();
+    }
+
+    Vector<StringView> lines;
+    StringView remaining { input };
+    while (!remaining.is_empty()) {
+        auto const* newline = static_cast<char const*>(memchr(remaining.characters_without_null_termination(), '\n', remaining.length()));
+        auto length = newline ? newline - remaining.characters_without_null_termination() : remaining.length();
+        auto line = remaining.substring_view(0, length);
+        remaining = remaining.substring_view(min(length + 1, remaining.length()));
+        while (line.ends_with('\r'))
+            line = line.substring_view(0, line.length() - 1);
+        lines.append(line);
     }
 
-    quick_sort(lines);
+    Threading::parallel_sort(lines);
 
     for (auto& line : lines) {
         outln("{}", line);
@@ -10,6 +10,7 @@
 #include <AK/Vector.h>
 #include <LibArchive/TarStream.h>
 #include <LibCompress/Gzip.h>
+#include <LibCompress/Lz4.h>
 #include <LibCore/ArgsParser.h>
 #include <LibCore/DirIterator.h>
 #include <LibCore/File.h>
@@ -28,6 +29,7 @@ int main(int argc, char** argv)
     bool list = false;
     bool verbose = false;
     bool gzip = false;
+    bool lz4 = false;
     const char* archive_file = nullptr;
     const char* directory = nullptr;
     Vector<const char*> paths;
@@ -38,6 +40,7 @@ int main(int argc, char** argv)
     args_parser.add_option(list, "List contents", "list", 't');
     args_parser.add_option(verbose, "Print paths", "verbose", 'v');
     args_parser.add_option(gzip, "Compress or decompress file using gzip", "gzip", 'z');
+    args_parser.add_option(lz4, "Compress or decompress file using LZ4", "lz4", 0);
     args_parser.add_option(directory, "Directory to extract to/create from", "directory", 'C', "DIRECTORY");
     args_parser.add_option(archive_file, "Archive file", "file", 'f', "FILE");
     args_parser.add_positional_argument(paths, "Paths", "PATHS", Core::ArgsParser::Required::No);
@@ -48,6 +51,11 @@ int main(int argc, char** argv)
         return 1;
     }
 
+    if (gzip && lz4) {
+        warnln("at most one of -z and --lz4 can be used");
+        return 1;
+    }
+
     if (list || extract) {
         auto file = Core::File::standard_input();
 
@@ -69,10 +77,12 @@ int main(int argc, char** argv)
 
         Core::InputFileStream file_stream(file);
         Compress::GzipDecompressor gzip_stream(file_stream);
+        Compress::Lz4Decompressor lz4_stream(file_stream);
 
         InputStream& file_input_stream = file_stream;
         InputStream& gzip_input_stream = gzip_stream;
-        Archive::TarInputStream tar_stream((gzip) ? gzip_input_stream : file_input_stream);
+        InputStream& lz4_input_stream = lz4_stream;
+        Archive::TarInputStream tar_stream(gzip ? gzip_input_stream : lz4 ? lz4_input_stream : file_input_stream);
         if (!tar_stream.valid()) {
             warnln("the provided file is not a well-formatted ustar file");
             return 1;
@@ -178,10 +188,12 @@ int main(int argc, char** argv)
 
         Core::OutputFileStream file_stream(file);
         Compress::GzipCompressor gzip_stream(file_stream);
+        Compress::Lz4Compressor lz4_stream(file_stream);
 
         OutputStream& file_output_stream = file_stream;
         OutputStream& gzip_output_stream = gzip_stream;
-        Archive::TarOutputStream tar_stream((gzip) ? gzip_output_stream : file_output_stream);
+        OutputStream& lz4_output_stream = lz4_stream;
+        Archive::TarOutputStream tar_stream(gzip ? gzip_output_stream : lz4 ? lz4_output_stream : file_output_stream);
 
         auto add_file = [&](String path) {
             auto file = Core::File::construct(path);
@@ -232,6 +244,8 @@ int main(int argc, char** argv)
         }
 
         tar_stream.finish();
+        if (lz4)
+            lz4_stream.final_flush();
 
         return 0;
     }
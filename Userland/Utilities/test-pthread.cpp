@@ -5,7 +5,10 @@
  */
 
 #include <AK/Assertions.h>
+#include <AK/Format.h>
 #include <AK/NonnullRefPtrVector.h>
+#include <AK/StringView.h>
+#include <LibCore/ElapsedTimer.h>
 #include <LibThreading/Thread.h>
 #include <errno.h>
 #include <pthread.h>
@@ -66,6 +69,54 @@ static void test_mutex()
     VERIFY(pthread_mutex_trylock(&mutex) == EBUSY);
 }
 
+static void test_rwlock()
+{
+    constexpr size_t threads_count = 10;
+    constexpr size_t num_times = 100;
+
+    NonnullRefPtrVector<Threading::Thread, threads_count> threads;
+    pthread_rwlock_t lock = PTHREAD_RWLOCK_INITIALIZER;
+    Atomic<u32> readers_inside = 0;
+    Atomic<u32> writers_inside = 0;
+    Vector<int> v;
+
+    for (size_t i = 0; i < threads_count; i++) {
+        bool is_writer = i % 3 == 0;
+        threads.append(Threading::Thread::construct([&, is_writer] {
+            for (size_t j = 0; j < num_times; j++) {
+                if (is_writer) {
+                    VERIFY(pthread_rwlock_wrlock(&lock) == 0);
+                    VERIFY(writers_inside.fetch_add(1) == 0);
+                    VERIFY(readers_inside.load() == 0);
+                    v.append(35);
+                    sched_yield();
+                    writers_inside.fetch_sub(1);
+                } else {
+                    VERIFY(pthread_rwlock_rdlock(&lock) == 0);
+                    readers_inside.fetch_add(1);
+                    VERIFY(writers_inside.load() == 0);
+                    sched_yield();
+                    readers_inside.fetch_sub(1);
+                }
+                VERIFY(pthread_rwlock_unlock(&lock) == 0);
+                sched_yield();
+            }
+            return 0;
+        }));
+        threads.last().start();
+    }
+    for (auto& thread : threads)
+        [[maybe_unused]] auto res = thread.join();
+
+    VERIFY(v.size() == 4 * num_times);
+    VERIFY(pthread_rwlock_tryrdlock(&lock) == 0);
+    VERIFY(pthread_rwlock_trywrlock(&lock) == EBUSY);
+    VERIFY(pthread_rwlock_unlock(&lock) == 0);
+    VERIFY(pthread_rwlock_trywrlock(&lock) == 0);
+    VERIFY(pthread_rwlock_tryrdlock(&lock) == EBUSY);
+    VERIFY(pthread_rwlock_unlock(&lock) == 0);
+}
+
 static void test_semaphore_as_lock()
 {
     constexpr size_t threads_count = 10;
@@ -165,10 +216,87 @@ static void test_semaphore_nonbinary()
     VERIFY(sem_trywait(&semaphore) == EAGAIN);
 }
 
-int main()
+// Runs the given number of threads that all hammer on the same lock, and prints how long it took.
+template<typename Callback>
+static void benchmark(StringView name, size_t threads_count, Callback callback)
 {
+    NonnullRefPtrVector<Threading::Thread> threads;
+    auto timer = Core::ElapsedTimer::start_new();
+    for (size_t i = 0; i < threads_count; i++) {
+        threads.append(Threading::Thread::construct([&callback, i] {
+            callback(i);
+            return 0;
+        }));
+        threads.last().start();
+    }
+    for (auto& thread : threads)
+        [[maybe_unused]] auto res = thread.join();
+    outln("{}: {} threads, {} ms", name, threads_count, timer.elapsed());
+}
+
+static void run_benchmarks()
+{
+    constexpr size_t num_times = 100000;
+
+    for (size_t threads_count : { 1, 2, 4, 8 }) {
+        pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+        u64 counter = 0;
+        benchmark("mutex"sv, threads_count, [&](size_t) {
+            for (size_t j = 0; j < num_times; j++) {
+                pthread_mutex_lock(&mutex);
+                ++counter;
+                pthread_mutex_unlock(&mutex);
+            }
+        });
+        VERIFY(counter == threads_count * num_times);
+    }
+
+    for (size_t threads_count : { 1, 2, 4, 8 }) {
+        pthread_rwlock_t lock = PTHREAD_RWLOCK_INITIALIZER;
+        u64 counter = 0;
+        // One in sixteen accesses is a write.
+        benchmark("rwlock"sv, threads_count, [&](size_t) {
+            for (size_t j = 0; j < num_times; j++) {
+                if (j % 16 == 0) {
+                    pthread_rwlock_wrlock(&lock);
+                    ++counter;
+                } else {
+                    pthread_rwlock_rdlock(&lock);
+                    [[maybe_unused]] volatile u64 value = counter;
+                }
+                pthread_rwlock_unlock(&lock);
+            }
+        });
+    }
+
+    for (size_t threads_count : { 2, 4, 8 }) {
+        pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+        pthread_cond_t condition = PTHREAD_COND_INITIALIZER;
+        size_t turn = 0;
+        // The threads pass a token around in a ring, waking each other up with a broadcast every time.
+        benchmark("condvar ring"sv, threads_count, [&](size_t index) {
+            for (size_t j = 0; j < num_times / 10; j++) {
+                pthread_mutex_lock(&mutex);
+                while (turn % threads_count != index)
+                    pthread_cond_wait(&condition, &mutex);
+                ++turn;
+                pthread_cond_broadcast(&condition);
+                pthread_mutex_unlock(&mutex);
+            }
+        });
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 1 && argv[1] == "--benchmark"sv) {
+        run_benchmarks();
+        return 0;
+    }
+
     test_once();
     test_mutex();
+    test_rwlock();
 
     test_semaphore_as_lock();
     test_semaphore_as_event();
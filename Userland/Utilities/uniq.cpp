@@ -5,12 +5,15 @@
  */
 
 #include <AK/RefPtr.h>
+#include <AK/StringView.h>
 #include <LibCore/ArgsParser.h>
+#include <LibCore/MappedFile.h>
 #include <LibCore/System.h>
 #include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 struct linebuf {
@@ -18,6 +21,47 @@ struct linebuf {
     size_t len = 0;
 };
 
+// Calls callback() with every line of the input, including its newline if it has one. Each line stays valid until the
+// callback for the line after it has returned.
+template<typename Callback>
+static void for_each_line(FILE* infile, Callback callback)
+{
+    // Regular files are mapped, so the lines can be looked at in place.
+    struct stat st;
+    if (fstat(fileno(infile), &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        auto mapped_file_or_error = Core::MappedFile::map_from_fd_and_close(dup(fileno(infile)), {});
+        if (!mapped_file_or_error.is_error()) {
+            StringView remaining { mapped_file_or_error.value()->bytes() };
+            while (!remaining.is_empty()) {
+                auto const* newline = static_cast<char const*>(memchr(remaining.characters_without_null_termination(), '\n', remaining.length()));
+                size_t length = newline ? newline - remaining.characters_without_null_termination() + 1 : remaining.length();
+                callback(remaining.substring_view(0, length));
+                remaining = remaining.substring_view(length);
+            }
+            return;
+        }
+    }
+
+    // Otherwise, we alternate between two buffers so that the previous line is still around.
+    struct linebuf buffers[2];
+    struct linebuf* current = &(buffers[0]);
+    struct linebuf* previous = &(buffers[1]);
+    for (;;) {
+        errno = 0;
+        ssize_t rc = getline(&(current->buf), &(current->len), infile);
+        if (rc < 0 && errno != 0) {
+            perror("getline");
+            exit(1);
+        }
+        if (rc < 0)
+            break;
+        callback(StringView { current->buf, static_cast<size_t>(rc) });
+        swap(current, previous);
+    }
+    free(buffers[0].buf);
+    free(buffers[1].buf);
+}
+
 static FILE* get_stream(const char* filepath, const char* perms)
 {
     FILE* ret;
@@ -51,26 +95,14 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     FILE* infile = get_stream(inpath, "r");
     FILE* outfile = get_stream(outpath, "w");
 
-    struct linebuf buffers[2];
-    struct linebuf* previous = &(buffers[0]);
-    struct linebuf* current = &(buffers[1]);
-    bool first_run = true;
-    for (;;) {
-        errno = 0;
-        ssize_t rc = getline(&(current->buf), &(current->len), infile);
-        if (rc < 0 && errno != 0) {
-            perror("getline");
-            exit(1);
-        }
-        if (rc < 0)
-            break;
-        if (!first_run && strcmp(current->buf, previous->buf) == 0)
-            continue;
+    Optional<StringView> previous;
+    for_each_line(infile, [&](StringView line) {
+        if (previous.has_value() && line == *previous)
+            return;
 
-        fputs(current->buf, outfile);
-        swap(current, previous);
-        first_run = false;
-    }
+        fwrite(line.characters_without_null_termination(), 1, line.length(), outfile);
+        previous = line;
+    });
 
     fclose(infile);
     fclose(outfile);
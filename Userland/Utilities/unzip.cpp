@@ -5,17 +5,35 @@
  */
 
 #include <AK/Assertions.h>
+#include <AK/Atomic.h>
 #include <AK/NumberFormat.h>
+#include <AK/ScopeGuard.h>
 #include <LibArchive/Zip.h>
 #include <LibCompress/Deflate.h>
 #include <LibCore/ArgsParser.h>
-#include <LibCore/File.h>
 #include <LibCore/MappedFile.h>
 #include <LibCore/System.h>
+#include <LibCrypto/Checksum/CRC32.h>
+#include <LibThreading/Thread.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
-static bool unpack_zip_member(Archive::ZipMember zip_member, bool quiet)
+static bool write_all(int fd, ReadonlyBytes bytes)
+{
+    while (!bytes.is_empty()) {
+        auto nwritten = Core::System::write(fd, bytes);
+        if (nwritten.is_error())
+            return false;
+        bytes = bytes.slice(nwritten.value());
+    }
+    return true;
+}
+
+// NOTE: This runs on the extraction threads too, so it sticks to plain file descriptors instead of Core::Objects.
+static bool unpack_zip_member(Archive::ZipMember const& zip_member, bool quiet)
 {
     if (zip_member.is_directory) {
         if (mkdir(zip_member.name.characters(), 0755) < 0) {
@@ -26,63 +44,106 @@ static bool unpack_zip_member(Archive::ZipMember zip_member, bool quiet)
             outln(" extracting: {}", zip_member.name);
         return true;
     }
-    auto new_file = Core::File::construct(zip_member.name);
-    if (!new_file->open(Core::OpenMode::WriteOnly)) {
-        warnln("Can't write file {}: {}", zip_member.name, new_file->error_string());
+    auto fd_or_error = Core::System::open(zip_member.name, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd_or_error.is_error()) {
+        warnln("Can't write file {}: {}", zip_member.name, fd_or_error.error());
         return false;
     }
+    auto fd = fd_or_error.release_value();
+    ScopeGuard close_fd = [&] { (void)Core::System::close(fd); };
 
     if (!quiet)
         outln(" extracting: {}", zip_member.name);
 
-    // TODO: verify CRC32s match!
+    // Stored members are written straight out of the mapped archive, deflated ones are inflated into a single buffer of their final size.
+    ByteBuffer decompressed_data;
+    ReadonlyBytes data;
     switch (zip_member.compression_method) {
-    case Archive::ZipCompressionMethod::Store: {
-        if (!new_file->write(zip_member.compressed_data.data(), zip_member.compressed_data.size())) {
-            warnln("Can't write file contents in {}: {}", zip_member.name, new_file->error_string());
-            return false;
-        }
+    case Archive::ZipCompressionMethod::Store:
+        data = zip_member.compressed_data;
         break;
-    }
     case Archive::ZipCompressionMethod::Deflate: {
-        auto decompressed_data = Compress::DeflateDecompressor::decompress_all(zip_member.compressed_data);
-        if (!decompressed_data.has_value()) {
-            warnln("Failed decompressing file {}", zip_member.name);
+        auto buffer_or_error = ByteBuffer::create_uninitialized(zip_member.uncompressed_size);
+        if (!buffer_or_error.has_value()) {
+            warnln("Not enough memory to decompress file {}", zip_member.name);
             return false;
         }
-        if (decompressed_data.value().size() != zip_member.uncompressed_size) {
+        decompressed_data = buffer_or_error.release_value();
+        auto decompressed_size = Compress::DeflateDecompressor::decompress_into(zip_member.compressed_data, decompressed_data);
+        if (!decompressed_size.has_value() || decompressed_size.value() != zip_member.uncompressed_size) {
             warnln("Failed decompressing file {}", zip_member.name);
             return false;
         }
-        if (!new_file->write(decompressed_data.value().data(), decompressed_data.value().size())) {
-            warnln("Can't write file contents in {}: {}", zip_member.name, new_file->error_string());
-            return false;
-        }
+        data = decompressed_data;
         break;
     }
     default:
         VERIFY_NOT_REACHED();
     }
 
-    if (!new_file->close()) {
-        warnln("Can't close file {}: {}", zip_member.name, new_file->error_string());
+    if (Crypto::Checksum::CRC32 { data }.digest() != zip_member.crc32) {
+        warnln("CRC32 mismatch in file {}", zip_member.name);
+        return false;
+    }
+
+    if (!write_all(fd, data)) {
+        warnln("Can't write file contents in {}: {}", zip_member.name, strerror(errno));
         return false;
     }
 
     return true;
 }
 
+static bool unpack_zip_members_in_parallel(Vector<Archive::ZipMember> const& zip_members, bool quiet, size_t thread_count)
+{
+    // Directories are created up front and in archive order, so that the files inside them can be extracted in any order.
+    for (auto& zip_member : zip_members) {
+        if (zip_member.is_directory && !unpack_zip_member(zip_member, quiet))
+            return false;
+    }
+
+    Atomic<size_t> next_member_index { 0 };
+    Atomic<bool> failed { false };
+    auto unpack_files = [&]() -> intptr_t {
+        while (!failed.load()) {
+            auto const member_index = next_member_index.fetch_add(1);
+            if (member_index >= zip_members.size())
+                break;
+            auto& zip_member = zip_members[member_index];
+            if (!zip_member.is_directory && !unpack_zip_member(zip_member, quiet))
+                failed.store(true);
+        }
+        return 0;
+    };
+
+    Vector<NonnullRefPtr<Threading::Thread>> threads;
+    for (size_t i = 1; i < min(thread_count, zip_members.size()); ++i) {
+        auto thread = Threading::Thread::construct([&unpack_files] { return unpack_files(); }, "unzip"sv);
+        thread->start();
+        threads.append(move(thread));
+    }
+
+    unpack_files();
+
+    for (auto& thread : threads)
+        (void)thread->join();
+
+    return !failed.load();
+}
+
 ErrorOr<int> serenity_main(Main::Arguments arguments)
 {
     const char* path;
     int map_size_limit = 32 * MiB;
     bool quiet { false };
+    unsigned thread_count { 1 };
     String output_directory_path;
 
     Core::ArgsParser args_parser;
     args_parser.add_option(map_size_limit, "Maximum chunk size to map", "map-size-limit", 0, "size");
     args_parser.add_option(output_directory_path, "Directory to receive the archive content", "output-directory", 'd', "path");
     args_parser.add_option(quiet, "Be less verbose", "quiet", 'q');
+    args_parser.add_option(thread_count, "Extract members in parallel on this many threads", "threads", 'T', "count");
     args_parser.add_positional_argument(path, "File to unzip", "path", Core::ArgsParser::Required::Yes);
     args_parser.parse(arguments);
 
@@ -118,7 +179,16 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
         TRY(Core::System::chdir(output_directory_path));
     }
 
-    auto success = zip_file->for_each_member([&](auto zip_member) {
+    if (thread_count > 1) {
+        Vector<Archive::ZipMember> zip_members;
+        zip_file->for_each_member([&](auto& zip_member) {
+            zip_members.append(zip_member);
+            return IterationDecision::Continue;
+        });
+        return unpack_zip_members_in_parallel(zip_members, quiet, thread_count) ? 0 : 1;
+    }
+
+    auto success = zip_file->for_each_member([&](auto& zip_member) {
         return unpack_zip_member(zip_member, quiet) ? IterationDecision::Continue : IterationDecision::Break;
     });
 